@@ -0,0 +1,47 @@
+# Runs the benchmark suite without the window, renderer or audio devices, so measuring a
+# kernel change only rebuilds core and the handful of CLI sources below.
+add_executable(synesthesia_bench
+    ${SRC_DIR}/utilities/cli/bench_main.cpp
+    ${SRC_DIR}/utilities/cli/cli.cpp
+    ${SRC_DIR}/utilities/cli/batch_exporter.cpp
+    ${SRC_DIR}/utilities/cli/batch_dataset_writer.cpp
+    ${SRC_DIR}/utilities/cli/gradient_png_writer.cpp
+    ${SRC_DIR}/utilities/cli/batch_export_cache.cpp
+    ${SRC_DIR}/utilities/cli/batch_memory_budget.cpp
+    ${SRC_DIR}/utilities/cli/misc/benchmark_suite_command.cpp
+    ${SRC_DIR}/resyne/recorder/import_helpers.cpp
+    ${SRC_DIR}/resyne/recorder/embedded_source_utils.cpp
+    ${SRC_DIR}/resyne/ui/timeline/timeline_rasteriser.cpp
+)
+
+target_include_directories(synesthesia_bench SYSTEM PRIVATE
+    ${CMAKE_CURRENT_SOURCE_DIR}/vendor/lodepng
+)
+
+# The timeline rasteriser only needs ImGui's vector types from timeline.h.
+target_include_directories(synesthesia_bench PRIVATE
+    ${IMGUI_DIR}
+    ${SRC_DIR}/utilities/cli
+    ${CMAKE_BINARY_DIR}
+)
+
+target_link_libraries(synesthesia_bench PRIVATE
+    synesthesia_core
+    vendor_imgui
+    vendor_lodepng
+)
+
+if(MSVC)
+    target_compile_options(synesthesia_bench PRIVATE
+        $<$<CONFIG:Release>:/O2>
+    )
+else()
+    target_compile_options(synesthesia_bench PRIVATE
+        "-Wall" "-Wextra" "-Wformat" "-Wpedantic"
+        "-O3" "-ffast-math"
+    )
+endif()
+
+set_target_properties(synesthesia_bench PROPERTIES
+    RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}
+)
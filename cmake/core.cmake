@@ -0,0 +1,51 @@
+add_library(synesthesia_core STATIC ${CORE_SOURCES})
+
+configure_core_include_directories()
+
+target_link_libraries(synesthesia_core PUBLIC
+    nlohmann_json::nlohmann_json
+    vendor_kissfft
+)
+
+if(ENABLE_OSC)
+    target_link_libraries(synesthesia_core PUBLIC vendor_oscpack)
+    target_compile_definitions(synesthesia_core PUBLIC ENABLE_OSC)
+endif()
+
+# The timers are compiled into core and read by the application's overlay, so both sides
+# have to agree on the flag.
+if(ENABLE_FRAME_PROFILER)
+    target_compile_definitions(synesthesia_core PUBLIC ENABLE_FRAME_PROFILER)
+endif()
+
+if(UNIX AND NOT APPLE)
+    target_link_libraries(synesthesia_core PUBLIC pthread m rt)
+endif()
+
+# MMCSS registration for the real-time threads.
+if(WIN32)
+    target_link_libraries(synesthesia_core PUBLIC avrt)
+endif()
+
+if(MSVC)
+    target_compile_options(synesthesia_core PRIVATE
+        $<$<CONFIG:Release>:/O2>
+    )
+elseif(APPLE)
+    target_compile_options(synesthesia_core PRIVATE
+        "-Wall" "-Wextra" "-Wformat" "-Wpedantic"
+        "-Wunused" "-Wuninitialized" "-Wshadow"
+        "-Wconversion" "-Wsign-conversion" "-Wfloat-conversion"
+        "-Wnull-dereference" "-Wdouble-promotion"
+        "-Wmissing-include-dirs" "-Wundef" "-Wredundant-decls"
+        "-Woverloaded-virtual" "-Wnon-virtual-dtor"
+        "-O3" "-ffast-math"
+    )
+else()
+    target_compile_options(synesthesia_core PRIVATE
+        "-Wall" "-Wextra" "-Wformat" "-Wpedantic"
+        "-O3" "-ffast-math"
+    )
+endif()
+
+message(STATUS "Configured synesthesia_core library")
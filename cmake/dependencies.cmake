@@ -65,6 +65,10 @@ function(configure_synesthesia_bgfx_target)
     if(bgfx_renderer_definitions)
         target_compile_definitions(bgfx PRIVATE ${bgfx_renderer_definitions})
     endif()
+
+    # The renderer relies on bgfx owning a render thread outside macOS, so pin it rather
+    # than follow bgfx's per-platform default.
+    target_compile_definitions(bgfx PRIVATE BGFX_CONFIG_MULTITHREADED=1)
 endfunction()
 
 if(EXISTS "${GLFW_DIR}/CMakeLists.txt")
@@ -3,6 +3,7 @@ if(NOT TARGET ${EXECUTABLE_NAME})
 endif()
 
 option(SYN_BUNDLE_FFMPEG "Build and bundle the project-managed FFmpeg binary" ON)
+option(SYN_FFMPEG_LIBAV "Encode video in-process through the bundled libavformat/libavcodec" OFF)
 
 if(NOT SYN_BUNDLE_FFMPEG)
     return()
@@ -76,6 +77,25 @@ if(NOT SYN_FFMPEG_AVAILABLE)
     return()
 endif()
 
+if(SYN_FFMPEG_LIBAV)
+    find_package(PkgConfig QUIET)
+    if(PkgConfig_FOUND)
+        set(_SYN_PREVIOUS_PKG_CONFIG_PATH "$ENV{PKG_CONFIG_PATH}")
+        set(ENV{PKG_CONFIG_PATH} "${SYN_FFMPEG_INSTALL_PREFIX}/lib/pkgconfig")
+        pkg_check_modules(SYN_LIBAV libavformat libavcodec libswresample libavutil)
+        set(ENV{PKG_CONFIG_PATH} "${_SYN_PREVIOUS_PKG_CONFIG_PATH}")
+    endif()
+    if(SYN_LIBAV_FOUND)
+        target_include_directories(${EXECUTABLE_NAME} PRIVATE ${SYN_LIBAV_STATIC_INCLUDE_DIRS})
+        target_link_directories(${EXECUTABLE_NAME} PRIVATE ${SYN_LIBAV_STATIC_LIBRARY_DIRS})
+        target_link_libraries(${EXECUTABLE_NAME} PRIVATE ${SYN_LIBAV_STATIC_LDFLAGS})
+        target_compile_definitions(${EXECUTABLE_NAME} PRIVATE SYN_FFMPEG_LIBAV)
+        message(STATUS "Video export encodes in-process through the bundled libav libraries")
+    else()
+        message(WARNING "Bundled libav libraries not found under ${SYN_FFMPEG_INSTALL_PREFIX}; video export will pipe to the ffmpeg executable.")
+    endif()
+endif()
+
 if(APPLE)
     if(BUILD_MACOS_BUNDLE)
         set(SYN_FFMPEG_BUNDLE_BIN "${CMAKE_BINARY_DIR}/${EXECUTABLE_NAME}.app/Contents/Resources/bin")
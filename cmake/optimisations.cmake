@@ -39,20 +39,51 @@ endif()
 
 function(add_neon_sources)
     if(NEON_AVAILABLE AND ENABLE_NEON_OPTIMISATIONS)
-        list(APPEND SOURCES
+        list(APPEND CORE_SOURCES
             ${SRC_DIR}/audio/analysis/fft/neon/fft_processor_neon.cpp
+            ${SRC_DIR}/audio/analysis/fft/neon/spectral_descriptors_neon.cpp
+            ${SRC_DIR}/audio/analysis/eq/neon/shared_eq_model_neon.cpp
+            ${SRC_DIR}/audio/analysis/loudness/neon/loudness_meter_neon.cpp
+            ${SRC_DIR}/audio/processing/noise_gate/neon/noise_gate_neon.cpp
+            ${SRC_DIR}/resyne/decoding/neon/pcm_conversion_neon.cpp
+            ${SRC_DIR}/resyne/encoding/audio/neon/pcm_encoding_neon.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/neon/phase_kernels_neon.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/neon/varispeed_neon.cpp
+            ${SRC_DIR}/resyne/encoding/spectral/neon/colour_column_neon.cpp
+            ${SRC_DIR}/colour/neon/display_lut_neon.cpp
+            ${SRC_DIR}/colour/neon/cube_root_neon.cpp
+            ${SRC_DIR}/resyne/encoding/formats/neon/half_float_neon.cpp
+            ${SRC_DIR}/resyne/encoding/formats/neon/crc32_neon.cpp
         )
-        set(SOURCES ${SOURCES} PARENT_SCOPE)
+        set(CORE_SOURCES ${CORE_SOURCES} PARENT_SCOPE)
         message(STATUS "Added NEON-optimised source files to build")
     endif()
 endfunction()
 
 function(add_sse_sources)
     if(SSE_AVAILABLE)
-        list(APPEND SOURCES
+        list(APPEND CORE_SOURCES
             ${SRC_DIR}/audio/analysis/fft/sse/fft_processor_sse.cpp
+            ${SRC_DIR}/audio/analysis/fft/sse/spectral_descriptors_sse.cpp
+            ${SRC_DIR}/audio/analysis/eq/sse/shared_eq_model_sse.cpp
+            ${SRC_DIR}/audio/analysis/loudness/sse/loudness_meter_sse.cpp
+            ${SRC_DIR}/audio/processing/noise_gate/sse/noise_gate_sse.cpp
+            ${SRC_DIR}/resyne/decoding/sse/pcm_conversion_sse.cpp
+            ${SRC_DIR}/resyne/encoding/audio/sse/pcm_encoding_sse.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/sse/phase_kernels_sse.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/sse/varispeed_sse.cpp
+            ${SRC_DIR}/resyne/encoding/spectral/sse/colour_column_sse.cpp
+            ${SRC_DIR}/colour/sse/display_lut_sse.cpp
+            ${SRC_DIR}/colour/sse/cube_root_sse.cpp
+            ${SRC_DIR}/resyne/encoding/formats/sse/half_float_sse.cpp
+            ${SRC_DIR}/resyne/encoding/formats/sse/crc32_sse.cpp
+            ${SRC_DIR}/audio/analysis/fft/avx/fft_processor_avx2.cpp
+            ${SRC_DIR}/audio/analysis/fft/avx/fft_processor_avx512.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/avx/phase_kernels_avx2.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/avx/phase_kernels_avx512.cpp
+            ${SRC_DIR}/resyne/encoding/spectral/avx/colour_column_avx2.cpp
         )
-        set(SOURCES ${SOURCES} PARENT_SCOPE)
+        set(CORE_SOURCES ${CORE_SOURCES} PARENT_SCOPE)
         message(STATUS "Added SSE/AVX-optimised source files to build")
     endif()
 endfunction()
@@ -61,16 +92,35 @@ function(apply_neon_optimisations)
     if(NEON_AVAILABLE AND ENABLE_NEON_OPTIMISATIONS)
         if(APPLE)
             set(NEON_CPU_FLAGS "-mcpu=native -mtune=native")
+            set(NEON_CRC_FLAGS "-mcpu=native -mtune=native")
             message(STATUS "Applied NEON optimisations for Apple Silicon (native)")
         else()
             set(NEON_CPU_FLAGS "-march=armv8-a+simd -mtune=cortex-a72")
+            # CRC32 is optional before ARMv8.1, so the kernel checks for it at runtime.
+            set(NEON_CRC_FLAGS "-march=armv8-a+crc+simd -mtune=cortex-a72")
             message(STATUS "Applied NEON optimisations for generic ARM64")
         endif()
 
         set_source_files_properties(
             ${SRC_DIR}/audio/analysis/fft/neon/fft_processor_neon.cpp
+            ${SRC_DIR}/audio/analysis/fft/neon/spectral_descriptors_neon.cpp
+            ${SRC_DIR}/audio/analysis/eq/neon/shared_eq_model_neon.cpp
+            ${SRC_DIR}/audio/analysis/loudness/neon/loudness_meter_neon.cpp
+            ${SRC_DIR}/audio/processing/noise_gate/neon/noise_gate_neon.cpp
+            ${SRC_DIR}/resyne/decoding/neon/pcm_conversion_neon.cpp
+            ${SRC_DIR}/resyne/encoding/audio/neon/pcm_encoding_neon.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/neon/phase_kernels_neon.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/neon/varispeed_neon.cpp
+            ${SRC_DIR}/resyne/encoding/spectral/neon/colour_column_neon.cpp
+            ${SRC_DIR}/colour/neon/display_lut_neon.cpp
+            ${SRC_DIR}/colour/neon/cube_root_neon.cpp
+            ${SRC_DIR}/resyne/encoding/formats/neon/half_float_neon.cpp
             PROPERTIES COMPILE_FLAGS "-O3 -ffast-math ${NEON_CPU_FLAGS}"
         )
+        set_source_files_properties(
+            ${SRC_DIR}/resyne/encoding/formats/neon/crc32_neon.cpp
+            PROPERTIES COMPILE_FLAGS "-O3 ${NEON_CRC_FLAGS}"
+        )
 
         message(STATUS "Applied NEON-specific compiler optimisations")
     endif()
@@ -78,18 +128,64 @@ endfunction()
 
 function(apply_sse_optimisations)
     if(SSE_AVAILABLE)
+        # Every target builds for the SSE4.2 baseline. Only the kernels below are built for
+        # wider instruction sets, and each is reached through a runtime check in
+        # utilities/cpu, so one binary runs on any x86_64 machine.
+        set(SSE_KERNEL_SOURCES
+            ${SRC_DIR}/audio/analysis/fft/sse/fft_processor_sse.cpp
+            ${SRC_DIR}/audio/analysis/fft/sse/spectral_descriptors_sse.cpp
+            ${SRC_DIR}/audio/analysis/eq/sse/shared_eq_model_sse.cpp
+            ${SRC_DIR}/audio/analysis/loudness/sse/loudness_meter_sse.cpp
+            ${SRC_DIR}/audio/processing/noise_gate/sse/noise_gate_sse.cpp
+            ${SRC_DIR}/resyne/decoding/sse/pcm_conversion_sse.cpp
+            ${SRC_DIR}/resyne/encoding/audio/sse/pcm_encoding_sse.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/sse/phase_kernels_sse.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/sse/varispeed_sse.cpp
+            ${SRC_DIR}/resyne/encoding/spectral/sse/colour_column_sse.cpp
+            ${SRC_DIR}/colour/sse/display_lut_sse.cpp
+            ${SRC_DIR}/colour/sse/cube_root_sse.cpp
+        )
+        set(F16C_KERNEL_SOURCES
+            ${SRC_DIR}/resyne/encoding/formats/sse/half_float_sse.cpp
+        )
+        set(PCLMUL_KERNEL_SOURCES
+            ${SRC_DIR}/resyne/encoding/formats/sse/crc32_sse.cpp
+        )
+        set(AVX2_KERNEL_SOURCES
+            ${SRC_DIR}/audio/analysis/fft/avx/fft_processor_avx2.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/avx/phase_kernels_avx2.cpp
+            ${SRC_DIR}/resyne/encoding/spectral/avx/colour_column_avx2.cpp
+        )
+        set(AVX512_KERNEL_SOURCES
+            ${SRC_DIR}/audio/analysis/fft/avx/fft_processor_avx512.cpp
+            ${SRC_DIR}/resyne/encoding/reconstruction/avx/phase_kernels_avx512.cpp
+        )
+
         if(MSVC)
-            target_compile_options(${EXECUTABLE_NAME} PRIVATE /arch:AVX2)
-            set_source_files_properties(
-                ${SRC_DIR}/audio/analysis/fft/sse/fft_processor_sse.cpp
-                PROPERTIES COMPILE_FLAGS "$<$<CONFIG:Release>:/O2> /fp:fast /arch:AVX2"
-            )
+            set_source_files_properties(${SSE_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "$<$<CONFIG:Release>:/O2> /fp:fast")
+            set_source_files_properties(${F16C_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "$<$<CONFIG:Release>:/O2> /fp:fast /arch:AVX")
+            set_source_files_properties(${PCLMUL_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "$<$<CONFIG:Release>:/O2>")
+            set_source_files_properties(${AVX2_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "$<$<CONFIG:Release>:/O2> /fp:fast /arch:AVX2")
+            set_source_files_properties(${AVX512_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "$<$<CONFIG:Release>:/O2> /fp:fast /arch:AVX512")
         else()
-            target_compile_options(${EXECUTABLE_NAME} PRIVATE -msse4.2 -mavx2)
-            set_source_files_properties(
-                ${SRC_DIR}/audio/analysis/fft/sse/fft_processor_sse.cpp
-                PROPERTIES COMPILE_FLAGS "-O3 -ffast-math -msse4.2 -mavx2"
-            )
+            foreach(target IN ITEMS ${EXECUTABLE_NAME} synesthesia_core synesthesia_bench)
+                target_compile_options(${target} PRIVATE -msse4.2)
+            endforeach()
+            set_source_files_properties(${SSE_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "-O3 -ffast-math -msse4.2")
+            set_source_files_properties(${F16C_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "-O3 -ffast-math -mavx -mf16c")
+            set_source_files_properties(${PCLMUL_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "-O3 -msse4.2 -mpclmul")
+            set_source_files_properties(${AVX2_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "-O3 -ffast-math -mavx2 -mfma -mf16c")
+            set_source_files_properties(${AVX512_KERNEL_SOURCES}
+                PROPERTIES COMPILE_FLAGS "-O3 -ffast-math -mavx512f -mavx2 -mfma -mf16c")
         endif()
 
         message(STATUS "Applied SSE/AVX-specific compiler optimisations")
@@ -97,8 +193,13 @@ function(apply_sse_optimisations)
 endfunction()
 
 function(apply_colour_accuracy_flags)
+    # The spectral descriptor kernels are here too: their spread pass must round the same way
+    # on every path, which fast-math reassociation or FMA contraction would break.
     set(COLOUR_SOURCE_FILES
         ${SRC_DIR}/colour/colour_core.cpp
+        ${SRC_DIR}/audio/analysis/fft/spectral_descriptors.cpp
+        ${SRC_DIR}/audio/analysis/fft/sse/spectral_descriptors_sse.cpp
+        ${SRC_DIR}/audio/analysis/fft/neon/spectral_descriptors_neon.cpp
     )
 
     if(MSVC)
@@ -113,3 +214,25 @@ function(apply_colour_accuracy_flags)
 
     message(STATUS "Applied strict floating-point flags to colour-critical files")
 endfunction()
+
+function(apply_fft_backends)
+    if(APPLE AND ENABLE_ACCELERATE_FFT)
+        find_library(ACCELERATE_FRAMEWORK Accelerate REQUIRED)
+        target_link_libraries(synesthesia_core PRIVATE ${ACCELERATE_FRAMEWORK})
+        target_compile_definitions(synesthesia_core PRIVATE SYN_FFT_ACCELERATE)
+        message(STATUS "FFT backend: Apple Accelerate vDSP")
+    endif()
+
+    if(ENABLE_FFTW)
+        find_path(FFTW_INCLUDE_DIR fftw3.h)
+        find_library(FFTW_FLOAT_LIBRARY NAMES fftw3f libfftw3f-3)
+        if(FFTW_INCLUDE_DIR AND FFTW_FLOAT_LIBRARY)
+            target_include_directories(synesthesia_core PRIVATE ${FFTW_INCLUDE_DIR})
+            target_link_libraries(synesthesia_core PRIVATE ${FFTW_FLOAT_LIBRARY})
+            target_compile_definitions(synesthesia_core PRIVATE SYN_FFT_FFTW)
+            message(STATUS "FFT backend: FFTW (${FFTW_FLOAT_LIBRARY})")
+        else()
+            message(WARNING "ENABLE_FFTW is set but single-precision FFTW was not found; using kissfft")
+        endif()
+    endif()
+endfunction()
@@ -34,6 +34,8 @@ list(APPEND SOURCES
     ${SRC_DIR}/renderer/main.cpp
     ${SRC_DIR}/renderer/bgfx_context.cpp
     ${SRC_DIR}/renderer/window.cpp
+    ${SRC_DIR}/renderer/frame_scheduler.cpp
+    ${SRC_DIR}/renderer/startup_profile.cpp
     ${SRC_DIR}/renderer/font_loader.cpp
     ${SRC_DIR}/renderer/imgui_impl_bgfx.cpp
     ${SRC_DIR}/renderer/presentation_resources.cpp
@@ -66,6 +68,8 @@ if(APPLE OR UNIX)
     list(APPEND SOURCES
         ${SRC_DIR}/utilities/cli/cli.cpp
         ${SRC_DIR}/utilities/cli/headless.cpp
+        ${SRC_DIR}/utilities/cli/terminal_renderer.cpp
+        ${SRC_DIR}/utilities/cli/multi_input_daemon.cpp
     )
     if(APPLE)
         message(STATUS "Added CLI sources to build for macOS")
@@ -112,7 +116,7 @@ elseif(APPLE)
         "-Wnull-dereference" "-Wdouble-promotion"
         "-Wmissing-include-dirs" "-Wundef" "-Wredundant-decls"
         "-Woverloaded-virtual" "-Wnon-virtual-dtor"
-        "-O3" "-ffast-math" "-march=native"
+        "-O3" "-ffast-math"
     )
 
     set_source_files_properties(${SRC_DIR}/renderer/styling/mac.mm PROPERTIES COMPILE_FLAGS "${OBJC_FLAGS}")
@@ -135,10 +139,11 @@ elseif(APPLE)
     set_property(SOURCE ${SRC_DIR}/osc/osc_sender.cpp APPEND PROPERTY COMPILE_OPTIONS "-Wno-c99-extensions")
     set_property(SOURCE ${SRC_DIR}/osc/synesthesia_osc_integration.cpp APPEND PROPERTY COMPILE_OPTIONS "-Wno-c99-extensions")
     set_property(SOURCE ${SRC_DIR}/utilities/cli/headless.cpp APPEND PROPERTY COMPILE_OPTIONS "-Wno-c99-extensions")
+    set_property(SOURCE ${SRC_DIR}/utilities/cli/multi_input_daemon.cpp APPEND PROPERTY COMPILE_OPTIONS "-Wno-c99-extensions")
 else()
     target_compile_options(${EXECUTABLE_NAME} PRIVATE
         "-Wall" "-Wextra" "-Wformat" "-Wpedantic"
-        "-O3" "-ffast-math" "-march=native"
+        "-O3" "-ffast-math"
     )
 endif()
 
@@ -166,13 +171,11 @@ if(APPLE)
         bx
         ${GLFW_TARGET}
         ${PORTAUDIO_TARGET}
-        nlohmann_json::nlohmann_json
+        synesthesia_core
         vendor_imgui
         vendor_implot
-        vendor_kissfft
         vendor_lodepng
         vendor_tinygltf
-        vendor_oscpack
         vendor_imgui_backends
         m
     )
@@ -187,15 +190,14 @@ elseif(WIN32)
         bx
         ${GLFW_TARGET}
         ${PORTAUDIO_TARGET}
-        nlohmann_json::nlohmann_json
+        synesthesia_core
         vendor_imgui
         vendor_implot
-        vendor_kissfft
         vendor_lodepng
         vendor_tinygltf
-        vendor_oscpack
         vendor_imgui_backends
         dwmapi
+        ole32
         windowsapp
     )
 
@@ -210,13 +212,11 @@ else()
         ${GLFW_TARGET}
         ${PORTAUDIO_TARGET}
         ${ALSA_LIBRARIES}
-        nlohmann_json::nlohmann_json
+        synesthesia_core
         vendor_imgui
         vendor_implot
-        vendor_kissfft
         vendor_lodepng
         vendor_tinygltf
-        vendor_oscpack
         vendor_imgui_backends
         dl
         pthread
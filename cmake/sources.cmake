@@ -1,25 +1,32 @@
-set(SOURCES
-    ${SRC_DIR}/main.cpp
+# Analysis, colour, encoding, decoding and OSC code with no window, GPU or audio device
+# dependency. It builds as the synesthesia_core library, which the application and the
+# benchmark executable link.
+set(CORE_SOURCES
+    ${SRC_DIR}/audio/analysis/fft/fft_backend.cpp
     ${SRC_DIR}/audio/analysis/fft/fft_processor.cpp
+    ${SRC_DIR}/audio/analysis/fft/stereo_fft_processor.cpp
+    ${SRC_DIR}/audio/analysis/fft/constant_q_processor.cpp
+    ${SRC_DIR}/audio/analysis/fft/spectral_descriptors.cpp
     ${SRC_DIR}/audio/analysis/phase/phase_features.cpp
     ${SRC_DIR}/audio/analysis/presentation/spectral_presentation.cpp
     ${SRC_DIR}/audio/analysis/presentation/sample_sequence.cpp
     ${SRC_DIR}/colour/colour_core.cpp
     ${SRC_DIR}/colour/colour_presentation.cpp
+    ${SRC_DIR}/colour/display_lut.cpp
     ${SRC_DIR}/audio/analysis/eq/equaliser.cpp
     ${SRC_DIR}/audio/analysis/eq/shared_eq_model.cpp
     ${SRC_DIR}/audio/analysis/loudness/loudness_meter.cpp
-    ${SRC_DIR}/audio/input/audio_input.cpp
-    ${SRC_DIR}/audio/output/audio_output.cpp
-    ${SRC_DIR}/audio/output/playback_equaliser.cpp
+    ${SRC_DIR}/audio/analysis/onset/transient_detector.cpp
     ${SRC_DIR}/audio/processing/audio_processor.cpp
     ${SRC_DIR}/audio/processing/dc_filter/dc_filter.cpp
+    ${SRC_DIR}/audio/processing/decimator/decimator.cpp
     ${SRC_DIR}/audio/processing/noise_gate/noise_gate.cpp
     ${SRC_DIR}/resyne/encoding/spectral/colour_native_codec.cpp
     ${SRC_DIR}/resyne/encoding/reconstruction/phase_wrapping.cpp
     ${SRC_DIR}/resyne/encoding/reconstruction/transient_detection.cpp
     ${SRC_DIR}/resyne/encoding/reconstruction/damage_detection.cpp
     ${SRC_DIR}/resyne/encoding/reconstruction/phase_locking.cpp
+    ${SRC_DIR}/resyne/encoding/reconstruction/peak_tracking.cpp
     ${SRC_DIR}/resyne/encoding/reconstruction/phase_vocoder.cpp
     ${SRC_DIR}/resyne/encoding/reconstruction/pghi.cpp
     ${SRC_DIR}/resyne/encoding/reconstruction/edit_detection.cpp
@@ -31,48 +38,87 @@ set(SOURCES
     ${SRC_DIR}/resyne/encoding/formats/rsyn_container.cpp
     ${SRC_DIR}/resyne/encoding/formats/rsyn_presentation.cpp
     ${SRC_DIR}/resyne/encoding/formats/rsyn_serialisation.cpp
+    ${SRC_DIR}/resyne/encoding/formats/spectral_sequence.cpp
     ${SRC_DIR}/resyne/encoding/formats/format_tiff.cpp
+    ${SRC_DIR}/resyne/encoding/formats/half_float.cpp
+    ${SRC_DIR}/resyne/encoding/formats/crc32.cpp
     ${SRC_DIR}/resyne/encoding/formats/format_rsyn.cpp
     ${SRC_DIR}/resyne/encoding/formats/format_wav.cpp
-    ${SRC_DIR}/resyne/encoding/formats/format_mp4.cpp
     ${SRC_DIR}/resyne/conversions/colour_space.cpp
     ${SRC_DIR}/resyne/encoding/audio/wav_encoder.cpp
+    ${SRC_DIR}/resyne/encoding/audio/wav_writer.cpp
+    ${SRC_DIR}/resyne/encoding/audio/inverse_stft.cpp
+    ${SRC_DIR}/resyne/encoding/audio/streaming_vocoder.cpp
     ${SRC_DIR}/resyne/decoding/wav_decoder_impl.cpp
+    ${SRC_DIR}/resyne/decoding/mapped_file.cpp
+    ${SRC_DIR}/resyne/decoding/audio_decoder.cpp
+    ${SRC_DIR}/resyne/decoding/decoder_wav.cpp
+    ${SRC_DIR}/resyne/decoding/decoder_flac.cpp
+    ${SRC_DIR}/resyne/decoding/decoder_mp3.cpp
+    ${SRC_DIR}/resyne/decoding/decoder_ogg.cpp
+    ${SRC_DIR}/resyne/decoding/parallel_decode.cpp
+    ${SRC_DIR}/resyne/recorder/loudness_utils.cpp
+    ${SRC_DIR}/ui/smoothing/smoothing.cpp
+    ${SRC_DIR}/ui/smoothing/offline_smoothing.cpp
+    ${SRC_DIR}/ui/smoothing/smoothing_features.cpp
+    ${SRC_DIR}/utilities/cpu/cpu_features.cpp
+    ${SRC_DIR}/utilities/profiling/frame_profiler.cpp
+    ${SRC_DIR}/utilities/telemetry/telemetry.cpp
+    ${SRC_DIR}/utilities/telemetry/telemetry_exporter.cpp
+    ${SRC_DIR}/utilities/telemetry/latency_probe.cpp
+    ${SRC_DIR}/utilities/threading/realtime_thread.cpp
+    ${SRC_DIR}/utilities/threading/task_scheduler.cpp
+    ${SRC_DIR}/utilities/tuning/wisdom.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/vendor/tinydng/miniz.c
+)
+
+set(SOURCES
+    ${SRC_DIR}/main.cpp
+    ${SRC_DIR}/audio/input/audio_input.cpp
+    ${SRC_DIR}/audio/input/input_capture.cpp
+    ${SRC_DIR}/audio/input/audio_stream_settings.cpp
+    ${SRC_DIR}/audio/input/audio_device_registry.cpp
+    ${SRC_DIR}/audio/output/audio_output.cpp
+    ${SRC_DIR}/audio/output/playback_stream.cpp
+    ${SRC_DIR}/audio/output/playback_equaliser.cpp
+    ${SRC_DIR}/resyne/encoding/formats/format_mp4.cpp
+    ${SRC_DIR}/resyne/encoding/formats/mp4_libav_writer.cpp
+    ${SRC_DIR}/resyne/encoding/formats/ycbcr_rows.cpp
     ${SRC_DIR}/ui/ui.cpp
     ${SRC_DIR}/ui/handlers/import_handler.cpp
     ${SRC_DIR}/ui/controls/controls.cpp
     ${SRC_DIR}/ui/device_manager/device_manager.cpp
     ${SRC_DIR}/ui/device_manager/device_selector.cpp
     ${SRC_DIR}/ui/updating/update.cpp
-    ${SRC_DIR}/ui/smoothing/smoothing.cpp
-    ${SRC_DIR}/ui/smoothing/smoothing_features.cpp
     ${SRC_DIR}/ui/styling/styling.cpp
     ${SRC_DIR}/ui/spectrum_analyser/spectrum_analyser.cpp
     ${SRC_DIR}/ui/sidebar/sidebar.cpp
+    ${SRC_DIR}/ui/audio_visualisation/live_presentation.cpp
     ${SRC_DIR}/ui/audio_visualisation/presentation_state.cpp
     ${SRC_DIR}/ui/audio_visualisation/visualisation_surface.cpp
     ${SRC_DIR}/ui/dragdrop/file_drop_manager.cpp
     ${SRC_DIR}/ui/input/trackpad_gestures.cpp
+    ${SRC_DIR}/ui/profiler/frame_profiler_overlay.cpp
     ${SRC_DIR}/utilities/midi/input/midi_input.cpp
     ${SRC_DIR}/utilities/midi/processing/midi_processor.cpp
     ${SRC_DIR}/utilities/midi/analysis/midi_analyser.cpp
     ${SRC_DIR}/utilities/midi/device_manager/midi_device_manager.cpp
     ${SRC_DIR}/utilities/video/ffmpeg_locator.cpp
-    ${CMAKE_CURRENT_SOURCE_DIR}/vendor/tinydng/miniz.c
-    ${SRC_DIR}/resyne/decoding/audio_decoder.cpp
-    ${SRC_DIR}/resyne/decoding/decoder_wav.cpp
-    ${SRC_DIR}/resyne/decoding/decoder_flac.cpp
-    ${SRC_DIR}/resyne/decoding/decoder_mp3.cpp
-    ${SRC_DIR}/resyne/decoding/decoder_ogg.cpp
     ${SRC_DIR}/resyne/recorder/recording.cpp
     ${SRC_DIR}/resyne/recorder/playback.cpp
     ${SRC_DIR}/resyne/recorder/dialogs.cpp
     ${SRC_DIR}/resyne/recorder/import.cpp
     ${SRC_DIR}/resyne/recorder/import_helpers.cpp
+    ${SRC_DIR}/resyne/recorder/import_queue.cpp
     ${SRC_DIR}/resyne/recorder/embedded_source_utils.cpp
-    ${SRC_DIR}/resyne/recorder/loudness_utils.cpp
     ${SRC_DIR}/resyne/recorder/reconstruction_utils.cpp
     ${SRC_DIR}/resyne/recorder/colour_cache_utils.cpp
+    ${SRC_DIR}/resyne/recorder/rsyn_hydration.cpp
+    ${SRC_DIR}/resyne/recorder/streaming_playback.cpp
+    ${SRC_DIR}/resyne/recorder/resident_spectral_store.cpp
+    ${SRC_DIR}/resyne/recorder/recording_capture.cpp
+    ${SRC_DIR}/resyne/recorder/spectral_journal.cpp
+    ${SRC_DIR}/resyne/recorder/memory_usage.cpp
     ${SRC_DIR}/resyne/ui/recorder/bottom_panel.cpp
     ${SRC_DIR}/resyne/ui/recorder/full_window.cpp
     ${SRC_DIR}/resyne/ui/recorder/export_dialog.cpp
@@ -93,26 +139,38 @@ set(SOURCES
     ${SRC_DIR}/renderer/imgui_window_context.cpp
     ${SRC_DIR}/renderer/detached_visualisation_window.cpp
     ${SRC_DIR}/utilities/cli/batch_exporter.cpp
+    ${SRC_DIR}/utilities/cli/batch_dataset_writer.cpp
+    ${SRC_DIR}/utilities/cli/gradient_png_writer.cpp
+    ${SRC_DIR}/utilities/cli/batch_export_cache.cpp
+    ${SRC_DIR}/utilities/cli/batch_memory_budget.cpp
+    ${SRC_DIR}/utilities/cli/batch_prefetcher.cpp
     ${SRC_DIR}/utilities/cli/misc/misc_commands.cpp
+    ${SRC_DIR}/utilities/cli/misc/misc_batch.cpp
     ${SRC_DIR}/utilities/cli/misc/presentation_export_utils.cpp
     ${SRC_DIR}/utilities/cli/misc/gltf_gradient_command.cpp
+    ${SRC_DIR}/utilities/cli/misc/glb_stream_writer.cpp
     ${SRC_DIR}/utilities/cli/misc/vector_gradient_command.cpp
+    ${SRC_DIR}/utilities/cli/misc/fft_benchmark_command.cpp
+    ${SRC_DIR}/utilities/cli/misc/benchmark_suite_command.cpp
+    ${SRC_DIR}/utilities/cli/misc/tune_command.cpp
 )
 
 
 function(add_osc_sources)
     if(ENABLE_OSC)
-        list(APPEND SOURCES
+        list(APPEND CORE_SOURCES
             ${SRC_DIR}/osc/osc_config.cpp
             ${SRC_DIR}/osc/osc_command_queue.cpp
             ${SRC_DIR}/osc/osc_frame_builder.cpp
+            ${SRC_DIR}/osc/osc_latency_histogram.cpp
             ${SRC_DIR}/osc/osc_packet_listener.cpp
             ${SRC_DIR}/osc/osc_receiver.cpp
             ${SRC_DIR}/osc/osc_runtime.cpp
             ${SRC_DIR}/osc/osc_sender.cpp
+            ${SRC_DIR}/osc/shared_memory_frame_output.cpp
             ${SRC_DIR}/osc/synesthesia_osc_integration.cpp
         )
-        set(SOURCES ${SOURCES} PARENT_SCOPE)
+        set(CORE_SOURCES ${CORE_SOURCES} PARENT_SCOPE)
         message(STATUS "Added OSC sources to build")
     endif()
 endfunction()
@@ -127,23 +185,16 @@ function(add_midi_sources)
     endif()
 endfunction()
 
-function(configure_include_directories)
-    target_include_directories(${EXECUTABLE_NAME} SYSTEM PRIVATE
+function(configure_core_include_directories)
+    target_include_directories(synesthesia_core SYSTEM PUBLIC
         ${CMAKE_CURRENT_SOURCE_DIR}/vendor/stb
-        ${CMAKE_CURRENT_SOURCE_DIR}/vendor/portable-file-dialogs
-        ${CMAKE_CURRENT_SOURCE_DIR}/vendor/lodepng
-        ${CMAKE_CURRENT_SOURCE_DIR}/vendor/tinygltf
         ${CMAKE_CURRENT_SOURCE_DIR}/vendor/dr_libs
         ${CMAKE_CURRENT_SOURCE_DIR}/vendor/tinydng
         ${CMAKE_CURRENT_SOURCE_DIR}/vendor/json/include
     )
 
-    target_include_directories(${EXECUTABLE_NAME} PRIVATE
-        ${IMGUI_DIR}
-        ${IMGUI_DIR}/backends
-        ${IMPLOT_DIR}
+    target_include_directories(synesthesia_core PUBLIC
         ${KISSFFT_DIR}
-        ${RTMIDI_DIR}
         ${SRC_DIR}
         ${SRC_DIR}/audio
         ${SRC_DIR}/audio/analysis
@@ -151,10 +202,9 @@ function(configure_include_directories)
         ${SRC_DIR}/audio/analysis/spectral
         ${SRC_DIR}/audio/analysis/eq
         ${SRC_DIR}/audio/analysis/loudness
-        ${SRC_DIR}/audio/input
-        ${SRC_DIR}/audio/output
         ${SRC_DIR}/audio/processing
         ${SRC_DIR}/audio/processing/dc_filter
+        ${SRC_DIR}/audio/processing/decimator
         ${SRC_DIR}/audio/processing/noise_gate
         ${SRC_DIR}/resyne/encoding
         ${SRC_DIR}/resyne/encoding/spectral
@@ -162,7 +212,33 @@ function(configure_include_directories)
         ${SRC_DIR}/resyne/encoding/formats
         ${SRC_DIR}/resyne/encoding/audio
         ${SRC_DIR}/resyne/conversions
+        ${SRC_DIR}/resyne/decoding
         ${SRC_DIR}/colour
+        ${SRC_DIR}/ui/smoothing
+    )
+
+    if(ENABLE_OSC)
+        target_include_directories(synesthesia_core PUBLIC
+            ${SRC_DIR}/osc
+            ${OSCPACK_DIR}
+        )
+    endif()
+endfunction()
+
+function(configure_include_directories)
+    target_include_directories(${EXECUTABLE_NAME} SYSTEM PRIVATE
+        ${CMAKE_CURRENT_SOURCE_DIR}/vendor/portable-file-dialogs
+        ${CMAKE_CURRENT_SOURCE_DIR}/vendor/lodepng
+        ${CMAKE_CURRENT_SOURCE_DIR}/vendor/tinygltf
+    )
+
+    target_include_directories(${EXECUTABLE_NAME} PRIVATE
+        ${IMGUI_DIR}
+        ${IMGUI_DIR}/backends
+        ${IMPLOT_DIR}
+        ${RTMIDI_DIR}
+        ${SRC_DIR}/audio/input
+        ${SRC_DIR}/audio/output
         ${SRC_DIR}/ui
         ${SRC_DIR}/renderer
         ${SRC_DIR}/renderer/styling
@@ -171,7 +247,6 @@ function(configure_include_directories)
         ${SRC_DIR}/ui/controls
         ${SRC_DIR}/ui/device_manager
         ${SRC_DIR}/ui/updating
-        ${SRC_DIR}/ui/smoothing
         ${SRC_DIR}/ui/styling
         ${SRC_DIR}/ui/styling/system_theme
         ${SRC_DIR}/ui/spectrum_analyser
@@ -180,7 +255,6 @@ function(configure_include_directories)
         ${SRC_DIR}/ui/input
         ${SRC_DIR}/resyne
         ${SRC_DIR}/resyne/controller
-        ${SRC_DIR}/resyne/decoding
         ${SRC_DIR}/resyne/recorder
         ${SRC_DIR}/resyne/ui
         ${SRC_DIR}/resyne/ui/recorder
@@ -196,11 +270,4 @@ function(configure_include_directories)
         ${CMAKE_BINARY_DIR}
         /opt/homebrew/include
     )
-
-    if(ENABLE_OSC)
-        target_include_directories(${EXECUTABLE_NAME} PRIVATE
-            ${SRC_DIR}/osc
-            ${OSCPACK_DIR}
-        )
-    endif()
 endfunction()
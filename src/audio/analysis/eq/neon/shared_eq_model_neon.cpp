@@ -0,0 +1,52 @@
+#include "shared_eq_model_neon.h"
+
+#ifdef __ARM_NEON
+
+#include <arm_neon.h>
+
+namespace AudioEQNEON {
+
+namespace {
+
+float32x4_t lanes3(const float first, const float second, const float third) {
+    const float values[4] = {first, second, third, 0.0f};
+    return vld1q_f32(values);
+}
+
+}
+
+void pipelineCascade(const AudioEQ::CascadeCoefficients& cascade,
+                     AudioEQ::CascadeState& state,
+                     float* samples,
+                     const std::size_t frames,
+                     const std::size_t stride,
+                     std::array<float, 2>& pending) {
+    // Lane 3 is idle; zero coefficients keep it at zero.
+    const float32x4_t b0 = lanes3(cascade.low.b0, cascade.mid.b0, cascade.high.b0);
+    const float32x4_t b1 = lanes3(cascade.low.b1, cascade.mid.b1, cascade.high.b1);
+    const float32x4_t b2 = lanes3(cascade.low.b2, cascade.mid.b2, cascade.high.b2);
+    const float32x4_t a1 = lanes3(cascade.low.a1, cascade.mid.a1, cascade.high.a1);
+    const float32x4_t a2 = lanes3(cascade.low.a2, cascade.mid.a2, cascade.high.a2);
+    float32x4_t z1 = lanes3(state.z1[0], state.z1[1], state.z1[2]);
+    float32x4_t z2 = lanes3(state.z2[0], state.z2[1], state.z2[2]);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    // Lane k of input feeds stage k; the stages' outputs shift up one lane for the next sample.
+    float32x4_t input = lanes3(0.0f, pending[0], pending[1]);
+    for (std::size_t frame = 2; frame < frames; ++frame) {
+        input = vsetq_lane_f32(samples[frame * stride], input, 0);
+        const float32x4_t output = vaddq_f32(vmulq_f32(b0, input), z1);
+        z1 = vaddq_f32(vsubq_f32(vmulq_f32(b1, input), vmulq_f32(a1, output)), z2);
+        z2 = vsubq_f32(vmulq_f32(b2, input), vmulq_f32(a2, output));
+        samples[(frame - 2) * stride] = vgetq_lane_f32(output, 2);
+        input = vextq_f32(zero, output, 3);
+    }
+
+    pending = {vgetq_lane_f32(input, 1), vgetq_lane_f32(input, 2)};
+    state.z1 = {vgetq_lane_f32(z1, 0), vgetq_lane_f32(z1, 1), vgetq_lane_f32(z1, 2)};
+    state.z2 = {vgetq_lane_f32(z2, 0), vgetq_lane_f32(z2, 1), vgetq_lane_f32(z2, 2)};
+}
+
+}
+
+#endif
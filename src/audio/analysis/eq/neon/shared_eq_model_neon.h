@@ -0,0 +1,19 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <array>
+#include <cstddef>
+
+#include "shared_eq_model.h"
+
+namespace AudioEQNEON {
+    // Steady state of AudioEQ::processBlock for frames >= 3; see AudioEQSSE::pipelineCascade.
+    void pipelineCascade(const AudioEQ::CascadeCoefficients& cascade,
+                         AudioEQ::CascadeState& state,
+                         float* samples,
+                         std::size_t frames,
+                         std::size_t stride,
+                         std::array<float, 2>& pending);
+}
+
+#endif
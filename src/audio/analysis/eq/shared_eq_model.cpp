@@ -4,6 +4,12 @@
 #include <cmath>
 #include <complex>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/shared_eq_model_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/shared_eq_model_sse.h"
+#endif
+
 namespace AudioEQ {
 
 namespace {
@@ -134,6 +140,42 @@ float processSample(const BiquadCoefficients& coefficients,
     return output;
 }
 
+void processBlock(const CascadeCoefficients& cascade,
+                  CascadeState& state,
+                  float* samples,
+                  const size_t frames,
+                  const size_t stride) {
+    if (samples == nullptr || frames == 0) {
+        return;
+    }
+
+    const auto low = [&](const float input) { return processSample(cascade.low, input, state.z1[0], state.z2[0]); };
+    const auto mid = [&](const float input) { return processSample(cascade.mid, input, state.z1[1], state.z2[1]); };
+    const auto high = [&](const float input) { return processSample(cascade.high, input, state.z1[2], state.z2[2]); };
+
+#if defined(USE_NEON_OPTIMISATIONS) || defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    if (frames >= 3) {
+        // Fill the pipeline: the low stage runs two samples ahead and the mid stage one.
+        const float firstLow = low(samples[0]);
+        std::array<float, 2> pending{low(samples[stride]), mid(firstLow)};
+#ifdef USE_NEON_OPTIMISATIONS
+        AudioEQNEON::pipelineCascade(cascade, state, samples, frames, stride, pending);
+#else
+        AudioEQSSE::pipelineCascade(cascade, state, samples, frames, stride, pending);
+#endif
+        // Drain it: the last two samples still have stages left to run.
+        samples[(frames - 2) * stride] = high(pending[1]);
+        samples[(frames - 1) * stride] = high(mid(pending[0]));
+        return;
+    }
+#endif
+
+    for (size_t frame = 0; frame < frames; ++frame) {
+        float& sample = samples[frame * stride];
+        sample = high(mid(low(sample)));
+    }
+}
+
 float cascadeMagnitudeResponse(const CascadeCoefficients& cascade,
                                const float frequency,
                                const float sampleRate) {
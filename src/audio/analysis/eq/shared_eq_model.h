@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <vector>
 
@@ -24,6 +25,12 @@ struct CascadeCoefficients {
     BiquadCoefficients high;
 };
 
+// Transposed direct form II state of the low, mid and high stages, in that order.
+struct CascadeState {
+    std::array<float, 3> z1{};
+    std::array<float, 3> z2{};
+};
+
 constexpr float kLowCrossoverHz = 200.0f;
 constexpr float kHighCrossoverHz = 1900.0f;
 constexpr float kMidCentreHz = 700.0f;
@@ -39,6 +46,16 @@ float processSample(const BiquadCoefficients& coefficients,
                     float& z1,
                     float& z2);
 
+// Filters frames samples spaced stride floats apart in place, so one channel of an
+// interleaved buffer can be run without deinterleaving it. The three stages are pipelined
+// across SIMD lanes where available, each stage running one sample behind the one before,
+// which leaves every stage's arithmetic as it would be sample by sample.
+void processBlock(const CascadeCoefficients& cascade,
+                  CascadeState& state,
+                  float* samples,
+                  size_t frames,
+                  size_t stride = 1);
+
 float cascadeMagnitudeResponse(const CascadeCoefficients& cascade,
                                float frequency,
                                float sampleRate);
@@ -0,0 +1,46 @@
+#include "shared_eq_model_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+namespace AudioEQSSE {
+
+void pipelineCascade(const AudioEQ::CascadeCoefficients& cascade,
+                     AudioEQ::CascadeState& state,
+                     float* samples,
+                     const std::size_t frames,
+                     const std::size_t stride,
+                     std::array<float, 2>& pending) {
+    // Lane 3 is idle; zero coefficients keep it at zero.
+    const __m128 b0 = _mm_setr_ps(cascade.low.b0, cascade.mid.b0, cascade.high.b0, 0.0f);
+    const __m128 b1 = _mm_setr_ps(cascade.low.b1, cascade.mid.b1, cascade.high.b1, 0.0f);
+    const __m128 b2 = _mm_setr_ps(cascade.low.b2, cascade.mid.b2, cascade.high.b2, 0.0f);
+    const __m128 a1 = _mm_setr_ps(cascade.low.a1, cascade.mid.a1, cascade.high.a1, 0.0f);
+    const __m128 a2 = _mm_setr_ps(cascade.low.a2, cascade.mid.a2, cascade.high.a2, 0.0f);
+    __m128 z1 = _mm_setr_ps(state.z1[0], state.z1[1], state.z1[2], 0.0f);
+    __m128 z2 = _mm_setr_ps(state.z2[0], state.z2[1], state.z2[2], 0.0f);
+
+    // Lane k of input feeds stage k; the stages' outputs shift up one lane for the next sample.
+    __m128 input = _mm_setr_ps(0.0f, pending[0], pending[1], 0.0f);
+    for (std::size_t frame = 2; frame < frames; ++frame) {
+        input = _mm_move_ss(input, _mm_set_ss(samples[frame * stride]));
+        const __m128 output = _mm_add_ps(_mm_mul_ps(b0, input), z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, input), _mm_mul_ps(a1, output)), z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(b2, input), _mm_mul_ps(a2, output));
+        samples[(frame - 2) * stride] = _mm_cvtss_f32(_mm_shuffle_ps(output, output, _MM_SHUFFLE(2, 2, 2, 2)));
+        input = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(output), 4));
+    }
+
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, input);
+    pending = {lanes[1], lanes[2]};
+    _mm_store_ps(lanes, z1);
+    state.z1 = {lanes[0], lanes[1], lanes[2]};
+    _mm_store_ps(lanes, z2);
+    state.z2 = {lanes[0], lanes[1], lanes[2]};
+}
+
+}
+
+#endif
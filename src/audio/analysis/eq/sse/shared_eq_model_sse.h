@@ -0,0 +1,23 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <array>
+#include <cstddef>
+
+#include "shared_eq_model.h"
+
+namespace AudioEQSSE {
+    // Steady state of AudioEQ::processBlock for frames >= 3. For each n from 2, lanes 0, 1
+    // and 2 run the low stage on sample n, the mid stage on the low output of n - 1 and the
+    // high stage on the mid output of n - 2, writing sample n - 2. pending holds the low
+    // output of n - 1 and the mid output of n - 2 on entry, and the same for n = frames on
+    // return; the last two samples are left for the caller to finish.
+    void pipelineCascade(const AudioEQ::CascadeCoefficients& cascade,
+                         AudioEQ::CascadeState& state,
+                         float* samples,
+                         std::size_t frames,
+                         std::size_t stride,
+                         std::array<float, 2>& pending);
+}
+
+#endif
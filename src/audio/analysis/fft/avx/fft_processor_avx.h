@@ -0,0 +1,30 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+#include "kiss_fftr.h"
+
+// 256- and 512-bit forms of the FFTProcessorSSE kernels, each compiled in its own file for
+// its own instruction set. FFTProcessorSSE calls them once Utilities::CPU says the machine
+// has it. Each returns how far it got, leaving the rest to the SSE path.
+namespace FFTProcessorAVX2 {
+    std::size_t applyHannWindow(float* output, const float* input, const float* window,
+                                std::size_t count);
+
+    // Bins [firstBin, lastBin] in whole vectors, adding into outMaxMagnitude and
+    // outTotalEnergy. Returns the first bin it did not handle.
+    std::size_t calculateBandMagnitudes(float* magnitudes, const kiss_fft_cpx* fft_output,
+                                        std::size_t firstBin, std::size_t lastBin,
+                                        float& outMaxMagnitude, float& outTotalEnergy);
+}
+
+namespace FFTProcessorAVX512 {
+    std::size_t applyHannWindow(float* output, const float* input, const float* window,
+                                std::size_t count);
+
+    std::size_t calculateBandMagnitudes(float* magnitudes, const kiss_fft_cpx* fft_output,
+                                        std::size_t firstBin, std::size_t lastBin,
+                                        float& outMaxMagnitude, float& outTotalEnergy);
+}
+
+#endif
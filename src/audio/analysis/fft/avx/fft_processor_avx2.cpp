@@ -0,0 +1,75 @@
+#include "fft_processor_avx.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+namespace FFTProcessorAVX2 {
+
+// Built with the AVX2 flags from optimisations.cmake; without them every kernel hands the
+// whole row back.
+#if defined(__AVX2__)
+
+std::size_t applyHannWindow(float* output, const float* input, const float* window,
+                            const std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(input + i), _mm256_loadu_ps(window + i)));
+    }
+    return i;
+}
+
+std::size_t calculateBandMagnitudes(float* magnitudes, const kiss_fft_cpx* fft_output,
+                                    const std::size_t firstBin, const std::size_t lastBin,
+                                    float& outMaxMagnitude, float& outTotalEnergy) {
+    __m256 energyVec = _mm256_setzero_ps();
+    __m256 maxVec = _mm256_setzero_ps();
+    std::size_t i = firstBin;
+
+    for (; i + 8 <= lastBin + 1; i += 8) {
+        // The in-lane shuffles leave bins in 0 1 4 5 2 3 6 7 order; only the stored
+        // magnitudes need putting back.
+        const __m256 low = _mm256_loadu_ps(&fft_output[i].r);
+        const __m256 high = _mm256_loadu_ps(&fft_output[i + 4].r);
+        const __m256 real = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 imag = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m256 power = _mm256_add_ps(_mm256_mul_ps(real, real), _mm256_mul_ps(imag, imag));
+        const __m256 magnitude = _mm256_sqrt_ps(power);
+        const __m256 ordered = _mm256_castpd_ps(
+            _mm256_permute4x64_pd(_mm256_castps_pd(magnitude), _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm256_storeu_ps(magnitudes + i, ordered);
+
+        energyVec = _mm256_add_ps(energyVec, power);
+        maxVec = _mm256_max_ps(maxVec, magnitude);
+    }
+
+    __m128 energy = _mm_add_ps(_mm256_castps256_ps128(energyVec), _mm256_extractf128_ps(energyVec, 1));
+    energy = _mm_add_ps(energy, _mm_movehl_ps(energy, energy));
+    energy = _mm_add_ss(energy, _mm_shuffle_ps(energy, energy, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    __m128 maximum = _mm_max_ps(_mm256_castps256_ps128(maxVec), _mm256_extractf128_ps(maxVec, 1));
+    maximum = _mm_max_ps(maximum, _mm_movehl_ps(maximum, maximum));
+    maximum = _mm_max_ss(maximum, _mm_shuffle_ps(maximum, maximum, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    outTotalEnergy += _mm_cvtss_f32(energy);
+    outMaxMagnitude = _mm_cvtss_f32(_mm_max_ss(maximum, _mm_set_ss(outMaxMagnitude)));
+    return i;
+}
+
+#else
+
+std::size_t applyHannWindow(float*, const float*, const float*, std::size_t) {
+    return 0;
+}
+
+std::size_t calculateBandMagnitudes(float*, const kiss_fft_cpx*, const std::size_t firstBin, std::size_t,
+                                    float&, float&) {
+    return firstBin;
+}
+
+#endif
+
+}
+
+#endif
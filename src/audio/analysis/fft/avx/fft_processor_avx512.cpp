@@ -0,0 +1,68 @@
+#include "fft_processor_avx.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+namespace FFTProcessorAVX512 {
+
+// Built with the AVX-512 flags from optimisations.cmake; without them every kernel hands
+// the whole row back.
+#if defined(__AVX512F__)
+
+std::size_t applyHannWindow(float* output, const float* input, const float* window,
+                            const std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_loadu_ps(input + i), _mm512_loadu_ps(window + i)));
+    }
+    return i;
+}
+
+std::size_t calculateBandMagnitudes(float* magnitudes, const kiss_fft_cpx* fft_output,
+                                    const std::size_t firstBin, const std::size_t lastBin,
+                                    float& outMaxMagnitude, float& outTotalEnergy) {
+    // Two loads hold sixteen bins; one two-source permute gathers the even floats and one
+    // the odd, already in bin order.
+    const __m512i realIndex = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i imagIndex = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    __m512 energyVec = _mm512_setzero_ps();
+    __m512 maxVec = _mm512_setzero_ps();
+    std::size_t i = firstBin;
+
+    for (; i + 16 <= lastBin + 1; i += 16) {
+        const __m512 low = _mm512_loadu_ps(&fft_output[i].r);
+        const __m512 high = _mm512_loadu_ps(&fft_output[i + 8].r);
+        const __m512 real = _mm512_permutex2var_ps(low, realIndex, high);
+        const __m512 imag = _mm512_permutex2var_ps(low, imagIndex, high);
+
+        const __m512 power = _mm512_add_ps(_mm512_mul_ps(real, real), _mm512_mul_ps(imag, imag));
+        const __m512 magnitude = _mm512_sqrt_ps(power);
+        _mm512_storeu_ps(magnitudes + i, magnitude);
+
+        energyVec = _mm512_add_ps(energyVec, power);
+        maxVec = _mm512_max_ps(maxVec, magnitude);
+    }
+
+    outTotalEnergy += _mm512_reduce_add_ps(energyVec);
+    const float maximum = _mm512_reduce_max_ps(maxVec);
+    outMaxMagnitude = maximum > outMaxMagnitude ? maximum : outMaxMagnitude;
+    return i;
+}
+
+#else
+
+std::size_t applyHannWindow(float*, const float*, const float*, std::size_t) {
+    return 0;
+}
+
+std::size_t calculateBandMagnitudes(float*, const kiss_fft_cpx*, const std::size_t firstBin, std::size_t,
+                                    float&, float&) {
+    return firstBin;
+}
+
+#endif
+
+}
+
+#endif
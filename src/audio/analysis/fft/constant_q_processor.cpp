@@ -0,0 +1,337 @@
+#include "constant_q_processor.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <numbers>
+
+#include "utilities/profiling/frame_profiler.h"
+#include "utilities/telemetry/telemetry.h"
+
+namespace {
+
+// Sum of e^(i * phi * m) for m in [0, length).
+std::complex<double> geometricSum(const double phi, const double length) {
+	const std::complex<double> denominator = 1.0 - std::polar(1.0, phi);
+	if (std::abs(denominator) < 1e-12) {
+		return length;
+	}
+	return (1.0 - std::polar(1.0, phi * length)) / denominator;
+}
+
+// DFT at angular frequency theta of a symmetric Hann window of windowSize samples that starts
+// offset samples into the frame. Hann is 0.5 - 0.25 e^(i a m) - 0.25 e^(-i a m), so this is
+// three geometric sums rather than a pass over the window.
+std::complex<double> hannSpectrum(const double theta, const double offset, const double windowSize) {
+	const double alpha = 2.0 * std::numbers::pi / (windowSize - 1.0);
+	const std::complex<double> sum = 0.5 * geometricSum(theta, windowSize) -
+		0.25 * geometricSum(theta + alpha, windowSize) -
+		0.25 * geometricSum(theta - alpha, windowSize);
+	return std::polar(1.0, theta * offset) * sum;
+}
+
+size_t countBins(const int binsPerOctave) {
+	const float octaves = std::log2(ConstantQProcessor::MAX_FREQ / ConstantQProcessor::MIN_FREQ);
+	return static_cast<size_t>(std::floor(octaves * static_cast<float>(binsPerOctave))) + 1;
+}
+
+}
+
+ConstantQProcessor::ConstantQProcessor(const int requestedBinsPerOctave)
+	: binsPerOctave(std::max(requestedBinsPerOctave, 1)),
+	  frequencies(countBins(binsPerOctave)),
+	  history(static_cast<size_t>(MAX_WINDOW_SIZE), 0.0f),
+	  hopAccumulator(static_cast<size_t>(HOP_SIZE), 0.0f),
+	  magnitudes(frequencies.size(), 0.0f),
+	  phases(frequencies.size(), 0.0f),
+	  previousMagnitudes(frequencies.size(), 0.0f),
+	  fluxHistory(FLUX_HISTORY_SIZE, 0.0f) {
+	for (size_t bin = 0; bin < frequencies.size(); ++bin) {
+		frequencies[bin] = MIN_FREQ * std::exp2(static_cast<float>(bin) / static_cast<float>(binsPerOctave));
+	}
+
+	frameRingBuffer.resize(FRAME_BUFFER_SIZE);
+	for (auto& frame : frameRingBuffer) {
+		frame.magnitudes.resize(frequencies.size());
+		frame.phases.resize(frequencies.size());
+	}
+}
+
+void ConstantQProcessor::setHopSize(const int hopSizeIn) {
+	const size_t clampedHop = static_cast<size_t>(std::clamp(hopSizeIn, 1, MAX_WINDOW_SIZE));
+	std::lock_guard<std::mutex> processingLock(processingMutex);
+	if (clampedHop == hopAccumulator.size()) {
+		return;
+	}
+	// Windows do not depend on the hop, so the history stays valid.
+	hopAccumulator.assign(clampedHop, 0.0f);
+	accumulatedSamples = 0;
+	hopSize.store(static_cast<int>(clampedHop), std::memory_order_relaxed);
+}
+
+void ConstantQProcessor::reset() {
+	std::lock_guard processingLock(processingMutex);
+
+	std::ranges::fill(history, 0.0f);
+	std::ranges::fill(hopAccumulator, 0.0f);
+	accumulatedSamples = 0;
+	loudnessMeter.reset();
+	std::ranges::fill(magnitudes, 0.0f);
+	std::ranges::fill(phases, 0.0f);
+	std::ranges::fill(previousMagnitudes, 0.0f);
+	std::ranges::fill(fluxHistory, 0.0f);
+	fluxHistoryIndex = 0;
+	spectralFlux = 0.0f;
+	onsetDetected = false;
+	frameCounter.store(0, std::memory_order_relaxed);
+
+	requestFrameDrain();
+}
+
+void ConstantQProcessor::processBuffer(const std::span<const float> buffer, const float sampleRate) {
+	processBuffer(ChannelView{buffer.data(), buffer.size(), 1}, sampleRate);
+}
+
+void ConstantQProcessor::processBuffer(const ChannelView samples, const float sampleRate) {
+	if (sampleRate <= 0.0f || samples.data == nullptr || samples.frameCount == 0)
+		return;
+	std::lock_guard processingLock(processingMutex);
+
+	if (kernelSampleRate != sampleRate) {
+		buildKernels(sampleRate);
+	}
+
+	size_t framePos = 0;
+	while (framePos < samples.frameCount) {
+		const size_t samplesNeeded = hopAccumulator.size() - accumulatedSamples;
+		const size_t samplesAvailable = samples.frameCount - framePos;
+		const size_t samplesToCopy = std::min(samplesNeeded, samplesAvailable);
+
+		float* destination = hopAccumulator.data() + accumulatedSamples;
+		const float* source = samples.data + framePos * samples.stride;
+		if (samples.stride == 1) {
+			std::copy_n(source, samplesToCopy, destination);
+		} else {
+			for (size_t i = 0; i < samplesToCopy; ++i) {
+				destination[i] = source[i * samples.stride];
+			}
+		}
+		loudnessMeter.processSamples(std::span<const float>(destination, samplesToCopy), sampleRate);
+		accumulatedSamples += samplesToCopy;
+		framePos += samplesToCopy;
+
+		if (accumulatedSamples == hopAccumulator.size()) {
+			processHop(sampleRate);
+			accumulatedSamples = 0;
+		}
+	}
+}
+
+// Brown & Puckette (1992), "An efficient algorithm for the calculation of a constant Q transform".
+// Bin k's coefficient is (1 / sum(w)) * sum(x[n] w[n] e^(-i omega n)) over its window, which
+// Parseval turns into (1 / (N sum(w))) * sum(X[j] conj(Y[j])) over the frame's spectrum, Y being
+// the DFT of the windowed exponential. Y is concentrated around the bin's frequency, so only the
+// taps near it are kept.
+void ConstantQProcessor::buildKernels(const float sampleRate) {
+	kernelSampleRate = sampleRate;
+	resolutions.clear();
+	binKernels.assign(frequencies.size(), BinKernel{});
+	kernelTaps.clear();
+
+	const double q = 1.0 / (std::exp2(1.0 / static_cast<double>(binsPerOctave)) - 1.0);
+	const double rate = static_cast<double>(sampleRate);
+	std::vector<std::pair<int, std::complex<double>>> candidates;
+
+	for (size_t bin = 0; bin < frequencies.size(); ++bin) {
+		const double frequency = static_cast<double>(frequencies[bin]);
+		const size_t windowSize = std::clamp(static_cast<size_t>(std::ceil(q * rate / frequency)),
+											 static_cast<size_t>(4), static_cast<size_t>(MAX_WINDOW_SIZE));
+		// Hann's main lobe spans two of its own bins either side; past Nyquist it would alias.
+		if (frequency + 2.0 * rate / static_cast<double>(windowSize) >= 0.5 * rate) {
+			continue;
+		}
+
+		const size_t frameSize = std::max(static_cast<size_t>(MIN_WINDOW_SIZE), std::bit_ceil(windowSize));
+		auto resolution = std::ranges::find(resolutions, frameSize, &Resolution::frameSize);
+		if (resolution == resolutions.end()) {
+			Resolution& added = resolutions.emplace_back();
+			added.frameSize = frameSize;
+			added.transform = FFTBackend::create(static_cast<int>(frameSize));
+			added.spectrum.resize(frameSize / 2 + 1);
+			resolution = resolutions.end() - 1;
+		}
+
+		const double frame = static_cast<double>(frameSize);
+		const double window = static_cast<double>(windowSize);
+		// The symmetric Hann window sums to (windowSize - 1) / 2.
+		const double scale = 1.0 / (frame * 0.5 * (window - 1.0));
+		const double centre = frequency * frame / rate;
+		// Hann's sidelobes fall below KERNEL_THRESHOLD within about eight of its own bins.
+		const int span = static_cast<int>(std::min(frame / 2.0, std::ceil(8.0 * frame / window) + 2.0));
+
+		candidates.clear();
+		double peak = 0.0;
+		for (int j = static_cast<int>(std::floor(centre)) - span; j <= static_cast<int>(std::ceil(centre)) + span; ++j) {
+			const double theta = 2.0 * std::numbers::pi * (frequency / rate - static_cast<double>(j) / frame);
+			const std::complex<double> tap = std::conj(hannSpectrum(theta, frame - window, window)) * scale;
+			peak = std::max(peak, std::abs(tap));
+			candidates.emplace_back(j, tap);
+		}
+
+		BinKernel& kernel = binKernels[bin];
+		kernel.resolution = static_cast<uint32_t>(resolution - resolutions.begin());
+		kernel.firstTap = static_cast<uint32_t>(kernelTaps.size());
+		const int half = static_cast<int>(frameSize / 2);
+		for (const auto& [j, tap] : candidates) {
+			if (std::abs(tap) < KERNEL_THRESHOLD * peak) {
+				continue;
+			}
+			// A real signal's spectrum at -j and N - j is the conjugate of the one at j.
+			const bool mirrored = j < 0 || j > half;
+			const int spectrumBin = j < 0 ? -j : (j > half ? static_cast<int>(frameSize) - j : j);
+			kernelTaps.push_back({static_cast<uint32_t>(spectrumBin),
+								  static_cast<float>(tap.real()),
+								  static_cast<float>(tap.imag()),
+								  mirrored ? -1.0f : 1.0f});
+		}
+		kernel.tapCount = static_cast<uint32_t>(kernelTaps.size()) - kernel.firstTap;
+	}
+}
+
+void ConstantQProcessor::processHop(const float sampleRate) {
+	SYN_PROFILE_SCOPE(FFTWindow);
+	const size_t hop = hopAccumulator.size();
+	std::copy(history.begin() + static_cast<std::ptrdiff_t>(hop), history.end(), history.begin());
+	std::copy(hopAccumulator.begin(), hopAccumulator.end(), history.end() - static_cast<std::ptrdiff_t>(hop));
+
+	for (Resolution& resolution : resolutions) {
+		resolution.transform->forward(std::span<const float>(history).last(resolution.frameSize),
+									  resolution.spectrum);
+	}
+
+	for (size_t bin = 0; bin < binKernels.size(); ++bin) {
+		const BinKernel& kernel = binKernels[bin];
+		if (kernel.tapCount == 0) {
+			magnitudes[bin] = 0.0f;
+			phases[bin] = 0.0f;
+			continue;
+		}
+
+		const kiss_fft_cpx* spectrum = resolutions[kernel.resolution].spectrum.data();
+		float real = 0.0f;
+		float imaginary = 0.0f;
+		for (uint32_t t = kernel.firstTap; t < kernel.firstTap + kernel.tapCount; ++t) {
+			const KernelTap& tap = kernelTaps[t];
+			const float valueReal = spectrum[tap.spectrumBin].r;
+			const float valueImaginary = spectrum[tap.spectrumBin].i * tap.imaginarySign;
+			real += valueReal * tap.real - valueImaginary * tap.imaginary;
+			imaginary += valueReal * tap.imaginary + valueImaginary * tap.real;
+		}
+		magnitudes[bin] = std::sqrt(real * real + imaginary * imaginary);
+		phases[bin] = std::atan2(imaginary, real);
+	}
+
+	updateSpectralFluxAndOnset();
+	frameCounter.fetch_add(1, std::memory_order_relaxed);
+	pushFrameToBuffer(sampleRate);
+}
+
+// Positive flux of the peak-normalised spectrum against a running maximum of the frames before
+// this one, as FFTProcessor measures it.
+void ConstantQProcessor::updateSpectralFluxAndOnset() {
+	const float peak = *std::ranges::max_element(magnitudes);
+	const float normalisation = peak > FFTProcessor::MAGNITUDE_EPSILON ? 1.0f / peak : 1.0f;
+
+	float flux = 0.0f;
+	for (size_t i = 0; i < magnitudes.size(); ++i) {
+		const float normalised = magnitudes[i] * normalisation;
+		flux += std::max(normalised - previousMagnitudes[i], 0.0f);
+		previousMagnitudes[i] = normalised;
+	}
+	flux /= static_cast<float>(magnitudes.size());
+
+	const float threshold = *std::ranges::max_element(fluxHistory) * ONSET_THRESHOLD_MULTIPLIER;
+	onsetDetected = flux > threshold && flux > 0.01f;
+	spectralFlux = flux;
+
+	fluxHistory[fluxHistoryIndex] = flux;
+	fluxHistoryIndex = (fluxHistoryIndex + 1) % FLUX_HISTORY_SIZE;
+}
+
+void ConstantQProcessor::pushFrameToBuffer(const float sampleRate) {
+	const size_t head = frameBufferHead.load(std::memory_order_relaxed);
+	const size_t nextHead = (head + 1) % FRAME_BUFFER_SIZE;
+
+	if (nextHead == frameBufferTail.load(std::memory_order_acquire)) {
+		droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+		Utilities::Telemetry::increment(Utilities::Telemetry::Counter::SpectrumFramesDropped);
+		return;
+	}
+
+	FFTProcessor::FFTFrame& frame = frameRingBuffer[head];
+	std::ranges::copy(magnitudes, frame.magnitudes.begin());
+	std::ranges::copy(phases, frame.phases.begin());
+	frame.frameCounter = frameCounter.load(std::memory_order_relaxed);
+	frame.sampleRate = sampleRate;
+	frame.loudnessLUFS = loudnessMeter.getMomentaryLoudness();
+	frame.spectralFlux = spectralFlux;
+	frame.onsetDetected = onsetDetected;
+
+	frameBufferHead.store(nextHead, std::memory_order_release);
+}
+
+void ConstantQProcessor::requestFrameDrain() {
+	frameBufferDrainHead.store(frameBufferHead.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	frameBufferDrainEpoch.fetch_add(1, std::memory_order_release);
+}
+
+size_t ConstantQProcessor::applyFrameDrain() const {
+	const uint64_t epoch = frameBufferDrainEpoch.load(std::memory_order_acquire);
+	if (epoch == consumerDrainEpoch) {
+		return frameBufferTail.load(std::memory_order_relaxed);
+	}
+	consumerDrainEpoch = epoch;
+	const size_t tail = frameBufferDrainHead.load(std::memory_order_relaxed);
+	frameBufferTail.store(tail, std::memory_order_release);
+	return tail;
+}
+
+size_t ConstantQProcessor::borrowBufferedFrames(std::vector<FrameView>& views, const size_t maxFrames) const {
+	views.clear();
+
+	const size_t head = frameBufferHead.load(std::memory_order_acquire);
+	const size_t tail = applyFrameDrain();
+	const size_t available = (head >= tail) ? (head - tail) : (FRAME_BUFFER_SIZE - tail + head);
+	const size_t count = std::min(available, maxFrames);
+
+	size_t current = tail;
+	for (size_t index = 0; index < count; ++index) {
+		const FFTProcessor::FFTFrame& frame = frameRingBuffer[current];
+		FrameView view;
+		view.magnitudes = frame.magnitudes;
+		view.phases = frame.phases;
+		view.frameCounter = frame.frameCounter;
+		view.sampleRate = frame.sampleRate;
+		view.loudnessLUFS = frame.loudnessLUFS;
+		view.spectralFlux = frame.spectralFlux;
+		view.onsetDetected = frame.onsetDetected;
+		views.push_back(view);
+		current = (current + 1) % FRAME_BUFFER_SIZE;
+	}
+
+	return count;
+}
+
+void ConstantQProcessor::releaseBufferedFrames(const size_t count) {
+	const size_t head = frameBufferHead.load(std::memory_order_acquire);
+	const uint64_t borrowedEpoch = consumerDrainEpoch;
+	const size_t tail = applyFrameDrain();
+	if (count == 0 || consumerDrainEpoch != borrowedEpoch) {
+		return;
+	}
+
+	const size_t available = (head >= tail) ? (head - tail) : (FRAME_BUFFER_SIZE - tail + head);
+	const size_t released = std::min(count, available);
+	frameBufferTail.store((tail + released) % FRAME_BUFFER_SIZE, std::memory_order_release);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "fft_backend.h"
+#include "fft_processor.h"
+#include "kiss_fftr.h"
+#include "loudness_meter.h"
+#include "constants.h"
+
+// Constant-Q analysis on the log-frequency axis logFrequencyToWavelength assumes, run alongside
+// FFTProcessor's fixed-resolution STFT. Bin k sits at MIN_FREQ * 2^(k / binsPerOctave) and
+// correlates the newest samples with a Hann-windowed complex exponential about Q cycles long.
+// Each correlation is a short sparse product with the spectrum of the smallest power-of-two
+// frame that holds its window (Brown & Puckette 1992), so one FFT per frame size serves every
+// bin assigned to it. Windows stop growing at MAX_WINDOW_SIZE, below which the bass keeps that
+// fixed resolution instead of its full Q.
+//
+// Every window ends at the newest sample, so a bin lags by half its own window: under a
+// millisecond at the top of the range, against half of MAX_WINDOW_SIZE for the deepest bass.
+// Magnitudes share FFTProcessor's normalisation, a sinusoid of amplitude A reading A / 2.
+class ConstantQProcessor {
+public:
+	static constexpr int BINS_PER_OCTAVE = 24;
+	static constexpr int HOP_SIZE = 512;
+	static constexpr int MIN_WINDOW_SIZE = 256;
+	static constexpr int MAX_WINDOW_SIZE = FFTProcessor::MAX_FFT_SIZE;
+	static constexpr float MIN_FREQ = synesthesia::constants::MIN_AUDIO_FREQ;
+	static constexpr float MAX_FREQ = synesthesia::constants::MAX_AUDIO_FREQ;
+	// Kernel taps below this fraction of a bin's strongest tap are dropped.
+	static constexpr float KERNEL_THRESHOLD = 1e-3f;
+	static constexpr size_t FRAME_BUFFER_SIZE = FFTProcessor::FRAME_BUFFER_SIZE;
+
+	using FrameView = FFTProcessor::FrameView;
+	using ChannelView = FFTProcessor::ChannelView;
+
+	explicit ConstantQProcessor(int binsPerOctave = BINS_PER_OCTAVE);
+
+	ConstantQProcessor(const ConstantQProcessor&) = delete;
+	ConstantQProcessor& operator=(const ConstantQProcessor&) = delete;
+	ConstantQProcessor(ConstantQProcessor&&) noexcept = delete;
+	ConstantQProcessor& operator=(ConstantQProcessor&&) noexcept = delete;
+
+	void processBuffer(std::span<const float> buffer, float sampleRate);
+	void processBuffer(ChannelView samples, float sampleRate);
+	void reset();
+	void setHopSize(int hopSize);
+	int getHopSize() const { return hopSize.load(std::memory_order_relaxed); }
+
+	// Bin centre frequencies in Hz, fixed for the processor's lifetime. Bins whose window would
+	// reach past Nyquist at the current sample rate read zero.
+	std::span<const float> getFrequencies() const { return frequencies; }
+	size_t getBinCount() const { return frequencies.size(); }
+	int getBinsPerOctave() const { return binsPerOctave; }
+	uint64_t getFrameCounter() const { return frameCounter.load(std::memory_order_relaxed); }
+
+	// Same single-producer/single-consumer contract as FFTProcessor's ring; views index getFrequencies().
+	size_t borrowBufferedFrames(std::vector<FrameView>& views, size_t maxFrames = FRAME_BUFFER_SIZE) const;
+	void releaseBufferedFrames(size_t count);
+	uint64_t getDroppedFrameCount() const { return droppedFrameCount.load(std::memory_order_relaxed); }
+
+private:
+	// One spectrum coefficient's contribution to a bin. imaginarySign is -1 for taps on the
+	// negative-frequency side, read through the conjugate symmetry of a real signal's spectrum.
+	struct KernelTap {
+		uint32_t spectrumBin;
+		float real;
+		float imaginary;
+		float imaginarySign;
+	};
+	struct BinKernel {
+		uint32_t resolution = 0;
+		uint32_t firstTap = 0;
+		uint32_t tapCount = 0;
+	};
+	struct Resolution {
+		size_t frameSize = 0;
+		std::unique_ptr<FFTBackend::RealTransform> transform;
+		std::vector<kiss_fft_cpx> spectrum;
+	};
+
+	int binsPerOctave;
+	std::vector<float> frequencies;
+
+	// processingMutex serialises the analysis thread and configuration changes.
+	mutable std::mutex processingMutex;
+
+	std::vector<Resolution> resolutions;
+	std::vector<BinKernel> binKernels;
+	std::vector<KernelTap> kernelTaps;
+	float kernelSampleRate = 0.0f;
+
+	// The newest MAX_WINDOW_SIZE samples, oldest first; every resolution reads its tail.
+	std::vector<float> history;
+	std::vector<float> hopAccumulator;
+	size_t accumulatedSamples = 0;
+	std::atomic<int> hopSize{HOP_SIZE};
+
+	LoudnessMeter loudnessMeter;
+	std::vector<float> magnitudes;
+	std::vector<float> phases;
+	std::vector<float> previousMagnitudes;
+	std::vector<float> fluxHistory;
+	size_t fluxHistoryIndex = 0;
+	float spectralFlux = 0.0f;
+	bool onsetDetected = false;
+	std::atomic<uint64_t> frameCounter{0};
+
+	static constexpr size_t FLUX_HISTORY_SIZE = 10;
+	static constexpr float ONSET_THRESHOLD_MULTIPLIER = 1.5f;
+
+	std::vector<FFTProcessor::FFTFrame> frameRingBuffer;
+	alignas(64) std::atomic<size_t> frameBufferHead{0};
+	// Consumer-owned, drained on request exactly as in FFTProcessor.
+	alignas(64) mutable std::atomic<size_t> frameBufferTail{0};
+	std::atomic<size_t> frameBufferDrainHead{0};
+	std::atomic<uint64_t> frameBufferDrainEpoch{0};
+	mutable uint64_t consumerDrainEpoch = 0;
+	std::atomic<uint64_t> droppedFrameCount{0};
+
+	void buildKernels(float sampleRate);
+	void processHop(float sampleRate);
+	void updateSpectralFluxAndOnset();
+	void pushFrameToBuffer(float sampleRate);
+	void requestFrameDrain();
+	size_t applyFrameDrain() const;
+};
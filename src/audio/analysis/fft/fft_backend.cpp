@@ -0,0 +1,496 @@
+#include "fft_backend.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(SYN_FFT_ACCELERATE)
+#include <Accelerate/Accelerate.h>
+#endif
+
+#if defined(SYN_FFT_FFTW)
+#include <fftw3.h>
+#endif
+
+namespace FFTBackend {
+
+namespace {
+
+class KissTransform final : public RealTransform {
+public:
+	explicit KissTransform(const int size)
+		: RealTransform(size),
+		  forwardConfig(kiss_fftr_alloc(size, 0, nullptr, nullptr)),
+		  inverseConfig(kiss_fftr_alloc(size, 1, nullptr, nullptr)) {
+		if (!forwardConfig || !inverseConfig) {
+			release();
+			throw std::runtime_error("Error allocating FFTR configuration.");
+		}
+	}
+
+	~KissTransform() override {
+		release();
+	}
+
+	Kind kind() const override { return Kind::KissFFT; }
+
+	void forward(std::span<const float> input, std::span<kiss_fft_cpx> output) override {
+		kiss_fftr(forwardConfig, input.data(), output.data());
+	}
+
+	void inverse(std::span<const kiss_fft_cpx> input, std::span<float> output) override {
+		kiss_fftri(inverseConfig, input.data(), output.data());
+	}
+
+private:
+	void release() {
+		if (forwardConfig) {
+			kiss_fftr_free(forwardConfig);
+			forwardConfig = nullptr;
+		}
+		if (inverseConfig) {
+			kiss_fftr_free(inverseConfig);
+			inverseConfig = nullptr;
+		}
+	}
+
+	kiss_fftr_cfg forwardConfig;
+	kiss_fftr_cfg inverseConfig;
+};
+
+class KissComplexTransform final : public ComplexTransform {
+public:
+	explicit KissComplexTransform(const int size)
+		: ComplexTransform(size),
+		  config(kiss_fft_alloc(size, 0, nullptr, nullptr)) {
+		if (!config) {
+			throw std::runtime_error("Error allocating FFT configuration.");
+		}
+	}
+
+	~KissComplexTransform() override {
+		kiss_fft_free(config);
+	}
+
+	Kind kind() const override { return Kind::KissFFT; }
+
+	void forward(std::span<const kiss_fft_cpx> input, std::span<kiss_fft_cpx> output) override {
+		kiss_fft(config, input.data(), output.data());
+	}
+
+private:
+	kiss_fft_cfg config;
+};
+
+#if defined(SYN_FFT_ACCELERATE)
+static_assert(std::is_same_v<kiss_fft_scalar, float>);
+
+// vDSP_fft_zrip packs DC into realp[0] and Nyquist into imagp[0], and its forward output is
+// twice the DFT. Both are undone here so callers see kissfft's layout and scale.
+class AccelerateTransform final : public RealTransform {
+public:
+	explicit AccelerateTransform(const int size)
+		: RealTransform(size),
+		  log2Size(static_cast<vDSP_Length>(std::log2(static_cast<double>(size)))),
+		  setup(vDSP_create_fftsetup(log2Size, kFFTRadix2)),
+		  realPart(static_cast<size_t>(size / 2)),
+		  imagPart(static_cast<size_t>(size / 2)) {
+		if (!setup) {
+			throw std::runtime_error("Error allocating vDSP FFT setup.");
+		}
+	}
+
+	~AccelerateTransform() override {
+		vDSP_destroy_fftsetup(setup);
+	}
+
+	Kind kind() const override { return Kind::Accelerate; }
+
+	void forward(std::span<const float> input, std::span<kiss_fft_cpx> output) override {
+		const size_t half = realPart.size();
+		DSPSplitComplex split{realPart.data(), imagPart.data()};
+		vDSP_ctoz(reinterpret_cast<const DSPComplex*>(input.data()), 2, &split, 1, half);
+		vDSP_fft_zrip(setup, &split, 1, log2Size, kFFTDirection_Forward);
+
+		output[0] = {realPart[0] * 0.5f, 0.0f};
+		output[half] = {imagPart[0] * 0.5f, 0.0f};
+		for (size_t k = 1; k < half; ++k) {
+			output[k] = {realPart[k] * 0.5f, imagPart[k] * 0.5f};
+		}
+	}
+
+	void inverse(std::span<const kiss_fft_cpx> input, std::span<float> output) override {
+		const size_t half = realPart.size();
+		realPart[0] = input[0].r;
+		imagPart[0] = input[half].r;
+		for (size_t k = 1; k < half; ++k) {
+			realPart[k] = input[k].r;
+			imagPart[k] = input[k].i;
+		}
+
+		DSPSplitComplex split{realPart.data(), imagPart.data()};
+		vDSP_fft_zrip(setup, &split, 1, log2Size, kFFTDirection_Inverse);
+		vDSP_ztoc(&split, 1, reinterpret_cast<DSPComplex*>(output.data()), 2, half);
+	}
+
+private:
+	vDSP_Length log2Size;
+	FFTSetup setup;
+	std::vector<float> realPart;
+	std::vector<float> imagPart;
+};
+
+// vDSP_fft_zip gives the plain DFT, so only the interleaved layout needs converting.
+class AccelerateComplexTransform final : public ComplexTransform {
+public:
+	explicit AccelerateComplexTransform(const int size)
+		: ComplexTransform(size),
+		  log2Size(static_cast<vDSP_Length>(std::log2(static_cast<double>(size)))),
+		  setup(vDSP_create_fftsetup(log2Size, kFFTRadix2)),
+		  realPart(static_cast<size_t>(size)),
+		  imagPart(static_cast<size_t>(size)) {
+		if (!setup) {
+			throw std::runtime_error("Error allocating vDSP FFT setup.");
+		}
+	}
+
+	~AccelerateComplexTransform() override {
+		vDSP_destroy_fftsetup(setup);
+	}
+
+	Kind kind() const override { return Kind::Accelerate; }
+
+	void forward(std::span<const kiss_fft_cpx> input, std::span<kiss_fft_cpx> output) override {
+		DSPSplitComplex split{realPart.data(), imagPart.data()};
+		vDSP_ctoz(reinterpret_cast<const DSPComplex*>(input.data()), 2, &split, 1, realPart.size());
+		vDSP_fft_zip(setup, &split, 1, log2Size, kFFTDirection_Forward);
+		vDSP_ztoc(&split, 1, reinterpret_cast<DSPComplex*>(output.data()), 2, realPart.size());
+	}
+
+private:
+	vDSP_Length log2Size;
+	FFTSetup setup;
+	std::vector<float> realPart;
+	std::vector<float> imagPart;
+};
+#endif
+
+#if defined(SYN_FFT_FFTW)
+static_assert(std::is_same_v<kiss_fft_scalar, float>);
+static_assert(sizeof(fftwf_complex) == sizeof(kiss_fft_cpx));
+
+// The FFTW planner is not thread-safe; execution on distinct plans is.
+std::mutex& fftwPlannerMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+// Plans are built against internal aligned buffers so execution can use SIMD paths and
+// the destructive c2r transform never touches caller data.
+class FFTWTransform final : public RealTransform {
+public:
+	explicit FFTWTransform(const int size)
+		: RealTransform(size),
+		  timeBuffer(fftwf_alloc_real(static_cast<size_t>(size))),
+		  freqBuffer(fftwf_alloc_complex(static_cast<size_t>(size / 2 + 1))) {
+		std::lock_guard<std::mutex> lock(fftwPlannerMutex());
+		if (timeBuffer && freqBuffer) {
+			forwardPlan = fftwf_plan_dft_r2c_1d(size, timeBuffer, freqBuffer, FFTW_ESTIMATE);
+			inversePlan = fftwf_plan_dft_c2r_1d(size, freqBuffer, timeBuffer, FFTW_ESTIMATE);
+		}
+		if (!forwardPlan || !inversePlan) {
+			releaseLocked();
+			throw std::runtime_error("Error allocating FFTW plans.");
+		}
+	}
+
+	~FFTWTransform() override {
+		std::lock_guard<std::mutex> lock(fftwPlannerMutex());
+		releaseLocked();
+	}
+
+	Kind kind() const override { return Kind::FFTW; }
+
+	void forward(std::span<const float> input, std::span<kiss_fft_cpx> output) override {
+		std::memcpy(timeBuffer, input.data(), static_cast<size_t>(fftSize) * sizeof(float));
+		fftwf_execute(forwardPlan);
+		std::memcpy(output.data(), freqBuffer, static_cast<size_t>(fftSize / 2 + 1) * sizeof(kiss_fft_cpx));
+	}
+
+	void inverse(std::span<const kiss_fft_cpx> input, std::span<float> output) override {
+		std::memcpy(freqBuffer, input.data(), static_cast<size_t>(fftSize / 2 + 1) * sizeof(kiss_fft_cpx));
+		fftwf_execute(inversePlan);
+		std::memcpy(output.data(), timeBuffer, static_cast<size_t>(fftSize) * sizeof(float));
+	}
+
+private:
+	void releaseLocked() {
+		if (forwardPlan) {
+			fftwf_destroy_plan(forwardPlan);
+			forwardPlan = nullptr;
+		}
+		if (inversePlan) {
+			fftwf_destroy_plan(inversePlan);
+			inversePlan = nullptr;
+		}
+		if (timeBuffer) {
+			fftwf_free(timeBuffer);
+			timeBuffer = nullptr;
+		}
+		if (freqBuffer) {
+			fftwf_free(freqBuffer);
+			freqBuffer = nullptr;
+		}
+	}
+
+	float* timeBuffer;
+	fftwf_complex* freqBuffer;
+	fftwf_plan forwardPlan = nullptr;
+	fftwf_plan inversePlan = nullptr;
+};
+
+class FFTWComplexTransform final : public ComplexTransform {
+public:
+	explicit FFTWComplexTransform(const int size)
+		: ComplexTransform(size),
+		  timeBuffer(fftwf_alloc_complex(static_cast<size_t>(size))),
+		  freqBuffer(fftwf_alloc_complex(static_cast<size_t>(size))) {
+		std::lock_guard<std::mutex> lock(fftwPlannerMutex());
+		if (timeBuffer && freqBuffer) {
+			forwardPlan = fftwf_plan_dft_1d(size, timeBuffer, freqBuffer, FFTW_FORWARD, FFTW_ESTIMATE);
+		}
+		if (!forwardPlan) {
+			releaseLocked();
+			throw std::runtime_error("Error allocating FFTW plans.");
+		}
+	}
+
+	~FFTWComplexTransform() override {
+		std::lock_guard<std::mutex> lock(fftwPlannerMutex());
+		releaseLocked();
+	}
+
+	Kind kind() const override { return Kind::FFTW; }
+
+	void forward(std::span<const kiss_fft_cpx> input, std::span<kiss_fft_cpx> output) override {
+		std::memcpy(timeBuffer, input.data(), static_cast<size_t>(fftSize) * sizeof(kiss_fft_cpx));
+		fftwf_execute(forwardPlan);
+		std::memcpy(output.data(), freqBuffer, static_cast<size_t>(fftSize) * sizeof(kiss_fft_cpx));
+	}
+
+private:
+	void releaseLocked() {
+		if (forwardPlan) {
+			fftwf_destroy_plan(forwardPlan);
+			forwardPlan = nullptr;
+		}
+		if (timeBuffer) {
+			fftwf_free(timeBuffer);
+			timeBuffer = nullptr;
+		}
+		if (freqBuffer) {
+			fftwf_free(freqBuffer);
+			freqBuffer = nullptr;
+		}
+	}
+
+	fftwf_complex* timeBuffer;
+	fftwf_complex* freqBuffer;
+	fftwf_plan forwardPlan = nullptr;
+};
+#endif
+
+std::optional<Kind> kindFromString(std::string value) {
+	std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
+		return static_cast<char>(std::tolower(c));
+	});
+	if (value == "kissfft" || value == "kiss") {
+		return Kind::KissFFT;
+	}
+	if (value == "accelerate" || value == "vdsp") {
+		return Kind::Accelerate;
+	}
+	if (value == "fftw") {
+		return Kind::FFTW;
+	}
+	return std::nullopt;
+}
+
+std::optional<Kind> readEnvironmentKind() {
+	const char* env = std::getenv("SYN_FFT_BACKEND");
+	if (env == nullptr || env[0] == '\0') {
+		return std::nullopt;
+	}
+
+	const std::optional<Kind> kind = kindFromString(env);
+	if (!kind) {
+		std::fprintf(stderr, "[fft] Ignoring unknown SYN_FFT_BACKEND='%s'\n", env);
+		return std::nullopt;
+	}
+	if (!isAvailable(*kind)) {
+		std::fprintf(stderr, "[fft] SYN_FFT_BACKEND='%s' is not built in, ignoring\n", env);
+		return std::nullopt;
+	}
+
+	return kind;
+}
+
+const std::optional<Kind>& environmentKind() {
+	static const std::optional<Kind> kind = readEnvironmentKind();
+	return kind;
+}
+
+std::mutex& preferenceMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+std::map<int, Kind>& preferences() {
+	static std::map<int, Kind> bySize;
+	return bySize;
+}
+
+[[maybe_unused]] bool isPowerOfTwo(const int value) {
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+}
+
+const char* name(const Kind kind) {
+	switch (kind) {
+		case Kind::KissFFT:
+			return "kissfft";
+		case Kind::Accelerate:
+			return "accelerate";
+		case Kind::FFTW:
+			return "fftw";
+	}
+	return "unknown";
+}
+
+bool isAvailable(const Kind kind) {
+	switch (kind) {
+		case Kind::KissFFT:
+			return true;
+		case Kind::Accelerate:
+#if defined(SYN_FFT_ACCELERATE)
+			return true;
+#else
+			return false;
+#endif
+		case Kind::FFTW:
+#if defined(SYN_FFT_FFTW)
+			return true;
+#else
+			return false;
+#endif
+	}
+	return false;
+}
+
+std::vector<Kind> availableKinds() {
+	std::vector<Kind> kinds;
+	for (const Kind kind : {Kind::KissFFT, Kind::Accelerate, Kind::FFTW}) {
+		if (isAvailable(kind)) {
+			kinds.push_back(kind);
+		}
+	}
+	return kinds;
+}
+
+Kind defaultKind() {
+	static const Kind kind = [] {
+		if (environmentKind()) {
+			return *environmentKind();
+		}
+		if (isAvailable(Kind::Accelerate)) {
+			return Kind::Accelerate;
+		}
+		if (isAvailable(Kind::FFTW)) {
+			return Kind::FFTW;
+		}
+		return Kind::KissFFT;
+	}();
+	return kind;
+}
+
+std::optional<Kind> kindFromName(const std::string& name) {
+	return kindFromString(name);
+}
+
+Kind preferredKind(const int fftSize) {
+	if (environmentKind()) {
+		return *environmentKind();
+	}
+	{
+		std::lock_guard<std::mutex> lock(preferenceMutex());
+		const auto found = preferences().find(fftSize);
+		if (found != preferences().end()) {
+			return found->second;
+		}
+	}
+	return defaultKind();
+}
+
+void setPreferredKind(const int fftSize, const Kind kind) {
+	if (!isAvailable(kind)) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(preferenceMutex());
+	preferences()[fftSize] = kind;
+}
+
+void clearPreferredKinds() {
+	std::lock_guard<std::mutex> lock(preferenceMutex());
+	preferences().clear();
+}
+
+std::unique_ptr<RealTransform> create(const int fftSize, const Kind kind) {
+#if defined(SYN_FFT_ACCELERATE)
+	// vDSP's radix-2 path needs a power of two; kissfft handles any even size.
+	if (kind == Kind::Accelerate && isPowerOfTwo(fftSize)) {
+		return std::make_unique<AccelerateTransform>(fftSize);
+	}
+#endif
+#if defined(SYN_FFT_FFTW)
+	if (kind == Kind::FFTW) {
+		return std::make_unique<FFTWTransform>(fftSize);
+	}
+#endif
+	(void)kind;
+	return std::make_unique<KissTransform>(fftSize);
+}
+
+std::unique_ptr<RealTransform> create(const int fftSize) {
+	return create(fftSize, preferredKind(fftSize));
+}
+
+std::unique_ptr<ComplexTransform> createComplex(const int fftSize, const Kind kind) {
+#if defined(SYN_FFT_ACCELERATE)
+	if (kind == Kind::Accelerate && isPowerOfTwo(fftSize)) {
+		return std::make_unique<AccelerateComplexTransform>(fftSize);
+	}
+#endif
+#if defined(SYN_FFT_FFTW)
+	if (kind == Kind::FFTW) {
+		return std::make_unique<FFTWComplexTransform>(fftSize);
+	}
+#endif
+	(void)kind;
+	return std::make_unique<KissComplexTransform>(fftSize);
+}
+
+std::unique_ptr<ComplexTransform> createComplex(const int fftSize) {
+	return createComplex(fftSize, preferredKind(fftSize));
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "kiss_fftr.h"
+
+namespace FFTBackend {
+
+enum class Kind {
+	KissFFT,
+	Accelerate,
+	FFTW
+};
+
+// Fixed-size real transform following kissfft's conventions so backends are interchangeable:
+// forward produces fftSize / 2 + 1 unnormalised bins, inverse returns fftSize * x.
+// Instances own scratch space and are not safe to share between threads.
+class RealTransform {
+public:
+	virtual ~RealTransform() = default;
+
+	RealTransform(const RealTransform&) = delete;
+	RealTransform& operator=(const RealTransform&) = delete;
+
+	virtual Kind kind() const = 0;
+	virtual void forward(std::span<const float> input, std::span<kiss_fft_cpx> output) = 0;
+	virtual void inverse(std::span<const kiss_fft_cpx> input, std::span<float> output) = 0;
+
+	int size() const { return fftSize; }
+
+protected:
+	explicit RealTransform(const int size) : fftSize(size) {}
+
+	int fftSize;
+};
+
+// Fixed-size forward complex transform with the same sign and scale as RealTransform:
+// fftSize unnormalised bins. Instances own scratch space and are not safe to share between
+// threads.
+class ComplexTransform {
+public:
+	virtual ~ComplexTransform() = default;
+
+	ComplexTransform(const ComplexTransform&) = delete;
+	ComplexTransform& operator=(const ComplexTransform&) = delete;
+
+	virtual Kind kind() const = 0;
+	virtual void forward(std::span<const kiss_fft_cpx> input, std::span<kiss_fft_cpx> output) = 0;
+
+	int size() const { return fftSize; }
+
+protected:
+	explicit ComplexTransform(const int size) : fftSize(size) {}
+
+	int fftSize;
+};
+
+const char* name(Kind kind);
+bool isAvailable(Kind kind);
+std::vector<Kind> availableKinds();
+
+// Fastest compiled-in backend unless SYN_FFT_BACKEND (kissfft, accelerate, fftw) names another.
+Kind defaultKind();
+std::optional<Kind> kindFromName(const std::string& name);
+
+// What create(fftSize) and createComplex(fftSize) build: the kind set for that size, usually
+// from a tuning run, else defaultKind(). SYN_FFT_BACKEND overrides both. Unavailable kinds
+// are not recorded.
+Kind preferredKind(int fftSize);
+void setPreferredKind(int fftSize, Kind kind);
+void clearPreferredKinds();
+
+// Unavailable kinds fall back to kissfft. Throws std::runtime_error if no plan can be built.
+std::unique_ptr<RealTransform> create(int fftSize, Kind kind);
+std::unique_ptr<RealTransform> create(int fftSize);
+std::unique_ptr<ComplexTransform> createComplex(int fftSize, Kind kind);
+std::unique_ptr<ComplexTransform> createComplex(int fftSize);
+
+}
@@ -1,97 +1,247 @@
 #include "fft_processor.h"
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <numbers>
 #include <numeric>
 #include <stdexcept>
+#include <utility>
 
-FFTProcessor::FFTProcessor()
-	: fft_in(FFT_SIZE),
-	  fft_out(FFT_SIZE / 2 + 1),
-	  hannWindow(FFT_SIZE),
-	  overlapBuffer(FFT_SIZE - HOP_SIZE, 0.0f),
-	  windowBuffer(FFT_SIZE, 0.0f),
-	  inputAccumulator(HOP_SIZE, 0.0f),
-	  accumulatedSamples(0),
-	  analysisHopSize(HOP_SIZE),
-	  overlapSize(FFT_SIZE - HOP_SIZE),
-	  magnitudesBuffer(FFT_SIZE / 2 + 1, 0.0f),
-	  rawMagnitudesBuffer(FFT_SIZE / 2 + 1, 0.0f),
-	  processedMagnitudesBuffer(FFT_SIZE / 2 + 1, 0.0f),
-	  spectralEnvelope(FFT_SIZE / 2 + 1, 0.0f),
-	  phaseBuffer(FFT_SIZE / 2 + 1, 0.0f),
+#include "utilities/profiling/frame_profiler.h"
+#include "utilities/telemetry/telemetry.h"
+#include "utilities/threading/task_scheduler.h"
+
+namespace {
+
+constexpr std::array<int, 5> SUPPORTED_FFT_SIZES = {512, 1024, 2048, 4096, 8192};
+
+// Hann window (also called Hanning window) - symmetric variant
+// Formula: w[n] = 0.5 * (1 - cos(2π * n / (N-1)))
+// Reduces spectral leakage in FFT analysis by smoothly tapering signal to zero at edges
+// Named after Austrian meteorologist Julius von Hann
+// https://en.wikipedia.org/wiki/Hann_function
+//
+// The table also carries the 2/N spectrum scale. Every supported N is a power of two, so
+// scaling the input instead of the output is exact in floating point: the transform's adds
+// and multiplies commute with it bit for bit, and the bins come out already normalised
+// without a pass over the spectrum.
+std::vector<float> buildAnalysisWindow(const int fftSize) {
+	const float scale = 2.0f / static_cast<float>(fftSize);
+	std::vector<float> window(static_cast<size_t>(fftSize));
+	for (size_t i = 0; i < window.size(); ++i) {
+		window[i] =
+			0.5f * (1.0f - std::cos(
+				2.0f * std::numbers::pi_v<float> * static_cast<float>(i) /
+				static_cast<float>(fftSize - 1))) * scale;
+	}
+	return window;
+}
+
+// Windows are read-only once built, so every processor of a given size shares one copy.
+// FFT plans carry scratch space and stay per instance.
+std::span<const float> analysisWindowFor(const int fftSize) {
+	static const std::array<std::vector<float>, SUPPORTED_FFT_SIZES.size()> windows = [] {
+		std::array<std::vector<float>, SUPPORTED_FFT_SIZES.size()> built;
+		for (size_t i = 0; i < SUPPORTED_FFT_SIZES.size(); ++i) {
+			built[i] = buildAnalysisWindow(SUPPORTED_FFT_SIZES[i]);
+		}
+		return built;
+	}();
+
+	for (size_t i = 0; i < SUPPORTED_FFT_SIZES.size(); ++i) {
+		if (SUPPORTED_FFT_SIZES[i] == fftSize) {
+			return windows[i];
+		}
+	}
+	return {};
+}
+
+int validatedFFTSize(const int fftSize) {
+	if (!FFTProcessor::isSupportedFFTSize(fftSize)) {
+		throw std::invalid_argument("Unsupported FFT size.");
+	}
+	return fftSize;
+}
+
+void windowFrame(const std::span<float> output, const std::span<const float> buffer, const std::span<const float> window) {
+	const size_t copySize = std::min({buffer.size(), output.size(), window.size()});
+	std::ranges::fill(output, 0.0f);
+
+#ifdef USE_NEON_OPTIMISATIONS
+	if (FFTProcessorNEON::isNEONAvailable() && copySize >= 4) {
+		FFTProcessorNEON::applyHannWindow(
+			std::span<float>(output.data(), copySize),
+			std::span<const float>(buffer.data(), copySize),
+			std::span<const float>(window.data(), copySize)
+		);
+	} else
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	if (FFTProcessorSSE::isSSEAvailable() && copySize >= 4) {
+		FFTProcessorSSE::applyHannWindow(
+			std::span<float>(output.data(), copySize),
+			std::span<const float>(buffer.data(), copySize),
+			std::span<const float>(window.data(), copySize)
+		);
+	} else
+#endif
+	{
+		for (size_t i = 0; i < copySize; ++i) {
+			output[i] = buffer[i] * window[i];
+		}
+	}
+}
+
+// Energy-preserving normalisation: 2/N for positive frequencies, which the analysis window
+// has already applied, and 1/N for DC and Nyquist since they have no negative-frequency
+// counterpart. Parseval's theorem then holds for magnitude squared. KissFFT and the other
+// backends are unnormalised, so this is the only scaling the spectrum gets.
+void normaliseSpectrum(const std::span<kiss_fft_cpx> spectrum) {
+	spectrum[0].r *= 0.5f;
+	spectrum[0].i *= 0.5f;
+	if (spectrum.size() > 1) {
+		spectrum[spectrum.size() - 1].r *= 0.5f;
+		spectrum[spectrum.size() - 1].i *= 0.5f;
+	}
+}
+
+// Bins strictly between DC and Nyquist whose centre frequency lies within the analysis band.
+// Empty when first > last.
+std::pair<size_t, size_t> analysisBandBins(const size_t binCount, const int fftSize, const float sampleRate) {
+	constexpr float MIN_FREQ = FFTProcessor::MIN_FREQ;
+	constexpr float MAX_FREQ = FFTProcessor::MAX_FREQ;
+
+	if (binCount < 3 || sampleRate <= 0.0f) {
+		return {1, 0};
+	}
+	const auto binFrequency = [&](const size_t bin) {
+		return static_cast<float>(bin) * sampleRate / static_cast<float>(fftSize);
+	};
+
+	size_t first = 1;
+	while (first < binCount - 1 && binFrequency(first) < MIN_FREQ) {
+		++first;
+	}
+	size_t last = std::min(binCount - 2, static_cast<size_t>(MAX_FREQ * static_cast<float>(fftSize) / sampleRate) + 1);
+	while (last >= first && binFrequency(last) > MAX_FREQ) {
+		--last;
+	}
+	return {first, last};
+}
+
+// Bins outside the analysis band, DC and Nyquist included, come out as zero.
+void computeRawMagnitudes(const std::span<const kiss_fft_cpx> spectrum, const int fftSize,
+						  const std::span<float> rawMagnitudes, const float sampleRate,
+						  float& outMaxMagnitude, float& outTotalEnergy) {
+	outMaxMagnitude = 0.0f;
+	outTotalEnergy = 0.0f;
+
+	const std::span<float> magnitudes = rawMagnitudes.first(std::min(rawMagnitudes.size(), spectrum.size()));
+	const auto [firstBin, lastBin] = analysisBandBins(magnitudes.size(), fftSize, sampleRate);
+	if (firstBin > lastBin) {
+		std::ranges::fill(magnitudes, 0.0f);
+		return;
+	}
+
+#ifdef USE_NEON_OPTIMISATIONS
+	if (FFTProcessorNEON::isNEONAvailable()) {
+		FFTProcessorNEON::calculateBandMagnitudes(magnitudes, spectrum.data(), firstBin, lastBin,
+												  outMaxMagnitude, outTotalEnergy);
+	} else
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	if (FFTProcessorSSE::isSSEAvailable()) {
+		FFTProcessorSSE::calculateBandMagnitudes(magnitudes, spectrum.data(), firstBin, lastBin,
+												 outMaxMagnitude, outTotalEnergy);
+	} else
+#endif
+	{
+		std::fill(magnitudes.begin(), magnitudes.begin() + static_cast<std::ptrdiff_t>(firstBin), 0.0f);
+		std::fill(magnitudes.begin() + static_cast<std::ptrdiff_t>(lastBin + 1), magnitudes.end(), 0.0f);
+		for (size_t i = firstBin; i <= lastBin; ++i) {
+			const float magnitudeSquared = spectrum[i].r * spectrum[i].r + spectrum[i].i * spectrum[i].i;
+			const float magnitude = std::sqrt(magnitudeSquared);
+			magnitudes[i] = magnitude;
+			outTotalEnergy += magnitudeSquared;
+			outMaxMagnitude = std::max(outMaxMagnitude, magnitude);
+		}
+	}
+}
+
+void computePhases(const std::span<const kiss_fft_cpx> spectrum, const std::span<float> phases) {
+	for (size_t i = 0; i < spectrum.size(); ++i) {
+		phases[i] = std::atan2(spectrum[i].i, spectrum[i].r);
+	}
+}
+
+}
+
+bool FFTProcessor::isSupportedFFTSize(const int fftSize) {
+	return std::ranges::find(SUPPORTED_FFT_SIZES, fftSize) != SUPPORTED_FFT_SIZES.end();
+}
+
+FFTProcessor::FFTProcessor(const int requestedFFTSize)
+	: fftSize(validatedFFTSize(requestedFFTSize)),
+	  fftTransform(FFTBackend::create(fftSize)),
+	  fft_in(static_cast<size_t>(fftSize)),
+	  fft_out(static_cast<size_t>(fftSize / 2 + 1)),
+	  analysisWindow(analysisWindowFor(fftSize)),
+	  history(static_cast<size_t>(fftSize), 0.0f),
+	  historyWrite(0),
+	  samplesSinceFrame(0),
+	  analysisHopSize(static_cast<size_t>(fftSize / 2)),
+	  pendingHopSize(static_cast<size_t>(fftSize / 2)),
+	  magnitudesBuffer(static_cast<size_t>(fftSize / 2 + 1), 0.0f),
+	  rawMagnitudesBuffer(static_cast<size_t>(fftSize / 2 + 1), 0.0f),
+	  processedMagnitudesBuffer(static_cast<size_t>(fftSize / 2 + 1), 0.0f),
+	  spectralEnvelope(static_cast<size_t>(fftSize / 2 + 1), 0.0f),
+	  phaseBuffer(static_cast<size_t>(fftSize / 2 + 1), 0.0f),
 	  currentLoudness(0.0f),
 	  momentaryLoudnessLUFS(-200.0f),
 	  totalEnergy(0.0f),
 	  maxMagnitude(0.0f),
 	  spectralFlux(0.0f),
 	  onsetDetected(false),
-	  previousMagnitudes(FFT_SIZE / 2 + 1, 0.0f),
+	  previousMagnitudes(static_cast<size_t>(fftSize / 2 + 1), 0.0f),
 	  fluxHistory(FLUX_HISTORY_SIZE, 0.0f),
 	  fluxHistoryIndex(0),
 	  frameCounter(0),
 	  criticalBandSmoothingEnabled(true),
 	  melWeightingEnabled(true) {
-	fft_cfg = kiss_fftr_alloc(FFT_SIZE, 0, nullptr, nullptr);
-	if (!fft_cfg) {
-		throw std::runtime_error("Error allocating FFTR configuration.");
-	}
-
+	const size_t binCount = getBinCount();
 	frameRingBuffer.resize(FRAME_BUFFER_SIZE);
 	for (auto& frame : frameRingBuffer) {
-		frame.magnitudes.resize(FFT_SIZE / 2 + 1);
-		frame.phases.resize(FFT_SIZE / 2 + 1);
-	}
-
-	// Hann window (also called Hanning window) - symmetric variant
-	// Formula: w[n] = 0.5 * (1 - cos(2π * n / (N-1)))
-	// Reduces spectral leakage in FFT analysis by smoothly tapering signal to zero at edges
-	// Named after Austrian meteorologist Julius von Hann
-	// https://en.wikipedia.org/wiki/Hann_function
-	for (size_t i = 0; i < hannWindow.size(); ++i) {
-		hannWindow[i] =
-			0.5f * (1.0f - std::cos(
-				2.0f * std::numbers::pi_v<float> * static_cast<float>(i) /
-				static_cast<float>(FFT_SIZE - 1)));
+		frame.magnitudes.resize(binCount);
+		frame.phases.resize(binCount);
 	}
-}
 
-FFTProcessor::~FFTProcessor() {
-	if (fft_cfg) {
-		kiss_fftr_free(fft_cfg);
-		fft_cfg = nullptr;
+	for (auto& published : publishedFrames) {
+		published.magnitudes.assign(binCount, 0.0f);
+		published.rawMagnitudes.assign(binCount, 0.0f);
+		published.phases.assign(binCount, 0.0f);
+		published.spectralEnvelope.assign(binCount, 0.0f);
+		published.state.hopSize = static_cast<int>(analysisHopSize);
 	}
 }
 
 uint64_t FFTProcessor::getFrameCounter() const {
-	std::lock_guard lock(dataMutex);
-	return frameCounter;
+	return getAnalysisState().frameCounter;
 }
 
 void FFTProcessor::setEQGains(const float low, const float mid, const float high) {
 	equaliser.setGains(low, mid, high);
+	binWeightsDirty.store(true, std::memory_order_release);
 }
 
+// The frame in progress still ends after the old hop; the new one counts from there. The
+// history, the loudness meter and the frame counter carry on, so the change leaves no gap.
 void FFTProcessor::setHopSize(const int hopSize) {
-	const size_t clampedHop = static_cast<size_t>(std::clamp(hopSize, 1, FFT_SIZE));
+	const size_t clampedHop = static_cast<size_t>(std::clamp(hopSize, 1, fftSize));
 	std::lock_guard<std::mutex> processingLock(processingMutex);
-	if (clampedHop == analysisHopSize) {
-		return;
-	}
-	analysisHopSize = clampedHop;
-	overlapSize = FFT_SIZE - analysisHopSize;
-	overlapBuffer.assign(overlapSize, 0.0f);
-	inputAccumulator.assign(analysisHopSize, 0.0f);
-	windowBuffer.assign(FFT_SIZE, 0.0f);
-	accumulatedSamples = 0;
-	loudnessMeter.reset();
-	{
-		std::lock_guard dataLock(dataMutex);
-		frameCounter = 0;
-		momentaryLoudnessLUFS = -200.0f;
-		currentLoudness = 0.0f;
+	pendingHopSize = clampedHop;
+	if (samplesSinceFrame == 0 && analysisHopSize != pendingHopSize) {
+		analysisHopSize = pendingHopSize;
+		publishFrame();
 	}
 }
 
@@ -106,36 +256,22 @@ float FFTProcessor::calculateMelWeight(const float frequency) {
 	return std::max(MEL_MIN_WEIGHT, melWeight);
 }
 
-void FFTProcessor::applyWindow(const std::span<const float> buffer) {
-	const size_t copySize = std::min(buffer.size(), static_cast<size_t>(FFT_SIZE));
-	std::ranges::fill(fft_in, 0.0f);
-
-#ifdef USE_NEON_OPTIMISATIONS
-	if (FFTProcessorNEON::isNEONAvailable() && copySize >= 4) {
-		FFTProcessorNEON::applyHannWindow(
-			std::span<float>(fft_in.data(), copySize),
-			std::span<const float>(buffer.data(), copySize),
-			std::span<const float>(hannWindow.data(), copySize)
-		);
-	} else
-#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
-	if (FFTProcessorSSE::isSSEAvailable() && copySize >= 4) {
-		FFTProcessorSSE::applyHannWindow(
-			std::span<float>(fft_in.data(), copySize),
-			std::span<const float>(buffer.data(), copySize),
-			std::span<const float>(hannWindow.data(), copySize)
-		);
-	} else
-#endif
-	{
-		for (size_t i = 0; i < copySize; ++i) {
-			fft_in[i] = buffer[i] * hannWindow[i];
-		}
-	}
+// Oldest sample first: the run from historyWrite to the end of the ring, then the run
+// before it.
+void FFTProcessor::applyWindow() {
+	const std::span<const float> samples(history);
+	const std::span<float> output(fft_in);
+	const size_t olderRun = samples.size() - historyWrite;
+	windowFrame(output.first(olderRun), samples.subspan(historyWrite), analysisWindow.first(olderRun));
+	windowFrame(output.subspan(olderRun), samples.first(historyWrite), analysisWindow.subspan(olderRun));
 }
 
 void FFTProcessor::processBuffer(const std::span<const float> buffer, const float sampleRate) {
-	if (sampleRate <= 0.0f || buffer.empty())
+	processBuffer(ChannelView{buffer.data(), buffer.size(), 1}, sampleRate);
+}
+
+void FFTProcessor::processBuffer(const ChannelView samples, const float sampleRate) {
+	if (sampleRate <= 0.0f || samples.data == nullptr || samples.frameCount == 0)
 		return;
 	std::lock_guard processingLock(processingMutex);
 
@@ -143,63 +279,57 @@ void FFTProcessor::processBuffer(const std::span<const float> buffer, const floa
 		initialiseCriticalBands(sampleRate);
 	}
 
-	size_t bufferPos = 0;
-	while (bufferPos < buffer.size()) {
-		const size_t samplesNeeded = analysisHopSize - accumulatedSamples;
-		const size_t samplesAvailable = buffer.size() - bufferPos;
-		const size_t samplesToCopy = std::min(samplesNeeded, samplesAvailable);
+	size_t framePos = 0;
+	while (framePos < samples.frameCount) {
+		const size_t samplesToCopy = std::min(historySpace(), samples.frameCount - framePos);
+		const bool frameReady =
+			appendHistory(samples.data + framePos * samples.stride, samples.stride, samplesToCopy, sampleRate);
+		framePos += samplesToCopy;
 
-		const std::span<const float> incoming(buffer.data() + bufferPos, samplesToCopy);
-		loudnessMeter.processSamples(incoming, sampleRate);
+		if (frameReady) {
+			processOverlappingWindow(sampleRate);
+			completeFrame();
+		}
+	}
+}
 
-		std::copy_n(buffer.begin() + static_cast<std::ptrdiff_t>(bufferPos), samplesToCopy,
-					inputAccumulator.begin() + static_cast<std::ptrdiff_t>(accumulatedSamples));
-		accumulatedSamples += samplesToCopy;
-		bufferPos += samplesToCopy;
+size_t FFTProcessor::historySpace() const {
+	return std::min(analysisHopSize - samplesSinceFrame, history.size() - historyWrite);
+}
 
-		if (accumulatedSamples == analysisHopSize) {
-			processOverlappingWindow(sampleRate);
-			accumulatedSamples = 0;
+bool FFTProcessor::appendHistory(const float* source, const size_t stride, const size_t count, const float sampleRate) {
+	float* destination = history.data() + historyWrite;
+	if (stride == 1) {
+		std::copy_n(source, count, destination);
+	} else {
+		for (size_t i = 0; i < count; ++i) {
+			destination[i] = source[i * stride];
 		}
 	}
+	loudnessMeter.processSamples(std::span<const float>(destination, count), sampleRate);
+	historyWrite = (historyWrite + count) % history.size();
+	samplesSinceFrame += count;
+	return samplesSinceFrame == analysisHopSize;
+}
+
+void FFTProcessor::completeFrame() {
+	samplesSinceFrame = 0;
+	analysisHopSize = pendingHopSize;
 }
 
-// Applies energy-preserving FFT normalisation
-// DC and Nyquist bins get 1/N scaling, positive frequency bins get 2/N
 void FFTProcessor::normalizeFFTOutput() {
-	// FFT normalisation convention: Scale by 2/N for positive frequencies
-	// DC (bin 0) and Nyquist (bin N/2) get additional 0.5x since they lack complex conjugates
-	// This gives energy-preserving normalisation: Parseval's theorem holds for magnitude²
-	// Reference: KissFFT uses unnormalized FFT, so we apply 1/N scaling here
-	// Positive frequency bins: 2/N (to account for negative frequencies folded in real FFT)
-	// DC and Nyquist bins: 1/N (no negative frequency counterpart)
-	constexpr float scaleFactor = 2.0f / FFT_SIZE;
-	for (auto& i : fft_out) {
-		i.r *= scaleFactor;
-		i.i *= scaleFactor;
-	}
-	fft_out[0].r *= 0.5f;
-	fft_out[0].i *= 0.5f;
-	if (fft_out.size() > 1) {
-		fft_out[fft_out.size() - 1].r *= 0.5f;
-		fft_out[fft_out.size() - 1].i *= 0.5f;
-	}
+	normaliseSpectrum(fft_out);
 }
 
 float FFTProcessor::updateLoudnessMetrics() {
 	const float lufs = loudnessMeter.getMomentaryLoudness();
-	{
-		std::lock_guard lock(dataMutex);
-		momentaryLoudnessLUFS = lufs;
-	}
+	momentaryLoudnessLUFS = lufs;
 	return std::clamp((lufs + LUFS_NORMALISATION_OFFSET) / LUFS_NORMALISATION_OFFSET, 0.0f, 1.0f);
 }
 
 void FFTProcessor::updateSpectralData(const std::vector<float>& rawMagnitudes,
 									  const float sampleRate, const float frameMaxMagnitude,
 									  const float frameTotalEnergy, const float normalisedLoudness) {
-	std::lock_guard lock(dataMutex);
-
 	rawMagnitudesBuffer = rawMagnitudes;
 	magnitudesBuffer = processedMagnitudesBuffer;
 	currentLoudness = currentLoudness * (1.0f - LOUDNESS_SMOOTHING) + normalisedLoudness * LOUDNESS_SMOOTHING;
@@ -208,23 +338,17 @@ void FFTProcessor::updateSpectralData(const std::vector<float>& rawMagnitudes,
 	++frameCounter;
 
 	pushFrameToBuffer(rawMagnitudesBuffer, phaseBuffer, sampleRate);
+	publishFrame();
 }
 
 void FFTProcessor::processOverlappingWindow(const float sampleRate) {
-	if (overlapSize > 0) {
-		std::copy(overlapBuffer.begin(), overlapBuffer.end(), windowBuffer.begin());
-	}
-	std::copy(inputAccumulator.begin(),
-			  inputAccumulator.end(),
-			  windowBuffer.begin() + static_cast<std::ptrdiff_t>(overlapSize));
-	if (overlapSize > 0) {
-		std::copy(windowBuffer.begin() + static_cast<std::ptrdiff_t>(analysisHopSize),
-				  windowBuffer.end(),
-				  overlapBuffer.begin());
-	}
+	SYN_PROFILE_SCOPE(FFTWindow);
+	applyWindow();
+	fftTransform->forward(fft_in, fft_out);
+	analyseSpectrum(sampleRate);
+}
 
-	applyWindow(windowBuffer);
-	kiss_fftr(fft_cfg, fft_in.data(), fft_out.data());
+void FFTProcessor::analyseSpectrum(const float sampleRate) {
 	normalizeFFTOutput();
 
 	const size_t binCount = fft_out.size();
@@ -248,58 +372,111 @@ void FFTProcessor::processOverlappingWindow(const float sampleRate) {
 	updateSpectralData(rawMagnitudes, sampleRate, frameMaxMagnitude, frameTotalEnergy, normalisedLoudness);
 }
 
+void FFTProcessor::publishFrame() {
+	PublishedFrame& published = publishedFrames[nextPublishedFrame];
+	const uint32_t sequence = published.sequence.load(std::memory_order_relaxed);
+	published.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	std::copy_n(magnitudesBuffer.begin(), std::min(magnitudesBuffer.size(), published.magnitudes.size()),
+				published.magnitudes.begin());
+	std::copy_n(rawMagnitudesBuffer.begin(), std::min(rawMagnitudesBuffer.size(), published.rawMagnitudes.size()),
+				published.rawMagnitudes.begin());
+	std::copy_n(phaseBuffer.begin(), std::min(phaseBuffer.size(), published.phases.size()),
+				published.phases.begin());
+	std::copy_n(spectralEnvelope.begin(), std::min(spectralEnvelope.size(), published.spectralEnvelope.size()),
+				published.spectralEnvelope.begin());
+
+	published.state.frameCounter = frameCounter;
+	published.state.momentaryLoudnessLUFS = momentaryLoudnessLUFS;
+	published.state.currentLoudness = currentLoudness;
+	published.state.totalEnergy = totalEnergy;
+	published.state.maxMagnitude = maxMagnitude;
+	published.state.spectralFlux = spectralFlux;
+	published.state.hopSize = static_cast<int>(analysisHopSize);
+	published.state.onsetDetected = onsetDetected;
+
+	published.sequence.store(sequence + 2, std::memory_order_release);
+	publishedFrameIndex.store(nextPublishedFrame, std::memory_order_release);
+	nextPublishedFrame = (nextPublishedFrame + 1) % PUBLISHED_FRAME_SLOTS;
+}
+
+template <typename Reader>
+void FFTProcessor::readPublishedFrame(Reader&& reader) const {
+	while (true) {
+		const PublishedFrame& published = publishedFrames[publishedFrameIndex.load(std::memory_order_acquire)];
+		const uint32_t sequence = published.sequence.load(std::memory_order_acquire);
+		if ((sequence & 1U) != 0U) {
+			continue;
+		}
+
+		reader(published);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (published.sequence.load(std::memory_order_relaxed) == sequence) {
+			return;
+		}
+	}
+}
+
+FFTProcessor::AnalysisState FFTProcessor::getAnalysisState() const {
+	AnalysisState state;
+	readPublishedFrame([&](const PublishedFrame& published) {
+		state = published.state;
+	});
+	return state;
+}
+
 std::vector<float> FFTProcessor::getSpectralEnvelope() const {
-	std::lock_guard lock(dataMutex);
-	return spectralEnvelope;
+	std::vector<float> envelope;
+	readPublishedFrame([&](const PublishedFrame& published) {
+		envelope.assign(published.spectralEnvelope.begin(), published.spectralEnvelope.end());
+	});
+	return envelope;
 }
 
 std::vector<float> FFTProcessor::getMagnitudesBuffer() const {
-	std::lock_guard lock(dataMutex);
-	return magnitudesBuffer;
+	std::vector<float> magnitudes;
+	readPublishedFrame([&](const PublishedFrame& published) {
+		magnitudes.assign(published.magnitudes.begin(), published.magnitudes.end());
+	});
+	return magnitudes;
 }
 
 std::vector<float> FFTProcessor::getRawMagnitudesBuffer() const {
-	std::lock_guard lock(dataMutex);
-	return rawMagnitudesBuffer;
+	std::vector<float> rawMagnitudes;
+	readPublishedFrame([&](const PublishedFrame& published) {
+		rawMagnitudes.assign(published.rawMagnitudes.begin(), published.rawMagnitudes.end());
+	});
+	return rawMagnitudes;
 }
 
 std::vector<float> FFTProcessor::getPhaseBuffer() const {
-	std::lock_guard lock(dataMutex);
-	return phaseBuffer;
+	std::vector<float> phases;
+	readPublishedFrame([&](const PublishedFrame& published) {
+		phases.assign(published.phases.begin(), published.phases.end());
+	});
+	return phases;
 }
 
 void FFTProcessor::copyProcessedFrame(std::vector<float>& magnitudes,
 									  std::vector<float>& phases,
 									  AnalysisState& state) const {
-	std::lock_guard processingLock(processingMutex);
-	std::lock_guard lock(dataMutex);
-	magnitudes = magnitudesBuffer;
-	phases = phaseBuffer;
-	state.frameCounter = frameCounter;
-	state.momentaryLoudnessLUFS = momentaryLoudnessLUFS;
-	state.currentLoudness = currentLoudness;
-	state.totalEnergy = totalEnergy;
-	state.maxMagnitude = maxMagnitude;
-	state.spectralFlux = spectralFlux;
-	state.hopSize = static_cast<int>(analysisHopSize);
-	state.onsetDetected = onsetDetected;
+	readPublishedFrame([&](const PublishedFrame& published) {
+		magnitudes.assign(published.magnitudes.begin(), published.magnitudes.end());
+		phases.assign(published.phases.begin(), published.phases.end());
+		state = published.state;
+	});
 }
 
 void FFTProcessor::copyRawFrame(std::vector<float>& rawMagnitudes,
 								std::vector<float>& phases,
 								AnalysisState& state) const {
-	std::lock_guard processingLock(processingMutex);
-	std::lock_guard lock(dataMutex);
-	rawMagnitudes = rawMagnitudesBuffer;
-	phases = phaseBuffer;
-	state.frameCounter = frameCounter;
-	state.momentaryLoudnessLUFS = momentaryLoudnessLUFS;
-	state.currentLoudness = currentLoudness;
-	state.totalEnergy = totalEnergy;
-	state.maxMagnitude = maxMagnitude;
-	state.spectralFlux = spectralFlux;
-	state.hopSize = static_cast<int>(analysisHopSize);
-	state.onsetDetected = onsetDetected;
+	readPublishedFrame([&](const PublishedFrame& published) {
+		rawMagnitudes.assign(published.rawMagnitudes.begin(), published.rawMagnitudes.end());
+		phases.assign(published.phases.begin(), published.phases.end());
+		state = published.state;
+	});
 }
 
 void FFTProcessor::processMagnitudes(std::vector<float>& magnitudes, const float sampleRate,
@@ -307,11 +484,14 @@ void FFTProcessor::processMagnitudes(std::vector<float>& magnitudes, const float
 	const float normalisationFactor =
 		referenceMaxMagnitude > MAGNITUDE_EPSILON ? 1.0f / referenceMaxMagnitude : 1.0f;
 
+	if (binWeightsDirty.exchange(false, std::memory_order_acq_rel) || binWeightsSampleRate != sampleRate) {
+		rebuildBinWeights(sampleRate);
+	}
+
 	std::ranges::fill(spectralEnvelope, 0.0f);
 
-	const size_t minBinIndex = std::max(static_cast<size_t>(1), static_cast<size_t>(MIN_FREQ * FFT_SIZE / sampleRate));
-	const size_t maxBinIndex =
-		std::min(static_cast<size_t>(MAX_FREQ * FFT_SIZE / sampleRate) + 1, fft_out.size() - 1);
+	const size_t minBinIndex = weightedMinBin;
+	const size_t maxBinIndex = weightedMaxBin;
 	float envelopeEnergy = 0.0f;
 	for (size_t i = minBinIndex; i <= maxBinIndex; ++i) {
 		const float energy = fft_out[i].r * fft_out[i].r + fft_out[i].i * fft_out[i].i;
@@ -325,11 +505,23 @@ void FFTProcessor::processMagnitudes(std::vector<float>& magnitudes, const float
 		}
 	}
 
+	const float* weights = binWeights.data();
 	for (size_t i = minBinIndex; i <= maxBinIndex; ++i) {
 		magnitudes[i] =
-			std::sqrt(fft_out[i].r * fft_out[i].r + fft_out[i].i * fft_out[i].i) * normalisationFactor;
+			std::sqrt(fft_out[i].r * fft_out[i].r + fft_out[i].i * fft_out[i].i) * normalisationFactor * weights[i];
 	}
 
+	SYN_PROFILE_SCOPE(CriticalBandSmoothing);
+	applyCriticalBandSmoothing(magnitudes);
+}
+
+void FFTProcessor::rebuildBinWeights(const float sampleRate) {
+	binWeightsSampleRate = sampleRate;
+	binWeights.assign(fft_out.size(), 0.0f);
+	weightedMinBin = std::max(static_cast<size_t>(1), static_cast<size_t>(MIN_FREQ * static_cast<float>(fftSize) / sampleRate));
+	weightedMaxBin =
+		std::min(static_cast<size_t>(MAX_FREQ * static_cast<float>(fftSize) / sampleRate) + 1, fft_out.size() - 1);
+
 	// Apply mel-scale perceptual weighting to magnitudes.
 	// Mel-scale reflects human pitch perception: linear below 1 kHz, logarithmic above.
 	// The derivative dm/df gives perceptual resolution, emphasising frequencies where
@@ -342,111 +534,82 @@ void FFTProcessor::processMagnitudes(std::vector<float>& magnitudes, const float
 	// Reference: Malcolm Slaney, "Auditory Toolbox: A MATLAB Toolbox for Auditory
 	// Modeling Work", Technical Report #1998-010, Interval Research Corporation, 1998.
 	// https://engineering.purdue.edu/~malcolm/apple/tr45/AuditoryToolboxTechReport.pdf
-	if (melWeightingEnabled) {
-		for (size_t i = minBinIndex; i <= maxBinIndex; ++i) {
-			const float freq = static_cast<float>(i) * sampleRate / FFT_SIZE;
-			const float melWeight = calculateMelWeight(freq);
-			magnitudes[i] *= melWeight;
-		}
+	for (size_t i = weightedMinBin; i <= weightedMaxBin; ++i) {
+		const float freq = static_cast<float>(i) * sampleRate / static_cast<float>(fftSize);
+		binWeights[i] = melWeightingEnabled ? calculateMelWeight(freq) : 1.0f;
 	}
 
-	equaliser.applyEQ(magnitudes, sampleRate, FFT_SIZE);
-
-	applyCriticalBandSmoothing(magnitudes);
+	equaliser.applyEQ(binWeights, sampleRate, static_cast<size_t>(fftSize));
 }
 
 void FFTProcessor::calculateMagnitudes(std::vector<float>& rawMagnitudes, const float sampleRate,
 									   float& outMaxMagnitude, float& outTotalEnergy) const {
-	outMaxMagnitude = 0.0f;
-	outTotalEnergy = 0.0f;
-
-#ifdef USE_NEON_OPTIMISATIONS
-	if (FFTProcessorNEON::isNEONAvailable() && fft_out.size() >= 4) {
-		FFTProcessorNEON::calculateMagnitudesFromComplex(
-			std::span<float>(rawMagnitudes.data(), rawMagnitudes.size()),
-			fft_out.data(), fft_out.size());
-
-		for (size_t i = 1; i < fft_out.size() - 1; ++i) {
-			const float freq = static_cast<float>(i) * sampleRate / FFT_SIZE;
-			if (freq < MIN_FREQ || freq > MAX_FREQ) {
-				rawMagnitudes[i] = 0.0f;
-				continue;
-			}
-
-			outTotalEnergy += rawMagnitudes[i] * rawMagnitudes[i];
-			outMaxMagnitude = std::max(outMaxMagnitude, rawMagnitudes[i]);
-		}
-	} else
-#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
-	if (FFTProcessorSSE::isSSEAvailable() && fft_out.size() >= 4) {
-		FFTProcessorSSE::calculateMagnitudesFromComplex(
-			std::span<float>(rawMagnitudes.data(), rawMagnitudes.size()),
-			fft_out.data(), fft_out.size());
-
-		for (size_t i = 1; i < fft_out.size() - 1; ++i) {
-			const float freq = static_cast<float>(i) * sampleRate / FFT_SIZE;
-			if (freq < MIN_FREQ || freq > MAX_FREQ) {
-				rawMagnitudes[i] = 0.0f;
-				continue;
-			}
-
-			outTotalEnergy += rawMagnitudes[i] * rawMagnitudes[i];
-			outMaxMagnitude = std::max(outMaxMagnitude, rawMagnitudes[i]);
-		}
-	} else
-#endif
-	{
-		for (size_t i = 1; i < fft_out.size() - 1; ++i) {
-			if (const float freq = static_cast<float>(i) * sampleRate / FFT_SIZE;
-				freq < MIN_FREQ || freq > MAX_FREQ)
-				continue;
-
-			const float magnitudeSquared = fft_out[i].r * fft_out[i].r + fft_out[i].i * fft_out[i].i;
-			const float magnitude = std::sqrt(magnitudeSquared);
-			rawMagnitudes[i] = magnitude;
-			outTotalEnergy += magnitudeSquared;
-			outMaxMagnitude = std::max(outMaxMagnitude, magnitude);
-		}
-	}
+	computeRawMagnitudes(fft_out, fftSize, rawMagnitudes, sampleRate, outMaxMagnitude, outTotalEnergy);
 }
 
 void FFTProcessor::calculatePhases() {
-	std::lock_guard lock(dataMutex);
-	for (size_t i = 0; i < fft_out.size(); ++i) {
-		phaseBuffer[i] = std::atan2(fft_out[i].i, fft_out[i].r);
-	}
+	computePhases(fft_out, phaseBuffer);
 }
 
 void FFTProcessor::reset() {
 	std::lock_guard processingLock(processingMutex);
-	std::lock_guard dataLock(dataMutex);
-	std::lock_guard bufferLock(frameBufferMutex);
 
 	std::ranges::fill(magnitudesBuffer, 0.0f);
 	std::ranges::fill(rawMagnitudesBuffer, 0.0f);
 	std::ranges::fill(spectralEnvelope, 0.0f);
-	std::ranges::fill(overlapBuffer, 0.0f);
-	std::ranges::fill(inputAccumulator, 0.0f);
-	accumulatedSamples = 0;
+	std::ranges::fill(history, 0.0f);
+	historyWrite = 0;
+	samplesSinceFrame = 0;
+	analysisHopSize = pendingHopSize;
 	frameCounter = 0;
 	loudnessMeter.reset();
 	momentaryLoudnessLUFS = -200.0f;
 
-	frameBufferHead = 0;
-	frameBufferTail = 0;
+	requestFrameDrain();
+	publishFrame();
 }
 
-void FFTProcessor::pushFrameToBuffer(const std::vector<float>& mags, const std::vector<float>& phases, const float sampleRate) {
-	std::lock_guard lock(frameBufferMutex);
+void FFTProcessor::discardBufferedFrames() {
+	std::lock_guard processingLock(processingMutex);
+	requestFrameDrain();
+}
+
+// The tail belongs to the consumer, so a drain is only requested here. Holding processingMutex
+// keeps the producer off the head, and any frame pushed later carries the new epoch with it.
+void FFTProcessor::requestFrameDrain() {
+	frameBufferDrainHead.store(frameBufferHead.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	frameBufferDrainEpoch.fetch_add(1, std::memory_order_release);
+}
 
-	const size_t head = frameBufferHead;
-	const size_t tail = frameBufferTail;
+// Consumer side. Moves the tail up to the latest requested drain, if one is pending, and
+// returns the tail. Callers load the head first: seeing a frame pushed after a request then
+// guarantees seeing the request too.
+size_t FFTProcessor::applyFrameDrain() const {
+	const uint64_t epoch = frameBufferDrainEpoch.load(std::memory_order_acquire);
+	if (epoch == consumerDrainEpoch) {
+		return frameBufferTail.load(std::memory_order_relaxed);
+	}
+	consumerDrainEpoch = epoch;
+	const size_t tail = frameBufferDrainHead.load(std::memory_order_relaxed);
+	frameBufferTail.store(tail, std::memory_order_release);
+	return tail;
+}
+
+// Wait-free SPSC ring: the producer owns the head, the consumer owns the tail. When the ring is
+// full the incoming frame is dropped, so the producer never has to touch the consumer's index.
+void FFTProcessor::pushFrameToBuffer(const std::vector<float>& mags, const std::vector<float>& phases, const float sampleRate) {
+	const size_t head = frameBufferHead.load(std::memory_order_relaxed);
 	const size_t nextHead = (head + 1) % FRAME_BUFFER_SIZE;
 
+	const size_t tail = frameBufferTail.load(std::memory_order_acquire);
 	if (nextHead == tail) {
-		frameBufferTail = (tail + 1) % FRAME_BUFFER_SIZE;
 		droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+		Utilities::Telemetry::increment(Utilities::Telemetry::Counter::SpectrumFramesDropped);
+		Utilities::Telemetry::set(Utilities::Telemetry::Gauge::SpectrumRingFill, 1.0);
+		return;
 	}
+	Utilities::Telemetry::set(Utilities::Telemetry::Gauge::SpectrumRingFill,
+							  static_cast<double>((nextHead + FRAME_BUFFER_SIZE - tail) % FRAME_BUFFER_SIZE) / FRAME_BUFFER_SIZE);
 
 	FFTFrame& frame = frameRingBuffer[head];
 
@@ -458,33 +621,196 @@ void FFTProcessor::pushFrameToBuffer(const std::vector<float>& mags, const std::
 	frame.frameCounter = frameCounter;
 	frame.sampleRate = sampleRate;
 	frame.loudnessLUFS = momentaryLoudnessLUFS;
+	frame.spectralFlux = spectralFlux;
+	frame.onsetDetected = onsetDetected;
 
-	frameBufferHead = nextHead;
+	frameBufferHead.store(nextHead, std::memory_order_release);
 }
 
-std::vector<FFTProcessor::FFTFrame> FFTProcessor::getBufferedFrames() {
-	std::lock_guard lock(frameBufferMutex);
+size_t FFTProcessor::borrowBufferedFrames(std::vector<FrameView>& views, const size_t maxFrames) const {
+	views.clear();
+
+	const size_t head = frameBufferHead.load(std::memory_order_acquire);
+	const size_t tail = applyFrameDrain();
+	const size_t available = (head >= tail) ? (head - tail) : (FRAME_BUFFER_SIZE - tail + head);
+	const size_t count = std::min(available, maxFrames);
 
-	const size_t head = frameBufferHead;
-	const size_t tail = frameBufferTail;
+	size_t current = tail;
+	for (size_t index = 0; index < count; ++index) {
+		const FFTFrame& frame = frameRingBuffer[current];
+		FrameView view;
+		view.magnitudes = frame.magnitudes;
+		view.phases = frame.phases;
+		view.frameCounter = frame.frameCounter;
+		view.sampleRate = frame.sampleRate;
+		view.loudnessLUFS = frame.loudnessLUFS;
+		view.spectralFlux = frame.spectralFlux;
+		view.onsetDetected = frame.onsetDetected;
+		views.push_back(view);
+		current = (current + 1) % FRAME_BUFFER_SIZE;
+	}
 
-	std::vector<FFTFrame> frames;
+	return count;
+}
 
-	if (head == tail) {
-		return frames;
+void FFTProcessor::releaseBufferedFrames(const size_t count) {
+	const size_t head = frameBufferHead.load(std::memory_order_acquire);
+	const uint64_t borrowedEpoch = consumerDrainEpoch;
+	const size_t tail = applyFrameDrain();
+	// A drain requested since the borrow already covers every frame that was borrowed.
+	if (count == 0 || consumerDrainEpoch != borrowedEpoch) {
+		return;
 	}
 
-	const size_t count = (head >= tail) ? (head - tail) : (FRAME_BUFFER_SIZE - tail + head);
-	frames.reserve(count);
+	const size_t available = (head >= tail) ? (head - tail) : (FRAME_BUFFER_SIZE - tail + head);
+	const size_t released = std::min(count, available);
+	frameBufferTail.store((tail + released) % FRAME_BUFFER_SIZE, std::memory_order_release);
+}
+
+size_t FFTProcessor::countSignalFrames(const size_t signalLength, const int hopSize) {
+	return hopSize > 0 ? signalLength / static_cast<size_t>(hopSize) : 0;
+}
 
-	size_t current = tail;
-	while (current != head) {
-		frames.push_back(frameRingBuffer[current]);
-		current = (current + 1) % FRAME_BUFFER_SIZE;
+// Loudness is the one piece of offline state that must run in order: the K-weighting filters
+// never forget, so no warm-up reproduces them exactly. It is measured separately in one cheap pass
+// over the same hop-sized pieces processBuffer would feed the meter.
+std::vector<float> FFTProcessor::analyseSignalLoudness(const std::span<const float> signal,
+													   const float sampleRate, const int hopSize) {
+	std::vector<float> loudness(countSignalFrames(signal.size(), hopSize), -200.0f);
+	analyseSignalLoudness(signal, sampleRate, hopSize, loudness, nullptr);
+	return loudness;
+}
+
+void FFTProcessor::analyseSignalLoudness(const std::span<const float> signal, const float sampleRate,
+										 const int hopSize, const std::span<float> loudness,
+										 const std::function<void(size_t)>& onFramesReady) {
+	const size_t frameCount = std::min(countSignalFrames(signal.size(), hopSize), loudness.size());
+	if (frameCount == 0 || sampleRate <= 0.0f) {
+		std::ranges::fill(loudness, -200.0f);
+		if (onFramesReady) {
+			onFramesReady(loudness.size());
+		}
+		return;
 	}
 
-	frameBufferTail = head;
+	const size_t hop = static_cast<size_t>(hopSize);
+	LoudnessMeter meter;
+	for (size_t frame = 0; frame < frameCount; ++frame) {
+		meter.processSamples(signal.subspan(frame * hop, hop), sampleRate);
+		loudness[frame] = meter.getMomentaryLoudness();
+		if (onFramesReady && (frame + 1) % LOUDNESS_REPORT_INTERVAL == 0) {
+			onFramesReady(frame + 1);
+		}
+	}
+	if (onFramesReady) {
+		onFramesReady(frameCount);
+	}
+}
 
+void FFTProcessor::analyseSignalFrames(const std::span<const float> signal, const float sampleRate,
+									   const int hopSize, const size_t firstFrame, const size_t frameCount,
+									   SignalFrames& frames, const size_t workerCount) const {
+	analyseSignalFrames(signal, 0, sampleRate, hopSize, firstFrame, frameCount, frames, workerCount);
+}
+
+void FFTProcessor::analyseSignalFrames(const std::span<const float> signal, const size_t signalStart,
+									   const float sampleRate, const int hopSize, const size_t firstFrame,
+									   const size_t frameCount, SignalFrames& frames,
+									   const size_t workerCount) const {
+	prepareSignalFrames(frames, firstFrame, frameCount);
+	if (frameCount == 0 || sampleRate <= 0.0f) {
+		return;
+	}
+
+	const size_t hop = static_cast<size_t>(std::clamp(hopSize, 1, fftSize));
+	const size_t windowSize = static_cast<size_t>(fftSize);
+	const size_t threadCount = std::clamp<size_t>(workerCount, 1, frameCount);
+	const size_t framesPerThread = (frameCount + threadCount - 1) / threadCount;
+
+	// Plans are built up front so allocation failures surface here rather than inside a worker.
+	std::vector<std::unique_ptr<FFTBackend::RealTransform>> transforms;
+	transforms.reserve(threadCount);
+	for (size_t t = 0; t < threadCount; ++t) {
+		transforms.push_back(FFTBackend::create(fftSize));
+	}
+
+	auto analyseRange = [&](const size_t t) {
+		const size_t rangeStart = t * framesPerThread;
+		const size_t rangeEnd = std::min(rangeStart + framesPerThread, frameCount);
+		std::vector<float> padded(windowSize, 0.0f);
+		std::vector<float> input(windowSize, 0.0f);
+		std::vector<kiss_fft_cpx> spectrum(getBinCount());
+
+		for (size_t local = rangeStart; local < rangeEnd; ++local) {
+			windowSignalFrame(signal, signalStart, (firstFrame + local + 1) * hop, input, padded);
+			transforms[t]->forward(input, spectrum);
+			storeSignalFrame(spectrum, sampleRate, frames, local);
+		}
+	};
+
+	if (threadCount == 1) {
+		analyseRange(0);
+		return;
+	}
+
+	// On the shared scheduler, so analysis already running as a task helps rather than
+	// stacking threads on top of the pool.
+	Utilities::Threading::TaskScheduler::shared().parallelFor(threadCount, 1, [&](const size_t first, const size_t end) {
+		for (size_t t = first; t < end; ++t) {
+			analyseRange(t);
+		}
+	});
+}
+
+void FFTProcessor::prepareSignalFrames(SignalFrames& frames, const size_t firstFrame, const size_t frameCount) const {
+	const size_t binCount = getBinCount();
+	frames.firstFrame = firstFrame;
+	frames.frameCount = frameCount;
+	frames.binCount = binCount;
+	frames.magnitudes.assign(frameCount * binCount, 0.0f);
+	frames.phases.assign(frameCount * binCount, 0.0f);
+}
+
+void FFTProcessor::windowSignalFrame(const std::span<const float> signal, const size_t signalStart, const size_t end,
+									 const std::span<float> input, std::vector<float>& padded) const {
+	const size_t windowSize = static_cast<size_t>(fftSize);
+	const size_t signalEnd = signalStart + signal.size();
+	if (end >= windowSize + signalStart && end <= signalEnd) {
+		windowFrame(input, signal.subspan(end - windowSize - signalStart, windowSize), analysisWindow);
+		return;
+	}
+
+	// Frames before the first full window see the zeroed overlap processBuffer starts with.
+	std::ranges::fill(padded, 0.0f);
+	const size_t start = std::max(end > windowSize ? end - windowSize : 0, signalStart);
+	const size_t available = std::min(end, signalEnd);
+	if (available > start) {
+		std::copy(signal.begin() + static_cast<std::ptrdiff_t>(start - signalStart),
+				  signal.begin() + static_cast<std::ptrdiff_t>(available - signalStart),
+				  padded.begin() + static_cast<std::ptrdiff_t>(windowSize - (end - start)));
+	}
+	windowFrame(input, padded, analysisWindow);
+}
+
+void FFTProcessor::storeSignalFrame(const std::span<kiss_fft_cpx> spectrum, const float sampleRate,
+									SignalFrames& frames, const size_t local) const {
+	const size_t binCount = frames.binCount;
+	normaliseSpectrum(spectrum);
+
+	float frameMaxMagnitude = 0.0f;
+	float frameTotalEnergy = 0.0f;
+	computeRawMagnitudes(spectrum, fftSize,
+						 std::span<float>(frames.magnitudes.data() + local * binCount, binCount),
+						 sampleRate, frameMaxMagnitude, frameTotalEnergy);
+	computePhases(spectrum, std::span<float>(frames.phases.data() + local * binCount, binCount));
+}
+
+FFTProcessor::SignalFrames FFTProcessor::analyseWholeSignal(const std::span<const float> signal,
+															const float sampleRate, const int hopSize,
+															const size_t workerCount) const {
+	SignalFrames frames;
+	analyseSignalFrames(signal, sampleRate, hopSize, 0, countSignalFrames(signal.size(), hopSize),
+						frames, workerCount);
 	return frames;
 }
 
@@ -497,17 +823,28 @@ void FFTProcessor::calculateSpectralFluxAndOnset(const std::vector<float>& curre
 		return;
 	}
 
+	// Summing the rise and retiring the current frame share one pass.
 	float flux = 0.0f;
-	for (size_t i = 0; i < currentMagnitudes.size(); ++i) {
-		const float diff = currentMagnitudes[i] - previousMagnitudes[i];
-		flux += std::max(diff, 0.0f);
+#ifdef USE_NEON_OPTIMISATIONS
+	if (FFTProcessorNEON::isNEONAvailable()) {
+		flux = FFTProcessorNEON::accumulatePositiveFlux(currentMagnitudes, previousMagnitudes);
+	} else
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	if (FFTProcessorSSE::isSSEAvailable()) {
+		flux = FFTProcessorSSE::accumulatePositiveFlux(currentMagnitudes, previousMagnitudes);
+	} else
+#endif
+	{
+		for (size_t i = 0; i < currentMagnitudes.size(); ++i) {
+			flux += std::max(currentMagnitudes[i] - previousMagnitudes[i], 0.0f);
+			previousMagnitudes[i] = currentMagnitudes[i];
+		}
 	}
 
 	flux /= static_cast<float>(currentMagnitudes.size());
 
-	fluxHistory[fluxHistoryIndex] = flux;
-	fluxHistoryIndex = (fluxHistoryIndex + 1) % FLUX_HISTORY_SIZE;
-
+	// The threshold comes from the frames before this one: a history holding this frame's own
+	// flux would put the threshold above it and no onset could ever fire.
 	float maxFlux = 0.0f;
 	for (const float histFlux : fluxHistory) {
 		maxFlux = std::max(maxFlux, histFlux);
@@ -515,12 +852,11 @@ void FFTProcessor::calculateSpectralFluxAndOnset(const std::vector<float>& curre
 
 	const float threshold = maxFlux * ONSET_THRESHOLD_MULTIPLIER;
 	const bool onset = flux > threshold && flux > 0.01f;
-	previousMagnitudes = currentMagnitudes;
-	{
-		std::lock_guard lock(dataMutex);
-		onsetDetected = onset;
-		spectralFlux = flux;
-	}
+	onsetDetected = onset;
+	spectralFlux = flux;
+
+	fluxHistory[fluxHistoryIndex] = flux;
+	fluxHistoryIndex = (fluxHistoryIndex + 1) % FLUX_HISTORY_SIZE;
 }
 
 // Glasberg & Moore (1990) - ERB: Equivalent Rectangular Bandwidth
@@ -547,57 +883,55 @@ void FFTProcessor::setCriticalBandSmoothingEnabled(const bool enabled) {
 void FFTProcessor::setMelWeightingEnabled(const bool enabled) {
 	std::lock_guard<std::mutex> lock(processingMutex);
 	melWeightingEnabled = enabled;
+	binWeightsDirty.store(true, std::memory_order_release);
 }
 
 int FFTProcessor::getHopSize() const {
-	std::lock_guard lock(processingMutex);
-	return static_cast<int>(analysisHopSize);
+	return getAnalysisState().hopSize;
 }
 
 float FFTProcessor::getCurrentLoudness() const {
-	std::lock_guard lock(dataMutex);
-	return currentLoudness;
+	return getAnalysisState().currentLoudness;
 }
 
 float FFTProcessor::getMomentaryLoudnessLUFS() const {
-	std::lock_guard lock(dataMutex);
-	return momentaryLoudnessLUFS;
+	return getAnalysisState().momentaryLoudnessLUFS;
 }
 
 float FFTProcessor::getTotalEnergy() const {
-	std::lock_guard lock(dataMutex);
-	return totalEnergy;
+	return getAnalysisState().totalEnergy;
 }
 
 float FFTProcessor::getMaxMagnitude() const {
-	std::lock_guard lock(dataMutex);
-	return maxMagnitude;
+	return getAnalysisState().maxMagnitude;
 }
 
 float FFTProcessor::getSpectralFlux() const {
-	std::lock_guard lock(dataMutex);
-	return spectralFlux;
+	return getAnalysisState().spectralFlux;
 }
 
 bool FFTProcessor::getOnsetDetected() const {
-	std::lock_guard lock(dataMutex);
-	return onsetDetected;
+	return getAnalysisState().onsetDetected;
 }
 
-void FFTProcessor::initialiseCriticalBands(const float sampleRate) {
-	criticalBands.clear();
+std::vector<FFTProcessor::CriticalBand> FFTProcessor::buildCriticalBands(const float sampleRate,
+																		  const int fftSize,
+																		  const size_t bandCount) {
+	std::vector<CriticalBand> bands;
+	if (sampleRate <= 0.0f || fftSize <= 0 || bandCount == 0) {
+		return bands;
+	}
 
 	const float nyquist = sampleRate / 2.0f;
-	const size_t numBins = FFT_SIZE / 2 + 1;
-	const float binSize = sampleRate / static_cast<float>(FFT_SIZE);
+	const auto numBins = static_cast<size_t>(fftSize / 2 + 1);
+	const float binSize = sampleRate / static_cast<float>(fftSize);
 
 	const float minERB = frequencyToERBScale(MIN_FREQ);
 	const float maxERB = frequencyToERBScale(std::min(MAX_FREQ, nyquist));
 
-	constexpr size_t TARGET_NUM_BANDS = 32;
-	const float erbStep = (maxERB - minERB) / static_cast<float>(TARGET_NUM_BANDS);
+	const float erbStep = (maxERB - minERB) / static_cast<float>(bandCount);
 
-	for (size_t i = 0; i < TARGET_NUM_BANDS; ++i) {
+	for (size_t i = 0; i < bandCount; ++i) {
 		const float centerERB = minERB + (static_cast<float>(i) + 0.5f) * erbStep;
 		const float centerFreq = erbScaleToFrequency(centerERB);
 		const float erbWidth = calculateERB(centerFreq);
@@ -616,12 +950,25 @@ void FFTProcessor::initialiseCriticalBands(const float sampleRate) {
 			band.startBin = startBin;
 			band.endBin = endBin;
 			band.smoothingFactor = calculatePsychoacousticSmoothingFactor(centerFreq);
-			band.smoothedMagnitude = 0.0f;
-			band.rawMagnitude = 0.0f;
 
-			criticalBands.push_back(band);
+			bands.push_back(band);
 		}
 	}
+	return bands;
+}
+
+void FFTProcessor::initialiseCriticalBands(const float sampleRate) {
+	constexpr size_t TARGET_NUM_BANDS = 32;
+	criticalBands = buildCriticalBands(sampleRate, fftSize, TARGET_NUM_BANDS);
+
+	bandBins.clear();
+	bandBins.reserve(criticalBands.size());
+	for (const auto& band : criticalBands) {
+		bandBins.push_back({static_cast<uint32_t>(band.startBin),
+							static_cast<uint32_t>(band.endBin - band.startBin + 1),
+							band.smoothingFactor});
+	}
+	bandStates.assign(bandBins.size(), BandState{});
 }
 
 // Fletcher (1940), Moore (2012) - frequency-dependent temporal integration
@@ -636,7 +983,7 @@ void FFTProcessor::initialiseCriticalBands(const float sampleRate) {
 // - 100-500Hz: 3x → 1x transition - improving frequency discrimination
 // - 500-2000Hz: 1x (base) - optimal frequency discrimination range
 // - >2000Hz: 1x → 0.25x - excellent discrimination, wider ERB bands but sharper perceptual resolution
-float FFTProcessor::calculatePsychoacousticSmoothingFactor(const float frequency) const {
+float FFTProcessor::calculatePsychoacousticSmoothingFactor(const float frequency) {
 	constexpr float BASE_SMOOTHING = 0.2f;
 
 	if (frequency < 100.0f) {
@@ -655,35 +1002,52 @@ float FFTProcessor::calculatePsychoacousticSmoothingFactor(const float frequency
 }
 
 void FFTProcessor::applyCriticalBandSmoothing(std::vector<float>& magnitudes) {
-	if (!criticalBandSmoothingEnabled || criticalBands.empty()) {
+	if (!criticalBandSmoothingEnabled || bandBins.empty()) {
 		return;
 	}
 
-	for (auto& band : criticalBands) {
-		float bandEnergy = 0.0f;
-		size_t count = 0;
-
-		for (size_t bin = band.startBin; bin <= band.endBin && bin < magnitudes.size(); ++bin) {
-			const float mag = magnitudes[bin];
-			bandEnergy += mag * mag * mag;
-			++count;
+	for (size_t index = 0; index < bandBins.size(); ++index) {
+		const BandBins& band = bandBins[index];
+		BandState& state = bandStates[index];
+		if (band.firstBin + band.binCount > magnitudes.size()) {
+			continue;
 		}
+		const std::span<float> bins(magnitudes.data() + band.firstBin, band.binCount);
 
-		if (count > 0) {
-			band.rawMagnitude = std::cbrt(bandEnergy / static_cast<float>(count));
+		float bandEnergy = 0.0f;
+#ifdef USE_NEON_OPTIMISATIONS
+		if (FFTProcessorNEON::isNEONAvailable()) {
+			bandEnergy = FFTProcessorNEON::sumOfCubes(bins);
+		} else
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		if (FFTProcessorSSE::isSSEAvailable()) {
+			bandEnergy = FFTProcessorSSE::sumOfCubes(bins);
+		} else
+#endif
+		{
+			for (const float mag : bins) {
+				bandEnergy += mag * mag * mag;
+			}
 		}
 
+		state.rawMagnitude = std::cbrt(bandEnergy / static_cast<float>(band.binCount));
+
 		const float alpha = 1.0f - band.smoothingFactor;
-		band.smoothedMagnitude = alpha * band.rawMagnitude + band.smoothingFactor * band.smoothedMagnitude;
-
-		for (size_t bin = band.startBin; bin <= band.endBin && bin < magnitudes.size(); ++bin) {
-			const float originalMag = magnitudes[bin];
-			if (band.rawMagnitude > 1e-6f) {
-				const float scale = band.smoothedMagnitude / band.rawMagnitude;
-				magnitudes[bin] = originalMag * scale;
-			} else {
-				magnitudes[bin] = band.smoothedMagnitude;
+		state.smoothedMagnitude = alpha * state.rawMagnitude + band.smoothingFactor * state.smoothedMagnitude;
+
+		if (state.rawMagnitude > 1e-6f) {
+			const float scale = state.smoothedMagnitude / state.rawMagnitude;
+#ifdef USE_NEON_OPTIMISATIONS
+			FFTProcessorNEON::vectorScale(bins, scale);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+			FFTProcessorSSE::vectorScale(bins, scale);
+#else
+			for (float& mag : bins) {
+				mag *= scale;
 			}
+#endif
+		} else {
+			std::ranges::fill(bins, state.smoothedMagnitude);
 		}
 	}
 }
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <span>
 #include <vector>
 
 #include "equaliser.h"
+#include "fft_backend.h"
 #include "kiss_fftr.h"
 #include "loudness_meter.h"
 #include "constants.h"
@@ -23,6 +27,8 @@ class FFTProcessor {
 public:
 	static constexpr int FFT_SIZE = 2048;
 	static constexpr int HOP_SIZE = FFT_SIZE / 2;
+	static constexpr int MIN_FFT_SIZE = 512;
+	static constexpr int MAX_FFT_SIZE = 8192;
 	static constexpr float MIN_FREQ = synesthesia::constants::MIN_AUDIO_FREQ;
 	static constexpr float MAX_FREQ = synesthesia::constants::MAX_AUDIO_FREQ;
 	static constexpr float MAGNITUDE_EPSILON = 1e-6f;
@@ -30,6 +36,8 @@ public:
 	static constexpr float MEL_LINEAR_WEIGHT = 3.0f;
 	static constexpr float MEL_LOG_NUMERATOR = 27.0f;
 	static constexpr float MEL_MIN_WEIGHT = 1.0f;
+	static constexpr size_t FRAME_BUFFER_SIZE = 128;
+	static constexpr size_t LOUDNESS_REPORT_INTERVAL = 64;
 
 	struct ComplexBin {
 		float frequency;
@@ -45,13 +53,10 @@ public:
 		size_t startBin;
 		size_t endBin;
 		float smoothingFactor;
-		float smoothedMagnitude;
-		float rawMagnitude;
 
 		CriticalBand()
 			: centerFrequency(0.0f), lowerFreq(0.0f), upperFreq(0.0f),
-			  startBin(0), endBin(0), smoothingFactor(0.2f),
-			  smoothedMagnitude(0.0f), rawMagnitude(0.0f) {}
+			  startBin(0), endBin(0), smoothingFactor(0.2f) {}
 	};
 
 	struct FFTFrame {
@@ -60,8 +65,44 @@ public:
 		uint64_t frameCounter;
 		float sampleRate;
 		float loudnessLUFS;
+		float spectralFlux;
+		bool onsetDetected;
+
+		FFTFrame() : frameCounter(0), sampleRate(0.0f), loudnessLUFS(-200.0f), spectralFlux(0.0f), onsetDetected(false) {}
+	};
+
+	// Borrowed view of a ring slot; valid until the slot is released by its consumer.
+	struct FrameView {
+		std::span<const float> magnitudes;
+		std::span<const float> phases;
+		uint64_t frameCounter = 0;
+		float sampleRate = 0.0f;
+		float loudnessLUFS = -200.0f;
+		float spectralFlux = 0.0f;
+		bool onsetDetected = false;
+	};
+
+	// One channel of an interleaved buffer: frameCount samples, stride floats apart.
+	struct ChannelView {
+		const float* data = nullptr;
+		size_t frameCount = 0;
+		size_t stride = 1;
+	};
+
+	// Frame-major raw magnitude and phase slabs from offline analysis, getBinCount() floats per frame.
+	struct SignalFrames {
+		size_t firstFrame = 0;
+		size_t frameCount = 0;
+		size_t binCount = 0;
+		std::vector<float> magnitudes;
+		std::vector<float> phases;
 
-		FFTFrame() : frameCounter(0), sampleRate(0.0f), loudnessLUFS(-200.0f) {}
+		std::span<const float> frameMagnitudes(const size_t frame) const {
+			return {magnitudes.data() + frame * binCount, binCount};
+		}
+		std::span<const float> framePhases(const size_t frame) const {
+			return {phases.data() + frame * binCount, binCount};
+		}
 	};
 
 	struct AnalysisState {
@@ -75,8 +116,7 @@ public:
 		bool onsetDetected = false;
 	};
 
-	FFTProcessor();
-	~FFTProcessor();
+	explicit FFTProcessor(int requestedFFTSize = FFT_SIZE);
 
 	FFTProcessor(const FFTProcessor&) = delete;
 	FFTProcessor& operator=(const FFTProcessor&) = delete;
@@ -84,22 +124,58 @@ public:
 	FFTProcessor& operator=(FFTProcessor&&) noexcept = delete;
 
 	void processBuffer(std::span<const float> buffer, float sampleRate);
+	// Deinterleaves straight into the hop accumulator, so no per-channel copy is needed first.
+	void processBuffer(ChannelView samples, float sampleRate);
+	int getFFTSize() const { return fftSize; }
+	size_t getBinCount() const { return static_cast<size_t>(fftSize / 2 + 1); }
 	std::vector<float> getMagnitudesBuffer() const;
 	std::vector<float> getRawMagnitudesBuffer() const;
 	std::vector<float> getSpectralEnvelope() const;
 	std::vector<float> getPhaseBuffer() const;
 	void copyProcessedFrame(std::vector<float>& magnitudes, std::vector<float>& phases, AnalysisState& state) const;
 	void copyRawFrame(std::vector<float>& rawMagnitudes, std::vector<float>& phases, AnalysisState& state) const;
+	AnalysisState getAnalysisState() const;
 	void reset();
 	void setEQGains(float low, float mid, float high);
 	void setHopSize(int hopSize);
 	int getHopSize() const;
+	// Samples processBuffer has taken since the newest frame ended. Only the thread feeding
+	// processBuffer may ask.
+	size_t getSamplesSinceFrame() const { return samplesSinceFrame; }
 	void setCriticalBandSmoothingEnabled(bool enabled);
 	void setMelWeightingEnabled(bool enabled);
 	bool getCriticalBandSmoothingEnabled() const { return criticalBandSmoothingEnabled; }
 	const std::vector<CriticalBand>& getCriticalBands() const { return criticalBands; }
 
-	std::vector<FFTFrame> getBufferedFrames();
+	// Offline entrypoints. Frames match what processBuffer emits after a reset at the given hop,
+	// but are computed straight into SignalFrames without the ring, the snapshots or this
+	// processor's running state. Frame k ends at sample (k + 1) * hopSize and reads its
+	// fftSize - hopSize samples of overlap straight from the signal, so any frame range can be
+	// analysed independently and segments stitch bit-identically.
+	static size_t countSignalFrames(size_t signalLength, int hopSize);
+	static std::vector<float> analyseSignalLoudness(std::span<const float> signal, float sampleRate, int hopSize);
+	// Fills loudness frame by frame, reporting the count written so far every
+	// LOUDNESS_REPORT_INTERVAL frames and once at the end.
+	static void analyseSignalLoudness(std::span<const float> signal, float sampleRate, int hopSize,
+									  std::span<float> loudness,
+									  const std::function<void(size_t)>& onFramesReady);
+	void analyseSignalFrames(std::span<const float> signal, float sampleRate, int hopSize,
+							 size_t firstFrame, size_t frameCount, SignalFrames& frames,
+							 size_t workerCount = 1) const;
+	// Streaming form: signal holds samples from signalStart onwards and must cover every
+	// requested frame's window that lies at or after sample 0.
+	void analyseSignalFrames(std::span<const float> signal, size_t signalStart, float sampleRate,
+							 int hopSize, size_t firstFrame, size_t frameCount, SignalFrames& frames,
+							 size_t workerCount = 1) const;
+	SignalFrames analyseWholeSignal(std::span<const float> signal, float sampleRate, int hopSize,
+									size_t workerCount = 1) const;
+
+	// Frame ring is single-producer/single-consumer: only one thread may borrow and release.
+	size_t borrowBufferedFrames(std::vector<FrameView>& views, size_t maxFrames = FRAME_BUFFER_SIZE) const;
+	void releaseBufferedFrames(size_t count);
+	// Any thread may ask; the consumer drops everything buffered so far at its next borrow or
+	// release, so frames it still holds stay valid until then.
+	void discardBufferedFrames();
 	uint64_t getDroppedFrameCount() const { return droppedFrameCount.load(std::memory_order_relaxed); }
 	float getCurrentLoudness() const;
 	float getMomentaryLoudnessLUFS() const;
@@ -109,27 +185,39 @@ public:
 	bool getOnsetDetected() const;
 	uint64_t getFrameCounter() const;
 
+	static bool isSupportedFFTSize(int fftSize);
 	static float calculateMelWeight(float frequency);
 	static float calculateERB(float frequency);
 	static float frequencyToERBScale(float frequency);
 	static float erbScaleToFrequency(float erbScale);
+	// bandCount bands evenly spaced on the ERB scale across the analysis range. Bands narrower
+	// than a bin are left out, so there can be fewer than asked for.
+	static std::vector<CriticalBand> buildCriticalBands(float sampleRate, int fftSize, size_t bandCount);
 
 private:
-	kiss_fftr_cfg fft_cfg;
+	// Drives a pair of processors through one transform; see stereo_fft_processor.h.
+	friend class StereoFFTProcessor;
+
+	int fftSize;
+	std::unique_ptr<FFTBackend::RealTransform> fftTransform;
 	std::vector<float> fft_in;
 	std::vector<kiss_fft_cpx> fft_out;
 
-	// Lock hierarchy: processingMutex → dataMutex → frameBufferMutex
-	// Always acquire in this order to prevent deadlocks
+	// processingMutex serialises the analysis thread and configuration changes. Readers never take
+	// it; they copy the latest published frame instead.
 	mutable std::mutex processingMutex;
 
-	std::vector<float> hannWindow;
-	std::vector<float> overlapBuffer;
-	std::vector<float> windowBuffer;
-	std::vector<float> inputAccumulator;
-	size_t accumulatedSamples;
+	// Hann window pre-scaled by 2/fftSize; see buildAnalysisWindow.
+	std::span<const float> analysisWindow;
+	// The last fftSize input samples, oldest at historyWrite, zeros until that many have
+	// arrived. Each frame is windowed straight out of it as two runs, so a sample is copied
+	// once on the way in and never shifted.
+	std::vector<float> history;
+	size_t historyWrite;
+	size_t samplesSinceFrame;
 	size_t analysisHopSize;
-	size_t overlapSize;
+	// Becomes analysisHopSize at the next frame boundary, so a change keeps the history.
+	size_t pendingHopSize;
 
 	std::vector<float> magnitudesBuffer;
 	std::vector<float> rawMagnitudesBuffer;
@@ -137,7 +225,20 @@ private:
 	std::vector<float> spectralEnvelope;
 	std::vector<float> phaseBuffer;
 
-	mutable std::mutex dataMutex;
+	// Seqlock-guarded snapshots: the analysis thread fills the next slot while readers copy the
+	// last published one, retrying only if the writer laps them mid-copy.
+	struct PublishedFrame {
+		std::atomic<uint32_t> sequence{0};
+		AnalysisState state;
+		std::vector<float> magnitudes;
+		std::vector<float> rawMagnitudes;
+		std::vector<float> phases;
+		std::vector<float> spectralEnvelope;
+	};
+	static constexpr size_t PUBLISHED_FRAME_SLOTS = 3;
+	std::array<PublishedFrame, PUBLISHED_FRAME_SLOTS> publishedFrames;
+	std::atomic<size_t> publishedFrameIndex{0};
+	size_t nextPublishedFrame{1};
 
 	Equaliser equaliser;
 	LoudnessMeter loudnessMeter;
@@ -154,22 +255,68 @@ private:
 	uint64_t frameCounter;
 
 	std::vector<CriticalBand> criticalBands;
+
+	// Flattened copy of criticalBands for applyCriticalBandSmoothing: each band's bin range,
+	// already clamped to the spectrum, beside the per-frame state it carries between frames.
+	// Neighbouring bands can share an edge bin, so they are still applied in order.
+	struct BandBins {
+		uint32_t firstBin;
+		uint32_t binCount;
+		float smoothingFactor;
+	};
+	struct BandState {
+		float rawMagnitude = 0.0f;
+		float smoothedMagnitude = 0.0f;
+	};
+	std::vector<BandBins> bandBins;
+	std::vector<BandState> bandStates;
 	bool criticalBandSmoothingEnabled;
 	bool melWeightingEnabled;
+
+	// Per-bin product of the analysis band mask, the mel weight and the EQ response, so
+	// processMagnitudes weights each bin with one multiply. Rebuilt on the analysis thread
+	// when the sample rate changes or binWeightsDirty is set by an EQ or weighting change.
+	std::vector<float> binWeights;
+	float binWeightsSampleRate = 0.0f;
+	size_t weightedMinBin = 1;
+	size_t weightedMaxBin = 0;
+	std::atomic<bool> binWeightsDirty{true};
+
 	static constexpr float LOUDNESS_SMOOTHING = 0.3f;
 	static constexpr size_t FLUX_HISTORY_SIZE = 10;
 	static constexpr float ONSET_THRESHOLD_MULTIPLIER = 1.5f;
 	static constexpr float LUFS_NORMALISATION_OFFSET = 70.0f;
 
-	static constexpr size_t FRAME_BUFFER_SIZE = 128;
 	std::vector<FFTFrame> frameRingBuffer;
-	size_t frameBufferHead{0};
-	size_t frameBufferTail{0};
+	alignas(64) std::atomic<size_t> frameBufferHead{0};
+	// Only the consumer writes the tail, borrowing included, which is why it is mutable.
+	alignas(64) mutable std::atomic<size_t> frameBufferTail{0};
+	// A drain request: the head to drain up to, published by bumping the epoch. Requests are
+	// made under processingMutex; the consumer applies one when its epoch falls behind.
+	std::atomic<size_t> frameBufferDrainHead{0};
+	std::atomic<uint64_t> frameBufferDrainEpoch{0};
+	mutable uint64_t consumerDrainEpoch = 0;
 	std::atomic<uint64_t> droppedFrameCount{0};
-	mutable std::mutex frameBufferMutex;
 
-	void applyWindow(std::span<const float> buffer);
+	void requestFrameDrain();
+	size_t applyFrameDrain() const;
+	void applyWindow();
+	// Samples the history takes before the frame in progress ends or the ring wraps.
+	size_t historySpace() const;
+	// Takes count samples, at most historySpace(), stride floats apart. True once they end a frame.
+	bool appendHistory(const float* source, size_t stride, size_t count, float sampleRate);
+	void completeFrame();
 	void processOverlappingWindow(float sampleRate);
+	// Everything processOverlappingWindow does once fft_out holds the frame's spectrum.
+	void analyseSpectrum(float sampleRate);
+
+	// Offline frame steps shared with StereoFFTProcessor. windowSignalFrame windows the frame
+	// ending at sample end into input, using padded for windows that run off the signal.
+	void windowSignalFrame(std::span<const float> signal, size_t signalStart, size_t end,
+						   std::span<float> input, std::vector<float>& padded) const;
+	void storeSignalFrame(std::span<kiss_fft_cpx> spectrum, float sampleRate, SignalFrames& frames,
+						  size_t local) const;
+	void prepareSignalFrames(SignalFrames& frames, size_t firstFrame, size_t frameCount) const;
 
 	void normalizeFFTOutput();
 	float updateLoudnessMetrics();
@@ -180,10 +327,14 @@ private:
 							 float& outMaxMagnitude, float& outTotalEnergy) const;
 	void calculatePhases();
 	void processMagnitudes(std::vector<float>& magnitudes, float sampleRate, float referenceMaxMagnitude);
+	void rebuildBinWeights(float sampleRate);
 	void calculateSpectralFluxAndOnset(const std::vector<float>& currentMagnitudes);
 	void pushFrameToBuffer(const std::vector<float>& mags, const std::vector<float>& phases, float sampleRate);
+	void publishFrame();
+	template <typename Reader>
+	void readPublishedFrame(Reader&& reader) const;
 
 	void initialiseCriticalBands(float sampleRate);
 	void applyCriticalBandSmoothing(std::vector<float>& magnitudes);
-	float calculatePsychoacousticSmoothingFactor(float frequency) const;
+	static float calculatePsychoacousticSmoothingFactor(float frequency);
 };
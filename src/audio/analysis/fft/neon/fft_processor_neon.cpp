@@ -246,6 +246,93 @@ float vectorMax(std::span<const float> data) {
     return maxVal;
 }
 
+float sumOfCubes(std::span<const float> data) {
+    const size_t size = data.size();
+    const size_t vectorSize = size & ~3u;
+    
+    float32x4_t sumVec = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    
+    for (; i < vectorSize; i += 4) {
+        float32x4_t dataVec = vld1q_f32(&data[i]);
+        sumVec = vmlaq_f32(sumVec, vmulq_f32(dataVec, dataVec), dataVec);
+    }
+    
+    float32x2_t sum_low = vget_low_f32(sumVec);
+    float32x2_t sum_high = vget_high_f32(sumVec);
+    float32x2_t sum_pair = vadd_f32(sum_low, sum_high);
+    float sum = vget_lane_f32(vpadd_f32(sum_pair, sum_pair), 0);
+    
+    for (; i < size; ++i) {
+        sum += data[i] * data[i] * data[i];
+    }
+    
+    return sum;
+}
+
+void calculateBandMagnitudes(std::span<float> magnitudes, const kiss_fft_cpx* fft_output,
+                             size_t firstBin, size_t lastBin,
+                             float& outMaxMagnitude, float& outTotalEnergy) {
+    const size_t size = magnitudes.size();
+    lastBin = std::min(lastBin, size - 1);
+    vectorFill(magnitudes.subspan(0, firstBin), 0.0f);
+    vectorFill(magnitudes.subspan(lastBin + 1), 0.0f);
+
+    float32x4_t energyVec = vdupq_n_f32(0.0f);
+    float32x4_t maxVec = vdupq_n_f32(0.0f);
+    size_t i = firstBin;
+    
+    for (; i + 4 <= lastBin + 1; i += 4) {
+        // kiss_fft_cpx is {r, i}, so a de-interleaving load splits four bins.
+        const float32x4x2_t bins = vld2q_f32(&fft_output[i].r);
+        const float32x4_t power = vaddq_f32(vmulq_f32(bins.val[0], bins.val[0]), vmulq_f32(bins.val[1], bins.val[1]));
+        const float32x4_t magnitude = vsqrtq_f32(power);
+        vst1q_f32(&magnitudes[i], magnitude);
+
+        energyVec = vaddq_f32(energyVec, power);
+        maxVec = vmaxq_f32(maxVec, magnitude);
+    }
+    
+    float energy = vaddvq_f32(energyVec);
+    float maxMagnitude = vmaxvq_f32(maxVec);
+
+    for (; i <= lastBin; ++i) {
+        const float power = fft_output[i].r * fft_output[i].r + fft_output[i].i * fft_output[i].i;
+        const float magnitude = std::sqrt(power);
+        magnitudes[i] = magnitude;
+        energy += power;
+        maxMagnitude = std::max(maxMagnitude, magnitude);
+    }
+
+    outMaxMagnitude = maxMagnitude;
+    outTotalEnergy = energy;
+}
+
+float accumulatePositiveFlux(std::span<const float> current, std::span<float> previous) {
+    const size_t size = std::min(current.size(), previous.size());
+    const size_t vectorSize = size & ~3u;
+    
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t fluxVec = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    
+    for (; i < vectorSize; i += 4) {
+        const float32x4_t currentVec = vld1q_f32(&current[i]);
+        const float32x4_t previousVec = vld1q_f32(&previous[i]);
+        fluxVec = vaddq_f32(fluxVec, vmaxq_f32(vsubq_f32(currentVec, previousVec), zero));
+        vst1q_f32(&previous[i], currentVec);
+    }
+    
+    float flux = vaddvq_f32(fluxVec);
+    
+    for (; i < size; ++i) {
+        flux += std::max(current[i] - previous[i], 0.0f);
+        previous[i] = current[i];
+    }
+    
+    return flux;
+}
+
 void calculateMagnitudesFromComplex(std::span<float> magnitudes, 
                                    const kiss_fft_cpx* fft_output, size_t count) {
     const size_t size = std::min(magnitudes.size(), count);
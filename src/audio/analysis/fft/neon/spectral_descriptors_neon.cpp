@@ -0,0 +1,186 @@
+#include "spectral_descriptors_neon.h"
+
+#ifdef __ARM_NEON
+
+#include <algorithm>
+
+namespace SpectralDescriptorsNEON {
+
+namespace {
+
+float32x4_t maskedSelect(const uint32x4_t mask, const float32x4_t values) {
+    return vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(values)));
+}
+
+float horizontalSum(const float32x4_t values) {
+    const float32x2_t pair = vadd_f32(vget_low_f32(values), vget_high_f32(values));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+}
+
+float horizontalMax(const float32x4_t values) {
+    const float32x2_t pair = vmax_f32(vget_low_f32(values), vget_high_f32(values));
+    return vget_lane_f32(vpmax_f32(pair, pair), 0);
+}
+
+}
+
+// Cephes-style natural log for positive normal inputs: split into mantissa and exponent,
+// then evaluate a degree-9 polynomial around 1.
+float32x4_t fastLog(float32x4_t values) {
+    const uint32x4_t bits = vreinterpretq_u32_f32(values);
+    const int32x4_t exponentBits = vsubq_s32(
+        vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)),
+        vdupq_n_s32(126));
+    float32x4_t exponent = vcvtq_f32_s32(exponentBits);
+    float32x4_t mantissa = vreinterpretq_f32_u32(vorrq_u32(
+        vandq_u32(bits, vdupq_n_u32(0x007fffff)),
+        vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const uint32x4_t belowSqrtHalf = vcltq_f32(mantissa, vdupq_n_f32(0.707106781186547524f));
+    exponent = vsubq_f32(exponent, maskedSelect(belowSqrtHalf, one));
+    mantissa = vaddq_f32(vsubq_f32(mantissa, one), maskedSelect(belowSqrtHalf, mantissa));
+
+    const float32x4_t x = mantissa;
+    const float32x4_t z = vmulq_f32(x, x);
+    float32x4_t y = vdupq_n_f32(7.0376836292e-2f);
+    y = vmlaq_f32(vdupq_n_f32(-1.1514610310e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(1.1676998740e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(-1.2420140846e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(1.4249322787e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(-1.6668057665e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(2.0000714765e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(-2.4999993993e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(3.3333331174e-1f), y, x);
+    y = vmulq_f32(vmulq_f32(y, x), z);
+    y = vmlaq_f32(y, exponent, vdupq_n_f32(-2.12194440e-4f));
+    y = vmlsq_f32(y, z, vdupq_n_f32(0.5f));
+
+    const float32x4_t result = vaddq_f32(x, y);
+    return vmlaq_f32(result, exponent, vdupq_n_f32(0.693359375f));
+}
+
+SpectralDescriptors::Accumulators accumulate(std::span<const float> magnitudes,
+                                             std::span<const float> frequencies) {
+    const size_t size = std::min(magnitudes.size(), frequencies.size());
+    const size_t vectorSize = size & ~static_cast<size_t>(3);
+
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t epsilon = vdupq_n_f32(SpectralDescriptors::MAGNITUDE_EPSILON);
+    const float32x4_t minFrequency = vdupq_n_f32(synesthesia::constants::MIN_AUDIO_FREQ);
+    const float32x4_t maxFrequency = vdupq_n_f32(synesthesia::constants::MAX_AUDIO_FREQ);
+    const float32x4_t lowLimit = vdupq_n_f32(SpectralDescriptors::LOW_BAND_LIMIT_HZ);
+    const float32x4_t midLimit = vdupq_n_f32(SpectralDescriptors::MID_BAND_LIMIT_HZ);
+
+    float32x4_t magnitudeSum = vdupq_n_f32(0.0f);
+    float32x4_t positiveMagnitudeSum = vdupq_n_f32(0.0f);
+    float32x4_t positiveCount = vdupq_n_f32(0.0f);
+    float32x4_t logMagnitudeSum = vdupq_n_f32(0.0f);
+    float32x4_t audibleWeightSum = vdupq_n_f32(0.0f);
+    float32x4_t weightedFrequencySum = vdupq_n_f32(0.0f);
+    float32x4_t totalEnergy = vdupq_n_f32(0.0f);
+    float32x4_t maxMagnitude = vdupq_n_f32(0.0f);
+    float32x4_t lowEnergy = vdupq_n_f32(0.0f);
+    float32x4_t midEnergy = vdupq_n_f32(0.0f);
+    float32x4_t highEnergy = vdupq_n_f32(0.0f);
+
+    size_t i = 0;
+    for (; i < vectorSize; i += 4) {
+        const float32x4_t magnitude = vld1q_f32(&magnitudes[i]);
+        const float32x4_t frequency = vld1q_f32(&frequencies[i]);
+        const float32x4_t energy = vmulq_f32(magnitude, magnitude);
+
+        magnitudeSum = vaddq_f32(magnitudeSum, magnitude);
+        totalEnergy = vaddq_f32(totalEnergy, energy);
+        maxMagnitude = vmaxq_f32(maxMagnitude, magnitude);
+
+        const uint32x4_t lowMask = vcltq_f32(frequency, lowLimit);
+        const uint32x4_t belowMidLimit = vcltq_f32(frequency, midLimit);
+        const uint32x4_t midMask = vbicq_u32(belowMidLimit, lowMask);
+        lowEnergy = vaddq_f32(lowEnergy, maskedSelect(lowMask, energy));
+        midEnergy = vaddq_f32(midEnergy, maskedSelect(midMask, energy));
+        highEnergy = vaddq_f32(highEnergy, maskedSelect(vmvnq_u32(belowMidLimit), energy));
+
+        const uint32x4_t positiveMask = vcgtq_f32(magnitude, epsilon);
+        const float32x4_t positiveMagnitude = maskedSelect(positiveMask, magnitude);
+        positiveMagnitudeSum = vaddq_f32(positiveMagnitudeSum, positiveMagnitude);
+        positiveCount = vaddq_f32(positiveCount, maskedSelect(positiveMask, one));
+        logMagnitudeSum = vaddq_f32(
+            logMagnitudeSum,
+            maskedSelect(positiveMask, fastLog(vmaxq_f32(magnitude, epsilon))));
+
+        const uint32x4_t audibleMask = vandq_u32(
+            vcgeq_f32(frequency, minFrequency),
+            vcleq_f32(frequency, maxFrequency));
+        const float32x4_t audibleMagnitude = maskedSelect(audibleMask, positiveMagnitude);
+        const float32x4_t weightedFrequency = vmulq_f32(audibleMagnitude, frequency);
+        audibleWeightSum = vaddq_f32(audibleWeightSum, audibleMagnitude);
+        weightedFrequencySum = vaddq_f32(weightedFrequencySum, weightedFrequency);
+    }
+
+    SpectralDescriptors::Accumulators sums{};
+    sums.magnitudeSum = horizontalSum(magnitudeSum);
+    sums.positiveMagnitudeSum = horizontalSum(positiveMagnitudeSum);
+    sums.positiveCount = horizontalSum(positiveCount);
+    sums.logMagnitudeSum = horizontalSum(logMagnitudeSum);
+    sums.audibleWeightSum = horizontalSum(audibleWeightSum);
+    sums.weightedFrequencySum = horizontalSum(weightedFrequencySum);
+    sums.totalEnergy = horizontalSum(totalEnergy);
+    sums.maxMagnitude = horizontalMax(maxMagnitude);
+    sums.lowEnergy = horizontalSum(lowEnergy);
+    sums.midEnergy = horizontalSum(midEnergy);
+    sums.highEnergy = horizontalSum(highEnergy);
+
+    for (; i < size; ++i) {
+        SpectralDescriptors::accumulateBin(sums, magnitudes[i], frequencies[i]);
+    }
+
+    return sums;
+}
+
+#ifdef __aarch64__
+// Bins 0-1 of each group of four go to lowSum and 2-3 to highSum, the scalar path's lanes.
+// Multiplies and adds stay separate, as vfmaq_f64 would round differently from scalar code.
+double weightedSquaredDeviation(std::span<const float> magnitudes,
+                                std::span<const float> frequencies,
+                                const double centre) {
+    const size_t size = std::min(magnitudes.size(), frequencies.size());
+    const size_t vectorSize = size & ~static_cast<size_t>(3);
+
+    const float32x4_t epsilon = vdupq_n_f32(SpectralDescriptors::MAGNITUDE_EPSILON);
+    const float32x4_t minFrequency = vdupq_n_f32(synesthesia::constants::MIN_AUDIO_FREQ);
+    const float32x4_t maxFrequency = vdupq_n_f32(synesthesia::constants::MAX_AUDIO_FREQ);
+    const float64x2_t centreLanes = vdupq_n_f64(centre);
+
+    float64x2_t lowSum = vdupq_n_f64(0.0);
+    float64x2_t highSum = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i < vectorSize; i += 4) {
+        const float32x4_t magnitude = vld1q_f32(&magnitudes[i]);
+        const float32x4_t frequency = vld1q_f32(&frequencies[i]);
+        const uint32x4_t weightMask = vandq_u32(
+            vcgtq_f32(magnitude, epsilon),
+            vandq_u32(vcgeq_f32(frequency, minFrequency), vcleq_f32(frequency, maxFrequency)));
+        const float32x4_t weight = maskedSelect(weightMask, magnitude);
+
+        const float64x2_t lowDeviation = vsubq_f64(vcvt_f64_f32(vget_low_f32(frequency)), centreLanes);
+        const float64x2_t highDeviation = vsubq_f64(vcvt_high_f64_f32(frequency), centreLanes);
+        lowSum = vaddq_f64(lowSum, vmulq_f64(vcvt_f64_f32(vget_low_f32(weight)),
+                                             vmulq_f64(lowDeviation, lowDeviation)));
+        highSum = vaddq_f64(highSum, vmulq_f64(vcvt_high_f64_f32(weight),
+                                               vmulq_f64(highDeviation, highDeviation)));
+    }
+
+    double sum = (vgetq_lane_f64(lowSum, 0) + vgetq_lane_f64(lowSum, 1)) +
+                 (vgetq_lane_f64(highSum, 0) + vgetq_lane_f64(highSum, 1));
+    for (; i < size; ++i) {
+        sum += SpectralDescriptors::squaredDeviationTerm(magnitudes[i], frequencies[i], centre);
+    }
+    return sum;
+}
+#endif
+
+}
+
+#endif
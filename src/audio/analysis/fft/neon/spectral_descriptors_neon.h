@@ -0,0 +1,22 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <span>
+
+#include "spectral_descriptors.h"
+
+namespace SpectralDescriptorsNEON {
+    float32x4_t fastLog(float32x4_t values);
+
+    SpectralDescriptors::Accumulators accumulate(std::span<const float> magnitudes,
+                                                 std::span<const float> frequencies);
+
+#ifdef __aarch64__
+    double weightedSquaredDeviation(std::span<const float> magnitudes,
+                                    std::span<const float> frequencies,
+                                    double centre);
+#endif
+}
+
+#endif
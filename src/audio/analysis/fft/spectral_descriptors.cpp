@@ -0,0 +1,63 @@
+#include "spectral_descriptors.h"
+
+#include <array>
+
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/spectral_descriptors_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/spectral_descriptors_sse.h"
+#endif
+
+namespace SpectralDescriptors {
+
+Accumulators accumulateScalar(std::span<const float> magnitudes, std::span<const float> frequencies) {
+    Accumulators sums{};
+    const size_t count = std::min(magnitudes.size(), frequencies.size());
+    for (size_t i = 0; i < count; ++i) {
+        accumulateBin(sums, magnitudes[i], frequencies[i]);
+    }
+    return sums;
+}
+
+Accumulators accumulate(std::span<const float> magnitudes, std::span<const float> frequencies) {
+#ifdef USE_NEON_OPTIMISATIONS
+    return SpectralDescriptorsNEON::accumulate(magnitudes, frequencies);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    return SpectralDescriptorsSSE::accumulate(magnitudes, frequencies);
+#else
+    return accumulateScalar(magnitudes, frequencies);
+#endif
+}
+
+double weightedSquaredDeviationScalar(std::span<const float> magnitudes,
+                                      std::span<const float> frequencies,
+                                      const double centre) {
+    const size_t count = std::min(magnitudes.size(), frequencies.size());
+    const size_t vectorCount = count & ~static_cast<size_t>(3);
+    std::array<double, 4> lanes{};
+    size_t i = 0;
+    for (; i < vectorCount; i += 4) {
+        for (size_t lane = 0; lane < lanes.size(); ++lane) {
+            lanes[lane] += squaredDeviationTerm(magnitudes[i + lane], frequencies[i + lane], centre);
+        }
+    }
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < count; ++i) {
+        sum += squaredDeviationTerm(magnitudes[i], frequencies[i], centre);
+    }
+    return sum;
+}
+
+double weightedSquaredDeviation(std::span<const float> magnitudes,
+                                std::span<const float> frequencies,
+                                const double centre) {
+#if defined(USE_NEON_OPTIMISATIONS) && defined(__aarch64__)
+    return SpectralDescriptorsNEON::weightedSquaredDeviation(magnitudes, frequencies, centre);
+#elif !defined(USE_NEON_OPTIMISATIONS) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+    return SpectralDescriptorsSSE::weightedSquaredDeviation(magnitudes, frequencies, centre);
+#else
+    return weightedSquaredDeviationScalar(magnitudes, frequencies, centre);
+#endif
+}
+
+}
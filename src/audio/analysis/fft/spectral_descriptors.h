@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+#include "constants.h"
+
+namespace SpectralDescriptors {
+
+constexpr float MAGNITUDE_EPSILON = 1e-6f;
+constexpr float LOW_BAND_LIMIT_HZ = 220.0f;
+constexpr float MID_BAND_LIMIT_HZ = 2200.0f;
+
+// Running sums for every per-frame spectral descriptor but the spread, gathered in one pass
+// over the bins. Magnitudes are expected to be finite and non-negative.
+struct Accumulators {
+    float magnitudeSum = 0.0f;
+    float positiveMagnitudeSum = 0.0f;
+    float positiveCount = 0.0f;
+    float logMagnitudeSum = 0.0f;
+    float audibleWeightSum = 0.0f;
+    float weightedFrequencySum = 0.0f;
+    float totalEnergy = 0.0f;
+    float maxMagnitude = 0.0f;
+    float lowEnergy = 0.0f;
+    float midEnergy = 0.0f;
+    float highEnergy = 0.0f;
+};
+
+inline void accumulateBin(Accumulators& sums, const float magnitude, const float frequency) {
+    const float energy = magnitude * magnitude;
+    sums.magnitudeSum += magnitude;
+    sums.totalEnergy += energy;
+    sums.maxMagnitude = std::max(sums.maxMagnitude, magnitude);
+
+    if (frequency < LOW_BAND_LIMIT_HZ) {
+        sums.lowEnergy += energy;
+    } else if (frequency < MID_BAND_LIMIT_HZ) {
+        sums.midEnergy += energy;
+    } else {
+        sums.highEnergy += energy;
+    }
+
+    if (magnitude <= MAGNITUDE_EPSILON) {
+        return;
+    }
+
+    sums.positiveMagnitudeSum += magnitude;
+    sums.positiveCount += 1.0f;
+    sums.logMagnitudeSum += std::log(magnitude);
+
+    if (frequency >= synesthesia::constants::MIN_AUDIO_FREQ &&
+        frequency <= synesthesia::constants::MAX_AUDIO_FREQ) {
+        const float weightedFrequency = magnitude * frequency;
+        sums.audibleWeightSum += magnitude;
+        sums.weightedFrequencySum += weightedFrequency;
+    }
+}
+
+// One bin's share of the spread sum: zero unless the bin also weights the centroid.
+inline double squaredDeviationTerm(const float magnitude, const float frequency, const double centre) {
+    if (magnitude <= MAGNITUDE_EPSILON ||
+        frequency < synesthesia::constants::MIN_AUDIO_FREQ ||
+        frequency > synesthesia::constants::MAX_AUDIO_FREQ) {
+        return 0.0;
+    }
+    const double deviation = static_cast<double>(frequency) - centre;
+    return static_cast<double>(magnitude) * (deviation * deviation);
+}
+
+Accumulators accumulate(std::span<const float> magnitudes, std::span<const float> frequencies);
+Accumulators accumulateScalar(std::span<const float> magnitudes, std::span<const float> frequencies);
+
+// The spread's second pass: the magnitude-weighted sum of (frequency - centre)^2 over the bins
+// the centroid weights. Taking E[f^2] - centroid^2 from the first pass instead cancels to noise
+// once the spread is small beside the centroid, as for a tonal or bright frame, so this runs
+// in double about the centroid itself. Every path keeps four interleaved partial sums joined
+// as (0 + 1) + (2 + 3) before the tail, so the SIMD kernels match the scalar one bit for bit.
+double weightedSquaredDeviation(std::span<const float> magnitudes,
+                                std::span<const float> frequencies,
+                                double centre);
+double weightedSquaredDeviationScalar(std::span<const float> magnitudes,
+                                      std::span<const float> frequencies,
+                                      double centre);
+
+}
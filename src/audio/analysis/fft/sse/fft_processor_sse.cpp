@@ -5,6 +5,9 @@
 #include <algorithm>
 #include <cmath>
 
+#include "audio/analysis/fft/avx/fft_processor_avx.h"
+#include "utilities/cpu/cpu_features.h"
+
 namespace FFTProcessorSSE {
 
 bool isSSEAvailable() {
@@ -17,6 +20,11 @@ void applyHannWindow(std::span<float> output, std::span<const float> input,
     const size_t vectorSize = size & ~3u;
 
     size_t i = 0;
+    if (Utilities::CPU::hasAVX512()) {
+        i = FFTProcessorAVX512::applyHannWindow(output.data(), input.data(), window.data(), size);
+    } else if (Utilities::CPU::hasAVX2()) {
+        i = FFTProcessorAVX2::applyHannWindow(output.data(), input.data(), window.data(), size);
+    }
 
     for (; i < vectorSize; i += 4) {
         __m128 inputVec = _mm_loadu_ps(&input[i]);
@@ -248,6 +256,124 @@ float vectorMax(std::span<const float> data) {
     return maxVal;
 }
 
+float sumOfCubes(std::span<const float> data) {
+    const size_t size = data.size();
+    const size_t vectorSize = size & ~3u;
+
+    __m128 sumVec = _mm_setzero_ps();
+    size_t i = 0;
+
+    for (; i < vectorSize; i += 4) {
+        __m128 dataVec = _mm_loadu_ps(&data[i]);
+        __m128 cubes = _mm_mul_ps(_mm_mul_ps(dataVec, dataVec), dataVec);
+        sumVec = _mm_add_ps(sumVec, cubes);
+    }
+
+    __m128 shuffled = _mm_shuffle_ps(sumVec, sumVec, _MM_SHUFFLE(2, 3, 0, 1));
+    sumVec = _mm_add_ps(sumVec, shuffled);
+    shuffled = _mm_shuffle_ps(sumVec, sumVec, _MM_SHUFFLE(1, 0, 3, 2));
+    sumVec = _mm_add_ps(sumVec, shuffled);
+    float sum = _mm_cvtss_f32(sumVec);
+
+    for (; i < size; ++i) {
+        sum += data[i] * data[i] * data[i];
+    }
+
+    return sum;
+}
+
+void calculateBandMagnitudes(std::span<float> magnitudes, const kiss_fft_cpx* fft_output,
+                             size_t firstBin, size_t lastBin,
+                             float& outMaxMagnitude, float& outTotalEnergy) {
+    const size_t size = magnitudes.size();
+    lastBin = std::min(lastBin, size - 1);
+    vectorFill(magnitudes.subspan(0, firstBin), 0.0f);
+    vectorFill(magnitudes.subspan(lastBin + 1), 0.0f);
+
+    float wideEnergy = 0.0f;
+    float wideMax = 0.0f;
+    size_t i = firstBin;
+    if (firstBin <= lastBin) {
+        if (Utilities::CPU::hasAVX512()) {
+            i = FFTProcessorAVX512::calculateBandMagnitudes(magnitudes.data(), fft_output, firstBin, lastBin,
+                                                            wideMax, wideEnergy);
+        } else if (Utilities::CPU::hasAVX2()) {
+            i = FFTProcessorAVX2::calculateBandMagnitudes(magnitudes.data(), fft_output, firstBin, lastBin,
+                                                          wideMax, wideEnergy);
+        }
+    }
+
+    __m128 energyVec = _mm_setzero_ps();
+    __m128 maxVec = _mm_setzero_ps();
+
+    for (; i + 4 <= lastBin + 1; i += 4) {
+        // kiss_fft_cpx is {r, i}, so two loads hold four bins and two shuffles split them.
+        const __m128 low = _mm_loadu_ps(&fft_output[i].r);
+        const __m128 high = _mm_loadu_ps(&fft_output[i + 2].r);
+        const __m128 real = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 imag = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m128 power = _mm_add_ps(_mm_mul_ps(real, real), _mm_mul_ps(imag, imag));
+        const __m128 magnitude = _mm_sqrt_ps(power);
+        _mm_storeu_ps(&magnitudes[i], magnitude);
+
+        energyVec = _mm_add_ps(energyVec, power);
+        maxVec = _mm_max_ps(maxVec, magnitude);
+    }
+
+    __m128 shuffled = _mm_shuffle_ps(energyVec, energyVec, _MM_SHUFFLE(2, 3, 0, 1));
+    energyVec = _mm_add_ps(energyVec, shuffled);
+    shuffled = _mm_shuffle_ps(energyVec, energyVec, _MM_SHUFFLE(1, 0, 3, 2));
+    energyVec = _mm_add_ps(energyVec, shuffled);
+    float energy = _mm_cvtss_f32(energyVec) + wideEnergy;
+
+    shuffled = _mm_shuffle_ps(maxVec, maxVec, _MM_SHUFFLE(2, 3, 0, 1));
+    maxVec = _mm_max_ps(maxVec, shuffled);
+    shuffled = _mm_shuffle_ps(maxVec, maxVec, _MM_SHUFFLE(1, 0, 3, 2));
+    maxVec = _mm_max_ps(maxVec, shuffled);
+    float maxMagnitude = std::max(_mm_cvtss_f32(maxVec), wideMax);
+
+    for (; i <= lastBin; ++i) {
+        const float power = fft_output[i].r * fft_output[i].r + fft_output[i].i * fft_output[i].i;
+        const float magnitude = std::sqrt(power);
+        magnitudes[i] = magnitude;
+        energy += power;
+        maxMagnitude = std::max(maxMagnitude, magnitude);
+    }
+
+    outMaxMagnitude = maxMagnitude;
+    outTotalEnergy = energy;
+}
+
+float accumulatePositiveFlux(std::span<const float> current, std::span<float> previous) {
+    const size_t size = std::min(current.size(), previous.size());
+    const size_t vectorSize = size & ~3u;
+
+    const __m128 zero = _mm_setzero_ps();
+    __m128 fluxVec = _mm_setzero_ps();
+    size_t i = 0;
+
+    for (; i < vectorSize; i += 4) {
+        const __m128 currentVec = _mm_loadu_ps(&current[i]);
+        const __m128 previousVec = _mm_loadu_ps(&previous[i]);
+        fluxVec = _mm_add_ps(fluxVec, _mm_max_ps(_mm_sub_ps(currentVec, previousVec), zero));
+        _mm_storeu_ps(&previous[i], currentVec);
+    }
+
+    __m128 shuffled = _mm_shuffle_ps(fluxVec, fluxVec, _MM_SHUFFLE(2, 3, 0, 1));
+    fluxVec = _mm_add_ps(fluxVec, shuffled);
+    shuffled = _mm_shuffle_ps(fluxVec, fluxVec, _MM_SHUFFLE(1, 0, 3, 2));
+    fluxVec = _mm_add_ps(fluxVec, shuffled);
+    float flux = _mm_cvtss_f32(fluxVec);
+
+    for (; i < size; ++i) {
+        flux += std::max(current[i] - previous[i], 0.0f);
+        previous[i] = current[i];
+    }
+
+    return flux;
+}
+
 void calculateMagnitudesFromComplex(std::span<float> magnitudes,
                                    const kiss_fft_cpx* fft_output, size_t count) {
     const size_t size = std::min(magnitudes.size(), count);
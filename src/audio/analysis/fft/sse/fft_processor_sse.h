@@ -30,6 +30,19 @@ namespace FFTProcessorSSE {
     float vectorSum(std::span<const float> data);
     float vectorMax(std::span<const float> data);
 
+    // Sum of data[i]^3, for band energies on the cubic loudness scale.
+    float sumOfCubes(std::span<const float> data);
+
+    // One pass over the spectrum: magnitudes of bins [firstBin, lastBin], zero elsewhere,
+    // with the band's total power and largest magnitude.
+    void calculateBandMagnitudes(std::span<float> magnitudes, const kiss_fft_cpx* fft_output,
+                                 size_t firstBin, size_t lastBin,
+                                 float& outMaxMagnitude, float& outTotalEnergy);
+
+    // Half-wave rectified flux of current against previous, copying current into previous
+    // on the way.
+    float accumulatePositiveFlux(std::span<const float> current, std::span<float> previous);
+
     bool isSSEAvailable();
 }
 
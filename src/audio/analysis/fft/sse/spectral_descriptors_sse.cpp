@@ -0,0 +1,184 @@
+#include "spectral_descriptors_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <algorithm>
+
+namespace SpectralDescriptorsSSE {
+
+namespace {
+
+float horizontalSum(__m128 values) {
+    __m128 shuffled = _mm_shuffle_ps(values, values, _MM_SHUFFLE(2, 3, 0, 1));
+    values = _mm_add_ps(values, shuffled);
+    shuffled = _mm_shuffle_ps(values, values, _MM_SHUFFLE(1, 0, 3, 2));
+    values = _mm_add_ps(values, shuffled);
+    return _mm_cvtss_f32(values);
+}
+
+float horizontalMax(__m128 values) {
+    __m128 shuffled = _mm_shuffle_ps(values, values, _MM_SHUFFLE(2, 3, 0, 1));
+    values = _mm_max_ps(values, shuffled);
+    shuffled = _mm_shuffle_ps(values, values, _MM_SHUFFLE(1, 0, 3, 2));
+    values = _mm_max_ps(values, shuffled);
+    return _mm_cvtss_f32(values);
+}
+
+}
+
+// Cephes-style natural log for positive normal inputs: split into mantissa and exponent,
+// then evaluate a degree-9 polynomial around 1.
+__m128 fastLog(__m128 values) {
+    const __m128i bits = _mm_castps_si128(values);
+    const __m128i exponentBits = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126));
+    __m128 exponent = _mm_cvtepi32_ps(exponentBits);
+    __m128 mantissa = _mm_or_ps(
+        _mm_castsi128_ps(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff))),
+        _mm_set1_ps(0.5f));
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 belowSqrtHalf = _mm_cmplt_ps(mantissa, _mm_set1_ps(0.707106781186547524f));
+    exponent = _mm_sub_ps(exponent, _mm_and_ps(one, belowSqrtHalf));
+    mantissa = _mm_add_ps(_mm_sub_ps(mantissa, one), _mm_and_ps(mantissa, belowSqrtHalf));
+
+    const __m128 x = mantissa;
+    const __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(7.0376836292e-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174e-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+    y = _mm_add_ps(y, _mm_mul_ps(exponent, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+
+    __m128 result = _mm_add_ps(x, y);
+    return _mm_add_ps(result, _mm_mul_ps(exponent, _mm_set1_ps(0.693359375f)));
+}
+
+SpectralDescriptors::Accumulators accumulate(std::span<const float> magnitudes,
+                                             std::span<const float> frequencies) {
+    const size_t size = std::min(magnitudes.size(), frequencies.size());
+    const size_t vectorSize = size & ~static_cast<size_t>(3);
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 epsilon = _mm_set1_ps(SpectralDescriptors::MAGNITUDE_EPSILON);
+    const __m128 minFrequency = _mm_set1_ps(synesthesia::constants::MIN_AUDIO_FREQ);
+    const __m128 maxFrequency = _mm_set1_ps(synesthesia::constants::MAX_AUDIO_FREQ);
+    const __m128 lowLimit = _mm_set1_ps(SpectralDescriptors::LOW_BAND_LIMIT_HZ);
+    const __m128 midLimit = _mm_set1_ps(SpectralDescriptors::MID_BAND_LIMIT_HZ);
+
+    __m128 magnitudeSum = _mm_setzero_ps();
+    __m128 positiveMagnitudeSum = _mm_setzero_ps();
+    __m128 positiveCount = _mm_setzero_ps();
+    __m128 logMagnitudeSum = _mm_setzero_ps();
+    __m128 audibleWeightSum = _mm_setzero_ps();
+    __m128 weightedFrequencySum = _mm_setzero_ps();
+    __m128 totalEnergy = _mm_setzero_ps();
+    __m128 maxMagnitude = _mm_setzero_ps();
+    __m128 lowEnergy = _mm_setzero_ps();
+    __m128 midEnergy = _mm_setzero_ps();
+    __m128 highEnergy = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i < vectorSize; i += 4) {
+        const __m128 magnitude = _mm_loadu_ps(&magnitudes[i]);
+        const __m128 frequency = _mm_loadu_ps(&frequencies[i]);
+        const __m128 energy = _mm_mul_ps(magnitude, magnitude);
+
+        magnitudeSum = _mm_add_ps(magnitudeSum, magnitude);
+        totalEnergy = _mm_add_ps(totalEnergy, energy);
+        maxMagnitude = _mm_max_ps(maxMagnitude, magnitude);
+
+        const __m128 lowMask = _mm_cmplt_ps(frequency, lowLimit);
+        const __m128 belowMidLimit = _mm_cmplt_ps(frequency, midLimit);
+        const __m128 midMask = _mm_andnot_ps(lowMask, belowMidLimit);
+        lowEnergy = _mm_add_ps(lowEnergy, _mm_and_ps(lowMask, energy));
+        midEnergy = _mm_add_ps(midEnergy, _mm_and_ps(midMask, energy));
+        highEnergy = _mm_add_ps(highEnergy, _mm_andnot_ps(belowMidLimit, energy));
+
+        const __m128 positiveMask = _mm_cmpgt_ps(magnitude, epsilon);
+        const __m128 positiveMagnitude = _mm_and_ps(positiveMask, magnitude);
+        positiveMagnitudeSum = _mm_add_ps(positiveMagnitudeSum, positiveMagnitude);
+        positiveCount = _mm_add_ps(positiveCount, _mm_and_ps(positiveMask, one));
+        logMagnitudeSum = _mm_add_ps(
+            logMagnitudeSum,
+            _mm_and_ps(positiveMask, fastLog(_mm_max_ps(magnitude, epsilon))));
+
+        const __m128 audibleMask = _mm_and_ps(
+            _mm_cmpge_ps(frequency, minFrequency),
+            _mm_cmple_ps(frequency, maxFrequency));
+        const __m128 audibleMagnitude = _mm_and_ps(audibleMask, positiveMagnitude);
+        const __m128 weightedFrequency = _mm_mul_ps(audibleMagnitude, frequency);
+        audibleWeightSum = _mm_add_ps(audibleWeightSum, audibleMagnitude);
+        weightedFrequencySum = _mm_add_ps(weightedFrequencySum, weightedFrequency);
+    }
+
+    SpectralDescriptors::Accumulators sums{};
+    sums.magnitudeSum = horizontalSum(magnitudeSum);
+    sums.positiveMagnitudeSum = horizontalSum(positiveMagnitudeSum);
+    sums.positiveCount = horizontalSum(positiveCount);
+    sums.logMagnitudeSum = horizontalSum(logMagnitudeSum);
+    sums.audibleWeightSum = horizontalSum(audibleWeightSum);
+    sums.weightedFrequencySum = horizontalSum(weightedFrequencySum);
+    sums.totalEnergy = horizontalSum(totalEnergy);
+    sums.maxMagnitude = horizontalMax(maxMagnitude);
+    sums.lowEnergy = horizontalSum(lowEnergy);
+    sums.midEnergy = horizontalSum(midEnergy);
+    sums.highEnergy = horizontalSum(highEnergy);
+
+    for (; i < size; ++i) {
+        SpectralDescriptors::accumulateBin(sums, magnitudes[i], frequencies[i]);
+    }
+
+    return sums;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+// Bins 0-1 of each group of four go to lowSum and 2-3 to highSum, the scalar path's lanes.
+double weightedSquaredDeviation(std::span<const float> magnitudes,
+                                std::span<const float> frequencies,
+                                const double centre) {
+    const size_t size = std::min(magnitudes.size(), frequencies.size());
+    const size_t vectorSize = size & ~static_cast<size_t>(3);
+
+    const __m128 epsilon = _mm_set1_ps(SpectralDescriptors::MAGNITUDE_EPSILON);
+    const __m128 minFrequency = _mm_set1_ps(synesthesia::constants::MIN_AUDIO_FREQ);
+    const __m128 maxFrequency = _mm_set1_ps(synesthesia::constants::MAX_AUDIO_FREQ);
+    const __m128d centreLanes = _mm_set1_pd(centre);
+
+    __m128d lowSum = _mm_setzero_pd();
+    __m128d highSum = _mm_setzero_pd();
+
+    size_t i = 0;
+    for (; i < vectorSize; i += 4) {
+        const __m128 magnitude = _mm_loadu_ps(&magnitudes[i]);
+        const __m128 frequency = _mm_loadu_ps(&frequencies[i]);
+        const __m128 weightMask = _mm_and_ps(
+            _mm_cmpgt_ps(magnitude, epsilon),
+            _mm_and_ps(_mm_cmpge_ps(frequency, minFrequency), _mm_cmple_ps(frequency, maxFrequency)));
+        const __m128 weight = _mm_and_ps(weightMask, magnitude);
+
+        const __m128d lowDeviation = _mm_sub_pd(_mm_cvtps_pd(frequency), centreLanes);
+        const __m128d highDeviation = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(frequency, frequency)), centreLanes);
+        lowSum = _mm_add_pd(lowSum, _mm_mul_pd(_mm_cvtps_pd(weight), _mm_mul_pd(lowDeviation, lowDeviation)));
+        highSum = _mm_add_pd(highSum, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(weight, weight)),
+                                                 _mm_mul_pd(highDeviation, highDeviation)));
+    }
+
+    double sum = (_mm_cvtsd_f64(lowSum) + _mm_cvtsd_f64(_mm_unpackhi_pd(lowSum, lowSum))) +
+                 (_mm_cvtsd_f64(highSum) + _mm_cvtsd_f64(_mm_unpackhi_pd(highSum, highSum)));
+    for (; i < size; ++i) {
+        sum += SpectralDescriptors::squaredDeviationTerm(magnitudes[i], frequencies[i], centre);
+    }
+    return sum;
+}
+#endif
+
+}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#include <span>
+
+#include "spectral_descriptors.h"
+
+namespace SpectralDescriptorsSSE {
+    __m128 fastLog(__m128 values);
+
+    SpectralDescriptors::Accumulators accumulate(std::span<const float> magnitudes,
+                                                 std::span<const float> frequencies);
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    double weightedSquaredDeviation(std::span<const float> magnitudes,
+                                    std::span<const float> frequencies,
+                                    double centre);
+#endif
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "stereo_fft_processor.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include "utilities/profiling/frame_profiler.h"
+#include "utilities/threading/task_scheduler.h"
+
+StereoFFTProcessor::StereoFFTProcessor(const int size)
+	: fftSize(size) {
+	if (!FFTProcessor::isSupportedFFTSize(size)) {
+		throw std::invalid_argument("Unsupported FFT size.");
+	}
+	transform = FFTBackend::createComplex(size);
+	packedInput.resize(static_cast<size_t>(size));
+	packedOutput.resize(static_cast<size_t>(size));
+}
+
+bool StereoFFTProcessor::inLockstep(const FFTProcessor& left, const FFTProcessor& right) {
+	return left.fftSize == right.fftSize &&
+		   left.historyWrite == right.historyWrite &&
+		   left.samplesSinceFrame == right.samplesSinceFrame &&
+		   left.analysisHopSize == right.analysisHopSize &&
+		   left.pendingHopSize == right.pendingHopSize;
+}
+
+void StereoFFTProcessor::transformPair(FFTBackend::ComplexTransform& complexTransform,
+									   const std::span<const float> left, const std::span<const float> right,
+									   const std::span<kiss_fft_cpx> packedInput,
+									   const std::span<kiss_fft_cpx> packedOutput,
+									   const std::span<kiss_fft_cpx> leftSpectrum,
+									   const std::span<kiss_fft_cpx> rightSpectrum) {
+	const size_t size = packedInput.size();
+	for (size_t n = 0; n < size; ++n) {
+		packedInput[n] = {left[n], right[n]};
+	}
+	complexTransform.forward(packedInput, packedOutput);
+
+	for (size_t k = 0; k <= size / 2; ++k) {
+		const kiss_fft_cpx z = packedOutput[k];
+		const kiss_fft_cpx mirror = packedOutput[k == 0 ? 0 : size - k];
+		leftSpectrum[k] = {0.5f * (z.r + mirror.r), 0.5f * (z.i - mirror.i)};
+		rightSpectrum[k] = {0.5f * (z.i + mirror.i), 0.5f * (mirror.r - z.r)};
+	}
+}
+
+void StereoFFTProcessor::processBuffer(FFTProcessor& left, FFTProcessor& right,
+									   const FFTProcessor::ChannelView leftSamples,
+									   const FFTProcessor::ChannelView rightSamples,
+									   const float sampleRate) {
+	if (sampleRate <= 0.0f || leftSamples.data == nullptr || rightSamples.data == nullptr ||
+		leftSamples.frameCount == 0) {
+		return;
+	}
+
+	{
+		std::scoped_lock processingLock(left.processingMutex, right.processingMutex);
+		if (left.fftSize == fftSize && leftSamples.frameCount == rightSamples.frameCount &&
+			inLockstep(left, right)) {
+			if (left.criticalBands.empty()) {
+				left.initialiseCriticalBands(sampleRate);
+			}
+			if (right.criticalBands.empty()) {
+				right.initialiseCriticalBands(sampleRate);
+			}
+
+			size_t framePos = 0;
+			while (framePos < leftSamples.frameCount) {
+				const size_t samplesToCopy = std::min(left.historySpace(), leftSamples.frameCount - framePos);
+				const bool frameReady = left.appendHistory(leftSamples.data + framePos * leftSamples.stride,
+														   leftSamples.stride, samplesToCopy, sampleRate);
+				right.appendHistory(rightSamples.data + framePos * rightSamples.stride,
+									rightSamples.stride, samplesToCopy, sampleRate);
+				framePos += samplesToCopy;
+
+				if (frameReady) {
+					SYN_PROFILE_SCOPE(FFTWindow);
+					left.applyWindow();
+					right.applyWindow();
+					transformPair(*transform, left.fft_in, right.fft_in, packedInput, packedOutput, left.fft_out, right.fft_out);
+					left.analyseSpectrum(sampleRate);
+					right.analyseSpectrum(sampleRate);
+					left.completeFrame();
+					right.completeFrame();
+				}
+			}
+			return;
+		}
+	}
+
+	left.processBuffer(leftSamples, sampleRate);
+	right.processBuffer(rightSamples, sampleRate);
+}
+
+void StereoFFTProcessor::analyseSignalFrames(const FFTProcessor& analyser,
+											 const std::span<const float> left, const std::span<const float> right,
+											 const size_t signalStart, const float sampleRate, const int hopSize,
+											 const size_t firstFrame, const size_t frameCount,
+											 FFTProcessor::SignalFrames& leftFrames,
+											 FFTProcessor::SignalFrames& rightFrames) {
+	if (left.size() != right.size()) {
+		const size_t workerCount = Utilities::Threading::TaskScheduler::shared().workerCount();
+		analyser.analyseSignalFrames(left, signalStart, sampleRate, hopSize, firstFrame, frameCount,
+									 leftFrames, workerCount);
+		analyser.analyseSignalFrames(right, signalStart, sampleRate, hopSize, firstFrame, frameCount,
+									 rightFrames, workerCount);
+		return;
+	}
+
+	analyser.prepareSignalFrames(leftFrames, firstFrame, frameCount);
+	analyser.prepareSignalFrames(rightFrames, firstFrame, frameCount);
+	if (frameCount == 0 || sampleRate <= 0.0f) {
+		return;
+	}
+
+	const int size = analyser.getFFTSize();
+	const size_t hop = static_cast<size_t>(std::clamp(hopSize, 1, size));
+	const size_t windowSize = static_cast<size_t>(size);
+
+	// Every range plans its own transform; a failed plan is rethrown by parallelFor.
+	Utilities::Threading::TaskScheduler::shared().parallelFor(frameCount, MIN_RANGE_FRAMES, [&](const size_t rangeStart, const size_t rangeEnd) {
+		const auto complexTransform = FFTBackend::createComplex(size);
+		std::vector<float> padded(windowSize, 0.0f);
+		std::vector<float> leftInput(windowSize, 0.0f);
+		std::vector<float> rightInput(windowSize, 0.0f);
+		std::vector<kiss_fft_cpx> packedInput(windowSize);
+		std::vector<kiss_fft_cpx> packedOutput(windowSize);
+		std::vector<kiss_fft_cpx> leftSpectrum(analyser.getBinCount());
+		std::vector<kiss_fft_cpx> rightSpectrum(analyser.getBinCount());
+
+		for (size_t local = rangeStart; local < rangeEnd; ++local) {
+			const size_t end = (firstFrame + local + 1) * hop;
+			analyser.windowSignalFrame(left, signalStart, end, leftInput, padded);
+			analyser.windowSignalFrame(right, signalStart, end, rightInput, padded);
+			transformPair(*complexTransform, leftInput, rightInput, packedInput, packedOutput, leftSpectrum, rightSpectrum);
+			analyser.storeSignalFrame(leftSpectrum, sampleRate, leftFrames, local);
+			analyser.storeSignalFrame(rightSpectrum, sampleRate, rightFrames, local);
+		}
+	});
+}
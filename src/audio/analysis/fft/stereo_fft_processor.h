@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "fft_backend.h"
+#include "fft_processor.h"
+#include "kiss_fftr.h"
+
+// Analyses two channels with one complex transform. Left and right go in as its real and
+// imaginary parts and come apart again by the conjugate symmetry of a real signal's
+// spectrum, so a pair costs about one channel's transform. The channels keep their own
+// FFTProcessors for everything else: history, loudness, EQ, onset state and frame ring.
+// Rounding in the shared transform leaks into the quieter channel at around 1e-7 of the
+// louder one, well below anything the analysis resolves.
+class StereoFFTProcessor {
+public:
+	explicit StereoFFTProcessor(int fftSize = FFTProcessor::FFT_SIZE);
+
+	StereoFFTProcessor(const StereoFFTProcessor&) = delete;
+	StereoFFTProcessor& operator=(const StereoFFTProcessor&) = delete;
+
+	int getFFTSize() const { return fftSize; }
+
+	// FFTProcessor::processBuffer for both channels at once. The processors must be of this
+	// size and fed the same number of samples. A pair that has fallen out of step, after a
+	// reset or a hop change that reached one of them first, is run a channel at a time until
+	// it lines up again.
+	void processBuffer(FFTProcessor& left, FFTProcessor& right,
+					   FFTProcessor::ChannelView leftSamples, FFTProcessor::ChannelView rightSamples,
+					   float sampleRate);
+
+	// FFTProcessor::analyseSignalFrames for two equally long signals, with the analyser's
+	// size and window. Signals of different lengths are analysed one at a time. Frames are
+	// split into ranges of at least MIN_RANGE_FRAMES on the shared task scheduler.
+	static void analyseSignalFrames(const FFTProcessor& analyser,
+									std::span<const float> left, std::span<const float> right,
+									size_t signalStart, float sampleRate, int hopSize,
+									size_t firstFrame, size_t frameCount,
+									FFTProcessor::SignalFrames& leftFrames,
+									FFTProcessor::SignalFrames& rightFrames);
+
+private:
+	// Enough frames that planning a range's transform is a small share of its work.
+	static constexpr size_t MIN_RANGE_FRAMES = 16;
+
+	static bool inLockstep(const FFTProcessor& left, const FFTProcessor& right);
+	// Packs left and right as z = l + i·r, transforms z and writes bins 0 to N/2 of each
+	// channel's own spectrum: L[k] = (Z[k] + conj Z[N-k]) / 2, R[k] = (Z[k] - conj Z[N-k]) / 2i.
+	static void transformPair(FFTBackend::ComplexTransform& complexTransform,
+							  std::span<const float> left, std::span<const float> right,
+							  std::span<kiss_fft_cpx> packedInput, std::span<kiss_fft_cpx> packedOutput,
+							  std::span<kiss_fft_cpx> leftSpectrum, std::span<kiss_fft_cpx> rightSpectrum);
+
+	int fftSize;
+	std::unique_ptr<FFTBackend::ComplexTransform> transform;
+	std::vector<kiss_fft_cpx> packedInput;
+	std::vector<kiss_fft_cpx> packedOutput;
+};
@@ -3,14 +3,19 @@
 #include <algorithm>
 #include <cmath>
 #include <numbers>
-#include <numeric>
+
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/loudness_meter_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/loudness_meter_sse.h"
+#endif
 
 LoudnessMeter::LoudnessMeter()
 	: currentSampleRate(0.0f),
 	  blockSize(static_cast<size_t>(BLOCK_DURATION * 48000.0f)),
-	  hopSize(static_cast<size_t>(BLOCK_DURATION * 48000.0f * (1.0f - OVERLAP))),
-	  bufferPosition(0) {
-	audioBuffer.resize(blockSize, 0.0f);
+	  hopSize(static_cast<size_t>(BLOCK_DURATION * 48000.0f * (1.0f - OVERLAP))) {
+	blockHistory.resize(BLOCK_HISTORY_CAPACITY, -200.0f);
+	loudnessHistogram.resize(HISTOGRAM_BIN_COUNT);
 	initialiseFilters(48000.0f);
 }
 
@@ -26,10 +31,7 @@ void LoudnessMeter::initialiseFilters(const float sampleRate) {
 	currentSampleRate = sampleRate;
 	blockSize = static_cast<size_t>(BLOCK_DURATION * sampleRate);
 	hopSize = static_cast<size_t>(blockSize * (1.0f - OVERLAP));
-	audioBuffer.resize(blockSize, 0.0f);
-	bufferPosition = 0;
-	bufferInitialised = false;
-	samplesSinceLastBlock = 0;
+	resetSegments();
 
 	// ITU-R BS.1770-4 Stage 1: High-frequency shelving filter
 	// Centre frequency f0 ≈ 1681.97 Hz, Gain G ≈ 4.0 dB, Q ≈ 0.7071
@@ -79,43 +81,137 @@ void LoudnessMeter::BiquadFilter::reset() {
 	z[1] = 0.0f;
 }
 
+void LoudnessMeter::resetSegments() {
+	leadInSamples = blockSize - BLOCK_HOPS * hopSize;
+	segments = {};
+	currentSegment = {};
+	segmentPosition = 0;
+	// The first block also covers the leadInSamples before its hops; with none, that
+	// segment is already complete and empty.
+	completedSegments = leadInSamples == 0 ? 1 : 0;
+	segmentLength = leadInSamples == 0 ? hopSize : leadInSamples;
+}
+
 void LoudnessMeter::processSamples(const std::span<const float> samples, const float sampleRate) {
 	if (samples.empty())
 		return;
 
 	initialiseFilters(sampleRate);
+	processChannel(samples.data(), samples.size(), 1);
+}
 
-	for (const float sample : samples) {
-		const float filtered1 = preFilter.process(sample);
-		const float filtered2 = rlbFilter.process(filtered1);
+void LoudnessMeter::processInterleaved(const std::span<LoudnessMeter> meters, const std::span<const float> interleaved,
+									   const float sampleRate) {
+	const size_t channels = meters.size();
+	if (channels == 0 || interleaved.size() < channels)
+		return;
 
-		audioBuffer[bufferPosition] = filtered2;
-		const size_t previousPosition = bufferPosition;
-		bufferPosition = (bufferPosition + 1) % blockSize;
+	for (auto& meter : meters) {
+		meter.initialiseFilters(sampleRate);
+	}
 
-		if (!bufferInitialised && previousPosition > 0 && bufferPosition == 0) {
-			bufferInitialised = true;
+	const size_t frames = interleaved.size() / channels;
+	const bool inStep = std::ranges::all_of(meters, [&](const LoudnessMeter& meter) { return meter.inStepWith(meters[0]); });
+	if (!inStep) {
+		for (size_t ch = 0; ch < channels; ++ch) {
+			meters[ch].processChannel(interleaved.data() + ch, frames, channels);
 		}
+		return;
+	}
 
-		++samplesSinceLastBlock;
+	for (size_t frame = 0; frame < frames;) {
+		const size_t run = std::min(frames - frame, meters[0].samplesUntilBoundary());
+		const float* input = interleaved.data() + frame * channels;
+		size_t ch = 0;
+
+#if defined(USE_NEON_OPTIMISATIONS) || defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		for (; ch + 4 <= channels; ch += 4) {
+			const auto coefficients = [](const BiquadFilter& filter) {
+				return std::array<float, 5>{filter.b[0], filter.b[1], filter.b[2], filter.a[1], filter.a[2]};
+			};
+			std::array<std::array<float, 4>, 4> state{};
+			for (size_t lane = 0; lane < 4; ++lane) {
+				const LoudnessMeter& meter = meters[ch + lane];
+				state[0][lane] = meter.preFilter.z[0];
+				state[1][lane] = meter.preFilter.z[1];
+				state[2][lane] = meter.rlbFilter.z[0];
+				state[3][lane] = meter.rlbFilter.z[1];
+			}
+			std::array<float, 4> energy{};
+#ifdef USE_NEON_OPTIMISATIONS
+			LoudnessMeterNEON::kWeightFourChannels(input + ch, run, channels, coefficients(meters[ch].preFilter),
+												   coefficients(meters[ch].rlbFilter), state, energy);
+#else
+			LoudnessMeterSSE::kWeightFourChannels(input + ch, run, channels, coefficients(meters[ch].preFilter),
+												  coefficients(meters[ch].rlbFilter), state, energy);
+#endif
+			for (size_t lane = 0; lane < 4; ++lane) {
+				LoudnessMeter& meter = meters[ch + lane];
+				meter.preFilter.z = {state[0][lane], state[1][lane]};
+				meter.rlbFilter.z = {state[2][lane], state[3][lane]};
+				meter.advanceSegment(energy[lane], run);
+			}
+		}
+#endif
 
-		if (bufferInitialised && samplesSinceLastBlock >= hopSize) {
-			const float meanSquare = calculateMeanSquare(audioBuffer);
-			const float loudness = loudnessFromMeanSquare(meanSquare);
-			blockHistory.emplace_back(processedBlockCount, loudness);
-			++processedBlockCount;
-			samplesSinceLastBlock = 0;
+		for (; ch < channels; ++ch) {
+			meters[ch].advanceSegment(meters[ch].filterRun(input + ch, run, channels), run);
 		}
+		frame += run;
 	}
 }
 
-float LoudnessMeter::calculateMeanSquare(const std::span<const float> samples) const {
-	if (samples.empty())
-		return 0.0f;
+void LoudnessMeter::processChannel(const float* samples, const size_t frames, const size_t stride) {
+	for (size_t frame = 0; frame < frames;) {
+		const size_t run = std::min(frames - frame, samplesUntilBoundary());
+		advanceSegment(filterRun(samples + frame * stride, run, stride), run);
+		frame += run;
+	}
+}
+
+// Both K-weighting stages and the energy sum in one pass over the run.
+float LoudnessMeter::filterRun(const float* samples, const size_t frames, const size_t stride) {
+	float energy = 0.0f;
+	for (size_t frame = 0; frame < frames; ++frame) {
+		const float filtered = rlbFilter.process(preFilter.process(samples[frame * stride]));
+		energy += filtered * filtered;
+	}
+	return energy;
+}
 
-	const float sum = std::accumulate(samples.begin(), samples.end(), 0.0f,
-									  [](const float acc, const float val) { return acc + val * val; });
-	return sum / static_cast<float>(samples.size());
+size_t LoudnessMeter::samplesUntilBoundary() const {
+	const size_t tailStart = segmentLength - std::min(leadInSamples, segmentLength);
+	return segmentPosition < tailStart ? tailStart - segmentPosition : segmentLength - segmentPosition;
+}
+
+void LoudnessMeter::advanceSegment(const float energy, const size_t frames) {
+	currentSegment.energy += energy;
+	if (segmentPosition + std::min(leadInSamples, segmentLength) >= segmentLength) {
+		currentSegment.tailEnergy += energy;
+	}
+	segmentPosition += frames;
+	if (segmentPosition < segmentLength)
+		return;
+
+	segments[completedSegments % segments.size()] = currentSegment;
+	++completedSegments;
+	currentSegment = {};
+	segmentPosition = 0;
+	segmentLength = hopSize;
+
+	if (completedSegments <= BLOCK_HOPS)
+		return;
+
+	float blockEnergy = segments[(completedSegments - BLOCK_HOPS - 1) % segments.size()].tailEnergy;
+	for (size_t hop = 1; hop <= BLOCK_HOPS; ++hop) {
+		blockEnergy += segments[(completedSegments - hop) % segments.size()].energy;
+	}
+	recordBlock(loudnessFromMeanSquare(blockEnergy / static_cast<float>(blockSize)));
+}
+
+bool LoudnessMeter::inStepWith(const LoudnessMeter& other) const {
+	return currentSampleRate == other.currentSampleRate && completedSegments == other.completedSegments &&
+		   segmentPosition == other.segmentPosition;
 }
 
 // ITU-R BS.1770-4 loudness calculation from mean square
@@ -129,73 +225,75 @@ float LoudnessMeter::loudnessFromMeanSquare(const float meanSquare) const {
 	return -0.691f + 10.0f * std::log10(meanSquare);
 }
 
-float LoudnessMeter::getIntegratedLoudness() const {
-	if (blockHistory.empty())
-		return -200.0f;
+void LoudnessMeter::recordBlock(const float loudness) {
+	blockHistory[processedBlockCount % BLOCK_HISTORY_CAPACITY] = loudness;
+	++processedBlockCount;
 
-	std::vector<float> gatedBlocks;
-	gatedBlocks.reserve(blockHistory.size());
+	if (loudness < ABSOLUTE_THRESHOLD)
+		return;
 
-	for (const auto& [_, loudness] : blockHistory) {
-		if (loudness >= ABSOLUTE_THRESHOLD) {
-			gatedBlocks.push_back(loudness);
-		}
-	}
+	const auto bin = std::min(static_cast<size_t>((loudness - ABSOLUTE_THRESHOLD) / HISTOGRAM_BIN_WIDTH),
+							  HISTOGRAM_BIN_COUNT - 1);
+	const double energy = std::pow(10.0, static_cast<double>(loudness) / 10.0);
+	++loudnessHistogram[bin].blockCount;
+	loudnessHistogram[bin].energy += energy;
+	++gatedBlockCount;
+	gatedEnergy += energy;
+}
 
-	if (gatedBlocks.empty())
+float LoudnessMeter::getIntegratedLoudness() const {
+	if (gatedBlockCount == 0)
 		return -200.0f;
 
-	std::vector<float> linearValues;
-	linearValues.reserve(gatedBlocks.size());
-	for (const float loudness : gatedBlocks) {
-		linearValues.push_back(std::pow(10.0f, loudness / 10.0f));
+	const double meanLinear = gatedEnergy / static_cast<double>(gatedBlockCount);
+	const float relativeThreshold = static_cast<float>(10.0 * std::log10(meanLinear)) + RELATIVE_THRESHOLD;
+
+	// The bin holding the threshold counts when its centre clears it, as in libebur128.
+	size_t firstBin = 0;
+	if (relativeThreshold > ABSOLUTE_THRESHOLD) {
+		firstBin = std::min(static_cast<size_t>((relativeThreshold - ABSOLUTE_THRESHOLD) / HISTOGRAM_BIN_WIDTH),
+							HISTOGRAM_BIN_COUNT - 1);
+		const float binCentre = ABSOLUTE_THRESHOLD + (static_cast<float>(firstBin) + 0.5f) * HISTOGRAM_BIN_WIDTH;
+		if (relativeThreshold > binCentre && firstBin + 1 < HISTOGRAM_BIN_COUNT) {
+			++firstBin;
+		}
 	}
 
-	const float meanLinear = std::accumulate(linearValues.begin(), linearValues.end(), 0.0f) /
-							 static_cast<float>(linearValues.size());
-	const float relativeThreshold = 10.0f * std::log10(meanLinear) + RELATIVE_THRESHOLD;
-
-	std::vector<float> finalGatedLinear;
-	finalGatedLinear.reserve(gatedBlocks.size());
-	for (size_t i = 0; i < gatedBlocks.size(); ++i) {
-		if (gatedBlocks[i] >= relativeThreshold) {
-			finalGatedLinear.push_back(linearValues[i]);
-		}
+	uint64_t blockCount = 0;
+	double energy = 0.0;
+	for (size_t bin = firstBin; bin < HISTOGRAM_BIN_COUNT; ++bin) {
+		blockCount += loudnessHistogram[bin].blockCount;
+		energy += loudnessHistogram[bin].energy;
 	}
 
-	if (finalGatedLinear.empty())
+	if (blockCount == 0)
 		return -200.0f;
 
-	const float finalMeanLinear = std::accumulate(finalGatedLinear.begin(), finalGatedLinear.end(), 0.0f) /
-								  static_cast<float>(finalGatedLinear.size());
-	return 10.0f * std::log10(finalMeanLinear);
+	return static_cast<float>(10.0 * std::log10(energy / static_cast<double>(blockCount)));
 }
 
 float LoudnessMeter::getMomentaryLoudness() const {
-	if (blockHistory.empty())
+	if (processedBlockCount == 0)
 		return -200.0f;
 
-	const float lastLoudness = blockHistory.back().second;
-	return lastLoudness;
+	return blockHistory[(processedBlockCount - 1) % BLOCK_HISTORY_CAPACITY];
 }
 
 bool LoudnessMeter::getBlockLoudness(const uint64_t index, float& out) const {
-	for (const auto& [blockIndex, loudness] : blockHistory) {
-		if (blockIndex == index) {
-			out = loudness;
-			return true;
-		}
-	}
-	return false;
+	if (index >= processedBlockCount || processedBlockCount - index > BLOCK_HISTORY_CAPACITY)
+		return false;
+
+	out = blockHistory[index % BLOCK_HISTORY_CAPACITY];
+	return true;
 }
 
 void LoudnessMeter::reset() {
 	preFilter.reset();
 	rlbFilter.reset();
-	blockHistory.clear();
-	std::fill(audioBuffer.begin(), audioBuffer.end(), 0.0f);
-	bufferPosition = 0;
-	bufferInitialised = false;
-	samplesSinceLastBlock = 0;
+	std::fill(blockHistory.begin(), blockHistory.end(), -200.0f);
+	std::fill(loudnessHistogram.begin(), loudnessHistogram.end(), HistogramBin{});
+	gatedBlockCount = 0;
+	gatedEnergy = 0.0;
+	resetSegments();
 	processedBlockCount = 0;
 }
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <array>
-#include <deque>
 #include <span>
 #include <vector>
 #include <cstdint>
 
 class LoudnessMeter {
 public:
+	// getBlockLoudness only reaches this many of the most recent blocks (about 100 s).
+	static constexpr size_t BLOCK_HISTORY_CAPACITY = 1024;
+
 	LoudnessMeter();
 
 	void processSamples(std::span<const float> samples, float sampleRate);
+
+	// Meters channel ch of interleaved frames with meters[ch]. Meters fed only through here
+	// stay in step and are filtered four channels at a time.
+	static void processInterleaved(std::span<LoudnessMeter> meters, std::span<const float> interleaved,
+								   float sampleRate);
+
 	float getIntegratedLoudness() const;
 	float getMomentaryLoudness() const;
 	uint64_t getProcessedBlockCount() const { return processedBlockCount; }
@@ -30,14 +38,40 @@ private:
 		void reset();
 	};
 
+	// Filtered energy of one segment of the input, and of its last leadInSamples samples.
+	// Segments end where blocks do, so a block is the last BLOCK_HOPS segments plus the tail
+	// of the one before them, and nothing is rescanned when it completes.
+	struct Segment {
+		float energy = 0.0f;
+		float tailEnergy = 0.0f;
+	};
+	static constexpr size_t BLOCK_HOPS = 4;
+
 	void initialiseFilters(float sampleRate);
-	float calculateMeanSquare(std::span<const float> samples) const;
+	void resetSegments();
+	void processChannel(const float* samples, size_t frames, size_t stride);
+	float filterRun(const float* samples, size_t frames, size_t stride);
+	size_t samplesUntilBoundary() const;
+	void advanceSegment(float energy, size_t frames);
+	bool inStepWith(const LoudnessMeter& other) const;
 	float loudnessFromMeanSquare(float meanSquare) const;
+	void recordBlock(float loudness);
 
 	BiquadFilter preFilter;
 	BiquadFilter rlbFilter;
 
-	std::deque<std::pair<uint64_t, float>> blockHistory;
+	// Block i lives in blockHistory[i % BLOCK_HISTORY_CAPACITY] until it is overwritten.
+	std::vector<float> blockHistory;
+
+	// Blocks that pass the absolute gate, binned by loudness as libebur128 does, so the
+	// relative gate is applied over the bins instead of over every block ever measured.
+	struct HistogramBin {
+		uint64_t blockCount = 0;
+		double energy = 0.0;
+	};
+	std::vector<HistogramBin> loudnessHistogram;
+	uint64_t gatedBlockCount{0};
+	double gatedEnergy{0.0};
 
 	// ITU-R BS.1770-4 gating thresholds for integrated loudness measurement
 	// Absolute gate: -70 LUFS (removes silent/very quiet blocks)
@@ -46,13 +80,18 @@ private:
 	static constexpr float RELATIVE_THRESHOLD = -10.0f;
 	static constexpr float BLOCK_DURATION = 0.4f;  // 400ms measurement blocks
 	static constexpr float OVERLAP = 0.75f;         // 75% overlap (100ms hop size)
+	static constexpr float HISTOGRAM_MAX_LUFS = 30.0f;
+	static constexpr float HISTOGRAM_BIN_WIDTH = 0.1f;
+	static constexpr size_t HISTOGRAM_BIN_COUNT = 1000;  // ABSOLUTE_THRESHOLD to HISTOGRAM_MAX_LUFS
 
 	float currentSampleRate;
 	size_t blockSize;
 	size_t hopSize;
-	std::vector<float> audioBuffer;
-	size_t bufferPosition;
+	size_t leadInSamples{0};  // blockSize - BLOCK_HOPS * hopSize
+	std::array<Segment, BLOCK_HOPS + 1> segments{};  // Segment i in segments[i % size]
+	uint64_t completedSegments{0};
+	Segment currentSegment;
+	size_t segmentLength{0};
+	size_t segmentPosition{0};
 	uint64_t processedBlockCount{0};
-	bool bufferInitialised{false};
-	size_t samplesSinceLastBlock{0};
 };
@@ -0,0 +1,44 @@
+#include "loudness_meter_neon.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+
+namespace LoudnessMeterNEON {
+
+void kWeightFourChannels(const float* input,
+                         const std::size_t frames,
+                         const std::size_t stride,
+                         const std::array<float, 5>& pre,
+                         const std::array<float, 5>& rlb,
+                         std::array<std::array<float, 4>, 4>& state,
+                         std::array<float, 4>& energy) {
+    float32x4_t preZ0 = vld1q_f32(state[0].data());
+    float32x4_t preZ1 = vld1q_f32(state[1].data());
+    float32x4_t rlbZ0 = vld1q_f32(state[2].data());
+    float32x4_t rlbZ1 = vld1q_f32(state[3].data());
+    float32x4_t sum = vdupq_n_f32(0.0f);
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        const float32x4_t x = vld1q_f32(input + frame * stride);
+
+        const float32x4_t shelved = vaddq_f32(vmulq_n_f32(x, pre[0]), preZ0);
+        preZ0 = vaddq_f32(vsubq_f32(vmulq_n_f32(x, pre[1]), vmulq_n_f32(shelved, pre[3])), preZ1);
+        preZ1 = vsubq_f32(vmulq_n_f32(x, pre[2]), vmulq_n_f32(shelved, pre[4]));
+
+        const float32x4_t filtered = vaddq_f32(vmulq_n_f32(shelved, rlb[0]), rlbZ0);
+        rlbZ0 = vaddq_f32(vsubq_f32(vmulq_n_f32(shelved, rlb[1]), vmulq_n_f32(filtered, rlb[3])), rlbZ1);
+        rlbZ1 = vsubq_f32(vmulq_n_f32(shelved, rlb[2]), vmulq_n_f32(filtered, rlb[4]));
+
+        sum = vmlaq_f32(sum, filtered, filtered);
+    }
+
+    vst1q_f32(state[0].data(), preZ0);
+    vst1q_f32(state[1].data(), preZ1);
+    vst1q_f32(state[2].data(), rlbZ0);
+    vst1q_f32(state[3].data(), rlbZ1);
+    vst1q_f32(energy.data(), sum);
+}
+
+}
+
+#endif
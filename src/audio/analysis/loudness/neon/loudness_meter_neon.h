@@ -0,0 +1,21 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <array>
+#include <cstddef>
+
+namespace LoudnessMeterNEON {
+    // Runs the K-weighting pre-filter and RLB high-pass over four channels of interleaved
+    // input at once, one lane per channel, and returns each channel's filtered energy in
+    // energy. Coefficients are b0, b1, b2, a1, a2; state holds pre z0, pre z1, RLB z0 and
+    // RLB z1 for each lane.
+    void kWeightFourChannels(const float* input,
+                             std::size_t frames,
+                             std::size_t stride,
+                             const std::array<float, 5>& pre,
+                             const std::array<float, 5>& rlb,
+                             std::array<std::array<float, 4>, 4>& state,
+                             std::array<float, 4>& energy);
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "loudness_meter_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+
+namespace LoudnessMeterSSE {
+
+void kWeightFourChannels(const float* input,
+                         const std::size_t frames,
+                         const std::size_t stride,
+                         const std::array<float, 5>& pre,
+                         const std::array<float, 5>& rlb,
+                         std::array<std::array<float, 4>, 4>& state,
+                         std::array<float, 4>& energy) {
+    const __m128 preB0 = _mm_set1_ps(pre[0]);
+    const __m128 preB1 = _mm_set1_ps(pre[1]);
+    const __m128 preB2 = _mm_set1_ps(pre[2]);
+    const __m128 preA1 = _mm_set1_ps(pre[3]);
+    const __m128 preA2 = _mm_set1_ps(pre[4]);
+    const __m128 rlbB0 = _mm_set1_ps(rlb[0]);
+    const __m128 rlbB1 = _mm_set1_ps(rlb[1]);
+    const __m128 rlbB2 = _mm_set1_ps(rlb[2]);
+    const __m128 rlbA1 = _mm_set1_ps(rlb[3]);
+    const __m128 rlbA2 = _mm_set1_ps(rlb[4]);
+
+    __m128 preZ0 = _mm_loadu_ps(state[0].data());
+    __m128 preZ1 = _mm_loadu_ps(state[1].data());
+    __m128 rlbZ0 = _mm_loadu_ps(state[2].data());
+    __m128 rlbZ1 = _mm_loadu_ps(state[3].data());
+    __m128 sum = _mm_setzero_ps();
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        const __m128 x = _mm_loadu_ps(input + frame * stride);
+
+        const __m128 shelved = _mm_add_ps(_mm_mul_ps(preB0, x), preZ0);
+        preZ0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(preB1, x), _mm_mul_ps(preA1, shelved)), preZ1);
+        preZ1 = _mm_sub_ps(_mm_mul_ps(preB2, x), _mm_mul_ps(preA2, shelved));
+
+        const __m128 filtered = _mm_add_ps(_mm_mul_ps(rlbB0, shelved), rlbZ0);
+        rlbZ0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rlbB1, shelved), _mm_mul_ps(rlbA1, filtered)), rlbZ1);
+        rlbZ1 = _mm_sub_ps(_mm_mul_ps(rlbB2, shelved), _mm_mul_ps(rlbA2, filtered));
+
+        sum = _mm_add_ps(sum, _mm_mul_ps(filtered, filtered));
+    }
+
+    _mm_storeu_ps(state[0].data(), preZ0);
+    _mm_storeu_ps(state[1].data(), preZ1);
+    _mm_storeu_ps(state[2].data(), rlbZ0);
+    _mm_storeu_ps(state[3].data(), rlbZ1);
+    _mm_storeu_ps(energy.data(), sum);
+}
+
+}
+
+#endif
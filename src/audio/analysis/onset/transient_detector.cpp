@@ -0,0 +1,58 @@
+#include "transient_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+size_t TransientDetector::process(const float* interleaved, const size_t frameCount, const size_t channelCount,
+								  const float sampleRate) {
+	if (!interleaved || channelCount == 0 || sampleRate <= 0.0f) {
+		return 0;
+	}
+
+	const float channelScale = 1.0f / static_cast<float>(channelCount);
+	size_t onsets = 0;
+	for (size_t frame = 0; frame < frameCount; ++frame) {
+		const float* samples = interleaved + frame * channelCount;
+		float mono = 0.0f;
+		for (size_t ch = 0; ch < channelCount; ++ch) {
+			mono += samples[ch];
+		}
+		mono *= channelScale;
+
+		const float difference = mono - previousSample;
+		previousSample = mono;
+		blockEnergy += difference * difference;
+		if (++blockFill == BLOCK_SIZE && finishBlock(sampleRate)) {
+			++onsets;
+			lastOnsetEnd = frame + 1;
+		}
+	}
+	return onsets;
+}
+
+void TransientDetector::reset() {
+	previousSample = 0.0f;
+	blockEnergy = 0.0f;
+	blockFill = 0;
+	averageEnergy = 0.0f;
+	holdSeconds = 0.0f;
+	onsetCount = 0;
+	lastOnsetEnd = 0;
+}
+
+bool TransientDetector::finishBlock(const float sampleRate) {
+	const float energy = std::isfinite(blockEnergy) ? blockEnergy / static_cast<float>(BLOCK_SIZE) : 0.0f;
+	const float blockSeconds = static_cast<float>(BLOCK_SIZE) / sampleRate;
+	blockEnergy = 0.0f;
+	blockFill = 0;
+
+	const bool onset = holdSeconds <= 0.0f && energy > ENERGY_FLOOR && energy > averageEnergy * THRESHOLD_RATIO;
+	holdSeconds = onset ? REFRACTORY_SECONDS : std::max(0.0f, holdSeconds - blockSeconds);
+
+	const float follow = 1.0f - std::exp(-blockSeconds / AVERAGE_SECONDS);
+	averageEnergy += (energy - averageEnergy) * follow;
+	if (onset) {
+		++onsetCount;
+	}
+	return onset;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Time-domain onset detector that runs ahead of the FFT. It takes the high-frequency
+// content of every BLOCK_SIZE-sample block, the energy of the first difference of a mono
+// downmix. A block is an onset when that energy rises THRESHOLD_RATIO above a slower running
+// average of it, so a hit is reported about a block after it happens instead of once a
+// whole analysis window has filled.
+class TransientDetector {
+public:
+	static constexpr size_t BLOCK_SIZE = 64;
+	// Time constant of the running average the blocks are compared against.
+	static constexpr float AVERAGE_SECONDS = 0.1f;
+	static constexpr float THRESHOLD_RATIO = 4.0f;
+	// Blocks quieter than this mean square difference never count, about -60 dBFS.
+	static constexpr float ENERGY_FLOOR = 1.0e-6f;
+	// One onset per this span, so a single hit's ringing reads as one event.
+	static constexpr float REFRACTORY_SECONDS = 0.05f;
+
+	// Feeds frameCount frames of channelCount interleaved channels and returns how many
+	// onsets they completed. Blocks carry across calls, whatever size the calls are.
+	size_t process(const float* interleaved, size_t frameCount, size_t channelCount, float sampleRate);
+
+	// Onsets since construction or the last reset.
+	uint64_t getOnsetCount() const { return onsetCount; }
+	// Frames into the latest process() call at which its last onset's block ended, when it
+	// reported any.
+	size_t getLastOnsetEnd() const { return lastOnsetEnd; }
+	void reset();
+
+private:
+	bool finishBlock(float sampleRate);
+
+	float previousSample = 0.0f;
+	float blockEnergy = 0.0f;
+	size_t blockFill = 0;
+	float averageEnergy = 0.0f;
+	float holdSeconds = 0.0f;
+	uint64_t onsetCount = 0;
+	size_t lastOnsetEnd = 0;
+};
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
 #include <numbers>
 
 #include "audio/analysis/presentation/spectral_presentation.h"
@@ -18,33 +19,26 @@ constexpr float kMaximumDeltaTime = 0.25f;
 constexpr float kMinimumAudibleFrequency = 20.0f;
 constexpr float kMaximumAudibleFrequency = 20000.0f;
 
+constexpr float kTwoPi = 2.0f * std::numbers::pi_v<float>;
+constexpr float kInverseTwoPi = 1.0f / kTwoPi;
+
+// Same result as atan2(sin(value), cos(value)) for the finite values it is given, without the
+// three transcendental calls per bin.
 float wrapPhase(const float value) {
-    return std::atan2(std::sin(value), std::cos(value));
+    return value - kTwoPi * std::nearbyint(value * kInverseTwoPi);
 }
 
-std::span<const float> resolveFrequencies(std::vector<float>& buffer,
-                                          std::span<const float> frequencies,
-                                          const size_t binCount,
-                                          const float sampleRate) {
-    if (frequencies.size() == binCount) {
-        return frequencies;
-    }
-
-    buffer.assign(binCount, 0.0f);
-    if (binCount <= 1 || sampleRate <= 0.0f) {
-        return std::span<const float>(buffer.data(), buffer.size());
-    }
-
-    const float binWidth = sampleRate / (2.0f * static_cast<float>(binCount - 1));
-    for (size_t index = 0; index < binCount; ++index) {
-        buffer[index] = static_cast<float>(index) * binWidth;
-    }
-
-    return std::span<const float>(buffer.data(), buffer.size());
+// Whole cycles are dropped before scaling to radians, so a long hop at a high bin keeps its
+// precision instead of leaving a residual of tens of thousands of radians to wrap.
+float expectedAdvance(const float frequency, const float deltaTimeSeconds) {
+    const float cycles = frequency * deltaTimeSeconds;
+    return kTwoPi * (cycles - std::nearbyint(cycles));
 }
 
-SpectralPresentation::Frame mixSampleFrame(const AudioColourSample& sample) {
+SpectralPresentation::FrameView mixSampleFrame(SpectralPresentation::FrameWorkspace& workspace,
+                                               const SpectralFrame& sample) {
     return SpectralPresentation::mixChannels(
+        workspace,
         sample.magnitudes,
         sample.phases,
         sample.frequencies,
@@ -84,26 +78,22 @@ PhaseFeatureMetrics analyseTransition(std::span<const float> previousMagnitudes,
         return metrics;
     }
 
-    std::vector<float> derivedFrequencies;
-    const std::span<const float> effectiveFrequencies = resolveFrequencies(
-        derivedFrequencies,
-        frequencies,
-        binCount,
-        sampleRate);
+    // Frames without their own frequencies are on the FFT grid, so a bin's frequency is derived
+    // where it is read instead of into a buffer.
+    const bool derivedFrequencies = frequencies.size() != binCount;
+    const float binWidth = sampleRate / (2.0f * static_cast<float>(binCount - 1));
 
+    // Branch-free, so it vectorises: a NaN weight compares false and an infinite one is
+    // rejected, as the accumulation below skips both.
     float peakWeight = 0.0f;
     for (size_t index = 1; index < binCount; ++index) {
-        const float previousMagnitude = previousMagnitudes[index];
-        const float currentMagnitude = currentMagnitudes[index];
-        if (!std::isfinite(previousMagnitude) || !std::isfinite(currentMagnitude)) {
-            continue;
-        }
-
-        peakWeight = std::max(peakWeight, 0.5f * (std::max(previousMagnitude, 0.0f) + std::max(currentMagnitude, 0.0f)));
+        const float weight = 0.5f * (std::max(previousMagnitudes[index], 0.0f) + std::max(currentMagnitudes[index], 0.0f));
+        peakWeight = (weight > peakWeight && weight < std::numeric_limits<float>::infinity()) ? weight : peakWeight;
     }
 
     const float minimumWeight = std::max(kMinimumMagnitude, peakWeight * kRelativeMagnitudeFloor);
     const float phaseScale = 1.0f / std::numbers::pi_v<float>;
+    const float inverseNyquist = 1.0f / std::max(sampleRate * 0.5f, 1.0f);
 
     float totalWeight = 0.0f;
     float highFrequencyWeight = 0.0f;
@@ -113,7 +103,9 @@ PhaseFeatureMetrics analyseTransition(std::span<const float> previousMagnitudes,
     float sinAccumulator = 0.0f;
 
     for (size_t index = 1; index < binCount; ++index) {
-        const float frequency = effectiveFrequencies[index];
+        const float frequency = derivedFrequencies
+            ? static_cast<float>(index) * binWidth
+            : frequencies[index];
         if (!std::isfinite(frequency) ||
             frequency < kMinimumAudibleFrequency ||
             frequency > kMaximumAudibleFrequency) {
@@ -136,10 +128,9 @@ PhaseFeatureMetrics analyseTransition(std::span<const float> previousMagnitudes,
             continue;
         }
 
-        const float expectedAdvance = 2.0f * std::numbers::pi_v<float> * frequency * clampedDeltaTime;
-        const float residual = wrapPhase(currentPhase - previousPhase - expectedAdvance);
+        const float residual = wrapPhase(currentPhase - previousPhase - expectedAdvance(frequency, clampedDeltaTime));
         const float absoluteResidual = std::abs(residual);
-        const float frequencyNorm = std::clamp(frequency / std::max(sampleRate * 0.5f, 1.0f), 0.0f, 1.0f);
+        const float frequencyNorm = std::clamp(frequency * inverseNyquist, 0.0f, 1.0f);
         const float transientWeight = weight * (0.35f + 0.65f * frequencyNorm);
 
         totalWeight += weight;
@@ -167,25 +158,36 @@ PhaseFeatureMetrics analyseTransition(std::span<const float> previousMagnitudes,
     return metrics;
 }
 
-PhaseFeatureMetrics analyseTransition(const SpectralPresentation::Frame* previousFrame,
-                                      const SpectralPresentation::Frame& currentFrame,
+PhaseFeatureMetrics analyseTransition(const SpectralPresentation::FrameView* previousFrame,
+                                      const SpectralPresentation::FrameView& currentFrame,
                                       const float deltaTimeSeconds) {
     if (previousFrame == nullptr) {
         return {};
     }
 
     return analyseTransition(
-        std::span<const float>(previousFrame->magnitudes.data(), previousFrame->magnitudes.size()),
-        std::span<const float>(previousFrame->phases.data(), previousFrame->phases.size()),
-        std::span<const float>(currentFrame.magnitudes.data(), currentFrame.magnitudes.size()),
-        std::span<const float>(currentFrame.phases.data(), currentFrame.phases.size()),
-        std::span<const float>(currentFrame.frequencies.data(), currentFrame.frequencies.size()),
+        previousFrame->magnitudes,
+        previousFrame->phases,
+        currentFrame.magnitudes,
+        currentFrame.phases,
+        currentFrame.frequencies,
         currentFrame.sampleRate,
         deltaTimeSeconds);
 }
 
-PhaseFeatureMetrics analyseTransition(const AudioColourSample* previousSample,
-                                      const AudioColourSample& currentSample) {
+PhaseFeatureMetrics analyseTransition(const SpectralPresentation::Frame* previousFrame,
+                                      const SpectralPresentation::Frame& currentFrame,
+                                      const float deltaTimeSeconds) {
+    if (previousFrame == nullptr) {
+        return {};
+    }
+
+    const SpectralPresentation::FrameView previousView = previousFrame->view();
+    return analyseTransition(&previousView, currentFrame.view(), deltaTimeSeconds);
+}
+
+PhaseFeatureMetrics analyseTransition(const SpectralFrame* previousSample,
+                                      const SpectralFrame& currentSample) {
     if (previousSample == nullptr) {
         return {};
     }
@@ -195,8 +197,10 @@ PhaseFeatureMetrics analyseTransition(const AudioColourSample* previousSample,
         return {};
     }
 
-    const SpectralPresentation::Frame previousFrame = mixSampleFrame(*previousSample);
-    const SpectralPresentation::Frame currentFrame = mixSampleFrame(currentSample);
+    thread_local SpectralPresentation::FrameWorkspace previousWorkspace;
+    thread_local SpectralPresentation::FrameWorkspace currentWorkspace;
+    const SpectralPresentation::FrameView previousFrame = mixSampleFrame(previousWorkspace, *previousSample);
+    const SpectralPresentation::FrameView currentFrame = mixSampleFrame(currentWorkspace, currentSample);
     return analyseTransition(&previousFrame, currentFrame, static_cast<float>(deltaTime));
 }
 
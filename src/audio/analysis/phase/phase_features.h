@@ -7,6 +7,7 @@
 
 namespace SpectralPresentation {
 struct Frame;
+struct FrameView;
 }
 
 namespace PhaseAnalysis {
@@ -27,11 +28,15 @@ PhaseFeatureMetrics analyseTransition(std::span<const float> previousMagnitudes,
                                       float sampleRate,
                                       float deltaTimeSeconds);
 
+PhaseFeatureMetrics analyseTransition(const SpectralPresentation::FrameView* previousFrame,
+                                      const SpectralPresentation::FrameView& currentFrame,
+                                      float deltaTimeSeconds);
+
 PhaseFeatureMetrics analyseTransition(const SpectralPresentation::Frame* previousFrame,
                                       const SpectralPresentation::Frame& currentFrame,
                                       float deltaTimeSeconds);
 
-PhaseFeatureMetrics analyseTransition(const AudioColourSample* previousSample,
-                                      const AudioColourSample& currentSample);
+PhaseFeatureMetrics analyseTransition(const SpectralFrame* previousSample,
+                                      const SpectralFrame& currentSample);
 
 } // namespace PhaseAnalysis
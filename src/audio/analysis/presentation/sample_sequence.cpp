@@ -4,7 +4,7 @@
 
 namespace SpectralPresentation::SampleSequence {
 
-Frame buildFrame(const AudioColourSample& sample) {
+Frame buildFrame(const SpectralFrame& sample) {
     return SpectralPresentation::mixChannels(
         sample.magnitudes,
         sample.phases,
@@ -13,8 +13,18 @@ Frame buildFrame(const AudioColourSample& sample) {
         sample.sampleRate);
 }
 
-float resolveDeltaTimeSeconds(const AudioColourSample* previousSample,
-                              const AudioColourSample& currentSample,
+FrameView buildFrame(FrameWorkspace& workspace, const SpectralFrame& sample) {
+    return SpectralPresentation::mixChannels(
+        workspace,
+        sample.magnitudes,
+        sample.phases,
+        sample.frequencies,
+        sample.channels,
+        sample.sampleRate);
+}
+
+float resolveDeltaTimeSeconds(const SpectralFrame* previousSample,
+                              const SpectralFrame& currentSample,
                               const float fallbackDeltaTimeSeconds) {
     if (previousSample != nullptr) {
         const double delta = currentSample.timestamp - previousSample->timestamp;
@@ -26,33 +36,48 @@ float resolveDeltaTimeSeconds(const AudioColourSample* previousSample,
     return fallbackDeltaTimeSeconds;
 }
 
-PreparedFrame prepareSampleFrame(const AudioColourSample& sample,
-                                 const Settings& settings,
-                                 const AudioColourSample* previousSample,
-                                 const float fallbackDeltaTimeSeconds) {
+FrameView prepareSampleFrame(Workspace& workspace,
+                             const SpectralFrame& sample,
+                             const Settings& settings,
+                             PreparedFrame& prepared,
+                             const SpectralFrame* previousSample,
+                             const float fallbackDeltaTimeSeconds) {
     const float loudnessOverride = std::isfinite(sample.loudnessLUFS)
         ? sample.loudnessLUFS
         : ColourCore::LOUDNESS_DB_UNSPECIFIED;
-    const Frame frame = buildFrame(sample);
+    const FrameView frame = buildFrame(workspace.current, sample);
 
-    Frame previousFrame{};
-    const Frame* previousFramePtr = nullptr;
+    FrameView previousFrame{};
+    const FrameView* previousFramePtr = nullptr;
     if (previousSample != nullptr) {
-        previousFrame = buildFrame(*previousSample);
+        previousFrame = buildFrame(workspace.previous, *previousSample);
         previousFramePtr = &previousFrame;
     }
 
-    return SpectralPresentation::prepareFrame(
+    SpectralPresentation::prepareFrame(
+        workspace.current,
         frame,
         settings,
         loudnessOverride,
         previousFramePtr,
-        resolveDeltaTimeSeconds(previousSample, sample, fallbackDeltaTimeSeconds));
+        resolveDeltaTimeSeconds(previousSample, sample, fallbackDeltaTimeSeconds),
+        prepared);
+    return frame;
+}
+
+PreparedFrame prepareSampleFrame(const SpectralFrame& sample,
+                                 const Settings& settings,
+                                 const SpectralFrame* previousSample,
+                                 const float fallbackDeltaTimeSeconds) {
+    Workspace workspace;
+    PreparedFrame prepared{};
+    prepareSampleFrame(workspace, sample, settings, prepared, previousSample, fallbackDeltaTimeSeconds);
+    return prepared;
 }
 
-ColourCore::FrameResult buildSampleColourResult(const AudioColourSample& sample,
+ColourCore::FrameResult buildSampleColourResult(const SpectralFrame& sample,
                                                 const Settings& settings,
-                                                const AudioColourSample* previousSample,
+                                                const SpectralFrame* previousSample,
                                                 const float fallbackDeltaTimeSeconds) {
     return prepareSampleFrame(sample, settings, previousSample, fallbackDeltaTimeSeconds).colourResult;
 }
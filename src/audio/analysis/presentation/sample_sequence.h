@@ -7,20 +7,35 @@ namespace SpectralPresentation::SampleSequence {
 
 constexpr float kFallbackDeltaTimeSeconds = 1.0f / 60.0f;
 
-Frame buildFrame(const AudioColourSample& sample);
+// Buffers for one sample and the one before it, kept by a caller preparing a run of samples.
+struct Workspace {
+    FrameWorkspace current;
+    FrameWorkspace previous;
+};
 
-float resolveDeltaTimeSeconds(const AudioColourSample* previousSample,
-                              const AudioColourSample& currentSample,
+Frame buildFrame(const SpectralFrame& sample);
+FrameView buildFrame(FrameWorkspace& workspace, const SpectralFrame& sample);
+
+float resolveDeltaTimeSeconds(const SpectralFrame* previousSample,
+                              const SpectralFrame& currentSample,
                               float fallbackDeltaTimeSeconds = kFallbackDeltaTimeSeconds);
 
-PreparedFrame prepareSampleFrame(const AudioColourSample& sample,
+PreparedFrame prepareSampleFrame(const SpectralFrame& sample,
                                  const Settings& settings,
-                                 const AudioColourSample* previousSample = nullptr,
+                                 const SpectralFrame* previousSample = nullptr,
                                  float fallbackDeltaTimeSeconds = kFallbackDeltaTimeSeconds);
 
-ColourCore::FrameResult buildSampleColourResult(const AudioColourSample& sample,
+// Fills prepared in place and returns the sample's mixed frame, which views workspace or sample.
+FrameView prepareSampleFrame(Workspace& workspace,
+                             const SpectralFrame& sample,
+                             const Settings& settings,
+                             PreparedFrame& prepared,
+                             const SpectralFrame* previousSample = nullptr,
+                             float fallbackDeltaTimeSeconds = kFallbackDeltaTimeSeconds);
+
+ColourCore::FrameResult buildSampleColourResult(const SpectralFrame& sample,
                                                 const Settings& settings,
-                                                const AudioColourSample* previousSample = nullptr,
+                                                const SpectralFrame* previousSample = nullptr,
                                                 float fallbackDeltaTimeSeconds = kFallbackDeltaTimeSeconds);
 
 }
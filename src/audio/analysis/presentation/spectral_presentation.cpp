@@ -15,7 +15,11 @@ constexpr float kMinimumMagnitude = 1e-6f;
 constexpr float kMinimumLoudnessDb = -70.0f;
 constexpr float kMaximumLoudnessDb = 0.0f;
 
-void sanitiseMagnitudes(std::vector<float>& magnitudes) {
+// Beyond these a magnitude does not survive the mix's square and root unchanged.
+constexpr float kMinimumExactMagnitude = 1e-18f;
+constexpr float kMaximumExactMagnitude = 1e18f;
+
+void sanitiseMagnitudes(std::span<float> magnitudes) {
     for (float& magnitude : magnitudes) {
         if (!std::isfinite(magnitude) || magnitude < 0.0f) {
             magnitude = 0.0f;
@@ -42,14 +46,21 @@ float resolveSpectrumPresence(const ColourCore::FrameResult& colourResult) {
     return std::pow(normalisedLoudness, 1.25f);
 }
 
+bool passesMixUnchanged(std::span<const float> magnitudes) {
+    return std::all_of(magnitudes.begin(), magnitudes.end(), [](const float magnitude) {
+        return magnitude == 0.0f ||
+            (magnitude >= kMinimumExactMagnitude && magnitude <= kMaximumExactMagnitude);
+    });
 }
 
-Frame mixChannels(const std::vector<std::vector<float>>& magnitudes,
-                  const std::vector<std::vector<float>>& phases,
-                  const std::vector<std::vector<float>>& frequencies,
+FrameView mixInto(std::vector<float>& mixedMagnitudes,
+                  std::vector<float>& mixedPhases,
+                  const SpectralChannels& magnitudes,
+                  const SpectralChannels& phases,
+                  const SpectralChannels& frequencies,
                   const std::uint32_t channels,
                   const float sampleRate) {
-    Frame frame{};
+    FrameView frame{};
     frame.sampleRate = sampleRate;
 
     if (magnitudes.empty() || magnitudes.front().empty()) {
@@ -57,19 +68,37 @@ Frame mixChannels(const std::vector<std::vector<float>>& magnitudes,
     }
 
     const size_t numBins = magnitudes.front().size();
-    frame.magnitudes.assign(numBins, 0.0f);
-    frame.phases.assign(numBins, 0.0f);
+    if (!frequencies.empty() && !frequencies.front().empty() && frequencies.front().size() == numBins) {
+        frame.frequencies = frequencies.front();
+    }
+
+    const size_t channelLimit = std::min(magnitudes.size(), static_cast<size_t>(std::max<std::uint32_t>(1, channels)));
+
+    // One channel averages with nothing, so its finite, non-negative magnitudes and its
+    // phases are already the mix.
+    if (channelLimit == 1 && passesMixUnchanged(magnitudes.front())) {
+        frame.magnitudes = magnitudes.front();
+        if (!phases.empty() && phases.front().size() == numBins) {
+            frame.phases = phases.front();
+        } else {
+            mixedPhases.assign(numBins, 0.0f);
+            frame.phases = mixedPhases;
+        }
+        return frame;
+    }
+
+    mixedMagnitudes.assign(numBins, 0.0f);
+    mixedPhases.assign(numBins, 0.0f);
 
     size_t contributingMagnitudeChannels = 0;
     size_t contributingPhaseChannels = 0;
-    const size_t channelLimit = std::min(magnitudes.size(), static_cast<size_t>(std::max<std::uint32_t>(1, channels)));
 
     for (size_t channelIndex = 0; channelIndex < channelLimit; ++channelIndex) {
         const auto& channelMagnitudes = magnitudes[channelIndex];
         if (channelMagnitudes.size() == numBins) {
             for (size_t bin = 0; bin < numBins; ++bin) {
                 const float magnitude = channelMagnitudes[bin];
-                frame.magnitudes[bin] += magnitude * magnitude;
+                mixedMagnitudes[bin] += magnitude * magnitude;
             }
             ++contributingMagnitudeChannels;
         }
@@ -78,7 +107,7 @@ Frame mixChannels(const std::vector<std::vector<float>>& magnitudes,
             const auto& channelPhases = phases[channelIndex];
             if (channelPhases.size() == numBins) {
                 for (size_t bin = 0; bin < numBins; ++bin) {
-                    frame.phases[bin] += channelPhases[bin];
+                    mixedPhases[bin] += channelPhases[bin];
                 }
                 ++contributingPhaseChannels;
             }
@@ -87,60 +116,105 @@ Frame mixChannels(const std::vector<std::vector<float>>& magnitudes,
 
     if (contributingMagnitudeChannels > 0) {
         const float invChannelCount = 1.0f / static_cast<float>(contributingMagnitudeChannels);
-        for (float& magnitude : frame.magnitudes) {
+        for (float& magnitude : mixedMagnitudes) {
             magnitude = std::sqrt(magnitude * invChannelCount);
         }
     }
 
     if (contributingPhaseChannels > 0) {
         const float invChannelCount = 1.0f / static_cast<float>(contributingPhaseChannels);
-        for (float& phase : frame.phases) {
+        for (float& phase : mixedPhases) {
             phase *= invChannelCount;
         }
     }
 
-    if (!frequencies.empty() && !frequencies.front().empty() && frequencies.front().size() == numBins) {
-        frame.frequencies = frequencies.front();
+    sanitiseMagnitudes(mixedMagnitudes);
+    frame.magnitudes = mixedMagnitudes;
+    frame.phases = mixedPhases;
+    return frame;
+}
+
+void assignFrom(std::vector<float>& target, std::span<const float> source) {
+    if (source.data() != target.data() || source.size() != target.size()) {
+        target.assign(source.begin(), source.end());
     }
+}
+
+}
+
+FrameView Frame::view() const {
+    return FrameView{magnitudes, phases, frequencies, sampleRate};
+}
+
+void Frame::assign(const FrameView& view) {
+    assignFrom(magnitudes, view.magnitudes);
+    assignFrom(phases, view.phases);
+    assignFrom(frequencies, view.frequencies);
+    sampleRate = view.sampleRate;
+}
 
-    sanitiseMagnitudes(frame.magnitudes);
+FrameView mixChannels(FrameWorkspace& workspace,
+                      const SpectralChannels& magnitudes,
+                      const SpectralChannels& phases,
+                      const SpectralChannels& frequencies,
+                      const std::uint32_t channels,
+                      const float sampleRate) {
+    return mixInto(workspace.magnitudes, workspace.phases, magnitudes, phases, frequencies, channels, sampleRate);
+}
+
+Frame mixChannels(const SpectralChannels& magnitudes,
+                  const SpectralChannels& phases,
+                  const SpectralChannels& frequencies,
+                  const std::uint32_t channels,
+                  const float sampleRate) {
+    Frame frame{};
+    frame.assign(mixInto(frame.magnitudes, frame.phases, magnitudes, phases, frequencies, channels, sampleRate));
     return frame;
 }
 
-std::vector<float> buildSharedMagnitudes(const Frame& frame,
-                                         const Settings& settings) {
-    std::vector<float> magnitudes = frame.magnitudes;
-    if (magnitudes.empty() || frame.sampleRate <= 0.0f) {
-        return magnitudes;
+void buildSharedMagnitudes(const FrameView& frame,
+                           const Settings& settings,
+                           std::vector<float>& sharedMagnitudes) {
+    sharedMagnitudes.assign(frame.magnitudes.begin(), frame.magnitudes.end());
+    if (sharedMagnitudes.empty() || frame.sampleRate <= 0.0f) {
+        return;
     }
 
-    sanitiseMagnitudes(magnitudes);
+    sanitiseMagnitudes(sharedMagnitudes);
     AudioEQ::applyMagnitudeResponse(
-        magnitudes,
+        sharedMagnitudes,
         frame.sampleRate,
-        resolveFftSize(magnitudes.size()),
+        resolveFftSize(sharedMagnitudes.size()),
         settings.lowGain,
         settings.midGain,
         settings.highGain);
 
-    sanitiseMagnitudes(magnitudes);
+    sanitiseMagnitudes(sharedMagnitudes);
+}
+
+std::vector<float> buildSharedMagnitudes(const Frame& frame,
+                                         const Settings& settings) {
+    std::vector<float> magnitudes;
+    buildSharedMagnitudes(frame.view(), settings, magnitudes);
     return magnitudes;
 }
 
-std::vector<float> buildVisualiserMagnitudes(const std::vector<float>& sharedMagnitudes,
-                                             const float sampleRate,
-                                             const ColourCore::FrameResult& colourResult) {
-    std::vector<float> magnitudes = sharedMagnitudes;
+void buildVisualiserMagnitudes(std::span<const float> sharedMagnitudes,
+                               const float sampleRate,
+                               const ColourCore::FrameResult& colourResult,
+                               std::vector<float>& visualiserMagnitudes) {
+    std::vector<float>& magnitudes = visualiserMagnitudes;
+    magnitudes.assign(sharedMagnitudes.begin(), sharedMagnitudes.end());
     if (magnitudes.empty() || sampleRate <= 0.0f) {
-        return magnitudes;
+        return;
     }
 
     const float presence = resolveSpectrumPresence(colourResult);
+    const float binWidth = sampleRate / static_cast<float>(resolveFftSize(magnitudes.size()));
     float maxMagnitude = 0.0f;
 
     for (size_t index = 0; index < magnitudes.size(); ++index) {
-        const float frequency =
-            static_cast<float>(index) * sampleRate / static_cast<float>(resolveFftSize(magnitudes.size()));
+        const float frequency = static_cast<float>(index) * binWidth;
         if (frequency < synesthesia::constants::MIN_AUDIO_FREQ ||
             frequency > synesthesia::constants::MAX_AUDIO_FREQ ||
             !std::isfinite(magnitudes[index])) {
@@ -153,25 +227,33 @@ std::vector<float> buildVisualiserMagnitudes(const std::vector<float>& sharedMag
 
     if (maxMagnitude <= kMinimumMagnitude) {
         std::fill(magnitudes.begin(), magnitudes.end(), 0.0f);
-        return magnitudes;
+        return;
     }
 
     const float normalisation = presence / maxMagnitude;
     for (float& magnitude : magnitudes) {
         magnitude = std::clamp(magnitude * normalisation, 0.0f, 1.0f);
     }
+}
 
+std::vector<float> buildVisualiserMagnitudes(const std::vector<float>& sharedMagnitudes,
+                                             const float sampleRate,
+                                             const ColourCore::FrameResult& colourResult) {
+    std::vector<float> magnitudes;
+    buildVisualiserMagnitudes(sharedMagnitudes, sampleRate, colourResult, magnitudes);
     return magnitudes;
 }
 
-PreparedFrame prepareFrame(const Frame& frame,
-                           const Settings& settings,
-                           const float loudnessDb,
-                           const PhaseAnalysis::PhaseFeatureMetrics& phaseMetrics) {
-    PreparedFrame prepared{};
-    const std::vector<float> sharedMagnitudes = buildSharedMagnitudes(frame, settings);
+void prepareFrame(FrameWorkspace& workspace,
+                  const FrameView& frame,
+                  const Settings& settings,
+                  const float loudnessDb,
+                  const PhaseAnalysis::PhaseFeatureMetrics& phaseMetrics,
+                  PreparedFrame& prepared) {
+    buildSharedMagnitudes(frame, settings, workspace.sharedMagnitudes);
     prepared.colourResult = ColourCore::analyseSpectrum(
-        sharedMagnitudes,
+        workspace.analysis,
+        workspace.sharedMagnitudes,
         frame.phases,
         frame.frequencies,
         frame.sampleRate,
@@ -181,10 +263,34 @@ PreparedFrame prepareFrame(const Frame& frame,
         },
         loudnessDb,
         &phaseMetrics);
-    prepared.visualiserMagnitudes = buildVisualiserMagnitudes(
-        sharedMagnitudes,
+    buildVisualiserMagnitudes(
+        workspace.sharedMagnitudes,
         frame.sampleRate,
-        prepared.colourResult);
+        prepared.colourResult,
+        prepared.visualiserMagnitudes);
+}
+
+void prepareFrame(FrameWorkspace& workspace,
+                  const FrameView& frame,
+                  const Settings& settings,
+                  const float loudnessDb,
+                  const FrameView* previousFrame,
+                  const float deltaTimeSeconds,
+                  PreparedFrame& prepared) {
+    const PhaseAnalysis::PhaseFeatureMetrics phaseMetrics =
+        previousFrame != nullptr
+            ? PhaseAnalysis::analyseTransition(previousFrame, frame, deltaTimeSeconds)
+            : PhaseAnalysis::PhaseFeatureMetrics{};
+    prepareFrame(workspace, frame, settings, loudnessDb, phaseMetrics, prepared);
+}
+
+PreparedFrame prepareFrame(const Frame& frame,
+                           const Settings& settings,
+                           const float loudnessDb,
+                           const PhaseAnalysis::PhaseFeatureMetrics& phaseMetrics) {
+    FrameWorkspace workspace;
+    PreparedFrame prepared{};
+    prepareFrame(workspace, frame.view(), settings, loudnessDb, phaseMetrics, prepared);
     return prepared;
 }
 
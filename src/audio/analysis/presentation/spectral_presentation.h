@@ -2,9 +2,11 @@
 
 #include <array>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include "colour/colour_core.h"
+#include "resyne/encoding/formats/spectral_sequence.h"
 
 namespace PhaseAnalysis {
 struct PhaseFeatureMetrics;
@@ -20,11 +22,24 @@ struct Settings {
     bool applyGamutMapping = true;
 };
 
+// A frame's spectra without owning them. Views from mixChannels point at the source channel or
+// into the workspace they were mixed into, so they last until either changes.
+struct FrameView {
+    std::span<const float> magnitudes;
+    std::span<const float> phases;
+    std::span<const float> frequencies;
+    float sampleRate = 0.0f;
+};
+
 struct Frame {
     std::vector<float> magnitudes;
     std::vector<float> phases;
     std::vector<float> frequencies;
     float sampleRate = 0.0f;
+
+    FrameView view() const;
+    // Copies view in, reusing this frame's storage, so a caller can keep the previous frame.
+    void assign(const FrameView& view);
 };
 
 struct PreparedFrame {
@@ -32,9 +47,52 @@ struct PreparedFrame {
     ColourCore::FrameResult colourResult;
 };
 
-Frame mixChannels(const std::vector<std::vector<float>>& magnitudes,
-                  const std::vector<std::vector<float>>& phases,
-                  const std::vector<std::vector<float>>& frequencies,
+// Caller-owned buffers for mixing and preparing frames. They only grow, so a caller that keeps
+// one across frames of the same size allocates nothing in steady state.
+struct FrameWorkspace {
+    std::vector<float> magnitudes;
+    std::vector<float> phases;
+    std::vector<float> sharedMagnitudes;
+    ColourCore::AnalysisScratch analysis;
+};
+
+// Mixes the channels into workspace. A single channel whose magnitudes would come through the
+// mix unchanged is viewed in place instead.
+FrameView mixChannels(FrameWorkspace& workspace,
+                      const SpectralChannels& magnitudes,
+                      const SpectralChannels& phases,
+                      const SpectralChannels& frequencies,
+                      std::uint32_t channels,
+                      float sampleRate);
+
+void buildSharedMagnitudes(const FrameView& frame,
+                           const Settings& settings,
+                           std::vector<float>& sharedMagnitudes);
+
+void buildVisualiserMagnitudes(std::span<const float> sharedMagnitudes,
+                               float sampleRate,
+                               const ColourCore::FrameResult& colourResult,
+                               std::vector<float>& visualiserMagnitudes);
+
+// Fills prepared, reusing its storage and workspace's.
+void prepareFrame(FrameWorkspace& workspace,
+                  const FrameView& frame,
+                  const Settings& settings,
+                  float loudnessDb,
+                  const PhaseAnalysis::PhaseFeatureMetrics& phaseMetrics,
+                  PreparedFrame& prepared);
+
+void prepareFrame(FrameWorkspace& workspace,
+                  const FrameView& frame,
+                  const Settings& settings,
+                  float loudnessDb,
+                  const FrameView* previousFrame,
+                  float deltaTimeSeconds,
+                  PreparedFrame& prepared);
+
+Frame mixChannels(const SpectralChannels& magnitudes,
+                  const SpectralChannels& phases,
+                  const SpectralChannels& frequencies,
                   std::uint32_t channels,
                   float sampleRate);
 
@@ -0,0 +1,284 @@
+#include "audio_device_registry.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <mmdeviceapi.h>
+#elif defined(__APPLE__)
+#include <CoreAudio/CoreAudio.h>
+#elif defined(__linux__)
+#include <alsa/asoundlib.h>
+#endif
+
+namespace {
+
+// ALSA has no change notification short of udev, so its card list is polled at this rate.
+constexpr auto kPollInterval = std::chrono::seconds(2);
+// Plugging a device in raises several notifications; they are enumerated once, after this.
+constexpr auto kSettleTime = std::chrono::milliseconds(250);
+
+#if defined(_WIN32)
+class EndpointNotificationClient final : public IMMNotificationClient {
+public:
+	explicit EndpointNotificationClient(AudioDeviceRegistry& registry)
+		: registry_(registry) {
+	}
+
+	ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG STDMETHODCALLTYPE Release() override { return 1; }
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override {
+		if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient)) {
+			*object = static_cast<IMMNotificationClient*>(this);
+			return S_OK;
+		}
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+
+	HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override {
+		registry_.requestRefresh();
+		return S_OK;
+	}
+
+	HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override {
+		registry_.requestRefresh();
+		return S_OK;
+	}
+
+	HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override {
+		registry_.requestRefresh();
+		return S_OK;
+	}
+
+	HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow, ERole, LPCWSTR) override {
+		return S_OK;
+	}
+
+	HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override {
+		return S_OK;
+	}
+
+private:
+	AudioDeviceRegistry& registry_;
+};
+#elif defined(__APPLE__)
+constexpr AudioObjectPropertyAddress kDevicesAddress{
+	kAudioHardwarePropertyDevices,
+	kAudioObjectPropertyScopeGlobal,
+	kAudioObjectPropertyElementMain
+};
+
+OSStatus devicesChanged(AudioObjectID, UInt32, const AudioObjectPropertyAddress*, void* clientData) {
+	static_cast<AudioDeviceRegistry*>(clientData)->requestRefresh();
+	return noErr;
+}
+#elif defined(__linux__)
+std::vector<int> alsaCards() {
+	std::vector<int> cards;
+	int card = -1;
+	while (snd_card_next(&card) == 0 && card >= 0) {
+		cards.push_back(card);
+	}
+	return cards;
+}
+#endif
+
+}
+
+// Lives on the worker thread for as long as it runs, so notifications stop before it exits.
+struct AudioDeviceRegistry::PlatformListener {
+	explicit PlatformListener(AudioDeviceRegistry& registry)
+#if defined(_WIN32)
+		: client(registry) {
+		comInitialised = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+		if (SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+									   __uuidof(IMMDeviceEnumerator), reinterpret_cast<void**>(&enumerator))) &&
+			FAILED(enumerator->RegisterEndpointNotificationCallback(&client))) {
+			enumerator->Release();
+			enumerator = nullptr;
+		}
+	}
+#elif defined(__APPLE__)
+		: registry(registry) {
+		registered = AudioObjectAddPropertyListener(
+			kAudioObjectSystemObject, &kDevicesAddress, devicesChanged, &registry) == noErr;
+	}
+#elif defined(__linux__)
+		: cards(alsaCards()) {
+		(void)registry;
+	}
+#else
+	{
+		(void)registry;
+	}
+#endif
+
+	~PlatformListener() {
+#if defined(_WIN32)
+		if (enumerator != nullptr) {
+			enumerator->UnregisterEndpointNotificationCallback(&client);
+			enumerator->Release();
+		}
+		if (comInitialised) {
+			CoUninitialize();
+		}
+#elif defined(__APPLE__)
+		if (registered) {
+			AudioObjectRemovePropertyListener(kAudioObjectSystemObject, &kDevicesAddress, devicesChanged, &registry);
+		}
+#endif
+	}
+
+	// Only platforms without notifications find changes here.
+	bool pollForChanges() {
+#if defined(__linux__)
+		std::vector<int> current = alsaCards();
+		if (current == cards) {
+			return false;
+		}
+		cards = std::move(current);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+#if defined(_WIN32)
+	EndpointNotificationClient client;
+	IMMDeviceEnumerator* enumerator = nullptr;
+	bool comInitialised = false;
+#elif defined(__APPLE__)
+	AudioDeviceRegistry& registry;
+	bool registered = false;
+#elif defined(__linux__)
+	std::vector<int> cards;
+#endif
+};
+
+AudioDeviceRegistry::~AudioDeviceRegistry() {
+	stop();
+}
+
+void AudioDeviceRegistry::start() {
+	if (worker_.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopRequested_ = false;
+		refreshRequested_ = false;
+	}
+	worker_ = std::thread(&AudioDeviceRegistry::run, this);
+}
+
+void AudioDeviceRegistry::stop() {
+	if (!worker_.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopRequested_ = true;
+	}
+	wake_.notify_all();
+	worker_.join();
+}
+
+std::shared_ptr<const AudioDeviceRegistry::Snapshot> AudioDeviceRegistry::snapshot() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return snapshot_;
+}
+
+void AudioDeviceRegistry::requestRefresh() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		refreshRequested_ = true;
+	}
+	wake_.notify_all();
+}
+
+void AudioDeviceRegistry::setHostApi(const AudioStreamSettings::HostApi hostApi) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (hostApi_ == hostApi) {
+			return;
+		}
+		hostApi_ = hostApi;
+		hostApiChanged_ = true;
+	}
+	wake_.notify_all();
+}
+
+AudioStreamSettings::HostApi AudioDeviceRegistry::hostApi() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return hostApi_;
+}
+
+void AudioDeviceRegistry::run() {
+	PlatformListener listener(*this);
+	enumerate(false);
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!stopRequested_) {
+		wake_.wait_for(lock, kPollInterval,
+					   [this] { return stopRequested_ || refreshRequested_ || hostApiChanged_; });
+		if (stopRequested_) {
+			break;
+		}
+		if (hostApiChanged_ && !refreshRequested_) {
+			// Nothing was plugged in, so there is nothing to let settle.
+			lock.unlock();
+			enumerate(false);
+			lock.lock();
+			continue;
+		}
+		if (!refreshRequested_) {
+			lock.unlock();
+			const bool changed = listener.pollForChanges();
+			lock.lock();
+			if (!changed) {
+				continue;
+			}
+		}
+
+		if (wake_.wait_for(lock, kSettleTime, [this] { return stopRequested_; })) {
+			break;
+		}
+		refreshRequested_ = false;
+		lock.unlock();
+		enumerate(true);
+		lock.lock();
+	}
+}
+
+void AudioDeviceRegistry::enumerate(const bool hardwareChanged) {
+	hardwareChanged_ = hardwareChanged_ || hardwareChanged;
+	AudioStreamSettings::HostApi hostApi;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		hostApi = hostApi_;
+		hostApiChanged_ = false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	auto next = std::make_shared<Snapshot>();
+	next->inputDevices = AudioInput::getInputDevices(hostApi);
+	next->outputDevices = AudioOutput::getOutputDevices(hostApi);
+	next->hostApi = hostApi;
+	next->hardwareChanged = hardwareChanged_;
+	next->enumerationTime = std::chrono::steady_clock::now() - start;
+	next->version = version_.load(std::memory_order_relaxed) + 1;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		snapshot_ = std::move(next);
+		version_.store(snapshot_->version, std::memory_order_release);
+	}
+}
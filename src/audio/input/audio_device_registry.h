@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "audio_input.h"
+#include "audio_output.h"
+
+// Holds the PortAudio device lists, enumerated on its own thread, and enumerates them again
+// when the platform reports a device change (CoreAudio, WASAPI endpoints or ALSA cards). The
+// UI never queries devices itself. Each enumeration is published as a snapshot with a higher
+// version, so consumers compare versions rather than the lists.
+class AudioDeviceRegistry {
+public:
+	struct Snapshot {
+		uint64_t version = 0;
+		std::vector<AudioInput::DeviceInfo> inputDevices;
+		std::vector<AudioOutput::DeviceInfo> outputDevices;
+		// The host API the lists were filtered to.
+		AudioStreamSettings::HostApi hostApi = AudioStreamSettings::HostApi::Default;
+		// PortAudio only lists the devices present when it initialised; this is set once the
+		// platform has reported a change since, so devices added later need a restart.
+		bool hardwareChanged = false;
+		std::chrono::steady_clock::duration enumerationTime{};
+	};
+
+	AudioDeviceRegistry() = default;
+	~AudioDeviceRegistry();
+
+	AudioDeviceRegistry(const AudioDeviceRegistry&) = delete;
+	AudioDeviceRegistry& operator=(const AudioDeviceRegistry&) = delete;
+
+	// PortAudio must be initialised before start and stay so until stop.
+	void start();
+	void stop();
+
+	// Zero until the first enumeration has been published.
+	uint64_t version() const { return version_.load(std::memory_order_acquire); }
+	std::shared_ptr<const Snapshot> snapshot() const;
+
+	// Called from the platform's notification thread; coalesces with any pending refresh.
+	void requestRefresh();
+
+	// Lists only the host API's devices from the next enumeration, which starts at once.
+	void setHostApi(AudioStreamSettings::HostApi hostApi);
+	AudioStreamSettings::HostApi hostApi() const;
+
+private:
+	struct PlatformListener;
+
+	void run();
+	void enumerate(bool hardwareChanged);
+
+	std::thread worker_;
+	std::atomic<uint64_t> version_{0};
+
+	mutable std::mutex mutex_;
+	std::condition_variable wake_;
+	bool stopRequested_ = false;  // Protected by mutex_
+	bool refreshRequested_ = false;  // Protected by mutex_
+	bool hostApiChanged_ = false;  // Protected by mutex_
+	AudioStreamSettings::HostApi hostApi_ = AudioStreamSettings::HostApi::Default;  // Protected by mutex_
+	std::shared_ptr<const Snapshot> snapshot_;  // Protected by mutex_
+
+	// Worker only
+	bool hardwareChanged_ = false;
+};
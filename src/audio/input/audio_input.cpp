@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cstddef>
 #include <cmath>
 #include <iostream>
@@ -10,6 +11,9 @@
 #include <stdexcept>
 #include <string_view>
 
+#include "utilities/telemetry/telemetry.h"
+#include "utilities/threading/realtime_thread.h"
+
 #ifdef __linux__
 #include <alsa/asoundlib.h>
 #include <cstdio>
@@ -37,10 +41,32 @@ public:
 
 namespace {
 
+// Background meters take turns, so a long device list never has more than this many
+// monitoring streams open alongside the analysis stream.
+constexpr size_t MAX_CONCURRENT_MONITOR_STREAMS = 2;
+constexpr auto MONITOR_SAMPLE_DURATION = std::chrono::milliseconds(750);
+
 float smoothedLevel(const float current, const float target) {
 	return std::max(target, current * 0.84f);
 }
 
+// PortAudio stamps a buffer with its ADC time on the stream's own clock. The callback's
+// currentTime is read on that clock at about the moment this runs, so their difference moves
+// it onto the steady clock. Without usable times the buffer is taken to have just finished.
+std::chrono::steady_clock::time_point captureTime(const PaStreamCallbackTimeInfo* timeInfo,
+												  const unsigned long frameCount,
+												  const float sampleRate) {
+	const auto now = std::chrono::steady_clock::now();
+	double secondsAgo = sampleRate > 0.0f ? static_cast<double>(frameCount) / sampleRate : 0.0;
+	if (timeInfo && timeInfo->inputBufferAdcTime > 0.0 && timeInfo->currentTime > 0.0) {
+		const double reported = timeInfo->currentTime - timeInfo->inputBufferAdcTime;
+		if (reported >= 0.0 && reported < 1.0) {
+			secondsAgo = reported;
+		}
+	}
+	return now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(secondsAgo));
+}
+
 #ifdef __APPLE__
 constexpr UInt32 makeFourCC(const char a, const char b, const char c, const char d) {
 	return (static_cast<UInt32>(static_cast<unsigned char>(a)) << 24U) |
@@ -245,7 +271,7 @@ AudioInput::~AudioInput() {
 	processor.stop();
 }
 
-std::vector<AudioInput::DeviceInfo> AudioInput::getInputDevices() {
+std::vector<AudioInput::DeviceInfo> AudioInput::getInputDevices(const AudioStreamSettings::HostApi hostApi) {
 	std::vector<DeviceInfo> devices;
 
 #ifdef __linux__
@@ -262,7 +288,7 @@ std::vector<AudioInput::DeviceInfo> AudioInput::getInputDevices() {
 	devices.reserve(static_cast<size_t>(deviceCount));
 	for (int i = 0; i < deviceCount; ++i) {
 		if (const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(i)) {
-			if (deviceInfo->maxInputChannels > 0) {
+			if (deviceInfo->maxInputChannels > 0 && AudioStreamConfig::deviceMatchesHostApi(*deviceInfo, hostApi)) {
 				devices.emplace_back(DeviceInfo{
 					deviceInfo->name,
 					i,
@@ -275,7 +301,7 @@ std::vector<AudioInput::DeviceInfo> AudioInput::getInputDevices() {
 	return devices;
 }
 
-bool AudioInput::initStream(const int deviceIndex, const int numChannels) {
+bool AudioInput::initStream(const int deviceIndex, const int numChannels, const AudioStreamSettings& settings) {
 	stopStream();
 
 	const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(deviceIndex);
@@ -295,16 +321,19 @@ bool AudioInput::initStream(const int deviceIndex, const int numChannels) {
 	activeChannel = 0;
 	dcFilter.setChannelCount(static_cast<size_t>(channelCount));
 
+	const AudioStreamConfig::HostApiStreamInfo hostApiStreamInfo(settings);
 	PaStreamParameters inputParameters{};
 	inputParameters.device = deviceIndex;
 	inputParameters.channelCount = channelCount;
 	inputParameters.sampleFormat = paFloat32;
-	inputParameters.suggestedLatency = deviceInfo->defaultLowInputLatency;
-	inputParameters.hostApiSpecificStreamInfo = nullptr;
+	inputParameters.suggestedLatency = AudioStreamConfig::suggestedLatency(settings, deviceInfo->defaultLowInputLatency);
+	inputParameters.hostApiSpecificStreamInfo = hostApiStreamInfo.get();
 
+	const unsigned long framesPerBuffer =
+		AudioStreamConfig::framesPerBuffer(settings, static_cast<unsigned long>(processor.getFFTSize()));
 	const PaError err =
 		Pa_OpenStream(&stream, &inputParameters, nullptr, deviceInfo->defaultSampleRate,
-					  FFTProcessor::FFT_SIZE, paClipOff, audioCallback, this);
+					  framesPerBuffer, paClipOff, audioCallback, this);
 
 	if (err != paNoError) {
 		std::cerr << "AudioInput: Failed to open stream: " << Pa_GetErrorText(err) << std::endl;
@@ -319,6 +348,12 @@ bool AudioInput::initStream(const int deviceIndex, const int numChannels) {
 		return false;
 	}
 	sampleRate = static_cast<float>(streamInfo->sampleRate);
+	streamLatency = AudioStreamLatency{
+		streamInfo->inputLatency,
+		streamInfo->sampleRate,
+		framesPerBuffer,
+		AudioStreamConfig::hostApiOfDevice(*deviceInfo)
+	};
 
 	if (const PaError startErr = Pa_StartStream(stream); startErr != paNoError) {
 		std::cerr << "AudioInput: Failed to start stream: " << Pa_GetErrorText(startErr) << std::endl;
@@ -329,6 +364,31 @@ bool AudioInput::initStream(const int deviceIndex, const int numChannels) {
 	return true;
 }
 
+double AudioInput::estimateAnalysisLatencySeconds() const {
+	if (!stream || streamLatency.sampleRate <= 0.0) {
+		return 0.0;
+	}
+
+	const AudioProcessor::LatencyHistogram histogram = processor.getLatencyHistogram();
+	uint64_t total = 0;
+	for (const uint64_t count : histogram) {
+		total += count;
+	}
+	double analysisSeconds = 0.0;
+	uint64_t seen = 0;
+	for (size_t bucket = 0; bucket < histogram.size() && total > 0; ++bucket) {
+		seen += histogram[bucket];
+		if (seen * 2 >= total) {
+			// Bucket i spans [2^i, 2^(i+1)) microseconds.
+			analysisSeconds = 1.5e-6 * static_cast<double>(uint64_t{1} << bucket);
+			break;
+		}
+	}
+
+	const double halfWindowSeconds = 0.5 * static_cast<double>(processor.getFFTSize()) / streamLatency.sampleRate;
+	return streamLatency.latencySeconds + halfWindowSeconds + analysisSeconds;
+}
+
 AudioProcessor::SpectralData AudioInput::getSpectralData() const {
 	return processor.getSpectralData();
 }
@@ -355,12 +415,22 @@ bool AudioInput::isStreamActive() const {
 	return stream && Pa_IsStreamActive(stream) == 1;
 }
 
+bool AudioInput::startCapture(const std::filesystem::path& path, std::string& errorMessage) {
+	if (!stream) {
+		errorMessage = "No input stream is open";
+		return false;
+	}
+	return capture.open(path, sampleRate, static_cast<size_t>(channelCount), errorMessage);
+}
+
 void AudioInput::stopStream() {
+	capture.close();
 	if (stream) {
 		Pa_StopStream(stream);
 		Pa_CloseStream(stream);
 		stream = nullptr;
 	}
+	streamLatency = {};
 	resetStereoLevels();
 }
 
@@ -376,10 +446,25 @@ void AudioInput::resetStereoLevels() {
 
 int AudioInput::audioCallback(const void* input, [[maybe_unused]] void* output,
 							  const unsigned long frameCount,
-							  [[maybe_unused]] const PaStreamCallbackTimeInfo* timeInfo,
-							  [[maybe_unused]] PaStreamCallbackFlags statusFlags,
+							  const PaStreamCallbackTimeInfo* timeInfo,
+							  const PaStreamCallbackFlags statusFlags,
 							  void* userData) {
 	auto* audio = static_cast<AudioInput*>(userData);
+	const Utilities::Telemetry::StageTimer stageTimer(Utilities::Telemetry::Stage::InputCallback);
+	if (statusFlags & paInputOverflow) {
+		Utilities::Telemetry::increment(Utilities::Telemetry::Counter::InputOverflows);
+	}
+	if (statusFlags & paInputUnderflow) {
+		Utilities::Telemetry::increment(Utilities::Telemetry::Counter::InputUnderflows);
+	}
+
+	// PortAudio owns the callback thread, so it is configured from the first callback it runs.
+	static thread_local bool threadConfigured = false;
+	if (!threadConfigured) {
+		threadConfigured = true;
+		Utilities::Threading::configureCurrentThread(Utilities::Threading::ThreadRole::AudioCallback,
+													 audio->sampleRate > 0.0f ? static_cast<double>(frameCount) / audio->sampleRate : 0.0);
+	}
 
 	if (!input) {
 		return paContinue;
@@ -387,23 +472,27 @@ int AudioInput::audioCallback(const void* input, [[maybe_unused]] void* output,
 
 	try {
 		const auto* inBuffer = static_cast<const float*>(input);
-		constexpr size_t MAX_BUFFER_SIZE = 4096;
-		thread_local std::vector<float> processedBuffer(MAX_BUFFER_SIZE);
-		if (frameCount > MAX_BUFFER_SIZE) {
-			processedBuffer.resize(frameCount);
-		}
 
-		audio->processor.queueAudioData(inBuffer, frameCount * static_cast<size_t>(audio->channelCount), audio->sampleRate, static_cast<size_t>(audio->channelCount));
+		const auto capturedAt = captureTime(timeInfo, frameCount, audio->sampleRate);
+		audio->capture.push(inBuffer, frameCount, std::chrono::steady_clock::now(), capturedAt,
+							static_cast<uint32_t>(statusFlags));
+		audio->processor.queueAudioData(inBuffer, frameCount * static_cast<size_t>(audio->channelCount), audio->sampleRate,
+										static_cast<size_t>(audio->channelCount), capturedAt);
 
 		float leftPeak = 0.0f;
 		float rightPeak = 0.0f;
 		const size_t channels = static_cast<size_t>(std::max(audio->channelCount, 1));
-		for (unsigned long frame = 0; frame < frameCount; ++frame) {
-			const size_t offset = static_cast<size_t>(frame) * channels;
-			const float left = std::abs(inBuffer[offset]);
-			const float right = channels > 1 ? std::abs(inBuffer[offset + 1]) : left;
-			leftPeak = std::max(leftPeak, left);
-			rightPeak = std::max(rightPeak, right);
+		if (channels == 1) {
+			for (unsigned long frame = 0; frame < frameCount; ++frame) {
+				leftPeak = std::max(leftPeak, std::abs(inBuffer[frame]));
+			}
+			rightPeak = leftPeak;
+		} else {
+			for (unsigned long frame = 0; frame < frameCount; ++frame) {
+				const size_t offset = static_cast<size_t>(frame) * channels;
+				leftPeak = std::max(leftPeak, std::abs(inBuffer[offset]));
+				rightPeak = std::max(rightPeak, std::abs(inBuffer[offset + 1]));
+			}
 		}
 		audio->updateStereoLevels(leftPeak, rightPeak);
 	}
@@ -423,7 +512,8 @@ struct AudioInputLevelMonitor::MonitoredDevice {
 	int paIndex = paNoDevice;
 	int channelCount = 0;
 	PaStream* stream = nullptr;
-	bool startAttempted = false;
+	std::chrono::steady_clock::time_point sampleStarted{};
+	bool openFailed = false;
 	bool allowLevelMonitoring = true;
 	std::atomic<float> leftLevel{0.0f};
 	std::atomic<float> rightLevel{0.0f};
@@ -436,9 +526,10 @@ AudioInputLevelMonitor::~AudioInputLevelMonitor() {
 }
 
 void AudioInputLevelMonitor::syncDevices(const std::vector<AudioInput::DeviceInfo>& devices,
+										 const uint64_t deviceListVersion,
 										 const int selectedPaIndex) {
 	bool topologyChanged = monitoredDevices_.size() != devices.size();
-	if (!topologyChanged) {
+	if (!topologyChanged && deviceListVersion != syncedVersion_) {
 		for (size_t i = 0; i < devices.size(); ++i) {
 			if (monitoredDevices_[i]->paIndex != devices[i].paIndex ||
 				monitoredDevices_[i]->allowLevelMonitoring != devices[i].allowLevelMonitoring) {
@@ -457,28 +548,54 @@ void AudioInputLevelMonitor::syncDevices(const std::vector<AudioInput::DeviceInf
 			monitoredDevice->allowLevelMonitoring = device.allowLevelMonitoring;
 			monitoredDevices_.push_back(std::move(monitoredDevice));
 		}
+		nextDeviceToSample_ = 0;
 	}
+	syncedVersion_ = deviceListVersion;
+
+	// The selected device's meter reads the analysis stream, so it never gets a monitor.
+	const auto canSample = [selectedPaIndex](const MonitoredDevice& device) {
+		return device.allowLevelMonitoring && !device.openFailed && device.paIndex != selectedPaIndex;
+	};
 
+	size_t sampleableDevices = 0;
 	for (const auto& device : monitoredDevices_) {
-		if (!device) {
-			continue;
+		if (device->paIndex == selectedPaIndex) {
+			stopDevice(*device);
+			device->openFailed = false;
+		} else if (!device->allowLevelMonitoring) {
+			stopDevice(*device);
+		} else if (canSample(*device)) {
+			++sampleableDevices;
 		}
+	}
 
-		if (!device->allowLevelMonitoring) {
-			stopDevice(*device);
-			device->startAttempted = true;
-			continue;
+	// With few enough devices every meter stays live; otherwise each one keeps its last
+	// reading while it waits for its next turn.
+	const bool rotate = sampleableDevices > MAX_CONCURRENT_MONITOR_STREAMS;
+	const auto now = std::chrono::steady_clock::now();
+	size_t openStreams = 0;
+	for (const auto& device : monitoredDevices_) {
+		if (device->stream && rotate && now - device->sampleStarted >= MONITOR_SAMPLE_DURATION) {
+			closeStream(*device);
+		}
+		if (device->stream) {
+			++openStreams;
 		}
+	}
 
-		if (device->paIndex == selectedPaIndex) {
-			stopDevice(*device);
-			device->startAttempted = false;
+	const size_t deviceCount = monitoredDevices_.size();
+	const size_t firstCandidate = nextDeviceToSample_;
+	for (size_t step = 0; step < deviceCount && openStreams < MAX_CONCURRENT_MONITOR_STREAMS; ++step) {
+		const size_t index = (firstCandidate + step) % deviceCount;
+		MonitoredDevice& device = *monitoredDevices_[index];
+		if (device.stream || !canSample(device)) {
 			continue;
 		}
-
-		if (!device->stream && !device->startAttempted) {
-			startDevice(*device);
+		if (startDevice(device)) {
+			device.sampleStarted = now;
+			++openStreams;
 		}
+		nextDeviceToSample_ = (index + 1) % deviceCount;
 	}
 }
 
@@ -500,22 +617,25 @@ void AudioInputLevelMonitor::stopAll() {
 	monitoredDevices_.clear();
 }
 
-void AudioInputLevelMonitor::stopDevice(MonitoredDevice& device) {
+void AudioInputLevelMonitor::closeStream(MonitoredDevice& device) {
 	if (device.stream) {
 		Pa_StopStream(device.stream);
 		Pa_CloseStream(device.stream);
 		device.stream = nullptr;
 	}
 	device.channelCount = 0;
+}
+
+void AudioInputLevelMonitor::stopDevice(MonitoredDevice& device) {
+	closeStream(device);
 	device.leftLevel.store(0.0f);
 	device.rightLevel.store(0.0f);
 }
 
 bool AudioInputLevelMonitor::startDevice(MonitoredDevice& device) {
-	device.startAttempted = true;
-
 	const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(device.paIndex);
 	if (!deviceInfo || deviceInfo->maxInputChannels < 1) {
+		device.openFailed = true;
 		return false;
 	}
 	if (!device.allowLevelMonitoring) {
@@ -544,6 +664,7 @@ bool AudioInputLevelMonitor::startDevice(MonitoredDevice& device) {
 
 	if (openErr != paNoError) {
 		device.channelCount = 0;
+		device.openFailed = true;
 		return false;
 	}
 
@@ -551,6 +672,7 @@ bool AudioInputLevelMonitor::startDevice(MonitoredDevice& device) {
 	if (startErr != paNoError) {
 		Pa_CloseStream(stream);
 		device.channelCount = 0;
+		device.openFailed = true;
 		return false;
 	}
 
@@ -4,14 +4,18 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "audio_processor.h"
+#include "audio_stream_settings.h"
 #include "dc_filter.h"
 #include "noise_gate.h"
 #include "fft_processor.h"
+#include "input_capture.h"
 
 class AudioInput {
 public:
@@ -25,8 +29,9 @@ public:
 	AudioInput();
 	~AudioInput();
 
-	static std::vector<DeviceInfo> getInputDevices();
-	bool initStream(int deviceIndex, int numChannels = 1);
+	static std::vector<DeviceInfo> getInputDevices(
+		AudioStreamSettings::HostApi hostApi = AudioStreamSettings::HostApi::Default);
+	bool initStream(int deviceIndex, int numChannels = 1, const AudioStreamSettings& settings = {});
 	bool pauseStream();
 	bool resumeStream();
 	bool isStreamActive() const;
@@ -34,7 +39,7 @@ public:
 		return {leftLevel.load(), rightLevel.load()};
 	}
 	AudioProcessor::SpectralData getSpectralData() const;
-	void copySpectralData(AudioProcessor::SpectralData& out) const { processor.copySpectralData(out); }
+	AudioProcessor::SpectralSnapshot acquireSpectralData() const { return processor.acquireSpectralData(); }
 	FFTProcessor& getFFTProcessor(size_t channel = 0) { return processor.getFFTProcessor(channel); }
 	const FFTProcessor& getFFTProcessor(size_t channel = 0) const { return processor.getFFTProcessor(channel); }
 	AudioProcessor& getAudioProcessor() { return processor; }
@@ -48,6 +53,17 @@ public:
 		activeChannel.store(channel >= 0 && channel < channelCount ? channel : 0);
 	}
 	float getSampleRate() const { return sampleRate; }
+	// Zero while no stream is open.
+	const AudioStreamLatency& getStreamLatency() const { return streamLatency; }
+	// Input latency, plus half the analysis window, about where its energy centres, plus the
+	// analysis thread's median time per buffer. The colour then waits for the next UI frame.
+	double estimateAnalysisLatencySeconds() const;
+
+	// Records the open stream's callback blocks to path until stopCapture() or the stream
+	// closes. Replay them with InputCaptureReplay.
+	bool startCapture(const std::filesystem::path& path, std::string& errorMessage);
+	void stopCapture() { capture.close(); }
+	const InputCaptureWriter& getCapture() const { return capture; }
 
 private:
 	PaStream* stream;
@@ -56,9 +72,11 @@ private:
 	NoiseGate noiseGate;
 	float sampleRate;
 	int channelCount;
+	AudioStreamLatency streamLatency;
 	std::atomic<int> activeChannel;
 	std::atomic<float> leftLevel;
 	std::atomic<float> rightLevel;
+	InputCaptureWriter capture;
 
 	void stopStream();
 	void updateStereoLevels(float left, float right);
@@ -68,20 +86,26 @@ private:
 							 PaStreamCallbackFlags statusFlags, void* userData);
 };
 
+// Meters every listed input but the selected one, whose level comes from the analysis stream.
+// At most a couple of monitoring streams are open at once; beyond that the devices take turns.
 class AudioInputLevelMonitor {
 public:
 	AudioInputLevelMonitor();
 	~AudioInputLevelMonitor();
 
-	void syncDevices(const std::vector<AudioInput::DeviceInfo>& devices, int selectedPaIndex = -1);
+	// The device list is only compared when deviceListVersion differs from the last call's.
+	void syncDevices(const std::vector<AudioInput::DeviceInfo>& devices, uint64_t deviceListVersion, int selectedPaIndex = -1);
 	std::array<float, 2> getStereoLevels(size_t deviceListIndex) const;
 
 private:
 	struct MonitoredDevice;
 
 	std::vector<std::unique_ptr<MonitoredDevice>> monitoredDevices_;
+	uint64_t syncedVersion_ = 0;
+	size_t nextDeviceToSample_ = 0;
 
 	void stopAll();
+	static void closeStream(MonitoredDevice& device);
 	static void stopDevice(MonitoredDevice& device);
 	static bool startDevice(MonitoredDevice& device);
 	static int monitorCallback(const void* input, void* output, unsigned long frameCount,
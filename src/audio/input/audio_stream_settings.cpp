@@ -0,0 +1,188 @@
+#include "audio_stream_settings.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string>
+
+#if defined(_WIN32) && __has_include(<pa_win_wasapi.h>)
+#include <pa_win_wasapi.h>
+#define SYNESTHESIA_WASAPI_STREAM_INFO 1
+#endif
+
+namespace AudioStreamConfig {
+
+namespace {
+
+using HostApi = AudioStreamSettings::HostApi;
+
+constexpr std::array<HostApi, 7> kHostApis{
+	HostApi::Default,
+	HostApi::CoreAudio,
+	HostApi::WASAPI,
+	HostApi::WASAPIExclusive,
+	HostApi::ASIO,
+	HostApi::JACK,
+	HostApi::ALSA
+};
+
+std::optional<PaHostApiTypeId> typeIdFor(const HostApi hostApi) {
+	switch (hostApi) {
+		case HostApi::CoreAudio:
+			return paCoreAudio;
+		case HostApi::WASAPI:
+		case HostApi::WASAPIExclusive:
+			return paWASAPI;
+		case HostApi::ASIO:
+			return paASIO;
+		case HostApi::JACK:
+			return paJACK;
+		case HostApi::ALSA:
+			return paALSA;
+		case HostApi::Default:
+		default:
+			return std::nullopt;
+	}
+}
+
+const PaHostApiInfo* hostApiInfoFor(const HostApi hostApi) {
+	const std::optional<PaHostApiTypeId> typeId = typeIdFor(hostApi);
+	if (!typeId) {
+		return nullptr;
+	}
+	const PaHostApiIndex index = Pa_HostApiTypeIdToHostApiIndex(*typeId);
+	return index >= 0 ? Pa_GetHostApiInfo(index) : nullptr;
+}
+
+std::string lowercase(const std::string_view text) {
+	std::string lower;
+	lower.reserve(text.size());
+	for (const char ch : text) {
+		lower.push_back(ch == '_' || ch == ' ' ? '-' : static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+	}
+	return lower;
+}
+
+}
+
+struct HostApiStreamInfo::Storage {
+#ifdef SYNESTHESIA_WASAPI_STREAM_INFO
+	PaWasapiStreamInfo wasapi{};
+#endif
+};
+
+std::span<const HostApi> allHostApis() {
+	return kHostApis;
+}
+
+const char* hostApiName(const HostApi hostApi) {
+	switch (hostApi) {
+		case HostApi::CoreAudio:
+			return "CoreAudio";
+		case HostApi::WASAPI:
+			return "WASAPI";
+		case HostApi::WASAPIExclusive:
+			return "WASAPI (exclusive)";
+		case HostApi::ASIO:
+			return "ASIO";
+		case HostApi::JACK:
+			return "JACK";
+		case HostApi::ALSA:
+			return "ALSA";
+		case HostApi::Default:
+		default:
+			return "Default";
+	}
+}
+
+std::optional<HostApi> parseHostApi(const std::string_view name) {
+	const std::string lower = lowercase(name);
+	if (lower == "wasapi-exclusive" || lower == "wasapi-(exclusive)") {
+		return HostApi::WASAPIExclusive;
+	}
+	for (const HostApi hostApi : kHostApis) {
+		if (lower == lowercase(hostApiName(hostApi))) {
+			return hostApi;
+		}
+	}
+	return std::nullopt;
+}
+
+bool isHostApiAvailable(const HostApi hostApi) {
+	if (hostApi == HostApi::Default) {
+		return true;
+	}
+#ifndef SYNESTHESIA_WASAPI_STREAM_INFO
+	if (hostApi == HostApi::WASAPIExclusive) {
+		return false;
+	}
+#endif
+	return hostApiInfoFor(hostApi) != nullptr;
+}
+
+bool deviceMatchesHostApi(const PaDeviceInfo& deviceInfo, const HostApi hostApi) {
+	if (hostApi == HostApi::Default) {
+		return true;
+	}
+	const PaHostApiInfo* info = Pa_GetHostApiInfo(deviceInfo.hostApi);
+	const std::optional<PaHostApiTypeId> typeId = typeIdFor(hostApi);
+	return info != nullptr && typeId && info->type == *typeId;
+}
+
+HostApi hostApiOfDevice(const PaDeviceInfo& deviceInfo) {
+	if (const PaHostApiInfo* info = Pa_GetHostApiInfo(deviceInfo.hostApi)) {
+		for (const HostApi hostApi : kHostApis) {
+			if (hostApi != HostApi::WASAPIExclusive && typeIdFor(hostApi) == info->type) {
+				return hostApi;
+			}
+		}
+	}
+	return HostApi::Default;
+}
+
+PaDeviceIndex defaultInputDevice(const HostApi hostApi) {
+	const PaHostApiInfo* info = hostApiInfoFor(hostApi);
+	return info != nullptr && info->defaultInputDevice != paNoDevice ? info->defaultInputDevice
+																	 : Pa_GetDefaultInputDevice();
+}
+
+PaDeviceIndex defaultOutputDevice(const HostApi hostApi) {
+	const PaHostApiInfo* info = hostApiInfoFor(hostApi);
+	return info != nullptr && info->defaultOutputDevice != paNoDevice ? info->defaultOutputDevice
+																	  : Pa_GetDefaultOutputDevice();
+}
+
+double suggestedLatency(const AudioStreamSettings& settings, const double deviceLowLatency) {
+	return settings.suggestedLatencySeconds > 0.0 ? settings.suggestedLatencySeconds : deviceLowLatency;
+}
+
+unsigned long framesPerBuffer(const AudioStreamSettings& settings, const unsigned long streamDefault) {
+	return settings.framesPerBuffer > 0 ? static_cast<unsigned long>(settings.framesPerBuffer) : streamDefault;
+}
+
+HostApiStreamInfo::HostApiStreamInfo(const AudioStreamSettings& settings) {
+#ifdef SYNESTHESIA_WASAPI_STREAM_INFO
+	if (settings.hostApi == HostApi::WASAPIExclusive) {
+		storage_ = std::make_unique<Storage>();
+		storage_->wasapi.size = sizeof(PaWasapiStreamInfo);
+		storage_->wasapi.hostApiType = paWASAPI;
+		storage_->wasapi.version = 1;
+		storage_->wasapi.flags = paWinWasapiExclusive;
+	}
+#else
+	(void)settings;
+#endif
+}
+
+HostApiStreamInfo::~HostApiStreamInfo() = default;
+
+void* HostApiStreamInfo::get() const {
+#ifdef SYNESTHESIA_WASAPI_STREAM_INFO
+	if (storage_) {
+		return &storage_->wasapi;
+	}
+#endif
+	return nullptr;
+}
+
+}
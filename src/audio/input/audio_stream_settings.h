@@ -0,0 +1,80 @@
+#pragma once
+
+#include <portaudio.h>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+// What a stream asks PortAudio for when it opens. Zero leaves a value to the stream's own
+// default: the device's low latency, and for the buffer the FFT size on input and 512 frames
+// on output. A host API other than Default restricts the device lists to that API's devices.
+struct AudioStreamSettings {
+	enum class HostApi {
+		Default,
+		CoreAudio,
+		WASAPI,
+		WASAPIExclusive,
+		ASIO,
+		JACK,
+		ALSA
+	};
+
+	HostApi hostApi = HostApi::Default;
+	int framesPerBuffer = 0;
+	double suggestedLatencySeconds = 0.0;
+
+	bool operator==(const AudioStreamSettings&) const = default;
+};
+
+// What PortAudio granted an open stream. latencySeconds is its reported input or output
+// latency, which includes the buffering.
+struct AudioStreamLatency {
+	double latencySeconds = 0.0;
+	double sampleRate = 0.0;
+	unsigned long framesPerBuffer = 0;
+	AudioStreamSettings::HostApi hostApi = AudioStreamSettings::HostApi::Default;
+
+	double bufferSeconds() const {
+		return sampleRate > 0.0 ? static_cast<double>(framesPerBuffer) / sampleRate : 0.0;
+	}
+};
+
+namespace AudioStreamConfig {
+
+std::span<const AudioStreamSettings::HostApi> allHostApis();
+const char* hostApiName(AudioStreamSettings::HostApi hostApi);
+// Accepts the names hostApiName returns, case-insensitively, and the CLI spellings
+// (coreaudio, wasapi, wasapi-exclusive, asio, jack, alsa, default).
+std::optional<AudioStreamSettings::HostApi> parseHostApi(std::string_view name);
+
+// Whether this PortAudio build has the host API; Default always is.
+bool isHostApiAvailable(AudioStreamSettings::HostApi hostApi);
+bool deviceMatchesHostApi(const PaDeviceInfo& deviceInfo, AudioStreamSettings::HostApi hostApi);
+AudioStreamSettings::HostApi hostApiOfDevice(const PaDeviceInfo& deviceInfo);
+// The host API's default device, or PortAudio's when hostApi is Default or unavailable.
+PaDeviceIndex defaultInputDevice(AudioStreamSettings::HostApi hostApi);
+PaDeviceIndex defaultOutputDevice(AudioStreamSettings::HostApi hostApi);
+
+double suggestedLatency(const AudioStreamSettings& settings, double deviceLowLatency);
+unsigned long framesPerBuffer(const AudioStreamSettings& settings, unsigned long streamDefault);
+
+// Host-specific stream parameters, which must outlive the Pa_OpenStream call they are passed
+// to. Null unless the settings need any (WASAPI exclusive mode).
+class HostApiStreamInfo {
+public:
+	explicit HostApiStreamInfo(const AudioStreamSettings& settings);
+	~HostApiStreamInfo();
+
+	HostApiStreamInfo(const HostApiStreamInfo&) = delete;
+	HostApiStreamInfo& operator=(const HostApiStreamInfo&) = delete;
+
+	void* get() const;
+
+private:
+	struct Storage;
+	std::unique_ptr<Storage> storage_;
+};
+
+}
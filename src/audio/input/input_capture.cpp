@@ -0,0 +1,240 @@
+#include "input_capture.h"
+
+#include <portaudio.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "audio_processor.h"
+#include "utilities/telemetry/telemetry.h"
+
+namespace {
+
+constexpr auto WRITER_POLL_INTERVAL = std::chrono::milliseconds(10);
+constexpr auto REPLAY_POLL_INTERVAL = std::chrono::microseconds(100);
+// An unpaced replay stops waiting on a block the processor never analyses, such as one sent
+// while it is stopped.
+constexpr auto REPLAY_BLOCK_TIMEOUT = std::chrono::seconds(1);
+// Far past any callback PortAudio makes; a larger block means the capture is corrupt.
+constexpr uint32_t MAX_REPLAY_BLOCK_FRAMES = uint32_t{1} << 20;
+constexpr uint32_t MAX_CAPTURE_CHANNELS = 256;
+
+int64_t toMicros(const std::chrono::steady_clock::duration duration) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+}
+
+InputCaptureWriter::InputCaptureWriter() = default;
+
+InputCaptureWriter::~InputCaptureWriter() {
+	close();
+}
+
+bool InputCaptureWriter::open(const std::filesystem::path& path, const float sampleRate, const size_t channels,
+							  std::string& errorMessage) {
+	close();
+	if (channels == 0 || channels > MAX_CAPTURE_CHANNELS || sampleRate <= 0.0f) {
+		errorMessage = "Nothing to capture from this stream";
+		return false;
+	}
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		errorMessage = "Unable to open " + path.string();
+		return false;
+	}
+	InputCapture::FileHeader header;
+	header.sampleRate = sampleRate;
+	header.channelCount = static_cast<uint32_t>(channels);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!file) {
+		errorMessage = "Unable to write " + path.string();
+		file.close();
+		return false;
+	}
+
+	ring.resize(RING_BYTES);
+	ringWritePosition.store(0, std::memory_order_relaxed);
+	ringReadPosition.store(0, std::memory_order_relaxed);
+	blocksWritten.store(0, std::memory_order_relaxed);
+	blocksDropped.store(0, std::memory_order_relaxed);
+	hasFirstCallback = false;
+	pendingDropped = 0;
+	channelCount = channels;
+
+	stopWriter.store(false, std::memory_order_relaxed);
+	writerThread = std::thread(&InputCaptureWriter::writerThreadFunc, this);
+	recording.store(true);
+	return true;
+}
+
+void InputCaptureWriter::close() {
+	if (!writerThread.joinable()) {
+		return;
+	}
+	// push() raises activePushes before it checks recording, so once this sees none the
+	// callback cannot write again.
+	recording.store(false);
+	while (activePushes.load() != 0) {
+		std::this_thread::yield();
+	}
+	stopWriter.store(true, std::memory_order_release);
+	writerThread.join();
+	file.close();
+}
+
+void InputCaptureWriter::push(const float* interleaved, const unsigned long frameCount,
+							  const std::chrono::steady_clock::time_point callbackTime,
+							  const std::chrono::steady_clock::time_point capturedAt, const uint32_t statusFlags) {
+	activePushes.fetch_add(1);
+	if (!recording.load() || !interleaved || frameCount == 0) {
+		activePushes.fetch_sub(1);
+		return;
+	}
+
+	if (!hasFirstCallback) {
+		firstCallback = callbackTime;
+		hasFirstCallback = true;
+	}
+
+	const size_t sampleBytes = static_cast<size_t>(frameCount) * channelCount * sizeof(float);
+	const size_t recordBytes = sizeof(InputCapture::BlockHeader) + sampleBytes;
+	const uint64_t write = ringWritePosition.load(std::memory_order_relaxed);
+	if (recordBytes > RING_BYTES - (write - ringReadPosition.load(std::memory_order_acquire))) {
+		++pendingDropped;
+		blocksDropped.fetch_add(1, std::memory_order_relaxed);
+		activePushes.fetch_sub(1);
+		return;
+	}
+
+	InputCapture::BlockHeader header;
+	header.callbackMicros = toMicros(callbackTime - firstCallback);
+	header.captureLeadMicros = toMicros(callbackTime - capturedAt);
+	header.frameCount = static_cast<uint32_t>(frameCount);
+	header.statusFlags = statusFlags;
+	header.droppedBefore = pendingDropped;
+
+	const auto copyIn = [this](const uint64_t position, const void* source, const size_t bytes) {
+		const size_t offset = static_cast<size_t>(position % RING_BYTES);
+		const size_t first = std::min(bytes, RING_BYTES - offset);
+		std::memcpy(ring.data() + offset, source, first);
+		std::memcpy(ring.data(), static_cast<const std::byte*>(source) + first, bytes - first);
+	};
+	copyIn(write, &header, sizeof(header));
+	copyIn(write + sizeof(header), interleaved, sampleBytes);
+	ringWritePosition.store(write + recordBytes, std::memory_order_release);
+
+	pendingDropped = 0;
+	blocksWritten.fetch_add(1, std::memory_order_relaxed);
+	activePushes.fetch_sub(1);
+}
+
+size_t InputCaptureWriter::drain() {
+	const uint64_t read = ringReadPosition.load(std::memory_order_relaxed);
+	const uint64_t write = ringWritePosition.load(std::memory_order_acquire);
+	const size_t bytes = static_cast<size_t>(write - read);
+	if (bytes == 0) {
+		return 0;
+	}
+	const size_t offset = static_cast<size_t>(read % RING_BYTES);
+	const size_t first = std::min(bytes, RING_BYTES - offset);
+	file.write(reinterpret_cast<const char*>(ring.data() + offset), static_cast<std::streamsize>(first));
+	file.write(reinterpret_cast<const char*>(ring.data()), static_cast<std::streamsize>(bytes - first));
+	ringReadPosition.store(write, std::memory_order_release);
+	return bytes;
+}
+
+void InputCaptureWriter::writerThreadFunc() {
+	while (!stopWriter.load(std::memory_order_acquire)) {
+		if (drain() == 0) {
+			std::this_thread::sleep_for(WRITER_POLL_INTERVAL);
+		}
+	}
+	drain();
+	file.flush();
+}
+
+bool InputCaptureReplay::open(const std::filesystem::path& path, std::string& errorMessage) {
+	file.close();
+	file.clear();
+	file.open(path, std::ios::binary);
+	if (!file) {
+		errorMessage = "Unable to open " + path.string();
+		return false;
+	}
+	header = {};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.magic != InputCapture::MAGIC) {
+		errorMessage = path.string() + " is not an input capture";
+		return false;
+	}
+	if (header.channelCount == 0 || header.channelCount > MAX_CAPTURE_CHANNELS || !(header.sampleRate > 0.0f)) {
+		errorMessage = path.string() + " has an invalid stream format";
+		return false;
+	}
+	return true;
+}
+
+InputCaptureReplay::Result InputCaptureReplay::replay(AudioProcessor& processor, const float speed,
+													  const std::atomic<bool>& stop) {
+	Result result;
+	const bool paced = speed > 0.0f;
+	const uint64_t droppedAtStart = processor.getDroppedBufferCount();
+	const auto replayStart = std::chrono::steady_clock::now();
+	const auto scaled = [speed](const int64_t micros) {
+		return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double, std::micro>(static_cast<double>(micros) / speed));
+	};
+
+	InputCapture::BlockHeader blockHeader;
+	while (!stop.load(std::memory_order_acquire) &&
+		   file.read(reinterpret_cast<char*>(&blockHeader), sizeof(blockHeader))) {
+		if (blockHeader.frameCount == 0 || blockHeader.frameCount > MAX_REPLAY_BLOCK_FRAMES) {
+			break;
+		}
+		const size_t samples = static_cast<size_t>(blockHeader.frameCount) * header.channelCount;
+		block.resize(samples);
+		if (!file.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(samples * sizeof(float)))) {
+			break;
+		}
+		result.captureDropped += blockHeader.droppedBefore;
+
+		auto callbackTime = std::chrono::steady_clock::now();
+		auto captureLead = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::microseconds(blockHeader.captureLeadMicros));
+		if (paced) {
+			callbackTime = replayStart + scaled(blockHeader.callbackMicros);
+			captureLead = scaled(blockHeader.captureLeadMicros);
+			std::this_thread::sleep_until(callbackTime);
+		}
+
+		// Replayed xruns count where the live ones did, so telemetry reads as it did on the rig.
+		if (blockHeader.statusFlags & paInputOverflow) {
+			Utilities::Telemetry::increment(Utilities::Telemetry::Counter::InputOverflows);
+		}
+		if (blockHeader.statusFlags & paInputUnderflow) {
+			Utilities::Telemetry::increment(Utilities::Telemetry::Counter::InputUnderflows);
+		}
+
+		const uint64_t seenGeneration = processor.bufferedFrameGeneration();
+		const uint64_t droppedBefore = processor.getDroppedBufferCount();
+		processor.queueAudioData(block.data(), samples, header.sampleRate, header.channelCount,
+								 callbackTime - captureLead);
+		++result.blocks;
+
+		if (!paced) {
+			const auto giveUpAt = std::chrono::steady_clock::now() + REPLAY_BLOCK_TIMEOUT;
+			while (!stop.load(std::memory_order_acquire) &&
+				   processor.bufferedFrameGeneration() == seenGeneration &&
+				   processor.getDroppedBufferCount() == droppedBefore &&
+				   std::chrono::steady_clock::now() < giveUpAt) {
+				std::this_thread::sleep_for(REPLAY_POLL_INTERVAL);
+			}
+		}
+	}
+
+	result.processorDropped = processor.getDroppedBufferCount() - droppedAtStart;
+	result.elapsed = std::chrono::steady_clock::now() - replayStart;
+	return result;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AudioProcessor;
+
+// Input captures hold the blocks the input callback handed to AudioProcessor, with the
+// callback's timing, so a problem seen on a live rig can be replayed through the same
+// analysis path block for block. A capture is a FileHeader and then one BlockHeader per
+// callback, each followed by its frameCount * channelCount interleaved float32 samples,
+// all in the byte order of the machine that wrote it.
+namespace InputCapture {
+
+inline constexpr std::array<char, 8> MAGIC{'S', 'Y', 'N', 'C', 'A', 'P', '0', '1'};
+
+struct FileHeader {
+	std::array<char, 8> magic = MAGIC;
+	float sampleRate = 0.0f;
+	uint32_t channelCount = 0;
+};
+
+struct BlockHeader {
+	// When the callback ran, from the first captured callback.
+	int64_t callbackMicros = 0;
+	// How long before the callback the block's first sample was captured.
+	int64_t captureLeadMicros = 0;
+	uint32_t frameCount = 0;
+	// The callback's PaStreamCallbackFlags.
+	uint32_t statusFlags = 0;
+	// Blocks lost between this one and the last because the writer fell behind.
+	uint64_t droppedBefore = 0;
+};
+
+static_assert(sizeof(FileHeader) == 16 && sizeof(BlockHeader) == 32);
+
+}
+
+// Writes a capture from the input callback. push() copies the block into a ring that a
+// writer thread drains to disk, so the callback never waits on the file; a block that does
+// not fit is dropped, and counted in the next block written.
+class InputCaptureWriter {
+public:
+	// About 20 seconds of stereo at 48 kHz.
+	static constexpr size_t RING_BYTES = size_t{8} << 20;
+
+	InputCaptureWriter();
+	~InputCaptureWriter();
+
+	InputCaptureWriter(const InputCaptureWriter&) = delete;
+	InputCaptureWriter& operator=(const InputCaptureWriter&) = delete;
+
+	bool open(const std::filesystem::path& path, float sampleRate, size_t channelCount, std::string& errorMessage);
+	// Waits for the callback to leave push() and for the ring to reach the file.
+	void close();
+	bool isOpen() const { return recording.load(std::memory_order_acquire); }
+
+	// Audio callback only.
+	void push(const float* interleaved, unsigned long frameCount, std::chrono::steady_clock::time_point callbackTime,
+			  std::chrono::steady_clock::time_point capturedAt, uint32_t statusFlags);
+
+	uint64_t getBlocksWritten() const { return blocksWritten.load(std::memory_order_relaxed); }
+	uint64_t getBlocksDropped() const { return blocksDropped.load(std::memory_order_relaxed); }
+
+private:
+	void writerThreadFunc();
+	size_t drain();
+
+	std::vector<std::byte> ring;
+	std::atomic<uint64_t> ringWritePosition{0};
+	std::atomic<uint64_t> ringReadPosition{0};
+	std::atomic<bool> recording{false};
+	std::atomic<uint32_t> activePushes{0};
+	std::atomic<uint64_t> blocksWritten{0};
+	std::atomic<uint64_t> blocksDropped{0};
+
+	// Owned by the audio callback.
+	std::chrono::steady_clock::time_point firstCallback;
+	bool hasFirstCallback = false;
+	uint64_t pendingDropped = 0;
+	size_t channelCount = 1;
+
+	// Owned by the writer thread once open() has started it.
+	std::ofstream file;
+	std::thread writerThread;
+	std::atomic<bool> stopWriter{false};
+};
+
+// Feeds a capture into an AudioProcessor with the block sizes, spacing and status flags it
+// was recorded with.
+class InputCaptureReplay {
+public:
+	struct Result {
+		uint64_t blocks = 0;
+		// Blocks the processor turned away because it had fallen behind.
+		uint64_t processorDropped = 0;
+		// Blocks the capture itself lost while it was recorded.
+		uint64_t captureDropped = 0;
+		std::chrono::steady_clock::duration elapsed{};
+	};
+
+	bool open(const std::filesystem::path& path, std::string& errorMessage);
+	float getSampleRate() const { return header.sampleRate; }
+	size_t getChannelCount() const { return header.channelCount; }
+
+	// Keeps the recorded spacing between callbacks divided by speed, stamping each block as
+	// captured that long into the replay. A speed of zero or less feeds each block once the
+	// processor has analysed the one before, as fast as it goes. Returns early when stop is set.
+	Result replay(AudioProcessor& processor, float speed, const std::atomic<bool>& stop);
+
+private:
+	std::ifstream file;
+	InputCapture::FileHeader header;
+	std::vector<float> block;
+};
@@ -1,19 +1,51 @@
 #include "audio_output.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 
+#include "resyne/encoding/reconstruction/varispeed.h"
+#include "utilities/telemetry/latency_probe.h"
+#include "utilities/telemetry/telemetry.h"
+#include "utilities/threading/realtime_thread.h"
+
 namespace {
 
+constexpr uint64_t CURSOR_COMMAND_PENDING = uint64_t{1} << 63;
+constexpr uint64_t CURSOR_COMMAND_CROSSFADE = uint64_t{1} << 62;
+constexpr uint64_t CURSOR_COMMAND_FRAME_MASK = CURSOR_COMMAND_CROSSFADE - 1;
+constexpr size_t SEEK_CROSSFADE_SAMPLES = 256;
+constexpr size_t RESAMPLE_BLOCK_FRAMES = 65536;
+
 float smoothedLevel(const float current, const float target) {
 	return std::max(target, current * 0.84f);
 }
 
+// Keeps callbackEpoch_ odd for the life of one callback.
+class CallbackEpochScope {
+public:
+	explicit CallbackEpochScope(std::atomic<uint64_t>& epoch) : epoch_(epoch) { epoch_.fetch_add(1); }
+	~CallbackEpochScope() { epoch_.fetch_add(1); }
+
+	CallbackEpochScope(const CallbackEpochScope&) = delete;
+	CallbackEpochScope& operator=(const CallbackEpochScope&) = delete;
+
+private:
+	std::atomic<uint64_t>& epoch_;
+};
+
 }
 
 AudioOutput::AudioOutput()
 	: stream_(nullptr),
-	  audioBuffer_(std::make_shared<std::vector<float>>()),
+	  ownedSource_(nullptr),
+	  nextSourceGeneration_(1),
+	  activeSource_(nullptr),
+	  activeStream_(nullptr),
+	  streamTrackFrames_(0),
+	  callbackEpoch_(0),
+	  pendingCursorCommand_(0),
+	  cancelResample_(false),
 	  playbackPosition_(0),
 	  totalSamples_(0),
 	  isPlaying_(false),
@@ -22,16 +54,19 @@ AudioOutput::AudioOutput()
 	  actualSampleRate_(0.0f),
 	  playbackStep_(1.0f),
 	  channelCount_(1),
+	  impulsePending_(false),
+	  playingGeneration_(0),
+	  playingFramesPerTrackFrame_(1.0),
 	  playbackCursor_(0.0),
-	  seekCrossfadeActive_(false),
-	  pendingSeekPosition_(0),
-	  seekFadeRemaining_(0),
 	  oldSeekCursor_(0.0),
+	  seekFadeRemaining_(0),
+	  impulseFrame_(IMPULSE_FRAMES),
 	  leftLevel_(0.0f),
 	  rightLevel_(0.0f) {
 }
 
 AudioOutput::~AudioOutput() {
+	cancelDeviceRateResample();
 	if (stream_) {
 		if (Pa_IsStreamActive(stream_) == 1) {
 			Pa_StopStream(stream_);
@@ -40,7 +75,7 @@ AudioOutput::~AudioOutput() {
 	}
 }
 
-std::vector<AudioOutput::DeviceInfo> AudioOutput::getOutputDevices() {
+std::vector<AudioOutput::DeviceInfo> AudioOutput::getOutputDevices(const AudioStreamSettings::HostApi hostApi) {
 	std::vector<DeviceInfo> devices;
 
 	const int deviceCount = Pa_GetDeviceCount();
@@ -51,7 +86,7 @@ std::vector<AudioOutput::DeviceInfo> AudioOutput::getOutputDevices() {
 	devices.reserve(static_cast<size_t>(deviceCount));
 	for (int i = 0; i < deviceCount; ++i) {
 		if (const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(i)) {
-			if (deviceInfo->maxOutputChannels > 0) {
+			if (deviceInfo->maxOutputChannels > 0 && AudioStreamConfig::deviceMatchesHostApi(*deviceInfo, hostApi)) {
 				devices.emplace_back(DeviceInfo{deviceInfo->name, i, deviceInfo->maxOutputChannels});
 			}
 		}
@@ -59,7 +94,9 @@ std::vector<AudioOutput::DeviceInfo> AudioOutput::getOutputDevices() {
 	return devices;
 }
 
-bool AudioOutput::initOutputStream(float sampleRate, int channelCount, int deviceIndex, int framesPerBuffer) {
+bool AudioOutput::initOutputStream(float sampleRate, int channelCount, int deviceIndex,
+								   const AudioStreamSettings& settings) {
+	cancelDeviceRateResample();
 	if (stream_) {
 		if (Pa_IsStreamActive(stream_) == 1) {
 			Pa_StopStream(stream_);
@@ -67,6 +104,14 @@ bool AudioOutput::initOutputStream(float sampleRate, int channelCount, int devic
 		Pa_CloseStream(stream_);
 		stream_ = nullptr;
 	}
+	streamLatency_ = {};
+	{
+		// A resample for the previous device would play at the wrong speed on the new one.
+		std::lock_guard<std::mutex> lock(controlMutex_);
+		if (ownedSource_ && ownedSource_->deviceRate) {
+			replaceSource(trackSamples_, 1.0, false);
+		}
+	}
 	requestedSampleRate_.store(sampleRate);
 	actualSampleRate_.store(sampleRate);
 	playbackStep_.store(1.0f);
@@ -76,7 +121,7 @@ bool AudioOutput::initOutputStream(float sampleRate, int channelCount, int devic
 	if (deviceIndex >= 0) {
 		outputParameters.device = deviceIndex;
 	} else {
-		outputParameters.device = Pa_GetDefaultOutputDevice();
+		outputParameters.device = AudioStreamConfig::defaultOutputDevice(settings.hostApi);
 	}
 	if (outputParameters.device == paNoDevice) {
 		return false;
@@ -91,15 +136,18 @@ bool AudioOutput::initOutputStream(float sampleRate, int channelCount, int devic
 	const int clampedChannels = std::min(requestedChannels, deviceInfo->maxOutputChannels);
 	outputParameters.channelCount = clampedChannels;
 	outputParameters.sampleFormat = paFloat32;
-	outputParameters.suggestedLatency = deviceInfo->defaultLowOutputLatency;
-	outputParameters.hostApiSpecificStreamInfo = nullptr;
+	const AudioStreamConfig::HostApiStreamInfo hostApiStreamInfo(settings);
+	outputParameters.suggestedLatency =
+		AudioStreamConfig::suggestedLatency(settings, deviceInfo->defaultLowOutputLatency);
+	outputParameters.hostApiSpecificStreamInfo = hostApiStreamInfo.get();
 
+	const unsigned long framesPerBuffer = AudioStreamConfig::framesPerBuffer(settings, DEFAULT_FRAMES_PER_BUFFER);
 	PaError err = Pa_OpenStream(
 		&stream_,
 		nullptr,
 		&outputParameters,
 		static_cast<double>(sampleRate),
-		static_cast<unsigned long>(framesPerBuffer),
+		framesPerBuffer,
 		paClipOff,
 		&AudioOutput::audioCallback,
 		this
@@ -119,27 +167,176 @@ bool AudioOutput::initOutputStream(float sampleRate, int channelCount, int devic
 			playbackStep_.store(1.0f);
 		}
 		playbackEqualiser_.configure(actualRate, static_cast<size_t>(clampedChannels));
+		streamLatency_ = AudioStreamLatency{
+			info->outputLatency,
+			info->sampleRate,
+			framesPerBuffer,
+			AudioStreamConfig::hostApiOfDevice(*deviceInfo)
+		};
 	}
+	scheduleDeviceRateResample();
 	return true;
 }
 
-void AudioOutput::setAudioData(const std::vector<float>& audioSamples, size_t channelCount) {
-	if (audioSamples.empty()) {
+void AudioOutput::setAudioData(const PCMBuffer& audio, size_t channelCount) {
+	if (audio.empty()) {
 		clearAudioData();
 		return;
 	}
 
+	cancelDeviceRateResample();
 	channelCount_.store(std::max<size_t>(1, channelCount));
 
-	auto newBuffer = std::make_shared<std::vector<float>>(audioSamples);
+	totalSamples_.store(audio.size());
 	{
-		std::lock_guard<std::mutex> lock(bufferMutex_);
-		audioBuffer_ = std::move(newBuffer);
-		playbackCursor_ = 0.0;
+		std::lock_guard<std::mutex> lock(controlMutex_);
+		trackSamples_ = audio.shared();
+		replaceSource(trackSamples_, 1.0, false);
 	}
+	postCursorCommand(0, false);
 	playbackEqualiser_.requestReset();
-	totalSamples_.store(audioSamples.size());
 	playbackPosition_.store(0);
+	scheduleDeviceRateResample();
+}
+
+void AudioOutput::replaceSource(std::shared_ptr<const std::vector<float>> samples, const double framesPerTrackFrame,
+								 const bool deviceRate) {
+	std::unique_ptr<const PlaybackSource> source;
+	if (samples) {
+		const size_t channelCount = std::max<size_t>(1, channelCount_.load());
+		const size_t trackFrames = trackSamples_ ? trackSamples_->size() / channelCount : 0;
+		source = std::make_unique<const PlaybackSource>(
+			PlaybackSource{std::move(samples), framesPerTrackFrame, trackFrames, deviceRate, nextSourceGeneration_++});
+	}
+	activeSource_.store(source.get());
+	// A callback that was not running at the swap can only load the new source.
+	const uint64_t epoch = callbackEpoch_.load();
+	if ((epoch & 1) != 0) {
+		retiredSources_.push_back(RetiredSource{std::move(ownedSource_), epoch});
+	}
+	ownedSource_ = std::move(source);
+	reclaimRetiredSources();
+	// The track itself is counted by whoever handed it over; only the resample is the stream's.
+	Utilities::Telemetry::setBytes(Utilities::Telemetry::Memory::OutputResample,
+								   ownedSource_ && ownedSource_->deviceRate
+									   ? ownedSource_->samples->capacity() * sizeof(float)
+									   : 0);
+}
+
+void AudioOutput::reclaimRetiredSources() {
+	const uint64_t epoch = callbackEpoch_.load();
+	std::erase_if(retiredSources_, [epoch](const RetiredSource& retired) {
+		return retired.callbackEpoch != epoch;
+	});
+	std::erase_if(retiredStreams_, [epoch](const RetiredStream& retired) {
+		return retired.callbackEpoch != epoch;
+	});
+}
+
+void AudioOutput::setPlaybackStream(std::shared_ptr<PlaybackStream> stream) {
+	std::lock_guard<std::mutex> lock(controlMutex_);
+	if (stream == ownedStream_) {
+		return;
+	}
+	streamTrackFrames_.store(stream ? stream->getTrackFrames() : 0);
+	activeStream_.store(stream.get());
+	const uint64_t epoch = callbackEpoch_.load();
+	if ((epoch & 1) != 0) {
+		retiredStreams_.push_back(RetiredStream{std::move(ownedStream_), epoch});
+	}
+	ownedStream_ = std::move(stream);
+	reclaimRetiredSources();
+}
+
+void AudioOutput::scheduleDeviceRateResample() {
+	std::shared_ptr<const std::vector<float>> track;
+	{
+		std::lock_guard<std::mutex> lock(controlMutex_);
+		track = trackSamples_;
+	}
+	const float step = playbackStep_.load();
+	if (!track || track->empty() || !std::isfinite(step) || step <= 0.0f || step == 1.0f) {
+		return;
+	}
+	cancelResample_.store(false);
+	resampleThread_ = std::thread(&AudioOutput::resampleToDeviceRate, this, std::move(track),
+								  std::max<size_t>(1, channelCount_.load()), step);
+}
+
+void AudioOutput::cancelDeviceRateResample() {
+	if (resampleThread_.joinable()) {
+		cancelResample_.store(true);
+		resampleThread_.join();
+	}
+}
+
+void AudioOutput::resampleToDeviceRate(std::shared_ptr<const std::vector<float>> track, const size_t channelCount,
+									   const float step) {
+	const size_t trackFrames = track->size() / channelCount;
+	const size_t frames = Varispeed::Resampler::outputLength(trackFrames, step);
+	if (frames == 0) {
+		return;
+	}
+
+	auto resampled = std::make_shared<std::vector<float>>(frames * channelCount);
+	std::vector<float> channel(trackFrames);
+	std::vector<float> block(std::min(frames, RESAMPLE_BLOCK_FRAMES));
+	Varispeed::Resampler resampler;
+	for (size_t ch = 0; ch < channelCount; ++ch) {
+		for (size_t frame = 0; frame < trackFrames; ++frame) {
+			channel[frame] = (*track)[frame * channelCount + ch];
+		}
+		for (size_t first = 0; first < frames; first += block.size()) {
+			if (cancelResample_.load()) {
+				return;
+			}
+			const size_t count = std::min(block.size(), frames - first);
+			const std::span<float> output(block.data(), count);
+			resampler.process(channel, 0, step, first, output);
+			for (size_t i = 0; i < count; ++i) {
+				(*resampled)[(first + i) * channelCount + ch] = output[i];
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(controlMutex_);
+	if (!cancelResample_.load() && trackSamples_ == track && playbackStep_.load() == step) {
+		replaceSource(std::move(resampled), 1.0 / static_cast<double>(step), true);
+	}
+}
+
+void AudioOutput::postCursorCommand(const size_t framePosition, const bool crossfade) {
+	const uint64_t frame = std::min<uint64_t>(framePosition, CURSOR_COMMAND_FRAME_MASK);
+	pendingCursorCommand_.store(CURSOR_COMMAND_PENDING | (crossfade ? CURSOR_COMMAND_CROSSFADE : 0) | frame);
+}
+
+void AudioOutput::followSource(const PlaybackSource* source) {
+	if (!source || source->generation == playingGeneration_) {
+		return;
+	}
+	// Carries the cursors across to the new source's frames; whole frames on a resample
+	// keep the callback on its copying path.
+	const double scale = source->framesPerTrackFrame / playingFramesPerTrackFrame_;
+	playbackCursor_ *= scale;
+	oldSeekCursor_ *= scale;
+	if (source->deviceRate) {
+		playbackCursor_ = std::round(playbackCursor_);
+		oldSeekCursor_ = std::round(oldSeekCursor_);
+	}
+	playingGeneration_ = source->generation;
+	playingFramesPerTrackFrame_ = source->framesPerTrackFrame;
+}
+
+void AudioOutput::applyCursorCommand(const uint64_t command) {
+	if ((command & CURSOR_COMMAND_PENDING) == 0) {
+		return;
+	}
+	if ((command & CURSOR_COMMAND_CROSSFADE) != 0) {
+		oldSeekCursor_ = playbackCursor_;
+		seekFadeRemaining_ = SEEK_CROSSFADE_SAMPLES;
+	}
+	const double frame = static_cast<double>(command & CURSOR_COMMAND_FRAME_MASK);
+	playbackCursor_ = std::round(frame * playingFramesPerTrackFrame_);
 }
 
 void AudioOutput::setPlaybackEQEnabled(const bool enabled) {
@@ -172,6 +369,8 @@ void AudioOutput::pause() {
 
 	isPlaying_.store(false);
 	resetStereoLevels();
+	std::lock_guard<std::mutex> lock(controlMutex_);
+	reclaimRetiredSources();
 }
 
 void AudioOutput::stop() {
@@ -184,12 +383,11 @@ void AudioOutput::stop() {
 		Pa_StopStream(stream_);
 	}
 	playbackPosition_.store(0);
-	{
-		std::lock_guard<std::mutex> lock(bufferMutex_);
-		playbackCursor_ = 0.0;
-	}
+	postCursorCommand(0, false);
 	playbackEqualiser_.requestReset();
 	resetStereoLevels();
+	std::lock_guard<std::mutex> lock(controlMutex_);
+	reclaimRetiredSources();
 }
 
 void AudioOutput::seek(size_t framePosition) {
@@ -200,33 +398,42 @@ void AudioOutput::seek(size_t framePosition) {
 	const size_t oldPos = playbackPosition_.load();
 
 	constexpr size_t SEEK_THRESHOLD = 2205;
-	constexpr size_t CROSSFADE_SAMPLES = 256;
 
-	if (std::abs(static_cast<long>(clamped) - static_cast<long>(oldPos)) > static_cast<long>(SEEK_THRESHOLD)) {
-		std::lock_guard<std::mutex> lock(bufferMutex_);
-		oldSeekCursor_ = playbackCursor_;
-		pendingSeekPosition_.store(clamped);
-		seekFadeRemaining_.store(CROSSFADE_SAMPLES);
-		seekCrossfadeActive_.store(true);
-	} else {
-		std::lock_guard<std::mutex> lock(bufferMutex_);
-		playbackCursor_ = static_cast<double>(clamped);
-	}
+	const bool crossfade =
+		std::abs(static_cast<long>(clamped) - static_cast<long>(oldPos)) > static_cast<long>(SEEK_THRESHOLD);
+	postCursorCommand(clamped, crossfade);
 	playbackEqualiser_.requestReset();
 	playbackPosition_.store(clamped);
+	std::lock_guard<std::mutex> lock(controlMutex_);
+	reclaimRetiredSources();
 }
 
 void AudioOutput::clearAudioData() {
+	cancelDeviceRateResample();
 	stop();
-	std::lock_guard<std::mutex> lock(bufferMutex_);
-	audioBuffer_ = std::make_shared<std::vector<float>>();
 	totalSamples_.store(0);
+	{
+		std::lock_guard<std::mutex> lock(controlMutex_);
+		trackSamples_.reset();
+		replaceSource(nullptr, 1.0, false);
+	}
 	playbackPosition_.store(0);
-	playbackCursor_ = 0.0;
+	postCursorCommand(0, false);
 	playbackEqualiser_.requestReset();
 	resetStereoLevels();
 }
 
+bool AudioOutput::queueImpulse() {
+	if (!stream_) {
+		return false;
+	}
+	if (Pa_IsStreamActive(stream_) != 1 && Pa_StartStream(stream_) != paNoError) {
+		return false;
+	}
+	impulsePending_.store(true);
+	return true;
+}
+
 float AudioOutput::getPlaybackRateRatio() const {
 	const float actual = actualSampleRate_.load();
 	const float requested = requestedSampleRate_.load();
@@ -246,44 +453,135 @@ void AudioOutput::resetStereoLevels() {
 	rightLevel_.store(0.0f);
 }
 
+void AudioOutput::mixPendingImpulse(float* out, const unsigned long frameCount, const size_t channels,
+									const PaStreamCallbackTimeInfo* timeInfo) {
+	if (impulseFrame_ >= IMPULSE_FRAMES) {
+		if (!impulsePending_.exchange(false)) {
+			return;
+		}
+		impulseFrame_ = 0;
+		double secondsAhead = 0.0;
+		if (timeInfo && timeInfo->outputBufferDacTime > 0.0 && timeInfo->currentTime > 0.0) {
+			const double reported = timeInfo->outputBufferDacTime - timeInfo->currentTime;
+			if (reported >= 0.0 && reported < 1.0) {
+				secondsAhead = reported;
+			}
+		}
+		const auto dacTime = std::chrono::steady_clock::now() +
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(secondsAhead));
+		Utilities::Telemetry::LatencyProbe::impulseEmitted(
+			std::chrono::duration_cast<std::chrono::microseconds>(dacTime.time_since_epoch()).count());
+	}
+
+	// Flips sign every two samples and decays linearly, so its first difference stands well
+	// clear of any music under it.
+	const size_t frames = std::min<size_t>(frameCount, IMPULSE_FRAMES - impulseFrame_);
+	for (size_t frame = 0; frame < frames; ++frame, ++impulseFrame_) {
+		const float decay = 1.0f - static_cast<float>(impulseFrame_) / static_cast<float>(IMPULSE_FRAMES);
+		const float sample = ((impulseFrame_ / 2) % 2 == 0 ? IMPULSE_AMPLITUDE : -IMPULSE_AMPLITUDE) * decay;
+		for (size_t ch = 0; ch < channels; ++ch) {
+			float& value = out[frame * channels + ch];
+			value = std::clamp(value + sample, -1.0f, 1.0f);
+		}
+	}
+}
+
+void AudioOutput::finishOutputBlock(float* out, const unsigned long frameCount, const size_t channels,
+									const PaStreamCallbackTimeInfo* timeInfo) {
+	playbackEqualiser_.processInterleaved(out, frameCount, channels);
+
+	constexpr float THRESHOLD = 0.85f;
+	constexpr float KNEE = 0.1f;
+	constexpr float CEILING = 0.95f;
+
+	for (size_t i = 0; i < frameCount * channels; ++i) {
+		float sample = out[i];
+		float absSample = std::abs(sample);
+
+		if (absSample > THRESHOLD) {
+			float excess = absSample - THRESHOLD;
+			float reduction;
+
+			if (excess < KNEE) {
+				reduction = excess * excess / (2.0f * KNEE);
+			} else {
+				reduction = excess - KNEE / 2.0f;
+			}
+
+			float limited = THRESHOLD + reduction * 0.3f;
+			limited = std::min(limited, CEILING);
+			out[i] = (sample >= 0.0f) ? limited : -limited;
+		}
+	}
+
+	float leftPeak = 0.0f;
+	float rightPeak = 0.0f;
+	for (unsigned long frame = 0; frame < frameCount; ++frame) {
+		const size_t offset = static_cast<size_t>(frame) * channels;
+		const float left = std::abs(out[offset]);
+		const float right = channels > 1 ? std::abs(out[offset + 1]) : left;
+		leftPeak = std::max(leftPeak, left);
+		rightPeak = std::max(rightPeak, right);
+	}
+	updateStereoLevels(leftPeak, rightPeak);
+	mixPendingImpulse(out, frameCount, channels, timeInfo);
+}
+
 int AudioOutput::audioCallback(const void* input, void* output,
 								unsigned long frameCount,
 								const PaStreamCallbackTimeInfo* timeInfo,
 								PaStreamCallbackFlags statusFlags,
 								void* userData) {
 	(void)input;
-	(void)timeInfo;
-	(void)statusFlags;
+
+	const Utilities::Telemetry::StageTimer stageTimer(Utilities::Telemetry::Stage::OutputCallback);
+	if (statusFlags & paOutputUnderflow) {
+		Utilities::Telemetry::increment(Utilities::Telemetry::Counter::OutputUnderflows);
+	}
+	if (statusFlags & paOutputOverflow) {
+		Utilities::Telemetry::increment(Utilities::Telemetry::Counter::OutputOverflows);
+	}
 
 	auto* audioOutput = static_cast<AudioOutput*>(userData);
 	auto* out = static_cast<float*>(output);
 	const size_t outputChannels = audioOutput->channelCount_.load();
 
+	static thread_local bool threadConfigured = false;
+	if (!threadConfigured) {
+		threadConfigured = true;
+		const float deviceRate = audioOutput->actualSampleRate_.load();
+		Utilities::Threading::configureCurrentThread(Utilities::Threading::ThreadRole::AudioCallback,
+													 deviceRate > 0.0f ? static_cast<double>(frameCount) / deviceRate : 0.0);
+	}
+
+	// The cursor command is taken before the source is loaded, so a reset posted after a
+	// track swap is never applied to the track it replaced.
+	const CallbackEpochScope epochScope(audioOutput->callbackEpoch_);
+	const uint64_t cursorCommand = audioOutput->pendingCursorCommand_.exchange(0);
+	const PlaybackSource* source = audioOutput->activeSource_.load();
+	audioOutput->followSource(source);
+	audioOutput->applyCursorCommand(cursorCommand);
+
 	if (!audioOutput->isPlaying_.load()) {
 		std::memset(out, 0, frameCount * outputChannels * sizeof(float));
 		audioOutput->resetStereoLevels();
+		audioOutput->mixPendingImpulse(out, frameCount, outputChannels, timeInfo);
 		return paContinue;
 	}
 
-	std::shared_ptr<std::vector<float>> bufferSnapshot;
-	double cursorSnapshot = 0.0;
-	double oldSeekCursorSnapshot = 0.0;
-	bool seekFading = false;
-	{
-		std::lock_guard<std::mutex> lock(audioOutput->bufferMutex_);
-		bufferSnapshot = audioOutput->audioBuffer_;
-		cursorSnapshot = audioOutput->playbackCursor_;
-
-		if (audioOutput->seekCrossfadeActive_.load()) {
-			oldSeekCursorSnapshot = audioOutput->oldSeekCursor_;
-			audioOutput->playbackCursor_ = static_cast<double>(audioOutput->pendingSeekPosition_.load());
-			cursorSnapshot = audioOutput->playbackCursor_;
-			seekFading = true;
-			audioOutput->seekCrossfadeActive_.store(false);
+	if (PlaybackStream* playbackStream = audioOutput->activeStream_.load()) {
+		playbackStream->read(out, frameCount, outputChannels, audioOutput->playbackStep_.load());
+		audioOutput->streamTrackFrames_.store(playbackStream->getTrackFrames());
+		audioOutput->playbackPosition_.store(static_cast<size_t>(std::max(0.0, playbackStream->getTrackPosition())));
+		if (playbackStream->hasEnded()) {
+			audioOutput->isPlaying_.store(false);
 		}
+		audioOutput->finishOutputBlock(out, frameCount, outputChannels, timeInfo);
+		return paContinue;
 	}
 
-	const size_t totalSamples = audioOutput->totalSamples_.load();
+	const std::vector<float>* bufferSnapshot = source != nullptr ? source->samples.get() : nullptr;
+	const size_t totalSamples = bufferSnapshot != nullptr ? bufferSnapshot->size() : 0;
 	const bool loopEnabled = audioOutput->loopEnabled_.load();
 	const size_t totalFrames = outputChannels > 0 ? totalSamples / outputChannels : totalSamples;
 	const double totalFramesDouble = static_cast<double>(totalFrames);
@@ -291,21 +589,33 @@ int AudioOutput::audioCallback(const void* input, void* output,
 	if (!bufferSnapshot || bufferSnapshot->empty() || totalFrames == 0) {
 		std::memset(out, 0, frameCount * outputChannels * sizeof(float));
 		audioOutput->resetStereoLevels();
+		audioOutput->mixPendingImpulse(out, frameCount, outputChannels, timeInfo);
 		return paContinue;
 	}
 
-	double cursor = cursorSnapshot;
-	double step = static_cast<double>(audioOutput->playbackStep_.load());
+	double cursor = audioOutput->playbackCursor_;
+	double step = source->deviceRate ? 1.0 : static_cast<double>(audioOutput->playbackStep_.load());
 	if (!std::isfinite(step) || step <= 0.0) {
 		step = 1.0;
 	}
 
 	bool stopPlayback = false;
 	const auto& buffer = *bufferSnapshot;
-	double oldSeekCursor = oldSeekCursorSnapshot;
-	size_t seekFadeRemaining = seekFading ? audioOutput->seekFadeRemaining_.load() : 0;
+	double oldSeekCursor = audioOutput->oldSeekCursor_;
+	size_t seekFadeRemaining = audioOutput->seekFadeRemaining_;
+
+	// A source already at the device rate copies straight through, short of the last frame,
+	// which the loop crossfade blends with the first.
+	unsigned long copiedFrames = 0;
+	if (source->deviceRate && seekFadeRemaining == 0 && cursor >= 0.0 && cursor == std::floor(cursor) &&
+		cursor + 1.0 < totalFramesDouble) {
+		const size_t frameIndex = static_cast<size_t>(cursor);
+		copiedFrames = static_cast<unsigned long>(std::min<size_t>(frameCount, totalFrames - 1 - frameIndex));
+		std::memcpy(out, &buffer[frameIndex * outputChannels], copiedFrames * outputChannels * sizeof(float));
+		cursor += static_cast<double>(copiedFrames);
+	}
 
-	for (unsigned long i = 0; i < frameCount; ++i) {
+	for (unsigned long i = copiedFrames; i < frameCount; ++i) {
 		if (!loopEnabled && cursor >= totalFramesDouble) {
 			const size_t remaining = frameCount - i;
 			if (remaining > 0) {
@@ -384,8 +694,7 @@ int AudioOutput::audioCallback(const void* input, void* output,
 
 			const double oldFrac = std::clamp(oldWorkingCursor - static_cast<double>(oldClampedFrameIndex), 0.0, 1.0);
 
-			const size_t totalCrossfadeSamples = 256;
-			const float fadeIn = static_cast<float>(totalCrossfadeSamples - seekFadeRemaining) / static_cast<float>(totalCrossfadeSamples);
+			const float fadeIn = static_cast<float>(SEEK_CROSSFADE_SAMPLES - seekFadeRemaining) / static_cast<float>(SEEK_CROSSFADE_SAMPLES);
 			const float fadeOut = 1.0f - fadeIn;
 
 			for (size_t ch = 0; ch < outputChannels; ++ch) {
@@ -416,71 +725,28 @@ int AudioOutput::audioCallback(const void* input, void* output,
 		finalCursor = std::clamp(finalCursor, 0.0, totalFramesDouble);
 	}
 
-	{
-		std::lock_guard<std::mutex> lock(audioOutput->bufferMutex_);
-		audioOutput->playbackCursor_ = finalCursor;
-	}
-
-	if (seekFading) {
-		audioOutput->seekFadeRemaining_.store(seekFadeRemaining);
-	}
+	audioOutput->playbackCursor_ = finalCursor;
+	audioOutput->oldSeekCursor_ = oldSeekCursor;
+	audioOutput->seekFadeRemaining_ = seekFadeRemaining;
 
+	// Positions are reported in track frames whatever the source.
+	const size_t trackFrames = source->trackFrames;
+	const auto trackFrameAt = [&](const double sourceCursor) {
+		const size_t frame = static_cast<size_t>(std::floor(sourceCursor / source->framesPerTrackFrame));
+		return std::min(frame, trackFrames > 0 ? trackFrames - 1 : 0);
+	};
 	if (loopEnabled) {
-		size_t stored = static_cast<size_t>(std::floor(finalCursor));
-		if (stored >= totalFrames) {
-			stored = totalFrames > 0 ? totalFrames - 1 : 0;
-		}
-		audioOutput->playbackPosition_.store(stored);
+		audioOutput->playbackPosition_.store(trackFrameAt(finalCursor));
 	} else {
 		if (stopPlayback || finalCursor >= totalFramesDouble) {
-			audioOutput->playbackPosition_.store(totalFrames);
+			audioOutput->playbackPosition_.store(trackFrames);
 			audioOutput->isPlaying_.store(false);
 		} else {
-			size_t stored = static_cast<size_t>(std::floor(finalCursor));
-			if (stored >= totalFrames) {
-				stored = totalFrames - 1;
-			}
-			audioOutput->playbackPosition_.store(stored);
-		}
-	}
-
-	audioOutput->playbackEqualiser_.processInterleaved(out, frameCount, outputChannels);
-
-
-	constexpr float THRESHOLD = 0.85f;
-	constexpr float KNEE = 0.1f;
-	constexpr float CEILING = 0.95f;
-
-	for (size_t i = 0; i < frameCount * outputChannels; ++i) {
-		float sample = out[i];
-		float absSample = std::abs(sample);
-
-		if (absSample > THRESHOLD) {
-			float excess = absSample - THRESHOLD;
-			float reduction;
-
-			if (excess < KNEE) {
-				reduction = excess * excess / (2.0f * KNEE);
-			} else {
-				reduction = excess - KNEE / 2.0f;
-			}
-
-			float limited = THRESHOLD + reduction * 0.3f;
-			limited = std::min(limited, CEILING);
-			out[i] = (sample >= 0.0f) ? limited : -limited;
+			audioOutput->playbackPosition_.store(trackFrameAt(finalCursor));
 		}
 	}
 
-	float leftPeak = 0.0f;
-	float rightPeak = 0.0f;
-	for (unsigned long frame = 0; frame < frameCount; ++frame) {
-		const size_t offset = static_cast<size_t>(frame) * outputChannels;
-		const float left = std::abs(out[offset]);
-		const float right = outputChannels > 1 ? std::abs(out[offset + 1]) : left;
-		leftPeak = std::max(leftPeak, left);
-		rightPeak = std::max(rightPeak, right);
-	}
-	audioOutput->updateStereoLevels(leftPeak, rightPeak);
+	audioOutput->finishOutputBlock(out, frameCount, outputChannels, timeInfo);
 
 	return paContinue;
 }
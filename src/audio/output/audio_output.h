@@ -3,12 +3,17 @@
 #include <portaudio.h>
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <vector>
 #include <mutex>
 #include <string>
 #include <memory>
+#include <thread>
 
+#include "audio/input/audio_stream_settings.h"
+#include "pcm_buffer.h"
 #include "playback_equaliser.h"
+#include "playback_stream.h"
 
 class AudioOutput {
 public:
@@ -21,10 +26,21 @@ public:
 	AudioOutput();
 	~AudioOutput();
 
-	static std::vector<DeviceInfo> getOutputDevices();
-	bool initOutputStream(float sampleRate, int channelCount = 1, int deviceIndex = -1, int framesPerBuffer = 512);
-	void setAudioData(const std::vector<float>& audioSamples, size_t channelCount = 1);
+	static constexpr unsigned long DEFAULT_FRAMES_PER_BUFFER = 512;
+	// The latency probe's test impulse: a short burst near a quarter of the device rate,
+	// mixed over whatever is playing.
+	static constexpr size_t IMPULSE_FRAMES = 48;
+	static constexpr float IMPULSE_AMPLITUDE = 0.5f;
 
+	static std::vector<DeviceInfo> getOutputDevices(
+		AudioStreamSettings::HostApi hostApi = AudioStreamSettings::HostApi::Default);
+	// A negative deviceIndex opens the host API's default output.
+	bool initOutputStream(float sampleRate, int channelCount = 1, int deviceIndex = -1,
+						  const AudioStreamSettings& settings = {});
+	// Shares audio rather than copying it; the samples stay alive until playback lets go of them.
+	void setAudioData(const PCMBuffer& audio, size_t channelCount = 1);
+
+	bool isStreamOpen() const { return stream_ != nullptr; }
 	void play();
 	void pause();
 	void stop();
@@ -36,11 +52,16 @@ public:
 	void seek(size_t framePosition);
 	size_t getPlaybackPosition() const { return playbackPosition_.load(); }
 	size_t getTotalSamples() const { return totalSamples_.load(); }
+	// The stream's track while one is set.
 	size_t getTotalFrames() const {
+		if (activeStream_.load() != nullptr) {
+			return streamTrackFrames_.load();
+		}
 		const size_t channelCount = channelCount_.load();
 		const size_t totalSamples = totalSamples_.load();
 		return channelCount > 0 ? totalSamples / channelCount : totalSamples;
 	}
+	size_t getChannelCount() const { return channelCount_.load(); }
 
 	void setLoopEnabled(bool enabled) { loopEnabled_.store(enabled); }
 	bool isLoopEnabled() const { return loopEnabled_.load(); }
@@ -48,15 +69,69 @@ public:
 	float getActualSampleRate() const { return actualSampleRate_.load(); }
 	float getPlaybackRateRatio() const;
 	float getPlaybackStep() const { return playbackStep_.load(); }
+	// Zero while no stream is open.
+	const AudioStreamLatency& getStreamLatency() const { return streamLatency_; }
 	void setPlaybackEQEnabled(bool enabled);
 	void setPlaybackEQGains(float low, float mid, float high);
 
 	void clearAudioData();
 
+	// While a stream is set the callback plays it in place of the track, through the same
+	// equaliser and limiter, and reports its track position. Null goes back to the track.
+	void setPlaybackStream(std::shared_ptr<PlaybackStream> stream);
+
+	// Plays one test impulse, starting the open stream if it is idle, and reports when it
+	// reaches the converter to the latency probe. False while no stream is open.
+	bool queueImpulse();
+
 private:
+	// What the callback plays: the track itself, read at playbackStep_ with linear
+	// interpolation, or its resample at the device rate, copied straight out.
+	struct PlaybackSource {
+		std::shared_ptr<const std::vector<float>> samples;
+		// Source frames per track frame: 1 for the track, device rate over track rate for
+		// the resample.
+		double framesPerTrackFrame = 1.0;
+		size_t trackFrames = 0;
+		bool deviceRate = false;
+		uint64_t generation = 0;
+	};
+
+	struct RetiredSource {
+		std::unique_ptr<const PlaybackSource> source;
+		uint64_t callbackEpoch;
+	};
+
+	struct RetiredStream {
+		std::shared_ptr<PlaybackStream> stream;
+		uint64_t callbackEpoch;
+	};
+
 	PaStream* stream_;
-	std::shared_ptr<std::vector<float>> audioBuffer_;
-	std::mutex bufferMutex_;
+	AudioStreamLatency streamLatency_;
+
+	// The callback never waits on the threads controlling playback. It reads the source
+	// through activeSource_, or a stream through activeStream_, and takes cursor changes
+	// from a single-slot mailbox, where a newer seek replaces one not yet applied. A replaced
+	// source or stream is released on a control thread once every callback that could have
+	// loaded it has returned; callbackEpoch_ is odd while a callback is running.
+	std::mutex controlMutex_;
+	std::shared_ptr<const std::vector<float>> trackSamples_;  // Protected by controlMutex_
+	std::unique_ptr<const PlaybackSource> ownedSource_;  // Protected by controlMutex_
+	std::vector<RetiredSource> retiredSources_;  // Protected by controlMutex_
+	uint64_t nextSourceGeneration_;  // Protected by controlMutex_
+	std::atomic<const PlaybackSource*> activeSource_;
+	std::shared_ptr<PlaybackStream> ownedStream_;  // Protected by controlMutex_
+	std::vector<RetiredStream> retiredStreams_;  // Protected by controlMutex_
+	std::atomic<PlaybackStream*> activeStream_;
+	std::atomic<size_t> streamTrackFrames_;
+	std::atomic<uint64_t> callbackEpoch_;
+	std::atomic<uint64_t> pendingCursorCommand_;
+
+	// Whenever the track or the device rate changes, the track is resampled to the device
+	// rate on resampleThread_ and swapped in when done; until then the callback resamples.
+	std::thread resampleThread_;
+	std::atomic<bool> cancelResample_;
 
 	std::atomic<size_t> playbackPosition_;
 	std::atomic<size_t> totalSamples_;
@@ -66,18 +141,34 @@ private:
 	std::atomic<float> actualSampleRate_;
 	std::atomic<float> playbackStep_;
 	std::atomic<size_t> channelCount_;
-	double playbackCursor_;
+	std::atomic<bool> impulsePending_;
 
-	std::atomic<bool> seekCrossfadeActive_;
-	std::atomic<size_t> pendingSeekPosition_;
-	std::atomic<size_t> seekFadeRemaining_;
+	// Owned by the audio callback. Cursors count frames of the source last played.
+	uint64_t playingGeneration_;
+	double playingFramesPerTrackFrame_;
+	double playbackCursor_;
 	double oldSeekCursor_;
+	size_t seekFadeRemaining_;
+	size_t impulseFrame_;
+
 	PlaybackEqualiser playbackEqualiser_;
 	std::atomic<float> leftLevel_;
 	std::atomic<float> rightLevel_;
 
+	void replaceSource(std::shared_ptr<const std::vector<float>> samples, double framesPerTrackFrame, bool deviceRate);
+	void reclaimRetiredSources();
+	void scheduleDeviceRateResample();
+	void cancelDeviceRateResample();
+	void resampleToDeviceRate(std::shared_ptr<const std::vector<float>> track, size_t channelCount, float step);
+	void postCursorCommand(size_t framePosition, bool crossfade);
+	void followSource(const PlaybackSource* source);
+	void applyCursorCommand(uint64_t command);
 	void updateStereoLevels(float left, float right);
 	void resetStereoLevels();
+	void mixPendingImpulse(float* out, unsigned long frameCount, size_t channels,
+						   const PaStreamCallbackTimeInfo* timeInfo);
+	void finishOutputBlock(float* out, unsigned long frameCount, size_t channels,
+						   const PaStreamCallbackTimeInfo* timeInfo);
 	static int audioCallback(const void* input, void* output,
 						 unsigned long frameCount,
 						 const PaStreamCallbackTimeInfo* timeInfo,
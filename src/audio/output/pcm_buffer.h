@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Immutable interleaved PCM with shared ownership. A decoded or rebuilt track is moved in once,
+// and the recorder state and AudioOutput then hold the same samples instead of a copy each.
+class PCMBuffer {
+public:
+	PCMBuffer() = default;
+	// Implicit, so a finished vector can be assigned straight in.
+	PCMBuffer(std::vector<float>&& samples)
+		: storage(samples.empty() ? nullptr : std::make_shared<const std::vector<float>>(std::move(samples))) {}
+
+	bool empty() const { return storage == nullptr || storage->empty(); }
+	size_t size() const { return storage != nullptr ? storage->size() : 0; }
+	std::span<const float> samples() const {
+		return storage != nullptr ? std::span<const float>(*storage) : std::span<const float>();
+	}
+	const std::shared_ptr<const std::vector<float>>& shared() const { return storage; }
+	void clear() { storage.reset(); }
+
+private:
+	std::shared_ptr<const std::vector<float>> storage;
+};
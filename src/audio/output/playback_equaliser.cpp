@@ -74,21 +74,22 @@ void PlaybackEqualiser::processInterleaved(float* buffer, const size_t frames, c
         return;
     }
 
-    const AudioEQ::BiquadCoefficients low{
+    AudioEQ::CascadeCoefficients cascade;
+    cascade.low = {
         lowB0_.load(std::memory_order_relaxed),
         lowB1_.load(std::memory_order_relaxed),
         lowB2_.load(std::memory_order_relaxed),
         lowA1_.load(std::memory_order_relaxed),
         lowA2_.load(std::memory_order_relaxed)
     };
-    const AudioEQ::BiquadCoefficients mid{
+    cascade.mid = {
         midB0_.load(std::memory_order_relaxed),
         midB1_.load(std::memory_order_relaxed),
         midB2_.load(std::memory_order_relaxed),
         midA1_.load(std::memory_order_relaxed),
         midA2_.load(std::memory_order_relaxed)
     };
-    const AudioEQ::BiquadCoefficients high{
+    cascade.high = {
         highB0_.load(std::memory_order_relaxed),
         highB1_.load(std::memory_order_relaxed),
         highB2_.load(std::memory_order_relaxed),
@@ -96,16 +97,9 @@ void PlaybackEqualiser::processInterleaved(float* buffer, const size_t frames, c
         highA2_.load(std::memory_order_relaxed)
     };
 
-    for (size_t frameIndex = 0; frameIndex < frames; ++frameIndex) {
-        for (size_t channelIndex = 0; channelIndex < channels; ++channelIndex) {
-            const size_t sampleIndex = frameIndex * channels + channelIndex;
-            auto& state = channelStates_[channelIndex];
-            float sample = buffer[sampleIndex];
-            sample = AudioEQ::processSample(low, sample, state.low.z1, state.low.z2);
-            sample = AudioEQ::processSample(mid, sample, state.mid.z1, state.mid.z2);
-            sample = AudioEQ::processSample(high, sample, state.high.z1, state.high.z2);
-            buffer[sampleIndex] = sample;
-        }
+    // Channels are independent, so each runs over the whole buffer in one pass.
+    for (size_t channelIndex = 0; channelIndex < channels; ++channelIndex) {
+        AudioEQ::processBlock(cascade, channelStates_[channelIndex], buffer + channelIndex, frames, channels);
     }
 }
 
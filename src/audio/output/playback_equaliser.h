@@ -4,13 +4,10 @@
 #include <cstddef>
 #include <vector>
 
+#include "audio/analysis/eq/shared_eq_model.h"
+
 class PlaybackEqualiser {
 public:
-    struct BiquadState {
-        float z1 = 0.0f;
-        float z2 = 0.0f;
-    };
-
     void configure(float sampleRate, size_t channels);
     void setEnabled(bool enabled);
     void setGains(float low, float mid, float high);
@@ -18,13 +15,7 @@ public:
     void processInterleaved(float* buffer, size_t frames, size_t channels);
 
 private:
-    struct ChannelState {
-        BiquadState low;
-        BiquadState mid;
-        BiquadState high;
-    };
-
-    std::vector<ChannelState> channelStates_;
+    std::vector<AudioEQ::CascadeState> channelStates_;
     std::atomic<bool> enabled_{false};
     std::atomic<bool> resetRequested_{false};
     std::atomic<float> sampleRate_{0.0f};
@@ -0,0 +1,152 @@
+#include "playback_stream.h"
+
+#include <algorithm>
+#include <cmath>
+
+PlaybackStream::PlaybackStream(const size_t channelCount, const size_t framesPerBlock, const size_t blockCount)
+	: channels(std::max<size_t>(1, channelCount)),
+	  blockFrames(std::max<size_t>(1, framesPerBlock)),
+	  blocks(std::max<size_t>(2, blockCount)),
+	  previousFrame(channels, 0.0f),
+	  currentFrame(channels, 0.0f) {
+	for (Block& block : blocks) {
+		block.samples.assign(blockFrames * channels, 0.0f);
+	}
+}
+
+float* PlaybackStream::beginBlock() {
+	const uint64_t write = writeIndex.load(std::memory_order_relaxed);
+	if (write - readIndex.load(std::memory_order_acquire) >= blocks.size()) {
+		return nullptr;
+	}
+	return blocks[write % blocks.size()].samples.data();
+}
+
+void PlaybackStream::commitBlock(const size_t frames, const double trackFrame, const double trackFramesPerFrame,
+								 const bool final) {
+	const uint64_t write = writeIndex.load(std::memory_order_relaxed);
+	Block& block = blocks[write % blocks.size()];
+	block.frames = std::min(frames, blockFrames);
+	block.trackFrame = trackFrame;
+	block.trackFramesPerFrame = trackFramesPerFrame;
+	block.generation = generation.load(std::memory_order_relaxed);
+	block.final = final;
+	writeIndex.store(write + 1, std::memory_order_release);
+}
+
+void PlaybackStream::beginGeneration(const double trackFrame) {
+	trackPosition.store(trackFrame, std::memory_order_relaxed);
+	generation.fetch_add(1, std::memory_order_release);
+}
+
+void PlaybackStream::read(float* out, const size_t frameCount, const size_t outputChannels, double step) {
+	if (!std::isfinite(step) || step <= 0.0) {
+		step = 1.0;
+	}
+	const size_t copiedChannels = std::min(channels, outputChannels);
+	const uint64_t target = generation.load(std::memory_order_acquire);
+	if (target != playingGeneration && fadeOutRemaining == 0) {
+		if (started) {
+			fadeOutRemaining = GENERATION_FADE_FRAMES;
+		} else {
+			switchGeneration(target);
+		}
+	}
+
+	constexpr float fadeScale = 1.0f / static_cast<float>(GENERATION_FADE_FRAMES);
+	bool starved = false;
+	for (size_t i = 0; i < frameCount; ++i) {
+		float* frame = out + i * outputChannels;
+		bool available = true;
+		while (phase >= 1.0) {
+			if (!advanceFrame()) {
+				available = false;
+				break;
+			}
+			phase -= 1.0;
+		}
+		if (!available) {
+			std::fill_n(frame, outputChannels, 0.0f);
+			if (fadeOutRemaining > 0) {
+				// Nothing left of the old generation to fade over.
+				fadeOutRemaining = 0;
+				switchGeneration(target);
+			} else if (started && !ended.load(std::memory_order_relaxed)) {
+				starved = true;
+			}
+			continue;
+		}
+
+		float gain = 1.0f;
+		if (fadeOutRemaining > 0) {
+			gain = static_cast<float>(fadeOutRemaining) * fadeScale;
+		} else if (fadeInRemaining > 0) {
+			gain = 1.0f - static_cast<float>(fadeInRemaining) * fadeScale;
+			--fadeInRemaining;
+		}
+		const float fraction = static_cast<float>(phase);
+		for (size_t ch = 0; ch < copiedChannels; ++ch) {
+			frame[ch] = gain * (previousFrame[ch] + fraction * (currentFrame[ch] - previousFrame[ch]));
+		}
+		std::fill(frame + copiedChannels, frame + outputChannels, 0.0f);
+		phase += step;
+
+		if (fadeOutRemaining > 0 && --fadeOutRemaining == 0) {
+			switchGeneration(target);
+		}
+	}
+
+	if (starved) {
+		underruns.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+bool PlaybackStream::advanceFrame() {
+	uint64_t read = readIndex.load(std::memory_order_relaxed);
+	while (read != writeIndex.load(std::memory_order_acquire)) {
+		const Block& block = blocks[read % blocks.size()];
+		// A newer generation waits for the fade-out over this one.
+		if (block.generation != playingGeneration) {
+			return false;
+		}
+		if (readOffset < block.frames) {
+			previousFrame.swap(currentFrame);
+			std::copy_n(block.samples.begin() + static_cast<std::ptrdiff_t>(readOffset * channels), channels,
+						currentFrame.begin());
+			// Once a jump is under way the position already reads where it lands.
+			if (generation.load(std::memory_order_relaxed) == playingGeneration) {
+				trackPosition.store(block.trackFrame + static_cast<double>(readOffset) * block.trackFramesPerFrame,
+									std::memory_order_relaxed);
+			}
+			++readOffset;
+			started = true;
+			return true;
+		}
+
+		const bool final = block.final;
+		readOffset = 0;
+		readIndex.store(++read, std::memory_order_release);
+		if (final) {
+			ended.store(true, std::memory_order_release);
+			return false;
+		}
+	}
+	return false;
+}
+
+void PlaybackStream::switchGeneration(const uint64_t target) {
+	uint64_t read = readIndex.load(std::memory_order_relaxed);
+	const uint64_t write = writeIndex.load(std::memory_order_acquire);
+	while (read != write && blocks[read % blocks.size()].generation != target) {
+		++read;
+	}
+	readIndex.store(read, std::memory_order_release);
+	readOffset = 0;
+	playingGeneration = target;
+	std::fill(previousFrame.begin(), previousFrame.end(), 0.0f);
+	std::fill(currentFrame.begin(), currentFrame.end(), 0.0f);
+	phase = 1.0;
+	fadeInRemaining = GENERATION_FADE_FRAMES;
+	started = false;
+	ended.store(false, std::memory_order_release);
+}
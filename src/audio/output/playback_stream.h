@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Blocks of track audio synthesised on a render thread and played by the audio callback.
+// Each block records the track frame it starts at and how many track frames each of its
+// frames covers, so the callback can report where in the track it is whatever rate the
+// blocks were rendered at. When the render thread jumps elsewhere it starts a new
+// generation: the callback fades out over what it is playing, drops the blocks still queued
+// from before the jump and fades the new ones in. One render thread and one callback; neither
+// ever waits on the other.
+class PlaybackStream {
+public:
+	static constexpr size_t GENERATION_FADE_FRAMES = 64;
+
+	PlaybackStream(size_t channelCount, size_t blockFrames, size_t blockCount);
+
+	PlaybackStream(const PlaybackStream&) = delete;
+	PlaybackStream& operator=(const PlaybackStream&) = delete;
+
+	size_t getChannelCount() const { return channels; }
+	size_t getBlockFrames() const { return blockFrames; }
+
+	// Render thread only. The next block to fill with up to getBlockFrames() interleaved
+	// frames, or null while every block is queued.
+	float* beginBlock();
+	// Queues the block beginBlock() returned. A track that does not loop marks its last
+	// block final, and the stream ends once the callback has played it.
+	void commitBlock(size_t frames, double trackFrame, double trackFramesPerFrame, bool final);
+	// Blocks committed from here on replace every one queued before. The position reads
+	// trackFrame until they play.
+	void beginGeneration(double trackFrame);
+	// How long the track is, in its own frames; it may grow while the stream plays.
+	void setTrackFrames(size_t frames) { trackFrames.store(frames, std::memory_order_relaxed); }
+	size_t getTrackFrames() const { return trackFrames.load(std::memory_order_relaxed); }
+
+	// Audio callback only. Fills frameCount frames of outputChannels, stepping through the
+	// stream's frames step at a time with linear interpolation. Channels the stream does not
+	// have, and frames past what is queued, are silent.
+	void read(float* out, size_t frameCount, size_t outputChannels, double step);
+
+	// The track frame last played.
+	double getTrackPosition() const { return trackPosition.load(std::memory_order_relaxed); }
+	bool hasEnded() const { return ended.load(std::memory_order_acquire); }
+	// Callbacks that ran out of queued frames before the stream ended.
+	uint64_t getUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+
+private:
+	struct Block {
+		std::vector<float> samples;
+		size_t frames = 0;
+		double trackFrame = 0.0;
+		double trackFramesPerFrame = 1.0;
+		uint64_t generation = 0;
+		bool final = false;
+	};
+
+	bool advanceFrame();
+	void switchGeneration(uint64_t target);
+
+	size_t channels;
+	size_t blockFrames;
+	std::vector<Block> blocks;
+	std::atomic<uint64_t> writeIndex{0};
+	std::atomic<uint64_t> readIndex{0};
+	std::atomic<uint64_t> generation{0};
+	std::atomic<double> trackPosition{0.0};
+	std::atomic<size_t> trackFrames{0};
+	std::atomic<bool> ended{false};
+	std::atomic<uint64_t> underruns{0};
+
+	// Owned by the audio callback. The output falls between previousFrame and currentFrame,
+	// phase of the way along; readOffset is the next frame of the block at readIndex.
+	std::vector<float> previousFrame;
+	std::vector<float> currentFrame;
+	double phase = 1.0;
+	size_t readOffset = 0;
+	uint64_t playingGeneration = 0;
+	size_t fadeOutRemaining = 0;
+	size_t fadeInRemaining = 0;
+	bool started = false;
+};
@@ -1,11 +1,21 @@
 #include "audio_processor.h"
 
 #include <algorithm>
-
-AudioProcessor::AudioProcessor()
-	: writeIndex(0), readIndex(0), running(false), currentSpectralData{} {
-	fftProcessors.push_back(std::make_unique<FFTProcessor>());
+#include <bit>
+#include <thread>
+
+#include "utilities/profiling/frame_profiler.h"
+#include "utilities/telemetry/latency_probe.h"
+#include "utilities/telemetry/telemetry.h"
+#include "utilities/threading/realtime_thread.h"
+
+AudioProcessor::AudioProcessor(const int requestedFFTSize)
+	: writeIndex(0), readIndex(0), running(false), fftSize(requestedFFTSize) {
+	publishedSnapshot.store(&snapshotSlots[0], std::memory_order_seq_cst);
+	fftProcessors.push_back(std::make_unique<FFTProcessor>(fftSize));
 	activeChannelCount = 1;
+	frameSources[0].store(fftProcessors[0].get(), std::memory_order_relaxed);
+	frameSourceCount.store(1, std::memory_order_release);
 }
 
 AudioProcessor::~AudioProcessor() { stop(); }
@@ -15,6 +25,8 @@ void AudioProcessor::start() {
 		return;
 	writeIndex = 0;
 	readIndex = 0;
+	ringWritePosition = 0;
+	ringReadPosition.store(0, std::memory_order_relaxed);
 
 	workerThread = std::thread(&AudioProcessor::processingThreadFunc, this);
 }
@@ -22,10 +34,8 @@ void AudioProcessor::start() {
 void AudioProcessor::stop() {
 	if (!running.exchange(false))
 		return;
-	{
-		std::lock_guard lock(queueMutex);
-		dataAvailable.notify_one();
-	}
+	wakeSequence.fetch_add(1, std::memory_order_release);
+	wakeSequence.notify_one();
 
 	if (workerThread.joinable()) {
 		workerThread.join();
@@ -33,142 +43,409 @@ void AudioProcessor::stop() {
 }
 
 void AudioProcessor::queueAudioData(const float* buffer, const size_t numSamples,
-									const float sampleRate, const size_t numChannels) {
+									const float sampleRate, const size_t numChannels,
+									const std::chrono::steady_clock::time_point capturedAt) {
 	if (!buffer || numSamples == 0 || !running || numChannels == 0)
 		return;
 
 	const size_t currentWrite = writeIndex.load(std::memory_order_relaxed);
-	const size_t nextWrite = (currentWrite + 1) % QUEUE_SIZE;
+	const size_t nextWrite = (currentWrite + 1) % CHUNK_QUEUE_SIZE;
+	const size_t sampleCount = numSamples - numSamples % numChannels;
+	if (sampleCount == 0)
+		return;
 
-	if (nextWrite == readIndex.load(std::memory_order_acquire)) {
+	uint64_t start = ringWritePosition;
+	const size_t offset = static_cast<size_t>(start % SAMPLE_RING_CAPACITY);
+	if (offset + sampleCount > SAMPLE_RING_CAPACITY) {
+		start += SAMPLE_RING_CAPACITY - offset;
+	}
+
+	// Whole buffers are dropped rather than truncated when the worker has fallen behind.
+	if (nextWrite == readIndex.load(std::memory_order_acquire) ||
+		start + sampleCount - ringReadPosition.load(std::memory_order_acquire) > SAMPLE_RING_CAPACITY) {
 		droppedBufferCount.fetch_add(1, std::memory_order_relaxed);
+		Utilities::Telemetry::increment(Utilities::Telemetry::Counter::AnalysisBuffersDropped);
 		return;
 	}
 
-	AudioBuffer& queuedBuffer = audioQueue[currentWrite];
-	queuedBuffer.sampleRate = sampleRate;
-	queuedBuffer.numChannels = numChannels;
-	queuedBuffer.sampleCount = std::min(numSamples, MAX_SAMPLES);
-	std::copy_n(buffer, queuedBuffer.sampleCount, queuedBuffer.data.begin());
+	std::copy_n(buffer, sampleCount, sampleRing.begin() + static_cast<std::ptrdiff_t>(start % SAMPLE_RING_CAPACITY));
+	ringWritePosition = start + sampleCount;
+
+	InputChunk& chunk = chunkQueue[currentWrite];
+	chunk.start = start;
+	chunk.sampleCount = sampleCount;
+	chunk.sampleRate = sampleRate;
+	chunk.numChannels = numChannels;
+	chunk.queuedAt = std::chrono::steady_clock::now();
+	chunk.capturedAt = capturedAt;
 
 	writeIndex.store(nextWrite, std::memory_order_release);
-	{
-		std::lock_guard lock(queueMutex);
-		dataAvailable.notify_one();
-	}
+	const size_t readAt = readIndex.load(std::memory_order_acquire);
+	Utilities::Telemetry::set(Utilities::Telemetry::Gauge::AnalysisQueueDepth,
+							  static_cast<double>((nextWrite + CHUNK_QUEUE_SIZE - readAt) % CHUNK_QUEUE_SIZE));
+	Utilities::Telemetry::set(Utilities::Telemetry::Gauge::AnalysisRingFill,
+							  static_cast<double>(ringWritePosition - ringReadPosition.load(std::memory_order_acquire)) /
+								  static_cast<double>(SAMPLE_RING_CAPACITY));
+	wakeSequence.fetch_add(1, std::memory_order_release);
+	wakeSequence.notify_one();
 }
 
 void AudioProcessor::processingThreadFunc() {
-	while (running.load(std::memory_order_acquire)) {
-		std::unique_lock lock(queueMutex);
-		dataAvailable.wait(lock, [this] {
-			return !running.load(std::memory_order_acquire) ||
-				   readIndex.load(std::memory_order_relaxed) !=
-					   writeIndex.load(std::memory_order_acquire);
-		});
-
-		if (!running.load(std::memory_order_acquire))
-			break;
-
-		lock.unlock();
-
+	Utilities::Threading::configureCurrentThread(Utilities::Threading::ThreadRole::Analysis);
+	while (waitForChunk()) {
 		while (running.load(std::memory_order_acquire)) {
 			const size_t currentRead = readIndex.load(std::memory_order_relaxed);
 			if (currentRead == writeIndex.load(std::memory_order_acquire)) {
 				break;
 			}
 
-			processBuffer(audioQueue[currentRead]);
-			readIndex.store((currentRead + 1) % QUEUE_SIZE, std::memory_order_release);
+			const InputChunk& chunk = chunkQueue[currentRead];
+			processChunk(chunk);
+			recordLatency(chunk.queuedAt);
+			ringReadPosition.store(chunk.start + chunk.sampleCount, std::memory_order_release);
+			readIndex.store((currentRead + 1) % CHUNK_QUEUE_SIZE, std::memory_order_release);
+		}
+	}
+	stopLanes();
+}
+
+// Buffers usually arrive at the callback period, so a short spin catches the next one without
+// the cost of parking and being woken; a quiet input parks on wakeSequence instead.
+bool AudioProcessor::waitForChunk() {
+	const auto hasChunk = [this] {
+		return readIndex.load(std::memory_order_relaxed) != writeIndex.load(std::memory_order_acquire);
+	};
+
+	const auto spinUntil = std::chrono::steady_clock::now() + WAKE_SPIN_DURATION;
+	while (running.load(std::memory_order_acquire)) {
+		if (hasChunk()) {
+			return true;
 		}
+		if (std::chrono::steady_clock::now() >= spinUntil) {
+			break;
+		}
+		std::this_thread::yield();
+	}
+
+	while (running.load(std::memory_order_acquire)) {
+		// Read before re-checking, so a buffer queued in between changes it and the wait returns.
+		const uint32_t seen = wakeSequence.load(std::memory_order_acquire);
+		if (hasChunk()) {
+			return true;
+		}
+		wakeSequence.wait(seen, std::memory_order_acquire);
+	}
+	return false;
+}
+
+void AudioProcessor::recordLatency(const std::chrono::steady_clock::time_point queuedAt) {
+	const auto sinceQueued = std::chrono::steady_clock::now() - queuedAt;
+	Utilities::Telemetry::record(Utilities::Telemetry::Stage::AnalysisQueue, sinceQueued);
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(sinceQueued).count();
+	const uint64_t micros = static_cast<uint64_t>(std::max<int64_t>(elapsed, 1));
+	const size_t bucket = std::min<size_t>(static_cast<size_t>(std::bit_width(micros)) - 1, LATENCY_BUCKET_COUNT - 1);
+	latencyHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+AudioProcessor::LatencyHistogram AudioProcessor::getLatencyHistogram() const {
+	LatencyHistogram histogram{};
+	for (size_t bucket = 0; bucket < LATENCY_BUCKET_COUNT; ++bucket) {
+		histogram[bucket] = latencyHistogram[bucket].load(std::memory_order_relaxed);
 	}
+	return histogram;
 }
 
-void AudioProcessor::processBuffer(const AudioBuffer& buffer) {
-	if (buffer.numChannels == 0) {
+void AudioProcessor::processChunk(const InputChunk& chunk) {
+	if (chunk.numChannels == 0) {
 		return;
 	}
+	SYN_PROFILE_SCOPE(AudioChunk);
 
 	std::lock_guard processorLock(processorMutex);
-	ensureProcessorCountLocked(buffer.numChannels);
-	activeChannelCount = buffer.numChannels;
+	ensureProcessorCountLocked(chunk.numChannels);
+	activeChannelCount = chunk.numChannels;
+	frameSourceCount.store(std::min(activeChannelCount, MAX_FRAME_SOURCES), std::memory_order_release);
+
+	stagingSpectralData.magnitudes.resize(chunk.numChannels);
+	stagingSpectralData.phases.resize(chunk.numChannels);
+	channelResults.resize(chunk.numChannels);
+	configureLanes(chunk.numChannels);
+	configureDecimation(chunk);
+
+	const size_t frames = chunk.sampleCount / chunk.numChannels;
+	const float analysisRate = chunk.sampleRate / static_cast<float>(decimationFactor);
+	const auto captureMicros = [&chunk](const size_t sample) {
+		const double seconds = chunk.sampleRate > 0.0f ? static_cast<double>(sample) / chunk.sampleRate : 0.0;
+		const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>(seconds));
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			chunk.capturedAt.time_since_epoch() + offset).count();
+	};
+	if (transientDetector.process(sampleRing.data() + chunk.start % SAMPLE_RING_CAPACITY, frames, chunk.numChannels,
+								  chunk.sampleRate) > 0) {
+		Utilities::Telemetry::LatencyProbe::onsetCaptured(captureMicros(transientDetector.getLastOnsetEnd()));
+	}
 
-	const size_t frames = buffer.sampleCount / buffer.numChannels;
-	channelBufferScratch.resize(frames);
-	stagingSpectralData.magnitudes.resize(buffer.numChannels);
-	stagingSpectralData.phases.resize(buffer.numChannels);
+	laneChunk = &chunk;
+	if (laneCount > 1) {
+		laneBarrier->arrive_and_wait();
+		analyseLaneChannels(0);
+		laneBarrier->arrive_and_wait();
+	} else {
+		analyseLaneChannels(0);
+	}
+	laneChunk = nullptr;
+
+	// Reduced in channel order, so the result does not depend on how channels were laned.
 	float maxDominantFreq = 0.0f;
 	float maxMagnitudeVal = 0.0f;
-	FFTProcessor::AnalysisState primaryAnalysis{};
-
-	for (size_t ch = 0; ch < buffer.numChannels; ++ch) {
-		for (size_t i = 0; i < frames; ++i) {
-			channelBufferScratch[i] = buffer.data[i * buffer.numChannels + ch];
-		}
-
-		FFTProcessor::AnalysisState analysis{};
-		fftProcessors[ch]->processBuffer(std::span(channelBufferScratch.data(), frames), buffer.sampleRate);
-		fftProcessors[ch]->copyRawFrame(
-			stagingSpectralData.magnitudes[ch],
-			stagingSpectralData.phases[ch],
-			analysis);
-
-		if (!stagingSpectralData.magnitudes[ch].empty()) {
-			const auto maxIt = std::max_element(
-				stagingSpectralData.magnitudes[ch].begin(),
-				stagingSpectralData.magnitudes[ch].end());
-			const float currentMaxMag = *maxIt;
-
-			if (currentMaxMag > maxMagnitudeVal) {
-				maxMagnitudeVal = currentMaxMag;
-				const size_t maxIndex = static_cast<size_t>(
-					std::distance(stagingSpectralData.magnitudes[ch].begin(), maxIt));
-				maxDominantFreq = static_cast<float>(maxIndex) * buffer.sampleRate /
-								  static_cast<float>(FFTProcessor::FFT_SIZE);
-			}
-		}
-
-		if (ch == 0) {
-			primaryAnalysis = analysis;
+	for (const ChannelResult& result : channelResults) {
+		if (result.peakMagnitude > maxMagnitudeVal) {
+			maxMagnitudeVal = result.peakMagnitude;
+			maxDominantFreq = static_cast<float>(result.peakBin) * analysisRate /
+							  static_cast<float>(fftSize);
 		}
 	}
+	const FFTProcessor::AnalysisState& primaryAnalysis = channelResults.front().analysis;
+
+	// A hop that completed in this buffer ended getSamplesSinceFrame() samples before its end,
+	// and decimated samples lag their source by the filter's delay as well.
+	if (primaryAnalysis.frameCounter != stampedFrameCounter) {
+		const size_t decimatedSinceFrame = fftProcessors[0]->getSamplesSinceFrame() +
+										   (decimationFactor > 1 ? decimators.front().getLatency() : 0);
+		const size_t sinceFrame =
+			std::min(decimatedSinceFrame * static_cast<size_t>(decimationFactor), frames);
+		frameCaptureMicros = captureMicros(frames - sinceFrame);
+		stampedFrameCounter = primaryAnalysis.frameCounter;
+	}
 
-	stagingSpectralData.sampleRate = buffer.sampleRate;
+	stagingSpectralData.sampleRate = analysisRate;
 	stagingSpectralData.dominantFrequency = maxDominantFreq;
 	stagingSpectralData.momentaryLoudnessLUFS = primaryAnalysis.momentaryLoudnessLUFS;
 	stagingSpectralData.spectralFlux = primaryAnalysis.spectralFlux;
 	stagingSpectralData.frameCounter = primaryAnalysis.frameCounter;
 	stagingSpectralData.hopSize = primaryAnalysis.hopSize;
 	stagingSpectralData.onsetDetected = primaryAnalysis.onsetDetected;
+	stagingSpectralData.transientOnsetCount = transientDetector.getOnsetCount();
+	stagingSpectralData.captureTimestampMicros = frameCaptureMicros;
+	stagingSpectralData.bufferTimestampMicros = captureMicros(frames);
+
+	publishSpectralData();
+	wakeFrameWaiters();
+	Utilities::Telemetry::LatencyProbe::frameReached(Utilities::Telemetry::LatencyProbe::Stage::Analysis,
+													 frameCaptureMicros);
+}
 
-	{
-		std::lock_guard lock(resultsMutex);
-		std::swap(currentSpectralData, stagingSpectralData);
+void AudioProcessor::configureDecimation(const InputChunk& chunk) {
+	const int factor = decimationEnabled.load(std::memory_order_relaxed) ? Decimator::factorFor(chunk.sampleRate) : 1;
+	if (factor != decimationFactor || chunk.sampleRate != decimationInputRate || decimators.size() != chunk.numChannels) {
+		decimators.assign(chunk.numChannels, Decimator(factor, chunk.sampleRate));
+		decimationFactor = factor;
+		decimationInputRate = chunk.sampleRate;
+	}
+
+	const size_t frames = chunk.sampleCount / chunk.numChannels;
+	decimatedFrames = decimators.front().outputsFor(frames);
+	if (decimationFactor > 1 && decimatedInput.size() < decimatedFrames * chunk.numChannels) {
+		decimatedInput.resize(decimatedFrames * chunk.numChannels);
 	}
 }
 
-AudioProcessor::SpectralData AudioProcessor::getSpectralData() const {
-	SpectralData out;
-	copySpectralData(out);
-	return out;
+void AudioProcessor::decimateChannel(const size_t channel) {
+	if (decimationFactor == 1) {
+		return;
+	}
+	const InputChunk& chunk = *laneChunk;
+	decimators[channel].process(sampleRing.data() + chunk.start % SAMPLE_RING_CAPACITY + channel,
+								chunk.sampleCount / chunk.numChannels, chunk.numChannels,
+								decimatedInput.data() + channel, chunk.numChannels);
 }
 
-void AudioProcessor::copySpectralData(SpectralData& out) const {
-	std::lock_guard lock(resultsMutex);
-	out = currentSpectralData;
+void AudioProcessor::analyseLaneChannels(const size_t lane) {
+	const InputChunk& chunk = *laneChunk;
+	const bool decimating = decimationFactor > 1;
+	const size_t frames = decimating ? decimatedFrames : chunk.sampleCount / chunk.numChannels;
+	const float sampleRate = chunk.sampleRate / static_cast<float>(decimationFactor);
+	const float* interleaved =
+		decimating ? decimatedInput.data() : sampleRing.data() + chunk.start % SAMPLE_RING_CAPACITY;
+
+	if (chunk.numChannels % 2 == 0) {
+		for (size_t pair = lane; pair < chunk.numChannels / 2; pair += laneCount) {
+			const size_t left = pair * 2;
+			const size_t right = left + 1;
+			decimateChannel(left);
+			decimateChannel(right);
+			stereoProcessors[pair]->processBuffer(
+				*fftProcessors[left], *fftProcessors[right],
+				FFTProcessor::ChannelView{interleaved + left, frames, chunk.numChannels},
+				FFTProcessor::ChannelView{interleaved + right, frames, chunk.numChannels},
+				sampleRate);
+			collectChannelResult(left);
+			collectChannelResult(right);
+		}
+		return;
+	}
+
+	for (size_t ch = lane; ch < chunk.numChannels; ch += laneCount) {
+		decimateChannel(ch);
+		fftProcessors[ch]->processBuffer(
+			FFTProcessor::ChannelView{interleaved + ch, frames, chunk.numChannels}, sampleRate);
+		collectChannelResult(ch);
+	}
 }
 
-AudioProcessor::BufferedFrames AudioProcessor::consumeBufferedFrames() {
-	std::lock_guard processorLock(processorMutex);
-	BufferedFrames frames(activeChannelCount);
-	for (size_t ch = 0; ch < activeChannelCount; ++ch) {
-		frames[ch] = fftProcessors[ch]->getBufferedFrames();
+void AudioProcessor::collectChannelResult(const size_t channel) {
+	ChannelResult& result = channelResults[channel];
+	result = {};
+	fftProcessors[channel]->copyRawFrame(
+		stagingSpectralData.magnitudes[channel],
+		stagingSpectralData.phases[channel],
+		result.analysis);
+
+	const std::vector<float>& magnitudes = stagingSpectralData.magnitudes[channel];
+	if (!magnitudes.empty()) {
+		const auto maxIt = std::max_element(magnitudes.begin(), magnitudes.end());
+		result.peakMagnitude = *maxIt;
+		result.peakBin = static_cast<size_t>(std::distance(magnitudes.begin(), maxIt));
+	}
+}
+
+void AudioProcessor::laneThreadFunc(const size_t lane) {
+	Utilities::Threading::configureHelperThread(Utilities::Threading::ThreadRole::Analysis);
+	for (;;) {
+		laneBarrier->arrive_and_wait();
+		if (lanesStopping) {
+			return;
+		}
+		analyseLaneChannels(lane);
+		laneBarrier->arrive_and_wait();
+	}
+}
+
+void AudioProcessor::configureLanes(const size_t numChannels) {
+	size_t lanes = requestedLaneCount.load(std::memory_order_relaxed);
+	if (lanes == 0) {
+		const size_t hardwareLanes = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), 8));
+		lanes = numChannels > 2 ? hardwareLanes : 1;
+	}
+	const size_t laneUnits = numChannels % 2 == 0 ? numChannels / 2 : numChannels;
+	lanes = std::clamp<size_t>(lanes, 1, laneUnits);
+	if (lanes == laneCount) {
+		return;
+	}
+
+	stopLanes();
+	laneCount = lanes;
+	if (laneCount == 1) {
+		return;
+	}
+	laneBarrier = std::make_unique<std::barrier<>>(static_cast<std::ptrdiff_t>(laneCount));
+	laneThreads.reserve(laneCount - 1);
+	for (size_t lane = 1; lane < laneCount; ++lane) {
+		laneThreads.emplace_back(&AudioProcessor::laneThreadFunc, this, lane);
+	}
+}
+
+void AudioProcessor::stopLanes() {
+	if (laneThreads.empty()) {
+		laneCount = 1;
+		return;
+	}
+	lanesStopping = true;
+	laneBarrier->arrive_and_wait();
+	for (auto& lane : laneThreads) {
+		lane.join();
+	}
+	laneThreads.clear();
+	laneBarrier.reset();
+	lanesStopping = false;
+	laneCount = 1;
+}
+
+// The writer publishes before it checks a slot's readers, and a reader pins before it
+// re-reads the published slot, both sequentially consistent. So either the writer sees the
+// pin and leaves the slot alone, or the reader sees the newer slot and lets go.
+void AudioProcessor::publishSpectralData() {
+	SnapshotSlot* const published = publishedSnapshot.load(std::memory_order_relaxed);
+	for (SnapshotSlot& slot : snapshotSlots) {
+		if (&slot == published || slot.readers.load(std::memory_order_seq_cst) != 0) {
+			continue;
+		}
+		std::swap(slot.data, stagingSpectralData);
+		publishedSnapshot.store(&slot, std::memory_order_seq_cst);
+		return;
+	}
+}
+
+AudioProcessor::SpectralSnapshot AudioProcessor::acquireSpectralData() const {
+	for (;;) {
+		SnapshotSlot* const slot = publishedSnapshot.load(std::memory_order_seq_cst);
+		slot->readers.fetch_add(1, std::memory_order_seq_cst);
+		if (publishedSnapshot.load(std::memory_order_seq_cst) == slot) {
+			return SpectralSnapshot(slot);
+		}
+		slot->readers.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+AudioProcessor::SpectralSnapshot& AudioProcessor::SpectralSnapshot::operator=(SpectralSnapshot&& other) noexcept {
+	if (this != &other) {
+		release();
+		slot = std::exchange(other.slot, nullptr);
+	}
+	return *this;
+}
+
+const AudioProcessor::SpectralData& AudioProcessor::SpectralSnapshot::operator*() const {
+	return slot->data;
+}
+
+void AudioProcessor::SpectralSnapshot::release() {
+	if (slot != nullptr) {
+		slot->readers.fetch_sub(1, std::memory_order_release);
+		slot = nullptr;
+	}
+}
+
+void AudioProcessor::borrowBufferedFrames(BorrowedFrames& frames) {
+	const size_t channelCount = frameSourceCount.load(std::memory_order_acquire);
+	frames.resize(channelCount);
+	for (size_t ch = 0; ch < channelCount; ++ch) {
+		const FFTProcessor* processor = frameSources[ch].load(std::memory_order_acquire);
+		if (processor == nullptr) {
+			frames[ch].clear();
+			continue;
+		}
+		processor->borrowBufferedFrames(frames[ch]);
+	}
+}
+
+void AudioProcessor::releaseBufferedFrames(const BorrowedFrames& frames) {
+	for (size_t ch = 0; ch < frames.size() && ch < MAX_FRAME_SOURCES; ++ch) {
+		FFTProcessor* processor = frameSources[ch].load(std::memory_order_acquire);
+		if (processor != nullptr) {
+			processor->releaseBufferedFrames(frames[ch].size());
+		}
 	}
-	return frames;
 }
 
 void AudioProcessor::discardBufferedFrames() {
-	(void)consumeBufferedFrames();
+	const size_t channelCount = frameSourceCount.load(std::memory_order_acquire);
+	for (size_t ch = 0; ch < channelCount; ++ch) {
+		FFTProcessor* processor = frameSources[ch].load(std::memory_order_acquire);
+		if (processor != nullptr) {
+			processor->discardBufferedFrames();
+		}
+	}
+}
+
+uint64_t AudioProcessor::waitForBufferedFrames(const uint64_t seenGeneration) const {
+	frameGeneration.wait(seenGeneration, std::memory_order_acquire);
+	return frameGeneration.load(std::memory_order_acquire);
+}
+
+void AudioProcessor::wakeFrameWaiters() {
+	frameGeneration.fetch_add(1, std::memory_order_release);
+	frameGeneration.notify_all();
 }
 
 void AudioProcessor::setEQGains(const float low, const float mid, const float high) {
@@ -186,13 +463,19 @@ void AudioProcessor::reset() {
 	for (auto& processor : fftProcessors) {
 		processor->reset();
 	}
-
-	{
-		std::lock_guard lock(resultsMutex);
-		currentSpectralData = {};
-		stagingSpectralData = {};
+	transientDetector.reset();
+	for (Decimator& decimator : decimators) {
+		decimator.reset();
 	}
+	stampedFrameCounter = 0;
+	frameCaptureMicros = 0;
+
+	stagingSpectralData = {};
+	publishSpectralData();
 	droppedBufferCount.store(0, std::memory_order_relaxed);
+	for (auto& bucket : latencyHistogram) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
 }
 
 FFTProcessor& AudioProcessor::getFFTProcessor(size_t channel) {
@@ -214,15 +497,21 @@ size_t AudioProcessor::getChannelCount() const {
 
 void AudioProcessor::ensureProcessorCountLocked(const size_t numChannels) {
 	while (fftProcessors.size() < numChannels) {
-		auto processor = std::make_unique<FFTProcessor>();
+		auto processor = std::make_unique<FFTProcessor>(fftSize);
 		processor->setEQGains(eqLowGain, eqMidGain, eqHighGain);
+		if (fftProcessors.size() < MAX_FRAME_SOURCES) {
+			frameSources[fftProcessors.size()].store(processor.get(), std::memory_order_release);
+		}
 		fftProcessors.push_back(std::move(processor));
 	}
+	while (stereoProcessors.size() < numChannels / 2) {
+		stereoProcessors.push_back(std::make_unique<StereoFFTProcessor>(fftSize));
+	}
 }
 
 FFTProcessor* AudioProcessor::getProcessorForChannel(const size_t channel) {
 	if (fftProcessors.empty()) {
-		fftProcessors.push_back(std::make_unique<FFTProcessor>());
+		fftProcessors.push_back(std::make_unique<FFTProcessor>(fftSize));
 		activeChannelCount = std::max<size_t>(activeChannelCount, 1);
 	}
 	const size_t safeChannel =
@@ -2,15 +2,22 @@
 
 #include <array>
 #include <atomic>
-#include <condition_variable>
+#include <barrier>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 
+#include "audio/analysis/onset/transient_detector.h"
+#include "decimator.h"
 #include "fft_processor.h"
+#include "stereo_fft_processor.h"
 
 class AudioProcessor {
+	struct SnapshotSlot;
+
 public:
 	struct SpectralData {
 		std::vector<std::vector<float>> magnitudes;
@@ -22,63 +29,190 @@ public:
 		uint64_t frameCounter = 0;
 		int hopSize = FFTProcessor::HOP_SIZE;
 		bool onsetDetected = false;
+		// Onsets the time-domain detector has found since the last reset. Unlike
+		// onsetDetected it advances with every buffer, not only when a hop completes, so a
+		// reader that sees it move can react before the next frame.
+		uint64_t transientOnsetCount = 0;
+		// Steady clock microseconds at which the newest sample of this frame's window reached
+		// the converter, from the input's ADC time. bufferTimestampMicros is the same for the
+		// newest sample analysed at all, which is where a transient onset would lie.
+		int64_t captureTimestampMicros = 0;
+		int64_t bufferTimestampMicros = 0;
+	};
+
+	// Pins one published SpectralData, which stays immutable until the last handle on it is
+	// dropped. Readers compare frameCounter against the last one they consumed to skip
+	// frames they have already seen, and should not hold a handle across UI frames.
+	class SpectralSnapshot {
+	public:
+		SpectralSnapshot() = default;
+		~SpectralSnapshot() { release(); }
+
+		SpectralSnapshot(SpectralSnapshot&& other) noexcept : slot(std::exchange(other.slot, nullptr)) {}
+		SpectralSnapshot& operator=(SpectralSnapshot&& other) noexcept;
+		SpectralSnapshot(const SpectralSnapshot&) = delete;
+		SpectralSnapshot& operator=(const SpectralSnapshot&) = delete;
+
+		const SpectralData& operator*() const;
+		const SpectralData* operator->() const { return &**this; }
+		explicit operator bool() const { return slot != nullptr; }
+
+	private:
+		friend class AudioProcessor;
+		explicit SpectralSnapshot(SnapshotSlot* pinned) : slot(pinned) {}
+		void release();
+
+		SnapshotSlot* slot = nullptr;
 	};
 
-	using BufferedFrames = std::vector<std::vector<FFTProcessor::FFTFrame>>;
+	using BorrowedFrames = std::vector<std::vector<FFTProcessor::FrameView>>;
 
-	AudioProcessor();
+	// Time from a buffer being queued to its analysis being published. Bucket i counts
+	// buffers that took [2^i, 2^(i+1)) microseconds; the last bucket also takes anything slower.
+	static constexpr size_t LATENCY_BUCKET_COUNT = 16;
+	using LatencyHistogram = std::array<uint64_t, LATENCY_BUCKET_COUNT>;
+
+	explicit AudioProcessor(int requestedFFTSize = FFTProcessor::FFT_SIZE);
 	~AudioProcessor();
 
-	void queueAudioData(const float* buffer, size_t numSamples, float sampleRate, size_t numChannels);
+	// capturedAt is when the buffer's first sample was captured, on the steady clock.
+	void queueAudioData(const float* buffer, size_t numSamples, float sampleRate, size_t numChannels,
+						std::chrono::steady_clock::time_point capturedAt);
 
-	SpectralData getSpectralData() const;
-	void copySpectralData(SpectralData& out) const;
-	BufferedFrames consumeBufferedFrames();
+	// Never waits on the analysis thread and never copies; always returns a valid snapshot.
+	SpectralSnapshot acquireSpectralData() const;
+	SpectralData getSpectralData() const { return *acquireSpectralData(); }
+	// Borrowing never waits on the analysis thread; views stay valid until released.
+	void borrowBufferedFrames(BorrowedFrames& frames);
+	void releaseBufferedFrames(const BorrowedFrames& frames);
 	void discardBufferedFrames();
+	// Advances each time the analysis thread has pushed a buffer's frames. The analysis thread
+	// only bumps and notifies it, so a waiting consumer never holds it up.
+	uint64_t bufferedFrameGeneration() const { return frameGeneration.load(std::memory_order_acquire); }
+	uint64_t waitForBufferedFrames(uint64_t seenGeneration) const;
+	void wakeFrameWaiters();
 	void setEQGains(float low, float mid, float high);
 	void reset();
 	void start();
 	void stop();
 	uint64_t getDroppedBufferCount() const { return droppedBufferCount.load(std::memory_order_relaxed); }
+	LatencyHistogram getLatencyHistogram() const;
+	// Channels are analysed on up to this many lanes, the analysis thread being one of them.
+	// Zero picks automatically: mono and stereo stay on the analysis thread, and wider inputs
+	// spread across up to eight lanes. Takes effect from the next buffer.
+	void setAnalysisLaneCount(size_t lanes) { requestedLaneCount.store(lanes, std::memory_order_relaxed); }
+	// Decimates input at 88.2 kHz and above to 44.1 or 48 kHz before analysis (see Decimator),
+	// so the FFT spends its bins below MAX_FREQ and resolves them more finely. SpectralData then
+	// reports the decimated rate. Off by default; takes effect from the next buffer.
+	void setAnalysisDecimationEnabled(bool enabled) { decimationEnabled.store(enabled, std::memory_order_relaxed); }
 
+	int getFFTSize() const { return fftSize; }
 	FFTProcessor& getFFTProcessor(size_t channel = 0);
 	const FFTProcessor& getFFTProcessor(size_t channel = 0) const;
 	size_t getChannelCount() const;
 
 private:
-	static constexpr size_t QUEUE_SIZE = 16;
-	static constexpr size_t MAX_SAMPLES = 4096;
+	// Raw interleaved input, written in variable-length chunks. A chunk never wraps: one that
+	// would run past the end starts again at the front, so every chunk can be read in place.
+	static constexpr size_t SAMPLE_RING_CAPACITY = size_t{1} << 20;
+	static constexpr size_t CHUNK_QUEUE_SIZE = 64;
+	static constexpr size_t MAX_FRAME_SOURCES = 16;
+
+	// How long the worker keeps polling for the next buffer before it parks.
+	static constexpr std::chrono::microseconds WAKE_SPIN_DURATION{50};
 
-	struct AudioBuffer {
-		std::vector<float> data = std::vector<float>(MAX_SAMPLES);
+	struct InputChunk {
+		std::chrono::steady_clock::time_point queuedAt;
+		std::chrono::steady_clock::time_point capturedAt;
+		uint64_t start = 0;
 		size_t sampleCount = 0;
 		float sampleRate = 44100.0f;
 		size_t numChannels = 1;
 	};
 
-	std::array<AudioBuffer, QUEUE_SIZE> audioQueue;
+	std::vector<float> sampleRing = std::vector<float>(SAMPLE_RING_CAPACITY);
+	uint64_t ringWritePosition = 0;  // Producer only
+	std::atomic<uint64_t> ringReadPosition{0};
+	std::array<InputChunk, CHUNK_QUEUE_SIZE> chunkQueue;
 	std::atomic<size_t> writeIndex;
 	std::atomic<size_t> readIndex;
 	std::thread workerThread;
 	std::atomic<bool> running;
-	std::condition_variable dataAvailable;
-	std::mutex queueMutex;
+	// Bumped after every queued buffer and on stop; the worker parks on it with atomic wait,
+	// so the audio callback only ever notifies and never takes a lock.
+	std::atomic<uint32_t> wakeSequence{0};
 	std::atomic<uint64_t> droppedBufferCount{0};
+	std::array<std::atomic<uint64_t>, LATENCY_BUCKET_COUNT> latencyHistogram{};
 
+	const int fftSize;
 	mutable std::mutex processorMutex;
 	std::vector<std::unique_ptr<FFTProcessor>> fftProcessors;
+	// One per channel pair. An even channel count is analysed a pair at a time through these.
+	std::vector<std::unique_ptr<StereoFFTProcessor>> stereoProcessors;
 	size_t activeChannelCount = 0;
+	std::array<std::atomic<FFTProcessor*>, MAX_FRAME_SOURCES> frameSources{};
+	std::atomic<size_t> frameSourceCount{0};
+	std::atomic<uint64_t> frameGeneration{0};
 	float eqLowGain = 1.0f;
 	float eqMidGain = 1.0f;
 	float eqHighGain = 1.0f;
-	std::vector<float> channelBufferScratch;
 	SpectralData stagingSpectralData;
+	TransientDetector transientDetector;
+	// One decimator per channel, all in the same phase, so every channel of a buffer comes out
+	// decimatedFrames long. Lanes decimate their own channels into decimatedInput, interleaved
+	// like the ring, before analysing them.
+	std::atomic<bool> decimationEnabled{false};
+	std::vector<Decimator> decimators;
+	std::vector<float> decimatedInput;
+	int decimationFactor = 1;
+	float decimationInputRate = 0.0f;
+	size_t decimatedFrames = 0;
+	// The frame last given a capture time, kept for buffers that complete no hop.
+	uint64_t stampedFrameCounter = 0;
+	int64_t frameCaptureMicros = 0;
+
+	// Published results live in a small pool of slots. The writer swaps each frame's staging
+	// data into a slot no reader has pinned and points publishedSnapshot at it; readers pin
+	// the slot and then confirm it is still the published one. Only the thread holding
+	// processorMutex publishes. A frame is left unpublished if every slot is pinned.
+	struct SnapshotSlot {
+		SpectralData data;
+		std::atomic<uint32_t> readers{0};
+	};
+	static constexpr size_t SNAPSHOT_SLOTS = 8;
+	std::array<SnapshotSlot, SNAPSHOT_SLOTS> snapshotSlots;
+	std::atomic<SnapshotSlot*> publishedSnapshot{nullptr};
+
+	struct ChannelResult {
+		FFTProcessor::AnalysisState analysis;
+		float peakMagnitude = 0.0f;
+		size_t peakBin = 0;
+	};
 
-	mutable std::mutex resultsMutex;
-	SpectralData currentSpectralData;
+	// Lane threads are owned by the analysis thread. Each pass, every lane meets the others at
+	// laneBarrier, analyses channels lane, lane + laneCount, ..., and meets them again, so
+	// the frame's SpectralData is only assembled once every channel has been analysed. With
+	// an even channel count the lanes share out channel pairs instead.
+	std::atomic<size_t> requestedLaneCount{0};
+	std::vector<std::thread> laneThreads;
+	std::unique_ptr<std::barrier<>> laneBarrier;
+	size_t laneCount = 1;
+	bool lanesStopping = false;
+	const InputChunk* laneChunk = nullptr;
+	std::vector<ChannelResult> channelResults;
 
 	void processingThreadFunc();
-	void processBuffer(const AudioBuffer& buffer);
+	bool waitForChunk();
+	void recordLatency(std::chrono::steady_clock::time_point queuedAt);
+	void processChunk(const InputChunk& chunk);
+	void configureDecimation(const InputChunk& chunk);
+	void decimateChannel(size_t channel);
+	void analyseLaneChannels(size_t lane);
+	void collectChannelResult(size_t channel);
+	void laneThreadFunc(size_t lane);
+	void configureLanes(size_t numChannels);
+	void stopLanes();
+	void publishSpectralData();
 	void ensureProcessorCountLocked(size_t numChannels);
 	FFTProcessor* getProcessorForChannel(size_t channel);
 	const FFTProcessor* getProcessorForChannel(size_t channel) const;
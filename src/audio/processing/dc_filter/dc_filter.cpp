@@ -25,9 +25,34 @@ void DCFilter::processBuffer(float* buffer, const size_t numSamples, const size_
 		return;
 	}
 
-	for (size_t i = 0; i < numSamples; ++i) {
-		buffer[i] = process(buffer[i], channel);
+	processStrided(buffer, numSamples, 1, channel);
+}
+
+void DCFilter::processInterleaved(float* buffer, const size_t numFrames, const size_t numChannels) {
+	if (!buffer) {
+		return;
+	}
+
+	const size_t filteredChannels = std::min(numChannels, previousInputs.size());
+	for (size_t channel = 0; channel < filteredChannels; ++channel) {
+		processStrided(buffer + channel, numFrames, numChannels, channel);
+	}
+}
+
+// Keeps the channel's state in locals for the whole run rather than going back to the
+// state vectors for every sample.
+void DCFilter::processStrided(float* buffer, const size_t numFrames, const size_t stride, const size_t channel) {
+	float previousInput = previousInputs[channel];
+	float previousOutput = previousOutputs[channel];
+	for (size_t frame = 0; frame < numFrames; ++frame) {
+		float& sample = buffer[frame * stride];
+		const float input = sample;
+		previousOutput = input - previousInput + alpha * previousOutput;
+		previousInput = input;
+		sample = previousOutput;
 	}
+	previousInputs[channel] = previousInput;
+	previousOutputs[channel] = previousOutput;
 }
 
 void DCFilter::setChannelCount(const size_t channels) {
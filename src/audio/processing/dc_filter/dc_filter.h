@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 class DCFilter {
@@ -11,11 +12,16 @@ public:
 
 	float process(float sample, size_t channel = 0);
 	void processBuffer(float* buffer, size_t numSamples, size_t channel = 0);
+	// Filters each channel of interleaved frames in place; channels beyond the configured
+	// count pass through untouched.
+	void processInterleaved(float* buffer, size_t numFrames, size_t numChannels);
 
 	void setChannelCount(size_t channels);
 	void reset();
 
 private:
+	void processStrided(float* buffer, size_t numFrames, size_t stride, size_t channel);
+
 	float alpha;
 	std::vector<float> previousInputs;
 	std::vector<float> previousOutputs;
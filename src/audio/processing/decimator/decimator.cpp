@@ -0,0 +1,152 @@
+#include "decimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "constants.h"
+
+namespace {
+
+constexpr double STOPBAND_ATTENUATION_DB = 80.0;
+constexpr size_t MAX_TAPS = 511;
+
+double besselI0(const double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	const double halfX = 0.5 * x;
+	for (int k = 1; k < 64; ++k) {
+		term *= (halfX / k) * (halfX / k);
+		sum += term;
+		if (term < sum * 1e-12) {
+			break;
+		}
+	}
+	return sum;
+}
+
+}
+
+int Decimator::factorFor(const float sampleRate) {
+	int factor = 1;
+	while (factor < MAX_FACTOR && sampleRate / static_cast<float>(factor * 2) >= MIN_OUTPUT_RATE) {
+		factor *= 2;
+	}
+	return factor;
+}
+
+Decimator::Decimator(const int initialFactor, const float initialSampleRate) {
+	configure(initialFactor, initialSampleRate);
+}
+
+void Decimator::configure(const int newFactor, const float newSampleRate) {
+	const int clampedFactor = std::clamp(newFactor, 1, MAX_FACTOR);
+	if (clampedFactor != factor || newSampleRate != sampleRate || (factor > 1 && coefficients.empty())) {
+		factor = clampedFactor;
+		sampleRate = newSampleRate;
+		design();
+	}
+	reset();
+}
+
+void Decimator::reset() {
+	std::fill(history.begin(), history.end(), 0.0f);
+	historyPosition = 0;
+	phase = 0;
+}
+
+// Kaiser-windowed sinc cut off at the output Nyquist, its length from Kaiser's estimate for
+// the transition band and rounded so the group delay is a whole number of outputs.
+void Decimator::design() {
+	coefficients.clear();
+	history.clear();
+	latency = 0;
+	if (factor == 1 || sampleRate <= 0.0f) {
+		factor = 1;
+		return;
+	}
+
+	const double inputRate = static_cast<double>(sampleRate);
+	const double outputRate = inputRate / factor;
+	const double passEdge = std::min(static_cast<double>(synesthesia::constants::MAX_AUDIO_FREQ), 0.45 * outputRate);
+	const double transition = (outputRate - 2.0 * passEdge) / inputRate;
+	const double estimatedTaps =
+		(STOPBAND_ATTENUATION_DB - 7.95) / (2.285 * 2.0 * std::numbers::pi * transition) + 1.0;
+	const size_t step = 2 * static_cast<size_t>(factor);
+	const size_t halfLength = std::min(
+		static_cast<size_t>(std::ceil((estimatedTaps - 1.0) / static_cast<double>(step))), (MAX_TAPS - 1) / step);
+	const size_t taps = halfLength * step + 1;
+	latency = halfLength;
+
+	const double beta = 0.1102 * (STOPBAND_ATTENUATION_DB - 8.7);
+	const double cutoff = 0.5 / factor;
+	const double centre = static_cast<double>(taps - 1) / 2.0;
+	const double windowScale = 1.0 / besselI0(beta);
+	coefficients.resize(taps);
+	double sum = 0.0;
+	for (size_t n = 0; n < taps; ++n) {
+		const double offset = static_cast<double>(n) - centre;
+		const double ratio = offset / centre;
+		const double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) * windowScale;
+		const double argument = 2.0 * cutoff * offset;
+		const double sinc = offset == 0.0 ? 1.0 : std::sin(std::numbers::pi * argument) / (std::numbers::pi * argument);
+		const double value = 2.0 * cutoff * sinc * window;
+		coefficients[n] = static_cast<float>(value);
+		sum += value;
+	}
+	// Unity at DC.
+	for (float& coefficient : coefficients) {
+		coefficient = static_cast<float>(coefficient / sum);
+	}
+	history.assign(taps * 2, 0.0f);
+}
+
+size_t Decimator::process(const float* input, const size_t count, const size_t inputStride, float* output,
+						  const size_t outputStride) {
+	if (factor == 1 || coefficients.empty()) {
+		for (size_t i = 0; i < count; ++i) {
+			output[i * outputStride] = input[i * inputStride];
+		}
+		return count;
+	}
+
+	const size_t taps = coefficients.size();
+	size_t written = 0;
+	for (size_t i = 0; i < count; ++i) {
+		const float sample = input[i * inputStride];
+		history[historyPosition] = sample;
+		history[historyPosition + taps] = sample;
+		historyPosition = historyPosition + 1 == taps ? 0 : historyPosition + 1;
+
+		if (phase == 0) {
+			// The filter is symmetric, so oldest-first history against the taps needs no reversal.
+			const float* window = history.data() + historyPosition;
+			float accumulator = 0.0f;
+			for (size_t tap = 0; tap < taps; ++tap) {
+				accumulator += coefficients[tap] * window[tap];
+			}
+			output[written * outputStride] = accumulator;
+			++written;
+		}
+		phase = phase + 1 == factor ? 0 : phase + 1;
+	}
+	return written;
+}
+
+size_t Decimator::outputsFor(const size_t count) const {
+	if (factor == 1 || coefficients.empty()) {
+		return count;
+	}
+	const size_t step = static_cast<size_t>(factor);
+	const size_t first = (step - static_cast<size_t>(phase)) % step;
+	return count > first ? 1 + (count - 1 - first) / step : 0;
+}
+
+size_t Decimator::flush(float* output, const size_t outputStride) {
+	size_t written = 0;
+	const float silence = 0.0f;
+	for (size_t i = 0; i < latency * static_cast<size_t>(factor); ++i) {
+		written += process(&silence, 1, 1, output + written * outputStride, outputStride);
+	}
+	return written;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Brings a high-rate signal down to about 48 kHz ahead of analysis: a linear-phase FIR
+// lowpass, with only every factor-th output computed. The passband runs to MAX_AUDIO_FREQ and
+// the stopband starts where aliasing would first fold back below it, about 80 dB down, since
+// anything folding in above MAX_AUDIO_FREQ is never analysed. That keeps the filter to 65 taps
+// at 96 kHz and 129 at 192 kHz, or 16 and 32 multiplies per input sample.
+class Decimator {
+public:
+	static constexpr float MIN_OUTPUT_RATE = 44100.0f;
+	static constexpr int MAX_FACTOR = 8;
+
+	// The largest power of two up to MAX_FACTOR that keeps sampleRate / factor at or above
+	// MIN_OUTPUT_RATE, so 1 below 88.2 kHz.
+	static int factorFor(float sampleRate);
+
+	Decimator() = default;
+	Decimator(int initialFactor, float initialSampleRate);
+
+	// Redesigns the filter if either has changed and starts again from silence. A factor of
+	// 1 passes samples straight through.
+	void configure(int newFactor, float newSampleRate);
+	void reset();
+
+	int getFactor() const { return factor; }
+	// How many output samples the filter delays the signal by.
+	size_t getLatency() const { return latency; }
+
+	// Takes count samples, inputStride apart, and writes every factor-th filtered one
+	// outputStride apart, the first input of all producing the first output. Returns how many
+	// it wrote.
+	size_t process(const float* input, size_t count, size_t inputStride, float* output, size_t outputStride = 1);
+	// How many outputs process() would write for count more inputs.
+	size_t outputsFor(size_t count) const;
+	// Runs getLatency() outputs' worth of silence through, writing the outputs the end of the
+	// signal was still delayed into.
+	size_t flush(float* output, size_t outputStride = 1);
+
+private:
+	void design();
+
+	int factor = 1;
+	float sampleRate = 0.0f;
+	std::vector<float> coefficients;
+	// Each input is written twice, taps apart, so the newest taps inputs always lie
+	// contiguous at historyPosition.
+	std::vector<float> history;
+	size_t historyPosition = 0;
+	int phase = 0;
+	size_t latency = 0;
+};
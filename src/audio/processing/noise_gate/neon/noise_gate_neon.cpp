@@ -0,0 +1,25 @@
+#include "noise_gate_neon.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+
+namespace NoiseGateNEON {
+
+std::size_t gate(float* buffer, const std::size_t count, const float threshold) {
+    const std::size_t vectorSize = count & ~std::size_t{3};
+    const float32x4_t thresholdVec = vdupq_n_f32(threshold);
+
+    for (std::size_t i = 0; i < vectorSize; i += 4) {
+        const float32x4_t samples = vld1q_f32(buffer + i);
+        // Only samples known to be below the threshold are cleared, so NaNs pass as in the
+        // scalar comparison.
+        const uint32x4_t closed = vcltq_f32(vabsq_f32(samples), thresholdVec);
+        vst1q_f32(buffer + i, vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(samples), closed)));
+    }
+
+    return vectorSize;
+}
+
+}
+
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <cstddef>
+
+namespace NoiseGateNEON {
+    // Zeroes samples whose magnitude is below threshold, four at a time, and returns how many
+    // leading samples it handled; the caller gates the rest.
+    std::size_t gate(float* buffer, std::size_t count, float threshold);
+}
+
+#endif
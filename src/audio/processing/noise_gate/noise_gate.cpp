@@ -1,5 +1,11 @@
 #include "noise_gate.h"
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/noise_gate_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/noise_gate_sse.h"
+#endif
+
 NoiseGate::NoiseGate(const float threshold) : threshold(threshold) {}
 
 void NoiseGate::setThreshold(const float newThreshold) { this->threshold = newThreshold; }
@@ -13,7 +19,13 @@ void NoiseGate::processBuffer(float* buffer, const size_t numSamples) const {
 		return;
 	}
 
-	for (size_t i = 0; i < numSamples; ++i) {
+	size_t i = 0;
+#ifdef USE_NEON_OPTIMISATIONS
+	i = NoiseGateNEON::gate(buffer, numSamples, threshold);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	i = NoiseGateSSE::gate(buffer, numSamples, threshold);
+#endif
+	for (; i < numSamples; ++i) {
 		buffer[i] = process(buffer[i]);
 	}
 }
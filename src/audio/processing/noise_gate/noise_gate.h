@@ -11,6 +11,8 @@ public:
 	float getThreshold() const { return threshold; }
 
 	float process(float sample) const;
+	// The gate keeps no state, so interleaved buffers of any channel count are gated in one
+	// call with numSamples = frames * channels.
 	void processBuffer(float* buffer, size_t numSamples) const;
 
 private:
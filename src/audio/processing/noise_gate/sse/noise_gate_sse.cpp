@@ -0,0 +1,25 @@
+#include "noise_gate_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+
+namespace NoiseGateSSE {
+
+std::size_t gate(float* buffer, const std::size_t count, const float threshold) {
+    const std::size_t vectorSize = count & ~std::size_t{3};
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 thresholdVec = _mm_set1_ps(threshold);
+
+    for (std::size_t i = 0; i < vectorSize; i += 4) {
+        const __m128 samples = _mm_loadu_ps(buffer + i);
+        // Not-less-than keeps NaNs, as the scalar comparison does.
+        const __m128 open = _mm_cmpnlt_ps(_mm_and_ps(samples, absMask), thresholdVec);
+        _mm_storeu_ps(buffer + i, _mm_and_ps(samples, open));
+    }
+
+    return vectorSize;
+}
+
+}
+
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+
+namespace NoiseGateSSE {
+    // Zeroes samples whose magnitude is below threshold, four at a time, and returns how many
+    // leading samples it handled; the caller gates the rest.
+    std::size_t gate(float* buffer, std::size_t count, float threshold);
+}
+
+#endif
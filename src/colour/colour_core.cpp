@@ -2,13 +2,24 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <limits>
-#include <numeric>
+#include <numbers>
 #include <vector>
 
+#include "audio/analysis/fft/spectral_descriptors.h"
 #include "audio/analysis/phase/phase_features.h"
 #include "colour/cie_2006.h"
+#include "utilities/profiling/frame_profiler.h"
+
+#ifdef USE_NEON_OPTIMISATIONS
+#include "colour/neon/cube_root_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "colour/sse/cube_root_sse.h"
+#endif
 
 namespace {
 
@@ -147,6 +158,16 @@ constexpr ColourCore::PngProfile kSrgbPngProfile{
     1
 };
 
+struct SpectralBasis {
+    size_t binCount = 0;
+    float sampleRate = 0.0f;
+    // The axis the weights were built for, compared bit for bit.
+    std::vector<float> frequencies;
+    std::vector<float> weightX;
+    std::vector<float> weightY;
+    std::vector<float> weightZ;
+};
+
 struct SpectralBandBalance {
     float low = 0.0f;
     float mid = 0.0f;
@@ -189,6 +210,41 @@ std::array<float, 3> multiplyMatrix(const std::array<float, 9>& matrix,
     };
 }
 
+// The scalar twin of the cube root kernels, for their tails and other targets: a third of
+// the bit pattern as the estimate, then one Halley and one Newton step.
+float fastCubeRoot(const float value) {
+    const float magnitude = std::abs(value);
+    if (!(magnitude >= std::numeric_limits<float>::min())) {
+        return 0.0f;
+    }
+
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    bits = static_cast<std::uint32_t>(static_cast<float>(bits) * (1.0f / 3.0f)) + 709921077U;
+    float root = 0.0f;
+    std::memcpy(&root, &bits, sizeof(root));
+
+    const float cube = root * root * root;
+    root *= (cube + 2.0f * magnitude) / (2.0f * cube + magnitude);
+    root = (2.0f * root + magnitude / (root * root)) * (1.0f / 3.0f);
+    return std::copysign(root, value);
+}
+
+void cubeRoots(const float* input, float* output, const size_t count) {
+    size_t i = 0;
+#ifdef USE_NEON_OPTIMISATIONS
+    i = CubeRootNEON::cubeRoots(input, output, count);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    i = CubeRootSSE::cubeRoots(input, output, count);
+#endif
+    for (; i < count; ++i) {
+        output[i] = fastCubeRoot(input[i]);
+    }
+}
+
+// Batch conversions work through this many colours at a time in stack buffers.
+constexpr size_t kConversionChunk = 256;
+
 float encodeSrgb(const float value) {
     const float absValue = std::abs(value);
     if (absValue <= kSrgbEncodeThreshold) {
@@ -399,29 +455,11 @@ float blendLogFrequencies(const float lhs, const float rhs, const float blend) {
         std::clamp(blend, 0.0f, 1.0f)));
 }
 
-SpectralBandBalance calculateBandBalance(std::span<const float> magnitudes,
-                                         std::span<const float> frequencies) {
+SpectralBandBalance calculateBandBalance(const SpectralDescriptors::Accumulators& sums) {
     SpectralBandBalance balance{};
-    if (magnitudes.size() != frequencies.size()) {
-        return balance;
-    }
-
-    for (size_t i = 0; i < magnitudes.size(); ++i) {
-        const float magnitude = magnitudes[i];
-        const float frequency = frequencies[i];
-        if (!std::isfinite(magnitude) || !std::isfinite(frequency) || magnitude <= 0.0f) {
-            continue;
-        }
-
-        const float energy = magnitude * magnitude;
-        if (frequency < 220.0f) {
-            balance.low += energy;
-        } else if (frequency < 2200.0f) {
-            balance.mid += energy;
-        } else {
-            balance.high += energy;
-        }
-    }
+    balance.low = sums.lowEnergy;
+    balance.mid = sums.midEnergy;
+    balance.high = sums.highEnergy;
 
     const float total = balance.low + balance.mid + balance.high;
     if (total <= kRmsEpsilon) {
@@ -434,83 +472,42 @@ SpectralBandBalance calculateBandBalance(std::span<const float> magnitudes,
     return balance;
 }
 
-float calculateSpectralCentroid(std::span<const float> magnitudes,
-                                std::span<const float> frequencies) {
-    float weightedSum = 0.0f;
-    float totalWeight = 0.0f;
-
-    for (size_t i = 0; i < magnitudes.size() && i < frequencies.size(); ++i) {
-        const float magnitude = magnitudes[i];
-        const float frequency = frequencies[i];
-        if (frequency < synesthesia::constants::MIN_AUDIO_FREQ ||
-            frequency > synesthesia::constants::MAX_AUDIO_FREQ ||
-            magnitude <= kEpsilonSmall) {
-            continue;
-        }
-
-        weightedSum += frequency * magnitude;
-        totalWeight += magnitude;
-    }
-
-    return totalWeight > kEpsilonSmall ? weightedSum / totalWeight : 0.0f;
+float calculateSpectralCentroid(const SpectralDescriptors::Accumulators& sums) {
+    return sums.audibleWeightSum > kEpsilonSmall
+        ? sums.weightedFrequencySum / sums.audibleWeightSum
+        : 0.0f;
 }
 
 float calculateSpectralSpread(std::span<const float> magnitudes,
                               std::span<const float> frequencies,
+                              const SpectralDescriptors::Accumulators& sums,
                               const float centroid) {
-    float spreadSum = 0.0f;
-    float totalWeight = 0.0f;
-
-    for (size_t i = 0; i < magnitudes.size() && i < frequencies.size(); ++i) {
-        const float magnitude = magnitudes[i];
-        const float frequency = frequencies[i];
-        if (frequency < synesthesia::constants::MIN_AUDIO_FREQ ||
-            frequency > synesthesia::constants::MAX_AUDIO_FREQ ||
-            magnitude <= kEpsilonSmall) {
-            continue;
-        }
-
-        const float diff = frequency - centroid;
-        spreadSum += magnitude * diff * diff;
-        totalWeight += magnitude;
+    if (sums.audibleWeightSum <= kEpsilonSmall) {
+        return 0.0f;
     }
 
-    return totalWeight > kEpsilonSmall ? std::sqrt(spreadSum / totalWeight) : 0.0f;
+    const double deviation = SpectralDescriptors::weightedSquaredDeviation(magnitudes, frequencies, centroid);
+    return static_cast<float>(std::sqrt(deviation / static_cast<double>(sums.audibleWeightSum)));
 }
 
-float calculateSpectralFlatness(std::span<const float> magnitudes) {
-    float geometricSum = 0.0f;
-    float arithmeticSum = 0.0f;
-    int count = 0;
-
-    for (const float magnitude : magnitudes) {
-        if (magnitude > kEpsilonSmall) {
-            geometricSum += std::log(magnitude);
-            arithmeticSum += magnitude;
-            ++count;
-        }
-    }
-
-    if (count == 0 || arithmeticSum < kEpsilonSmall) {
+float calculateSpectralFlatness(const SpectralDescriptors::Accumulators& sums) {
+    if (sums.positiveCount <= 0.0f || sums.positiveMagnitudeSum < kEpsilonSmall) {
         return 0.5f;
     }
 
-    const float geometricMean = std::exp(geometricSum / static_cast<float>(count));
-    const float arithmeticMean = arithmeticSum / static_cast<float>(count);
+    const float geometricMean = std::exp(sums.logMagnitudeSum / sums.positiveCount);
+    const float arithmeticMean = sums.positiveMagnitudeSum / sums.positiveCount;
     return geometricMean / arithmeticMean;
 }
 
 float calculateSpectralRolloff(std::span<const float> magnitudes,
                                std::span<const float> frequencies,
+                               const float totalEnergy,
                                const float threshold = 0.85f) {
     if (magnitudes.size() != frequencies.size() || magnitudes.empty()) {
         return 0.0f;
     }
 
-    float totalEnergy = 0.0f;
-    for (const float magnitude : magnitudes) {
-        totalEnergy += magnitude * magnitude;
-    }
     if (totalEnergy < kEpsilonSmall) {
         return 0.0f;
     }
@@ -547,28 +544,54 @@ float calculateSpectralCrestFactor(std::span<const float> magnitudes,
     return maxMagnitude / rms;
 }
 
-ColourCore::XYZ integrateSpectrum2006(std::span<const float> magnitudes,
-                                      std::span<const float> frequencies) {
-    ColourCore::XYZ total{};
+// Bin frequencies only change with the FFT size, sample rate or an edited axis, so the
+// CIE 2006 weights per bin are cached per thread and rebuilt only when the key changes.
+// The axis is checked with memcmp rather than hashed: a hash chains a multiply through
+// every bin, where memcmp runs at memory speed, and this runs for every analysed frame.
+const SpectralBasis& spectralBasisFor(std::span<const float> frequencies, const float sampleRate) {
+    thread_local SpectralBasis basis;
 
-    for (size_t i = 0; i < magnitudes.size() && i < frequencies.size(); ++i) {
-        const float magnitude = magnitudes[i];
+    if (basis.binCount == frequencies.size() &&
+        basis.sampleRate == sampleRate &&
+        !basis.weightX.empty() &&
+        std::memcmp(basis.frequencies.data(), frequencies.data(), frequencies.size_bytes()) == 0) {
+        return basis;
+    }
+
+    basis.binCount = frequencies.size();
+    basis.sampleRate = sampleRate;
+    basis.frequencies.assign(frequencies.begin(), frequencies.end());
+    basis.weightX.assign(frequencies.size(), 0.0f);
+    basis.weightY.assign(frequencies.size(), 0.0f);
+    basis.weightZ.assign(frequencies.size(), 0.0f);
+
+    for (size_t i = 0; i < frequencies.size(); ++i) {
         const float frequency = frequencies[i];
         if (frequency < synesthesia::constants::MIN_AUDIO_FREQ ||
-            frequency > synesthesia::constants::MAX_AUDIO_FREQ ||
-            magnitude <= kEpsilonSmall) {
+            frequency > synesthesia::constants::MAX_AUDIO_FREQ) {
             continue;
         }
 
         const float wavelength = ColourCore::logFrequencyToWavelength(frequency);
-        float X = 0.0f;
-        float Y = 0.0f;
-        float Z = 0.0f;
-        ColourCore::interpolateCIE(wavelength, X, Y, Z);
+        ColourCore::interpolateCIE(wavelength, basis.weightX[i], basis.weightY[i], basis.weightZ[i]);
+    }
+
+    return basis;
+}
+
+ColourCore::XYZ integrateSpectrum2006(std::span<const float> magnitudes,
+                                      const SpectralBasis& basis) {
+    ColourCore::XYZ total{};
 
-        total.X += magnitude * X;
-        total.Y += magnitude * Y;
-        total.Z += magnitude * Z;
+    const size_t count = std::min(magnitudes.size(), basis.binCount);
+    const float* weightX = basis.weightX.data();
+    const float* weightY = basis.weightY.data();
+    const float* weightZ = basis.weightZ.data();
+    for (size_t i = 0; i < count; ++i) {
+        const float magnitude = magnitudes[i] > kEpsilonSmall ? magnitudes[i] : 0.0f;
+        total.X += magnitude * weightX[i];
+        total.Y += magnitude * weightY[i];
+        total.Z += magnitude * weightZ[i];
     }
 
     return total;
@@ -667,100 +690,81 @@ void applyPhaseInfluence(FrameResult& result,
         std::max(0.0f, result.Y) * synesthesia::constants::REFERENCE_WHITE_LUMINANCE_CDM2;
 }
 
-} // namespace
-
-namespace ColourCore {
-
-WhitePoint D50White() {
-    return kD50White;
-}
-
-WhitePoint D65White() {
-    return kD65White;
-}
+void projectWith(const OutputProfileDefinition& definition,
+                 const float X, const float Y, const float Z,
+                 float& r, float& g, float& b,
+                 const bool applyGamma,
+                 const bool applyGamutMapping) {
+    const auto linearRgb = multiplyMatrix(definition.xyzToRgb, X, Y, Z);
 
-void interpolateCIE(const float wavelength, float& X, float& Y, float& Z) {
-    Colour::CIE2006::interpolate(wavelength, X, Y, Z);
-}
+    float linearR = linearRgb[0];
+    float linearG = linearRgb[1];
+    float linearB = linearRgb[2];
 
-float logFrequencyToWavelength(const float frequency) {
-    if (!std::isfinite(frequency) || frequency <= 0.0f) {
-        return synesthesia::constants::MAX_WAVELENGTH_NM;
+    if (applyGamutMapping) {
+        mixTowardsWhite(linearR, linearG, linearB);
+        gamutMapRgb(linearR, linearG, linearB);
+        linearR = std::clamp(linearR, 0.0f, 1.0f);
+        linearG = std::clamp(linearG, 0.0f, 1.0f);
+        linearB = std::clamp(linearB, 0.0f, 1.0f);
     }
 
-    constexpr float minWavelength = 390.0f;
-    constexpr float maxWavelength = 700.0f;
-
-    if (frequency < synesthesia::constants::MIN_AUDIO_FREQ) {
-        const float subMin = 0.1f;
-        const float tSub = std::clamp(
-            (frequency - subMin) / (synesthesia::constants::MIN_AUDIO_FREQ - subMin),
-            0.0f,
-            1.0f);
-        return 900.0f - tSub * (900.0f - maxWavelength);
+    if (!applyGamma) {
+        r = linearR;
+        g = linearG;
+        b = linearB;
+        return;
     }
 
-    const float minLog = std::log2(synesthesia::constants::MIN_AUDIO_FREQ);
-    const float maxLog = std::log2(synesthesia::constants::MAX_AUDIO_FREQ);
-    const float logFrequency = std::log2(frequency);
-    const float normalised = (logFrequency - minLog) / (maxLog - minLog);
-    const float t = std::clamp(normalised, 0.0f, 1.0f);
-    return maxWavelength - t * (maxWavelength - minWavelength);
-}
-
-float wavelengthToLogFrequency(const float wavelengthIn) {
-    constexpr float minWavelength = 390.0f;
-    constexpr float maxWavelength = 700.0f;
+    r = encodeTransferValue(definition.transfer, linearR);
+    g = encodeTransferValue(definition.transfer, linearG);
+    b = encodeTransferValue(definition.transfer, linearB);
 
-    const float wavelength = std::clamp(
-        std::isfinite(wavelengthIn) ? wavelengthIn : maxWavelength,
-        minWavelength,
-        maxWavelength);
-    const float t = (maxWavelength - wavelength) / (maxWavelength - minWavelength);
-    const float minLog = std::log2(synesthesia::constants::MIN_AUDIO_FREQ);
-    const float maxLog = std::log2(synesthesia::constants::MAX_AUDIO_FREQ);
-    return std::pow(2.0f, minLog + t * (maxLog - minLog));
+    if (applyGamutMapping) {
+        r = std::clamp(r, 0.0f, 1.0f);
+        g = std::clamp(g, 0.0f, 1.0f);
+        b = std::clamp(b, 0.0f, 1.0f);
+    }
 }
 
-float chromaticDominantWavelength(const float X, const float Y, const float Z) {
-    const float sum = X + Y + Z;
-    if (!std::isfinite(sum) || sum <= 0.0f) {
-        return synesthesia::constants::MAX_WAVELENGTH_NM;
+// The spectral locus at 1 nm spacing, as chromaticities.
+struct SpectralLocus {
+    static constexpr int FIRST_WAVELENGTH = 390;
+    static constexpr int LAST_WAVELENGTH = 830;
+    static constexpr std::size_t SAMPLE_COUNT = LAST_WAVELENGTH - FIRST_WAVELENGTH + 1;
+
+    std::array<std::array<float, 2>, SAMPLE_COUNT> chromaticity{};
+
+    SpectralLocus() {
+        for (std::size_t i = 0; i < SAMPLE_COUNT; ++i) {
+            float X = 0.0f;
+            float Y = 0.0f;
+            float Z = 0.0f;
+            Colour::CIE2006::interpolate(static_cast<float>(FIRST_WAVELENGTH + static_cast<int>(i)), X, Y, Z);
+            const float sum = X + Y + Z;
+            chromaticity[i] = sum > 0.0f ? std::array<float, 2>{X / sum, Y / sum} : std::array<float, 2>{0.0f, 0.0f};
+        }
     }
+};
 
-    const float x = X / sum;
-    const float y = Y / sum;
-
+std::array<float, 2> d50Chromaticity() {
     const float whiteSum = kD50White.X + kD50White.Y + kD50White.Z;
-    const float whiteX = kD50White.X / whiteSum;
-    const float whiteY = kD50White.Y / whiteSum;
+    return {kD50White.X / whiteSum, kD50White.Y / whiteSum};
+}
 
-    const float rayDx = x - whiteX;
-    const float rayDy = y - whiteY;
-    const float rayLengthSquared = rayDx * rayDx + rayDy * rayDy;
-    if (rayLengthSquared < kEpsilonTiny) {
-        return synesthesia::constants::MAX_WAVELENGTH_NM;
-    }
+// Casts a ray from the D50 white point against the locus. Where it passes through the
+// purple gap instead, the wavelength whose direction is closest to the ray wins.
+float rayCastDominantWavelength(const SpectralLocus& locus, const float rayDx, const float rayDy) {
+    const auto [whiteX, whiteY] = d50Chromaticity();
 
     bool found = false;
     float bestT = std::numeric_limits<float>::max();
     float bestWavelength = synesthesia::constants::MAX_WAVELENGTH_NM;
 
-    auto chromaticityAt = [](const float wavelength) {
-        float sampleX = 0.0f;
-        float sampleY = 0.0f;
-        float sampleZ = 0.0f;
-        ColourCore::interpolateCIE(wavelength, sampleX, sampleY, sampleZ);
-        const float sampleSum = sampleX + sampleY + sampleZ;
-        if (sampleSum <= 0.0f) {
-            return std::array<float, 2>{0.0f, 0.0f};
-        }
-        return std::array<float, 2>{sampleX / sampleSum, sampleY / sampleSum};
-    };
-
-    for (int wavelength = 390; wavelength < 830; ++wavelength) {
-        const auto c0 = chromaticityAt(static_cast<float>(wavelength));
-        const auto c1 = chromaticityAt(static_cast<float>(wavelength + 1));
+    for (std::size_t i = 0; i + 1 < SpectralLocus::SAMPLE_COUNT; ++i) {
+        const auto& c0 = locus.chromaticity[i];
+        const auto& c1 = locus.chromaticity[i + 1];
+        const float wavelength = static_cast<float>(SpectralLocus::FIRST_WAVELENGTH + static_cast<int>(i));
 
         const float segDx = c1[0] - c0[0];
         const float segDy = c1[1] - c0[1];
@@ -778,7 +782,7 @@ float chromaticDominantWavelength(const float X, const float Y, const float Z) {
             found = true;
             bestT = t;
             bestWavelength = std::clamp(
-                std::lerp(static_cast<float>(wavelength), static_cast<float>(wavelength + 1), u),
+                std::lerp(wavelength, wavelength + 1.0f, u),
                 synesthesia::constants::MIN_WAVELENGTH_NM,
                 synesthesia::constants::MAX_WAVELENGTH_NM);
         }
@@ -788,14 +792,13 @@ float chromaticDominantWavelength(const float X, const float Y, const float Z) {
         return bestWavelength;
     }
 
-    const float rayLength = std::sqrt(rayLengthSquared);
+    const float rayLength = std::sqrt(rayDx * rayDx + rayDy * rayDy);
     float bestCosine = -1.0f;
     float bestDistance = std::numeric_limits<float>::max();
 
-    for (int wavelength = 390; wavelength <= 830; ++wavelength) {
-        const auto chromaticity = chromaticityAt(static_cast<float>(wavelength));
-        const float vecX = chromaticity[0] - whiteX;
-        const float vecY = chromaticity[1] - whiteY;
+    for (std::size_t i = 0; i < SpectralLocus::SAMPLE_COUNT; ++i) {
+        const float vecX = locus.chromaticity[i][0] - whiteX;
+        const float vecY = locus.chromaticity[i][1] - whiteY;
         const float vectorLength = std::sqrt(vecX * vecX + vecY * vecY);
         if (vectorLength < kEpsilonSmall) {
             continue;
@@ -813,13 +816,125 @@ float chromaticDominantWavelength(const float X, const float Y, const float Z) {
             (std::abs(cosine - bestCosine) < 1e-4f && distance < bestDistance)) {
             bestCosine = cosine;
             bestDistance = distance;
-            bestWavelength = static_cast<float>(wavelength);
+            bestWavelength = static_cast<float>(SpectralLocus::FIRST_WAVELENGTH + static_cast<int>(i));
         }
     }
 
     return bestWavelength;
 }
 
+// The dominant wavelength depends only on the direction from the white point, so it is
+// ray-cast once per angular bin and interpolated between bins.
+struct DominantWavelengthTable {
+    static constexpr std::size_t BIN_COUNT = 4096;
+    // Beyond this step between neighbouring bins, as across the purple gap's edges or the
+    // folded red end, the nearer bin is taken instead of blending across the jump.
+    static constexpr float MAX_INTERPOLATED_STEP_NM = 10.0f;
+
+    std::array<float, BIN_COUNT + 1> wavelength{};
+
+    DominantWavelengthTable() {
+        const SpectralLocus locus;
+        for (std::size_t bin = 0; bin < BIN_COUNT; ++bin) {
+            const double angle = -std::numbers::pi + 2.0 * std::numbers::pi * static_cast<double>(bin) /
+                                                         static_cast<double>(BIN_COUNT);
+            wavelength[bin] = rayCastDominantWavelength(locus,
+                                                        static_cast<float>(std::cos(angle)),
+                                                        static_cast<float>(std::sin(angle)));
+        }
+        wavelength[BIN_COUNT] = wavelength[0];
+    }
+
+    float lookup(const float rayDx, const float rayDy) const {
+        constexpr float binsPerRadian = static_cast<float>(BIN_COUNT / (2.0 * std::numbers::pi));
+        const float position = (std::atan2(rayDy, rayDx) + std::numbers::pi_v<float>) * binsPerRadian;
+        const std::size_t bin = std::min(static_cast<std::size_t>(std::max(position, 0.0f)), BIN_COUNT - 1);
+        const float fraction = std::clamp(position - static_cast<float>(bin), 0.0f, 1.0f);
+        const float w0 = wavelength[bin];
+        const float w1 = wavelength[bin + 1];
+        if (std::abs(w1 - w0) > MAX_INTERPOLATED_STEP_NM) {
+            return fraction < 0.5f ? w0 : w1;
+        }
+        return std::lerp(w0, w1, fraction);
+    }
+};
+
+const DominantWavelengthTable& dominantWavelengthTable() {
+    static const DominantWavelengthTable table;
+    return table;
+}
+
+} // namespace
+
+namespace ColourCore {
+
+WhitePoint D50White() {
+    return kD50White;
+}
+
+WhitePoint D65White() {
+    return kD65White;
+}
+
+void interpolateCIE(const float wavelength, float& X, float& Y, float& Z) {
+    Colour::CIE2006::interpolate(wavelength, X, Y, Z);
+}
+
+float logFrequencyToWavelength(const float frequency) {
+    if (!std::isfinite(frequency) || frequency <= 0.0f) {
+        return synesthesia::constants::MAX_WAVELENGTH_NM;
+    }
+
+    constexpr float minWavelength = 390.0f;
+    constexpr float maxWavelength = 700.0f;
+
+    if (frequency < synesthesia::constants::MIN_AUDIO_FREQ) {
+        const float subMin = 0.1f;
+        const float tSub = std::clamp(
+            (frequency - subMin) / (synesthesia::constants::MIN_AUDIO_FREQ - subMin),
+            0.0f,
+            1.0f);
+        return 900.0f - tSub * (900.0f - maxWavelength);
+    }
+
+    const float minLog = std::log2(synesthesia::constants::MIN_AUDIO_FREQ);
+    const float maxLog = std::log2(synesthesia::constants::MAX_AUDIO_FREQ);
+    const float logFrequency = std::log2(frequency);
+    const float normalised = (logFrequency - minLog) / (maxLog - minLog);
+    const float t = std::clamp(normalised, 0.0f, 1.0f);
+    return maxWavelength - t * (maxWavelength - minWavelength);
+}
+
+float wavelengthToLogFrequency(const float wavelengthIn) {
+    constexpr float minWavelength = 390.0f;
+    constexpr float maxWavelength = 700.0f;
+
+    const float wavelength = std::clamp(
+        std::isfinite(wavelengthIn) ? wavelengthIn : maxWavelength,
+        minWavelength,
+        maxWavelength);
+    const float t = (maxWavelength - wavelength) / (maxWavelength - minWavelength);
+    const float minLog = std::log2(synesthesia::constants::MIN_AUDIO_FREQ);
+    const float maxLog = std::log2(synesthesia::constants::MAX_AUDIO_FREQ);
+    return std::pow(2.0f, minLog + t * (maxLog - minLog));
+}
+
+float chromaticDominantWavelength(const float X, const float Y, const float Z) {
+    const float sum = X + Y + Z;
+    if (!std::isfinite(sum) || sum <= 0.0f) {
+        return synesthesia::constants::MAX_WAVELENGTH_NM;
+    }
+
+    const auto [whiteX, whiteY] = d50Chromaticity();
+    const float rayDx = X / sum - whiteX;
+    const float rayDy = Y / sum - whiteY;
+    if (rayDx * rayDx + rayDy * rayDy < kEpsilonTiny) {
+        return synesthesia::constants::MAX_WAVELENGTH_NM;
+    }
+
+    return dominantWavelengthTable().lookup(rayDx, rayDy);
+}
+
 void XYZtoLab(const float X, const float Y, const float Z, float& L, float& a, float& bValue) {
     const float xr = kD50White.X > 0.0f ? X / kD50White.X : 0.0f;
     const float yr = kD50White.Y > 0.0f ? Y / kD50White.Y : 0.0f;
@@ -877,6 +992,90 @@ void OklabtoXYZ(const float L, const float a, const float bValue, float& X, floa
     Z = xyz[2];
 }
 
+void XYZtoLab(std::span<const XYZ> xyz, std::span<Lab> lab) {
+    constexpr float epsilon = synesthesia::constants::LAB_EPSILON;
+    constexpr float kappa = synesthesia::constants::LAB_KAPPA;
+    const std::array<float, 3> inverseWhite{1.0f / kD50White.X, 1.0f / kD50White.Y, 1.0f / kD50White.Z};
+
+    std::array<float, kConversionChunk * 3> scaled;
+    std::array<float, kConversionChunk * 3> roots;
+    const size_t count = std::min(xyz.size(), lab.size());
+    for (size_t start = 0; start < count; start += kConversionChunk) {
+        const size_t chunk = std::min(kConversionChunk, count - start);
+        for (size_t i = 0; i < chunk; ++i) {
+            scaled[i * 3 + 0] = xyz[start + i].X * inverseWhite[0];
+            scaled[i * 3 + 1] = xyz[start + i].Y * inverseWhite[1];
+            scaled[i * 3 + 2] = xyz[start + i].Z * inverseWhite[2];
+        }
+        cubeRoots(scaled.data(), roots.data(), chunk * 3);
+        for (size_t i = 0; i < chunk * 3; ++i) {
+            if (scaled[i] <= epsilon) {
+                roots[i] = (kappa * scaled[i] + 16.0f) / 116.0f;
+            }
+        }
+        for (size_t i = 0; i < chunk; ++i) {
+            const float fx = roots[i * 3 + 0];
+            const float fy = roots[i * 3 + 1];
+            const float fz = roots[i * 3 + 2];
+            lab[start + i] = {116.0f * fy - 16.0f, 500.0f * (fx - fy), 200.0f * (fy - fz)};
+        }
+    }
+}
+
+void LabtoXYZ(std::span<const Lab> lab, std::span<XYZ> xyz) {
+    constexpr float delta = synesthesia::constants::LAB_DELTA;
+    constexpr float deltaSquared = delta * delta;
+    const auto inverse = [](const float value) {
+        return value > delta ? value * value * value : 3.0f * deltaSquared * (value - 4.0f / 29.0f);
+    };
+
+    const size_t count = std::min(lab.size(), xyz.size());
+    for (size_t i = 0; i < count; ++i) {
+        const float fY = (lab[i].L + 16.0f) / 116.0f;
+        const float fX = fY + lab[i].a / 500.0f;
+        const float fZ = fY - lab[i].b / 200.0f;
+        xyz[i] = {kD50White.X * inverse(fX), kD50White.Y * inverse(fY), kD50White.Z * inverse(fZ)};
+    }
+}
+
+void XYZtoOklab(std::span<const XYZ> xyz, std::span<Lab> oklab) {
+    std::array<float, kConversionChunk * 3> lms;
+    std::array<float, kConversionChunk * 3> roots;
+    const size_t count = std::min(xyz.size(), oklab.size());
+    for (size_t start = 0; start < count; start += kConversionChunk) {
+        const size_t chunk = std::min(kConversionChunk, count - start);
+        for (size_t i = 0; i < chunk; ++i) {
+            const auto& colour = xyz[start + i];
+            const auto cone = multiplyMatrix(kXYZToOklabLms, colour.X, colour.Y, colour.Z);
+            lms[i * 3 + 0] = cone[0];
+            lms[i * 3 + 1] = cone[1];
+            lms[i * 3 + 2] = cone[2];
+        }
+        cubeRoots(lms.data(), roots.data(), chunk * 3);
+        for (size_t i = 0; i < chunk; ++i) {
+            const float l = roots[i * 3 + 0];
+            const float m = roots[i * 3 + 1];
+            const float s = roots[i * 3 + 2];
+            oklab[start + i] = {
+                (0.2104542683093140f * l + 0.7936177747023054f * m - 0.0040720430116193f * s) * 100.0f,
+                (1.9779985324311684f * l - 2.4285922420485799f * m + 0.4505937096174110f * s) * 100.0f,
+                (0.0259040424655478f * l + 0.7827717124575296f * m - 0.8086757549230774f * s) * 100.0f
+            };
+        }
+    }
+}
+
+void OklabtoXYZ(std::span<const Lab> oklab, std::span<XYZ> xyz) {
+    const size_t count = std::min(oklab.size(), xyz.size());
+    for (size_t i = 0; i < count; ++i) {
+        float X = 0.0f;
+        float Y = 0.0f;
+        float Z = 0.0f;
+        OklabtoXYZ(oklab[i].L, oklab[i].a, oklab[i].b, X, Y, Z);
+        xyz[i] = {X, Y, Z};
+    }
+}
+
 void RGBtoXYZ(const float r, const float g, const float b, float& X, float& Y, float& Z,
               const ColourSpace colourSpace) {
     const auto& definition = outputProfileDefinition(colourSpace);
@@ -894,37 +1093,7 @@ void XYZtoRGB(const float X, const float Y, const float Z,
               const ColourSpace colourSpace,
               const bool applyGamma,
               const bool applyGamutMapping) {
-    const auto& definition = outputProfileDefinition(colourSpace);
-    const auto linearRgb = multiplyMatrix(definition.xyzToRgb, X, Y, Z);
-
-    float linearR = linearRgb[0];
-    float linearG = linearRgb[1];
-    float linearB = linearRgb[2];
-
-    if (applyGamutMapping) {
-        mixTowardsWhite(linearR, linearG, linearB);
-        gamutMapRgb(linearR, linearG, linearB);
-        linearR = std::clamp(linearR, 0.0f, 1.0f);
-        linearG = std::clamp(linearG, 0.0f, 1.0f);
-        linearB = std::clamp(linearB, 0.0f, 1.0f);
-    }
-
-    if (!applyGamma) {
-        r = linearR;
-        g = linearG;
-        b = linearB;
-        return;
-    }
-
-    r = encodeTransferValue(definition.transfer, linearR);
-    g = encodeTransferValue(definition.transfer, linearG);
-    b = encodeTransferValue(definition.transfer, linearB);
-
-    if (applyGamutMapping) {
-        r = std::clamp(r, 0.0f, 1.0f);
-        g = std::clamp(g, 0.0f, 1.0f);
-        b = std::clamp(b, 0.0f, 1.0f);
-    }
+    projectWith(outputProfileDefinition(colourSpace), X, Y, Z, r, g, b, applyGamma, applyGamutMapping);
 }
 
 void RGBtoLab(const float r, const float g, const float b, float& L, float& a, float& bValue,
@@ -962,6 +1131,15 @@ RGB projectToRGB(const XYZ& xyz, const OutputSettings& settings) {
     return rgb;
 }
 
+void projectToRGB(std::span<const XYZ> xyz, std::span<RGB> rgb, const OutputSettings& settings) {
+    const auto& definition = outputProfileDefinition(settings.colourSpace);
+    const size_t count = std::min(xyz.size(), rgb.size());
+    for (size_t i = 0; i < count; ++i) {
+        projectWith(definition, xyz[i].X, xyz[i].Y, xyz[i].Z, rgb[i].r, rgb[i].g, rgb[i].b, true,
+                    settings.applyGamutMapping);
+    }
+}
+
 const VideoProfile& videoProfileFor(const ColourSpace colourSpace) {
     return outputProfileDefinition(colourSpace).videoProfile;
 }
@@ -1043,6 +1221,26 @@ FrameResult analyseSpectrum(std::span<const float> magnitudes,
                             const OutputSettings& outputSettings,
                             const float overrideLoudnessDb,
                             const PhaseAnalysis::PhaseFeatureMetrics* phaseMetrics) {
+    thread_local AnalysisScratch scratch;
+    return analyseSpectrum(scratch,
+                           magnitudes,
+                           phases,
+                           frequencies,
+                           sampleRate,
+                           outputSettings,
+                           overrideLoudnessDb,
+                           phaseMetrics);
+}
+
+FrameResult analyseSpectrum(AnalysisScratch& scratch,
+                            std::span<const float> magnitudes,
+                            std::span<const float> phases,
+                            std::span<const float> frequencies,
+                            const float sampleRate,
+                            const OutputSettings& outputSettings,
+                            const float overrideLoudnessDb,
+                            const PhaseAnalysis::PhaseFeatureMetrics* phaseMetrics) {
+    SYN_PROFILE_SCOPE(AnalyseSpectrum);
     FrameResult result{};
 
     if (magnitudes.empty() || sampleRate <= 0.0f) {
@@ -1056,34 +1254,40 @@ FrameResult analyseSpectrum(std::span<const float> magnitudes,
         return result;
     }
 
-    std::vector<float> cleanMagnitudes(magnitudes.size(), 0.0f);
-    for (size_t i = 0; i < magnitudes.size(); ++i) {
+    const size_t binCount = magnitudes.size();
+    scratch.cleanMagnitudes.resize(binCount);
+    for (size_t i = 0; i < binCount; ++i) {
         const float magnitude = magnitudes[i];
-        cleanMagnitudes[i] = (std::isfinite(magnitude) && magnitude > 0.0f) ? magnitude : 0.0f;
-    }
-
-    std::vector<float> effectiveFrequencies;
-    effectiveFrequencies.resize(cleanMagnitudes.size(), 0.0f);
-    if (!frequencies.empty() && frequencies.size() == cleanMagnitudes.size()) {
-        std::copy(frequencies.begin(), frequencies.end(), effectiveFrequencies.begin());
-    } else if (cleanMagnitudes.size() > 1) {
-        const float binSize = sampleRate / (2.0f * static_cast<float>(cleanMagnitudes.size() - 1));
-        for (size_t i = 0; i < cleanMagnitudes.size(); ++i) {
-            effectiveFrequencies[i] = static_cast<float>(i) * binSize;
+        scratch.cleanMagnitudes[i] = (std::isfinite(magnitude) && magnitude > 0.0f) ? magnitude : 0.0f;
+    }
+    const std::span<const float> cleanMagnitudes(scratch.cleanMagnitudes.data(), binCount);
+
+    std::span<const float> effectiveFrequencies = frequencies;
+    if (frequencies.size() != binCount) {
+        if (scratch.effectiveFrequencies.size() != binCount ||
+            scratch.effectiveFrequencySampleRate != sampleRate) {
+            scratch.effectiveFrequencies.assign(binCount, 0.0f);
+            if (binCount > 1) {
+                const float binSize = sampleRate / (2.0f * static_cast<float>(binCount - 1));
+                for (size_t i = 0; i < binCount; ++i) {
+                    scratch.effectiveFrequencies[i] = static_cast<float>(i) * binSize;
+                }
+            }
+            scratch.effectiveFrequencySampleRate = sampleRate;
         }
+        effectiveFrequencies = std::span<const float>(scratch.effectiveFrequencies.data(), binCount);
     }
 
-    result.spectralCentroid = calculateSpectralCentroid(cleanMagnitudes, effectiveFrequencies);
-    result.spectralSpread = calculateSpectralSpread(cleanMagnitudes, effectiveFrequencies, result.spectralCentroid);
-    result.spectralFlatness = calculateSpectralFlatness(cleanMagnitudes);
-    result.spectralRolloff = calculateSpectralRolloff(cleanMagnitudes, effectiveFrequencies);
+    const SpectralDescriptors::Accumulators sums =
+        SpectralDescriptors::accumulate(cleanMagnitudes, effectiveFrequencies);
+    const float maxMagnitude = sums.maxMagnitude;
+    const float totalEnergy = sums.totalEnergy;
 
-    float maxMagnitude = 0.0f;
-    float totalEnergy = 0.0f;
-    for (const float magnitude : cleanMagnitudes) {
-        maxMagnitude = std::max(maxMagnitude, magnitude);
-        totalEnergy += magnitude * magnitude;
-    }
+    result.spectralCentroid = calculateSpectralCentroid(sums);
+    result.spectralSpread =
+        calculateSpectralSpread(cleanMagnitudes, effectiveFrequencies, sums, result.spectralCentroid);
+    result.spectralFlatness = calculateSpectralFlatness(sums);
+    result.spectralRolloff = calculateSpectralRolloff(cleanMagnitudes, effectiveFrequencies, totalEnergy);
     result.spectralCrestFactor = calculateSpectralCrestFactor(cleanMagnitudes, maxMagnitude, totalEnergy);
 
     const float computedLoudnessDb = calculateLoudnessDbFromEnergy(totalEnergy, cleanMagnitudes.size());
@@ -1111,19 +1315,20 @@ FrameResult analyseSpectrum(std::span<const float> magnitudes,
         0.55f * (1.0f - result.spectralFlatness) + 0.45f * crestNormalised,
         0.0f,
         1.0f);
-    const SpectralBandBalance bandBalance = calculateBandBalance(cleanMagnitudes, effectiveFrequencies);
+    const SpectralBandBalance bandBalance = calculateBandBalance(sums);
     const float transientAccent = transientMix * (0.35f + 0.65f * tonalStrength);
     const float brightnessGain = std::clamp(
         loudnessToBrightness(brightnessLoudnessDb) * (1.0f + 0.18f * transientAccent),
         0.0f,
         1.2f);
 
-    const XYZ integratedXYZ = integrateSpectrum2006(cleanMagnitudes, effectiveFrequencies);
+    const XYZ integratedXYZ = integrateSpectrum2006(
+        cleanMagnitudes, spectralBasisFor(effectiveFrequencies, sampleRate));
 
     float chromaX = 0.0f;
     float chromaY = 0.0f;
     float chromaZ = 0.0f;
-    const float totalWeight = std::accumulate(cleanMagnitudes.begin(), cleanMagnitudes.end(), 0.0f);
+    const float totalWeight = sums.magnitudeSum;
     if (totalWeight > kEpsilonSmall) {
         const float invWeight = 1.0f / totalWeight;
         chromaX = integratedXYZ.X * invWeight;
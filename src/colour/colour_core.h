@@ -3,6 +3,7 @@
 #include <array>
 #include <limits>
 #include <span>
+#include <vector>
 
 #include "constants.h"
 
@@ -83,6 +84,16 @@ struct FrameResult {
     float phaseTransientNorm = 0.0f;
 };
 
+// Reusable per-caller workspace for analyseSpectrum. Buffers only grow, so a caller that keeps
+// one alive across frames of the same size performs no allocations in steady state.
+struct AnalysisScratch {
+    std::vector<float> cleanMagnitudes;
+    std::vector<float> effectiveFrequencies;
+    // The sample rate effectiveFrequencies was derived for, so a run of frames on the same
+    // FFT grid derives it once.
+    float effectiveFrequencySampleRate = 0.0f;
+};
+
 struct VideoProfile {
     const char* filter = "";
     const char* colourSpace = "";
@@ -115,6 +126,15 @@ void LabtoXYZ(float L, float a, float bValue, float& X, float& Y, float& Z);
 void XYZtoOklab(float X, float Y, float Z, float& L, float& a, float& bValue);
 void OklabtoXYZ(float L, float a, float bValue, float& X, float& Y, float& Z);
 
+// Array forms of the four conversions above, for whole sequences; Oklab travels in Lab's
+// fields. Cube roots come from a bit-level estimate refined by one Halley and one Newton
+// step, within 2.5 ulp of std::cbrt, and cubes are multiplied out, so results can differ
+// from the scalar forms in the last bits.
+void XYZtoLab(std::span<const XYZ> xyz, std::span<Lab> lab);
+void LabtoXYZ(std::span<const Lab> lab, std::span<XYZ> xyz);
+void XYZtoOklab(std::span<const XYZ> xyz, std::span<Lab> oklab);
+void OklabtoXYZ(std::span<const Lab> oklab, std::span<XYZ> xyz);
+
 void RGBtoXYZ(float r, float g, float b, float& X, float& Y, float& Z, ColourSpace colourSpace);
 void XYZtoRGB(float X, float Y, float Z, float& r, float& g, float& b,
               ColourSpace colourSpace,
@@ -128,6 +148,8 @@ void LabtoRGB(float L, float a, float bValue, float& r, float& g, float& bOut,
               bool applyGamutMapping = true);
 
 RGB projectToRGB(const XYZ& xyz, const OutputSettings& settings);
+// The same projection over a run of colours, resolving the output profile once.
+void projectToRGB(std::span<const XYZ> xyz, std::span<RGB> rgb, const OutputSettings& settings);
 const VideoProfile& videoProfileFor(ColourSpace colourSpace);
 const PngProfile& pngProfileFor(ColourSpace colourSpace);
 SpectralCharacteristics calculateSpectralCharacteristics(std::span<const float> spectrum, float sampleRate);
@@ -140,4 +162,13 @@ FrameResult analyseSpectrum(std::span<const float> magnitudes,
                             float overrideLoudnessDb = LOUDNESS_DB_UNSPECIFIED,
                             const PhaseAnalysis::PhaseFeatureMetrics* phaseMetrics = nullptr);
 
+FrameResult analyseSpectrum(AnalysisScratch& scratch,
+                            std::span<const float> magnitudes,
+                            std::span<const float> phases,
+                            std::span<const float> frequencies,
+                            float sampleRate,
+                            const OutputSettings& outputSettings,
+                            float overrideLoudnessDb = LOUDNESS_DB_UNSPECIFIED,
+                            const PhaseAnalysis::PhaseFeatureMetrics* phaseMetrics = nullptr);
+
 }
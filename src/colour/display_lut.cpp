@@ -0,0 +1,240 @@
+#include "colour/display_lut.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+
+#ifdef USE_NEON_OPTIMISATIONS
+#include "colour/neon/display_lut_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "colour/sse/display_lut_sse.h"
+#endif
+
+namespace ColourCore {
+
+namespace {
+
+static_assert(sizeof(Lab) == 3 * sizeof(float) && sizeof(RGB) == 3 * sizeof(float),
+              "The batch kernels read Lab and write RGB as packed float triples");
+
+constexpr std::size_t GRID_SIZE = DisplayLUT::GRID_SIZE;
+constexpr std::size_t NODE_FLOATS = 4;
+constexpr std::array<std::size_t, 3> kStrides{GRID_SIZE * GRID_SIZE * NODE_FLOATS, GRID_SIZE * NODE_FLOATS,
+                                              NODE_FLOATS};
+
+// Spans every colour the analysis produces; more saturated ones take the exact path.
+constexpr std::array<float, 3> kOrigin{0.0f, -160.0f, -160.0f};
+constexpr std::array<float, 3> kExtent{100.0f, 320.0f, 320.0f};
+constexpr std::array<float, 3> kScale{
+    static_cast<float>(GRID_SIZE - 1) / kExtent[0],
+    static_cast<float>(GRID_SIZE - 1) / kExtent[1],
+    static_cast<float>(GRID_SIZE - 1) / kExtent[2]
+};
+
+// A cell is trusted when the interpolation at these points lies within kCellTolerance of
+// the exact projection in every channel.
+constexpr float kCellTolerance = 1.0f / 1024.0f;
+constexpr std::array<std::array<float, 3>, 3> kCellProbes{{
+    {0.2f, 0.5f, 0.8f}, {0.8f, 0.2f, 0.5f}, {0.5f, 0.8f, 0.2f}
+}};
+
+constexpr std::uint32_t kValidationSeed = 0xC0105;
+constexpr int kValidationSamples = 16384;
+
+RGB projectExact(const Lab& lab, const OutputSettings& settings) {
+    RGB rgb{};
+    LabtoRGB(lab.L, lab.a, lab.b, rgb.r, rgb.g, rgb.b, settings.colourSpace, settings.applyGamutMapping);
+    return rgb;
+}
+
+// Tetrahedral interpolation within lab's cell. False when lab lies outside the lattice or is
+// not finite, so the caller goes exact.
+bool interpolateCell(const std::vector<float>& nodes, const Lab& lab, RGB& rgb, float& cellError) {
+    const std::array<float, 3> values{lab.L, lab.a, lab.b};
+    constexpr float lastNode = static_cast<float>(GRID_SIZE - 1);
+    std::array<std::size_t, 3> cells{};
+    std::array<float, 3> fractions{};
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        const float coordinate = (values[axis] - kOrigin[axis]) * kScale[axis];
+        if (!(coordinate >= 0.0f && coordinate <= lastNode)) {
+            return false;
+        }
+        cells[axis] = std::min(static_cast<std::size_t>(coordinate), GRID_SIZE - 2);
+        fractions[axis] = coordinate - static_cast<float>(cells[axis]);
+    }
+
+    // The tetrahedron runs from the cell's base corner along the axes in order of
+    // decreasing fraction.
+    std::size_t first = 0;
+    std::size_t second = 1;
+    std::size_t third = 2;
+    if (fractions[first] < fractions[second]) {
+        std::swap(first, second);
+    }
+    if (fractions[second] < fractions[third]) {
+        std::swap(second, third);
+    }
+    if (fractions[first] < fractions[second]) {
+        std::swap(first, second);
+    }
+
+    const float* corner0 = nodes.data() + cells[0] * kStrides[0] + cells[1] * kStrides[1] + cells[2] * kStrides[2];
+    const float* corner1 = corner0 + kStrides[first];
+    const float* corner2 = corner1 + kStrides[second];
+    const float* corner3 = corner2 + kStrides[third];
+    cellError = corner0[3];
+    const float weight0 = 1.0f - fractions[first];
+    const float weight1 = fractions[first] - fractions[second];
+    const float weight2 = fractions[second] - fractions[third];
+    const float weight3 = fractions[third];
+
+    rgb.r = weight0 * corner0[0] + weight1 * corner1[0] + weight2 * corner2[0] + weight3 * corner3[0];
+    rgb.g = weight0 * corner0[1] + weight1 * corner1[1] + weight2 * corner2[1] + weight3 * corner3[1];
+    rgb.b = weight0 * corner0[2] + weight1 * corner1[2] + weight2 * corner2[2] + weight3 * corner3[2];
+    return true;
+}
+
+bool interpolate(const std::vector<float>& nodes, const Lab& lab, RGB& rgb) {
+    float cellError = 0.0f;
+    return interpolateCell(nodes, lab, rgb, cellError) && cellError <= kCellTolerance;
+}
+
+float deltaE(const RGB& lhs, const RGB& rhs, const ColourSpace colourSpace) {
+    Lab lhsLab{};
+    Lab rhsLab{};
+    RGBtoLab(lhs.r, lhs.g, lhs.b, lhsLab.L, lhsLab.a, lhsLab.b, colourSpace);
+    RGBtoLab(rhs.r, rhs.g, rhs.b, rhsLab.L, rhsLab.a, rhsLab.b, colourSpace);
+    return std::hypot(lhsLab.L - rhsLab.L, lhsLab.a - rhsLab.a, lhsLab.b - rhsLab.b);
+}
+
+template <ColourSpace Space, bool GamutMapping>
+const DisplayLUT& sharedTable() {
+    static const DisplayLUT table(OutputSettings{Space, GamutMapping});
+    return table;
+}
+
+template <ColourSpace Space>
+const DisplayLUT& sharedTable(const bool applyGamutMapping) {
+    return applyGamutMapping ? sharedTable<Space, true>() : sharedTable<Space, false>();
+}
+
+}
+
+const DisplayLUT& DisplayLUT::forSettings(const OutputSettings& settings) {
+    switch (settings.colourSpace) {
+        case ColourSpace::Rec2020:
+            return sharedTable<ColourSpace::Rec2020>(settings.applyGamutMapping);
+        case ColourSpace::DisplayP3:
+            return sharedTable<ColourSpace::DisplayP3>(settings.applyGamutMapping);
+        case ColourSpace::SRGB:
+        default:
+            return sharedTable<ColourSpace::SRGB>(settings.applyGamutMapping);
+    }
+}
+
+DisplayLUT::DisplayLUT(const OutputSettings& targetSettings)
+    : settings(targetSettings) {
+    nodes.resize(GRID_SIZE * GRID_SIZE * GRID_SIZE * NODE_FLOATS);
+    float* node = nodes.data();
+    for (std::size_t l = 0; l < GRID_SIZE; ++l) {
+        for (std::size_t a = 0; a < GRID_SIZE; ++a) {
+            for (std::size_t b = 0; b < GRID_SIZE; ++b, node += NODE_FLOATS) {
+                const Lab lab{
+                    kOrigin[0] + static_cast<float>(l) / kScale[0],
+                    kOrigin[1] + static_cast<float>(a) / kScale[1],
+                    kOrigin[2] + static_cast<float>(b) / kScale[2]
+                };
+                const RGB rgb = projectExact(lab, settings);
+                node[0] = rgb.r;
+                node[1] = rgb.g;
+                node[2] = rgb.b;
+            }
+        }
+    }
+
+    // A cell whose interpolation strays from the exact projection, as those the gamut
+    // mapping folds do, sends its colours down the exact path instead.
+    for (std::size_t l = 0; l + 1 < GRID_SIZE; ++l) {
+        for (std::size_t a = 0; a + 1 < GRID_SIZE; ++a) {
+            for (std::size_t b = 0; b + 1 < GRID_SIZE; ++b) {
+                float error = 0.0f;
+                for (const auto& probe : kCellProbes) {
+                    const Lab lab{
+                        kOrigin[0] + (static_cast<float>(l) + probe[0]) / kScale[0],
+                        kOrigin[1] + (static_cast<float>(a) + probe[1]) / kScale[1],
+                        kOrigin[2] + (static_cast<float>(b) + probe[2]) / kScale[2]
+                    };
+                    RGB approximate{};
+                    float cellError = 0.0f;
+                    interpolateCell(nodes, lab, approximate, cellError);
+                    const RGB exact = projectExact(lab, settings);
+                    error = std::max({error, std::abs(approximate.r - exact.r), std::abs(approximate.g - exact.g),
+                                      std::abs(approximate.b - exact.b)});
+                }
+                nodes[l * kStrides[0] + a * kStrides[1] + b * kStrides[2] + 3] = error;
+            }
+        }
+    }
+
+    std::mt19937 generator(kValidationSeed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int sample = 0; sample < kValidationSamples; ++sample) {
+        const Lab lab{
+            kOrigin[0] + unit(generator) * kExtent[0],
+            kOrigin[1] + unit(generator) * kExtent[1],
+            kOrigin[2] + unit(generator) * kExtent[2]
+        };
+        RGB approximate{};
+        if (interpolate(nodes, lab, approximate)) {
+            measuredDeltaE = std::max(measuredDeltaE, deltaE(approximate, projectExact(lab, settings),
+                                                             settings.colourSpace));
+        }
+    }
+}
+
+RGB DisplayLUT::project(const Lab& lab) const {
+    RGB rgb{};
+    if (!interpolate(nodes, lab, rgb)) {
+        rgb = projectExact(lab, settings);
+    }
+    return rgb;
+}
+
+void DisplayLUT::project(std::span<const Lab> lab, std::span<RGB> rgb) const {
+    const std::size_t count = std::min(lab.size(), rgb.size());
+#ifdef USE_NEON_OPTIMISATIONS
+    const DisplayLutNEON::Lattice lattice{nodes.data(), GRID_SIZE, {kOrigin[0], kOrigin[1], kOrigin[2]},
+                                          {kScale[0], kScale[1], kScale[2]}, kCellTolerance};
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    const DisplayLutSSE::Lattice lattice{nodes.data(), GRID_SIZE, {kOrigin[0], kOrigin[1], kOrigin[2]},
+                                         {kScale[0], kScale[1], kScale[2]}, kCellTolerance};
+#endif
+    std::size_t i = 0;
+    while (i < count) {
+#ifdef USE_NEON_OPTIMISATIONS
+        i += DisplayLutNEON::project(&lab[i].L, &rgb[i].r, count - i, lattice);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+        i += DisplayLutSSE::project(&lab[i].L, &rgb[i].r, count - i, lattice);
+#endif
+        if (i < count) {
+            rgb[i] = project(lab[i]);
+            ++i;
+        }
+    }
+}
+
+void DisplayLUT::project(std::span<const XYZ> xyz, std::span<RGB> rgb) const {
+    constexpr std::size_t chunkSize = 256;
+    std::array<Lab, chunkSize> lab;
+    const std::size_t count = std::min(xyz.size(), rgb.size());
+    for (std::size_t start = 0; start < count; start += chunkSize) {
+        const std::size_t chunk = std::min(chunkSize, count - start);
+        XYZtoLab(xyz.subspan(start, chunk), std::span(lab).first(chunk));
+        project(std::span<const Lab>(lab).first(chunk), rgb.subspan(start, chunk));
+    }
+}
+
+}
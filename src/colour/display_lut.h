@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "colour/colour_core.h"
+
+namespace ColourCore {
+
+// A sampled LabtoRGB for one output profile, for callers converting whole strips or images.
+// Colours inside the table's Lab box are interpolated tetrahedrally between the nodes of a
+// GRID_SIZE³ lattice; anything outside it or non-finite takes the exact projection, which
+// stays the reference.
+class DisplayLUT {
+public:
+    static constexpr std::size_t GRID_SIZE = 65;
+
+    // Each profile's table is built by the first caller to ask for it and then shared.
+    static const DisplayLUT& forSettings(const OutputSettings& settings);
+
+    explicit DisplayLUT(const OutputSettings& targetSettings);
+
+    RGB project(const Lab& lab) const;
+    void project(std::span<const Lab> lab, std::span<RGB> rgb) const;
+    // Goes through Lab, whose cube roots are what keep the lattice even near black.
+    void project(std::span<const XYZ> xyz, std::span<RGB> rgb) const;
+
+    // The largest CIE76 difference from the exact projection over the points checked when
+    // the table was built.
+    float maxDeltaE() const { return measuredDeltaE; }
+    const OutputSettings& outputSettings() const { return settings; }
+
+private:
+    OutputSettings settings;
+    std::vector<float> nodes;  // Padded RGB per node, L slowest and b fastest
+    float measuredDeltaE = 0.0f;
+};
+
+}
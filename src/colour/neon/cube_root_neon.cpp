@@ -0,0 +1,38 @@
+#include "cube_root_neon.h"
+
+#ifdef __ARM_NEON
+
+namespace CubeRootNEON {
+
+std::size_t cubeRoots(const float* input, float* output, const std::size_t count) {
+    const uint32x4_t signMask = vdupq_n_u32(0x80000000U);
+    const float32x4_t smallestNormal = vreinterpretq_f32_u32(vdupq_n_u32(0x00800000U));
+    const uint32x4_t seedBias = vdupq_n_u32(709921077U);
+
+    const std::size_t vectorCount = count - count % 4;
+    for (std::size_t i = 0; i < vectorCount; i += 4) {
+        const uint32x4_t values = vreinterpretq_u32_f32(vld1q_f32(input + i));
+        const uint32x4_t sign = vandq_u32(values, signMask);
+        const float32x4_t magnitude = vreinterpretq_f32_u32(vbicq_u32(values, signMask));
+
+        // A third of the bit pattern approximates the cube root to a few percent; the
+        // division goes through float, which only perturbs the estimate.
+        const float32x4_t bits = vcvtq_f32_u32(vreinterpretq_u32_f32(magnitude));
+        float32x4_t root = vreinterpretq_f32_u32(
+            vaddq_u32(vcvtq_u32_f32(vmulq_n_f32(bits, 1.0f / 3.0f)), seedBias));
+
+        // One Halley step, then one Newton step.
+        const float32x4_t cube = vmulq_f32(vmulq_f32(root, root), root);
+        root = vmulq_f32(root, vdivq_f32(vmlaq_n_f32(cube, magnitude, 2.0f), vmlaq_n_f32(magnitude, cube, 2.0f)));
+        root = vmulq_n_f32(vmlaq_n_f32(vdivq_f32(magnitude, vmulq_f32(root, root)), root, 2.0f), 1.0f / 3.0f);
+
+        const uint32x4_t normal = vcgeq_f32(magnitude, smallestNormal);
+        const uint32x4_t result = vorrq_u32(vandq_u32(vreinterpretq_u32_f32(root), normal), sign);
+        vst1q_f32(output + i, vreinterpretq_f32_u32(result));
+    }
+    return vectorCount;
+}
+
+}
+
+#endif
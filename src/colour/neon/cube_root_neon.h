@@ -0,0 +1,15 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <cstddef>
+
+namespace CubeRootNEON {
+    // output[i] = cbrt(input[i]) for the batch colour conversions, from the same estimate
+    // and refinement as ColourCore's scalar fallback: within 2.5 ulp for finite inputs below
+    // 2^126, zero for subnormals. Returns how many values it handled, a multiple of 4,
+    // leaving the tail to the caller.
+    std::size_t cubeRoots(const float* input, float* output, std::size_t count);
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include "display_lut_neon.h"
+
+#ifdef __ARM_NEON
+
+#include <cstdint>
+#include <utility>
+
+namespace DisplayLutNEON {
+
+namespace {
+
+// Integer test, so -ffast-math cannot assume the answer.
+uint32x4_t isFinite(const float32x4_t values) {
+    const uint32x4_t exponent = vandq_u32(vreinterpretq_u32_f32(values), vdupq_n_u32(0x7f800000));
+    return vmvnq_u32(vceqq_u32(exponent, vdupq_n_u32(0x7f800000)));
+}
+
+float32x4_t load3(const float* values) {
+    const float lanes[4] = {values[0], values[1], values[2], 0.0f};
+    return vld1q_f32(lanes);
+}
+
+}
+
+std::size_t project(const float* lab, float* rgb, const std::size_t count, const Lattice& lattice) {
+    if (lattice.gridSize < 2) {
+        return 0;
+    }
+
+    const float32x4_t origin = load3(lattice.origin);
+    const float32x4_t scale = load3(lattice.scale);
+    const float32x4_t lastNode = vdupq_n_f32(static_cast<float>(lattice.gridSize - 1));
+    const float32x4_t lastCell = vdupq_n_f32(static_cast<float>(lattice.gridSize - 2));
+    const std::size_t strides[3] = {lattice.gridSize * lattice.gridSize * 4, lattice.gridSize * 4, 4};
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const float32x4_t values = load3(lab + i * 3);
+        const float32x4_t coords = vmulq_f32(vsubq_f32(values, origin), scale);
+        uint32x4_t inside = vandq_u32(vcgeq_f32(coords, vdupq_n_f32(0.0f)), vcleq_f32(coords, lastNode));
+        inside = vandq_u32(inside, isFinite(values));
+        if (vgetq_lane_u32(inside, 0) == 0 || vgetq_lane_u32(inside, 1) == 0 || vgetq_lane_u32(inside, 2) == 0) {
+            return i;
+        }
+
+        const uint32x4_t cell = vcvtq_u32_f32(vminq_f32(coords, lastCell));
+        std::uint32_t cells[4];
+        float fractions[4];
+        vst1q_u32(cells, cell);
+        vst1q_f32(fractions, vsubq_f32(coords, vcvtq_f32_u32(cell)));
+
+        // The tetrahedron runs from the cell's base corner along the axes in order of
+        // decreasing fraction.
+        int first = 0;
+        int second = 1;
+        int third = 2;
+        if (fractions[first] < fractions[second]) {
+            std::swap(first, second);
+        }
+        if (fractions[second] < fractions[third]) {
+            std::swap(second, third);
+        }
+        if (fractions[first] < fractions[second]) {
+            std::swap(first, second);
+        }
+
+        const float* corner0 = lattice.nodes +
+            static_cast<std::size_t>(cells[0]) * strides[0] +
+            static_cast<std::size_t>(cells[1]) * strides[1] +
+            static_cast<std::size_t>(cells[2]) * strides[2];
+        if (corner0[3] > lattice.cellTolerance) {
+            return i;
+        }
+        const float* corner1 = corner0 + strides[first];
+        const float* corner2 = corner1 + strides[second];
+        const float* corner3 = corner2 + strides[third];
+
+        float32x4_t result = vmulq_n_f32(vld1q_f32(corner0), 1.0f - fractions[first]);
+        result = vmlaq_n_f32(result, vld1q_f32(corner1), fractions[first] - fractions[second]);
+        result = vmlaq_n_f32(result, vld1q_f32(corner2), fractions[second] - fractions[third]);
+        result = vmlaq_n_f32(result, vld1q_f32(corner3), fractions[third]);
+
+        float output[4];
+        vst1q_f32(output, result);
+        rgb[i * 3 + 0] = output[0];
+        rgb[i * 3 + 1] = output[1];
+        rgb[i * 3 + 2] = output[2];
+    }
+    return count;
+}
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <cstddef>
+
+namespace DisplayLutNEON {
+    // Maps Lab onto DisplayLUT's node lattice: coordinate k is (lab[k] - origin[k]) * scale[k].
+    // nodes holds four floats per node, the third axis varying fastest: RGB, then the error
+    // measured over the cell the node is the base corner of.
+    struct Lattice {
+        const float* nodes;
+        std::size_t gridSize;
+        float origin[3];
+        float scale[3];
+        float cellTolerance;
+    };
+
+    // Tetrahedral interpolation of interleaved Lab into interleaved RGB. Stops at the first
+    // colour that is not finite, lies outside the lattice or falls in a cell whose error
+    // exceeds cellTolerance, and returns how many it converted, leaving that colour to the
+    // exact path.
+    std::size_t project(const float* lab, float* rgb, std::size_t count, const Lattice& lattice);
+}
+
+#endif
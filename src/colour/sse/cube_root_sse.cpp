@@ -0,0 +1,41 @@
+#include "cube_root_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+namespace CubeRootSSE {
+
+std::size_t cubeRoots(const float* input, float* output, const std::size_t count) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000U)));
+    const __m128 smallestNormal = _mm_castsi128_ps(_mm_set1_epi32(0x00800000));
+    const __m128 third = _mm_set1_ps(1.0f / 3.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128i seedBias = _mm_set1_epi32(709921077);
+
+    const std::size_t vectorCount = count - count % 4;
+    for (std::size_t i = 0; i < vectorCount; i += 4) {
+        const __m128 values = _mm_loadu_ps(input + i);
+        const __m128 sign = _mm_and_ps(values, signMask);
+        const __m128 magnitude = _mm_andnot_ps(signMask, values);
+
+        // A third of the bit pattern approximates the cube root to a few percent; the
+        // division goes through float, which only perturbs the estimate.
+        const __m128 bits = _mm_cvtepi32_ps(_mm_castps_si128(magnitude));
+        __m128 root = _mm_castsi128_ps(_mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(bits, third)), seedBias));
+
+        // One Halley step, then one Newton step.
+        const __m128 cube = _mm_mul_ps(_mm_mul_ps(root, root), root);
+        root = _mm_mul_ps(root, _mm_div_ps(_mm_add_ps(cube, _mm_mul_ps(two, magnitude)),
+                                           _mm_add_ps(_mm_mul_ps(two, cube), magnitude)));
+        root = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(two, root), _mm_div_ps(magnitude, _mm_mul_ps(root, root))), third);
+
+        root = _mm_and_ps(root, _mm_cmpge_ps(magnitude, smallestNormal));
+        _mm_storeu_ps(output + i, _mm_or_ps(root, sign));
+    }
+    return vectorCount;
+}
+
+}
+
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+
+namespace CubeRootSSE {
+    // output[i] = cbrt(input[i]) for the batch colour conversions, from the same estimate
+    // and refinement as ColourCore's scalar fallback: within 2.5 ulp for finite inputs below
+    // 2^126, zero for subnormals. Returns how many values it handled, a multiple of 4,
+    // leaving the tail to the caller.
+    std::size_t cubeRoots(const float* input, float* output, std::size_t count);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include "display_lut_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <cstdint>
+#include <immintrin.h>
+#include <utility>
+
+namespace DisplayLutSSE {
+
+namespace {
+
+// Integer test, so -ffast-math cannot assume the answer.
+int finiteLanes(const __m128 values) {
+    const __m128i exponent = _mm_and_si128(_mm_castps_si128(values), _mm_set1_epi32(0x7f800000));
+    const __m128i infinite = _mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x7f800000));
+    return ~_mm_movemask_ps(_mm_castsi128_ps(infinite)) & 0xF;
+}
+
+}
+
+std::size_t project(const float* lab, float* rgb, const std::size_t count, const Lattice& lattice) {
+    if (lattice.gridSize < 2) {
+        return 0;
+    }
+
+    const __m128 origin = _mm_setr_ps(lattice.origin[0], lattice.origin[1], lattice.origin[2], 0.0f);
+    const __m128 scale = _mm_setr_ps(lattice.scale[0], lattice.scale[1], lattice.scale[2], 0.0f);
+    const __m128 lastNode = _mm_set1_ps(static_cast<float>(lattice.gridSize - 1));
+    const __m128 lastCell = _mm_set1_ps(static_cast<float>(lattice.gridSize - 2));
+    const std::size_t strides[3] = {lattice.gridSize * lattice.gridSize * 4, lattice.gridSize * 4, 4};
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* colour = lab + i * 3;
+        const __m128 values = _mm_setr_ps(colour[0], colour[1], colour[2], 0.0f);
+        const __m128 coords = _mm_mul_ps(_mm_sub_ps(values, origin), scale);
+        const __m128 inside = _mm_and_ps(_mm_cmpge_ps(coords, _mm_setzero_ps()), _mm_cmple_ps(coords, lastNode));
+        if ((_mm_movemask_ps(inside) & finiteLanes(values) & 0x7) != 0x7) {
+            return i;
+        }
+
+        const __m128i cell = _mm_cvttps_epi32(_mm_min_ps(coords, lastCell));
+        alignas(16) std::int32_t cells[4];
+        alignas(16) float fractions[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(cells), cell);
+        _mm_store_ps(fractions, _mm_sub_ps(coords, _mm_cvtepi32_ps(cell)));
+
+        // The tetrahedron runs from the cell's base corner along the axes in order of
+        // decreasing fraction.
+        int first = 0;
+        int second = 1;
+        int third = 2;
+        if (fractions[first] < fractions[second]) {
+            std::swap(first, second);
+        }
+        if (fractions[second] < fractions[third]) {
+            std::swap(second, third);
+        }
+        if (fractions[first] < fractions[second]) {
+            std::swap(first, second);
+        }
+
+        const float* corner0 = lattice.nodes +
+            static_cast<std::size_t>(cells[0]) * strides[0] +
+            static_cast<std::size_t>(cells[1]) * strides[1] +
+            static_cast<std::size_t>(cells[2]) * strides[2];
+        if (corner0[3] > lattice.cellTolerance) {
+            return i;
+        }
+        const float* corner1 = corner0 + strides[first];
+        const float* corner2 = corner1 + strides[second];
+        const float* corner3 = corner2 + strides[third];
+
+        __m128 result = _mm_mul_ps(_mm_loadu_ps(corner0), _mm_set1_ps(1.0f - fractions[first]));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(corner1), _mm_set1_ps(fractions[first] - fractions[second])));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(corner2), _mm_set1_ps(fractions[second] - fractions[third])));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(corner3), _mm_set1_ps(fractions[third])));
+
+        alignas(16) float output[4];
+        _mm_store_ps(output, result);
+        rgb[i * 3 + 0] = output[0];
+        rgb[i * 3 + 1] = output[1];
+        rgb[i * 3 + 2] = output[2];
+    }
+    return count;
+}
+
+}
+
+#endif
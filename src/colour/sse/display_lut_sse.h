@@ -0,0 +1,25 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+
+namespace DisplayLutSSE {
+    // Maps Lab onto DisplayLUT's node lattice: coordinate k is (lab[k] - origin[k]) * scale[k].
+    // nodes holds four floats per node, the third axis varying fastest: RGB, then the error
+    // measured over the cell the node is the base corner of.
+    struct Lattice {
+        const float* nodes;
+        std::size_t gridSize;
+        float origin[3];
+        float scale[3];
+        float cellTolerance;
+    };
+
+    // Tetrahedral interpolation of interleaved Lab into interleaved RGB. Stops at the first
+    // colour that is not finite, lies outside the lattice or falls in a cell whose error
+    // exceeds cellTolerance, and returns how many it converted, leaving that colour to the
+    // exact path.
+    std::size_t project(const float* lab, float* rgb, std::size_t count, const Lattice& lattice);
+}
+
+#endif
@@ -1,8 +1,13 @@
 #if defined(__APPLE__) || defined(__linux__)
 #include "cli.h"
 #include "headless.h"
+#include "multi_input_daemon.h"
 #include "batch_exporter.h"
 #include "misc/misc_commands.h"
+#include "misc/tune_command.h"
+#ifdef ENABLE_OSC
+#include "synesthesia_osc_integration.h"
+#endif
 #endif
 
 #if defined(_WIN32)
@@ -20,6 +25,8 @@
 #include <iostream>
 #include <string>
 
+#include "utilities/tuning/wisdom.h"
+
 int app_main(int argc, char** argv);
 
 namespace {
@@ -36,9 +43,13 @@ int reportStartupFailure(const std::string& message) {
 
 int main(int argc, char* argv[]) {
     try {
+        Utilities::Tuning::loadDefault();
+
 #if defined(__APPLE__) || defined(__linux__)
         CLI::Arguments args = CLI::Arguments::parseCommandLine(argc, argv);
 
+        Utilities::Threading::setConfiguration(args.threadConfiguration);
+
         if (args.showHelp) {
             CLI::Arguments::printHelp();
             return 0;
@@ -49,6 +60,10 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
+        if (args.tune) {
+            return CLI::Misc::runTuneCommand(args);
+        }
+
         if (args.exportGradients) {
             if (args.inputDir.empty()) {
                 std::cerr << "Error: --export-gradients requires --input <dir>\n";
@@ -62,7 +77,19 @@ int main(int argc, char* argv[]) {
             }
             return CLI::BatchExporter::run(args.inputDir, args.outputDir, args.copyAudio,
                                            args.gradientWidth, args.gradientHeight, args.gradientFormat, args.writeConditionSidecar, args.trueSize,
-                                           args.numWorkers, args.analysisHop, args.disableSmoothing);
+                                           args.numWorkers, args.analysisHop, args.disableSmoothing,
+                                           args.useExportCache, args.shardIndex, args.shardCount,
+                                           args.writeDatasetShards, args.pngCompressionLevel,
+                                           args.memoryBudgetMiB, args.prefetchFiles, args.decimateAnalysis);
+        }
+
+        if (args.mergeManifests) {
+            if (args.inputDir.empty() || args.outputDir.empty()) {
+                std::cerr << "Error: --merge-manifests requires --input <dir> and --output <dir>\n";
+                std::cerr << "Use --help for usage information.\n";
+                return 1;
+            }
+            return CLI::BatchExporter::mergeManifests(args.inputDir, args.outputDir);
         }
 
         if (args.runMisc) {
@@ -71,13 +98,64 @@ int main(int argc, char* argv[]) {
 
         if (args.headless) {
             try {
+                const Utilities::Telemetry::Exporter telemetryExporter(args.telemetryExport);
+#ifdef ENABLE_OSC
+                std::string sharedMemoryError;
+                if (args.sharedMemoryOutput &&
+                    !Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance().startSharedMemoryOutput(
+                        args.sharedMemoryName, sharedMemoryError)) {
+                    std::cerr << "Shared memory output: " << sharedMemoryError << std::endl;
+                }
+#endif
+                if (!args.pipelines.empty()) {
+                    std::vector<CLI::MultiInputDaemon::PipelineSpec> specs;
+                    for (const std::string& pipeline : args.pipelines) {
+                        const auto spec = CLI::MultiInputDaemon::parsePipelineSpec(pipeline);
+                        if (!spec.has_value()) {
+                            std::cerr << "Invalid --pipeline: " << pipeline << std::endl;
+                            return 1;
+                        }
+                        specs.push_back(*spec);
+                    }
+                    CLI::MultiInputDaemon daemon;
+                    return daemon.run(
+                        specs,
+                        args.enableOSC,
+                        args.oscDestination,
+                        static_cast<uint16_t>(args.oscSendPort),
+                        static_cast<uint16_t>(args.oscReceivePort),
+                        args.oscPackedFrames,
+                        args.streamSettings
+                    );
+                }
                 CLI::HeadlessInterface interface;
+                interface.setLatencyProbe(args.latencyProbe);
+                interface.setInputCapture(args.inputCapturePath);
+                interface.setInputReplay(args.inputReplayPath, args.replaySpeed);
+                interface.setAnalysisDecimation(args.decimateAnalysis);
+                interface.setTerminalRefresh(args.terminalRefreshHz, args.quiet);
+                interface.setOSCPeakTracks(static_cast<size_t>(args.oscPeakTracks));
+                if (!args.inputDir.empty()) {
+                    return interface.replayFile(
+                        args.inputDir,
+                        args.replaySpeed,
+                        args.analysisHop,
+                        args.oscDestination,
+                        static_cast<uint16_t>(args.oscSendPort),
+                        static_cast<uint16_t>(args.oscReceivePort),
+                        args.oscPackedFrames,
+                        args.oscExtraDestinations
+                    );
+                }
                 interface.run(
                     args.enableOSC,
                     args.audioDevice,
                     args.oscDestination,
                     static_cast<uint16_t>(args.oscSendPort),
-                    static_cast<uint16_t>(args.oscReceivePort)
+                    static_cast<uint16_t>(args.oscReceivePort),
+                    args.oscPackedFrames,
+                    args.oscExtraDestinations,
+                    args.streamSettings
                 );
                 return 0;
             } catch (const std::exception& e) {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace Synesthesia::OSC {
 
 inline constexpr const char* kFrameMetaSampleRateAddress = "/synesthesia/frame/meta/sample_rate";
@@ -56,6 +58,46 @@ inline constexpr const char* kFrameSmoothingPhaseInstabilityAddress = "/synesthe
 inline constexpr const char* kFrameSmoothingPhaseCoherenceAddress = "/synesthesia/frame/smoothing/phase_coherence_normalised";
 inline constexpr const char* kFrameSmoothingPhaseTransientAddress = "/synesthesia/frame/smoothing/phase_transient_normalised";
 
+// Packed frames carry every value above in one message instead: an int32 schema version,
+// then one argument per address in the order listed, typed as its named message is. The
+// version changes whenever that order or a type does.
+inline constexpr const char* kFramePackedAddress = "/synesthesia/frame/packed";
+inline constexpr int32_t kFramePackedSchemaVersion = 1;
+
+// Spectrum messages carry, in order: int32 schema version, int64 frame timestamp, int32
+// sample rate, int32 FFT size, int32 layout (0 bins, 1 critical bands), int32 bits per
+// level (8 or 16), float floor dB, a blob of levels and a blob of band edges. Levels and
+// edges are big-endian. Each band is a pair of uint16 first and last bins, and the edge
+// blob is empty for the bins layout.
+inline constexpr const char* kFrameSpectrumAddress = "/synesthesia/frame/spectrum";
+inline constexpr int32_t kFrameSpectrumSchemaVersion = 1;
+
+// Peak messages carry, in order: int32 schema version, int64 frame timestamp, int32 sample
+// rate, int32 FFT size, int32 peak count and a blob of peaks in ascending frequency. Each
+// peak is 16 big-endian bytes: a uint32 track id, then float32 frequency in Hz, magnitude
+// and phase in radians. A partial keeps its track id for as long as it lasts, and ids are
+// never reused, so a gap in a track's frames means it ended.
+inline constexpr const char* kFramePeaksAddress = "/synesthesia/frame/peaks";
+inline constexpr int32_t kFramePeaksSchemaVersion = 1;
+
+// Sent as one bundle every OSCConfig::statsIntervalSeconds. The destination message is
+// repeated once per destination with its host, port and bytes per second.
+inline constexpr const char* kStatsLatencyP50Address = "/synesthesia/stats/latency_p50_ms";
+inline constexpr const char* kStatsLatencyP95Address = "/synesthesia/stats/latency_p95_ms";
+inline constexpr const char* kStatsLatencyP99Address = "/synesthesia/stats/latency_p99_ms";
+inline constexpr const char* kStatsLatencyMaxAddress = "/synesthesia/stats/latency_max_ms";
+inline constexpr const char* kStatsJitterAddress = "/synesthesia/stats/jitter_ms";
+inline constexpr const char* kStatsFpsAddress = "/synesthesia/stats/fps";
+inline constexpr const char* kStatsFramesSentAddress = "/synesthesia/stats/frames_sent";
+inline constexpr const char* kStatsFramesCoalescedAddress = "/synesthesia/stats/frames_coalesced";
+inline constexpr const char* kStatsFramesDroppedAddress = "/synesthesia/stats/frames_dropped";
+inline constexpr const char* kStatsDestinationAddress = "/synesthesia/stats/destination";
+// The telemetry registry follows in the same bundle, one message per metric under this prefix
+// and its Utilities::Telemetry name: counters as int64, gauges as float, stages as <name>_ms
+// with three floats, the last, mean and peak pass, and memory as memory_<name>_bytes with two
+// int64s, the current and peak bytes.
+inline constexpr const char* kStatsTelemetryPrefix = "/synesthesia/stats/";
+
 inline constexpr const char* kControlSmoothingAddress = "/synesthesia/control/smoothing";
 inline constexpr const char* kControlSpectrumSmoothingAddress = "/synesthesia/control/spectrum_smoothing";
 inline constexpr const char* kControlColourSpaceAddress = "/synesthesia/control/colour_space";
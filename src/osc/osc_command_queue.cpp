@@ -1,17 +1,51 @@
 #include "osc_command_queue.h"
 
+#include <bit>
+#include <type_traits>
+
 namespace Synesthesia::OSC {
 
-void OSCCommandQueue::push(OSCCommand command) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    queue_.push_back(std::move(command));
+namespace {
+
+uint32_t encodePayload(const OSCCommand& command) {
+    return std::visit([](const auto& value) -> uint32_t {
+        using ValueType = std::decay_t<decltype(value)>;
+
+        if constexpr (std::is_same_v<ValueType, SetSmoothingEnabledCommand>) {
+            return value.enabled ? 1u : 0u;
+        } else if constexpr (std::is_same_v<ValueType, SetColourSmoothingSpeedCommand>) {
+            return std::bit_cast<uint32_t>(value.speed);
+        } else if constexpr (std::is_same_v<ValueType, SetSpectrumSmoothingCommand>) {
+            return std::bit_cast<uint32_t>(value.amount);
+        } else if constexpr (std::is_same_v<ValueType, SetColourSpaceCommand>) {
+            return static_cast<uint32_t>(value.colourSpace);
+        } else if constexpr (std::is_same_v<ValueType, SetGamutMappingCommand>) {
+            return value.enabled ? 1u : 0u;
+        }
+    }, command);
+}
+
+}
+
+void OSCCommandQueue::push(const OSCCommand& command) {
+    slots_[command.index()].store(kPendingBit | encodePayload(command), std::memory_order_release);
 }
 
-std::vector<OSCCommand> OSCCommandQueue::popAll() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<OSCCommand> commands = std::move(queue_);
-    queue_.clear();
-    return commands;
+OSCCommand OSCCommandQueue::decode(const std::size_t kind, const uint32_t payload) {
+    static_assert(kCommandKinds == 5, "Every OSCCommand alternative needs a case here");
+
+    switch (kind) {
+        case 0:
+            return SetSmoothingEnabledCommand{payload != 0};
+        case 1:
+            return SetColourSmoothingSpeedCommand{std::bit_cast<float>(payload)};
+        case 2:
+            return SetSpectrumSmoothingCommand{std::bit_cast<float>(payload)};
+        case 3:
+            return SetColourSpaceCommand{static_cast<ColourCore::ColourSpace>(payload)};
+        default:
+            return SetGamutMappingCommand{payload != 0};
+    }
 }
 
 }
@@ -2,19 +2,44 @@
 
 #include "osc_messages.h"
 
-#include <mutex>
-#include <vector>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <variant>
 
 namespace Synesthesia::OSC {
 
+// Keeps only the latest command of each kind, each in one atomic slot, so it is lock-free
+// for any number of receiving threads and never allocates. Fader spam between two drains
+// collapses to the last value, which is all PendingOSCSettings keeps anyway. Commands of
+// different kinds are not ordered against each other.
 class OSCCommandQueue {
 public:
-    void push(OSCCommand command);
-    std::vector<OSCCommand> popAll();
+    void push(const OSCCommand& command);
+
+    // Calls callback(const OSCCommand&) once for each kind pushed since the last drain.
+    template <typename Callback>
+    void drain(Callback&& callback) {
+        for (std::size_t kind = 0; kind < kCommandKinds; ++kind) {
+            if (slots_[kind].load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            const uint64_t slot = slots_[kind].exchange(0, std::memory_order_acquire);
+            if ((slot & kPendingBit) != 0) {
+                callback(decode(kind, static_cast<uint32_t>(slot)));
+            }
+        }
+    }
 
 private:
-    std::mutex mutex_;
-    std::vector<OSCCommand> queue_;
+    static constexpr std::size_t kCommandKinds = std::variant_size_v<OSCCommand>;
+    static constexpr uint64_t kPendingBit = uint64_t{1} << 32;
+
+    static OSCCommand decode(std::size_t kind, uint32_t payload);
+
+    // The pending bit above a 32-bit payload; zero when nothing is waiting.
+    std::array<std::atomic<uint64_t>, kCommandKinds> slots_{};
 };
 
 }
@@ -80,6 +80,10 @@ bool isPrivateOrLoopbackIPv4(const std::array<uint8_t, 4>& octets) {
     return false;
 }
 
+bool isScopedMulticastIPv4(const std::array<uint8_t, 4>& octets) {
+    return octets[0] == 239;
+}
+
 }  // namespace
 
 OSCDestinationValidationResult validateOSCDestination(const std::string& destinationHost) {
@@ -97,8 +101,9 @@ OSCDestinationValidationResult validateOSCDestination(const std::string& destina
         return result;
     }
 
-    if (!isPrivateOrLoopbackIPv4(octets)) {
-        result.errorMessage = "Destination must be loopback or RFC1918 private IPv4";
+    result.multicast = isScopedMulticastIPv4(octets);
+    if (!result.multicast && !isPrivateOrLoopbackIPv4(octets)) {
+        result.errorMessage = "Destination must be loopback, RFC1918 private or 239.x multicast IPv4";
         return result;
     }
 
@@ -117,4 +122,16 @@ OSCDestinationValidationResult validateOSCDestination(const std::string& destina
     return result;
 }
 
+bool normaliseOSCDestinations(std::vector<OSCDestination>& destinations, std::string& errorMessage) {
+    for (OSCDestination& destination : destinations) {
+        const auto validation = validateOSCDestination(destination.host);
+        if (!validation.valid) {
+            errorMessage = validation.errorMessage + " (" + destination.host + ")";
+            return false;
+        }
+        destination.host = validation.canonicalHost;
+    }
+    return true;
+}
+
 }
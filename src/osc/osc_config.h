@@ -3,25 +3,95 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Synesthesia::OSC {
 
 inline constexpr const char* kLoopbackHost = "127.0.0.1";
+inline constexpr float kMaxPresentationLatencyMs = 1000.0f;
+
+enum class OSCFrameFormat {
+    Named,   // A bundle of one message per value, each at its own address
+    Packed   // A single kFramePackedAddress message
+};
+
+enum class OSCSpectrumLayout {
+    Bins,           // Every FFT bin
+    CriticalBands   // FFTProcessor::buildCriticalBands, the peak bin of each band
+};
+
+enum class OSCSpectrumPrecision {
+    UInt8,
+    UInt16
+};
+
+// Spectrum blobs are sent at up to rateHz, independently of the frame rate. Levels are
+// quantised on a dB scale, from floorDb at zero to 0 dBFS at the top of the range.
+struct OSCSpectrumConfig {
+    bool enabled = false;
+    OSCSpectrumLayout layout = OSCSpectrumLayout::CriticalBands;
+    std::size_t bandCount = 32;
+    OSCSpectrumPrecision precision = OSCSpectrumPrecision::UInt8;
+    float rateHz = 30.0f;
+    float floorDb = -90.0f;
+
+    bool operator==(const OSCSpectrumConfig&) const = default;
+};
+
+// Peak tracks are each frame's maxPeaks strongest partials, linked from frame to frame by
+// PhaseReconstruction::PeakTracker. Every frame is tracked; they are sent at up to rateHz,
+// or with every frame at 0.
+struct OSCPeakTrackConfig {
+    bool enabled = false;
+    std::size_t maxPeaks = 16;
+    float rateHz = 0.0f;
+
+    bool operator==(const OSCPeakTrackConfig&) const = default;
+};
+
+// A receiver beyond the primary destination. A multicast group reaches every receiver that
+// has joined it with a single send.
+struct OSCDestination {
+    std::string host = kLoopbackHost;
+    uint16_t port = 7000;
+    OSCFrameFormat frameFormat = OSCFrameFormat::Named;
+    float maxRateHz = 0.0f;  // 0 sends every frame
+
+    bool operator==(const OSCDestination&) const = default;
+};
 
 struct OSCConfig {
     std::string destinationHost = kLoopbackHost;
     uint16_t transmitPort = 7000;
     uint16_t receivePort = 7001;
-    std::size_t outputBufferSize = 4096;
+    // Named frames are split into bundles no larger than this. The default is the UDP
+    // payload of a 1500-byte Ethernet frame, so frames are never IP-fragmented.
+    std::size_t maxPacketSize = 1472;
+    OSCFrameFormat frameFormat = OSCFrameFormat::Named;
+    OSCSpectrumConfig spectrum;
+    OSCPeakTrackConfig peaks;
+    std::vector<OSCDestination> additionalDestinations;
+    float statsIntervalSeconds = 1.0f;  // 0 stops /synesthesia/stats/* messages
+    // Above zero, frames and spectra are sent in bundles time-tagged this long after the
+    // frame's capture time, so receivers that honour time tags present each one at a fixed
+    // delay from the audio rather than whenever the UI loop and the network deliver it.
+    // Zero tags them for immediate use. Clamped to kMaxPresentationLatencyMs.
+    float presentationLatencyMs = 0.0f;
 };
 
 struct OSCDestinationValidationResult {
     bool valid = false;
+    bool multicast = false;
     uint32_t address = 0;
     std::string canonicalHost;
     std::string errorMessage;
 };
 
+// Accepts loopback, RFC1918 private and administratively scoped (239.0.0.0/8) multicast
+// IPv4 literals, so frames never leave the local network.
 OSCDestinationValidationResult validateOSCDestination(const std::string& destinationHost);
 
+// Validates every additional destination and rewrites its host in canonical form.
+bool normaliseOSCDestinations(std::vector<OSCDestination>& destinations, std::string& errorMessage);
+
 }
@@ -63,13 +63,6 @@ float interpolatePhase(const std::span<const float> magnitudes,
     return std::fmod(interpolatedPhase + std::numbers::pi_v<float>, twoPi) - std::numbers::pi_v<float>;
 }
 
-int64_t currentTimestampMicros() {
-    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()
-    ).count();
-    return static_cast<int64_t>(std::max(now, static_cast<decltype(now)>(0)));
-}
-
 int32_t resolveFftSize(const std::span<const float> magnitudes) {
     return magnitudes.size() > 1
         ? static_cast<int32_t>((magnitudes.size() - 1) * 2)
@@ -78,6 +71,13 @@ int32_t resolveFftSize(const std::span<const float> magnitudes) {
 
 }
 
+int64_t currentTimestampMicros() {
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+    return static_cast<int64_t>(std::max(now, static_cast<decltype(now)>(0)));
+}
+
 OSCAnalysisSignals buildAnalysisSignals(const AudioProcessor::SpectralData& spectralData) {
     return buildAnalysisSignals(
         spectralData.momentaryLoudnessLUFS,
@@ -118,7 +118,9 @@ OSCFrameData buildFrameData(const OSCFrameUpdate& update) {
         update.sampleRate);
     frame.meta.sampleRate = static_cast<int32_t>(update.sampleRate);
     frame.meta.fftSize = resolveFftSize(update.magnitudes);
-    frame.meta.frameTimestamp = currentTimestampMicros();
+    frame.meta.frameTimestamp = update.captureTimestampMicros > 0
+        ? update.captureTimestampMicros
+        : currentTimestampMicros();
 
     frame.signal.dominantFrequencyHz = update.colourResult.dominantFrequency;
     frame.signal.dominantWavelengthNm = update.colourResult.dominantWavelength;
@@ -25,8 +25,14 @@ struct OSCFrameUpdate {
     ColourCore::RGB displayColour{};
     OSCAnalysisSignals analysisSignals{};
     OSCSmoothingSignals smoothingSignals{};
+    // The frame's audio capture time on the currentTimestampMicros clock; 0 stamps it with
+    // the time it is built instead.
+    int64_t captureTimestampMicros = 0;
 };
 
+// The clock frame timestamps are taken from.
+int64_t currentTimestampMicros();
+
 OSCAnalysisSignals buildAnalysisSignals(const AudioProcessor::SpectralData& spectralData);
 OSCAnalysisSignals buildAnalysisSignals(float momentaryLoudnessLUFS,
                                         float spectralFlux,
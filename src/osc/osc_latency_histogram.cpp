@@ -0,0 +1,77 @@
+#include "osc_latency_histogram.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace Synesthesia::OSC {
+
+std::size_t OSCLatencyHistogram::bucketFor(const uint64_t micros) {
+    if (micros < kLinearBuckets) {
+        return static_cast<std::size_t>(micros);
+    }
+    // Octave of the value past the linear range, then its next two bits below the top one.
+    const auto octave = static_cast<std::size_t>(std::bit_width(micros) - 1) - 4;
+    const auto subBucket = static_cast<std::size_t>((micros >> (octave + 2)) & (kSubBucketsPerOctave - 1));
+    return std::min(kLinearBuckets + octave * kSubBucketsPerOctave + subBucket, kBucketCount - 1);
+}
+
+uint64_t OSCLatencyHistogram::bucketMidpoint(const std::size_t bucket) {
+    if (bucket < kLinearBuckets) {
+        return bucket;
+    }
+    const std::size_t octave = (bucket - kLinearBuckets) / kSubBucketsPerOctave;
+    const std::size_t subBucket = (bucket - kLinearBuckets) % kSubBucketsPerOctave;
+    const uint64_t octaveStart = uint64_t{16} << octave;
+    const uint64_t subBucketWidth = octaveStart / kSubBucketsPerOctave;
+    return octaveStart + subBucket * subBucketWidth + subBucketWidth / 2;
+}
+
+void OSCLatencyHistogram::record(const int64_t micros) {
+    const uint64_t value = micros > 0 ? static_cast<uint64_t>(micros) : 0;
+    buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t previousMax = maxMicros_.load(std::memory_order_relaxed);
+    while (value > previousMax &&
+           !maxMicros_.compare_exchange_weak(previousMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+void OSCLatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    maxMicros_.store(0, std::memory_order_relaxed);
+}
+
+OSCLatencySummary OSCLatencyHistogram::summarise() const {
+    std::array<uint64_t, kBucketCount> counts{};
+    OSCLatencySummary summary;
+    for (std::size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+        counts[bucket] = buckets_[bucket].load(std::memory_order_relaxed);
+        summary.count += counts[bucket];
+    }
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    const uint64_t maxMicros = maxMicros_.load(std::memory_order_relaxed);
+    const auto percentileMs = [&counts, &summary, maxMicros](const double fraction) {
+        const auto rank = static_cast<uint64_t>(fraction * static_cast<double>(summary.count - 1)) + 1;
+        uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+            seen += counts[bucket];
+            if (seen >= rank) {
+                return static_cast<float>(std::min(bucketMidpoint(bucket), maxMicros)) / 1000.0f;
+            }
+        }
+        return static_cast<float>(maxMicros) / 1000.0f;
+    };
+
+    summary.p50Ms = percentileMs(0.50);
+    summary.p95Ms = percentileMs(0.95);
+    summary.p99Ms = percentileMs(0.99);
+    summary.maxMs = static_cast<float>(maxMicros) / 1000.0f;
+    return summary;
+}
+
+}
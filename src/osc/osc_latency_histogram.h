@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Synesthesia::OSC {
+
+struct OSCLatencySummary {
+    uint64_t count = 0;
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float maxMs = 0.0f;
+};
+
+// Log-bucketed histogram of microsecond latencies, four buckets per octave, so percentiles
+// are within about 12% of the true value. One thread records while any thread summarises,
+// all without locks; a summary taken mid-record may miss that one sample.
+class OSCLatencyHistogram {
+public:
+    void record(int64_t micros);
+    void reset();
+    OSCLatencySummary summarise() const;
+
+private:
+    static constexpr std::size_t kLinearBuckets = 16;
+    static constexpr std::size_t kSubBucketsPerOctave = 4;
+    static constexpr std::size_t kOctaves = 21;  // Up to about 33 seconds
+    static constexpr std::size_t kBucketCount = kLinearBuckets + kOctaves * kSubBucketsPerOctave;
+
+    static std::size_t bucketFor(uint64_t micros);
+    static uint64_t bucketMidpoint(std::size_t bucket);
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> maxMicros_{0};
+};
+
+}
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "colour/colour_core.h"
+#include "resyne/encoding/reconstruction/peak_tracking.h"
 
 #include <cstdint>
 #include <optional>
+#include <string>
 #include <variant>
+#include <vector>
 
 namespace Synesthesia::OSC {
 
@@ -89,11 +92,39 @@ struct OSCFrameData {
     OSCSmoothingFeatureData smoothing;
 };
 
+struct OSCSpectrumData {
+    OSCFrameMetaData meta;
+    std::vector<float> magnitudes;
+};
+
+struct OSCPeakTrackData {
+    OSCFrameMetaData meta;
+    std::vector<PhaseReconstruction::TrackedPeak> peaks;
+};
+
+struct OSCDestinationStats {
+    std::string host;
+    uint16_t port = 0;
+    uint64_t bytesSent = 0;
+    float bytesPerSecond = 0.0f;
+};
+
 struct OSCStats {
     uint64_t framesSent = 0;
     uint64_t messagesReceived = 0;
     uint32_t currentFps = 0;
     float averageSendTimeMs = 0.0f;
+    uint64_t framesCoalesced = 0;  // Replaced by a newer frame before the sender got to them
+    uint64_t framesDropped = 0;    // Failed to send, or still waiting when the runtime stopped
+
+    // From frameTimestamp to the last socket send, since the runtime started.
+    float latencyP50Ms = 0.0f;
+    float latencyP95Ms = 0.0f;
+    float latencyP99Ms = 0.0f;
+    float latencyMaxMs = 0.0f;
+    // RFC 3550 interarrival jitter of sends against frame timestamps.
+    float jitterMs = 0.0f;
+    std::vector<OSCDestinationStats> destinations;  // The primary destination first
 };
 
 struct SetSmoothingEnabledCommand {
@@ -1,10 +1,22 @@
 #include "osc_runtime.h"
 
+#include "utilities/telemetry/latency_probe.h"
+#include "utilities/telemetry/telemetry.h"
+#include "utilities/threading/realtime_thread.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
 namespace Synesthesia::OSC {
 
 OSCRuntime::OSCRuntime(const OSCConfig& config)
     : config_(config), receiver_(commandQueue_) {}
 
+OSCRuntime::~OSCRuntime() {
+    stop();
+}
+
 bool OSCRuntime::start() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (running_) {
@@ -27,11 +39,18 @@ bool OSCRuntime::start() {
     fpsWindowStart_ = std::chrono::steady_clock::now();
     framesInWindow_ = 0;
     currentFps_ = 0;
+    jitterMs_ = 0.0f;
+    previousSentMicros_ = 0;
+    latency_.reset();
     lastError_.clear();
+    startSenderThread();
     return true;
 }
 
 void OSCRuntime::stop() {
+    // The sender thread records its samples under mutex_, so it is joined before taking it.
+    stopSenderThread();
+
     std::lock_guard<std::mutex> lock(mutex_);
     if (!running_) {
         sender_.reset();
@@ -62,6 +81,15 @@ bool OSCRuntime::updateConfig(const OSCConfig& config) {
 
     OSCConfig normalisedConfig = config;
     normalisedConfig.destinationHost = destination.canonicalHost;
+    normalisedConfig.presentationLatencyMs = std::isfinite(config.presentationLatencyMs)
+        ? std::clamp(config.presentationLatencyMs, 0.0f, kMaxPresentationLatencyMs)
+        : 0.0f;
+    std::string destinationError;
+    if (!normaliseOSCDestinations(normalisedConfig.additionalDestinations, destinationError)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_ = destinationError;
+        return false;
+    }
 
     const bool wasRunning = isRunning();
     {
@@ -83,50 +111,248 @@ OSCConfig OSCRuntime::getConfig() const {
     return config_;
 }
 
+float OSCRuntime::getPresentationLatencyMs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_ ? config_.presentationLatencyMs : 0.0f;
+}
+
 std::string OSCRuntime::getLastError() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return lastError_;
 }
 
-void OSCRuntime::sendFrame(const OSCFrameData& frame) {
-    auto startTime = std::chrono::steady_clock::now();
-
+void OSCRuntime::sendFrame(const OSCFrameData& frame,
+                           const std::span<const float> magnitudes,
+                           const std::span<const float> phases) {
+    std::unique_lock<std::mutex> peakLock(peakTrackerMutex_, std::defer_lock);
+    const std::size_t peakCount = peakTrackCount_.load(std::memory_order_relaxed);
+    if (peakCount > 0 && !magnitudes.empty()) {
+        peakLock.lock();
+        if (peakTracker_.maxPeaks() != peakCount) {
+            peakTracker_ = PhaseReconstruction::PeakTracker(peakCount);
+        }
+        const float binSpacingHz = frame.meta.fftSize > 0
+            ? static_cast<float>(frame.meta.sampleRate) / static_cast<float>(frame.meta.fftSize)
+            : 0.0f;
+        peakTracker_.track(magnitudes, phases, binSpacingHz, trackedPeaks_);
+    }
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (!running_) {
+        std::lock_guard<std::mutex> lock(mailboxMutex_);
+        if (!senderRunning_) {
             return;
         }
-    }
+        if (pendingFrame_.has_value()) {
+            ++framesCoalesced_;
+            Utilities::Telemetry::increment(Utilities::Telemetry::Counter::OSCFramesCoalesced);
+        }
+        pendingFrame_ = frame;
 
-    if (!sender_.sendFrame(frame)) {
-        return;
+        const auto now = std::chrono::steady_clock::now();
+        if (spectrumEnabled_ && !magnitudes.empty() && now >= nextSpectrumTime_) {
+            pendingSpectrum_.meta = frame.meta;
+            pendingSpectrum_.magnitudes.assign(magnitudes.begin(), magnitudes.end());
+            spectrumPending_ = true;
+            nextSpectrumTime_ = now + spectrumInterval_;
+        }
+        if (peakLock.owns_lock() && now >= nextPeaksTime_) {
+            pendingPeaks_.meta = frame.meta;
+            pendingPeaks_.peaks.assign(trackedPeaks_.begin(), trackedPeaks_.end());
+            peaksPending_ = true;
+            nextPeaksTime_ = now + peaksInterval_;
+        }
     }
+    mailboxChanged_.notify_one();
+}
 
-    const auto endTime = std::chrono::steady_clock::now();
-    const float durationMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
-    recordSendSample(durationMs);
+void OSCRuntime::waitForPendingFrame() {
+    std::unique_lock<std::mutex> lock(mailboxMutex_);
+    frameTaken_.wait(lock, [this] { return !senderRunning_ || !pendingFrame_.has_value(); });
 }
 
-std::vector<OSCCommand> OSCRuntime::popPendingCommands() {
-    return commandQueue_.popAll();
+PendingOSCSettings OSCRuntime::consumePendingSettings() {
+    PendingOSCSettings pendingSettings;
+    drainPendingCommands([&pendingSettings](const OSCCommand& command) {
+        std::visit([&pendingSettings](const auto& value) {
+            using ValueType = std::decay_t<decltype(value)>;
+
+            if constexpr (std::is_same_v<ValueType, SetSmoothingEnabledCommand>) {
+                pendingSettings.smoothingEnabled = value.enabled;
+            } else if constexpr (std::is_same_v<ValueType, SetColourSmoothingSpeedCommand>) {
+                pendingSettings.colourSmoothingSpeed = value.speed;
+            } else if constexpr (std::is_same_v<ValueType, SetSpectrumSmoothingCommand>) {
+                pendingSettings.spectrumSmoothingAmount = value.amount;
+            } else if constexpr (std::is_same_v<ValueType, SetColourSpaceCommand>) {
+                pendingSettings.colourSpace = value.colourSpace;
+            } else if constexpr (std::is_same_v<ValueType, SetGamutMappingCommand>) {
+                pendingSettings.gamutMappingEnabled = value.enabled;
+            }
+        }, command);
+    });
+
+    return pendingSettings;
 }
 
 OSCStats OSCRuntime::getStats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return OSCStats{
-        framesSent_,
-        receiver_.getReceivedMessageCount(),
-        currentFps_,
-        averageSendTimeMs_
-    };
+    OSCStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.framesSent = framesSent_;
+        stats.messagesReceived = receiver_.getReceivedMessageCount();
+        stats.currentFps = currentFps_;
+        stats.averageSendTimeMs = averageSendTimeMs_;
+        stats.jitterMs = jitterMs_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mailboxMutex_);
+        stats.framesCoalesced = framesCoalesced_;
+        stats.framesDropped = framesDropped_;
+    }
+    const OSCLatencySummary latency = latency_.summarise();
+    stats.latencyP50Ms = latency.p50Ms;
+    stats.latencyP95Ms = latency.p95Ms;
+    stats.latencyP99Ms = latency.p99Ms;
+    stats.latencyMaxMs = latency.maxMs;
+    stats.destinations = sender_.getDestinationStats();
+    return stats;
+}
+
+void OSCRuntime::startSenderThread() {
+    {
+        std::lock_guard<std::mutex> lock(mailboxMutex_);
+        senderRunning_ = true;
+        spectrumEnabled_ = config_.spectrum.enabled && config_.spectrum.rateHz > 0.0f;
+        spectrumInterval_ = spectrumEnabled_
+            ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<float>(1.0f / config_.spectrum.rateHz))
+            : std::chrono::steady_clock::duration{};
+        nextSpectrumTime_ = std::chrono::steady_clock::now();
+        peaksInterval_ = config_.peaks.rateHz > 0.0f
+            ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<float>(1.0f / config_.peaks.rateHz))
+            : std::chrono::steady_clock::duration{};
+        nextPeaksTime_ = nextSpectrumTime_;
+    }
+    {
+        // A restart begins new tracks rather than continuing ones from before it.
+        std::lock_guard<std::mutex> lock(peakTrackerMutex_);
+        peakTracker_.reset();
+        peakTrackCount_.store(config_.peaks.enabled ? std::max<std::size_t>(config_.peaks.maxPeaks, 1) : 0,
+                              std::memory_order_relaxed);
+    }
+    statsInterval_ = config_.statsIntervalSeconds > 0.0f
+        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<float>(config_.statsIntervalSeconds))
+        : std::chrono::steady_clock::duration{};
+    senderThread_ = std::thread(&OSCRuntime::runSender, this);
+}
+
+void OSCRuntime::stopSenderThread() {
+    peakTrackCount_.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mailboxMutex_);
+        senderRunning_ = false;
+    }
+    mailboxChanged_.notify_all();
+    frameTaken_.notify_all();
+    if (senderThread_.joinable()) {
+        senderThread_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mailboxMutex_);
+    if (pendingFrame_.has_value()) {
+        ++framesDropped_;
+        Utilities::Telemetry::increment(Utilities::Telemetry::Counter::OSCFramesDropped);
+        pendingFrame_.reset();
+    }
+    spectrumPending_ = false;
+    peaksPending_ = false;
 }
 
-void OSCRuntime::recordSendSample(const float durationMs) {
+void OSCRuntime::runSender() {
+    Utilities::Threading::configureCurrentThread(Utilities::Threading::ThreadRole::OSCSender);
+    OSCSpectrumData spectrum;
+    OSCPeakTrackData peaks;
+    auto nextStatsTime = std::chrono::steady_clock::now() + statsInterval_;
+    for (;;) {
+        std::optional<OSCFrameData> frame;
+        bool hasSpectrum = false;
+        bool hasPeaks = false;
+        {
+            std::unique_lock<std::mutex> lock(mailboxMutex_);
+            mailboxChanged_.wait(lock, [this] {
+                return !senderRunning_ || pendingFrame_.has_value() || spectrumPending_ || peaksPending_;
+            });
+            if (!senderRunning_) {
+                return;
+            }
+            frame.swap(pendingFrame_);
+            if (spectrumPending_) {
+                // Swapping hands the last spectrum's storage back for the next copy.
+                std::swap(spectrum, pendingSpectrum_);
+                spectrumPending_ = false;
+                hasSpectrum = true;
+            }
+            if (peaksPending_) {
+                std::swap(peaks, pendingPeaks_);
+                peaksPending_ = false;
+                hasPeaks = true;
+            }
+        }
+
+        if (frame.has_value()) {
+            frameTaken_.notify_all();
+            const auto startTime = std::chrono::steady_clock::now();
+            if (sender_.sendFrame(*frame)) {
+                const auto endTime = std::chrono::steady_clock::now();
+                Utilities::Telemetry::record(Utilities::Telemetry::Stage::OSCSend, endTime - startTime);
+                const int64_t sentMicros =
+                    std::chrono::duration_cast<std::chrono::microseconds>(endTime.time_since_epoch()).count();
+                recordSendSample(std::chrono::duration<float, std::milli>(endTime - startTime).count(),
+                                 frame->meta.frameTimestamp,
+                                 sentMicros);
+                Utilities::Telemetry::LatencyProbe::frameReached(
+                    Utilities::Telemetry::LatencyProbe::Stage::OSCSend, frame->meta.frameTimestamp);
+            } else {
+                std::lock_guard<std::mutex> lock(mailboxMutex_);
+                ++framesDropped_;
+                Utilities::Telemetry::increment(Utilities::Telemetry::Counter::OSCFramesDropped);
+            }
+        }
+        if (hasSpectrum) {
+            sender_.sendSpectrum(spectrum);
+        }
+        if (hasPeaks) {
+            sender_.sendPeaks(peaks);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (statsInterval_.count() > 0 && now >= nextStatsTime) {
+            sender_.sendStats(getStats(), Utilities::Telemetry::snapshot());
+            nextStatsTime = now + statsInterval_;
+        }
+    }
+}
+
+void OSCRuntime::recordSendSample(const float durationMs,
+                                  const int64_t frameTimestampMicros,
+                                  const int64_t sentMicros) {
+    // Frame timestamps come from the same steady clock as sentMicros.
+    latency_.record(sentMicros - frameTimestampMicros);
+
     std::lock_guard<std::mutex> lock(mutex_);
     if (!running_) {
         return;
     }
 
+    if (previousSentMicros_ != 0) {
+        const int64_t deviation = (sentMicros - previousSentMicros_) -
+                                (frameTimestampMicros - previousFrameTimestampMicros_);
+        const float deviationMs = static_cast<float>(deviation < 0 ? -deviation : deviation) / 1000.0f;
+        jitterMs_ += (deviationMs - jitterMs_) / 16.0f;
+    }
+    previousSentMicros_ = sentMicros;
+    previousFrameTimestampMicros_ = frameTimestampMicros;
+
     ++framesSent_;
     ++framesInWindow_;
 
@@ -2,21 +2,34 @@
 
 #include "osc_command_queue.h"
 #include "osc_config.h"
+#include "osc_latency_histogram.h"
 #include "osc_messages.h"
 #include "osc_receiver.h"
 #include "osc_sender.h"
 
+#include "resyne/encoding/reconstruction/peak_tracking.h"
+
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
-#include <vector>
+#include <thread>
+#include <utility>
 
 namespace Synesthesia::OSC {
 
 class OSCRuntime {
 public:
     explicit OSCRuntime(const OSCConfig& config = {});
+    ~OSCRuntime();
+
+    OSCRuntime(const OSCRuntime&) = delete;
+    OSCRuntime& operator=(const OSCRuntime&) = delete;
 
     bool start();
     void stop();
@@ -24,14 +37,35 @@ public:
 
     bool updateConfig(const OSCConfig& config);
     OSCConfig getConfig() const;
+    // The configured presentation latency while running, otherwise 0.
+    float getPresentationLatencyMs() const;
     std::string getLastError() const;
 
-    void sendFrame(const OSCFrameData& frame);
-    std::vector<OSCCommand> popPendingCommands();
+    // Hands the frame to the sender thread and returns at once. Only the most recent frame
+    // is kept, so a slow network send skips stale frames rather than queueing them. The
+    // magnitudes are only copied when spectrum streaming is on and a spectrum is due. With
+    // peak tracks on, every frame's magnitudes and phases go through the tracker here,
+    // so tracks stay linked across frames that are coalesced or over the peak rate.
+    void sendFrame(const OSCFrameData& frame,
+                   std::span<const float> magnitudes = {},
+                   std::span<const float> phases = {});
+    // Blocks until the sender thread has taken the waiting frame, if there is one, so a
+    // producer that must not lose frames can call this before each sendFrame.
+    void waitForPendingFrame();
+    // Hands each command received since the last call to callback(const OSCCommand&).
+    template <typename Callback>
+    void drainPendingCommands(Callback&& callback) {
+        commandQueue_.drain(std::forward<Callback>(callback));
+    }
+    // Drains the pending commands, keeping the latest value of each setting.
+    PendingOSCSettings consumePendingSettings();
     OSCStats getStats() const;
 
 private:
-    void recordSendSample(float durationMs);
+    void startSenderThread();
+    void stopSenderThread();
+    void runSender();
+    void recordSendSample(float durationMs, int64_t frameTimestampMicros, int64_t sentMicros);
 
     mutable std::mutex mutex_;
     OSCConfig config_;
@@ -44,7 +78,36 @@ private:
     float averageSendTimeMs_ = 0.0f;
     uint32_t framesInWindow_ = 0;
     std::chrono::steady_clock::time_point fpsWindowStart_{};
+    float jitterMs_ = 0.0f;
+    int64_t previousFrameTimestampMicros_ = 0;
+    int64_t previousSentMicros_ = 0;
     std::string lastError_;
+    OSCLatencyHistogram latency_;
+
+    std::thread senderThread_;
+    std::chrono::steady_clock::duration statsInterval_{};  // Set before the sender thread starts
+    mutable std::mutex mailboxMutex_;
+    std::condition_variable mailboxChanged_;
+    std::condition_variable frameTaken_;
+    std::optional<OSCFrameData> pendingFrame_;  // Protected by mailboxMutex_
+    bool senderRunning_ = false;                // Protected by mailboxMutex_
+    uint64_t framesCoalesced_ = 0;              // Protected by mailboxMutex_
+    uint64_t framesDropped_ = 0;                // Protected by mailboxMutex_
+    OSCSpectrumData pendingSpectrum_;           // Protected by mailboxMutex_
+    bool spectrumPending_ = false;              // Protected by mailboxMutex_
+    bool spectrumEnabled_ = false;              // Protected by mailboxMutex_
+    std::chrono::steady_clock::duration spectrumInterval_{};           // Protected by mailboxMutex_
+    std::chrono::steady_clock::time_point nextSpectrumTime_{};         // Protected by mailboxMutex_
+    OSCPeakTrackData pendingPeaks_;             // Protected by mailboxMutex_
+    bool peaksPending_ = false;                 // Protected by mailboxMutex_
+    std::chrono::steady_clock::duration peaksInterval_{};              // Protected by mailboxMutex_
+    std::chrono::steady_clock::time_point nextPeaksTime_{};            // Protected by mailboxMutex_
+
+    // Taken before mailboxMutex_ when both are held.
+    std::mutex peakTrackerMutex_;
+    std::atomic<std::size_t> peakTrackCount_{0};  // 0 while peak tracks are off
+    PhaseReconstruction::PeakTracker peakTracker_;                     // Protected by peakTrackerMutex_
+    std::vector<PhaseReconstruction::TrackedPeak> trackedPeaks_;      // Protected by peakTrackerMutex_
 };
 
 }
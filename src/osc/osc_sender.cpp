@@ -2,92 +2,219 @@
 
 #include "osc_addresses.h"
 
+#include "audio/analysis/fft/fft_processor.h"
+#include "utilities/profiling/frame_profiler.h"
 #include "ip/UdpSocket.h"
 #include "osc/OscOutboundPacketStream.h"
 #include "osc/OscTypes.h"
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <optional>
+
 namespace Synesthesia::OSC {
 
 namespace {
 
-void appendFloatValue(osc::OutboundPacketStream& packet, const char* address, const float value) {
-    packet << osc::BeginMessage(address)
-           << value
-           << osc::EndMessage;
+constexpr std::size_t kBundleHeaderSize = 16;     // "#bundle" and the time tag
+constexpr std::size_t kBundleElementPrefix = 4;   // Each element's size
+// oscpack builds type tags at the far end of the buffer, so it wants a little room to spare.
+constexpr std::size_t kPacketSlack = 16;
+// Headroom for the spectrum message's address, type tags and scalar arguments.
+constexpr std::size_t kSpectrumMessageOverhead = 256;
+// The same for the peak message, whose blob holds 16 bytes a peak.
+constexpr std::size_t kPeaksMessageOverhead = 128;
+constexpr std::size_t kPeakBytes = 16;
+// What a single message costs once it is wrapped in a bundle of its own.
+constexpr std::size_t kWrappedMessageOverhead = kBundleHeaderSize + kBundleElementPrefix;
+
+constexpr osc::uint64 kImmediateTimeTag = 1;
+constexpr int64_t kNtpToUnixEpochSeconds = 2208988800;
+
+// OSC strings are null-terminated and padded to four bytes.
+std::size_t paddedStringSize(const std::size_t length) {
+    return (length + 4) & ~std::size_t{3};
+}
+
+constexpr std::size_t argumentSize(float) { return 4; }
+constexpr std::size_t argumentSize(int32_t) { return 4; }
+constexpr std::size_t argumentSize(int64_t) { return 8; }
+constexpr std::size_t argumentSize(bool) { return 0; }  // T and F carry no data
+
+template <typename Value>
+std::size_t valueMessageSize(const char* address, const Value value) {
+    return paddedStringSize(std::strlen(address)) + paddedStringSize(2) + argumentSize(value);
 }
 
-void appendInt32Value(osc::OutboundPacketStream& packet, const char* address, const int32_t value) {
-    packet << osc::BeginMessage(address)
-           << static_cast<osc::int32>(value)
-           << osc::EndMessage;
+void appendArgument(osc::OutboundPacketStream& packet, const float value) {
+    packet << value;
 }
 
-void appendInt64Value(osc::OutboundPacketStream& packet, const char* address, const int64_t value) {
-    packet << osc::BeginMessage(address)
-           << static_cast<osc::int64>(value)
-           << osc::EndMessage;
+void appendArgument(osc::OutboundPacketStream& packet, const int32_t value) {
+    packet << static_cast<osc::int32>(value);
 }
 
-void appendBoolValue(osc::OutboundPacketStream& packet, const char* address, const bool value) {
-    packet << osc::BeginMessage(address)
-           << value
-           << osc::EndMessage;
+void appendArgument(osc::OutboundPacketStream& packet, const int64_t value) {
+    packet << static_cast<osc::int64>(value);
 }
 
-void appendNamedValueMessages(osc::OutboundPacketStream& packet, const OSCFrameData& frame) {
-    appendInt32Value(packet, kFrameMetaSampleRateAddress, frame.meta.sampleRate);
-    appendInt32Value(packet, kFrameMetaFftSizeAddress, frame.meta.fftSize);
-    appendInt64Value(packet, kFrameMetaTimestampAddress, frame.meta.frameTimestamp);
+void appendArgument(osc::OutboundPacketStream& packet, const bool value) {
+    packet << value;
+}
+
+template <typename Value>
+void appendValueMessage(osc::OutboundPacketStream& packet, const char* address, const Value value) {
+    packet << osc::BeginMessage(address);
+    appendArgument(packet, value);
+    packet << osc::EndMessage;
+}
 
-    appendFloatValue(packet, kFrameSignalDominantFrequencyAddress, frame.signal.dominantFrequencyHz);
-    appendFloatValue(packet, kFrameSignalDominantWavelengthAddress, frame.signal.dominantWavelengthNm);
-    appendFloatValue(packet, kFrameSignalVisualiserMagnitudeAddress, frame.signal.visualiserMagnitude);
-    appendFloatValue(packet, kFrameSignalPhaseRadiansAddress, frame.signal.phaseRadians);
+// OSC time tags are NTP time, seconds since 1900 in the high word and the fraction in the low.
+// The frame clock is steady, so the instant is carried onto the system clock through the
+// offset between the two now.
+osc::uint64 timeTagAt(const int64_t steadyMicros) {
+    const auto steadyNow = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const auto systemNow = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t unixMicros = static_cast<int64_t>(systemNow) + steadyMicros - static_cast<int64_t>(steadyNow);
+    const auto seconds = static_cast<osc::uint64>(unixMicros / 1'000'000 + kNtpToUnixEpochSeconds);
+    const auto fraction = (static_cast<osc::uint64>(unixMicros % 1'000'000) << 32) / 1'000'000;
+    return (seconds << 32) | fraction;
+}
 
-    appendFloatValue(packet, kFrameColourDisplayRAddress, frame.colour.displayR);
-    appendFloatValue(packet, kFrameColourDisplayGAddress, frame.colour.displayG);
-    appendFloatValue(packet, kFrameColourDisplayBAddress, frame.colour.displayB);
-    appendFloatValue(packet, kFrameColourCIEXAddress, frame.colour.cieX);
-    appendFloatValue(packet, kFrameColourCIEYAddress, frame.colour.cieY);
-    appendFloatValue(packet, kFrameColourCIEZAddress, frame.colour.cieZ);
-    appendFloatValue(packet, kFrameColourOklabLAddress, frame.colour.oklabL);
-    appendFloatValue(packet, kFrameColourOklabAAddress, frame.colour.oklabA);
-    appendFloatValue(packet, kFrameColourOklabBAddress, frame.colour.oklabB);
+// When a receiver should present the frame stamped frameTimestamp.
+osc::uint64 presentationTimeTag(const OSCConfig& config, const int64_t frameTimestamp) {
+    if (config.presentationLatencyMs <= 0.0f) {
+        return kImmediateTimeTag;
+    }
+    return timeTagAt(frameTimestamp + static_cast<int64_t>(std::lround(config.presentationLatencyMs * 1000.0f)));
+}
 
-    appendFloatValue(packet, kFrameAnalysisSpectralFlatnessAddress, frame.spectral.flatness);
-    appendFloatValue(packet, kFrameAnalysisSpectralCentroidAddress, frame.spectral.centroidHz);
-    appendFloatValue(packet, kFrameAnalysisSpectralSpreadAddress, frame.spectral.spreadHz);
-    appendFloatValue(packet, kFrameAnalysisSpectralSpreadNormalisedAddress, frame.spectral.normalisedSpread);
-    appendFloatValue(packet, kFrameAnalysisSpectralRolloffAddress, frame.spectral.rolloffHz);
-    appendFloatValue(packet, kFrameAnalysisSpectralCrestAddress, frame.spectral.crestFactor);
-    appendFloatValue(packet, kFrameAnalysisSpectralFluxAddress, frame.spectral.spectralFlux);
+// Visits every frame value with its named address. The packed message carries the values
+// as arguments in exactly this order, so it is the packed schema as well.
+template <typename Visitor>
+void forEachFrameValue(const OSCFrameData& frame, Visitor&& visit) {
+    visit(kFrameMetaSampleRateAddress, frame.meta.sampleRate);
+    visit(kFrameMetaFftSizeAddress, frame.meta.fftSize);
+    visit(kFrameMetaTimestampAddress, frame.meta.frameTimestamp);
 
-    appendFloatValue(packet, kFrameAnalysisLoudnessDbAddress, frame.loudness.loudnessDb);
-    appendFloatValue(packet, kFrameAnalysisLoudnessNormalisedAddress, frame.loudness.loudnessNormalised);
-    appendFloatValue(packet, kFrameAnalysisFrameLoudnessDbAddress, frame.loudness.frameLoudnessDb);
-    appendFloatValue(packet, kFrameAnalysisMomentaryLoudnessAddress, frame.loudness.momentaryLoudnessLUFS);
-    appendFloatValue(packet, kFrameAnalysisEstimatedSPLAddress, frame.loudness.estimatedSPL);
-    appendFloatValue(packet, kFrameAnalysisLuminanceAddress, frame.loudness.luminanceCdM2);
-    appendFloatValue(packet, kFrameAnalysisBrightnessNormalisedAddress, frame.loudness.brightnessNormalised);
+    visit(kFrameSignalDominantFrequencyAddress, frame.signal.dominantFrequencyHz);
+    visit(kFrameSignalDominantWavelengthAddress, frame.signal.dominantWavelengthNm);
+    visit(kFrameSignalVisualiserMagnitudeAddress, frame.signal.visualiserMagnitude);
+    visit(kFrameSignalPhaseRadiansAddress, frame.signal.phaseRadians);
 
-    appendFloatValue(packet, kFrameAnalysisTransientMixAddress, frame.transient.transientMix);
-    appendBoolValue(packet, kFrameAnalysisOnsetDetectedAddress, frame.transient.onsetDetected);
+    visit(kFrameColourDisplayRAddress, frame.colour.displayR);
+    visit(kFrameColourDisplayGAddress, frame.colour.displayG);
+    visit(kFrameColourDisplayBAddress, frame.colour.displayB);
+    visit(kFrameColourCIEXAddress, frame.colour.cieX);
+    visit(kFrameColourCIEYAddress, frame.colour.cieY);
+    visit(kFrameColourCIEZAddress, frame.colour.cieZ);
+    visit(kFrameColourOklabLAddress, frame.colour.oklabL);
+    visit(kFrameColourOklabAAddress, frame.colour.oklabA);
+    visit(kFrameColourOklabBAddress, frame.colour.oklabB);
 
-    appendFloatValue(packet, kFrameAnalysisPhaseInstabilityAddress, frame.phase.instabilityNorm);
-    appendFloatValue(packet, kFrameAnalysisPhaseCoherenceAddress, frame.phase.coherenceNorm);
-    appendFloatValue(packet, kFrameAnalysisPhaseTransientAddress, frame.phase.transientNorm);
+    visit(kFrameAnalysisSpectralFlatnessAddress, frame.spectral.flatness);
+    visit(kFrameAnalysisSpectralCentroidAddress, frame.spectral.centroidHz);
+    visit(kFrameAnalysisSpectralSpreadAddress, frame.spectral.spreadHz);
+    visit(kFrameAnalysisSpectralSpreadNormalisedAddress, frame.spectral.normalisedSpread);
+    visit(kFrameAnalysisSpectralRolloffAddress, frame.spectral.rolloffHz);
+    visit(kFrameAnalysisSpectralCrestAddress, frame.spectral.crestFactor);
+    visit(kFrameAnalysisSpectralFluxAddress, frame.spectral.spectralFlux);
+
+    visit(kFrameAnalysisLoudnessDbAddress, frame.loudness.loudnessDb);
+    visit(kFrameAnalysisLoudnessNormalisedAddress, frame.loudness.loudnessNormalised);
+    visit(kFrameAnalysisFrameLoudnessDbAddress, frame.loudness.frameLoudnessDb);
+    visit(kFrameAnalysisMomentaryLoudnessAddress, frame.loudness.momentaryLoudnessLUFS);
+    visit(kFrameAnalysisEstimatedSPLAddress, frame.loudness.estimatedSPL);
+    visit(kFrameAnalysisLuminanceAddress, frame.loudness.luminanceCdM2);
+    visit(kFrameAnalysisBrightnessNormalisedAddress, frame.loudness.brightnessNormalised);
+
+    visit(kFrameAnalysisTransientMixAddress, frame.transient.transientMix);
+    visit(kFrameAnalysisOnsetDetectedAddress, frame.transient.onsetDetected);
+
+    visit(kFrameAnalysisPhaseInstabilityAddress, frame.phase.instabilityNorm);
+    visit(kFrameAnalysisPhaseCoherenceAddress, frame.phase.coherenceNorm);
+    visit(kFrameAnalysisPhaseTransientAddress, frame.phase.transientNorm);
+
+    visit(kFrameSmoothingOnsetDetectedAddress, frame.smoothing.onsetDetected);
+    visit(kFrameSmoothingSpectralFluxAddress, frame.smoothing.spectralFlux);
+    visit(kFrameSmoothingSpectralFlatnessAddress, frame.smoothing.spectralFlatness);
+    visit(kFrameSmoothingLoudnessNormalisedAddress, frame.smoothing.loudnessNormalised);
+    visit(kFrameSmoothingBrightnessNormalisedAddress, frame.smoothing.brightnessNormalised);
+    visit(kFrameSmoothingSpectralSpreadAddress, frame.smoothing.spectralSpreadNorm);
+    visit(kFrameSmoothingSpectralRolloffAddress, frame.smoothing.spectralRolloffNorm);
+    visit(kFrameSmoothingSpectralCrestAddress, frame.smoothing.spectralCrestNorm);
+    visit(kFrameSmoothingPhaseInstabilityAddress, frame.smoothing.phaseInstabilityNorm);
+    visit(kFrameSmoothingPhaseCoherenceAddress, frame.smoothing.phaseCoherenceNorm);
+    visit(kFrameSmoothingPhaseTransientAddress, frame.smoothing.phaseTransientNorm);
+}
+
+// Writes the named messages as bundles of at most maxPacketSize bytes, back to back in
+// buffer, and records where each one is. A message too big for any bundle gets its own.
+template <typename PacketSpan>
+void appendNamedValueBundles(std::vector<char>& buffer,
+                             const std::size_t maxPacketSize,
+                             const OSCFrameData& frame,
+                             const osc::uint64 timeTag,
+                             std::vector<PacketSpan>& packets) {
+    packets.clear();
+    std::size_t offset = 0;
+    std::size_t bundleSize = 0;
+    std::optional<osc::OutboundPacketStream> packet;
+    const auto closeBundle = [&] {
+        *packet << osc::EndBundle;
+        packets.push_back({offset, packet->Size()});
+        offset += packet->Size();
+        packet.reset();
+    };
+
+    forEachFrameValue(frame, [&](const char* address, const auto value) {
+        const std::size_t elementSize = kBundleElementPrefix + valueMessageSize(address, value);
+        if (packet.has_value() && bundleSize + elementSize > maxPacketSize) {
+            closeBundle();
+        }
+        if (!packet.has_value()) {
+            packet.emplace(buffer.data() + offset, buffer.size() - offset);
+            *packet << osc::BeginBundle(timeTag);
+            bundleSize = kBundleHeaderSize;
+        }
+        appendValueMessage(*packet, address, value);
+        bundleSize += elementSize;
+    });
+    if (packet.has_value()) {
+        closeBundle();
+    }
+}
+
+void appendPackedMessage(osc::OutboundPacketStream& packet, const OSCFrameData& frame) {
+    packet << osc::BeginMessage(kFramePackedAddress)
+           << static_cast<osc::int32>(kFramePackedSchemaVersion);
+    forEachFrameValue(frame, [&packet](const char*, const auto value) {
+        appendArgument(packet, value);
+    });
+    packet << osc::EndMessage;
+}
 
-    appendBoolValue(packet, kFrameSmoothingOnsetDetectedAddress, frame.smoothing.onsetDetected);
-    appendFloatValue(packet, kFrameSmoothingSpectralFluxAddress, frame.smoothing.spectralFlux);
-    appendFloatValue(packet, kFrameSmoothingSpectralFlatnessAddress, frame.smoothing.spectralFlatness);
-    appendFloatValue(packet, kFrameSmoothingLoudnessNormalisedAddress, frame.smoothing.loudnessNormalised);
-    appendFloatValue(packet, kFrameSmoothingBrightnessNormalisedAddress, frame.smoothing.brightnessNormalised);
-    appendFloatValue(packet, kFrameSmoothingSpectralSpreadAddress, frame.smoothing.spectralSpreadNorm);
-    appendFloatValue(packet, kFrameSmoothingSpectralRolloffAddress, frame.smoothing.spectralRolloffNorm);
-    appendFloatValue(packet, kFrameSmoothingSpectralCrestAddress, frame.smoothing.spectralCrestNorm);
-    appendFloatValue(packet, kFrameSmoothingPhaseInstabilityAddress, frame.smoothing.phaseInstabilityNorm);
-    appendFloatValue(packet, kFrameSmoothingPhaseCoherenceAddress, frame.smoothing.phaseCoherenceNorm);
-    appendFloatValue(packet, kFrameSmoothingPhaseTransientAddress, frame.smoothing.phaseTransientNorm);
+void appendBigEndian16(std::vector<uint8_t>& bytes, const uint16_t value) {
+    bytes.push_back(static_cast<uint8_t>(value >> 8));
+    bytes.push_back(static_cast<uint8_t>(value & 0xFF));
+}
+
+void appendBigEndian32(std::vector<uint8_t>& bytes, const uint32_t value) {
+    appendBigEndian16(bytes, static_cast<uint16_t>(value >> 16));
+    appendBigEndian16(bytes, static_cast<uint16_t>(value & 0xFFFF));
+}
+
+// 0 at floorDb and below, maxLevel at 0 dBFS and above.
+uint16_t quantiseLevel(const float magnitude, const float floorDb, const uint16_t maxLevel) {
+    const float db = 20.0f * std::log10(std::max(magnitude, 1e-12f));
+    const float position = std::clamp((db - floorDb) / -floorDb, 0.0f, 1.0f);
+    return static_cast<uint16_t>(std::lround(position * static_cast<float>(maxLevel)));
 }
 
 }
@@ -96,11 +223,16 @@ OSCSender::~OSCSender() = default;
 
 bool OSCSender::configure(const OSCConfig& config, std::string& errorMessage) {
     std::lock_guard<std::mutex> lock(mutex_);
+    socket_.reset();
+    endpoints_.clear();
+    buffer_.clear();
+    packedBuffer_.clear();
+    statsBuffer_.clear();
+    spectrumBuffer_.clear();
+    peaksBuffer_.clear();
 
     const auto destination = validateOSCDestination(config.destinationHost);
     if (!destination.valid) {
-        socket_.reset();
-        buffer_.clear();
         errorMessage = destination.errorMessage;
         return false;
     }
@@ -108,18 +240,112 @@ bool OSCSender::configure(const OSCConfig& config, std::string& errorMessage) {
     try {
         config_ = config;
         config_.destinationHost = destination.canonicalHost;
-        buffer_.assign(config.outputBufferSize, '\0');
-        socket_ = std::make_unique<UdpTransmitSocket>(
-            IpEndpointName(static_cast<unsigned long>(destination.address), static_cast<int>(config_.transmitPort))
-        );
+        if (!normaliseOSCDestinations(config_.additionalDestinations, errorMessage)) {
+            return false;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        std::vector<OSCDestinationStats> destinationStats;
+        const auto addEndpoint = [this, now, &destinationStats](const std::string& host, const uint16_t port,
+                                                                const OSCFrameFormat frameFormat,
+                                                                const float maxRateHz) {
+            const auto interval = maxRateHz > 0.0f
+                ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                      std::chrono::duration<float>(1.0f / maxRateHz))
+                : std::chrono::steady_clock::duration{};
+            const uint32_t address = validateOSCDestination(host).address;
+            Endpoint endpoint{IpEndpointName(static_cast<unsigned long>(address), static_cast<int>(port)),
+                              frameFormat, interval, now, 0, 0, now};
+            endpoints_.push_back(endpoint);
+            destinationStats.push_back({host, port, 0, 0.0f});
+        };
+        addEndpoint(config_.destinationHost, config_.transmitPort, config_.frameFormat, 0.0f);
+        for (const OSCDestination& extra : config_.additionalDestinations) {
+            addEndpoint(extra.host, extra.port, extra.frameFormat, extra.maxRateHz);
+        }
+        {
+            std::lock_guard<std::mutex> statsLock(statsMutex_);
+            destinationStats_ = std::move(destinationStats);
+        }
+
+        // Room for every named message in a bundle of its own, the worst case for splitting.
+        std::size_t namedMessages = 0;
+        std::size_t namedBytes = 0;
+        std::size_t packedArguments = 1;
+        std::size_t packedBytes = argumentSize(kFramePackedSchemaVersion);
+        forEachFrameValue(OSCFrameData{}, [&](const char* address, const auto value) {
+            ++namedMessages;
+            namedBytes += kBundleElementPrefix + valueMessageSize(address, value);
+            ++packedArguments;
+            packedBytes += argumentSize(value);
+        });
+        buffer_.assign(namedBytes + namedMessages * kBundleHeaderSize + kPacketSlack, '\0');
+        namedPackets_.reserve(namedMessages);
+        packedBuffer_.assign(paddedStringSize(std::strlen(kFramePackedAddress)) + paddedStringSize(1 + packedArguments) +
+                             packedBytes + kWrappedMessageOverhead + kPacketSlack, '\0');
+
+        std::size_t statsBytes = kBundleHeaderSize + kPacketSlack;
+        for (const char* address : {kStatsLatencyP50Address, kStatsLatencyP95Address, kStatsLatencyP99Address,
+                                    kStatsLatencyMaxAddress, kStatsJitterAddress}) {
+            statsBytes += kBundleElementPrefix + valueMessageSize(address, 0.0f);
+        }
+        statsBytes += kBundleElementPrefix + valueMessageSize(kStatsFpsAddress, int32_t{0});
+        for (const char* address : {kStatsFramesSentAddress, kStatsFramesCoalescedAddress,
+                                    kStatsFramesDroppedAddress}) {
+            statsBytes += kBundleElementPrefix + valueMessageSize(address, int64_t{0});
+        }
+        telemetryAddresses_.clear();
+        for (std::size_t index = 0; index < Utilities::Telemetry::kCounterCount; ++index) {
+            telemetryAddresses_.push_back(std::string(kStatsTelemetryPrefix) +
+                                          Utilities::Telemetry::name(static_cast<Utilities::Telemetry::Counter>(index)));
+            statsBytes += kBundleElementPrefix + valueMessageSize(telemetryAddresses_.back().c_str(), int64_t{0});
+        }
+        for (std::size_t index = 0; index < Utilities::Telemetry::kGaugeCount; ++index) {
+            telemetryAddresses_.push_back(std::string(kStatsTelemetryPrefix) +
+                                          Utilities::Telemetry::name(static_cast<Utilities::Telemetry::Gauge>(index)));
+            statsBytes += kBundleElementPrefix + valueMessageSize(telemetryAddresses_.back().c_str(), 0.0f);
+        }
+        for (std::size_t index = 0; index < Utilities::Telemetry::kStageCount; ++index) {
+            telemetryAddresses_.push_back(std::string(kStatsTelemetryPrefix) +
+                                          Utilities::Telemetry::name(static_cast<Utilities::Telemetry::Stage>(index)) + "_ms");
+            statsBytes += kBundleElementPrefix + paddedStringSize(telemetryAddresses_.back().size()) +
+                          paddedStringSize(4) + 3 * argumentSize(0.0f);
+        }
+        for (std::size_t index = 0; index < Utilities::Telemetry::kMemoryCount; ++index) {
+            telemetryAddresses_.push_back(std::string(kStatsTelemetryPrefix) + "memory_" +
+                                          Utilities::Telemetry::name(static_cast<Utilities::Telemetry::Memory>(index)) + "_bytes");
+            statsBytes += kBundleElementPrefix + paddedStringSize(telemetryAddresses_.back().size()) +
+                          paddedStringSize(3) + 2 * argumentSize(int64_t{0});
+        }
+        // Host, port and rate per destination; canonical IPv4 hosts are at most 15 characters.
+        statsBytes += endpoints_.size() * (kBundleElementPrefix + paddedStringSize(std::strlen(kStatsDestinationAddress)) +
+                                           paddedStringSize(4) + paddedStringSize(15) + 8);
+        statsBuffer_.assign(statsBytes, '\0');
+
+        if (config_.spectrum.enabled) {
+            constexpr std::size_t maxBins = FFTProcessor::MAX_FFT_SIZE / 2 + 1;
+            const std::size_t levelBytes = maxBins * 2;
+            const std::size_t edgeBytes = std::min(config_.spectrum.bandCount, maxBins) * 4;
+            spectrumLevels_.reserve(levelBytes);
+            spectrumEdges_.reserve(edgeBytes);
+            spectrumBands_.reserve(std::min(config_.spectrum.bandCount, maxBins));
+            spectrumBuffer_.assign(levelBytes + edgeBytes + kSpectrumMessageOverhead + kWrappedMessageOverhead, '\0');
+        }
+        if (config_.peaks.enabled) {
+            const std::size_t peakBytes = std::max<std::size_t>(config_.peaks.maxPeaks, 1) * kPeakBytes;
+            peakBytes_.reserve(peakBytes);
+            peaksBuffer_.assign(peakBytes + kPeaksMessageOverhead + kWrappedMessageOverhead, '\0');
+        }
+        // Unconnected, so one socket reaches every endpoint.
+        socket_ = std::make_unique<UdpSocket>();
     } catch (const std::exception& exception) {
         socket_.reset();
-        buffer_.clear();
+        endpoints_.clear();
         errorMessage = exception.what();
         return false;
     } catch (...) {
         socket_.reset();
-        buffer_.clear();
+        endpoints_.clear();
         errorMessage = "Failed to create OSC transmit socket";
         return false;
     }
@@ -131,22 +357,241 @@ bool OSCSender::configure(const OSCConfig& config, std::string& errorMessage) {
 void OSCSender::reset() {
     std::lock_guard<std::mutex> lock(mutex_);
     socket_.reset();
+    endpoints_.clear();
     buffer_.clear();
+    packedBuffer_.clear();
+    statsBuffer_.clear();
+    spectrumBuffer_.clear();
+    peaksBuffer_.clear();
 }
 
 bool OSCSender::sendFrame(const OSCFrameData& frame) {
+    SYN_PROFILE_SCOPE(OSCSend);
     std::lock_guard<std::mutex> lock(mutex_);
     if (!socket_ || buffer_.empty()) {
         return false;
     }
 
+    // Each format is serialised at most once per frame, however many endpoints take it.
+    // A scheduled packed frame is wrapped in a bundle, the only place a time tag can go.
+    const osc::uint64 timeTag = presentationTimeTag(config_, frame.meta.frameTimestamp);
+    const bool scheduled = timeTag != kImmediateTimeTag;
+    bool namedReady = false;
+    std::size_t packedSize = 0;
+    bool allSent = true;
+    const auto now = std::chrono::steady_clock::now();
+    for (std::size_t index = 0; index < endpoints_.size(); ++index) {
+        Endpoint& endpoint = endpoints_[index];
+        if (now < endpoint.nextSend) {
+            continue;
+        }
+        endpoint.nextSend = endpoint.interval.count() > 0 ? now + endpoint.interval : now;
+
+        try {
+            if (endpoint.frameFormat == OSCFrameFormat::Packed) {
+                if (packedSize == 0) {
+                    osc::OutboundPacketStream packet(packedBuffer_.data(), packedBuffer_.size());
+                    if (scheduled) {
+                        packet << osc::BeginBundle(timeTag);
+                    }
+                    appendPackedMessage(packet, frame);
+                    if (scheduled) {
+                        packet << osc::EndBundle;
+                    }
+                    packedSize = packet.Size();
+                }
+                sendTo(index, packedBuffer_.data(), packedSize, now);
+            } else {
+                if (!namedReady) {
+                    appendNamedValueBundles(buffer_, config_.maxPacketSize, frame, timeTag, namedPackets_);
+                    namedReady = true;
+                }
+                for (const PacketSpan& bundle : namedPackets_) {
+                    sendTo(index, buffer_.data() + bundle.offset, bundle.size, now);
+                }
+            }
+        } catch (...) {
+            allSent = false;
+        }
+    }
+
+    return allSent;
+}
+
+bool OSCSender::sendSpectrum(const OSCSpectrumData& spectrum) {
+    SYN_PROFILE_SCOPE(OSCSend);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!socket_ || spectrumBuffer_.empty() || spectrum.magnitudes.empty()) {
+        return false;
+    }
+
+    const OSCSpectrumConfig& settings = config_.spectrum;
+    const bool wide = settings.precision == OSCSpectrumPrecision::UInt16;
+    const uint16_t maxLevel = wide ? 0xFFFF : 0xFF;
+    const float floorDb = std::min(settings.floorDb, -1.0f);
+    const auto appendLevel = [this, wide, maxLevel, floorDb](const float magnitude) {
+        const uint16_t level = quantiseLevel(magnitude, floorDb, maxLevel);
+        if (wide) {
+            appendBigEndian16(spectrumLevels_, level);
+        } else {
+            spectrumLevels_.push_back(static_cast<uint8_t>(level));
+        }
+    };
+
+    spectrumLevels_.clear();
+    spectrumEdges_.clear();
+    const std::size_t binCount = spectrum.magnitudes.size();
+    if (settings.layout == OSCSpectrumLayout::CriticalBands) {
+        updateSpectrumBands(spectrum.meta, binCount);
+        for (const SpectrumBand& band : spectrumBands_) {
+            const auto first = spectrum.magnitudes.begin() + static_cast<std::ptrdiff_t>(band.firstBin);
+            const auto last = spectrum.magnitudes.begin() + static_cast<std::ptrdiff_t>(band.lastBin) + 1;
+            appendLevel(*std::max_element(first, last));
+            appendBigEndian16(spectrumEdges_, static_cast<uint16_t>(band.firstBin));
+            appendBigEndian16(spectrumEdges_, static_cast<uint16_t>(band.lastBin));
+        }
+    } else {
+        for (const float magnitude : spectrum.magnitudes) {
+            appendLevel(magnitude);
+        }
+    }
+
+    if (spectrumLevels_.size() + spectrumEdges_.size() + kSpectrumMessageOverhead > spectrumBuffer_.size()) {
+        return false;
+    }
+
+    try {
+        const osc::uint64 timeTag = presentationTimeTag(config_, spectrum.meta.frameTimestamp);
+        const bool scheduled = timeTag != kImmediateTimeTag;
+        osc::OutboundPacketStream packet(spectrumBuffer_.data(), spectrumBuffer_.size());
+        if (scheduled) {
+            packet << osc::BeginBundle(timeTag);
+        }
+        packet << osc::BeginMessage(kFrameSpectrumAddress)
+               << static_cast<osc::int32>(kFrameSpectrumSchemaVersion)
+               << static_cast<osc::int64>(spectrum.meta.frameTimestamp)
+               << static_cast<osc::int32>(spectrum.meta.sampleRate)
+               << static_cast<osc::int32>(spectrum.meta.fftSize)
+               << static_cast<osc::int32>(settings.layout == OSCSpectrumLayout::CriticalBands ? 1 : 0)
+               << static_cast<osc::int32>(wide ? 16 : 8)
+               << floorDb
+               << osc::Blob(spectrumLevels_.data(), static_cast<osc::int32>(spectrumLevels_.size()))
+               << osc::Blob(spectrumEdges_.data(), static_cast<osc::int32>(spectrumEdges_.size()))
+               << osc::EndMessage;
+        if (scheduled) {
+            packet << osc::EndBundle;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (std::size_t index = 0; index < endpoints_.size(); ++index) {
+            sendTo(index, packet.Data(), packet.Size(), now);
+        }
+    } catch (...) {
+        return false;
+    }
+
+    return true;
+}
+
+bool OSCSender::sendPeaks(const OSCPeakTrackData& peaks) {
+    SYN_PROFILE_SCOPE(OSCSend);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!socket_ || peaksBuffer_.empty()) {
+        return false;
+    }
+
+    peakBytes_.clear();
+    const std::size_t peakCount = std::min(peaks.peaks.size(), std::max<std::size_t>(config_.peaks.maxPeaks, 1));
+    for (std::size_t index = 0; index < peakCount; ++index) {
+        const PhaseReconstruction::TrackedPeak& peak = peaks.peaks[index];
+        appendBigEndian32(peakBytes_, peak.track);
+        appendBigEndian32(peakBytes_, std::bit_cast<uint32_t>(peak.frequencyHz));
+        appendBigEndian32(peakBytes_, std::bit_cast<uint32_t>(peak.magnitude));
+        appendBigEndian32(peakBytes_, std::bit_cast<uint32_t>(peak.phase));
+    }
+
+    try {
+        const osc::uint64 timeTag = presentationTimeTag(config_, peaks.meta.frameTimestamp);
+        const bool scheduled = timeTag != kImmediateTimeTag;
+        osc::OutboundPacketStream packet(peaksBuffer_.data(), peaksBuffer_.size());
+        if (scheduled) {
+            packet << osc::BeginBundle(timeTag);
+        }
+        packet << osc::BeginMessage(kFramePeaksAddress)
+               << static_cast<osc::int32>(kFramePeaksSchemaVersion)
+               << static_cast<osc::int64>(peaks.meta.frameTimestamp)
+               << static_cast<osc::int32>(peaks.meta.sampleRate)
+               << static_cast<osc::int32>(peaks.meta.fftSize)
+               << static_cast<osc::int32>(peakCount)
+               << osc::Blob(peakBytes_.data(), static_cast<osc::int32>(peakBytes_.size()))
+               << osc::EndMessage;
+        if (scheduled) {
+            packet << osc::EndBundle;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (std::size_t index = 0; index < endpoints_.size(); ++index) {
+            sendTo(index, packet.Data(), packet.Size(), now);
+        }
+    } catch (...) {
+        return false;
+    }
+
+    return true;
+}
+
+bool OSCSender::sendStats(const OSCStats& stats, const Utilities::Telemetry::Snapshot& telemetry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!socket_ || statsBuffer_.empty()) {
+        return false;
+    }
+
     try {
-        osc::OutboundPacketStream packet(buffer_.data(), buffer_.size());
+        osc::OutboundPacketStream packet(statsBuffer_.data(), statsBuffer_.size());
         packet << osc::BeginBundleImmediate;
-        appendNamedValueMessages(packet, frame);
+        appendValueMessage(packet, kStatsLatencyP50Address, stats.latencyP50Ms);
+        appendValueMessage(packet, kStatsLatencyP95Address, stats.latencyP95Ms);
+        appendValueMessage(packet, kStatsLatencyP99Address, stats.latencyP99Ms);
+        appendValueMessage(packet, kStatsLatencyMaxAddress, stats.latencyMaxMs);
+        appendValueMessage(packet, kStatsJitterAddress, stats.jitterMs);
+        appendValueMessage(packet, kStatsFpsAddress, static_cast<int32_t>(stats.currentFps));
+        appendValueMessage(packet, kStatsFramesSentAddress, static_cast<int64_t>(stats.framesSent));
+        appendValueMessage(packet, kStatsFramesCoalescedAddress, static_cast<int64_t>(stats.framesCoalesced));
+        appendValueMessage(packet, kStatsFramesDroppedAddress, static_cast<int64_t>(stats.framesDropped));
+        for (const OSCDestinationStats& destination : stats.destinations) {
+            packet << osc::BeginMessage(kStatsDestinationAddress)
+                   << destination.host.c_str()
+                   << static_cast<osc::int32>(destination.port)
+                   << destination.bytesPerSecond
+                   << osc::EndMessage;
+        }
+
+        std::size_t address = 0;
+        for (const uint64_t value : telemetry.counters) {
+            appendValueMessage(packet, telemetryAddresses_[address++].c_str(), static_cast<int64_t>(value));
+        }
+        for (const double value : telemetry.gauges) {
+            appendValueMessage(packet, telemetryAddresses_[address++].c_str(), static_cast<float>(value));
+        }
+        for (const Utilities::Telemetry::StageSample& sample : telemetry.stages) {
+            packet << osc::BeginMessage(telemetryAddresses_[address++].c_str())
+                   << static_cast<float>(sample.lastMs())
+                   << static_cast<float>(sample.meanMs())
+                   << static_cast<float>(sample.peakMs())
+                   << osc::EndMessage;
+        }
+        for (const Utilities::Telemetry::MemorySample& sample : telemetry.memory) {
+            packet << osc::BeginMessage(telemetryAddresses_[address++].c_str())
+                   << static_cast<osc::int64>(sample.bytes)
+                   << static_cast<osc::int64>(sample.peakBytes)
+                   << osc::EndMessage;
+        }
         packet << osc::EndBundle;
 
-        socket_->Send(packet.Data(), packet.Size());
+        const auto now = std::chrono::steady_clock::now();
+        for (std::size_t index = 0; index < endpoints_.size(); ++index) {
+            sendTo(index, packet.Data(), packet.Size(), now);
+        }
     } catch (...) {
         return false;
     }
@@ -154,4 +599,44 @@ bool OSCSender::sendFrame(const OSCFrameData& frame) {
     return true;
 }
 
+std::vector<OSCDestinationStats> OSCSender::getDestinationStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return destinationStats_;
+}
+
+void OSCSender::sendTo(const std::size_t index,
+                       const char* data,
+                       const std::size_t size,
+                       const std::chrono::steady_clock::time_point now) {
+    Endpoint& endpoint = endpoints_[index];
+    socket_->SendTo(endpoint.address, data, size);
+    endpoint.bytesSent += size;
+    endpoint.windowBytes += size;
+
+    const float elapsedSeconds = std::chrono::duration<float>(now - endpoint.windowStart).count();
+    if (elapsedSeconds >= 1.0f) {
+        std::lock_guard<std::mutex> statsLock(statsMutex_);
+        destinationStats_[index].bytesSent = endpoint.bytesSent;
+        destinationStats_[index].bytesPerSecond = static_cast<float>(endpoint.windowBytes) / elapsedSeconds;
+        endpoint.windowBytes = 0;
+        endpoint.windowStart = now;
+    }
+}
+
+void OSCSender::updateSpectrumBands(const OSCFrameMetaData& meta, const std::size_t binCount) {
+    if (meta.sampleRate == spectrumBandsSampleRate_ && binCount == spectrumBandsBinCount_) {
+        return;
+    }
+
+    spectrumBandsSampleRate_ = meta.sampleRate;
+    spectrumBandsBinCount_ = binCount;
+    spectrumBands_.clear();
+    const int fftSize = static_cast<int>(2 * (binCount - 1));
+    const auto bands = FFTProcessor::buildCriticalBands(static_cast<float>(meta.sampleRate), fftSize,
+                                                        config_.spectrum.bandCount);
+    for (const auto& band : bands) {
+        spectrumBands_.push_back({band.startBin, std::min(band.endBin, binCount - 1)});
+    }
+}
+
 }
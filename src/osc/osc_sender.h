@@ -4,9 +4,14 @@
 #include "osc_messages.h"
 
 #include "ip/UdpSocket.h"
+#include "utilities/telemetry/telemetry.h"
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace Synesthesia::OSC {
@@ -18,13 +23,70 @@ public:
 
     bool configure(const OSCConfig& config, std::string& errorMessage);
     void reset();
+    // Sends to every endpoint that is due under its rate limit. False if any send failed.
     bool sendFrame(const OSCFrameData& frame);
+    // Reduces and quantises the spectrum as config.spectrum asks and sends it as one blob.
+    bool sendSpectrum(const OSCSpectrumData& spectrum);
+    // Sends the frame's tracked peaks as one blob, up to config.peaks.maxPeaks of them.
+    bool sendPeaks(const OSCPeakTrackData& peaks);
+    // Publishes stats and the telemetry registry as one /synesthesia/stats/* bundle to every
+    // endpoint.
+    bool sendStats(const OSCStats& stats, const Utilities::Telemetry::Snapshot& telemetry);
+    // Bytes sent to each endpoint, refreshed about once a second.
+    std::vector<OSCDestinationStats> getDestinationStats() const;
 
 private:
+    struct SpectrumBand {
+        std::size_t firstBin;
+        std::size_t lastBin;
+    };
+
+    struct Endpoint {
+        IpEndpointName address;
+        OSCFrameFormat frameFormat;
+        std::chrono::steady_clock::duration interval;
+        std::chrono::steady_clock::time_point nextSend;
+        uint64_t bytesSent = 0;
+        uint64_t windowBytes = 0;
+        std::chrono::steady_clock::time_point windowStart;
+    };
+
+    struct PacketSpan {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    void sendTo(std::size_t endpoint, const char* data, std::size_t size,
+                std::chrono::steady_clock::time_point now);
+
+    void updateSpectrumBands(const OSCFrameMetaData& meta, std::size_t binCount);
+
     std::mutex mutex_;
     OSCConfig config_;
-    std::unique_ptr<UdpTransmitSocket> socket_;
-    std::vector<char> buffer_;
+    std::unique_ptr<UdpSocket> socket_;
+    std::vector<Endpoint> endpoints_;  // The primary destination first
+    // Sized in configure() from the frame layout, so sending never allocates.
+    std::vector<char> buffer_;               // Named frames, as one or more bundles
+    std::vector<PacketSpan> namedPackets_;   // The bundles of the current frame in buffer_
+    std::vector<char> packedBuffer_;
+    std::vector<char> statsBuffer_;
+    // Counters, then gauges, then stages, in their enum order.
+    std::vector<std::string> telemetryAddresses_;
+
+    // Rebuilt only when the sample rate or FFT size changes. The level and edge buffers
+    // are reserved for the largest FFT when spectrum streaming is on.
+    std::vector<SpectrumBand> spectrumBands_;
+    int32_t spectrumBandsSampleRate_ = 0;
+    std::size_t spectrumBandsBinCount_ = 0;
+    std::vector<char> spectrumBuffer_;
+    std::vector<uint8_t> spectrumLevels_;
+    std::vector<uint8_t> spectrumEdges_;
+    // Sized for config.peaks.maxPeaks when peak tracks are on.
+    std::vector<char> peaksBuffer_;
+    std::vector<uint8_t> peakBytes_;
+
+    mutable std::mutex statsMutex_;
+    std::vector<OSCDestinationStats> destinationStats_;  // Protected by statsMutex_; follows endpoints_
 };
 
 }
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+
+// The layout SharedMemoryFrameOutput publishes, for readers in other processes. It has no
+// dependency beyond <cstdint>, so a reader can copy this header as it is.
+//
+// The region is named kDefaultSharedMemoryName unless configured otherwise: a POSIX shared
+// memory object ("/" + name, shm_open) on Linux and macOS, and a "Local\" file mapping on
+// Windows. It holds one SharedFrameHeader followed by slotCount SharedFrameSlots, every field
+// little-endian and naturally aligned. Frame values are those of the named OSC messages.
+//
+// The writer keeps a seqlock per slot; sequence and publishedFrames are accessed atomically.
+// To read the newest frame:
+//   1. n = publishedFrames (acquire). Zero means nothing has been published yet.
+//   2. slot = slots[(n - 1) % slotCount].
+//   3. s1 = slot.sequence (acquire). If s1 is odd the slot is being written; retry.
+//   4. Copy the slot, then issue an acquire fence.
+//   5. s2 = slot.sequence (relaxed). If s1 != s2 the copy is torn; retry.
+// Older frames stay readable until the writer wraps round to their slot, so a reader that
+// falls behind by fewer than slotCount frames can catch up from frameIndex without a gap.
+namespace Synesthesia::OSC {
+
+inline constexpr const char* kDefaultSharedMemoryName = "synesthesia-frames";
+inline constexpr char kSharedFrameMagic[8] = {'S', 'Y', 'N', 'F', 'R', 'A', 'M', 'E'};
+inline constexpr uint32_t kSharedFrameLayoutVersion = 1;
+inline constexpr uint32_t kSharedFrameSlotCount = 8;
+// FFTProcessor::MAX_FFT_SIZE / 2 + 1.
+inline constexpr uint32_t kSharedFrameMaxSpectrumBins = 4097;
+
+inline constexpr uint32_t kSharedFrameFlagOnset = 1u << 0;
+inline constexpr uint32_t kSharedFrameFlagSmoothingOnset = 1u << 1;
+
+struct alignas(64) SharedFrameHeader {
+    char magic[8];
+    uint32_t layoutVersion;
+    uint32_t headerSize;           // sizeof(SharedFrameHeader); the first slot starts here
+    uint32_t slotCount;
+    uint32_t slotSize;             // sizeof(SharedFrameSlot)
+    uint32_t maxSpectrumBins;
+    uint32_t writerProcessId;
+    uint64_t publishedFrames;      // Frames published since the writer opened the region
+};
+
+struct alignas(64) SharedFrameSlot {
+    uint64_t sequence;             // Odd while the writer is filling the slot
+    uint64_t frameIndex;           // publishedFrames when written, counting from one
+    int64_t frameTimestampMicros;  // Steady clock, the same clock OSC frame timestamps use
+    int32_t sampleRate;
+    int32_t fftSize;
+    uint32_t flags;                // kSharedFrameFlag* bits
+    uint32_t spectrumBinCount;     // Magnitudes in spectrum; zero when none was attached
+
+    float dominantFrequencyHz;
+    float dominantWavelengthNm;
+    float visualiserMagnitude;
+    float phaseRadians;
+
+    float displayR;
+    float displayG;
+    float displayB;
+    float cieX;
+    float cieY;
+    float cieZ;
+    float oklabL;
+    float oklabA;
+    float oklabB;
+
+    float spectralFlatness;
+    float spectralCentroidHz;
+    float spectralSpreadHz;
+    float spectralSpreadNormalised;
+    float spectralRolloffHz;
+    float spectralCrestFactor;
+    float spectralFlux;
+
+    float loudnessDb;
+    float loudnessNormalised;
+    float frameLoudnessDb;
+    float momentaryLoudnessLUFS;
+    float estimatedSPL;
+    float luminanceCdM2;
+    float brightnessNormalised;
+
+    float transientMix;
+    float phaseInstabilityNorm;
+    float phaseCoherenceNorm;
+    float phaseTransientNorm;
+
+    float smoothingSpectralFlux;
+    float smoothingSpectralFlatness;
+    float smoothingLoudnessNormalised;
+    float smoothingBrightnessNormalised;
+    float smoothingSpectralSpreadNorm;
+    float smoothingSpectralRolloffNorm;
+    float smoothingSpectralCrestNorm;
+    float smoothingPhaseInstabilityNorm;
+    float smoothingPhaseCoherenceNorm;
+    float smoothingPhaseTransientNorm;
+
+    // The magnitudes the OSC spectrum stream is built from, on the FFT's bin axis, bin 0 first.
+    float spectrum[kSharedFrameMaxSpectrumBins];
+};
+
+static_assert(sizeof(SharedFrameHeader) == 64);
+static_assert(sizeof(SharedFrameSlot) % 64 == 0);
+
+}
@@ -0,0 +1,219 @@
+#include "shared_memory_frame_output.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Synesthesia::OSC {
+
+namespace {
+
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free,
+              "Readers in other processes rely on address-free 64-bit atomics");
+
+constexpr std::size_t kRegionSize = sizeof(SharedFrameHeader) + kSharedFrameSlotCount * sizeof(SharedFrameSlot);
+
+void fillSlot(SharedFrameSlot& slot, const OSCFrameData& frame, const std::span<const float> magnitudes) {
+    slot.frameTimestampMicros = frame.meta.frameTimestamp;
+    slot.sampleRate = frame.meta.sampleRate;
+    slot.fftSize = frame.meta.fftSize;
+    slot.flags = (frame.transient.onsetDetected ? kSharedFrameFlagOnset : 0u) |
+                 (frame.smoothing.onsetDetected ? kSharedFrameFlagSmoothingOnset : 0u);
+
+    slot.dominantFrequencyHz = frame.signal.dominantFrequencyHz;
+    slot.dominantWavelengthNm = frame.signal.dominantWavelengthNm;
+    slot.visualiserMagnitude = frame.signal.visualiserMagnitude;
+    slot.phaseRadians = frame.signal.phaseRadians;
+
+    slot.displayR = frame.colour.displayR;
+    slot.displayG = frame.colour.displayG;
+    slot.displayB = frame.colour.displayB;
+    slot.cieX = frame.colour.cieX;
+    slot.cieY = frame.colour.cieY;
+    slot.cieZ = frame.colour.cieZ;
+    slot.oklabL = frame.colour.oklabL;
+    slot.oklabA = frame.colour.oklabA;
+    slot.oklabB = frame.colour.oklabB;
+
+    slot.spectralFlatness = frame.spectral.flatness;
+    slot.spectralCentroidHz = frame.spectral.centroidHz;
+    slot.spectralSpreadHz = frame.spectral.spreadHz;
+    slot.spectralSpreadNormalised = frame.spectral.normalisedSpread;
+    slot.spectralRolloffHz = frame.spectral.rolloffHz;
+    slot.spectralCrestFactor = frame.spectral.crestFactor;
+    slot.spectralFlux = frame.spectral.spectralFlux;
+
+    slot.loudnessDb = frame.loudness.loudnessDb;
+    slot.loudnessNormalised = frame.loudness.loudnessNormalised;
+    slot.frameLoudnessDb = frame.loudness.frameLoudnessDb;
+    slot.momentaryLoudnessLUFS = frame.loudness.momentaryLoudnessLUFS;
+    slot.estimatedSPL = frame.loudness.estimatedSPL;
+    slot.luminanceCdM2 = frame.loudness.luminanceCdM2;
+    slot.brightnessNormalised = frame.loudness.brightnessNormalised;
+
+    slot.transientMix = frame.transient.transientMix;
+    slot.phaseInstabilityNorm = frame.phase.instabilityNorm;
+    slot.phaseCoherenceNorm = frame.phase.coherenceNorm;
+    slot.phaseTransientNorm = frame.phase.transientNorm;
+
+    slot.smoothingSpectralFlux = frame.smoothing.spectralFlux;
+    slot.smoothingSpectralFlatness = frame.smoothing.spectralFlatness;
+    slot.smoothingLoudnessNormalised = frame.smoothing.loudnessNormalised;
+    slot.smoothingBrightnessNormalised = frame.smoothing.brightnessNormalised;
+    slot.smoothingSpectralSpreadNorm = frame.smoothing.spectralSpreadNorm;
+    slot.smoothingSpectralRolloffNorm = frame.smoothing.spectralRolloffNorm;
+    slot.smoothingSpectralCrestNorm = frame.smoothing.spectralCrestNorm;
+    slot.smoothingPhaseInstabilityNorm = frame.smoothing.phaseInstabilityNorm;
+    slot.smoothingPhaseCoherenceNorm = frame.smoothing.phaseCoherenceNorm;
+    slot.smoothingPhaseTransientNorm = frame.smoothing.phaseTransientNorm;
+
+    const std::size_t bins = std::min<std::size_t>(magnitudes.size(), kSharedFrameMaxSpectrumBins);
+    std::copy_n(magnitudes.begin(), bins, slot.spectrum);
+    slot.spectrumBinCount = static_cast<uint32_t>(bins);
+}
+
+}
+
+SharedMemoryFrameOutput::~SharedMemoryFrameOutput() {
+    close();
+}
+
+bool SharedMemoryFrameOutput::open(const std::string& name, std::string& errorMessage) {
+    close();
+    if (name.empty()) {
+        errorMessage = "Shared memory name is empty";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    void* memory = nullptr;
+#if defined(_WIN32)
+    const std::string mappingName = "Local\\" + name;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(kRegionSize) >> 32),
+                                        static_cast<DWORD>(kRegionSize & 0xffffffffu),
+                                        mappingName.c_str());
+    if (mapping == nullptr) {
+        errorMessage = "CreateFileMapping failed (" + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, kRegionSize);
+    if (memory == nullptr) {
+        errorMessage = "MapViewOfFile failed (" + std::to_string(GetLastError()) + ")";
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+#else
+    const std::string objectName = "/" + name;
+    // A region left by a writer that crashed may have another size; start from a fresh one.
+    shm_unlink(objectName.c_str());
+    const int descriptor = shm_open(objectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0) {
+        errorMessage = "shm_open failed: " + std::string(std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(descriptor, static_cast<off_t>(kRegionSize)) != 0) {
+        errorMessage = "ftruncate failed: " + std::string(std::strerror(errno));
+        ::close(descriptor);
+        shm_unlink(objectName.c_str());
+        return false;
+    }
+    memory = mmap(nullptr, kRegionSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    ::close(descriptor);
+    if (memory == MAP_FAILED) {
+        errorMessage = "mmap failed: " + std::string(std::strerror(errno));
+        shm_unlink(objectName.c_str());
+        return false;
+    }
+#endif
+
+    std::memset(memory, 0, kRegionSize);
+    header_ = static_cast<SharedFrameHeader*>(memory);
+    slots_ = reinterpret_cast<SharedFrameSlot*>(static_cast<char*>(memory) + sizeof(SharedFrameHeader));
+    mappedSize_ = kRegionSize;
+    name_ = name;
+
+    header_->layoutVersion = kSharedFrameLayoutVersion;
+    header_->headerSize = static_cast<uint32_t>(sizeof(SharedFrameHeader));
+    header_->slotCount = kSharedFrameSlotCount;
+    header_->slotSize = static_cast<uint32_t>(sizeof(SharedFrameSlot));
+    header_->maxSpectrumBins = kSharedFrameMaxSpectrumBins;
+#if defined(_WIN32)
+    header_->writerProcessId = static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    header_->writerProcessId = static_cast<uint32_t>(getpid());
+#endif
+    // The magic goes in last, so a reader that sees it sees the rest of the header.
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, kSharedFrameMagic, sizeof(kSharedFrameMagic));
+    return true;
+}
+
+void SharedMemoryFrameOutput::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (header_ == nullptr) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(header_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    mapping_ = nullptr;
+#else
+    munmap(header_, mappedSize_);
+    shm_unlink(("/" + name_).c_str());
+#endif
+    header_ = nullptr;
+    slots_ = nullptr;
+    mappedSize_ = 0;
+}
+
+bool SharedMemoryFrameOutput::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return header_ != nullptr;
+}
+
+std::string SharedMemoryFrameOutput::name() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return name_;
+}
+
+void SharedMemoryFrameOutput::publish(const OSCFrameData& frame, const std::span<const float> magnitudes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (header_ == nullptr) {
+        return;
+    }
+
+    std::atomic_ref<uint64_t> published(header_->publishedFrames);
+    const uint64_t frameIndex = published.load(std::memory_order_relaxed) + 1;
+    SharedFrameSlot& slot = slots_[(frameIndex - 1) % kSharedFrameSlotCount];
+
+    std::atomic_ref<uint64_t> sequence(slot.sequence);
+    const uint64_t begin = sequence.load(std::memory_order_relaxed) + 1;
+    sequence.store(begin, std::memory_order_relaxed);
+    // Keeps the payload stores below from moving ahead of the odd sequence.
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.frameIndex = frameIndex;
+    fillSlot(slot, frame, magnitudes);
+
+    sequence.store(begin + 1, std::memory_order_release);
+    published.store(frameIndex, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "osc_messages.h"
+#include "shared_memory_frame_layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace Synesthesia::OSC {
+
+// Publishes frames into a shared memory ring for consumers on the same machine, in the layout
+// shared_memory_frame_layout.h documents. A publish is a copy into the next slot, with no
+// serialisation or syscall, so it runs on the caller's thread.
+class SharedMemoryFrameOutput {
+public:
+    SharedMemoryFrameOutput() = default;
+    ~SharedMemoryFrameOutput();
+
+    SharedMemoryFrameOutput(const SharedMemoryFrameOutput&) = delete;
+    SharedMemoryFrameOutput& operator=(const SharedMemoryFrameOutput&) = delete;
+
+    // Creates the region, replacing one a previous writer left behind.
+    bool open(const std::string& name, std::string& errorMessage);
+    void close();
+    bool isOpen() const;
+    std::string name() const;
+
+    // Magnitudes beyond kSharedFrameMaxSpectrumBins are dropped.
+    void publish(const OSCFrameData& frame, std::span<const float> magnitudes = {});
+
+private:
+    mutable std::mutex mutex_;
+    std::string name_;
+    SharedFrameHeader* header_ = nullptr;  // The start of the mapping
+    SharedFrameSlot* slots_ = nullptr;
+    std::size_t mappedSize_ = 0;
+#if defined(_WIN32)
+    void* mapping_ = nullptr;
+#endif
+};
+
+}
@@ -1,7 +1,5 @@
 #include "synesthesia_osc_integration.h"
 
-#include <type_traits>
-
 namespace Synesthesia::OSC {
 
 std::unique_ptr<SynesthesiaOSCIntegration> SynesthesiaOSCIntegration::instance_;
@@ -30,47 +28,73 @@ OSCConfig SynesthesiaOSCIntegration::getConfig() const {
     return runtime_.getConfig();
 }
 
+float SynesthesiaOSCIntegration::getPresentationLatencyMs() const {
+    return runtime_.getPresentationLatencyMs();
+}
+
 std::string SynesthesiaOSCIntegration::getLastError() const {
     return runtime_.getLastError();
 }
 
 void SynesthesiaOSCIntegration::updateFrameData(const OSCFrameUpdate& update) {
-    if (!runtime_.isRunning()) {
+    if (!wantsFrames()) {
         return;
     }
+    updateFrameData(buildFrameData(update), update.magnitudes, update.phases);
+}
 
-    runtime_.sendFrame(buildFrameData(update));
+void SynesthesiaOSCIntegration::updateFrameData(const OSCFrameData& frame,
+                                                const std::span<const float> magnitudes,
+                                                const std::span<const float> phases) {
+    if (sharedMemory_.isOpen()) {
+        sharedMemory_.publish(frame, magnitudes);
+    }
+    if (runtime_.isRunning()) {
+        runtime_.sendFrame(frame, magnitudes, phases);
+    }
 }
 
-PendingOSCSettings SynesthesiaOSCIntegration::consumePendingSettings() {
-    PendingOSCSettings pendingSettings;
-    const auto commands = runtime_.popPendingCommands();
-
-    for (const OSCCommand& command : commands) {
-        std::visit([&pendingSettings](const auto& value) {
-            using ValueType = std::decay_t<decltype(value)>;
-
-            if constexpr (std::is_same_v<ValueType, SetSmoothingEnabledCommand>) {
-                pendingSettings.smoothingEnabled = value.enabled;
-            } else if constexpr (std::is_same_v<ValueType, SetColourSmoothingSpeedCommand>) {
-                pendingSettings.colourSmoothingSpeed = value.speed;
-            } else if constexpr (std::is_same_v<ValueType, SetSpectrumSmoothingCommand>) {
-                pendingSettings.spectrumSmoothingAmount = value.amount;
-            } else if constexpr (std::is_same_v<ValueType, SetColourSpaceCommand>) {
-                pendingSettings.colourSpace = value.colourSpace;
-            } else if constexpr (std::is_same_v<ValueType, SetGamutMappingCommand>) {
-                pendingSettings.gamutMappingEnabled = value.enabled;
-            }
-        }, command);
+void SynesthesiaOSCIntegration::sendFrameData(const OSCFrameData& frame) {
+    sharedMemory_.publish(frame);
+    if (!runtime_.isRunning()) {
+        return;
     }
 
-    return pendingSettings;
+    runtime_.sendFrame(frame);
+}
+
+void SynesthesiaOSCIntegration::waitForPendingFrame() {
+    runtime_.waitForPendingFrame();
+}
+
+PendingOSCSettings SynesthesiaOSCIntegration::consumePendingSettings() {
+    return runtime_.consumePendingSettings();
 }
 
 OSCStats SynesthesiaOSCIntegration::getStats() const {
     return runtime_.getStats();
 }
 
+bool SynesthesiaOSCIntegration::startSharedMemoryOutput(const std::string& name, std::string& errorMessage) {
+    return sharedMemory_.open(name, errorMessage);
+}
+
+void SynesthesiaOSCIntegration::stopSharedMemoryOutput() {
+    sharedMemory_.close();
+}
+
+bool SynesthesiaOSCIntegration::isSharedMemoryOutputRunning() const {
+    return sharedMemory_.isOpen();
+}
+
+std::string SynesthesiaOSCIntegration::getSharedMemoryOutputName() const {
+    return sharedMemory_.name();
+}
+
+bool SynesthesiaOSCIntegration::wantsFrames() const {
+    return runtime_.isRunning() || sharedMemory_.isOpen();
+}
+
 SynesthesiaOSCIntegration& SynesthesiaOSCIntegration::getInstance() {
     std::lock_guard<std::mutex> lock(instanceMutex_);
     if (!instance_) {
@@ -4,9 +4,11 @@
 #include "osc_config.h"
 #include "osc_messages.h"
 #include "osc_runtime.h"
+#include "shared_memory_frame_output.h"
 
 #include <memory>
 #include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -20,19 +22,40 @@ public:
 
     bool updateConfig(const OSCConfig& config);
     OSCConfig getConfig() const;
+    // How long after its capture time a frame is scheduled to be presented, 0 when frames
+    // are sent for immediate use. Cheap enough to ask every UI frame.
+    float getPresentationLatencyMs() const;
     std::string getLastError() const;
 
+    // Frames go to the UDP transport when it is running and to the shared memory output
+    // when that is open; the two are independent.
     void updateFrameData(const OSCFrameUpdate& update);
+    // The same for a frame already built with buildFrameData, with the magnitudes it was
+    // built from for the spectrum message and the phases for peak tracks.
+    void updateFrameData(const OSCFrameData& frame,
+                         std::span<const float> magnitudes,
+                         std::span<const float> phases = {});
+    // For frames already built with buildFrameData; the frame's own timestamp is kept.
+    void sendFrameData(const OSCFrameData& frame);
+    void waitForPendingFrame();
 
     PendingOSCSettings consumePendingSettings();
     OSCStats getStats() const;
 
+    bool startSharedMemoryOutput(const std::string& name, std::string& errorMessage);
+    void stopSharedMemoryOutput();
+    bool isSharedMemoryOutputRunning() const;
+    std::string getSharedMemoryOutputName() const;
+    // Whether updateFrameData has anywhere to deliver to, so callers can skip building frames.
+    bool wantsFrames() const;
+
     static SynesthesiaOSCIntegration& getInstance();
 
 private:
     SynesthesiaOSCIntegration() = default;
 
     OSCRuntime runtime_;
+    SharedMemoryFrameOutput sharedMemory_;
 
     static std::unique_ptr<SynesthesiaOSCIntegration> instance_;
     static std::mutex instanceMutex_;
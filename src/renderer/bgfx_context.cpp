@@ -169,7 +169,14 @@ bool BgfxContext::initialise(const Window& window, uint32_t width, uint32_t heig
 
 #if defined(__APPLE__)
     // bgfx documentation and long-standing example code keep renderer startup on the API thread on macOS.
+    // Metal setup touches the window's view and GLFW needs this thread for events, so macOS stays
+    // single-threaded: renderFrame before init stops bgfx starting its own render thread.
     bgfx::renderFrame(0);
+    render_thread_ = false;
+#else
+    // bgfx::init starts a render thread of its own, so bgfx::frame hands each frame over and the
+    // UI pass for the next one overlaps the GPU submission of this one.
+    render_thread_ = true;
 #endif
 
     for (const auto colourFormat : kPreferredColourFormats) {
@@ -235,6 +242,10 @@ bool BgfxContext::isInitialised() const {
     return initialised_;
 }
 
+bool BgfxContext::usesRenderThread() const {
+    return initialised_ && render_thread_;
+}
+
 uint32_t BgfxContext::resetFlags() const {
     return reset_flags_;
 }
@@ -20,6 +20,7 @@ public:
     void setViewRects(uint16_t width, uint16_t height) const;
 
     [[nodiscard]] bool isInitialised() const;
+    [[nodiscard]] bool usesRenderThread() const;
     [[nodiscard]] uint32_t resetFlags() const;
     [[nodiscard]] bgfx::RendererType::Enum rendererType() const;
     [[nodiscard]] bool supportsMultipleWindows() const;
@@ -29,6 +30,7 @@ public:
 private:
     uint32_t reset_flags_ = BGFX_RESET_VSYNC;
     bool initialised_ = false;
+    bool render_thread_ = false;
     bgfx::TextureFormat::Enum colour_format_ = bgfx::TextureFormat::BGRA8;
 };
 
@@ -14,6 +14,10 @@ struct RecorderState;
 
 namespace Renderer {
 
+// A second window drawn by the one bgfx device into its own swap-chain frame buffer, through
+// views of its own. The PresentationResources textures and passes and the ImGui backend's
+// program are the main window's; only the ImGui context is separate, with a font atlas
+// built at this window's DPI, so makeCurrent switches ImGui's context and no graphics one.
 class DetachedVisualisationWindow {
 public:
     static constexpr bgfx::ViewId kClearViewId = 3;
@@ -0,0 +1,104 @@
+#include "renderer/frame_scheduler.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "renderer/window.h"
+
+namespace Renderer {
+
+namespace {
+
+constexpr auto kIdleFrameInterval = std::chrono::milliseconds(100);
+constexpr auto kHiddenFrameInterval = std::chrono::milliseconds(250);
+// Long enough for hover and press animations to settle after the last event.
+constexpr auto kInteractionGracePeriod = std::chrono::milliseconds(500);
+// The main window's UI still refreshes at a quarter of the loop rate however slow it is.
+constexpr int kMaxIterationsPerMainPass = 4;
+// glfwWaitEventsTimeout returning this much before its timeout means an event woke it.
+constexpr auto kEventWakeMargin = std::chrono::milliseconds(1);
+
+} // namespace
+
+void WindowPacer::setRateCap(const float framesPerSecond) {
+    if (framesPerSecond <= 0.0f) {
+        minimumInterval_ = Clock::duration::zero();
+        return;
+    }
+    minimumInterval_ = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / static_cast<double>(framesPerSecond)));
+}
+
+bool WindowPacer::isFrameDue(const Clock::time_point now) const {
+    return now >= nextFrameDue();
+}
+
+WindowPacer::Clock::time_point WindowPacer::nextFrameDue() const {
+    return lastPresented_ + minimumInterval_;
+}
+
+void WindowPacer::markPresented(const Clock::time_point now) {
+    lastPresented_ = now;
+}
+
+void FrameScheduler::waitForNextFrame(const Window& window, const Clock::time_point nextDue) {
+    if (mode_ != Mode::Live) {
+        const auto interval = mode_ == Mode::Hidden ? kHiddenFrameInterval : kIdleFrameInterval;
+        const auto waitStart = Clock::now();
+        const auto deadline = std::max(nextDue, lastFrame_ + interval);
+        if (deadline > waitStart) {
+            const auto timeout = std::chrono::duration<double>(deadline - waitStart);
+            window.waitEvents(timeout.count());
+            const auto woken = Clock::now();
+            if (woken + kEventWakeMargin < deadline) {
+                lastActivity_ = woken;
+                mode_ = Mode::Live;
+            }
+        }
+    }
+
+    if (Clock::now() < nextDue) {
+        std::this_thread::sleep_until(nextDue);
+    }
+    window.pollEvents();
+}
+
+void FrameScheduler::update(const Activity& activity, const Clock::time_point now) {
+    lastFrame_ = now;
+    if (activity.interacting) {
+        lastActivity_ = now;
+    }
+
+    if (!idleThrottling_) {
+        mode_ = Mode::Live;
+    } else if (!activity.anyWindowVisible) {
+        mode_ = Mode::Hidden;
+    } else if (activity.audioRunning || now - lastActivity_ < kInteractionGracePeriod) {
+        mode_ = Mode::Live;
+    } else {
+        mode_ = Mode::Idle;
+    }
+}
+
+bool MainPassBudget::isPassDue() const {
+    if (budget_ <= Clock::duration::zero() || averageCost_ <= budget_) {
+        return true;
+    }
+    const auto iterationsPerPass = std::min<Clock::rep>(
+        kMaxIterationsPerMainPass,
+        (averageCost_.count() + budget_.count() - 1) / budget_.count());
+    return iterationsSinceLastPass_ + 1 >= iterationsPerPass;
+}
+
+void MainPassBudget::passBuilt(const Clock::duration cost) {
+    // A short moving average, so one slow pass does not halve the main window's rate.
+    averageCost_ = averageCost_ == Clock::duration::zero() ? cost : (averageCost_ * 3 + cost) / 4;
+    iterationsSinceLastPass_ = 0;
+}
+
+void MainPassBudget::reset() {
+    averageCost_ = Clock::duration::zero();
+    iterationsSinceLastPass_ = 0;
+}
+
+} // namespace Renderer
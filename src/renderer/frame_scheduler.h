@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+
+namespace Renderer {
+
+class Window;
+
+// Keeps one window's presented frames at least a minimum interval apart. Uncapped, a window
+// presents every time the loop runs, which bgfx's vsync keeps in step with the display.
+class WindowPacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Zero or less removes the cap.
+    void setRateCap(float framesPerSecond);
+
+    [[nodiscard]] bool isFrameDue(Clock::time_point now) const;
+    [[nodiscard]] Clock::time_point nextFrameDue() const;
+    void markPresented(Clock::time_point now);
+
+private:
+    Clock::duration minimumInterval_{};
+    Clock::time_point lastPresented_{};
+};
+
+// Decides how the main loop waits between frames. While audio is running or the user is
+// interacting it polls, and vsync and the window caps pace the loop. Otherwise it sleeps in
+// the event queue, waking at the idle interval so progress and status text still move, and
+// far less often when no window can be seen. Any event wakes it and counts as interaction.
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Mode {
+        Live,
+        Idle,
+        Hidden
+    };
+
+    struct Activity {
+        bool audioRunning = false;
+        bool interacting = false;
+        bool anyWindowVisible = true;
+    };
+
+    // Off, the loop always runs live, as it did before idle throttling.
+    void setIdleThrottling(bool enabled) { idleThrottling_ = enabled; }
+
+    // Returns once the next frame should be built, with events polled. nextDue is the
+    // earliest time any open window's cap lets it present again.
+    void waitForNextFrame(const Window& window, Clock::time_point nextDue);
+
+    // Call once a frame has been submitted, with what that frame saw.
+    void update(const Activity& activity, Clock::time_point now);
+
+    [[nodiscard]] Mode mode() const { return mode_; }
+
+private:
+    Mode mode_ = Mode::Live;
+    bool idleThrottling_ = true;
+    Clock::time_point lastFrame_{};
+    Clock::time_point lastActivity_{};
+};
+
+// While the detached window is open, spreads an expensive main-window UI pass over several
+// loop iterations, so the detached window still presents on every one of them. Iterations
+// between passes resubmit the main window's previous draw data and only step the colours.
+class MainPassBudget {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // The time the main window's UI pass may take per loop iteration.
+    void setFrameBudget(Clock::duration budget) { budget_ = budget; }
+
+    [[nodiscard]] bool isPassDue() const;
+    void passSkipped() { ++iterationsSinceLastPass_; }
+    void passBuilt(Clock::duration cost);
+    void reset();
+
+private:
+    Clock::duration budget_{};
+    Clock::duration averageCost_{};
+    int iterationsSinceLastPass_ = 0;
+};
+
+} // namespace Renderer
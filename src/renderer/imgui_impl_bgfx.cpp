@@ -23,6 +23,8 @@ struct BackendData {
     bgfx::UniformHandle sampler = BGFX_INVALID_HANDLE;
     bgfx::ViewId viewId = 255;
     bool linearOutput = false;
+    // Set only while a draw callback runs.
+    const ImGui_Implbgfx_CallbackTarget* callbackTarget = nullptr;
 };
 
 const bgfx::EmbeddedShader kEmbeddedShaders[] = {
@@ -277,31 +279,71 @@ ImU32 linearisePackedColour(const ImU32 packedColour) {
         colour.w));
 }
 
-void invalidateDeviceObjects() {
-    BackendData* bd = getBackendData();
-    if (bd == nullptr) {
-        return;
-    }
+struct Scissor {
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+};
 
-    if (bgfx::isValid(bd->sampler)) {
-        bgfx::destroy(bd->sampler);
-        bd->sampler = BGFX_INVALID_HANDLE;
+bool clipToScissor(const ImVec4& commandClipRect,
+                   const ImVec2& clipOffset,
+                   const ImVec2& clipScale,
+                   const int framebufferWidth,
+                   const int framebufferHeight,
+                   Scissor& scissor) {
+    ImVec4 clipRect;
+    clipRect.x = (commandClipRect.x - clipOffset.x) * clipScale.x;
+    clipRect.y = (commandClipRect.y - clipOffset.y) * clipScale.y;
+    clipRect.z = (commandClipRect.z - clipOffset.x) * clipScale.x;
+    clipRect.w = (commandClipRect.w - clipOffset.y) * clipScale.y;
+
+    if (clipRect.x >= static_cast<float>(framebufferWidth) || clipRect.y >= static_cast<float>(framebufferHeight) ||
+        clipRect.z < 0.0f || clipRect.w < 0.0f) {
+        return false;
     }
 
-    if (bgfx::isValid(bd->program)) {
-        bgfx::destroy(bd->program);
-        bd->program = BGFX_INVALID_HANDLE;
+    const int scissorX = static_cast<int>(std::max(clipRect.x, 0.0f));
+    const int scissorY = static_cast<int>(std::max(clipRect.y, 0.0f));
+    const int scissorZ = static_cast<int>(std::min(clipRect.z, 65535.0f));
+    const int scissorW = static_cast<int>(std::min(clipRect.w, 65535.0f));
+    if (scissorZ <= scissorX || scissorW <= scissorY) {
+        return false;
     }
 
-    destroyManagedTextures();
+    scissor.x = static_cast<uint16_t>(scissorX);
+    scissor.y = static_cast<uint16_t>(scissorY);
+    scissor.width = static_cast<uint16_t>(scissorZ - scissorX);
+    scissor.height = static_cast<uint16_t>(scissorW - scissorY);
+    return true;
 }
 
-bool createDeviceObjects() {
-    BackendData* bd = getBackendData();
-    if (bd == nullptr) {
-        return false;
+// Every context draws with the same program, so the windows sharing the bgfx device create
+// it once and the last context to shut down destroys it.
+struct SharedDeviceObjects {
+    bgfx::ProgramHandle program = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle sampler = BGFX_INVALID_HANDLE;
+    int users = 0;
+};
+
+SharedDeviceObjects& sharedDeviceObjects() {
+    static SharedDeviceObjects objects;
+    return objects;
+}
+
+void destroySharedDeviceObjects(SharedDeviceObjects& shared) {
+    if (bgfx::isValid(shared.sampler)) {
+        bgfx::destroy(shared.sampler);
+        shared.sampler = BGFX_INVALID_HANDLE;
+    }
+
+    if (bgfx::isValid(shared.program)) {
+        bgfx::destroy(shared.program);
+        shared.program = BGFX_INVALID_HANDLE;
     }
+}
 
+bool createSharedDeviceObjects(SharedDeviceObjects& shared) {
     const bgfx::RendererType::Enum rendererType = bgfx::getRendererType();
     const bgfx::ShaderHandle vertexShader = bgfx::createEmbeddedShader(kEmbeddedShaders, rendererType, "vs_ocornut_imgui");
     const bgfx::ShaderHandle fragmentShader = bgfx::createEmbeddedShader(kEmbeddedShaders, rendererType, "fs_ocornut_imgui");
@@ -315,15 +357,46 @@ bool createDeviceObjects() {
         return false;
     }
 
-    bd->program = bgfx::createProgram(vertexShader, fragmentShader, true);
-    if (!bgfx::isValid(bd->program)) {
+    shared.program = bgfx::createProgram(vertexShader, fragmentShader, true);
+    shared.sampler = bgfx::createUniform("s_tex", bgfx::UniformType::Sampler);
+    if (!bgfx::isValid(shared.program) || !bgfx::isValid(shared.sampler)) {
+        destroySharedDeviceObjects(shared);
         return false;
     }
+    return true;
+}
 
-    bd->sampler = bgfx::createUniform("s_tex", bgfx::UniformType::Sampler);
-    if (!bgfx::isValid(bd->sampler)) {
+void invalidateDeviceObjects() {
+    BackendData* bd = getBackendData();
+    if (bd == nullptr) {
+        return;
+    }
+
+    if (bgfx::isValid(bd->program)) {
+        bd->program = BGFX_INVALID_HANDLE;
+        bd->sampler = BGFX_INVALID_HANDLE;
+        SharedDeviceObjects& shared = sharedDeviceObjects();
+        if (--shared.users == 0) {
+            destroySharedDeviceObjects(shared);
+        }
+    }
+
+    destroyManagedTextures();
+}
+
+bool createDeviceObjects() {
+    BackendData* bd = getBackendData();
+    if (bd == nullptr) {
+        return false;
+    }
+
+    SharedDeviceObjects& shared = sharedDeviceObjects();
+    if (shared.users == 0 && !createSharedDeviceObjects(shared)) {
         return false;
     }
+    ++shared.users;
+    bd->program = shared.program;
+    bd->sampler = shared.sampler;
 
     bd->layout.begin()
         .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float)
@@ -455,7 +528,22 @@ void ImGui_Implbgfx_RenderDrawData(ImDrawData* drawData) {
                 if (command->UserCallback == ImDrawCallback_ResetRenderState) {
                     continue;
                 }
+                ImGui_Implbgfx_CallbackTarget target;
+                target.encoder = encoder;
+                target.viewId = backend->viewId;
+                target.program = backend->program;
+                target.sampler = backend->sampler;
+                Scissor scissor;
+                const bool visible = clipToScissor(command->ClipRect, clipOffset, clipScale, framebufferWidth, framebufferHeight, scissor);
+                if (visible) {
+                    target.scissorX = scissor.x;
+                    target.scissorY = scissor.y;
+                    target.scissorWidth = scissor.width;
+                    target.scissorHeight = scissor.height;
+                }
+                backend->callbackTarget = visible ? &target : nullptr;
                 command->UserCallback(drawList, command);
+                backend->callbackTarget = nullptr;
                 continue;
             }
 
@@ -463,22 +551,8 @@ void ImGui_Implbgfx_RenderDrawData(ImDrawData* drawData) {
                 continue;
             }
 
-            ImVec4 clipRect;
-            clipRect.x = (command->ClipRect.x - clipOffset.x) * clipScale.x;
-            clipRect.y = (command->ClipRect.y - clipOffset.y) * clipScale.y;
-            clipRect.z = (command->ClipRect.z - clipOffset.x) * clipScale.x;
-            clipRect.w = (command->ClipRect.w - clipOffset.y) * clipScale.y;
-
-            if (clipRect.x >= static_cast<float>(framebufferWidth) || clipRect.y >= static_cast<float>(framebufferHeight) ||
-                clipRect.z < 0.0f || clipRect.w < 0.0f) {
-                continue;
-            }
-
-            const int scissorX = static_cast<int>(std::max(clipRect.x, 0.0f));
-            const int scissorY = static_cast<int>(std::max(clipRect.y, 0.0f));
-            const int scissorZ = static_cast<int>(std::min(clipRect.z, 65535.0f));
-            const int scissorW = static_cast<int>(std::min(clipRect.w, 65535.0f));
-            if (scissorZ <= scissorX || scissorW <= scissorY) {
+            Scissor scissor;
+            if (!clipToScissor(command->ClipRect, clipOffset, clipScale, framebufferWidth, framebufferHeight, scissor)) {
                 continue;
             }
 
@@ -497,12 +571,7 @@ void ImGui_Implbgfx_RenderDrawData(ImDrawData* drawData) {
                 BGFX_STATE_MSAA |
                 BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA);
 
-            encoder->setScissor(
-                static_cast<uint16_t>(scissorX),
-                static_cast<uint16_t>(scissorY),
-                static_cast<uint16_t>(scissorZ - scissorX),
-                static_cast<uint16_t>(scissorW - scissorY)
-            );
+            encoder->setScissor(scissor.x, scissor.y, scissor.width, scissor.height);
             encoder->setState(state);
             encoder->setTexture(0, backend->sampler, texture);
             encoder->setVertexBuffer(0, &vertexBuffer, 0, vertexCount);
@@ -527,3 +596,22 @@ void ImGui_Implbgfx_SetLinearOutput(const bool enabled) {
         backend->linearOutput = enabled;
     }
 }
+
+bool ImGui_Implbgfx_GetCallbackTarget(ImGui_Implbgfx_CallbackTarget& target) {
+    const BackendData* backend = getBackendData();
+    if (backend == nullptr || backend->callbackTarget == nullptr) {
+        return false;
+    }
+
+    target = *backend->callbackTarget;
+    return true;
+}
+
+uint32_t ImGui_Implbgfx_OutputColour(const uint32_t packedColour) {
+    const BackendData* backend = getBackendData();
+    if (backend == nullptr || !backend->linearOutput) {
+        return packedColour;
+    }
+
+    return linearisePackedColour(packedColour);
+}
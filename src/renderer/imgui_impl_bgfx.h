@@ -10,3 +10,22 @@ void ImGui_Implbgfx_NewFrame();
 void ImGui_Implbgfx_RenderDrawData(ImDrawData* drawData);
 void ImGui_Implbgfx_SetViewId(bgfx::ViewId viewId);
 void ImGui_Implbgfx_SetLinearOutput(bool enabled);
+
+// What a draw callback needs to submit its own geometry in ImGui's draw order: the encoder and
+// view the draw list is going to, the backend's program, and the command's clip rect as a
+// scissor. The view transform maps ImGui's display coordinates.
+struct ImGui_Implbgfx_CallbackTarget {
+    bgfx::Encoder* encoder = nullptr;
+    bgfx::ViewId viewId = 255;
+    bgfx::ProgramHandle program = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle sampler = BGFX_INVALID_HANDLE;
+    uint16_t scissorX = 0;
+    uint16_t scissorY = 0;
+    uint16_t scissorWidth = 0;
+    uint16_t scissorHeight = 0;
+};
+
+// Only valid inside a draw callback; returns false elsewhere or when the command is clipped away.
+bool ImGui_Implbgfx_GetCallbackTarget(ImGui_Implbgfx_CallbackTarget& target);
+// Converts a packed ImGui colour to what the backend writes, linearised for linear output.
+uint32_t ImGui_Implbgfx_OutputColour(uint32_t packedColour);
@@ -1,17 +1,25 @@
 #include "renderer/bgfx_context.h"
 #include "renderer/detached_visualisation_window.h"
+#include "renderer/frame_scheduler.h"
 #include "renderer/imgui_window_context.h"
 #include "renderer/presentation_resources.h"
 #include "renderer/render_utils.h"
+#include "renderer/startup_profile.h"
 #include "renderer/styling/platform_styling.h"
 #include "renderer/window.h"
 
+#include "audio_device_registry.h"
 #include "audio_input.h"
 #include "audio_output.h"
+#include "resyne/recorder/recorder.h"
 #include "ui.h"
 #include "ui/dragdrop/file_drop_manager.h"
 #include "ui/input/trackpad_gestures.h"
 #include "ui/styling/system_theme/system_theme_detector.h"
+#include "utilities/profiling/frame_profiler.h"
+#include "utilities/telemetry/latency_probe.h"
+#include "utilities/telemetry/telemetry_exporter.h"
+#include "utilities/threading/realtime_thread.h"
 #include "utilities/video/ffmpeg_locator.h"
 
 #ifdef ENABLE_MIDI
@@ -22,15 +30,18 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
-#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace {
 
 constexpr int kDefaultWindowWidth = 1480;
 constexpr int kDefaultWindowHeight = 750;
-constexpr int kTargetFramesPerSecond = 120;
-constexpr int kTargetFrameDurationMicroseconds = 1'000'000 / kTargetFramesPerSecond;
 
 PresentationDiagnostics::DisplaySurfacePrecision displaySurfacePrecisionFromFormat(
     const bgfx::TextureFormat::Enum colourFormat) {
@@ -44,6 +55,14 @@ PresentationDiagnostics::DisplaySurfacePrecision displaySurfacePrecisionFromForm
     }
 }
 
+// Half of a 60 Hz frame when the detached window follows the display, leaving the rest of
+// the interval for its own pass and the submission.
+std::chrono::steady_clock::duration detachedFrameBudget(const float detachedRateCap) {
+    const float framesPerSecond = detachedRateCap > 0.0f ? detachedRateCap : 60.0f;
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>(0.5f / framesPerSecond));
+}
+
 void getThemeBackgroundColour(float* colour) {
     const SystemTheme theme = SystemThemeDetector::detectSystemTheme();
     if (theme == SystemTheme::Light) {
@@ -59,6 +78,87 @@ void getThemeBackgroundColour(float* colour) {
     }
 }
 
+#ifdef ENABLE_MIDI
+// MIDI ports are listed off the main thread at start-up, as the audio devices are by the
+// registry, while the UI runs without them.
+struct StartupMidiDevices {
+    std::vector<MIDIInput::DeviceInfo> devices;
+    std::chrono::steady_clock::duration duration{};
+};
+
+StartupMidiDevices enumerateStartupMidiDevices() {
+    const auto start = std::chrono::steady_clock::now();
+    StartupMidiDevices midiDevices;
+    midiDevices.devices = MIDIInput::getMIDIInputDevices();
+    midiDevices.duration = std::chrono::steady_clock::now() - start;
+    return midiDevices;
+}
+#endif
+
+bool hasArgument(const int argc, char** argv, const char* argument) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], argument) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* argumentValue(const int argc, char** argv, const char* argument) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], argument) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return nullptr;
+}
+
+// The same --host-api, --buffer-frames and --latency-ms the headless mode takes.
+AudioStreamSettings streamSettingsFromArguments(const int argc, char** argv) {
+    AudioStreamSettings settings;
+    if (const char* hostApi = argumentValue(argc, argv, "--host-api")) {
+        if (const auto parsed = AudioStreamConfig::parseHostApi(hostApi)) {
+            settings.hostApi = *parsed;
+        } else {
+            std::fprintf(stderr, "Unknown host API: %s\n", hostApi);
+        }
+    }
+    if (const char* frames = argumentValue(argc, argv, "--buffer-frames")) {
+        settings.framesPerBuffer = std::clamp(std::atoi(frames), 0, 8192);
+    }
+    if (const char* latency = argumentValue(argc, argv, "--latency-ms")) {
+        settings.suggestedLatencySeconds = std::max(0.0, std::atof(latency)) / 1000.0;
+    }
+    return settings;
+}
+
+// The same --realtime, --rt-priority, --cpu-* and --keep-denormals the headless mode takes.
+Utilities::Threading::ThreadConfiguration threadConfigurationFromArguments(const int argc, char** argv) {
+    Utilities::Threading::ThreadConfiguration configuration;
+    for (int i = 1; i < argc; ++i) {
+        configuration.parseArgument(i, argc, argv);
+    }
+    return configuration;
+}
+
+// The same --metrics-file, --statsd and --metrics-interval the headless mode takes.
+Utilities::Telemetry::ExportConfig telemetryExportFromArguments(const int argc, char** argv) {
+    Utilities::Telemetry::ExportConfig config;
+    for (int i = 1; i < argc; ++i) {
+        config.parseArgument(i, argc, argv);
+    }
+    return config;
+}
+
+// --latency-probe and --latency-report, as the headless mode takes them.
+Utilities::Telemetry::LatencyProbe::Config latencyProbeFromArguments(const int argc, char** argv) {
+    Utilities::Telemetry::LatencyProbe::Config config;
+    for (int i = 1; i < argc; ++i) {
+        config.parseArgument(i, argc, argv);
+    }
+    return config;
+}
+
 #ifdef ENABLE_MIDI
 void initialiseMidiState(UIState& uiState, MIDIInput& midiInput, std::vector<MIDIInput::DeviceInfo>& midiDevices) {
     uiState.midiDevicesAvailable = !midiDevices.empty();
@@ -76,7 +176,9 @@ void initialiseMidiState(UIState& uiState, MIDIInput& midiInput, std::vector<MID
 
 } // namespace
 
-int app_main(int, char**) {
+int app_main(int argc, char** argv) {
+    Renderer::StartupProfile startupProfile(hasArgument(argc, argv, "--profile-startup"));
+
     if (!Renderer::initialiseWindowing()) {
         std::fprintf(stderr, "Failed to initialise GLFW\n");
         return 1;
@@ -96,6 +198,7 @@ int app_main(int, char**) {
     Renderer::Styling::applyPlatformWindowStyling(window.handle());
     window.show();
     window.realiseForRenderer();
+    startupProfile.mark("Window");
 
     const Renderer::FramebufferSize initialSize = window.framebufferSize();
 
@@ -109,6 +212,7 @@ int app_main(int, char**) {
         Renderer::shutdownWindowing();
         return 1;
     }
+    startupProfile.mark("bgfx");
 
     Renderer::ImGuiWindowContext mainWindowContext;
     if (!mainWindowContext.initialise(window, Renderer::BgfxContext::kImGuiViewId, bgfxContext.usesLinearPresentation())) {
@@ -119,27 +223,57 @@ int app_main(int, char**) {
         return 1;
     }
 
+    startupProfile.mark("ImGui and fonts");
+
     FileDropManager::attach(window.handle());
     TrackpadGestures::attach(window.handle());
 
-    auto& ffmpegLocator = Utilities::Video::FFmpegLocator::instance();
-    ffmpegLocator.refresh();
+    float clearColour[4];
+    getThemeBackgroundColour(clearColour);
+
+    // Present the theme colour before the audio and tool start-up below, so the window is
+    // filled straight away rather than blank until the first UI frame.
+    if (initialSize.width > 0 && initialSize.height > 0) {
+        bgfxContext.setViewRects(static_cast<uint16_t>(initialSize.width), static_cast<uint16_t>(initialSize.height));
+        bgfx::setViewClear(Renderer::BgfxContext::kClearViewId, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH,
+                           Renderer::packRgba8(clearColour[0], clearColour[1], clearColour[2], clearColour[3]), 1.0f, 0);
+        bgfx::touch(Renderer::BgfxContext::kClearViewId);
+        bgfx::frame();
+    }
+    startupProfile.mark("First frame");
 
+    Utilities::Threading::setConfiguration(threadConfigurationFromArguments(argc, argv));
+    const Utilities::Telemetry::Exporter telemetryExporter(telemetryExportFromArguments(argc, argv));
     AudioInput audioInput;
-    std::vector<AudioInput::DeviceInfo> inputDevices = AudioInput::getInputDevices();
-    std::vector<AudioOutput::DeviceInfo> outputDevices = AudioOutput::getOutputDevices();
+    const bool decimateAnalysis = hasArgument(argc, argv, "--decimate-analysis");
+    audioInput.getAudioProcessor().setAnalysisDecimationEnabled(decimateAnalysis);
+    startupProfile.mark("PortAudio");
+
+    // Declared after audioInput, so its worker stops before PortAudio terminates.
+    AudioDeviceRegistry deviceRegistry;
+    const AudioStreamSettings streamSettings = streamSettingsFromArguments(argc, argv);
+    deviceRegistry.setHostApi(streamSettings.hostApi);
+    deviceRegistry.start();
+    // The UI keeps pointers into the current snapshot's lists until the version moves on.
+    auto deviceSnapshot = std::make_shared<const AudioDeviceRegistry::Snapshot>();
 
 #ifdef ENABLE_MIDI
     MIDIInput midiInput;
-    std::vector<MIDIInput::DeviceInfo> midiDevices = MIDIInput::getMIDIInputDevices();
+    std::vector<MIDIInput::DeviceInfo> midiDevices;
+    startupProfile.mark("MIDI");
+    std::future<StartupMidiDevices> startupMidiDevices = std::async(std::launch::async, enumerateStartupMidiDevices);
 #endif
 
-    float clearColour[4];
-    getThemeBackgroundColour(clearColour);
+    auto& ffmpegLocator = Utilities::Video::FFmpegLocator::instance();
+    ffmpegLocator.refresh();
+    startupProfile.mark("FFmpeg detection");
 
     UIState uiState;
+    uiState.deviceState.streamSettings = streamSettings;
+    uiState.deviceState.listedHostApi = streamSettings.hostApi;
     uiState.presentationDiagnostics.displaySurfacePrecision =
         displaySurfacePrecisionFromFormat(bgfxContext.colourFormat());
+    uiState.presentationDiagnostics.renderThreadActive = bgfxContext.usesRenderThread();
     Renderer::PresentationResources presentationResources;
     if (!presentationResources.initialise()) {
         std::fprintf(stderr, "[renderer] Failed to initialise presentation resources, falling back to legacy colour widgets\n");
@@ -156,26 +290,85 @@ int app_main(int, char**) {
     }
     auto& recorderState = uiState.resyneState.recorderState;
     recorderState.presentationResources = uiState.presentationResources;
+    recorderState.importDecimateHighRates = decimateAnalysis;
     recorderState.detachedVisualisation.available = bgfxContext.supportsMultipleWindows();
     Renderer::DetachedVisualisationWindow detachedVisualisationWindow;
+    startupProfile.mark("Presentation resources");
+
+    namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+    const LatencyProbe::Config latencyProbe = latencyProbeFromArguments(argc, argv);
+    if (latencyProbe.enabled) {
+        if (latencyProbe.source == LatencyProbe::Source::OutputImpulse &&
+            !ReSyne::Recorder::ensureProbeOutput(recorderState)) {
+            std::fprintf(stderr, "[latency] Unable to open an output for the test impulse\n");
+        } else {
+            LatencyProbe::start(latencyProbe.source);
+        }
+    }
 
-#ifdef ENABLE_MIDI
-    initialiseMidiState(uiState, midiInput, midiDevices);
-#endif
-
-    constexpr auto targetFrameDuration = std::chrono::microseconds(kTargetFrameDurationMicroseconds);
+    Renderer::FrameScheduler frameScheduler;
+    Renderer::WindowPacer mainWindowPacer;
+    Renderer::WindowPacer detachedWindowPacer;
+    Renderer::MainPassBudget mainPassBudget;
+    auto previousFrameStart = std::chrono::steady_clock::now();
+    bool interacting = false;
 
     int previousWidth = std::max(initialSize.width, 1);
     int previousHeight = std::max(initialSize.height, 1);
+    bool firstFrameSubmitted = false;
+    const auto reportStartupOnceSettled = [&]() {
+        bool settled = firstFrameSubmitted && deviceSnapshot->version > 0;
+#ifdef ENABLE_MIDI
+        settled = settled && !startupMidiDevices.valid();
+#endif
+        if (settled) {
+            startupProfile.report();
+        }
+    };
 
     while (!window.shouldClose()) {
+        deviceRegistry.setHostApi(uiState.deviceState.streamSettings.hostApi);
+        if (deviceRegistry.version() != deviceSnapshot->version) {
+            const bool firstDeviceList = deviceSnapshot->version == 0;
+            deviceSnapshot = deviceRegistry.snapshot();
+            uiState.deviceState.deviceListVersion = deviceSnapshot->version;
+            uiState.deviceState.audioHardwareChanged = deviceSnapshot->hardwareChanged;
+            if (deviceSnapshot->hostApi != uiState.deviceState.listedHostApi) {
+                uiState.deviceState.listedHostApi = deviceSnapshot->hostApi;
+                DeviceManager::resetDeviceSelection(uiState.deviceState, audioInput);
+            }
+            if (firstDeviceList) {
+                startupProfile.addBackgroundStep("Audio device enumeration", deviceSnapshot->enumerationTime);
+                reportStartupOnceSettled();
+            }
+        }
+#ifdef ENABLE_MIDI
+        if (startupMidiDevices.valid() &&
+            startupMidiDevices.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            StartupMidiDevices startupMidi = startupMidiDevices.get();
+            midiDevices = std::move(startupMidi.devices);
+            initialiseMidiState(uiState, midiInput, midiDevices);
+            startupProfile.addBackgroundStep("MIDI enumeration", startupMidi.duration);
+            reportStartupOnceSettled();
+        }
+#endif
+
+        frameScheduler.setIdleThrottling(uiState.framePacing.idleThrottling);
+        mainWindowPacer.setRateCap(uiState.framePacing.mainWindowRateCap);
+        detachedWindowPacer.setRateCap(uiState.framePacing.detachedWindowRateCap);
+        // Both windows draw colours stepped once per iteration, so the loop runs at the faster
+        // window and the detached window skips iterations beyond its own cap.
+        auto nextFrameDue = mainWindowPacer.nextFrameDue();
+        if (recorderState.detachedVisualisation.isOpen) {
+            nextFrameDue = std::min(nextFrameDue, detachedWindowPacer.nextFrameDue());
+        }
+        frameScheduler.waitForNextFrame(window, nextFrameDue);
         const auto frameStart = std::chrono::steady_clock::now();
-        window.pollEvents();
 
         const Renderer::FramebufferSize currentSize = window.framebufferSize();
         const int framebufferWidth = currentSize.width;
         const int framebufferHeight = currentSize.height;
-        const bool mainWindowVisible = framebufferWidth > 0 && framebufferHeight > 0;
+        const bool mainWindowVisible = framebufferWidth > 0 && framebufferHeight > 0 && !window.isIconified();
 
         if (mainWindowVisible && (framebufferWidth != previousWidth || framebufferHeight != previousHeight)) {
             bgfxContext.reset(static_cast<uint32_t>(framebufferWidth), static_cast<uint32_t>(framebufferHeight));
@@ -187,15 +380,36 @@ int app_main(int, char**) {
             bgfxContext.setViewRects(static_cast<uint16_t>(framebufferWidth), static_cast<uint16_t>(framebufferHeight));
         }
 
-        mainWindowContext.beginFrame();
+        const float deltaTime = std::chrono::duration<float>(frameStart - previousFrameStart).count();
+        previousFrameStart = frameStart;
+        updatePresentation(audioInput, clearColour, deltaTime, uiState);
+
+        // With the detached window open, a main-window UI pass that runs long is only rebuilt
+        // every few iterations, so the detached window keeps presenting on every one.
+        const bool detachedOpen = recorderState.detachedVisualisation.isOpen;
+        if (detachedOpen) {
+            mainPassBudget.setFrameBudget(detachedFrameBudget(uiState.framePacing.detachedWindowRateCap));
+        } else {
+            mainPassBudget.reset();
+        }
+        if (!detachedOpen || mainPassBudget.isPassDue()) {
+            SYN_PROFILE_SCOPE(UIBuild);
+            const auto passStart = std::chrono::steady_clock::now();
+            mainWindowContext.beginFrame();
 
-        updateUI(audioInput, inputDevices, outputDevices, clearColour, ImGui::GetIO(), uiState
+            updateUI(audioInput, deviceSnapshot->inputDevices, deviceSnapshot->outputDevices, clearColour, ImGui::GetIO(), uiState
 #ifdef ENABLE_MIDI
-                 , &midiInput, &midiDevices
+                     , &midiInput, &midiDevices
 #endif
-        );
-
-        mainWindowContext.endFrame();
+            );
+
+            interacting = ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput;
+            mainWindowContext.endFrame();
+            mainPassBudget.passBuilt(std::chrono::steady_clock::now() - passStart);
+        } else {
+            // The previous pass's draw data is submitted again below.
+            mainPassBudget.passSkipped();
+        }
 
         if (recorderState.detachedVisualisation.openRequested && !recorderState.detachedVisualisation.isOpen) {
             uiState.visualSettings.activeView = UIState::View::ReSyne;
@@ -213,36 +427,52 @@ int app_main(int, char**) {
             mainWindowContext.makeCurrent();
         }
 
-        if (mainWindowVisible) {
-            const bool usedPresentationBackground =
-                uiState.presentationResources != nullptr &&
-                uiState.presentationResources->submitBackground(
-                    Renderer::BgfxContext::kBackgroundViewId,
-                    static_cast<uint16_t>(framebufferWidth),
-                    static_cast<uint16_t>(framebufferHeight),
-                    clearColour[0],
-                    clearColour[1],
-                    clearColour[2]);
-            const uint32_t packedClear = usedPresentationBackground
-                ? Renderer::packRgba8(0.0f, 0.0f, 0.0f, clearColour[3])
-                : Renderer::packRgba8(clearColour[0], clearColour[1], clearColour[2], clearColour[3]);
-            bgfx::setViewClear(Renderer::BgfxContext::kClearViewId, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, packedClear, 1.0f, 0);
-            bgfx::touch(Renderer::BgfxContext::kClearViewId);
-            mainWindowContext.renderDrawData();
-        }
+        {
+            SYN_PROFILE_SCOPE(RenderSubmit);
+            if (mainWindowVisible) {
+                const bool usedPresentationBackground =
+                    uiState.presentationResources != nullptr &&
+                    uiState.presentationResources->submitBackground(
+                        Renderer::BgfxContext::kBackgroundViewId,
+                        static_cast<uint16_t>(framebufferWidth),
+                        static_cast<uint16_t>(framebufferHeight),
+                        clearColour[0],
+                        clearColour[1],
+                        clearColour[2]);
+                const uint32_t packedClear = usedPresentationBackground
+                    ? Renderer::packRgba8(0.0f, 0.0f, 0.0f, clearColour[3])
+                    : Renderer::packRgba8(clearColour[0], clearColour[1], clearColour[2], clearColour[3]);
+                bgfx::setViewClear(Renderer::BgfxContext::kClearViewId, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, packedClear, 1.0f, 0);
+                bgfx::touch(Renderer::BgfxContext::kClearViewId);
+                mainWindowContext.renderDrawData();
+            }
 
-        if (recorderState.detachedVisualisation.isOpen) {
-            detachedVisualisationWindow.renderFrame(uiState, audioInput);
-            mainWindowContext.makeCurrent();
-        }
+            mainWindowPacer.markPresented(frameStart);
 
-        bgfx::frame();
+            if (recorderState.detachedVisualisation.isOpen && detachedWindowPacer.isFrameDue(frameStart)) {
+                detachedVisualisationWindow.renderFrame(uiState, audioInput);
+                detachedWindowPacer.markPresented(frameStart);
+                mainWindowContext.makeCurrent();
+            }
+
+            bgfx::frame();
+            Utilities::Telemetry::LatencyProbe::framePresented();
+        }
 
-        const auto frameEnd = std::chrono::steady_clock::now();
-        const auto frameDuration = frameEnd - frameStart;
-        if (frameDuration < targetFrameDuration) {
-            std::this_thread::sleep_for(targetFrameDuration - frameDuration);
+        if (!firstFrameSubmitted) {
+            firstFrameSubmitted = true;
+            startupProfile.mark("First UI frame");
+            reportStartupOnceSettled();
         }
+
+        Renderer::FrameScheduler::Activity activity;
+        activity.audioRunning =
+            (uiState.deviceState.selectedDeviceIndex >= 0 && !uiState.deviceState.streamError && audioInput.isStreamActive()) ||
+            (recorderState.audioOutput != nullptr && recorderState.audioOutput->isPlaying()) ||
+            recorderState.isRecording.load(std::memory_order_acquire);
+        activity.interacting = interacting;
+        activity.anyWindowVisible = mainWindowVisible || recorderState.detachedVisualisation.isOpen;
+        frameScheduler.update(activity, frameStart);
     }
 
     if (recorderState.detachedVisualisation.isOpen) {
@@ -250,6 +480,14 @@ int app_main(int, char**) {
         mainWindowContext.makeCurrent();
     }
 
+    if (!latencyProbe.reportFile.empty()) {
+        std::string errorMessage;
+        if (!LatencyProbe::writeJson(LatencyProbe::collect(), latencyProbe.reportFile, errorMessage)) {
+            std::fprintf(stderr, "[latency] %s\n", errorMessage.c_str());
+        }
+    }
+    LatencyProbe::stop();
+
     presentationResources.shutdown();
     TrackpadGestures::shutdown();
     mainWindowContext.shutdown();
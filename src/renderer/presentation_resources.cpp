@@ -2,6 +2,10 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <span>
 #include <cstdint>
 #include <limits>
@@ -16,6 +20,7 @@
 #include "../../vendor/bgfx/examples/common/imgui/vs_ocornut_imgui.bin.h"
 
 #include "colour/colour_presentation.h"
+#include "renderer/imgui_impl_bgfx.h"
 #include "resyne/ui/timeline/timeline_rasteriser.h"
 
 namespace Renderer {
@@ -62,6 +67,26 @@ ImTextureID textureIdFromHandle(const bgfx::TextureHandle handle) {
 
     return static_cast<ImTextureID>(handle.idx);
 }
+
+// Each spectrum point has a fill vertex on the baseline and one on the curve, then the line's
+// cross-section: a transparent fringe, two core vertices and another fringe.
+constexpr std::uint32_t kSpectrumVerticesPerPoint = 6;
+constexpr std::uint32_t kSpectrumIndicesPerSegment = 24;
+constexpr std::uint32_t kMaxSpectrumPoints = 2048;
+constexpr float kSpectrumLineFringe = 1.0f;
+
+// Copied into the draw list with AddCallback, so resubmitted draw data still draws it.
+// pointCount floats follow it.
+struct SpectrumCallbackHeader {
+    const void* pass = nullptr;
+    ImVec2 rectMin;
+    ImVec2 rectMax;
+    float maxValue = 1.0f;
+    float lineWidth = 1.0f;
+    ImU32 lineColour = 0;
+    ImU32 fillColour = 0;
+    std::uint32_t pointCount = 0;
+};
  
 } // namespace
 
@@ -84,6 +109,7 @@ public:
         texture_ = BGFX_INVALID_HANDLE;
         width_ = 0;
         height_ = 0;
+        hasSolidTexel_ = false;
     }
 
     bool update(const std::span<const float> rgbaPixels,
@@ -94,31 +120,81 @@ public:
             return false;
         }
 
-        if (!ensureTexture(width, height, format)) {
+        hasSolidTexel_ = false;
+        if (!ensureTexture(width, height, format, false)) {
             return false;
         }
 
-        const bgfx::Memory* memory = nullptr;
-        if (format_ == bgfx::TextureFormat::RGBA16F) {
-            halfPixels_.resize(rgbaPixels.size());
-            for (std::size_t index = 0; index < rgbaPixels.size(); ++index) {
-                halfPixels_[index] = bx::halfFromFloat(rgbaPixels[index]);
+        const bgfx::Memory* memory = copyPixels(rgbaPixels);
+        if (memory == nullptr) {
+            return false;
+        }
+
+        bgfx::updateTexture2D(texture_, 0, 0, 0, 0, width, height, memory);
+        return true;
+    }
+
+    // A 1x1 texture that only goes up when its colour differs from the one already uploaded,
+    // so a swatch or background holding still costs no texture update.
+    bool updateSolid(const std::array<float, 4>& rgba, const bgfx::TextureFormat::Enum format) {
+        if (hasSolidTexel_ && solidTexel_ == rgba && bgfx::isValid(texture_) && format_ == format) {
+            return true;
+        }
+        if (!update(rgba, 1, 1, format)) {
+            return false;
+        }
+        solidTexel_ = rgba;
+        hasSolidTexel_ = true;
+        return true;
+    }
+
+    // Uploads a one-texel-high texture with a full mip chain; levels[k] holds
+    // max(1, width >> k) RGBA texels.
+    bool updateMipChain(const std::span<const std::vector<float>> levels,
+                        const uint16_t width,
+                        const bgfx::TextureFormat::Enum format) {
+        if (width == 0 || levels.size() != static_cast<std::size_t>(std::bit_width(width))) {
+            return false;
+        }
+        for (std::size_t level = 0; level < levels.size(); ++level) {
+            if (levels[level].size() < static_cast<std::size_t>(std::max(1, width >> level)) * 4) {
+                return false;
             }
-            memory = bgfx::copy(halfPixels_.data(), static_cast<uint32_t>(halfPixels_.size() * sizeof(std::uint16_t)));
-        } else {
-            bytePixels_.resize(rgbaPixels.size());
-            for (std::size_t index = 0; index < rgbaPixels.size(); ++index) {
-                bytePixels_[index] = static_cast<std::uint8_t>(
-                    std::clamp(rgbaPixels[index], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+
+        hasSolidTexel_ = false;
+        if (!ensureTexture(width, 1, format, true)) {
+            return false;
+        }
+
+        for (std::size_t level = 0; level < levels.size(); ++level) {
+            const auto levelWidth = static_cast<uint16_t>(std::max(1, width >> level));
+            const bgfx::Memory* memory = copyPixels(std::span<const float>(levels[level]).first(levelWidth * 4u));
+            if (memory == nullptr) {
+                return false;
             }
-            memory = bgfx::copy(bytePixels_.data(), static_cast<uint32_t>(bytePixels_.size()));
+            bgfx::updateTexture2D(texture_, 0, static_cast<uint8_t>(level), 0, 0, levelWidth, 1, memory);
         }
+        return true;
+    }
 
-        if (memory == nullptr) {
+    [[nodiscard]] bool hasMipChain(const uint16_t width, const bgfx::TextureFormat::Enum format) const {
+        return bgfx::isValid(texture_) && width_ == width && height_ == 1 && format_ == format && mipmapped_;
+    }
+
+    // Rewrites texels [x, x + rgbaPixels.size() / 4) of one level of the existing chain.
+    bool updateMipRegion(const uint8_t level, const uint16_t x, const std::span<const float> rgbaPixels) {
+        const auto texelCount = static_cast<uint16_t>(rgbaPixels.size() / 4);
+        if (!mipmapped_ || !bgfx::isValid(texture_) || texelCount == 0 ||
+            static_cast<std::size_t>(x) + texelCount > static_cast<std::size_t>(std::max(1, width_ >> level))) {
             return false;
         }
 
-        bgfx::updateTexture2D(texture_, 0, 0, 0, 0, width, height, memory);
+        const bgfx::Memory* memory = copyPixels(rgbaPixels.first(static_cast<std::size_t>(texelCount) * 4));
+        if (memory == nullptr) {
+            return false;
+        }
+        bgfx::updateTexture2D(texture_, 0, level, x, 0, texelCount, 1, memory);
         return true;
     }
 
@@ -131,13 +207,32 @@ public:
     }
 
 private:
+    const bgfx::Memory* copyPixels(const std::span<const float> rgbaPixels) {
+        if (format_ == bgfx::TextureFormat::RGBA16F) {
+            halfPixels_.resize(rgbaPixels.size());
+            for (std::size_t index = 0; index < rgbaPixels.size(); ++index) {
+                halfPixels_[index] = bx::halfFromFloat(rgbaPixels[index]);
+            }
+            return bgfx::copy(halfPixels_.data(), static_cast<uint32_t>(halfPixels_.size() * sizeof(std::uint16_t)));
+        }
+
+        bytePixels_.resize(rgbaPixels.size());
+        for (std::size_t index = 0; index < rgbaPixels.size(); ++index) {
+            bytePixels_[index] = static_cast<std::uint8_t>(
+                std::clamp(rgbaPixels[index], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+        return bgfx::copy(bytePixels_.data(), static_cast<uint32_t>(bytePixels_.size()));
+    }
+
     bool ensureTexture(const uint16_t width,
                        const uint16_t height,
-                       const bgfx::TextureFormat::Enum format) {
+                       const bgfx::TextureFormat::Enum format,
+                       const bool mipmapped) {
         if (bgfx::isValid(texture_) &&
             width_ == width &&
             height_ == height &&
-            format_ == format) {
+            format_ == format &&
+            mipmapped_ == mipmapped) {
             return true;
         }
 
@@ -146,7 +241,7 @@ private:
         texture_ = bgfx::createTexture2D(
             width,
             height,
-            false,
+            mipmapped,
             1,
             format,
             BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP
@@ -159,6 +254,7 @@ private:
         width_ = width;
         height_ = height;
         format_ = format;
+        mipmapped_ = mipmapped;
         return true;
     }
 
@@ -167,6 +263,9 @@ private:
     bgfx::TextureFormat::Enum format_ = bgfx::TextureFormat::RGBA8;
     std::uint16_t width_ = 0;
     std::uint16_t height_ = 0;
+    bool mipmapped_ = false;
+    std::array<float, 4> solidTexel_{};
+    bool hasSolidTexel_ = false;
     std::vector<std::uint16_t> halfPixels_;
     std::vector<std::uint8_t> bytePixels_;
 };
@@ -265,6 +364,149 @@ private:
     bgfx::UniformHandle sampler_ = BGFX_INVALID_HANDLE;
 };
 
+// Draws the spectrum from inside the ImGui pass with the backend's program and a white texel.
+// The index buffer never changes, so a frame only writes the vertices, a fixed number per point
+// whatever the FFT size.
+class PresentationResources::SpectrumPass {
+public:
+    ~SpectrumPass() {
+        shutdown();
+    }
+
+    bool initialise() {
+        shutdown();
+
+        FullscreenVertex::initialiseLayout();
+
+        constexpr std::uint32_t whiteTexel = UINT32_MAX;
+        whiteTexture_ = bgfx::createTexture2D(1, 1, false, 1, bgfx::TextureFormat::RGBA8,
+                                              BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP,
+                                              bgfx::copy(&whiteTexel, sizeof(whiteTexel)));
+        if (!bgfx::isValid(whiteTexture_)) {
+            return false;
+        }
+        bgfx::setName(whiteTexture_, "SpectrumWhiteTexel");
+
+        std::vector<std::uint16_t> indices;
+        indices.reserve(static_cast<std::size_t>(kMaxSpectrumPoints - 1) * kSpectrumIndicesPerSegment);
+        const auto addQuad = [&indices](const std::uint32_t a0, const std::uint32_t a1,
+                                        const std::uint32_t b0, const std::uint32_t b1) {
+            for (const std::uint32_t index : {a0, a1, b1, a0, b1, b0}) {
+                indices.push_back(static_cast<std::uint16_t>(index));
+            }
+        };
+        for (std::uint32_t point = 0; point + 1 < kMaxSpectrumPoints; ++point) {
+            const std::uint32_t a = point * kSpectrumVerticesPerPoint;
+            const std::uint32_t b = a + kSpectrumVerticesPerPoint;
+            addQuad(a, a + 1, b, b + 1);
+            addQuad(a + 2, a + 3, b + 2, b + 3);
+            addQuad(a + 3, a + 4, b + 3, b + 4);
+            addQuad(a + 4, a + 5, b + 4, b + 5);
+        }
+        indexBuffer_ = bgfx::createIndexBuffer(
+            bgfx::copy(indices.data(), static_cast<std::uint32_t>(indices.size() * sizeof(std::uint16_t))));
+        return bgfx::isValid(indexBuffer_);
+    }
+
+    void shutdown() {
+        if (bgfx::isValid(indexBuffer_)) {
+            bgfx::destroy(indexBuffer_);
+            indexBuffer_ = BGFX_INVALID_HANDLE;
+        }
+        if (bgfx::isValid(whiteTexture_)) {
+            bgfx::destroy(whiteTexture_);
+            whiteTexture_ = BGFX_INVALID_HANDLE;
+        }
+    }
+
+    static void drawCallback(const ImDrawList*, const ImDrawCmd* command) {
+        SpectrumCallbackHeader header;
+        if (command->UserCallbackDataSize < static_cast<int>(sizeof(header))) {
+            return;
+        }
+        const auto* data = static_cast<const std::byte*>(command->UserCallbackData);
+        std::memcpy(&header, data, sizeof(header));
+        static_cast<const SpectrumPass*>(header.pass)->submit(header, data + sizeof(header));
+    }
+
+private:
+    void submit(const SpectrumCallbackHeader& header, const std::byte* values) const {
+        ImGui_Implbgfx_CallbackTarget target;
+        if (!ImGui_Implbgfx_GetCallbackTarget(target) ||
+            !bgfx::isValid(target.program) ||
+            !bgfx::isValid(whiteTexture_) ||
+            !bgfx::isValid(indexBuffer_) ||
+            header.pointCount < 2 || header.pointCount > kMaxSpectrumPoints) {
+            return;
+        }
+
+        const std::uint32_t vertexCount = header.pointCount * kSpectrumVerticesPerPoint;
+        if (bgfx::getAvailTransientVertexBuffer(vertexCount, FullscreenVertex::layout) != vertexCount) {
+            return;
+        }
+
+        bgfx::TransientVertexBuffer vertexBuffer;
+        bgfx::allocTransientVertexBuffer(&vertexBuffer, vertexCount, FullscreenVertex::layout);
+        auto* vertices = reinterpret_cast<FullscreenVertex*>(vertexBuffer.data);
+
+        const float width = header.rectMax.x - header.rectMin.x;
+        const float height = header.rectMax.y - header.rectMin.y;
+        const float xStep = width / static_cast<float>(header.pointCount - 1);
+        const float yScale = header.maxValue > 0.0f ? height / header.maxValue : 0.0f;
+        const auto pointY = [&](const std::uint32_t point) {
+            float value = 0.0f;
+            std::memcpy(&value, values + static_cast<std::size_t>(point) * sizeof(float), sizeof(float));
+            return header.rectMax.y - std::clamp(value * yScale, 0.0f, height);
+        };
+
+        const ImU32 fillColour = ImGui_Implbgfx_OutputColour(header.fillColour);
+        const ImU32 lineColour = ImGui_Implbgfx_OutputColour(header.lineColour);
+        const ImU32 fringeColour = lineColour & ~IM_COL32_A_MASK;
+        const float coreHalfWidth = std::max(header.lineWidth - kSpectrumLineFringe, 0.0f) * 0.5f;
+        const float outerHalfWidth = coreHalfWidth + kSpectrumLineFringe;
+
+        float previousY = pointY(0);
+        float currentY = previousY;
+        for (std::uint32_t point = 0; point < header.pointCount; ++point) {
+            const float nextY = point + 1 < header.pointCount ? pointY(point + 1) : currentY;
+            const float x = header.rectMin.x + xStep * static_cast<float>(point);
+
+            // The line's normal follows the curve through both neighbours.
+            const float tangentX = point > 0 && point + 1 < header.pointCount ? 2.0f * xStep : xStep;
+            const float tangentY = nextY - previousY;
+            const float inverseLength = 1.0f / std::sqrt(tangentX * tangentX + tangentY * tangentY);
+            const float normalX = -tangentY * inverseLength;
+            const float normalY = tangentX * inverseLength;
+
+            FullscreenVertex* vertex = vertices + point * kSpectrumVerticesPerPoint;
+            vertex[0] = FullscreenVertex{x, header.rectMax.y, 0.0f, 0.0f, fillColour};
+            vertex[1] = FullscreenVertex{x, currentY, 0.0f, 0.0f, fillColour};
+            vertex[2] = FullscreenVertex{x - normalX * outerHalfWidth, currentY - normalY * outerHalfWidth, 0.0f, 0.0f, fringeColour};
+            vertex[3] = FullscreenVertex{x - normalX * coreHalfWidth, currentY - normalY * coreHalfWidth, 0.0f, 0.0f, lineColour};
+            vertex[4] = FullscreenVertex{x + normalX * coreHalfWidth, currentY + normalY * coreHalfWidth, 0.0f, 0.0f, lineColour};
+            vertex[5] = FullscreenVertex{x + normalX * outerHalfWidth, currentY + normalY * outerHalfWidth, 0.0f, 0.0f, fringeColour};
+
+            previousY = currentY;
+            currentY = nextY;
+        }
+
+        bgfx::Encoder* encoder = target.encoder;
+        encoder->setScissor(target.scissorX, target.scissorY, target.scissorWidth, target.scissorHeight);
+        encoder->setState(
+            BGFX_STATE_WRITE_RGB |
+            BGFX_STATE_WRITE_A |
+            BGFX_STATE_MSAA |
+            BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA));
+        encoder->setTexture(0, target.sampler, whiteTexture_);
+        encoder->setVertexBuffer(0, &vertexBuffer, 0, vertexCount);
+        encoder->setIndexBuffer(indexBuffer_, 0, (header.pointCount - 1) * kSpectrumIndicesPerSegment);
+        encoder->submit(target.viewId, target.program);
+    }
+
+    bgfx::TextureHandle whiteTexture_ = BGFX_INVALID_HANDLE;
+    bgfx::IndexBufferHandle indexBuffer_ = BGFX_INVALID_HANDLE;
+};
+
 PresentationResources::PresentationResources() = default;
 
 PresentationResources::~PresentationResources() {
@@ -285,11 +527,13 @@ bool PresentationResources::initialise() {
     backgroundTexture_ = std::make_unique<SampledTexture>("BackgroundColourSurface");
     timelineTexture_ = std::make_unique<SampledTexture>("TimelineGradientSurface");
     backgroundPass_ = std::make_unique<FullscreenTexturePass>();
+    spectrumPass_ = std::make_unique<SpectrumPass>();
 
     initialised_ = true;
     backgroundPresentationSupported_ =
         backgroundPass_ != nullptr &&
         backgroundPass_->initialise();
+    spectrumPassSupported_ = spectrumPass_->initialise();
     return true;
 }
 
@@ -309,15 +553,24 @@ void PresentationResources::shutdown() {
     if (backgroundPass_ != nullptr) {
         backgroundPass_->shutdown();
     }
+    if (spectrumPass_ != nullptr) {
+        spectrumPass_->shutdown();
+    }
 
     timelineTexture_.reset();
     sidebarColourTexture_.reset();
     recorderColourTexture_.reset();
     backgroundTexture_.reset();
     backgroundPass_.reset();
+    spectrumPass_.reset();
+    spectrumCallbackData_.clear();
     timelinePixels_.clear();
+    timelineLevels_.clear();
+    timelinePyramid_ = {};
+    timelinePyramidRevision_ = 0;
     timelineTextureCacheKey_ = {};
     backgroundPresentationSupported_ = false;
+    spectrumPassSupported_ = false;
     initialised_ = false;
 }
 
@@ -329,23 +582,139 @@ bool PresentationResources::supportsBackgroundPresentation() const {
     return backgroundPresentationSupported_;
 }
 
+bool PresentationResources::supportsSpectrumPass() const {
+    return spectrumPassSupported_;
+}
+
+// Returns how many leading samples the pyramid kept from the revision it held before.
+std::size_t PresentationResources::refreshTimelinePyramid(
+    const std::vector<ReSyne::Timeline::TimelineSample>& samples,
+    const uint64_t sampleRevision,
+    const std::size_t retainedSampleCount) {
+    if (sampleRevision > 0 && timelinePyramidRevision_ == sampleRevision &&
+        timelinePyramid_.sampleCount == samples.size()) {
+        return samples.size();
+    }
+
+    const std::size_t previousCount = timelinePyramid_.sampleCount;
+    const bool appended = sampleRevision > 0 &&
+        timelinePyramidRevision_ + 1 == sampleRevision &&
+        previousCount > 0 &&
+        retainedSampleCount >= previousCount &&
+        samples.size() >= previousCount;
+    timelinePyramidRevision_ = sampleRevision;
+    if (appended) {
+        ReSyne::Timeline::extendGradientPyramid(samples, timelinePyramid_);
+        return previousCount;
+    }
+    ReSyne::Timeline::buildGradientPyramid(samples, timelinePyramid_);
+    return 0;
+}
+
 ImTextureID PresentationResources::updateTimelineTexture(
     const std::vector<ReSyne::Timeline::TimelineSample>& samples,
     const uint64_t sampleRevision,
-    const float visibleStart,
-    const float visibleEnd,
+    const std::size_t retainedSampleCount,
+    float visibleStart,
+    float visibleEnd,
     const int width,
     const ColourCore::ColourSpace colourSpace,
-    const bool applyGamutMapping) {
+    const bool applyGamutMapping,
+    ImVec2& uvMin,
+    ImVec2& uvMax) {
+    uvMin = ImVec2(0.0f, 0.0f);
+    uvMax = ImVec2(1.0f, 1.0f);
     if (!initialised_ || timelineTexture_ == nullptr || samples.empty() || width <= 0) {
         return ImTextureID_Invalid;
     }
 
+    visibleStart = std::clamp(visibleStart, 0.0f, 1.0f);
+    visibleEnd = std::clamp(visibleEnd, visibleStart, 1.0f);
+
+    // The whole sequence goes up once as a mip chain of the pyramid's buckets, one texel per
+    // sample at the base. Zooming and panning then only move the UVs, and the sampler's
+    // trilinear filtering picks the level with about one texel per pixel. The texture is
+    // sized to the next power of two, so while a recording or import appends samples only
+    // the texels holding them, and the one past each level's end that filtering reaches,
+    // are uploaded.
+    const bgfx::Caps* caps = bgfx::getCaps();
+    const std::size_t maxTextureSize = caps != nullptr
+        ? std::min<std::size_t>(caps->limits.maxTextureSize, std::numeric_limits<std::uint16_t>::max())
+        : 0;
+    if (samples.size() <= maxTextureSize) {
+        const auto textureWidth = static_cast<std::uint16_t>(std::min(std::bit_ceil(samples.size()), maxTextureSize));
+        const bool sameSequenceTexture =
+            sampleRevision > 0 &&
+            timelineTexture_->hasMipChain(textureWidth, sampledTextureFormat_) &&
+            timelineTextureCacheKey_.valid &&
+            timelineTextureCacheKey_.wholeSequence &&
+            timelineTextureCacheKey_.width == textureWidth &&
+            timelineTextureCacheKey_.colourSpace == colourSpace &&
+            timelineTextureCacheKey_.applyGamutMapping == applyGamutMapping;
+        if (!sameSequenceTexture || timelineTextureCacheKey_.sampleRevision != sampleRevision) {
+            const std::size_t uploadedCount = timelineTextureCacheKey_.sampleCount;
+            const std::size_t keptCount = refreshTimelinePyramid(samples, sampleRevision, retainedSampleCount);
+            const bool appendOnly =
+                sameSequenceTexture &&
+                timelineTextureCacheKey_.sampleRevision + 1 == sampleRevision &&
+                uploadedCount > 0 &&
+                keptCount == uploadedCount;
+            const auto levelCount = static_cast<std::size_t>(std::bit_width(textureWidth));
+
+            bool uploaded = true;
+            if (appendOnly) {
+                for (std::size_t level = 0; level < levelCount && uploaded; ++level) {
+                    const std::size_t levelWidth = std::max<std::size_t>(1, textureWidth >> level);
+                    const std::size_t firstTexel = std::min((uploadedCount - 1) >> level, levelWidth - 1);
+                    const std::size_t endTexel = std::min(levelWidth, ((samples.size() - 1) >> level) + 2);
+                    timelinePixels_.resize((endTexel - firstTexel) * 4);
+                    ReSyne::Timeline::rasteriseGradientBuckets(
+                        timelinePyramid_, level, firstTexel, endTexel - firstTexel,
+                        colourSpace, applyGamutMapping, timelinePixels_);
+                    uploaded = timelineTexture_->updateMipRegion(
+                        static_cast<std::uint8_t>(level), static_cast<std::uint16_t>(firstTexel), timelinePixels_);
+                }
+            } else {
+                timelineLevels_.resize(levelCount);
+                for (std::size_t level = 0; level < levelCount; ++level) {
+                    const std::size_t levelWidth = std::max<std::size_t>(1, textureWidth >> level);
+                    timelineLevels_[level].resize(levelWidth * 4);
+                    ReSyne::Timeline::rasteriseGradientBuckets(
+                        timelinePyramid_, level, 0, levelWidth, colourSpace, applyGamutMapping, timelineLevels_[level]);
+                }
+                uploaded = timelineTexture_->updateMipChain(timelineLevels_, textureWidth, sampledTextureFormat_);
+            }
+            if (!uploaded) {
+                timelineTextureCacheKey_ = {};
+                return ImTextureID_Invalid;
+            }
+            timelineTextureCacheKey_ = TimelineTextureCacheKey{
+                true,
+                true,
+                sampleRevision,
+                textureWidth,
+                samples.size(),
+                0.0f,
+                1.0f,
+                colourSpace,
+                applyGamutMapping
+            };
+        }
+
+        // Normalised positions address sample centres, as in the CPU rasteriser.
+        const float lastSample = static_cast<float>(samples.size()) - 1.0f;
+        const float texelCount = static_cast<float>(textureWidth);
+        uvMin = ImVec2((visibleStart * lastSample + 0.5f) / texelCount, 0.0f);
+        uvMax = ImVec2((visibleEnd * lastSample + 0.5f) / texelCount, 1.0f);
+        return timelineTexture_->textureId();
+    }
+
     const auto safeWidth = static_cast<std::uint16_t>(std::clamp(width, 1, static_cast<int>(std::numeric_limits<std::uint16_t>::max())));
     const bool canReuseCachedTexture =
         sampleRevision > 0 &&
         timelineTexture_->textureId() != ImTextureID_Invalid &&
         timelineTextureCacheKey_.valid &&
+        !timelineTextureCacheKey_.wholeSequence &&
         timelineTextureCacheKey_.sampleRevision == sampleRevision &&
         timelineTextureCacheKey_.width == safeWidth &&
         timelineTextureCacheKey_.visibleStart == visibleStart &&
@@ -356,9 +725,11 @@ ImTextureID PresentationResources::updateTimelineTexture(
         return timelineTexture_->textureId();
     }
 
+    refreshTimelinePyramid(samples, sampleRevision, retainedSampleCount);
+
     timelinePixels_.resize(static_cast<std::size_t>(safeWidth) * 4);
     ReSyne::Timeline::rasteriseGradientStrip(
-        samples,
+        timelinePyramid_,
         visibleStart,
         visibleEnd,
         safeWidth,
@@ -367,13 +738,16 @@ ImTextureID PresentationResources::updateTimelineTexture(
         timelinePixels_);
 
     if (!timelineTexture_->update(timelinePixels_, safeWidth, 1, sampledTextureFormat_)) {
+        timelineTextureCacheKey_ = {};
         return ImTextureID_Invalid;
     }
 
     timelineTextureCacheKey_ = TimelineTextureCacheKey{
         true,
+        false,
         sampleRevision,
         safeWidth,
+        samples.size(),
         visibleStart,
         visibleEnd,
         colourSpace,
@@ -408,7 +782,7 @@ ImTextureID PresentationResources::updateActiveColourTexture(
     solidPixel_[2] = b;
     solidPixel_[3] = 1.0f;
 
-    if (!texture->update(solidPixel_, 1, 1, sampledTextureFormat_)) {
+    if (!texture->updateSolid(solidPixel_, sampledTextureFormat_)) {
         return ImTextureID_Invalid;
     }
 
@@ -436,11 +810,44 @@ bool PresentationResources::submitBackground(const bgfx::ViewId viewId,
     solidPixel[2] = b;
     solidPixel[3] = 1.0f;
 
-    if (!backgroundTexture_->update(solidPixel, 1, 1, sampledTextureFormat_)) {
+    if (!backgroundTexture_->updateSolid(solidPixel, sampledTextureFormat_)) {
         return false;
     }
 
     return backgroundPass_->submit(viewId, width, height, backgroundTexture_->handle());
 }
 
+bool PresentationResources::queueSpectrum(ImDrawList* drawList,
+                                          const ImVec2 rectMin,
+                                          const ImVec2 rectMax,
+                                          const std::span<const float> values,
+                                          const float maxValue,
+                                          const ImU32 lineColour,
+                                          const ImU32 fillColour,
+                                          const float lineWidth) {
+    if (!initialised_ || !spectrumPassSupported_ || drawList == nullptr ||
+        values.size() < 2 || values.size() > kMaxSpectrumPoints ||
+        rectMax.x <= rectMin.x || rectMax.y <= rectMin.y) {
+        return false;
+    }
+
+    SpectrumCallbackHeader header;
+    header.pass = spectrumPass_.get();
+    header.rectMin = rectMin;
+    header.rectMax = rectMax;
+    header.maxValue = maxValue;
+    header.lineWidth = lineWidth;
+    header.lineColour = lineColour;
+    header.fillColour = fillColour;
+    header.pointCount = static_cast<std::uint32_t>(values.size());
+
+    spectrumCallbackData_.resize(sizeof(header) + values.size_bytes());
+    std::memcpy(spectrumCallbackData_.data(), &header, sizeof(header));
+    std::memcpy(spectrumCallbackData_.data() + sizeof(header), values.data(), values.size_bytes());
+
+    drawList->AddCallback(&SpectrumPass::drawCallback, spectrumCallbackData_.data(), spectrumCallbackData_.size());
+    drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+    return true;
+}
+
 }
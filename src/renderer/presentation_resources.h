@@ -1,7 +1,9 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include <bgfx/bgfx.h>
@@ -10,6 +12,7 @@
 
 #include "colour/colour_core.h"
 #include "resyne/ui/timeline/timeline.h"
+#include "resyne/ui/timeline/timeline_rasteriser.h"
 
 namespace Renderer {
 
@@ -31,14 +34,20 @@ public:
 
     [[nodiscard]] bool supportsHighPrecisionTextures() const;
     [[nodiscard]] bool supportsBackgroundPresentation() const;
+    [[nodiscard]] bool supportsSpectrumPass() const;
 
+    // The first retainedSampleCount samples must be unchanged since revision
+    // sampleRevision - 1; when they are, only the texels holding the rest are uploaded.
     [[nodiscard]] ImTextureID updateTimelineTexture(const std::vector<ReSyne::Timeline::TimelineSample>& samples,
                                                     uint64_t sampleRevision,
+                                                    std::size_t retainedSampleCount,
                                                     float visibleStart,
                                                     float visibleEnd,
                                                     int width,
                                                     ColourCore::ColourSpace colourSpace,
-                                                    bool applyGamutMapping);
+                                                    bool applyGamutMapping,
+                                                    ImVec2& uvMin,
+                                                    ImVec2& uvMax);
 
     [[nodiscard]] ImTextureID updateActiveColourTexture(PreviewSurface surface,
                                                         float r,
@@ -52,19 +61,41 @@ public:
                           float g,
                           float b) const;
 
+    // Adds the spectrum curve to drawList as a draw callback, so bgfx draws it in ImGui's
+    // order from one vertex buffer of fixed size per point. values are spaced evenly across
+    // the rect and map 0..maxValue onto its height. Returns false if nothing was queued.
+    bool queueSpectrum(ImDrawList* drawList,
+                       ImVec2 rectMin,
+                       ImVec2 rectMax,
+                       std::span<const float> values,
+                       float maxValue,
+                       ImU32 lineColour,
+                       ImU32 fillColour,
+                       float lineWidth);
+
 private:
     class SampledTexture;
     class FullscreenTexturePass;
+    class SpectrumPass;
+
+    std::size_t refreshTimelinePyramid(const std::vector<ReSyne::Timeline::TimelineSample>& samples,
+                                       uint64_t sampleRevision,
+                                       std::size_t retainedSampleCount);
 
     bgfx::TextureFormat::Enum sampledTextureFormat_ = bgfx::TextureFormat::RGBA8;
     bool highPrecisionTexturesSupported_ = false;
     bool backgroundPresentationSupported_ = false;
+    bool spectrumPassSupported_ = false;
     bool initialised_ = false;
 
+    // wholeSequence textures hold every sample with mips and ignore the visible window and
+    // width; otherwise the texture is the visible window rasterised at width.
     struct TimelineTextureCacheKey {
         bool valid = false;
+        bool wholeSequence = false;
         uint64_t sampleRevision = 0;
         uint16_t width = 0;
+        std::size_t sampleCount = 0;
         float visibleStart = 0.0f;
         float visibleEnd = 1.0f;
         ColourCore::ColourSpace colourSpace = ColourCore::ColourSpace::Rec2020;
@@ -72,6 +103,12 @@ private:
     };
 
     std::vector<float> timelinePixels_;
+    std::vector<std::vector<float>> timelineLevels_;
+    // Whole-sequence mips are laid out on the pyramid's buckets, and sequences too long for
+    // one texture row are rasterised per window on the CPU from it. It is extended when
+    // samples were only appended and rebuilt when anything else changed.
+    ReSyne::Timeline::GradientPyramid timelinePyramid_;
+    uint64_t timelinePyramidRevision_ = 0;
     std::array<float, 4> solidPixel_ = {0.0f, 0.0f, 0.0f, 1.0f};
     TimelineTextureCacheKey timelineTextureCacheKey_;
 
@@ -80,6 +117,8 @@ private:
     std::unique_ptr<SampledTexture> backgroundTexture_;
     std::unique_ptr<SampledTexture> timelineTexture_;
     std::unique_ptr<FullscreenTexturePass> backgroundPass_;
+    std::unique_ptr<SpectrumPass> spectrumPass_;
+    std::vector<std::byte> spectrumCallbackData_;
 };
 
 }
@@ -0,0 +1,55 @@
+#include "renderer/startup_profile.h"
+
+#include <cstdio>
+
+namespace Renderer {
+
+namespace {
+
+double milliseconds(const StartupProfile::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+StartupProfile::StartupProfile(const bool enabled)
+    : enabled_(enabled),
+      start_(Clock::now()),
+      lastMark_(start_) {
+}
+
+void StartupProfile::mark(const char* step) {
+    if (!enabled_ || reported_) {
+        return;
+    }
+
+    const auto now = Clock::now();
+    steps_.push_back(Step{step, now - lastMark_, false});
+    lastMark_ = now;
+}
+
+void StartupProfile::addBackgroundStep(const char* step, const Clock::duration duration) {
+    if (!enabled_ || reported_) {
+        return;
+    }
+
+    steps_.push_back(Step{step, duration, true});
+}
+
+void StartupProfile::report() {
+    if (!enabled_ || reported_) {
+        return;
+    }
+    reported_ = true;
+
+    std::fprintf(stderr, "[startup] Start-up profile:\n");
+    for (const Step& step : steps_) {
+        std::fprintf(stderr, "[startup]   %-28s %8.1f ms%s\n",
+                     step.name.c_str(),
+                     milliseconds(step.duration),
+                     step.background ? " (background)" : "");
+    }
+    std::fprintf(stderr, "[startup]   %-28s %8.1f ms\n", "Total on main thread", milliseconds(lastMark_ - start_));
+}
+
+} // namespace Renderer
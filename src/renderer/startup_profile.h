@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace Renderer {
+
+// Times the steps of GUI start-up for --profile-startup. Each mark closes the step that began
+// at the previous one; steps that run off the main thread are added with their own duration.
+// Does nothing unless enabled.
+class StartupProfile {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StartupProfile(bool enabled);
+
+    [[nodiscard]] bool isEnabled() const { return enabled_; }
+
+    void mark(const char* step);
+    void addBackgroundStep(const char* step, Clock::duration duration);
+
+    // Prints the breakdown to stderr the first time it is called.
+    void report();
+
+private:
+    struct Step {
+        std::string name;
+        Clock::duration duration{};
+        bool background = false;
+    };
+
+    bool enabled_ = false;
+    bool reported_ = false;
+    Clock::time_point start_;
+    Clock::time_point lastMark_;
+    std::vector<Step> steps_;
+};
+
+} // namespace Renderer
@@ -70,6 +70,10 @@ void Window::pollEvents() const {
     glfwPollEvents();
 }
 
+void Window::waitEvents(const double timeoutSeconds) const {
+    glfwWaitEventsTimeout(timeoutSeconds);
+}
+
 void Window::realiseForRenderer() const {
 #if defined(__APPLE__)
     for (int i = 0; i < 3; ++i) {
@@ -83,6 +87,10 @@ bool Window::shouldClose() const {
     return window_ == nullptr || glfwWindowShouldClose(window_) != 0;
 }
 
+bool Window::isIconified() const {
+    return window_ != nullptr && glfwGetWindowAttrib(window_, GLFW_ICONIFIED) != 0;
+}
+
 GLFWwindow* Window::handle() const {
     return window_;
 }
@@ -33,9 +33,12 @@ public:
 
     void show() const;
     void pollEvents() const;
+    // Returns when an event arrives or after timeoutSeconds, whichever is first.
+    void waitEvents(double timeoutSeconds) const;
     void realiseForRenderer() const;
 
     [[nodiscard]] bool shouldClose() const;
+    [[nodiscard]] bool isIconified() const;
     [[nodiscard]] GLFWwindow* handle() const;
     [[nodiscard]] FramebufferSize framebufferSize() const;
     [[nodiscard]] bgfx::PlatformData platformData() const;
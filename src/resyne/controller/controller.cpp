@@ -1,11 +1,11 @@
 #include "resyne/controller/controller.h"
 
+#include "resyne/recorder/memory_usage.h"
 #include "resyne/recorder/recorder.h"
 
 namespace ReSyne {
 
 void updateFromFFT(State& state,
-                   AudioProcessor& audioProcessor,
                    float sampleRate,
                    float currentR,
                    float currentG,
@@ -19,13 +19,6 @@ void updateFromFFT(State& state,
     }
     state.recorderState.fallbackFftSize = FFTProcessor::FFT_SIZE;
     state.recorderState.fallbackHopSize = FFTProcessor::HOP_SIZE;
-
-    Recorder::updateFromFFTProcessor(
-        state.recorderState,
-        audioProcessor,
-        currentR,
-        currentG,
-        currentB);
 }
 
 void renderMainView(State& state,
@@ -66,4 +59,8 @@ void handleDialogs(State& state) {
     Recorder::handleLoadDialog(state.recorderState);
 }
 
+void publishMemoryUsage(State& state) {
+    RecorderMemory::publish(state.recorderState);
+}
+
 }
@@ -7,7 +7,6 @@
 namespace ReSyne {
 
 void updateFromFFT(State& state,
-                   AudioProcessor& audioProcessor,
                    float sampleRate,
                    float currentR,
                    float currentG,
@@ -29,4 +28,6 @@ void renderRecorderPanel(State& state,
 
 void handleDialogs(State& state);
 
+void publishMemoryUsage(State& state);
+
 }
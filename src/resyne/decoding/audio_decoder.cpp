@@ -6,9 +6,16 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <filesystem>
 #include <string>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "resyne/decoding/neon/pcm_conversion_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "resyne/decoding/sse/pcm_conversion_sse.h"
+#endif
+
 namespace AudioDecoding {
 namespace {
 
@@ -24,6 +31,67 @@ std::string extractExtension(const std::string& path) {
     return toLower(fsPath.extension().string());
 }
 
+std::size_t splitSanitisedVectorised(const float* interleaved,
+                                     const std::size_t frameCount,
+                                     const std::uint32_t channels,
+                                     std::span<float* const> planar,
+                                     float* playback,
+                                     bool& replaced) {
+#ifdef USE_NEON_OPTIMISATIONS
+    if (channels == 1) {
+        return PCMConversionNEON::splitSanitisedMono(interleaved, frameCount, planar[0], playback, replaced);
+    }
+    if (channels == 2) {
+        return PCMConversionNEON::splitSanitisedStereo(interleaved, frameCount, planar[0], planar[1], playback,
+                                                       replaced);
+    }
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    if (channels == 1) {
+        return PCMConversionSSE::splitSanitisedMono(interleaved, frameCount, planar[0], playback, replaced);
+    }
+    if (channels == 2) {
+        return PCMConversionSSE::splitSanitisedStereo(interleaved, frameCount, planar[0], planar[1], playback,
+                                                      replaced);
+    }
+#else
+    (void)interleaved;
+    (void)frameCount;
+    (void)channels;
+    (void)planar;
+    (void)playback;
+    (void)replaced;
+#endif
+    return 0;
+}
+
+}
+
+bool splitSanitisedFrames(std::span<const float> interleaved,
+                          const std::uint32_t channels,
+                          std::span<float* const> planar,
+                          float* playback) {
+    if (channels == 0 || planar.size() < channels) {
+        return false;
+    }
+
+    const std::size_t frameCount = interleaved.size() / channels;
+    bool replaced = false;
+    std::size_t frame = splitSanitisedVectorised(interleaved.data(), frameCount, channels, planar, playback, replaced);
+    for (; frame < frameCount; ++frame) {
+        for (std::uint32_t ch = 0; ch < channels; ++ch) {
+            const std::size_t index = frame * channels + ch;
+            float sample = interleaved[index];
+            if (!std::isfinite(sample)) {
+                sample = 0.0f;
+                replaced = true;
+            }
+            planar[ch][frame] = sample;
+            if (playback != nullptr) {
+                playback[index] = sample;
+            }
+        }
+    }
+    return replaced;
 }
 
 bool decodeFile(const std::string& filepath, DecodedAudio& out, std::string& errorMessage) {
@@ -48,4 +116,24 @@ bool decodeFile(const std::string& filepath, DecodedAudio& out, std::string& err
     return false;
 }
 
+std::unique_ptr<StreamingDecoder> openStreamingDecoder(const std::string& filepath, std::string& errorMessage) {
+    const std::string extension = extractExtension(filepath);
+
+    if (extension == ".wav") {
+        return openWavStream(filepath, errorMessage);
+    }
+    if (extension == ".flac") {
+        return openFlacStream(filepath, errorMessage);
+    }
+    if (extension == ".mp3" || extension == ".mpeg3" || extension == ".mpga") {
+        return openMp3Stream(filepath, errorMessage);
+    }
+    if (extension == ".ogg" || extension == ".oga") {
+        return openOggStream(filepath, errorMessage);
+    }
+
+    errorMessage = "unsupported format";
+    return nullptr;
+}
+
 }
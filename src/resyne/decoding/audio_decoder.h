@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,7 +15,42 @@ struct DecodedAudio {
     std::uint32_t channels = 0;
 };
 
+// Pull-based decoder yielding interleaved float frames in caller-sized blocks, so analysis can
+// start before the file is decoded and memory stays bounded by the block size.
+class StreamingDecoder {
+public:
+    virtual ~StreamingDecoder() = default;
+
+    std::uint32_t sampleRate() const { return rate; }
+    std::uint32_t channels() const { return channelCount; }
+    // Frame count recorded by the container, or 0 when it is only known at end of stream.
+    std::uint64_t totalFrames() const { return frameCount; }
+
+    // Fills whole frames into interleaved (channels() floats each); returns frames read, 0 at end.
+    virtual std::size_t readFrames(std::span<float> interleaved) = 0;
+    // Moves the next read to start at frame. False, leaving the position alone, for formats
+    // that can only seek by decoding everything before it.
+    virtual bool seekToFrame(std::uint64_t frame) {
+        (void)frame;
+        return false;
+    }
+
+protected:
+    std::uint32_t rate = 0;
+    std::uint32_t channelCount = 0;
+    std::uint64_t frameCount = 0;
+};
+
+// Splits interleaved frames into planar[ch], zeroing non-finite samples on the way, and writes
+// the sanitised frames interleaved to playback as well when it is not null, all in one pass.
+// planar holds one destination per channel, each with room for every frame. True if any
+// sample was zeroed.
+bool splitSanitisedFrames(std::span<const float> interleaved,
+                          std::uint32_t channels,
+                          std::span<float* const> planar,
+                          float* playback = nullptr);
+
 bool decodeFile(const std::string& filepath, DecodedAudio& out, std::string& errorMessage);
+std::unique_ptr<StreamingDecoder> openStreamingDecoder(const std::string& filepath, std::string& errorMessage);
 
 }
-
@@ -1,7 +1,8 @@
 #include "resyne/decoding/decoder_flac.h"
+#include "resyne/decoding/parallel_decode.h"
 #include <algorithm>
-#include <cmath>
 #include <limits>
+#include <optional>
 
 #define DR_FLAC_IMPLEMENTATION
 #include <dr_flac.h>
@@ -19,24 +20,129 @@ std::vector<std::vector<float>> deinterleave(const float* interleaved,
         return channelSamples;
     }
 
-    channelSamples.resize(channels);
+    channelSamples.assign(channels, std::vector<float>(frameCount));
+    std::vector<float*> destinations(channels);
     for (std::uint32_t ch = 0; ch < channels; ++ch) {
-        channelSamples[ch].reserve(frameCount);
+        destinations[ch] = channelSamples[ch].data();
     }
+    splitSanitisedFrames(std::span<const float>(interleaved, frameCount * channels), channels, destinations);
+    return channelSamples;
+}
+
 
-    for (SampleCount frame = 0; frame < frameCount; ++frame) {
-        const SampleCount baseIndex = frame * static_cast<SampleCount>(channels);
-        for (std::uint32_t ch = 0; ch < channels; ++ch) {
-            const float raw = interleaved[baseIndex + ch];
-            channelSamples[ch].push_back(std::isfinite(raw) ? raw : 0.0f);
+// Large enough that each chunk's seek, a seek-table lookup or a short binary search over the
+// frame headers, is a small share of its decode.
+constexpr std::size_t kParallelChunkFrames = std::size_t{1} << 16;
+
+// FLAC frames decode independently, so a handle seeked to any frame produces exactly the
+// samples a serial decode would.
+std::size_t decodeFlacChunk(drflac*& handle,
+                            const std::string& filepath,
+                            const std::uint64_t firstFrame,
+                            const std::span<float> interleaved) {
+    if (handle == nullptr) {
+        handle = drflac_open_file(filepath.c_str(), nullptr);
+    }
+    if (handle == nullptr || handle->channels == 0 ||
+        drflac_seek_to_pcm_frame(handle, firstFrame) != DRFLAC_TRUE) {
+        return 0;
+    }
+    return static_cast<std::size_t>(
+        drflac_read_pcm_frames_f32(handle, interleaved.size() / handle->channels, interleaved.data()));
+}
+
+void closeHandles(std::vector<drflac*>& handles) {
+    for (drflac* handle : handles) {
+        if (handle != nullptr) {
+            drflac_close(handle);
         }
     }
-    return channelSamples;
+    handles.clear();
+}
+
+// A long file is read ahead through one extra handle per parallel slot, opened on first use.
+class FlacStream final : public StreamingDecoder {
+public:
+    FlacStream(drflac* handle, const std::string& filepath) : flac(handle), path(filepath) {
+        rate = handle->sampleRate;
+        channelCount = handle->channels;
+        frameCount = handle->totalPCMFrameCount;
+
+        const std::size_t slots = parallelDecodeSlots(frameCount);
+        if (slots > 1) {
+            slotHandles.assign(slots, nullptr);
+            readAhead.emplace(channelCount, frameCount, kParallelChunkFrames, slots,
+                              [this](const std::size_t slot, const std::uint64_t firstFrame, const std::span<float> out) {
+                                  return decodeFlacChunk(slotHandles[slot], path, firstFrame, out);
+                              });
+        }
+    }
+
+    ~FlacStream() override {
+        closeHandles(slotHandles);
+        drflac_close(flac);
+    }
+
+    FlacStream(const FlacStream&) = delete;
+    FlacStream& operator=(const FlacStream&) = delete;
+
+    std::size_t readFrames(std::span<float> interleaved) override {
+        if (readAhead) {
+            return readAhead->read(interleaved);
+        }
+        const drflac_uint64 maxFrames = interleaved.size() / channelCount;
+        return static_cast<std::size_t>(drflac_read_pcm_frames_f32(flac, maxFrames, interleaved.data()));
+    }
+
+    bool seekToFrame(const std::uint64_t frame) override {
+        if (readAhead) {
+            return readAhead->seek(frame);
+        }
+        return drflac_seek_to_pcm_frame(flac, frame) == DRFLAC_TRUE;
+    }
+
+private:
+    drflac* flac;
+    std::string path;
+    std::vector<drflac*> slotHandles;
+    std::optional<ParallelReadAhead> readAhead;
+};
+
+// Chunks are decoded straight into the planar output, so the interleaved copy of the whole
+// file a serial decode makes is never built.
+bool decodeFlacParallel(drflac* flac, const std::string& filepath, const std::size_t slots, DecodedAudio& out) {
+    std::vector<drflac*> handles(slots, nullptr);
+    const bool decoded = decodePlanar(
+        flac->channels,
+        flac->totalPCMFrameCount,
+        kParallelChunkFrames,
+        slots,
+        [&handles, &filepath](const std::size_t slot, const std::uint64_t firstFrame, const std::span<float> interleaved) {
+            return decodeFlacChunk(handles[slot], filepath, firstFrame, interleaved);
+        },
+        out.channelSamples);
+    closeHandles(handles);
+    if (decoded) {
+        out.channels = flac->channels;
+        out.sampleRate = flac->sampleRate;
+    }
+    return decoded;
 }
 
 }
 
 bool decodeFlac(const std::string& filepath, DecodedAudio& out, std::string& error) {
+    if (drflac* flac = drflac_open_file(filepath.c_str(), nullptr)) {
+        const std::size_t slots = flac->channels > 0 && flac->sampleRate > 0
+            ? parallelDecodeSlots(flac->totalPCMFrameCount)
+            : 1;
+        const bool decoded = slots > 1 && decodeFlacParallel(flac, filepath, slots, out);
+        drflac_close(flac);
+        if (decoded) {
+            return true;
+        }
+    }
+
     unsigned int channels = 0;
     unsigned int sampleRate = 0;
     drflac_uint64 pcmFrameCount = 0;
@@ -75,4 +181,18 @@ bool decodeFlac(const std::string& filepath, DecodedAudio& out, std::string& err
     return true;
 }
 
+std::unique_ptr<StreamingDecoder> openFlacStream(const std::string& filepath, std::string& error) {
+    drflac* flac = drflac_open_file(filepath.c_str(), nullptr);
+    if (!flac) {
+        error = "unable to decode flac";
+        return nullptr;
+    }
+    if (flac->channels == 0 || flac->sampleRate == 0) {
+        drflac_close(flac);
+        error = "empty flac";
+        return nullptr;
+    }
+    return std::make_unique<FlacStream>(flac, filepath);
+}
+
 }
@@ -1,7 +1,11 @@
 #include "resyne/decoding/decoder_mp3.h"
+#include "resyne/decoding/parallel_decode.h"
 #include <algorithm>
-#include <cmath>
+#include <filesystem>
 #include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
 
 #define DR_MP3_IMPLEMENTATION
 #include <dr_mp3.h>
@@ -19,24 +23,192 @@ std::vector<std::vector<float>> deinterleave(const float* interleaved,
         return channelSamples;
     }
 
-    channelSamples.resize(channels);
+    channelSamples.assign(channels, std::vector<float>(frameCount));
+    std::vector<float*> destinations(channels);
     for (std::uint32_t ch = 0; ch < channels; ++ch) {
-        channelSamples[ch].reserve(frameCount);
+        destinations[ch] = channelSamples[ch].data();
     }
+    splitSanitisedFrames(std::span<const float>(interleaved, frameCount * channels), channels, destinations);
+    return channelSamples;
+}
 
-    for (SampleCount frame = 0; frame < frameCount; ++frame) {
-        const SampleCount baseIndex = frame * static_cast<SampleCount>(channels);
-        for (std::uint32_t ch = 0; ch < channels; ++ch) {
-            const float raw = interleaved[baseIndex + ch];
-            channelSamples[ch].push_back(std::isfinite(raw) ? raw : 0.0f);
-        }
+
+// Files smaller than this, about 2 min at 128 kbit/s, are decoded serially without scanning for
+// a seek table first.
+constexpr std::uintmax_t kParallelMinFileBytes = std::uintmax_t{2} << 20;
+// Chunks start wherever they fall, so each seek decodes up to kSeekPointSpacing MP3 frames
+// from the seek point before it, plus dr_mp3's bit-reservoir pre-roll; at 1152 samples a
+// frame that stays a few percent of a chunk.
+constexpr std::size_t kParallelChunkFrames = std::size_t{1} << 17;
+constexpr drmp3_uint64 kSeekPointSpacing = 4;
+
+// The MP3 frames scanned once, shared read-only by every handle bound to it.
+struct Mp3SeekTable {
+    std::vector<drmp3_seek_point> points;
+    drmp3_uint64 pcmFrameCount = 0;
+};
+
+// Scans the frame headers without decoding them. Null for short files and for streams whose
+// table could not be built, which are then read serially from the start.
+std::shared_ptr<Mp3SeekTable> buildSeekTable(drmp3& mp3, const std::string& filepath) {
+    std::error_code ec;
+    const std::uintmax_t fileBytes = std::filesystem::file_size(filepath, ec);
+    if (ec || fileBytes < kParallelMinFileBytes) {
+        return nullptr;
     }
-    return channelSamples;
+
+    drmp3_uint64 mp3FrameCount = 0;
+    drmp3_uint64 pcmFrameCount = 0;
+    if (!drmp3_get_mp3_and_pcm_frame_count(&mp3, &mp3FrameCount, &pcmFrameCount) ||
+        parallelDecodeSlots(pcmFrameCount) <= 1) {
+        return nullptr;
+    }
+
+    auto table = std::make_shared<Mp3SeekTable>();
+    drmp3_uint32 pointCount = static_cast<drmp3_uint32>(std::min<drmp3_uint64>(
+        std::max<drmp3_uint64>(1, mp3FrameCount / kSeekPointSpacing),
+        std::numeric_limits<drmp3_uint32>::max()));
+    table->points.resize(pointCount);
+    if (!drmp3_calculate_seek_points(&mp3, &pointCount, table->points.data()) || pointCount == 0) {
+        return nullptr;
+    }
+    table->points.resize(pointCount);
+    table->pcmFrameCount = pcmFrameCount;
+    return table;
 }
 
+// One handle per parallel slot, each opened on first use and bound to the shared table.
+class Mp3ChunkHandles {
+public:
+    Mp3ChunkHandles(std::string filepath, std::shared_ptr<Mp3SeekTable> seekTable, const std::size_t slots)
+        : path(std::move(filepath)), table(std::move(seekTable)), handles(slots) {}
+
+    ~Mp3ChunkHandles() {
+        for (auto& handle : handles) {
+            if (handle != nullptr) {
+                drmp3_uninit(handle.get());
+            }
+        }
+    }
+
+    Mp3ChunkHandles(const Mp3ChunkHandles&) = delete;
+    Mp3ChunkHandles& operator=(const Mp3ChunkHandles&) = delete;
+
+    std::size_t decode(const std::size_t slot, const std::uint64_t firstFrame, const std::span<float> interleaved) {
+        std::unique_ptr<drmp3>& handle = handles[slot];
+        if (handle == nullptr) {
+            auto opened = std::make_unique<drmp3>();
+            if (!drmp3_init_file(opened.get(), path.c_str(), nullptr)) {
+                return 0;
+            }
+            handle = std::move(opened);
+            drmp3_bind_seek_table(handle.get(), static_cast<drmp3_uint32>(table->points.size()), table->points.data());
+        }
+        if (handle->channels == 0 || !drmp3_seek_to_pcm_frame(handle.get(), firstFrame)) {
+            return 0;
+        }
+        return static_cast<std::size_t>(
+            drmp3_read_pcm_frames_f32(handle.get(), interleaved.size() / handle->channels, interleaved.data()));
+    }
+
+private:
+    std::string path;
+    std::shared_ptr<Mp3SeekTable> table;
+    std::vector<std::unique_ptr<drmp3>> handles;
+};
+
+// A short file has no frame count up front, since drmp3 would have to scan it to learn one,
+// and keeps the default seekToFrame, since seeking would decode everything before the frame.
+// A long one is scanned once for a seek table, which gives both, and is read ahead in parallel
+// through one handle per slot.
+class Mp3Stream final : public StreamingDecoder {
+public:
+    Mp3Stream() = default;
+
+    ~Mp3Stream() override {
+        readAhead.reset();
+        chunkHandles.reset();
+        if (initialised) {
+            drmp3_uninit(&mp3);
+        }
+    }
+
+    Mp3Stream(const Mp3Stream&) = delete;
+    Mp3Stream& operator=(const Mp3Stream&) = delete;
+
+    bool open(const std::string& filepath) {
+        initialised = drmp3_init_file(&mp3, filepath.c_str(), nullptr) != 0;
+        if (initialised) {
+            rate = mp3.sampleRate;
+            channelCount = mp3.channels;
+        }
+        if (initialised && channelCount > 0) {
+            if (auto table = buildSeekTable(mp3, filepath)) {
+                const std::size_t slots = parallelDecodeSlots(table->pcmFrameCount);
+                frameCount = table->pcmFrameCount;
+                chunkHandles = std::make_unique<Mp3ChunkHandles>(filepath, std::move(table), slots);
+                readAhead.emplace(channelCount, frameCount, kParallelChunkFrames, slots,
+                                  [handles = chunkHandles.get()](const std::size_t slot,
+                                                                 const std::uint64_t firstFrame,
+                                                                 const std::span<float> out) {
+                                      return handles->decode(slot, firstFrame, out);
+                                  });
+            }
+        }
+        return initialised;
+    }
+
+    std::size_t readFrames(std::span<float> interleaved) override {
+        if (readAhead) {
+            return readAhead->read(interleaved);
+        }
+        const drmp3_uint64 maxFrames = interleaved.size() / channelCount;
+        return static_cast<std::size_t>(drmp3_read_pcm_frames_f32(&mp3, maxFrames, interleaved.data()));
+    }
+
+    bool seekToFrame(const std::uint64_t frame) override {
+        return readAhead ? readAhead->seek(frame) : StreamingDecoder::seekToFrame(frame);
+    }
+
+private:
+    drmp3 mp3{};
+    bool initialised = false;
+    std::unique_ptr<Mp3ChunkHandles> chunkHandles;
+    std::optional<ParallelReadAhead> readAhead;
+};
+
 }
 
 bool decodeMp3(const std::string& filepath, DecodedAudio& out, std::string& error) {
+    {
+        drmp3 mp3{};
+        if (drmp3_init_file(&mp3, filepath.c_str(), nullptr)) {
+            std::shared_ptr<Mp3SeekTable> table = mp3.channels > 0 && mp3.sampleRate > 0
+                ? buildSeekTable(mp3, filepath)
+                : nullptr;
+            const std::uint32_t channels = mp3.channels;
+            const std::uint32_t sampleRate = mp3.sampleRate;
+            drmp3_uninit(&mp3);
+
+            if (table != nullptr) {
+                const std::uint64_t frames = table->pcmFrameCount;
+                const std::size_t slots = parallelDecodeSlots(frames);
+                Mp3ChunkHandles handles(filepath, std::move(table), slots);
+                const bool decoded = decodePlanar(
+                    channels, frames, kParallelChunkFrames, slots,
+                    [&handles](const std::size_t slot, const std::uint64_t firstFrame, const std::span<float> interleaved) {
+                        return handles.decode(slot, firstFrame, interleaved);
+                    },
+                    out.channelSamples);
+                if (decoded) {
+                    out.channels = channels;
+                    out.sampleRate = sampleRate;
+                    return true;
+                }
+            }
+        }
+    }
+
     drmp3_config config{};
     drmp3_uint64 frameCount = 0;
     float* data = drmp3_open_file_and_read_pcm_frames_f32(
@@ -74,4 +246,17 @@ bool decodeMp3(const std::string& filepath, DecodedAudio& out, std::string& erro
     return true;
 }
 
+std::unique_ptr<StreamingDecoder> openMp3Stream(const std::string& filepath, std::string& error) {
+    auto stream = std::make_unique<Mp3Stream>();
+    if (!stream->open(filepath)) {
+        error = "unable to decode mp3";
+        return nullptr;
+    }
+    if (stream->channels() == 0 || stream->sampleRate() == 0) {
+        error = "empty mp3";
+        return nullptr;
+    }
+    return stream;
+}
+
 }
@@ -1,6 +1,6 @@
 #include "resyne/decoding/decoder_ogg.h"
 #include <algorithm>
-#include <cmath>
+#include <limits>
 #include <vector>
 
 #define STB_VORBIS_NO_PUSHDOWN_MATH
@@ -20,20 +20,58 @@ std::vector<std::vector<float>> deinterleave(const float* interleaved,
         return channelSamples;
     }
 
-    channelSamples.resize(channels);
+    channelSamples.assign(channels, std::vector<float>(frameCount));
+    std::vector<float*> destinations(channels);
     for (std::uint32_t ch = 0; ch < channels; ++ch) {
-        channelSamples[ch].reserve(frameCount);
+        destinations[ch] = channelSamples[ch].data();
+    }
+    splitSanitisedFrames(std::span<const float>(interleaved, frameCount * channels), channels, destinations);
+    return channelSamples;
+}
+
+
+class OggStream final : public StreamingDecoder {
+public:
+    OggStream(stb_vorbis* handle, const stb_vorbis_info& info) : vorbis(handle) {
+        rate = static_cast<std::uint32_t>(info.sample_rate);
+        channelCount = static_cast<std::uint32_t>(info.channels);
+        frameCount = stb_vorbis_stream_length_in_samples(handle);
+    }
+
+    ~OggStream() override {
+        stb_vorbis_close(vorbis);
     }
 
-    for (SampleCount frame = 0; frame < frameCount; ++frame) {
-        const SampleCount baseIndex = frame * static_cast<SampleCount>(channels);
-        for (std::uint32_t ch = 0; ch < channels; ++ch) {
-            const float raw = interleaved[baseIndex + ch];
-            channelSamples[ch].push_back(std::isfinite(raw) ? raw : 0.0f);
+    OggStream(const OggStream&) = delete;
+    OggStream& operator=(const OggStream&) = delete;
+
+    std::size_t readFrames(std::span<float> interleaved) override {
+        const std::size_t maxFloats = (interleaved.size() / channelCount) * channelCount;
+        std::size_t framesRead = 0;
+        while (framesRead * channelCount < maxFloats) {
+            const int read = stb_vorbis_get_samples_float_interleaved(
+                vorbis,
+                static_cast<int>(channelCount),
+                interleaved.data() + framesRead * channelCount,
+                static_cast<int>(maxFloats - framesRead * channelCount));
+            if (read <= 0) {
+                break;
+            }
+            framesRead += static_cast<std::size_t>(read);
         }
+        return framesRead;
     }
-    return channelSamples;
-}
+
+    bool seekToFrame(const std::uint64_t frame) override {
+        if (frame > std::numeric_limits<unsigned int>::max()) {
+            return false;
+        }
+        return stb_vorbis_seek(vorbis, static_cast<unsigned int>(frame)) != 0;
+    }
+
+private:
+    stb_vorbis* vorbis;
+};
 
 }
 
@@ -90,4 +128,21 @@ bool decodeOgg(const std::string& filepath, DecodedAudio& out, std::string& erro
     return true;
 }
 
+std::unique_ptr<StreamingDecoder> openOggStream(const std::string& filepath, std::string& error) {
+    int openError = 0;
+    stb_vorbis* vorbis = stb_vorbis_open_filename(filepath.c_str(), &openError, nullptr);
+    if (!vorbis) {
+        error = "unable to decode ogg";
+        return nullptr;
+    }
+
+    const stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+    if (info.channels <= 0 || info.sample_rate <= 0) {
+        stb_vorbis_close(vorbis);
+        error = "invalid ogg stream";
+        return nullptr;
+    }
+    return std::make_unique<OggStream>(vorbis, info);
+}
+
 }
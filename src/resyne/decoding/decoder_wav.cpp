@@ -1,7 +1,106 @@
 #include "resyne/decoding/decoder_wav.h"
+#include "resyne/decoding/mapped_file.h"
 #include "resyne/decoding/wav_decoder_impl.h"
 
+#include <algorithm>
+#include <fstream>
+
 namespace AudioDecoding {
+namespace {
+
+// Converts from the mapped data chunk into the caller's block and lets consumed pages go,
+// so multi-gigabyte archives stream without a raw copy or a growing resident set.
+class MappedWavStream final : public StreamingDecoder {
+public:
+    MappedWavStream(MappedFile&& mappedFile, const WAVDecoder::WAVFormat& wavFormat)
+        : mapping(std::move(mappedFile)),
+          format(wavFormat),
+          frameBytes(static_cast<std::size_t>(wavFormat.bytesPerSample()) * wavFormat.channels),
+          cursor(static_cast<std::size_t>(wavFormat.dataOffset)) {
+        const std::uint64_t available = std::min<std::uint64_t>(
+            wavFormat.dataSize, mapping.size() - wavFormat.dataOffset);
+        end = cursor + static_cast<std::size_t>(available / frameBytes * frameBytes);
+        rate = format.sampleRate;
+        channelCount = format.channels;
+        frameCount = available / frameBytes;
+    }
+
+    std::size_t readFrames(std::span<float> interleaved) override {
+        const std::size_t framesRead = std::min(interleaved.size() / channelCount, (end - cursor) / frameBytes);
+        if (framesRead == 0) {
+            return 0;
+        }
+
+        WAVDecoder::convertSamples(mapping.data() + cursor, framesRead * channelCount, format, interleaved.data());
+        mapping.release(cursor, framesRead * frameBytes);
+        cursor += framesRead * frameBytes;
+        return framesRead;
+    }
+
+    bool seekToFrame(const std::uint64_t frame) override {
+        if (frame > frameCount) {
+            return false;
+        }
+        cursor = static_cast<std::size_t>(format.dataOffset) + static_cast<std::size_t>(frame) * frameBytes;
+        return true;
+    }
+
+private:
+    MappedFile mapping;
+    WAVDecoder::WAVFormat format;
+    std::size_t frameBytes;
+    std::size_t cursor;
+    std::size_t end = 0;
+};
+
+class WavStream final : public StreamingDecoder {
+public:
+    WavStream(std::ifstream&& stream, const WAVDecoder::WAVFormat& wavFormat)
+        : file(std::move(stream)),
+          format(wavFormat),
+          frameBytes(static_cast<std::size_t>(wavFormat.bytesPerSample()) * wavFormat.channels),
+          remainingBytes(wavFormat.dataSize) {
+        rate = format.sampleRate;
+        channelCount = format.channels;
+        frameCount = format.dataSize / frameBytes;
+    }
+
+    std::size_t readFrames(std::span<float> interleaved) override {
+        const std::uint64_t framesLeft = remainingBytes / frameBytes;
+        const std::size_t maxFrames = static_cast<std::size_t>(
+            std::min<std::uint64_t>(interleaved.size() / channelCount, framesLeft));
+        if (maxFrames == 0 || !file) {
+            return 0;
+        }
+
+        raw.resize(maxFrames * frameBytes);
+        file.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+        const std::size_t framesRead = static_cast<std::size_t>(file.gcount()) / frameBytes;
+        remainingBytes -= static_cast<std::uint64_t>(framesRead * frameBytes);
+
+        WAVDecoder::convertSamples(raw.data(), framesRead * channelCount, format, interleaved.data());
+        return framesRead;
+    }
+
+    bool seekToFrame(const std::uint64_t frame) override {
+        if (frame > frameCount) {
+            return false;
+        }
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(format.dataOffset + frame * frameBytes), std::ios::beg);
+        remainingBytes = format.dataSize - frame * frameBytes;
+        return static_cast<bool>(file);
+    }
+
+private:
+    std::ifstream file;
+    WAVDecoder::WAVFormat format;
+    std::size_t frameBytes;
+    std::uint64_t remainingBytes;
+    std::vector<std::uint8_t> raw;
+};
+
+}
 
 bool decodeWav(const std::string& filepath, DecodedAudio& out, std::string& error) {
     WAVDecoder::DecodedWAV wav;
@@ -18,4 +117,31 @@ bool decodeWav(const std::string& filepath, DecodedAudio& out, std::string& erro
     return true;
 }
 
+std::unique_ptr<StreamingDecoder> openWavStream(const std::string& filepath, std::string& error) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) {
+        error = "unable to open";
+        return nullptr;
+    }
+
+    WAVDecoder::WAVFormat format;
+    if (!WAVDecoder::readFormat(file, format, error)) {
+        return nullptr;
+    }
+    if (format.dataSize / format.bytesPerSample() < format.channels) {
+        error = "no audio";
+        return nullptr;
+    }
+
+    MappedFile mapping;
+    std::string mapError;
+    if (mapping.open(filepath, mapError) && format.dataOffset < mapping.size()) {
+        return std::make_unique<MappedWavStream>(std::move(mapping), format);
+    }
+
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(format.dataOffset), std::ios::beg);
+    return std::make_unique<WavStream>(std::move(file), format);
+}
+
 }
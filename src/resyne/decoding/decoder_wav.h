@@ -1,10 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include "resyne/decoding/audio_decoder.h"
 
 namespace AudioDecoding {
 
 bool decodeWav(const std::string& filepath, DecodedAudio& out, std::string& error);
+std::unique_ptr<StreamingDecoder> openWavStream(const std::string& filepath, std::string& error);
 
 }
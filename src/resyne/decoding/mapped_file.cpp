@@ -0,0 +1,159 @@
+#include "resyne/decoding/mapped_file.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AudioDecoding {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        mappedData = std::exchange(other.mappedData, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filepath, std::string& error) {
+    close();
+
+    const int wideLength = MultiByteToWideChar(CP_UTF8, 0, filepath.c_str(), -1, nullptr, 0);
+    std::wstring widePath(static_cast<std::size_t>(wideLength > 0 ? wideLength : 0), L'\0');
+    if (wideLength > 0) {
+        MultiByteToWideChar(CP_UTF8, 0, filepath.c_str(), -1, widePath.data(), wideLength);
+    }
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "unable to open";
+        return false;
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        CloseHandle(file);
+        error = "unable to map";
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        error = "unable to map";
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        error = "unable to map";
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedData = static_cast<const std::uint8_t*>(view);
+    mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mappedData) {
+        UnmapViewOfFile(mappedData);
+        mappedData = nullptr;
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+    mappedSize = 0;
+}
+
+void MappedFile::release(std::size_t, std::size_t) const {}
+
+#else
+
+bool MappedFile::open(const std::string& filepath, std::string& error) {
+    close();
+
+    const int descriptor = ::open(filepath.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        error = "unable to open";
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(descriptor, &info) != 0 || info.st_size <= 0) {
+        ::close(descriptor);
+        error = "unable to map";
+        return false;
+    }
+
+    const std::size_t length = static_cast<std::size_t>(info.st_size);
+    void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(descriptor);
+    if (view == MAP_FAILED) {
+        error = "unable to map";
+        return false;
+    }
+
+    madvise(view, length, MADV_SEQUENTIAL);
+    mappedData = static_cast<const std::uint8_t*>(view);
+    mappedSize = length;
+    return true;
+}
+
+void MappedFile::close() {
+    if (mappedData) {
+        munmap(const_cast<std::uint8_t*>(mappedData), mappedSize);
+        mappedData = nullptr;
+    }
+    mappedSize = 0;
+}
+
+void MappedFile::release(const std::size_t offset, const std::size_t length) const {
+    if (!mappedData || offset >= mappedSize) {
+        return;
+    }
+
+    static const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t begin = offset / pageSize * pageSize;
+    const std::size_t end = std::min(offset + length, mappedSize) / pageSize * pageSize;
+    if (end > begin) {
+        madvise(const_cast<std::uint8_t*>(mappedData) + begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+#endif
+
+}
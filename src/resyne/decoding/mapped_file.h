@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AudioDecoding {
+
+// Read-only view of a whole file mapped into the address space. Pages are faulted in on
+// demand, so converting from the view never holds a second copy of the file in memory.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& filepath, std::string& error);
+    void close();
+
+    bool isOpen() const { return mappedData != nullptr; }
+    const std::uint8_t* data() const { return mappedData; }
+    std::size_t size() const { return mappedSize; }
+
+    // Lets the OS drop pages behind a sequential reader instead of keeping them resident.
+    void release(std::size_t offset, std::size_t length) const;
+
+private:
+    const std::uint8_t* mappedData = nullptr;
+    std::size_t mappedSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+}
@@ -0,0 +1,94 @@
+#include "pcm_conversion_neon.h"
+
+#ifdef __ARM_NEON
+
+namespace PCMConversionNEON {
+namespace {
+
+// Tested on the exponent bits rather than by comparison, so -ffast-math cannot fold it away.
+inline uint32x4_t nonFiniteMask(const float32x4_t values) {
+    const uint32x4_t exponent = vdupq_n_u32(0x7F800000u);
+    return vceqq_u32(vandq_u32(vreinterpretq_u32_f32(values), exponent), exponent);
+}
+
+inline float32x4_t zeroMasked(const float32x4_t values, const uint32x4_t mask) {
+    return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(values), mask));
+}
+
+}
+
+std::size_t convertInt16(const std::uint8_t* raw, const std::size_t sampleCount, float* out) {
+    const float scale = 1.0f / 32768.0f;
+    std::size_t i = 0;
+    for (; i + 8 <= sampleCount; i += 8) {
+        const int16x8_t packed = vreinterpretq_s16_u8(vld1q_u8(raw + i * 2));
+        const int32x4_t low = vmovl_s16(vget_low_s16(packed));
+        const int32x4_t high = vmovl_s16(vget_high_s16(packed));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(low), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(high), scale));
+    }
+    return i;
+}
+
+std::size_t convertInt24(const std::uint8_t* raw, const std::size_t sampleCount, float* out) {
+    const float scale = 1.0f / 8388608.0f;
+    std::size_t i = 0;
+    for (; i + 8 <= sampleCount; i += 8) {
+        // vld3 splits the packed stream into low, middle and (signed) high bytes.
+        const uint8x8x3_t bytes = vld3_u8(raw + i * 3);
+        const uint16x8_t lowWord = vorrq_u16(vmovl_u8(bytes.val[0]), vshlq_n_u16(vmovl_u8(bytes.val[1]), 8));
+        const int16x8_t highByte = vmovl_s8(vreinterpret_s8_u8(bytes.val[2]));
+
+        const int32x4_t low = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(highByte)), 16),
+                                        vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(lowWord))));
+        const int32x4_t high = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(highByte)), 16),
+                                         vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(lowWord))));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(low), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(high), scale));
+    }
+    return i;
+}
+
+std::size_t splitSanitisedMono(const float* interleaved, const std::size_t frameCount, float* out,
+                               float* playback, bool& replaced) {
+    uint32x4_t anyNonFinite = vdupq_n_u32(0);
+    std::size_t i = 0;
+    for (; i + 4 <= frameCount; i += 4) {
+        const float32x4_t values = vld1q_f32(interleaved + i);
+        const uint32x4_t nonFinite = nonFiniteMask(values);
+        const float32x4_t clean = zeroMasked(values, nonFinite);
+        anyNonFinite = vorrq_u32(anyNonFinite, nonFinite);
+        vst1q_f32(out + i, clean);
+        if (playback != nullptr) {
+            vst1q_f32(playback + i, clean);
+        }
+    }
+    replaced = replaced || vmaxvq_u32(anyNonFinite) != 0;
+    return i;
+}
+
+std::size_t splitSanitisedStereo(const float* interleaved, const std::size_t frameCount, float* left,
+                                 float* right, float* playback, bool& replaced) {
+    uint32x4_t anyNonFinite = vdupq_n_u32(0);
+    std::size_t i = 0;
+    for (; i + 4 <= frameCount; i += 4) {
+        float32x4x2_t frames = vld2q_f32(interleaved + i * 2);
+        const uint32x4_t leftNonFinite = nonFiniteMask(frames.val[0]);
+        const uint32x4_t rightNonFinite = nonFiniteMask(frames.val[1]);
+        frames.val[0] = zeroMasked(frames.val[0], leftNonFinite);
+        frames.val[1] = zeroMasked(frames.val[1], rightNonFinite);
+        anyNonFinite = vorrq_u32(anyNonFinite, vorrq_u32(leftNonFinite, rightNonFinite));
+
+        vst1q_f32(left + i, frames.val[0]);
+        vst1q_f32(right + i, frames.val[1]);
+        if (playback != nullptr) {
+            vst2q_f32(playback + i * 2, frames);
+        }
+    }
+    replaced = replaced || vmaxvq_u32(anyNonFinite) != 0;
+    return i;
+}
+
+}
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace PCMConversionNEON {
+    // Little-endian PCM to float in [-1, 1). Both return the number of samples converted,
+    // leaving any tail shorter than one vector to the caller's scalar path.
+    std::size_t convertInt16(const std::uint8_t* raw, std::size_t sampleCount, float* out);
+    std::size_t convertInt24(const std::uint8_t* raw, std::size_t sampleCount, float* out);
+
+    // Interleaved float frames to planar with non-finite samples zeroed, also storing the
+    // sanitised frames to playback when it is not null. Both return the number of frames
+    // processed and set replaced if any sample was zeroed.
+    std::size_t splitSanitisedMono(const float* interleaved, std::size_t frameCount, float* out,
+                                   float* playback, bool& replaced);
+    std::size_t splitSanitisedStereo(const float* interleaved, std::size_t frameCount, float* left,
+                                     float* right, float* playback, bool& replaced);
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include "resyne/decoding/parallel_decode.h"
+#include "resyne/decoding/audio_decoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "utilities/threading/task_scheduler.h"
+
+namespace AudioDecoding {
+namespace {
+
+// Below about 45 s at 44.1 kHz the handles cost more to open than the decode saves.
+constexpr std::uint64_t kParallelMinFrames = std::uint64_t{1} << 21;
+constexpr std::size_t kMaxSlots = 8;
+
+}
+
+std::size_t parallelDecodeSlots(const std::uint64_t totalFrames) {
+    if (totalFrames < kParallelMinFrames) {
+        return 1;
+    }
+    return std::clamp<std::size_t>(Utilities::Threading::TaskScheduler::shared().workerCount(), 1, kMaxSlots);
+}
+
+ParallelReadAhead::ParallelReadAhead(const std::uint32_t channelCount,
+                                     const std::uint64_t frameCount,
+                                     const std::size_t framesPerChunk,
+                                     const std::size_t slots,
+                                     ChunkDecoder chunkDecoder)
+    : channels(channelCount),
+      totalFrames(frameCount),
+      chunkFrames(framesPerChunk),
+      slotCount(std::max<std::size_t>(1, slots)),
+      decoder(std::move(chunkDecoder)),
+      buffer(chunkFrames * slotCount * channelCount) {}
+
+std::size_t ParallelReadAhead::read(std::span<float> interleaved) {
+    const std::size_t wanted = interleaved.size() / channels;
+    std::size_t written = 0;
+    while (written < wanted) {
+        if (consumedFrames == bufferedFrames && !refill()) {
+            break;
+        }
+        const std::size_t frames = std::min(wanted - written, bufferedFrames - consumedFrames);
+        std::memcpy(interleaved.data() + written * channels,
+                    buffer.data() + consumedFrames * channels,
+                    frames * channels * sizeof(float));
+        consumedFrames += frames;
+        written += frames;
+    }
+    return written;
+}
+
+bool ParallelReadAhead::seek(const std::uint64_t frame) {
+    if (frame > totalFrames) {
+        return false;
+    }
+    bufferStart = frame;
+    bufferedFrames = 0;
+    consumedFrames = 0;
+    ended = false;
+    return true;
+}
+
+// Chunks land in order, so a chunk that comes up short ends the stream there: what follows
+// it would leave a gap.
+bool ParallelReadAhead::refill() {
+    bufferStart += bufferedFrames;
+    bufferedFrames = 0;
+    consumedFrames = 0;
+    if (ended || bufferStart >= totalFrames) {
+        ended = true;
+        return false;
+    }
+
+    const std::uint64_t remaining = totalFrames - bufferStart;
+    const std::size_t chunkCount = static_cast<std::size_t>(
+        std::min<std::uint64_t>(slotCount, (remaining + chunkFrames - 1) / chunkFrames));
+    std::vector<std::size_t> decoded(chunkCount, 0);
+    Utilities::Threading::TaskScheduler::shared().parallelFor(chunkCount, 1, [&](const std::size_t first, const std::size_t end) {
+        for (std::size_t slot = first; slot < end; ++slot) {
+            const std::uint64_t chunkStart = bufferStart + static_cast<std::uint64_t>(slot) * chunkFrames;
+            const std::size_t frames = static_cast<std::size_t>(
+                std::min<std::uint64_t>(chunkFrames, totalFrames - chunkStart));
+            decoded[slot] = decoder(slot, chunkStart,
+                                    std::span<float>(buffer.data() + slot * chunkFrames * channels, frames * channels));
+        }
+    });
+
+    for (std::size_t slot = 0; slot < chunkCount; ++slot) {
+        bufferedFrames += decoded[slot];
+        if (decoded[slot] < chunkFrames) {
+            ended = true;
+            break;
+        }
+    }
+    return bufferedFrames > 0;
+}
+
+bool decodePlanar(const std::uint32_t channels,
+                  const std::uint64_t totalFrames,
+                  const std::size_t chunkFrames,
+                  const std::size_t slotCount,
+                  const ChunkDecoder& decoder,
+                  std::vector<std::vector<float>>& channelSamples) {
+    channelSamples.assign(channels, std::vector<float>(static_cast<std::size_t>(totalFrames)));
+    const std::size_t chunkCount = static_cast<std::size_t>((totalFrames + chunkFrames - 1) / chunkFrames);
+    const std::size_t slots = std::clamp<std::size_t>(slotCount, 1, std::max<std::size_t>(1, chunkCount));
+    std::atomic<bool> failed{false};
+
+    Utilities::Threading::TaskScheduler::shared().parallelFor(slots, 1, [&](const std::size_t first, const std::size_t end) {
+        std::vector<float> interleaved(chunkFrames * channels);
+        std::vector<float*> destinations(channels);
+        for (std::size_t slot = first; slot < end; ++slot) {
+            for (std::size_t chunk = slot; chunk < chunkCount && !failed.load(std::memory_order_relaxed); chunk += slots) {
+                const std::size_t chunkStart = chunk * chunkFrames;
+                const std::size_t frames = std::min(chunkFrames, static_cast<std::size_t>(totalFrames) - chunkStart);
+                if (decoder(slot, chunkStart, std::span<float>(interleaved.data(), frames * channels)) < frames) {
+                    failed.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                for (std::uint32_t ch = 0; ch < channels; ++ch) {
+                    destinations[ch] = channelSamples[ch].data() + chunkStart;
+                }
+                splitSanitisedFrames(std::span<const float>(interleaved.data(), frames * channels), channels,
+                                     destinations);
+            }
+        }
+    });
+
+    if (failed.load(std::memory_order_relaxed)) {
+        channelSamples.clear();
+        return false;
+    }
+    return true;
+}
+
+}
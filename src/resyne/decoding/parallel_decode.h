@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace AudioDecoding {
+
+// Decodes the frames from firstFrame into interleaved, filling it unless the stream ends or
+// fails first, and returns the frames written. Each slot owns a decoder handle that seeks
+// itself there; a slot is never used by two threads at once, but different slots are.
+using ChunkDecoder = std::function<std::size_t(std::size_t slot, std::uint64_t firstFrame, std::span<float> interleaved)>;
+
+// Handles worth opening for a file of totalFrames, or 1 when a serial decode would be as quick.
+std::size_t parallelDecodeSlots(std::uint64_t totalFrames);
+
+// Decodes ahead of a streaming reader on the shared task scheduler: each refill splits the
+// next slotCount * chunkFrames frames into one chunk per slot and decodes them at once, so
+// memory stays at one refill however long the file is.
+class ParallelReadAhead {
+public:
+    ParallelReadAhead(std::uint32_t channels,
+                      std::uint64_t totalFrames,
+                      std::size_t chunkFrames,
+                      std::size_t slotCount,
+                      ChunkDecoder decoder);
+
+    // Same contract as StreamingDecoder::readFrames.
+    std::size_t read(std::span<float> interleaved);
+    bool seek(std::uint64_t frame);
+
+private:
+    bool refill();
+
+    std::uint32_t channels;
+    std::uint64_t totalFrames;
+    std::size_t chunkFrames;
+    std::size_t slotCount;
+    ChunkDecoder decoder;
+
+    std::vector<float> buffer;
+    std::size_t bufferedFrames = 0;
+    std::size_t consumedFrames = 0;
+    // The file frame the first buffered frame stands for.
+    std::uint64_t bufferStart = 0;
+    bool ended = false;
+};
+
+// Decodes all totalFrames straight into planar channelSamples, which it sizes up front, with
+// slot s taking chunks s, s + slotCount, ... False if any chunk comes up short.
+bool decodePlanar(std::uint32_t channels,
+                  std::uint64_t totalFrames,
+                  std::size_t chunkFrames,
+                  std::size_t slotCount,
+                  const ChunkDecoder& decoder,
+                  std::vector<std::vector<float>>& channelSamples);
+
+}
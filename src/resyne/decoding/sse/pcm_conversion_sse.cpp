@@ -0,0 +1,97 @@
+#include "pcm_conversion_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+namespace PCMConversionSSE {
+namespace {
+
+// Tested on the exponent bits rather than by comparison, so a fast-math build cannot fold it away.
+inline __m128i nonFiniteMask(const __m128 values) {
+    const __m128i exponent = _mm_set1_epi32(0x7F800000);
+    return _mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(values), exponent), exponent);
+}
+
+}
+
+std::size_t convertInt16(const std::uint8_t* raw, const std::size_t sampleCount, float* out) {
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    std::size_t i = 0;
+    for (; i + 8 <= sampleCount; i += 8) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i * 2));
+        // Duplicating each lane into the top half and shifting back sign-extends on SSE2.
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    return i;
+}
+
+std::size_t convertInt24(const std::uint8_t* raw, const std::size_t sampleCount, float* out) {
+#if defined(__SSSE3__) || defined(_MSC_VER)
+    const __m128 scale = _mm_set1_ps(1.0f / 8388608.0f);
+    // Place each 3-byte sample in the top of a 32-bit lane so an arithmetic shift sign-extends.
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    std::size_t i = 0;
+    // Each load reads 16 bytes for 12 bytes of samples; stop while the overread stays in range.
+    for (; i + 6 <= sampleCount; i += 4) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i * 3));
+        const __m128i values = _mm_srai_epi32(_mm_shuffle_epi8(packed, shuffle), 8);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(values), scale));
+    }
+    return i;
+#else
+    (void)raw;
+    (void)sampleCount;
+    (void)out;
+    return 0;
+#endif
+}
+
+std::size_t splitSanitisedMono(const float* interleaved, const std::size_t frameCount, float* out,
+                               float* playback, bool& replaced) {
+    __m128i anyNonFinite = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= frameCount; i += 4) {
+        const __m128 values = _mm_loadu_ps(interleaved + i);
+        const __m128i nonFinite = nonFiniteMask(values);
+        const __m128 clean = _mm_andnot_ps(_mm_castsi128_ps(nonFinite), values);
+        anyNonFinite = _mm_or_si128(anyNonFinite, nonFinite);
+        _mm_storeu_ps(out + i, clean);
+        if (playback != nullptr) {
+            _mm_storeu_ps(playback + i, clean);
+        }
+    }
+    replaced = replaced || _mm_movemask_epi8(anyNonFinite) != 0;
+    return i;
+}
+
+std::size_t splitSanitisedStereo(const float* interleaved, const std::size_t frameCount, float* left,
+                                 float* right, float* playback, bool& replaced) {
+    __m128i anyNonFinite = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= frameCount; i += 4) {
+        const __m128 first = _mm_loadu_ps(interleaved + i * 2);
+        const __m128 second = _mm_loadu_ps(interleaved + i * 2 + 4);
+        const __m128i firstNonFinite = nonFiniteMask(first);
+        const __m128i secondNonFinite = nonFiniteMask(second);
+        const __m128 firstClean = _mm_andnot_ps(_mm_castsi128_ps(firstNonFinite), first);
+        const __m128 secondClean = _mm_andnot_ps(_mm_castsi128_ps(secondNonFinite), second);
+        anyNonFinite = _mm_or_si128(anyNonFinite, _mm_or_si128(firstNonFinite, secondNonFinite));
+
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(firstClean, secondClean, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(firstClean, secondClean, _MM_SHUFFLE(3, 1, 3, 1)));
+        if (playback != nullptr) {
+            _mm_storeu_ps(playback + i * 2, firstClean);
+            _mm_storeu_ps(playback + i * 2 + 4, secondClean);
+        }
+    }
+    replaced = replaced || _mm_movemask_epi8(anyNonFinite) != 0;
+    return i;
+}
+
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "resyne/decoding/wav_decoder_impl.h"
+#include "resyne/decoding/mapped_file.h"
 
 #include <algorithm>
 #include <cstdint>
@@ -6,11 +7,17 @@
 #include <fstream>
 #include <iostream>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "resyne/decoding/neon/pcm_conversion_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "resyne/decoding/sse/pcm_conversion_sse.h"
+#endif
+
 namespace WAVDecoder {
 
 namespace {
 
-bool readChunkHeader(std::ifstream& stream, char (&id)[4], uint32_t& size) {
+bool readChunkHeader(std::istream& stream, char (&id)[4], uint32_t& size) {
     if (!stream.read(id, 4)) {
         return false;
     }
@@ -56,7 +63,63 @@ float readFloatValue(const uint8_t* data) {
     return value;
 }
 
-void skipPadding(std::ifstream& stream, uint32_t chunkSize) {
+// Frames converted per scratch block when deinterleaving; small enough to stay in cache.
+constexpr size_t DEINTERLEAVE_BLOCK_FRAMES = 4096;
+
+size_t convertVectorised(const uint8_t* raw, const size_t sampleCount, const WAVFormat& format, float* out) {
+    if (format.audioFormat == 3) {
+        std::memcpy(out, raw, sampleCount * sizeof(float));
+        return sampleCount;
+    }
+#ifdef USE_NEON_OPTIMISATIONS
+    if (format.bitsPerSample == 16) {
+        return PCMConversionNEON::convertInt16(raw, sampleCount, out);
+    }
+    if (format.bitsPerSample == 24) {
+        return PCMConversionNEON::convertInt24(raw, sampleCount, out);
+    }
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    if (format.bitsPerSample == 16) {
+        return PCMConversionSSE::convertInt16(raw, sampleCount, out);
+    }
+    if (format.bitsPerSample == 24) {
+        return PCMConversionSSE::convertInt24(raw, sampleCount, out);
+    }
+#endif
+    return 0;
+}
+
+void deinterleaveSamples(const uint8_t* raw, const size_t frameCount, const WAVFormat& format,
+                         std::vector<std::vector<float>>& channelSamples,
+                         const AudioDecoding::MappedFile* mapping) {
+    const uint16_t channels = format.channels;
+    const size_t frameBytes = static_cast<size_t>(format.bytesPerSample()) * channels;
+
+    if (channels == 1) {
+        convertSamples(raw, frameCount, format, channelSamples[0].data());
+        return;
+    }
+
+    std::vector<float> block(std::min(frameCount, DEINTERLEAVE_BLOCK_FRAMES) * channels);
+    for (size_t start = 0; start < frameCount; start += DEINTERLEAVE_BLOCK_FRAMES) {
+        const size_t frames = std::min(DEINTERLEAVE_BLOCK_FRAMES, frameCount - start);
+        const uint8_t* blockData = raw + start * frameBytes;
+        convertSamples(blockData, frames * channels, format, block.data());
+
+        for (uint16_t channel = 0; channel < channels; ++channel) {
+            float* destination = channelSamples[channel].data() + start;
+            for (size_t frame = 0; frame < frames; ++frame) {
+                destination[frame] = block[frame * channels + channel];
+            }
+        }
+
+        if (mapping) {
+            mapping->release(static_cast<size_t>(blockData - mapping->data()), frames * frameBytes);
+        }
+    }
+}
+
+void skipPadding(std::istream& stream, uint32_t chunkSize) {
     if (chunkSize % 2 != 0) {
         stream.seekg(1, std::ios::cur);
     }
@@ -64,12 +127,8 @@ void skipPadding(std::ifstream& stream, uint32_t chunkSize) {
 
 }
 
-bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& errorMessage) {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file) {
-        errorMessage = "unable to open";
-        return false;
-    }
+bool readFormat(std::istream& file, WAVFormat& format, std::string& errorMessage) {
+    format = WAVFormat{};
 
     char riff[4];
     if (!file.read(riff, 4) || std::strncmp(riff, "RIFF", 4) != 0) {
@@ -87,11 +146,6 @@ bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& error
 
     bool fmtFound = false;
     bool dataFound = false;
-    uint16_t audioFormat = 0;
-    uint16_t channels = 0;
-    uint32_t sampleRate = 0;
-    uint16_t bitsPerSample = 0;
-    std::vector<uint8_t> dataChunk;
 
     while (file && !(fmtFound && dataFound)) {
         char chunkId[4];
@@ -103,16 +157,16 @@ bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& error
         if (std::strncmp(chunkId, "fmt ", 4) == 0) {
             fmtFound = true;
 
-            if (!file.read(reinterpret_cast<char*>(&audioFormat), sizeof(uint16_t)) ||
-                !file.read(reinterpret_cast<char*>(&channels), sizeof(uint16_t)) ||
-                !file.read(reinterpret_cast<char*>(&sampleRate), sizeof(uint32_t))) {
+            if (!file.read(reinterpret_cast<char*>(&format.audioFormat), sizeof(uint16_t)) ||
+                !file.read(reinterpret_cast<char*>(&format.channels), sizeof(uint16_t)) ||
+                !file.read(reinterpret_cast<char*>(&format.sampleRate), sizeof(uint32_t))) {
                 errorMessage = "malformed fmt";
                 return false;
             }
 
             file.seekg(6, std::ios::cur);
 
-            if (!file.read(reinterpret_cast<char*>(&bitsPerSample), sizeof(uint16_t))) {
+            if (!file.read(reinterpret_cast<char*>(&format.bitsPerSample), sizeof(uint16_t))) {
                 errorMessage = "malformed fmt";
                 return false;
             }
@@ -123,11 +177,12 @@ bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& error
             }
         } else if (std::strncmp(chunkId, "data", 4) == 0) {
             dataFound = true;
-            dataChunk.resize(chunkSize);
-            if (!file.read(reinterpret_cast<char*>(dataChunk.data()), chunkSize)) {
-                errorMessage = "malformed data";
-                return false;
+            format.dataOffset = static_cast<uint64_t>(file.tellg());
+            format.dataSize = chunkSize;
+            if (fmtFound) {
+                break;
             }
+            file.seekg(chunkSize, std::ios::cur);
         } else {
             file.seekg(chunkSize, std::ios::cur);
         }
@@ -144,31 +199,81 @@ bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& error
         return false;
     }
 
-    if (audioFormat != 1 && audioFormat != 3) {
+    if (format.audioFormat != 1 && format.audioFormat != 3) {
         errorMessage = "unsupported format";
         return false;
     }
-    if (channels == 0 || sampleRate == 0) {
+    if (format.channels == 0 || format.sampleRate == 0) {
         errorMessage = "invalid stream";
         return false;
     }
-    if (audioFormat == 3 && bitsPerSample != 32) {
+    if (format.audioFormat == 3 && format.bitsPerSample != 32) {
         errorMessage = "unsupported float bit depth";
         return false;
     }
-    if (audioFormat == 1 && bitsPerSample != 8 && bitsPerSample != 16 &&
-        bitsPerSample != 24 && bitsPerSample != 32) {
+    if (format.audioFormat == 1 && format.bitsPerSample != 8 && format.bitsPerSample != 16 &&
+        format.bitsPerSample != 24 && format.bitsPerSample != 32) {
         errorMessage = "unsupported bit depth";
         return false;
     }
 
-    const uint16_t bytesPerSample = bitsPerSample / 8;
-    if (bytesPerSample == 0) {
+    if (format.bytesPerSample() == 0) {
         errorMessage = "invalid bit depth";
         return false;
     }
 
-    const size_t totalSamples = dataChunk.size() / bytesPerSample;
+    return true;
+}
+
+void convertSamples(const uint8_t* raw, const size_t sampleCount, const WAVFormat& format, float* out) {
+    const uint16_t bytesPerSample = format.bytesPerSample();
+    for (size_t i = convertVectorised(raw, sampleCount, format, out); i < sampleCount; ++i) {
+        const uint8_t* samplePtr = raw + i * bytesPerSample;
+        out[i] = format.audioFormat == 3
+            ? readFloatValue(samplePtr)
+            : readPCMValue(samplePtr, format.bitsPerSample);
+    }
+}
+
+bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& errorMessage) {
+    WAVFormat format;
+    {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file) {
+            errorMessage = "unable to open";
+            return false;
+        }
+        if (!readFormat(file, format, errorMessage)) {
+            return false;
+        }
+    }
+
+    // Convert straight from the mapped pages where possible; the stream copy is only a fallback
+    // for files the platform refuses to map.
+    AudioDecoding::MappedFile mapping;
+    std::string mapError;
+    std::vector<uint8_t> dataChunk;
+    const uint8_t* raw = nullptr;
+    if (mapping.open(filepath, mapError)) {
+        if (format.dataOffset + format.dataSize > mapping.size()) {
+            errorMessage = "malformed data";
+            return false;
+        }
+        raw = mapping.data() + format.dataOffset;
+    } else {
+        std::ifstream file(filepath, std::ios::binary);
+        dataChunk.resize(static_cast<size_t>(format.dataSize));
+        file.seekg(static_cast<std::streamoff>(format.dataOffset), std::ios::beg);
+        if (!file.read(reinterpret_cast<char*>(dataChunk.data()), static_cast<std::streamsize>(dataChunk.size()))) {
+            errorMessage = "malformed data";
+            return false;
+        }
+        raw = dataChunk.data();
+    }
+
+    const uint16_t channels = format.channels;
+    const uint16_t bytesPerSample = format.bytesPerSample();
+    const size_t totalSamples = static_cast<size_t>(format.dataSize) / bytesPerSample;
     if (totalSamples < channels) {
         errorMessage = "no audio";
         return false;
@@ -178,24 +283,12 @@ bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& error
     out.channelSamples.clear();
     out.channelSamples.resize(channels);
     for (uint16_t channel = 0; channel < channels; ++channel) {
-        out.channelSamples[channel].reserve(frameCount);
+        out.channelSamples[channel].resize(frameCount);
     }
 
-    const uint8_t* raw = dataChunk.data();
-    for (size_t frame = 0; frame < frameCount; ++frame) {
-        for (uint16_t channel = 0; channel < channels; ++channel) {
-            const uint8_t* samplePtr = raw + (frame * channels + channel) * bytesPerSample;
-            float value = 0.0f;
-            if (audioFormat == 3) {
-                value = readFloatValue(samplePtr);
-            } else {
-                value = readPCMValue(samplePtr, bitsPerSample);
-            }
-            out.channelSamples[channel].push_back(value);
-        }
-    }
+    deinterleaveSamples(raw, frameCount, format, out.channelSamples, mapping.isOpen() ? &mapping : nullptr);
 
-    out.sampleRate = sampleRate;
+    out.sampleRate = format.sampleRate;
     out.channels = channels;
 
     return true;
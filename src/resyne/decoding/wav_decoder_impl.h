@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <istream>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,22 @@ struct DecodedWAV {
     uint16_t channels = 0;
 };
 
+struct WAVFormat {
+    uint16_t audioFormat = 0;
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t bitsPerSample = 0;
+    uint64_t dataOffset = 0;
+    uint64_t dataSize = 0;
+
+    uint16_t bytesPerSample() const { return static_cast<uint16_t>(bitsPerSample / 8); }
+};
+
 bool decodeFile(const std::string& filepath, DecodedWAV& out, std::string& errorMessage);
 
+// Validates the RIFF header and locates the data chunk without reading the samples.
+bool readFormat(std::istream& stream, WAVFormat& format, std::string& errorMessage);
+// Converts sampleCount interleaved samples in the stream's encoding to float.
+void convertSamples(const uint8_t* raw, size_t sampleCount, const WAVFormat& format, float* out);
+
 }
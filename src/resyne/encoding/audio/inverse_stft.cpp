@@ -0,0 +1,189 @@
+#include "resyne/encoding/audio/inverse_stft.h"
+#include "audio/analysis/fft/fft_backend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+InverseSTFT::InverseSTFT(const int fftSize, const int hopSize)
+	: frameSize(fftSize),
+	  hop(hopSize),
+	  inverseTransform(FFTBackend::create(fftSize)),
+	  window(static_cast<size_t>(fftSize), 1.0f),
+	  bins(static_cast<size_t>(fftSize / 2 + 1)),
+	  frame(static_cast<size_t>(fftSize), 0.0f) {
+	if (fftSize > 1) {
+		const float denom = static_cast<float>(fftSize - 1);
+		for (size_t n = 0; n < window.size(); ++n) {
+			window[n] = 0.5f * (1.0f - std::cos(2.0f * std::numbers::pi_v<float> * static_cast<float>(n) / denom));
+		}
+	}
+}
+
+InverseSTFT::~InverseSTFT() = default;
+
+std::span<float> InverseSTFT::transform(std::span<const float> magnitudes, std::span<const float> phases) {
+	const size_t numBins = bins.size();
+	const size_t dataSize = std::min({numBins, magnitudes.size(), phases.size()});
+
+	for (size_t i = 0; i < dataSize; ++i) {
+		bins[i].r = magnitudes[i] * std::cos(phases[i]);
+		bins[i].i = magnitudes[i] * std::sin(phases[i]);
+	}
+	std::fill(bins.begin() + static_cast<std::ptrdiff_t>(dataSize), bins.end(), kiss_fft_cpx{0.0f, 0.0f});
+
+	bins[0].r *= 2.0f;
+	bins[0].i *= 2.0f;
+	if (numBins > 1) {
+		bins[numBins - 1].r *= 2.0f;
+		bins[numBins - 1].i *= 2.0f;
+	}
+
+	inverseTransform->inverse(bins, frame);
+	return frame;
+}
+
+void InverseSTFT::reset() {
+	accumulator.clear();
+	weights.clear();
+	framesPushed = 0;
+	finalised = 0;
+	ready.clear();
+	readPosition = 0;
+}
+
+void InverseSTFT::seek(const size_t firstFrame) {
+	reset();
+	framesPushed = firstFrame;
+	finalised = firstFrame * static_cast<size_t>(hop);
+}
+
+void InverseSTFT::push() {
+	overlapAdd(false);
+}
+
+void InverseSTFT::pushSilence() {
+	overlapAdd(true);
+}
+
+void InverseSTFT::overlapAdd(const bool silent) {
+	// Nothing before this frame's start can change any more.
+	const size_t writePos = framesPushed * static_cast<size_t>(hop);
+	finalise(writePos - finalised, std::numeric_limits<size_t>::max());
+
+	if (accumulator.size() < frame.size()) {
+		accumulator.resize(frame.size(), 0.0f);
+		weights.resize(frame.size(), 0.0f);
+	}
+	for (size_t j = 0; j < frame.size(); ++j) {
+		if (!silent) {
+			accumulator[j] += frame[j] * window[j];
+		}
+		weights[j] += window[j] * window[j];
+	}
+	++framesPushed;
+}
+
+void InverseSTFT::flush() {
+	// Nothing has been pushed since the signal started.
+	if (finalised == framesPushed * static_cast<size_t>(hop)) {
+		return;
+	}
+
+	// With overlapping frames the part of the last frame that no other frame reaches is as
+	// thinly covered as the first hop; without overlap there is no such tail.
+	const size_t totalSamples = (framesPushed - 1) * static_cast<size_t>(hop) + frame.size();
+	const size_t tailStart = totalSamples - static_cast<size_t>(std::max(0, frameSize - hop));
+	finalise(totalSamples - finalised, tailStart);
+	accumulator.clear();
+	weights.clear();
+	framesPushed = 0;
+	finalised = 0;
+}
+
+void InverseSTFT::finalise(const size_t count, const size_t tailStart) {
+	constexpr float normalisationEpsilon = 1e-6f;
+	constexpr float expectedColaSumHann50 = 0.5f;
+
+	if (count == 0) {
+		return;
+	}
+
+	// The first hop and the tail see fewer overlapping windows, so their gain is capped at
+	// the 50%-overlap Hann sum rather than blowing up towards the edges.
+	ready.reserve(ready.size() + count);
+	for (size_t i = 0; i < count; ++i) {
+		float value = i < accumulator.size() ? accumulator[i] : 0.0f;
+		const float weight = i < weights.size() ? weights[i] : 0.0f;
+		if (weight > normalisationEpsilon) {
+			const size_t position = finalised + i;
+			if (position < static_cast<size_t>(hop) || position >= tailStart) {
+				value /= std::max(expectedColaSumHann50, weight);
+			} else {
+				value /= weight;
+			}
+		}
+		ready.push_back(value);
+	}
+
+	const size_t consumed = std::min(count, accumulator.size());
+	accumulator.erase(accumulator.begin(), accumulator.begin() + static_cast<std::ptrdiff_t>(consumed));
+	weights.erase(weights.begin(), weights.begin() + static_cast<std::ptrdiff_t>(consumed));
+	finalised += count;
+}
+
+size_t InverseSTFT::pull(std::span<float> destination) {
+	const size_t count = std::min(destination.size(), available());
+	std::copy_n(ready.begin() + static_cast<std::ptrdiff_t>(readPosition), count, destination.begin());
+	readPosition += count;
+	if (readPosition == ready.size()) {
+		ready.clear();
+		readPosition = 0;
+	}
+	return count;
+}
+
+size_t InverseSTFT::skip(const size_t count) {
+	const size_t skipped = std::min(count, available());
+	readPosition += skipped;
+	if (readPosition == ready.size()) {
+		ready.clear();
+		readPosition = 0;
+	}
+	return skipped;
+}
+
+void matchSpectralEnergy(std::span<float> timeFrame, std::span<const float> mags, const int fftSize) {
+	float timeEnergy = 0.0f;
+	for (float value : timeFrame) {
+		timeEnergy += value * value;
+	}
+
+	if (mags.empty() || fftSize <= 0 || timeEnergy <= std::numeric_limits<float>::epsilon()) {
+		return;
+	}
+
+	const size_t binCount = mags.size();
+	float edgeEnergy = mags[0] * mags[0];
+	if (binCount > 1) {
+		edgeEnergy += mags[binCount - 1] * mags[binCount - 1];
+	}
+
+	float interiorSum = 0.0f;
+	for (size_t bin = 1; bin + 1 < binCount; ++bin) {
+		const float magnitude = mags[bin];
+		interiorSum += magnitude * magnitude;
+	}
+
+	const float spectralEnergy = static_cast<float>(fftSize) * (edgeEnergy + 0.5f * interiorSum);
+	if (spectralEnergy > std::numeric_limits<float>::epsilon()) {
+		const float gain = std::sqrt(spectralEnergy / timeEnergy);
+		const float clampedGain = std::clamp(gain, 0.1f, 10.0f);
+		if (std::isfinite(clampedGain) && std::abs(clampedGain - 1.0f) > 1e-4f) {
+			for (float& value : timeFrame) {
+				value *= clampedGain;
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "kiss_fftr.h"
+
+namespace FFTBackend {
+class RealTransform;
+}
+
+// Streaming inverse STFT for one FFT and hop size. Owns the transform plan, the Hann
+// synthesis window, the per-frame scratch and a rolling overlap-add accumulator one frame
+// long: each pushed frame finalises the samples no later frame can reach, and those are
+// pulled out as they complete. Not safe to share between threads.
+class InverseSTFT {
+public:
+	// Throws std::runtime_error if no transform can be built for fftSize.
+	InverseSTFT(int fftSize, int hopSize);
+	~InverseSTFT();
+
+	InverseSTFT(const InverseSTFT&) = delete;
+	InverseSTFT& operator=(const InverseSTFT&) = delete;
+
+	int fftSize() const { return frameSize; }
+	int hopSize() const { return hop; }
+
+	// Builds the spectrum from polar bins and inverse-transforms it into the frame buffer,
+	// which the caller may rescale before pushing it.
+	std::span<float> transform(std::span<const float> magnitudes, std::span<const float> phases);
+
+	// Drops the pending signal and any unpulled samples.
+	void reset();
+	// Starts a new signal whose first frame is pushed firstFrame hops in, so one segment of a
+	// longer signal can be synthesised on its own. Samples the skipped frames would have
+	// reached come out incomplete and should be skipped.
+	void seek(size_t firstFrame);
+	// Windows the frame buffer into the accumulator one hop after the previous frame.
+	void push();
+	// A missing frame still counts towards the window normalisation.
+	void pushSilence();
+	// Ends the signal, finalising the tail of the last frame. The next push starts a new
+	// signal at sample zero.
+	void flush();
+
+	// Finalised samples waiting to be pulled.
+	size_t available() const { return ready.size() - readPosition; }
+	// Copies up to destination.size() finalised samples out and returns how many.
+	size_t pull(std::span<float> destination);
+	// Drops up to count finalised samples and returns how many.
+	size_t skip(size_t count);
+
+private:
+	void overlapAdd(bool silent);
+	void finalise(size_t count, size_t tailStart);
+
+	int frameSize;
+	int hop;
+	std::unique_ptr<FFTBackend::RealTransform> inverseTransform;
+	std::vector<float> window;
+	std::vector<kiss_fft_cpx> bins;
+	std::vector<float> frame;
+
+	// accumulator[i] and weights[i] hold sample finalised + i.
+	std::vector<float> accumulator;
+	std::vector<float> weights;
+	size_t framesPushed = 0;
+	size_t finalised = 0;
+	std::vector<float> ready;
+	size_t readPosition = 0;
+};
+
+// Scales an inverse-transformed frame so its energy matches what the magnitudes imply.
+void matchSpectralEnergy(std::span<float> timeFrame, std::span<const float> mags, int fftSize);
@@ -0,0 +1,49 @@
+#include "pcm_encoding_neon.h"
+
+#ifdef __ARM_NEON
+
+namespace PCMEncodingNEON {
+
+namespace {
+
+int32x4_t scaleAndRound(const float* samples, const float scale) {
+    const float32x4_t clamped = vminq_f32(vmaxq_f32(vld1q_f32(samples), vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+    return vcvtnq_s32_f32(vmulq_n_f32(clamped, scale));
+}
+
+uint8x8_t byteLane(const int32x4_t low, const int32x4_t high, const int shift) {
+    const uint32x4_t shiftedLow = vshlq_u32(vreinterpretq_u32_s32(low), vdupq_n_s32(-shift));
+    const uint32x4_t shiftedHigh = vshlq_u32(vreinterpretq_u32_s32(high), vdupq_n_s32(-shift));
+    return vmovn_u16(vcombine_u16(vmovn_u32(shiftedLow), vmovn_u32(shiftedHigh)));
+}
+
+}
+
+std::size_t encodeInt16(const float* samples, const std::size_t sampleCount, std::uint8_t* out) {
+    std::size_t i = 0;
+    for (; i + 8 <= sampleCount; i += 8) {
+        const int16x8_t packed = vcombine_s16(vqmovn_s32(scaleAndRound(samples + i, 32767.0f)),
+                                              vqmovn_s32(scaleAndRound(samples + i + 4, 32767.0f)));
+        vst1q_u8(out + i * 2, vreinterpretq_u8_s16(packed));
+    }
+    return i;
+}
+
+std::size_t encodeInt24(const float* samples, const std::size_t sampleCount, std::uint8_t* out) {
+    std::size_t i = 0;
+    for (; i + 8 <= sampleCount; i += 8) {
+        const int32x4_t low = scaleAndRound(samples + i, 8388607.0f);
+        const int32x4_t high = scaleAndRound(samples + i + 4, 8388607.0f);
+        // vst3 interleaves the low, middle and high byte planes back into packed samples.
+        uint8x8x3_t bytes;
+        bytes.val[0] = byteLane(low, high, 0);
+        bytes.val[1] = byteLane(low, high, 8);
+        bytes.val[2] = byteLane(low, high, 16);
+        vst3_u8(out + i * 3, bytes);
+    }
+    return i;
+}
+
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace PCMEncodingNEON {
+    // Float in [-1, 1] to little-endian PCM, clamping and rounding to nearest. Both return the
+    // number of samples converted, leaving any tail shorter than one vector to the caller's
+    // scalar path.
+    std::size_t encodeInt16(const float* samples, std::size_t sampleCount, std::uint8_t* out);
+    std::size_t encodeInt24(const float* samples, std::size_t sampleCount, std::uint8_t* out);
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "pcm_encoding_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace PCMEncodingSSE {
+
+namespace {
+
+// cvtps rounds to nearest under the default MXCSR; the clamp keeps every lane in range.
+__m128i scaleAndRound(const float* samples, const __m128 scale) {
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+    return _mm_cvtps_epi32(_mm_mul_ps(clamped, scale));
+}
+
+}
+
+std::size_t encodeInt16(const float* samples, const std::size_t sampleCount, std::uint8_t* out) {
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    std::size_t i = 0;
+    for (; i + 8 <= sampleCount; i += 8) {
+        const __m128i low = scaleAndRound(samples + i, scale);
+        const __m128i high = scaleAndRound(samples + i + 4, scale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_packs_epi32(low, high));
+    }
+    return i;
+}
+
+std::size_t encodeInt24(const float* samples, const std::size_t sampleCount, std::uint8_t* out) {
+#if defined(__SSSE3__) || defined(_MSC_VER)
+    const __m128 scale = _mm_set1_ps(8388607.0f);
+    // Keep the low three bytes of each 32-bit lane, packed into the first 12 bytes.
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    std::size_t i = 0;
+    for (; i + 4 <= sampleCount; i += 4) {
+        const __m128i packed = _mm_shuffle_epi8(scaleAndRound(samples + i, scale), shuffle);
+        std::uint8_t* destination = out + i * 3;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(destination), packed);
+        const int tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+        std::memcpy(destination + 8, &tail, 4);
+    }
+    return i;
+#else
+    (void)samples;
+    (void)sampleCount;
+    (void)out;
+    return 0;
+#endif
+}
+
+}
+
+#endif
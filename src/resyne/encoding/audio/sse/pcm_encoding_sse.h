@@ -0,0 +1,15 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+#include <cstdint>
+
+namespace PCMEncodingSSE {
+    // Float in [-1, 1] to little-endian PCM, clamping and rounding to nearest. Both return the
+    // number of samples converted, leaving any tail shorter than one vector to the caller's
+    // scalar path.
+    std::size_t encodeInt16(const float* samples, std::size_t sampleCount, std::uint8_t* out);
+    std::size_t encodeInt24(const float* samples, std::size_t sampleCount, std::uint8_t* out);
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include "resyne/encoding/audio/streaming_vocoder.h"
+#include "resyne/encoding/reconstruction/phase_wrapping.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+constexpr float MIN_PEAK_MAGNITUDE = 1e-6f;
+constexpr float TWO_PI = 2.0f * std::numbers::pi_v<float>;
+
+float binValue(const std::span<const float> values, const size_t bin) {
+	return bin < values.size() ? values[bin] : 0.0f;
+}
+
+}
+
+StreamingVocoder::StreamingVocoder(const int fftSize, const int hopSize)
+	: synthesis(fftSize, hopSize),
+	  magnitudes(static_cast<size_t>(fftSize / 2 + 1), 0.0f),
+	  phases(magnitudes.size(), 0.0f),
+	  advance(magnitudes.size(), 0.0f) {
+	peaks.reserve(magnitudes.size() / 2);
+}
+
+void StreamingVocoder::reset() {
+	synthesis.reset();
+	hasPhases = false;
+}
+
+size_t StreamingVocoder::renderHop(const WAVEncoder::ChannelFrame& before, const WAVEncoder::ChannelFrame& after,
+								   const float fraction, const std::span<float> output) {
+	const float weight = std::clamp(fraction, 0.0f, 1.0f);
+	const float fftSize = static_cast<float>(synthesis.fftSize());
+	const float hop = static_cast<float>(synthesis.hopSize());
+	const bool bothPresent = before.present && after.present;
+	for (size_t bin = 0; bin < magnitudes.size(); ++bin) {
+		magnitudes[bin] = (1.0f - weight) * binValue(before.magnitudes, bin) + weight * binValue(after.magnitudes, bin);
+
+		// The stored phase change, unwrapped about the bin's own advance; a missing frame
+		// leaves the bin running at its centre frequency.
+		const float expected = TWO_PI * static_cast<float>(bin) * hop / fftSize;
+		if (bothPresent && bin < before.phases.size() && bin < after.phases.size()) {
+			advance[bin] = expected + PhaseReconstruction::wrapToPi(after.phases[bin] - before.phases[bin] - expected);
+		} else {
+			advance[bin] = expected;
+		}
+	}
+
+	if (!hasPhases) {
+		for (size_t bin = 0; bin < phases.size(); ++bin) {
+			phases[bin] = binValue(before.phases, bin) + weight * advance[bin];
+		}
+		PhaseReconstruction::wrapToPi(phases);
+		hasPhases = true;
+	}
+
+	const WAVEncoder::ChannelFrame& nearer = weight < 0.5f ? before : after;
+	if (nearer.present && nearer.phases.size() >= phases.size()) {
+		lockToPeaks(nearer.phases);
+	}
+
+	matchSpectralEnergy(synthesis.transform(magnitudes, phases), magnitudes, synthesis.fftSize());
+	synthesis.push();
+
+	for (size_t bin = 0; bin < phases.size(); ++bin) {
+		phases[bin] += advance[bin];
+	}
+	PhaseReconstruction::wrapToPi(phases);
+
+	if (output.empty()) {
+		synthesis.skip(synthesis.available());
+		return 0;
+	}
+	return synthesis.pull(output);
+}
+
+size_t StreamingVocoder::finish(const std::span<float> output) {
+	size_t pulled = 0;
+	if (hasPhases) {
+		synthesis.pushSilence();
+		pulled = output.empty() ? 0 : synthesis.pull(output);
+	}
+	reset();
+	return pulled;
+}
+
+void StreamingVocoder::lockToPeaks(const std::span<const float> reference) {
+	peaks.clear();
+	for (size_t bin = 1; bin + 1 < magnitudes.size(); ++bin) {
+		if (magnitudes[bin] > MIN_PEAK_MAGNITUDE && magnitudes[bin] > magnitudes[bin - 1] &&
+			magnitudes[bin] >= magnitudes[bin + 1]) {
+			peaks.push_back(bin);
+		}
+	}
+
+	// Each peak governs the bins out to the quietest bin between it and its neighbours.
+	size_t regionStart = 0;
+	for (size_t i = 0; i < peaks.size(); ++i) {
+		const size_t peak = peaks[i];
+		size_t regionEnd = magnitudes.size();
+		if (i + 1 < peaks.size()) {
+			const auto trough = std::min_element(magnitudes.begin() + static_cast<std::ptrdiff_t>(peak),
+												 magnitudes.begin() + static_cast<std::ptrdiff_t>(peaks[i + 1]));
+			regionEnd = static_cast<size_t>(trough - magnitudes.begin()) + 1;
+		}
+		const float peakPhase = phases[peak];
+		for (size_t bin = regionStart; bin < regionEnd; ++bin) {
+			if (bin != peak) {
+				phases[bin] = PhaseReconstruction::wrapToPi(peakPhase + reference[bin] - reference[peak]);
+			}
+		}
+		regionStart = regionEnd;
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "resyne/encoding/audio/inverse_stft.h"
+#include "resyne/encoding/audio/wav_encoder.h"
+
+// Phase vocoder over one channel's stored spectral frames, synthesising a hop of output per
+// call from an analysis position anywhere between two frames. Magnitudes are interpolated
+// between the frames either side of the position and every bin's phase runs on by the
+// advance between them, with the bins round each peak kept at the peak's offsets in the
+// nearer frame (Laroche & Dolson identity locking). Moving the position by other than one
+// frame a hop stretches time without moving pitch; moving it by exactly one frame from an
+// integral position reproduces the stored phases, and so the offline reconstruction before
+// its varispeed and limiting. Not safe to share between threads.
+class StreamingVocoder {
+public:
+	// Throws std::runtime_error if no transform can be built for fftSize.
+	StreamingVocoder(int fftSize, int hopSize);
+
+	int hopSize() const { return synthesis.hopSize(); }
+
+	// Forgets the running phases and the overlap-add tail; the next hop starts a new signal.
+	void reset();
+
+	// Synthesises the hop fraction of the way from before to after and pulls out the hop
+	// rendered by the call before, which no later frame can reach. Returns how many samples
+	// went into output: hopSize() of them, or none on the first hop of a signal. An empty
+	// output discards them.
+	size_t renderHop(const WAVEncoder::ChannelFrame& before, const WAVEncoder::ChannelFrame& after, float fraction,
+					 std::span<float> output);
+	// Ends the signal, pulling out the hop rendered last, and resets.
+	size_t finish(std::span<float> output);
+
+private:
+	void lockToPeaks(std::span<const float> reference);
+
+	InverseSTFT synthesis;
+	std::vector<float> magnitudes;
+	// The phases of the next hop, and how far each bin runs on over one hop.
+	std::vector<float> phases;
+	std::vector<float> advance;
+	std::vector<size_t> peaks;
+	bool hasPhases = false;
+};
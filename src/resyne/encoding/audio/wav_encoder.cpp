@@ -1,53 +1,76 @@
 #include "resyne/encoding/audio/wav_encoder.h"
+#include "resyne/encoding/audio/inverse_stft.h"
+#include "resyne/encoding/formats/spectral_sequence.h"
 #include "resyne/encoding/reconstruction/varispeed.h"
-#include <kiss_fftr.h>
-#include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <cstring>
 #include <cmath>
 #include <limits>
-#include <numbers>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
-class KissFFTRConfig {
-public:
-	explicit KissFFTRConfig(int fftSize, int inverse)
-		: cfg_(kiss_fftr_alloc(fftSize, inverse, nullptr, nullptr)) {}
+namespace {
 
-	~KissFFTRConfig() {
-		if (cfg_) {
-			kiss_fftr_free(cfg_);
-		}
-	}
+constexpr float TARGET_PEAK = 0.9f;
 
-	KissFFTRConfig(const KissFFTRConfig&) = delete;
-	KissFFTRConfig& operator=(const KissFFTRConfig&) = delete;
+// Below this a segment spends a noticeable share of its time replaying the frames that
+// overlap the previous one.
+constexpr size_t kMinSegmentFrames = 256;
 
-	KissFFTRConfig(KissFFTRConfig&& other) noexcept : cfg_(other.cfg_) {
-		other.cfg_ = nullptr;
-	}
-
-	KissFFTRConfig& operator=(KissFFTRConfig&& other) noexcept {
-		if (this != &other) {
-			if (cfg_) {
-				kiss_fftr_free(cfg_);
-			}
-			cfg_ = other.cfg_;
-			other.cfg_ = nullptr;
-		}
-		return *this;
-	}
+size_t workerCount() {
+	return std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(std::thread::hardware_concurrency()), 8));
+}
 
-	kiss_fftr_cfg get() const { return cfg_; }
-	operator bool() const { return cfg_ != nullptr; }
+size_t signalLength(const size_t frameCount, const int fftSize, const int hopSize) {
+	return (frameCount - 1) * static_cast<size_t>(hopSize) + static_cast<size_t>(fftSize);
+}
 
-private:
-	kiss_fftr_cfg cfg_;
-};
+// Frames before a given one whose windows still reach its first sample.
+size_t overlapFrames(const int fftSize, const int hopSize) {
+	return static_cast<size_t>(std::max(0, fftSize - 1)) / static_cast<size_t>(std::max(1, hopSize));
+}
 
-namespace {
+uint64_t hashFrame(const WAVEncoder::ChannelFrame& view) {
+	uint64_t hash = 14695981039346656037ull;
+	const auto mix = [&hash](const uint32_t value) {
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+	mix(view.present ? 1u : 0u);
+	mix(static_cast<uint32_t>(view.magnitudes.size()));
+	for (const float magnitude : view.magnitudes) {
+		mix(std::bit_cast<uint32_t>(magnitude));
+	}
+	mix(static_cast<uint32_t>(view.phases.size()));
+	for (const float phase : view.phases) {
+		mix(std::bit_cast<uint32_t>(phase));
+	}
+	return hash;
+}
 
-constexpr float TARGET_PEAK = 0.9f;
+WAVEncoder::ChannelFrame sequenceFrame(const SpectralSequenceView sequence,
+									   const size_t channel,
+									   const size_t frame,
+									   const bool withFrequencies) {
+	const SpectralSequence& source = *sequence.source();
+	const size_t index = sequence.offset() + frame;
+	const SpectralFrameInfo& info = source.frameInfo(index);
+	WAVEncoder::ChannelFrame view;
+	if (channel >= info.magnitudeChannels || channel >= info.phaseChannels) {
+		return view;
+	}
+	view.magnitudes = source.magnitudes(index, channel);
+	view.phases = source.phases(index, channel);
+	if (withFrequencies && info.hasFrequencies && channel < info.frequencyChannels) {
+		view.frequencies = source.frequencies(index, channel);
+	}
+	view.present = true;
+	return view;
+}
 
 void applyLimiter(std::vector<float>& samples) {
 	if (samples.empty()) {
@@ -73,6 +96,113 @@ void applyLimiter(std::vector<float>& samples) {
 	}
 }
 
+// Synthesises the samples owned by frames [firstFrame, endFrame) of a frameCount-frame
+// signal into audio, leaving every other sample untouched. Stored phases are used as they
+// are, so no frame depends on another until overlap-add and the signal splits freely in
+// time. Each segment owns the samples from its first frame's start to the next segment's,
+// and replays the earlier frames that still reach them so every owned sample sums the same
+// frames in the same order as a serial pass over the whole signal. Fails once cancellation is
+// set, leaving whatever was written so far.
+bool synthesiseFrames(
+	const std::function<WAVEncoder::ChannelFrame(size_t)>& frameAt,
+	const size_t frameCount,
+	const size_t firstFrame,
+	const size_t endFrame,
+	const int fftSize,
+	const int hopSize,
+	const size_t threadCount,
+	const Utilities::Threading::CancellationToken& cancellation,
+	std::vector<float>& audio,
+	std::vector<std::span<const float>>* frameFrequencies
+) {
+	const size_t hop = static_cast<size_t>(hopSize);
+	const size_t rangeFrames = endFrame - firstFrame;
+	const size_t leadFrames = overlapFrames(fftSize, hopSize);
+	const size_t segmentCount = std::clamp<size_t>(rangeFrames / kMinSegmentFrames, 1, std::max<size_t>(1, threadCount));
+
+	const auto synthesiseSegment = [&](const size_t segment) {
+		const size_t segmentStart = firstFrame + segment * rangeFrames / segmentCount;
+		const size_t segmentEnd = firstFrame + (segment + 1) * rangeFrames / segmentCount;
+		const bool signalEnd = segmentEnd == frameCount;
+		const size_t replayFrame = segmentStart - std::min(segmentStart, leadFrames);
+		const size_t ownedEnd = signalEnd ? audio.size() : segmentEnd * hop;
+
+		InverseSTFT synthesis(fftSize, hopSize);
+		synthesis.seek(replayFrame);
+		size_t toSkip = (segmentStart - replayFrame) * hop;
+		size_t written = segmentStart * hop;
+		const auto drain = [&] {
+			toSkip -= synthesis.skip(toSkip);
+			if (toSkip == 0) {
+				written += synthesis.pull(std::span<float>(audio).subspan(written, ownedEnd - written));
+			}
+		};
+
+		for (size_t frame = replayFrame; frame < segmentEnd; ++frame) {
+			if (cancellation.isCancelled()) {
+				return false;
+			}
+			const WAVEncoder::ChannelFrame view = frameAt(frame);
+			if (!view.present) {
+				synthesis.pushSilence();
+			} else {
+				if (frameFrequencies != nullptr && frame >= segmentStart) {
+					(*frameFrequencies)[frame] = view.frequencies;
+				}
+				matchSpectralEnergy(synthesis.transform(view.magnitudes, view.phases), view.magnitudes, fftSize);
+				synthesis.push();
+			}
+			drain();
+		}
+
+		if (signalEnd) {
+			synthesis.flush();
+		} else {
+			// The next frame only adds from its own start onwards, so a silent stand-in
+			// finalises this segment's last hop without transforming anything.
+			synthesis.pushSilence();
+		}
+		drain();
+		return true;
+	};
+
+	std::vector<std::uint8_t> failed(segmentCount, 0);
+	const auto runSegment = [&](const size_t segment) {
+		try {
+			if (!synthesiseSegment(segment)) {
+				failed[segment] = 1;
+			}
+		} catch (const std::runtime_error&) {
+			failed[segment] = 1;
+		}
+	};
+
+	::Utilities::Threading::TaskScheduler::shared().parallelFor(segmentCount, 1, [&](const size_t first, const size_t end) {
+		for (size_t segment = first; segment < end; ++segment) {
+			runSegment(segment);
+		}
+	});
+
+	return std::find(failed.begin(), failed.end(), 1) == failed.end();
+}
+
+void finishChannel(
+	std::vector<float>& audio,
+	const std::vector<std::span<const float>>& frameFrequencies,
+	const float sampleRate,
+	const int fftSize,
+	const int hopSize
+) {
+	auto varispeedRegions = Varispeed::detectVarispeedRegions(
+		frameFrequencies, sampleRate, static_cast<size_t>(fftSize));
+
+	if (!varispeedRegions.empty()) {
+		audio = Varispeed::applyVarispeedRegions(audio, varispeedRegions, hopSize);
+	}
+
+	applyLimiter(audio);
+}
+
 }
 
 WAVEncoder::EncodingResult WAVEncoder::reconstructFromSpectralData(
@@ -99,245 +229,314 @@ WAVEncoder::EncodingResult WAVEncoder::reconstructFromSpectralData(
 	}
 	result.numChannels = numChannels;
 
-	std::vector<std::vector<float>> channelAudio(numChannels);
-	std::vector<std::vector<std::vector<float>>> channelFrequencies(numChannels);
-
-	for (size_t ch = 0; ch < numChannels; ++ch) {
-		std::vector<std::vector<float>> timeFrames;
-		timeFrames.reserve(samples.size());
-		channelFrequencies[ch].reserve(samples.size());
-
-		for (const auto& sample : samples) {
-			if (ch >= sample.magnitudes.size() || ch >= sample.phases.size()) {
-				timeFrames.push_back(std::vector<float>(static_cast<size_t>(fftSize), 0.0f));
-				channelFrequencies[ch].push_back(std::vector<float>());
-				continue;
-			}
-
-			const auto& mags = sample.magnitudes[ch];
-			const auto& phs = sample.phases[ch];
-
-			if (ch < sample.frequencies.size()) {
-				channelFrequencies[ch].push_back(sample.frequencies[ch]);
-			} else {
-				channelFrequencies[ch].push_back(std::vector<float>());
-			}
-
-			std::vector<float> timeFrame = inverseFFT(mags, phs, fftSize);
-
-			float timeEnergy = 0.0f;
-			for (float value : timeFrame) {
-				timeEnergy += value * value;
-			}
-
-			if (!mags.empty() && fftSize > 0 && timeEnergy > std::numeric_limits<float>::epsilon()) {
-				const size_t binCount = mags.size();
-				float edgeEnergy = mags[0] * mags[0];
-				if (binCount > 1) {
-					edgeEnergy += mags[binCount - 1] * mags[binCount - 1];
-				}
-
-				float interiorSum = 0.0f;
-				for (size_t bin = 1; bin + 1 < binCount; ++bin) {
-					const float magnitude = mags[bin];
-					interiorSum += magnitude * magnitude;
-				}
-
-				const float spectralEnergy = static_cast<float>(fftSize) * (edgeEnergy + 0.5f * interiorSum);
-				if (spectralEnergy > std::numeric_limits<float>::epsilon()) {
-					const float gain = std::sqrt(spectralEnergy / timeEnergy);
-					const float clampedGain = std::clamp(gain, 0.1f, 10.0f);
-
-					if (std::isfinite(clampedGain) && std::abs(clampedGain - 1.0f) > 1e-4f) {
-						for (float& value : timeFrame) {
-							value *= clampedGain;
-						}
-					}
-				}
-			}
-
-			timeFrames.push_back(std::move(timeFrame));
+	FrameSource source;
+	source.channelCount = numChannels;
+	source.frameCount = samples.size();
+	source.frameAt = [&samples](const size_t ch, const size_t frame) {
+		const SpectralSample& sample = samples[frame];
+		ChannelFrame view;
+		if (ch >= sample.magnitudes.size() || ch >= sample.phases.size()) {
+			return view;
+		}
+		view.magnitudes = sample.magnitudes[ch];
+		view.phases = sample.phases[ch];
+		if (ch < sample.frequencies.size()) {
+			view.frequencies = sample.frequencies[ch];
 		}
+		view.present = true;
+		return view;
+	};
+	std::vector<std::vector<float>> channelAudio = reconstructChannels(source, sampleRate, fftSize, hopSize);
 
-		channelAudio[ch] = overlapAdd(timeFrames, hopSize);
+	interleaveChannels(channelAudio, result);
+	result.success = true;
 
-		auto varispeedRegions = Varispeed::detectVarispeedRegions(
-			channelFrequencies[ch], sampleRate, static_cast<size_t>(fftSize));
+	return result;
+}
 
-		if (!varispeedRegions.empty()) {
-			channelAudio[ch] = Varispeed::applyVarispeedRegions(
-				channelAudio[ch], varispeedRegions, hopSize);
-		}
+WAVEncoder::EncodingResult WAVEncoder::reconstructFromSequence(
+	const SpectralSequenceView sequence,
+	float sampleRate,
+	int fftSize,
+	int hopSize,
+	const Utilities::Threading::CancellationToken& cancellation
+) {
+	EncodingResult result;
+	result.success = false;
+	result.sampleRate = sampleRate;
+	result.numChannels = 0;
 
-		applyLimiter(channelAudio[ch]);
+	if (sequence.empty()) {
+		result.errorMessage = "No spectral samples provided";
+		return result;
 	}
 
-	if (numChannels == 1) {
-		result.audioSamples = std::move(channelAudio[0]);
-	} else {
-		size_t numSamplesPerChannel = channelAudio[0].size();
-		for (size_t ch = 1; ch < numChannels; ++ch) {
-			numSamplesPerChannel = std::min(numSamplesPerChannel, channelAudio[ch].size());
-		}
+	const size_t numChannels = sequence.source()->channelCount();
+	if (numChannels == 0) {
+		result.errorMessage = "Sample has 0 channels";
+		return result;
+	}
+	result.numChannels = numChannels;
 
-		result.audioSamples.resize(numSamplesPerChannel * numChannels);
-		for (size_t i = 0; i < numSamplesPerChannel; ++i) {
-			for (size_t ch = 0; ch < numChannels; ++ch) {
-				result.audioSamples[i * numChannels + ch] = channelAudio[ch][i];
-			}
-		}
+	std::vector<std::vector<float>> channelAudio = reconstructChannels(
+		sequence, sampleRate, fftSize, hopSize, nullptr, cancellation);
+	if (cancellation.isCancelled()) {
+		result.errorMessage = "Reconstruction cancelled";
+		return result;
 	}
 
+	interleaveChannels(channelAudio, result);
 	result.success = true;
 
 	return result;
 }
 
-std::vector<float> WAVEncoder::inverseFFT(
-	const std::vector<float>& magnitudes,
-	const std::vector<float>& phases,
-	int fftSize
+std::vector<float> WAVEncoder::reconstructChannel(
+	const SpectralSequenceView sequence,
+	size_t channel,
+	float sampleRate,
+	int fftSize,
+	int hopSize
 ) {
-	const size_t numBins = static_cast<size_t>(fftSize / 2 + 1);
-	std::vector<kiss_fft_cpx> fftBins(numBins, {0.0f, 0.0f});
+	if (sequence.empty() || channel >= sequence.source()->channelCount()) {
+		return {};
+	}
 
-	const size_t dataSize = std::min(magnitudes.size(), phases.size());
+	return reconstructChannelFrames(
+		sequence.size(),
+		[sequence, channel](const size_t frame) {
+			return sequenceFrame(sequence, channel, frame, true);
+		},
+		sampleRate,
+		fftSize,
+		hopSize,
+		workerCount(),
+		{});
+}
 
-	for (size_t i = 0; i < numBins && i < dataSize; ++i) {
-		float magnitude = magnitudes[i];
-		float phase = phases[i];
+std::vector<std::vector<float>> WAVEncoder::reconstructChannels(
+	const SpectralSequenceView sequence,
+	float sampleRate,
+	int fftSize,
+	int hopSize,
+	const std::function<void(size_t)>& onChannelDone,
+	const Utilities::Threading::CancellationToken& cancellation
+) {
+	FrameSource source = frameSource(sequence);
+	source.cancellation = cancellation;
+	return reconstructChannels(source, sampleRate, fftSize, hopSize, onChannelDone);
+}
 
-		fftBins[i].r = magnitude * std::cos(phase);
-		fftBins[i].i = magnitude * std::sin(phase);
+WAVEncoder::FrameSource WAVEncoder::frameSource(const SpectralSequenceView sequence, const bool withFrequencies) {
+	FrameSource source;
+	if (sequence.empty()) {
+		return source;
 	}
+	source.channelCount = sequence.source()->channelCount();
+	source.frameCount = sequence.size();
+	source.frameAt = [sequence, withFrequencies](const size_t channel, const size_t frame) {
+		return sequenceFrame(sequence, channel, frame, withFrequencies);
+	};
+	return source;
+}
 
-	if (!fftBins.empty()) {
-		fftBins[0].r *= 2.0f;
-		fftBins[0].i *= 2.0f;
-		if (numBins > 1) {
-			fftBins[numBins - 1].r *= 2.0f;
-			fftBins[numBins - 1].i *= 2.0f;
-		}
+std::vector<std::vector<float>> WAVEncoder::reconstructChannels(
+	const FrameSource& source,
+	float sampleRate,
+	int fftSize,
+	int hopSize,
+	const std::function<void(size_t)>& onChannelDone,
+	std::vector<ChannelCache>* cache
+) {
+	const size_t channelCount = source.channelCount;
+	std::vector<std::vector<float>> channelAudio(channelCount);
+	if (cache != nullptr) {
+		cache->resize(channelCount);
 	}
-
-	KissFFTRConfig cfg(fftSize, 1);
-	if (!cfg) {
-		return std::vector<float>(static_cast<size_t>(fftSize), 0.0f);
+	if (channelCount == 0) {
+		return channelAudio;
 	}
 
-	std::vector<float> timeDomain(static_cast<size_t>(fftSize));
-	kiss_fftri(cfg.get(), fftBins.data(), timeDomain.data());
+	// Channels share the worker budget; whatever they leave over splits each channel in time.
+	const size_t workers = workerCount();
+	const size_t channelThreads = std::min(channelCount, workers);
+	const size_t segmentThreads = std::max<size_t>(1, workers / channelThreads);
+
+	// Channels run as scheduler ranges, and each splits into segments on the same pool, so a
+	// reconstruction inside an export task never puts more threads on the cores than workers.
+	std::mutex progressMutex;
+	const auto reconstructRange = [&](const size_t first, const size_t end) {
+		for (size_t ch = first; ch < end; ++ch) {
+			if (source.cancellation.isCancelled()) {
+				return;
+			}
+			const auto frameAt = [&source, ch](const size_t frame) { return source.frameAt(ch, frame); };
+			if (cache != nullptr) {
+				channelAudio[ch] = reconstructChannelFramesCached(
+					source.frameCount, frameAt, sampleRate, fftSize, hopSize, segmentThreads,
+					source.cancellation, (*cache)[ch]);
+			} else {
+				channelAudio[ch] = reconstructChannelFrames(
+					source.frameCount, frameAt, sampleRate, fftSize, hopSize, segmentThreads,
+					source.cancellation);
+			}
+			if (onChannelDone) {
+				std::lock_guard<std::mutex> lock(progressMutex);
+				onChannelDone(ch);
+			}
+		}
+	};
 
-	return timeDomain;
+	::Utilities::Threading::TaskScheduler::shared().parallelFor(channelCount, 1, reconstructRange);
+	if (source.cancellation.isCancelled()) {
+		return {};
+	}
+	return channelAudio;
 }
 
-std::vector<float> WAVEncoder::overlapAdd(
-	const std::vector<std::vector<float>>& frames,
-	int hopSize
+std::vector<float> WAVEncoder::reconstructChannelFrames(
+	size_t frameCount,
+	const std::function<ChannelFrame(size_t)>& frameAt,
+	float sampleRate,
+	int fftSize,
+	int hopSize,
+	size_t threadCount,
+	const Utilities::Threading::CancellationToken& cancellation
 ) {
-	if (frames.empty()) {
+	if (frameCount == 0) {
 		return {};
 	}
 
-	const size_t frameSize = frames[0].size();
-	const size_t totalSamples = (frames.size() - 1) * static_cast<size_t>(hopSize) + frameSize;
+	std::vector<std::span<const float>> frameFrequencies(frameCount);
+	std::vector<float> audio(signalLength(frameCount, fftSize, hopSize), 0.0f);
+	if (!synthesiseFrames(frameAt, frameCount, 0, frameCount, fftSize, hopSize, threadCount, cancellation, audio, &frameFrequencies)) {
+		std::fill(audio.begin(), audio.end(), 0.0f);
+		return audio;
+	}
+
+	finishChannel(audio, frameFrequencies, sampleRate, fftSize, hopSize);
+	return audio;
+}
 
-	if (frameSize == 0) {
+std::vector<float> WAVEncoder::reconstructChannelFramesCached(
+	size_t frameCount,
+	const std::function<ChannelFrame(size_t)>& frameAt,
+	float sampleRate,
+	int fftSize,
+	int hopSize,
+	size_t threadCount,
+	const Utilities::Threading::CancellationToken& cancellation,
+	ChannelCache& cache
+) {
+	if (frameCount == 0) {
+		cache = ChannelCache{};
 		return {};
 	}
 
-	std::vector<float> hannWindow(frameSize, 1.0f);
-	if (frameSize > 1) {
-		const float denom = static_cast<float>(frameSize - 1);
-		for (size_t n = 0; n < frameSize; ++n) {
-			hannWindow[n] = 0.5f * (1.0f - std::cos(2.0f * std::numbers::pi_v<float> * static_cast<float>(n) / denom));
-		}
+	std::vector<std::span<const float>> frameFrequencies(frameCount);
+	std::vector<std::uint64_t> frameHashes(frameCount);
+	for (size_t frame = 0; frame < frameCount; ++frame) {
+		const ChannelFrame view = frameAt(frame);
+		frameFrequencies[frame] = view.frequencies;
+		frameHashes[frame] = hashFrame(view);
 	}
 
-	std::vector<float> output(totalSamples, 0.0f);
-	std::vector<float> normalisation(totalSamples, 0.0f);
-
-	for (size_t i = 0; i < frames.size(); ++i) {
-		size_t writePos = i * static_cast<size_t>(hopSize);
+	const size_t totalSamples = signalLength(frameCount, fftSize, hopSize);
+	const bool reusable = cache.fftSize == fftSize &&
+		cache.hopSize == hopSize &&
+		cache.frameHashes.size() == frameCount &&
+		cache.overlapAdded.size() == totalSamples;
+	if (!reusable) {
+		cache.frameHashes.assign(frameCount, 0);
+		cache.overlapAdded.assign(totalSamples, 0.0f);
+	}
 
-		const auto& frame = frames[i];
-		const size_t copyCount = std::min(frameSize, frame.size());
+	// A changed frame reaches up to leadFrames hops past its own, so each dirty run is
+	// re-synthesised that far beyond its end; runs whose margins meet are done as one.
+	const size_t leadFrames = overlapFrames(fftSize, hopSize);
+	std::vector<std::pair<size_t, size_t>> dirtyRanges;
+	for (size_t frame = 0; frame < frameCount; ++frame) {
+		if (reusable && frameHashes[frame] == cache.frameHashes[frame]) {
+			continue;
+		}
+		const size_t end = std::min(frameCount, frame + 1 + leadFrames);
+		if (!dirtyRanges.empty() && frame <= dirtyRanges.back().second) {
+			dirtyRanges.back().second = end;
+		} else {
+			dirtyRanges.emplace_back(frame, end);
+		}
+	}
 
-		for (size_t j = 0; j < copyCount && (writePos + j) < totalSamples; ++j) {
-			const float windowed = frame[j] * hannWindow[j];
-			const size_t index = writePos + j;
-			output[index] += windowed;
-			normalisation[index] += hannWindow[j] * hannWindow[j];
+	for (const auto& [firstFrame, endFrame] : dirtyRanges) {
+		if (!synthesiseFrames(frameAt, frameCount, firstFrame, endFrame, fftSize, hopSize, threadCount, cancellation, cache.overlapAdded, nullptr)) {
+			cache = ChannelCache{};
+			return std::vector<float>(totalSamples, 0.0f);
 		}
 	}
+	cache.fftSize = fftSize;
+	cache.hopSize = hopSize;
+	cache.frameHashes = std::move(frameHashes);
 
-	constexpr float normalisationEpsilon = 1e-6f;
-	constexpr float expectedColaSumHann50 = 0.5f;
+	std::vector<float> audio = cache.overlapAdded;
+	finishChannel(audio, frameFrequencies, sampleRate, fftSize, hopSize);
+	return audio;
+}
 
-	const size_t edgeStart = static_cast<size_t>(hopSize);
-	const size_t edgeEnd = totalSamples - (frameSize - static_cast<size_t>(hopSize));
+void WAVEncoder::interleaveChannels(
+	std::vector<std::vector<float>>& channelAudio,
+	EncodingResult& result
+) {
+	const size_t numChannels = channelAudio.size();
+	if (numChannels == 1) {
+		result.audioSamples = std::move(channelAudio[0]);
+		return;
+	}
 
-	for (size_t i = 0; i < output.size(); ++i) {
-		if (normalisation[i] > normalisationEpsilon) {
-			if (i < edgeStart || i >= edgeEnd) {
-				output[i] /= std::max(expectedColaSumHann50, normalisation[i]);
-			} else {
-				output[i] /= normalisation[i];
-			}
+	size_t numSamplesPerChannel = channelAudio[0].size();
+	for (size_t ch = 1; ch < numChannels; ++ch) {
+		numSamplesPerChannel = std::min(numSamplesPerChannel, channelAudio[ch].size());
+	}
+
+	result.audioSamples.resize(numSamplesPerChannel * numChannels);
+	for (size_t i = 0; i < numSamplesPerChannel; ++i) {
+		for (size_t ch = 0; ch < numChannels; ++ch) {
+			result.audioSamples[i * numChannels + ch] = channelAudio[ch][i];
 		}
 	}
+}
 
-	return output;
+std::vector<float> WAVEncoder::inverseFFT(
+	std::span<const float> magnitudes,
+	std::span<const float> phases,
+	int fftSize
+) {
+	try {
+		InverseSTFT synthesis(fftSize, fftSize);
+		const std::span<const float> timeDomain = synthesis.transform(magnitudes, phases);
+		return std::vector<float>(timeDomain.begin(), timeDomain.end());
+	} catch (const std::runtime_error&) {
+		return std::vector<float>(static_cast<size_t>(fftSize), 0.0f);
+	}
 }
 
 bool WAVEncoder::exportToWAV(
 	const std::string& wavPath,
 	const std::vector<float>& audioSamples,
 	float sampleRate,
-	size_t numChannels
+	size_t numChannels,
+	const WAVWriter::Options& options
 ) {
-	if (audioSamples.empty() || numChannels == 0) {
+	if (audioSamples.empty() || numChannels == 0 || numChannels > std::numeric_limits<uint16_t>::max()) {
 		return false;
 	}
 
-	std::ofstream file(wavPath, std::ios::binary);
-	if (!file.is_open()) {
+	WAVWriter writer;
+	if (!writer.open(wavPath, static_cast<uint32_t>(sampleRate), static_cast<uint16_t>(numChannels), options)) {
 		return false;
 	}
 
-	const uint32_t numSamples = static_cast<uint32_t>(audioSamples.size());
-	const uint16_t bitsPerSample = 16;
-	const uint32_t byteRate = static_cast<uint32_t>(sampleRate) * static_cast<uint32_t>(numChannels) * (bitsPerSample / 8);
-	const uint16_t blockAlign = static_cast<uint16_t>(numChannels * (bitsPerSample / 8));
-	const uint32_t dataSize = numSamples * blockAlign;
-	const uint32_t fileSize = 36 + dataSize;
-
-	file.write("RIFF", 4);
-	file.write(reinterpret_cast<const char*>(&fileSize), 4);
-	file.write("WAVE", 4);
-
-	file.write("fmt ", 4);
-	uint32_t fmtSize = 16;
-	file.write(reinterpret_cast<const char*>(&fmtSize), 4);
-	uint16_t audioFormat = 1;
-	file.write(reinterpret_cast<const char*>(&audioFormat), 2);
-	uint16_t channels = static_cast<uint16_t>(numChannels);
-	file.write(reinterpret_cast<const char*>(&channels), 2);
-	uint32_t sampleRateInt = static_cast<uint32_t>(sampleRate);
-	file.write(reinterpret_cast<const char*>(&sampleRateInt), 4);
-	file.write(reinterpret_cast<const char*>(&byteRate), 4);
-	file.write(reinterpret_cast<const char*>(&blockAlign), 2);
-	file.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
-
-	file.write("data", 4);
-	file.write(reinterpret_cast<const char*>(&dataSize), 4);
-
-	std::vector<int16_t> intSamples(audioSamples.size());
-	for (size_t i = 0; i < audioSamples.size(); ++i) {
-		intSamples[i] = static_cast<int16_t>(std::clamp(audioSamples[i], -1.0f, 1.0f) * 32767.0f);
-	}
-	file.write(reinterpret_cast<const char*>(intSamples.data()), static_cast<std::streamsize>(intSamples.size() * sizeof(int16_t)));
-
-	file.close();
-	return true;
+	// A trailing partial frame is dropped rather than written as a torn frame.
+	const size_t wholeSamples = audioSamples.size() - audioSamples.size() % numChannels;
+	const bool written = writer.write(std::span<const float>(audioSamples.data(), wholeSamples));
+	return writer.close() && written;
 }
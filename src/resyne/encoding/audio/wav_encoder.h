@@ -1,7 +1,15 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
+#include <functional>
+#include <span>
 #include <string>
+#include <vector>
+
+#include "resyne/encoding/audio/wav_writer.h"
+#include "utilities/threading/task_scheduler.h"
+
+class SpectralSequenceView;
 
 struct SpectralSample {
 	std::vector<std::vector<float>> magnitudes;
@@ -21,6 +29,34 @@ public:
 		std::string errorMessage;
 	};
 
+	struct ChannelFrame {
+		std::span<const float> magnitudes;
+		std::span<const float> phases;
+		std::span<const float> frequencies;
+		bool present = false;
+	};
+
+	// Read-only view over spectral frames stored elsewhere, so callers can reconstruct
+	// straight from their own layout. frameAt(channel, frame) is called from several
+	// threads at once and the spans it returns must stay valid for the whole call.
+	// Reconstruction checks cancellation between frames and, once it is set, stops and
+	// returns no channels.
+	struct FrameSource {
+		size_t channelCount = 0;
+		size_t frameCount = 0;
+		std::function<ChannelFrame(size_t, size_t)> frameAt;
+		Utilities::Threading::CancellationToken cancellation;
+	};
+
+	// One channel's overlap-add output before varispeed and limiting, with a fingerprint of
+	// each frame it was built from.
+	struct ChannelCache {
+		int fftSize = 0;
+		int hopSize = 0;
+		std::vector<std::uint64_t> frameHashes;
+		std::vector<float> overlapAdded;
+	};
+
 	static EncodingResult reconstructFromSpectralData(
 		const std::vector<SpectralSample>& samples,
 		float sampleRate,
@@ -28,22 +64,91 @@ public:
 		int hopSize = 1024
 	);
 
+	static EncodingResult reconstructFromSequence(
+		SpectralSequenceView sequence,
+		float sampleRate,
+		int fftSize = 2048,
+		int hopSize = 1024,
+		const Utilities::Threading::CancellationToken& cancellation = {}
+	);
+
+	static std::vector<float> reconstructChannel(
+		SpectralSequenceView sequence,
+		size_t channel,
+		float sampleRate,
+		int fftSize = 2048,
+		int hopSize = 1024
+	);
+
+	// Reconstructs every channel, running channels and time segments within each channel
+	// concurrently. onChannelDone is called once per finished channel from a worker thread;
+	// calls never overlap.
+	static std::vector<std::vector<float>> reconstructChannels(
+		SpectralSequenceView sequence,
+		float sampleRate,
+		int fftSize = 2048,
+		int hopSize = 1024,
+		const std::function<void(size_t)>& onChannelDone = nullptr,
+		const Utilities::Threading::CancellationToken& cancellation = {}
+	);
+
+	// Frames of a sequence as a FrameSource. Without frequencies every frame is synthesised on
+	// the plain bin grid, skipping varispeed correction.
+	static FrameSource frameSource(SpectralSequenceView sequence, bool withFrequencies = true);
+
+	// With a cache, each channel only re-synthesises the frames whose spectra differ from
+	// the cached run (plus the frames their windows overlap) and splices them into the
+	// cached overlap-add output; the cache is then updated to this run. The result matches
+	// an uncached reconstruction exactly.
+	static std::vector<std::vector<float>> reconstructChannels(
+		const FrameSource& source,
+		float sampleRate,
+		int fftSize = 2048,
+		int hopSize = 1024,
+		const std::function<void(size_t)>& onChannelDone = nullptr,
+		std::vector<ChannelCache>* cache = nullptr
+	);
+
+	// audioSamples is interleaved.
 	static bool exportToWAV(
 		const std::string& wavPath,
 		const std::vector<float>& audioSamples,
 		float sampleRate,
-		size_t numChannels = 1
+		size_t numChannels = 1,
+		const WAVWriter::Options& options = {}
 	);
 
 	static std::vector<float> inverseFFT(
-		const std::vector<float>& magnitudes,
-		const std::vector<float>& phases,
+		std::span<const float> magnitudes,
+		std::span<const float> phases,
 		int fftSize
 	);
 
 private:
-	static std::vector<float> overlapAdd(
-		const std::vector<std::vector<float>>& frames,
-		int hopSize
+	// frameAt is called from up to threadCount threads at once.
+	static std::vector<float> reconstructChannelFrames(
+		size_t frameCount,
+		const std::function<ChannelFrame(size_t)>& frameAt,
+		float sampleRate,
+		int fftSize,
+		int hopSize,
+		size_t threadCount,
+		const Utilities::Threading::CancellationToken& cancellation
+	);
+
+	static std::vector<float> reconstructChannelFramesCached(
+		size_t frameCount,
+		const std::function<ChannelFrame(size_t)>& frameAt,
+		float sampleRate,
+		int fftSize,
+		int hopSize,
+		size_t threadCount,
+		const Utilities::Threading::CancellationToken& cancellation,
+		ChannelCache& cache
+	);
+
+	static void interleaveChannels(
+		std::vector<std::vector<float>>& channelAudio,
+		EncodingResult& result
 	);
 };
@@ -0,0 +1,293 @@
+#include "resyne/encoding/audio/wav_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef USE_NEON_OPTIMISATIONS
+#include "resyne/encoding/audio/neon/pcm_encoding_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "resyne/encoding/audio/sse/pcm_encoding_sse.h"
+#endif
+
+namespace {
+
+// Samples dithered or interleaved per pass; small enough to stay in cache.
+constexpr size_t STAGING_SAMPLES = 8192;
+constexpr uint64_t RIFF_SIZE_LIMIT = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t DS64_PAYLOAD_BYTES = 28;
+
+constexpr float INT16_SCALE = 32767.0f;
+constexpr float INT24_SCALE = 8388607.0f;
+
+void appendBytes(std::vector<uint8_t>& out, const char* text) {
+	out.insert(out.end(), text, text + 4);
+}
+
+template <typename T>
+void appendValue(std::vector<uint8_t>& out, const T value) {
+	uint8_t bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// NaN goes to -1, matching the vector kernels' min/max.
+float clampSample(const float value) {
+	const float lower = value > -1.0f ? value : -1.0f;
+	return lower < 1.0f ? lower : 1.0f;
+}
+
+size_t encodeInt16Vectorised(const float* samples, const size_t sampleCount, uint8_t* out) {
+#ifdef USE_NEON_OPTIMISATIONS
+	return PCMEncodingNEON::encodeInt16(samples, sampleCount, out);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	return PCMEncodingSSE::encodeInt16(samples, sampleCount, out);
+#else
+	(void)samples;
+	(void)sampleCount;
+	(void)out;
+	return 0;
+#endif
+}
+
+size_t encodeInt24Vectorised(const float* samples, const size_t sampleCount, uint8_t* out) {
+#ifdef USE_NEON_OPTIMISATIONS
+	return PCMEncodingNEON::encodeInt24(samples, sampleCount, out);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	return PCMEncodingSSE::encodeInt24(samples, sampleCount, out);
+#else
+	(void)samples;
+	(void)sampleCount;
+	(void)out;
+	return 0;
+#endif
+}
+
+}
+
+WAVWriter::~WAVWriter() {
+	close();
+}
+
+bool WAVWriter::open(const std::string& path, const uint32_t rate, const uint16_t channels) {
+	return open(path, rate, channels, Options{});
+}
+
+bool WAVWriter::open(const std::string& path, const uint32_t rate, const uint16_t channels, const Options& writerOptions) {
+	close();
+	if (channels == 0 || rate == 0) {
+		return false;
+	}
+
+	options = writerOptions;
+	sampleRate = rate;
+	channelCount = channels;
+	samplesWritten = 0;
+	failed = false;
+	bufferUsed = 0;
+	buffer.resize(std::max(options.bufferBytes, STAGING_SAMPLES * sizeof(float)));
+	staging.resize(STAGING_SAMPLES);
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	const std::vector<uint8_t> header = buildHeader(0);
+	file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+	failed = !file;
+	return !failed;
+}
+
+bool WAVWriter::write(std::span<const float> samples) {
+	if (!file.is_open() || failed || samples.size() % channelCount != 0) {
+		return false;
+	}
+
+	for (size_t offset = 0; offset < samples.size(); offset += STAGING_SAMPLES) {
+		const size_t count = std::min(STAGING_SAMPLES, samples.size() - offset);
+		if (!append(samples.data() + offset, count)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool WAVWriter::writePlanar(std::span<const std::span<const float>> channels) {
+	if (!file.is_open() || failed || channels.size() != channelCount) {
+		return false;
+	}
+
+	size_t frameCount = std::numeric_limits<size_t>::max();
+	for (const auto& channel : channels) {
+		frameCount = std::min(frameCount, channel.size());
+	}
+
+	const size_t blockFrames = std::max<size_t>(1, STAGING_SAMPLES / channelCount);
+	staging.resize(std::max(STAGING_SAMPLES, blockFrames * channelCount));
+	for (size_t start = 0; start < frameCount; start += blockFrames) {
+		const size_t frames = std::min(blockFrames, frameCount - start);
+		for (size_t ch = 0; ch < channelCount; ++ch) {
+			const float* source = channels[ch].data() + start;
+			for (size_t frame = 0; frame < frames; ++frame) {
+				staging[frame * channelCount + ch] = source[frame];
+			}
+		}
+		if (!append(staging.data(), frames * channelCount)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool WAVWriter::close() {
+	if (!file.is_open()) {
+		return !failed;
+	}
+
+	const uint64_t dataBytes = samplesWritten * bytesPerSample();
+	if (!failed && flush() && dataBytes % 2 != 0) {
+		file.put('\0');
+	}
+
+	if (!failed) {
+		const std::vector<uint8_t> header = buildHeader(dataBytes);
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+		failed = !file;
+	}
+
+	file.close();
+	failed = failed || file.fail();
+	buffer.clear();
+	buffer.shrink_to_fit();
+	return !failed;
+}
+
+size_t WAVWriter::bytesPerSample() const {
+	switch (options.format) {
+		case WAVSampleFormat::PCM24:
+			return 3;
+		case WAVSampleFormat::Float32:
+			return 4;
+		case WAVSampleFormat::PCM16:
+		default:
+			return 2;
+	}
+}
+
+// The same length whatever dataBytes is, so close() can write it over the placeholder.
+std::vector<uint8_t> WAVWriter::buildHeader(const uint64_t dataBytes) const {
+	const bool isFloat = options.format == WAVSampleFormat::Float32;
+	const uint16_t sampleBytes = static_cast<uint16_t>(bytesPerSample());
+	const uint16_t blockAlign = static_cast<uint16_t>(channelCount * sampleBytes);
+	const uint32_t fmtBytes = isFloat ? 18 : 16;
+	const uint64_t frames = framesWritten();
+
+	const size_t headerBytes = 12 + (8 + DS64_PAYLOAD_BYTES) + (8 + fmtBytes) + (isFloat ? 12 : 0) + 8;
+	const uint64_t riffBytes = headerBytes - 8 + dataBytes + (dataBytes % 2);
+	const bool rf64 = riffBytes > RIFF_SIZE_LIMIT;
+
+	std::vector<uint8_t> header;
+	header.reserve(headerBytes);
+	appendBytes(header, rf64 ? "RF64" : "RIFF");
+	appendValue<uint32_t>(header, rf64 ? static_cast<uint32_t>(RIFF_SIZE_LIMIT) : static_cast<uint32_t>(riffBytes));
+	appendBytes(header, "WAVE");
+
+	// Readers skip JUNK, so a file that stays under 4 GiB is a plain RIFF WAV.
+	appendBytes(header, rf64 ? "ds64" : "JUNK");
+	appendValue<uint32_t>(header, DS64_PAYLOAD_BYTES);
+	appendValue<uint64_t>(header, rf64 ? riffBytes : 0);
+	appendValue<uint64_t>(header, rf64 ? dataBytes : 0);
+	appendValue<uint64_t>(header, rf64 ? frames : 0);
+	appendValue<uint32_t>(header, 0);
+
+	appendBytes(header, "fmt ");
+	appendValue<uint32_t>(header, fmtBytes);
+	appendValue<uint16_t>(header, isFloat ? 3 : 1);
+	appendValue<uint16_t>(header, channelCount);
+	appendValue<uint32_t>(header, sampleRate);
+	appendValue<uint32_t>(header, sampleRate * blockAlign);
+	appendValue<uint16_t>(header, blockAlign);
+	appendValue<uint16_t>(header, static_cast<uint16_t>(sampleBytes * 8));
+	if (isFloat) {
+		appendValue<uint16_t>(header, 0);
+		appendBytes(header, "fact");
+		appendValue<uint32_t>(header, 4);
+		appendValue<uint32_t>(header, static_cast<uint32_t>(std::min<uint64_t>(frames, RIFF_SIZE_LIMIT)));
+	}
+
+	appendBytes(header, "data");
+	appendValue<uint32_t>(header, rf64 ? static_cast<uint32_t>(RIFF_SIZE_LIMIT) : static_cast<uint32_t>(dataBytes));
+	return header;
+}
+
+bool WAVWriter::append(const float* samples, const size_t sampleCount) {
+	const bool dithered = options.dither && options.format != WAVSampleFormat::Float32;
+	if (dithered) {
+		const float lsb = 1.0f / (options.format == WAVSampleFormat::PCM24 ? INT24_SCALE : INT16_SCALE);
+		for (size_t i = 0; i < sampleCount; ++i) {
+			staging[i] = samples[i] + nextDither() * lsb;
+		}
+		samples = staging.data();
+	}
+
+	const size_t bytes = sampleCount * bytesPerSample();
+	if (bufferUsed + bytes > buffer.size() && !flush()) {
+		return false;
+	}
+	if (bytes > buffer.size()) {
+		buffer.resize(bytes);
+	}
+
+	encode(samples, sampleCount, buffer.data() + bufferUsed);
+	bufferUsed += bytes;
+	samplesWritten += sampleCount;
+	return true;
+}
+
+bool WAVWriter::flush() {
+	if (bufferUsed > 0) {
+		file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(bufferUsed));
+		bufferUsed = 0;
+		failed = failed || !file;
+	}
+	return !failed;
+}
+
+void WAVWriter::encode(const float* samples, const size_t sampleCount, uint8_t* out) const {
+	switch (options.format) {
+		case WAVSampleFormat::Float32:
+			std::memcpy(out, samples, sampleCount * sizeof(float));
+			return;
+		case WAVSampleFormat::PCM24:
+			for (size_t i = encodeInt24Vectorised(samples, sampleCount, out); i < sampleCount; ++i) {
+				const int32_t value = static_cast<int32_t>(std::lrint(clampSample(samples[i]) * INT24_SCALE));
+				out[i * 3] = static_cast<uint8_t>(value);
+				out[i * 3 + 1] = static_cast<uint8_t>(value >> 8);
+				out[i * 3 + 2] = static_cast<uint8_t>(value >> 16);
+			}
+			return;
+		case WAVSampleFormat::PCM16:
+		default:
+			for (size_t i = encodeInt16Vectorised(samples, sampleCount, out); i < sampleCount; ++i) {
+				const int16_t value = static_cast<int16_t>(std::lrint(clampSample(samples[i]) * INT16_SCALE));
+				std::memcpy(out + i * 2, &value, sizeof(value));
+			}
+			return;
+	}
+}
+
+// Difference of two uniforms in [0, 1): triangular over (-1, 1), so the quantisation error
+// stays independent of the signal.
+float WAVWriter::nextDither() {
+	const auto uniform = [this] {
+		ditherState ^= ditherState << 13;
+		ditherState ^= ditherState >> 17;
+		ditherState ^= ditherState << 5;
+		return static_cast<float>(ditherState >> 8) * (1.0f / 16777216.0f);
+	};
+	const float first = uniform();
+	return first - uniform();
+}
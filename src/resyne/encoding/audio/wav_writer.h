@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+enum class WAVSampleFormat {
+	PCM16,
+	PCM24,
+	Float32
+};
+
+// Streams float audio into a WAV file a block at a time, so writing costs one buffer of
+// memory however long the track is. The header goes out first with a JUNK chunk holding
+// room for ds64; close() fills in the sizes and, once the file has passed 4 GiB, turns the
+// header into RF64.
+class WAVWriter {
+public:
+	struct Options {
+		WAVSampleFormat format = WAVSampleFormat::PCM16;
+		// Triangular dither of one LSB peak added before quantising. Ignored for Float32.
+		bool dither = false;
+		size_t bufferBytes = size_t{4} << 20;
+	};
+
+	WAVWriter() = default;
+	~WAVWriter();
+
+	WAVWriter(const WAVWriter&) = delete;
+	WAVWriter& operator=(const WAVWriter&) = delete;
+
+	bool open(const std::string& path, uint32_t sampleRate, uint16_t channels, const Options& options);
+	bool open(const std::string& path, uint32_t sampleRate, uint16_t channels);
+
+	// Interleaved frames. A write that fails leaves the writer failed; close() then reports it.
+	bool write(std::span<const float> samples);
+	// One span per channel; frames beyond the shortest channel are ignored.
+	bool writePlanar(std::span<const std::span<const float>> channels);
+
+	// Writes out the buffer and the final header. Safe to call more than once.
+	bool close();
+
+	bool isOpen() const { return file.is_open(); }
+	uint64_t framesWritten() const { return channelCount == 0 ? 0 : samplesWritten / channelCount; }
+
+private:
+	size_t bytesPerSample() const;
+	std::vector<uint8_t> buildHeader(uint64_t dataBytes) const;
+	// sampleCount is at most one staging block; samples may be the staging buffer itself.
+	bool append(const float* samples, size_t sampleCount);
+	bool flush();
+	void encode(const float* samples, size_t sampleCount, uint8_t* out) const;
+	float nextDither();
+
+	std::ofstream file;
+	Options options;
+	uint32_t sampleRate = 0;
+	uint16_t channelCount = 0;
+	uint64_t samplesWritten = 0;
+	bool failed = false;
+	uint32_t ditherState = 0x9E3779B9u;
+	std::vector<uint8_t> buffer;
+	size_t bufferUsed = 0;
+	// Dithered or interleaved samples on their way into the buffer.
+	std::vector<float> staging;
+};
@@ -0,0 +1,131 @@
+#include "resyne/encoding/formats/crc32.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#ifdef USE_NEON_OPTIMISATIONS
+#include "resyne/encoding/formats/neon/crc32_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "resyne/encoding/formats/sse/crc32_sse.h"
+#endif
+
+namespace CRC32 {
+
+namespace {
+
+constexpr std::uint32_t kPolynomial = 0xEDB88320U;
+constexpr std::size_t kSlices = 16;
+
+using SliceTables = std::array<std::array<std::uint32_t, 256>, kSlices>;
+
+// tables[k][b] is the CRC of byte b followed by k zero bytes.
+constexpr SliceTables buildTables() {
+    SliceTables tables{};
+    for (std::uint32_t byte = 0; byte < 256; ++byte) {
+        std::uint32_t crc = byte;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) != 0 ? (crc >> 1) ^ kPolynomial : crc >> 1;
+        }
+        tables[0][byte] = crc;
+    }
+    for (std::size_t slice = 1; slice < kSlices; ++slice) {
+        for (std::size_t byte = 0; byte < 256; ++byte) {
+            const std::uint32_t previous = tables[slice - 1][byte];
+            tables[slice][byte] = (previous >> 8) ^ tables[0][previous & 0xFFU];
+        }
+    }
+    return tables;
+}
+
+constexpr SliceTables kTables = buildTables();
+
+std::uint32_t loadLittleEndian32(const std::uint8_t* bytes) {
+    std::uint32_t value = 0;
+    std::memcpy(&value, bytes, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = ((value & 0xFFU) << 24) | ((value & 0xFF00U) << 8) | ((value >> 8) & 0xFF00U) | (value >> 24);
+    }
+    return value;
+}
+
+// Works on the register value, before zlib's final inversion.
+std::uint32_t updateSliced(std::uint32_t state, const std::uint8_t* bytes, std::size_t size) {
+    for (; size >= kSlices; bytes += kSlices, size -= kSlices) {
+        const std::uint32_t a = loadLittleEndian32(bytes) ^ state;
+        const std::uint32_t b = loadLittleEndian32(bytes + 4);
+        const std::uint32_t c = loadLittleEndian32(bytes + 8);
+        const std::uint32_t d = loadLittleEndian32(bytes + 12);
+        state = kTables[15][a & 0xFFU] ^ kTables[14][(a >> 8) & 0xFFU] ^
+                kTables[13][(a >> 16) & 0xFFU] ^ kTables[12][a >> 24] ^
+                kTables[11][b & 0xFFU] ^ kTables[10][(b >> 8) & 0xFFU] ^
+                kTables[9][(b >> 16) & 0xFFU] ^ kTables[8][b >> 24] ^
+                kTables[7][c & 0xFFU] ^ kTables[6][(c >> 8) & 0xFFU] ^
+                kTables[5][(c >> 16) & 0xFFU] ^ kTables[4][c >> 24] ^
+                kTables[3][d & 0xFFU] ^ kTables[2][(d >> 8) & 0xFFU] ^
+                kTables[1][(d >> 16) & 0xFFU] ^ kTables[0][d >> 24];
+    }
+    for (; size > 0; ++bytes, --size) {
+        state = (state >> 8) ^ kTables[0][(state ^ *bytes) & 0xFFU];
+    }
+    return state;
+}
+
+// Product of two polynomials modulo the CRC polynomial, in the reflected bit order.
+constexpr std::uint32_t multiplyModP(std::uint32_t a, std::uint32_t b) {
+    std::uint32_t product = 0;
+    for (std::uint32_t mask = 1U << 31; mask != 0; mask >>= 1) {
+        if ((a & mask) != 0) {
+            product ^= b;
+            if ((a & (mask - 1)) == 0) {
+                break;
+            }
+        }
+        b = (b & 1U) != 0 ? (b >> 1) ^ kPolynomial : b >> 1;
+    }
+    return product;
+}
+
+// powersOfX[k] is x^(2^k) modulo the polynomial.
+constexpr std::array<std::uint32_t, 32> buildPowersOfX() {
+    std::array<std::uint32_t, 32> powers{};
+    std::uint32_t power = 1U << 30;  // x^1
+    for (std::uint32_t& entry : powers) {
+        entry = power;
+        power = multiplyModP(power, power);
+    }
+    return powers;
+}
+
+constexpr std::array<std::uint32_t, 32> kPowersOfX = buildPowersOfX();
+
+}
+
+std::uint32_t update(const std::uint32_t crc, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    std::uint32_t state = ~crc;
+    std::size_t consumed = 0;
+#ifdef USE_NEON_OPTIMISATIONS
+    consumed = CRC32NEON::update(state, bytes, size);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    consumed = CRC32SSE::update(state, bytes, size);
+#endif
+    return ~updateSliced(state, bytes + consumed, size - consumed);
+}
+
+std::uint32_t compute(const std::span<const std::uint8_t> data) {
+    return update(0, data.data(), data.size());
+}
+
+std::uint32_t combine(const std::uint32_t crcA, const std::uint32_t crcB, std::uint64_t sizeB) {
+    // Appending sizeB bytes multiplies A's CRC by x^(8 * sizeB).
+    std::uint32_t shift = 1U << 31;  // x^0
+    for (std::size_t k = 3; sizeB != 0; sizeB >>= 1, ++k) {
+        if ((sizeB & 1U) != 0) {
+            shift = multiplyModP(kPowersOfX[k & 31], shift);
+        }
+    }
+    return multiplyModP(shift, crcA) ^ crcB;
+}
+
+}
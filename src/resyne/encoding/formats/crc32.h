@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// The CRC-32 of zlib and PNG (reflected polynomial 0xEDB88320), computing the same values as
+// mz_crc32. Slicing-by-16 tables by default; PCLMULQDQ folding on x86 and the ARMv8 CRC32
+// instructions where the running CPU has them.
+namespace CRC32 {
+
+// Extends crc, which starts at 0, over size more bytes.
+std::uint32_t update(std::uint32_t crc, const void* data, std::size_t size);
+std::uint32_t compute(std::span<const std::uint8_t> data);
+
+// The CRC of A followed by B, from crcA, crcB and the length of B, so pieces checksummed
+// separately need not be read again to checksum the whole.
+std::uint32_t combine(std::uint32_t crcA, std::uint32_t crcB, std::uint64_t sizeB);
+
+}
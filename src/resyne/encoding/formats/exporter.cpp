@@ -4,15 +4,16 @@
 #include "resyne/encoding/formats/format_wav.h"
 
 bool SequenceExporter::exportToRsyn(const std::string& filepath,
-                                    const std::vector<AudioColourSample>& samples,
+                                    const SpectralSequenceView samples,
                                     const AudioMetadata& metadata,
                                     const RSYNExportOptions& options,
-                                    const std::function<void(float)>& progress) {
-    return SequenceExporterInternal::exportToRsyn(filepath, samples, metadata, options, progress);
+                                    const std::function<void(float)>& progress,
+                                    const Utilities::Threading::CancellationToken& cancellation) {
+    return SequenceExporterInternal::exportToRsyn(filepath, samples, metadata, options, progress, cancellation);
 }
 
 bool SequenceExporter::loadFromRsyn(const std::string& filepath,
-                                    std::vector<AudioColourSample>& samples,
+                                    SpectralSequence& samples,
                                     AudioMetadata& metadata,
                                     const std::function<void(float)>& progress,
                                     const SequenceFrameCallback& onFrameDecoded) {
@@ -21,40 +22,56 @@ bool SequenceExporter::loadFromRsyn(const std::string& filepath,
 
 bool SequenceExporter::loadFromRsynShell(const std::string& filepath,
                                          AudioMetadata& metadata,
-                                         const std::function<void(float)>& progress) {
-    return SequenceExporterInternal::loadFromRsynShell(filepath, metadata, progress);
+                                         const std::function<void(float)>& progress,
+                                         const RSYNPreviewCallback& onPreviewDecoded) {
+    return SequenceExporterInternal::loadFromRsynShell(filepath, metadata, progress, onPreviewDecoded);
 }
 
 bool SequenceExporter::hydrateRsynSamples(AudioMetadata& metadata,
-                                          std::vector<AudioColourSample>& samples,
+                                          SpectralSequence& samples,
                                           const std::function<void(float)>& progress,
                                           const SequenceFrameCallback& onFrameDecoded) {
     return SequenceExporterInternal::hydrateRsynSamples(metadata, samples, progress, onFrameDecoded);
 }
 
+bool SequenceExporter::hydrateRsynFrames(const AudioMetadata& metadata,
+                                         const size_t firstFrame,
+                                         const size_t frameCount,
+                                         SpectralSequence& frames) {
+    return SequenceExporterInternal::hydrateRsynFrames(metadata, firstFrame, frameCount, frames);
+}
+
 bool SequenceExporter::hydrateRsynSource(AudioMetadata& metadata,
                                          const std::function<void(float)>& progress) {
     return SequenceExporterInternal::hydrateRsynSource(metadata, progress);
 }
 
+bool SequenceExporter::compactRsyn(const std::string& filepath, AudioMetadata& metadata) {
+    return SequenceExporterInternal::compactRsyn(filepath, metadata);
+}
+
 bool SequenceExporter::exportToWAV(const std::string& filepath,
-                                   const std::vector<AudioColourSample>& samples,
+                                   const SpectralSequenceView samples,
                                    const AudioMetadata& metadata,
-                                   const std::function<void(float)>& progress) {
-	return SequenceExporterInternal::exportToWAV(filepath, samples, metadata, progress);
+                                   const std::function<void(float)>& progress,
+                                   const Utilities::Threading::CancellationToken& cancellation) {
+	return SequenceExporterInternal::exportToWAV(filepath, samples, metadata, progress, cancellation);
 }
 
 bool SequenceExporter::exportToTIFF(const std::string& filepath,
-                                    const std::vector<AudioColourSample>& samples,
+                                    const SpectralSequenceView samples,
                                     const AudioMetadata& metadata,
-                                    const std::function<void(float)>& progress) {
-	return SequenceExporterInternal::exportToTIFF(filepath, samples, metadata, progress);
+                                    const std::function<void(float)>& progress,
+                                    const TIFFExportOptions& options,
+                                    const Utilities::Threading::CancellationToken& cancellation) {
+	return SequenceExporterInternal::exportToTIFF(filepath, samples, metadata, progress, options, cancellation);
 }
 
 bool SequenceExporter::loadFromTIFF(const std::string& filepath,
-                                    std::vector<AudioColourSample>& samples,
+                                    SpectralSequence& samples,
                                     AudioMetadata& metadata,
                                     const std::function<void(float)>& progress,
-                                    const SequenceFrameCallback& onFrameDecoded) {
-    return SequenceExporterInternal::loadFromTIFF(filepath, samples, metadata, progress, onFrameDecoded);
+                                    const SequenceFrameCallback& onFrameDecoded,
+                                    const Utilities::Threading::CancellationToken& cancellation) {
+    return SequenceExporterInternal::loadFromTIFF(filepath, samples, metadata, progress, onFrameDecoded, cancellation);
 }
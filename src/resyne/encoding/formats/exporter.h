@@ -4,24 +4,17 @@
 #include <vector>
 #include <cstdint>
 #include <functional>
-#include <limits>
 #include <memory>
 
 #include "resyne/encoding/formats/rsyn_asset.h"
-
-struct AudioColourSample {
-	std::vector<std::vector<float>> magnitudes;
-	std::vector<std::vector<float>> phases;
-	std::vector<std::vector<float>> frequencies;
-	double timestamp;
-	float sampleRate;
-	float loudnessLUFS = std::numeric_limits<float>::quiet_NaN();
-	float splDb = std::numeric_limits<float>::quiet_NaN();
-	std::uint32_t channels = 1;
-};
+#include "resyne/encoding/formats/spectral_sequence.h"
+#include "utilities/threading/task_scheduler.h"
 
 struct AudioMetadata {
+    // The rate the frames were analysed at. Above 88.2 kHz an import may decimate first, and
+    // the source then ran analysisDecimation times faster.
     float sampleRate = 0.0f;
+    int analysisDecimation = 1;
     int fftSize = 0;
     int hopSize = 0;
     double durationSeconds = 0.0;
@@ -35,51 +28,102 @@ struct AudioMetadata {
     std::shared_ptr<RSYNLazyAsset> lazyAsset;
 };
 
+// Deflate keeps the original float32 SPEC bytes. Lossless shuffles the same bytes into
+// planes first. NearLossless quantises to 16 bits and then shuffles. Magnitude error is
+// about 0.02% across a 100 dB frame and phase error stays within 0.00005 rad. Half stores
+// magnitudes and phases as half floats, shuffled: about 0.05% relative error on either and
+// no per-frame prediction, so any frame decodes on its own.
+enum class RSYNSpectralCodec {
+    Deflate,
+    Lossless,
+    NearLossless,
+    Half
+};
+
 struct RSYNExportOptions {
     RSYNPresentationSettings presentationSettings{};
+    RSYNSpectralCodec spectralCodec = RSYNSpectralCodec::Deflate;
+    // Above zero, also stores up to this many of each frame's strongest peaks, linked into
+    // tracks, as a PEAK chunk for consumers that want the partials rather than every bin.
+    std::size_t peakTrackCount = 0;
 };
 
-using SequenceFrameCallback = std::function<void(const std::vector<AudioColourSample>&, size_t)>;
+// TIFF strip compression. Deflate runs the floating-point predictor over each row first.
+enum class TIFFCompression {
+    None,
+    Deflate
+};
+
+struct TIFFExportOptions {
+    TIFFCompression compression = TIFFCompression::None;
+    // Stores 16-bit IEEE half floats instead of float32, halving the file. Channels in
+    // [0, 1] round within 2^-12, under the 0.001 change threshold edit detection uses.
+    bool halfFloat = false;
+};
 
+using SequenceFrameCallback = std::function<void(const SpectralSequence&, size_t)>;
+// Called by loadFromRsynShell with the embedded preview, before the presentation track is
+// decoded, when the file has one.
+using RSYNPreviewCallback = std::function<void(std::shared_ptr<const RSYNPreviewData>)>;
+
+// The exports and loadFromTIFF stop once their cancellation token is set and return false,
+// removing whatever part of the output file they had written.
 class SequenceExporter {
 public:
     static bool exportToRsyn(const std::string& filepath,
-                             const std::vector<AudioColourSample>& samples,
+                             SpectralSequenceView samples,
                              const AudioMetadata& metadata,
                              const RSYNExportOptions& options,
-                             const std::function<void(float)>& progress = {});
+                             const std::function<void(float)>& progress = {},
+                             const Utilities::Threading::CancellationToken& cancellation = {});
 
     static bool loadFromRsyn(const std::string& filepath,
-                             std::vector<AudioColourSample>& samples,
+                             SpectralSequence& samples,
                              AudioMetadata& metadata,
                              const std::function<void(float)>& progress = {},
                              const SequenceFrameCallback& onFrameDecoded = {});
 
     static bool loadFromRsynShell(const std::string& filepath,
                                   AudioMetadata& metadata,
-                                  const std::function<void(float)>& progress = {});
+                                  const std::function<void(float)>& progress = {},
+                                  const RSYNPreviewCallback& onPreviewDecoded = {});
 
     static bool hydrateRsynSamples(AudioMetadata& metadata,
-                                   std::vector<AudioColourSample>& samples,
+                                   SpectralSequence& samples,
                                    const std::function<void(float)>& progress = {},
                                    const SequenceFrameCallback& onFrameDecoded = {});
 
+    static bool hydrateRsynFrames(const AudioMetadata& metadata,
+                                  size_t firstFrame,
+                                  size_t frameCount,
+                                  SpectralSequence& frames);
+
     static bool hydrateRsynSource(AudioMetadata& metadata,
                                   const std::function<void(float)>& progress = {});
 
+    // Saving over a .rsyn appends what changed, so superseded pieces pile up until this drops
+    // them, once they are over half the file. Compaction moves every piece, so call it only
+    // while nothing reads filepath lazily. When metadata's lazy asset is filepath, its chunk
+    // index is re-read so the asset keeps reading the right bytes. True if it compacted.
+    static bool compactRsyn(const std::string& filepath, AudioMetadata& metadata);
+
 	static bool exportToWAV(const std::string& filepath,
-						   const std::vector<AudioColourSample>& samples,
+						   SpectralSequenceView samples,
 						   const AudioMetadata& metadata,
-						   const std::function<void(float)>& progress = {});
+						   const std::function<void(float)>& progress = {},
+						   const Utilities::Threading::CancellationToken& cancellation = {});
 
 	static bool exportToTIFF(const std::string& filepath,
-							const std::vector<AudioColourSample>& samples,
+							SpectralSequenceView samples,
 							const AudioMetadata& metadata,
-							const std::function<void(float)>& progress = {});
+							const std::function<void(float)>& progress = {},
+							const TIFFExportOptions& options = {},
+							const Utilities::Threading::CancellationToken& cancellation = {});
 
 	static bool loadFromTIFF(const std::string& filepath,
-							std::vector<AudioColourSample>& samples,
+							SpectralSequence& samples,
 							AudioMetadata& metadata,
 							const std::function<void(float)>& progress = {},
-							const SequenceFrameCallback& onFrameDecoded = {});
+							const SequenceFrameCallback& onFrameDecoded = {},
+							const Utilities::Threading::CancellationToken& cancellation = {});
 };
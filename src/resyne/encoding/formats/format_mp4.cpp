@@ -5,13 +5,18 @@
 #include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
 #include <deque>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 #ifdef _WIN32
@@ -21,6 +26,8 @@
 
 #include "colour/colour_core.h"
 #include "colour/colour_presentation.h"
+#include "resyne/encoding/formats/mp4_libav_writer.h"
+#include "resyne/encoding/formats/ycbcr_rows.h"
 #include "resyne/recorder/colour_cache_utils.h"
 #include "ui/smoothing/smoothing.h"
 #include "utilities/video/ffmpeg_locator.h"
@@ -38,6 +45,15 @@ constexpr int kMaxResolution = 7680;
 constexpr int kMinFps = 1;
 constexpr int kMaxFps = 240;
 
+constexpr const char* kCancelledMessage = "Export cancelled";
+
+// Solid frames are piped at this size and scaled up by ffmpeg: every pixel is the same, so
+// nothing is lost, and the pipe carries under 1 KB a frame rather than megabytes. It is
+// kept even and above 1x1 so the 4:2:0 frames have ordinary chroma planes.
+constexpr int kSolidSourceSize = 16;
+// Gradient frames only vary across x.
+constexpr int kGradientSourceHeight = 2;
+
 struct RGB {
     float r;
     float g;
@@ -78,9 +94,14 @@ inline uint16_t toWord(float value) {
     return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
 }
 
+// Colours a track at video frame times. Frames are placed between the two samples either
+// side of them, mixing the samples' colours in Oklab, and each sample's Oklab is computed
+// the first time a frame reaches it. Timestamps a uniform hop apart are indexed by
+// arithmetic; others, such as an edited TIFF, walk a cursor forward from the last frame
+// and fall back to a binary search when time moves backwards or jumps.
 class ColourTimelineSampler {
 public:
-    ColourTimelineSampler(const std::vector<AudioColourSample>& source,
+    ColourTimelineSampler(const SpectralSequenceView source,
                           ColourCore::ColourSpace colourSpace,
                           bool gamut,
                           float smoothingAmount,
@@ -92,31 +113,20 @@ public:
           frameInterval_(frameInterval) {
         smoother_.setSmoothingAmount(std::clamp(smoothingAmount, 0.0f, 1.0f));
         timestamps_.reserve(samples_.size());
-        for (const auto& sample : samples_) {
+        for (const SpectralFrame sample : samples_) {
             timestamps_.push_back(sample.timestamp);
         }
         if (!timestamps_.empty() && timestamps_.front() > 0.0) {
             startTime_ = timestamps_.front();
         }
+        oklab_.resize(samples_.size());
+        oklabReady_.assign(samples_.size(), 0);
+        detectUniformHop();
     }
 
     RGB colourAt(double timeSeconds) {
         timeSeconds = std::max(timeSeconds, 0.0);
-        const size_t sampleIndex = sampleIndexForTime(timeSeconds);
-        const AudioColourSample& sample = samples_[sampleIndex];
-        ReSyne::RecorderColourCache::CacheSettings settings{};
-        settings.colourSpace = colourSpace_;
-        settings.gamutMapping = gamut_;
-        settings.smoothingEnabled = false;
-        settings.smoothingAmount = 0.0f;
-        const auto entry = ReSyne::RecorderColourCache::computeSampleColour(
-            sample,
-            settings,
-            sampleIndex > 0 ? &samples_[sampleIndex - 1] : nullptr);
-
-        RGB rgb{std::clamp(entry.rgb.x, 0.0f, 1.0f),
-                std::clamp(entry.rgb.y, 0.0f, 1.0f),
-                std::clamp(entry.rgb.z, 0.0f, 1.0f)};
+        const RGB rgb = interpolatedColour(timeSeconds + startTime_);
 
         if (!initialised_) {
             smoother_.reset(rgb.r, rgb.g, rgb.b);
@@ -131,103 +141,308 @@ public:
         return RGB{outR, outG, outB};
     }
 
-    size_t sampleIndexForTime(double timeSeconds) const {
-        if (samples_.empty()) {
-            return 0;
+private:
+    // A larger spread between sample deltas still indexes correctly, just by the cursor.
+    static constexpr double kUniformHopTolerance = 1.0e-4;
+    // Steps the cursor may take before a binary search is cheaper.
+    static constexpr size_t kMaxCursorSteps = 8;
+
+    void detectUniformHop() {
+        if (timestamps_.size() < 2) {
+            return;
+        }
+        const double span = timestamps_.back() - timestamps_.front();
+        const double hop = span / static_cast<double>(timestamps_.size() - 1);
+        if (!(hop > 0.0) || !std::isfinite(hop)) {
+            return;
+        }
+        const double tolerance = hop * kUniformHopTolerance;
+        for (size_t i = 1; i < timestamps_.size(); ++i) {
+            if (std::abs((timestamps_[i] - timestamps_[i - 1]) - hop) > tolerance) {
+                return;
+            }
+        }
+        uniformHop_ = hop;
+    }
+
+    // First index whose timestamp is at or after targetTime, timestamps_.size() if none is.
+    size_t upperIndexFor(double targetTime) {
+        const size_t count = timestamps_.size();
+        size_t index = cursor_;
+        if (uniformHop_ > 0.0) {
+            const double position = std::ceil((targetTime - timestamps_.front()) / uniformHop_);
+            index = position <= 0.0 ? 0 : std::min(static_cast<size_t>(position), count);
+        }
+
+        // The estimate, or the cursor, is at most a few samples out; settle it exactly so
+        // both paths agree with a binary search.
+        size_t steps = 0;
+        while (index < count && timestamps_[index] < targetTime && steps < kMaxCursorSteps) {
+            ++index;
+            ++steps;
         }
-        if (timestamps_.empty()) {
-            return 0;
+        while (index > 0 && timestamps_[index - 1] >= targetTime && steps < kMaxCursorSteps) {
+            --index;
+            ++steps;
         }
+        const bool settled = (index == count || timestamps_[index] >= targetTime) &&
+                             (index == 0 || timestamps_[index - 1] < targetTime);
+        if (!settled) {
+            index = static_cast<size_t>(std::distance(
+                timestamps_.begin(),
+                std::lower_bound(timestamps_.begin(), timestamps_.end(), targetTime)));
+        }
+        cursor_ = index;
+        return index;
+    }
 
-        const double targetTime = timeSeconds + startTime_;
-        auto it = std::lower_bound(timestamps_.begin(), timestamps_.end(), targetTime);
-        if (it == timestamps_.end()) {
-            return samples_.size() - 1;
+    const ColourCore::Lab& sampleOklab(size_t index) {
+        if (!oklabReady_[index]) {
+            ReSyne::RecorderColourCache::CacheSettings settings{};
+            settings.colourSpace = colourSpace_;
+            settings.gamutMapping = gamut_;
+            settings.smoothingEnabled = false;
+            settings.smoothingAmount = 0.0f;
+            const SpectralFrame previous = index > 0 ? samples_[index - 1] : SpectralFrame{};
+            const auto entry = ReSyne::RecorderColourCache::computeSampleColour(
+                samples_[index],
+                settings,
+                index > 0 ? &previous : nullptr);
+            ColourCore::Lab& oklab = oklab_[index];
+            ColourCore::XYZtoOklab(entry.xyz.X, entry.xyz.Y, entry.xyz.Z, oklab.L, oklab.a, oklab.b);
+            oklabReady_[index] = 1;
         }
-        return static_cast<size_t>(std::distance(timestamps_.begin(), it));
+        return oklab_[index];
     }
 
-private:
-    const std::vector<AudioColourSample>& samples_;
+    RGB interpolatedColour(double targetTime) {
+        if (samples_.empty()) {
+            return RGB{0.0f, 0.0f, 0.0f};
+        }
+
+        const size_t upper = upperIndexFor(targetTime);
+        ColourCore::Lab oklab{};
+        if (upper == 0) {
+            oklab = sampleOklab(0);
+        } else if (upper >= samples_.size()) {
+            oklab = sampleOklab(samples_.size() - 1);
+        } else {
+            const ColourCore::Lab& before = sampleOklab(upper - 1);
+            const ColourCore::Lab& after = sampleOklab(upper);
+            const double gap = timestamps_[upper] - timestamps_[upper - 1];
+            const float t = gap > 0.0
+                ? static_cast<float>(std::clamp((targetTime - timestamps_[upper - 1]) / gap, 0.0, 1.0))
+                : 1.0f;
+            oklab.L = before.L + (after.L - before.L) * t;
+            oklab.a = before.a + (after.a - before.a) * t;
+            oklab.b = before.b + (after.b - before.b) * t;
+        }
+
+        ColourCore::XYZ xyz{};
+        ColourCore::OklabtoXYZ(oklab.L, oklab.a, oklab.b, xyz.X, xyz.Y, xyz.Z);
+        const ColourCore::RGB projected = ColourCore::projectToRGB(
+            xyz, ColourCore::OutputSettings{colourSpace_, gamut_});
+        return RGB{std::clamp(projected.r, 0.0f, 1.0f),
+                   std::clamp(projected.g, 0.0f, 1.0f),
+                   std::clamp(projected.b, 0.0f, 1.0f)};
+    }
+
+    const SpectralSequenceView samples_;
     std::vector<double> timestamps_;
+    std::vector<ColourCore::Lab> oklab_;
+    std::vector<uint8_t> oklabReady_;
     ColourCore::ColourSpace colourSpace_;
     bool gamut_;
     SpringSmoother smoother_;
     double frameInterval_;
     bool initialised_ = false;
     double startTime_ = 0.0;
+    double uniformHop_ = 0.0;  // Zero when the timestamps are not evenly spaced
+    size_t cursor_ = 0;
 };
 
-void paintColourFrame(std::vector<uint16_t>& buffer,
-                      int width,
-                      int height,
-                      RGB colour) {
+RGBWords outputWords(RGB colour) {
     ColourPresentation::applyOutputPrecision(colour.r, colour.g, colour.b);
-    const uint16_t r = toWord(colour.r);
-    const uint16_t g = toWord(colour.g);
-    const uint16_t b = toWord(colour.b);
-    const int lineStride = width * 3;
+    return RGBWords{toWord(colour.r), toWord(colour.g), toWord(colour.b)};
+}
 
-    for (int y = 0; y < height; ++y) {
-        uint16_t* row = buffer.data() + static_cast<size_t>(y) * static_cast<size_t>(lineStride);
-        for (int x = 0; x < width; ++x) {
-            uint16_t* pixel = row + static_cast<size_t>(x) * 3;
-            pixel[0] = r;
-            pixel[1] = g;
-            pixel[2] = b;
+// Paints gradient frames from a growing colour history, oldest colour on the left. The
+// canvas and each column's position along the history are kept between frames, so a frame
+// is one resample of the history prefix and costs O(width) however long the track runs.
+class GradientPainter {
+public:
+    GradientPainter(const std::vector<RGB>& history, size_t width)
+        : history_(history),
+          background_(history.empty() ? RGB{0.0f, 0.0f, 0.0f} : history.front()),
+          positions_(width),
+          columns_(width) {
+        for (size_t x = 0; x < width; ++x) {
+            positions_[x] = width > 1 ? static_cast<float>(x) / static_cast<float>(width - 1) : 0.0f;
         }
     }
+
+    // Columns of the frame showing the first historySize colours.
+    const std::vector<RGBWords>& paint(size_t historySize) {
+        historySize = std::min(historySize, history_.size());
+        if (historySize <= 1) {
+            std::fill(columns_.begin(), columns_.end(),
+                      outputWords(historySize == 1 ? history_[0] : background_));
+            return columns_;
+        }
+
+        const float span = static_cast<float>(historySize - 1);
+        for (size_t x = 0; x < columns_.size(); ++x) {
+            const float historyPos = positions_[x] * span;
+            const size_t idx0 = std::min(static_cast<size_t>(historyPos), historySize - 1);
+            const size_t idx1 = std::min(idx0 + 1, historySize - 1);
+            const float frac = historyPos - static_cast<float>(idx0);
+
+            const RGB& c0 = history_[idx0];
+            const RGB& c1 = history_[idx1];
+            columns_[x] = outputWords(RGB{c0.r * (1.0f - frac) + c1.r * frac,
+                                          c0.g * (1.0f - frac) + c1.g * frac,
+                                          c0.b * (1.0f - frac) + c1.b * frac});
+        }
+        return columns_;
+    }
+
+private:
+    const std::vector<RGB>& history_;
+    RGB background_;
+    std::vector<float> positions_;
+    std::vector<RGBWords> columns_;
+};
+
+// Frames go down the pipe already in the profile's planar 4:2:0 format, converted the same
+// way as the in-process writer, so ffmpeg only has to scale them: 10-bit codes as
+// little-endian words for yuv420p10le, 8-bit codes as bytes for yuv420p.
+struct PipeFormat {
+    MatrixWeights weights;
+    bool tenBit = false;
+};
+
+PipeFormat pipeFormatFor(const ColourCore::ColourSpace colourSpace) {
+    const auto& profile = ColourCore::videoProfileFor(colourSpace);
+    return PipeFormat{matrixWeightsFor(profile.colourSpace),
+                      std::string_view(profile.pixelFormat) == "yuv420p10le"};
 }
 
-void paintGradientFrame(std::vector<uint16_t>& buffer,
-                        int width,
-                        int height,
-                        const std::vector<RGB>& history,
-                        const RGB& backgroundColour) {
-    const int lineStride = width * 3;
-    const bool hasHistory = !history.empty();
-    const size_t historySize = history.size();
-
-    for (int x = 0; x < width; ++x) {
-        RGB colour = backgroundColour;
-
-        if (hasHistory && historySize > 0) {
-            const float t = historySize > 1
-                ? static_cast<float>(x) / static_cast<float>(width - 1)
-                : 0.0f;
-            const float historyPos = t * static_cast<float>(historySize - 1);
-
-            if (historySize == 1) {
-                colour = history[0];
-            } else {
-                const size_t idx0 = std::min(static_cast<size_t>(historyPos), historySize - 1);
-                const size_t idx1 = std::min(idx0 + 1, historySize - 1);
-                const float frac = historyPos - static_cast<float>(idx0);
-
-                const RGB& c0 = history[idx0];
-                const RGB& c1 = history[idx1];
-                colour.r = c0.r * (1.0f - frac) + c1.r * frac;
-                colour.g = c0.g * (1.0f - frac) + c1.g * frac;
-                colour.b = c0.b * (1.0f - frac) + c1.b * frac;
+size_t planarFrameBytes(const PipeFormat& format, int width, int height) {
+    const size_t chromaSamples = static_cast<size_t>((width + 1) / 2) * static_cast<size_t>((height + 1) / 2);
+    const size_t samples = static_cast<size_t>(width) * static_cast<size_t>(height) + 2 * chromaSamples;
+    return samples * (format.tenBit ? 2 : 1);
+}
+
+// Writes a frame of height copies of row; frame must hold planarFrameBytes.
+void packPlanarFrame(const PipeFormat& format, const YCbCrRow& row, int height, std::vector<uint8_t>& frame) {
+    uint8_t* out = frame.data();
+    const auto packPlane = [&](const std::vector<uint16_t>& codes, int rows) {
+        uint8_t* first = out;
+        for (const uint16_t code : codes) {
+            *out++ = static_cast<uint8_t>(code);
+            if (format.tenBit) {
+                *out++ = static_cast<uint8_t>(code >> 8);
             }
         }
+        const size_t rowBytes = static_cast<size_t>(out - first);
+        for (int y = 1; y < rows; ++y) {
+            std::memcpy(out, first, rowBytes);
+            out += rowBytes;
+        }
+    };
+    const int chromaHeight = (height + 1) / 2;
+    packPlane(row.luma, height);
+    packPlane(row.cb, chromaHeight);
+    packPlane(row.cr, chromaHeight);
+}
+
+// Hands painted frames to a thread that writes them to the ffmpeg pipe, so painting the
+// next frame overlaps the blocking fwrite of the last. acquire() blocks while every
+// buffer is still waiting to be written, and returns null once a write has failed.
+class PipeFrameQueue {
+public:
+    PipeFrameQueue(FILE* pipe, size_t frameBytes) : pipe_(pipe) {
+        for (auto& buffer : buffers_) {
+            buffer.assign(frameBytes, 0);
+        }
+        writer_ = std::thread([this] { run(); });
+    }
+
+    ~PipeFrameQueue() {
+        finish();
+    }
+
+    PipeFrameQueue(const PipeFrameQueue&) = delete;
+    PipeFrameQueue& operator=(const PipeFrameQueue&) = delete;
+
+    std::vector<uint8_t>* acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return failed_ || submitted_ - written_ < kQueuedFrames; });
+        return failed_ ? nullptr : &buffers_[submitted_ % kQueuedFrames];
+    }
+
+    void submit() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++submitted_;
+        }
+        changed_.notify_all();
+    }
 
-        ColourPresentation::applyOutputPrecision(colour.r, colour.g, colour.b);
-        const uint16_t r = toWord(colour.r);
-        const uint16_t g = toWord(colour.g);
-        const uint16_t b = toWord(colour.b);
+    // Waits for every submitted frame to be written. False if any write failed.
+    bool finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        changed_.notify_all();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !failed_;
+    }
 
-        for (int y = 0; y < height; ++y) {
-            uint16_t* row = buffer.data() + static_cast<size_t>(y) * static_cast<size_t>(lineStride);
-            uint16_t* pixel = row + static_cast<size_t>(x) * 3;
-            pixel[0] = r;
-            pixel[1] = g;
-            pixel[2] = b;
+private:
+    static constexpr size_t kQueuedFrames = 3;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            changed_.wait(lock, [this] { return closing_ || written_ < submitted_; });
+            if (written_ == submitted_) {
+                return;
+            }
+
+            // The producer never touches a buffer between written_ and submitted_.
+            const std::vector<uint8_t>& frame = buffers_[written_ % kQueuedFrames];
+            lock.unlock();
+            const bool ok = fwrite(frame.data(), 1, frame.size(), pipe_) == frame.size();
+            lock.lock();
+
+            ++written_;
+            if (!ok) {
+                failed_ = true;
+            }
+            changed_.notify_all();
+            if (failed_) {
+                return;
+            }
         }
     }
-}
 
-double computeDuration(const std::vector<AudioColourSample>& samples,
+    FILE* pipe_;
+    std::array<std::vector<uint8_t>, kQueuedFrames> buffers_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    size_t submitted_ = 0;  // Protected by mutex_
+    size_t written_ = 0;  // Protected by mutex_
+    bool closing_ = false;  // Protected by mutex_
+    bool failed_ = false;  // Protected by mutex_
+    std::thread writer_;
+};
+
+double computeDuration(const SpectralSequenceView samples,
                        const AudioMetadata& metadata) {
     if (!samples.empty()) {
         const double lastTimestamp = samples.back().timestamp;
@@ -293,10 +508,15 @@ void appendEncoderParameters(std::ostringstream& stream,
     }
 }
 
+// The piped source is sourceWidth x sourceHeight in the profile's pixel format; when that is
+// smaller than the output it is scaled up with nearest-neighbour, which keeps flat regions
+// bit-exact. An empty audioPath writes a video-only file.
 std::string buildFFmpegCommand(const std::string& ffmpegPath,
                                const fs::path& audioPath,
                                const std::string& outputPath,
                                const fs::path& stderrPath,
+                               int sourceWidth,
+                               int sourceHeight,
                                int width,
                                int height,
                                int fps,
@@ -307,23 +527,33 @@ std::string buildFFmpegCommand(const std::string& ffmpegPath,
     std::ostringstream oss;
     oss << '"' << ffmpegPath << '"'
         << " -y -loglevel error"
-        << " -f rawvideo -pixel_format rgb48le"
-        << " -video_size " << width << 'x' << height
+        << " -f rawvideo -pixel_format " << colourProfile.pixelFormat
+        << " -video_size " << sourceWidth << 'x' << sourceHeight
         << " -framerate " << fps
-        << " -i -"
-        << " -i " << '"' << audioPath.string() << '"'
-        << " -map 0:v:0 -map 1:a:0"
-        << " -vf \"" << colourProfile.filter << '"'
-        << " -c:v " << videoEncoder;
+        << " -i -";
+    if (!audioPath.empty()) {
+        oss << " -i " << '"' << audioPath.string() << '"'
+            << " -map 0:v:0 -map 1:a:0";
+    } else {
+        oss << " -map 0:v:0";
+    }
+    if (sourceWidth != width || sourceHeight != height) {
+        oss << " -vf \"scale=" << width << ':' << height << ":flags=neighbor\"";
+    }
+    oss << " -c:v " << videoEncoder;
 
     appendEncoderParameters(oss, videoEncoder, colourProfile.pixelFormat);
 
     oss << " -color_primaries " << colourProfile.primaries
         << " -color_trc " << colourProfile.transfer
         << " -colorspace " << colourProfile.colourSpace
-        << " -color_range tv"
-        << " -c:a aac -b:a 192k -movflags +faststart -avoid_negative_ts make_zero"
-        << " \"" << outputPath << "\"";
+        << " -color_range tv";
+    if (!audioPath.empty()) {
+        oss << " -c:a aac -b:a 192k -movflags +faststart -avoid_negative_ts make_zero";
+    } else {
+        oss << " -an";
+    }
+    oss << " \"" << outputPath << "\"";
 
 #ifdef _WIN32
     oss << " 2>\"" << stderrPath.string() << "\"";
@@ -334,29 +564,109 @@ std::string buildFFmpegCommand(const std::string& ffmpegPath,
     return oss.str();
 }
 
+// A run of frames for one encoder. Segments after the first sample preRoll frames before
+// first and discard them, so the colour smoother arrives at the segment already settled
+// the same way on every export.
+struct FrameRange {
+    int first = 0;
+    int count = 0;
+    int preRoll = 0;
+};
+
+// Encodes range to outputPath, muxing audioPath unless it is empty, and calls onFrameDone
+// after each frame. May run on any thread, several at once. A renderer that sees the
+// export cancelled closes its ffmpeg and fails with kCancelledMessage.
+using SegmentRenderer = std::function<bool(const FrameRange& range,
+                                           const std::string& outputPath,
+                                           const fs::path& audioPath,
+                                           const fs::path& stderrPath,
+                                           const std::function<void()>& onFrameDone,
+                                           std::string& errorMessage)>;
+
+size_t exportThreadCount() {
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return std::max<size_t>(1, std::min<size_t>(hardwareThreads, 8));
+}
+
+// Tracks shorter than two segments of this length are exported by a single encoder.
+constexpr double kMinSegmentSeconds = 30.0;
+constexpr double kSegmentPreRollSeconds = 2.0;
+
+std::vector<FrameRange> planSegments(int totalFrames, int fps) {
+    const int minSegmentFrames = std::max(1, static_cast<int>(kMinSegmentSeconds * static_cast<double>(fps)));
+    const int segmentCount = static_cast<int>(std::min<size_t>(exportThreadCount(),
+                                                              static_cast<size_t>(std::max(1, totalFrames / minSegmentFrames))));
+    const int preRoll = static_cast<int>(std::ceil(kSegmentPreRollSeconds * static_cast<double>(fps)));
+
+    std::vector<FrameRange> segments;
+    segments.reserve(static_cast<size_t>(segmentCount));
+    for (int i = 0; i < segmentCount; ++i) {
+        FrameRange range;
+        range.first = static_cast<int>(static_cast<int64_t>(totalFrames) * i / segmentCount);
+        range.count = static_cast<int>(static_cast<int64_t>(totalFrames) * (i + 1) / segmentCount) - range.first;
+        range.preRoll = std::min(preRoll, range.first);
+        segments.push_back(range);
+    }
+    return segments;
+}
+
+std::string readStderr(const fs::path& stderrPath) {
+    std::error_code ec;
+    if (!fs::exists(stderrPath, ec) || fs::file_size(stderrPath, ec) == 0) {
+        return {};
+    }
+    std::ifstream stderrFile(stderrPath);
+    std::string line;
+    std::string stderrContent;
+    while (stderrFile.is_open() && std::getline(stderrFile, line) && stderrContent.size() < 500) {
+        if (!stderrContent.empty()) {
+            stderrContent += " | ";
+        }
+        stderrContent += line;
+    }
+    return stderrContent;
+}
+
+bool closeFFmpeg(FILE* pipe, const fs::path& stderrPath, const char* stage, std::string& errorMessage) {
+    const int exitCode = closePipe(pipe);
+    if (exitCode == 0) {
+        return true;
+    }
+    errorMessage = std::string("FFmpeg exited with an error") + stage + " (code " + std::to_string(exitCode) + ")";
+    if (const std::string stderrContent = readStderr(stderrPath); !stderrContent.empty()) {
+        errorMessage += ": " + stderrContent;
+    }
+    return false;
+}
+
+// gradientHistory, when given, must already hold a slot for every frame of the export.
 bool renderVideo(const std::string& ffmpegCommand,
                  const fs::path& stderrPath,
                  int width,
                  int height,
                  int fps,
-                 const std::vector<AudioColourSample>& samples,
+                 const SpectralSequenceView samples,
                  const ExportOptions& options,
-                 const std::function<void(float)>& progress,
+                 const FrameRange& range,
                  double duration,
+                 const std::function<void()>& onFrameDone,
+                 const Utilities::Threading::CancellationToken& cancellation,
                  std::string& errorMessage,
                  std::vector<RGB>* gradientHistory = nullptr) {
-    const int totalFrames = std::max(1, static_cast<int>(std::ceil(duration * static_cast<double>(fps))));
-    const int lineStride = width * 3;
-    std::vector<uint16_t> frame(static_cast<size_t>(lineStride) * static_cast<size_t>(height), 0);
+    const PipeFormat format = pipeFormatFor(options.colourSpace);
+    std::vector<uint8_t> frame(planarFrameBytes(format, width, height), 0);
+    YCbCrRow row;
 
     ColourTimelineSampler sampler(samples,
                                   options.colourSpace,
                                   options.applyGamutMapping,
                                   options.smoothingAmount,
                                   1.0 / static_cast<double>(fps));
-
-    if (gradientHistory) {
-        gradientHistory->reserve(static_cast<size_t>(totalFrames));
+    const auto frameTime = [&](const int frameIndex) {
+        return std::min(duration, static_cast<double>(frameIndex) / static_cast<double>(fps));
+    };
+    for (int frameIndex = range.first - range.preRoll; frameIndex < range.first; ++frameIndex) {
+        sampler.colourAt(frameTime(frameIndex));
     }
 
     FILE* pipe = openPipe(ffmpegCommand);
@@ -369,22 +679,22 @@ bool renderVideo(const std::string& ffmpegCommand,
     std::vector<char> pipeBuffer(kPipeBufferSize);
     setvbuf(pipe, pipeBuffer.data(), _IOFBF, kPipeBufferSize);
 
-    const float renderStart = 0.15f;
-    const float renderSpan = gradientHistory ? 0.35f : 0.75f;
-
-    for (int frameIndex = 0; frameIndex < totalFrames; ++frameIndex) {
-        const double time = std::min(duration, static_cast<double>(frameIndex) / static_cast<double>(fps));
-        const RGB colour = sampler.colourAt(time);
+    for (int frameIndex = range.first; frameIndex < range.first + range.count; ++frameIndex) {
+        if (cancellation.isCancelled()) {
+            errorMessage = kCancelledMessage;
+            closePipe(pipe);
+            return false;
+        }
+        const RGB colour = sampler.colourAt(frameTime(frameIndex));
 
         if (gradientHistory) {
-            gradientHistory->push_back(colour);
+            (*gradientHistory)[static_cast<size_t>(frameIndex)] = colour;
         }
 
-        paintColourFrame(frame, width, height, colour);
+        convertRow({outputWords(colour)}, static_cast<size_t>(width), format.weights, format.tenBit, row);
+        packPlanarFrame(format, row, height, frame);
 
-        const size_t frameBytes = frame.size() * sizeof(uint16_t);
-        const size_t bytesWritten = fwrite(frame.data(), 1, frameBytes, pipe);
-        if (bytesWritten != frameBytes) {
+        if (fwrite(frame.data(), 1, frame.size(), pipe) != frame.size()) {
             errorMessage = "Failed to stream video frame to FFmpeg";
             closePipe(pipe);
             return false;
@@ -397,39 +707,184 @@ bool renderVideo(const std::string& ffmpegCommand,
         }
 #endif
 
-        if (progress) {
-            const float fraction = static_cast<float>(frameIndex + 1) / static_cast<float>(totalFrames);
-            progress(renderStart + renderSpan * fraction);
+        if (onFrameDone) {
+            onFrameDone();
         }
     }
 
     fflush(pipe);
+    return closeFFmpeg(pipe, stderrPath, "", errorMessage);
+}
 
-    const int exitCode = closePipe(pipe);
-    if (exitCode != 0) {
-        errorMessage = "FFmpeg exited with an error (code " + std::to_string(exitCode) + ")";
+// Gradient frames depend only on the history, so segments need no pre-roll.
+bool renderGradient(const std::string& ffmpegCommand,
+                    const fs::path& stderrPath,
+                    int width,
+                    const ColourCore::ColourSpace colourSpace,
+                    const std::vector<RGB>& history,
+                    const FrameRange& range,
+                    const std::function<void()>& onFrameDone,
+                    const Utilities::Threading::CancellationToken& cancellation,
+                    std::string& errorMessage) {
+    const PipeFormat format = pipeFormatFor(colourSpace);
+    const size_t frameBytes = planarFrameBytes(format, width, kGradientSourceHeight);
 
-        std::error_code ec;
-        if (fs::exists(stderrPath, ec) && fs::file_size(stderrPath, ec) > 0) {
-            std::ifstream stderrFile(stderrPath);
-            if (stderrFile.is_open()) {
-                std::string line;
-                std::string stderrContent;
-                while (std::getline(stderrFile, line) && stderrContent.size() < 500) {
-                    if (!stderrContent.empty()) {
-                        stderrContent += " | ";
-                    }
-                    stderrContent += line;
-                }
-                if (!stderrContent.empty()) {
-                    errorMessage += ": " + stderrContent;
-                }
+    FILE* pipe = openPipe(ffmpegCommand);
+    if (!pipe) {
+        errorMessage = "Unable to start FFmpeg for gradient export";
+        return false;
+    }
+
+    constexpr size_t kPipeBufferSize = 8 * 1024 * 1024;
+    std::vector<char> pipeBuffer(kPipeBufferSize);
+    setvbuf(pipe, pipeBuffer.data(), _IOFBF, kPipeBufferSize);
+
+    GradientPainter painter(history, static_cast<size_t>(width));
+    bool streamed = true;
+    {
+        PipeFrameQueue queue(pipe, frameBytes);
+        YCbCrRow row;
+
+        for (int frameIndex = range.first; frameIndex < range.first + range.count; ++frameIndex) {
+            if (cancellation.isCancelled()) {
+                break;
+            }
+            std::vector<uint8_t>* frame = queue.acquire();
+            if (!frame) {
+                break;
+            }
+            convertRow(painter.paint(static_cast<size_t>(frameIndex) + 1), static_cast<size_t>(width),
+                       format.weights, format.tenBit, row);
+            packPlanarFrame(format, row, kGradientSourceHeight, *frame);
+            queue.submit();
+
+            if (onFrameDone) {
+                onFrameDone();
             }
         }
+
+        streamed = queue.finish();
+    }
+    if (cancellation.isCancelled()) {
+        errorMessage = kCancelledMessage;
+        closePipe(pipe);
+        return false;
+    }
+    if (!streamed) {
+        errorMessage = "Failed to stream gradient frame to FFmpeg";
+        closePipe(pipe);
         return false;
     }
 
-    return true;
+    return closeFFmpeg(pipe, stderrPath, " during gradient export", errorMessage);
+}
+
+// Joins video-only segments without re-encoding and muxes the audio in alongside.
+bool concatSegments(const std::string& ffmpegPath,
+                    const std::vector<TempFile>& segments,
+                    const fs::path& listPath,
+                    const fs::path& audioPath,
+                    const std::string& outputPath,
+                    const fs::path& stderrPath,
+                    std::string& errorMessage) {
+    {
+        std::ofstream list(listPath);
+        for (const TempFile& segment : segments) {
+            std::string path = segment.path.string();
+            for (size_t quote = path.find('\''); quote != std::string::npos; quote = path.find('\'', quote + 4)) {
+                path.replace(quote, 1, "'\\''");
+            }
+            list << "file '" << path << "'\n";
+        }
+        if (!list) {
+            errorMessage = "Unable to write the video segment list";
+            return false;
+        }
+    }
+
+    std::ostringstream oss;
+    oss << '"' << ffmpegPath << '"'
+        << " -y -loglevel error -nostdin"
+        << " -f concat -safe 0 -i \"" << listPath.string() << '"'
+        << " -i \"" << audioPath.string() << '"'
+        << " -map 0:v:0 -map 1:a:0 -c:v copy"
+        << " -c:a aac -b:a 192k -movflags +faststart -avoid_negative_ts make_zero"
+        << " \"" << outputPath << "\""
+        << " 2>\"" << stderrPath.string() << "\"";
+
+    FILE* pipe = openPipe(oss.str());
+    if (!pipe) {
+        errorMessage = "Unable to start FFmpeg";
+        return false;
+    }
+    return closeFFmpeg(pipe, stderrPath, " while joining video segments", errorMessage);
+}
+
+// Encodes totalFrames to outputPath through render. Long tracks are split into one segment
+// per core, each with its own ffmpeg, and the segments are then joined losslessly.
+bool encodeTimeline(const std::string& ffmpegPath,
+                    const fs::path& audioPath,
+                    const std::string& outputPath,
+                    const std::string& tempPrefix,
+                    int totalFrames,
+                    int fps,
+                    const SegmentRenderer& render,
+                    const std::function<void(float)>& progress,
+                    float progressStart,
+                    float progressSpan,
+                    const Utilities::Threading::CancellationToken& cancellation,
+                    std::string& errorMessage) {
+    std::mutex progressMutex;
+    int framesDone = 0;  // Protected by progressMutex
+    const auto onFrameDone = [&]() {
+        if (!progress) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(progressMutex);
+        ++framesDone;
+        progress(progressStart + progressSpan * static_cast<float>(framesDone) / static_cast<float>(totalFrames));
+    };
+
+    const fs::path tempRoot = fs::temp_directory_path();
+    TempFile stderrTemp;
+    stderrTemp.path = tempRoot / (tempPrefix + "_stderr.txt");
+
+    const std::vector<FrameRange> segments = planSegments(totalFrames, fps);
+    if (segments.size() <= 1) {
+        return render(FrameRange{0, totalFrames, 0}, outputPath, audioPath, stderrTemp.path, onFrameDone, errorMessage);
+    }
+
+    std::vector<TempFile> segmentFiles(segments.size());
+    std::vector<TempFile> segmentStderr(segments.size());
+    std::vector<std::string> segmentErrors(segments.size());
+    std::vector<char> segmentOk(segments.size(), 0);
+    std::vector<std::thread> workers;
+    workers.reserve(segments.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        segmentFiles[i].path = tempRoot / (tempPrefix + "_segment_" + std::to_string(i) + ".mp4");
+        segmentStderr[i].path = tempRoot / (tempPrefix + "_segment_" + std::to_string(i) + "_stderr.txt");
+        workers.emplace_back([&, i]() {
+            segmentOk[i] = render(segments[i], segmentFiles[i].path.string(), fs::path(),
+                                  segmentStderr[i].path, onFrameDone, segmentErrors[i]) ? 1 : 0;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (cancellation.isCancelled()) {
+        errorMessage = kCancelledMessage;
+        return false;
+    }
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (!segmentOk[i]) {
+            errorMessage = segmentErrors[i];
+            return false;
+        }
+    }
+
+    TempFile listTemp;
+    listTemp.path = tempRoot / (tempPrefix + "_segments.txt");
+    return concatSegments(ffmpegPath, segmentFiles, listTemp.path, audioPath, outputPath, stderrTemp.path, errorMessage);
 }
 
 std::string getGradientFilename(const std::string& originalPath) {
@@ -442,20 +897,125 @@ std::string getGradientFilename(const std::string& originalPath) {
     return gradientPath.string();
 }
 
+// RESYNE_VIDEO_BACKEND=pipe keeps exports on the ffmpeg executable even when in-process
+// encoding is built in.
+bool pipeBackendForced() {
+    const char* backend = std::getenv("RESYNE_VIDEO_BACKEND");
+    return backend && std::string(backend) == "pipe";
+}
+
+// Encodes the solid video and, if requested, the gradient video through LibavMP4Writer.
+// Each frame is sampled once; the gradient reuses the solid pass's colours.
+bool exportInProcess(const std::string& outputPath,
+                     const fs::path& audioPath,
+                     int width,
+                     int height,
+                     int fps,
+                     const SpectralSequenceView samples,
+                     const ExportOptions& options,
+                     const std::function<void(float)>& progress,
+                     double duration,
+                     const Utilities::Threading::CancellationToken& cancellation,
+                     std::string& errorMessage) {
+    const int totalFrames = std::max(1, static_cast<int>(std::ceil(duration * static_cast<double>(fps))));
+
+    ColourTimelineSampler sampler(samples,
+                                  options.colourSpace,
+                                  options.applyGamutMapping,
+                                  options.smoothingAmount,
+                                  1.0 / static_cast<double>(fps));
+
+    std::vector<RGB> history;
+    if (options.exportGradient) {
+        history.reserve(static_cast<size_t>(totalFrames));
+    }
+
+    LibavMP4Writer writer;
+    if (!writer.open(outputPath, audioPath.string(), width, height, fps, options.colourSpace, errorMessage)) {
+        return false;
+    }
+
+    const float renderStart = 0.15f;
+    const float renderSpan = options.exportGradient ? 0.35f : 0.75f;
+    std::vector<RGBWords> columns(1);
+
+    for (int frameIndex = 0; frameIndex < totalFrames; ++frameIndex) {
+        if (cancellation.isCancelled()) {
+            errorMessage = kCancelledMessage;
+            return false;
+        }
+        const double time = std::min(duration, static_cast<double>(frameIndex) / static_cast<double>(fps));
+        const RGB colour = sampler.colourAt(time);
+        if (options.exportGradient) {
+            history.push_back(colour);
+        }
+
+        columns[0] = outputWords(colour);
+        if (!writer.writeFrame(columns, errorMessage)) {
+            return false;
+        }
+
+        if (progress) {
+            const float fraction = static_cast<float>(frameIndex + 1) / static_cast<float>(totalFrames);
+            progress(renderStart + renderSpan * fraction);
+        }
+    }
+
+    if (!writer.finish(errorMessage)) {
+        return false;
+    }
+    if (!options.exportGradient || history.empty()) {
+        return true;
+    }
+
+    LibavMP4Writer gradientWriter;
+    if (!gradientWriter.open(getGradientFilename(outputPath),
+                             audioPath.string(),
+                             width,
+                             height,
+                             fps,
+                             options.colourSpace,
+                             errorMessage)) {
+        return false;
+    }
+
+    GradientPainter painter(history, static_cast<size_t>(width));
+    const size_t gradientFrames = history.size();
+
+    for (size_t frameIndex = 0; frameIndex < gradientFrames; ++frameIndex) {
+        if (cancellation.isCancelled()) {
+            errorMessage = kCancelledMessage;
+            return false;
+        }
+        if (!gradientWriter.writeFrame(painter.paint(frameIndex + 1), errorMessage)) {
+            return false;
+        }
+
+        if (progress) {
+            const float fraction = static_cast<float>(frameIndex + 1) / static_cast<float>(gradientFrames);
+            progress(0.5f + 0.4f * fraction);
+        }
+    }
+
+    return gradientWriter.finish(errorMessage);
+}
+
 }
 
 
 bool exportToMP4(const std::string& outputPath,
-                 const std::vector<AudioColourSample>& samples,
+                 const SpectralSequenceView samples,
                  const AudioMetadata& metadata,
                  const ExportOptions& options,
                  const std::function<void(float)>& progress,
-                 std::string& errorMessage) {
+                 std::string& errorMessage,
+                 const Utilities::Threading::CancellationToken& cancellation) {
     if (samples.empty()) {
         errorMessage = "No samples available for video export";
         return false;
     }
-    if (options.ffmpegExecutable.empty()) {
+    const bool inProcess = LibavMP4Writer::isAvailable() && !pipeBackendForced();
+    if (!inProcess && options.ffmpegExecutable.empty()) {
         errorMessage = "FFmpeg executable path is empty";
         return false;
     }
@@ -487,101 +1047,138 @@ bool exportToMP4(const std::string& outputPath,
 
     TempFile audioTemp;
     const auto timestamp = std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-    audioTemp.path = fs::temp_directory_path() / ("resyne_video_export_" + timestamp + ".wav");
+    fs::path audioPath = options.preparedAudioPath;
+    if (audioPath.empty()) {
+        audioTemp.path = fs::temp_directory_path() / ("resyne_video_export_" + timestamp + ".wav");
+        audioPath = audioTemp.path;
+        if (!SequenceExporter::exportToWAV(audioTemp.path.string(), samples, metadata, [&](float p) {
+                if (progress) {
+                    progress(0.02f + 0.13f * p);
+                }
+            }, cancellation)) {
+            errorMessage = cancellation.isCancelled() ? kCancelledMessage : "Failed to reconstruct audio for video export";
+            return false;
+        }
+    }
 
-    TempFile stderrTemp;
-    stderrTemp.path = fs::temp_directory_path() / ("resyne_video_export_stderr_" + timestamp + ".txt");
+    // Whatever an encoder left behind is incomplete and would not play.
+    const auto discardOutputs = [&]() {
+        std::error_code ec;
+        fs::remove(outputPath, ec);
+        if (options.exportGradient) {
+            fs::remove(getGradientFilename(outputPath), ec);
+        }
+    };
+
+    const double duration = computeDuration(samples, metadata);
 
-    if (!SequenceExporter::exportToWAV(audioTemp.path.string(), samples, metadata, [&](float p) {
+    if (inProcess) {
+        if (exportInProcess(outputPath, audioPath, width, height, fps, samples, options,
+                            progress, duration, cancellation, errorMessage)) {
             if (progress) {
-                progress(0.02f + 0.13f * p);
+                progress(1.0f);
             }
-        })) {
-        errorMessage = "Failed to reconstruct audio for video export";
-        return false;
+            return true;
+        }
+        if (cancellation.isCancelled()) {
+            discardOutputs();
+            return false;
+        }
+        // An encoder the build lacks or the driver refuses can still be there in ffmpeg.
+        if (options.ffmpegExecutable.empty()) {
+            return false;
+        }
+        errorMessage.clear();
     }
 
-    const double duration = computeDuration(samples, metadata);
-
-    const std::string command = buildFFmpegCommand(options.ffmpegExecutable,
-                                                   audioTemp.path,
-                                                   outputPath,
-                                                   stderrTemp.path,
-                                                   width,
-                                                   height,
-                                                   fps,
-                                                   options.colourSpace);
-
-    std::vector<RGB> gradientHistory;
-    const bool success = renderVideo(command,
-                                     stderrTemp.path,
-                                     width,
-                                     height,
-                                     fps,
-                                     samples,
-                                     options,
-                                     progress,
-                                     duration,
-                                     errorMessage,
-                                     options.exportGradient ? &gradientHistory : nullptr);
-
-    if (!success) {
+    const int totalFrames = std::max(1, static_cast<int>(std::ceil(duration * static_cast<double>(fps))));
+    std::vector<RGB> gradientHistory(options.exportGradient ? static_cast<size_t>(totalFrames) : 0);
+
+    const SegmentRenderer renderSolid = [&](const FrameRange& range,
+                                            const std::string& segmentPath,
+                                            const fs::path& segmentAudio,
+                                            const fs::path& stderrPath,
+                                            const std::function<void()>& onFrameDone,
+                                            std::string& segmentError) {
+        const std::string command = buildFFmpegCommand(options.ffmpegExecutable,
+                                                       segmentAudio,
+                                                       segmentPath,
+                                                       stderrPath,
+                                                       kSolidSourceSize,
+                                                       kSolidSourceSize,
+                                                       width,
+                                                       height,
+                                                       fps,
+                                                       options.colourSpace);
+        return renderVideo(command,
+                           stderrPath,
+                           kSolidSourceSize,
+                           kSolidSourceSize,
+                           fps,
+                           samples,
+                           options,
+                           range,
+                           duration,
+                           onFrameDone,
+                           cancellation,
+                           segmentError,
+                           options.exportGradient ? &gradientHistory : nullptr);
+    };
+
+    if (!encodeTimeline(options.ffmpegExecutable,
+                        audioPath,
+                        outputPath,
+                        "resyne_video_export_" + timestamp,
+                        totalFrames,
+                        fps,
+                        renderSolid,
+                        progress,
+                        0.15f,
+                        options.exportGradient ? 0.35f : 0.75f,
+                        cancellation,
+                        errorMessage)) {
+        if (cancellation.isCancelled()) {
+            discardOutputs();
+        }
         return false;
     }
 
-    if (options.exportGradient && !gradientHistory.empty()) {
-        const std::string gradientOutputPath = getGradientFilename(outputPath);
-
-        TempFile gradientStderrTemp;
-        gradientStderrTemp.path = fs::temp_directory_path() / ("resyne_gradient_export_stderr_" + timestamp + ".txt");
-
-        const std::string gradientCommand = buildFFmpegCommand(options.ffmpegExecutable,
-                                                               audioTemp.path,
-                                                               gradientOutputPath,
-                                                               gradientStderrTemp.path,
-                                                               width,
-                                                               height,
-                                                               fps,
-                                                               options.colourSpace);
-
-        const int totalFrames = static_cast<int>(gradientHistory.size());
-        const int lineStride = width * 3;
-        std::vector<uint16_t> frame(static_cast<size_t>(lineStride) * static_cast<size_t>(height), 0);
-
-        FILE* pipe = openPipe(gradientCommand);
-        if (!pipe) {
-            errorMessage = "Unable to start FFmpeg for gradient export";
-            return false;
-        }
-
-        constexpr size_t kPipeBufferSize = 8 * 1024 * 1024;
-        std::vector<char> pipeBuffer(kPipeBufferSize);
-        setvbuf(pipe, pipeBuffer.data(), _IOFBF, kPipeBufferSize);
-
-        RGB backgroundColour = gradientHistory.empty() ? RGB{0.0f, 0.0f, 0.0f} : gradientHistory.front();
-
-        for (int frameIndex = 0; frameIndex < totalFrames; ++frameIndex) {
-            std::vector<RGB> currentHistory(gradientHistory.begin(),
-                                          gradientHistory.begin() + frameIndex + 1);
-
-            paintGradientFrame(frame, width, height, currentHistory, backgroundColour);
-
-            const size_t frameBytes = frame.size() * sizeof(uint16_t);
-            if (fwrite(frame.data(), 1, frameBytes, pipe) != frameBytes) {
-                errorMessage = "Failed to stream gradient frame to FFmpeg";
-                closePipe(pipe);
-                return false;
+    if (options.exportGradient) {
+        const SegmentRenderer renderGradientSegment = [&](const FrameRange& range,
+                                                          const std::string& segmentPath,
+                                                          const fs::path& segmentAudio,
+                                                          const fs::path& stderrPath,
+                                                          const std::function<void()>& onFrameDone,
+                                                          std::string& segmentError) {
+            const std::string command = buildFFmpegCommand(options.ffmpegExecutable,
+                                                           segmentAudio,
+                                                           segmentPath,
+                                                           stderrPath,
+                                                           width,
+                                                           kGradientSourceHeight,
+                                                           width,
+                                                           height,
+                                                           fps,
+                                                           options.colourSpace);
+            return renderGradient(command, stderrPath, width, options.colourSpace, gradientHistory, range,
+                                  onFrameDone, cancellation, segmentError);
+        };
+
+        if (!encodeTimeline(options.ffmpegExecutable,
+                            audioPath,
+                            getGradientFilename(outputPath),
+                            "resyne_gradient_export_" + timestamp,
+                            totalFrames,
+                            fps,
+                            renderGradientSegment,
+                            progress,
+                            0.5f,
+                            0.4f,
+                            cancellation,
+                            errorMessage)) {
+            if (cancellation.isCancelled()) {
+                discardOutputs();
             }
-
-            if (progress) {
-                const float fraction = static_cast<float>(frameIndex + 1) / static_cast<float>(totalFrames);
-                progress(0.5f + 0.4f * fraction);
-            }
-        }
-
-        const int exitCode = closePipe(pipe);
-        if (exitCode != 0) {
-            errorMessage = "FFmpeg exited with an error during gradient export (code " + std::to_string(exitCode) + ")";
             return false;
         }
     }
@@ -18,13 +18,19 @@ struct ExportOptions {
     int height = 1080;
     int frameRate = 60;
     bool exportGradient = false;
+    // A WAV of the reconstructed audio to mux, when the caller already wrote one; otherwise
+    // the export reconstructs it into a temporary file.
+    std::string preparedAudioPath;
 };
 
+// Once cancellation is set the encoders are closed, the partial video files removed and
+// the export fails with "Export cancelled".
 bool exportToMP4(const std::string& outputPath,
-                 const std::vector<AudioColourSample>& samples,
+                 SpectralSequenceView samples,
                  const AudioMetadata& metadata,
                  const ExportOptions& options,
                  const std::function<void(float)>& progress,
-                 std::string& errorMessage);
+                 std::string& errorMessage,
+                 const Utilities::Threading::CancellationToken& cancellation = {});
 
 }
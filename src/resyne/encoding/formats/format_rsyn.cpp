@@ -1,12 +1,23 @@
 #include "resyne/encoding/formats/format_rsyn.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 #include "resyne/encoding/formats/rsyn_container.h"
 #include "resyne/encoding/formats/rsyn_presentation.h"
 #include "resyne/encoding/formats/rsyn_serialisation.h"
+#include "resyne/encoding/formats/spectral_sequence.h"
 
 namespace {
 
@@ -14,6 +25,9 @@ constexpr std::uint32_t kMetaTag = RSYNContainer::makeTag("META");
 constexpr std::uint32_t kSourceTag = RSYNContainer::makeTag("SRCE");
 constexpr std::uint32_t kSpectralTag = RSYNContainer::makeTag("SPEC");
 constexpr std::uint32_t kPresentationTag = RSYNContainer::makeTag("PRES");
+constexpr std::uint32_t kFrequencyAxisTag = RSYNContainer::makeTag("FAXS");
+constexpr std::uint32_t kPreviewTag = RSYNContainer::makeTag("PREV");
+constexpr std::uint32_t kPeakTrackTag = RSYNContainer::makeTag("PEAK");
 
 void emitProgress(const std::function<void(float)>& progress, const float value) {
     if (!progress) {
@@ -22,6 +36,19 @@ void emitProgress(const std::function<void(float)>& progress, const float value)
     progress(std::clamp(value, 0.0f, 1.0f));
 }
 
+// Sources in these codecs are already compressed, so deflating them again only costs time.
+RSYNContainer::Compression sourceCompressionFor(std::string extension) {
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    for (const char* compressed : {".flac", ".mp3", ".mpeg3", ".mpga", ".ogg", ".oga"}) {
+        if (extension == compressed) {
+            return RSYNContainer::Compression::None;
+        }
+    }
+    return RSYNContainer::Compression::Deflate;
+}
+
 bool readRequiredLocator(const AudioMetadata& metadata,
                          const std::uint32_t tag,
                          RSYNContainer::ChunkLocator& locator) {
@@ -38,7 +65,86 @@ bool readRequiredLocator(const AudioMetadata& metadata,
     return true;
 }
 
-AudioMetadata prepareMetadata(const std::vector<AudioColourSample>& samples,
+// Maps the asset's file for one read; the mapping is dropped again afterwards so the file
+// can be overwritten by a save, which an open mapping would block on Windows.
+bool openAssetView(const AudioMetadata& metadata, RSYNContainer::MappedView& view) {
+    return metadata.lazyAsset != nullptr && view.open(metadata.lazyAsset->filepath);
+}
+
+bool readSharedFrequencies(const AudioMetadata& metadata,
+                           const RSYNContainer::MappedView& view,
+                           std::vector<float>& sharedFrequencies) {
+    sharedFrequencies.clear();
+    RSYNContainer::ChunkLocator frequencyAxisLocator{};
+    if (!readRequiredLocator(metadata, kFrequencyAxisTag, frequencyAxisLocator)) {
+        return true;
+    }
+
+    std::vector<std::uint8_t> scratch;
+    std::span<const std::uint8_t> frequencyAxisBytes;
+    return view.access(frequencyAxisLocator, scratch, frequencyAxisBytes) &&
+        RSYNSerialisation::decodeFrequencyAxis(frequencyAxisBytes, sharedFrequencies);
+}
+
+// Blocks inflated per batch: enough to keep every worker busy while previews still
+// arrive steadily and only one batch of payloads is resident.
+constexpr std::size_t kHydrateBatchBlocks = 32;
+// Spectral blocks encoded and handed to the writer per batch on export.
+constexpr std::size_t kExportBatchBlocks = 32;
+
+// Every block but the last holds exactly blockFrames frames, which is what makes a frame
+// index map straight onto a block.
+bool decodeSpectralBlock(const AudioMetadata& metadata,
+                         const RSYNContainer::ChunkLocator& spectralLocator,
+                         const std::size_t blockIndex,
+                         std::span<const std::uint8_t> blockPayload,
+                         std::span<const float> sharedFrequencies,
+                         SpectralSequence& samples,
+                         const std::size_t firstFrame) {
+    const std::size_t blockFrames = metadata.lazyAsset->spectralBlockFrames;
+    std::size_t frameCount = 0;
+    if (!RSYNSerialisation::decodeSampleBlock(blockPayload, samples, firstFrame, sharedFrequencies,
+                                              metadata.lazyAsset->spectralEncoding, frameCount)) {
+        return false;
+    }
+
+    const bool lastBlock = blockIndex + 1 == spectralLocator.blocks.size();
+    return lastBlock ? (frameCount > 0 && frameCount <= blockFrames) : frameCount == blockFrames;
+}
+
+bool hasSpectralBlocks(const AudioMetadata& metadata, const RSYNContainer::ChunkLocator& spectralLocator) {
+    return !spectralLocator.blocks.empty() && metadata.lazyAsset->spectralBlockFrames > 0;
+}
+
+// Tracks the first channel, on the frame's own frequency axis when it carries one.
+PhaseReconstruction::PeakTrackSequence buildPeakTracks(const SpectralSequenceView samples,
+                                                       const AudioMetadata& metadata,
+                                                       std::span<const float> sharedFrequencies,
+                                                       const std::size_t peakCount) {
+    PhaseReconstruction::PeakTrackSequence tracks;
+    tracks.frameStarts.reserve(samples.size() + 1);
+    tracks.peaks.reserve(samples.size() * peakCount);
+    PhaseReconstruction::PeakTracker tracker(peakCount);
+    std::vector<PhaseReconstruction::TrackedPeak> framePeaks;
+    for (const SpectralFrame sample : samples) {
+        framePeaks.clear();
+        if (!sample.magnitudes.empty()) {
+            const std::span<const float> magnitudes = sample.magnitudes.front();
+            const std::span<const float> phases = sample.phases.empty() ? std::span<const float>() : sample.phases.front();
+            const std::span<const float> frequencies = !sample.frequencies.empty() && !sample.frequencies.front().empty()
+                ? sample.frequencies.front()
+                : sharedFrequencies;
+            const int fftSize = metadata.fftSize > 0 ? metadata.fftSize
+                                                     : static_cast<int>(magnitudes.size() > 1 ? (magnitudes.size() - 1) * 2 : 1);
+            const float sampleRate = sample.sampleRate > 0.0f ? sample.sampleRate : metadata.sampleRate;
+            tracker.track(magnitudes, phases, sampleRate / static_cast<float>(fftSize), framePeaks, frequencies);
+        }
+        tracks.append(framePeaks);
+    }
+    return tracks;
+}
+
+AudioMetadata prepareMetadata(const SpectralSequenceView samples,
                               AudioMetadata metadata,
                               const std::shared_ptr<RSYNPresentationData>& presentationData) {
     metadata.numFrames = samples.size();
@@ -57,10 +163,11 @@ AudioMetadata prepareMetadata(const std::vector<AudioColourSample>& samples,
 namespace SequenceExporterInternal {
 
 bool exportToRsyn(const std::string& filepath,
-                  const std::vector<AudioColourSample>& samples,
+                  const SpectralSequenceView samples,
                   const AudioMetadata& metadata,
                   const RSYNExportOptions& options,
-                  const std::function<void(float)>& progress) {
+                  const std::function<void(float)>& progress,
+                  const Utilities::Threading::CancellationToken& cancellation) {
     if (samples.empty()) {
         emitProgress(progress, 1.0f);
         return false;
@@ -74,42 +181,107 @@ bool exportToRsyn(const std::string& filepath,
         [&](const float value) {
             emitProgress(progress, 0.02f + value * 0.28f);
         });
+    if (cancellation.isCancelled()) {
+        emitProgress(progress, 1.0f);
+        return false;
+    }
     const AudioMetadata exportedMetadata = prepareMetadata(samples, metadata, presentationData);
 
     std::vector<std::uint8_t> metaPayload;
     std::vector<std::uint8_t> sourcePayload;
-    std::vector<std::uint8_t> spectralPayload;
     std::vector<std::uint8_t> presentationPayload;
-    if (!RSYNSerialisation::encodeMetadata(exportedMetadata, metaPayload) ||
-        !RSYNSerialisation::encodeSourceBytes(exportedMetadata.sourceData, sourcePayload) ||
-        !RSYNSerialisation::encodeSamples(samples, spectralPayload) ||
-        !RSYNSerialisation::encodePresentationFrames(exportedMetadata.presentationData, presentationPayload)) {
+    std::vector<std::uint8_t> frequencyAxisPayload;
+    RSYNSpectralEncoding spectralEncoding = RSYNSpectralEncoding::Float32;
+    if (options.spectralCodec == RSYNSpectralCodec::NearLossless) {
+        spectralEncoding = RSYNSpectralEncoding::Quantised16;
+    } else if (options.spectralCodec == RSYNSpectralCodec::Half) {
+        spectralEncoding = RSYNSpectralEncoding::Half16;
+    }
+    const RSYNContainer::Compression spectralCompression = options.spectralCodec == RSYNSpectralCodec::Deflate
+        ? RSYNContainer::Compression::Deflate
+        : RSYNContainer::Compression::ShuffledDeflate;
+    const double phaseAdvancePerBin = exportedMetadata.fftSize > 0
+        ? 2.0 * std::numbers::pi * static_cast<double>(exportedMetadata.hopSize) / static_cast<double>(exportedMetadata.fftSize)
+        : 0.0;
+
+    const std::vector<float> sharedFrequencies = SpectralSequence::detectSharedFrequencies(samples);
+    if (!RSYNSerialisation::encodeMetadata(exportedMetadata, metaPayload, spectralEncoding) ||
+        !RSYNSerialisation::encodeFrequencyAxis(sharedFrequencies, frequencyAxisPayload)) {
         emitProgress(progress, 1.0f);
         return false;
     }
 
-    emitProgress(progress, 0.72f);
+    // Each chunk is written as soon as it is encoded, and the spectra a batch of blocks at a
+    // time, so the serialised project never sits in memory whole beside the live samples.
+    // Saving over an existing container appends only the chunks and blocks that changed, so
+    // a settings tweak rewrites PRES and its preview rather than the spectra and source.
+    RSYNContainer::ContainerWriter writer;
+    std::error_code existsError;
+    const bool reopened = std::filesystem::is_regular_file(filepath, existsError) && writer.openForAppend(filepath);
+    bool ok = (reopened || writer.open(filepath)) &&
+        writer.addChunk({kMetaTag, std::move(metaPayload), {}}) &&
+        writer.beginBlocks(kSpectralTag, spectralCompression);
+
+    const std::size_t batchFrames = static_cast<std::size_t>(RSYNSerialisation::kSpectralBlockFrames) * kExportBatchBlocks;
+    const SpectralSequenceView frames = samples;
+    std::vector<std::vector<std::uint8_t>> spectralBlocks;
+    for (std::size_t first = 0; ok && first < frames.size() && !cancellation.isCancelled(); first += batchFrames) {
+        ok = RSYNSerialisation::encodeSampleBlocks(frames.subspan(first, std::min(batchFrames, frames.size() - first)),
+                                                   sharedFrequencies, RSYNSerialisation::kSpectralBlockFrames,
+                                                   spectralEncoding, phaseAdvancePerBin, spectralBlocks) &&
+            writer.addBlocks(spectralBlocks);
+        emitProgress(progress, 0.3f + static_cast<float>(std::min(first + batchFrames, frames.size())) / static_cast<float>(frames.size()) * 0.6f);
+    }
+    std::vector<std::vector<std::uint8_t>>().swap(spectralBlocks);
+    if (cancellation.isCancelled()) {
+        writer.discard();
+        emitProgress(progress, 1.0f);
+        return false;
+    }
 
-    std::vector<RSYNContainer::Chunk> chunks;
-    chunks.push_back({kMetaTag, std::move(metaPayload)});
-    chunks.push_back({kSpectralTag, std::move(spectralPayload)});
-    chunks.push_back({kPresentationTag, std::move(presentationPayload)});
-    if (!sourcePayload.empty()) {
-        chunks.push_back({kSourceTag, std::move(sourcePayload)});
+    ok = ok && writer.endBlocks() &&
+        RSYNSerialisation::encodePresentationFrames(exportedMetadata.presentationData, presentationPayload) &&
+        writer.addChunk({kPresentationTag, std::move(presentationPayload), {}});
+    if (ok && !sharedFrequencies.empty()) {
+        ok = writer.addChunk({kFrequencyAxisTag, std::move(frequencyAxisPayload), {}});
+    }
+    if (ok && options.peakTrackCount > 0) {
+        std::vector<std::uint8_t> peakPayload;
+        ok = RSYNSerialisation::encodePeakTracks(
+                 buildPeakTracks(samples, exportedMetadata, sharedFrequencies, options.peakTrackCount), peakPayload) &&
+            writer.addChunk({kPeakTrackTag, std::move(peakPayload), {}});
+    }
+    if (ok) {
+        std::vector<std::uint8_t> previewPayload;
+        const auto preview = RSYNPresentation::buildPreviewData(*exportedMetadata.presentationData);
+        if (preview != nullptr && RSYNSerialisation::encodePreview(*preview, previewPayload)) {
+            ok = writer.addChunk({kPreviewTag, std::move(previewPayload), {}});
+        }
     }
 
-    const bool ok = RSYNContainer::writeFile(
-        filepath,
-        chunks,
-        [&](const float value) {
-            emitProgress(progress, 0.72f + value * 0.28f);
-        });
+    emitProgress(progress, 0.92f);
+
+    const auto& sourceData = exportedMetadata.sourceData;
+    if (ok && sourceData != nullptr && sourceData->bytes.empty() && sourceData->hasContent()) {
+        RSYNContainer::Chunk sourceChunk{kSourceTag, {}, {}, sourceCompressionFor(sourceData->extension)};
+        sourceChunk.sourcePath = sourceData->path;
+        sourceChunk.sourceSize = sourceData->size;
+        sourceChunk.sourceCrc32 = sourceData->crc32;
+        ok = writer.addChunk(sourceChunk);
+    } else if (ok) {
+        ok = RSYNSerialisation::encodeSourceBytes(sourceData, sourcePayload);
+        if (ok && !sourcePayload.empty()) {
+            ok = writer.addChunk({kSourceTag, std::move(sourcePayload), {}, sourceCompressionFor(sourceData->extension)});
+        }
+    }
+
+    ok = ok && writer.finish();
     emitProgress(progress, 1.0f);
     return ok;
 }
 
 bool loadFromRsyn(const std::string& filepath,
-                  std::vector<AudioColourSample>& samples,
+                  SpectralSequence& samples,
                   AudioMetadata& metadata,
                   const std::function<void(float)>& progress,
                   const SequenceFrameCallback& onFrameDecoded) {
@@ -143,20 +315,22 @@ bool loadFromRsyn(const std::string& filepath,
 
 bool loadFromRsynShell(const std::string& filepath,
                        AudioMetadata& metadata,
-                       const std::function<void(float)>& progress) {
+                       const std::function<void(float)>& progress,
+                       const RSYNPreviewCallback& onPreviewDecoded) {
     metadata.sourceData.reset();
     metadata.presentationData.reset();
     metadata.lazyAsset = std::make_shared<RSYNLazyAsset>();
     metadata.lazyAsset->filepath = filepath;
 
-    if (!RSYNContainer::readIndex(
+    RSYNContainer::MappedView view;
+    if (!view.open(
             filepath,
-            metadata.lazyAsset->chunkIndex,
             [&](const float value) {
                 emitProgress(progress, value * 0.3f);
             })) {
         return false;
     }
+    metadata.lazyAsset->chunkIndex = view.index();
 
     RSYNContainer::ChunkLocator metaLocator{};
     RSYNContainer::ChunkLocator presentationLocator{};
@@ -165,10 +339,12 @@ bool loadFromRsynShell(const std::string& filepath,
         return false;
     }
 
-    std::vector<std::uint8_t> metaPayload;
-    std::vector<std::uint8_t> presentationPayload;
-    if (!RSYNContainer::readChunk(metadata.lazyAsset->filepath, metaLocator, metaPayload) ||
-        !RSYNContainer::readChunk(metadata.lazyAsset->filepath, presentationLocator, presentationPayload)) {
+    std::vector<std::uint8_t> metaScratch;
+    std::vector<std::uint8_t> presentationScratch;
+    std::span<const std::uint8_t> metaPayload;
+    std::span<const std::uint8_t> presentationPayload;
+    if (!view.access(metaLocator, metaScratch, metaPayload) ||
+        !view.access(presentationLocator, presentationScratch, presentationPayload)) {
         return false;
     }
 
@@ -176,6 +352,19 @@ bool loadFromRsynShell(const std::string& filepath,
         return false;
     }
 
+    // PREV is optional and a bad one is skipped rather than failing the load, since PRES
+    // carries everything it summarises.
+    RSYNContainer::ChunkLocator previewLocator{};
+    if (onPreviewDecoded && readRequiredLocator(metadata, kPreviewTag, previewLocator)) {
+        std::vector<std::uint8_t> previewScratch;
+        std::span<const std::uint8_t> previewPayload;
+        auto preview = std::make_shared<RSYNPreviewData>();
+        if (view.access(previewLocator, previewScratch, previewPayload) &&
+            RSYNSerialisation::decodePreview(previewPayload, *preview)) {
+            onPreviewDecoded(std::move(preview));
+        }
+    }
+
     metadata.lazyAsset->filepath = filepath;
     if (!RSYNSerialisation::decodePresentationFrames(
             presentationPayload,
@@ -191,26 +380,65 @@ bool loadFromRsynShell(const std::string& filepath,
 }
 
 bool hydrateRsynSamples(AudioMetadata& metadata,
-                        std::vector<AudioColourSample>& samples,
+                        SpectralSequence& samples,
                         const std::function<void(float)>& progress,
                         const SequenceFrameCallback& onFrameDecoded) {
     RSYNContainer::ChunkLocator spectralLocator{};
-    if (!readRequiredLocator(metadata, kSpectralTag, spectralLocator)) {
+    RSYNContainer::MappedView view;
+    if (!readRequiredLocator(metadata, kSpectralTag, spectralLocator) || !openAssetView(metadata, view)) {
         return false;
     }
 
-    std::vector<std::uint8_t> spectralPayload;
-    if (!RSYNContainer::readChunk(metadata.lazyAsset->filepath, spectralLocator, spectralPayload) ||
-        !RSYNSerialisation::decodeSamples(
-            spectralPayload,
-            samples,
-            onFrameDecoded,
-            [&](const float value) {
-                emitProgress(progress, value);
-            })) {
+    std::vector<float> sharedFrequencies;
+    if (!readSharedFrequencies(metadata, view, sharedFrequencies)) {
         return false;
     }
 
+    if (hasSpectralBlocks(metadata, spectralLocator)) {
+        // Blocks are inflated a batch at a time, so peak memory is one batch rather than the
+        // whole chunk and previews start after the first batch lands.
+        const std::size_t blockFrames = metadata.lazyAsset->spectralBlockFrames;
+        const std::span<const RSYNContainer::BlockLocator> blocks(spectralLocator.blocks);
+        samples.clear();
+        samples.reserve(blocks.size() * blockFrames);
+        std::vector<std::vector<std::uint8_t>> blockScratch;
+        std::vector<std::span<const std::uint8_t>> blockPayloads;
+        for (std::size_t batchStart = 0; batchStart < blocks.size(); batchStart += kHydrateBatchBlocks) {
+            const std::size_t batchSize = std::min(kHydrateBatchBlocks, blocks.size() - batchStart);
+            if (!view.accessBlocks(blocks.subspan(batchStart, batchSize), blockScratch, blockPayloads)) {
+                samples.clear();
+                return false;
+            }
+
+            for (std::size_t batchIndex = 0; batchIndex < batchSize; ++batchIndex) {
+                const std::size_t blockIndex = batchStart + batchIndex;
+                if (!decodeSpectralBlock(metadata, spectralLocator, blockIndex, blockPayloads[batchIndex],
+                                         sharedFrequencies, samples, blockIndex * blockFrames)) {
+                    samples.clear();
+                    return false;
+                }
+                if (onFrameDecoded) {
+                    onFrameDecoded(samples, samples.size());
+                }
+                emitProgress(progress, static_cast<float>(blockIndex + 1) / static_cast<float>(blocks.size()));
+            }
+        }
+    } else {
+        std::vector<std::uint8_t> spectralScratch;
+        std::span<const std::uint8_t> spectralPayload;
+        if (!view.access(spectralLocator, spectralScratch, spectralPayload) ||
+            !RSYNSerialisation::decodeSamples(
+                spectralPayload,
+                samples,
+                sharedFrequencies,
+                onFrameDecoded,
+                [&](const float value) {
+                    emitProgress(progress, value);
+                })) {
+            return false;
+        }
+    }
+
     if (metadata.numFrames == 0) {
         metadata.numFrames = samples.size();
     }
@@ -224,20 +452,92 @@ bool hydrateRsynSamples(AudioMetadata& metadata,
     return true;
 }
 
+bool hydrateRsynFrames(const AudioMetadata& metadata,
+                       const std::size_t firstFrame,
+                       const std::size_t frameCount,
+                       SpectralSequence& frames) {
+    frames.clear();
+    if (frameCount == 0) {
+        return true;
+    }
+
+    RSYNContainer::ChunkLocator spectralLocator{};
+    RSYNContainer::MappedView view;
+    std::vector<float> sharedFrequencies;
+    if (!readRequiredLocator(metadata, kSpectralTag, spectralLocator) || !openAssetView(metadata, view) ||
+        !readSharedFrequencies(metadata, view, sharedFrequencies)) {
+        return false;
+    }
+
+    SpectralSequence decoded;
+    std::size_t decodedFirstFrame = 0;
+    if (hasSpectralBlocks(metadata, spectralLocator)) {
+        const std::size_t blockFrames = metadata.lazyAsset->spectralBlockFrames;
+        const std::size_t firstBlock = firstFrame / blockFrames;
+        const std::size_t endFrame = frameCount > std::numeric_limits<std::size_t>::max() - firstFrame
+            ? std::numeric_limits<std::size_t>::max()
+            : firstFrame + frameCount;
+        const std::size_t endBlock = std::min(spectralLocator.blocks.size(), (endFrame - 1) / blockFrames + 1);
+        decodedFirstFrame = firstBlock * blockFrames;
+        if (firstBlock >= endBlock) {
+            return true;
+        }
+
+        std::vector<std::vector<std::uint8_t>> blockScratch;
+        std::vector<std::span<const std::uint8_t>> blockPayloads;
+        if (!view.accessBlocks(
+                std::span<const RSYNContainer::BlockLocator>(spectralLocator.blocks).subspan(firstBlock, endBlock - firstBlock),
+                blockScratch,
+                blockPayloads)) {
+            return false;
+        }
+        for (std::size_t blockIndex = firstBlock; blockIndex < endBlock; ++blockIndex) {
+            if (!decodeSpectralBlock(metadata, spectralLocator, blockIndex, blockPayloads[blockIndex - firstBlock],
+                                     sharedFrequencies, decoded, (blockIndex - firstBlock) * blockFrames)) {
+                return false;
+            }
+        }
+    } else {
+        // Files without a block index still need the whole chunk inflated.
+        std::vector<std::uint8_t> spectralScratch;
+        std::span<const std::uint8_t> spectralPayload;
+        if (!view.access(spectralLocator, spectralScratch, spectralPayload) ||
+            !RSYNSerialisation::decodeSamples(spectralPayload, decoded, sharedFrequencies)) {
+            return false;
+        }
+    }
+
+    if (firstFrame - decodedFirstFrame >= decoded.size()) {
+        return true;
+    }
+
+    const std::size_t begin = firstFrame - decodedFirstFrame;
+    const std::size_t end = begin + std::min(frameCount, decoded.size() - begin);
+    if (begin == 0 && end == decoded.size()) {
+        frames = std::move(decoded);
+        return true;
+    }
+    frames.setSharedFrequencies(decoded.sharedFrequencies());
+    frames.append(SpectralSequenceView(decoded, begin, end - begin));
+    return true;
+}
+
 bool hydrateRsynSource(AudioMetadata& metadata,
                        const std::function<void(float)>& progress) {
-    if (metadata.sourceData != nullptr && !metadata.sourceData->bytes.empty()) {
+    if (metadata.sourceData != nullptr && metadata.sourceData->hasContent()) {
         emitProgress(progress, 1.0f);
         return true;
     }
 
     RSYNContainer::ChunkLocator sourceLocator{};
-    if (!readRequiredLocator(metadata, kSourceTag, sourceLocator)) {
+    RSYNContainer::MappedView view;
+    if (!readRequiredLocator(metadata, kSourceTag, sourceLocator) || !openAssetView(metadata, view)) {
         return false;
     }
 
-    std::vector<std::uint8_t> sourcePayload;
-    if (!RSYNContainer::readChunk(metadata.lazyAsset->filepath, sourceLocator, sourcePayload)) {
+    std::vector<std::uint8_t> sourceScratch;
+    std::span<const std::uint8_t> sourcePayload;
+    if (!view.access(sourceLocator, sourceScratch, sourcePayload)) {
         return false;
     }
 
@@ -249,4 +549,35 @@ bool hydrateRsynSource(AudioMetadata& metadata,
     return true;
 }
 
+bool compactRsyn(const std::string& filepath, AudioMetadata& metadata) {
+    if (!RSYNContainer::shouldCompact(filepath) || !RSYNContainer::compact(filepath)) {
+        return false;
+    }
+
+    // The copy keeps every chunk's tag, blocks and bytes, so only the offsets change.
+    const auto& asset = metadata.lazyAsset;
+    std::error_code ec;
+    if (asset != nullptr && std::filesystem::equivalent(asset->filepath, filepath, ec) && !ec) {
+        RSYNContainer::ChunkIndex index;
+        if (RSYNContainer::readIndex(filepath, index)) {
+            asset->chunkIndex = std::move(index);
+        }
+    }
+    return true;
+}
+
+bool loadRsynPeakTracks(const AudioMetadata& metadata,
+                        PhaseReconstruction::PeakTrackSequence& tracks) {
+    RSYNContainer::ChunkLocator peakLocator{};
+    RSYNContainer::MappedView view;
+    if (!readRequiredLocator(metadata, kPeakTrackTag, peakLocator) || !openAssetView(metadata, view)) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> peakScratch;
+    std::span<const std::uint8_t> peakPayload;
+    return view.access(peakLocator, peakScratch, peakPayload) &&
+        RSYNSerialisation::decodePeakTracks(peakPayload, tracks);
+}
+
 }
@@ -1,35 +1,52 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <string>
 #include <vector>
 
 #include "resyne/encoding/formats/exporter.h"
+#include "resyne/encoding/reconstruction/peak_tracking.h"
 
 namespace SequenceExporterInternal {
 
 bool exportToRsyn(const std::string& filepath,
-                  const std::vector<AudioColourSample>& samples,
+                  SpectralSequenceView samples,
                   const AudioMetadata& metadata,
                   const RSYNExportOptions& options,
-                  const std::function<void(float)>& progress = {});
+                  const std::function<void(float)>& progress = {},
+                  const Utilities::Threading::CancellationToken& cancellation = {});
 
 bool loadFromRsyn(const std::string& filepath,
-                  std::vector<AudioColourSample>& samples,
+                  SpectralSequence& samples,
                   AudioMetadata& metadata,
                   const std::function<void(float)>& progress = {},
                   const SequenceFrameCallback& onFrameDecoded = {});
 
 bool loadFromRsynShell(const std::string& filepath,
                        AudioMetadata& metadata,
-                       const std::function<void(float)>& progress = {});
+                       const std::function<void(float)>& progress = {},
+                       const RSYNPreviewCallback& onPreviewDecoded = {});
 
 bool hydrateRsynSamples(AudioMetadata& metadata,
-                        std::vector<AudioColourSample>& samples,
+                        SpectralSequence& samples,
                         const std::function<void(float)>& progress = {},
                         const SequenceFrameCallback& onFrameDecoded = {});
 
+// Decodes frames [firstFrame, firstFrame + frameCount) reading only the SPEC blocks that
+// cover them; the result is shorter when the range runs past the end.
+bool hydrateRsynFrames(const AudioMetadata& metadata,
+                       std::size_t firstFrame,
+                       std::size_t frameCount,
+                       SpectralSequence& frames);
+
 bool hydrateRsynSource(AudioMetadata& metadata,
                        const std::function<void(float)>& progress = {});
 
+bool compactRsyn(const std::string& filepath, AudioMetadata& metadata);
+
+// Reads the PEAK chunk, one entry per SPEC frame; false when the file was saved without one.
+bool loadRsynPeakTracks(const AudioMetadata& metadata,
+                        PhaseReconstruction::PeakTrackSequence& tracks);
+
 }
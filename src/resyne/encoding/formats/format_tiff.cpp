@@ -1,4 +1,5 @@
 #include "resyne/encoding/formats/format_tiff.h"
+#include "resyne/encoding/formats/half_float.h"
 
 #include "resyne/encoding/spectral/colour_native_codec.h"
 #include "resyne/recorder/loudness_utils.h"
@@ -9,17 +10,20 @@
 
 #define TINY_DNG_LOADER_NO_STB_IMAGE_INCLUDE
 #define TINY_DNG_LOADER_IMPLEMENTATION
-#define TINY_DNG_WRITER_IMPLEMENTATION
 #include <tiny_dng_loader.h>
-#include <tiny_dng_writer.h>
+
+#include "miniz.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <limits>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -46,6 +50,22 @@ float srgbToLinear(const float value) {
 	return std::pow((value + 0.055f) / 1.055f, 2.4f);
 }
 
+// A channel's linear value depends only on its code, so each integer depth decodes through
+// a table of every code built on first use.
+template <typename Sample>
+const std::vector<float>& srgbDecodeTable() {
+	static const std::vector<float> table = [] {
+		constexpr size_t codeCount = size_t{std::numeric_limits<Sample>::max()} + 1;
+		std::vector<float> values(codeCount);
+		for (size_t code = 0; code < codeCount; ++code) {
+			const float encoded = static_cast<float>(code) / static_cast<float>(codeCount - 1);
+			values[code] = srgbToLinear(encoded);
+		}
+		return values;
+	}();
+	return table;
+}
+
 float sanitiseFloat(const float value) {
 	if (!std::isfinite(value)) {
 		return 0.0f;
@@ -53,7 +73,7 @@ float sanitiseFloat(const float value) {
 	return std::clamp(value, 0.0f, 1.0f);
 }
 
-size_t resolveBinCount(const std::vector<AudioColourSample>& samples,
+size_t resolveBinCount(const SpectralSequenceView samples,
 						 const AudioMetadata& metadata) {
 	if (metadata.numBins > 0) {
 		return metadata.numBins;
@@ -64,7 +84,7 @@ size_t resolveBinCount(const std::vector<AudioColourSample>& samples,
 	return samples.front().magnitudes.front().size();
 }
 
-uint32_t resolveStoredSampleRate(const std::vector<AudioColourSample>& samples,
+uint32_t resolveStoredSampleRate(const SpectralSequenceView samples,
 								   const AudioMetadata& metadata) {
 	const float sampleRate = metadata.sampleRate > 0.0f
 		? metadata.sampleRate
@@ -80,7 +100,7 @@ uint32_t resolveStoredSampleRate(const std::vector<AudioColourSample>& samples,
 	return static_cast<uint32_t>(clampedSampleRate);
 }
 
-uint32_t resolveStoredFftSize(const std::vector<AudioColourSample>& samples,
+uint32_t resolveStoredFftSize(const SpectralSequenceView samples,
 								const AudioMetadata& metadata) {
 	if (metadata.fftSize > 0) {
 		return static_cast<uint32_t>(metadata.fftSize);
@@ -100,7 +120,7 @@ uint32_t resolveStoredHopSize(const AudioMetadata& metadata,
 	return storedFftSize > 0 ? std::max(1u, storedFftSize / 2) : 0u;
 }
 
-uint32_t resolveStoredChannels(const std::vector<AudioColourSample>& samples,
+uint32_t resolveStoredChannels(const SpectralSequenceView samples,
 								 const AudioMetadata& metadata) {
 	if (metadata.channels > 0) {
 		return metadata.channels;
@@ -156,6 +176,105 @@ EmbeddedTiffMetadata readEmbeddedMetadata(const tinydng::DNGImage& image) {
 	return metadata;
 }
 
+// Strips are sized to about this many bytes, so only one is ever held in memory.
+constexpr size_t TIFF_STRIP_TARGET_BYTES = 1 << 20;
+constexpr int TIFF_DEFLATE_LEVEL = 6;
+
+constexpr uint16_t TIFF_TYPE_ASCII = 2;
+constexpr uint16_t TIFF_TYPE_SHORT = 3;
+constexpr uint16_t TIFF_TYPE_LONG = 4;
+constexpr uint16_t TIFF_TYPE_RATIONAL = 5;
+
+struct TiffEntry {
+	uint16_t tag;
+	uint16_t type;
+	uint32_t count;
+	std::vector<uint8_t> value;
+};
+
+template <typename T>
+void appendLittleEndian(std::vector<uint8_t>& bytes, const T value) {
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		bytes.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+	}
+}
+
+TiffEntry shortEntry(const uint16_t tag, const std::vector<uint16_t>& values) {
+	TiffEntry entry{tag, TIFF_TYPE_SHORT, static_cast<uint32_t>(values.size()), {}};
+	for (const uint16_t value : values) {
+		appendLittleEndian(entry.value, value);
+	}
+	return entry;
+}
+
+TiffEntry longEntry(const uint16_t tag, const std::vector<uint32_t>& values) {
+	TiffEntry entry{tag, TIFF_TYPE_LONG, static_cast<uint32_t>(values.size()), {}};
+	for (const uint32_t value : values) {
+		appendLittleEndian(entry.value, value);
+	}
+	return entry;
+}
+
+TiffEntry rationalEntry(const uint16_t tag, const uint32_t numerator, const uint32_t denominator) {
+	TiffEntry entry{tag, TIFF_TYPE_RATIONAL, 1, {}};
+	appendLittleEndian(entry.value, numerator);
+	appendLittleEndian(entry.value, denominator);
+	return entry;
+}
+
+TiffEntry asciiEntry(const uint16_t tag, const std::string& text) {
+	TiffEntry entry{tag, TIFF_TYPE_ASCII, static_cast<uint32_t>(text.size() + 1), {}};
+	entry.value.assign(text.begin(), text.end());
+	entry.value.push_back(0);
+	return entry;
+}
+
+// Serialises one IFD to be written at ifdOffset, with values over four bytes following it.
+std::vector<uint8_t> buildIfd(std::vector<TiffEntry> entries, const uint32_t ifdOffset) {
+	std::sort(entries.begin(), entries.end(), [](const TiffEntry& a, const TiffEntry& b) {
+		return a.tag < b.tag;
+	});
+
+	std::vector<uint8_t> ifd;
+	std::vector<uint8_t> external;
+	const uint32_t externalOffset = ifdOffset + 2 + static_cast<uint32_t>(entries.size()) * 12 + 4;
+	appendLittleEndian(ifd, static_cast<uint16_t>(entries.size()));
+	for (const TiffEntry& entry : entries) {
+		appendLittleEndian(ifd, entry.tag);
+		appendLittleEndian(ifd, entry.type);
+		appendLittleEndian(ifd, entry.count);
+		if (entry.value.size() <= 4) {
+			ifd.insert(ifd.end(), entry.value.begin(), entry.value.end());
+			ifd.resize(ifd.size() + (4 - entry.value.size()), 0);
+		} else {
+			if ((external.size() & 1) != 0) {
+				external.push_back(0);
+			}
+			appendLittleEndian(ifd, externalOffset + static_cast<uint32_t>(external.size()));
+			external.insert(external.end(), entry.value.begin(), entry.value.end());
+		}
+	}
+	appendLittleEndian(ifd, uint32_t{0});
+	ifd.insert(ifd.end(), external.begin(), external.end());
+	return ifd;
+}
+
+// TIFF floating-point predictor (Adobe Technical Note 3): each row's sample bytes are
+// regrouped most significant first, then differenced byte-wise across each pixel's stride.
+void applyFloatingPointPredictor(uint8_t* row, const size_t sampleCount, const size_t sampleBytes,
+								 const size_t stride, std::vector<uint8_t>& scratch) {
+	const size_t rowBytes = sampleCount * sampleBytes;
+	scratch.assign(row, row + rowBytes);
+	for (size_t i = 0; i < sampleCount; ++i) {
+		for (size_t byte = 0; byte < sampleBytes; ++byte) {
+			row[(sampleBytes - 1 - byte) * sampleCount + i] = scratch[i * sampleBytes + byte];
+		}
+	}
+	for (size_t i = rowBytes - 1; i >= stride; --i) {
+		row[i] = static_cast<uint8_t>(row[i] - row[i - stride]);
+	}
+}
+
 bool resolveImageLayout(const size_t height,
 						  const uint32_t preferredChannels,
 						  size_t& binCount,
@@ -203,128 +322,206 @@ bool resolveImageLayout(const size_t height,
 	return acceptLayout(1);
 }
 
-}
-
-bool exportToTIFF(const std::string& filepath,
-                 const std::vector<AudioColourSample>& samples,
-                 const AudioMetadata& metadata,
-                 const std::function<void(float)>& progress) {
-	if (samples.empty()) {
-		if (progress) {
-			progress(1.0f);
-		}
+// Reads float32 RGB(A) TIFFs laid out in strips, as exportToTIFF writes them, one strip at a
+// time straight into colourImage. Uncompressed and Deflate strips are handled, with or
+// without the floating-point predictor; false for anything else, which then goes through
+// tinydng instead.
+bool loadFloatStrips(const std::string& filepath,
+					 ColourNativeImage& colourImage,
+					 EmbeddedTiffMetadata& embeddedMetadata,
+					 const std::function<void(float)>& progress) {
+	std::ifstream file(filepath, std::ios::binary);
+	uint8_t header[8] = {};
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
 		return false;
 	}
-
-	const auto emitProgress = [&](float value) {
-		if (!progress) {
-			return;
+	const bool bigEndian = header[0] == 'M' && header[1] == 'M';
+	if (!bigEndian && !(header[0] == 'I' && header[1] == 'I')) {
+		return false;
+	}
+	const auto readUnsigned = [bigEndian](const uint8_t* bytes, const size_t size) {
+		uint32_t value = 0;
+		for (size_t i = 0; i < size; ++i) {
+			const size_t shift = bigEndian ? (size - 1 - i) : i;
+			value |= static_cast<uint32_t>(bytes[i]) << (8 * shift);
 		}
-		const float clamped = std::clamp(value, 0.0f, 1.0f);
-		progress(clamped);
+		return value;
 	};
-
-	emitProgress(0.0f);
-
-	const ColourNativeImage image = ColourNativeCodec::encode(
-		samples,
-		metadata,
-		[&](float encodeProgress) {
-			emitProgress(encodeProgress * 0.65f);
-		});
-	if (image.width == 0 || image.height == 0) {
-		emitProgress(1.0f);
+	if (readUnsigned(header + 2, 2) != 42) {
 		return false;
 	}
 
-	std::vector<float> imageData(image.width * image.height * 4);
-	for (size_t row = 0; row < image.height; ++row) {
-		const size_t invertedRow = image.height - 1 - row;
-		for (size_t column = 0; column < image.width; ++column) {
-			const RGBAColour& pixel = image.at(column, invertedRow);
-			const size_t idx = (row * image.width + column) * 4;
-
-			imageData[idx + 0] = pixel.r;
-			imageData[idx + 1] = pixel.g;
-			imageData[idx + 2] = pixel.b;
-			imageData[idx + 3] = pixel.a;
+	// Only SHORT and LONG fields are needed; everything else is skipped.
+	std::map<uint16_t, std::vector<uint32_t>> fields;
+	const uint32_t ifdOffset = readUnsigned(header + 4, 4);
+	uint8_t countBytes[2] = {};
+	if (!file.seekg(ifdOffset) || !file.read(reinterpret_cast<char*>(countBytes), 2)) {
+		return false;
+	}
+	const uint32_t entryCount = readUnsigned(countBytes, 2);
+	std::vector<uint8_t> entries(static_cast<size_t>(entryCount) * 12);
+	if (!file.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size()))) {
+		return false;
+	}
+	for (uint32_t i = 0; i < entryCount; ++i) {
+		const uint8_t* entry = entries.data() + static_cast<size_t>(i) * 12;
+		const uint16_t tag = static_cast<uint16_t>(readUnsigned(entry, 2));
+		const uint32_t type = readUnsigned(entry + 2, 2);
+		const uint32_t count = readUnsigned(entry + 4, 4);
+		if ((type != TIFF_TYPE_SHORT && type != TIFF_TYPE_LONG) || count == 0 || count > (1u << 24)) {
+			continue;
 		}
-
-		if (image.height > 0) {
-			const float rowProgress = static_cast<float>(row + 1) /
-				static_cast<float>(image.height);
-			emitProgress(0.65f + rowProgress * 0.25f);
+		const size_t valueSize = type == TIFF_TYPE_SHORT ? 2 : 4;
+		std::vector<uint8_t> bytes(valueSize * count);
+		if (bytes.size() <= 4) {
+			std::memcpy(bytes.data(), entry + 8, bytes.size());
+		} else if (!file.seekg(readUnsigned(entry + 8, 4)) ||
+				   !file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+			return false;
+		}
+		std::vector<uint32_t>& values = fields[tag];
+		values.resize(count);
+		for (uint32_t v = 0; v < count; ++v) {
+			values[v] = readUnsigned(bytes.data() + v * valueSize, valueSize);
 		}
 	}
 
-	tinydngwriter::DNGImage dngImage;
-	tinydngwriter::DNGWriter dngWriter(false);
+	const auto single = [&fields](const uint16_t tag, const uint32_t fallback) {
+		const auto it = fields.find(tag);
+		return it == fields.end() ? fallback : it->second.front();
+	};
+	const auto allEqual = [&fields](const uint16_t tag, const uint32_t expected) {
+		const auto it = fields.find(tag);
+		return it != fields.end() && std::all_of(it->second.begin(), it->second.end(), [expected](const uint32_t value) {
+			return value == expected;
+		});
+	};
 
-	dngImage.SetBigEndian(false);
-	dngImage.SetSubfileType(false, false, false);
-	dngImage.SetImageWidth(static_cast<uint32_t>(image.width));
-	dngImage.SetImageLength(static_cast<uint32_t>(image.height));
-	dngImage.SetRowsPerStrip(static_cast<uint32_t>(image.height));
-	dngImage.SetSamplesPerPixel(4);
+	const uint32_t width = single(256, 0);
+	const uint32_t height = single(257, 0);
+	const uint32_t samplesPerPixel = single(277, 1);
+	const uint32_t bitsPerSample = single(258, 1);
+	const uint32_t compression = single(259, 1);
+	const uint32_t predictor = single(317, 1);
+	const auto offsets = fields.find(273);
+	const auto byteCounts = fields.find(279);
+	if (width == 0 || height == 0 || (samplesPerPixel != 3 && samplesPerPixel != 4) ||
+		(bitsPerSample != 32 && bitsPerSample != 16) || !allEqual(258, bitsPerSample) ||
+		!allEqual(339, 3) || single(284, 1) != 1 ||
+		(compression != 1 && compression != 8 && compression != 32946) ||
+		(predictor != 1 && predictor != 3) ||
+		offsets == fields.end() || byteCounts == fields.end() ||
+		offsets->second.size() != byteCounts->second.size()) {
+		return false;
+	}
 
-	uint16_t bitsPerSample[4] = {32, 32, 32, 32};
-	dngImage.SetBitsPerSample(4, bitsPerSample);
+	const size_t rowFloats = static_cast<size_t>(width) * samplesPerPixel;
+	const size_t sampleBytes = bitsPerSample / 8;
+	const size_t rowBytes = rowFloats * sampleBytes;
+	const size_t rowsPerStrip = std::min<size_t>(single(278, height), height);
+	const size_t stripCount = (height + rowsPerStrip - 1) / rowsPerStrip;
+	if (rowsPerStrip == 0 || offsets->second.size() != stripCount) {
+		return false;
+	}
 
-	uint16_t sampleFormat[4] = {
-		tinydngwriter::SAMPLEFORMAT_IEEEFP,
-		tinydngwriter::SAMPLEFORMAT_IEEEFP,
-		tinydngwriter::SAMPLEFORMAT_IEEEFP,
-		tinydngwriter::SAMPLEFORMAT_IEEEFP
-	};
-	dngImage.SetSampleFormat(4, sampleFormat);
+	embeddedMetadata.sampleRate = single(TIFFTAG_RESYNE_SAMPLE_RATE, 0);
+	embeddedMetadata.fftSize = single(TIFFTAG_RESYNE_FFT_SIZE, 0);
+	embeddedMetadata.hopSize = single(TIFFTAG_RESYNE_HOP_SIZE, 0);
+	embeddedMetadata.channels = single(TIFFTAG_RESYNE_CHANNELS, 0);
 
-	dngImage.SetPhotometric(tinydngwriter::PHOTOMETRIC_RGB);
-	dngImage.SetPlanarConfig(tinydngwriter::PLANARCONFIG_CONTIG);
-	dngImage.SetCompression(tinydngwriter::COMPRESSION_NONE);
-	dngImage.SetXResolution(1.0);
-	dngImage.SetYResolution(1.0);
-	dngImage.SetResolutionUnit(tinydngwriter::RESUNIT_NONE);
-	dngImage.SetSoftware("Synesthesia");
+	if (progress) {
+		progress(0.06f);
+	}
 
-	const uint32_t storedSampleRate = resolveStoredSampleRate(samples, metadata);
-	const uint32_t storedFftSize = resolveStoredFftSize(samples, metadata);
-	const uint32_t storedHopSize = resolveStoredHopSize(metadata, storedFftSize);
-	const uint32_t storedChannels = resolveStoredChannels(samples, metadata);
+	colourImage.resize(width, height);
+	std::vector<uint8_t> stored;
+	std::vector<uint8_t> strip(rowsPerStrip * rowBytes);
+	std::vector<uint8_t> planes;
+	std::vector<uint16_t> halfRow;
+	std::vector<float> floatRow(rowFloats);
+
+	for (size_t stripIndex = 0; stripIndex < stripCount; ++stripIndex) {
+		const size_t firstRow = stripIndex * rowsPerStrip;
+		const size_t rows = std::min(rowsPerStrip, static_cast<size_t>(height) - firstRow);
+		const size_t expectedBytes = rows * rowBytes;
+
+		stored.resize(byteCounts->second[stripIndex]);
+		if (!file.seekg(offsets->second[stripIndex]) ||
+			!file.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(stored.size()))) {
+			return false;
+		}
+		if (compression == 1) {
+			if (stored.size() < expectedBytes) {
+				return false;
+			}
+			std::memcpy(strip.data(), stored.data(), expectedBytes);
+		} else {
+			mz_ulong decodedSize = static_cast<mz_ulong>(expectedBytes);
+			if (uncompress(strip.data(), &decodedSize, stored.data(), static_cast<mz_ulong>(stored.size())) != MZ_OK ||
+				decodedSize != expectedBytes) {
+				return false;
+			}
+		}
 
-	if (!dngImage.SetCustomFieldULong(TIFFTAG_RESYNE_SAMPLE_RATE, storedSampleRate) ||
-		!dngImage.SetCustomFieldULong(TIFFTAG_RESYNE_FFT_SIZE, storedFftSize) ||
-		!dngImage.SetCustomFieldULong(TIFFTAG_RESYNE_HOP_SIZE, storedHopSize) ||
-		!dngImage.SetCustomFieldULong(TIFFTAG_RESYNE_CHANNELS, storedChannels)) {
-		emitProgress(1.0f);
-		return false;
-	}
+		for (size_t row = 0; row < rows; ++row) {
+			uint8_t* bytes = strip.data() + row * rowBytes;
+			if (predictor == 3) {
+				// Undo the differencing, then put each sample's bytes back together. The planes
+				// are most significant first whatever the file's byte order.
+				for (size_t i = samplesPerPixel; i < rowBytes; ++i) {
+					bytes[i] = static_cast<uint8_t>(bytes[i] + bytes[i - samplesPerPixel]);
+				}
+				planes.assign(bytes, bytes + rowBytes);
+				for (size_t i = 0; i < rowFloats; ++i) {
+					for (size_t byte = 0; byte < sampleBytes; ++byte) {
+						bytes[i * sampleBytes + byte] = planes[(sampleBytes - 1 - byte) * rowFloats + i];
+					}
+				}
+			} else if (bigEndian) {
+				for (size_t i = 0; i < rowFloats; ++i) {
+					std::reverse(bytes + i * sampleBytes, bytes + (i + 1) * sampleBytes);
+				}
+			}
+			if (sampleBytes == sizeof(uint16_t)) {
+				halfRow.resize(rowFloats);
+				std::memcpy(halfRow.data(), bytes, rowBytes);
+				HalfFloat::toFloats(halfRow.data(), floatRow.data(), rowFloats);
+			} else {
+				std::memcpy(floatRow.data(), bytes, rowBytes);
+			}
 
-	dngImage.SetImageData(reinterpret_cast<const unsigned char*>(imageData.data()),
-						  imageData.size() * sizeof(float));
+			const size_t invertedRow = colourImage.height - 1 - (firstRow + row);
+			for (size_t column = 0; column < colourImage.width; ++column) {
+				float pixel[4] = {0.0f, 0.0f, 0.0f, 0.5f};
+				std::memcpy(pixel, floatRow.data() + column * samplesPerPixel, samplesPerPixel * sizeof(float));
+				colourImage.at(column, invertedRow) = {
+					sanitiseFloat(pixel[0]),
+					sanitiseFloat(pixel[1]),
+					sanitiseFloat(pixel[2]),
+					samplesPerPixel > 3 ? sanitiseFloat(pixel[3]) : 0.5f
+				};
+			}
+		}
 
-	dngWriter.AddImage(&dngImage);
+		if (progress) {
+			const float stripProgress = static_cast<float>(firstRow + rows) / static_cast<float>(height);
+			progress(0.08f + stripProgress * 0.48f);
+		}
+	}
 
-	std::string err;
-	emitProgress(0.92f);
-	const bool ok = dngWriter.WriteToFile(filepath.c_str(), &err);
-	emitProgress(ok ? 1.0f : 0.92f);
-	return ok;
+	return true;
 }
 
-bool loadFromTIFF(const std::string& filepath,
-                 std::vector<AudioColourSample>& samples,
-                 AudioMetadata& metadata,
-                 const std::function<void(float)>& progress,
-				 const SequenceFrameCallback& onFrameDecoded) {
+// Any TIFF layout tinydng understands, loaded whole.
+bool loadWithTinyDng(const std::string& filepath,
+					 ColourNativeImage& colourImage,
+					 EmbeddedTiffMetadata& embeddedMetadata,
+					 const std::function<void(float)>& progress) {
 	std::vector<tinydng::DNGImage> images;
 	std::vector<tinydng::FieldInfo> customFields = buildEmbeddedMetadataFields();
 	std::string warn;
 	std::string err;
 
-	if (progress) {
-		progress(0.02f);
-	}
-
 	if (!tinydng::LoadDNG(filepath.c_str(), customFields, &images, &warn, &err)) {
 		return false;
 	}
@@ -337,13 +534,12 @@ bool loadFromTIFF(const std::string& filepath,
 	if (image.width <= 0 || image.height <= 0 || image.samples_per_pixel < 3) {
 		return false;
 	}
-	const EmbeddedTiffMetadata embeddedMetadata = readEmbeddedMetadata(image);
+	embeddedMetadata = readEmbeddedMetadata(image);
 
 	if (progress) {
 		progress(0.06f);
 	}
 
-	ColourNativeImage colourImage;
 	colourImage.resize(static_cast<size_t>(image.width),
 					   static_cast<size_t>(image.height));
 
@@ -377,14 +573,15 @@ bool loadFromTIFF(const std::string& filepath,
 
 		if (image.bits_per_sample == 8) {
 			const unsigned char* imageData = image.data.data();
+			const auto& decode = srgbDecodeTable<uint8_t>();
 			for (size_t row = 0; row < colourImage.height; ++row) {
 				const size_t invertedRow = colourImage.height - 1 - row;
 				for (size_t column = 0; column < colourImage.width; ++column) {
 					const size_t idx = (row * colourImage.width + column) * pixelStride;
 
-					const float r = srgbToLinear(static_cast<float>(imageData[idx + 0]) / 255.0f);
-					const float g = srgbToLinear(static_cast<float>(imageData[idx + 1]) / 255.0f);
-					const float b = srgbToLinear(static_cast<float>(imageData[idx + 2]) / 255.0f);
+					const float r = decode[imageData[idx + 0]];
+					const float g = decode[imageData[idx + 1]];
+					const float b = decode[imageData[idx + 2]];
 					const float a = pixelStride > 3
 						? static_cast<float>(imageData[idx + 3]) / 255.0f
 						: 0.5f;
@@ -404,14 +601,15 @@ bool loadFromTIFF(const std::string& filepath,
 			}
 		} else {
 			const uint16_t* imageData = reinterpret_cast<const uint16_t*>(image.data.data());
+			const auto& decode = srgbDecodeTable<uint16_t>();
 			for (size_t row = 0; row < colourImage.height; ++row) {
 				const size_t invertedRow = colourImage.height - 1 - row;
 				for (size_t column = 0; column < colourImage.width; ++column) {
 					const size_t idx = (row * colourImage.width + column) * pixelStride;
 
-					const float r = srgbToLinear(static_cast<float>(imageData[idx + 0]) / 65535.0f);
-					const float g = srgbToLinear(static_cast<float>(imageData[idx + 1]) / 65535.0f);
-					const float b = srgbToLinear(static_cast<float>(imageData[idx + 2]) / 65535.0f);
+					const float r = decode[imageData[idx + 0]];
+					const float g = decode[imageData[idx + 1]];
+					const float b = decode[imageData[idx + 2]];
 					const float a = pixelStride > 3
 						? static_cast<float>(imageData[idx + 3]) / 65535.0f
 						: 0.5f;
@@ -434,6 +632,204 @@ bool loadFromTIFF(const std::string& filepath,
 		return false;
 	}
 
+	return true;
+}
+
+}
+
+// Writes the encoded image straight to disk one strip of rows at a time, so the only other
+// copy held is a single strip rather than the whole float image.
+bool exportToTIFF(const std::string& filepath,
+                 const SpectralSequenceView samples,
+                 const AudioMetadata& metadata,
+                 const std::function<void(float)>& progress,
+                 const TIFFExportOptions& options,
+                 const Utilities::Threading::CancellationToken& cancellation) {
+	if (samples.empty()) {
+		if (progress) {
+			progress(1.0f);
+		}
+		return false;
+	}
+
+	const auto emitProgress = [&](float value) {
+		if (!progress) {
+			return;
+		}
+		const float clamped = std::clamp(value, 0.0f, 1.0f);
+		progress(clamped);
+	};
+
+	emitProgress(0.0f);
+
+	const ColourNativeImage image = ColourNativeCodec::encode(
+		samples,
+		metadata,
+		[&](float encodeProgress) {
+			emitProgress(encodeProgress * 0.65f);
+		},
+		cancellation);
+	if (image.width == 0 || image.height == 0 ||
+		image.width > std::numeric_limits<uint32_t>::max() ||
+		image.height > std::numeric_limits<uint32_t>::max()) {
+		emitProgress(1.0f);
+		return false;
+	}
+
+	static_assert(sizeof(RGBAColour) == 4 * sizeof(float), "TIFF rows are written straight from RGBAColour");
+	const size_t rowFloats = image.width * 4;
+	const size_t sampleBytes = options.halfFloat ? sizeof(uint16_t) : sizeof(float);
+	const uint16_t bitsPerSample = static_cast<uint16_t>(sampleBytes * 8);
+	const size_t rowBytes = rowFloats * sampleBytes;
+	const size_t rowsPerStrip = std::clamp<size_t>(TIFF_STRIP_TARGET_BYTES / rowBytes, 1, image.height);
+	const size_t stripCount = (image.height + rowsPerStrip - 1) / rowsPerStrip;
+	const bool deflate = options.compression == TIFFCompression::Deflate;
+
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		emitProgress(1.0f);
+		return false;
+	}
+
+	// Classic little-endian TIFF; the IFD offset is filled in once the strips are down.
+	const uint8_t header[8] = {'I', 'I', 42, 0, 0, 0, 0, 0};
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	std::vector<uint32_t> stripOffsets;
+	std::vector<uint32_t> stripByteCounts;
+	stripOffsets.reserve(stripCount);
+	stripByteCounts.reserve(stripCount);
+	std::vector<uint8_t> strip(rowsPerStrip * rowBytes);
+	std::vector<uint8_t> compressed;
+	std::vector<uint8_t> scratch;
+	std::vector<uint16_t> halfRow(options.halfFloat ? rowFloats : 0);
+	uint64_t offset = sizeof(header);
+
+	for (size_t firstRow = 0; firstRow < image.height; firstRow += rowsPerStrip) {
+		if (cancellation.isCancelled()) {
+			file.close();
+			std::error_code ec;
+			std::filesystem::remove(filepath, ec);
+			emitProgress(1.0f);
+			return false;
+		}
+		const size_t rows = std::min(rowsPerStrip, image.height - firstRow);
+		// The image is stored top row first, which is the highest bin.
+		for (size_t row = 0; row < rows; ++row) {
+			const size_t invertedRow = image.height - 1 - (firstRow + row);
+			uint8_t* destination = strip.data() + row * rowBytes;
+			if (options.halfFloat) {
+				HalfFloat::fromFloats(&image.at(0, invertedRow).r, halfRow.data(), rowFloats);
+				std::memcpy(destination, halfRow.data(), rowBytes);
+			} else {
+				std::memcpy(destination, &image.at(0, invertedRow), rowBytes);
+			}
+			if (deflate) {
+				applyFloatingPointPredictor(destination, rowFloats, sampleBytes, 4, scratch);
+			}
+		}
+
+		const uint8_t* data = strip.data();
+		size_t size = rows * rowBytes;
+		if (deflate) {
+			mz_ulong compressedSize = compressBound(static_cast<mz_ulong>(size));
+			compressed.resize(static_cast<size_t>(compressedSize));
+			if (compress2(compressed.data(), &compressedSize, data, static_cast<mz_ulong>(size), TIFF_DEFLATE_LEVEL) != MZ_OK) {
+				emitProgress(1.0f);
+				return false;
+			}
+			data = compressed.data();
+			size = static_cast<size_t>(compressedSize);
+		}
+
+		// Classic TIFF addresses at most 4 GiB.
+		if (offset + size > std::numeric_limits<uint32_t>::max()) {
+			emitProgress(1.0f);
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+		stripOffsets.push_back(static_cast<uint32_t>(offset));
+		stripByteCounts.push_back(static_cast<uint32_t>(size));
+		offset += size;
+
+		emitProgress(0.65f + 0.33f * static_cast<float>(firstRow + rows) / static_cast<float>(image.height));
+	}
+
+	if ((offset & 1) != 0) {
+		file.put(0);
+		++offset;
+	}
+
+	const uint32_t storedSampleRate = resolveStoredSampleRate(samples, metadata);
+	const uint32_t storedFftSize = resolveStoredFftSize(samples, metadata);
+	const uint32_t storedHopSize = resolveStoredHopSize(metadata, storedFftSize);
+	const uint32_t storedChannels = resolveStoredChannels(samples, metadata);
+
+	std::vector<TiffEntry> entries = {
+		longEntry(254, {0}),
+		longEntry(256, {static_cast<uint32_t>(image.width)}),
+		longEntry(257, {static_cast<uint32_t>(image.height)}),
+		shortEntry(258, {bitsPerSample, bitsPerSample, bitsPerSample, bitsPerSample}),
+		shortEntry(259, {static_cast<uint16_t>(deflate ? 8 : 1)}),
+		shortEntry(262, {2}),
+		longEntry(273, stripOffsets),
+		shortEntry(277, {4}),
+		longEntry(278, {static_cast<uint32_t>(rowsPerStrip)}),
+		longEntry(279, stripByteCounts),
+		rationalEntry(282, 1, 1),
+		rationalEntry(283, 1, 1),
+		shortEntry(284, {1}),
+		shortEntry(296, {1}),
+		asciiEntry(305, "Synesthesia"),
+		shortEntry(338, {2}),
+		shortEntry(339, {3, 3, 3, 3}),
+		longEntry(TIFFTAG_RESYNE_SAMPLE_RATE, {storedSampleRate}),
+		longEntry(TIFFTAG_RESYNE_FFT_SIZE, {storedFftSize}),
+		longEntry(TIFFTAG_RESYNE_HOP_SIZE, {storedHopSize}),
+		longEntry(TIFFTAG_RESYNE_CHANNELS, {storedChannels})
+	};
+	if (deflate) {
+		entries.push_back(shortEntry(317, {3}));
+	}
+
+	const std::vector<uint8_t> ifd = buildIfd(std::move(entries), static_cast<uint32_t>(offset));
+	if (offset + ifd.size() > std::numeric_limits<uint32_t>::max()) {
+		emitProgress(1.0f);
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(ifd.data()), static_cast<std::streamsize>(ifd.size()));
+
+	std::vector<uint8_t> ifdOffset;
+	appendLittleEndian(ifdOffset, static_cast<uint32_t>(offset));
+	file.seekp(4);
+	file.write(reinterpret_cast<const char*>(ifdOffset.data()), static_cast<std::streamsize>(ifdOffset.size()));
+	file.close();
+
+	const bool ok = !file.fail();
+	emitProgress(ok ? 1.0f : 0.98f);
+	return ok;
+}
+
+bool loadFromTIFF(const std::string& filepath,
+                 SpectralSequence& samples,
+                 AudioMetadata& metadata,
+                 const std::function<void(float)>& progress,
+				 const SequenceFrameCallback& onFrameDecoded,
+				 const Utilities::Threading::CancellationToken& cancellation) {
+	if (progress) {
+		progress(0.02f);
+	}
+
+	ColourNativeImage colourImage;
+	EmbeddedTiffMetadata embeddedMetadata;
+	if (!loadFloatStrips(filepath, colourImage, embeddedMetadata, progress) &&
+		!loadWithTinyDng(filepath, colourImage, embeddedMetadata, progress)) {
+		return false;
+	}
+	if (cancellation.isCancelled()) {
+		return false;
+	}
+
 	size_t binCount = 0;
 	uint32_t inferredChannels = 1;
 	if (!resolveImageLayout(colourImage.height, embeddedMetadata.channels, binCount, inferredChannels)) {
@@ -478,13 +874,13 @@ bool loadFromTIFF(const std::string& filepath,
 		const float clamped = std::clamp(value, 0.0f, 1.0f);
 		progress(0.56f + clamped * 0.4f);
 	};
-	auto frameCallback = [&](const std::vector<AudioColourSample>& decoded, size_t validCount) {
+	auto frameCallback = [&](const SpectralSequence& decoded, size_t validCount) {
 		if (onFrameDecoded) {
 			onFrameDecoded(decoded, validCount);
 		}
 	};
 
-	samples = ColourNativeCodec::decode(colourImage, detectedSampleRate, hopSize, frameCallback, decodeProgress);
+	samples = ColourNativeCodec::decode(colourImage, detectedSampleRate, hopSize, frameCallback, decodeProgress, cancellation);
 	if (samples.empty()) {
 		return false;
 	}
@@ -8,14 +8,17 @@
 namespace SequenceExporterInternal {
 
 bool exportToTIFF(const std::string& filepath,
-                 const std::vector<AudioColourSample>& samples,
+                 SpectralSequenceView samples,
                  const AudioMetadata& metadata,
-                 const std::function<void(float)>& progress = {});
+                 const std::function<void(float)>& progress = {},
+                 const TIFFExportOptions& options = {},
+                 const Utilities::Threading::CancellationToken& cancellation = {});
 
 bool loadFromTIFF(const std::string& filepath,
-                 std::vector<AudioColourSample>& samples,
+                 SpectralSequence& samples,
                  AudioMetadata& metadata,
                  const std::function<void(float)>& progress = {},
-                 const SequenceFrameCallback& onFrameDecoded = {});
+                 const SequenceFrameCallback& onFrameDecoded = {},
+                 const Utilities::Threading::CancellationToken& cancellation = {});
 
 }
@@ -1,15 +1,19 @@
 #include "resyne/encoding/formats/format_wav.h"
 #include "resyne/encoding/audio/wav_encoder.h"
+#include "resyne/encoding/formats/spectral_sequence.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <span>
 #include <iostream>
 
 namespace SequenceExporterInternal {
 
 bool exportToWAV(const std::string& filepath,
-                const std::vector<AudioColourSample>& samples,
+                const SpectralSequenceView samples,
                 const AudioMetadata& metadata,
-                const std::function<void(float)>& progress) {
+                const std::function<void(float)>& progress,
+                const Utilities::Threading::CancellationToken& cancellation) {
 	const auto emitProgress = [&](float value) {
 		if (!progress) {
 			return;
@@ -20,45 +24,38 @@ bool exportToWAV(const std::string& filepath,
 
 	emitProgress(samples.empty() ? 1.0f : 0.0f);
 
-	std::vector<SpectralSample> spectralSamples;
-	spectralSamples.reserve(samples.size());
+	// WAV export has never applied varispeed correction; keep it that way.
+	WAVEncoder::FrameSource source = WAVEncoder::frameSource(samples, false);
+	source.cancellation = cancellation;
+	emitProgress(0.3f);
 
-	for (size_t index = 0; index < samples.size(); ++index) {
-		const auto& sample = samples[index];
-		SpectralSample spectral;
-		spectral.magnitudes = sample.magnitudes;
-		spectral.phases = sample.phases;
-		spectral.timestamp = sample.timestamp;
-		spectral.sampleRate = sample.sampleRate;
-		spectralSamples.push_back(spectral);
+	// Writing straight from the channels skips the interleaved copy of the whole track.
+	const std::vector<std::vector<float>> channelAudio = samples.empty()
+		? std::vector<std::vector<float>>{}
+		: WAVEncoder::reconstructChannels(
+			source,
+			metadata.sampleRate,
+			metadata.fftSize,
+			metadata.hopSize
+		);
 
-		if (!samples.empty()) {
-			const float progressRatio = static_cast<float>(index + 1) /
-				static_cast<float>(samples.size());
-			emitProgress(progressRatio * 0.3f);
-		}
-	}
-
-	auto result = WAVEncoder::reconstructFromSpectralData(
-		spectralSamples,
-		metadata.sampleRate,
-		metadata.fftSize,
-		metadata.hopSize
-	);
-
-	if (!result.success) {
+	if (channelAudio.empty() || cancellation.isCancelled()) {
 		emitProgress(1.0f);
 		return false;
 	}
 
 	emitProgress(0.8f);
 
-	const bool ok = WAVEncoder::exportToWAV(
-		filepath,
-		result.audioSamples,
-		result.sampleRate,
-		result.numChannels
-	);
+	std::vector<std::span<const float>> channels(channelAudio.begin(), channelAudio.end());
+	const bool hasAudio = std::none_of(channels.begin(), channels.end(), [](const std::span<const float> channel) {
+		return channel.empty();
+	});
+
+	WAVWriter writer;
+	bool ok = hasAudio &&
+		writer.open(filepath, static_cast<uint32_t>(metadata.sampleRate), static_cast<uint16_t>(channels.size())) &&
+		writer.writePlanar(channels);
+	ok = writer.close() && ok;
 
 	emitProgress(ok ? 1.0f : 0.9f);
 
@@ -8,8 +8,9 @@
 namespace SequenceExporterInternal {
 
 bool exportToWAV(const std::string& filepath,
-                const std::vector<AudioColourSample>& samples,
+                SpectralSequenceView samples,
                 const AudioMetadata& metadata,
-                const std::function<void(float)>& progress = {});
+                const std::function<void(float)>& progress = {},
+                const Utilities::Threading::CancellationToken& cancellation = {});
 
 }
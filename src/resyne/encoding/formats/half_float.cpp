@@ -0,0 +1,92 @@
+#include "resyne/encoding/formats/half_float.h"
+
+#include <bit>
+
+#ifdef USE_NEON_OPTIMISATIONS
+#include "resyne/encoding/formats/neon/half_float_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "resyne/encoding/formats/sse/half_float_sse.h"
+#endif
+
+namespace HalfFloat {
+
+std::uint16_t fromFloat(const float value) {
+    const std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+    const std::uint32_t sign = (bits >> 16) & 0x8000U;
+    const std::uint32_t magnitude = bits & 0x7FFFFFFFU;
+
+    if (magnitude >= 0x7F800000U) {
+        // Infinity stays infinity; NaN keeps the top of its payload and is made quiet.
+        const std::uint32_t nan = magnitude > 0x7F800000U ? 0x0200U | ((magnitude >> 13) & 0x03FFU) : 0U;
+        return static_cast<std::uint16_t>(sign | 0x7C00U | nan);
+    }
+    // 65520 and above round past the largest half.
+    if (magnitude >= 0x477FF000U) {
+        return static_cast<std::uint16_t>(sign | 0x7C00U);
+    }
+
+    std::uint32_t half = 0;
+    std::uint32_t remainder = 0;
+    std::uint32_t halfway = 0;
+    if (magnitude >= 0x38800000U) {
+        half = (magnitude - 0x38000000U) >> 13;
+        remainder = magnitude & 0x1FFFU;
+        halfway = 0x1000U;
+    } else {
+        // Below 2^-14 the result is subnormal, in units of 2^-24; 2^-25 and under round to zero.
+        if (magnitude < 0x33000000U) {
+            return static_cast<std::uint16_t>(sign);
+        }
+        const std::uint32_t shift = 126U - (magnitude >> 23);
+        const std::uint32_t mantissa = (magnitude & 0x007FFFFFU) | 0x00800000U;
+        half = mantissa >> shift;
+        remainder = mantissa & ((1U << shift) - 1U);
+        halfway = 1U << (shift - 1U);
+    }
+    // Carries run into the exponent, which is the correct next value.
+    if (remainder > halfway || (remainder == halfway && (half & 1U) != 0U)) {
+        ++half;
+    }
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+float toFloat(const std::uint16_t half) {
+    const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000U) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1FU;
+    const std::uint32_t mantissa = half & 0x03FFU;
+
+    if (exponent == 0) {
+        const float subnormal = static_cast<float>(mantissa) * 0x1p-24f;
+        return std::bit_cast<float>(sign | std::bit_cast<std::uint32_t>(subnormal));
+    }
+    if (exponent == 0x1FU) {
+        return std::bit_cast<float>(sign | 0x7F800000U | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112U) << 23) | (mantissa << 13));
+}
+
+void fromFloats(const float* input, std::uint16_t* output, const std::size_t count) {
+    std::size_t i = 0;
+#ifdef USE_NEON_OPTIMISATIONS
+    i = HalfFloatNEON::fromFloats(input, output, count);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    i = HalfFloatSSE::fromFloats(input, output, count);
+#endif
+    for (; i < count; ++i) {
+        output[i] = fromFloat(input[i]);
+    }
+}
+
+void toFloats(const std::uint16_t* input, float* output, const std::size_t count) {
+    std::size_t i = 0;
+#ifdef USE_NEON_OPTIMISATIONS
+    i = HalfFloatNEON::toFloats(input, output, count);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    i = HalfFloatSSE::toFloats(input, output, count);
+#endif
+    for (; i < count; ++i) {
+        output[i] = toFloat(input[i]);
+    }
+}
+
+}
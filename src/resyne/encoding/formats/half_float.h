@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// IEEE 754 binary16 storage for spectral data. Conversion rounds to nearest even: about
+// 0.05% relative error (0.004 dB) for normal values and within 2^-12 absolute for values
+// in [0, 1], inside edit detection's 0.001 change threshold. Magnitudes above 65504 become
+// infinity and anything below 2^-24 flushes to zero.
+namespace HalfFloat {
+
+std::uint16_t fromFloat(float value);
+float toFloat(std::uint16_t half);
+
+// Batch forms, through F16C or NEON where built for them.
+void fromFloats(const float* input, std::uint16_t* output, std::size_t count);
+void toFloats(const std::uint16_t* input, float* output, std::size_t count);
+
+}
@@ -0,0 +1,655 @@
+#include "resyne/encoding/formats/mp4_libav_writer.h"
+
+#if defined(SYN_FFMPEG_LIBAV)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/pixdesc.h>
+#include <libswresample/swresample.h>
+}
+
+namespace ReSyne::Encoding::Video {
+
+namespace {
+
+constexpr int64_t kAudioBitRate = 192000;
+
+std::string describe(const int error) {
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(error, buffer, sizeof(buffer));
+    return buffer;
+}
+
+// The layouts frames are written in directly, in order of preference for each depth.
+enum class PixelLayout {
+    Planar8,
+    Planar10,
+    SemiPlanar8,
+    SemiPlanar10
+};
+
+struct LayoutFormat {
+    PixelLayout layout;
+    AVPixelFormat format;
+};
+
+constexpr LayoutFormat kTenBitFormats[] = {
+    {PixelLayout::Planar10, AV_PIX_FMT_YUV420P10LE},
+    {PixelLayout::SemiPlanar10, AV_PIX_FMT_P010LE},
+};
+
+constexpr LayoutFormat kEightBitFormats[] = {
+    {PixelLayout::Planar8, AV_PIX_FMT_YUV420P},
+    {PixelLayout::SemiPlanar8, AV_PIX_FMT_NV12},
+};
+
+bool chooseLayout(const AVCodec* codec, const bool tenBit, LayoutFormat& chosen) {
+    const auto supports = [codec](const AVPixelFormat format) {
+        if (codec->pix_fmts == nullptr) {
+            return format == AV_PIX_FMT_YUV420P;
+        }
+        for (const AVPixelFormat* candidate = codec->pix_fmts; *candidate != AV_PIX_FMT_NONE; ++candidate) {
+            if (*candidate == format) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // An encoder without a 10-bit input still gets the 8-bit signal rather than no video.
+    if (tenBit) {
+        for (const LayoutFormat& candidate : kTenBitFormats) {
+            if (supports(candidate.format)) {
+                chosen = candidate;
+                return true;
+            }
+        }
+    }
+    for (const LayoutFormat& candidate : kEightBitFormats) {
+        if (supports(candidate.format)) {
+            chosen = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Same order as the ffmpeg pipe's encoder search, with the hardware encoders first.
+std::vector<std::string> videoEncoderCandidates(const bool hevc) {
+    if (const char* overrideCodec = std::getenv("RESYNE_FFMPEG_VIDEO_CODEC"); overrideCodec && *overrideCodec) {
+        return {overrideCodec};
+    }
+
+    std::vector<std::string> candidates;
+    if (hevc) {
+#if defined(__APPLE__)
+        candidates.emplace_back("hevc_videotoolbox");
+#endif
+        candidates.emplace_back("hevc_nvenc");
+        candidates.emplace_back("hevc_qsv");
+        candidates.emplace_back("libx265");
+    }
+#if defined(__APPLE__)
+    candidates.emplace_back("h264_videotoolbox");
+#endif
+    candidates.emplace_back("h264_nvenc");
+    candidates.emplace_back("h264_qsv");
+    candidates.emplace_back("libx264");
+    candidates.emplace_back("mpeg4");
+    return candidates;
+}
+
+// Mirrors appendEncoderParameters for the pipe.
+void configureEncoder(AVCodecContext* context, const std::string& name, const bool hevc, AVDictionary** options) {
+    if (name == "libx264" || name == "libx265") {
+        av_dict_set(options, "preset", "medium", 0);
+        av_dict_set(options, "crf", "18", 0);
+    } else if (name == "h264_videotoolbox" || name == "hevc_videotoolbox") {
+        const int64_t rate = name == "hevc_videotoolbox" ? 20000000 : 12000000;
+        context->bit_rate = rate;
+        context->rc_max_rate = rate;
+        context->rc_buffer_size = static_cast<int>(rate * 2);
+        av_dict_set(options, "allow_sw", "1", 0);
+    } else if (name == "h264_nvenc" || name == "hevc_nvenc") {
+        context->bit_rate = 0;
+        av_dict_set(options, "preset", "p5", 0);
+        av_dict_set(options, "rc", "vbr", 0);
+        av_dict_set(options, "cq", hevc ? "20" : "19", 0);
+    } else if (name == "h264_qsv" || name == "hevc_qsv") {
+        context->global_quality = 20;
+    } else {
+        context->flags |= AV_CODEC_FLAG_QSCALE;
+        context->global_quality = FF_QP2LAMBDA * 3;
+    }
+}
+
+template <typename Word>
+void fillPlane(AVFrame* frame, const int plane, const int rows, const std::vector<uint16_t>& row, const int shift) {
+    Word* first = reinterpret_cast<Word*>(frame->data[plane]);
+    for (size_t i = 0; i < row.size(); ++i) {
+        first[i] = static_cast<Word>(row[i] << shift);
+    }
+    const size_t rowBytes = row.size() * sizeof(Word);
+    for (int y = 1; y < rows; ++y) {
+        std::memcpy(frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane], first, rowBytes);
+    }
+}
+
+}
+
+struct LibavMP4Writer::State {
+    ~State() {
+        av_packet_free(&packet);
+        av_packet_free(&audioPacket);
+        av_frame_free(&frame);
+        av_frame_free(&decoded);
+        av_frame_free(&converted);
+        av_frame_free(&audioFrame);
+        av_audio_fifo_free(fifo);
+        swr_free(&resampler);
+        avcodec_free_context(&video);
+        avcodec_free_context(&audio);
+        avcodec_free_context(&audioDecoder);
+        avformat_close_input(&audioInput);
+        if (output != nullptr) {
+            if (!(output->oformat->flags & AVFMT_NOFILE)) {
+                avio_closep(&output->pb);
+            }
+            avformat_free_context(output);
+        }
+    }
+
+    bool encode(AVCodecContext* context, AVStream* stream, const AVFrame* input, std::string& errorMessage);
+    bool fillFrame(const std::vector<RGBWords>& columns, std::string& errorMessage);
+    bool readAudio(std::string& errorMessage);
+    bool pumpAudio(double untilSeconds, std::string& errorMessage);
+
+    AVFormatContext* output = nullptr;
+    AVPacket* packet = nullptr;
+
+    AVCodecContext* video = nullptr;
+    AVStream* videoStream = nullptr;
+    AVFrame* frame = nullptr;
+    PixelLayout layout = PixelLayout::Planar8;
+    int64_t nextVideoPts = 0;
+    std::vector<RGBWords> lastColumns;
+    MatrixWeights weights;
+    YCbCrRow row;
+
+    AVFormatContext* audioInput = nullptr;
+    AVCodecContext* audioDecoder = nullptr;
+    int audioStreamIndex = -1;
+    AVPacket* audioPacket = nullptr;
+    AVFrame* decoded = nullptr;
+    AVFrame* converted = nullptr;
+    SwrContext* resampler = nullptr;
+    AVAudioFifo* fifo = nullptr;
+    AVCodecContext* audio = nullptr;
+    AVStream* audioStream = nullptr;
+    AVFrame* audioFrame = nullptr;
+    int64_t nextAudioPts = 0;
+    bool audioInputDone = false;
+};
+
+LibavMP4Writer::LibavMP4Writer() = default;
+LibavMP4Writer::~LibavMP4Writer() = default;
+
+bool LibavMP4Writer::isAvailable() {
+    return true;
+}
+
+bool LibavMP4Writer::open(const std::string& outputPath,
+                          const std::string& audioPath,
+                          const int width,
+                          const int height,
+                          const int fps,
+                          const ColourCore::ColourSpace colourSpace,
+                          std::string& errorMessage) {
+    state = std::make_unique<State>();
+    encoder.clear();
+    State& s = *state;
+
+    int result = avformat_alloc_output_context2(&s.output, nullptr, "mp4", outputPath.c_str());
+    if (result < 0 || s.output == nullptr) {
+        errorMessage = "Unable to create MP4 output: " + describe(result);
+        return false;
+    }
+    s.packet = av_packet_alloc();
+    s.audioPacket = av_packet_alloc();
+    s.decoded = av_frame_alloc();
+    s.converted = av_frame_alloc();
+    s.audioFrame = av_frame_alloc();
+    s.frame = av_frame_alloc();
+    if (!s.packet || !s.audioPacket || !s.decoded || !s.converted || !s.audioFrame || !s.frame) {
+        errorMessage = "Out of memory preparing video export";
+        return false;
+    }
+    const bool globalHeader = (s.output->oformat->flags & AVFMT_GLOBALHEADER) != 0;
+
+    // Video: the first candidate that opens wins.
+    const auto& profile = ColourCore::videoProfileFor(colourSpace);
+    const bool tenBit = std::string_view(profile.pixelFormat) == "yuv420p10le";
+    std::string lastFailure = "no usable video encoder is built in";
+    for (const std::string& name : videoEncoderCandidates(tenBit)) {
+        const AVCodec* codec = avcodec_find_encoder_by_name(name.c_str());
+        LayoutFormat layout{};
+        if (codec == nullptr || !chooseLayout(codec, tenBit, layout)) {
+            continue;
+        }
+
+        AVCodecContext* context = avcodec_alloc_context3(codec);
+        if (context == nullptr) {
+            continue;
+        }
+        context->width = width;
+        context->height = height;
+        context->time_base = AVRational{1, fps};
+        context->framerate = AVRational{fps, 1};
+        context->pix_fmt = layout.format;
+        context->color_range = AVCOL_RANGE_MPEG;
+        if (const int primaries = av_color_primaries_from_name(profile.primaries); primaries >= 0) {
+            context->color_primaries = static_cast<AVColorPrimaries>(primaries);
+        }
+        if (const int transfer = av_color_transfer_from_name(profile.transfer); transfer >= 0) {
+            context->color_trc = static_cast<AVColorTransferCharacteristic>(transfer);
+        }
+        if (const int space = av_color_space_from_name(profile.colourSpace); space >= 0) {
+            context->colorspace = static_cast<AVColorSpace>(space);
+        }
+        if (globalHeader) {
+            context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+
+        AVDictionary* options = nullptr;
+        configureEncoder(context, name, tenBit, &options);
+        result = avcodec_open2(context, codec, &options);
+        av_dict_free(&options);
+        if (result < 0) {
+            lastFailure = name + ": " + describe(result);
+            avcodec_free_context(&context);
+            continue;
+        }
+
+        s.video = context;
+        s.weights = matrixWeightsFor(profile.colourSpace);
+        s.layout = layout.layout;
+        encoder = name;
+        break;
+    }
+    if (s.video == nullptr) {
+        errorMessage = "Unable to open a video encoder (" + lastFailure + ")";
+        return false;
+    }
+
+    s.videoStream = avformat_new_stream(s.output, nullptr);
+    if (s.videoStream == nullptr || avcodec_parameters_from_context(s.videoStream->codecpar, s.video) < 0) {
+        errorMessage = "Unable to add the video stream";
+        return false;
+    }
+    s.videoStream->time_base = s.video->time_base;
+    s.videoStream->avg_frame_rate = s.video->framerate;
+
+    s.frame->format = s.video->pix_fmt;
+    s.frame->width = width;
+    s.frame->height = height;
+    if ((result = av_frame_get_buffer(s.frame, 0)) < 0) {
+        errorMessage = "Unable to allocate a video frame: " + describe(result);
+        return false;
+    }
+
+    // Audio: decode the reconstructed WAV and re-encode it as AAC.
+    if ((result = avformat_open_input(&s.audioInput, audioPath.c_str(), nullptr, nullptr)) < 0 ||
+        (result = avformat_find_stream_info(s.audioInput, nullptr)) < 0) {
+        errorMessage = "Unable to read the reconstructed audio: " + describe(result);
+        return false;
+    }
+    const AVCodec* decoderCodec = nullptr;
+    s.audioStreamIndex = av_find_best_stream(s.audioInput, AVMEDIA_TYPE_AUDIO, -1, -1, &decoderCodec, 0);
+    if (s.audioStreamIndex < 0 || decoderCodec == nullptr) {
+        errorMessage = "The reconstructed audio has no audio stream";
+        return false;
+    }
+    s.audioDecoder = avcodec_alloc_context3(decoderCodec);
+    if (s.audioDecoder == nullptr ||
+        avcodec_parameters_to_context(s.audioDecoder, s.audioInput->streams[s.audioStreamIndex]->codecpar) < 0 ||
+        (result = avcodec_open2(s.audioDecoder, decoderCodec, nullptr)) < 0) {
+        errorMessage = "Unable to decode the reconstructed audio: " + describe(result);
+        return false;
+    }
+    if (s.audioDecoder->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC) {
+        const int channels = s.audioDecoder->ch_layout.nb_channels;
+        av_channel_layout_uninit(&s.audioDecoder->ch_layout);
+        av_channel_layout_default(&s.audioDecoder->ch_layout, channels);
+    }
+
+    const AVCodec* aac = avcodec_find_encoder(AV_CODEC_ID_AAC);
+    s.audio = aac != nullptr ? avcodec_alloc_context3(aac) : nullptr;
+    if (s.audio == nullptr) {
+        errorMessage = "No AAC encoder is built in";
+        return false;
+    }
+    // Like the ffmpeg CLI, fall back to the nearest rate the encoder supports.
+    int sampleRate = s.audioDecoder->sample_rate;
+    if (aac->supported_samplerates != nullptr) {
+        int nearest = aac->supported_samplerates[0];
+        for (const int* rate = aac->supported_samplerates; *rate != 0; ++rate) {
+            if (std::abs(*rate - sampleRate) < std::abs(nearest - sampleRate)) {
+                nearest = *rate;
+            }
+        }
+        sampleRate = nearest;
+    }
+    s.audio->sample_fmt = AV_SAMPLE_FMT_FLTP;
+    s.audio->sample_rate = sampleRate;
+    s.audio->bit_rate = kAudioBitRate;
+    s.audio->time_base = AVRational{1, sampleRate};
+    av_channel_layout_copy(&s.audio->ch_layout, &s.audioDecoder->ch_layout);
+    if (globalHeader) {
+        s.audio->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if ((result = avcodec_open2(s.audio, aac, nullptr)) < 0) {
+        errorMessage = "Unable to open the AAC encoder: " + describe(result);
+        return false;
+    }
+
+    s.audioStream = avformat_new_stream(s.output, nullptr);
+    if (s.audioStream == nullptr || avcodec_parameters_from_context(s.audioStream->codecpar, s.audio) < 0) {
+        errorMessage = "Unable to add the audio stream";
+        return false;
+    }
+    s.audioStream->time_base = s.audio->time_base;
+
+    if (swr_alloc_set_opts2(&s.resampler,
+                            &s.audio->ch_layout, s.audio->sample_fmt, s.audio->sample_rate,
+                            &s.audioDecoder->ch_layout, s.audioDecoder->sample_fmt, s.audioDecoder->sample_rate,
+                            0, nullptr) < 0 ||
+        swr_init(s.resampler) < 0) {
+        errorMessage = "Unable to convert the reconstructed audio for AAC";
+        return false;
+    }
+    const int frameSize = s.audio->frame_size > 0 ? s.audio->frame_size : 1024;
+    s.fifo = av_audio_fifo_alloc(s.audio->sample_fmt, s.audio->ch_layout.nb_channels, frameSize);
+    if (s.fifo == nullptr) {
+        errorMessage = "Out of memory preparing audio export";
+        return false;
+    }
+
+    if (!(s.output->oformat->flags & AVFMT_NOFILE) &&
+        (result = avio_open(&s.output->pb, outputPath.c_str(), AVIO_FLAG_WRITE)) < 0) {
+        errorMessage = "Unable to open " + outputPath + ": " + describe(result);
+        return false;
+    }
+    s.output->avoid_negative_ts = AVFMT_AVOID_NEG_TS_MAKE_ZERO;
+    AVDictionary* muxerOptions = nullptr;
+    av_dict_set(&muxerOptions, "movflags", "+faststart", 0);
+    result = avformat_write_header(s.output, &muxerOptions);
+    av_dict_free(&muxerOptions);
+    if (result < 0) {
+        errorMessage = "Unable to write the MP4 header: " + describe(result);
+        return false;
+    }
+    return true;
+}
+
+bool LibavMP4Writer::writeFrame(const std::vector<RGBWords>& columns, std::string& errorMessage) {
+    if (!state || state->video == nullptr) {
+        errorMessage = "Video encoder is not open";
+        return false;
+    }
+    State& s = *state;
+
+    // An unchanged frame goes back in as it is; the encoder takes its own reference.
+    if (columns != s.lastColumns) {
+        const int result = av_frame_make_writable(s.frame);
+        if (result < 0) {
+            errorMessage = "Unable to reuse the video frame: " + describe(result);
+            return false;
+        }
+        if (!s.fillFrame(columns, errorMessage)) {
+            return false;
+        }
+        s.lastColumns = columns;
+    }
+
+    s.frame->pts = s.nextVideoPts++;
+    if (!s.encode(s.video, s.videoStream, s.frame, errorMessage)) {
+        return false;
+    }
+    return s.pumpAudio(static_cast<double>(s.nextVideoPts) * av_q2d(s.video->time_base), errorMessage);
+}
+
+bool LibavMP4Writer::finish(std::string& errorMessage) {
+    if (!state || state->video == nullptr) {
+        errorMessage = "Video encoder is not open";
+        return false;
+    }
+    State& s = *state;
+
+    if (!s.pumpAudio(std::numeric_limits<double>::infinity(), errorMessage) ||
+        !s.encode(s.video, s.videoStream, nullptr, errorMessage) ||
+        !s.encode(s.audio, s.audioStream, nullptr, errorMessage)) {
+        return false;
+    }
+
+    const int result = av_write_trailer(s.output);
+    if (result < 0) {
+        errorMessage = "Unable to finalise the MP4: " + describe(result);
+        return false;
+    }
+    state.reset();
+    return true;
+}
+
+bool LibavMP4Writer::State::encode(AVCodecContext* context,
+                                   AVStream* stream,
+                                   const AVFrame* input,
+                                   std::string& errorMessage) {
+    int result = avcodec_send_frame(context, input);
+    if (result < 0) {
+        errorMessage = "Encoder rejected a frame: " + describe(result);
+        return false;
+    }
+
+    while (true) {
+        result = avcodec_receive_packet(context, packet);
+        if (result == AVERROR(EAGAIN) || result == AVERROR_EOF) {
+            return true;
+        }
+        if (result < 0) {
+            errorMessage = "Encoding failed: " + describe(result);
+            return false;
+        }
+
+        av_packet_rescale_ts(packet, context->time_base, stream->time_base);
+        packet->stream_index = stream->index;
+        result = av_interleaved_write_frame(output, packet);
+        if (result < 0) {
+            errorMessage = "Unable to write to the MP4: " + describe(result);
+            return false;
+        }
+    }
+}
+
+bool LibavMP4Writer::State::fillFrame(const std::vector<RGBWords>& columns, std::string& errorMessage) {
+    const int width = frame->width;
+    const int height = frame->height;
+    if (columns.empty() || (columns.size() != 1 && columns.size() != static_cast<size_t>(width))) {
+        errorMessage = "Frame colours do not match the video width";
+        return false;
+    }
+
+    const bool tenBit = layout == PixelLayout::Planar10 || layout == PixelLayout::SemiPlanar10;
+    convertRow(columns, static_cast<size_t>(width), weights, tenBit, row);
+    const size_t chromaWidth = row.cb.size();
+
+    const int chromaHeight = (height + 1) / 2;
+    switch (layout) {
+        case PixelLayout::Planar8:
+        case PixelLayout::Planar10: {
+            if (tenBit) {
+                fillPlane<uint16_t>(frame, 0, height, row.luma, 0);
+                fillPlane<uint16_t>(frame, 1, chromaHeight, row.cb, 0);
+                fillPlane<uint16_t>(frame, 2, chromaHeight, row.cr, 0);
+            } else {
+                fillPlane<uint8_t>(frame, 0, height, row.luma, 0);
+                fillPlane<uint8_t>(frame, 1, chromaHeight, row.cb, 0);
+                fillPlane<uint8_t>(frame, 2, chromaHeight, row.cr, 0);
+            }
+            break;
+        }
+        case PixelLayout::SemiPlanar8:
+        case PixelLayout::SemiPlanar10: {
+            std::vector<uint16_t> interleaved(chromaWidth * 2);
+            for (size_t x = 0; x < chromaWidth; ++x) {
+                interleaved[x * 2] = row.cb[x];
+                interleaved[x * 2 + 1] = row.cr[x];
+            }
+            // P010 keeps its ten bits at the top of each word.
+            if (tenBit) {
+                fillPlane<uint16_t>(frame, 0, height, row.luma, 6);
+                fillPlane<uint16_t>(frame, 1, chromaHeight, interleaved, 6);
+            } else {
+                fillPlane<uint8_t>(frame, 0, height, row.luma, 0);
+                fillPlane<uint8_t>(frame, 1, chromaHeight, interleaved, 0);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+bool LibavMP4Writer::State::readAudio(std::string& errorMessage) {
+    while (true) {
+        int result = av_read_frame(audioInput, audioPacket);
+        const bool endOfInput = result < 0;
+        if (!endOfInput && audioPacket->stream_index != audioStreamIndex) {
+            av_packet_unref(audioPacket);
+            continue;
+        }
+
+        result = avcodec_send_packet(audioDecoder, endOfInput ? nullptr : audioPacket);
+        av_packet_unref(audioPacket);
+        if (result < 0 && result != AVERROR_EOF) {
+            errorMessage = "Unable to decode the reconstructed audio: " + describe(result);
+            return false;
+        }
+
+        while ((result = avcodec_receive_frame(audioDecoder, decoded)) >= 0) {
+            av_frame_unref(converted);
+            converted->format = audio->sample_fmt;
+            converted->sample_rate = audio->sample_rate;
+            av_channel_layout_copy(&converted->ch_layout, &audio->ch_layout);
+            result = swr_convert_frame(resampler, converted, decoded);
+            av_frame_unref(decoded);
+            if (result < 0 ||
+                av_audio_fifo_write(fifo, reinterpret_cast<void**>(converted->data), converted->nb_samples) <
+                    converted->nb_samples) {
+                errorMessage = "Unable to convert the reconstructed audio";
+                return false;
+            }
+        }
+        if (result != AVERROR(EAGAIN) && result != AVERROR_EOF) {
+            errorMessage = "Unable to decode the reconstructed audio: " + describe(result);
+            return false;
+        }
+
+        if (endOfInput) {
+            // Whatever the resampler still holds.
+            av_frame_unref(converted);
+            converted->format = audio->sample_fmt;
+            converted->sample_rate = audio->sample_rate;
+            av_channel_layout_copy(&converted->ch_layout, &audio->ch_layout);
+            if (swr_convert_frame(resampler, converted, nullptr) >= 0 && converted->nb_samples > 0) {
+                av_audio_fifo_write(fifo, reinterpret_cast<void**>(converted->data), converted->nb_samples);
+            }
+            audioInputDone = true;
+        }
+        return true;
+    }
+}
+
+// Encodes audio up to the given time so it interleaves with the video rather than piling
+// up in the muxer; all of it once untilSeconds is infinite.
+bool LibavMP4Writer::State::pumpAudio(const double untilSeconds, std::string& errorMessage) {
+    const int frameSize = audio->frame_size > 0 ? audio->frame_size : 1024;
+    while (static_cast<double>(nextAudioPts) / static_cast<double>(audio->sample_rate) < untilSeconds) {
+        while (av_audio_fifo_size(fifo) < frameSize && !audioInputDone) {
+            if (!readAudio(errorMessage)) {
+                return false;
+            }
+        }
+
+        // Only the last frame may come up short.
+        const int count = std::min(frameSize, av_audio_fifo_size(fifo));
+        if (count == 0) {
+            return true;
+        }
+
+        av_frame_unref(audioFrame);
+        audioFrame->nb_samples = count;
+        audioFrame->format = audio->sample_fmt;
+        audioFrame->sample_rate = audio->sample_rate;
+        av_channel_layout_copy(&audioFrame->ch_layout, &audio->ch_layout);
+        if (av_frame_get_buffer(audioFrame, 0) < 0 ||
+            av_audio_fifo_read(fifo, reinterpret_cast<void**>(audioFrame->data), count) < count) {
+            errorMessage = "Unable to prepare an audio frame";
+            return false;
+        }
+        audioFrame->pts = nextAudioPts;
+        nextAudioPts += count;
+        if (!encode(audio, audioStream, audioFrame, errorMessage)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+#else
+
+namespace ReSyne::Encoding::Video {
+
+struct LibavMP4Writer::State {};
+
+LibavMP4Writer::LibavMP4Writer() = default;
+LibavMP4Writer::~LibavMP4Writer() = default;
+
+bool LibavMP4Writer::isAvailable() {
+    return false;
+}
+
+bool LibavMP4Writer::open(const std::string&,
+                          const std::string&,
+                          int,
+                          int,
+                          int,
+                          ColourCore::ColourSpace,
+                          std::string& errorMessage) {
+    errorMessage = "In-process video encoding is not built in";
+    return false;
+}
+
+bool LibavMP4Writer::writeFrame(const std::vector<RGBWords>&, std::string& errorMessage) {
+    errorMessage = "In-process video encoding is not built in";
+    return false;
+}
+
+bool LibavMP4Writer::finish(std::string& errorMessage) {
+    errorMessage = "In-process video encoding is not built in";
+    return false;
+}
+
+}
+
+#endif
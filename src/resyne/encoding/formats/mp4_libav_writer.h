@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "colour/colour_core.h"
+#include "resyne/encoding/formats/ycbcr_rows.h"
+
+namespace ReSyne::Encoding::Video {
+
+// Encodes video and muxes audio to MP4 in-process through the bundled libavformat and
+// libavcodec, without spawning ffmpeg or piping raw frames. Only built with
+// SYN_FFMPEG_LIBAV; otherwise isAvailable() is false and open() fails.
+//
+// Every frame is a set of column colours stretched down the full height, which covers
+// both solid and gradient exports. They are converted to Y'CbCr once per column and
+// written straight into the encoder's own pixel layout, and a frame whose columns match
+// the previous one is resubmitted without being redrawn.
+class LibavMP4Writer {
+public:
+    LibavMP4Writer();
+    ~LibavMP4Writer();
+
+    LibavMP4Writer(const LibavMP4Writer&) = delete;
+    LibavMP4Writer& operator=(const LibavMP4Writer&) = delete;
+
+    static bool isAvailable();
+
+    // Hardware encoders are tried before software ones for the colour space's codec, and
+    // RESYNE_FFMPEG_VIDEO_CODEC overrides the choice as it does for the ffmpeg pipe. The
+    // WAV at audioPath is re-encoded to AAC alongside the video.
+    bool open(const std::string& outputPath,
+              const std::string& audioPath,
+              int width,
+              int height,
+              int fps,
+              ColourCore::ColourSpace colourSpace,
+              std::string& errorMessage);
+
+    // One colour fills the frame; otherwise there must be one colour per column.
+    bool writeFrame(const std::vector<RGBWords>& columns, std::string& errorMessage);
+
+    // Drains both encoders and finalises the file.
+    bool finish(std::string& errorMessage);
+
+    // Name of the video encoder open() settled on.
+    const std::string& encoderName() const { return encoder; }
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+    std::string encoder;
+};
+
+}
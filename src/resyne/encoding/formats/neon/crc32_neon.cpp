@@ -0,0 +1,47 @@
+#include "crc32_neon.h"
+
+#ifdef __ARM_NEON
+
+#include <cstring>
+
+#include "utilities/cpu/cpu_features.h"
+
+// Built with the CRC extension enabled, so the instructions only run once the CPU is known to
+// have them.
+#if defined(__ARM_FEATURE_CRC32) || defined(_MSC_VER)
+#include <arm_acle.h>
+#endif
+
+namespace CRC32NEON {
+
+#if defined(__ARM_FEATURE_CRC32) || defined(_MSC_VER)
+
+std::size_t update(std::uint32_t& state, const std::uint8_t* data, const std::size_t size) {
+    if (!Utilities::CPU::hasARMCRC32()) {
+        return 0;
+    }
+    std::uint32_t crc = state;
+    std::size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data + offset, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+    state = crc;
+    return offset;
+}
+
+#else
+
+std::size_t update(std::uint32_t& state, const std::uint8_t* data, const std::size_t size) {
+    (void)state;
+    (void)data;
+    (void)size;
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <cstddef>
+#include <cstdint>
+
+namespace CRC32NEON {
+    // Runs whole 8-byte words through the ARMv8 CRC32 instructions into state (the CRC
+    // register before zlib's final inversion) and returns the number of bytes consumed,
+    // leaving the tail to the caller's table path. CPUs without them consume nothing.
+    std::size_t update(std::uint32_t& state, const std::uint8_t* data, std::size_t size);
+}
+
+#endif
@@ -0,0 +1,29 @@
+#include "half_float_neon.h"
+
+#ifdef __ARM_NEON
+
+namespace HalfFloatNEON {
+
+std::size_t fromFloats(const float* input, std::uint16_t* output, const std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const float16x4_t low = vcvt_f16_f32(vld1q_f32(input + i));
+        const float16x4_t high = vcvt_f16_f32(vld1q_f32(input + i + 4));
+        vst1q_u16(output + i, vcombine_u16(vreinterpret_u16_f16(low), vreinterpret_u16_f16(high)));
+    }
+    return i;
+}
+
+std::size_t toFloats(const std::uint16_t* input, float* output, const std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t halves = vld1q_u16(input + i);
+        vst1q_f32(output + i, vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(halves))));
+        vst1q_f32(output + i + 4, vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(halves))));
+    }
+    return i;
+}
+
+}
+
+#endif
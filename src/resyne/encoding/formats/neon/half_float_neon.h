@@ -0,0 +1,15 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace HalfFloatNEON {
+    // IEEE binary16 conversions, rounding to nearest even. Both return the number of values
+    // converted, leaving any tail shorter than one vector to the caller's scalar path.
+    std::size_t fromFloats(const float* input, std::uint16_t* output, std::size_t count);
+    std::size_t toFloats(const std::uint16_t* input, float* output, std::size_t count);
+}
+
+#endif
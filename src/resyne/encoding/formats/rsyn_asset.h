@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -37,6 +38,9 @@ struct RSYNPresentationSettings {
     std::string pipelineId = "synesthesia-rsyn-presentation-v1";
 };
 
+// Only analysis.r/g/b and smoothedDisplayRgb depend on the stored colour space and gamut
+// mapping. analysis.X/Y/Z and smoothedOklab do not, so a reader wanting another output
+// space reprojects from them instead of recomputing the track from SPEC.
 struct RSYNPresentationFrame {
     double timestamp = 0.0;
     ColourCore::FrameResult analysis{};
@@ -52,14 +56,62 @@ struct RSYNPresentationData {
     std::vector<RSYNPresentationFrame> frames;
 };
 
+// Low-resolution copy of the presentation track, so a timeline can be drawn before PRES has
+// been decoded. Level 0 has up to kPreviewColumns columns spread evenly over the frames,
+// each the mean of the frames' smoothed colours, and every further level halves the one
+// before down to a single column. displayRgb is in the stored colour space; Oklab lets a
+// reader reproject into another.
+struct RSYNPreviewColumn {
+    std::array<float, 3> oklab{};
+    std::array<float, 3> displayRgb{};
+};
+
+struct RSYNPreviewData {
+    static constexpr std::size_t kPreviewColumns = 4096;
+
+    ColourCore::ColourSpace colourSpace = ColourCore::ColourSpace::Rec2020;
+    bool applyGamutMapping = true;
+    double firstTimestamp = 0.0;
+    double lastTimestamp = 0.0;
+    std::vector<std::vector<RSYNPreviewColumn>> levels;
+
+    // The coarsest level with at least maxColumns columns, or level 0 if none has.
+    const std::vector<RSYNPreviewColumn>& levelFor(std::size_t maxColumns) const {
+        std::size_t level = 0;
+        while (level + 1 < levels.size() && levels[level + 1].size() >= maxColumns) {
+            ++level;
+        }
+        return levels[level];
+    }
+};
+
+// The file a track was imported from. A fresh import only records its path, size and CRC-32
+// and leaves it on disk until a save streams it into SRCE; bytes is filled when the source is
+// read back out of a .rsyn.
 struct RSYNSourceData {
     std::string filename;
     std::string extension;
     std::uint32_t crc32 = 0;
+    std::uint64_t size = 0;
+    std::string path;
     std::vector<std::uint8_t> bytes;
+
+    bool hasContent() const { return !bytes.empty() || (!path.empty() && size > 0); }
+};
+
+// Layout of frames inside SPEC blocks. Quantised16 stores log-magnitudes and phase deltas
+// against the expected per-bin advance as 16-bit codes. Half16 stores magnitudes and phases
+// as IEEE half floats, keeping frequencies at float32.
+enum class RSYNSpectralEncoding : std::uint32_t {
+    Float32 = 0,
+    Quantised16 = 1,
+    Half16 = 2
 };
 
 struct RSYNLazyAsset {
     std::string filepath;
     RSYNContainer::ChunkIndex chunkIndex;
+    // Zero for files written before SPEC was split into blocks.
+    std::uint32_t spectralBlockFrames = 0;
+    RSYNSpectralEncoding spectralEncoding = RSYNSpectralEncoding::Float32;
 };
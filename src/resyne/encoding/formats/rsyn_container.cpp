@@ -2,10 +2,14 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <limits>
+#include <span>
+#include <system_error>
 #include <utility>
 #include <vector>
 #include <type_traits>
@@ -13,13 +17,26 @@
 #include "miniz.h"
 #undef crc32
 
+#include "resyne/encoding/formats/crc32.h"
+#include "utilities/threading/task_scheduler.h"
+
 namespace RSYNContainer {
 
 namespace {
 
 constexpr std::array<char, 4> kMagic = {'R', 'S', 'Y', 'N'};
-constexpr std::uint32_t kVersion = 1;
+// Version 2 adds block tables; version 1 files are the same layout without any. Version 3
+// lets SPEC frames take their frequencies from the FAXS chunk, which version 2 readers would
+// silently drop, so they reject it instead.
+constexpr std::uint32_t kVersion = 3;
+constexpr std::uint64_t kTocEntrySize = 40;
+constexpr std::uint64_t kBlockEntrySize = 32;
 constexpr int kCompressionLevel = 6;
+// Bytes of a file-backed chunk read, compressed and written at a time.
+constexpr std::size_t kStreamedBlockSize = std::size_t{4} << 20;
+constexpr std::uint64_t kHeaderSize = 24;
+// Share of an appended-to file that may be superseded pieces before shouldCompact() says so.
+constexpr double kMaxDeadFraction = 0.5;
 
 struct Header {
     std::array<char, 4> magic{};
@@ -36,7 +53,7 @@ struct TocEntry {
     std::uint64_t storedSize = 0;
     std::uint64_t unpackedSize = 0;
     std::uint32_t crc32 = 0;
-    std::uint32_t reserved = 0;
+    std::uint32_t blockCount = 0;
 };
 
 template <typename T, bool IsEnum = std::is_enum_v<T>>
@@ -114,7 +131,7 @@ std::vector<std::uint8_t> encodeTocEntry(const TocEntry& entry) {
     appendLittleEndian(buffer, entry.storedSize);
     appendLittleEndian(buffer, entry.unpackedSize);
     appendLittleEndian(buffer, entry.crc32);
-    appendLittleEndian(buffer, entry.reserved);
+    appendLittleEndian(buffer, entry.blockCount);
     return buffer;
 }
 
@@ -125,25 +142,71 @@ bool decodeTocEntry(const std::vector<std::uint8_t>& buffer, std::size_t& offset
         readLittleEndian(buffer, offset, entry.storedSize) &&
         readLittleEndian(buffer, offset, entry.unpackedSize) &&
         readLittleEndian(buffer, offset, entry.crc32) &&
-        readLittleEndian(buffer, offset, entry.reserved);
+        readLittleEndian(buffer, offset, entry.blockCount);
+}
+
+void appendBlockEntry(std::vector<std::uint8_t>& buffer, const BlockLocator& block) {
+    appendLittleEndian(buffer, block.compression);
+    appendLittleEndian(buffer, block.crc32);
+    appendLittleEndian(buffer, block.offset);
+    appendLittleEndian(buffer, block.storedSize);
+    appendLittleEndian(buffer, block.unpackedSize);
+}
+
+bool decodeBlockEntry(const std::vector<std::uint8_t>& buffer, std::size_t& offset, BlockLocator& block) {
+    return readLittleEndian(buffer, offset, block.compression) &&
+        readLittleEndian(buffer, offset, block.crc32) &&
+        readLittleEndian(buffer, offset, block.offset) &&
+        readLittleEndian(buffer, offset, block.storedSize) &&
+        readLittleEndian(buffer, offset, block.unpackedSize);
 }
 
-std::uint32_t crc32For(const std::vector<std::uint8_t>& data) {
-    if (data.empty()) {
-        return 0;
+std::uint32_t crc32For(std::span<const std::uint8_t> data) {
+    return CRC32::compute(data);
+}
+
+constexpr std::size_t kShuffleLanes = 4;
+
+// Byte i of every lane goes to plane i; a tail shorter than one lane is copied as is.
+std::vector<std::uint8_t> shuffleBytes(const std::vector<std::uint8_t>& input) {
+    std::vector<std::uint8_t> output(input.size());
+    const std::size_t laneCount = input.size() / kShuffleLanes;
+    for (std::size_t lane = 0; lane < laneCount; ++lane) {
+        for (std::size_t plane = 0; plane < kShuffleLanes; ++plane) {
+            output[plane * laneCount + lane] = input[lane * kShuffleLanes + plane];
+        }
     }
-    return static_cast<std::uint32_t>(mz_crc32(MZ_CRC32_INIT, data.data(), data.size()));
+    std::copy(input.begin() + static_cast<std::ptrdiff_t>(laneCount * kShuffleLanes), input.end(),
+              output.begin() + static_cast<std::ptrdiff_t>(laneCount * kShuffleLanes));
+    return output;
 }
 
-bool compressPayload(const std::vector<std::uint8_t>& input,
+void unshuffleBytes(std::vector<std::uint8_t>& data) {
+    const std::vector<std::uint8_t> planes = data;
+    const std::size_t laneCount = data.size() / kShuffleLanes;
+    for (std::size_t lane = 0; lane < laneCount; ++lane) {
+        for (std::size_t plane = 0; plane < kShuffleLanes; ++plane) {
+            data[lane * kShuffleLanes + plane] = planes[plane * laneCount + lane];
+        }
+    }
+}
+
+bool compressPayload(const std::vector<std::uint8_t>& payload,
+                     const Compression preferred,
                      Compression& compression,
                      std::vector<std::uint8_t>& output) {
-    if (input.empty()) {
+    if (payload.empty() || preferred == Compression::None) {
         compression = Compression::None;
-        output.clear();
+        output = payload;
         return true;
     }
 
+    std::vector<std::uint8_t> shuffled;
+    if (preferred == Compression::ShuffledDeflate) {
+        shuffled = shuffleBytes(payload);
+    }
+    const std::vector<std::uint8_t>& input = shuffled.empty() ? payload : shuffled;
+
     mz_ulong bound = compressBound(static_cast<mz_ulong>(input.size()));
     if (bound == 0 || bound > static_cast<mz_ulong>(std::numeric_limits<std::size_t>::max())) {
         return false;
@@ -160,26 +223,26 @@ bool compressPayload(const std::vector<std::uint8_t>& input,
 
     if (result != MZ_OK || compressedSize >= input.size()) {
         compression = Compression::None;
-        output = input;
+        output = payload;
         return true;
     }
 
     compressed.resize(static_cast<std::size_t>(compressedSize));
-    compression = Compression::Deflate;
+    compression = shuffled.empty() ? Compression::Deflate : Compression::ShuffledDeflate;
     output = std::move(compressed);
     return true;
 }
 
 bool decompressPayload(const Compression compression,
-                       const std::vector<std::uint8_t>& input,
+                       std::span<const std::uint8_t> input,
                        const std::size_t expectedSize,
                        std::vector<std::uint8_t>& output) {
     if (compression == Compression::None) {
-        output = input;
+        output.assign(input.begin(), input.end());
         return true;
     }
 
-    if (compression != Compression::Deflate) {
+    if (compression != Compression::Deflate && compression != Compression::ShuffledDeflate) {
         return false;
     }
 
@@ -193,6 +256,9 @@ bool decompressPayload(const Compression compression,
     if (result != MZ_OK || decodedSize != expectedSize) {
         return false;
     }
+    if (compression == Compression::ShuffledDeflate) {
+        unshuffleBytes(output);
+    }
     return true;
 }
 
@@ -217,113 +283,145 @@ std::vector<std::uint8_t> readBytes(std::ifstream& file, const std::uint64_t off
     return buffer;
 }
 
-void emitProgress(const std::function<void(float)>& progress, const float value) {
-    if (!progress) {
-        return;
+bool writeBytes(std::ofstream& file, const std::vector<std::uint8_t>& bytes) {
+    if (!bytes.empty()) {
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
     }
-    progress(std::clamp(value, 0.0f, 1.0f));
+    return file.good();
 }
 
+bool inflateStored(const Compression compression,
+                   std::span<const std::uint8_t> storedPayload,
+                   const std::uint64_t unpackedSize,
+                   const std::uint32_t crc32,
+                   std::vector<std::uint8_t>& payload) {
+    if (!decompressPayload(compression, storedPayload, static_cast<std::size_t>(unpackedSize), payload) ||
+        crc32For(payload) != crc32) {
+        payload.clear();
+        return false;
+    }
+    return true;
 }
 
-bool writeFile(const std::string& filepath,
-               const std::vector<Chunk>& chunks,
-               const std::function<void(float)>& progress) {
-    std::ofstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
+bool readStored(std::ifstream& file,
+                const std::uint64_t fileSize,
+                const Compression compression,
+                const std::uint64_t offset,
+                const std::uint64_t storedSize,
+                const std::uint64_t unpackedSize,
+                const std::uint32_t crc32,
+                std::vector<std::uint8_t>& payload) {
+    if (offset + storedSize > fileSize ||
+        unpackedSize > static_cast<std::uint64_t>(std::numeric_limits<std::size_t>::max())) {
         return false;
     }
 
-    Header header{};
-    header.magic = kMagic;
-    header.version = kVersion;
-
-    const auto encodedHeader = encodeHeader(header);
-    file.write(reinterpret_cast<const char*>(encodedHeader.data()), static_cast<std::streamsize>(encodedHeader.size()));
-    if (!file.good()) {
+    const std::vector<std::uint8_t> storedPayload = readBytes(file, offset, storedSize);
+    if (storedPayload.size() != storedSize) {
         return false;
     }
 
-    std::vector<TocEntry> tocEntries;
-    tocEntries.reserve(chunks.size());
+    return inflateStored(compression, storedPayload, unpackedSize, crc32, payload);
+}
 
-    for (std::size_t index = 0; index < chunks.size(); ++index) {
-        Compression compression = Compression::None;
-        std::vector<std::uint8_t> storedPayload;
-        if (!compressPayload(chunks[index].payload, compression, storedPayload)) {
-            return false;
-        }
+bool openForReading(const std::string& filepath, std::ifstream& file, std::uint64_t& fileSize) {
+    file.open(filepath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    fileSize = static_cast<std::uint64_t>(file.tellg());
+    return true;
+}
 
-        const std::uint64_t payloadOffset = static_cast<std::uint64_t>(file.tellp());
-        if (!storedPayload.empty()) {
-            file.write(reinterpret_cast<const char*>(storedPayload.data()), static_cast<std::streamsize>(storedPayload.size()));
-            if (!file.good()) {
-                return false;
+void emitProgress(const std::function<void(float)>& progress, const float value) {
+    if (!progress) {
+        return;
+    }
+    progress(std::clamp(value, 0.0f, 1.0f));
+}
+
+// Runs job(index) for every index on the shared scheduler, the caller helping. Jobs must
+// only touch their own slot; once one fails the rest are skipped.
+template <typename Job>
+bool runParallel(const std::size_t jobCount, const Job& job) {
+    std::atomic<bool> succeeded{true};
+    Utilities::Threading::TaskScheduler::shared().parallelFor(jobCount, 1, [&](const std::size_t first, const std::size_t end) {
+        for (std::size_t index = first; index < end && succeeded.load(std::memory_order_relaxed); ++index) {
+            if (!job(index)) {
+                succeeded.store(false, std::memory_order_relaxed);
             }
         }
+    });
+    return succeeded.load();
+}
 
-        TocEntry entry{};
-        entry.tag = chunks[index].tag;
-        entry.compression = static_cast<std::uint32_t>(compression);
-        entry.offset = payloadOffset;
-        entry.storedSize = storedPayload.size();
-        entry.unpackedSize = chunks[index].payload.size();
-        entry.crc32 = crc32For(chunks[index].payload);
-        tocEntries.push_back(entry);
-
-        emitProgress(progress, static_cast<float>(index + 1) / static_cast<float>(std::max<std::size_t>(1, chunks.size())) * 0.8f);
-    }
+struct StoredPiece {
+    Compression compression = Compression::None;
+    std::vector<std::uint8_t> bytes;
+    std::uint64_t unpackedSize = 0;
+    std::uint32_t crc32 = 0;
+    bool kept = false;
+};
 
-    header.tocOffset = static_cast<std::uint64_t>(file.tellp());
-    header.tocCount = static_cast<std::uint32_t>(tocEntries.size());
-    for (const TocEntry& entry : tocEntries) {
-        const auto encodedEntry = encodeTocEntry(entry);
-        file.write(reinterpret_cast<const char*>(encodedEntry.data()), static_cast<std::streamsize>(encodedEntry.size()));
-        if (!file.good()) {
+// Reads the stored bytes of each block in file order on this thread, then inflates them in
+// parallel; disk access stays sequential while deflate uses every core.
+bool readBlocksFrom(std::ifstream& file,
+                    const std::uint64_t fileSize,
+                    std::span<const BlockLocator> blocks,
+                    std::vector<std::vector<std::uint8_t>>& payloads) {
+    payloads.assign(blocks.size(), {});
+    std::vector<std::vector<std::uint8_t>> stored(blocks.size());
+    for (std::size_t index = 0; index < blocks.size(); ++index) {
+        const BlockLocator& block = blocks[index];
+        if (block.offset + block.storedSize > fileSize ||
+            block.unpackedSize > static_cast<std::uint64_t>(std::numeric_limits<std::size_t>::max())) {
+            return false;
+        }
+        stored[index] = readBytes(file, block.offset, block.storedSize);
+        if (stored[index].size() != block.storedSize) {
             return false;
         }
     }
 
-    file.seekp(0, std::ios::beg);
-    const auto finalHeader = encodeHeader(header);
-    file.write(reinterpret_cast<const char*>(finalHeader.data()), static_cast<std::streamsize>(finalHeader.size()));
-    if (!file.good()) {
-        return false;
+    const bool ok = runParallel(blocks.size(), [&](const std::size_t index) {
+        const bool inflated = inflateStored(blocks[index].compression, stored[index], blocks[index].unpackedSize,
+                                            blocks[index].crc32, payloads[index]);
+        std::vector<std::uint8_t>().swap(stored[index]);
+        return inflated;
+    });
+    if (!ok) {
+        payloads.clear();
     }
-
-    emitProgress(progress, 1.0f);
-    return true;
+    return ok;
 }
 
-bool readIndex(const std::string& filepath,
-               ChunkIndex& index,
-               const std::function<void(float)>& progress) {
+// Shared by the stream and mapped readers; readRange(offset, size) returns the bytes or an
+// empty vector past the end.
+template <typename ReadRange>
+bool parseIndex(const ReadRange& readRange,
+                const std::uint64_t fileSize,
+                ChunkIndex& index,
+                const std::function<void(float)>& progress) {
     index.clear();
-    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        return false;
-    }
-
-    const std::uint64_t fileSize = static_cast<std::uint64_t>(file.tellg());
-    file.seekg(0, std::ios::beg);
 
-    const std::vector<std::uint8_t> headerBytes = readBytes(file, 0, 24);
+    const std::vector<std::uint8_t> headerBytes = readRange(0, 24);
     Header header{};
     if (!decodeHeader(headerBytes, header) ||
         header.magic != kMagic ||
-        header.version != kVersion ||
+        header.version == 0 ||
+        header.version > kVersion ||
         header.tocOffset > fileSize) {
         return false;
     }
 
     emitProgress(progress, 0.1f);
 
-    const std::uint64_t tocByteCount = static_cast<std::uint64_t>(header.tocCount) * 40U;
+    const std::uint64_t tocByteCount = static_cast<std::uint64_t>(header.tocCount) * kTocEntrySize;
     if (header.tocOffset + tocByteCount > fileSize) {
         return false;
     }
 
-    const std::vector<std::uint8_t> tocBytes = readBytes(file, header.tocOffset, tocByteCount);
+    const std::vector<std::uint8_t> tocBytes = readRange(header.tocOffset, tocByteCount);
     if (tocBytes.size() != tocByteCount) {
         return false;
     }
@@ -343,45 +441,668 @@ bool readIndex(const std::string& filepath,
         locator.storedSize = entry.storedSize;
         locator.unpackedSize = entry.unpackedSize;
         locator.crc32 = entry.crc32;
-        index.emplace(locator.tag, locator);
+
+        if (entry.blockCount > 0) {
+            if (entry.compression != static_cast<std::uint32_t>(Compression::None) ||
+                entry.storedSize != static_cast<std::uint64_t>(entry.blockCount) * kBlockEntrySize) {
+                return false;
+            }
+
+            const std::vector<std::uint8_t> blockTable = readRange(entry.offset, entry.storedSize);
+            if (blockTable.size() != entry.storedSize || crc32For(blockTable) != entry.crc32) {
+                return false;
+            }
+
+            std::size_t blockOffset = 0;
+            std::uint64_t unpackedSize = 0;
+            locator.blocks.resize(entry.blockCount);
+            for (BlockLocator& block : locator.blocks) {
+                if (!decodeBlockEntry(blockTable, blockOffset, block) ||
+                    block.offset + block.storedSize > fileSize) {
+                    return false;
+                }
+                unpackedSize += block.unpackedSize;
+            }
+            if (unpackedSize != entry.unpackedSize) {
+                return false;
+            }
+        }
+
+        index.emplace(locator.tag, std::move(locator));
     }
 
     emitProgress(progress, 1.0f);
     return true;
 }
 
+// Copies chunk.sourcePath into file as blocks. A block table is written even for a single
+// block, so every reader sees an ordinary blocked chunk.
+bool writeStreamedChunk(std::ofstream& file, const Chunk& chunk, TocEntry& entry) {
+    std::ifstream source(chunk.sourcePath, std::ios::binary);
+    if (!source.is_open()) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> blockTable;
+    std::vector<std::uint8_t> input(kStreamedBlockSize);
+    std::vector<std::uint8_t> stored;
+    std::uint64_t unpackedSize = 0;
+    std::uint32_t sourceCrc = 0;
+    std::uint32_t blockCount = 0;
+    while (source) {
+        source.read(reinterpret_cast<char*>(input.data()), static_cast<std::streamsize>(input.size()));
+        const auto count = static_cast<std::size_t>(source.gcount());
+        if (count == 0) {
+            break;
+        }
+        input.resize(count);
+
+        BlockLocator locator{};
+        if (!compressPayload(input, chunk.compression, locator.compression, stored)) {
+            return false;
+        }
+        locator.offset = static_cast<std::uint64_t>(file.tellp());
+        locator.storedSize = stored.size();
+        locator.unpackedSize = count;
+        locator.crc32 = crc32For(input);
+        if (!writeBytes(file, stored)) {
+            return false;
+        }
+        appendBlockEntry(blockTable, locator);
+
+        // The whole-source CRC follows from the block's, without a second pass over the bytes.
+        sourceCrc = CRC32::combine(sourceCrc, locator.crc32, count);
+        unpackedSize += count;
+        ++blockCount;
+        input.resize(kStreamedBlockSize);
+    }
+    if (source.bad() || blockCount == 0 || unpackedSize != chunk.sourceSize ||
+        sourceCrc != chunk.sourceCrc32) {
+        return false;
+    }
+
+    entry.tag = chunk.tag;
+    entry.compression = static_cast<std::uint32_t>(Compression::None);
+    entry.offset = static_cast<std::uint64_t>(file.tellp());
+    entry.storedSize = blockTable.size();
+    entry.unpackedSize = unpackedSize;
+    entry.crc32 = crc32For(blockTable);
+    entry.blockCount = blockCount;
+    return writeBytes(file, blockTable);
+}
+
+void appendTocEntry(std::vector<std::uint8_t>& toc, const TocEntry& entry) {
+    const auto encodedEntry = encodeTocEntry(entry);
+    toc.insert(toc.end(), encodedEntry.begin(), encodedEntry.end());
+}
+
+TocEntry tocEntryFor(const ChunkLocator& locator) {
+    TocEntry entry{};
+    entry.tag = locator.tag;
+    entry.compression = static_cast<std::uint32_t>(locator.compression);
+    entry.offset = locator.offset;
+    entry.storedSize = locator.storedSize;
+    entry.unpackedSize = locator.unpackedSize;
+    entry.crc32 = locator.crc32;
+    entry.blockCount = static_cast<std::uint32_t>(locator.blocks.size());
+    return entry;
+}
+
+// Writes the index at the end and then points the header at it. Until the header lands the
+// file still reads as whatever it held before.
+bool writeIndexAndHeader(std::ofstream& file, const std::vector<std::uint8_t>& toc, const std::uint32_t tocCount) {
+    Header header{};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.tocOffset = static_cast<std::uint64_t>(file.tellp());
+    header.tocCount = tocCount;
+    if (!writeBytes(file, toc)) {
+        return false;
+    }
+    file.flush();
+    file.seekp(0, std::ios::beg);
+    return writeBytes(file, encodeHeader(header));
+}
+
+// Raw storage is what the codec falls back to when compressing does not help, so a piece
+// stored raw is what any requested compression could have produced.
+bool storedAs(const Compression stored, const Compression requested) {
+    return stored == Compression::None || stored == requested;
+}
+
+bool blockUnchanged(const BlockLocator& stored,
+                    const Compression requested,
+                    const std::uint64_t size,
+                    const std::uint32_t crc32) {
+    return stored.unpackedSize == size && stored.crc32 == crc32 && storedAs(stored.compression, requested);
+}
+
+// A payload may have been stored whole or, as a streamed source is, as blocks; either holds
+// the same bytes when the sizes and whole-payload CRCs agree.
+bool chunkUnchanged(const ChunkLocator& stored,
+                    const Compression requested,
+                    const std::uint64_t size,
+                    const std::uint32_t crc32) {
+    if (stored.blocks.empty()) {
+        return stored.unpackedSize == size && stored.crc32 == crc32 && storedAs(stored.compression, requested);
+    }
+    std::uint32_t combined = 0;
+    for (const BlockLocator& block : stored.blocks) {
+        if (!storedAs(block.compression, requested)) {
+            return false;
+        }
+        combined = CRC32::combine(combined, block.crc32, block.unpackedSize);
+    }
+    return stored.unpackedSize == size && combined == crc32;
+}
+
+// The header, the index and every piece it reaches; the rest of a file is superseded pieces
+// and indexes left by appending saves.
+std::uint64_t liveBytes(const ChunkIndex& index) {
+    std::uint64_t bytes = kHeaderSize + static_cast<std::uint64_t>(index.size()) * kTocEntrySize;
+    for (const auto& [tag, locator] : index) {
+        (void)tag;
+        bytes += locator.storedSize;
+        for (const BlockLocator& block : locator.blocks) {
+            bytes += block.storedSize;
+        }
+    }
+    return bytes;
+}
+
+bool copyStored(std::ifstream& source,
+                const std::uint64_t sourceSize,
+                const std::uint64_t offset,
+                const std::uint64_t size,
+                std::ofstream& output) {
+    if (offset + size > sourceSize) {
+        return false;
+    }
+    const std::vector<std::uint8_t> bytes = readBytes(source, offset, size);
+    return bytes.size() == size && writeBytes(output, bytes);
+}
+
+// writeFile hands a blocked chunk to the writer this many blocks at a time, reporting
+// progress between batches.
+constexpr std::size_t kWriteBatchBlocks = 32;
+
+}
+
+bool ContainerWriter::open(const std::string& filepath) {
+    path = filepath;
+    file.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return fail();
+    }
+
+    // The magic stays zeroed until finish() rewrites the header.
+    Header header{};
+    header.version = kVersion;
+    if (!writeBytes(file, encodeHeader(header))) {
+        return fail();
+    }
+    return true;
+}
+
+bool ContainerWriter::openForAppend(const std::string& filepath) {
+    ChunkIndex index;
+    std::error_code ec;
+    const std::uint64_t size = std::filesystem::file_size(filepath, ec);
+    if (ec || !readIndex(filepath, index)) {
+        return false;
+    }
+
+    file.open(filepath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekp(0, std::ios::end);
+    if (!file.good()) {
+        file.close();
+        return false;
+    }
+
+    path = filepath;
+    appending = true;
+    storedIndex = std::move(index);
+    storedSize = size;
+    return true;
+}
+
+bool ContainerWriter::keepStored(const std::uint32_t tag,
+                                 const Compression compression,
+                                 const std::uint64_t size,
+                                 const std::uint32_t crc32) {
+    if (!appending) {
+        return false;
+    }
+    const auto stored = storedIndex.find(tag);
+    if (stored == storedIndex.end() || !chunkUnchanged(stored->second, compression, size, crc32)) {
+        return false;
+    }
+    appendTocEntry(toc, tocEntryFor(stored->second));
+    ++tocCount;
+    return true;
+}
+
+bool ContainerWriter::addChunk(const Chunk& chunk) {
+    if (failed || writingBlocks || !file.is_open()) {
+        return fail();
+    }
+
+    if (!chunk.sourcePath.empty()) {
+        if (keepStored(chunk.tag, chunk.compression, chunk.sourceSize, chunk.sourceCrc32)) {
+            return true;
+        }
+        TocEntry entry{};
+        if (!writeStreamedChunk(file, chunk, entry)) {
+            return fail();
+        }
+        appendTocEntry(toc, entry);
+        ++tocCount;
+        return true;
+    }
+
+    if (!chunk.blocks.empty()) {
+        return beginBlocks(chunk.tag, chunk.compression) && addBlocks(chunk.blocks) && endBlocks();
+    }
+
+    const std::uint32_t payloadCrc = crc32For(chunk.payload);
+    if (keepStored(chunk.tag, chunk.compression, chunk.payload.size(), payloadCrc)) {
+        return true;
+    }
+
+    TocEntry entry{};
+    Compression compression = Compression::None;
+    std::vector<std::uint8_t> stored;
+    if (!compressPayload(chunk.payload, chunk.compression, compression, stored)) {
+        return fail();
+    }
+    entry.tag = chunk.tag;
+    entry.compression = static_cast<std::uint32_t>(compression);
+    entry.offset = static_cast<std::uint64_t>(file.tellp());
+    entry.storedSize = stored.size();
+    entry.unpackedSize = chunk.payload.size();
+    entry.crc32 = payloadCrc;
+    if (!writeBytes(file, stored)) {
+        return fail();
+    }
+    appendTocEntry(toc, entry);
+    ++tocCount;
+    return true;
+}
+
+bool ContainerWriter::beginBlocks(const std::uint32_t tag, const Compression compression) {
+    if (failed || writingBlocks || !file.is_open()) {
+        return fail();
+    }
+    writingBlocks = true;
+    blockTag = tag;
+    blockCompression = compression;
+    blockTable.clear();
+    blockUnpackedSize = 0;
+    blockCount = 0;
+    keptBlockCount = 0;
+    storedBlocks = nullptr;
+    if (appending) {
+        const auto stored = storedIndex.find(tag);
+        if (stored != storedIndex.end() && !stored->second.blocks.empty()) {
+            storedBlocks = &stored->second;
+        }
+    }
+    return true;
+}
+
+bool ContainerWriter::addBlocks(std::span<const std::vector<std::uint8_t>> blocks) {
+    if (failed || !writingBlocks) {
+        return fail();
+    }
+
+    // An appending writer checksums each block first and compresses only those that differ
+    // from the stored block in the same position.
+    std::vector<StoredPiece> pieces(blocks.size());
+    if (!runParallel(pieces.size(), [&](const std::size_t index) {
+            StoredPiece& piece = pieces[index];
+            piece.unpackedSize = blocks[index].size();
+            piece.crc32 = crc32For(blocks[index]);
+            const std::size_t position = blockCount + index;
+            if (storedBlocks != nullptr && position < storedBlocks->blocks.size() &&
+                blockUnchanged(storedBlocks->blocks[position], blockCompression, piece.unpackedSize, piece.crc32)) {
+                piece.kept = true;
+                return true;
+            }
+            return compressPayload(blocks[index], blockCompression, piece.compression, piece.bytes);
+        })) {
+        return fail();
+    }
+
+    for (StoredPiece& piece : pieces) {
+        BlockLocator locator{};
+        if (piece.kept) {
+            locator = storedBlocks->blocks[blockCount];
+            ++keptBlockCount;
+        } else {
+            locator.compression = piece.compression;
+            locator.offset = static_cast<std::uint64_t>(file.tellp());
+            locator.storedSize = piece.bytes.size();
+            locator.unpackedSize = piece.unpackedSize;
+            locator.crc32 = piece.crc32;
+            if (!writeBytes(file, piece.bytes)) {
+                return fail();
+            }
+            std::vector<std::uint8_t>().swap(piece.bytes);
+        }
+        appendBlockEntry(blockTable, locator);
+        blockUnpackedSize += locator.unpackedSize;
+        ++blockCount;
+    }
+    return true;
+}
+
+bool ContainerWriter::endBlocks() {
+    if (failed || !writingBlocks) {
+        return fail();
+    }
+    writingBlocks = false;
+
+    // A chunk that never received a block is left out rather than written with an empty table.
+    if (blockCount == 0) {
+        return true;
+    }
+    // When every block was kept, the stored table already lists them.
+    if (storedBlocks != nullptr && keptBlockCount == blockCount && blockCount == storedBlocks->blocks.size()) {
+        std::vector<std::uint8_t>().swap(blockTable);
+        appendTocEntry(toc, tocEntryFor(*storedBlocks));
+        ++tocCount;
+        return true;
+    }
+
+    TocEntry entry{};
+    entry.tag = blockTag;
+    entry.compression = static_cast<std::uint32_t>(Compression::None);
+    entry.offset = static_cast<std::uint64_t>(file.tellp());
+    entry.storedSize = blockTable.size();
+    entry.unpackedSize = blockUnpackedSize;
+    entry.crc32 = crc32For(blockTable);
+    entry.blockCount = blockCount;
+    if (!writeBytes(file, blockTable)) {
+        return fail();
+    }
+    std::vector<std::uint8_t>().swap(blockTable);
+    appendTocEntry(toc, entry);
+    ++tocCount;
+    return true;
+}
+
+bool ContainerWriter::finish() {
+    if (failed || writingBlocks || !file.is_open()) {
+        return fail();
+    }
+
+    if (!writeIndexAndHeader(file, toc, tocCount)) {
+        return fail();
+    }
+    file.close();
+    if (file.fail()) {
+        return fail();
+    }
+    return true;
+}
+
+void ContainerWriter::discard() {
+    fail();
+    if (path.empty()) {
+        return;
+    }
+    std::error_code ec;
+    if (appending) {
+        // The header still names the old index, so dropping the tail restores the file exactly.
+        std::filesystem::resize_file(path, storedSize, ec);
+    } else {
+        std::filesystem::remove(path, ec);
+    }
+}
+
+bool ContainerWriter::fail() {
+    failed = true;
+    writingBlocks = false;
+    if (file.is_open()) {
+        file.close();
+    }
+    return false;
+}
+
+bool writeFile(const std::string& filepath,
+               const std::vector<Chunk>& chunks,
+               const std::function<void(float)>& progress) {
+    ContainerWriter writer;
+    if (!writer.open(filepath)) {
+        return false;
+    }
+
+    // Progress follows the bytes handed over, which the spectral blocks dominate.
+    std::uint64_t totalBytes = 0;
+    for (const Chunk& chunk : chunks) {
+        totalBytes += chunk.sourcePath.empty() ? chunk.payload.size() : chunk.sourceSize;
+        for (const std::vector<std::uint8_t>& block : chunk.blocks) {
+            totalBytes += block.size();
+        }
+    }
+    std::uint64_t writtenBytes = 0;
+    const auto advance = [&](const std::uint64_t bytes) {
+        writtenBytes += bytes;
+        emitProgress(progress, static_cast<float>(writtenBytes) / static_cast<float>(std::max<std::uint64_t>(1, totalBytes)) * 0.95f);
+    };
+
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.sourcePath.empty() || chunk.blocks.empty()) {
+            if (!writer.addChunk(chunk)) {
+                return false;
+            }
+            advance(chunk.sourcePath.empty() ? chunk.payload.size() : chunk.sourceSize);
+            continue;
+        }
+
+        if (!writer.beginBlocks(chunk.tag, chunk.compression)) {
+            return false;
+        }
+        const std::span<const std::vector<std::uint8_t>> blocks(chunk.blocks);
+        for (std::size_t first = 0; first < blocks.size(); first += kWriteBatchBlocks) {
+            const auto batch = blocks.subspan(first, std::min(kWriteBatchBlocks, blocks.size() - first));
+            if (!writer.addBlocks(batch)) {
+                return false;
+            }
+            std::uint64_t batchBytes = 0;
+            for (const std::vector<std::uint8_t>& block : batch) {
+                batchBytes += block.size();
+            }
+            advance(batchBytes);
+        }
+        if (!writer.endBlocks()) {
+            return false;
+        }
+    }
+
+    if (!writer.finish()) {
+        return false;
+    }
+    emitProgress(progress, 1.0f);
+    return true;
+}
+
+bool shouldCompact(const std::string& filepath) {
+    ChunkIndex index;
+    std::error_code ec;
+    const std::uint64_t size = std::filesystem::file_size(filepath, ec);
+    if (ec || !readIndex(filepath, index)) {
+        return false;
+    }
+    const std::uint64_t live = std::min(size, liveBytes(index));
+    return static_cast<double>(size - live) > kMaxDeadFraction * static_cast<double>(size);
+}
+
+bool compact(const std::string& filepath) {
+    ChunkIndex index;
+    std::ifstream source;
+    std::uint64_t sourceSize = 0;
+    if (!readIndex(filepath, index) || !openForReading(filepath, source, sourceSize)) {
+        return false;
+    }
+
+    std::vector<const ChunkLocator*> ordered;
+    ordered.reserve(index.size());
+    for (const auto& [tag, locator] : index) {
+        (void)tag;
+        ordered.push_back(&locator);
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const ChunkLocator* left, const ChunkLocator* right) {
+        return left->offset < right->offset;
+    });
+
+    const std::string compactedPath = filepath + ".compact";
+    std::ofstream output(compactedPath, std::ios::binary | std::ios::trunc);
+    bool ok = output.is_open() && writeBytes(output, encodeHeader(Header{}));
+    std::vector<std::uint8_t> toc;
+    for (const ChunkLocator* locator : ordered) {
+        if (!ok) {
+            break;
+        }
+        TocEntry entry = tocEntryFor(*locator);
+        if (locator->blocks.empty()) {
+            entry.offset = static_cast<std::uint64_t>(output.tellp());
+            ok = copyStored(source, sourceSize, locator->offset, locator->storedSize, output);
+        } else {
+            std::vector<std::uint8_t> blockTable;
+            for (BlockLocator block : locator->blocks) {
+                const std::uint64_t storedOffset = block.offset;
+                block.offset = static_cast<std::uint64_t>(output.tellp());
+                ok = ok && copyStored(source, sourceSize, storedOffset, block.storedSize, output);
+                appendBlockEntry(blockTable, block);
+            }
+            entry.offset = static_cast<std::uint64_t>(output.tellp());
+            entry.storedSize = blockTable.size();
+            entry.crc32 = crc32For(blockTable);
+            ok = ok && writeBytes(output, blockTable);
+        }
+        appendTocEntry(toc, entry);
+    }
+    ok = ok && writeIndexAndHeader(output, toc, static_cast<std::uint32_t>(ordered.size()));
+    output.close();
+    source.close();
+
+    std::error_code ec;
+    if (ok && !output.fail()) {
+        std::filesystem::rename(compactedPath, filepath, ec);
+        if (!ec) {
+            return true;
+        }
+    }
+    std::filesystem::remove(compactedPath, ec);
+    return false;
+}
+
+bool readIndex(const std::string& filepath,
+               ChunkIndex& index,
+               const std::function<void(float)>& progress) {
+    index.clear();
+    std::ifstream file;
+    std::uint64_t fileSize = 0;
+    if (!openForReading(filepath, file, fileSize)) {
+        return false;
+    }
+
+    return parseIndex(
+        [&](const std::uint64_t offset, const std::uint64_t size) {
+            return readBytes(file, offset, size);
+        },
+        fileSize,
+        index,
+        progress);
+}
+
 bool readChunk(const std::string& filepath,
                const ChunkLocator& locator,
                std::vector<std::uint8_t>& payload) {
     payload.clear();
 
-    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
+    std::ifstream file;
+    std::uint64_t fileSize = 0;
+    if (!openForReading(filepath, file, fileSize)) {
         return false;
     }
 
-    const std::uint64_t fileSize = static_cast<std::uint64_t>(file.tellg());
-    if (locator.offset + locator.storedSize > fileSize ||
+    if (locator.blocks.empty()) {
+        return readStored(file, fileSize, locator.compression, locator.offset, locator.storedSize,
+                          locator.unpackedSize, locator.crc32, payload);
+    }
+
+    if (locator.unpackedSize > static_cast<std::uint64_t>(std::numeric_limits<std::size_t>::max())) {
+        return false;
+    }
+    std::vector<std::vector<std::uint8_t>> blockPayloads;
+    if (!readBlocksFrom(file, fileSize, locator.blocks, blockPayloads)) {
+        return false;
+    }
+
+    payload.reserve(static_cast<std::size_t>(locator.unpackedSize));
+    for (const std::vector<std::uint8_t>& blockPayload : blockPayloads) {
+        payload.insert(payload.end(), blockPayload.begin(), blockPayload.end());
+    }
+    return true;
+}
+
+bool packBlock(const std::vector<std::uint8_t>& payload,
+               const Compression compression,
+               std::vector<std::uint8_t>& stored,
+               BlockLocator& locator) {
+    locator = BlockLocator{};
+    if (!compressPayload(payload, compression, locator.compression, stored)) {
+        return false;
+    }
+    locator.storedSize = stored.size();
+    locator.unpackedSize = payload.size();
+    locator.crc32 = crc32For(payload);
+    return true;
+}
+
+bool unpackBlock(std::span<const std::uint8_t> stored,
+                 const BlockLocator& locator,
+                 std::vector<std::uint8_t>& payload) {
+    payload.clear();
+    if (stored.size() != locator.storedSize ||
         locator.unpackedSize > static_cast<std::uint64_t>(std::numeric_limits<std::size_t>::max())) {
         return false;
     }
+    return inflateStored(locator.compression, stored, locator.unpackedSize, locator.crc32, payload);
+}
+
+bool readBlock(const std::string& filepath,
+               const BlockLocator& locator,
+               std::vector<std::uint8_t>& payload) {
+    payload.clear();
 
-    const std::vector<std::uint8_t> storedPayload = readBytes(file, locator.offset, locator.storedSize);
-    if (storedPayload.size() != locator.storedSize) {
+    std::ifstream file;
+    std::uint64_t fileSize = 0;
+    if (!openForReading(filepath, file, fileSize)) {
         return false;
     }
 
-    if (!decompressPayload(
-            locator.compression,
-            storedPayload,
-            static_cast<std::size_t>(locator.unpackedSize),
-            payload) ||
-        crc32For(payload) != locator.crc32) {
-        payload.clear();
+    return readStored(file, fileSize, locator.compression, locator.offset, locator.storedSize,
+                      locator.unpackedSize, locator.crc32, payload);
+}
+
+bool readBlocks(const std::string& filepath,
+                std::span<const BlockLocator> blocks,
+                std::vector<std::vector<std::uint8_t>>& payloads) {
+    payloads.clear();
+
+    std::ifstream file;
+    std::uint64_t fileSize = 0;
+    if (!openForReading(filepath, file, fileSize)) {
         return false;
     }
 
-    return true;
+    return readBlocksFrom(file, fileSize, blocks, payloads);
 }
 
 bool readFile(const std::string& filepath,
@@ -412,17 +1133,137 @@ bool readFile(const std::string& filepath,
             return left.offset < right.offset;
         });
 
+    // Plain chunks and blocks alike become pieces, so a blocked SPEC inflates on every core
+    // while small chunks ride along.
+    std::vector<BlockLocator> pieces;
+    std::vector<std::size_t> pieceOwners;
     for (std::size_t chunkIndex = 0; chunkIndex < orderedLocators.size(); ++chunkIndex) {
-        std::vector<std::uint8_t> payload;
-        if (!readChunk(filepath, orderedLocators[chunkIndex], payload)) {
+        const ChunkLocator& locator = orderedLocators[chunkIndex];
+        if (locator.blocks.empty()) {
+            pieces.push_back({locator.compression, locator.offset, locator.storedSize, locator.unpackedSize, locator.crc32});
+            pieceOwners.push_back(chunkIndex);
+        }
+        for (const BlockLocator& block : locator.blocks) {
+            pieces.push_back(block);
+            pieceOwners.push_back(chunkIndex);
+        }
+    }
+
+    std::ifstream file;
+    std::uint64_t fileSize = 0;
+    std::vector<std::vector<std::uint8_t>> payloads;
+    if (!openForReading(filepath, file, fileSize) ||
+        !readBlocksFrom(file, fileSize, pieces, payloads)) {
+        return false;
+    }
+
+    emitProgress(progress, 0.9f);
+
+    for (std::size_t pieceIndex = 0; pieceIndex < pieces.size(); ++pieceIndex) {
+        std::vector<std::uint8_t>& payload = chunks[orderedLocators[pieceOwners[pieceIndex]].tag];
+        if (payload.empty()) {
+            payload = std::move(payloads[pieceIndex]);
+        } else {
+            payload.insert(payload.end(), payloads[pieceIndex].begin(), payloads[pieceIndex].end());
+        }
+    }
+    for (const ChunkLocator& locator : orderedLocators) {
+        chunks.try_emplace(locator.tag);
+    }
+
+    emitProgress(progress, 1.0f);
+    return true;
+}
+
+bool MappedView::open(const std::string& filepath, const std::function<void(float)>& progress) {
+    chunkIndex.clear();
+    std::string error;
+    if (!mapping.open(filepath, error)) {
+        return false;
+    }
+
+    const std::uint64_t fileSize = mapping.size();
+    if (!parseIndex(
+            [&](const std::uint64_t offset, const std::uint64_t size) {
+                std::span<const std::uint8_t> bytes;
+                return stored(offset, size, bytes)
+                    ? std::vector<std::uint8_t>(bytes.begin(), bytes.end())
+                    : std::vector<std::uint8_t>{};
+            },
+            fileSize,
+            chunkIndex,
+            progress)) {
+        mapping.close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedView::stored(const std::uint64_t offset,
+                        const std::uint64_t size,
+                        std::span<const std::uint8_t>& bytes) const {
+    if (!mapping.isOpen() || offset > mapping.size() || size > mapping.size() - offset) {
+        return false;
+    }
+    bytes = std::span<const std::uint8_t>(mapping.data() + offset, static_cast<std::size_t>(size));
+    return true;
+}
+
+bool MappedView::access(const BlockLocator& locator,
+                        std::vector<std::uint8_t>& scratch,
+                        std::span<const std::uint8_t>& bytes) const {
+    std::span<const std::uint8_t> storedBytes;
+    if (!stored(locator.offset, locator.storedSize, storedBytes)) {
+        return false;
+    }
+
+    if (locator.compression == Compression::None) {
+        if (locator.storedSize != locator.unpackedSize || crc32For(storedBytes) != locator.crc32) {
             return false;
         }
+        bytes = storedBytes;
+        return true;
+    }
 
-        chunks.emplace(orderedLocators[chunkIndex].tag, std::move(payload));
-        emitProgress(progress, 0.1f + 0.9f * (static_cast<float>(chunkIndex + 1) / static_cast<float>(std::max<std::size_t>(1, orderedLocators.size()))));
+    if (!inflateStored(locator.compression, storedBytes, locator.unpackedSize, locator.crc32, scratch)) {
+        return false;
+    }
+    bytes = scratch;
+    return true;
+}
+
+bool MappedView::access(const ChunkLocator& locator,
+                        std::vector<std::uint8_t>& scratch,
+                        std::span<const std::uint8_t>& bytes) const {
+    if (locator.blocks.empty()) {
+        return access(BlockLocator{locator.compression, locator.offset, locator.storedSize,
+                                   locator.unpackedSize, locator.crc32},
+                      scratch, bytes);
     }
 
+    std::vector<std::vector<std::uint8_t>> blockScratch;
+    std::vector<std::span<const std::uint8_t>> blockBytes;
+    if (!accessBlocks(locator.blocks, blockScratch, blockBytes)) {
+        return false;
+    }
+
+    scratch.clear();
+    scratch.reserve(static_cast<std::size_t>(locator.unpackedSize));
+    for (const std::span<const std::uint8_t> block : blockBytes) {
+        scratch.insert(scratch.end(), block.begin(), block.end());
+    }
+    bytes = scratch;
     return true;
 }
 
+bool MappedView::accessBlocks(std::span<const BlockLocator> blocks,
+                              std::vector<std::vector<std::uint8_t>>& scratch,
+                              std::vector<std::span<const std::uint8_t>>& bytes) const {
+    scratch.assign(blocks.size(), {});
+    bytes.assign(blocks.size(), {});
+    return runParallel(blocks.size(), [&](const std::size_t index) {
+        return access(blocks[index], scratch[index], bytes[index]);
+    });
+}
+
 }
@@ -1,21 +1,47 @@
 #pragma once
 
 #include <cstdint>
+#include <fstream>
 #include <functional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "resyne/decoding/mapped_file.h"
+
 namespace RSYNContainer {
 
+// ShuffledDeflate splits the payload's 4-byte lanes into byte planes before deflating, which
+// groups the slowly varying exponent and high bytes of float32 or uint16 arrays together.
 enum class Compression : std::uint32_t {
     None = 0,
-    Deflate = 1
+    Deflate = 1,
+    ShuffledDeflate = 2
 };
 
+// A chunk with blocks is stored as independently compressed pieces plus a block table, so
+// readers can inflate any block on its own. Its payload is the blocks' concatenation.
 struct Chunk {
     std::uint32_t tag = 0;
     std::vector<std::uint8_t> payload;
+    std::vector<std::vector<std::uint8_t>> blocks;
+    // Codec tried for the payload and every block; stored raw when it does not help.
+    Compression compression = Compression::Deflate;
+    // When set, the payload is this file instead. It is read and written as blocks one at a
+    // time, so it is never held whole, and the write fails unless it still has sourceSize
+    // bytes with CRC-32 sourceCrc32.
+    std::string sourcePath{};
+    std::uint64_t sourceSize = 0;
+    std::uint32_t sourceCrc32 = 0;
+};
+
+struct BlockLocator {
+    Compression compression = Compression::None;
+    std::uint64_t offset = 0;
+    std::uint64_t storedSize = 0;
+    std::uint64_t unpackedSize = 0;
+    std::uint32_t crc32 = 0;
 };
 
 struct ChunkLocator {
@@ -25,6 +51,7 @@ struct ChunkLocator {
     std::uint64_t storedSize = 0;
     std::uint64_t unpackedSize = 0;
     std::uint32_t crc32 = 0;
+    std::vector<BlockLocator> blocks;
 };
 
 using ChunkMap = std::unordered_map<std::uint32_t, std::vector<std::uint8_t>>;
@@ -37,10 +64,80 @@ constexpr std::uint32_t makeTag(const char (&text)[5]) {
         (static_cast<std::uint32_t>(static_cast<std::uint8_t>(text[3])) << 24U);
 }
 
+// Writes a container a chunk at a time, so callers can hand over each chunk, or each batch of
+// a chunk's blocks, as it is produced rather than holding every payload until the end. Each
+// piece is compressed and written on arrival; finish() writes the index and then the header,
+// so a file left by a writer that never finished is not a valid container.
+class ContainerWriter {
+public:
+    ContainerWriter() = default;
+
+    ContainerWriter(const ContainerWriter&) = delete;
+    ContainerWriter& operator=(const ContainerWriter&) = delete;
+
+    bool open(const std::string& filepath);
+    // Reopens an existing container so that a save writes only what changed. A chunk or block
+    // whose bytes match, by size and CRC-32, the one stored under the same tag and position
+    // keeps its stored piece; the rest are appended, and finish() appends a new index and
+    // repoints the header at it. Nothing stored is overwritten, so locators read before the
+    // save stay valid and a save that stops before finish() leaves the old container intact.
+    // The superseded pieces stay until compact() is run. Fails, leaving the writer unopened,
+    // when the file is not a readable container.
+    bool openForAppend(const std::string& filepath);
+
+    // Writes a whole chunk of any kind: a payload, its blocks or its sourcePath.
+    bool addChunk(const Chunk& chunk);
+
+    // Writes a blocked chunk incrementally. Each addBlocks batch is compressed in parallel
+    // and written in order, so only one batch of stored bytes is held at a time.
+    bool beginBlocks(std::uint32_t tag, Compression compression);
+    bool addBlocks(std::span<const std::vector<std::uint8_t>> blocks);
+    bool endBlocks();
+
+    bool finish();
+    // Closes and removes an unfinished file, as when the export it belongs to is cancelled.
+    // An appending writer instead cuts the file back to what it held before.
+    void discard();
+
+private:
+    bool fail();
+    bool keepStored(std::uint32_t tag, Compression compression, std::uint64_t size, std::uint32_t crc32);
+
+    std::string path;
+    std::ofstream file;
+    std::vector<std::uint8_t> toc;
+    std::uint32_t tocCount = 0;
+    bool failed = false;
+
+    // The blocked chunk between beginBlocks and endBlocks
+    bool writingBlocks = false;
+    std::uint32_t blockTag = 0;
+    Compression blockCompression = Compression::None;
+    std::vector<std::uint8_t> blockTable;
+    std::uint64_t blockUnpackedSize = 0;
+    std::uint32_t blockCount = 0;
+
+    // What an appending writer's file held when opened, and the stored version of the
+    // blocked chunk in progress
+    bool appending = false;
+    ChunkIndex storedIndex;
+    std::uint64_t storedSize = 0;
+    const ChunkLocator* storedBlocks = nullptr;
+    std::uint32_t keptBlockCount = 0;
+};
+
 bool writeFile(const std::string& filepath,
                const std::vector<Chunk>& chunks,
                const std::function<void(float)>& progress = {});
 
+// Whether superseded pieces left by appending saves are over half of filepath.
+bool shouldCompact(const std::string& filepath);
+
+// Rewrites filepath with only the pieces its index reaches, copying their stored bytes as
+// they are, and replaces it once the copy is complete. Every piece moves, so locators read
+// before it are stale, and it fails on Windows while the file is mapped.
+bool compact(const std::string& filepath);
+
 bool readIndex(const std::string& filepath,
                ChunkIndex& index,
                const std::function<void(float)>& progress = {});
@@ -49,8 +146,57 @@ bool readChunk(const std::string& filepath,
                const ChunkLocator& locator,
                std::vector<std::uint8_t>& payload);
 
+// Compresses one block as writeFile would and fills in its locator apart from the offset,
+// so blocks appended to a file of the caller's own can be read back with readBlock.
+bool packBlock(const std::vector<std::uint8_t>& payload,
+               Compression compression,
+               std::vector<std::uint8_t>& stored,
+               BlockLocator& locator);
+
+// Reverses packBlock for a block the caller keeps in memory rather than in a file.
+bool unpackBlock(std::span<const std::uint8_t> stored,
+                 const BlockLocator& locator,
+                 std::vector<std::uint8_t>& payload);
+
+bool readBlock(const std::string& filepath,
+               const BlockLocator& locator,
+               std::vector<std::uint8_t>& payload);
+
+// Inflates several blocks in parallel; payloads[i] matches blocks[i].
+bool readBlocks(const std::string& filepath,
+                std::span<const BlockLocator> blocks,
+                std::vector<std::vector<std::uint8_t>>& payloads);
+
 bool readFile(const std::string& filepath,
               ChunkMap& chunks,
               const std::function<void(float)>& progress = {});
 
+// Container read through a file mapping. Compressed payloads inflate straight from the mapped
+// pages; Compression::None payloads come back as spans into the mapping with no copy at all.
+// Spans stay valid while the view is open and, for inflated data, while the scratch lives.
+class MappedView {
+public:
+    bool open(const std::string& filepath, const std::function<void(float)>& progress = {});
+    void close() { mapping.close(); chunkIndex.clear(); }
+
+    const ChunkIndex& index() const { return chunkIndex; }
+
+    bool access(const ChunkLocator& locator,
+                std::vector<std::uint8_t>& scratch,
+                std::span<const std::uint8_t>& bytes) const;
+    bool access(const BlockLocator& locator,
+                std::vector<std::uint8_t>& scratch,
+                std::span<const std::uint8_t>& bytes) const;
+    // Inflates in parallel; bytes[i] matches blocks[i].
+    bool accessBlocks(std::span<const BlockLocator> blocks,
+                      std::vector<std::vector<std::uint8_t>>& scratch,
+                      std::vector<std::span<const std::uint8_t>>& bytes) const;
+
+private:
+    bool stored(std::uint64_t offset, std::uint64_t size, std::span<const std::uint8_t>& bytes) const;
+
+    AudioDecoding::MappedFile mapping;
+    ChunkIndex chunkIndex;
+};
+
 }
@@ -1,12 +1,18 @@
 #include "resyne/encoding/formats/rsyn_presentation.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
 #include "audio/analysis/presentation/sample_sequence.h"
 #include "audio/analysis/presentation/spectral_presentation.h"
-#include "ui/smoothing/smoothing.h"
+#include "ui/smoothing/offline_smoothing.h"
 #include "ui/smoothing/smoothing_features.h"
+#include "utilities/threading/task_scheduler.h"
 
 namespace RSYNPresentation {
 
@@ -44,6 +50,24 @@ std::array<float, 3> xyzToOklab(const ColourCore::FrameResult& result) {
     return oklab;
 }
 
+// One previous frame for its magnitudes, plus one for each flux value the history keeps.
+constexpr std::size_t kFluxLookbackFrames =
+    std::tuple_size_v<decltype(UI::Smoothing::MagnitudeHistory::fluxHistory)> + 1;
+// Below this a run spends too much of its time replaying the frames before it.
+constexpr std::size_t kMinRunFrames = 256;
+
+// Progress is reported this often, so the runs do not queue on progressMutex every frame.
+constexpr std::size_t kProgressIntervalFrames = 64;
+
+// Splits [0, frameCount) into contiguous runs on the shared scheduler, a few per worker so
+// idle workers can steal from the slow ones, and calls job(first, end) for each. The calling
+// thread runs one and then helps, so an export already running as a scheduler task does not
+// stack threads on top of the pool.
+template <typename Job>
+void forEachRun(const std::size_t frameCount, const Job& job) {
+    Utilities::Threading::TaskScheduler::shared().parallelFor(frameCount, kMinRunFrames, job);
+}
+
 void writeSmoothedOutputs(RSYNPresentationFrame& frame,
                           const std::array<float, 3>& smoothedOklab,
                           const RSYNPresentationSettings& settings) {
@@ -79,12 +103,11 @@ void writeSmoothedOutputs(RSYNPresentationFrame& frame,
 }
 
 std::shared_ptr<RSYNPresentationData> buildPresentationData(
-    const std::vector<AudioColourSample>& samples,
+    const SpectralSequenceView samples,
     const RSYNPresentationSettings& settings,
     const std::function<void(float)>& progress) {
     auto presentation = std::make_shared<RSYNPresentationData>();
     presentation->settings = settings;
-    presentation->frames.reserve(samples.size());
 
     if (samples.empty()) {
         if (progress) {
@@ -93,60 +116,138 @@ std::shared_ptr<RSYNPresentationData> buildPresentationData(
         return presentation;
     }
 
-    SpringSmoother smoother(8.0f, 1.0f, settings.springMass);
-    smoother.setSmoothingAmount(settings.smoothingAmount);
-
+    const std::size_t frameCount = samples.size();
+    presentation->frames.resize(frameCount);
+    std::vector<UI::Smoothing::SpringStep> steps(settings.smoothingEnabled ? frameCount : 0);
     const auto presentationSettings = buildPresentationSettings(settings);
-    UI::Smoothing::MagnitudeHistory fluxHistory;
-
-    for (std::size_t index = 0; index < samples.size(); ++index) {
-        const AudioColourSample& sample = samples[index];
-        const AudioColourSample* previousSample = index > 0 ? &samples[index - 1] : nullptr;
-        const auto preparedFrame = SpectralPresentation::SampleSequence::prepareSampleFrame(
-            sample,
-            presentationSettings,
-            previousSample);
-
-        RSYNPresentationFrame frame{};
-        frame.timestamp = sample.timestamp;
-        frame.analysis = preparedFrame.colourResult;
-        frame.targetOklab = xyzToOklab(preparedFrame.colourResult);
-
-        auto features = UI::Smoothing::buildSignalFeatures(preparedFrame.colourResult);
-        UI::Smoothing::updateFluxHistory(preparedFrame.visualiserMagnitudes, fluxHistory, features);
-        frame.smoothingSignals = copySignals(features);
-
-        if (!settings.smoothingEnabled) {
-            writeSmoothedOutputs(frame, frame.targetOklab, settings);
-            presentation->frames.push_back(std::move(frame));
-        } else {
-            if (index == 0) {
-                smoother.resetOklab(frame.targetOklab[0], frame.targetOklab[1], frame.targetOklab[2]);
+
+    std::atomic<std::size_t> framesDone{0};
+    std::mutex progressMutex;
+    std::size_t reported = 0;  // Protected by progressMutex
+
+    forEachRun(frameCount, [&](const std::size_t first, const std::size_t end) {
+        // The flux history remembers one frame's magnitudes and the flux of the frames
+        // before it, so replaying that many frames first reproduces it exactly.
+        UI::Smoothing::MagnitudeHistory fluxHistory;
+        SpectralPresentation::SampleSequence::Workspace workspace;
+        SpectralPresentation::PreparedFrame preparedFrame;
+        std::size_t unreported = 0;
+        for (std::size_t index = first - std::min(first, kFluxLookbackFrames); index < end; ++index) {
+            const SpectralFrame sample = samples[index];
+            const SpectralFrame previousSample = index > 0 ? samples[index - 1] : SpectralFrame{};
+            SpectralPresentation::SampleSequence::prepareSampleFrame(
+                workspace,
+                sample,
+                presentationSettings,
+                preparedFrame,
+                index > 0 ? &previousSample : nullptr);
+
+            auto features = UI::Smoothing::buildSignalFeatures(preparedFrame.colourResult);
+            UI::Smoothing::updateFluxHistory(preparedFrame.visualiserMagnitudes, fluxHistory, features);
+            if (index < first) {
+                continue;
+            }
+
+            RSYNPresentationFrame& frame = presentation->frames[index];
+            frame.timestamp = sample.timestamp;
+            frame.analysis = preparedFrame.colourResult;
+            frame.targetOklab = xyzToOklab(preparedFrame.colourResult);
+            frame.smoothingSignals = copySignals(features);
+
+            if (!settings.smoothingEnabled) {
+                writeSmoothedOutputs(frame, frame.targetOklab, settings);
             } else {
-                const double deltaSeconds = sample.timestamp - samples[index - 1].timestamp;
-                const float deltaTime = std::isfinite(deltaSeconds) && deltaSeconds > 0.0
-                    ? static_cast<float>(deltaSeconds)
-                    : SpectralPresentation::SampleSequence::kFallbackDeltaTimeSeconds;
-                smoother.setTargetOklab(frame.targetOklab[0], frame.targetOklab[1], frame.targetOklab[2]);
-                if (settings.manualSmoothing) {
-                    smoother.update(deltaTime * settings.smoothingUpdateFactor);
-                } else {
-                    smoother.update(deltaTime * settings.smoothingUpdateFactor, features);
+                UI::Smoothing::SpringStep& step = steps[index];
+                step.targetOklab = frame.targetOklab;
+                step.features = features;
+                if (index > 0) {
+                    const double deltaSeconds = sample.timestamp - previousSample.timestamp;
+                    const float deltaTime = std::isfinite(deltaSeconds) && deltaSeconds > 0.0
+                        ? static_cast<float>(deltaSeconds)
+                        : SpectralPresentation::SampleSequence::kFallbackDeltaTimeSeconds;
+                    step.deltaTime = deltaTime * settings.smoothingUpdateFactor;
                 }
             }
 
-            std::array<float, 3> smoothedOklab{};
-            smoother.getCurrentOklab(smoothedOklab[0], smoothedOklab[1], smoothedOklab[2]);
-            writeSmoothedOutputs(frame, smoothedOklab, settings);
-            presentation->frames.push_back(std::move(frame));
-        }
-
-        if (progress) {
-            progress(static_cast<float>(index + 1) / static_cast<float>(samples.size()));
+            if (++unreported < kProgressIntervalFrames && index + 1 < end) {
+                continue;
+            }
+            const std::size_t done = framesDone.fetch_add(unreported) + unreported;
+            unreported = 0;
+            if (progress) {
+                std::lock_guard<std::mutex> lock(progressMutex);
+                if (done > reported) {
+                    reported = done;
+                    progress(static_cast<float>(done) / static_cast<float>(frameCount));
+                }
+            }
         }
+    });
+
+    if (settings.smoothingEnabled) {
+        UI::Smoothing::OfflineSpringSettings springSettings{};
+        springSettings.smoothingAmount = settings.smoothingAmount;
+        springSettings.mass = settings.springMass;
+        springSettings.adaptive = !settings.manualSmoothing;
+
+        std::vector<std::array<float, 3>> smoothedOklab(frameCount);
+        UI::Smoothing::smoothSequence(steps, springSettings, smoothedOklab);
+        forEachRun(frameCount, [&](const std::size_t first, const std::size_t end) {
+            for (std::size_t index = first; index < end; ++index) {
+                writeSmoothedOutputs(presentation->frames[index], smoothedOklab[index], settings);
+            }
+        });
     }
 
     return presentation;
 }
 
+std::shared_ptr<RSYNPreviewData> buildPreviewData(const RSYNPresentationData& presentation) {
+    const std::vector<RSYNPresentationFrame>& frames = presentation.frames;
+    if (frames.empty()) {
+        return nullptr;
+    }
+
+    auto preview = std::make_shared<RSYNPreviewData>();
+    preview->colourSpace = presentation.settings.colourSpace;
+    preview->applyGamutMapping = presentation.settings.applyGamutMapping;
+    preview->firstTimestamp = frames.front().timestamp;
+    preview->lastTimestamp = frames.back().timestamp;
+
+    const std::size_t columnCount = std::min(frames.size(), RSYNPreviewData::kPreviewColumns);
+    std::vector<RSYNPreviewColumn> columns(columnCount);
+    for (std::size_t column = 0; column < columnCount; ++column) {
+        const std::size_t first = frames.size() * column / columnCount;
+        const std::size_t end = frames.size() * (column + 1) / columnCount;
+        RSYNPreviewColumn& output = columns[column];
+        for (std::size_t index = first; index < end; ++index) {
+            for (std::size_t channel = 0; channel < 3; ++channel) {
+                output.oklab[channel] += frames[index].smoothedOklab[channel];
+                output.displayRgb[channel] += frames[index].smoothedDisplayRgb[channel];
+            }
+        }
+        const float scale = 1.0f / static_cast<float>(end - first);
+        for (std::size_t channel = 0; channel < 3; ++channel) {
+            output.oklab[channel] *= scale;
+            output.displayRgb[channel] *= scale;
+        }
+    }
+    preview->levels.push_back(std::move(columns));
+
+    while (preview->levels.back().size() > 1) {
+        const std::vector<RSYNPreviewColumn>& finer = preview->levels.back();
+        std::vector<RSYNPreviewColumn> coarser((finer.size() + 1) / 2);
+        for (std::size_t column = 0; column < coarser.size(); ++column) {
+            const RSYNPreviewColumn& left = finer[column * 2];
+            const RSYNPreviewColumn& right = finer[std::min(column * 2 + 1, finer.size() - 1)];
+            for (std::size_t channel = 0; channel < 3; ++channel) {
+                coarser[column].oklab[channel] = 0.5f * (left.oklab[channel] + right.oklab[channel]);
+                coarser[column].displayRgb[channel] = 0.5f * (left.displayRgb[channel] + right.displayRgb[channel]);
+            }
+        }
+        preview->levels.push_back(std::move(coarser));
+    }
+    return preview;
+}
+
 }
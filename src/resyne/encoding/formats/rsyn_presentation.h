@@ -8,9 +8,14 @@
 
 namespace RSYNPresentation {
 
+// Analyses the frames in parallel on the shared TaskScheduler, then smooths them in chunks
+// warmed up from rest. progress may be called from any of its workers, never concurrently.
 std::shared_ptr<RSYNPresentationData> buildPresentationData(
-    const std::vector<AudioColourSample>& samples,
+    SpectralSequenceView samples,
     const RSYNPresentationSettings& settings,
     const std::function<void(float)>& progress = {});
 
+// The PREV pyramid for a presentation track; null when it has no frames.
+std::shared_ptr<RSYNPreviewData> buildPreviewData(const RSYNPresentationData& presentation);
+
 }
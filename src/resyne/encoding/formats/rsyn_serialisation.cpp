@@ -1,11 +1,16 @@
 #include "resyne/encoding/formats/rsyn_serialisation.h"
+#include "resyne/encoding/formats/half_float.h"
+#include "resyne/encoding/formats/spectral_sequence.h"
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -43,7 +48,7 @@ void appendIntegral(std::vector<std::uint8_t>& output, T value) {
 }
 
 template <typename T>
-bool readIntegral(const std::vector<std::uint8_t>& input, std::size_t& offset, T& value) {
+bool readIntegral(std::span<const std::uint8_t> input, std::size_t& offset, T& value) {
     static_assert(std::is_integral_v<T> || std::is_enum_v<T>);
 
     if (offset + sizeof(T) > input.size()) {
@@ -70,7 +75,7 @@ void appendFloat(std::vector<std::uint8_t>& output, T value) {
 }
 
 template <typename T>
-bool readFloat(const std::vector<std::uint8_t>& input, std::size_t& offset, T& value) {
+bool readFloat(std::span<const std::uint8_t> input, std::size_t& offset, T& value) {
     static_assert(std::is_floating_point_v<T>);
 
     if (offset + sizeof(T) > input.size()) {
@@ -83,7 +88,7 @@ bool readFloat(const std::vector<std::uint8_t>& input, std::size_t& offset, T& v
 }
 
 template <typename T>
-void appendFloatVector(std::vector<std::uint8_t>& output, const std::vector<T>& values) {
+void appendFloatVector(std::vector<std::uint8_t>& output, std::span<const T> values) {
     appendIntegral(output, static_cast<std::uint32_t>(values.size()));
     for (const T value : values) {
         appendFloat(output, value);
@@ -91,7 +96,7 @@ void appendFloatVector(std::vector<std::uint8_t>& output, const std::vector<T>&
 }
 
 template <typename T>
-bool readFloatVector(const std::vector<std::uint8_t>& input, std::size_t& offset, std::vector<T>& values) {
+bool readFloatVector(std::span<const std::uint8_t> input, std::size_t& offset, std::vector<T>& values) {
     std::uint32_t size = 0;
     if (!readIntegral(input, offset, size)) {
         return false;
@@ -136,38 +141,7 @@ void decodePresentationSettings(const json& input, RSYNPresentationSettings& set
     settings.pipelineId = input.value("pipeline_id", settings.pipelineId);
 }
 
-void writeFrameResult(std::vector<std::uint8_t>& output, const ColourCore::FrameResult& result) {
-    appendFloat(output, result.r);
-    appendFloat(output, result.g);
-    appendFloat(output, result.b);
-    appendFloat(output, result.X);
-    appendFloat(output, result.Y);
-    appendFloat(output, result.Z);
-    appendFloat(output, result.dominantWavelength);
-    appendFloat(output, result.dominantFrequency);
-    appendFloat(output, result.colourIntensity);
-    appendFloat(output, result.L);
-    appendFloat(output, result.a);
-    appendFloat(output, result.b_comp);
-    appendFloat(output, result.spectralCentroid);
-    appendFloat(output, result.spectralFlatness);
-    appendFloat(output, result.spectralSpread);
-    appendFloat(output, result.spectralRolloff);
-    appendFloat(output, result.spectralCrestFactor);
-    appendFloat(output, result.loudnessDb);
-    appendFloat(output, result.frameLoudnessDb);
-    appendFloat(output, result.brightnessLoudnessDb);
-    appendFloat(output, result.loudnessNormalised);
-    appendFloat(output, result.brightnessNormalised);
-    appendFloat(output, result.transientMix);
-    appendFloat(output, result.estimatedSPL);
-    appendFloat(output, result.luminanceCdM2);
-    appendFloat(output, result.phaseInstabilityNorm);
-    appendFloat(output, result.phaseCoherenceNorm);
-    appendFloat(output, result.phaseTransientNorm);
-}
-
-bool readFrameResult(const std::vector<std::uint8_t>& input, std::size_t& offset, ColourCore::FrameResult& result) {
+bool readFrameResult(std::span<const std::uint8_t> input, std::size_t& offset, ColourCore::FrameResult& result) {
     return readFloat(input, offset, result.r) &&
         readFloat(input, offset, result.g) &&
         readFloat(input, offset, result.b) &&
@@ -198,21 +172,7 @@ bool readFrameResult(const std::vector<std::uint8_t>& input, std::size_t& offset
         readFloat(input, offset, result.phaseTransientNorm);
 }
 
-void writeSignals(std::vector<std::uint8_t>& output, const RSYNSmoothingSignals& signals) {
-    appendIntegral(output, static_cast<std::uint8_t>(signals.onsetDetected ? 1 : 0));
-    appendFloat(output, signals.spectralFlux);
-    appendFloat(output, signals.spectralFlatness);
-    appendFloat(output, signals.loudnessNormalised);
-    appendFloat(output, signals.brightnessNormalised);
-    appendFloat(output, signals.spectralSpreadNorm);
-    appendFloat(output, signals.spectralRolloffNorm);
-    appendFloat(output, signals.spectralCrestNorm);
-    appendFloat(output, signals.phaseInstabilityNorm);
-    appendFloat(output, signals.phaseCoherenceNorm);
-    appendFloat(output, signals.phaseTransientNorm);
-}
-
-bool readSignals(const std::vector<std::uint8_t>& input, std::size_t& offset, RSYNSmoothingSignals& signals) {
+bool readSignals(std::span<const std::uint8_t> input, std::size_t& offset, RSYNSmoothingSignals& signals) {
     std::uint8_t onset = 0;
     if (!readIntegral(input, offset, onset)) {
         return false;
@@ -231,23 +191,576 @@ bool readSignals(const std::vector<std::uint8_t>& input, std::size_t& offset, RS
         readFloat(input, offset, signals.phaseTransientNorm);
 }
 
-void writeFloatTriple(std::vector<std::uint8_t>& output, const std::array<float, 3>& values) {
+bool readFloatTriple(std::span<const std::uint8_t> input, std::size_t& offset, std::array<float, 3>& values) {
+    return readFloat(input, offset, values[0]) &&
+        readFloat(input, offset, values[1]) &&
+        readFloat(input, offset, values[2]);
+}
+
+constexpr std::uint32_t kPreviewMagic = RSYNContainer::makeTag("PRV1");
+constexpr std::uint32_t kPreviewVersion = 1;
+constexpr std::uint32_t kPreviewMaxLevels = 32;
+
+constexpr std::uint32_t kPeakTrackMagic = RSYNContainer::makeTag("PKT1");
+constexpr std::uint32_t kPeakTrackVersion = 1;
+
+std::uint8_t quantiseUnit(const float value) {
+    const float clamped = std::isfinite(value) ? std::clamp(value, 0.0f, 1.0f) : 0.0f;
+    return static_cast<std::uint8_t>(std::lround(clamped * 255.0f));
+}
+
+// PRES v2 is a 16-byte header (magic, version, stride, frame count) followed by one
+// fixed-stride record per frame, so frame N starts at kPresentationHeaderSize + N * stride.
+// Readers accept strides larger than the record so fields can be appended without a
+// version bump. Files written before v2 carry the field-by-field layout instead.
+constexpr std::uint32_t kPresentationMagic = RSYNContainer::makeTag("PRF2");
+constexpr std::uint32_t kPresentationVersion = 2;
+constexpr std::size_t kPresentationHeaderSize = 16;
+
+struct PresentationRecord {
+    double timestamp;
+    ColourCore::FrameResult analysis;
+    std::uint32_t onsetDetected;
+    float spectralFlux;
+    float spectralFlatness;
+    float loudnessNormalised;
+    float brightnessNormalised;
+    float spectralSpreadNorm;
+    float spectralRolloffNorm;
+    float spectralCrestNorm;
+    float phaseInstabilityNorm;
+    float phaseCoherenceNorm;
+    float phaseTransientNorm;
+    std::array<float, 3> targetOklab;
+    std::array<float, 3> smoothedOklab;
+    std::array<float, 3> smoothedLab;
+    std::array<float, 3> smoothedDisplayRgb;
+    std::uint32_t reserved;
+};
+
+// Records are copied to and from the file as raw bytes, which is only the stored
+// little-endian layout on little-endian hosts. Changing FrameResult changes the record,
+// so it needs a new version.
+static_assert(std::endian::native == std::endian::little);
+static_assert(std::is_trivially_copyable_v<PresentationRecord>);
+static_assert(sizeof(ColourCore::FrameResult) == 28 * sizeof(float));
+static_assert(sizeof(PresentationRecord) == 216);
+
+PresentationRecord toRecord(const RSYNPresentationFrame& frame) {
+    const RSYNSmoothingSignals& signals = frame.smoothingSignals;
+    return PresentationRecord{
+        frame.timestamp,
+        frame.analysis,
+        signals.onsetDetected ? 1U : 0U,
+        signals.spectralFlux,
+        signals.spectralFlatness,
+        signals.loudnessNormalised,
+        signals.brightnessNormalised,
+        signals.spectralSpreadNorm,
+        signals.spectralRolloffNorm,
+        signals.spectralCrestNorm,
+        signals.phaseInstabilityNorm,
+        signals.phaseCoherenceNorm,
+        signals.phaseTransientNorm,
+        frame.targetOklab,
+        frame.smoothedOklab,
+        frame.smoothedLab,
+        frame.smoothedDisplayRgb,
+        0U};
+}
+
+void fromRecord(const PresentationRecord& record, RSYNPresentationFrame& frame) {
+    RSYNSmoothingSignals& signals = frame.smoothingSignals;
+    frame.timestamp = record.timestamp;
+    frame.analysis = record.analysis;
+    signals.onsetDetected = (record.onsetDetected & 1U) != 0;
+    signals.spectralFlux = record.spectralFlux;
+    signals.spectralFlatness = record.spectralFlatness;
+    signals.loudnessNormalised = record.loudnessNormalised;
+    signals.brightnessNormalised = record.brightnessNormalised;
+    signals.spectralSpreadNorm = record.spectralSpreadNorm;
+    signals.spectralRolloffNorm = record.spectralRolloffNorm;
+    signals.spectralCrestNorm = record.spectralCrestNorm;
+    signals.phaseInstabilityNorm = record.phaseInstabilityNorm;
+    signals.phaseCoherenceNorm = record.phaseCoherenceNorm;
+    signals.phaseTransientNorm = record.phaseTransientNorm;
+    frame.targetOklab = record.targetOklab;
+    frame.smoothedOklab = record.smoothedOklab;
+    frame.smoothedLab = record.smoothedLab;
+    frame.smoothedDisplayRgb = record.smoothedDisplayRgb;
+}
+
+// A pre-v2 chunk opens with its frame count, and a count equal to the magic would need
+// hundreds of gigabytes of records, so the magic alone tells the layouts apart.
+bool hasPresentationMagic(std::span<const std::uint8_t> input) {
+    std::size_t offset = 0;
+    std::uint32_t magic = 0;
+    return readIntegral(input, offset, magic) && magic == kPresentationMagic;
+}
+
+// False for anything that is not a well-formed v2 chunk, including pre-v2 layouts.
+bool readPresentationHeader(std::span<const std::uint8_t> input,
+                            std::uint32_t& stride,
+                            std::uint32_t& frameCount) {
+    std::size_t offset = 0;
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    if (!readIntegral(input, offset, magic) || magic != kPresentationMagic ||
+        !readIntegral(input, offset, version) || version != kPresentationVersion ||
+        !readIntegral(input, offset, stride) || stride < sizeof(PresentationRecord) ||
+        !readIntegral(input, offset, frameCount)) {
+        return false;
+    }
+
+    const std::uint64_t recordBytes = static_cast<std::uint64_t>(stride) * frameCount;
+    return input.size() - kPresentationHeaderSize == recordBytes;
+}
+
+bool decodeLegacyPresentationFrames(std::span<const std::uint8_t> input,
+                                    std::vector<RSYNPresentationFrame>& frames,
+                                    const std::function<void(float)>& progress) {
+    std::size_t offset = 0;
+    std::uint32_t frameCount = 0;
+    if (!readIntegral(input, offset, frameCount)) {
+        return false;
+    }
+
+    frames.resize(frameCount);
+    for (std::uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+        RSYNPresentationFrame& frame = frames[frameIndex];
+        if (!readFloat(input, offset, frame.timestamp) ||
+            !readFrameResult(input, offset, frame.analysis) ||
+            !readSignals(input, offset, frame.smoothingSignals) ||
+            !readFloatTriple(input, offset, frame.targetOklab) ||
+            !readFloatTriple(input, offset, frame.smoothedOklab) ||
+            !readFloatTriple(input, offset, frame.smoothedLab) ||
+            !readFloatTriple(input, offset, frame.smoothedDisplayRgb)) {
+            return false;
+        }
+
+        if (progress) {
+            progress(static_cast<float>(frameIndex + 1U) / static_cast<float>(std::max<std::uint32_t>(1U, frameCount)));
+        }
+    }
+
+    return offset == input.size();
+}
+
+void writeSampleHeader(std::vector<std::uint8_t>& output, const SpectralFrame& sample) {
+    appendFloat(output, sample.timestamp);
+    appendFloat(output, sample.sampleRate);
+    appendFloat(output, sample.loudnessLUFS);
+    appendFloat(output, sample.splDb);
+    appendIntegral(output, sample.channels);
+}
+
+bool readSampleHeader(std::span<const std::uint8_t> input, std::size_t& offset, AudioColourSample& sample) {
+    return readFloat(input, offset, sample.timestamp) &&
+        readFloat(input, offset, sample.sampleRate) &&
+        readFloat(input, offset, sample.loudnessLUFS) &&
+        readFloat(input, offset, sample.splDb) &&
+        readIntegral(input, offset, sample.channels);
+}
+
+void writeFrequencies(std::vector<std::uint8_t>& output,
+                      const SpectralFrame& sample,
+                      std::span<const float> sharedFrequencies) {
+    // Zero frequency channels means "shared axis" once one is present, so frames without
+    // an axis are written as explicit empty channels instead.
+    if (SpectralSequence::matchesFrequencies(sample.frequencies, sharedFrequencies)) {
+        appendIntegral(output, static_cast<std::uint32_t>(0));
+    } else if (!sharedFrequencies.empty() && sample.frequencies.empty()) {
+        appendIntegral(output, static_cast<std::uint32_t>(sample.magnitudes.size()));
+        for (std::size_t channel = 0; channel < sample.magnitudes.size(); ++channel) {
+            appendIntegral(output, static_cast<std::uint32_t>(0));
+        }
+    } else {
+        appendIntegral(output, static_cast<std::uint32_t>(sample.frequencies.size()));
+        for (const auto channel : sample.frequencies) {
+            appendFloatVector(output, channel);
+        }
+    }
+}
+
+// A frame on the shared axis is left without frequencies and reported through usesSharedAxis,
+// so the sequence points it at its one copy of the axis.
+bool readFrequencies(std::span<const std::uint8_t> input,
+                     std::size_t& offset,
+                     std::span<const float> sharedFrequencies,
+                     AudioColourSample& sample,
+                     bool& usesSharedAxis) {
+    std::uint32_t frequencyChannels = 0;
+    if (!readIntegral(input, offset, frequencyChannels)) {
+        return false;
+    }
+    usesSharedAxis = frequencyChannels == 0 && !sharedFrequencies.empty();
+    sample.frequencies.resize(frequencyChannels);
+    if (!usesSharedAxis) {
+        for (auto& channel : sample.frequencies) {
+            if (!readFloatVector(input, offset, channel)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void writeSample(std::vector<std::uint8_t>& output,
+                 const SpectralFrame& sample,
+                 std::span<const float> sharedFrequencies) {
+    writeSampleHeader(output, sample);
+
+    appendIntegral(output, static_cast<std::uint32_t>(sample.magnitudes.size()));
+    for (const auto channel : sample.magnitudes) {
+        appendFloatVector(output, channel);
+    }
+
+    appendIntegral(output, static_cast<std::uint32_t>(sample.phases.size()));
+    for (const auto channel : sample.phases) {
+        appendFloatVector(output, channel);
+    }
+
+    writeFrequencies(output, sample, sharedFrequencies);
+}
+
+bool readSample(std::span<const std::uint8_t> input,
+                std::size_t& offset,
+                std::span<const float> sharedFrequencies,
+                AudioColourSample& sample,
+                bool& usesSharedAxis) {
+    if (!readSampleHeader(input, offset, sample)) {
+        return false;
+    }
+
+    std::uint32_t magnitudeChannels = 0;
+    if (!readIntegral(input, offset, magnitudeChannels)) {
+        return false;
+    }
+    sample.magnitudes.resize(magnitudeChannels);
+    for (auto& channel : sample.magnitudes) {
+        if (!readFloatVector(input, offset, channel)) {
+            return false;
+        }
+    }
+
+    std::uint32_t phaseChannels = 0;
+    if (!readIntegral(input, offset, phaseChannels)) {
+        return false;
+    }
+    sample.phases.resize(phaseChannels);
+    for (auto& channel : sample.phases) {
+        if (!readFloatVector(input, offset, channel)) {
+            return false;
+        }
+    }
+
+    return readFrequencies(input, offset, sharedFrequencies, sample, usesSharedAxis);
+}
+
+constexpr double kTwoPi = 6.283185307179586476925;
+constexpr double kPhaseStep = kTwoPi / 65536.0;
+constexpr float kMagnitudeCodeSpan = 65534.0f;
+
+double wrapPhase(const double phase) {
+    double wrapped = std::fmod(phase + kTwoPi * 0.5, kTwoPi);
+    if (wrapped < 0.0) {
+        wrapped += kTwoPi;
+    }
+    return wrapped - kTwoPi * 0.5;
+}
+
+// Code runs are padded to whole 4-byte lanes so the container's byte shuffle keeps low and
+// high bytes in separate planes.
+void padCodes(std::vector<std::uint8_t>& output, const std::size_t codeCount) {
+    if (codeCount % 2 != 0) {
+        appendIntegral(output, static_cast<std::uint16_t>(0));
+    }
+}
+
+bool skipCodePadding(std::span<const std::uint8_t> input, std::size_t& offset, const std::size_t codeCount) {
+    if (codeCount % 2 == 0) {
+        return true;
+    }
+    std::uint16_t padding = 0;
+    return readIntegral(input, offset, padding);
+}
+
+// Code 0 is exact silence; codes 1..65535 span the channel's log2 range linearly.
+void writeQuantisedMagnitudes(std::vector<std::uint8_t>& output, std::span<const float> values) {
+    float logMin = std::numeric_limits<float>::max();
+    float logMax = std::numeric_limits<float>::lowest();
     for (const float value : values) {
-        appendFloat(output, value);
+        if (std::isfinite(value) && value > 0.0f) {
+            const float logValue = std::log2(value);
+            logMin = std::min(logMin, logValue);
+            logMax = std::max(logMax, logValue);
+        }
+    }
+    if (logMin > logMax) {
+        logMin = 0.0f;
+        logMax = 0.0f;
+    }
+    const float step = (logMax - logMin) / kMagnitudeCodeSpan;
+
+    appendIntegral(output, static_cast<std::uint32_t>(values.size()));
+    appendFloat(output, logMin);
+    appendFloat(output, step);
+    for (const float value : values) {
+        std::uint16_t code = 0;
+        if (std::isfinite(value) && value > 0.0f) {
+            const float scaled = step > 0.0f ? (std::log2(value) - logMin) / step : 0.0f;
+            code = static_cast<std::uint16_t>(1.0f + std::clamp(std::round(scaled), 0.0f, kMagnitudeCodeSpan));
+        }
+        appendIntegral(output, code);
     }
+    padCodes(output, values.size());
 }
 
-bool readFloatTriple(const std::vector<std::uint8_t>& input, std::size_t& offset, std::array<float, 3>& values) {
-    return readFloat(input, offset, values[0]) &&
-        readFloat(input, offset, values[1]) &&
-        readFloat(input, offset, values[2]);
+bool readQuantisedMagnitudes(std::span<const std::uint8_t> input, std::size_t& offset, std::vector<float>& values) {
+    std::uint32_t size = 0;
+    float logMin = 0.0f;
+    float step = 0.0f;
+    if (!readIntegral(input, offset, size) || !readFloat(input, offset, logMin) || !readFloat(input, offset, step)) {
+        return false;
+    }
+
+    values.resize(size);
+    for (float& value : values) {
+        std::uint16_t code = 0;
+        if (!readIntegral(input, offset, code)) {
+            return false;
+        }
+        value = code == 0 ? 0.0f : std::exp2(logMin + static_cast<float>(code - 1U) * step);
+    }
+    return skipCodePadding(input, offset, values.size());
 }
 
+// Phases are predicted from the previous decoded frame plus the bin's expected advance, so
+// stationary partials code to near-zero deltas. The encoder tracks the decoder's output to
+// keep rounding from accumulating across a block.
+double predictPhase(const std::vector<float>* previous, const std::size_t bin, const double advancePerBin) {
+    if (previous == nullptr) {
+        return 0.0;
+    }
+    return static_cast<double>((*previous)[bin]) + std::fmod(advancePerBin * static_cast<double>(bin), kTwoPi);
 }
 
-bool encodeMetadata(const AudioMetadata& metadata, std::vector<std::uint8_t>& output) {
+float reconstructPhase(const double predicted, const std::uint16_t code) {
+    return static_cast<float>(wrapPhase(predicted + static_cast<double>(static_cast<std::int16_t>(code)) * kPhaseStep));
+}
+
+void writeQuantisedPhases(std::vector<std::uint8_t>& output,
+                          std::span<const float> phases,
+                          const std::vector<float>* previous,
+                          const double advancePerBin,
+                          std::vector<float>& decoded) {
+    appendIntegral(output, static_cast<std::uint32_t>(phases.size()));
+    decoded.resize(phases.size());
+    for (std::size_t bin = 0; bin < phases.size(); ++bin) {
+        const double predicted = predictPhase(previous, bin, advancePerBin);
+        const double phase = std::isfinite(phases[bin]) ? static_cast<double>(phases[bin]) : predicted;
+        const long steps = std::lround(wrapPhase(phase - predicted) / kPhaseStep);
+        const std::uint16_t code = static_cast<std::uint16_t>(static_cast<unsigned long>(steps) & 0xFFFFU);
+        appendIntegral(output, code);
+        decoded[bin] = reconstructPhase(predicted, code);
+    }
+    padCodes(output, phases.size());
+}
+
+bool readQuantisedPhases(std::span<const std::uint8_t> input,
+                         std::size_t& offset,
+                         const std::vector<float>* previous,
+                         const double advancePerBin,
+                         std::vector<float>& phases) {
+    std::uint32_t size = 0;
+    if (!readIntegral(input, offset, size)) {
+        return false;
+    }
+    if (previous != nullptr && previous->size() != size) {
+        previous = nullptr;
+    }
+
+    phases.resize(size);
+    for (std::uint32_t bin = 0; bin < size; ++bin) {
+        std::uint16_t code = 0;
+        if (!readIntegral(input, offset, code)) {
+            return false;
+        }
+        phases[bin] = reconstructPhase(predictPhase(previous, bin, advancePerBin), code);
+    }
+    return skipCodePadding(input, offset, size);
+}
+
+void writeQuantisedSample(std::vector<std::uint8_t>& output,
+                          const SpectralFrame& sample,
+                          std::span<const float> sharedFrequencies,
+                          const double advancePerBin,
+                          std::vector<std::vector<float>>& decodedPhases) {
+    writeSampleHeader(output, sample);
+
+    appendIntegral(output, static_cast<std::uint32_t>(sample.magnitudes.size()));
+    for (const auto channel : sample.magnitudes) {
+        writeQuantisedMagnitudes(output, channel);
+    }
+
+    std::vector<std::vector<float>> previous = std::move(decodedPhases);
+    decodedPhases.assign(sample.phases.size(), {});
+    appendIntegral(output, static_cast<std::uint32_t>(sample.phases.size()));
+    for (std::size_t channel = 0; channel < sample.phases.size(); ++channel) {
+        const bool predictable = channel < previous.size() && previous[channel].size() == sample.phases[channel].size();
+        writeQuantisedPhases(output, sample.phases[channel], predictable ? &previous[channel] : nullptr,
+                             advancePerBin, decodedPhases[channel]);
+    }
+
+    writeFrequencies(output, sample, sharedFrequencies);
+}
+
+bool readQuantisedSample(std::span<const std::uint8_t> input,
+                         std::size_t& offset,
+                         std::span<const float> sharedFrequencies,
+                         const double advancePerBin,
+                         const AudioColourSample* previousSample,
+                         AudioColourSample& sample,
+                         bool& usesSharedAxis) {
+    if (!readSampleHeader(input, offset, sample)) {
+        return false;
+    }
+
+    std::uint32_t magnitudeChannels = 0;
+    if (!readIntegral(input, offset, magnitudeChannels)) {
+        return false;
+    }
+    sample.magnitudes.resize(magnitudeChannels);
+    for (auto& channel : sample.magnitudes) {
+        if (!readQuantisedMagnitudes(input, offset, channel)) {
+            return false;
+        }
+    }
+
+    std::uint32_t phaseChannels = 0;
+    if (!readIntegral(input, offset, phaseChannels)) {
+        return false;
+    }
+    sample.phases.resize(phaseChannels);
+    for (std::size_t channel = 0; channel < sample.phases.size(); ++channel) {
+        const std::vector<float>* previous = previousSample != nullptr && channel < previousSample->phases.size()
+            ? &previousSample->phases[channel]
+            : nullptr;
+        if (!readQuantisedPhases(input, offset, previous, advancePerBin, sample.phases[channel])) {
+            return false;
+        }
+    }
+
+    return readFrequencies(input, offset, sharedFrequencies, sample, usesSharedAxis);
+}
+
+
+// Half16 channels are a count and then their values as half floats, padded like the codes.
+void writeHalfVector(std::vector<std::uint8_t>& output, std::span<const float> values, std::vector<std::uint16_t>& halves) {
+    halves.resize(values.size());
+    HalfFloat::fromFloats(values.data(), halves.data(), values.size());
+    appendIntegral(output, static_cast<std::uint32_t>(values.size()));
+    const std::size_t start = output.size();
+    output.resize(start + halves.size() * sizeof(std::uint16_t));
+    if (!halves.empty()) {
+        std::memcpy(output.data() + start, halves.data(), halves.size() * sizeof(std::uint16_t));
+    }
+    padCodes(output, values.size());
+}
+
+bool readHalfVector(std::span<const std::uint8_t> input,
+                    std::size_t& offset,
+                    std::vector<float>& values,
+                    std::vector<std::uint16_t>& halves) {
+    std::uint32_t size = 0;
+    if (!readIntegral(input, offset, size)) {
+        return false;
+    }
+    const std::size_t bytes = static_cast<std::size_t>(size) * sizeof(std::uint16_t);
+    if (bytes > input.size() - offset) {
+        return false;
+    }
+    halves.resize(size);
+    if (bytes > 0) {
+        std::memcpy(halves.data(), input.data() + offset, bytes);
+    }
+    offset += bytes;
+    values.resize(size);
+    HalfFloat::toFloats(halves.data(), values.data(), size);
+    return skipCodePadding(input, offset, size);
+}
+
+void writeHalfSample(std::vector<std::uint8_t>& output,
+                     const SpectralFrame& sample,
+                     std::span<const float> sharedFrequencies,
+                     std::vector<std::uint16_t>& halves) {
+    writeSampleHeader(output, sample);
+
+    appendIntegral(output, static_cast<std::uint32_t>(sample.magnitudes.size()));
+    for (const auto channel : sample.magnitudes) {
+        writeHalfVector(output, channel, halves);
+    }
+
+    appendIntegral(output, static_cast<std::uint32_t>(sample.phases.size()));
+    for (const auto channel : sample.phases) {
+        writeHalfVector(output, channel, halves);
+    }
+
+    writeFrequencies(output, sample, sharedFrequencies);
+}
+
+bool readHalfSample(std::span<const std::uint8_t> input,
+                    std::size_t& offset,
+                    std::span<const float> sharedFrequencies,
+                    std::vector<std::uint16_t>& halves,
+                    AudioColourSample& sample,
+                    bool& usesSharedAxis) {
+    if (!readSampleHeader(input, offset, sample)) {
+        return false;
+    }
+
+    std::uint32_t magnitudeChannels = 0;
+    if (!readIntegral(input, offset, magnitudeChannels)) {
+        return false;
+    }
+    sample.magnitudes.resize(magnitudeChannels);
+    for (auto& channel : sample.magnitudes) {
+        if (!readHalfVector(input, offset, channel, halves)) {
+            return false;
+        }
+    }
+
+    std::uint32_t phaseChannels = 0;
+    if (!readIntegral(input, offset, phaseChannels)) {
+        return false;
+    }
+    sample.phases.resize(phaseChannels);
+    for (auto& channel : sample.phases) {
+        if (!readHalfVector(input, offset, channel, halves)) {
+            return false;
+        }
+    }
+
+    return readFrequencies(input, offset, sharedFrequencies, sample, usesSharedAxis);
+}
+
+// Frames are read into a staging sample that keeps its channel capacity from one frame to
+// the next, then copied into the sequence's slabs.
+void appendDecoded(SpectralSequence& samples, const AudioColourSample& sample, const bool usesSharedAxis) {
+    const std::size_t frame = samples.appendFrame(sample);
+    if (usesSharedAxis) {
+        samples.setUsesSharedFrequencies(frame, true);
+    }
+}
+
+}
+
+bool encodeMetadata(const AudioMetadata& metadata,
+                    std::vector<std::uint8_t>& output,
+                    const RSYNSpectralEncoding spectralEncoding) {
     json encoded{
         {"sample_rate", metadata.sampleRate},
+        {"analysis_decimation", metadata.analysisDecimation},
         {"fft_size", metadata.fftSize},
         {"hop_size", metadata.hopSize},
         {"duration_seconds", metadata.durationSeconds},
@@ -256,16 +769,19 @@ bool encodeMetadata(const AudioMetadata& metadata, std::vector<std::uint8_t>& ou
         {"num_bins", metadata.numBins},
         {"channels", metadata.channels},
         {"version", metadata.version},
-        {"has_source_data", metadata.sourceData != nullptr && !metadata.sourceData->bytes.empty()},
+        {"spectral_block_frames", kSpectralBlockFrames},
+        {"spectral_encoding", static_cast<std::uint32_t>(spectralEncoding)},
+        {"has_source_data", metadata.sourceData != nullptr && metadata.sourceData->hasContent()},
         {"has_presentation_data", metadata.presentationData != nullptr && !metadata.presentationData->frames.empty()}
     };
 
-    if (metadata.sourceData != nullptr && !metadata.sourceData->bytes.empty()) {
+    if (metadata.sourceData != nullptr && metadata.sourceData->hasContent()) {
         encoded["source"] = {
             {"filename", metadata.sourceData->filename},
             {"extension", metadata.sourceData->extension},
             {"crc32", metadata.sourceData->crc32},
-            {"size", metadata.sourceData->bytes.size()}
+            {"size", metadata.sourceData->bytes.empty() ? metadata.sourceData->size
+                                                        : metadata.sourceData->bytes.size()}
         };
     }
 
@@ -280,7 +796,7 @@ bool encodeMetadata(const AudioMetadata& metadata, std::vector<std::uint8_t>& ou
     return true;
 }
 
-bool decodeMetadata(const std::vector<std::uint8_t>& input, AudioMetadata& metadata) {
+bool decodeMetadata(std::span<const std::uint8_t> input, AudioMetadata& metadata) {
     const json decoded = json::from_cbor(input, true, false);
     if (decoded.is_discarded()) {
         return false;
@@ -289,6 +805,7 @@ bool decodeMetadata(const std::vector<std::uint8_t>& input, AudioMetadata& metad
     metadata.sourceData.reset();
     metadata.presentationData.reset();
     metadata.sampleRate = decoded.value("sample_rate", metadata.sampleRate);
+    metadata.analysisDecimation = std::max(1, decoded.value("analysis_decimation", 1));
     metadata.fftSize = decoded.value("fft_size", metadata.fftSize);
     metadata.hopSize = decoded.value("hop_size", metadata.hopSize);
     metadata.durationSeconds = decoded.value("duration_seconds", metadata.durationSeconds);
@@ -297,12 +814,18 @@ bool decodeMetadata(const std::vector<std::uint8_t>& input, AudioMetadata& metad
     metadata.numBins = decoded.value("num_bins", metadata.numBins);
     metadata.channels = decoded.value("channels", metadata.channels);
     metadata.version = decoded.value("version", metadata.version);
+    if (metadata.lazyAsset != nullptr) {
+        metadata.lazyAsset->spectralBlockFrames = decoded.value("spectral_block_frames", std::uint32_t{0});
+        metadata.lazyAsset->spectralEncoding = static_cast<RSYNSpectralEncoding>(
+            decoded.value("spectral_encoding", static_cast<std::uint32_t>(RSYNSpectralEncoding::Float32)));
+    }
 
     if (decoded.value("has_source_data", false) && decoded.contains("source")) {
         metadata.sourceData = std::make_shared<RSYNSourceData>();
         metadata.sourceData->filename = decoded["source"].value("filename", std::string{});
         metadata.sourceData->extension = decoded["source"].value("extension", std::string{});
         metadata.sourceData->crc32 = decoded["source"].value("crc32", std::uint32_t{0});
+        metadata.sourceData->size = decoded["source"].value("size", std::uint64_t{0});
     }
 
     if (decoded.value("has_presentation_data", false) && decoded.contains("presentation")) {
@@ -324,52 +847,117 @@ bool encodeSourceBytes(const std::shared_ptr<RSYNSourceData>& sourceData,
     return true;
 }
 
-bool decodeSourceBytes(const std::vector<std::uint8_t>& input,
+bool decodeSourceBytes(std::span<const std::uint8_t> input,
                        AudioMetadata& metadata) {
     if (metadata.sourceData == nullptr) {
         metadata.sourceData = std::make_shared<RSYNSourceData>();
     }
 
     metadata.sourceData->bytes.assign(input.begin(), input.end());
+    metadata.sourceData->size = metadata.sourceData->bytes.size();
+    return true;
+}
+
+bool encodeFrequencyAxis(std::span<const float> axis,
+                         std::vector<std::uint8_t>& output) {
+    output.clear();
+    appendIntegral(output, static_cast<std::uint32_t>(axis.size()));
+    for (const float value : axis) {
+        appendFloat(output, value);
+    }
     return true;
 }
 
-bool encodeSamples(const std::vector<AudioColourSample>& samples,
+bool decodeFrequencyAxis(std::span<const std::uint8_t> input,
+                         std::vector<float>& axis) {
+    std::size_t offset = 0;
+    return readFloatVector(input, offset, axis) && offset == input.size();
+}
+
+bool encodeSamples(const SpectralSequenceView samples,
+                   std::span<const float> sharedFrequencies,
                    std::vector<std::uint8_t>& output) {
     output.clear();
     appendIntegral(output, static_cast<std::uint32_t>(samples.size()));
 
-    for (const AudioColourSample& sample : samples) {
-        appendFloat(output, sample.timestamp);
-        appendFloat(output, sample.sampleRate);
-        appendFloat(output, sample.loudnessLUFS);
-        appendFloat(output, sample.splDb);
-        appendIntegral(output, sample.channels);
+    for (const SpectralFrame sample : samples) {
+        writeSample(output, sample, sharedFrequencies);
+    }
 
-        appendIntegral(output, static_cast<std::uint32_t>(sample.magnitudes.size()));
-        for (const auto& channel : sample.magnitudes) {
-            appendFloatVector(output, channel);
-        }
+    return true;
+}
 
-        appendIntegral(output, static_cast<std::uint32_t>(sample.phases.size()));
-        for (const auto& channel : sample.phases) {
-            appendFloatVector(output, channel);
-        }
+bool encodeQuantisedSamples(const SpectralSequenceView samples,
+                            std::span<const float> sharedFrequencies,
+                            const double phaseAdvancePerBin,
+                            std::vector<std::uint8_t>& output) {
+    output.clear();
+    appendIntegral(output, static_cast<std::uint32_t>(samples.size()));
+    appendFloat(output, phaseAdvancePerBin);
 
-        appendIntegral(output, static_cast<std::uint32_t>(sample.frequencies.size()));
-        for (const auto& channel : sample.frequencies) {
-            appendFloatVector(output, channel);
-        }
+    std::vector<std::vector<float>> decodedPhases;
+    for (const SpectralFrame sample : samples) {
+        writeQuantisedSample(output, sample, sharedFrequencies, phaseAdvancePerBin, decodedPhases);
+    }
+
+    return true;
+}
+
+bool encodeHalfSamples(const SpectralSequenceView samples,
+                       std::span<const float> sharedFrequencies,
+                       std::vector<std::uint8_t>& output) {
+    output.clear();
+    appendIntegral(output, static_cast<std::uint32_t>(samples.size()));
+
+    std::vector<std::uint16_t> halves;
+    for (const SpectralFrame sample : samples) {
+        writeHalfSample(output, sample, sharedFrequencies, halves);
     }
 
     return true;
 }
 
-bool decodeSamples(const std::vector<std::uint8_t>& input,
-                   std::vector<AudioColourSample>& samples,
+bool encodeSampleBlocks(const SpectralSequenceView samples,
+                        std::span<const float> sharedFrequencies,
+                        const std::size_t blockFrames,
+                        const RSYNSpectralEncoding encoding,
+                        const double phaseAdvancePerBin,
+                        std::vector<std::vector<std::uint8_t>>& blocks) {
+    blocks.clear();
+    if (blockFrames == 0) {
+        return false;
+    }
+
+    blocks.reserve((samples.size() + blockFrames - 1) / blockFrames);
+    for (std::size_t first = 0; first < samples.size(); first += blockFrames) {
+        const auto frames = samples.subspan(first, std::min(blockFrames, samples.size() - first));
+        std::vector<std::uint8_t>& block = blocks.emplace_back();
+        bool encoded = false;
+        switch (encoding) {
+            case RSYNSpectralEncoding::Quantised16:
+                encoded = encodeQuantisedSamples(frames, sharedFrequencies, phaseAdvancePerBin, block);
+                break;
+            case RSYNSpectralEncoding::Half16:
+                encoded = encodeHalfSamples(frames, sharedFrequencies, block);
+                break;
+            default:
+                encoded = encodeSamples(frames, sharedFrequencies, block);
+                break;
+        }
+        if (!encoded) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool decodeSamples(std::span<const std::uint8_t> input,
+                   SpectralSequence& samples,
+                   std::span<const float> sharedFrequencies,
                    const SequenceFrameCallback& onFrameDecoded,
                    const std::function<void(float)>& progress) {
     samples.clear();
+    samples.setSharedFrequencies(sharedFrequencies);
 
     std::size_t offset = 0;
     std::uint32_t frameCount = 0;
@@ -377,50 +965,15 @@ bool decodeSamples(const std::vector<std::uint8_t>& input,
         return false;
     }
 
-    samples.resize(frameCount);
+    samples.reserve(frameCount);
+    AudioColourSample sample{};
     const std::size_t callbackStride = std::max<std::size_t>(1, frameCount / 200U);
     for (std::uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
-        AudioColourSample& sample = samples[frameIndex];
-        if (!readFloat(input, offset, sample.timestamp) ||
-            !readFloat(input, offset, sample.sampleRate) ||
-            !readFloat(input, offset, sample.loudnessLUFS) ||
-            !readFloat(input, offset, sample.splDb) ||
-            !readIntegral(input, offset, sample.channels)) {
-            return false;
-        }
-
-        std::uint32_t magnitudeChannels = 0;
-        if (!readIntegral(input, offset, magnitudeChannels)) {
+        bool usesSharedAxis = false;
+        if (!readSample(input, offset, sharedFrequencies, sample, usesSharedAxis)) {
             return false;
         }
-        sample.magnitudes.resize(magnitudeChannels);
-        for (auto& channel : sample.magnitudes) {
-            if (!readFloatVector(input, offset, channel)) {
-                return false;
-            }
-        }
-
-        std::uint32_t phaseChannels = 0;
-        if (!readIntegral(input, offset, phaseChannels)) {
-            return false;
-        }
-        sample.phases.resize(phaseChannels);
-        for (auto& channel : sample.phases) {
-            if (!readFloatVector(input, offset, channel)) {
-                return false;
-            }
-        }
-
-        std::uint32_t frequencyChannels = 0;
-        if (!readIntegral(input, offset, frequencyChannels)) {
-            return false;
-        }
-        sample.frequencies.resize(frequencyChannels);
-        for (auto& channel : sample.frequencies) {
-            if (!readFloatVector(input, offset, channel)) {
-                return false;
-            }
-        }
+        appendDecoded(samples, sample, usesSharedAxis);
 
         if (onFrameDecoded && (((frameIndex + 1U) % callbackStride) == 0U || frameIndex + 1U == frameCount)) {
             onFrameDecoded(samples, frameIndex + 1U);
@@ -434,59 +987,292 @@ bool decodeSamples(const std::vector<std::uint8_t>& input,
     return offset == input.size();
 }
 
+bool decodeSampleBlock(std::span<const std::uint8_t> input,
+                       SpectralSequence& samples,
+                       const std::size_t firstFrame,
+                       std::span<const float> sharedFrequencies,
+                       const RSYNSpectralEncoding encoding,
+                       std::size_t& frameCount) {
+    frameCount = 0;
+    std::size_t offset = 0;
+    std::uint32_t blockFrames = 0;
+    double phaseAdvancePerBin = 0.0;
+    if (!readIntegral(input, offset, blockFrames) ||
+        (encoding == RSYNSpectralEncoding::Quantised16 && !readFloat(input, offset, phaseAdvancePerBin))) {
+        return false;
+    }
+
+    if (firstFrame > samples.size()) {
+        return false;
+    }
+    samples.truncate(firstFrame);
+    if (firstFrame == 0 || samples.sharedFrequencies().empty()) {
+        samples.setSharedFrequencies(sharedFrequencies);
+    }
+    samples.reserve(firstFrame + blockFrames);
+
+    std::vector<std::uint16_t> halves;
+    // Quantised phases predict from the previous frame, so the last decoded one stays staged.
+    AudioColourSample previous{};
+    AudioColourSample sample{};
+    for (std::uint32_t frameIndex = 0; frameIndex < blockFrames; ++frameIndex) {
+        bool usesSharedAxis = false;
+        bool decoded = false;
+        switch (encoding) {
+            case RSYNSpectralEncoding::Quantised16:
+                decoded = readQuantisedSample(input, offset, sharedFrequencies, phaseAdvancePerBin,
+                                              frameIndex > 0 ? &previous : nullptr, sample, usesSharedAxis);
+                break;
+            case RSYNSpectralEncoding::Half16:
+                decoded = readHalfSample(input, offset, sharedFrequencies, halves, sample, usesSharedAxis);
+                break;
+            default:
+                decoded = readSample(input, offset, sharedFrequencies, sample, usesSharedAxis);
+                break;
+        }
+        if (!decoded) {
+            return false;
+        }
+        appendDecoded(samples, sample, usesSharedAxis);
+        std::swap(previous, sample);
+    }
+
+    frameCount = blockFrames;
+    return offset == input.size();
+}
+
 bool encodePresentationFrames(const std::shared_ptr<RSYNPresentationData>& presentationData,
                               std::vector<std::uint8_t>& output) {
     output.clear();
-    if (presentationData == nullptr) {
-        appendIntegral(output, static_cast<std::uint32_t>(0));
-        return true;
+    const std::size_t frameCount = presentationData != nullptr ? presentationData->frames.size() : 0;
+    if (frameCount > std::numeric_limits<std::uint32_t>::max()) {
+        return false;
     }
 
-    appendIntegral(output, static_cast<std::uint32_t>(presentationData->frames.size()));
-    for (const RSYNPresentationFrame& frame : presentationData->frames) {
-        appendFloat(output, frame.timestamp);
-        writeFrameResult(output, frame.analysis);
-        writeSignals(output, frame.smoothingSignals);
-        writeFloatTriple(output, frame.targetOklab);
-        writeFloatTriple(output, frame.smoothedOklab);
-        writeFloatTriple(output, frame.smoothedLab);
-        writeFloatTriple(output, frame.smoothedDisplayRgb);
+    output.reserve(kPresentationHeaderSize + frameCount * sizeof(PresentationRecord));
+    appendIntegral(output, kPresentationMagic);
+    appendIntegral(output, kPresentationVersion);
+    appendIntegral(output, static_cast<std::uint32_t>(sizeof(PresentationRecord)));
+    appendIntegral(output, static_cast<std::uint32_t>(frameCount));
+
+    output.resize(kPresentationHeaderSize + frameCount * sizeof(PresentationRecord));
+    std::uint8_t* records = output.data() + kPresentationHeaderSize;
+    for (std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+        const PresentationRecord record = toRecord(presentationData->frames[frameIndex]);
+        std::memcpy(records + frameIndex * sizeof(PresentationRecord), &record, sizeof(PresentationRecord));
     }
     return true;
 }
 
-bool decodePresentationFrames(const std::vector<std::uint8_t>& input,
+bool decodePresentationFrames(std::span<const std::uint8_t> input,
                               AudioMetadata& metadata,
                               const std::function<void(float)>& progress) {
     if (metadata.presentationData == nullptr) {
         metadata.presentationData = std::make_shared<RSYNPresentationData>();
     }
 
-    metadata.presentationData->frames.clear();
-    std::size_t offset = 0;
+    std::vector<RSYNPresentationFrame>& frames = metadata.presentationData->frames;
+    frames.clear();
+    if (!hasPresentationMagic(input)) {
+        return decodeLegacyPresentationFrames(input, frames, progress);
+    }
+
+    std::uint32_t stride = 0;
     std::uint32_t frameCount = 0;
-    if (!readIntegral(input, offset, frameCount)) {
+    if (!readPresentationHeader(input, stride, frameCount)) {
         return false;
     }
 
-    metadata.presentationData->frames.resize(frameCount);
-    for (std::uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
-        RSYNPresentationFrame& frame = metadata.presentationData->frames[frameIndex];
-        if (!readFloat(input, offset, frame.timestamp) ||
-            !readFrameResult(input, offset, frame.analysis) ||
-            !readSignals(input, offset, frame.smoothingSignals) ||
-            !readFloatTriple(input, offset, frame.targetOklab) ||
-            !readFloatTriple(input, offset, frame.smoothedOklab) ||
-            !readFloatTriple(input, offset, frame.smoothedLab) ||
-            !readFloatTriple(input, offset, frame.smoothedDisplayRgb)) {
+    frames.resize(frameCount);
+    const std::uint8_t* records = input.data() + kPresentationHeaderSize;
+    const std::size_t progressStride = std::max<std::size_t>(1, frameCount / 200U);
+    for (std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+        PresentationRecord record;
+        std::memcpy(&record, records + frameIndex * stride, sizeof(PresentationRecord));
+        fromRecord(record, frames[frameIndex]);
+
+        if (progress && ((frameIndex + 1U) % progressStride == 0U || frameIndex + 1U == frameCount)) {
+            progress(static_cast<float>(frameIndex + 1U) / static_cast<float>(frameCount));
+        }
+    }
+
+    return true;
+}
+
+std::size_t presentationFrameCount(std::span<const std::uint8_t> input) {
+    std::uint32_t stride = 0;
+    std::uint32_t frameCount = 0;
+    return readPresentationHeader(input, stride, frameCount) ? frameCount : 0;
+}
+
+bool decodePresentationFrame(std::span<const std::uint8_t> input,
+                             const std::size_t frameIndex,
+                             RSYNPresentationFrame& frame) {
+    std::uint32_t stride = 0;
+    std::uint32_t frameCount = 0;
+    if (!readPresentationHeader(input, stride, frameCount) || frameIndex >= frameCount) {
+        return false;
+    }
+
+    PresentationRecord record;
+    std::memcpy(&record, input.data() + kPresentationHeaderSize + frameIndex * stride, sizeof(PresentationRecord));
+    fromRecord(record, frame);
+    return true;
+}
+
+bool encodePreview(const RSYNPreviewData& preview, std::vector<std::uint8_t>& output) {
+    output.clear();
+    if (preview.levels.empty() || preview.levels.size() > kPreviewMaxLevels) {
+        return false;
+    }
+
+    appendIntegral(output, kPreviewMagic);
+    appendIntegral(output, kPreviewVersion);
+    appendIntegral(output, static_cast<std::uint32_t>(preview.colourSpace));
+    appendIntegral(output, static_cast<std::uint32_t>(preview.applyGamutMapping ? 1U : 0U));
+    appendFloat(output, preview.firstTimestamp);
+    appendFloat(output, preview.lastTimestamp);
+    appendIntegral(output, static_cast<std::uint32_t>(preview.levels.size()));
+    for (const auto& level : preview.levels) {
+        if (level.empty() || level.size() > RSYNPreviewData::kPreviewColumns) {
+            output.clear();
             return false;
         }
+        appendIntegral(output, static_cast<std::uint32_t>(level.size()));
+        for (const RSYNPreviewColumn& column : level) {
+            for (const float value : column.oklab) {
+                appendIntegral(output, HalfFloat::fromFloat(value));
+            }
+            for (const float value : column.displayRgb) {
+                output.push_back(quantiseUnit(value));
+            }
+        }
+    }
+    return true;
+}
 
-        if (progress) {
-            progress(static_cast<float>(frameIndex + 1U) / static_cast<float>(std::max<std::uint32_t>(1U, frameCount)));
+bool decodePreview(std::span<const std::uint8_t> input, RSYNPreviewData& preview) {
+    std::size_t offset = 0;
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t colourSpace = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t levelCount = 0;
+    if (!readIntegral(input, offset, magic) || magic != kPreviewMagic ||
+        !readIntegral(input, offset, version) || version != kPreviewVersion ||
+        !readIntegral(input, offset, colourSpace) ||
+        !readIntegral(input, offset, flags) ||
+        !readFloat(input, offset, preview.firstTimestamp) ||
+        !readFloat(input, offset, preview.lastTimestamp) ||
+        !readIntegral(input, offset, levelCount) || levelCount == 0 || levelCount > kPreviewMaxLevels) {
+        return false;
+    }
+    preview.colourSpace = static_cast<ColourCore::ColourSpace>(colourSpace);
+    preview.applyGamutMapping = (flags & 1U) != 0;
+
+    constexpr std::size_t columnBytes = 3 * sizeof(std::uint16_t) + 3;
+    preview.levels.assign(levelCount, {});
+    for (auto& level : preview.levels) {
+        std::uint32_t columnCount = 0;
+        if (!readIntegral(input, offset, columnCount) || columnCount == 0 ||
+            columnCount > RSYNPreviewData::kPreviewColumns ||
+            input.size() - offset < static_cast<std::size_t>(columnCount) * columnBytes) {
+            return false;
+        }
+        level.resize(columnCount);
+        for (RSYNPreviewColumn& column : level) {
+            for (float& value : column.oklab) {
+                std::uint16_t half = 0;
+                readIntegral(input, offset, half);
+                value = HalfFloat::toFloat(half);
+            }
+            for (float& value : column.displayRgb) {
+                value = static_cast<float>(input[offset++]) / 255.0f;
+            }
+        }
+    }
+    return offset == input.size();
+}
+
+bool encodePeakTracks(const PhaseReconstruction::PeakTrackSequence& tracks, std::vector<std::uint8_t>& output) {
+    output.clear();
+    const std::size_t frameCount = tracks.frameCount();
+    if (tracks.frameStarts.empty() || tracks.frameStarts.front() != 0 || tracks.frameStarts.back() != tracks.peaks.size()) {
+        return false;
+    }
+
+    output.reserve(16 + frameCount * sizeof(std::uint16_t) + tracks.peaks.size() * 12);
+    appendIntegral(output, kPeakTrackMagic);
+    appendIntegral(output, kPeakTrackVersion);
+    appendIntegral(output, static_cast<std::uint32_t>(frameCount));
+    appendIntegral(output, static_cast<std::uint32_t>(tracks.peaks.size()));
+    for (std::size_t frame = 0; frame < frameCount; ++frame) {
+        const std::uint32_t count = tracks.frameStarts[frame + 1] - tracks.frameStarts[frame];
+        if (count > std::numeric_limits<std::uint16_t>::max()) {
+            output.clear();
+            return false;
         }
+        appendIntegral(output, static_cast<std::uint16_t>(count));
+    }
+    for (const PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        appendIntegral(output, peak.track);
+    }
+    for (const PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        appendFloat(output, peak.frequencyHz);
     }
+    for (const PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        appendIntegral(output, HalfFloat::fromFloat(peak.magnitude));
+    }
+    for (const PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        const long steps = std::lround(wrapPhase(static_cast<double>(peak.phase)) / kPhaseStep);
+        appendIntegral(output, static_cast<std::uint16_t>(static_cast<unsigned long>(steps) & 0xFFFFU));
+    }
+    return true;
+}
 
+bool decodePeakTracks(std::span<const std::uint8_t> input, PhaseReconstruction::PeakTrackSequence& tracks) {
+    std::size_t offset = 0;
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t frameCount = 0;
+    std::uint32_t peakCount = 0;
+    if (!readIntegral(input, offset, magic) || magic != kPeakTrackMagic ||
+        !readIntegral(input, offset, version) || version != kPeakTrackVersion ||
+        !readIntegral(input, offset, frameCount) ||
+        !readIntegral(input, offset, peakCount) ||
+        input.size() - offset != static_cast<std::size_t>(frameCount) * sizeof(std::uint16_t) +
+                                     static_cast<std::size_t>(peakCount) * 12) {
+        return false;
+    }
+
+    tracks.frameStarts.assign(1, 0);
+    tracks.frameStarts.reserve(static_cast<std::size_t>(frameCount) + 1);
+    for (std::uint32_t frame = 0; frame < frameCount; ++frame) {
+        std::uint16_t count = 0;
+        readIntegral(input, offset, count);
+        tracks.frameStarts.push_back(tracks.frameStarts.back() + count);
+    }
+    if (tracks.frameStarts.back() != peakCount) {
+        return false;
+    }
+
+    tracks.peaks.assign(peakCount, {});
+    for (PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        readIntegral(input, offset, peak.track);
+    }
+    for (PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        readFloat(input, offset, peak.frequencyHz);
+    }
+    for (PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        std::uint16_t half = 0;
+        readIntegral(input, offset, half);
+        peak.magnitude = HalfFloat::toFloat(half);
+    }
+    for (PhaseReconstruction::TrackedPeak& peak : tracks.peaks) {
+        std::uint16_t code = 0;
+        readIntegral(input, offset, code);
+        peak.phase = static_cast<float>(static_cast<double>(static_cast<std::int16_t>(code)) * kPhaseStep);
+    }
     return offset == input.size();
 }
 
@@ -1,33 +1,80 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "resyne/encoding/formats/exporter.h"
+#include "resyne/encoding/reconstruction/peak_tracking.h"
 
 namespace RSYNSerialisation {
 
-bool encodeMetadata(const AudioMetadata& metadata, std::vector<std::uint8_t>& output);
-bool decodeMetadata(const std::vector<std::uint8_t>& input, AudioMetadata& metadata);
+// Frames per independently compressed SPEC block; written to META so readers can seek.
+constexpr std::uint32_t kSpectralBlockFrames = 256;
+
+bool encodeMetadata(const AudioMetadata& metadata,
+                    std::vector<std::uint8_t>& output,
+                    RSYNSpectralEncoding spectralEncoding = RSYNSpectralEncoding::Float32);
+bool decodeMetadata(std::span<const std::uint8_t> input, AudioMetadata& metadata);
 
 bool encodeSourceBytes(const std::shared_ptr<RSYNSourceData>& sourceData,
                        std::vector<std::uint8_t>& output);
-bool decodeSourceBytes(const std::vector<std::uint8_t>& input,
+bool decodeSourceBytes(std::span<const std::uint8_t> input,
                        AudioMetadata& metadata);
 
-bool encodeSamples(const std::vector<AudioColourSample>& samples,
+bool encodeFrequencyAxis(std::span<const float> axis,
+                         std::vector<std::uint8_t>& output);
+bool decodeFrequencyAxis(std::span<const std::uint8_t> input,
+                         std::vector<float>& axis);
+
+bool encodeSamples(SpectralSequenceView samples,
+                   std::span<const float> sharedFrequencies,
                    std::vector<std::uint8_t>& output);
-bool decodeSamples(const std::vector<std::uint8_t>& input,
-                   std::vector<AudioColourSample>& samples,
+// phaseAdvancePerBin (2*pi*hop/fftSize) is only used by Quantised16, which predicts each
+// phase from the previous frame of the same block.
+bool encodeSampleBlocks(SpectralSequenceView samples,
+                        std::span<const float> sharedFrequencies,
+                        std::size_t blockFrames,
+                        RSYNSpectralEncoding encoding,
+                        double phaseAdvancePerBin,
+                        std::vector<std::vector<std::uint8_t>>& blocks);
+bool decodeSamples(std::span<const std::uint8_t> input,
+                   SpectralSequence& samples,
+                   std::span<const float> sharedFrequencies = {},
                    const SequenceFrameCallback& onFrameDecoded = {},
                    const std::function<void(float)>& progress = {});
+// Decodes one SPEC block into samples from firstFrame on, dropping any frames after it;
+// firstFrame must not lie past the end of samples.
+bool decodeSampleBlock(std::span<const std::uint8_t> input,
+                       SpectralSequence& samples,
+                       std::size_t firstFrame,
+                       std::span<const float> sharedFrequencies,
+                       RSYNSpectralEncoding encoding,
+                       std::size_t& frameCount);
 
 bool encodePresentationFrames(const std::shared_ptr<RSYNPresentationData>& presentationData,
                               std::vector<std::uint8_t>& output);
-bool decodePresentationFrames(const std::vector<std::uint8_t>& input,
+bool decodePresentationFrames(std::span<const std::uint8_t> input,
                               AudioMetadata& metadata,
                               const std::function<void(float)>& progress = {});
+// Random access into a v2 PRES chunk without decoding the other frames. Pre-v2 chunks
+// report zero frames and fail to decode here; decodePresentationFrames still reads them.
+std::size_t presentationFrameCount(std::span<const std::uint8_t> input);
+bool decodePresentationFrame(std::span<const std::uint8_t> input,
+                             std::size_t frameIndex,
+                             RSYNPresentationFrame& frame);
+
+// PREV stores Oklab as half floats and display RGB as 8-bit codes, about 9 bytes a column.
+bool encodePreview(const RSYNPreviewData& preview, std::vector<std::uint8_t>& output);
+bool decodePreview(std::span<const std::uint8_t> input, RSYNPreviewData& preview);
+
+// PEAK stores each frame's peak count, then the track ids, frequencies, half-float
+// magnitudes and 16-bit phases of every peak as separate planes: 12 bytes a peak before
+// deflate, against 8 bytes a bin for the dense SPEC frame.
+bool encodePeakTracks(const PhaseReconstruction::PeakTrackSequence& tracks, std::vector<std::uint8_t>& output);
+bool decodePeakTracks(std::span<const std::uint8_t> input, PhaseReconstruction::PeakTrackSequence& tracks);
 
 }
@@ -0,0 +1,428 @@
+#include "resyne/encoding/formats/spectral_sequence.h"
+
+#include <algorithm>
+
+namespace {
+
+std::uint32_t channelsWithData(const SpectralChannels& channels) {
+	return static_cast<std::uint32_t>(channels.size());
+}
+
+size_t widestChannel(const SpectralChannels& channels) {
+	size_t width = 0;
+	for (const auto channel : channels) {
+		width = std::max(width, channel.size());
+	}
+	return width;
+}
+
+size_t channelsIn(const SpectralFrame& frame) {
+	return std::max(frame.magnitudes.size(), frame.phases.size());
+}
+
+size_t binsIn(const SpectralFrame& frame) {
+	return std::max({widestChannel(frame.magnitudes), widestChannel(frame.phases), widestChannel(frame.frequencies)});
+}
+
+void copyChannels(const SpectralChannels& source, std::span<float> destination, const size_t binCount) {
+	const size_t channelCount = binCount > 0 ? std::min(source.size(), destination.size() / binCount) : 0;
+	for (size_t channel = 0; channel < channelCount; ++channel) {
+		const auto values = source[channel];
+		std::copy_n(values.begin(), std::min(values.size(), binCount), destination.begin() + static_cast<std::ptrdiff_t>(channel * binCount));
+	}
+}
+
+}
+
+SpectralFrame::SpectralFrame(const AudioColourSample& sample)
+	: magnitudes(sample.magnitudes),
+	  phases(sample.phases),
+	  frequencies(sample.frequencies),
+	  timestamp(sample.timestamp),
+	  sampleRate(sample.sampleRate),
+	  loudnessLUFS(sample.loudnessLUFS),
+	  splDb(sample.splDb),
+	  channels(sample.channels) {}
+
+AudioColourSample SpectralFrame::toSample() const {
+	const auto copy = [](const SpectralChannels& source, std::vector<std::vector<float>>& destination) {
+		destination.resize(source.size());
+		for (size_t channel = 0; channel < source.size(); ++channel) {
+			destination[channel].assign(source[channel].begin(), source[channel].end());
+		}
+	};
+
+	AudioColourSample sample{};
+	sample.timestamp = timestamp;
+	sample.sampleRate = sampleRate;
+	sample.loudnessLUFS = loudnessLUFS;
+	sample.splDb = splDb;
+	sample.channels = channels;
+	copy(magnitudes, sample.magnitudes);
+	copy(phases, sample.phases);
+	copy(frequencies, sample.frequencies);
+	return sample;
+}
+
+SpectralSequenceView SpectralSequenceView::subspan(const size_t offset, const size_t count) const {
+	const size_t start = std::min(offset, frameCount);
+	return {*sequence, firstFrame + start, std::min(count, frameCount - start)};
+}
+
+SpectralSequence::SpectralSequence(const size_t channelCount, const size_t binCount) {
+	reset(channelCount, binCount);
+}
+
+void SpectralSequence::reset(const size_t channelCount, const size_t binCount) {
+	clear();
+	channels = channelCount;
+	bins = binCount;
+	sharedAxis.clear();
+}
+
+void SpectralSequence::reserve(const size_t frameCount) {
+	frames.reserve(frameCount);
+	chunks.reserve((frameCount + kChunkFrames - 1) / kChunkFrames);
+	reservedFrames = std::max(reservedFrames, frameCount);
+}
+
+void SpectralSequence::clear() {
+	frames.clear();
+	chunks.clear();
+	frequencyOverrides.clear();
+	overrideCount = 0;
+	reservedFrames = 0;
+	releasedFrames = 0;
+}
+
+void SpectralSequence::truncate(const size_t frameCount) {
+	if (frameCount >= frames.size()) {
+		return;
+	}
+	frames.resize(frameCount);
+	releasedFrames = std::min(releasedFrames, frameCount);
+	chunks.resize((frameCount + kChunkFrames - 1) / kChunkFrames);
+	if (!chunks.empty()) {
+		const size_t keep = (frameCount - (chunks.size() - 1) * kChunkFrames) * stride();
+		Chunk& last = chunks.back();
+		// A released chunk comes back zeroed, so frames appended after it land at their offsets.
+		last.magnitudes.resize(keep, 0.0f);
+		last.phases.resize(keep, 0.0f);
+	}
+	// Overrides of dropped frames stay in the slab unreferenced until the next clear.
+}
+
+// Repacks every stored frame at the new shape. Only reached when a wider frame arrives
+// after narrower ones, which a track analysed at one FFT size never does.
+void SpectralSequence::widen(const size_t channelCount, const size_t binCount) {
+	const size_t newChannels = std::max(channels, channelCount);
+	const size_t newBins = std::max(bins, binCount);
+	if (newChannels == channels && newBins == bins) {
+		return;
+	}
+
+	const size_t newStride = newChannels * newBins;
+	const auto repack = [&](const std::vector<float>& source, const size_t blockCount) {
+		std::vector<float> packed(blockCount * newStride, 0.0f);
+		for (size_t block = 0; block < blockCount; ++block) {
+			for (size_t channel = 0; channel < channels; ++channel) {
+				const auto first = source.begin() + static_cast<std::ptrdiff_t>((block * channels + channel) * bins);
+				std::copy_n(first, bins, packed.begin() + static_cast<std::ptrdiff_t>((block * newChannels + channel) * newBins));
+			}
+		}
+		return packed;
+	};
+
+	// Released chunks hold no blocks and stay empty.
+	for (size_t index = 0; index < chunks.size(); ++index) {
+		Chunk& chunk = chunks[index];
+		const size_t framesInChunk = std::min(kChunkFrames, frames.size() - index * kChunkFrames);
+		const size_t stored = stride() > 0 ? chunk.magnitudes.size() / stride() : framesInChunk;
+		chunk.magnitudes = repack(chunk.magnitudes, stored);
+		chunk.phases = repack(chunk.phases, stored);
+	}
+	frequencyOverrides = repack(frequencyOverrides, overrideCount);
+	channels = newChannels;
+	bins = newBins;
+}
+
+size_t SpectralSequence::appendFrame(const SpectralFrameInfo& info, const size_t channelCount, const size_t binCount) {
+	widen(channelCount, binCount);
+	const size_t frame = frames.size();
+	frames.push_back(info);
+	SpectralFrameInfo& stored = frames.back();
+	stored.magnitudeChannels = static_cast<std::uint32_t>(channelCount);
+	stored.phaseChannels = static_cast<std::uint32_t>(channelCount);
+	stored.frequencyChannels = 0;
+	stored.binCount = static_cast<std::uint32_t>(binCount);
+	stored.hasFrequencies = false;
+	stored.frequencyOverride = NO_FREQUENCY_OVERRIDE;
+
+	if (frame % kChunkFrames == 0) {
+		Chunk& chunk = chunks.emplace_back();
+		const size_t expected = std::clamp(reservedFrames > frame ? reservedFrames - frame : size_t{1},
+										   size_t{1}, kChunkFrames);
+		chunk.magnitudes.reserve(expected * stride());
+		chunk.phases.reserve(expected * stride());
+	}
+	Chunk& chunk = chunks.back();
+	chunk.magnitudes.resize(chunk.magnitudes.size() + stride(), 0.0f);
+	chunk.phases.resize(chunk.phases.size() + stride(), 0.0f);
+	return frame;
+}
+
+size_t SpectralSequence::appendFrequencyOverride(const size_t frame) {
+	frequencyOverrides.resize(frequencyOverrides.size() + stride(), 0.0f);
+	frames[frame].frequencyOverride = overrideCount++;
+	return overrideOffset(frame, 0);
+}
+
+size_t SpectralSequence::appendFrame(const SpectralFrame& source) {
+	const size_t frame = appendFrame(SpectralFrameInfo{}, channelsIn(source), binsIn(source));
+	writeFrame(frame, source);
+	return frame;
+}
+
+void SpectralSequence::writeFrame(const size_t frame, const SpectralFrame& source) {
+	SpectralFrameInfo& stored = frames[frame];
+	stored.timestamp = source.timestamp;
+	stored.sampleRate = source.sampleRate;
+	stored.loudnessLUFS = source.loudnessLUFS;
+	stored.splDb = source.splDb;
+	stored.channels = source.channels;
+	stored.magnitudeChannels = channelsWithData(source.magnitudes);
+	stored.phaseChannels = channelsWithData(source.phases);
+	stored.binCount = static_cast<std::uint32_t>(binsIn(source));
+
+	if (channelsIn(source) > 0 && stride() > 0) {
+		const size_t base = chunkOffset(frame, 0);
+		Chunk& chunk = chunks[frame / kChunkFrames];
+		const std::span<float> magnitudeBlock = std::span<float>(chunk.magnitudes).subspan(base, stride());
+		const std::span<float> phaseBlock = std::span<float>(chunk.phases).subspan(base, stride());
+		std::fill(magnitudeBlock.begin(), magnitudeBlock.end(), 0.0f);
+		std::fill(phaseBlock.begin(), phaseBlock.end(), 0.0f);
+		copyChannels(source.magnitudes, magnitudeBlock, bins);
+		copyChannels(source.phases, phaseBlock, bins);
+	}
+
+	const bool hasFrequencies = std::any_of(source.frequencies.begin(), source.frequencies.end(),
+		[](const std::span<const float> channel) { return !channel.empty(); });
+	stored.hasFrequencies = hasFrequencies;
+	stored.frequencyChannels = hasFrequencies ? channelsWithData(source.frequencies) : 0;
+	if (!hasFrequencies) {
+		stored.frequencyOverride = NO_FREQUENCY_OVERRIDE;
+		return;
+	}
+	if (sharedAxis.empty()) {
+		setSharedFrequencies(source.frequencies.front());
+	}
+	if (matchesFrequencies(source.frequencies, sharedAxis)) {
+		// A dropped override stays in the slab unreferenced until the next clear.
+		stored.frequencyOverride = NO_FREQUENCY_OVERRIDE;
+		return;
+	}
+	const size_t overrideBase = stored.frequencyOverride == NO_FREQUENCY_OVERRIDE
+		? appendFrequencyOverride(frame)
+		: overrideOffset(frame, 0);
+	const std::span<float> block = std::span<float>(frequencyOverrides).subspan(overrideBase, stride());
+	std::fill(block.begin(), block.end(), 0.0f);
+	copyChannels(source.frequencies, block, bins);
+}
+
+bool SpectralSequence::fitsInPlace(const size_t frame, const SpectralFrame& source) const {
+	if (channelsIn(source) == 0) {
+		return true;
+	}
+	const size_t binCount = binsIn(source);
+	if (channelsIn(source) > channels || binCount > bins || binCount == 0) {
+		return false;
+	}
+	return chunks[frame / kChunkFrames].magnitudes.size() >= chunkOffset(frame, 0) + stride();
+}
+
+void SpectralSequence::append(const SpectralSequenceView source) {
+	reserve(size() + source.size());
+	for (const SpectralFrame frame : source) {
+		appendFrame(frame);
+	}
+}
+
+void SpectralSequence::replaceFrames(const size_t firstFrame, const SpectralSequenceView source) {
+	if (firstFrame == frames.size()) {
+		append(source);
+		return;
+	}
+
+	// Frames that fit the slab shape, over frames whose blocks are still stored, are written
+	// where they stand, so filling a pre-sized track range by range stays linear.
+	bool inPlace = firstFrame + source.size() <= frames.size();
+	for (size_t index = 0; inPlace && index < source.size(); ++index) {
+		inPlace = fitsInPlace(firstFrame + index, source[index]);
+	}
+	if (inPlace) {
+		for (size_t index = 0; index < source.size(); ++index) {
+			writeFrame(firstFrame + index, source[index]);
+		}
+		return;
+	}
+
+	// Otherwise rebuilt from firstFrame on, widening the slabs for the new frames.
+	SpectralSequence tail;
+	tail.sharedAxis = sharedAxis;
+	tail.reserve(frames.size() > firstFrame + source.size() ? frames.size() - firstFrame : source.size());
+	tail.append(source);
+	if (firstFrame + source.size() < frames.size()) {
+		tail.append(SpectralSequenceView(*this, firstFrame + source.size(), frames.size() - firstFrame - source.size()));
+	}
+	truncate(firstFrame);
+	append(tail);
+}
+
+void SpectralSequence::releaseSpectra(const size_t frameCount) {
+	const size_t count = std::min(frameCount, frames.size());
+	for (size_t frame = releasedFrames; frame < count; ++frame) {
+		SpectralFrameInfo& info = frames[frame];
+		info.magnitudeChannels = 0;
+		info.phaseChannels = 0;
+		info.frequencyChannels = 0;
+		info.binCount = 0;
+		info.hasFrequencies = false;
+		info.frequencyOverride = NO_FREQUENCY_OVERRIDE;
+	}
+	for (size_t chunk = releasedFrames / kChunkFrames; chunk < count / kChunkFrames; ++chunk) {
+		chunks[chunk].magnitudes = {};
+		chunks[chunk].phases = {};
+	}
+	releasedFrames = std::max(releasedFrames, count);
+}
+
+SpectralFrame SpectralSequence::operator[](const size_t frame) const {
+	const SpectralFrameInfo& info = frames[frame];
+	SpectralFrame view;
+	view.timestamp = info.timestamp;
+	view.sampleRate = info.sampleRate;
+	view.loudnessLUFS = info.loudnessLUFS;
+	view.splDb = info.splDb;
+	view.channels = info.channels;
+
+	const Chunk& chunk = chunks[frame / kChunkFrames];
+	const size_t base = chunkOffset(frame, 0);
+	if (info.magnitudeChannels > 0) {
+		view.magnitudes = SpectralChannels(chunk.magnitudes.data() + base, info.magnitudeChannels, info.binCount, bins);
+	}
+	if (info.phaseChannels > 0) {
+		view.phases = SpectralChannels(chunk.phases.data() + base, info.phaseChannels, info.binCount, bins);
+	}
+	if (info.hasFrequencies) {
+		view.frequencies = info.frequencyOverride == NO_FREQUENCY_OVERRIDE
+			? SpectralChannels(sharedAxis.data(), info.frequencyChannels, sharedAxis.size(), 0)
+			: SpectralChannels(frequencyOverrides.data() + overrideOffset(frame, 0), info.frequencyChannels, info.binCount, bins);
+	}
+	return view;
+}
+
+std::span<float> SpectralSequence::magnitudes(const size_t frame, const size_t channel) {
+	if (frames[frame].binCount == 0) {
+		return {};
+	}
+	return {chunks[frame / kChunkFrames].magnitudes.data() + chunkOffset(frame, channel), frames[frame].binCount};
+}
+
+std::span<const float> SpectralSequence::magnitudes(const size_t frame, const size_t channel) const {
+	if (frames[frame].binCount == 0) {
+		return {};
+	}
+	return {chunks[frame / kChunkFrames].magnitudes.data() + chunkOffset(frame, channel), frames[frame].binCount};
+}
+
+std::span<float> SpectralSequence::phases(const size_t frame, const size_t channel) {
+	if (frames[frame].binCount == 0) {
+		return {};
+	}
+	return {chunks[frame / kChunkFrames].phases.data() + chunkOffset(frame, channel), frames[frame].binCount};
+}
+
+std::span<const float> SpectralSequence::phases(const size_t frame, const size_t channel) const {
+	if (frames[frame].binCount == 0) {
+		return {};
+	}
+	return {chunks[frame / kChunkFrames].phases.data() + chunkOffset(frame, channel), frames[frame].binCount};
+}
+
+std::span<float> SpectralSequence::frequencies(const size_t frame, const size_t channel) {
+	SpectralFrameInfo& info = frames[frame];
+	if (info.frequencyOverride == NO_FREQUENCY_OVERRIDE) {
+		const size_t base = appendFrequencyOverride(frame);
+		if (info.hasFrequencies) {
+			for (size_t index = 0; index < channels; ++index) {
+				std::copy_n(sharedAxis.begin(), std::min(sharedAxis.size(), bins),
+							frequencyOverrides.begin() + static_cast<std::ptrdiff_t>(base + index * bins));
+			}
+		}
+		info.hasFrequencies = true;
+		info.frequencyChannels = std::max(info.frequencyChannels, info.magnitudeChannels);
+	}
+	return {frequencyOverrides.data() + overrideOffset(frame, channel), info.binCount};
+}
+
+std::span<const float> SpectralSequence::frequencies(const size_t frame, const size_t channel) const {
+	const SpectralFrameInfo& info = frames[frame];
+	if (!info.hasFrequencies) {
+		return {};
+	}
+	if (info.frequencyOverride == NO_FREQUENCY_OVERRIDE) {
+		return sharedAxis;
+	}
+	return {frequencyOverrides.data() + overrideOffset(frame, channel), info.binCount};
+}
+
+void SpectralSequence::setUsesSharedFrequencies(const size_t frame, const bool usesShared) {
+	SpectralFrameInfo& info = frames[frame];
+	info.hasFrequencies = usesShared;
+	info.frequencyChannels = usesShared ? info.magnitudeChannels : 0;
+	info.frequencyOverride = NO_FREQUENCY_OVERRIDE;
+}
+
+void SpectralSequence::setSharedFrequencies(std::span<const float> axis) {
+	sharedAxis.assign(axis.begin(), axis.end());
+}
+
+bool SpectralSequence::usesSharedFrequencies(const size_t frame) const {
+	return frames[frame].hasFrequencies && frames[frame].frequencyOverride == NO_FREQUENCY_OVERRIDE;
+}
+
+size_t SpectralSequence::storedBytes() const {
+	size_t bytes = frames.capacity() * sizeof(SpectralFrameInfo) +
+		(sharedAxis.capacity() + frequencyOverrides.capacity()) * sizeof(float);
+	for (const Chunk& chunk : chunks) {
+		bytes += (chunk.magnitudes.capacity() + chunk.phases.capacity()) * sizeof(float);
+	}
+	return bytes;
+}
+
+AudioColourSample SpectralSequence::toSample(const size_t frame) const {
+	return (*this)[frame].toSample();
+}
+
+std::vector<float> SpectralSequence::detectSharedFrequencies(const SpectralSequenceView source) {
+	for (const SpectralFrame frame : source) {
+		if (!frame.frequencies.empty() && !frame.frequencies.front().empty()) {
+			const auto axis = frame.frequencies.front();
+			return {axis.begin(), axis.end()};
+		}
+	}
+	return {};
+}
+
+bool SpectralSequence::matchesFrequencies(const SpectralChannels& channelFrequencies,
+										  std::span<const float> axis) {
+	if (axis.empty() || channelFrequencies.empty()) {
+		return false;
+	}
+	for (const auto channel : channelFrequencies) {
+		if (!std::equal(channel.begin(), channel.end(), axis.begin(), axis.end())) {
+			return false;
+		}
+	}
+	return true;
+}
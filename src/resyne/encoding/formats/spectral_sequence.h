@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <vector>
+
+// One frame that owns its spectra, for code that builds frames one at a time before
+// appending them to a SpectralSequence.
+struct AudioColourSample {
+	std::vector<std::vector<float>> magnitudes;
+	std::vector<std::vector<float>> phases;
+	std::vector<std::vector<float>> frequencies;
+	double timestamp;
+	float sampleRate;
+	float loudnessLUFS = std::numeric_limits<float>::quiet_NaN();
+	float splDb = std::numeric_limits<float>::quiet_NaN();
+	std::uint32_t channels = 1;
+};
+
+inline constexpr size_t NO_FREQUENCY_OVERRIDE = std::numeric_limits<size_t>::max();
+
+struct SpectralFrameInfo {
+	double timestamp = 0.0;
+	float sampleRate = 0.0f;
+	float loudnessLUFS = std::numeric_limits<float>::quiet_NaN();
+	float splDb = std::numeric_limits<float>::quiet_NaN();
+	std::uint32_t channels = 1;
+	// How many channels of each field hold data, and their width; zero for a frame whose
+	// spectra were released or never stored.
+	std::uint32_t magnitudeChannels = 0;
+	std::uint32_t phaseChannels = 0;
+	std::uint32_t frequencyChannels = 0;
+	std::uint32_t binCount = 0;
+	bool hasFrequencies = false;
+	size_t frequencyOverride = NO_FREQUENCY_OVERRIDE;
+};
+
+// One field of one frame as a read-only span per channel: a slice of a packed sequence, or
+// the vectors of an AudioColourSample.
+class SpectralChannels {
+public:
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using iterator_concept = std::random_access_iterator_tag;
+		using value_type = std::span<const float>;
+		using difference_type = std::ptrdiff_t;
+		using reference = std::span<const float>;
+
+		iterator() = default;
+		iterator(const SpectralChannels* channels, size_t start) : owner(channels), index(start) {}
+
+		std::span<const float> operator*() const { return (*owner)[index]; }
+		iterator& operator++() { ++index; return *this; }
+		iterator operator++(int) { iterator previous = *this; ++index; return previous; }
+		bool operator==(const iterator& other) const { return index == other.index; }
+
+	private:
+		const SpectralChannels* owner = nullptr;
+		size_t index = 0;
+	};
+
+	SpectralChannels() = default;
+	SpectralChannels(const float* first, size_t channelCount, size_t binCount, size_t channelStride)
+		: base(first), count(channelCount), bins(binCount), stride(channelStride) {}
+	SpectralChannels(const std::vector<std::vector<float>>& channels)
+		: nested(channels.data()), count(channels.size()) {}
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	std::span<const float> operator[](const size_t channel) const {
+		if (nested != nullptr) {
+			return nested[channel];
+		}
+		return {base + channel * stride, bins};
+	}
+	std::span<const float> front() const { return (*this)[0]; }
+	std::span<const float> back() const { return (*this)[count - 1]; }
+	iterator begin() const { return {this, 0}; }
+	iterator end() const { return {this, count}; }
+
+private:
+	const float* base = nullptr;
+	const std::vector<float>* nested = nullptr;
+	size_t count = 0;
+	size_t bins = 0;
+	size_t stride = 0;
+};
+
+// A read-only frame, laid out like AudioColourSample so code reading either looks the same.
+// It points into its sequence, or the sample it was made from, and lives no longer than that.
+struct SpectralFrame {
+	SpectralChannels magnitudes;
+	SpectralChannels phases;
+	SpectralChannels frequencies;
+	double timestamp = 0.0;
+	float sampleRate = 0.0f;
+	float loudnessLUFS = std::numeric_limits<float>::quiet_NaN();
+	float splDb = std::numeric_limits<float>::quiet_NaN();
+	std::uint32_t channels = 1;
+
+	SpectralFrame() = default;
+	SpectralFrame(const AudioColourSample& sample);
+
+	AudioColourSample toSample() const;
+};
+
+class SpectralSequence;
+
+// Random access over the frames of a sequence; dereferencing yields a SpectralFrame by value.
+class SpectralFrameIterator {
+public:
+	using iterator_category = std::input_iterator_tag;
+	using iterator_concept = std::random_access_iterator_tag;
+	using value_type = SpectralFrame;
+	using difference_type = std::ptrdiff_t;
+	using reference = SpectralFrame;
+
+	SpectralFrameIterator() = default;
+	SpectralFrameIterator(const SpectralSequence* source, size_t start) : sequence(source), index(start) {}
+
+	SpectralFrame operator*() const;
+	SpectralFrame operator[](difference_type offset) const;
+	SpectralFrameIterator& operator++() { ++index; return *this; }
+	SpectralFrameIterator operator++(int) { SpectralFrameIterator previous = *this; ++index; return previous; }
+	SpectralFrameIterator& operator--() { --index; return *this; }
+	SpectralFrameIterator operator--(int) { SpectralFrameIterator previous = *this; --index; return previous; }
+	SpectralFrameIterator& operator+=(const difference_type offset) { index += static_cast<size_t>(offset); return *this; }
+	SpectralFrameIterator& operator-=(const difference_type offset) { index -= static_cast<size_t>(offset); return *this; }
+	friend SpectralFrameIterator operator+(SpectralFrameIterator it, const difference_type offset) { return it += offset; }
+	friend SpectralFrameIterator operator+(const difference_type offset, SpectralFrameIterator it) { return it += offset; }
+	friend SpectralFrameIterator operator-(SpectralFrameIterator it, const difference_type offset) { return it -= offset; }
+	friend difference_type operator-(const SpectralFrameIterator& lhs, const SpectralFrameIterator& rhs) {
+		return static_cast<difference_type>(lhs.index) - static_cast<difference_type>(rhs.index);
+	}
+	bool operator==(const SpectralFrameIterator& other) const { return index == other.index; }
+	auto operator<=>(const SpectralFrameIterator& other) const { return index <=> other.index; }
+
+	size_t frameIndex() const { return index; }
+
+private:
+	const SpectralSequence* sequence = nullptr;
+	size_t index = 0;
+};
+
+// A run of consecutive frames of one sequence, the SpectralSequence counterpart of a span.
+class SpectralSequenceView {
+public:
+	SpectralSequenceView() = default;
+	SpectralSequenceView(const SpectralSequence& source);
+	SpectralSequenceView(const SpectralSequence& source, size_t first, size_t count)
+		: sequence(&source), firstFrame(first), frameCount(count) {}
+
+	size_t size() const { return frameCount; }
+	bool empty() const { return frameCount == 0; }
+	SpectralFrame operator[](size_t frame) const;
+	SpectralFrame front() const { return (*this)[0]; }
+	SpectralFrame back() const { return (*this)[frameCount - 1]; }
+	SpectralFrameIterator begin() const { return {sequence, firstFrame}; }
+	SpectralFrameIterator end() const { return {sequence, firstFrame + frameCount}; }
+	SpectralSequenceView subspan(size_t offset, size_t count = std::numeric_limits<size_t>::max()) const;
+	SpectralSequenceView first(const size_t count) const { return subspan(0, count); }
+
+	// The sequence viewed and where in it the view starts, for reading its slabs directly.
+	const SpectralSequence* source() const { return sequence; }
+	size_t offset() const { return firstFrame; }
+
+private:
+	const SpectralSequence* sequence = nullptr;
+	size_t firstFrame = 0;
+	size_t frameCount = 0;
+};
+
+// Packed spectral storage: magnitudes and phases live in [frame][channel][bin] slabs, one per
+// field for every kChunkFrames frames, so a whole track costs a few hundred allocations
+// rather than up to nine per frame, and growing it never copies what is already stored.
+// Channels narrower than the widest are zero-padded and read back at their own width.
+// Frequencies live on a single shared axis; only frames whose axis differs (TIFF edits,
+// varispeed) carry their own block in the override slab.
+class SpectralSequence {
+public:
+	static constexpr size_t kChunkFrames = 64;
+
+	SpectralSequence() = default;
+	SpectralSequence(size_t channelCount, size_t binCount);
+
+	// Drops every frame and sets the slab shape; appending wider frames widens it again.
+	void reset(size_t channelCount, size_t binCount);
+	void reserve(size_t frameCount);
+	void clear();
+	// Keeps the first frameCount frames.
+	void truncate(size_t frameCount);
+
+	// Appends a frame of channelCount zeroed channels of binCount bins, to be written through
+	// magnitudes() and phases().
+	size_t appendFrame(const SpectralFrameInfo& info, size_t channelCount, size_t binCount);
+	size_t appendFrame(const SpectralFrame& frame);
+	void append(SpectralSequenceView source);
+	// Overwrites frames [firstFrame, firstFrame + source.size()), appending past the end.
+	// Frames that fit the slab shape are written in place; otherwise the tail is rebuilt.
+	void replaceFrames(size_t firstFrame, SpectralSequenceView source);
+	// Forgets the spectra of the first frameCount frames, keeping their timestamps and
+	// loudness, and frees every chunk they fill.
+	void releaseSpectra(size_t frameCount);
+
+	size_t size() const { return frames.size(); }
+	size_t frameCount() const { return frames.size(); }
+	size_t channelCount() const { return channels; }
+	size_t binCount() const { return bins; }
+	bool empty() const { return frames.empty(); }
+
+	SpectralFrame operator[](size_t frame) const;
+	SpectralFrame front() const { return (*this)[0]; }
+	SpectralFrame back() const { return (*this)[frames.size() - 1]; }
+	SpectralFrameIterator begin() const { return {this, 0}; }
+	SpectralFrameIterator end() const { return {this, frames.size()}; }
+
+	std::span<float> magnitudes(size_t frame, size_t channel);
+	std::span<const float> magnitudes(size_t frame, size_t channel) const;
+	std::span<float> phases(size_t frame, size_t channel);
+	std::span<const float> phases(size_t frame, size_t channel) const;
+	// The mutable overload gives the frame its own axis first, copied from the shared one.
+	std::span<float> frequencies(size_t frame, size_t channel);
+	std::span<const float> frequencies(size_t frame, size_t channel) const;
+	// Gives the frame frequencies on the shared axis, or drops them.
+	void setUsesSharedFrequencies(size_t frame, bool usesShared);
+
+	void setSharedFrequencies(std::span<const float> axis);
+	std::span<const float> sharedFrequencies() const { return sharedAxis; }
+	bool usesSharedFrequencies(size_t frame) const;
+
+	SpectralFrameInfo& frameInfo(size_t frame) { return frames[frame]; }
+	const SpectralFrameInfo& frameInfo(size_t frame) const { return frames[frame]; }
+
+	// Bytes held by the slabs, for memory accounting.
+	size_t storedBytes() const;
+
+	AudioColourSample toSample(size_t frame) const;
+
+	static std::vector<float> detectSharedFrequencies(SpectralSequenceView source);
+	static bool matchesFrequencies(const SpectralChannels& channelFrequencies, std::span<const float> axis);
+
+private:
+	struct Chunk {
+		std::vector<float> magnitudes;
+		std::vector<float> phases;
+	};
+
+	size_t stride() const { return channels * bins; }
+	size_t chunkOffset(const size_t frame, const size_t channel) const {
+		return ((frame % kChunkFrames) * channels + channel) * bins;
+	}
+	size_t overrideOffset(const size_t frame, const size_t channel) const {
+		return (frames[frame].frequencyOverride * channels + channel) * bins;
+	}
+
+	void widen(size_t channelCount, size_t binCount);
+	size_t appendFrequencyOverride(size_t frame);
+	void writeFrame(size_t frame, const SpectralFrame& source);
+	bool fitsInPlace(size_t frame, const SpectralFrame& source) const;
+
+	size_t channels = 0;
+	size_t bins = 0;
+	size_t reservedFrames = 0;
+	size_t releasedFrames = 0;
+	std::vector<SpectralFrameInfo> frames;
+	std::vector<Chunk> chunks;
+	std::vector<float> sharedAxis;
+	std::vector<float> frequencyOverrides;
+	size_t overrideCount = 0;
+};
+
+inline SpectralSequenceView::SpectralSequenceView(const SpectralSequence& source)
+	: sequence(&source), firstFrame(0), frameCount(source.size()) {}
+
+inline SpectralFrame SpectralSequenceView::operator[](const size_t frame) const {
+	return (*sequence)[firstFrame + frame];
+}
+
+inline SpectralFrame SpectralFrameIterator::operator*() const {
+	return (*sequence)[index];
+}
+
+inline SpectralFrame SpectralFrameIterator::operator[](const difference_type offset) const {
+	return (*sequence)[index + static_cast<size_t>(offset)];
+}
@@ -0,0 +1,96 @@
+#include "crc32_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+#include "utilities/cpu/cpu_features.h"
+
+namespace CRC32SSE {
+
+// Built with PCLMULQDQ enabled, so the folding only runs once the CPU is known to have it.
+// MSVC has no __PCLMUL__ and needs no flag for the intrinsic.
+#if defined(__PCLMUL__) || defined(_MSC_VER)
+
+namespace {
+
+// Folding constants x^k mod P for the reflected zlib polynomial, from Intel's "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction": four lanes folded 512 bits
+// at a time, one lane 128 bits at a time, then 64 bits, then a Barrett reduction.
+alignas(16) constexpr std::uint64_t kFold512[2] = {0x0154442bd4ULL, 0x01c6e41596ULL};
+alignas(16) constexpr std::uint64_t kFold128[2] = {0x01751997d0ULL, 0x00ccaa009eULL};
+alignas(16) constexpr std::uint64_t kFold64[2] = {0x0163cd6124ULL, 0x0000000000ULL};
+alignas(16) constexpr std::uint64_t kBarrett[2] = {0x01db710641ULL, 0x01f7011641ULL};
+
+__m128i load(const std::uint8_t* data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+// lane * x^(128 + shift) folded onto next.
+__m128i fold(const __m128i lane, const __m128i constants, const __m128i next) {
+    const __m128i low = _mm_clmulepi64_si128(lane, constants, 0x00);
+    const __m128i high = _mm_clmulepi64_si128(lane, constants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, low), next);
+}
+
+}
+
+std::size_t update(std::uint32_t& state, const std::uint8_t* data, const std::size_t size) {
+    if (size < 64 || !Utilities::CPU::hasPCLMUL()) {
+        return 0;
+    }
+    const std::size_t total = size & ~static_cast<std::size_t>(15);
+    std::size_t offset = 64;
+
+    __m128i lane0 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(state)));
+    __m128i lane1 = load(data + 16);
+    __m128i lane2 = load(data + 32);
+    __m128i lane3 = load(data + 48);
+
+    __m128i constants = _mm_load_si128(reinterpret_cast<const __m128i*>(kFold512));
+    for (; offset + 64 <= total; offset += 64) {
+        lane0 = fold(lane0, constants, load(data + offset));
+        lane1 = fold(lane1, constants, load(data + offset + 16));
+        lane2 = fold(lane2, constants, load(data + offset + 32));
+        lane3 = fold(lane3, constants, load(data + offset + 48));
+    }
+
+    constants = _mm_load_si128(reinterpret_cast<const __m128i*>(kFold128));
+    __m128i folded = fold(lane0, constants, lane1);
+    folded = fold(folded, constants, lane2);
+    folded = fold(folded, constants, lane3);
+    for (; offset < total; offset += 16) {
+        folded = fold(folded, constants, load(data + offset));
+    }
+
+    // 128 bits down to 64.
+    const __m128i lowMask = _mm_setr_epi32(~0, 0, ~0, 0);
+    folded = _mm_xor_si128(_mm_srli_si128(folded, 8), _mm_clmulepi64_si128(folded, constants, 0x10));
+    constants = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(kFold64));
+    folded = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(folded, lowMask), constants, 0x00),
+                           _mm_srli_si128(folded, 4));
+
+    // Barrett reduction to 32 bits.
+    constants = _mm_load_si128(reinterpret_cast<const __m128i*>(kBarrett));
+    __m128i quotient = _mm_clmulepi64_si128(_mm_and_si128(folded, lowMask), constants, 0x10);
+    quotient = _mm_clmulepi64_si128(_mm_and_si128(quotient, lowMask), constants, 0x00);
+    folded = _mm_xor_si128(folded, quotient);
+
+    state = static_cast<std::uint32_t>(_mm_extract_epi32(folded, 1));
+    return total;
+}
+
+#else
+
+std::size_t update(std::uint32_t& state, const std::uint8_t* data, const std::size_t size) {
+    (void)state;
+    (void)data;
+    (void)size;
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
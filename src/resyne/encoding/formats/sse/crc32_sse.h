@@ -0,0 +1,14 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+#include <cstdint>
+
+namespace CRC32SSE {
+    // Folds whole 16-byte blocks into state (the CRC register before zlib's final inversion)
+    // with PCLMULQDQ and returns the number of bytes consumed, leaving the tail to the
+    // caller's table path. Inputs under 64 bytes, and CPUs without PCLMULQDQ, consume nothing.
+    std::size_t update(std::uint32_t& state, const std::uint8_t* data, std::size_t size);
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include "half_float_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+#include "utilities/cpu/cpu_features.h"
+
+namespace HalfFloatSSE {
+
+// Built with F16C enabled, so the conversions only run once the CPU is known to have it.
+// MSVC has no __F16C__ and builds this file for AVX instead.
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX__))
+
+std::size_t fromFloats(const float* input, std::uint16_t* output, const std::size_t count) {
+    if (!Utilities::CPU::hasF16C()) {
+        return 0;
+    }
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), halves);
+    }
+    return i;
+}
+
+std::size_t toFloats(const std::uint16_t* input, float* output, const std::size_t count) {
+    if (!Utilities::CPU::hasF16C()) {
+        return 0;
+    }
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        _mm256_storeu_ps(output + i, _mm256_cvtph_ps(halves));
+    }
+    return i;
+}
+
+#else
+
+std::size_t fromFloats(const float* input, std::uint16_t* output, const std::size_t count) {
+    (void)input;
+    (void)output;
+    (void)count;
+    return 0;
+}
+
+std::size_t toFloats(const std::uint16_t* input, float* output, const std::size_t count) {
+    (void)input;
+    (void)output;
+    (void)count;
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
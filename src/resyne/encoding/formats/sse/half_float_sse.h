@@ -0,0 +1,15 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+#include <cstdint>
+
+namespace HalfFloatSSE {
+    // IEEE binary16 conversions through F16C, rounding to nearest even. Both return the
+    // number of values converted, leaving any tail shorter than one vector to the caller's
+    // scalar path; without F16C they convert nothing.
+    std::size_t fromFloats(const float* input, std::uint16_t* output, std::size_t count);
+    std::size_t toFloats(const std::uint16_t* input, float* output, std::size_t count);
+}
+
+#endif
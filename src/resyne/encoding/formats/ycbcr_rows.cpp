@@ -0,0 +1,66 @@
+#include "resyne/encoding/formats/ycbcr_rows.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ReSyne::Encoding::Video {
+
+MatrixWeights matrixWeightsFor(const std::string_view colourSpace) {
+    if (colourSpace == "bt2020nc" || colourSpace == "bt2020c") {
+        return MatrixWeights{0.2627f, 0.0593f};
+    }
+    if (colourSpace == "bt709") {
+        return MatrixWeights{0.2126f, 0.0722f};
+    }
+    return MatrixWeights{};
+}
+
+void convertRow(const std::vector<RGBWords>& columns,
+                const size_t width,
+                const MatrixWeights weights,
+                const bool tenBit,
+                YCbCrRow& row) {
+    const float codeScale = tenBit ? 4.0f : 1.0f;
+    const float codeMax = tenBit ? 1023.0f : 255.0f;
+    const float kr = weights.kr;
+    const float kb = weights.kb;
+    const float kg = 1.0f - kr - kb;
+    const size_t chromaWidth = (width + 1) / 2;
+
+    row.luma.resize(width);
+    row.cb.resize(chromaWidth);
+    row.cr.resize(chromaWidth);
+
+    const auto code = [&](const float offset, const float range, const float value) {
+        return static_cast<uint16_t>(std::clamp(std::round((offset + range * value) * codeScale), 0.0f, codeMax));
+    };
+    const auto column = [&](const size_t x) -> const RGBWords& {
+        return columns.size() == 1 ? columns.front() : columns[x];
+    };
+
+    float pairBlue = 0.0f;
+    float pairRed = 0.0f;
+    for (size_t x = 0; x < width; ++x) {
+        const RGBWords& words = column(x);
+        const float r = static_cast<float>(words[0]) / 65535.0f;
+        const float g = static_cast<float>(words[1]) / 65535.0f;
+        const float b = static_cast<float>(words[2]) / 65535.0f;
+        const float y = kr * r + kg * g + kb * b;
+        const float blue = (b - y) / (2.0f * (1.0f - kb));
+        const float red = (r - y) / (2.0f * (1.0f - kr));
+        row.luma[x] = code(16.0f, 219.0f, y);
+
+        // An odd last column is paired with itself.
+        if (x % 2 == 0) {
+            pairBlue = blue;
+            pairRed = red;
+            if (x + 1 < width) {
+                continue;
+            }
+        }
+        row.cb[x / 2] = code(128.0f, 224.0f, 0.5f * (pairBlue + blue));
+        row.cr[x / 2] = code(128.0f, 224.0f, 0.5f * (pairRed + red));
+    }
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace ReSyne::Encoding::Video {
+
+// 16-bit full-range R, G and B words, after output precision has been applied.
+using RGBWords = std::array<uint16_t, 3>;
+
+// Luma and chroma weights of a Y'CbCr matrix.
+struct MatrixWeights {
+    float kr = 0.299f;
+    float kb = 0.114f;
+};
+
+// Weights for an ffmpeg colour space name such as VideoProfile::colourSpace; BT.601 for
+// anything that is not BT.2020 or BT.709.
+MatrixWeights matrixWeightsFor(std::string_view colourSpace);
+
+// One row of limited-range 4:2:0 Y'CbCr codes, 8-bit or 10-bit, in the low bits of
+// each word. Chroma is averaged over each pair of columns.
+struct YCbCrRow {
+    std::vector<uint16_t> luma;
+    std::vector<uint16_t> cb;
+    std::vector<uint16_t> cr;
+};
+
+// Converts width columns, or a single colour stretched across them, into row. Both MP4
+// backends go through here, so a piped and an in-process export land on the same codes.
+void convertRow(const std::vector<RGBWords>& columns,
+                size_t width,
+                MatrixWeights weights,
+                bool tenBit,
+                YCbCrRow& row);
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+
+// 256- and 512-bit forms of the PhaseKernelsSSE row kernels, which call them when
+// Utilities::CPU reports the instruction set. Same contracts; each returns how far it got.
+namespace PhaseKernelsAVX2 {
+    std::size_t wrapToPi(const float* in, float* out, std::size_t count);
+    std::size_t smoothNeighbours(const float* phases, const float* magnitudes, float* smoothed,
+                                 std::size_t count, float minMagnitude, float smoothing);
+    std::size_t stepTowards(float* phases, const float* targets, std::size_t count, float gain);
+    std::size_t alignToExpected(float* reconstructed, const float* previous, const float* frequencies,
+                                const float* weights, std::size_t count, float binWidth,
+                                float hopSize, float sampleRate);
+}
+
+namespace PhaseKernelsAVX512 {
+    std::size_t wrapToPi(const float* in, float* out, std::size_t count);
+    std::size_t smoothNeighbours(const float* phases, const float* magnitudes, float* smoothed,
+                                 std::size_t count, float minMagnitude, float smoothing);
+    std::size_t stepTowards(float* phases, const float* targets, std::size_t count, float gain);
+    std::size_t alignToExpected(float* reconstructed, const float* previous, const float* frequencies,
+                                const float* weights, std::size_t count, float binWidth,
+                                float hopSize, float sampleRate);
+}
+
+#endif
@@ -0,0 +1,147 @@
+#include "phase_kernels_avx.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+#include <limits>
+#include <numbers>
+
+namespace PhaseKernelsAVX2 {
+
+// Built with the AVX2 flags from optimisations.cmake; without them every kernel hands the
+// whole row back.
+#if defined(__AVX2__)
+
+namespace {
+
+constexpr float PI = std::numbers::pi_v<float>;
+constexpr float TWO_PI = 2.0f * PI;
+
+__m256 wrap(const __m256 values) {
+    const __m256 shifted = _mm256_add_ps(values, _mm256_set1_ps(PI));
+    const __m256 turns = _mm256_floor_ps(_mm256_mul_ps(shifted, _mm256_set1_ps(1.0f / TWO_PI)));
+    return _mm256_sub_ps(_mm256_sub_ps(shifted, _mm256_mul_ps(turns, _mm256_set1_ps(TWO_PI))),
+                         _mm256_set1_ps(PI));
+}
+
+__m256 select(const __m256 mask, const __m256 whenTrue, const __m256 whenFalse) {
+    return _mm256_blendv_ps(whenFalse, whenTrue, mask);
+}
+
+__m256 greaterThan(const __m256 a, const __m256 b) {
+    return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+}
+
+}
+
+std::size_t wrapToPi(const float* in, float* out, const std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, wrap(_mm256_loadu_ps(in + i)));
+    }
+    return i;
+}
+
+std::size_t smoothNeighbours(const float* phases, const float* magnitudes, float* smoothed,
+                             const std::size_t count, const float minMagnitude, const float smoothing) {
+    const __m256 threshold = _mm256_set1_ps(minMagnitude);
+    const __m256 keep = _mm256_set1_ps(smoothing);
+    const __m256 rest = _mm256_set1_ps(1.0f - smoothing);
+    const __m256 two = _mm256_set1_ps(2.0f);
+
+    std::size_t bin = 1;
+    for (; bin + 9 <= count; bin += 8) {
+        const __m256 magnitude = _mm256_loadu_ps(magnitudes + bin);
+        const __m256 active = greaterThan(magnitude, threshold);
+        if (_mm256_movemask_ps(active) == 0) {
+            continue;
+        }
+
+        const __m256 lowerMagnitude = _mm256_loadu_ps(magnitudes + bin - 1);
+        const __m256 upperMagnitude = _mm256_loadu_ps(magnitudes + bin + 1);
+        const __m256 lowerWeight = _mm256_and_ps(lowerMagnitude, greaterThan(lowerMagnitude, threshold));
+        const __m256 upperWeight = _mm256_and_ps(upperMagnitude, greaterThan(upperMagnitude, threshold));
+        const __m256 centreWeight = _mm256_mul_ps(magnitude, two);
+        const __m256 centrePhase = _mm256_loadu_ps(phases + bin);
+
+        __m256 phaseSum = _mm256_mul_ps(_mm256_loadu_ps(phases + bin - 1), lowerWeight);
+        phaseSum = _mm256_add_ps(phaseSum, _mm256_mul_ps(_mm256_loadu_ps(phases + bin + 1), upperWeight));
+        phaseSum = _mm256_add_ps(phaseSum, _mm256_mul_ps(centrePhase, centreWeight));
+        const __m256 weightSum = _mm256_add_ps(_mm256_add_ps(lowerWeight, upperWeight), centreWeight);
+
+        const __m256 average = _mm256_div_ps(phaseSum, weightSum);
+        const __m256 blended = wrap(_mm256_add_ps(_mm256_mul_ps(keep, average), _mm256_mul_ps(rest, centrePhase)));
+        _mm256_storeu_ps(smoothed + bin, select(active, blended, _mm256_loadu_ps(smoothed + bin)));
+    }
+    return bin;
+}
+
+std::size_t stepTowards(float* phases, const float* targets, const std::size_t count, const float gain) {
+    const __m256 scale = _mm256_set1_ps(gain);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 current = _mm256_loadu_ps(phases + i);
+        const __m256 delta = wrap(_mm256_sub_ps(_mm256_loadu_ps(targets + i), current));
+        _mm256_storeu_ps(phases + i, wrap(_mm256_add_ps(current, _mm256_mul_ps(delta, scale))));
+    }
+    return i;
+}
+
+std::size_t alignToExpected(float* reconstructed, const float* previous, const float* frequencies,
+                            const float* weights, const std::size_t count, const float binWidth,
+                            const float hopSize, const float sampleRate) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 width = _mm256_set1_ps(binWidth);
+    const __m256 twoPi = _mm256_set1_ps(TWO_PI);
+    const __m256 hop = _mm256_set1_ps(hopSize);
+    const __m256 rate = _mm256_set1_ps(sampleRate);
+
+    std::size_t bin = 0;
+    for (; bin + 8 <= count; bin += 8) {
+        const __m256 weight = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(weights + bin), zero), one);
+        const __m256 active = greaterThan(weight, zero);
+        if (_mm256_movemask_ps(active) == 0) {
+            continue;
+        }
+
+        const __m256 stored = _mm256_loadu_ps(frequencies + bin);
+        const __m256 usable = _mm256_and_ps(greaterThan(stored, zero), _mm256_cmp_ps(stored, infinity, _CMP_LT_OQ));
+        const __m256 centre = _mm256_mul_ps(width, _mm256_add_ps(_mm256_set1_ps(static_cast<float>(bin)), lane));
+        const __m256 frequency = select(usable, stored, centre);
+
+        const __m256 advance = _mm256_div_ps(_mm256_mul_ps(_mm256_mul_ps(twoPi, frequency), hop), rate);
+        const __m256 expected = wrap(_mm256_add_ps(_mm256_loadu_ps(previous + bin), advance));
+        const __m256 current = _mm256_loadu_ps(reconstructed + bin);
+        const __m256 delta = wrap(_mm256_sub_ps(current, expected));
+        const __m256 aligned = wrap(_mm256_add_ps(expected, _mm256_mul_ps(delta, weight)));
+        _mm256_storeu_ps(reconstructed + bin, select(active, aligned, current));
+    }
+    return bin;
+}
+
+#else
+
+std::size_t wrapToPi(const float*, float*, std::size_t) {
+    return 0;
+}
+
+std::size_t smoothNeighbours(const float*, const float*, float*, std::size_t, float, float) {
+    return 1;
+}
+
+std::size_t stepTowards(float*, const float*, std::size_t, float) {
+    return 0;
+}
+
+std::size_t alignToExpected(float*, const float*, const float*, const float*, std::size_t, float, float, float) {
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
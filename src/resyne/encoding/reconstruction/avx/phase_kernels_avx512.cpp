@@ -0,0 +1,146 @@
+#include "phase_kernels_avx.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+#include <limits>
+#include <numbers>
+
+namespace PhaseKernelsAVX512 {
+
+// Built with the AVX-512 flags from optimisations.cmake; without them every kernel hands
+// the whole row back. Only AVX-512F is assumed, so masks stand in for the float and/andnot
+// that would need DQ.
+#if defined(__AVX512F__)
+
+namespace {
+
+constexpr float PI = std::numbers::pi_v<float>;
+constexpr float TWO_PI = 2.0f * PI;
+
+__m512 wrap(const __m512 values) {
+    const __m512 shifted = _mm512_add_ps(values, _mm512_set1_ps(PI));
+    const __m512 turns = _mm512_roundscale_ps(_mm512_mul_ps(shifted, _mm512_set1_ps(1.0f / TWO_PI)),
+                                              _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    return _mm512_sub_ps(_mm512_sub_ps(shifted, _mm512_mul_ps(turns, _mm512_set1_ps(TWO_PI))),
+                         _mm512_set1_ps(PI));
+}
+
+__mmask16 greaterThan(const __m512 a, const __m512 b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ);
+}
+
+}
+
+std::size_t wrapToPi(const float* in, float* out, const std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(out + i, wrap(_mm512_loadu_ps(in + i)));
+    }
+    return i;
+}
+
+std::size_t smoothNeighbours(const float* phases, const float* magnitudes, float* smoothed,
+                             const std::size_t count, const float minMagnitude, const float smoothing) {
+    const __m512 threshold = _mm512_set1_ps(minMagnitude);
+    const __m512 keep = _mm512_set1_ps(smoothing);
+    const __m512 rest = _mm512_set1_ps(1.0f - smoothing);
+    const __m512 two = _mm512_set1_ps(2.0f);
+
+    std::size_t bin = 1;
+    for (; bin + 17 <= count; bin += 16) {
+        const __m512 magnitude = _mm512_loadu_ps(magnitudes + bin);
+        const __mmask16 active = greaterThan(magnitude, threshold);
+        if (active == 0) {
+            continue;
+        }
+
+        const __m512 lowerMagnitude = _mm512_loadu_ps(magnitudes + bin - 1);
+        const __m512 upperMagnitude = _mm512_loadu_ps(magnitudes + bin + 1);
+        const __m512 lowerWeight = _mm512_maskz_mov_ps(greaterThan(lowerMagnitude, threshold), lowerMagnitude);
+        const __m512 upperWeight = _mm512_maskz_mov_ps(greaterThan(upperMagnitude, threshold), upperMagnitude);
+        const __m512 centreWeight = _mm512_mul_ps(magnitude, two);
+        const __m512 centrePhase = _mm512_loadu_ps(phases + bin);
+
+        __m512 phaseSum = _mm512_mul_ps(_mm512_loadu_ps(phases + bin - 1), lowerWeight);
+        phaseSum = _mm512_add_ps(phaseSum, _mm512_mul_ps(_mm512_loadu_ps(phases + bin + 1), upperWeight));
+        phaseSum = _mm512_add_ps(phaseSum, _mm512_mul_ps(centrePhase, centreWeight));
+        const __m512 weightSum = _mm512_add_ps(_mm512_add_ps(lowerWeight, upperWeight), centreWeight);
+
+        const __m512 average = _mm512_div_ps(phaseSum, weightSum);
+        const __m512 blended = wrap(_mm512_add_ps(_mm512_mul_ps(keep, average), _mm512_mul_ps(rest, centrePhase)));
+        _mm512_mask_storeu_ps(smoothed + bin, active, blended);
+    }
+    return bin;
+}
+
+std::size_t stepTowards(float* phases, const float* targets, const std::size_t count, const float gain) {
+    const __m512 scale = _mm512_set1_ps(gain);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512 current = _mm512_loadu_ps(phases + i);
+        const __m512 delta = wrap(_mm512_sub_ps(_mm512_loadu_ps(targets + i), current));
+        _mm512_storeu_ps(phases + i, wrap(_mm512_add_ps(current, _mm512_mul_ps(delta, scale))));
+    }
+    return i;
+}
+
+std::size_t alignToExpected(float* reconstructed, const float* previous, const float* frequencies,
+                            const float* weights, const std::size_t count, const float binWidth,
+                            const float hopSize, const float sampleRate) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 infinity = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+    const __m512 lane = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                       8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+    const __m512 width = _mm512_set1_ps(binWidth);
+    const __m512 twoPi = _mm512_set1_ps(TWO_PI);
+    const __m512 hop = _mm512_set1_ps(hopSize);
+    const __m512 rate = _mm512_set1_ps(sampleRate);
+
+    std::size_t bin = 0;
+    for (; bin + 16 <= count; bin += 16) {
+        const __m512 weight = _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(weights + bin), zero), one);
+        const __mmask16 active = greaterThan(weight, zero);
+        if (active == 0) {
+            continue;
+        }
+
+        const __m512 stored = _mm512_loadu_ps(frequencies + bin);
+        const __mmask16 usable = greaterThan(stored, zero) & _mm512_cmp_ps_mask(stored, infinity, _CMP_LT_OQ);
+        const __m512 centre = _mm512_mul_ps(width, _mm512_add_ps(_mm512_set1_ps(static_cast<float>(bin)), lane));
+        const __m512 frequency = _mm512_mask_blend_ps(usable, centre, stored);
+
+        const __m512 advance = _mm512_div_ps(_mm512_mul_ps(_mm512_mul_ps(twoPi, frequency), hop), rate);
+        const __m512 expected = wrap(_mm512_add_ps(_mm512_loadu_ps(previous + bin), advance));
+        const __m512 current = _mm512_loadu_ps(reconstructed + bin);
+        const __m512 delta = wrap(_mm512_sub_ps(current, expected));
+        const __m512 aligned = wrap(_mm512_add_ps(expected, _mm512_mul_ps(delta, weight)));
+        _mm512_mask_storeu_ps(reconstructed + bin, active, aligned);
+    }
+    return bin;
+}
+
+#else
+
+std::size_t wrapToPi(const float*, float*, std::size_t) {
+    return 0;
+}
+
+std::size_t smoothNeighbours(const float*, const float*, float*, std::size_t, float, float) {
+    return 1;
+}
+
+std::size_t stepTowards(float*, const float*, std::size_t, float) {
+    return 0;
+}
+
+std::size_t alignToExpected(float*, const float*, const float*, const float*, std::size_t, float, float, float) {
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include <cmath>
 #include <numbers>
 
+#include "utilities/threading/task_scheduler.h"
+
 namespace PhaseReconstruction {
 
 namespace {
@@ -67,6 +69,73 @@ void slerpPhaseVectors(float cosOriginal, float sinOriginal,
 	cosResult = coeffOrig * nCosOrig + coeffRecon * nCosRecon;
 	sinResult = coeffOrig * nSinOrig + coeffRecon * nSinRecon;
 }
+
+// Each bin's recurrence runs along time and reads only that bin in earlier frames, so bins
+// are independent and no wavefront is needed: tiles of bins run in parallel, and each walks
+// every frame with its few hundred bytes of the current and two previous rows in cache.
+constexpr size_t COHERENCE_TILE_BINS = 64;
+
+// The slerp of two unit phasors is the angle moved the given fraction along the shorter arc.
+float slerpPhase(const float from, const float to, const float weight) {
+	return wrapToPi(from + weight * wrapToPi(to - from));
+}
+
+template <typename RowAccessor>
+void applyTemporalCoherenceRows(const RowAccessor& row,
+								const size_t frameCount,
+								const size_t binCount,
+								const std::vector<float>& transitionWeights,
+								const size_t width,
+								const size_t height,
+								const float coherenceFactor) {
+	if (width == 0 || height == 0 || transitionWeights.size() != width * height) {
+		return;
+	}
+
+	// Pixel x is the frame and y the bin; frames and bins outside the weight image are left alone.
+	const size_t frameLimit = std::min(frameCount, width);
+	const size_t binLimit = std::min(binCount, height);
+	if (frameLimit < 2 || binLimit == 0) {
+		return;
+	}
+
+	const size_t tileCount = (binLimit + COHERENCE_TILE_BINS - 1) / COHERENCE_TILE_BINS;
+	const auto processTiles = [&](const size_t firstTile, const size_t endTile) {
+		for (size_t tile = firstTile; tile < endTile; ++tile) {
+			const size_t firstBin = tile * COHERENCE_TILE_BINS;
+			const size_t endBin = std::min(binLimit, firstBin + COHERENCE_TILE_BINS);
+
+			for (size_t frame = 1; frame < frameLimit; ++frame) {
+				float* const current = row(frame);
+				const float* const previous = row(frame - 1);
+				const float* const beforePrevious = frame >= 2 ? row(frame - 2) : nullptr;
+				// A window of the frame and the two before it, weighted 1, 1/2 and 1/3.
+				const float weightSum = beforePrevious != nullptr
+					? 1.0f + 1.0f / 2.0f + 1.0f / 3.0f
+					: 1.0f + 1.0f / 2.0f;
+
+				for (size_t bin = firstBin; bin < endBin; ++bin) {
+					const float boundaryWeight = transitionWeights[bin * width + frame];
+					if (boundaryWeight < 0.05f || boundaryWeight > 0.95f) {
+						continue;
+					}
+
+					// The current frame's own difference is zero, so only the two before it add in.
+					const float currentPhase = current[bin];
+					float phaseSum = (1.0f / 2.0f) * wrapToPi(currentPhase - previous[bin]);
+					if (beforePrevious != nullptr) {
+						phaseSum += (1.0f / 3.0f) * wrapToPi(currentPhase - beforePrevious[bin]);
+					}
+
+					const float expectedPhase = wrapToPi(previous[bin] + phaseSum / weightSum);
+					current[bin] = slerpPhase(currentPhase, expectedPhase, boundaryWeight * coherenceFactor);
+				}
+			}
+		}
+	};
+
+	::Utilities::Threading::TaskScheduler::shared().parallelFor(tileCount, 1, processTiles);
+}
 }
 
 void interpolateBoundaryPhase(std::vector<float>& phases,
@@ -107,74 +176,41 @@ void interpolateBoundaryPhase(std::vector<float>& phases,
 	}
 }
 
-void applyTemporalPhaseCoherence(std::vector<std::vector<float>>& allPhases,
+void applyTemporalPhaseCoherence(std::span<float> phases,
+								 size_t frameCount,
+								 size_t binCount,
 								 const std::vector<float>& transitionWeights,
 								 size_t width,
 								 size_t height,
 								 float coherenceFactor) {
-	if (allPhases.empty() || width == 0 || height == 0) {
+	if (phases.size() < frameCount * binCount) {
 		return;
 	}
 
-	const size_t numFrames = allPhases.size();
-	const size_t binCount = allPhases[0].size();
+	applyTemporalCoherenceRows(
+		[phases, binCount](const size_t frame) { return phases.data() + frame * binCount; },
+		frameCount, binCount, transitionWeights, width, height, coherenceFactor);
+}
 
-	if (transitionWeights.size() != width * height) {
+void applyTemporalPhaseCoherence(std::vector<std::vector<float>>& allPhases,
+								 const std::vector<float>& transitionWeights,
+								 size_t width,
+								 size_t height,
+								 float coherenceFactor) {
+	if (allPhases.empty()) {
 		return;
 	}
 
-	constexpr size_t TEMPORAL_WINDOW = 3;
-
-	for (size_t frame = 1; frame < numFrames; ++frame) {
-		for (size_t bin = 0; bin < binCount; ++bin) {
-			const size_t pixelX = frame;
-			const size_t pixelY = bin;
-
-			if (pixelX >= width || pixelY >= height) {
-				continue;
-			}
-
-			const size_t weightIdx = pixelY * width + pixelX;
-			const float boundaryWeight = transitionWeights[weightIdx];
-
-			if (boundaryWeight < 0.05f || boundaryWeight > 0.95f) {
-				continue;
-			}
-
-			float phaseSum = 0.0f;
-			float weightSum = 0.0f;
-
-			for (size_t t = 0; t < TEMPORAL_WINDOW && frame >= t; ++t) {
-				const size_t pastFrame = frame - t;
-				const float temporalWeight = 1.0f / static_cast<float>(t + 1);
-
-				const float pastPhase = allPhases[pastFrame][bin];
-				const float phaseDiff = wrapToPi(allPhases[frame][bin] - pastPhase);
-
-				phaseSum += temporalWeight * phaseDiff;
-				weightSum += temporalWeight;
-			}
-
-			if (weightSum > EPSILON) {
-				const float avgPhaseDiff = phaseSum / weightSum;
-				const float expectedPhase = wrapToPi(allPhases[frame - 1][bin] + avgPhaseDiff);
-
-				const float currentPhase = allPhases[frame][bin];
-				const float blendWeight = boundaryWeight * coherenceFactor;
-
-				const float cosExp = std::cos(expectedPhase);
-				const float sinExp = std::sin(expectedPhase);
-				const float cosCur = std::cos(currentPhase);
-				const float sinCur = std::sin(currentPhase);
-
-				float cosResult, sinResult;
-				slerpPhaseVectors(cosCur, sinCur, cosExp, sinExp, blendWeight,
-								  cosResult, sinResult);
-
-				allPhases[frame][bin] = std::atan2(sinResult, cosResult);
-			}
+	const size_t binCount = allPhases[0].size();
+	for (const auto& framePhases : allPhases) {
+		if (framePhases.size() < binCount) {
+			return;
 		}
 	}
+
+	applyTemporalCoherenceRows(
+		[&allPhases](const size_t frame) { return allPhases[frame].data(); },
+		allPhases.size(), binCount, transitionWeights, width, height, coherenceFactor);
 }
 
 }
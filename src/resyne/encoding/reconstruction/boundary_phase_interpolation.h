@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <span>
 #include <vector>
 
 namespace PhaseReconstruction {
@@ -11,7 +12,16 @@ void interpolateBoundaryPhase(std::vector<float>& phases,
 							  const std::vector<float>& transitionWeights,
 							  size_t binCount);
 
-
+// Pulls phases that sit on an edit boundary towards the phase their own recent history
+// predicts, by boundaryWeight * coherenceFactor. transitionWeights is a width x height image
+// with a column per frame and a row per bin. phases is a row-major frameCount x binCount slab.
+void applyTemporalPhaseCoherence(std::span<float> phases,
+								 size_t frameCount,
+								 size_t binCount,
+								 const std::vector<float>& transitionWeights,
+								 size_t width,
+								 size_t height,
+								 float coherenceFactor);
 
 void applyTemporalPhaseCoherence(std::vector<std::vector<float>>& allPhases,
 								 const std::vector<float>& transitionWeights,
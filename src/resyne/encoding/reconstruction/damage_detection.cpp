@@ -1,14 +1,39 @@
 #include "damage_detection.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <numbers>
 
+#include "utilities/threading/task_scheduler.h"
+
 namespace PhaseReconstruction {
 
 namespace {
 constexpr float EPSILON = 1e-6f;
 constexpr float MIN_BIN_INTENSITY = 1e-6f;
+constexpr size_t DAMAGE_TILE_FRAMES = 256;
+
+// Runs job(tileStart, tileEnd) over tiles of frames, up to threadCount at once on the shared
+// scheduler.
+template <typename Job>
+void forEachTile(const size_t frameCount, const size_t threadCount, const Job& job) {
+	const size_t tileCount = (frameCount + DAMAGE_TILE_FRAMES - 1) / DAMAGE_TILE_FRAMES;
+	std::atomic<size_t> nextTile{0};
+	const auto worker = [&] {
+		for (size_t tile = nextTile.fetch_add(1); tile < tileCount; tile = nextTile.fetch_add(1)) {
+			job(tile * DAMAGE_TILE_FRAMES, std::min(frameCount, (tile + 1) * DAMAGE_TILE_FRAMES));
+		}
+	};
+
+	const size_t workers = std::clamp<size_t>(threadCount, 1, std::max<size_t>(1, tileCount));
+	// Each range claims work until none is left, so one that starts late finds nothing.
+	::Utilities::Threading::TaskScheduler::shared().parallelFor(workers, 1, [&](const size_t first, const size_t end) {
+		for (size_t t = first; t < end; ++t) {
+			worker();
+		}
+	});
+}
 }
 
 float computeBinSharpness(const std::vector<float>& magnitudes, size_t bin) {
@@ -33,101 +58,155 @@ float computeBinSharpness(const std::vector<float>& magnitudes, size_t bin) {
 	return samples > 0.0f ? gradientSum / samples : 0.0f;
 }
 
-std::vector<bool> detectDamagedBins(const std::vector<std::vector<float>>& allMagnitudes,
-								   size_t currentFrame) {
-	if (allMagnitudes.empty() || currentFrame >= allMagnitudes.size()) {
-		return std::vector<bool>();
-	}
+DamageMap::DamageMap(const size_t frameCount, const size_t binCount)
+	: frames(frameCount), bins(binCount), wordsPerRow((binCount + 63) / 64),
+	  words(frameCount * ((binCount + 63) / 64), 0) {}
 
-	const auto& currentMagnitudes = allMagnitudes[currentFrame];
-	const size_t binCount = currentMagnitudes.size();
-	std::vector<bool> isDamaged(binCount, false);
+bool DamageMap::damaged(const size_t frame, const size_t bin) const {
+	return ((words[frame * wordsPerRow + bin / 64] >> (bin % 64)) & 1U) != 0;
+}
+
+bool DamageMap::frameHasDamage(const size_t frame) const {
+	const auto row = words.begin() + static_cast<std::ptrdiff_t>(frame * wordsPerRow);
+	return std::any_of(row, row + static_cast<std::ptrdiff_t>(wordsPerRow), [](const uint64_t word) { return word != 0; });
+}
+
+void DamageMap::mark(const size_t frame, const size_t bin) {
+	words[frame * wordsPerRow + bin / 64] |= uint64_t{1} << (bin % 64);
+}
+
+DamageMap detectDamage(const std::vector<std::vector<float>>& allMagnitudes, const size_t threadCount) {
+	const size_t frameCount = allMagnitudes.size();
+	size_t binCount = 0;
+	for (const auto& row : allMagnitudes) {
+		binCount = std::max(binCount, row.size());
+	}
+	DamageMap damage(frameCount, binCount);
+	if (frameCount == 0 || binCount == 0) {
+		return damage;
+	}
 
 	constexpr size_t TEMPORAL_RADIUS = 3;
 	constexpr float SHARPNESS_RATIO = 0.7f;
 	constexpr float MAG_STABILITY_RATIO = 0.15f;
 	constexpr float MAG_DROP_RATIO = 0.5f;
 	constexpr float CONTEXT_RATIO = 0.5f;
-	const size_t frameStart = currentFrame > TEMPORAL_RADIUS ? currentFrame - TEMPORAL_RADIUS : 0;
-	const size_t frameEnd = std::min(currentFrame + TEMPORAL_RADIUS + 1, allMagnitudes.size());
-
-	for (size_t bin = 0; bin < binCount; ++bin) {
-		const float currentMag = currentMagnitudes[bin];
-		if (currentMag <= MIN_BIN_INTENSITY) {
-			continue;
-		}
-
-		float temporalSharpness = 0.0f;
-		float temporalMagnitude = 0.0f;
-		size_t temporalCount = 0;
-
-		for (size_t frame = frameStart; frame < frameEnd; ++frame) {
-			if (frame == currentFrame) {
-				continue;
-			}
-			if (bin >= allMagnitudes[frame].size()) {
-				continue;
-			}
 
-			const float neighbourMag = allMagnitudes[frame][bin];
-			if (neighbourMag <= MIN_BIN_INTENSITY) {
-				continue;
+	// Bins past the end of a shorter frame stay silent, which excludes them like a quiet bin.
+	std::vector<float> magnitudes(frameCount * binCount, 0.0f);
+	std::vector<float> sharpness(frameCount * binCount, 0.0f);
+	forEachTile(frameCount, threadCount, [&](const size_t tileStart, const size_t tileEnd) {
+		for (size_t frame = tileStart; frame < tileEnd; ++frame) {
+			const auto& row = allMagnitudes[frame];
+			std::copy(row.begin(), row.end(), magnitudes.begin() + static_cast<std::ptrdiff_t>(frame * binCount));
+			for (size_t bin = 0; bin < row.size(); ++bin) {
+				sharpness[frame * binCount + bin] = computeBinSharpness(row, bin);
 			}
-
-			temporalSharpness += computeBinSharpness(allMagnitudes[frame], bin);
-			temporalMagnitude += neighbourMag;
-			temporalCount++;
 		}
+	});
+
+	forEachTile(frameCount, threadCount, [&](const size_t tileStart, const size_t tileEnd) {
+		// Sums over every audible cell of the window around the current frame, the current
+		// frame included; doubles keep the add-and-remove updates from drifting.
+		std::vector<double> windowSharpness(binCount, 0.0);
+		std::vector<double> windowMagnitude(binCount, 0.0);
+		std::vector<uint32_t> windowCount(binCount, 0);
+		const auto updateWindow = [&](const size_t frame, const bool entering) {
+			const float* magnitudeRow = magnitudes.data() + frame * binCount;
+			const float* sharpnessRow = sharpness.data() + frame * binCount;
+			const double sign = entering ? 1.0 : -1.0;
+			for (size_t bin = 0; bin < binCount; ++bin) {
+				if (magnitudeRow[bin] > MIN_BIN_INTENSITY) {
+					windowSharpness[bin] += sign * static_cast<double>(sharpnessRow[bin]);
+					windowMagnitude[bin] += sign * static_cast<double>(magnitudeRow[bin]);
+					windowCount[bin] = entering ? windowCount[bin] + 1 : windowCount[bin] - 1;
+				}
+			}
+		};
 
-		if (temporalCount < 2) {
-			continue;
+		const size_t firstWindowFrame = tileStart > TEMPORAL_RADIUS ? tileStart - TEMPORAL_RADIUS : 0;
+		for (size_t frame = firstWindowFrame; frame < std::min(tileStart + TEMPORAL_RADIUS + 1, frameCount); ++frame) {
+			updateWindow(frame, true);
 		}
 
-		temporalSharpness /= static_cast<float>(temporalCount);
-		temporalMagnitude /= static_cast<float>(temporalCount);
-
-		const float currentSharpness = computeBinSharpness(currentMagnitudes, bin);
-		float contextSharpness = 0.0f;
-		size_t contextCount = 0;
-
-		for (int offset = -2; offset <= 2; ++offset) {
-			if (offset == 0) {
-				continue;
+		for (size_t frame = tileStart; frame < tileEnd; ++frame) {
+			if (frame > tileStart) {
+				if (frame + TEMPORAL_RADIUS < frameCount) {
+					updateWindow(frame + TEMPORAL_RADIUS, true);
+				}
+				if (frame > TEMPORAL_RADIUS) {
+					updateWindow(frame - TEMPORAL_RADIUS - 1, false);
+				}
 			}
 
-			const int neighbourIndex = static_cast<int>(bin) + offset;
-			if (neighbourIndex < 0 || neighbourIndex >= static_cast<int>(binCount)) {
-				continue;
+			const size_t rowSize = allMagnitudes[frame].size();
+			const float* magnitudeRow = magnitudes.data() + frame * binCount;
+			const float* sharpnessRow = sharpness.data() + frame * binCount;
+			for (size_t bin = 0; bin < rowSize; ++bin) {
+				const float currentMag = magnitudeRow[bin];
+				if (currentMag <= MIN_BIN_INTENSITY) {
+					continue;
+				}
+
+				// The window holds the current cell too, which is audible here.
+				const uint32_t temporalCount = windowCount[bin] - 1;
+				if (temporalCount < 2) {
+					continue;
+				}
+
+				const float currentSharpness = sharpnessRow[bin];
+				const float temporalSharpness = static_cast<float>(
+					(windowSharpness[bin] - currentSharpness) / static_cast<double>(temporalCount));
+				const float temporalMagnitude = static_cast<float>(
+					(windowMagnitude[bin] - currentMag) / static_cast<double>(temporalCount));
+
+				float contextSharpness = 0.0f;
+				size_t contextCount = 0;
+				const size_t contextStart = bin > 2 ? bin - 2 : 0;
+				const size_t contextEnd = std::min(bin + 3, rowSize);
+				for (size_t neighbour = contextStart; neighbour < contextEnd; ++neighbour) {
+					if (neighbour != bin) {
+						contextSharpness += sharpnessRow[neighbour];
+						contextCount++;
+					}
+				}
+
+				const float avgContextSharpness = contextCount > 0
+					? contextSharpness / static_cast<float>(contextCount)
+					: currentSharpness;
+
+				const bool sharpnessDrop = (temporalSharpness > EPSILON) &&
+					(currentSharpness < temporalSharpness * SHARPNESS_RATIO);
+				const bool magnitudeStable = (temporalMagnitude > EPSILON) &&
+					(std::abs(currentMag - temporalMagnitude) < temporalMagnitude * MAG_STABILITY_RATIO);
+				const bool magnitudeDrop = (temporalMagnitude > EPSILON) &&
+					(currentMag < temporalMagnitude * MAG_DROP_RATIO);
+				const bool localContrast = avgContextSharpness > currentSharpness * CONTEXT_RATIO;
+
+				if (sharpnessDrop && magnitudeStable && magnitudeDrop && localContrast) {
+					damage.mark(frame, bin);
+				}
 			}
-
-			contextSharpness += computeBinSharpness(currentMagnitudes, static_cast<size_t>(neighbourIndex));
-			contextCount++;
 		}
+	});
 
-		const float avgContextSharpness = contextCount > 0
-			? contextSharpness / static_cast<float>(contextCount)
-			: currentSharpness;
-
-		const bool sharpnessDrop = (temporalSharpness > EPSILON) &&
-			(currentSharpness < temporalSharpness * SHARPNESS_RATIO);
-		const bool magnitudeStable = (temporalMagnitude > EPSILON) &&
-			(std::abs(currentMag - temporalMagnitude) < temporalMagnitude * MAG_STABILITY_RATIO);
-		const bool magnitudeDrop = (temporalMagnitude > EPSILON) &&
-			(currentMag < temporalMagnitude * MAG_DROP_RATIO);
-		const bool localContrast = avgContextSharpness > currentSharpness * CONTEXT_RATIO;
-
-		isDamaged[bin] = sharpnessDrop && magnitudeStable && magnitudeDrop && localContrast;
-	}
-
-	return isDamaged;
+	return damage;
 }
 
 std::vector<size_t> findSpectralPeaks(const std::vector<float>& magnitudes,
 									   float minPeakMagnitude) {
 	std::vector<size_t> peaks;
+	findSpectralPeaks(magnitudes, minPeakMagnitude, peaks);
+	return peaks;
+}
+
+void findSpectralPeaks(std::span<const float> magnitudes,
+					   float minPeakMagnitude,
+					   std::vector<size_t>& peaks) {
+	peaks.clear();
 
 	if (magnitudes.size() < 3) {
-		return peaks;
+		return;
 	}
 
 	for (size_t i = 1; i < magnitudes.size() - 1; ++i) {
@@ -137,40 +216,39 @@ std::vector<size_t> findSpectralPeaks(const std::vector<float>& magnitudes,
 			peaks.push_back(i);
 		}
 	}
-
-	return peaks;
 }
 
-std::vector<float> computeDamageBlend(const std::vector<bool>& damagedBins, size_t radius) {
-	std::vector<float> weights(damagedBins.size(), 0.0f);
-	if (damagedBins.empty()) {
-		return weights;
+void computeDamageBlend(const DamageMap& damage, const size_t frame, const size_t radius, std::vector<float>& weights) {
+	const size_t binCount = damage.binCount();
+	weights.assign(binCount, 0.0f);
+	if (binCount == 0 || frame >= damage.frameCount()) {
+		return;
 	}
 
 	if (radius == 0) {
-		for (size_t i = 0; i < damagedBins.size(); ++i) {
-			weights[i] = damagedBins[i] ? 1.0f : 0.0f;
+		for (size_t i = 0; i < binCount; ++i) {
+			weights[i] = damage.damaged(frame, i) ? 1.0f : 0.0f;
 		}
-		return weights;
+		return;
 	}
 
 	const float denom = static_cast<float>(radius) + 1.0f;
+	std::vector<float> window(2 * radius + 1);
+	for (size_t i = 0; i < window.size(); ++i) {
+		const float windowPhase = (static_cast<float>(i) - static_cast<float>(radius)) * std::numbers::pi_v<float> / denom;
+		window[i] = 0.5f * (1.0f + std::cos(windowPhase));
+	}
 
-	for (size_t bin = 0; bin < damagedBins.size(); ++bin) {
+	for (size_t bin = 0; bin < binCount; ++bin) {
 		float weightedSum = 0.0f;
 		float weightTotal = 0.0f;
 
-		for (int offset = -static_cast<int>(radius); offset <= static_cast<int>(radius); ++offset) {
-			const int neighbourIndex = static_cast<int>(bin) + offset;
-			if (neighbourIndex < 0 || neighbourIndex >= static_cast<int>(damagedBins.size())) {
-				continue;
-			}
-
-			const float windowPhase = static_cast<float>(offset) * std::numbers::pi_v<float> / denom;
-			const float windowWeight = 0.5f * (1.0f + std::cos(windowPhase));
-
+		const size_t neighbourStart = bin > radius ? bin - radius : 0;
+		const size_t neighbourEnd = std::min(bin + radius + 1, binCount);
+		for (size_t neighbour = neighbourStart; neighbour < neighbourEnd; ++neighbour) {
+			const float windowWeight = window[neighbour + radius - bin];
 			weightTotal += windowWeight;
-			if (damagedBins[static_cast<size_t>(neighbourIndex)]) {
+			if (damage.damaged(frame, neighbour)) {
 				weightedSum += windowWeight;
 			}
 		}
@@ -179,14 +257,12 @@ std::vector<float> computeDamageBlend(const std::vector<bool>& damagedBins, size
 			weights[bin] = std::clamp(weightedSum / weightTotal, 0.0f, 1.0f);
 		}
 
-		if (damagedBins[bin]) {
+		if (damage.damaged(frame, bin)) {
 			weights[bin] = 1.0f;
 		} else {
 			weights[bin] = std::min(weights[bin], 0.35f);
 		}
 	}
-
-	return weights;
 }
 
 }
@@ -2,23 +2,51 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <span>
 
 namespace PhaseReconstruction {
 
 // Computes average magnitude gradient at a bin
 float computeBinSharpness(const std::vector<float>& magnitudes, size_t bin);
 
-// Detects bins damaged by visual editing operations
+// Damage flags for every frame and bin of a sequence, one bit per cell. Each frame's row
+// starts on a fresh 64-bit word, so tiles of frames can be marked in parallel.
+class DamageMap {
+public:
+	DamageMap() = default;
+	DamageMap(size_t frameCount, size_t binCount);
+
+	size_t frameCount() const { return frames; }
+	size_t binCount() const { return bins; }
+
+	bool damaged(size_t frame, size_t bin) const;
+	bool frameHasDamage(size_t frame) const;
+	void mark(size_t frame, size_t bin);
+
+private:
+	size_t frames = 0;
+	size_t bins = 0;
+	size_t wordsPerRow = 0;
+	std::vector<uint64_t> words;
+};
+
+// Detects bins damaged by visual editing operations across the whole sequence in one pass.
+// Sharpness is found once per cell and the ±3-frame neighbourhood is kept as running sums
+// per bin, with tiles of frames spread over up to threadCount threads.
 // Damskagg & Välimäki (2017) - fuzzy bin classification for time-scale modification
-std::vector<bool> detectDamagedBins(const std::vector<std::vector<float>>& allMagnitudes,
-								   size_t currentFrame);
+DamageMap detectDamage(const std::vector<std::vector<float>>& allMagnitudes, size_t threadCount = 1);
 
 // Finds local maxima in magnitude spectrum
 std::vector<size_t> findSpectralPeaks(const std::vector<float>& magnitudes,
 									   float minPeakMagnitude = 1e-4f);
+// The same into peaks, reusing its storage, for callers that run once per live frame
+void findSpectralPeaks(std::span<const float> magnitudes,
+					   float minPeakMagnitude,
+					   std::vector<size_t>& peaks);
 
-// Computes smooth blend weights from binary damage mask
+// Computes smooth blend weights from one frame of a damage map into weights
 // Laroche & Dolson (1999) - raised-cosine windowing for phase locking
-std::vector<float> computeDamageBlend(const std::vector<bool>& damagedBins, size_t radius);
+void computeDamageBlend(const DamageMap& damage, size_t frame, size_t radius, std::vector<float>& weights);
 
 }
@@ -1,7 +1,12 @@
 #include "edit_detection.h"
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cmath>
+#include <limits>
+
+#include "utilities/threading/task_scheduler.h"
 
 namespace PhaseReconstruction {
 
@@ -9,6 +14,28 @@ namespace {
 constexpr float GRADIENT_THRESHOLD = 0.015f;
 constexpr float SECOND_DERIVATIVE_THRESHOLD = 0.008f;
 constexpr size_t MIN_REGION_SIZE = 4;
+constexpr size_t BAND_ROWS = 64;
+
+// Runs job(first, end) over bands of BAND_ROWS indices, up to threadCount at once on the
+// shared scheduler.
+template <typename Job>
+void forEachBand(const size_t count, const size_t threadCount, const Job& job) {
+	const size_t bandCount = (count + BAND_ROWS - 1) / BAND_ROWS;
+	std::atomic<size_t> nextBand{0};
+	const auto worker = [&] {
+		for (size_t band = nextBand.fetch_add(1); band < bandCount; band = nextBand.fetch_add(1)) {
+			job(band * BAND_ROWS, std::min(count, (band + 1) * BAND_ROWS));
+		}
+	};
+
+	const size_t workers = std::clamp<size_t>(threadCount, 1, std::max<size_t>(1, bandCount));
+	// Each range claims work until none is left, so one that starts late finds nothing.
+	::Utilities::Threading::TaskScheduler::shared().parallelFor(workers, 1, [&](const size_t first, const size_t end) {
+		for (size_t t = first; t < end; ++t) {
+			worker();
+		}
+	});
+}
 
 float computeGradientMagnitude(const ColourNativeImage& image,
 							   size_t x, size_t y,
@@ -60,207 +87,315 @@ float computeSecondDerivative(const ColourNativeImage& image,
 	return std::abs(laplacian);
 }
 
+// Bits of word `index` in a row of `width` pixels that are interior, 1 <= x <= width - 2.
+uint64_t interiorBits(const size_t index, const size_t width) {
+	uint64_t bits = index == 0 ? ~uint64_t{1} : ~uint64_t{0};
+	const size_t interiorEnd = width - 1;
+	if (interiorEnd < (index + 1) * 64) {
+		const size_t kept = interiorEnd - index * 64;
+		bits &= kept == 0 ? 0 : ~uint64_t{0} >> (64 - kept);
+	}
+	return bits;
 }
 
-EditBoundaryInfo detectEditBoundaries(const ColourNativeImage& original,
-									  const ColourNativeImage& edited) {
-	if (original.width != edited.width || original.height != edited.height) {
-		return EditBoundaryInfo();
+// For every column of row y, the distance to the nearest feature in that column within the
+// radius, or radius + 1 past it. Dilating the feature bits a row further each step lights up
+// each column at the step that first reaches a feature, 64 columns per word.
+void columnDistances(const EditMask& features,
+					 const size_t width,
+					 const size_t height,
+					 const size_t y,
+					 const uint32_t radius,
+					 std::vector<uint64_t>& reached,
+					 std::vector<uint32_t>& distances) {
+	const size_t rowWords = features.wordsPerRow();
+	distances.assign(width, radius + 1);
+	reached.assign(rowWords, 0);
+	for (uint32_t step = 0; step <= radius; ++step) {
+		const uint64_t* above = step <= y ? features.row(y - step) : nullptr;
+		const uint64_t* below = y + step < height ? features.row(y + step) : nullptr;
+		if (above == nullptr && below == nullptr) {
+			break;
+		}
+		for (size_t i = 0; i < rowWords; ++i) {
+			const uint64_t lit = (above != nullptr ? above[i] : 0) | (below != nullptr ? below[i] : 0);
+			for (uint64_t fresh = lit & ~reached[i]; fresh != 0; fresh &= fresh - 1) {
+				distances[i * 64 + static_cast<size_t>(std::countr_zero(fresh))] = step;
+			}
+			reached[i] |= lit;
+		}
 	}
+}
 
-	EditBoundaryInfo result(edited.width, edited.height);
+// Completes the separable transform at one pixel: the nearest feature within the square of
+// half-size radius, from the column distances of the pixels either side in its row.
+float nearestWithinRadius(const std::vector<uint32_t>& distances,
+						  const size_t width,
+						  const size_t x,
+						  const uint32_t radius) {
+	float nearest = static_cast<float>(radius + 1);
+	const size_t firstColumn = x > radius ? x - radius : 0;
+	const size_t endColumn = std::min(width, x + radius + 1);
+	for (size_t column = firstColumn; column < endColumn; ++column) {
+		const uint32_t dy = distances[column];
+		if (dy > radius) {
+			continue;
+		}
+		const int dx = static_cast<int>(column) - static_cast<int>(x);
+		nearest = std::min(nearest, std::sqrt(static_cast<float>(dx * dx + static_cast<int>(dy * dy))));
+	}
+	return nearest;
+}
+
+size_t findRoot(std::vector<uint32_t>& parents, size_t pixel) {
+	while (parents[pixel] != pixel) {
+		parents[pixel] = parents[parents[pixel]];
+		pixel = parents[pixel];
+	}
+	return pixel;
+}
 
-	for (size_t y = 0; y < edited.height; ++y) {
-		for (size_t x = 0; x < edited.width; ++x) {
-			const RGBAColour& origPixel = original.at(x, y);
-			const RGBAColour& editPixel = edited.at(x, y);
+// Keeps the lower index as the root, so every pixel's parent precedes it.
+void unite(std::vector<uint32_t>& parents, const size_t a, const size_t b) {
+	const size_t rootA = findRoot(parents, a);
+	const size_t rootB = findRoot(parents, b);
+	if (rootA < rootB) {
+		parents[rootB] = static_cast<uint32_t>(rootA);
+	} else if (rootB < rootA) {
+		parents[rootA] = static_cast<uint32_t>(rootB);
+	}
+}
 
-			const float rDiff = std::abs(editPixel.r - origPixel.r);
-			const float gDiff = std::abs(editPixel.g - origPixel.g);
-			const float bDiff = std::abs(editPixel.b - origPixel.b);
-			const float aDiff = std::abs(editPixel.a - origPixel.a);
+}
 
-			const float maxDiff = std::max({rDiff, gDiff, bDiff, aDiff});
-			const size_t idx = y * edited.width + x;
+EditBoundaryInfo detectEditBoundaries(const ColourNativeImage& original,
+									  const ColourNativeImage& edited,
+									  const size_t threadCount) {
+	if (original.width != edited.width || original.height != edited.height) {
+		return EditBoundaryInfo();
+	}
 
-			if (maxDiff > 0.001f) {
-				result.isEditedRegion[idx] = true;
+	EditBoundaryInfo result(edited.width, edited.height);
+	const size_t width = edited.width;
+	const size_t height = edited.height;
+
+	forEachBand(height, threadCount, [&](const size_t firstRow, const size_t endRow) {
+		for (size_t y = firstRow; y < endRow; ++y) {
+			for (size_t x = 0; x < width; ++x) {
+				const RGBAColour& origPixel = original.at(x, y);
+				const RGBAColour& editPixel = edited.at(x, y);
+
+				const float rDiff = std::abs(editPixel.r - origPixel.r);
+				const float gDiff = std::abs(editPixel.g - origPixel.g);
+				const float bDiff = std::abs(editPixel.b - origPixel.b);
+				const float aDiff = std::abs(editPixel.a - origPixel.a);
+
+				if (std::max({rDiff, gDiff, bDiff, aDiff}) > 0.001f) {
+					result.editedRegion.set(x, y);
+				}
 			}
 		}
+	});
+
+	if (width < 3 || height < 3) {
+		return result;
 	}
 
-	for (size_t y = 1; y < edited.height - 1; ++y) {
-		for (size_t x = 1; x < edited.width - 1; ++x) {
-			const size_t idx = y * edited.width + x;
-			const bool currentEdited = result.isEditedRegion[idx];
-
-			bool isBoundary = false;
-			for (int dy = -1; dy <= 1 && !isBoundary; ++dy) {
-				for (int dx = -1; dx <= 1 && !isBoundary; ++dx) {
-					if (dx == 0 && dy == 0) continue;
-					const size_t nx = static_cast<size_t>(static_cast<ptrdiff_t>(x) + dx);
-					const size_t ny = static_cast<size_t>(static_cast<ptrdiff_t>(y) + dy);
-					const size_t nidx = ny * edited.width + nx;
-					if (result.isEditedRegion[nidx] != currentEdited) {
-						isBoundary = true;
-					}
-				}
+	// A pixel is on a boundary when its 3x3 neighbourhood is not uniform, which is where the
+	// OR of the nine bits differs from their AND, found a 64-pixel word at a time.
+	const size_t rowWords = result.editedRegion.wordsPerRow();
+	forEachBand(height, threadCount, [&](const size_t firstRow, const size_t endRow) {
+		std::vector<uint64_t> columnAny(rowWords + 2, 0);
+		std::vector<uint64_t> columnAll(rowWords + 2, 0);
+		for (size_t y = std::max<size_t>(firstRow, 1); y < std::min(endRow, height - 1); ++y) {
+			const uint64_t* above = result.editedRegion.row(y - 1);
+			const uint64_t* centre = result.editedRegion.row(y);
+			const uint64_t* below = result.editedRegion.row(y + 1);
+			for (size_t i = 0; i < rowWords; ++i) {
+				columnAny[i + 1] = above[i] | centre[i] | below[i];
+				columnAll[i + 1] = above[i] & centre[i] & below[i];
 			}
 
-			if (isBoundary) {
-				result.boundaryWeights[idx] = 1.0f;
+			for (size_t i = 0; i < rowWords; ++i) {
+				const uint64_t any = columnAny[i + 1] |
+					(columnAny[i + 1] << 1) | (columnAny[i] >> 63) |
+					(columnAny[i + 1] >> 1) | (columnAny[i + 2] << 63);
+				const uint64_t all = columnAll[i + 1] &
+					((columnAll[i + 1] << 1) | (columnAll[i] >> 63)) &
+					((columnAll[i + 1] >> 1) | (columnAll[i + 2] << 63));
+				for (uint64_t boundary = any & ~all & interiorBits(i, width); boundary != 0; boundary &= boundary - 1) {
+					const size_t x = i * 64 + static_cast<size_t>(std::countr_zero(boundary));
+					result.boundaryWeights[y * width + x] = 1.0f;
+				}
 			}
 		}
-	}
+	});
 
 	return result;
 }
 
-EditBoundaryInfo detectEditBoundariesSingleImage(const ColourNativeImage& image) {
+EditBoundaryInfo detectEditBoundariesSingleImage(const ColourNativeImage& image, const size_t threadCount) {
 	EditBoundaryInfo result(image.width, image.height);
+	if (image.width < 3 || image.height < 3) {
+		return result;
+	}
 
-	std::vector<float> gradientMag(image.width * image.height, 0.0f);
-
-	for (size_t y = 1; y < image.height - 1; ++y) {
-		for (size_t x = 1; x < image.width - 1; ++x) {
-			const size_t idx = y * image.width + x;
-
-			float maxGradient = 0.0f;
-			float maxSecondDeriv = 0.0f;
-
-			for (size_t ch = 0; ch < 4; ++ch) {
-				const float grad = computeGradientMagnitude(image, x, y, ch);
-				const float secondDeriv = computeSecondDerivative(image, x, y, ch);
-				maxGradient = std::max(maxGradient, grad);
-				maxSecondDeriv = std::max(maxSecondDeriv, secondDeriv);
-			}
-
-			gradientMag[idx] = maxGradient;
+	forEachBand(image.height, threadCount, [&](const size_t firstRow, const size_t endRow) {
+		for (size_t y = std::max<size_t>(firstRow, 1); y < std::min(endRow, image.height - 1); ++y) {
+			for (size_t x = 1; x < image.width - 1; ++x) {
+				float maxGradient = 0.0f;
+				float maxSecondDeriv = 0.0f;
+
+				for (size_t ch = 0; ch < 4; ++ch) {
+					const float grad = computeGradientMagnitude(image, x, y, ch);
+					const float secondDeriv = computeSecondDerivative(image, x, y, ch);
+					maxGradient = std::max(maxGradient, grad);
+					maxSecondDeriv = std::max(maxSecondDeriv, secondDeriv);
+				}
 
-			const bool isEdge = maxGradient > GRADIENT_THRESHOLD &&
-								maxSecondDeriv > SECOND_DERIVATIVE_THRESHOLD;
+				const bool isEdge = maxGradient > GRADIENT_THRESHOLD &&
+									maxSecondDeriv > SECOND_DERIVATIVE_THRESHOLD;
 
-			if (isEdge) {
-				result.boundaryWeights[idx] = std::min(1.0f, maxGradient / (GRADIENT_THRESHOLD * 2.0f));
+				if (isEdge) {
+					result.boundaryWeights[y * image.width + x] = std::min(1.0f, maxGradient / (GRADIENT_THRESHOLD * 2.0f));
+				}
 			}
 		}
+	});
+
+	// Regions enclosed by edges are the 8-connected components of the interior pixels that
+	// are not edges. Each band of rows is labelled on its own, since a band's unions only
+	// touch its own pixels; the bands are then joined across their seams in order.
+	const size_t width = image.width;
+	const size_t height = image.height;
+	const size_t pixelCount = width * height;
+	if (pixelCount > std::numeric_limits<uint32_t>::max()) {
+		return result;
 	}
-
-	std::vector<bool> visited(image.width * image.height, false);
-	std::vector<size_t> stack;
-
-	for (size_t y = 1; y < image.height - 1; ++y) {
-		for (size_t x = 1; x < image.width - 1; ++x) {
-			const size_t idx = y * image.width + x;
-			if (result.boundaryWeights[idx] > 0.0f || visited[idx]) {
-				continue;
+	const auto isOpen = [&](const size_t x, const size_t y) {
+		return x >= 1 && x < width - 1 && y >= 1 && y < height - 1 && result.boundaryWeights[y * width + x] <= 0.0f;
+	};
+	const auto joinUpperNeighbours = [&](std::vector<uint32_t>& labels, const size_t x, const size_t y) {
+		const size_t pixel = y * width + x;
+		for (size_t nx = x - 1; nx <= x + 1; ++nx) {
+			if (isOpen(nx, y - 1)) {
+				unite(labels, pixel, (y - 1) * width + nx);
 			}
+		}
+	};
 
-			stack.clear();
-			stack.push_back(idx);
-			std::vector<size_t> region;
-
-			while (!stack.empty()) {
-				const size_t current = stack.back();
-				stack.pop_back();
-
-				if (visited[current]) continue;
-				visited[current] = true;
-
-				const size_t cx = current % image.width;
-				const size_t cy = current / image.width;
-
-				if (result.boundaryWeights[current] > 0.0f) {
+	std::vector<uint32_t> parents(pixelCount);
+	forEachBand(height, threadCount, [&](const size_t firstRow, const size_t endRow) {
+		for (size_t y = firstRow; y < endRow; ++y) {
+			for (size_t x = 0; x < width; ++x) {
+				const size_t pixel = y * width + x;
+				parents[pixel] = static_cast<uint32_t>(pixel);
+				if (!isOpen(x, y)) {
 					continue;
 				}
-
-				region.push_back(current);
-
-				for (int dy = -1; dy <= 1; ++dy) {
-					for (int dx = -1; dx <= 1; ++dx) {
-						if (dx == 0 && dy == 0) continue;
-						const size_t nx = static_cast<size_t>(static_cast<ptrdiff_t>(cx) + dx);
-						const size_t ny = static_cast<size_t>(static_cast<ptrdiff_t>(cy) + dy);
-						if (nx >= 1 && nx < image.width - 1 &&
-							ny >= 1 && ny < image.height - 1) {
-							const size_t nidx = ny * image.width + nx;
-							if (!visited[nidx]) {
-								stack.push_back(nidx);
-							}
-						}
-					}
+				if (isOpen(x - 1, y)) {
+					unite(parents, pixel, pixel - 1);
 				}
+				if (y > firstRow) {
+					joinUpperNeighbours(parents, x, y);
+				}
+			}
+		}
+	});
+	for (size_t seam = BAND_ROWS; seam < height; seam += BAND_ROWS) {
+		for (size_t x = 1; x + 1 < width; ++x) {
+			if (isOpen(x, seam)) {
+				joinUpperNeighbours(parents, x, seam);
 			}
+		}
+	}
 
-			if (region.size() >= MIN_REGION_SIZE && region.size() < image.width * image.height / 2) {
-				for (size_t ridx : region) {
-					result.isEditedRegion[ridx] = true;
+	// Parents precede their pixels, so one ascending pass points every pixel at its root.
+	std::vector<uint32_t> regionSizes(pixelCount, 0);
+	for (size_t pixel = 0; pixel < pixelCount; ++pixel) {
+		parents[pixel] = parents[parents[pixel]];
+		if (isOpen(pixel % width, pixel / width)) {
+			++regionSizes[parents[pixel]];
+		}
+	}
+
+	forEachBand(height, threadCount, [&](const size_t firstRow, const size_t endRow) {
+		for (size_t y = firstRow; y < endRow; ++y) {
+			for (size_t x = 0; x < width; ++x) {
+				if (!isOpen(x, y)) {
+					continue;
+				}
+				const size_t regionSize = regionSizes[parents[y * width + x]];
+				if (regionSize >= MIN_REGION_SIZE && regionSize < pixelCount / 2) {
+					result.editedRegion.set(x, y);
 				}
 			}
 		}
-	}
+	});
 
 	return result;
 }
 
 std::vector<float> computeTransitionWeights(const EditBoundaryInfo& boundaries,
-											size_t transitionRadius) {
-	std::vector<float> weights(boundaries.width * boundaries.height, 0.0f);
-
-	if (transitionRadius == 0) {
-		for (size_t i = 0; i < weights.size(); ++i) {
-			weights[i] = boundaries.isEditedRegion[i] ? 1.0f : 0.0f;
+											size_t transitionRadius,
+											const size_t threadCount) {
+	const size_t width = boundaries.width;
+	const size_t height = boundaries.height;
+	std::vector<float> weights(width * height, 0.0f);
+
+	for (size_t y = 0; y < height; ++y) {
+		for (size_t x = 0; x < width; ++x) {
+			weights[y * width + x] = boundaries.isEdited(x, y) ? 1.0f : 0.0f;
 		}
+	}
+	if (transitionRadius == 0) {
 		return weights;
 	}
 
-
-
-	for (size_t y = 0; y < boundaries.height; ++y) {
-		for (size_t x = 0; x < boundaries.width; ++x) {
-			const size_t idx = y * boundaries.width + x;
-
-			if (boundaries.boundaryWeights[idx] <= 0.0f) {
-				weights[idx] = boundaries.isEditedRegion[idx] ? 1.0f : 0.0f;
+	// Unedited pixels that are not boundaries, as bits alongside the edited mask.
+	EditMask unedited(width, height);
+	std::vector<uint8_t> rowHasBoundary(height, 0);
+	forEachBand(height, threadCount, [&](const size_t firstRow, const size_t endRow) {
+		for (size_t y = firstRow; y < endRow; ++y) {
+			for (size_t x = 0; x < width; ++x) {
+				if (boundaries.boundaryWeights[y * width + x] > 0.0f) {
+					rowHasBoundary[y] = 1;
+				} else if (!boundaries.isEdited(x, y)) {
+					unedited.set(x, y);
+				}
+			}
+		}
+	});
+
+	const auto radius = static_cast<uint32_t>(transitionRadius);
+	forEachBand(height, threadCount, [&](const size_t firstRow, const size_t endRow) {
+		std::vector<uint64_t> reached;
+		std::vector<uint32_t> toEdited;
+		std::vector<uint32_t> toUnedited;
+		for (size_t y = firstRow; y < endRow; ++y) {
+			if (!rowHasBoundary[y]) {
 				continue;
 			}
+			columnDistances(boundaries.editedRegion, width, height, y, radius, reached, toEdited);
+			columnDistances(unedited, width, height, y, radius, reached, toUnedited);
 
-			float minDistToUnedited = static_cast<float>(transitionRadius + 1);
-			float minDistToEdited = static_cast<float>(transitionRadius + 1);
-
-			for (int dy = -static_cast<int>(transitionRadius);
-				 dy <= static_cast<int>(transitionRadius); ++dy) {
-				for (int dx = -static_cast<int>(transitionRadius);
-					 dx <= static_cast<int>(transitionRadius); ++dx) {
-					const int nx = static_cast<int>(x) + dx;
-					const int ny = static_cast<int>(y) + dy;
-
-					if (nx < 0 || nx >= static_cast<int>(boundaries.width) ||
-						ny < 0 || ny >= static_cast<int>(boundaries.height)) {
-						continue;
-					}
-
-					const size_t nidx = static_cast<size_t>(ny) * boundaries.width +
-										static_cast<size_t>(nx);
-					const float dist = std::sqrt(static_cast<float>(dx * dx + dy * dy));
-
-					if (boundaries.isEditedRegion[nidx]) {
-						minDistToEdited = std::min(minDistToEdited, dist);
-					} else if (boundaries.boundaryWeights[nidx] <= 0.0f) {
-						minDistToUnedited = std::min(minDistToUnedited, dist);
-					}
+			for (size_t x = 0; x < width; ++x) {
+				const size_t idx = y * width + x;
+				if (boundaries.boundaryWeights[idx] <= 0.0f) {
+					continue;
 				}
-			}
 
-			const float totalDist = minDistToEdited + minDistToUnedited;
-			if (totalDist > 0.0f) {
-				const float t = minDistToUnedited / totalDist;
-				weights[idx] = 0.5f * (1.0f - std::cos(t * 3.14159265f));
-			} else {
-				weights[idx] = boundaries.isEditedRegion[idx] ? 1.0f : 0.0f;
+				const float minDistToEdited = nearestWithinRadius(toEdited, width, x, radius);
+				const float minDistToUnedited = nearestWithinRadius(toUnedited, width, x, radius);
+
+				const float totalDist = minDistToEdited + minDistToUnedited;
+				if (totalDist > 0.0f) {
+					const float t = minDistToUnedited / totalDist;
+					weights[idx] = 0.5f * (1.0f - std::cos(t * 3.14159265f));
+				}
 			}
 		}
-	}
+	});
 
 	return weights;
 }
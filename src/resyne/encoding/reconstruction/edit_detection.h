@@ -3,20 +3,43 @@
 #include "resyne/encoding/spectral/colour_native_codec.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace PhaseReconstruction {
 
+// One bit per pixel, each row starting on a fresh 64-bit word so bands of rows can be
+// written in parallel and rows combined a word at a time.
+class EditMask {
+public:
+	EditMask() = default;
+	EditMask(size_t width, size_t height)
+		: rowWords((width + 63) / 64), words(rowWords * height, 0) {}
+
+	bool test(size_t x, size_t y) const {
+		return ((words[y * rowWords + x / 64] >> (x % 64)) & 1U) != 0;
+	}
+	void set(size_t x, size_t y) { words[y * rowWords + x / 64] |= uint64_t{1} << (x % 64); }
+
+	size_t wordsPerRow() const { return rowWords; }
+	const uint64_t* row(size_t y) const { return words.data() + y * rowWords; }
+	uint64_t* row(size_t y) { return words.data() + y * rowWords; }
+
+private:
+	size_t rowWords = 0;
+	std::vector<uint64_t> words;
+};
+
 struct EditBoundaryInfo {
 	std::vector<float> boundaryWeights;
-	std::vector<bool> isEditedRegion;
+	EditMask editedRegion;
 	size_t width;
 	size_t height;
 
 	EditBoundaryInfo() : width(0), height(0) {}
 	EditBoundaryInfo(size_t w, size_t h)
 		: boundaryWeights(w * h, 0.0f),
-		  isEditedRegion(w * h, false),
+		  editedRegion(w, h),
 		  width(w),
 		  height(h) {}
 
@@ -25,16 +48,23 @@ struct EditBoundaryInfo {
 	}
 
 	bool isEdited(size_t x, size_t y) const {
-		return isEditedRegion[y * width + x];
+		return editedRegion.test(x, y);
 	}
 };
 
+// Both detectors split the image into bands of rows spread over up to threadCount threads.
 EditBoundaryInfo detectEditBoundaries(const ColourNativeImage& original,
-									  const ColourNativeImage& edited);
+									  const ColourNativeImage& edited,
+									  size_t threadCount = 1);
 
-EditBoundaryInfo detectEditBoundariesSingleImage(const ColourNativeImage& image);
+EditBoundaryInfo detectEditBoundariesSingleImage(const ColourNativeImage& image,
+												 size_t threadCount = 1);
 
+// Distances to the nearest edited and unedited pixel within the radius come from a separable
+// transform: the masks are dilated down the columns a word at a time for rows holding
+// boundaries, then each boundary pixel scans its row, costing O(radius) rather than O(radius^2).
 std::vector<float> computeTransitionWeights(const EditBoundaryInfo& boundaries,
-											size_t transitionRadius);
+											size_t transitionRadius,
+											size_t threadCount = 1);
 
 }
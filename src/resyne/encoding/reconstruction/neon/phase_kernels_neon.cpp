@@ -0,0 +1,118 @@
+#include "phase_kernels_neon.h"
+
+#ifdef __ARM_NEON
+
+#include <limits>
+#include <numbers>
+
+namespace PhaseKernelsNEON {
+
+namespace {
+
+constexpr float PI = std::numbers::pi_v<float>;
+constexpr float TWO_PI = 2.0f * PI;
+
+// Floor-based equivalent of the scalar fmod wrap into [-pi, pi).
+float32x4_t wrap(const float32x4_t values) {
+    const float32x4_t shifted = vaddq_f32(values, vdupq_n_f32(PI));
+    const float32x4_t turns = vrndmq_f32(vmulq_n_f32(shifted, 1.0f / TWO_PI));
+    return vsubq_f32(vsubq_f32(shifted, vmulq_n_f32(turns, TWO_PI)), vdupq_n_f32(PI));
+}
+
+bool anySet(const uint32x4_t mask) {
+    return vmaxvq_u32(mask) != 0;
+}
+
+float32x4_t maskOf(const float32x4_t values, const uint32x4_t mask) {
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(values), mask));
+}
+
+}
+
+std::size_t wrapToPi(const float* in, float* out, const std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, wrap(vld1q_f32(in + i)));
+    }
+    return i;
+}
+
+std::size_t smoothNeighbours(const float* phases, const float* magnitudes, float* smoothed,
+                             const std::size_t count, const float minMagnitude, const float smoothing) {
+    const float32x4_t threshold = vdupq_n_f32(minMagnitude);
+
+    std::size_t bin = 1;
+    for (; bin + 5 <= count; bin += 4) {
+        const float32x4_t magnitude = vld1q_f32(magnitudes + bin);
+        const uint32x4_t active = vcgtq_f32(magnitude, threshold);
+        if (!anySet(active)) {
+            continue;
+        }
+
+        const float32x4_t lowerMagnitude = vld1q_f32(magnitudes + bin - 1);
+        const float32x4_t upperMagnitude = vld1q_f32(magnitudes + bin + 1);
+        const float32x4_t lowerWeight = maskOf(lowerMagnitude, vcgtq_f32(lowerMagnitude, threshold));
+        const float32x4_t upperWeight = maskOf(upperMagnitude, vcgtq_f32(upperMagnitude, threshold));
+        const float32x4_t centreWeight = vmulq_n_f32(magnitude, 2.0f);
+        const float32x4_t centrePhase = vld1q_f32(phases + bin);
+
+        // Accumulated in the scalar pass's order: lower, upper, then centre.
+        float32x4_t phaseSum = vmulq_f32(vld1q_f32(phases + bin - 1), lowerWeight);
+        phaseSum = vaddq_f32(phaseSum, vmulq_f32(vld1q_f32(phases + bin + 1), upperWeight));
+        phaseSum = vaddq_f32(phaseSum, vmulq_f32(centrePhase, centreWeight));
+        const float32x4_t weightSum = vaddq_f32(vaddq_f32(lowerWeight, upperWeight), centreWeight);
+
+        const float32x4_t average = vdivq_f32(phaseSum, weightSum);
+        const float32x4_t blended = wrap(vaddq_f32(vmulq_n_f32(average, smoothing),
+                                                   vmulq_n_f32(centrePhase, 1.0f - smoothing)));
+        vst1q_f32(smoothed + bin, vbslq_f32(active, blended, vld1q_f32(smoothed + bin)));
+    }
+    return bin;
+}
+
+std::size_t stepTowards(float* phases, const float* targets, const std::size_t count, const float gain) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t current = vld1q_f32(phases + i);
+        const float32x4_t delta = wrap(vsubq_f32(vld1q_f32(targets + i), current));
+        vst1q_f32(phases + i, wrap(vaddq_f32(current, vmulq_n_f32(delta, gain))));
+    }
+    return i;
+}
+
+std::size_t alignToExpected(float* reconstructed, const float* previous, const float* frequencies,
+                            const float* weights, const std::size_t count, const float binWidth,
+                            const float hopSize, const float sampleRate) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t infinity = vdupq_n_f32(std::numeric_limits<float>::infinity());
+    const float lanes[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const float32x4_t lane = vld1q_f32(lanes);
+
+    std::size_t bin = 0;
+    for (; bin + 4 <= count; bin += 4) {
+        const float32x4_t weight = vminq_f32(vmaxq_f32(vld1q_f32(weights + bin), zero), vdupq_n_f32(1.0f));
+        const uint32x4_t active = vcgtq_f32(weight, zero);
+        if (!anySet(active)) {
+            continue;
+        }
+
+        // Ordered compares reject NaN, so this is isfinite(f) && f > 0.
+        const float32x4_t stored = vld1q_f32(frequencies + bin);
+        const uint32x4_t usable = vandq_u32(vcgtq_f32(stored, zero), vcltq_f32(stored, infinity));
+        const float32x4_t centre = vmulq_n_f32(vaddq_f32(vdupq_n_f32(static_cast<float>(bin)), lane), binWidth);
+        const float32x4_t frequency = vbslq_f32(usable, stored, centre);
+
+        const float32x4_t advance = vdivq_f32(vmulq_n_f32(vmulq_n_f32(frequency, TWO_PI), hopSize),
+                                              vdupq_n_f32(sampleRate));
+        const float32x4_t expected = wrap(vaddq_f32(vld1q_f32(previous + bin), advance));
+        const float32x4_t current = vld1q_f32(reconstructed + bin);
+        const float32x4_t delta = wrap(vsubq_f32(current, expected));
+        const float32x4_t aligned = wrap(vaddq_f32(expected, vmulq_f32(delta, weight)));
+        vst1q_f32(reconstructed + bin, vbslq_f32(active, aligned, current));
+    }
+    return bin;
+}
+
+}
+
+#endif
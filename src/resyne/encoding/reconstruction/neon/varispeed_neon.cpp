@@ -0,0 +1,40 @@
+#include "varispeed_neon.h"
+
+#ifdef __ARM_NEON
+
+#include <algorithm>
+
+namespace VarispeedNEON {
+
+std::size_t resample(const float* input, const float* bank, const std::size_t tapCount,
+                     const std::size_t phaseCount, const double start, const double step,
+                     const std::size_t firstOutput, float* output, const std::size_t count) {
+    if (tapCount == 0 || tapCount % 4 != 0) {
+        return 0;
+    }
+
+    const std::size_t leading = tapCount / 2 - 1;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double position = start + static_cast<double>(firstOutput + i) * step;
+        const auto index = static_cast<std::size_t>(position);
+        const double scaled = (position - static_cast<double>(index)) * static_cast<double>(phaseCount);
+        const std::size_t phase = std::min(static_cast<std::size_t>(scaled), phaseCount - 1);
+        const float mix = static_cast<float>(scaled - static_cast<double>(phase));
+
+        const float* window = input + index - leading;
+        const float* taps = bank + phase * tapCount * 2;
+        const float* deltas = taps + tapCount;
+
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (std::size_t k = 0; k < tapCount; k += 4) {
+            const float32x4_t tap = vmlaq_n_f32(vld1q_f32(taps + k), vld1q_f32(deltas + k), mix);
+            sum = vmlaq_f32(sum, vld1q_f32(window + k), tap);
+        }
+        output[i] = vaddvq_f32(sum);
+    }
+    return count;
+}
+
+}
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <cstddef>
+
+namespace VarispeedNEON {
+    // Polyphase interpolation for Varispeed::Resampler. output[i] is the bank's filter for
+    // the source position start + (firstOutput + i) * step, applied to the tapCount samples
+    // around it; every such window must lie inside input. Returns how many outputs it
+    // wrote, which is none unless tapCount is a multiple of 4.
+    std::size_t resample(const float* input, const float* bank, std::size_t tapCount,
+                         std::size_t phaseCount, double start, double step,
+                         std::size_t firstOutput, float* output, std::size_t count);
+}
+
+#endif
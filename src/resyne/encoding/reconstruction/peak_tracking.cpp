@@ -0,0 +1,111 @@
+#include "peak_tracking.h"
+#include "damage_detection.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace PhaseReconstruction {
+
+namespace {
+constexpr float LOG_FLOOR = 1e-12f;
+
+float logMagnitude(const float magnitude) {
+	return std::log(std::max(magnitude, LOG_FLOOR));
+}
+}
+
+std::span<const TrackedPeak> PeakTrackSequence::frame(const size_t index) const {
+	if (index + 1 >= frameStarts.size()) {
+		return {};
+	}
+	return std::span<const TrackedPeak>(peaks).subspan(frameStarts[index], frameStarts[index + 1] - frameStarts[index]);
+}
+
+void PeakTrackSequence::append(std::span<const TrackedPeak> framePeaks) {
+	peaks.insert(peaks.end(), framePeaks.begin(), framePeaks.end());
+	frameStarts.push_back(static_cast<uint32_t>(peaks.size()));
+}
+
+PeakTracker::PeakTracker(const size_t peakCount, const float magnitudeFloor, const float jumpLimitBins)
+	: peakLimit(std::max<size_t>(peakCount, 1)), minPeakMagnitude(magnitudeFloor), maxJumpBins(jumpLimitBins) {
+	previous.reserve(peakLimit);
+	current.reserve(peakLimit);
+	claimed.reserve(peakLimit);
+}
+
+void PeakTracker::reset() {
+	previous.clear();
+}
+
+void PeakTracker::track(std::span<const float> magnitudes,
+						std::span<const float> phases,
+						const float binSpacingHz,
+						std::vector<TrackedPeak>& peaks,
+						std::span<const float> binFrequencies) {
+	peaks.clear();
+	current.clear();
+	findSpectralPeaks(magnitudes, minPeakMagnitude, candidates);
+
+	const auto stronger = [&](const size_t lhs, const size_t rhs) {
+		return magnitudes[lhs] > magnitudes[rhs];
+	};
+	if (candidates.size() > peakLimit) {
+		std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(peakLimit - 1),
+						 candidates.end(), stronger);
+		candidates.resize(peakLimit);
+	}
+	std::sort(candidates.begin(), candidates.end(), stronger);
+
+	const bool axisGiven = binFrequencies.size() == magnitudes.size();
+	claimed.assign(previous.size(), 0);
+	for (const size_t bin : candidates) {
+		// findSpectralPeaks never returns the edge bins, so both neighbours exist.
+		const float below = logMagnitude(magnitudes[bin - 1]);
+		const float centre = logMagnitude(magnitudes[bin]);
+		const float above = logMagnitude(magnitudes[bin + 1]);
+		const float curvature = below - 2.0f * centre + above;
+		const float offset = curvature < 0.0f ? std::clamp(0.5f * (below - above) / curvature, -0.5f, 0.5f) : 0.0f;
+		const float position = static_cast<float>(bin) + offset;
+
+		float frequencyHz = position * binSpacingHz;
+		if (axisGiven) {
+			const float spacing = offset >= 0.0f ? binFrequencies[bin + 1] - binFrequencies[bin]
+												 : binFrequencies[bin] - binFrequencies[bin - 1];
+			frequencyHz = binFrequencies[bin] + offset * spacing;
+		}
+
+		size_t match = previous.size();
+		float matchDistance = maxJumpBins;
+		for (size_t i = 0; i < previous.size(); ++i) {
+			const float distance = std::abs(previous[i].bin - position);
+			if (!claimed[i] && distance <= matchDistance) {
+				match = i;
+				matchDistance = distance;
+			}
+		}
+
+		uint32_t trackId = 0;
+		if (match < previous.size()) {
+			claimed[match] = 1;
+			trackId = previous[match].track;
+		} else {
+			trackId = nextTrack++;
+			if (nextTrack == 0) {
+				nextTrack = 1;
+			}
+		}
+
+		current.push_back({position, trackId});
+		peaks.push_back({trackId,
+						 frequencyHz,
+						 std::exp(centre - 0.25f * (below - above) * offset),
+						 bin < phases.size() ? phases[bin] : 0.0f});
+	}
+
+	std::sort(peaks.begin(), peaks.end(), [](const TrackedPeak& lhs, const TrackedPeak& rhs) {
+		return lhs.frequencyHz < rhs.frequencyHz;
+	});
+	previous.swap(current);
+}
+
+}
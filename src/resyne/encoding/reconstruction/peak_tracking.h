@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace PhaseReconstruction {
+
+// One partial in one frame. track is shared by the same partial across the frames it lasts
+// and never reused afterwards, so consumers can follow it without matching frequencies.
+struct TrackedPeak {
+	uint32_t track = 0;
+	float frequencyHz = 0.0f;
+	float magnitude = 0.0f;
+	float phase = 0.0f;
+};
+
+// The peaks of a run of frames, flat: frame f holds peaks [frameStarts[f], frameStarts[f + 1]).
+struct PeakTrackSequence {
+	std::vector<TrackedPeak> peaks;
+	std::vector<uint32_t> frameStarts{0};
+
+	size_t frameCount() const { return frameStarts.size() - 1; }
+	std::span<const TrackedPeak> frame(size_t index) const;
+	void append(std::span<const TrackedPeak> framePeaks);
+};
+
+// Reduces each frame to its maxPeaks strongest local maxima and links them into tracks from
+// frame to frame. Frequency and magnitude are refined by quadratic interpolation of the log
+// magnitudes around the peak bin; the phase is the peak bin's own, which phase locking holds
+// its neighbours to. Strongest first, each peak continues the nearest unclaimed peak of the
+// previous frame within maxJumpBins, or else starts a new track.
+// Smith & Serra (1987) - PARSHL; McAulay & Quatieri (1986) - sinusoidal track birth and death
+class PeakTracker {
+public:
+	explicit PeakTracker(size_t peakCount = 16, float magnitudeFloor = 1e-4f, float jumpLimitBins = 2.0f);
+
+	size_t maxPeaks() const { return peakLimit; }
+
+	// binFrequencies gives every bin's centre in Hz; when empty, bins are binSpacingHz apart
+	// from 0 Hz. peaks comes back in ascending frequency. Allocates nothing once warm.
+	void track(std::span<const float> magnitudes,
+			   std::span<const float> phases,
+			   float binSpacingHz,
+			   std::vector<TrackedPeak>& peaks,
+			   std::span<const float> binFrequencies = {});
+	// Ends every track, as after a seek or a change of input.
+	void reset();
+
+private:
+	struct LivePeak {
+		float bin;
+		uint32_t track;
+	};
+
+	size_t peakLimit;
+	float minPeakMagnitude;
+	float maxJumpBins;
+	uint32_t nextTrack = 1;
+	std::vector<LivePeak> previous;
+	std::vector<LivePeak> current;
+	std::vector<uint8_t> claimed;
+	std::vector<size_t> candidates;
+};
+
+}
@@ -2,9 +2,11 @@
 #include "phase_wrapping.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <numbers>
-#include <utility>
+
+#include "utilities/threading/task_scheduler.h"
 
 namespace PhaseReconstruction {
 
@@ -12,6 +14,14 @@ namespace {
 constexpr float EPSILON = 1e-6f;
 constexpr float MIN_BIN_INTENSITY = 1e-6f;
 constexpr float TWO_PI = 2.0f * std::numbers::pi_v<float>;
+
+bool isVisited(const std::vector<std::uint64_t>& visited, const size_t bin) {
+	return (visited[bin >> 6] >> (bin & 63)) & 1u;
+}
+
+void markVisited(std::vector<std::uint64_t>& visited, const size_t bin) {
+	visited[bin >> 6] |= std::uint64_t{1} << (bin & 63);
+}
 }
 
 void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
@@ -20,7 +30,8 @@ void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 					  std::vector<float>& phases,
 					  float sampleRate,
 					  int hopSize,
-					  const std::vector<float>* prevOutputPhase) {
+					  const std::vector<float>* prevOutputPhase,
+					  PGHIWorkspace& workspace) {
 	const size_t numBins = phases.size();
 	if (numBins == 0 || allMagnitudes.empty() || currentFrame >= allMagnitudes.size()) {
 		return;
@@ -32,28 +43,34 @@ void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 		? &allFrequencies[currentFrame]
 		: nullptr;
 
-	std::vector<bool> visited(numBins, false);
-	std::vector<std::pair<float, size_t>> heap;
+	std::vector<std::uint64_t>& visited = workspace.visited;
+	visited.assign((numBins + 63) / 64, 0);
+	std::vector<float>& logMagnitudes = workspace.logMagnitudes;
+	logMagnitudes.resize(numBins);
 
+	// Integration only ever starts from the single strongest bin and then spreads outward
+	// in queue order, so the heap reduces to an argmax; ties go to the higher bin, as the
+	// max-heap of (magnitude, bin) pairs popped them.
+	size_t seedBin = numBins;
+	float seedMagnitude = 0.0f;
 	for (size_t bin = 0; bin < numBins; ++bin) {
-		if (magnitudes[bin] > MIN_BIN_INTENSITY) {
-			heap.push_back({magnitudes[bin], bin});
+		const float magnitude = magnitudes[bin];
+		logMagnitudes[bin] = std::log(std::max(magnitude, EPSILON));
+		if (magnitude > MIN_BIN_INTENSITY) {
+			if (seedBin == numBins || magnitude >= seedMagnitude) {
+				seedBin = bin;
+				seedMagnitude = magnitude;
+			}
 		} else {
 			phases[bin] = 0.0f;
-			visited[bin] = true;
+			markVisited(visited, bin);
 		}
 	}
 
-	std::make_heap(heap.begin(), heap.end());
-
-	if (heap.empty()) {
+	if (seedBin == numBins) {
 		return;
 	}
 
-	std::pop_heap(heap.begin(), heap.end());
-	const size_t seedBin = heap.back().second;
-	heap.pop_back();
-
 	const float freqResolution = sampleRate / fftSize;
 	const float binPhaseAdvance = TWO_PI * freqResolution * static_cast<float>(hopSize) / sampleRate;
 
@@ -67,9 +84,10 @@ void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 	} else {
 		phases[seedBin] = binPhaseAdvance * static_cast<float>(seedBin);
 	}
-	visited[seedBin] = true;
+	markVisited(visited, seedBin);
 
-	std::vector<size_t> integrationQueue;
+	std::vector<size_t>& integrationQueue = workspace.integrationQueue;
+	integrationQueue.clear();
 	integrationQueue.push_back(seedBin);
 	size_t queuePos = 0;
 
@@ -87,24 +105,20 @@ void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 	while (queuePos < integrationQueue.size()) {
 		const size_t currentBin = integrationQueue[queuePos++];
 
-		if (currentBin > 0 && !visited[currentBin - 1] && magnitudes[currentBin - 1] > MIN_BIN_INTENSITY) {
-			const float logMagCurrent = std::log(std::max(magnitudes[currentBin], EPSILON));
-			const float logMagPrev = std::log(std::max(magnitudes[currentBin - 1], EPSILON));
-			const float phaseGradient = 0.5f * (logMagCurrent - logMagPrev);
+		if (currentBin > 0 && !isVisited(visited, currentBin - 1) && magnitudes[currentBin - 1] > MIN_BIN_INTENSITY) {
+			const float phaseGradient = 0.5f * (logMagnitudes[currentBin] - logMagnitudes[currentBin - 1]);
 
 			phases[currentBin - 1] = wrapToPi(phases[currentBin] - phaseGradient - binPhaseAdvance);
-			visited[currentBin - 1] = true;
+			markVisited(visited, currentBin - 1);
 			alignToPrevious(currentBin - 1);
 			integrationQueue.push_back(currentBin - 1);
 		}
 
-		if (currentBin + 1 < numBins && !visited[currentBin + 1] && magnitudes[currentBin + 1] > MIN_BIN_INTENSITY) {
-			const float logMagCurrent = std::log(std::max(magnitudes[currentBin], EPSILON));
-			const float logMagNext = std::log(std::max(magnitudes[currentBin + 1], EPSILON));
-			const float phaseGradient = 0.5f * (logMagNext - logMagCurrent);
+		if (currentBin + 1 < numBins && !isVisited(visited, currentBin + 1) && magnitudes[currentBin + 1] > MIN_BIN_INTENSITY) {
+			const float phaseGradient = 0.5f * (logMagnitudes[currentBin + 1] - logMagnitudes[currentBin]);
 
 			phases[currentBin + 1] = wrapToPi(phases[currentBin] + phaseGradient + binPhaseAdvance);
-			visited[currentBin + 1] = true;
+			markVisited(visited, currentBin + 1);
 			alignToPrevious(currentBin + 1);
 			integrationQueue.push_back(currentBin + 1);
 		}
@@ -116,9 +130,8 @@ void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 		const auto& prevMagnitudes = allMagnitudes[currentFrame - 1];
 		for (size_t bin = 0; bin < numBins; ++bin) {
 			if (magnitudes[bin] > MIN_BIN_INTENSITY && prevMagnitudes[bin] > MIN_BIN_INTENSITY) {
-				const float logMagCurrent = std::log(std::max(magnitudes[bin], EPSILON));
 				const float logMagPrev = std::log(std::max(prevMagnitudes[bin], EPSILON));
-				const float timeGradient = (logMagCurrent - logMagPrev);
+				const float timeGradient = (logMagnitudes[bin] - logMagPrev);
 
 				phases[bin] = wrapToPi(phases[bin] + 0.5f * timeGradient);
 			}
@@ -126,4 +139,187 @@ void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 	}
 }
 
+void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
+					  const std::vector<std::vector<float>>& allFrequencies,
+					  size_t currentFrame,
+					  std::vector<float>& phases,
+					  float sampleRate,
+					  int hopSize,
+					  const std::vector<float>* prevOutputPhase) {
+	thread_local PGHIWorkspace workspace;
+	reconstructPhasePGHI(allMagnitudes, allFrequencies, currentFrame, phases, sampleRate, hopSize, prevOutputPhase, workspace);
+}
+
+void reconstructPhasePGHIBlock(std::span<const float> magnitudes,
+						   std::span<const float> frequencies,
+						   size_t frameCount,
+						   size_t binCount,
+						   std::span<float> phases,
+						   float sampleRate,
+						   int hopSize,
+						   PGHIWorkspace& workspace) {
+	const size_t cellCount = frameCount * binCount;
+	if (cellCount == 0 || magnitudes.size() < cellCount || phases.size() < cellCount ||
+		sampleRate <= EPSILON || hopSize <= 0) {
+		return;
+	}
+
+	const bool hasFrequencies = frequencies.size() >= cellCount;
+	const float fftSize = static_cast<float>(binCount > 1 ? (binCount - 1) * 2 : 2);
+	const float freqResolution = sampleRate / fftSize;
+	const float hop = static_cast<float>(hopSize);
+	const float binPhaseAdvance = TWO_PI * freqResolution * hop / sampleRate;
+
+	std::vector<std::uint64_t>& visited = workspace.visited;
+	visited.assign((cellCount + 63) / 64, 0);
+	std::vector<float>& logMagnitudes = workspace.logMagnitudes;
+	logMagnitudes.resize(cellCount);
+	std::vector<size_t>& seedOrder = workspace.integrationQueue;
+	seedOrder.clear();
+
+	for (size_t cell = 0; cell < cellCount; ++cell) {
+		const float magnitude = magnitudes[cell];
+		logMagnitudes[cell] = std::log(std::max(magnitude, EPSILON));
+		if (magnitude > MIN_BIN_INTENSITY) {
+			seedOrder.push_back(cell);
+		} else {
+			phases[cell] = 0.0f;
+			markVisited(visited, cell);
+		}
+	}
+
+	// Islands the heap cannot reach from an earlier seed start from their own strongest bin.
+	std::sort(seedOrder.begin(), seedOrder.end(), [&magnitudes](const size_t a, const size_t b) {
+		return magnitudes[a] > magnitudes[b] || (magnitudes[a] == magnitudes[b] && a > b);
+	});
+
+	const auto advanceAt = [&](const size_t cell) {
+		float frequency = hasFrequencies ? frequencies[cell] : 0.0f;
+		if (!std::isfinite(frequency) || frequency <= 0.0f) {
+			frequency = freqResolution * static_cast<float>(cell % binCount);
+		}
+		return TWO_PI * frequency * hop / sampleRate;
+	};
+
+	std::vector<std::pair<float, size_t>>& heap = workspace.heap;
+	heap.clear();
+	const auto visit = [&](const size_t cell, const float phase) {
+		phases[cell] = wrapToPi(phase);
+		markVisited(visited, cell);
+		heap.push_back({magnitudes[cell], cell});
+		std::push_heap(heap.begin(), heap.end());
+	};
+	const auto reachable = [&](const size_t cell) {
+		return !isVisited(visited, cell) && magnitudes[cell] > MIN_BIN_INTENSITY;
+	};
+
+	for (const size_t seed : seedOrder) {
+		if (isVisited(visited, seed)) {
+			continue;
+		}
+		visit(seed, binPhaseAdvance * static_cast<float>(seed % binCount));
+
+		while (!heap.empty()) {
+			std::pop_heap(heap.begin(), heap.end());
+			const size_t cell = heap.back().second;
+			heap.pop_back();
+
+			const size_t frame = cell / binCount;
+			const size_t bin = cell % binCount;
+			const float phase = phases[cell];
+
+			// Time direction: trapezoidal integration of the instantaneous frequency.
+			if (frame + 1 < frameCount && reachable(cell + binCount)) {
+				visit(cell + binCount, phase + 0.5f * (advanceAt(cell) + advanceAt(cell + binCount)));
+			}
+			if (frame > 0 && reachable(cell - binCount)) {
+				visit(cell - binCount, phase - 0.5f * (advanceAt(cell) + advanceAt(cell - binCount)));
+			}
+
+			// Frequency direction, as in the per-frame pass.
+			if (bin + 1 < binCount && reachable(cell + 1)) {
+				visit(cell + 1, phase + 0.5f * (logMagnitudes[cell + 1] - logMagnitudes[cell]) + binPhaseAdvance);
+			}
+			if (bin > 0 && reachable(cell - 1)) {
+				visit(cell - 1, phase - 0.5f * (logMagnitudes[cell] - logMagnitudes[cell - 1]) - binPhaseAdvance);
+			}
+		}
+	}
+}
+
+void reconstructPhasePGHIBlocks(std::span<const float> magnitudes,
+							std::span<const float> frequencies,
+							size_t frameCount,
+							size_t binCount,
+							std::span<float> phases,
+							float sampleRate,
+							int hopSize,
+							size_t blockFrames,
+							size_t threadCount) {
+	const size_t cellCount = frameCount * binCount;
+	if (cellCount == 0 || magnitudes.size() < cellCount || phases.size() < cellCount) {
+		return;
+	}
+
+	blockFrames = std::max<size_t>(2, blockFrames);
+	const size_t blockCount = (frameCount + blockFrames - 1) / blockFrames;
+	const bool hasFrequencies = frequencies.size() >= cellCount;
+
+	// Every block after the first also reconstructs the previous block's last frame; that
+	// row is kept aside and the rest is written straight into place, so blocks never share
+	// output.
+	std::vector<std::vector<float>> boundaryRows(blockCount);
+	std::atomic<size_t> nextBlock{0};
+	const auto worker = [&] {
+		PGHIWorkspace workspace;
+		std::vector<float> blockPhases;
+		for (size_t block = nextBlock.fetch_add(1); block < blockCount; block = nextBlock.fetch_add(1)) {
+			const size_t firstFrame = block == 0 ? 0 : block * blockFrames - 1;
+			const size_t endFrame = std::min(frameCount, (block + 1) * blockFrames);
+			const size_t first = firstFrame * binCount;
+			const size_t count = (endFrame - firstFrame) * binCount;
+
+			blockPhases.assign(count, 0.0f);
+			reconstructPhasePGHIBlock(
+				magnitudes.subspan(first, count),
+				hasFrequencies ? frequencies.subspan(first, count) : std::span<const float>(),
+				endFrame - firstFrame,
+				binCount,
+				blockPhases,
+				sampleRate,
+				hopSize,
+				workspace);
+
+			const size_t skipped = block == 0 ? 0 : binCount;
+			if (block > 0) {
+				boundaryRows[block].assign(blockPhases.begin(), blockPhases.begin() + static_cast<std::ptrdiff_t>(binCount));
+			}
+			std::copy(blockPhases.begin() + static_cast<std::ptrdiff_t>(skipped), blockPhases.end(),
+				phases.begin() + static_cast<std::ptrdiff_t>(first + skipped));
+		}
+	};
+
+	const size_t workers = std::clamp<size_t>(threadCount, 1, blockCount);
+	// Each range claims work until none is left, so one that starts late finds nothing.
+	::Utilities::Threading::TaskScheduler::shared().parallelFor(workers, 1, [&](const size_t first, const size_t end) {
+		for (size_t t = first; t < end; ++t) {
+			worker();
+		}
+	});
+
+	// Stitching runs in order, so each boundary row is compared against a block that is
+	// already aligned with everything before it.
+	std::vector<float> offsets(binCount);
+	for (size_t block = 1; block < blockCount; ++block) {
+		const size_t boundary = (block * blockFrames - 1) * binCount;
+		for (size_t bin = 0; bin < binCount; ++bin) {
+			offsets[bin] = phases[boundary + bin] - boundaryRows[block][bin];
+		}
+		const size_t endCell = std::min(frameCount, (block + 1) * blockFrames) * binCount;
+		for (size_t cell = boundary + binCount; cell < endCell; ++cell) {
+			phases[cell] = wrapToPi(phases[cell] + offsets[cell % binCount]);
+		}
+	}
+}
+
 }
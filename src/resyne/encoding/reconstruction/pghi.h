@@ -2,12 +2,34 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
 
 namespace PhaseReconstruction {
 
+// Scratch reused across reconstructPhasePGHI calls so the per-frame pass does not allocate
+// once it has seen the widest frame. One per thread.
+struct PGHIWorkspace {
+	std::vector<std::uint64_t> visited;
+	std::vector<float> logMagnitudes;
+	std::vector<size_t> integrationQueue;
+	std::vector<std::pair<float, size_t>> heap;
+};
+
 // Phase Gradient Heap Integration (PGHI) algorithm
 // Průša et al. (2017) - "A noniterative method for reconstruction of phase from STFT magnitude"
 // Reconstructs phase from magnitude spectrogram using heap-based integration
+void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
+					  const std::vector<std::vector<float>>& allFrequencies,
+					  size_t currentFrame,
+					  std::vector<float>& phases,
+					  float sampleRate,
+					  int hopSize,
+					  const std::vector<float>* prevOutputPhase,
+					  PGHIWorkspace& workspace);
+
+// Uses a thread-local workspace.
 void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 					  const std::vector<std::vector<float>>& allFrequencies,
 					  size_t currentFrame,
@@ -16,4 +38,31 @@ void reconstructPhasePGHI(const std::vector<std::vector<float>>& allMagnitudes,
 					  int hopSize,
 					  const std::vector<float>* prevOutputPhase);
 
+// Block PGHI: integrates phase over frameCount consecutive frames in one pass from a single
+// heap, so the strongest bins anywhere in the block seed their neighbours both across bins
+// (log-magnitude gradient) and across hops (instantaneous frequency). magnitudes and phases
+// are row-major frameCount x binCount slabs; frequencies is the same shape or empty, in which
+// case bin centres are used.
+void reconstructPhasePGHIBlock(std::span<const float> magnitudes,
+						   std::span<const float> frequencies,
+						   size_t frameCount,
+						   size_t binCount,
+						   std::span<float> phases,
+						   float sampleRate,
+						   int hopSize,
+						   PGHIWorkspace& workspace);
+
+// Splits the frames into blocks of blockFrames, reconstructs up to threadCount blocks at
+// once and stitches each onto the one before through a boundary frame both of them
+// reconstruct, rotating every bin of the later block by that frame's phase difference.
+void reconstructPhasePGHIBlocks(std::span<const float> magnitudes,
+							std::span<const float> frequencies,
+							size_t frameCount,
+							size_t binCount,
+							std::span<float> phases,
+							float sampleRate,
+							int hopSize,
+							size_t blockFrames,
+							size_t threadCount);
+
 }
@@ -5,6 +5,12 @@
 #include <numbers>
 #include <vector>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/phase_kernels_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/phase_kernels_sse.h"
+#endif
+
 namespace PhaseReconstruction {
 
 namespace {
@@ -20,10 +26,19 @@ void smoothPhase(std::vector<float>& phases,
 		return;
 	}
 
+	std::vector<float> newPhase;
 	for (size_t iter = 0; iter < iterations; ++iter) {
-		std::vector<float> newPhase = phases;
+		newPhase = phases;
 
-		for (size_t bin = 1; bin < phases.size() - 1; ++bin) {
+		size_t firstScalarBin = 1;
+#ifdef USE_NEON_OPTIMISATIONS
+		firstScalarBin = PhaseKernelsNEON::smoothNeighbours(phases.data(), targetMagnitudes.data(), newPhase.data(),
+			phases.size(), MIN_BIN_INTENSITY, SMOOTHING);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		firstScalarBin = PhaseKernelsSSE::smoothNeighbours(phases.data(), targetMagnitudes.data(), newPhase.data(),
+			phases.size(), MIN_BIN_INTENSITY, SMOOTHING);
+#endif
+		for (size_t bin = firstScalarBin; bin + 1 < phases.size(); ++bin) {
 			if (targetMagnitudes[bin] <= MIN_BIN_INTENSITY) {
 				continue;
 			}
@@ -53,7 +68,13 @@ void smoothPhase(std::vector<float>& phases,
 			}
 		}
 
-		for (size_t bin = 0; bin < phases.size(); ++bin) {
+		size_t firstScalarStep = 0;
+#ifdef USE_NEON_OPTIMISATIONS
+		firstScalarStep = PhaseKernelsNEON::stepTowards(phases.data(), newPhase.data(), phases.size(), 1.0f + MOMENTUM);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		firstScalarStep = PhaseKernelsSSE::stepTowards(phases.data(), newPhase.data(), phases.size(), 1.0f + MOMENTUM);
+#endif
+		for (size_t bin = firstScalarStep; bin < phases.size(); ++bin) {
 			const float delta = wrapToPi(newPhase[bin] - phases[bin]);
 			phases[bin] = wrapToPi(phases[bin] + delta * (1.0f + MOMENTUM));
 		}
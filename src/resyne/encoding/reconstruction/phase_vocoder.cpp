@@ -5,6 +5,12 @@
 #include <cmath>
 #include <numbers>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/phase_kernels_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/phase_kernels_sse.h"
+#endif
+
 namespace PhaseReconstruction {
 
 namespace {
@@ -31,7 +37,19 @@ void alignReconstructedPhase(std::vector<float>& reconPhases,
 		return;
 	}
 
-	for (size_t bin = 0; bin < numBins; ++bin) {
+	size_t firstScalarBin = 0;
+	if (frequencies.size() >= numBins) {
+		[[maybe_unused]] const float binWidth = sampleRate / fftSize;
+#ifdef USE_NEON_OPTIMISATIONS
+		firstScalarBin = PhaseKernelsNEON::alignToExpected(reconPhases.data(), prevOutputPhase.data(), frequencies.data(),
+			damageWeights.data(), numBins, binWidth, hop, sampleRate);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		firstScalarBin = PhaseKernelsSSE::alignToExpected(reconPhases.data(), prevOutputPhase.data(), frequencies.data(),
+			damageWeights.data(), numBins, binWidth, hop, sampleRate);
+#endif
+	}
+
+	for (size_t bin = firstScalarBin; bin < numBins; ++bin) {
 		const float weight = std::clamp(damageWeights[bin], 0.0f, 1.0f);
 		if (weight <= 0.0f) {
 			continue;
@@ -1,8 +1,15 @@
 #include "phase_wrapping.h"
 
 #include <cmath>
+#include <cstddef>
 #include <numbers>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/phase_kernels_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/phase_kernels_sse.h"
+#endif
+
 namespace PhaseReconstruction {
 
 namespace {
@@ -17,4 +24,16 @@ float wrapToPi(float value) {
 	return wrapped - std::numbers::pi_v<float>;
 }
 
+void wrapToPi(std::span<float> values) {
+	std::size_t processed = 0;
+#ifdef USE_NEON_OPTIMISATIONS
+	processed = PhaseKernelsNEON::wrapToPi(values.data(), values.data(), values.size());
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	processed = PhaseKernelsSSE::wrapToPi(values.data(), values.data(), values.size());
+#endif
+	for (std::size_t i = processed; i < values.size(); ++i) {
+		values[i] = wrapToPi(values[i]);
+	}
+}
+
 }
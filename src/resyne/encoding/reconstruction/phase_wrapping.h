@@ -1,7 +1,12 @@
 #pragma once
 
+#include <span>
+
 namespace PhaseReconstruction {
 
 float wrapToPi(float value);
 
+// Wraps a whole row in place.
+void wrapToPi(std::span<float> values);
+
 }
@@ -20,6 +20,26 @@ float computeShiftRatio(float decodedFrequency, float expectedFrequency) {
 	return decodedFrequency / expectedFrequency;
 }
 
+bool hasSignificantShift(
+	std::span<const float> decodedFrequencies,
+	float sampleRate,
+	size_t fftSize
+) {
+	const float freqResolution = (fftSize > 0 && sampleRate > 0.0f)
+		? sampleRate / static_cast<float>(fftSize)
+		: 1.0f;
+
+	for (size_t bin = 1; bin < decodedFrequencies.size(); ++bin) {
+		const float expectedFreq = freqResolution * static_cast<float>(bin);
+		const float decodedFreq = decodedFrequencies[bin];
+		if (expectedFreq > EPSILON && decodedFreq > EPSILON &&
+			std::abs(decodedFreq / expectedFreq - 1.0f) > SHIFT_DETECTION_THRESHOLD) {
+			return true;
+		}
+	}
+	return false;
+}
+
 ResampledSpectrum resampleSpectrum(
 	const std::vector<float>& magnitudes,
 	const std::vector<float>& phases,
@@ -36,6 +56,12 @@ ResampledSpectrum resampleSpectrum(
 		return result;
 	}
 
+	if (!hasSignificantShift(decodedFrequencies, sampleRate, fftSize)) {
+		result.magnitudes = magnitudes;
+		result.phases = phases;
+		return result;
+	}
+
 	result.magnitudes.assign(numBins, 0.0f);
 	result.phases.assign(numBins, 0.0f);
 
@@ -44,7 +70,6 @@ ResampledSpectrum resampleSpectrum(
 		: 1.0f;
 
 	std::vector<float> shiftRatios(numBins, 1.0f);
-	bool hasSignificantShift = false;
 
 	for (size_t bin = 1; bin < numBins; ++bin) {
 		const float expectedFreq = freqResolution * static_cast<float>(bin);
@@ -53,19 +78,9 @@ ResampledSpectrum resampleSpectrum(
 		if (expectedFreq > EPSILON && decodedFreq > EPSILON) {
 			const float ratio = decodedFreq / expectedFreq;
 			shiftRatios[bin] = std::clamp(ratio, MIN_SHIFT_RATIO, MAX_SHIFT_RATIO);
-
-			if (std::abs(ratio - 1.0f) > SHIFT_DETECTION_THRESHOLD) {
-				hasSignificantShift = true;
-			}
 		}
 	}
 
-	if (!hasSignificantShift) {
-		result.magnitudes = magnitudes;
-		result.phases = phases;
-		return result;
-	}
-
 	std::vector<float> accumulatedMag(numBins, 0.0f);
 	std::vector<float> accumulatedPhaseX(numBins, 0.0f);
 	std::vector<float> accumulatedPhaseY(numBins, 0.0f);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <span>
 #include <vector>
 
 namespace SpectralResampling {
@@ -20,4 +21,10 @@ ResampledSpectrum resampleSpectrum(
 
 float computeShiftRatio(float decodedFrequency, float expectedFrequency);
 
+bool hasSignificantShift(
+	std::span<const float> decodedFrequencies,
+	float sampleRate,
+	size_t fftSize
+);
+
 }
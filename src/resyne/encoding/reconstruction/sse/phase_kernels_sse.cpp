@@ -0,0 +1,170 @@
+#include "phase_kernels_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+#include <limits>
+#include <numbers>
+
+#include "resyne/encoding/reconstruction/avx/phase_kernels_avx.h"
+#include "utilities/cpu/cpu_features.h"
+
+namespace PhaseKernelsSSE {
+
+// _mm_floor_ps needs SSE4.1, which MSVC emits without an /arch switch; without it every
+// kernel hands the whole row back.
+#if defined(__SSE4_1__) || defined(_MSC_VER)
+
+namespace {
+
+constexpr float PI = std::numbers::pi_v<float>;
+constexpr float TWO_PI = 2.0f * PI;
+
+// Floor-based equivalent of the scalar fmod wrap into [-pi, pi).
+__m128 wrap(const __m128 values) {
+    const __m128 shifted = _mm_add_ps(values, _mm_set1_ps(PI));
+    const __m128 turns = _mm_floor_ps(_mm_mul_ps(shifted, _mm_set1_ps(1.0f / TWO_PI)));
+    return _mm_sub_ps(_mm_sub_ps(shifted, _mm_mul_ps(turns, _mm_set1_ps(TWO_PI))), _mm_set1_ps(PI));
+}
+
+__m128 select(const __m128 mask, const __m128 whenTrue, const __m128 whenFalse) {
+    return _mm_blendv_ps(whenFalse, whenTrue, mask);
+}
+
+}
+
+std::size_t wrapToPi(const float* in, float* out, const std::size_t count) {
+    std::size_t i = 0;
+    if (Utilities::CPU::hasAVX512()) {
+        i = PhaseKernelsAVX512::wrapToPi(in, out, count);
+    } else if (Utilities::CPU::hasAVX2()) {
+        i = PhaseKernelsAVX2::wrapToPi(in, out, count);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, wrap(_mm_loadu_ps(in + i)));
+    }
+    return i;
+}
+
+std::size_t smoothNeighbours(const float* phases, const float* magnitudes, float* smoothed,
+                             const std::size_t count, const float minMagnitude, const float smoothing) {
+    const __m128 threshold = _mm_set1_ps(minMagnitude);
+    const __m128 keep = _mm_set1_ps(smoothing);
+    const __m128 rest = _mm_set1_ps(1.0f - smoothing);
+    const __m128 two = _mm_set1_ps(2.0f);
+
+    std::size_t bin = 1;
+    if (Utilities::CPU::hasAVX512()) {
+        bin = PhaseKernelsAVX512::smoothNeighbours(phases, magnitudes, smoothed, count, minMagnitude, smoothing);
+    } else if (Utilities::CPU::hasAVX2()) {
+        bin = PhaseKernelsAVX2::smoothNeighbours(phases, magnitudes, smoothed, count, minMagnitude, smoothing);
+    }
+    for (; bin + 5 <= count; bin += 4) {
+        const __m128 magnitude = _mm_loadu_ps(magnitudes + bin);
+        const __m128 active = _mm_cmpgt_ps(magnitude, threshold);
+        if (_mm_movemask_ps(active) == 0) {
+            continue;
+        }
+
+        const __m128 lowerMagnitude = _mm_loadu_ps(magnitudes + bin - 1);
+        const __m128 upperMagnitude = _mm_loadu_ps(magnitudes + bin + 1);
+        const __m128 lowerWeight = _mm_and_ps(lowerMagnitude, _mm_cmpgt_ps(lowerMagnitude, threshold));
+        const __m128 upperWeight = _mm_and_ps(upperMagnitude, _mm_cmpgt_ps(upperMagnitude, threshold));
+        const __m128 centreWeight = _mm_mul_ps(magnitude, two);
+        const __m128 centrePhase = _mm_loadu_ps(phases + bin);
+
+        // Accumulated in the scalar pass's order: lower, upper, then centre.
+        __m128 phaseSum = _mm_mul_ps(_mm_loadu_ps(phases + bin - 1), lowerWeight);
+        phaseSum = _mm_add_ps(phaseSum, _mm_mul_ps(_mm_loadu_ps(phases + bin + 1), upperWeight));
+        phaseSum = _mm_add_ps(phaseSum, _mm_mul_ps(centrePhase, centreWeight));
+        const __m128 weightSum = _mm_add_ps(_mm_add_ps(lowerWeight, upperWeight), centreWeight);
+
+        const __m128 average = _mm_div_ps(phaseSum, weightSum);
+        const __m128 blended = wrap(_mm_add_ps(_mm_mul_ps(keep, average), _mm_mul_ps(rest, centrePhase)));
+        _mm_storeu_ps(smoothed + bin, select(active, blended, _mm_loadu_ps(smoothed + bin)));
+    }
+    return bin;
+}
+
+std::size_t stepTowards(float* phases, const float* targets, const std::size_t count, const float gain) {
+    const __m128 scale = _mm_set1_ps(gain);
+    std::size_t i = 0;
+    if (Utilities::CPU::hasAVX512()) {
+        i = PhaseKernelsAVX512::stepTowards(phases, targets, count, gain);
+    } else if (Utilities::CPU::hasAVX2()) {
+        i = PhaseKernelsAVX2::stepTowards(phases, targets, count, gain);
+    }
+    for (; i + 4 <= count; i += 4) {
+        const __m128 current = _mm_loadu_ps(phases + i);
+        const __m128 delta = wrap(_mm_sub_ps(_mm_loadu_ps(targets + i), current));
+        _mm_storeu_ps(phases + i, wrap(_mm_add_ps(current, _mm_mul_ps(delta, scale))));
+    }
+    return i;
+}
+
+std::size_t alignToExpected(float* reconstructed, const float* previous, const float* frequencies,
+                            const float* weights, const std::size_t count, const float binWidth,
+                            const float hopSize, const float sampleRate) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 width = _mm_set1_ps(binWidth);
+    const __m128 twoPi = _mm_set1_ps(TWO_PI);
+    const __m128 hop = _mm_set1_ps(hopSize);
+    const __m128 rate = _mm_set1_ps(sampleRate);
+
+    std::size_t bin = 0;
+    if (Utilities::CPU::hasAVX512()) {
+        bin = PhaseKernelsAVX512::alignToExpected(reconstructed, previous, frequencies, weights, count,
+                                                  binWidth, hopSize, sampleRate);
+    } else if (Utilities::CPU::hasAVX2()) {
+        bin = PhaseKernelsAVX2::alignToExpected(reconstructed, previous, frequencies, weights, count,
+                                                binWidth, hopSize, sampleRate);
+    }
+    for (; bin + 4 <= count; bin += 4) {
+        const __m128 weight = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(weights + bin), zero), one);
+        const __m128 active = _mm_cmpgt_ps(weight, zero);
+        if (_mm_movemask_ps(active) == 0) {
+            continue;
+        }
+
+        // Ordered compares reject NaN, so this is isfinite(f) && f > 0.
+        const __m128 stored = _mm_loadu_ps(frequencies + bin);
+        const __m128 usable = _mm_and_ps(_mm_cmpgt_ps(stored, zero), _mm_cmplt_ps(stored, infinity));
+        const __m128 centre = _mm_mul_ps(width, _mm_add_ps(_mm_set1_ps(static_cast<float>(bin)), lane));
+        const __m128 frequency = select(usable, stored, centre);
+
+        const __m128 advance = _mm_div_ps(_mm_mul_ps(_mm_mul_ps(twoPi, frequency), hop), rate);
+        const __m128 expected = wrap(_mm_add_ps(_mm_loadu_ps(previous + bin), advance));
+        const __m128 current = _mm_loadu_ps(reconstructed + bin);
+        const __m128 delta = wrap(_mm_sub_ps(current, expected));
+        const __m128 aligned = wrap(_mm_add_ps(expected, _mm_mul_ps(delta, weight)));
+        _mm_storeu_ps(reconstructed + bin, select(active, aligned, current));
+    }
+    return bin;
+}
+
+#else
+
+std::size_t wrapToPi(const float*, float*, std::size_t) {
+    return 0;
+}
+
+std::size_t smoothNeighbours(const float*, const float*, float*, std::size_t, float, float) {
+    return 1;
+}
+
+std::size_t stepTowards(float*, const float*, std::size_t, float) {
+    return 0;
+}
+
+std::size_t alignToExpected(float*, const float*, const float*, const float*, std::size_t, float, float, float) {
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+
+namespace PhaseKernelsSSE {
+    // Row kernels for the phase reconstruction passes. Each returns how far it got, leaving
+    // any tail shorter than one vector to the caller's scalar path.
+
+    // out[i] = wrapToPi(in[i]); in and out may alias.
+    std::size_t wrapToPi(const float* in, float* out, std::size_t count);
+
+    // One weighted neighbour-averaging pass of smoothPhase over bins [1, count - 1), writing
+    // only active bins of smoothed. Returns the first bin it did not handle.
+    std::size_t smoothNeighbours(const float* phases, const float* magnitudes, float* smoothed,
+                                 std::size_t count, float minMagnitude, float smoothing);
+
+    // phases[i] = wrapToPi(phases[i] + gain * wrapToPi(targets[i] - phases[i])).
+    std::size_t stepTowards(float* phases, const float* targets, std::size_t count, float gain);
+
+    // alignReconstructedPhase for bins whose frequency is known to the caller.
+    std::size_t alignToExpected(float* reconstructed, const float* previous, const float* frequencies,
+                                const float* weights, std::size_t count, float binWidth,
+                                float hopSize, float sampleRate);
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "varispeed_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <algorithm>
+#include <immintrin.h>
+
+namespace VarispeedSSE {
+
+namespace {
+
+float horizontalSum(const __m128 values) {
+    const __m128 pairs = _mm_add_ps(values, _mm_movehl_ps(values, values));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+}
+
+std::size_t resample(const float* input, const float* bank, const std::size_t tapCount,
+                     const std::size_t phaseCount, const double start, const double step,
+                     const std::size_t firstOutput, float* output, const std::size_t count) {
+    if (tapCount == 0 || tapCount % 4 != 0) {
+        return 0;
+    }
+
+    const std::size_t leading = tapCount / 2 - 1;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double position = start + static_cast<double>(firstOutput + i) * step;
+        const auto index = static_cast<std::size_t>(position);
+        const double scaled = (position - static_cast<double>(index)) * static_cast<double>(phaseCount);
+        const std::size_t phase = std::min(static_cast<std::size_t>(scaled), phaseCount - 1);
+        const __m128 mix = _mm_set1_ps(static_cast<float>(scaled - static_cast<double>(phase)));
+
+        const float* window = input + index - leading;
+        const float* taps = bank + phase * tapCount * 2;
+        const float* deltas = taps + tapCount;
+
+        __m128 sum = _mm_setzero_ps();
+        for (std::size_t k = 0; k < tapCount; k += 4) {
+            const __m128 tap = _mm_add_ps(_mm_loadu_ps(taps + k), _mm_mul_ps(mix, _mm_loadu_ps(deltas + k)));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(window + k), tap));
+        }
+        output[i] = horizontalSum(sum);
+    }
+    return count;
+}
+
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+
+namespace VarispeedSSE {
+    // Polyphase interpolation for Varispeed::Resampler. output[i] is the bank's filter for
+    // the source position start + (firstOutput + i) * step, applied to the tapCount samples
+    // around it; every such window must lie inside input. Returns how many outputs it
+    // wrote, which is none unless tapCount is a multiple of 4.
+    std::size_t resample(const float* input, const float* bank, std::size_t tapCount,
+                         std::size_t phaseCount, double start, double step,
+                         std::size_t firstOutput, float* output, std::size_t count);
+}
+
+#endif
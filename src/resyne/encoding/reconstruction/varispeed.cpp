@@ -2,18 +2,80 @@
 
 #include <algorithm>
 #include <cmath>
+#include <numbers>
 #include <utility>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/varispeed_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/varispeed_sse.h"
+#endif
+
 namespace Varispeed {
 
 namespace {
 constexpr float EPSILON = 1e-6f;
 constexpr float MIN_REGION_FRAMES = 4;
 constexpr float RATIO_TOLERANCE = 0.05f;
+
+// The passband ends a little below the new Nyquist to leave the short filter a transition band.
+constexpr double CUTOFF_ROLLOFF = 0.95;
+constexpr double KAISER_BETA = 7.0;
+constexpr size_t LEADING_TAPS = Resampler::TAPS / 2 - 1;
+
+bool isPassthrough(const float pitchRatio) {
+	return pitchRatio <= EPSILON || std::abs(pitchRatio - 1.0f) < EPSILON;
+}
+
+double besselI0(const double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 64 && term > 1e-12 * sum; ++k) {
+		const double half = x / (2.0 * k);
+		term *= half * half;
+		sum += term;
+	}
+	return sum;
+}
+
+double sourcePosition(const size_t start, const float pitchRatio, const size_t output) {
+	return static_cast<double>(start) + static_cast<double>(output) * static_cast<double>(pitchRatio);
+}
+
+// The same filter as the SIMD kernels, reading samples outside input as silence.
+float interpolate(std::span<const float> input, const float* bank, const double position) {
+	const auto index = static_cast<size_t>(position);
+	const double scaled = (position - static_cast<double>(index)) * static_cast<double>(Resampler::PHASES);
+	const size_t phase = std::min(static_cast<size_t>(scaled), Resampler::PHASES - 1);
+	const float mix = static_cast<float>(scaled - static_cast<double>(phase));
+	const float* taps = bank + phase * Resampler::TAPS * 2;
+	const float* deltas = taps + Resampler::TAPS;
+
+	float sum = 0.0f;
+	for (size_t k = 0; k < Resampler::TAPS; ++k) {
+		if (index + k < LEADING_TAPS || index + k - LEADING_TAPS >= input.size()) {
+			continue;
+		}
+		sum += input[index + k - LEADING_TAPS] * (taps[k] + mix * deltas[k]);
+	}
+	return sum;
+}
+
+// Raised-cosine crossfade of incoming over the last incoming.size() samples of result.
+void crossfadeTail(std::vector<float>& result, std::span<const float> incoming) {
+	const size_t fadeLen = incoming.size();
+	const size_t overlapStart = result.size() > fadeLen ? result.size() - fadeLen : 0;
+	for (size_t j = 0; j < fadeLen && overlapStart + j < result.size(); ++j) {
+		const float t = static_cast<float>(j) / static_cast<float>(fadeLen);
+		const float fadeOut = 0.5f * (1.0f + std::cos(t * 3.14159265f));
+		const float fadeIn = 1.0f - fadeOut;
+		result[overlapStart + j] = result[overlapStart + j] * fadeOut + incoming[j] * fadeIn;
+	}
+}
 }
 
 std::vector<VarspeedRegion> detectVarispeedRegions(
-	const std::vector<std::vector<float>>& allFrequencies,
+	const std::vector<std::span<const float>>& allFrequencies,
 	float sampleRate,
 	size_t fftSize,
 	float minShiftRatio
@@ -35,6 +97,13 @@ std::vector<VarspeedRegion> detectVarispeedRegions(
 			continue;
 		}
 
+		// Frames viewing a shared axis point at the same storage; its ratio only needs computing once.
+		if (frame > 0 && freqs.data() == allFrequencies[frame - 1].data() &&
+			freqs.size() == allFrequencies[frame - 1].size()) {
+			frameRatios[frame] = frameRatios[frame - 1];
+			continue;
+		}
+
 		float ratioSum = 0.0f;
 		float weightSum = 0.0f;
 
@@ -88,39 +157,126 @@ std::vector<VarspeedRegion> detectVarispeedRegions(
 	return regions;
 }
 
-std::vector<float> resampleAudio(
-	const std::vector<float>& input,
-	float pitchRatio
-) {
-	if (input.empty() || pitchRatio <= EPSILON) {
-		return input;
+size_t Resampler::outputLength(const size_t inputLength, const float pitchRatio) {
+	if (isPassthrough(pitchRatio)) {
+		return inputLength;
 	}
+	return static_cast<size_t>(std::ceil(static_cast<float>(inputLength) / pitchRatio));
+}
 
-	if (std::abs(pitchRatio - 1.0f) < EPSILON) {
-		return input;
+const std::vector<float>& Resampler::bankFor(const float pitchRatio) {
+	const double cutoff = std::min(1.0, 1.0 / static_cast<double>(pitchRatio)) * CUTOFF_ROLLOFF;
+	const int key = std::max(1, static_cast<int>(std::lround(cutoff * 1000.0)));
+	auto [entry, inserted] = banks.try_emplace(key);
+	if (!inserted) {
+		return entry->second;
 	}
 
-	const size_t inputSize = input.size();
-	const size_t outputSize = static_cast<size_t>(
-		std::ceil(static_cast<float>(inputSize) / pitchRatio)
-	);
+	// Row p is the Kaiser-windowed sinc for a source position p / PHASES past a sample, with
+	// unity DC gain; row PHASES closes the last phase's deltas.
+	const double bandwidth = static_cast<double>(key) / 1000.0;
+	const double halfWidth = static_cast<double>(TAPS) / 2.0;
+	const double windowNorm = besselI0(KAISER_BETA);
+	std::vector<double> rows((PHASES + 1) * TAPS);
+	for (size_t phase = 0; phase <= PHASES; ++phase) {
+		const double frac = static_cast<double>(phase) / static_cast<double>(PHASES);
+		double* row = rows.data() + phase * TAPS;
+		double sum = 0.0;
+		for (size_t k = 0; k < TAPS; ++k) {
+			const double t = static_cast<double>(k) - static_cast<double>(LEADING_TAPS) - frac;
+			const double x = t / halfWidth;
+			const double window = std::abs(x) < 1.0
+				? besselI0(KAISER_BETA * std::sqrt(1.0 - x * x)) / windowNorm
+				: 0.0;
+			const double arg = std::numbers::pi * bandwidth * t;
+			const double sinc = std::abs(arg) < 1e-12 ? 1.0 : std::sin(arg) / arg;
+			row[k] = bandwidth * sinc * window;
+			sum += row[k];
+		}
+		for (size_t k = 0; k < TAPS; ++k) {
+			row[k] /= sum;
+		}
+	}
 
-	std::vector<float> output(outputSize);
+	std::vector<float>& bank = entry->second;
+	bank.resize(PHASES * TAPS * 2);
+	for (size_t phase = 0; phase < PHASES; ++phase) {
+		const double* row = rows.data() + phase * TAPS;
+		float* taps = bank.data() + phase * TAPS * 2;
+		for (size_t k = 0; k < TAPS; ++k) {
+			taps[k] = static_cast<float>(row[k]);
+			taps[TAPS + k] = static_cast<float>(row[TAPS + k] - row[k]);
+		}
+	}
+	return bank;
+}
 
-	for (size_t i = 0; i < outputSize; ++i) {
-		const float srcPos = static_cast<float>(i) * pitchRatio;
-		const size_t idx0 = static_cast<size_t>(srcPos);
-		const float frac = srcPos - static_cast<float>(idx0);
+void Resampler::process(
+	std::span<const float> input,
+	const size_t start,
+	const float pitchRatio,
+	const size_t firstOutput,
+	std::span<float> output
+) {
+	if (isPassthrough(pitchRatio)) {
+		for (size_t i = 0; i < output.size(); ++i) {
+			const size_t source = start + firstOutput + i;
+			output[i] = source < input.size() ? input[source] : 0.0f;
+		}
+		return;
+	}
 
-		if (idx0 + 1 < inputSize) {
-			output[i] = input[idx0] * (1.0f - frac) + input[idx0 + 1] * frac;
-		} else if (idx0 < inputSize) {
-			output[i] = input[idx0];
-		} else {
-			output[i] = 0.0f;
+	const float* bank = bankFor(pitchRatio).data();
+	const size_t count = output.size();
+	const auto indexOf = [&](const size_t i) {
+		return static_cast<size_t>(sourcePosition(start, pitchRatio, firstOutput + i));
+	};
+
+	// Outputs whose whole window lies inside input go to the SIMD kernel; the few at either
+	// edge take the bounds-checked path.
+	size_t interiorBegin = 0;
+	while (interiorBegin < count && indexOf(interiorBegin) < LEADING_TAPS) {
+		++interiorBegin;
+	}
+	size_t interiorEnd = interiorBegin;
+	if (input.size() > TAPS) {
+		// Outputs stay within about a window of the input's end, so this walks back little.
+		const size_t lastIndex = input.size() - TAPS / 2 - 1;
+		interiorEnd = count;
+		while (interiorEnd > interiorBegin && indexOf(interiorEnd - 1) > lastIndex) {
+			--interiorEnd;
 		}
 	}
 
+	size_t done = interiorBegin;
+#ifdef USE_NEON_OPTIMISATIONS
+	done += VarispeedNEON::resample(input.data(), bank, TAPS, PHASES,
+		static_cast<double>(start), static_cast<double>(pitchRatio), firstOutput + interiorBegin,
+		output.data() + interiorBegin, interiorEnd - interiorBegin);
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	done += VarispeedSSE::resample(input.data(), bank, TAPS, PHASES,
+		static_cast<double>(start), static_cast<double>(pitchRatio), firstOutput + interiorBegin,
+		output.data() + interiorBegin, interiorEnd - interiorBegin);
+#endif
+
+	for (size_t i = 0; i < interiorBegin; ++i) {
+		output[i] = interpolate(input, bank, sourcePosition(start, pitchRatio, firstOutput + i));
+	}
+	for (size_t i = done; i < count; ++i) {
+		output[i] = interpolate(input, bank, sourcePosition(start, pitchRatio, firstOutput + i));
+	}
+}
+
+std::vector<float> resampleAudio(
+	const std::vector<float>& input,
+	float pitchRatio
+) {
+	if (input.empty() || isPassthrough(pitchRatio)) {
+		return input;
+	}
+
+	std::vector<float> output(Resampler::outputLength(input.size(), pitchRatio));
+	Resampler().process(input, 0, pitchRatio, 0, output);
 	return output;
 }
 
@@ -134,26 +290,44 @@ std::vector<float> applyVarispeedRegions(
 		return audio;
 	}
 
-	std::vector<std::pair<size_t, size_t>> sampleRegions;
+	const auto regionBounds = [&](const VarspeedRegion& region) {
+		const size_t hop = static_cast<size_t>(hopSize);
+		return std::pair{
+			std::min(region.startFrame * hop, audio.size()),
+			std::min(region.endFrame * hop, audio.size())
+		};
+	};
+
+	// Each region's faded-in head overlaps what came before it, so the timeline's length
+	// follows from the regions alone and the result is allocated once.
+	size_t totalLength = 0;
+	size_t currentPos = 0;
 	for (const auto& region : regions) {
-		sampleRegions.push_back({
-			region.startFrame * static_cast<size_t>(hopSize),
-			region.endFrame * static_cast<size_t>(hopSize)
-		});
+		const auto [startSample, endSample] = regionBounds(region);
+		if (startSample > currentPos) {
+			totalLength += startSample - currentPos;
+		}
+		if (startSample < endSample) {
+			const size_t length = Resampler::outputLength(endSample - startSample, region.pitchRatio);
+			const size_t fadeLen = std::min(crossfadeSamples, length / 2);
+			totalLength += fadeLen > 0 && totalLength > 0 ? length - fadeLen : length;
+		}
+		currentPos = endSample;
+	}
+	if (currentPos < audio.size()) {
+		const size_t fadeLen = std::min(crossfadeSamples, audio.size() - currentPos);
+		totalLength += audio.size() - currentPos - (fadeLen > 0 && totalLength > 0 ? fadeLen : 0);
 	}
 
 	std::vector<float> result;
-	result.reserve(audio.size());
+	result.reserve(totalLength);
 
-	size_t currentPos = 0;
+	Resampler resampler;
+	std::vector<float> fadeIn;
+	currentPos = 0;
 
-	for (size_t i = 0; i < regions.size(); ++i) {
-		const auto& region = regions[i];
-		const size_t startSample = region.startFrame * static_cast<size_t>(hopSize);
-		const size_t endSample = std::min(
-			region.endFrame * static_cast<size_t>(hopSize),
-			audio.size()
-		);
+	for (const auto& region : regions) {
+		const auto [startSample, endSample] = regionBounds(region);
 
 		if (startSample > currentPos) {
 			result.insert(result.end(),
@@ -161,34 +335,21 @@ std::vector<float> applyVarispeedRegions(
 				audio.begin() + static_cast<ptrdiff_t>(startSample));
 		}
 
-		if (startSample < endSample && endSample <= audio.size()) {
-			std::vector<float> regionAudio(
-				audio.begin() + static_cast<ptrdiff_t>(startSample),
-				audio.begin() + static_cast<ptrdiff_t>(endSample)
-			);
-
-			std::vector<float> resampled = resampleAudio(regionAudio, region.pitchRatio);
-
-			const size_t fadeLen = std::min(crossfadeSamples, resampled.size() / 2);
-
+		if (startSample < endSample) {
+			const size_t length = Resampler::outputLength(endSample - startSample, region.pitchRatio);
+			size_t fadeLen = std::min(crossfadeSamples, length / 2);
 			if (fadeLen > 0 && !result.empty()) {
-				const size_t overlapStart = result.size() > fadeLen ? result.size() - fadeLen : 0;
-				for (size_t j = 0; j < fadeLen && j < resampled.size(); ++j) {
-					const float t = static_cast<float>(j) / static_cast<float>(fadeLen);
-					const float fadeOut = 0.5f * (1.0f + std::cos(t * 3.14159265f));
-					const float fadeIn = 1.0f - fadeOut;
-
-					if (overlapStart + j < result.size()) {
-						result[overlapStart + j] = result[overlapStart + j] * fadeOut +
-							resampled[j] * fadeIn;
-					}
-				}
-				result.insert(result.end(),
-					resampled.begin() + static_cast<ptrdiff_t>(fadeLen),
-					resampled.end());
+				fadeIn.resize(fadeLen);
+				resampler.process(audio, startSample, region.pitchRatio, 0, fadeIn);
+				crossfadeTail(result, fadeIn);
 			} else {
-				result.insert(result.end(), resampled.begin(), resampled.end());
+				fadeLen = 0;
 			}
+
+			const size_t offset = result.size();
+			result.resize(offset + length - fadeLen);
+			resampler.process(audio, startSample, region.pitchRatio, fadeLen,
+				std::span<float>(result).subspan(offset));
 		}
 
 		currentPos = endSample;
@@ -196,26 +357,13 @@ std::vector<float> applyVarispeedRegions(
 
 	if (currentPos < audio.size()) {
 		const size_t fadeLen = std::min(crossfadeSamples, audio.size() - currentPos);
+		const std::span<const float> remainder(audio.data() + currentPos, audio.size() - currentPos);
 
 		if (fadeLen > 0 && !result.empty()) {
-			const size_t overlapStart = result.size() > fadeLen ? result.size() - fadeLen : 0;
-			for (size_t j = 0; j < fadeLen; ++j) {
-				const float t = static_cast<float>(j) / static_cast<float>(fadeLen);
-				const float fadeOut = 0.5f * (1.0f + std::cos(t * 3.14159265f));
-				const float fadeIn = 1.0f - fadeOut;
-
-				if (overlapStart + j < result.size() && currentPos + j < audio.size()) {
-					result[overlapStart + j] = result[overlapStart + j] * fadeOut +
-						audio[currentPos + j] * fadeIn;
-				}
-			}
-			result.insert(result.end(),
-				audio.begin() + static_cast<ptrdiff_t>(currentPos + fadeLen),
-				audio.end());
+			crossfadeTail(result, remainder.first(fadeLen));
+			result.insert(result.end(), remainder.begin() + static_cast<ptrdiff_t>(fadeLen), remainder.end());
 		} else {
-			result.insert(result.end(),
-				audio.begin() + static_cast<ptrdiff_t>(currentPos),
-				audio.end());
+			result.insert(result.end(), remainder.begin(), remainder.end());
 		}
 	}
 
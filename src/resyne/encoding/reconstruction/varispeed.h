@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <map>
+#include <span>
 #include <vector>
 
 namespace Varispeed {
@@ -12,12 +14,41 @@ struct VarspeedRegion {
 };
 
 std::vector<VarspeedRegion> detectVarispeedRegions(
-	const std::vector<std::vector<float>>& allFrequencies,
+	const std::vector<std::span<const float>>& allFrequencies,
 	float sampleRate,
 	size_t fftSize,
 	float minShiftRatio = 0.02f
 );
 
+// Windowed-sinc polyphase resampler. Each filter bank is built once per anti-aliasing
+// cutoff and kept, so one resampler serves every region of a track, and each region reads
+// straight from the source audio into the caller's buffer.
+class Resampler {
+public:
+	static constexpr size_t TAPS = 16;
+	static constexpr size_t PHASES = 256;
+
+	// Samples produced by playing inputLength samples at pitchRatio.
+	static size_t outputLength(size_t inputLength, float pitchRatio);
+
+	// output[i] = input sampled at start + (firstOutput + i) * pitchRatio. Samples outside
+	// input read as silence.
+	void process(
+		std::span<const float> input,
+		size_t start,
+		float pitchRatio,
+		size_t firstOutput,
+		std::span<float> output
+	);
+
+private:
+	const std::vector<float>& bankFor(float pitchRatio);
+
+	// Keyed by cutoff in thousandths of Nyquist; each bank holds PHASES rows of TAPS taps
+	// followed by their TAPS deltas to the next phase.
+	std::map<int, std::vector<float>> banks;
+};
+
 std::vector<float> resampleAudio(
 	const std::vector<float>& input,
 	float pitchRatio
@@ -0,0 +1,20 @@
+#pragma once
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <cstddef>
+
+#include "resyne/encoding/spectral/sse/colour_column_sse.h"
+
+// Eight-bin form of the ColourColumnSSE kernels, with the same approximations and
+// contracts. ColourColumnSSE calls it when Utilities::CPU reports AVX2.
+namespace ColourColumnAVX2 {
+    std::size_t encodeColumn(const float* magnitudes, const float* phases, const float* frequencies,
+                             float* rgba, std::size_t count, float binWidth, float maxBinFrequency,
+                             const ColourColumnSSE::ColumnScale& scale);
+
+    std::size_t decodeColumn(const float* rgba, float* magnitudes, float* phases, float* frequencies,
+                             std::size_t count, float binWidth, float silentLevel, float minPhaseVector,
+                             const ColourColumnSSE::ColumnScale& scale);
+}
+
+#endif
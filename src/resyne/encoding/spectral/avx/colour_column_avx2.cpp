@@ -0,0 +1,296 @@
+#include "colour_column_avx.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+#include <numbers>
+
+namespace ColourColumnAVX2 {
+
+using ColourColumnSSE::ColumnScale;
+
+// Built with the AVX2 flags from optimisations.cmake; without them every kernel hands the
+// whole column back.
+#if defined(__AVX2__)
+
+namespace {
+
+constexpr float PI = std::numbers::pi_v<float>;
+constexpr float LOG2_10_OVER_20 = 0.16609640474f;
+constexpr float LOG10_2_TIMES_20 = 6.02059991328f;
+
+__m256 greaterThan(const __m256 a, const __m256 b) {
+    return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+}
+
+__m256 lessThan(const __m256 a, const __m256 b) {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+}
+
+__m256 select(const __m256 mask, const __m256 whenTrue, const __m256 whenFalse) {
+    return _mm256_blendv_ps(whenFalse, whenTrue, mask);
+}
+
+__m256 clampUnit(const __m256 values) {
+    return _mm256_min_ps(_mm256_max_ps(values, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+}
+
+// Integer tests, so -ffast-math cannot assume the answer.
+__m256 isFinite(const __m256 values) {
+    const __m256i exponent = _mm256_and_si256(_mm256_castps_si256(values), _mm256_set1_epi32(0x7f800000));
+    return _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(exponent, _mm256_set1_epi32(0x7f800000)),
+                                          _mm256_set1_epi32(-1)));
+}
+
+__m256 isNaN(const __m256 values) {
+    const __m256i magnitude = _mm256_and_si256(_mm256_castps_si256(values), _mm256_set1_epi32(0x7fffffff));
+    return _mm256_castsi256_ps(_mm256_cmpgt_epi32(magnitude, _mm256_set1_epi32(0x7f800000)));
+}
+
+// log2 for positive normal inputs: exponent plus a degree-9 polynomial for ln over
+// [sqrt(1/2), sqrt(2)).
+__m256 log2Positive(const __m256 values) {
+    const __m256i bits = _mm256_castps_si256(values);
+    __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+    __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                    _mm256_set1_epi32(0x3f800000)));
+
+    const __m256 upper = greaterThan(mantissa, _mm256_set1_ps(std::numbers::sqrt2_v<float>));
+    mantissa = select(upper, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), mantissa);
+    exponent = _mm256_add_ps(exponent, _mm256_and_ps(upper, _mm256_set1_ps(1.0f)));
+
+    const __m256 t = _mm256_sub_ps(mantissa, _mm256_set1_ps(1.0f));
+    const __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 poly = _mm256_set1_ps(7.0376836292e-2f);
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(-1.1514610310e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(1.1676998740e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(-1.2420140846e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(1.4249322787e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(-1.6668057665e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(2.0000714765e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(-2.4999993993e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(3.3333331174e-1f));
+    poly = _mm256_mul_ps(_mm256_mul_ps(poly, t2), t);
+    poly = _mm256_sub_ps(poly, _mm256_mul_ps(t2, _mm256_set1_ps(0.5f)));
+
+    const __m256 naturalLog = _mm256_add_ps(t, poly);
+    return _mm256_add_ps(_mm256_mul_ps(naturalLog, _mm256_set1_ps(std::numbers::log2e_v<float>)), exponent);
+}
+
+// 2^x for x well inside the normal range: a degree-6 polynomial on the fractional part,
+// scaled by building the exponent directly.
+__m256 exp2Normal(const __m256 values) {
+    const __m256 x = _mm256_min_ps(_mm256_max_ps(values, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(127.0f));
+    const __m256 whole = _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __m256 r = _mm256_mul_ps(_mm256_sub_ps(x, whole), _mm256_set1_ps(std::numbers::ln2_v<float>));
+
+    __m256 poly = _mm256_set1_ps(1.9875691500e-4f);
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(1.3981999507e-3f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(8.3334519073e-3f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(4.1665795894e-2f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(1.6666665459e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, r), _mm256_set1_ps(5.0000001201e-1f));
+    poly = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(poly, r), r), r), _mm256_set1_ps(1.0f));
+
+    const __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(whole), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(poly, _mm256_castsi256_ps(scale));
+}
+
+// Cephes-style sincos: reduce by pi/4 in three parts, then pick and sign the sine or
+// cosine polynomial by octant.
+void sinCos(const __m256 values, __m256& sine, __m256& cosine) {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 inputSign = _mm256_and_ps(values, signMask);
+    const __m256 x = _mm256_andnot_ps(signMask, values);
+
+    __m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(4.0f / PI)));
+    octant = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    const __m256 y = _mm256_cvtepi32_ps(octant);
+
+    __m256 reduced = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(0.78515625f)));
+    reduced = _mm256_sub_ps(reduced, _mm256_mul_ps(y, _mm256_set1_ps(2.4187564849853515625e-4f)));
+    reduced = _mm256_sub_ps(reduced, _mm256_mul_ps(y, _mm256_set1_ps(3.77489497744594108e-8f)));
+    const __m256 z = _mm256_mul_ps(reduced, reduced);
+
+    __m256 cosPoly = _mm256_set1_ps(2.443315711809948e-5f);
+    cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(-1.388731625493765e-3f));
+    cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(4.166664568298827e-2f));
+    cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+    cosPoly = _mm256_add_ps(_mm256_sub_ps(cosPoly, _mm256_mul_ps(z, _mm256_set1_ps(0.5f))), _mm256_set1_ps(1.0f));
+
+    __m256 sinPoly = _mm256_set1_ps(-1.9515295891e-4f);
+    sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(8.3321608736e-3f));
+    sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(-1.6666654611e-1f));
+    sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sinPoly, z), reduced), reduced);
+
+    const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)),
+                                                         _mm256_set1_epi32(2)));
+    const __m256 sinSign = _mm256_xor_ps(inputSign,
+        _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29)));
+    const __m256 cosSign = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+
+    sine = _mm256_xor_ps(select(swap, cosPoly, sinPoly), sinSign);
+    cosine = _mm256_xor_ps(select(swap, sinPoly, cosPoly), cosSign);
+}
+
+// atan2 from the octant of (x, y): atan of min/max over [0, 1], reduced once more about
+// tan(pi/8), then reflected into place.
+__m256 atan2Approx(const __m256 y, const __m256 x) {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 ax = _mm256_andnot_ps(signMask, x);
+    const __m256 ay = _mm256_andnot_ps(signMask, y);
+    const __m256 ratio = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_max_ps(ax, ay));
+
+    const __m256 reduce = greaterThan(ratio, _mm256_set1_ps(0.41421356237f));
+    const __m256 t = select(reduce,
+        _mm256_div_ps(_mm256_sub_ps(ratio, _mm256_set1_ps(1.0f)), _mm256_add_ps(ratio, _mm256_set1_ps(1.0f))), ratio);
+    const __m256 base = _mm256_and_ps(reduce, _mm256_set1_ps(PI / 4.0f));
+
+    const __m256 z = _mm256_mul_ps(t, t);
+    __m256 poly = _mm256_set1_ps(8.05374449538e-2f);
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, z), _mm256_set1_ps(-1.38776856032e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, z), _mm256_set1_ps(1.99777106478e-1f));
+    poly = _mm256_add_ps(_mm256_mul_ps(poly, z), _mm256_set1_ps(-3.33329491539e-1f));
+    __m256 angle = _mm256_add_ps(base, _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(poly, z), t), t));
+
+    angle = select(greaterThan(ay, ax), _mm256_sub_ps(_mm256_set1_ps(PI / 2.0f), angle), angle);
+    angle = select(lessThan(x, _mm256_setzero_ps()), _mm256_sub_ps(_mm256_set1_ps(PI), angle), angle);
+    return _mm256_xor_ps(angle, _mm256_and_ps(y, signMask));
+}
+
+}
+
+std::size_t encodeColumn(const float* magnitudes, const float* phases, const float* frequencies,
+                         float* rgba, const std::size_t count, const float binWidth,
+                         const float maxBinFrequency, const ColumnScale& scale) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 dbMin = _mm256_set1_ps(scale.dbMin);
+    const __m256 dbScale = _mm256_set1_ps(1.0f / scale.dbRange);
+    const __m256 logMin = _mm256_set1_ps(scale.logFrequencyMin);
+    const __m256 logScale = _mm256_set1_ps(1.0f / scale.logFrequencyRange);
+
+    std::size_t bin = 0;
+    for (; bin + 8 <= count; bin += 8) {
+        const __m256 magnitude = _mm256_loadu_ps(magnitudes + bin);
+        const __m256 magnitudeValid = _mm256_and_ps(greaterThan(magnitude, zero), isFinite(magnitude));
+        const __m256 floorMagnitude = _mm256_set1_ps(scale.magnitudeFloor);
+        const __m256 db = _mm256_mul_ps(log2Positive(_mm256_max_ps(magnitude, floorMagnitude)), _mm256_set1_ps(LOG10_2_TIMES_20));
+        const __m256 level = select(greaterThan(magnitude, floorMagnitude),
+                                    clampUnit(_mm256_mul_ps(_mm256_sub_ps(db, dbMin), dbScale)),
+                                    _mm256_set1_ps(scale.floorLevel));
+        __m256 r = _mm256_and_ps(magnitudeValid, level);
+
+        const __m256 centre = _mm256_min_ps(
+            _mm256_mul_ps(_mm256_set1_ps(binWidth), _mm256_add_ps(_mm256_set1_ps(static_cast<float>(bin)), lane)),
+            _mm256_set1_ps(maxBinFrequency));
+        __m256 frequency = centre;
+        if (frequencies != nullptr) {
+            const __m256 stored = _mm256_loadu_ps(frequencies + bin);
+            frequency = select(greaterThan(stored, zero), stored, centre);
+        }
+        const __m256 frequencyValid = _mm256_and_ps(greaterThan(frequency, zero), isFinite(frequency));
+        const __m256 bounded = _mm256_min_ps(_mm256_max_ps(frequency, _mm256_set1_ps(scale.minFrequency)),
+                                          _mm256_set1_ps(scale.maxFrequency));
+        __m256 g = _mm256_and_ps(frequencyValid,
+            clampUnit(_mm256_mul_ps(_mm256_sub_ps(log2Positive(bounded), logMin), logScale)));
+
+        const __m256 phase = _mm256_loadu_ps(phases + bin);
+        const __m256 phaseValid = isFinite(phase);
+        __m256 sine;
+        __m256 cosine;
+        sinCos(_mm256_and_ps(phaseValid, phase), sine, cosine);
+        __m256 b = select(phaseValid, _mm256_add_ps(_mm256_mul_ps(cosine, half), half), half);
+        __m256 a = select(phaseValid, _mm256_add_ps(_mm256_mul_ps(sine, half), half), half);
+
+        // A 4x4 transpose within each 128-bit lane leaves bins n and n + 4 in one register.
+        const __m256 rgLow = _mm256_unpacklo_ps(r, g);
+        const __m256 rgHigh = _mm256_unpackhi_ps(r, g);
+        const __m256 baLow = _mm256_unpacklo_ps(b, a);
+        const __m256 baHigh = _mm256_unpackhi_ps(b, a);
+        const __m256 bin0 = _mm256_shuffle_ps(rgLow, baLow, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 bin1 = _mm256_shuffle_ps(rgLow, baLow, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 bin2 = _mm256_shuffle_ps(rgHigh, baHigh, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 bin3 = _mm256_shuffle_ps(rgHigh, baHigh, _MM_SHUFFLE(3, 2, 3, 2));
+        float* out = rgba + bin * 4;
+        _mm256_storeu_ps(out, _mm256_permute2f128_ps(bin0, bin1, 0x20));
+        _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(bin2, bin3, 0x20));
+        _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(bin0, bin1, 0x31));
+        _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(bin2, bin3, 0x31));
+    }
+    return bin;
+}
+
+std::size_t decodeColumn(const float* rgba, float* magnitudes, float* phases, float* frequencies,
+                         const std::size_t count, const float binWidth, const float silentLevel,
+                         const float minPhaseVector, const ColumnScale& scale) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    std::size_t bin = 0;
+    for (; bin + 8 <= count; bin += 8) {
+        const float* in = rgba + bin * 4;
+        // Pair bins n and n + 4 in each register, then transpose within lanes.
+        const __m256 first = _mm256_loadu_ps(in);
+        const __m256 second = _mm256_loadu_ps(in + 8);
+        const __m256 third = _mm256_loadu_ps(in + 16);
+        const __m256 fourth = _mm256_loadu_ps(in + 24);
+        const __m256 bin0 = _mm256_permute2f128_ps(first, third, 0x20);
+        const __m256 bin1 = _mm256_permute2f128_ps(first, third, 0x31);
+        const __m256 bin2 = _mm256_permute2f128_ps(second, fourth, 0x20);
+        const __m256 bin3 = _mm256_permute2f128_ps(second, fourth, 0x31);
+        const __m256d low01 = _mm256_castps_pd(_mm256_unpacklo_ps(bin0, bin1));
+        const __m256d low23 = _mm256_castps_pd(_mm256_unpacklo_ps(bin2, bin3));
+        const __m256d high01 = _mm256_castps_pd(_mm256_unpackhi_ps(bin0, bin1));
+        const __m256d high23 = _mm256_castps_pd(_mm256_unpackhi_ps(bin2, bin3));
+        const __m256 r = _mm256_castpd_ps(_mm256_unpacklo_pd(low01, low23));
+        const __m256 g = _mm256_castpd_ps(_mm256_unpackhi_pd(low01, low23));
+        const __m256 b = _mm256_castpd_ps(_mm256_unpacklo_pd(high01, high23));
+        const __m256 a = _mm256_castpd_ps(_mm256_unpackhi_pd(high01, high23));
+
+        const __m256 centre = _mm256_mul_ps(_mm256_set1_ps(binWidth),
+                                         _mm256_add_ps(_mm256_set1_ps(static_cast<float>(bin)), lane));
+
+        // NaN channels fail the same checks they fail in the scalar path.
+        const __m256 db = _mm256_add_ps(_mm256_mul_ps(clampUnit(r), _mm256_set1_ps(scale.dbRange)), _mm256_set1_ps(scale.dbMin));
+        const __m256 magnitude = exp2Normal(_mm256_mul_ps(db, _mm256_set1_ps(LOG2_10_OVER_20)));
+        const __m256 valid = _mm256_andnot_ps(isNaN(r), greaterThan(clampUnit(r), _mm256_set1_ps(silentLevel)));
+
+        const __m256 cosine = _mm256_mul_ps(_mm256_sub_ps(clampUnit(b), half), two);
+        const __m256 sine = _mm256_mul_ps(_mm256_sub_ps(clampUnit(a), half), two);
+        const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(cosine, cosine), _mm256_mul_ps(sine, sine)));
+        const __m256 phaseValid = _mm256_andnot_ps(_mm256_or_ps(isNaN(b), isNaN(a)),
+                                                greaterThan(length, _mm256_set1_ps(minPhaseVector)));
+        const __m256 phase = _mm256_and_ps(phaseValid, atan2Approx(sine, cosine));
+
+        const __m256 logValue = _mm256_add_ps(_mm256_set1_ps(scale.logFrequencyMin),
+                                           _mm256_mul_ps(clampUnit(g), _mm256_set1_ps(scale.logFrequencyRange)));
+        const __m256 resolved = select(isNaN(g), centre, exp2Normal(logValue));
+
+        _mm256_storeu_ps(magnitudes + bin, _mm256_and_ps(valid, magnitude));
+        _mm256_storeu_ps(phases + bin, _mm256_and_ps(valid, phase));
+        _mm256_storeu_ps(frequencies + bin, select(valid, resolved, centre));
+    }
+    return bin;
+}
+
+#else
+
+std::size_t encodeColumn(const float*, const float*, const float*, float*, std::size_t, float, float,
+                         const ColumnScale&) {
+    return 0;
+}
+
+std::size_t decodeColumn(const float*, float*, float*, float*, std::size_t, float, float, float,
+                         const ColumnScale&) {
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
@@ -10,18 +10,27 @@
 #include "resyne/encoding/reconstruction/phase_smoothing.h"
 #include "resyne/recorder/loudness_utils.h"
 #include "constants.h"
+#include "utilities/threading/task_scheduler.h"
 
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
 #include <cmath>
 #include <limits>
+#include <mutex>
 #include <numbers>
 #include <thread>
 #include <utility>
 #include <vector>
 #include <map>
 
+#ifdef USE_NEON_OPTIMISATIONS
+#include "neon/colour_column_neon.h"
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include "sse/colour_column_sse.h"
+#endif
+
 namespace {
 constexpr float DB_MIN = -140.0f;
 constexpr float DB_MAX = 40.0f;
@@ -67,6 +76,15 @@ constexpr float UNIT_SCALE = 0.5f;
 constexpr float UNIT_OFFSET = 0.5f;
 constexpr float MIN_PHASE_VECTOR = 1e-4f;
 
+// The column kernels address a column as interleaved RGBA floats.
+static_assert(sizeof(RGBAColour) == 4 * sizeof(float));
+
+template <typename Scale>
+Scale columnScale(const float floorLevel) {
+	return Scale{DB_MIN, DB_RANGE, LOG_FREQ_MIN, LOG_FREQ_RANGE,
+		synesthesia::constants::MIN_AUDIO_FREQ, synesthesia::constants::MAX_AUDIO_FREQ, EPSILON, floorLevel};
+}
+
 float computeRobustMedian(std::vector<float>& values) {
 	if (values.empty()) {
 		return 0.0f;
@@ -86,18 +104,60 @@ float computeRobustMedian(std::vector<float>& values) {
 	return median;
 }
 
+size_t codecThreadCount() {
+	return std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(std::thread::hardware_concurrency()), 8));
+}
+
+// Columns are independent, so the frames split into scheduler ranges that idle workers
+// steal from; a run of heavy frames then cannot leave one thread behind. Each range keeps
+// its own column scratch and reports every FRAMES_PER_CLAIM frames. onFramesDone sees the
+// running total, one call at a time. Ranges stop once cancellation is set.
+constexpr size_t FRAMES_PER_CLAIM = 16;
+
+template <typename ProcessFrame>
+void forEachFrame(const size_t frameCount,
+				  const ProcessFrame& processFrame,
+				  const std::function<void(size_t)>& onFramesDone,
+				  const Utilities::Threading::CancellationToken& cancellation) {
+	std::atomic<size_t> framesDone{0};
+	std::mutex progressMutex;
+	size_t reported = 0;  // Protected by progressMutex
+
+	const auto processRange = [&](const size_t rangeFirst, const size_t rangeEnd) {
+		std::vector<RGBAColour> column;
+		for (size_t first = rangeFirst; first < rangeEnd && !cancellation.isCancelled(); first += FRAMES_PER_CLAIM) {
+			const size_t end = std::min(first + FRAMES_PER_CLAIM, rangeEnd);
+			for (size_t frame = first; frame < end; ++frame) {
+				processFrame(frame, column);
+			}
+
+			const size_t done = framesDone.fetch_add(end - first) + (end - first);
+			if (onFramesDone) {
+				std::lock_guard<std::mutex> lock(progressMutex);
+				if (done > reported) {
+					reported = done;
+					onFramesDone(done);
+				}
+			}
+		}
+	};
+
+	Utilities::Threading::TaskScheduler::shared().parallelFor(frameCount, FRAMES_PER_CLAIM, processRange);
+}
+
 }
 
-ColourNativeImage ColourNativeCodec::encode(const std::vector<AudioColourSample>& samples,
+ColourNativeImage ColourNativeCodec::encode(const SpectralSequenceView samples,
 										  const AudioMetadata& metadata,
-										  const std::function<void(float)>& onProgress) {
+										  const std::function<void(float)>& onProgress,
+										  const Utilities::Threading::CancellationToken& cancellation) {
 	ColourNativeImage image;
 	const size_t numFrames = samples.size();
 	const uint32_t numChannels = metadata.channels > 0 ? metadata.channels :
 		(!samples.empty() ? samples.front().channels : 1);
 	const size_t numBinsPerChannel = metadata.numBins != 0
 		? metadata.numBins
-		: (samples.empty() || samples.front().magnitudes.empty() ? 0 : samples.front().magnitudes[0].size());
+		: (samples.empty() || samples.front().magnitudes.empty() ? 0 : samples.front().magnitudes.front().size());
 
 	const size_t totalHeight = numBinsPerChannel * numChannels;
 
@@ -111,22 +171,25 @@ ColourNativeImage ColourNativeCodec::encode(const std::vector<AudioColourSample>
 		onProgress(numFrames == 0 ? 1.0f : 0.0f);
 	}
 
-	for (size_t frame = 0; frame < numFrames; ++frame) {
-		const auto& sample = samples[frame];
+	const float hopRatio = (metadata.fftSize > 0)
+		? static_cast<float>(metadata.hopSize) / static_cast<float>(metadata.fftSize)
+		: 0.5f;
+
+	// Every frame writes only its own pixels, straight into the image.
+	forEachFrame(numFrames, [&](const size_t frame, std::vector<RGBAColour>& column) {
+		const SpectralFrame sample = samples[frame];
 		const float frameSampleRate = sample.sampleRate > 0.0f
 			? sample.sampleRate
 			: metadata.sampleRate;
-		const float hopRatio = (metadata.fftSize > 0)
-			? static_cast<float>(metadata.hopSize) / static_cast<float>(metadata.fftSize)
-			: 0.5f;
 
 		for (uint32_t ch = 0; ch < numChannels; ++ch) {
 			if (ch >= sample.magnitudes.size() || ch >= sample.phases.size()) {
 				continue;
 			}
 
-			std::vector<RGBAColour> column;
-			const std::vector<float>& rawFrequencies = (ch < sample.frequencies.size()) ? sample.frequencies[ch] : std::vector<float>();
+			const std::span<const float> rawFrequencies = ch < sample.frequencies.size()
+				? sample.frequencies[ch]
+				: std::span<const float>();
 			encodeTimeFrame(sample.magnitudes[ch], sample.phases[ch], rawFrequencies, frameSampleRate, hopRatio, column);
 
 			const size_t yOffset = ch * numBinsPerChannel;
@@ -134,14 +197,15 @@ ColourNativeImage ColourNativeCodec::encode(const std::vector<AudioColourSample>
 				image.at(frame, yOffset + bin) = column[bin];
 			}
 		}
-
-		if (onProgress && numFrames > 0) {
-			const float progress = static_cast<float>(frame + 1) /
-				static_cast<float>(numFrames);
-			onProgress(progress);
+	}, [&](const size_t framesDone) {
+		if (onProgress) {
+			onProgress(static_cast<float>(framesDone) / static_cast<float>(numFrames));
 		}
-	}
+	}, cancellation);
 
+	if (cancellation.isCancelled()) {
+		return {};
+	}
 	return image;
 }
 
@@ -302,17 +366,18 @@ float ColourNativeCodec::detectSampleRate(const ColourNativeImage& image) {
 	return std::clamp(sampleRate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE);
 }
 
-std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage& image,
+SpectralSequence ColourNativeCodec::decode(const ColourNativeImage& image,
 														float& sampleRate,
 														int& hopSize,
 														const SequenceFrameCallback& onFrameDecoded,
-														const std::function<void(float)>& onProgress) {
+														const std::function<void(float)>& onProgress,
+														const Utilities::Threading::CancellationToken& cancellation) {
 	const uint32_t numChannels = image.metadata.channels > 0 ? image.metadata.channels : 1;
 	const bool invalidLayout = numChannels == 0 || numChannels > 8 || image.height == 0 ||
 		numChannels > image.height || (image.height % numChannels) != 0;
 	const size_t binCount = invalidLayout ? 0 : (image.height / numChannels);
 
-	std::vector<AudioColourSample> samples(image.width);
+	SpectralSequence samples;
 	const size_t totalFrames = image.width;
 	if (binCount == 0 || binCount > ColourNativeCodec::MAX_BIN_COUNT || totalFrames == 0) {
 		if (onProgress) {
@@ -345,44 +410,34 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 		onProgress(0.0f);
 	}
 
-	const size_t numThreads = std::max<size_t>(
-		1,
-		std::min<size_t>(static_cast<size_t>(std::thread::hardware_concurrency()), 8));
-	const size_t framesPerThread = (totalFrames + numThreads - 1) / numThreads;
-	std::vector<std::thread> pixelThreads;
-	std::atomic<size_t> framesProcessed{0};
-
-	for (size_t t = 0; t < numThreads; ++t) {
-		pixelThreads.emplace_back([&, t]() {
-			const size_t frameStart = t * framesPerThread;
-			const size_t frameEnd = std::min(frameStart + framesPerThread, totalFrames);
-
-			for (size_t frame = frameStart; frame < frameEnd; ++frame) {
-				for (uint32_t ch = 0; ch < numChannels; ++ch) {
-					const size_t yOffset = ch * binCount;
-					std::vector<RGBAColour> column(binCount);
-					for (size_t bin = 0; bin < binCount; ++bin) {
-						column[bin] = image.at(frame, yOffset + bin);
-					}
-
-					std::vector<float> magnitudesFrame, rawPhasesFrame, frequenciesFrame;
-					decodeTimeFrame(column, sampleRate, magnitudesFrame, rawPhasesFrame, frequenciesFrame);
-
-					allChannelsMagnitudes[ch][frame] = std::move(magnitudesFrame);
-					allChannelsRawPhases[ch][frame] = std::move(rawPhasesFrame);
-					allChannelsFrequencies[ch][frame] = std::move(frequenciesFrame);
-				}
+	const size_t numThreads = codecThreadCount();
+	const size_t progressStride = 100;
 
-				const size_t completed = framesProcessed.fetch_add(1, std::memory_order_relaxed) + 1;
-				if (onProgress && (completed % 100 == 0)) {
-					onProgress(0.15f * static_cast<float>(completed) / static_cast<float>(totalFrames));
-				}
+	forEachFrame(totalFrames, [&](const size_t frame, std::vector<RGBAColour>& column) {
+		column.resize(binCount);
+		for (uint32_t ch = 0; ch < numChannels; ++ch) {
+			const size_t yOffset = ch * binCount;
+			for (size_t bin = 0; bin < binCount; ++bin) {
+				column[bin] = image.at(frame, yOffset + bin);
 			}
-		});
-	}
 
-	for (auto& thread : pixelThreads) {
-		thread.join();
+			std::vector<float> magnitudesFrame, rawPhasesFrame, frequenciesFrame;
+			decodeTimeFrame(column, sampleRate, magnitudesFrame, rawPhasesFrame, frequenciesFrame);
+			// Wrapped here, a row at a time, rather than bin by bin in the serial pass.
+			PhaseReconstruction::wrapToPi(rawPhasesFrame);
+
+			allChannelsMagnitudes[ch][frame] = std::move(magnitudesFrame);
+			allChannelsRawPhases[ch][frame] = std::move(rawPhasesFrame);
+			allChannelsFrequencies[ch][frame] = std::move(frequenciesFrame);
+		}
+	}, [&, nextReport = progressStride](const size_t framesDone) mutable {
+		if (onProgress && framesDone >= nextReport) {
+			nextReport = framesDone + progressStride;
+			onProgress(0.15f * static_cast<float>(framesDone) / static_cast<float>(totalFrames));
+		}
+	}, cancellation);
+	if (cancellation.isCancelled()) {
+		return {};
 	}
 
 	std::vector<std::vector<float>> allChannelsSpectralFlux(numChannels);
@@ -404,8 +459,10 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 	constexpr float ADAPTIVE_DAMPING_FACTOR = 0.95f;
 	constexpr float DISCONTINUITY_THRESHOLD = std::numbers::pi_v<float> / 2.0f;
 
+	constexpr size_t PGHI_BLOCK_FRAMES = 64;
+	const size_t pghiThreads = std::max<size_t>(1, numThreads / numChannels);
+
 	std::vector<std::vector<std::vector<float>>> allChannelsReconstructedPhases(numChannels);
-	std::vector<std::thread> channelThreads;
 	std::atomic<uint32_t> channelsCompleted{0};
 
 	auto processChannel = [&](uint32_t ch) {
@@ -421,7 +478,57 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 		std::vector<bool> phaseInitialised(binCount, false);
 		std::vector<int> silenceFrames(binCount, 0);
 
+		// Damage only depends on magnitudes, so it is found for the whole channel up front and
+		// the edited runs are phase-reconstructed as blocks before the serial vocoder pass.
+		// A damaged bin always has full weight, so any damage means the frame blends.
+		const PhaseReconstruction::DamageMap damage = PhaseReconstruction::detectDamage(channelMagnitudes, pghiThreads);
+		std::vector<std::uint8_t> frameHasDamage(totalFrames, 0);
 		for (size_t frame = 0; frame < totalFrames; ++frame) {
+			frameHasDamage[frame] = damage.frameHasDamage(frame) ? 1 : 0;
+		}
+		std::vector<float> damageWeights;
+
+		std::vector<std::vector<float>> frameReconstructedPhases(totalFrames);
+		std::vector<float> magnitudeSlab;
+		std::vector<float> frequencySlab;
+		std::vector<float> phaseSlab;
+		for (size_t runStart = 0; runStart < totalFrames;) {
+			if (!frameHasDamage[runStart]) {
+				++runStart;
+				continue;
+			}
+			size_t runEnd = runStart;
+			while (runEnd < totalFrames && frameHasDamage[runEnd]) {
+				++runEnd;
+			}
+
+			const size_t runFrames = runEnd - runStart;
+			magnitudeSlab.assign(runFrames * binCount, 0.0f);
+			frequencySlab.assign(runFrames * binCount, 0.0f);
+			phaseSlab.assign(runFrames * binCount, 0.0f);
+			for (size_t frame = runStart; frame < runEnd; ++frame) {
+				const size_t rowOffset = (frame - runStart) * binCount;
+				const auto& magnitudesRow = channelMagnitudes[frame];
+				const auto& frequenciesRow = channelFrequencies[frame];
+				std::copy_n(magnitudesRow.begin(), std::min(magnitudesRow.size(), binCount), magnitudeSlab.begin() + static_cast<std::ptrdiff_t>(rowOffset));
+				std::copy_n(frequenciesRow.begin(), std::min(frequenciesRow.size(), binCount), frequencySlab.begin() + static_cast<std::ptrdiff_t>(rowOffset));
+			}
+
+			PhaseReconstruction::reconstructPhasePGHIBlocks(
+				magnitudeSlab, frequencySlab, runFrames, binCount, phaseSlab,
+				sampleRate, hopSize, PGHI_BLOCK_FRAMES, pghiThreads);
+
+			for (size_t frame = runStart; frame < runEnd; ++frame) {
+				const auto row = phaseSlab.begin() + static_cast<std::ptrdiff_t>((frame - runStart) * binCount);
+				frameReconstructedPhases[frame].assign(row, row + static_cast<std::ptrdiff_t>(binCount));
+			}
+			runStart = runEnd;
+		}
+
+		for (size_t frame = 0; frame < totalFrames; ++frame) {
+			if (cancellation.isCancelled()) {
+				return;
+			}
 			const size_t windowStart = frame >= TRANSIENT_WINDOW_RADIUS ? frame - TRANSIENT_WINDOW_RADIUS : 0;
 			const size_t windowEnd = std::min(frame + TRANSIENT_WINDOW_RADIUS + 1, totalFrames);
 
@@ -452,16 +559,13 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 			const std::vector<float>& frequenciesFrame = channelFrequencies[frame];
 			std::vector<float> adjustedPhases(binCount, 0.0f);
 
-			const std::vector<bool> damagedMask = PhaseReconstruction::detectDamagedBins(channelMagnitudes, frame);
-			const std::vector<float> damageWeights = PhaseReconstruction::computeDamageBlend(damagedMask, TRANSITION_RADIUS);
-			const bool hasDamagedBins = std::any_of(damagedMask.begin(), damagedMask.end(),
-				[](bool value) { return value; });
-			const bool hasBlendRegions = std::any_of(damageWeights.begin(), damageWeights.end(),
-				[](float weight) { return weight > 0.0f; });
+			const bool hasBlendRegions = frameHasDamage[frame] != 0;
+			if (hasBlendRegions) {
+				PhaseReconstruction::computeDamageBlend(damage, frame, TRANSITION_RADIUS, damageWeights);
+			}
 
-			std::vector<float> reconstructedPhases(binCount, 0.0f);
+			std::vector<float> reconstructedPhases = std::move(frameReconstructedPhases[frame]);
 			if (hasBlendRegions) {
-				PhaseReconstruction::reconstructPhasePGHI(channelMagnitudes, channelFrequencies, frame, reconstructedPhases, sampleRate, hopSize, &prevOutputPhase);
 				PhaseReconstruction::alignReconstructedPhase(reconstructedPhases, prevOutputPhase, frequenciesFrame, damageWeights, sampleRate, hopSize);
 
 				const auto peaks = PhaseReconstruction::findSpectralPeaks(magnitudesFrame, MIN_BIN_INTENSITY * 5.0f);
@@ -471,7 +575,7 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 
 			for (size_t bin = 0; bin < binCount; ++bin) {
 				const float magnitude = magnitudesFrame[bin];
-				const float decodedPhase = PhaseReconstruction::wrapToPi(rawPhasesFrame[bin]);
+				const float decodedPhase = rawPhasesFrame[bin];
 				const float frequency = frequenciesFrame[bin] > 0.0f
 					? frequenciesFrame[bin]
 					: freqResolution * static_cast<float>(bin);
@@ -530,7 +634,7 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 				const float weight = hasBlendRegions ? std::clamp(damageWeights[bin], 0.0f, 1.0f) : 0.0f;
 				float finalPhase = vocoderPhase;
 
-				if (hasDamagedBins && weight > 0.0f) {
+				if (hasBlendRegions && weight > 0.0f) {
 					const float reconPhase = reconstructedPhases[bin];
 					const float phaseOffset = PhaseReconstruction::wrapToPi(reconPhase - vocoderPhase);
 					const float blendedPhase = PhaseReconstruction::wrapToPi(vocoderPhase + weight * phaseOffset);
@@ -558,38 +662,38 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 		}
 	};
 
-	if (numChannels > 1) {
-		channelThreads.reserve(numChannels);
-		for (uint32_t ch = 0; ch < numChannels; ++ch) {
-			channelThreads.emplace_back(processChannel, ch);
+	Utilities::Threading::TaskScheduler::shared().parallelFor(numChannels, 1, [&](const size_t first, const size_t end) {
+		for (size_t ch = first; ch < end; ++ch) {
+			processChannel(static_cast<uint32_t>(ch));
 		}
-		for (auto& thread : channelThreads) {
-			thread.join();
-		}
-	} else {
-		processChannel(0);
-	}
-
+	});
+	if (cancellation.isCancelled()) {
+		return {};
+	}
+
+	// Each channel's rows are freed as soon as the frame is packed, so the decoded track is
+	// held once rather than twice.
+	samples.reset(numChannels, binCount);
+	samples.reserve(totalFrames);
+	const auto copyRow = [](std::vector<float>& row, const std::span<float> destination) {
+		std::copy_n(row.begin(), std::min(row.size(), destination.size()), destination.begin());
+		std::vector<float>().swap(row);
+	};
 	for (size_t frame = 0; frame < totalFrames; ++frame) {
-		AudioColourSample sample;
-		sample.magnitudes.resize(numChannels);
-		sample.phases.resize(numChannels);
-		sample.frequencies.resize(numChannels);
-		sample.channels = numChannels;
-
-		for (uint32_t ch = 0; ch < numChannels; ++ch) {
-			sample.magnitudes[ch] = allChannelsMagnitudes[ch][frame];
-			sample.phases[ch] = allChannelsReconstructedPhases[ch][frame];
-			sample.frequencies[ch] = allChannelsFrequencies[ch][frame];
-		}
-
-		sample.sampleRate = sampleRate;
-		sample.timestamp = (sampleRate > EPSILON && hopSize > 0)
+		SpectralFrameInfo info{};
+		info.channels = numChannels;
+		info.sampleRate = sampleRate;
+		info.timestamp = (sampleRate > EPSILON && hopSize > 0)
 			? static_cast<double>(frame * static_cast<size_t>(hopSize)) /
 				static_cast<double>(sampleRate)
 			: 0.0;
+		samples.appendFrame(info, numChannels, binCount);
 
-		samples[frame] = sample;
+		for (uint32_t ch = 0; ch < numChannels; ++ch) {
+			copyRow(allChannelsMagnitudes[ch][frame], samples.magnitudes(frame, ch));
+			copyRow(allChannelsReconstructedPhases[ch][frame], samples.phases(frame, ch));
+			copyRow(allChannelsFrequencies[ch][frame], samples.frequencies(frame, ch));
+		}
 
 		if (onFrameDecoded && ((frame + 1) % callbackStride == 0 || frame + 1 == totalFrames)) {
 			onFrameDecoded(samples, frame + 1);
@@ -603,9 +707,9 @@ std::vector<AudioColourSample> ColourNativeCodec::decode(const ColourNativeImage
 	return samples;
 }
 
-void ColourNativeCodec::encodeTimeFrame(const std::vector<float>& magnitudes,
-									   const std::vector<float>& phases,
-									   const std::vector<float>& frequencies,
+void ColourNativeCodec::encodeTimeFrame(std::span<const float> magnitudes,
+									   std::span<const float> phases,
+									   std::span<const float> frequencies,
 									   const float sampleRate,
 									   const float hopRatio,
 									   std::vector<RGBAColour>& column) {
@@ -622,7 +726,21 @@ void ColourNativeCodec::encodeTimeFrame(const std::vector<float>& magnitudes,
 		? sampleRate / fftSizeF
 		: 0.0f;
 
-	for (size_t bin = 0; bin < numBins; ++bin) {
+	size_t firstScalarBin = 0;
+	if (freqResolution > 0.0f && LOG_FREQ_RANGE > EPSILON &&
+		(frequencies.empty() || frequencies.size() >= numBins)) {
+		[[maybe_unused]] const float* storedFrequencies = frequencies.empty() ? nullptr : frequencies.data();
+		[[maybe_unused]] float* pixels = reinterpret_cast<float*>(column.data());
+#ifdef USE_NEON_OPTIMISATIONS
+		firstScalarBin = ColourColumnNEON::encodeColumn(magnitudes.data(), phases.data(), storedFrequencies, pixels,
+			numBins, freqResolution, sampleRate * 0.5f, columnScale<ColourColumnNEON::ColumnScale>(normaliseMagnitude(EPSILON)));
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		firstScalarBin = ColourColumnSSE::encodeColumn(magnitudes.data(), phases.data(), storedFrequencies, pixels,
+			numBins, freqResolution, sampleRate * 0.5f, columnScale<ColourColumnSSE::ColumnScale>(normaliseMagnitude(EPSILON)));
+#endif
+	}
+
+	for (size_t bin = firstScalarBin; bin < numBins; ++bin) {
 		const float magnitude = magnitudes[bin];
 		const float phase = phases[bin];
 
@@ -661,7 +779,41 @@ void ColourNativeCodec::decodeTimeFrame(const std::vector<RGBAColour>& column,
 		? sampleRate / fftSizeF
 		: 0.0f;
 
-	for (size_t bin = 0; bin < numBins; ++bin) {
+	// The highest stored level the scalar path decodes as silence, found by bisecting the
+	// float bit patterns in [0, 1] once; the kernels cut on it exactly.
+	[[maybe_unused]] static const float silentLevel = [] {
+		const auto silent = [](const uint32_t bits) {
+			const float magnitude = denormaliseMagnitude(std::bit_cast<float>(bits));
+			return !std::isfinite(magnitude) || magnitude <= MIN_BIN_INTENSITY;
+		};
+		uint32_t low = std::bit_cast<uint32_t>(0.0f);
+		uint32_t high = std::bit_cast<uint32_t>(1.0f);
+		if (!silent(low) || silent(high)) {
+			return silent(high) ? 1.0f : -1.0f;
+		}
+		while (high - low > 1) {
+			const uint32_t mid = low + (high - low) / 2;
+			(silent(mid) ? low : high) = mid;
+		}
+		return std::bit_cast<float>(low);
+	}();
+
+	size_t firstScalarBin = 0;
+	if (LOG_FREQ_RANGE > EPSILON) {
+		[[maybe_unused]] const float* pixels = reinterpret_cast<const float*>(column.data());
+#ifdef USE_NEON_OPTIMISATIONS
+		firstScalarBin = ColourColumnNEON::decodeColumn(pixels, magnitudes.data(), phases.data(), frequencies.data(),
+			numBins, freqResolution, silentLevel, MIN_PHASE_VECTOR, columnScale<ColourColumnNEON::ColumnScale>(normaliseMagnitude(EPSILON)));
+#elif defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		firstScalarBin = ColourColumnSSE::decodeColumn(pixels, magnitudes.data(), phases.data(), frequencies.data(),
+			numBins, freqResolution, silentLevel, MIN_PHASE_VECTOR, columnScale<ColourColumnSSE::ColumnScale>(normaliseMagnitude(EPSILON)));
+#endif
+		if (firstScalarBin > 0) {
+			frequencies[0] = 0.0f;
+		}
+	}
+
+	for (size_t bin = firstScalarBin; bin < numBins; ++bin) {
 		const RGBAColour& pixel = column[bin];
 		const float magnitude = denormaliseMagnitude(std::clamp(pixel.r, 0.0f, 1.0f));
 		if (!std::isfinite(magnitude) || magnitude <= MIN_BIN_INTENSITY) {
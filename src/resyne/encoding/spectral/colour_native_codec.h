@@ -4,6 +4,7 @@
 
 #include <cstddef>
 #include <functional>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -40,21 +41,24 @@ public:
 	// Maximum supported bins per channel (supports up to 16384-point FFTs).
 	static constexpr size_t MAX_BIN_COUNT = 8193;
 
-	static ColourNativeImage encode(const std::vector<AudioColourSample>& samples,
+	// Both stop early once cancellation is set, returning an empty image or no samples.
+	static ColourNativeImage encode(SpectralSequenceView samples,
 								   const AudioMetadata& metadata,
-								   const std::function<void(float)>& onProgress = {});
+								   const std::function<void(float)>& onProgress = {},
+								   const Utilities::Threading::CancellationToken& cancellation = {});
 
-	static std::vector<AudioColourSample> decode(const ColourNativeImage& image,
-												float& sampleRate,
-												int& hopSize,
-												const SequenceFrameCallback& onFrameDecoded = {},
-												const std::function<void(float)>& onProgress = {});
+	static SpectralSequence decode(const ColourNativeImage& image,
+								   float& sampleRate,
+								   int& hopSize,
+								   const SequenceFrameCallback& onFrameDecoded = {},
+								   const std::function<void(float)>& onProgress = {},
+								   const Utilities::Threading::CancellationToken& cancellation = {});
 
 	static float detectSampleRate(const ColourNativeImage& image);
 
-	static void encodeTimeFrame(const std::vector<float>& magnitudes,
-								const std::vector<float>& phases,
-								const std::vector<float>& frequencies,
+	static void encodeTimeFrame(std::span<const float> magnitudes,
+								std::span<const float> phases,
+								std::span<const float> frequencies,
 								float sampleRate,
 								float hopRatio,
 								std::vector<RGBAColour>& column);
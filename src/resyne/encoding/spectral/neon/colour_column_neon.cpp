@@ -0,0 +1,242 @@
+#include "colour_column_neon.h"
+
+#ifdef __ARM_NEON
+
+#include <numbers>
+
+namespace ColourColumnNEON {
+
+namespace {
+
+constexpr float PI = std::numbers::pi_v<float>;
+constexpr float LOG2_10_OVER_20 = 0.16609640474f;
+constexpr float LOG10_2_TIMES_20 = 6.02059991328f;
+
+float32x4_t clampUnit(const float32x4_t values) {
+    return vminq_f32(vmaxq_f32(values, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+}
+
+float32x4_t maskOf(const float32x4_t values, const uint32x4_t mask) {
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(values), mask));
+}
+
+// Integer tests, so -ffast-math cannot assume the answer.
+uint32x4_t isFinite(const float32x4_t values) {
+    const uint32x4_t exponent = vandq_u32(vreinterpretq_u32_f32(values), vdupq_n_u32(0x7f800000));
+    return vmvnq_u32(vceqq_u32(exponent, vdupq_n_u32(0x7f800000)));
+}
+
+uint32x4_t isNaN(const float32x4_t values) {
+    const uint32x4_t magnitude = vandq_u32(vreinterpretq_u32_f32(values), vdupq_n_u32(0x7fffffff));
+    return vcgtq_u32(magnitude, vdupq_n_u32(0x7f800000));
+}
+
+float32x4_t multiplyAdd(const float32x4_t accumulator, const float32x4_t x, const float coefficient) {
+    return vaddq_f32(vmulq_f32(accumulator, x), vdupq_n_f32(coefficient));
+}
+
+// log2 for positive normal inputs: exponent plus a degree-9 polynomial for ln over
+// [sqrt(1/2), sqrt(2)).
+float32x4_t log2Positive(const float32x4_t values) {
+    const uint32x4_t bits = vreinterpretq_u32_f32(values);
+    float32x4_t exponent = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127)));
+    float32x4_t mantissa = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)),
+                                                           vdupq_n_u32(0x3f800000)));
+
+    const uint32x4_t upper = vcgtq_f32(mantissa, vdupq_n_f32(std::numbers::sqrt2_v<float>));
+    mantissa = vbslq_f32(upper, vmulq_n_f32(mantissa, 0.5f), mantissa);
+    exponent = vaddq_f32(exponent, maskOf(vdupq_n_f32(1.0f), upper));
+
+    const float32x4_t t = vsubq_f32(mantissa, vdupq_n_f32(1.0f));
+    const float32x4_t t2 = vmulq_f32(t, t);
+    float32x4_t poly = vdupq_n_f32(7.0376836292e-2f);
+    poly = multiplyAdd(poly, t, -1.1514610310e-1f);
+    poly = multiplyAdd(poly, t, 1.1676998740e-1f);
+    poly = multiplyAdd(poly, t, -1.2420140846e-1f);
+    poly = multiplyAdd(poly, t, 1.4249322787e-1f);
+    poly = multiplyAdd(poly, t, -1.6668057665e-1f);
+    poly = multiplyAdd(poly, t, 2.0000714765e-1f);
+    poly = multiplyAdd(poly, t, -2.4999993993e-1f);
+    poly = multiplyAdd(poly, t, 3.3333331174e-1f);
+    poly = vmulq_f32(vmulq_f32(poly, t2), t);
+    poly = vsubq_f32(poly, vmulq_n_f32(t2, 0.5f));
+
+    const float32x4_t naturalLog = vaddq_f32(t, poly);
+    return vaddq_f32(vmulq_n_f32(naturalLog, std::numbers::log2e_v<float>), exponent);
+}
+
+// 2^x for x well inside the normal range: a degree-6 polynomial on the fractional part,
+// scaled by building the exponent directly.
+float32x4_t exp2Normal(const float32x4_t values) {
+    const float32x4_t x = vminq_f32(vmaxq_f32(values, vdupq_n_f32(-126.0f)), vdupq_n_f32(127.0f));
+    const float32x4_t whole = vrndnq_f32(x);
+    const float32x4_t r = vmulq_n_f32(vsubq_f32(x, whole), std::numbers::ln2_v<float>);
+
+    float32x4_t poly = vdupq_n_f32(1.9875691500e-4f);
+    poly = multiplyAdd(poly, r, 1.3981999507e-3f);
+    poly = multiplyAdd(poly, r, 8.3334519073e-3f);
+    poly = multiplyAdd(poly, r, 4.1665795894e-2f);
+    poly = multiplyAdd(poly, r, 1.6666665459e-1f);
+    poly = multiplyAdd(poly, r, 5.0000001201e-1f);
+    poly = vaddq_f32(vaddq_f32(vmulq_f32(vmulq_f32(poly, r), r), r), vdupq_n_f32(1.0f));
+
+    const int32x4_t scale = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(whole), vdupq_n_s32(127)), 23);
+    return vmulq_f32(poly, vreinterpretq_f32_s32(scale));
+}
+
+// Cephes-style sincos: reduce by pi/4 in three parts, then pick and sign the sine or
+// cosine polynomial by octant.
+void sinCos(const float32x4_t values, float32x4_t& sine, float32x4_t& cosine) {
+    const uint32x4_t signMask = vdupq_n_u32(0x80000000);
+    const uint32x4_t inputSign = vandq_u32(vreinterpretq_u32_f32(values), signMask);
+    const float32x4_t x = vabsq_f32(values);
+
+    uint32x4_t octant = vcvtq_u32_f32(vmulq_n_f32(x, 4.0f / PI));
+    octant = vandq_u32(vaddq_u32(octant, vdupq_n_u32(1)), vdupq_n_u32(~1u));
+    const float32x4_t y = vcvtq_f32_u32(octant);
+
+    float32x4_t reduced = vsubq_f32(x, vmulq_n_f32(y, 0.78515625f));
+    reduced = vsubq_f32(reduced, vmulq_n_f32(y, 2.4187564849853515625e-4f));
+    reduced = vsubq_f32(reduced, vmulq_n_f32(y, 3.77489497744594108e-8f));
+    const float32x4_t z = vmulq_f32(reduced, reduced);
+
+    float32x4_t cosPoly = vdupq_n_f32(2.443315711809948e-5f);
+    cosPoly = multiplyAdd(cosPoly, z, -1.388731625493765e-3f);
+    cosPoly = multiplyAdd(cosPoly, z, 4.166664568298827e-2f);
+    cosPoly = vmulq_f32(vmulq_f32(cosPoly, z), z);
+    cosPoly = vaddq_f32(vsubq_f32(cosPoly, vmulq_n_f32(z, 0.5f)), vdupq_n_f32(1.0f));
+
+    float32x4_t sinPoly = vdupq_n_f32(-1.9515295891e-4f);
+    sinPoly = multiplyAdd(sinPoly, z, 8.3321608736e-3f);
+    sinPoly = multiplyAdd(sinPoly, z, -1.6666654611e-1f);
+    sinPoly = vaddq_f32(vmulq_f32(vmulq_f32(sinPoly, z), reduced), reduced);
+
+    const uint32x4_t swap = vtstq_u32(octant, vdupq_n_u32(2));
+    const uint32x4_t sinSign = veorq_u32(inputSign, vshlq_n_u32(vandq_u32(octant, vdupq_n_u32(4)), 29));
+    const uint32x4_t cosSign = vshlq_n_u32(vbicq_u32(vdupq_n_u32(4), vsubq_u32(octant, vdupq_n_u32(2))), 29);
+
+    sine = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, cosPoly, sinPoly)), sinSign));
+    cosine = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, sinPoly, cosPoly)), cosSign));
+}
+
+// atan2 from the octant of (x, y): atan of min/max over [0, 1], reduced once more about
+// tan(pi/8), then reflected into place.
+float32x4_t atan2Approx(const float32x4_t y, const float32x4_t x) {
+    const float32x4_t ax = vabsq_f32(x);
+    const float32x4_t ay = vabsq_f32(y);
+    const float32x4_t ratio = vdivq_f32(vminq_f32(ax, ay), vmaxq_f32(ax, ay));
+
+    const uint32x4_t reduce = vcgtq_f32(ratio, vdupq_n_f32(0.41421356237f));
+    const float32x4_t t = vbslq_f32(reduce,
+        vdivq_f32(vsubq_f32(ratio, vdupq_n_f32(1.0f)), vaddq_f32(ratio, vdupq_n_f32(1.0f))), ratio);
+    const float32x4_t base = maskOf(vdupq_n_f32(PI / 4.0f), reduce);
+
+    const float32x4_t z = vmulq_f32(t, t);
+    float32x4_t poly = vdupq_n_f32(8.05374449538e-2f);
+    poly = multiplyAdd(poly, z, -1.38776856032e-1f);
+    poly = multiplyAdd(poly, z, 1.99777106478e-1f);
+    poly = multiplyAdd(poly, z, -3.33329491539e-1f);
+    float32x4_t angle = vaddq_f32(base, vaddq_f32(vmulq_f32(vmulq_f32(poly, z), t), t));
+
+    angle = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(PI / 2.0f), angle), angle);
+    angle = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vsubq_f32(vdupq_n_f32(PI), angle), angle);
+    const uint32x4_t ySign = vandq_u32(vreinterpretq_u32_f32(y), vdupq_n_u32(0x80000000));
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(angle), ySign));
+}
+
+}
+
+std::size_t encodeColumn(const float* magnitudes, const float* phases, const float* frequencies,
+                         float* rgba, const std::size_t count, const float binWidth,
+                         const float maxBinFrequency, const ColumnScale& scale) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float laneOffsets[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const float32x4_t lane = vld1q_f32(laneOffsets);
+    const float dbScale = 1.0f / scale.dbRange;
+    const float logScale = 1.0f / scale.logFrequencyRange;
+
+    std::size_t bin = 0;
+    for (; bin + 4 <= count; bin += 4) {
+        float32x4x4_t pixel;
+
+        const float32x4_t magnitude = vld1q_f32(magnitudes + bin);
+        const uint32x4_t magnitudeValid = vandq_u32(vcgtq_f32(magnitude, zero), isFinite(magnitude));
+        const float32x4_t floorMagnitude = vdupq_n_f32(scale.magnitudeFloor);
+        const float32x4_t db = vmulq_n_f32(log2Positive(vmaxq_f32(magnitude, floorMagnitude)), LOG10_2_TIMES_20);
+        const float32x4_t level = vbslq_f32(vcgtq_f32(magnitude, floorMagnitude),
+                                            clampUnit(vmulq_n_f32(vsubq_f32(db, vdupq_n_f32(scale.dbMin)), dbScale)),
+                                            vdupq_n_f32(scale.floorLevel));
+        pixel.val[0] = maskOf(level, magnitudeValid);
+
+        const float32x4_t centre = vminq_f32(
+            vmulq_n_f32(vaddq_f32(vdupq_n_f32(static_cast<float>(bin)), lane), binWidth),
+            vdupq_n_f32(maxBinFrequency));
+        float32x4_t frequency = centre;
+        if (frequencies != nullptr) {
+            const float32x4_t stored = vld1q_f32(frequencies + bin);
+            frequency = vbslq_f32(vcgtq_f32(stored, zero), stored, centre);
+        }
+        const uint32x4_t frequencyValid = vandq_u32(vcgtq_f32(frequency, zero), isFinite(frequency));
+        const float32x4_t bounded = vminq_f32(vmaxq_f32(frequency, vdupq_n_f32(scale.minFrequency)),
+                                              vdupq_n_f32(scale.maxFrequency));
+        pixel.val[1] = maskOf(
+            clampUnit(vmulq_n_f32(vsubq_f32(log2Positive(bounded), vdupq_n_f32(scale.logFrequencyMin)), logScale)),
+            frequencyValid);
+
+        const float32x4_t phase = vld1q_f32(phases + bin);
+        const uint32x4_t phaseValid = isFinite(phase);
+        float32x4_t sine;
+        float32x4_t cosine;
+        sinCos(maskOf(phase, phaseValid), sine, cosine);
+        pixel.val[2] = vbslq_f32(phaseValid, vaddq_f32(vmulq_f32(cosine, half), half), half);
+        pixel.val[3] = vbslq_f32(phaseValid, vaddq_f32(vmulq_f32(sine, half), half), half);
+
+        vst4q_f32(rgba + bin * 4, pixel);
+    }
+    return bin;
+}
+
+std::size_t decodeColumn(const float* rgba, float* magnitudes, float* phases, float* frequencies,
+                         const std::size_t count, const float binWidth, const float silentLevel,
+                         const float minPhaseVector, const ColumnScale& scale) {
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float laneOffsets[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const float32x4_t lane = vld1q_f32(laneOffsets);
+
+    std::size_t bin = 0;
+    for (; bin + 4 <= count; bin += 4) {
+        const float32x4x4_t pixel = vld4q_f32(rgba + bin * 4);
+        const float32x4_t r = pixel.val[0];
+        const float32x4_t g = pixel.val[1];
+        const float32x4_t b = pixel.val[2];
+        const float32x4_t a = pixel.val[3];
+
+        const float32x4_t centre = vmulq_n_f32(vaddq_f32(vdupq_n_f32(static_cast<float>(bin)), lane), binWidth);
+
+        // NaN channels fail the same checks they fail in the scalar path.
+        const float32x4_t db = vaddq_f32(vmulq_n_f32(clampUnit(r), scale.dbRange), vdupq_n_f32(scale.dbMin));
+        const float32x4_t magnitude = exp2Normal(vmulq_n_f32(db, LOG2_10_OVER_20));
+        const uint32x4_t valid = vbicq_u32(vcgtq_f32(clampUnit(r), vdupq_n_f32(silentLevel)), isNaN(r));
+
+        const float32x4_t cosine = vmulq_n_f32(vsubq_f32(clampUnit(b), half), 2.0f);
+        const float32x4_t sine = vmulq_n_f32(vsubq_f32(clampUnit(a), half), 2.0f);
+        const float32x4_t length = vsqrtq_f32(vaddq_f32(vmulq_f32(cosine, cosine), vmulq_f32(sine, sine)));
+        const uint32x4_t phaseValid = vbicq_u32(vcgtq_f32(length, vdupq_n_f32(minPhaseVector)),
+                                                vorrq_u32(isNaN(b), isNaN(a)));
+        const float32x4_t phase = maskOf(atan2Approx(sine, cosine), phaseValid);
+
+        const float32x4_t logValue = vaddq_f32(vdupq_n_f32(scale.logFrequencyMin),
+                                               vmulq_n_f32(clampUnit(g), scale.logFrequencyRange));
+        const float32x4_t resolved = vbslq_f32(isNaN(g), centre, exp2Normal(logValue));
+
+        vst1q_f32(magnitudes + bin, maskOf(magnitude, valid));
+        vst1q_f32(phases + bin, maskOf(phase, valid));
+        vst1q_f32(frequencies + bin, vbslq_f32(valid, resolved, centre));
+    }
+    return bin;
+}
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#include <cstddef>
+
+namespace ColourColumnNEON {
+    // Ranges the codec maps magnitude and frequency through: decibels and log2 Hz.
+    struct ColumnScale {
+        float dbMin;
+        float dbRange;
+        float logFrequencyMin;
+        float logFrequencyRange;
+        float minFrequency;
+        float maxFrequency;
+        float magnitudeFloor;
+        // Stored level of magnitudeFloor, taken from the scalar path so that the many bins
+        // clamped to the floor encode exactly as it does.
+        float floorLevel;
+    };
+
+    // Batch forms of ColourNativeCodec's per-bin transforms, writing or reading interleaved
+    // RGBA floats. log, exp2 and sincos/atan2 are polynomial approximations good to a few
+    // ulp, so results track the scalar path closely but not bit for bit. Each returns how
+    // many bins it handled, leaving any tail shorter than one vector to the caller.
+
+    // frequencies may be null, in which case every bin takes its centre frequency capped at
+    // maxBinFrequency; so does any bin whose stored frequency is not positive.
+    std::size_t encodeColumn(const float* magnitudes, const float* phases, const float* frequencies,
+                             float* rgba, std::size_t count, float binWidth, float maxBinFrequency,
+                             const ColumnScale& scale);
+
+    // Bins whose magnitude channel is at or below silentLevel decode to silence at their
+    // centre frequency. The cutoff is taken on the stored level, so the approximate exp2
+    // cannot move it.
+    std::size_t decodeColumn(const float* rgba, float* magnitudes, float* phases, float* frequencies,
+                             std::size_t count, float binWidth, float silentLevel, float minPhaseVector,
+                             const ColumnScale& scale);
+}
+
+#endif
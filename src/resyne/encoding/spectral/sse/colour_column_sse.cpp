@@ -0,0 +1,277 @@
+#include "colour_column_sse.h"
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+#include <numbers>
+
+#include "resyne/encoding/spectral/avx/colour_column_avx.h"
+#include "utilities/cpu/cpu_features.h"
+
+namespace ColourColumnSSE {
+
+// _mm_blendv_ps and _mm_round_ps need SSE4.1, which MSVC emits without an /arch switch;
+// without it every kernel hands the whole column back.
+#if defined(__SSE4_1__) || defined(_MSC_VER)
+
+namespace {
+
+constexpr float PI = std::numbers::pi_v<float>;
+constexpr float LOG2_10_OVER_20 = 0.16609640474f;
+constexpr float LOG10_2_TIMES_20 = 6.02059991328f;
+
+__m128 select(const __m128 mask, const __m128 whenTrue, const __m128 whenFalse) {
+    return _mm_blendv_ps(whenFalse, whenTrue, mask);
+}
+
+__m128 clampUnit(const __m128 values) {
+    return _mm_min_ps(_mm_max_ps(values, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+// Integer tests, so -ffast-math cannot assume the answer.
+__m128 isFinite(const __m128 values) {
+    const __m128i exponent = _mm_and_si128(_mm_castps_si128(values), _mm_set1_epi32(0x7f800000));
+    return _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x7f800000)),
+                                          _mm_set1_epi32(-1)));
+}
+
+__m128 isNaN(const __m128 values) {
+    const __m128i magnitude = _mm_and_si128(_mm_castps_si128(values), _mm_set1_epi32(0x7fffffff));
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7f800000)));
+}
+
+// log2 for positive normal inputs: exponent plus a degree-9 polynomial for ln over
+// [sqrt(1/2), sqrt(2)).
+__m128 log2Positive(const __m128 values) {
+    const __m128i bits = _mm_castps_si128(values);
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                    _mm_set1_epi32(0x3f800000)));
+
+    const __m128 upper = _mm_cmpgt_ps(mantissa, _mm_set1_ps(std::numbers::sqrt2_v<float>));
+    mantissa = select(upper, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f)), mantissa);
+    exponent = _mm_add_ps(exponent, _mm_and_ps(upper, _mm_set1_ps(1.0f)));
+
+    const __m128 t = _mm_sub_ps(mantissa, _mm_set1_ps(1.0f));
+    const __m128 t2 = _mm_mul_ps(t, t);
+    __m128 poly = _mm_set1_ps(7.0376836292e-2f);
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(-1.1514610310e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(1.1676998740e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(-1.2420140846e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(1.4249322787e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(-1.6668057665e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(2.0000714765e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(-2.4999993993e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(3.3333331174e-1f));
+    poly = _mm_mul_ps(_mm_mul_ps(poly, t2), t);
+    poly = _mm_sub_ps(poly, _mm_mul_ps(t2, _mm_set1_ps(0.5f)));
+
+    const __m128 naturalLog = _mm_add_ps(t, poly);
+    return _mm_add_ps(_mm_mul_ps(naturalLog, _mm_set1_ps(std::numbers::log2e_v<float>)), exponent);
+}
+
+// 2^x for x well inside the normal range: a degree-6 polynomial on the fractional part,
+// scaled by building the exponent directly.
+__m128 exp2Normal(const __m128 values) {
+    const __m128 x = _mm_min_ps(_mm_max_ps(values, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+    const __m128 whole = _mm_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __m128 r = _mm_mul_ps(_mm_sub_ps(x, whole), _mm_set1_ps(std::numbers::ln2_v<float>));
+
+    __m128 poly = _mm_set1_ps(1.9875691500e-4f);
+    poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(1.3981999507e-3f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(8.3334519073e-3f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(4.1665795894e-2f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(1.6666665459e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(5.0000001201e-1f));
+    poly = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(poly, r), r), r), _mm_set1_ps(1.0f));
+
+    const __m128i scale = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(whole), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(poly, _mm_castsi128_ps(scale));
+}
+
+// Cephes-style sincos: reduce by pi/4 in three parts, then pick and sign the sine or
+// cosine polynomial by octant.
+void sinCos(const __m128 values, __m128& sine, __m128& cosine) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 inputSign = _mm_and_ps(values, signMask);
+    const __m128 x = _mm_andnot_ps(signMask, values);
+
+    __m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(4.0f / PI)));
+    octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    const __m128 y = _mm_cvtepi32_ps(octant);
+
+    __m128 reduced = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+    reduced = _mm_sub_ps(reduced, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+    reduced = _mm_sub_ps(reduced, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+    const __m128 z = _mm_mul_ps(reduced, reduced);
+
+    __m128 cosPoly = _mm_set1_ps(2.443315711809948e-5f);
+    cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(-1.388731625493765e-3f));
+    cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(4.166664568298827e-2f));
+    cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+    cosPoly = _mm_add_ps(_mm_sub_ps(cosPoly, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    __m128 sinPoly = _mm_set1_ps(-1.9515295891e-4f);
+    sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(8.3321608736e-3f));
+    sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(-1.6666654611e-1f));
+    sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), reduced), reduced);
+
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)),
+                                                         _mm_set1_epi32(2)));
+    const __m128 sinSign = _mm_xor_ps(inputSign,
+        _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29)));
+    const __m128 cosSign = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+
+    sine = _mm_xor_ps(select(swap, cosPoly, sinPoly), sinSign);
+    cosine = _mm_xor_ps(select(swap, sinPoly, cosPoly), cosSign);
+}
+
+// atan2 from the octant of (x, y): atan of min/max over [0, 1], reduced once more about
+// tan(pi/8), then reflected into place.
+__m128 atan2Approx(const __m128 y, const __m128 x) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 ax = _mm_andnot_ps(signMask, x);
+    const __m128 ay = _mm_andnot_ps(signMask, y);
+    const __m128 ratio = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(ax, ay));
+
+    const __m128 reduce = _mm_cmpgt_ps(ratio, _mm_set1_ps(0.41421356237f));
+    const __m128 t = select(reduce,
+        _mm_div_ps(_mm_sub_ps(ratio, _mm_set1_ps(1.0f)), _mm_add_ps(ratio, _mm_set1_ps(1.0f))), ratio);
+    const __m128 base = _mm_and_ps(reduce, _mm_set1_ps(PI / 4.0f));
+
+    const __m128 z = _mm_mul_ps(t, t);
+    __m128 poly = _mm_set1_ps(8.05374449538e-2f);
+    poly = _mm_add_ps(_mm_mul_ps(poly, z), _mm_set1_ps(-1.38776856032e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, z), _mm_set1_ps(1.99777106478e-1f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, z), _mm_set1_ps(-3.33329491539e-1f));
+    __m128 angle = _mm_add_ps(base, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(poly, z), t), t));
+
+    angle = select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(PI / 2.0f), angle), angle);
+    angle = select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(PI), angle), angle);
+    return _mm_xor_ps(angle, _mm_and_ps(y, signMask));
+}
+
+}
+
+std::size_t encodeColumn(const float* magnitudes, const float* phases, const float* frequencies,
+                         float* rgba, const std::size_t count, const float binWidth,
+                         const float maxBinFrequency, const ColumnScale& scale) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 dbMin = _mm_set1_ps(scale.dbMin);
+    const __m128 dbScale = _mm_set1_ps(1.0f / scale.dbRange);
+    const __m128 logMin = _mm_set1_ps(scale.logFrequencyMin);
+    const __m128 logScale = _mm_set1_ps(1.0f / scale.logFrequencyRange);
+
+    std::size_t bin = 0;
+    if (Utilities::CPU::hasAVX2()) {
+        bin = ColourColumnAVX2::encodeColumn(magnitudes, phases, frequencies, rgba, count, binWidth,
+                                             maxBinFrequency, scale);
+    }
+    for (; bin + 4 <= count; bin += 4) {
+        const __m128 magnitude = _mm_loadu_ps(magnitudes + bin);
+        const __m128 magnitudeValid = _mm_and_ps(_mm_cmpgt_ps(magnitude, zero), isFinite(magnitude));
+        const __m128 floorMagnitude = _mm_set1_ps(scale.magnitudeFloor);
+        const __m128 db = _mm_mul_ps(log2Positive(_mm_max_ps(magnitude, floorMagnitude)), _mm_set1_ps(LOG10_2_TIMES_20));
+        const __m128 level = select(_mm_cmpgt_ps(magnitude, floorMagnitude),
+                                    clampUnit(_mm_mul_ps(_mm_sub_ps(db, dbMin), dbScale)),
+                                    _mm_set1_ps(scale.floorLevel));
+        __m128 r = _mm_and_ps(magnitudeValid, level);
+
+        const __m128 centre = _mm_min_ps(
+            _mm_mul_ps(_mm_set1_ps(binWidth), _mm_add_ps(_mm_set1_ps(static_cast<float>(bin)), lane)),
+            _mm_set1_ps(maxBinFrequency));
+        __m128 frequency = centre;
+        if (frequencies != nullptr) {
+            const __m128 stored = _mm_loadu_ps(frequencies + bin);
+            frequency = select(_mm_cmpgt_ps(stored, zero), stored, centre);
+        }
+        const __m128 frequencyValid = _mm_and_ps(_mm_cmpgt_ps(frequency, zero), isFinite(frequency));
+        const __m128 bounded = _mm_min_ps(_mm_max_ps(frequency, _mm_set1_ps(scale.minFrequency)),
+                                          _mm_set1_ps(scale.maxFrequency));
+        __m128 g = _mm_and_ps(frequencyValid,
+            clampUnit(_mm_mul_ps(_mm_sub_ps(log2Positive(bounded), logMin), logScale)));
+
+        const __m128 phase = _mm_loadu_ps(phases + bin);
+        const __m128 phaseValid = isFinite(phase);
+        __m128 sine;
+        __m128 cosine;
+        sinCos(_mm_and_ps(phaseValid, phase), sine, cosine);
+        __m128 b = select(phaseValid, _mm_add_ps(_mm_mul_ps(cosine, half), half), half);
+        __m128 a = select(phaseValid, _mm_add_ps(_mm_mul_ps(sine, half), half), half);
+
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        float* out = rgba + bin * 4;
+        _mm_storeu_ps(out, r);
+        _mm_storeu_ps(out + 4, g);
+        _mm_storeu_ps(out + 8, b);
+        _mm_storeu_ps(out + 12, a);
+    }
+    return bin;
+}
+
+std::size_t decodeColumn(const float* rgba, float* magnitudes, float* phases, float* frequencies,
+                         const std::size_t count, const float binWidth, const float silentLevel,
+                         const float minPhaseVector, const ColumnScale& scale) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+    std::size_t bin = 0;
+    if (Utilities::CPU::hasAVX2()) {
+        bin = ColourColumnAVX2::decodeColumn(rgba, magnitudes, phases, frequencies, count, binWidth,
+                                             silentLevel, minPhaseVector, scale);
+    }
+    for (; bin + 4 <= count; bin += 4) {
+        const float* in = rgba + bin * 4;
+        __m128 r = _mm_loadu_ps(in);
+        __m128 g = _mm_loadu_ps(in + 4);
+        __m128 b = _mm_loadu_ps(in + 8);
+        __m128 a = _mm_loadu_ps(in + 12);
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+
+        const __m128 centre = _mm_mul_ps(_mm_set1_ps(binWidth),
+                                         _mm_add_ps(_mm_set1_ps(static_cast<float>(bin)), lane));
+
+        // NaN channels fail the same checks they fail in the scalar path.
+        const __m128 db = _mm_add_ps(_mm_mul_ps(clampUnit(r), _mm_set1_ps(scale.dbRange)), _mm_set1_ps(scale.dbMin));
+        const __m128 magnitude = exp2Normal(_mm_mul_ps(db, _mm_set1_ps(LOG2_10_OVER_20)));
+        const __m128 valid = _mm_andnot_ps(isNaN(r), _mm_cmpgt_ps(clampUnit(r), _mm_set1_ps(silentLevel)));
+
+        const __m128 cosine = _mm_mul_ps(_mm_sub_ps(clampUnit(b), half), two);
+        const __m128 sine = _mm_mul_ps(_mm_sub_ps(clampUnit(a), half), two);
+        const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(cosine, cosine), _mm_mul_ps(sine, sine)));
+        const __m128 phaseValid = _mm_andnot_ps(_mm_or_ps(isNaN(b), isNaN(a)),
+                                                _mm_cmpgt_ps(length, _mm_set1_ps(minPhaseVector)));
+        const __m128 phase = _mm_and_ps(phaseValid, atan2Approx(sine, cosine));
+
+        const __m128 logValue = _mm_add_ps(_mm_set1_ps(scale.logFrequencyMin),
+                                           _mm_mul_ps(clampUnit(g), _mm_set1_ps(scale.logFrequencyRange)));
+        const __m128 resolved = select(isNaN(g), centre, exp2Normal(logValue));
+
+        _mm_storeu_ps(magnitudes + bin, _mm_and_ps(valid, magnitude));
+        _mm_storeu_ps(phases + bin, _mm_and_ps(valid, phase));
+        _mm_storeu_ps(frequencies + bin, select(valid, resolved, centre));
+    }
+    return bin;
+}
+
+#else
+
+std::size_t encodeColumn(const float*, const float*, const float*, float*, std::size_t, float, float,
+                         const ColumnScale&) {
+    return 0;
+}
+
+std::size_t decodeColumn(const float*, float*, float*, float*, std::size_t, float, float, float,
+                         const ColumnScale&) {
+    return 0;
+}
+
+#endif
+
+}
+
+#endif
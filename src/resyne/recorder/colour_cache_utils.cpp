@@ -30,6 +30,7 @@ SampleColourEntry entryFromColourResult(const ColourCore::FrameResult& colourRes
     entry.labL = colourResult.L;
     entry.labA = colourResult.a;
     entry.labB = colourResult.b_comp;
+    entry.xyz = ColourCore::XYZ{colourResult.X, colourResult.Y, colourResult.Z};
     return entry;
 }
 
@@ -48,9 +49,9 @@ CacheSettings currentSettings(const RecorderState& state) {
     return settings;
 }
 
-SampleColourEntry computeSampleColour(const AudioColourSample& sample,
+SampleColourEntry computeSampleColour(const SpectralFrame& sample,
                                       const CacheSettings& settings,
-                                      const AudioColourSample*) {
+                                      const SpectralFrame*) {
     const float loudnessOverride = std::isfinite(sample.loudnessLUFS)
         ? sample.loudnessLUFS
         : ColourCore::LOUDNESS_DB_UNSPECIFIED;
@@ -61,4 +62,22 @@ SampleColourEntry computeSampleColour(const AudioColourSample& sample,
     return entryFromColourResult(colourResult);
 }
 
+SampleColourEntry computeSampleColour(SpectralPresentation::FrameWorkspace& workspace,
+                                      SpectralPresentation::PreparedFrame& prepared,
+                                      const SpectralFrame& sample,
+                                      const CacheSettings& settings) {
+    const float loudnessOverride = std::isfinite(sample.loudnessLUFS)
+        ? sample.loudnessLUFS
+        : ColourCore::LOUDNESS_DB_UNSPECIFIED;
+    SpectralPresentation::prepareFrame(
+        workspace,
+        SpectralPresentation::SampleSequence::buildFrame(workspace, sample),
+        buildPresentationSettings(settings),
+        loudnessOverride,
+        nullptr,
+        0.0f,
+        prepared);
+    return entryFromColourResult(prepared.colourResult);
+}
+
 }
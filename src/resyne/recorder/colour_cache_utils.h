@@ -1,5 +1,6 @@
 #pragma once
 
+#include "audio/analysis/presentation/spectral_presentation.h"
 #include "resyne/recorder/recorder.h"
 
 namespace ReSyne::RecorderColourCache {
@@ -17,8 +18,15 @@ struct CacheSettings {
 
 CacheSettings currentSettings(const RecorderState& state);
 
-SampleColourEntry computeSampleColour(const AudioColourSample& sample,
+SampleColourEntry computeSampleColour(const SpectralFrame& sample,
     const CacheSettings& settings,
-    const AudioColourSample* previousSample = nullptr);
+    const SpectralFrame* previousSample = nullptr);
+
+// As above, mixing and analysing into workspace and prepared, so a caller that keeps them
+// across frames allocates nothing once they have grown.
+SampleColourEntry computeSampleColour(SpectralPresentation::FrameWorkspace& workspace,
+    SpectralPresentation::PreparedFrame& prepared,
+    const SpectralFrame& sample,
+    const CacheSettings& settings);
 
 }
@@ -1,8 +1,12 @@
 #include "resyne/recorder/recorder.h"
+#include "resyne/recorder/spectral_journal.h"
 
 #include <utility>
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <system_error>
 
 #ifdef __clang__
 #pragma clang diagnostic push
@@ -15,51 +19,117 @@
 #endif
 
 #include "resyne/encoding/formats/format_mp4.h"
+#include "resyne/encoding/formats/mp4_libav_writer.h"
 #include "utilities/video/ffmpeg_locator.h"
 
 namespace ReSyne {
 
+namespace {
+
+ReSyne::Encoding::Video::ExportOptions mp4ExportOptions(const RecorderState& state) {
+    ReSyne::Encoding::Video::ExportOptions options;
+    options.ffmpegExecutable = Utilities::Video::FFmpegLocator::instance().executablePath();
+    options.colourSpace = state.videoColourSpace;
+    options.applyGamutMapping = state.videoGamutMapping;
+    options.smoothingAmount = state.videoSmoothingAmount;
+    options.width = state.videoWidth;
+    options.height = state.videoHeight;
+    options.frameRate = state.videoFrameRate;
+    options.exportGradient = state.exportGradient;
+    return options;
+}
+
+const char* exportExtension(const RecorderExportFormat format) {
+    switch (format) {
+        case RecorderExportFormat::RSYN:
+            return ".rsyn";
+        case RecorderExportFormat::TIFF:
+            return ".tiff";
+        case RecorderExportFormat::MP4:
+            return ".mp4";
+        case RecorderExportFormat::WAV:
+        default:
+            return ".wav";
+    }
+}
+
+// A save over the loaded project only appends; compacting it afterwards moves every chunk.
+// That waits until nothing reads the project lazily any more, with its spectra all decoded
+// and its source, if it has one, in memory, so otherwise the dead space stays for a later
+// save. metadata shares the loaded project's asset, whose index then follows the move.
+void compactSavedRsyn(AudioMetadata& metadata, const bool hydrating, const std::string& filepath) {
+    const auto& asset = metadata.lazyAsset;
+    std::error_code ec;
+    if (asset != nullptr && std::filesystem::equivalent(asset->filepath, filepath, ec) && !ec) {
+        const bool sourceResident = (metadata.sourceData != nullptr && metadata.sourceData->hasContent()) ||
+            !asset->chunkIndex.contains(RSYNContainer::makeTag("SRCE"));
+        if (hydrating || !sourceResident) {
+            return;
+        }
+    }
+    SequenceExporter::compactRsyn(filepath, metadata);
+}
+
+const char* exportLabel(const RecorderExportFormat format) {
+    switch (format) {
+        case RecorderExportFormat::RSYN:
+            return ".rsyn";
+        case RecorderExportFormat::TIFF:
+            return "TIFF";
+        case RecorderExportFormat::MP4:
+            return "MP4";
+        case RecorderExportFormat::WAV:
+        default:
+            return "WAV";
+    }
+}
+
+}
+
+RSYNExportOptions rsynExportOptions(const RecorderState& state) {
+    RSYNExportOptions options{};
+    options.presentationSettings.colourSpace = state.importColourSpace;
+    options.presentationSettings.applyGamutMapping = state.importGamutMapping;
+    options.presentationSettings.lowGain = state.importLowGain;
+    options.presentationSettings.midGain = state.importMidGain;
+    options.presentationSettings.highGain = state.importHighGain;
+    options.presentationSettings.smoothingEnabled = state.presentationSmoothingEnabled;
+    options.presentationSettings.manualSmoothing = state.presentationManualSmoothing;
+    options.presentationSettings.smoothingAmount = state.presentationSmoothingAmount;
+    return options;
+}
+
 bool Recorder::exportRecording(RecorderState& state,
                                const std::string& filepath,
                                RecorderExportFormat format) {
     ensureRsynSamplesLoaded(state);
+    // Asked before samplesMutex is taken, which the hydration takes after its own lock.
+    const bool hydrating = state.rsynHydration.isRunning();
 
     std::lock_guard<std::mutex> lock(state.samplesMutex);
+    SpectralSequence restored;
+    const auto& samples = RecorderJournal::restoredSamples(state, restored);
 
     switch (format) {
         case RecorderExportFormat::WAV:
-            return SequenceExporter::exportToWAV(filepath, state.samples, state.metadata);
-        case RecorderExportFormat::RSYN: {
-            RSYNExportOptions options{};
-            options.presentationSettings.colourSpace = state.importColourSpace;
-            options.presentationSettings.applyGamutMapping = state.importGamutMapping;
-            options.presentationSettings.lowGain = state.importLowGain;
-            options.presentationSettings.midGain = state.importMidGain;
-            options.presentationSettings.highGain = state.importHighGain;
-            options.presentationSettings.smoothingEnabled = state.presentationSmoothingEnabled;
-            options.presentationSettings.manualSmoothing = state.presentationManualSmoothing;
-            options.presentationSettings.smoothingAmount = state.presentationSmoothingAmount;
-            return SequenceExporter::exportToRsyn(filepath, state.samples, state.metadata, options);
-        }
+            return SequenceExporter::exportToWAV(filepath, samples, state.metadata);
+        case RecorderExportFormat::RSYN:
+            if (!SequenceExporter::exportToRsyn(filepath, samples, state.metadata, rsynExportOptions(state))) {
+                return false;
+            }
+            compactSavedRsyn(state.metadata, hydrating, filepath);
+            return true;
         case RecorderExportFormat::TIFF:
-            return SequenceExporter::exportToTIFF(filepath, state.samples, state.metadata);
+            return SequenceExporter::exportToTIFF(filepath, samples, state.metadata);
         case RecorderExportFormat::MP4: {
             auto& ffmpegLocator = Utilities::Video::FFmpegLocator::instance();
-            if (!ffmpegLocator.isAvailable()) {
+            if (!ffmpegLocator.isAvailable() && !ReSyne::Encoding::Video::LibavMP4Writer::isAvailable()) {
                 return false;
             }
-            ReSyne::Encoding::Video::ExportOptions options;
-            options.ffmpegExecutable = ffmpegLocator.executablePath();
-            options.colourSpace = state.videoColourSpace;
-            options.applyGamutMapping = state.videoGamutMapping;
-            options.smoothingAmount = state.videoSmoothingAmount;
-            options.width = state.videoWidth;
-            options.height = state.videoHeight;
-            options.frameRate = state.videoFrameRate;
-            options.exportGradient = state.exportGradient;
+            const ReSyne::Encoding::Video::ExportOptions options = mp4ExportOptions(state);
             std::string errorMsg;
             return ReSyne::Encoding::Video::exportToMP4(
-                filepath, state.samples, state.metadata, options,
+                filepath, samples, state.metadata, options,
                 nullptr, errorMsg);
         }
         default:
@@ -70,37 +140,34 @@ bool Recorder::exportRecording(RecorderState& state,
 void Recorder::exportRecordingThreaded(RecorderState& state,
                                        std::string filepath,
                                        RecorderExportFormat format) {
-    if (state.exportRunning.load(std::memory_order_acquire)) {
+    if (!state.exportTask.isFinished()) {
         return;
     }
 
-    if (state.exportThread.joinable()) {
-        state.exportThread.join();
-    }
-
-    state.exportRunning.store(true, std::memory_order_release);
-    state.exportComplete.store(false, std::memory_order_release);
-    state.exportProgressAtomic.store(0.0f, std::memory_order_release);
-    state.exportThread = std::thread([&state, filepath = std::move(filepath), format]() {
+    auto exportTask = [&state, filepath = std::move(filepath), format](const Utilities::Threading::TaskContext& context) {
         bool success = false;
         std::string errorMessage;
 
         auto updateProgress = [&](float progress) {
-            state.exportProgressAtomic.store(progress, std::memory_order_release);
+            context.reportProgress(progress);
         };
 
         auto updateStatus = [&](const std::string& status) {
             setExportOperationStatus(state, status);
         };
 
-        std::vector<AudioColourSample> samplesCopy;
+        SpectralSequence samplesCopy;
         AudioMetadata metadataCopy;
+        RecorderJournal::SpilledFrames spilled;
         ensureRsynSamplesLoaded(state);
         {
             std::lock_guard<std::mutex> lock(state.samplesMutex);
             samplesCopy = state.samples;
             metadataCopy = state.metadata;
+            spilled = RecorderJournal::spilledFrames(state);
         }
+        // Spilled frames are read back on this thread, outside samplesMutex.
+        RecorderJournal::restoreSpilledFrames(spilled, samplesCopy);
 
         updateProgress(0.05f);
 
@@ -116,18 +183,11 @@ void Recorder::exportRecordingThreaded(RecorderState& state,
 						[&](float fraction) {
 							const float clamped = std::clamp(fraction, 0.0f, 1.0f);
 							updateProgress(0.1f + clamped * 0.8f);
-						});
+						},
+						context.token());
 					break;
 				case RecorderExportFormat::RSYN: {
-                    RSYNExportOptions options{};
-                    options.presentationSettings.colourSpace = state.importColourSpace;
-                    options.presentationSettings.applyGamutMapping = state.importGamutMapping;
-                    options.presentationSettings.lowGain = state.importLowGain;
-                    options.presentationSettings.midGain = state.importMidGain;
-                    options.presentationSettings.highGain = state.importHighGain;
-                    options.presentationSettings.smoothingEnabled = state.presentationSmoothingEnabled;
-                    options.presentationSettings.manualSmoothing = state.presentationManualSmoothing;
-                    options.presentationSettings.smoothingAmount = state.presentationSmoothingAmount;
+                    const RSYNExportOptions options = rsynExportOptions(state);
 					updateStatus("Encoding spectral data to RSYN format...");
 					updateProgress(0.1f);
 					success = SequenceExporter::exportToRsyn(
@@ -138,7 +198,11 @@ void Recorder::exportRecordingThreaded(RecorderState& state,
 						[&](float fraction) {
 							const float clamped = std::clamp(fraction, 0.0f, 1.0f);
 							updateProgress(0.1f + clamped * 0.8f);
-						});
+						},
+						context.token());
+					if (success) {
+						compactSavedRsyn(metadataCopy, state.rsynHydration.isRunning(), filepath);
+					}
 					break;
                 }
 				case RecorderExportFormat::TIFF:
@@ -151,26 +215,20 @@ void Recorder::exportRecordingThreaded(RecorderState& state,
 						[&](float fraction) {
 							const float clamped = std::clamp(fraction, 0.0f, 1.0f);
 							updateProgress(0.1f + clamped * 0.8f);
-						});
+						},
+						TIFFExportOptions{},
+						context.token());
 					break;
 				case RecorderExportFormat::MP4: {
 					auto& ffmpegLocator = Utilities::Video::FFmpegLocator::instance();
-					if (!ffmpegLocator.isAvailable()) {
+					if (!ffmpegLocator.isAvailable() && !ReSyne::Encoding::Video::LibavMP4Writer::isAvailable()) {
 						errorMessage = "FFmpeg not found";
 						success = false;
 						break;
 					}
 					updateStatus("Preparing video export...");
 					updateProgress(0.02f);
-					ReSyne::Encoding::Video::ExportOptions options;
-					options.ffmpegExecutable = ffmpegLocator.executablePath();
-					options.colourSpace = state.videoColourSpace;
-					options.applyGamutMapping = state.videoGamutMapping;
-					options.smoothingAmount = state.videoSmoothingAmount;
-					options.width = state.videoWidth;
-					options.height = state.videoHeight;
-					options.frameRate = state.videoFrameRate;
-					options.exportGradient = state.exportGradient;
+					const ReSyne::Encoding::Video::ExportOptions options = mp4ExportOptions(state);
 					success = ReSyne::Encoding::Video::exportToMP4(
 						filepath,
 						samplesCopy,
@@ -189,7 +247,8 @@ void Recorder::exportRecordingThreaded(RecorderState& state,
 								updateStatus("Finalising video...");
 							}
 						},
-						errorMessage);
+						errorMessage,
+						context.token());
 					break;
 				}
                 default:
@@ -214,8 +273,9 @@ void Recorder::exportRecordingThreaded(RecorderState& state,
         }
 
         {
+            // The exporting dialog reports a cancelled export itself, so it is not an error.
             std::lock_guard<std::mutex> lock(state.samplesMutex);
-            if (success) {
+            if (success || context.isCancelled()) {
                 state.exportErrorMessage.clear();
             } else {
                 state.exportErrorMessage = errorMessage.empty() ? "Export failed" : errorMessage;
@@ -223,9 +283,154 @@ void Recorder::exportRecordingThreaded(RecorderState& state,
         }
 
         updateProgress(1.0f);
-        state.exportComplete.store(true, std::memory_order_release);
-        state.exportRunning.store(false, std::memory_order_release);
-    });
+    };
+    state.exportTask = Utilities::Threading::TaskScheduler::shared().submit(
+        Utilities::Threading::TaskPriority::Background, std::move(exportTask));
+}
+
+void Recorder::exportRecordingTargetsThreaded(RecorderState& state,
+                                              std::string basePath,
+                                              std::vector<RecorderExportFormat> formats) {
+    if (!state.exportTask.isFinished() || formats.empty()) {
+        return;
+    }
+
+    auto exportTask = [&state, basePath = std::move(basePath), formats = std::move(formats)](
+                          const Utilities::Threading::TaskContext& context) {
+        const auto wants = [&](const RecorderExportFormat format) {
+            return std::find(formats.begin(), formats.end(), format) != formats.end();
+        };
+        const auto pathFor = [&](const RecorderExportFormat format) {
+            return basePath + exportExtension(format);
+        };
+
+        std::string targetList;
+        for (const RecorderExportFormat format : formats) {
+            targetList += (targetList.empty() ? "" : ", ") + std::string(exportLabel(format));
+        }
+        setExportOperationStatus(state, "Exporting " + targetList + "...");
+
+        SpectralSequence samplesCopy;
+        AudioMetadata metadataCopy;
+        RecorderJournal::SpilledFrames spilled;
+        ensureRsynSamplesLoaded(state);
+        {
+            std::lock_guard<std::mutex> lock(state.samplesMutex);
+            samplesCopy = state.samples;
+            metadataCopy = state.metadata;
+            spilled = RecorderJournal::spilledFrames(state);
+        }
+        RecorderJournal::restoreSpilledFrames(spilled, samplesCopy);
+        context.reportProgress(0.05f);
+
+        const RSYNExportOptions rsynOptions = rsynExportOptions(state);
+        ReSyne::Encoding::Video::ExportOptions videoOptions = mp4ExportOptions(state);
+
+        // The WAV and the MP4 are one job, since the video muxes the WAV rather than
+        // reconstructing the audio a second time.
+        enum class Job { Rsyn, Tiff, Audio };
+        std::vector<Job> jobs;
+        if (wants(RecorderExportFormat::RSYN)) {
+            jobs.push_back(Job::Rsyn);
+        }
+        if (wants(RecorderExportFormat::TIFF)) {
+            jobs.push_back(Job::Tiff);
+        }
+        if (wants(RecorderExportFormat::WAV) || wants(RecorderExportFormat::MP4)) {
+            jobs.push_back(Job::Audio);
+        }
+
+        std::vector<std::atomic<float>> jobProgress(jobs.size());
+        std::vector<std::string> errors(jobs.size());
+        const auto report = [&](const std::size_t job, const float fraction) {
+            jobProgress[job].store(std::clamp(fraction, 0.0f, 1.0f), std::memory_order_relaxed);
+            float total = 0.0f;
+            for (const auto& value : jobProgress) {
+                total += value.load(std::memory_order_relaxed);
+            }
+            context.reportProgress(0.05f + 0.9f * total / static_cast<float>(jobs.size()));
+        };
+
+        const auto runAudioJob = [&](const std::function<void(float)>& progress) -> std::string {
+            const bool keepWav = wants(RecorderExportFormat::WAV);
+            const bool video = wants(RecorderExportFormat::MP4);
+            if (keepWav && !SequenceExporter::exportToWAV(
+                    pathFor(RecorderExportFormat::WAV), samplesCopy, metadataCopy,
+                    [&](const float fraction) { progress(video ? fraction * 0.3f : fraction); },
+                    context.token())) {
+                return "WAV";
+            }
+            if (!video) {
+                return {};
+            }
+            if (!Utilities::Video::FFmpegLocator::instance().isAvailable() &&
+                !ReSyne::Encoding::Video::LibavMP4Writer::isAvailable()) {
+                return "MP4 (FFmpeg not found)";
+            }
+            videoOptions.preparedAudioPath = keepWav ? pathFor(RecorderExportFormat::WAV) : std::string{};
+            std::string videoError;
+            if (!ReSyne::Encoding::Video::exportToMP4(
+                    pathFor(RecorderExportFormat::MP4), samplesCopy, metadataCopy, videoOptions,
+                    [&](const float fraction) { progress(keepWav ? 0.3f + fraction * 0.7f : fraction); },
+                    videoError, context.token())) {
+                return videoError.empty() ? "MP4" : "MP4 (" + videoError + ")";
+            }
+            return {};
+        };
+
+        const auto runJob = [&](const std::size_t job) {
+            const std::function<void(float)> progress = [&, job](const float fraction) { report(job, fraction); };
+            try {
+                switch (jobs[job]) {
+                    case Job::Rsyn:
+                        if (!SequenceExporter::exportToRsyn(pathFor(RecorderExportFormat::RSYN), samplesCopy,
+                                                            metadataCopy, rsynOptions, progress, context.token())) {
+                            errors[job] = ".rsyn";
+                        } else {
+                            compactSavedRsyn(metadataCopy, state.rsynHydration.isRunning(),
+                                             pathFor(RecorderExportFormat::RSYN));
+                        }
+                        break;
+                    case Job::Tiff:
+                        if (!SequenceExporter::exportToTIFF(pathFor(RecorderExportFormat::TIFF), samplesCopy,
+                                                            metadataCopy, progress, TIFFExportOptions{},
+                                                            context.token())) {
+                            errors[job] = "TIFF";
+                        }
+                        break;
+                    case Job::Audio:
+                        errors[job] = runAudioJob(progress);
+                        break;
+                }
+            } catch (const std::exception& e) {
+                errors[job] = std::string("Export error: ") + e.what();
+            } catch (...) {
+                errors[job] = "Unknown export error";
+            }
+            report(job, 1.0f);
+        };
+
+        Utilities::Threading::TaskScheduler::shared().parallelFor(
+            jobs.size(), 1, [&](const std::size_t first, const std::size_t end) {
+                for (std::size_t job = first; job < end; ++job) {
+                    runJob(job);
+                }
+            });
+
+        std::string failed;
+        for (const std::string& error : errors) {
+            if (!error.empty()) {
+                failed += (failed.empty() ? "" : ", ") + error;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(state.samplesMutex);
+            state.exportErrorMessage = failed.empty() || context.isCancelled() ? std::string{} : "Failed: " + failed;
+        }
+        context.reportProgress(1.0f);
+    };
+    state.exportTask = Utilities::Threading::TaskScheduler::shared().submit(
+        Utilities::Threading::TaskPriority::Background, std::move(exportTask));
 }
 
 void Recorder::handleLoadDialog(RecorderState& state) {
@@ -264,6 +469,46 @@ void Recorder::handleFileDialog(RecorderState& state) {
     auto now = std::chrono::system_clock::now();
     auto timestamp = std::chrono::system_clock::to_time_t(now);
 
+    if (!state.pendingExportTargets.empty()) {
+        std::vector<RecorderExportFormat> formats = std::move(state.pendingExportTargets);
+        state.pendingExportTargets.clear();
+
+        auto result = pfd::save_file(
+            "Save Recording in Several Formats",
+            "recording_" + std::to_string(timestamp),
+            {"All Files", "*"}
+        ).result();
+        if (result.empty()) {
+            return;
+        }
+
+        // A name typed with one of the extensions would otherwise get a second one.
+        std::string basePath = result;
+        for (const RecorderExportFormat format : formats) {
+            const std::string extension = exportExtension(format);
+            if (basePath.size() > extension.size() &&
+                basePath.compare(basePath.size() - extension.size(), extension.size(), extension) == 0) {
+                basePath.resize(basePath.size() - extension.size());
+                break;
+            }
+        }
+
+        std::string labels;
+        for (const RecorderExportFormat format : formats) {
+            labels += (labels.empty() ? "" : ", ") + std::string(exportLabel(format));
+        }
+        const size_t lastSlash = basePath.find_last_of("/\\");
+        state.pendingExportPath = basePath;
+        state.pendingExportFormat = formats.front();
+        state.showExportingDialog = true;
+        setExportOperationStatus(state, {});
+        state.exportingFilename = (lastSlash != std::string::npos ? basePath.substr(lastSlash + 1) : basePath) +
+                                  " (" + labels + ")";
+
+        exportRecordingTargetsThreaded(state, basePath, std::move(formats));
+        return;
+    }
+
     std::string extension;
     std::string dialogTitle;
     std::string fileFilter;
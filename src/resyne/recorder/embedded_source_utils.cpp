@@ -2,33 +2,81 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <span>
 
 #include "resyne/decoding/audio_decoder.h"
+#include "audio/processing/decimator/decimator.h"
 
 namespace ReSyne::EmbeddedSourceUtils {
 
 namespace {
 
-std::vector<float> buildInterleavedAudio(const AudioDecoding::DecodedAudio& decoded) {
-    if (decoded.channelSamples.empty()) {
-        return {};
+constexpr size_t DECODE_BLOCK_FRAMES = 65536;
+
+// Streams straight into the interleaved layout playback uses, so the track is never also held
+// planar. A track analysed decimated plays decimated, at the rate its frames were analysed at,
+// lined up as the import lined its windows up.
+bool decodeInterleaved(const std::string& path, const int decimation, std::vector<float>& interleaved,
+                       std::string& errorMessage) {
+    const std::unique_ptr<AudioDecoding::StreamingDecoder> decoder =
+        AudioDecoding::openStreamingDecoder(path, errorMessage);
+    if (decoder == nullptr || decoder->channels() == 0) {
+        return false;
+    }
+
+    const size_t channelCount = decoder->channels();
+    const size_t factor = static_cast<size_t>(std::max(1, decimation));
+    // Room for the final, partly filled block too, so a known length never reallocates.
+    if (decoder->totalFrames() > 0) {
+        interleaved.reserve((static_cast<size_t>(decoder->totalFrames()) / factor + DECODE_BLOCK_FRAMES) * channelCount);
     }
 
-    const size_t channelCount = decoded.channelSamples.size();
-    const size_t frameCount = decoded.channelSamples.front().size();
-    std::vector<float> interleaved(frameCount * channelCount, 0.0f);
+    if (factor == 1) {
+        for (;;) {
+            const size_t written = interleaved.size();
+            interleaved.resize(written + DECODE_BLOCK_FRAMES * channelCount);
+            const size_t framesRead = decoder->readFrames(
+                std::span<float>(interleaved.data() + written, DECODE_BLOCK_FRAMES * channelCount));
+            interleaved.resize(written + framesRead * channelCount);
+            if (framesRead == 0) {
+                break;
+            }
+        }
+        return !interleaved.empty();
+    }
 
-    for (size_t channelIndex = 0; channelIndex < channelCount; ++channelIndex) {
-        const auto& channelSamples = decoded.channelSamples[channelIndex];
-        const size_t safeFrameCount = std::min(frameCount, channelSamples.size());
-        for (size_t frameIndex = 0; frameIndex < safeFrameCount; ++frameIndex) {
-            interleaved[frameIndex * channelCount + channelIndex] = channelSamples[frameIndex];
+    std::vector<Decimator> decimators(channelCount, Decimator(decimation, static_cast<float>(decoder->sampleRate())));
+    std::vector<float> block(DECODE_BLOCK_FRAMES * channelCount);
+    size_t delayedOutputs = decimators.front().getLatency();
+    for (bool finished = false; !finished;) {
+        const size_t framesRead = decoder->readFrames(block);
+        finished = framesRead == 0;
+        // Anything non-finite would otherwise ring through the filter for good.
+        std::replace_if(block.begin(), block.begin() + static_cast<std::ptrdiff_t>(framesRead * channelCount),
+                        [](const float sample) { return !std::isfinite(sample); }, 0.0f);
+        const size_t written = interleaved.size();
+        interleaved.resize(written + (framesRead / factor + 1 + decimators.front().getLatency()) * channelCount);
+        size_t produced = 0;
+        for (size_t ch = 0; ch < channelCount; ++ch) {
+            float* const output = interleaved.data() + written + ch;
+            produced = finished ? decimators[ch].flush(output, channelCount)
+                                : decimators[ch].process(block.data() + ch, framesRead, channelCount, output,
+                                                         channelCount);
         }
+        // The first outputs are the filter filling up.
+        const size_t skipped = std::min(delayedOutputs, produced);
+        delayedOutputs -= skipped;
+        const auto tail = interleaved.begin() + static_cast<std::ptrdiff_t>(written);
+        std::copy(tail + static_cast<std::ptrdiff_t>(skipped * channelCount),
+                  tail + static_cast<std::ptrdiff_t>(produced * channelCount), tail);
+        interleaved.resize(written + (produced - skipped) * channelCount);
     }
 
-    return interleaved;
+    return !interleaved.empty();
 }
 
 }
@@ -38,10 +86,15 @@ bool decodeEmbeddedSourceAudio(const AudioMetadata& metadata,
                                std::string& errorMessage) {
     playbackAudio.clear();
 
-    if (metadata.sourceData == nullptr || metadata.sourceData->bytes.empty()) {
+    if (metadata.sourceData == nullptr || !metadata.sourceData->hasContent()) {
         return false;
     }
 
+    // A source still on disk is decoded where it is.
+    if (metadata.sourceData->bytes.empty()) {
+        return decodeInterleaved(metadata.sourceData->path, metadata.analysisDecimation, playbackAudio, errorMessage);
+    }
+
     const std::string extension = metadata.sourceData->extension.empty()
         ? ".bin"
         : metadata.sourceData->extension;
@@ -65,16 +118,10 @@ bool decodeEmbeddedSourceAudio(const AudioMetadata& metadata,
         }
     }
 
-    AudioDecoding::DecodedAudio decoded;
-    const bool decodedOk = AudioDecoding::decodeFile(tempPath.string(), decoded, errorMessage);
+    const bool decodedOk = decodeInterleaved(tempPath.string(), metadata.analysisDecimation, playbackAudio, errorMessage);
     std::error_code removeError;
     std::filesystem::remove(tempPath, removeError);
-    if (!decodedOk) {
-        return false;
-    }
-
-    playbackAudio = buildInterleavedAudio(decoded);
-    return !playbackAudio.empty();
+    return decodedOk;
 }
 
 }
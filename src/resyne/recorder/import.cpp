@@ -36,7 +36,7 @@ std::string extractFilename(const std::string& path) {
 }
 
 void applyImportedSequence(RecorderState& state,
-                           std::vector<AudioColourSample>&& samples,
+                           SpectralSequence&& samples,
                            AudioMetadata metadata) {
     if (metadata.numFrames == 0 && !samples.empty()) {
         metadata.numFrames = samples.size();
@@ -58,7 +58,7 @@ void applyImportedSequence(RecorderState& state,
     state.fallbackHopSize = state.metadata.hopSize;
     state.dropFlashAlpha = 1.0f;
     state.statusMessageTimer = STATUS_MESSAGE_DURATION;
-    state.timelinePreviewCache.clear();
+    state.timelinePreviewCache.reset();
     state.timelinePreviewCacheDirty = true;
 }
 
@@ -84,7 +84,7 @@ bool Recorder::importFromFile(RecorderState& state,
                               bool applyGamutMapping) {
     state.loadingProgress = 0.0f;
 
-    std::vector<AudioColourSample> importedSamples;
+    SpectralSequence importedSamples;
     AudioMetadata metadata{};
     std::string errorMessage;
     std::vector<float> playbackAudio;
@@ -104,7 +104,10 @@ bool Recorder::importFromFile(RecorderState& state,
             true,
             true,
             &playbackAudio,
-            RecorderState::MAX_RECORDING_SAMPLES
+            RecorderState::MAX_RECORDING_SAMPLES,
+            ImportHelpers::DEFAULT_ANALYSIS_FFT_SIZE,
+            {},
+            state.importDecimateHighRates
         );
 	} else if (extension == ".tiff" || extension == ".tif") {
 		state.loadingProgress = 0.05f;
@@ -161,36 +164,43 @@ bool Recorder::importFromFile(RecorderState& state,
 }
 
 void Recorder::importFromFileThreaded(RecorderState& state,
+                                      const Utilities::Threading::TaskContext& context,
                                       std::string filepath,
                                       ColourCore::ColourSpace colourSpace,
                                       bool applyGamutMapping) {
-    state.importRunning.store(true, std::memory_order_release);
-    state.importComplete.store(false, std::memory_order_release);
-    state.loadingProgressAtomic.store(0.0f, std::memory_order_release);
 
-    std::vector<AudioColourSample> samples;
+    SpectralSequence samples;
     AudioMetadata metadata{};
     std::string errorMessage;
     std::vector<float> playbackAudio;
     const auto extension = extractExtension(filepath);
     bool success = false;
 
-    auto updateProgress = [&state](float progress) {
-        state.loadingProgressAtomic.store(progress, std::memory_order_release);
+    auto updateProgress = [&context](float progress) {
+        context.reportProgress(progress);
     };
 
-    auto updatePreview = [&state](const std::vector<AudioColourSample>& samples) {
+    auto updatePreview = [&state](const SpectralSequence& preview) {
         std::lock_guard<std::mutex> lock(state.samplesMutex);
-        state.previewSamples = samples;
+        // A refined coarse preview replaces frames in place rather than appending to them,
+        // and frames replace an embedded preview, neither of which the timeline can tell
+        // from its frame count alone.
+        if ((!state.previewSamples.empty() && preview.size() <= state.previewSamples.size()) ||
+            state.storedPreview != nullptr) {
+            state.timelinePreviewCacheDirty = true;
+        }
+        state.previewSamples = preview;
         state.previewReady.store(true, std::memory_order_release);
     };
-    auto forwardDecodedFrame = [&state](const std::vector<AudioColourSample>& decoded, size_t validCount) {
+    auto forwardDecodedFrame = [&state](const SpectralSequence& decoded, size_t validCount) {
         if (validCount == 0 || decoded.empty()) {
             return;
         }
         const size_t safeCount = std::min(validCount, decoded.size());
         std::lock_guard<std::mutex> lock(state.samplesMutex);
-        state.previewSamples.assign(decoded.begin(), decoded.begin() + static_cast<std::ptrdiff_t>(safeCount));
+        state.previewSamples.clear();
+        state.previewSamples.setSharedFrequencies(decoded.sharedFrequencies());
+        state.previewSamples.append(SpectralSequenceView(decoded, 0, safeCount));
         state.previewReady.store(true, std::memory_order_release);
     };
 
@@ -212,7 +222,10 @@ void Recorder::importFromFileThreaded(RecorderState& state,
             true,
             true,
             &playbackAudio,
-            RecorderState::MAX_RECORDING_SAMPLES
+            RecorderState::MAX_RECORDING_SAMPLES,
+            ImportHelpers::DEFAULT_ANALYSIS_FFT_SIZE,
+            context.token(),
+            state.importDecimateHighRates
         );
 	} else if (extension == ".tiff" || extension == ".tif") {
 		setStatus("Loading TIFF file...");
@@ -223,7 +236,8 @@ void Recorder::importFromFileThreaded(RecorderState& state,
 			[&updateProgress](float p) {
 				updateProgress(0.05f + p * 0.75f);
 			},
-			forwardDecodedFrame);
+			forwardDecodedFrame,
+			context.token());
 		if (!success || (samples.empty() && metadata.presentationData == nullptr)) {
 			errorMessage = "parse failure";
 		} else {
@@ -237,12 +251,23 @@ void Recorder::importFromFileThreaded(RecorderState& state,
             samples, metadata, errorMessage,
             updateProgress,
             updatePreview,
-            nullptr
+            nullptr,
+            [&state](std::shared_ptr<const RSYNPreviewData> preview) {
+                std::lock_guard<std::mutex> lock(state.samplesMutex);
+                state.storedPreview = std::move(preview);
+                state.timelinePreviewCacheDirty = true;
+            }
         );
     } else {
         errorMessage = "unsupported format";
     }
 
+    // Cancelled from the loading dialog, by a newer import or by the recorder going away;
+    // the import handler sees the handle was cancelled and leaves the current track alone.
+    if (context.isCancelled()) {
+        return;
+    }
+
     std::vector<float> resolvedPlaybackAudio;
     bool reconstructionSuccess = false;
 
@@ -257,7 +282,12 @@ void Recorder::importFromFileThreaded(RecorderState& state,
             resolvedPlaybackAudio,
             [&updateProgress](float fraction) {
                 updateProgress(0.85f + std::clamp(fraction, 0.0f, 1.0f) * 0.10f);
-            });
+            },
+            &state.synthesisCache,
+            context.token());
+        if (context.isCancelled()) {
+            return;
+        }
         updateProgress(0.95f);
     } else if (success && !samples.empty() && !shouldReconstructDuringImport) {
         resolvedPlaybackAudio = std::move(playbackAudio);
@@ -293,9 +323,6 @@ void Recorder::importFromFileThreaded(RecorderState& state,
             state.importErrorMessage = errorMessage.empty() ? "unknown error" : errorMessage;
         }
     }
-
-    state.importComplete.store(true, std::memory_order_release);
-    state.importRunning.store(false, std::memory_order_release);
 }
 
 }
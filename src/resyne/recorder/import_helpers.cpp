@@ -1,14 +1,16 @@
 #include "resyne/recorder/import_helpers.h"
-#include "resyne/recorder/recorder.h"
 #include "resyne/decoding/audio_decoder.h"
+#include "resyne/encoding/formats/crc32.h"
 #include "resyne/encoding/formats/exporter.h"
 #include "resyne/recorder/embedded_source_utils.h"
-#include "resyne/recorder/loudness_utils.h"
 #include "audio/analysis/fft/fft_processor.h"
+#include "audio/analysis/fft/stereo_fft_processor.h"
+#include "audio/analysis/loudness/loudness_meter.h"
+#include "audio/processing/decimator/decimator.h"
 #include "colour/colour_core.h"
 #include "constants.h"
-#include "miniz.h"
-#undef crc32
+#include "utilities/threading/task_scheduler.h"
+#include "utilities/tuning/wisdom.h"
 
 #include <algorithm>
 #include <cmath>
@@ -21,89 +23,187 @@
 
 namespace ReSyne::ImportHelpers {
 
-namespace {
+static_assert(DEFAULT_ANALYSIS_FFT_SIZE == FFTProcessor::FFT_SIZE);
 
-bool sanitiseDecodedAudio(AudioDecoding::DecodedAudio& decoded) {
-    bool changed = false;
-    for (auto& channel : decoded.channelSamples) {
-        for (float& sample : channel) {
-            if (!std::isfinite(sample)) {
-                sample = 0.0f;
-                changed = true;
-            }
-        }
-    }
-    return changed;
-}
+namespace {
 
-bool hasUsableFrameLoudness(const AudioColourSample& sample) {
+// Frames per worker segment; a pass covers one segment per worker and bounds the slabs held
+// alongside the growing sample list.
+constexpr size_t ANALYSIS_SEGMENT_FRAMES = 512;
+// Audio frames pulled from the decoder per read.
+constexpr size_t DECODE_BLOCK_FRAMES = 16384;
+// What LoudnessMeter reports before it has completed a block.
+constexpr float NO_BLOCK_LOUDNESS_LUFS = -200.0f;
+// Source bytes hashed per read while fingerprinting the imported file.
+constexpr size_t SOURCE_HASH_BLOCK_BYTES = size_t{1} << 20;
+// Frames in the coarse preview, a little over the widest timeline preview. Files with fewer
+// than COARSE_PREVIEW_MIN_RATIO times as many full-resolution frames skip the coarse pass,
+// since their first few analysis passes cover the timeline about as quickly.
+constexpr size_t COARSE_PREVIEW_FRAMES = 1536;
+constexpr size_t COARSE_PREVIEW_MIN_RATIO = 16;
+
+bool hasUsableFrameLoudness(const SpectralFrameInfo& sample) {
     return std::isfinite(sample.loudnessLUFS) &&
            std::isnormal(sample.loudnessLUFS) &&
            sample.loudnessLUFS > -200.0f &&
            sample.loudnessLUFS < 20.0f;
 }
 
-std::vector<float> buildInterleavedAudio(const AudioDecoding::DecodedAudio& decoded) {
-    if (decoded.channelSamples.empty()) {
-        return {};
+// Records where the source is rather than reading it into memory; a save streams it into the
+// asset from there. The CRC-32 lets that save notice if the file changes in the meantime.
+std::shared_ptr<RSYNSourceData> buildSourceDataFromFile(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open()) {
+        return nullptr;
     }
 
-    const size_t channelCount = decoded.channelSamples.size();
-    const size_t frameCount = decoded.channelSamples.front().size();
-    std::vector<float> interleaved(frameCount * channelCount, 0.0f);
-
-    for (size_t channelIndex = 0; channelIndex < channelCount; ++channelIndex) {
-        const auto& channelSamples = decoded.channelSamples[channelIndex];
-        const size_t safeFrameCount = std::min(frameCount, channelSamples.size());
-        for (size_t frameIndex = 0; frameIndex < safeFrameCount; ++frameIndex) {
-            interleaved[frameIndex * channelCount + channelIndex] = channelSamples[frameIndex];
+    std::vector<std::uint8_t> block(SOURCE_HASH_BLOCK_BYTES);
+    std::uint32_t crc = 0;
+    std::uint64_t size = 0;
+    while (file) {
+        file.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(block.size()));
+        const auto count = static_cast<std::size_t>(file.gcount());
+        if (count > 0) {
+            crc = CRC32::update(crc, block.data(), count);
+            size += count;
         }
     }
+    if (file.bad()) {
+        return nullptr;
+    }
 
-    return interleaved;
+    auto sourceData = std::make_shared<RSYNSourceData>();
+    const std::filesystem::path fsPath(filepath);
+    std::error_code pathError;
+    const std::filesystem::path absolutePath = std::filesystem::absolute(fsPath, pathError);
+    sourceData->filename = fsPath.filename().string();
+    sourceData->extension = fsPath.extension().string();
+    sourceData->crc32 = crc;
+    sourceData->size = size;
+    sourceData->path = pathError ? filepath : absolutePath.string();
+    return sourceData;
 }
 
-bool readFileBytes(const std::string& filepath, std::vector<std::uint8_t>& bytes) {
-    bytes.clear();
-
-    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        return false;
+// Analyses one frame at each of COARSE_PREVIEW_FRAMES points spread across the file, through
+// a second decoder that seeks between them, so the timeline fills in end to end before the
+// full-resolution pass has got far. Each frame analyses the fftSize samples from its point,
+// which lies on a multiple of fftSize. Empty if the format cannot seek. A decimated import
+// decimates each point's window too, reading the filter's delay beyond it.
+SpectralSequence analyseCoarsePreview(const std::string& filepath,
+                                      const FFTProcessor& analyser,
+                                      const int fftSize,
+                                      const uint64_t totalFrames,
+                                      const int decimation,
+                                      const Utilities::Threading::CancellationToken& cancellation) {
+    std::string ignoredError;
+    std::unique_ptr<AudioDecoding::StreamingDecoder> decoder =
+        AudioDecoding::openStreamingDecoder(filepath, ignoredError);
+    if (!decoder || !decoder->seekToFrame(0)) {
+        return {};
     }
 
-    const std::streamsize size = file.tellg();
-    if (size < 0) {
-        return false;
+    const uint32_t numChannels = decoder->channels();
+    const float sourceRate = static_cast<float>(decoder->sampleRate());
+    const float sampleRate = sourceRate / static_cast<float>(decimation);
+    Decimator decimator(decimation, sourceRate);
+    const size_t latency = decimator.getLatency();
+    const size_t windowSize = static_cast<size_t>(fftSize);
+    const size_t sourceFrames = (windowSize + latency) * static_cast<size_t>(decimation);
+    const uint64_t analysedFrames = totalFrames / static_cast<uint64_t>(decimation);
+    const uint64_t windowCount = analysedFrames > latency ? (analysedFrames - latency) / windowSize : 0;
+    if (numChannels == 0 || windowCount == 0) {
+        return {};
     }
 
-    file.seekg(0, std::ios::beg);
-    bytes.resize(static_cast<std::size_t>(size));
-    if (!bytes.empty()) {
-        file.read(reinterpret_cast<char*>(bytes.data()), size);
-        if (!file.good()) {
-            bytes.clear();
-            return false;
+    std::vector<float> block(sourceFrames * numChannels);
+    std::vector<float> sourceChannel(decimation > 1 ? sourceFrames : 0);
+    std::vector<float> decimated(decimation > 1 ? windowSize + latency : 0);
+    std::vector<float> window(windowSize);
+    std::vector<float> pairedWindow(windowSize);
+    FFTProcessor::SignalFrames frames;
+    FFTProcessor::SignalFrames pairedFrames;
+    const size_t binCount = windowSize / 2 + 1;
+    SpectralSequence preview(numChannels, binCount);
+    preview.reserve(COARSE_PREVIEW_FRAMES);
+    const uint64_t pointCount = std::min<uint64_t>(COARSE_PREVIEW_FRAMES, windowCount);
+    for (uint64_t point = 0; point < pointCount; ++point) {
+        if (cancellation.isCancelled()) {
+            return {};
+        }
+        const uint64_t windowIndex = windowCount * point / pointCount;
+        const uint64_t start = windowIndex * windowSize;
+        if (!decoder->seekToFrame(start * static_cast<uint64_t>(decimation))) {
+            return {};
+        }
+        const size_t framesRead = decoder->readFrames(block);
+        if (framesRead < sourceFrames) {
+            break;
         }
-    }
 
-    return true;
+        SpectralFrameInfo info{};
+        info.channels = numChannels;
+        info.sampleRate = sampleRate;
+        info.timestamp = static_cast<double>(start) / static_cast<double>(sampleRate);
+        info.loudnessLUFS = ColourCore::LOUDNESS_DB_UNSPECIFIED;
+        info.splDb = std::numeric_limits<float>::quiet_NaN();
+        const size_t stored = preview.appendFrame(info, numChannels, binCount);
+        const auto channelWindow = [&](const uint32_t ch, std::vector<float>& output) {
+            float* const sanitised = decimation > 1 ? sourceChannel.data() : output.data();
+            for (size_t frame = 0; frame < sourceFrames; ++frame) {
+                const float value = block[frame * numChannels + ch];
+                sanitised[frame] = std::isfinite(value) ? value : 0.0f;
+            }
+            if (decimation > 1) {
+                decimator.reset();
+                decimator.process(sourceChannel.data(), sourceFrames, 1, decimated.data());
+                std::copy_n(decimated.begin() + static_cast<std::ptrdiff_t>(latency), windowSize, output.begin());
+            }
+        };
+        const auto storeChannel = [&](const uint32_t ch, const FFTProcessor::SignalFrames& analysed) {
+            const auto magnitudes = analysed.frameMagnitudes(0);
+            const auto phases = analysed.framePhases(0);
+            std::copy_n(magnitudes.begin(), std::min(magnitudes.size(), binCount), preview.magnitudes(stored, ch).begin());
+            std::copy_n(phases.begin(), std::min(phases.size(), binCount), preview.phases(stored, ch).begin());
+        };
+        const bool analysePairs = numChannels % 2 == 0;
+        for (uint32_t ch = 0; ch < numChannels; ch += analysePairs ? 2 : 1) {
+            channelWindow(ch, window);
+            if (analysePairs) {
+                channelWindow(ch + 1, pairedWindow);
+                StereoFFTProcessor::analyseSignalFrames(analyser, window, pairedWindow, static_cast<size_t>(start),
+                                                        sampleRate, fftSize, static_cast<size_t>(windowIndex), 1,
+                                                        frames, pairedFrames);
+                storeChannel(ch, frames);
+                storeChannel(ch + 1, pairedFrames);
+            } else {
+                analyser.analyseSignalFrames(window, static_cast<size_t>(start), sampleRate, fftSize,
+                                             static_cast<size_t>(windowIndex), 1, frames);
+                storeChannel(ch, frames);
+            }
+        }
+    }
+    return preview;
 }
 
-std::shared_ptr<RSYNSourceData> buildSourceDataFromFile(const std::string& filepath) {
-    std::vector<std::uint8_t> bytes;
-    if (!readFileBytes(filepath, bytes)) {
-        return nullptr;
+// The coarse preview with every point the full-resolution frames have reached replaced by
+// the frame nearest it, so the timeline keeps its coarse density while it sharpens.
+void refineCoarsePreview(const SpectralSequence& coarse,
+                         const SpectralSequence& samples,
+                         const size_t hop,
+                         const float sampleRate,
+                         SpectralSequence& preview) {
+    preview.clear();
+    preview.reserve(coarse.size());
+    const double covered = samples.empty() ? -1.0 : samples.frameInfo(samples.size() - 1).timestamp;
+    for (size_t point = 0; point < coarse.size(); ++point) {
+        const double timestamp = coarse.frameInfo(point).timestamp;
+        if (timestamp > covered) {
+            preview.appendFrame(coarse[point]);
+            continue;
+        }
+        const size_t frame = static_cast<size_t>(timestamp * static_cast<double>(sampleRate) / static_cast<double>(hop));
+        preview.appendFrame(samples[std::min(frame, samples.size() - 1)]);
     }
-
-    auto sourceData = std::make_shared<RSYNSourceData>();
-    const std::filesystem::path fsPath(filepath);
-    sourceData->filename = fsPath.filename().string();
-    sourceData->extension = fsPath.extension().string();
-    sourceData->crc32 = bytes.empty()
-        ? 0U
-        : static_cast<std::uint32_t>(mz_crc32(MZ_CRC32_INIT, bytes.data(), bytes.size()));
-    sourceData->bytes = std::move(bytes);
-    return sourceData;
 }
 
 }
@@ -116,7 +216,7 @@ bool importAudioFile(
     float importLowGain,
     float importMidGain,
     float importHighGain,
-    std::vector<AudioColourSample>& samples,
+    SpectralSequence& samples,
     AudioMetadata& metadata,
     std::string& errorMessage,
     const ProgressCallback& onProgress,
@@ -124,7 +224,10 @@ bool importAudioFile(
     const bool enableSmoothing,
     const bool enableMelWeighting,
     std::vector<float>* playbackAudio,
-    const std::size_t maxAnalysisFrames
+    const std::size_t maxAnalysisFrames,
+    const int analysisFftSize,
+    const Utilities::Threading::CancellationToken& cancellation,
+    const bool decimateHighSampleRates
 ) {
     (void)colourSpace;
     (void)applyGamutMapping;
@@ -135,144 +238,328 @@ bool importAudioFile(
         return false;
     }
 
-    AudioDecoding::DecodedAudio decoded;
-    if (!AudioDecoding::decodeFile(filepath, decoded, errorMessage)) {
+    if (!FFTProcessor::isSupportedFFTSize(analysisFftSize)) {
+        errorMessage = "unsupported analysis FFT size " + std::to_string(analysisFftSize);
+        return false;
+    }
+
+    std::unique_ptr<AudioDecoding::StreamingDecoder> decoder =
+        AudioDecoding::openStreamingDecoder(filepath, errorMessage);
+    if (!decoder) {
         return false;
     }
 
     if (onProgress) onProgress(0.2f);
 
-    if (decoded.channelSamples.empty() || decoded.sampleRate == 0) {
+    const uint32_t numChannels = decoder->channels();
+    if (numChannels == 0 || decoder->sampleRate() == 0) {
         errorMessage = "empty audio";
         return false;
     }
 
-    if (sanitiseDecodedAudio(decoded)) {
-        std::cerr << "[Synesthesia] Replaced non-finite decoded audio samples with silence for " << filepath << '\n';
-    }
-
-    if (playbackAudio != nullptr) {
-        *playbackAudio = buildInterleavedAudio(decoded);
-    }
+    const int resolvedHopSize = std::clamp(analysisHopSize, 1, analysisFftSize);
+    const size_t hop = static_cast<size_t>(resolvedHopSize);
+    const size_t windowSize = static_cast<size_t>(analysisFftSize);
+    const uint64_t expectedFrames = decoder->totalFrames();
+    const float sourceRate = static_cast<float>(decoder->sampleRate());
+    const int decimation = decimateHighSampleRates ? Decimator::factorFor(sourceRate) : 1;
+    // Audio frames the windows will hold, at the rate the frames are analysed at.
+    const uint64_t expectedWindowFrames = expectedFrames / static_cast<uint64_t>(decimation);
 
-    const uint32_t numChannels = static_cast<uint32_t>(decoded.channelSamples.size());
+    auto failFrameLimit = [&]() {
+        samples.clear();
+        metadata = AudioMetadata{};
+        errorMessage =
+            "analysis frame limit exceeded (" + std::to_string(maxAnalysisFrames) + "); "
+            "split the audio file or raise the limit";
+        return false;
+    };
 
-    if (numChannels == 0) {
-        errorMessage = "no channels";
+    // Replaced rather than cleared so a long import hands its memory back straight away.
+    auto failCancelled = [&]() {
+        samples = SpectralSequence{};
+        if (playbackAudio != nullptr) {
+            std::vector<float>().swap(*playbackAudio);
+        }
+        metadata = AudioMetadata{};
+        errorMessage = "cancelled";
         return false;
-    }
+    };
 
-    const int resolvedHopSize = std::clamp(analysisHopSize, 1, FFTProcessor::FFT_SIZE);
+    if (expectedWindowFrames > 0 &&
+        FFTProcessor::countSignalFrames(static_cast<size_t>(expectedWindowFrames), resolvedHopSize) > maxAnalysisFrames) {
+        return failFrameLimit();
+    }
 
-    std::vector<std::unique_ptr<FFTProcessor>> processors;
-    processors.reserve(numChannels);
-    for (uint32_t ch = 0; ch < numChannels; ++ch) {
-        processors.push_back(std::make_unique<FFTProcessor>());
+    // Imported frames carry raw magnitudes; EQ, smoothing and mel weighting only shape the
+    // processed live buffer, so the offline analysis does not need them.
+    (void)importLowGain;
+    (void)importMidGain;
+    (void)importHighGain;
+    (void)enableSmoothing;
+    (void)enableMelWeighting;
+
+    const FFTProcessor analyser(analysisFftSize);
+    const float sampleRate = sourceRate / static_cast<float>(decimation);
+    const size_t workerCount = Utilities::Tuning::analysisWorkerCount();
+    // An even channel count is analysed a pair at a time, each pair through one transform.
+    const bool analysePairs = numChannels % 2 == 0;
+    const uint32_t analysisUnits = analysePairs ? numChannels / 2 : numChannels;
+    const size_t frameWorkersPerUnit = std::max<size_t>(1, workerCount / analysisUnits);
+
+    const size_t binCount = windowSize / 2 + 1;
+    samples.reset(numChannels, binCount);
+    if (expectedWindowFrames > 0) {
+        samples.reserve(FFTProcessor::countSignalFrames(static_cast<size_t>(expectedWindowFrames), resolvedHopSize));
     }
-    for (auto& processor : processors) {
-        processor->setHopSize(resolvedHopSize);
-        processor->setEQGains(importLowGain, importMidGain, importHighGain);
-        processor->setCriticalBandSmoothingEnabled(enableSmoothing);
-        processor->setMelWeightingEnabled(enableMelWeighting);
+    if (playbackAudio != nullptr) {
+        playbackAudio->clear();
+        if (expectedWindowFrames > 0) {
+            playbackAudio->reserve(static_cast<size_t>(expectedWindowFrames) * numChannels);
+        }
     }
 
-    samples.clear();
-    const size_t estimatedFrames = decoded.channelSamples[0].size() / static_cast<size_t>(resolvedHopSize) + 1;
-    samples.reserve(std::min(estimatedFrames, maxAnalysisFrames));
-
-    const float sampleRate = static_cast<float>(decoded.sampleRate);
-    const size_t chunkSize = static_cast<size_t>(resolvedHopSize) * 8;
-    size_t offset = 0;
-    uint64_t frameIndex = 0;
-    bool hitFrameLimit = false;
-
-    auto consumeFrames = [&](std::vector<std::vector<FFTProcessor::FFTFrame>>&& channelFrames) {
-        if (channelFrames.empty() || channelFrames[0].empty()) {
-            return;
+    // Only the decoded samples still needed by upcoming frames are kept: window[ch][0] is
+    // absolute sample windowStart, and each pass trims everything before the next frame's window.
+    // windowFrames counts every sample the windows have been given, decodedFrames every frame
+    // the decoder has; they differ only when decimating.
+    std::vector<std::vector<float>> window(numChannels);
+    size_t windowStart = 0;
+    size_t windowFrames = 0;
+    size_t decodedFrames = 0;
+    size_t nextFrame = 0;
+    bool endOfStream = false;
+    bool replacedNonFinite = false;
+    std::vector<float> decodeBlock(DECODE_BLOCK_FRAMES * numChannels);
+    std::vector<float*> windowTails(numChannels);
+
+    // A decimated import splits each block into sourceBlock and filters it into
+    // decimatedBlock. The first getLatency() outputs are the filter filling up and are dropped,
+    // so window sample n still lines up with source frame n * decimation, and the playback
+    // copy is the decimated signal, at the rate metadata.sampleRate records.
+    std::vector<Decimator> decimators(numChannels, Decimator(decimation, sourceRate));
+    std::vector<std::vector<float>> sourceBlock(decimation > 1 ? numChannels : 0,
+                                                std::vector<float>(DECODE_BLOCK_FRAMES));
+    std::vector<std::vector<float>> decimatedBlock(decimation > 1 ? numChannels : 0,
+                                                   std::vector<float>(DECODE_BLOCK_FRAMES));
+    size_t delayedOutputs = decimators.front().getLatency();
+    const auto appendDecimated = [&](const auto& decimate) {
+        size_t produced = 0;
+        for (uint32_t ch = 0; ch < numChannels; ++ch) {
+            produced = decimate(decimators[ch], ch, decimatedBlock[ch].data());
+        }
+        const size_t skipped = std::min(delayedOutputs, produced);
+        delayedOutputs -= skipped;
+        const size_t appended = produced - skipped;
+        for (uint32_t ch = 0; ch < numChannels; ++ch) {
+            const auto first = decimatedBlock[ch].begin() + static_cast<std::ptrdiff_t>(skipped);
+            window[ch].insert(window[ch].end(), first, first + static_cast<std::ptrdiff_t>(appended));
+        }
+        if (playbackAudio != nullptr) {
+            const size_t written = playbackAudio->size();
+            playbackAudio->resize(written + appended * numChannels);
+            float* const tail = playbackAudio->data() + written;
+            for (size_t frame = 0; frame < appended; ++frame) {
+                for (uint32_t ch = 0; ch < numChannels; ++ch) {
+                    tail[frame * numChannels + ch] = decimatedBlock[ch][skipped + frame];
+                }
+            }
         }
+        return appended;
+    };
 
-        size_t frameCount = channelFrames[0].size();
-        for (uint32_t ch = 1; ch < numChannels && ch < channelFrames.size(); ++ch) {
-            frameCount = std::min(frameCount, channelFrames[ch].size());
+    LoudnessMeter loudnessMeter;
+    // Every 400 ms block the meter has completed, indexed from the start of the file.
+    std::vector<float> blockLoudness;
+    // The lead channel is metered while the newest samples are still in cache, and the blocks
+    // it completes are kept for the frames analysed later to look theirs up.
+    const auto meterAppended = [&](const size_t appended) {
+        loudnessMeter.processSamples(
+            std::span<const float>(window[0].data() + window[0].size() - appended, appended), sampleRate);
+        for (uint64_t blockIndex = blockLoudness.size(); blockIndex < loudnessMeter.getProcessedBlockCount();
+             ++blockIndex) {
+            float loudness = NO_BLOCK_LOUDNESS_LUFS;
+            loudnessMeter.getBlockLoudness(blockIndex, loudness);
+            blockLoudness.push_back(loudness);
+        }
+        windowFrames += appended;
+    };
+    std::vector<float> passLoudness;
+    std::vector<FFTProcessor::SignalFrames> channelFrames(numChannels);
+    std::vector<std::string> channelErrors(numChannels);
+
+    auto analyseUnit = [&](const uint32_t unit, const size_t passStart, const size_t passFrames) {
+        const uint32_t ch = analysePairs ? unit * 2 : unit;
+        try {
+            if (analysePairs) {
+                StereoFFTProcessor::analyseSignalFrames(analyser, window[ch], window[ch + 1], windowStart, sampleRate,
+                                                        resolvedHopSize, passStart, passFrames, channelFrames[ch],
+                                                        channelFrames[ch + 1]);
+            } else {
+                analyser.analyseSignalFrames(window[ch], windowStart, sampleRate, resolvedHopSize,
+                                             passStart, passFrames, channelFrames[ch], frameWorkersPerUnit);
+            }
+        } catch (const std::exception& e) {
+            channelErrors[ch] = e.what();
         }
+    };
 
-        if (frameCount == 0) {
-            return;
+    SpectralSequence coarsePreview;
+    SpectralSequence refinedPreview;
+    if (onPreview && expectedWindowFrames > 0 &&
+        FFTProcessor::countSignalFrames(static_cast<size_t>(expectedWindowFrames), resolvedHopSize) >=
+            COARSE_PREVIEW_FRAMES * COARSE_PREVIEW_MIN_RATIO) {
+        coarsePreview =
+            analyseCoarsePreview(filepath, analyser, analysisFftSize, expectedFrames, decimation, cancellation);
+        if (!coarsePreview.empty()) {
+            onPreview(coarsePreview);
         }
+    }
 
-        for (size_t f = 0; f < frameCount; ++f) {
-            if (samples.size() >= maxAnalysisFrames) {
-                hitFrameLimit = true;
-                return;
+    // The first pass is a single segment so previews appear as soon as it is decoded; later
+    // passes give every frame worker one segment.
+    size_t passTarget = ANALYSIS_SEGMENT_FRAMES;
+    while (!endOfStream || nextFrame < windowFrames / hop) {
+        while (!endOfStream && windowFrames < (nextFrame + passTarget) * hop) {
+            if (cancellation.isCancelled()) {
+                return failCancelled();
+            }
+            const size_t framesRead = decoder->readFrames(decodeBlock);
+            if (framesRead == 0) {
+                endOfStream = true;
+                if (decimation > 1) {
+                    meterAppended(appendDecimated([](Decimator& decimator, uint32_t, float* output) {
+                        return decimator.flush(output);
+                    }));
+                }
+                break;
             }
-            AudioColourSample sample;
-            sample.magnitudes.resize(numChannels);
-            sample.phases.resize(numChannels);
-            sample.channels = numChannels;
 
-            bool channelsAligned = true;
-            for (uint32_t ch = 0; ch < numChannels; ++ch) {
-                if (channelFrames[ch][f].frameCounter != channelFrames[0][f].frameCounter) {
-                    channelsAligned = false;
-                    break;
+            // Sanitising, the playback copy and the split into channel windows share one pass.
+            const std::span<const float> block(decodeBlock.data(), framesRead * numChannels);
+            if (decimation > 1) {
+                for (uint32_t ch = 0; ch < numChannels; ++ch) {
+                    windowTails[ch] = sourceBlock[ch].data();
                 }
-                sample.magnitudes[ch] = std::move(channelFrames[ch][f].magnitudes);
-                sample.phases[ch] = std::move(channelFrames[ch][f].phases);
-                if (ch == 0) {
-                    sample.sampleRate = channelFrames[ch][f].sampleRate;
-                    sample.loudnessLUFS = channelFrames[ch][f].loudnessLUFS;
-                    sample.splDb = channelFrames[ch][f].loudnessLUFS + synesthesia::constants::REFERENCE_SPL_AT_0_LUFS;
+                if (AudioDecoding::splitSanitisedFrames(block, numChannels, windowTails, nullptr)) {
+                    replacedNonFinite = true;
                 }
+                meterAppended(appendDecimated([&](Decimator& decimator, const uint32_t ch, float* output) {
+                    return decimator.process(sourceBlock[ch].data(), framesRead, 1, output);
+                }));
+                decodedFrames += framesRead;
+                continue;
             }
 
-            if (!channelsAligned) {
-                continue;
+            for (uint32_t ch = 0; ch < numChannels; ++ch) {
+                auto& channel = window[ch];
+                channel.resize(channel.size() + framesRead);
+                windowTails[ch] = channel.data() + channel.size() - framesRead;
             }
+            float* playbackTail = nullptr;
+            if (playbackAudio != nullptr) {
+                playbackAudio->resize(playbackAudio->size() + block.size());
+                playbackTail = playbackAudio->data() + playbackAudio->size() - block.size();
+            }
+            if (AudioDecoding::splitSanitisedFrames(block, numChannels, windowTails, playbackTail)) {
+                replacedNonFinite = true;
+            }
+            meterAppended(framesRead);
+            decodedFrames += framesRead;
+        }
 
-            sample.timestamp = (static_cast<double>(frameIndex) * static_cast<double>(resolvedHopSize)) /
-                               static_cast<double>(decoded.sampleRate);
-            samples.push_back(std::move(sample));
-            ++frameIndex;
+        const size_t readyFrames = windowFrames / hop;
+        const size_t passFrames = std::min(passTarget, readyFrames - nextFrame);
+        if (passFrames == 0) {
+            break;
+        }
+        if (cancellation.isCancelled()) {
+            return failCancelled();
+        }
+        if (samples.size() + passFrames > maxAnalysisFrames) {
+            return failFrameLimit();
         }
-    };
 
-    while (offset < decoded.channelSamples[0].size()) {
-        size_t chunk = std::min(chunkSize, decoded.channelSamples[0].size() - offset);
+        // A frame's loudness is the momentary loudness at its end: the last block finished by
+        // then, which was decoded, and so metered, before the frame was ready.
+        // The meter sizes its blocks for the sample rate once it has been fed.
+        const size_t blockSize = loudnessMeter.getBlockSizeSamples();
+        const size_t blockHop = loudnessMeter.getBlockHopSamples();
+        passLoudness.resize(passFrames);
+        for (size_t f = 0; f < passFrames; ++f) {
+            const size_t frameEnd = (nextFrame + f + 1) * hop;
+            passLoudness[f] = frameEnd >= blockSize && !blockLoudness.empty()
+                ? blockLoudness[std::min((frameEnd - blockSize) / blockHop, blockLoudness.size() - 1)]
+                : NO_BLOCK_LOUDNESS_LUFS;
+        }
+
+        // Channels, or channel pairs, are independent, so each is a range on the shared
+        // scheduler, and each splits its frames across the same pool.
+        Utilities::Threading::TaskScheduler::shared().parallelFor(
+            analysisUnits, 1, [&](const size_t firstUnit, const size_t endUnit) {
+                for (size_t unit = firstUnit; unit < endUnit; ++unit) {
+                    analyseUnit(static_cast<uint32_t>(unit), nextFrame, passFrames);
+                }
+            });
 
-        std::vector<std::vector<FFTProcessor::FFTFrame>> channelFrames(numChannels);
         for (uint32_t ch = 0; ch < numChannels; ++ch) {
-            processors[ch]->processBuffer(
-                std::span<const float>(decoded.channelSamples[ch].data() + offset, chunk),
-                sampleRate);
-            channelFrames[ch] = processors[ch]->getBufferedFrames();
+            if (!channelErrors[ch].empty()) {
+                samples.clear();
+                errorMessage = "analysis failed on channel " + std::to_string(ch) + ": " + channelErrors[ch];
+                return false;
+            }
         }
 
-        offset += chunk;
-        consumeFrames(std::move(channelFrames));
-        if (hitFrameLimit) {
-            break;
+        // Every channel slab covers the same frame range, which keeps the merge aligned.
+        for (size_t f = 0; f < passFrames; ++f) {
+            const size_t frameIndex = nextFrame + f;
+            SpectralFrameInfo info{};
+            info.channels = numChannels;
+            info.sampleRate = sampleRate;
+            info.loudnessLUFS = passLoudness[f];
+            info.splDb = info.loudnessLUFS + synesthesia::constants::REFERENCE_SPL_AT_0_LUFS;
+            info.timestamp = (static_cast<double>(frameIndex) * static_cast<double>(resolvedHopSize)) /
+                             static_cast<double>(sampleRate);
+            const size_t frame = samples.appendFrame(info, numChannels, binCount);
+            for (uint32_t ch = 0; ch < numChannels; ++ch) {
+                const auto magnitudes = channelFrames[ch].frameMagnitudes(f);
+                const auto phases = channelFrames[ch].framePhases(f);
+                std::copy_n(magnitudes.begin(), std::min(magnitudes.size(), binCount), samples.magnitudes(frame, ch).begin());
+                std::copy_n(phases.begin(), std::min(phases.size(), binCount), samples.phases(frame, ch).begin());
+            }
+        }
+        nextFrame += passFrames;
+
+        const size_t nextWindowEnd = (nextFrame + 1) * hop;
+        const size_t keepFrom = nextWindowEnd > windowSize ? nextWindowEnd - windowSize : 0;
+        if (keepFrom > windowStart) {
+            const size_t trim = std::min(keepFrom - windowStart, window[0].size());
+            for (auto& channel : window) {
+                channel.erase(channel.begin(), channel.begin() + static_cast<std::ptrdiff_t>(trim));
+            }
+            windowStart += trim;
         }
 
-        const float processProgress = static_cast<float>(offset) / static_cast<float>(decoded.channelSamples[0].size());
-        if (onProgress) onProgress(0.2f + (processProgress * 0.6f));
-
-        if (onPreview && (samples.size() % 500 < chunkSize / static_cast<size_t>(resolvedHopSize) ||
-            offset >= decoded.channelSamples[0].size())) {
+        if (onProgress && expectedFrames > 0) {
+            const float decodeProgress = std::min(
+                1.0f, static_cast<float>(decodedFrames) / static_cast<float>(expectedFrames));
+            onProgress(0.2f + (decodeProgress * 0.6f));
+        }
+        if (onPreview && !coarsePreview.empty()) {
+            refineCoarsePreview(coarsePreview, samples, hop, sampleRate, refinedPreview);
+            onPreview(refinedPreview);
+        } else if (onPreview) {
             onPreview(samples);
         }
+        passTarget = ANALYSIS_SEGMENT_FRAMES * workerCount;
     }
 
-    std::vector<std::vector<FFTProcessor::FFTFrame>> channelFrames(numChannels);
-    for (uint32_t ch = 0; ch < numChannels; ++ch) {
-        channelFrames[ch] = processors[ch]->getBufferedFrames();
+    if (replacedNonFinite) {
+        std::cerr << "[Synesthesia] Replaced non-finite decoded audio samples with silence for " << filepath << '\n';
     }
-    consumeFrames(std::move(channelFrames));
-    if (hitFrameLimit) {
-        samples.clear();
-        metadata = AudioMetadata{};
-        errorMessage =
-            "analysis frame limit exceeded (" + std::to_string(maxAnalysisFrames) + "); "
-            "split the audio file or raise the limit";
+
+    if (decodedFrames == 0) {
+        errorMessage = "empty audio";
         return false;
     }
 
@@ -282,29 +569,33 @@ bool importAudioFile(
     }
 
     metadata.sampleRate = sampleRate;
-    metadata.fftSize = FFTProcessor::FFT_SIZE;
+    metadata.analysisDecimation = decimation;
+    metadata.fftSize = analysisFftSize;
     metadata.hopSize = resolvedHopSize;
-    metadata.durationSeconds = decoded.channelSamples[0].empty()
-        ? 0.0
-        : static_cast<double>(decoded.channelSamples[0].size()) / static_cast<double>(decoded.sampleRate);
+    metadata.durationSeconds = static_cast<double>(decodedFrames) / static_cast<double>(decoder->sampleRate());
     metadata.windowType = "hann";
     metadata.numFrames = samples.size();
-    metadata.numBins = static_cast<size_t>(FFTProcessor::FFT_SIZE / 2 + 1);
+    metadata.numBins = binCount;
     metadata.channels = numChannels;
     metadata.version = "3.0.0";
     metadata.sourceData = buildSourceDataFromFile(filepath);
     metadata.presentationData.reset();
     metadata.lazyAsset.reset();
 
-    const bool needsLoudnessBackfill = std::any_of(
-        samples.begin(),
-        samples.end(),
-        [](const AudioColourSample& sample) {
-            return !hasUsableFrameLoudness(sample);
-        });
-
-    if (needsLoudnessBackfill) {
-        ReSyne::LoudnessUtils::calculateLoudnessFromSpectralFrames(samples, metadata);
+    // Frames ending before the first block take it as the nearest one measured. Any frame still
+    // without a usable level, in silence or in audio shorter than one block, is unspecified.
+    const float leadInLoudness = blockLoudness.empty() ? NO_BLOCK_LOUDNESS_LUFS : blockLoudness.front();
+    const size_t blockSize = loudnessMeter.getBlockSizeSamples();
+    for (size_t frameIndex = 0; frameIndex < samples.size(); ++frameIndex) {
+        SpectralFrameInfo& sample = samples.frameInfo(frameIndex);
+        if ((frameIndex + 1) * hop < blockSize) {
+            sample.loudnessLUFS = leadInLoudness;
+            sample.splDb = sample.loudnessLUFS + synesthesia::constants::REFERENCE_SPL_AT_0_LUFS;
+        }
+        if (!hasUsableFrameLoudness(sample)) {
+            sample.loudnessLUFS = ColourCore::LOUDNESS_DB_UNSPECIFIED;
+            sample.splDb = std::numeric_limits<float>::quiet_NaN();
+        }
     }
 
     return true;
@@ -318,12 +609,13 @@ bool importRsynFile(
     float importLowGain,
     float importMidGain,
     float importHighGain,
-    std::vector<AudioColourSample>& samples,
+    SpectralSequence& samples,
     AudioMetadata& metadata,
     std::string& errorMessage,
     const ProgressCallback& onProgress,
     const PreviewCallback& onPreview,
-    std::vector<float>* playbackAudio
+    std::vector<float>* playbackAudio,
+    const RSYNPreviewCallback& onStoredPreview
 ) {
     (void)colourSpace;
     (void)applyGamutMapping;
@@ -341,17 +633,19 @@ bool importRsynFile(
 
     SequenceFrameCallback frameCallback;
     if (onPreview) {
-        frameCallback = [onPreview](const std::vector<AudioColourSample>& decoded, size_t validCount) {
+        frameCallback = [onPreview](const SpectralSequence& decoded, size_t validCount) {
             if (validCount == 0 || decoded.empty()) {
                 return;
             }
             const size_t safeCount = std::min(validCount, decoded.size());
-            std::vector<AudioColourSample> preview(decoded.begin(), decoded.begin() + static_cast<std::vector<AudioColourSample>::difference_type>(safeCount));
+            SpectralSequence preview;
+            preview.setSharedFrequencies(decoded.sharedFrequencies());
+            preview.append(SpectralSequenceView(decoded, 0, safeCount));
             onPreview(preview);
         };
     }
 
-    if (!SequenceExporter::loadFromRsynShell(filepath, metadata, fileProgress)) {
+    if (!SequenceExporter::loadFromRsynShell(filepath, metadata, fileProgress, onStoredPreview)) {
         errorMessage = "parse failure";
         return false;
     }
@@ -16,10 +16,16 @@ using ProgressCallback = std::function<void(float)>;
 
 using StatusCallback = std::function<void(const std::string&)>;
 
-using PreviewCallback = std::function<void(const std::vector<AudioColourSample>&)>;
+using PreviewCallback = std::function<void(const SpectralSequence&)>;
 
 inline constexpr std::size_t DEFAULT_MAX_ANALYSIS_FRAMES = 100000;
+inline constexpr int DEFAULT_ANALYSIS_FFT_SIZE = 2048;
 
+// Checks cancellation between decoded blocks and analysis passes; once it is set the decoder
+// and everything analysed so far are released and the import fails as "cancelled".
+// decimateHighSampleRates brings audio at 88.2 kHz and above down to 44.1 or 48 kHz before
+// analysis (see Decimator), so the bins cover only what the analysis keeps and each is finer;
+// metadata then records the decimated rate and the factor, and playbackAudio is decimated too.
 bool importAudioFile(
     const std::string& filepath,
     ColourCore::ColourSpace colourSpace,
@@ -28,7 +34,7 @@ bool importAudioFile(
     float importLowGain,
     float importMidGain,
     float importHighGain,
-    std::vector<AudioColourSample>& samples,
+    SpectralSequence& samples,
     AudioMetadata& metadata,
     std::string& errorMessage,
     const ProgressCallback& onProgress = nullptr,
@@ -36,7 +42,10 @@ bool importAudioFile(
     bool enableSmoothing = true,
     bool enableMelWeighting = true,
     std::vector<float>* playbackAudio = nullptr,
-    std::size_t maxAnalysisFrames = DEFAULT_MAX_ANALYSIS_FRAMES
+    std::size_t maxAnalysisFrames = DEFAULT_MAX_ANALYSIS_FRAMES,
+    int analysisFftSize = DEFAULT_ANALYSIS_FFT_SIZE,
+    const Utilities::Threading::CancellationToken& cancellation = {},
+    bool decimateHighSampleRates = false
 );
 
 bool importRsynFile(
@@ -47,12 +56,13 @@ bool importRsynFile(
     float importLowGain,
     float importMidGain,
     float importHighGain,
-    std::vector<AudioColourSample>& samples,
+    SpectralSequence& samples,
     AudioMetadata& metadata,
     std::string& errorMessage,
     const ProgressCallback& onProgress = nullptr,
     const PreviewCallback& onPreview = nullptr,
-    std::vector<float>* playbackAudio = nullptr
+    std::vector<float>* playbackAudio = nullptr,
+    const RSYNPreviewCallback& onStoredPreview = nullptr
 );
 
 }
@@ -0,0 +1,182 @@
+#include "resyne/recorder/import_queue.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "audio/analysis/fft/fft_processor.h"
+#include "resyne/decoding/audio_decoder.h"
+#include "resyne/recorder/import_helpers.h"
+#include "resyne/recorder/recorder.h"
+
+namespace ReSyne {
+
+namespace {
+
+constexpr float NEUTRAL_EQ_GAIN = 1.0f;
+// Decoder, analysis buffers and the RSYN encoder's scratch, whatever the file's length.
+constexpr std::uint64_t kFixedCostBytes = std::uint64_t{64} << 20;
+
+// The analysed frames twice over: once as samples and once while the encoder packs them.
+std::uint64_t estimateCost(const std::string& filepath) {
+    std::string errorMessage;
+    const auto decoder = AudioDecoding::openStreamingDecoder(filepath, errorMessage);
+    if (!decoder || decoder->channels() == 0 || decoder->totalFrames() == 0) {
+        return kFixedCostBytes;
+    }
+    const std::size_t frames = std::min(
+        FFTProcessor::countSignalFrames(static_cast<std::size_t>(decoder->totalFrames()), FFTProcessor::HOP_SIZE),
+        RecorderState::MAX_RECORDING_SAMPLES);
+    const std::size_t bins = static_cast<std::size_t>(ImportHelpers::DEFAULT_ANALYSIS_FFT_SIZE / 2 + 1);
+    const std::uint64_t bytesPerFrame =
+        sizeof(SpectralFrameInfo) + decoder->channels() * 2 * bins * sizeof(float);
+    return kFixedCostBytes + 2 * frames * bytesPerFrame;
+}
+
+}
+
+ImportQueue::ImportQueue(const std::size_t maxConcurrent, const std::uint64_t memoryBudgetBytes)
+    : concurrency(std::max<std::size_t>(1, maxConcurrent)),
+      budgetBytes(memoryBudgetBytes) {}
+
+ImportQueue::~ImportQueue() {
+    cancel();
+}
+
+bool ImportQueue::accepts(const std::string& filepath) {
+    std::string extension = std::filesystem::path(filepath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return extension == ".wav" || extension == ".flac" || extension == ".mp3" || extension == ".mpeg3" ||
+           extension == ".mpga" || extension == ".ogg" || extension == ".oga";
+}
+
+void ImportQueue::enqueue(std::string filepath, const Settings& settings) {
+    if (!counts.active()) {
+        counts = Progress{};
+    }
+    waiting.push_back(Pending{std::move(filepath), settings, 0});
+    ++counts.waiting;
+}
+
+const ImportQueue::Progress& ImportQueue::pump() {
+    for (auto it = running.begin(); it != running.end();) {
+        if (!it->task.isFinished()) {
+            ++it;
+            continue;
+        }
+        reserved -= std::min(reserved, it->cost);
+        --counts.running;
+        if (it->outcome->saved) {
+            ++counts.saved;
+        } else {
+            ++counts.failed;
+            if (counts.firstError.empty()) {
+                const std::string name = std::filesystem::path(it->sourcePath).filename().string();
+                counts.firstError = name + (it->outcome->error.empty() ? "" : ": " + it->outcome->error);
+            }
+        }
+        it = running.erase(it);
+    }
+
+    while (!waiting.empty() && running.size() < concurrency) {
+        Pending& next = waiting.front();
+        if (next.cost == 0) {
+            next.cost = estimateCost(next.path);
+        }
+        if (!running.empty() && reserved + next.cost > budgetBytes) {
+            break;
+        }
+        Pending job = std::move(next);
+        waiting.pop_front();
+        --counts.waiting;
+        start(std::move(job));
+    }
+    return counts;
+}
+
+void ImportQueue::cancel() {
+    for (Running& job : running) {
+        job.task.cancel();
+    }
+    for (Running& job : running) {
+        job.task.wait();
+    }
+    counts.waiting = 0;
+    counts.running = 0;
+    waiting.clear();
+    running.clear();
+    reserved = 0;
+}
+
+// Beside the source, numbered rather than overwriting an .rsyn already there or one another
+// running file will write.
+std::string ImportQueue::chooseOutputPath(const std::string& sourcePath) const {
+    const std::filesystem::path source(sourcePath);
+    const auto taken = [&](const std::filesystem::path& candidate) {
+        std::error_code error;
+        return std::filesystem::exists(candidate, error) ||
+               std::any_of(running.begin(), running.end(), [&](const Running& job) {
+                   return job.outputPath == candidate.string();
+               });
+    };
+    std::filesystem::path candidate = source;
+    candidate.replace_extension(".rsyn");
+    for (int suffix = 2; taken(candidate); ++suffix) {
+        candidate = source.parent_path() / (source.stem().string() + " (" + std::to_string(suffix) + ").rsyn");
+    }
+    return candidate.string();
+}
+
+void ImportQueue::start(Pending job) {
+    Running entry;
+    entry.outcome = std::make_shared<Outcome>();
+    entry.sourcePath = job.path;
+    entry.outputPath = chooseOutputPath(job.path);
+    entry.cost = job.cost;
+    entry.task = Utilities::Threading::TaskScheduler::shared().submit(
+        Utilities::Threading::TaskPriority::Background,
+        [outcome = entry.outcome, source = job.path, output = entry.outputPath,
+         settings = std::move(job.settings)](const Utilities::Threading::TaskContext& context) {
+            SpectralSequence samples;
+            AudioMetadata metadata{};
+            const bool imported = ImportHelpers::importAudioFile(
+                source, settings.colourSpace, settings.applyGamutMapping,
+                FFTProcessor::HOP_SIZE,
+                NEUTRAL_EQ_GAIN, NEUTRAL_EQ_GAIN, NEUTRAL_EQ_GAIN,
+                samples, metadata, outcome->error,
+                [&context](float progress) { context.reportProgress(progress * 0.8f); },
+                nullptr,
+                true,
+                true,
+                nullptr,
+                RecorderState::MAX_RECORDING_SAMPLES,
+                ImportHelpers::DEFAULT_ANALYSIS_FFT_SIZE,
+                context.token(),
+                settings.decimateHighSampleRates);
+            if (!imported || samples.empty()) {
+                if (outcome->error.empty()) {
+                    outcome->error = "parse failure";
+                }
+                return;
+            }
+            outcome->saved = SequenceExporter::exportToRsyn(
+                output, samples, metadata, settings.exportOptions,
+                [&context](float progress) { context.reportProgress(0.8f + progress * 0.2f); },
+                context.token());
+            if (!outcome->saved) {
+                outcome->error = context.isCancelled() ? "cancelled" : "could not write " +
+                    std::filesystem::path(output).filename().string();
+            } else {
+                // Freshly imported, so nothing reads the output lazily.
+                SequenceExporter::compactRsyn(output, metadata);
+            }
+        });
+    ++counts.running;
+    running.push_back(std::move(entry));
+}
+
+}
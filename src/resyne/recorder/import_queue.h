@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "colour/colour_core.h"
+#include "resyne/encoding/formats/exporter.h"
+#include "utilities/threading/task_scheduler.h"
+
+namespace ReSyne {
+
+// Audio files dropped alongside the one opened on the timeline. Each is analysed on the shared
+// scheduler and saved beside its source as .rsyn, never touching the loaded track. At most
+// maxConcurrent run at once, and a file starts only while its estimated memory fits beside
+// those running; one costing more than the whole budget starts once nothing else runs.
+// Owned and pumped by the UI thread; the tasks only write their own outcome.
+class ImportQueue {
+public:
+    struct Settings {
+        ColourCore::ColourSpace colourSpace = ColourCore::ColourSpace::Rec2020;
+        bool applyGamutMapping = true;
+        RSYNExportOptions exportOptions{};
+        bool decimateHighSampleRates = false;
+    };
+
+    // Counts for the files enqueued since the queue was last idle.
+    struct Progress {
+        std::size_t waiting = 0;
+        std::size_t running = 0;
+        std::size_t saved = 0;
+        std::size_t failed = 0;
+        // The first failure, for the status line.
+        std::string firstError;
+
+        bool active() const { return waiting + running > 0; }
+    };
+
+    explicit ImportQueue(std::size_t maxConcurrent = 2, std::uint64_t memoryBudgetBytes = std::uint64_t{1} << 30);
+    ~ImportQueue();
+
+    ImportQueue(const ImportQueue&) = delete;
+    ImportQueue& operator=(const ImportQueue&) = delete;
+
+    static bool accepts(const std::string& filepath);
+
+    void enqueue(std::string filepath, const Settings& settings);
+    // Collects finished files and starts whatever now fits. Runs once a frame.
+    const Progress& pump();
+    const Progress& progress() const { return counts; }
+    void cancel();
+
+private:
+    struct Outcome {
+        bool saved = false;
+        std::string error;
+    };
+
+    struct Pending {
+        std::string path;
+        Settings settings;
+        std::uint64_t cost = 0;
+    };
+
+    struct Running {
+        Utilities::Threading::TaskHandle task;
+        std::shared_ptr<Outcome> outcome;
+        std::string sourcePath;
+        std::string outputPath;
+        std::uint64_t cost = 0;
+    };
+
+    std::string chooseOutputPath(const std::string& sourcePath) const;
+    void start(Pending job);
+
+    const std::size_t concurrency;
+    const std::uint64_t budgetBytes;
+    std::deque<Pending> waiting;
+    std::vector<Running> running;
+    std::uint64_t reserved = 0;
+    Progress counts;
+};
+
+}
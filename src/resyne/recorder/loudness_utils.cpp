@@ -3,12 +3,14 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <span>
 
 #include "audio/analysis/fft/fft_processor.h"
 #include "audio/analysis/loudness/loudness_meter.h"
 #include "colour/colour_core.h"
 #include "constants.h"
 #include "resyne/encoding/audio/wav_encoder.h"
+#include "resyne/encoding/formats/spectral_sequence.h"
 
 namespace ReSyne::LoudnessUtils {
 
@@ -31,30 +33,39 @@ float meanSquareToLoudness(const float meanSquare) {
 	return BS1770_LUFS_OFFSET + 10.0f * std::log10(meanSquare);
 }
 
-std::vector<std::vector<float>> deinterleaveChannels(const std::vector<float>& interleavedSamples,
-													  const size_t numChannels) {
-	std::vector<std::vector<float>> channels(numChannels);
-	if (numChannels == 0) {
-		return channels;
+// Feeds the meters a second at a time and reads each block back before their bounded
+// histories let it go. blocks[ch] follows meters[ch], which meters channel ch of the
+// interleaved samples.
+std::vector<std::vector<float>> measureBlockLoudness(const std::span<LoudnessMeter> meters,
+													 const std::span<const float> interleaved,
+													 const float sampleRate) {
+	std::vector<std::vector<float>> blocks(meters.size());
+	if (meters.empty()) {
+		return blocks;
 	}
 
-	const size_t frames = interleavedSamples.size() / numChannels;
-	for (auto& channel : channels) {
-		channel.resize(frames, 0.0f);
-	}
-
-	for (size_t frame = 0; frame < frames; ++frame) {
-		for (size_t ch = 0; ch < numChannels; ++ch) {
-			channels[ch][frame] = interleavedSamples[frame * numChannels + ch];
+	const size_t pieceSize = std::max<size_t>(1, static_cast<size_t>(sampleRate)) * meters.size();
+	for (size_t offset = 0; offset < interleaved.size(); offset += pieceSize) {
+		const auto piece = interleaved.subspan(offset, std::min(pieceSize, interleaved.size() - offset));
+		if (meters.size() == 1) {
+			meters[0].processSamples(piece, sampleRate);
+		} else {
+			LoudnessMeter::processInterleaved(meters, piece, sampleRate);
+		}
+		for (size_t ch = 0; ch < meters.size(); ++ch) {
+			for (uint64_t blockIndex = blocks[ch].size(); blockIndex < meters[ch].getProcessedBlockCount(); ++blockIndex) {
+				float loudness = INVALID_LOUDNESS_LUFS;
+				meters[ch].getBlockLoudness(blockIndex, loudness);
+				blocks[ch].push_back(loudness);
+			}
 		}
 	}
-
-	return channels;
+	return blocks;
 }
 
 }
 
-void calculateLoudnessFromSpectralFrames(std::vector<AudioColourSample>& samples,
+void calculateLoudnessFromSpectralFrames(SpectralSequence& samples,
 										  const AudioMetadata& metadata) {
 	if (samples.empty() || metadata.sampleRate <= 0.0f) {
 		return;
@@ -63,39 +74,12 @@ void calculateLoudnessFromSpectralFrames(std::vector<AudioColourSample>& samples
 	const int fftSize = metadata.fftSize > 0 ? metadata.fftSize : FFTProcessor::FFT_SIZE;
 	const int hopSize = metadata.hopSize > 0 ? metadata.hopSize : (fftSize / 2);
 
-	const uint32_t numChannels = !samples.empty() ? samples.front().channels : 1;
-
-	std::vector<SpectralSample> spectralSamples;
-	spectralSamples.reserve(samples.size());
-
-	for (const auto& sample : samples) {
-		SpectralSample spectral;
-		spectral.timestamp = sample.timestamp;
-		spectral.sampleRate = sample.sampleRate > 0.0f ? sample.sampleRate : metadata.sampleRate;
-		spectral.magnitudes.resize(numChannels);
-		spectral.phases.resize(numChannels);
-		spectral.frequencies.resize(numChannels);
-
-		for (uint32_t ch = 0; ch < numChannels; ++ch) {
-			if (ch < sample.magnitudes.size()) {
-				spectral.magnitudes[ch] = sample.magnitudes[ch];
-			}
-			if (ch < sample.phases.size()) {
-				spectral.phases[ch] = sample.phases[ch];
-			}
-			if (ch < sample.frequencies.size()) {
-				spectral.frequencies[ch] = sample.frequencies[ch];
-			}
-		}
-
-		spectralSamples.push_back(std::move(spectral));
-	}
-
-	const auto reconstructionResult = WAVEncoder::reconstructFromSpectralData(
-		spectralSamples, metadata.sampleRate, fftSize, hopSize);
+	const auto reconstructionResult = WAVEncoder::reconstructFromSequence(
+		samples, metadata.sampleRate, fftSize, hopSize);
 
 	if (!reconstructionResult.success || reconstructionResult.audioSamples.empty()) {
-		for (auto& sample : samples) {
+		for (size_t frameIndex = 0; frameIndex < samples.size(); ++frameIndex) {
+			SpectralFrameInfo& sample = samples.frameInfo(frameIndex);
 			if (!std::isfinite(sample.loudnessLUFS)) {
 				sample.loudnessLUFS = ColourCore::LOUDNESS_DB_UNSPECIFIED;
 				sample.splDb = std::numeric_limits<float>::quiet_NaN();
@@ -108,62 +92,35 @@ void calculateLoudnessFromSpectralFrames(std::vector<AudioColourSample>& samples
 	size_t blockHopSamples = 0;
 	size_t blockSizeSamples = 0;
 
-	if (reconstructionResult.numChannels <= 1) {
-		LoudnessMeter loudnessMeter;
-		loudnessMeter.processSamples(reconstructionResult.audioSamples, metadata.sampleRate);
+	std::vector<LoudnessMeter> channelMeters(std::max<size_t>(1, reconstructionResult.numChannels));
+	const auto channelBlocks = measureBlockLoudness(channelMeters, reconstructionResult.audioSamples, metadata.sampleRate);
+	blockHopSamples = channelMeters.front().getBlockHopSamples();
+	blockSizeSamples = channelMeters.front().getBlockSizeSamples();
 
-		const uint64_t processedBlockCount = loudnessMeter.getProcessedBlockCount();
-		blockHopSamples = loudnessMeter.getBlockHopSamples();
-		blockSizeSamples = loudnessMeter.getBlockSizeSamples();
-		blockLoudness.resize(static_cast<size_t>(processedBlockCount), INVALID_LOUDNESS_LUFS);
-
-		for (uint64_t blockIndex = 0; blockIndex < processedBlockCount; ++blockIndex) {
-			float loudness = INVALID_LOUDNESS_LUFS;
-			if (loudnessMeter.getBlockLoudness(blockIndex, loudness)) {
-				blockLoudness[static_cast<size_t>(blockIndex)] = loudness;
-			}
-		}
+	if (channelBlocks.size() == 1) {
+		blockLoudness = channelBlocks.front();
 	} else {
-		const auto channelSamples = deinterleaveChannels(
-			reconstructionResult.audioSamples,
-			reconstructionResult.numChannels);
-
-		std::vector<LoudnessMeter> channelMeters(reconstructionResult.numChannels);
-		uint64_t processedBlockCount = std::numeric_limits<uint64_t>::max();
-
-		for (size_t ch = 0; ch < channelSamples.size(); ++ch) {
-			channelMeters[ch].processSamples(channelSamples[ch], metadata.sampleRate);
-			processedBlockCount = std::min(processedBlockCount, channelMeters[ch].getProcessedBlockCount());
-		}
-
-		if (processedBlockCount == std::numeric_limits<uint64_t>::max()) {
-			processedBlockCount = 0;
+		size_t processedBlockCount = std::numeric_limits<size_t>::max();
+		for (const auto& blocks : channelBlocks) {
+			processedBlockCount = std::min(processedBlockCount, blocks.size());
 		}
 
-		if (!channelMeters.empty()) {
-			blockHopSamples = channelMeters.front().getBlockHopSamples();
-			blockSizeSamples = channelMeters.front().getBlockSizeSamples();
-		}
-
-		blockLoudness.resize(static_cast<size_t>(processedBlockCount), INVALID_LOUDNESS_LUFS);
+		blockLoudness.resize(processedBlockCount, INVALID_LOUDNESS_LUFS);
 
-		for (uint64_t blockIndex = 0; blockIndex < processedBlockCount; ++blockIndex) {
+		for (size_t blockIndex = 0; blockIndex < processedBlockCount; ++blockIndex) {
 			float combinedMeanSquare = 0.0f;
-			for (auto& meter : channelMeters) {
-				float channelLoudness = INVALID_LOUDNESS_LUFS;
-				if (meter.getBlockLoudness(blockIndex, channelLoudness)) {
-					// Channel layout is not stored in spectral assets, so use equal weights.
-					combinedMeanSquare += loudnessToMeanSquare(channelLoudness);
-				}
+			for (const auto& blocks : channelBlocks) {
+				// Channel layout is not stored in spectral assets, so use equal weights.
+				combinedMeanSquare += loudnessToMeanSquare(blocks[blockIndex]);
 			}
-			blockLoudness[static_cast<size_t>(blockIndex)] = meanSquareToLoudness(combinedMeanSquare);
+			blockLoudness[blockIndex] = meanSquareToLoudness(combinedMeanSquare);
 		}
 	}
 
 	const uint64_t processedBlockCount = static_cast<uint64_t>(blockLoudness.size());
 
 	for (size_t frameIndex = 0; frameIndex < samples.size(); ++frameIndex) {
-		auto& sample = samples[frameIndex];
+		SpectralFrameInfo& sample = samples.frameInfo(frameIndex);
 
 		const bool hasValidLoudness = std::isfinite(sample.loudnessLUFS) &&
 		                               std::isnormal(sample.loudnessLUFS) &&
@@ -8,7 +8,7 @@ namespace ReSyne::LoudnessUtils {
 
 // ITU-R BS.1770-4 compliant loudness calculation from spectral frames
 // Reconstructs time-domain audio via IFFT and processes through K-weighted loudness meter
-void calculateLoudnessFromSpectralFrames(std::vector<AudioColourSample>& samples,
+void calculateLoudnessFromSpectralFrames(SpectralSequence& samples,
 										  const AudioMetadata& metadata);
 
 }
@@ -0,0 +1,39 @@
+#include "resyne/recorder/memory_usage.h"
+
+#include <mutex>
+
+#include "resyne/recorder/recorder.h"
+#include "resyne/recorder/resident_spectral_store.h"
+#include "utilities/telemetry/telemetry.h"
+
+namespace ReSyne::RecorderMemory {
+
+std::uint64_t sampleBytes(const SpectralSequence& samples) {
+    return samples.storedBytes();
+}
+
+void publish(RecorderState& state) {
+    using Utilities::Telemetry::Memory;
+    using Utilities::Telemetry::setBytes;
+
+    std::unique_lock<std::mutex> lock(state.samplesMutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        setBytes(Memory::RecorderSamples, sampleBytes(state.samples));
+        setBytes(Memory::PreviewSamples, sampleBytes(state.previewSamples));
+        setBytes(Memory::ResidentSpectra, state.residentSpectra != nullptr ? state.residentSpectra->storedBytes() : 0);
+        lock.unlock();
+    }
+
+    setBytes(Memory::PlaybackAudio, state.playbackAudio.size() * sizeof(float));
+    setBytes(Memory::RSYNSource, state.metadata.sourceData != nullptr ? state.metadata.sourceData->bytes.capacity() : 0);
+    setBytes(Memory::PresentationFrames,
+             state.metadata.presentationData != nullptr
+                 ? state.metadata.presentationData->frames.capacity() * sizeof(RSYNPresentationFrame)
+                 : 0);
+    setBytes(Memory::TimelinePreview,
+             state.timelinePreviewCache != nullptr
+                 ? state.timelinePreviewCache->capacity() * sizeof(Timeline::TimelineSample)
+                 : 0);
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "resyne/encoding/formats/exporter.h"
+
+namespace ReSyne {
+
+struct RecorderState;
+
+namespace RecorderMemory {
+
+// What the sequence's frame records and slabs hold. Spilled frames have had their chunks
+// freed, so they count only their records.
+std::uint64_t sampleBytes(const SpectralSequence& samples);
+
+// Sets the recorder's subsystems in the telemetry registry. Runs on the UI thread once a
+// frame; samples held by a worker at the time keep their last value until the next.
+void publish(RecorderState& state);
+
+}
+
+}
@@ -1,44 +1,47 @@
 #include "resyne/recorder/recorder.h"
 #include "resyne/recorder/embedded_source_utils.h"
 #include "resyne/recorder/reconstruction_utils.h"
+#include "resyne/recorder/spectral_journal.h"
 #include "imgui_internal.h"
 
 #include <algorithm>
+#include <cmath>
 #include <mutex>
 
 namespace ReSyne {
 
-bool Recorder::ensureRsynSamplesLoaded(RecorderState& state) {
+bool Recorder::requestRsynHydration(RecorderState& state) {
+    AudioMetadata metadata;
+    size_t focusFrame = 0;
     {
         std::lock_guard<std::mutex> lock(state.samplesMutex);
-        if (!state.samples.empty()) {
-            return true;
-        }
         if (state.metadata.lazyAsset == nullptr) {
-            return false;
+            return !state.samples.empty();
         }
-    }
-
-    AudioMetadata metadata;
-    {
-        std::lock_guard<std::mutex> lock(state.samplesMutex);
         metadata = state.metadata;
+        if (metadata.numFrames > 1) {
+            focusFrame = static_cast<size_t>(
+                std::clamp(state.timeline.scrubberNormalisedPosition, 0.0f, 1.0f) *
+                static_cast<float>(metadata.numFrames - 1));
+        }
     }
 
-    std::vector<AudioColourSample> loadedSamples;
-    if (!SequenceExporter::hydrateRsynSamples(metadata, loadedSamples) || loadedSamples.empty()) {
+    return state.rsynHydration.start(state, metadata, focusFrame);
+}
+
+bool Recorder::ensureRsynSamplesLoaded(RecorderState& state) {
+    if (!requestRsynHydration(state)) {
         return false;
     }
 
     {
         std::lock_guard<std::mutex> lock(state.samplesMutex);
-        state.metadata = std::move(metadata);
-        state.samples = std::move(loadedSamples);
-        state.timelinePreviewCache.clear();
-        state.timelinePreviewCacheDirty = true;
+        if (state.metadata.lazyAsset == nullptr) {
+            return true;
+        }
     }
 
-    return true;
+    return state.rsynHydration.waitUntilComplete();
 }
 
 bool Recorder::ensurePlaybackAudioLoaded(RecorderState& state) {
@@ -80,7 +83,8 @@ bool Recorder::ensurePlaybackAudioLoaded(RecorderState& state) {
                 state.timelinePreviewCacheDirty = true;
             }
 
-            ensureRsynSamplesLoaded(state);
+            // The embedded source already plays, so spectral frames can keep arriving.
+            requestRsynHydration(state);
             return refreshPlaybackOutput(state);
         }
     }
@@ -112,7 +116,8 @@ bool Recorder::refreshPlaybackOutput(RecorderState& state) {
     }
 
     const int deviceIndex = state.outputDeviceIndex;
-    if (!state.audioOutput->initOutputStream(sampleRate, static_cast<int>(numChannels), deviceIndex)) {
+    if (!state.audioOutput->initOutputStream(sampleRate, static_cast<int>(numChannels), deviceIndex,
+                                             state.outputStreamSettings)) {
         state.isPlaybackInitialised = false;
         return false;
     }
@@ -123,11 +128,25 @@ bool Recorder::refreshPlaybackOutput(RecorderState& state) {
     return true;
 }
 
+bool Recorder::ensureProbeOutput(RecorderState& state) {
+    if (state.audioOutput && state.audioOutput->isStreamOpen()) {
+        return true;
+    }
+    if (!state.audioOutput) {
+        state.audioOutput = std::make_unique<AudioOutput>();
+    }
+    const float sampleRate = state.fallbackSampleRate > 0.0f ? state.fallbackSampleRate : 48000.0f;
+    return state.audioOutput->initOutputStream(sampleRate, 2, state.outputDeviceIndex, state.outputStreamSettings);
+}
+
 void Recorder::reconstructAudio(RecorderState& state) {
     ensureRsynSamplesLoaded(state);
 
-    std::vector<AudioColourSample> samples;
+    // Frames spilled to a recording's journal or a loaded project's compressed store are
+    // copied without their spectra and read back block by block during synthesis.
+    SpectralSequence samples;
     AudioMetadata metadata;
+    RecorderJournal::SpilledFrames spilled;
     {
         std::lock_guard<std::mutex> lock(state.samplesMutex);
         if (state.samples.empty()) {
@@ -135,10 +154,21 @@ void Recorder::reconstructAudio(RecorderState& state) {
         }
         samples = state.samples;
         metadata = state.metadata;
+        spilled = RecorderJournal::spilledFrames(state);
     }
 
     std::vector<float> rebuiltPlaybackAudio;
-    if (!RecorderReconstruction::buildPlaybackAudio(samples, metadata, rebuiltPlaybackAudio)) {
+    bool rebuilt = false;
+    if (spilled.store != nullptr) {
+        const uint32_t numChannels = samples.front().channels > 0 ? samples.front().channels : 1;
+        rebuilt = RecorderReconstruction::buildPlaybackAudio(
+            RecorderJournal::frameSource(std::move(spilled), samples),
+            numChannels, metadata, rebuiltPlaybackAudio, nullptr, &state.synthesisCache);
+    } else {
+        rebuilt = RecorderReconstruction::buildPlaybackAudio(
+            samples, metadata, rebuiltPlaybackAudio, nullptr, &state.synthesisCache);
+    }
+    if (!rebuilt) {
         return;
     }
 
@@ -150,8 +180,98 @@ void Recorder::reconstructAudio(RecorderState& state) {
     refreshPlaybackOutput(state);
 }
 
+bool Recorder::startStreamingPlayback(RecorderState& state) {
+    float sampleRate = 0.0f;
+    uint32_t numChannels = 1;
+    size_t trackFrames = 0;
+    size_t hopSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(state.samplesMutex);
+        if (state.samples.empty()) {
+            return false;
+        }
+        hopSize = static_cast<size_t>(std::max(state.metadata.hopSize, 0));
+        sampleRate = state.metadata.sampleRate > 0.0f ? state.metadata.sampleRate : state.fallbackSampleRate;
+        numChannels = state.samples.front().channels > 0 ? state.samples.front().channels : 1;
+        trackFrames = StreamingPlayback::trackLength(state.samples.size(), state.metadata.fftSize,
+                                                     state.metadata.hopSize);
+    }
+    if (sampleRate <= 0.0f || trackFrames == 0) {
+        return false;
+    }
+
+    if (!state.audioOutput) {
+        state.audioOutput = std::make_unique<AudioOutput>();
+    }
+    // The stream plays at the track's own rate and layout; the latency probe's output may
+    // have neither.
+    if (!state.audioOutput->isStreamOpen() ||
+        state.audioOutput->getRequestedSampleRate() != sampleRate ||
+        state.audioOutput->getChannelCount() != numChannels) {
+        if (!state.audioOutput->initOutputStream(sampleRate, static_cast<int>(numChannels), state.outputDeviceIndex,
+                                                 state.outputStreamSettings)) {
+            return false;
+        }
+    }
+
+    float normalised = std::clamp(state.timeline.scrubberNormalisedPosition, 0.0f, 1.0f);
+    if (normalised >= 1.0f || state.streamingPlayback.hasEnded()) {
+        normalised = 0.0f;
+        state.timeline.scrubberNormalisedPosition = 0.0f;
+    }
+    const size_t trackFrame = std::min(static_cast<size_t>(normalised * static_cast<float>(trackFrames)),
+                                       trackFrames - 1);
+
+    if (state.streamingPlayback.isRunning()) {
+        state.streamingPlayback.setRate(state.playbackRate);
+        state.streamingPlayback.setLoopEnabled(state.loopEnabled);
+        // Resuming where the stream paused keeps the hops it already queued.
+        const size_t position = state.audioOutput->getPlaybackPosition();
+        const size_t distance = trackFrame > position ? trackFrame - position : position - trackFrame;
+        if (distance > hopSize || state.streamingPlayback.hasEnded()) {
+            state.streamingPlayback.seek(trackFrame);
+        }
+    } else {
+        std::shared_ptr<PlaybackStream> stream =
+            state.streamingPlayback.start(state, trackFrame, state.playbackRate, state.loopEnabled);
+        if (!stream) {
+            return false;
+        }
+        state.audioOutput->setPlaybackStream(std::move(stream));
+    }
+
+    state.audioOutput->setLoopEnabled(state.loopEnabled);
+    state.audioOutput->play();
+    return true;
+}
+
+void Recorder::stopStreamingPlayback(RecorderState& state) {
+    if (!state.streamingPlayback.isRunning()) {
+        return;
+    }
+    if (state.audioOutput) {
+        state.audioOutput->setPlaybackStream(nullptr);
+    }
+    state.streamingPlayback.stop();
+}
+
 void Recorder::startPlayback(RecorderState& state) {
-    ensureRsynSamplesLoaded(state);
+    requestRsynHydration(state);
+
+    if (state.playbackRate != 1.0f) {
+        startStreamingPlayback(state);
+        return;
+    }
+    if (state.streamingPlayback.isRunning()) {
+        // Back at the track's own rate the reconstructed track takes over where the stream was.
+        if (state.audioOutput && state.audioOutput->getTotalFrames() > 0) {
+            state.timeline.scrubberNormalisedPosition = std::clamp(
+                static_cast<float>(state.audioOutput->getPlaybackPosition()) /
+                    static_cast<float>(state.audioOutput->getTotalFrames()),
+                0.0f, 1.0f);
+        }
+        stopStreamingPlayback(state);
+    }
 
     if (!state.isPlaybackInitialised || state.playbackAudio.empty()) {
         if (!ensurePlaybackAudioLoaded(state)) {
@@ -198,14 +318,48 @@ void Recorder::pausePlayback(RecorderState& state) {
 }
 
 void Recorder::stopPlayback(RecorderState& state) {
+    stopStreamingPlayback(state);
     if (state.audioOutput) {
         state.audioOutput->stop();
     }
 }
 
+void Recorder::setPlaybackRate(RecorderState& state, const float rate) {
+    state.playbackRate = std::isfinite(rate)
+        ? std::clamp(rate, StreamingPlayback::kMinRate, StreamingPlayback::kMaxRate)
+        : 1.0f;
+    if (state.streamingPlayback.isRunning()) {
+        state.streamingPlayback.setRate(state.playbackRate);
+        return;
+    }
+    if (state.playbackRate != 1.0f && state.audioOutput && state.audioOutput->isPlaying()) {
+        const size_t totalFrames = state.audioOutput->getTotalFrames();
+        if (totalFrames > 0) {
+            state.timeline.scrubberNormalisedPosition = std::clamp(
+                static_cast<float>(state.audioOutput->getPlaybackPosition()) / static_cast<float>(totalFrames),
+                0.0f, 1.0f);
+        }
+        startStreamingPlayback(state);
+    }
+}
+
 void Recorder::seekPlayback(RecorderState& state, float normalisedPosition) {
     float clamped = std::clamp(normalisedPosition, 0.0f, 1.0f);
     state.timeline.scrubberNormalisedPosition = clamped;
+    if (!state.samples.empty()) {
+        state.rsynHydration.setFocus(static_cast<size_t>(clamped * static_cast<float>(state.samples.size() - 1)));
+    }
+
+    if (state.streamingPlayback.isRunning()) {
+        if (state.audioOutput && state.audioOutput->isPlaying()) {
+            const size_t totalFrames = state.audioOutput->getTotalFrames();
+            if (totalFrames > 0) {
+                state.streamingPlayback.seek(std::min(static_cast<size_t>(clamped * static_cast<float>(totalFrames)),
+                                                      totalFrames - 1));
+            }
+        }
+        return;
+    }
 
     if (state.audioOutput && !state.playbackAudio.empty()) {
         size_t totalFrames = state.audioOutput->getTotalFrames();
@@ -6,61 +6,65 @@
 
 namespace ReSyne::RecorderReconstruction {
 
-bool buildPlaybackAudio(const std::vector<AudioColourSample>& samples,
+bool buildPlaybackAudio(const SpectralSequence& samples,
                         const AudioMetadata& metadata,
                         std::vector<float>& playbackAudio,
-                        const ProgressCallback& onProgress) {
-    playbackAudio.clear();
-    if (samples.empty() || metadata.sampleRate <= 0.0f || metadata.fftSize <= 0 || metadata.hopSize <= 0) {
+                        const ProgressCallback& onProgress,
+                        SynthesisCache* cache,
+                        const Utilities::Threading::CancellationToken& cancellation) {
+    if (samples.empty()) {
+        playbackAudio.clear();
         return false;
     }
 
-    const uint32_t numChannels = samples.front().channels > 0 ? samples.front().channels : 1;
-    std::vector<std::vector<float>> channelAudioData(numChannels);
-    size_t maxLength = 0;
+    // WAVEncoder reads the channel slices in place rather than from a packed copy of the
+    // whole spectrogram.
+    WAVEncoder::FrameSource source = WAVEncoder::frameSource(samples);
+    source.cancellation = cancellation;
 
-    for (uint32_t ch = 0; ch < numChannels; ++ch) {
-        std::vector<SpectralSample> spectralSamples;
-        spectralSamples.reserve(samples.size());
+    const uint32_t numChannels = samples.frameInfo(0).channels > 0 ? samples.frameInfo(0).channels : 1;
+    return buildPlaybackAudio(source, numChannels, metadata, playbackAudio, onProgress, cache);
+}
 
-        for (const auto& sample : samples) {
-            SpectralSample spectral;
-            if (ch < sample.magnitudes.size()) {
-                spectral.magnitudes.push_back(sample.magnitudes[ch]);
-            } else {
-                spectral.magnitudes.emplace_back();
-            }
-            if (ch < sample.phases.size()) {
-                spectral.phases.push_back(sample.phases[ch]);
-            } else {
-                spectral.phases.emplace_back();
-            }
-            if (ch < sample.frequencies.size()) {
-                spectral.frequencies.push_back(sample.frequencies[ch]);
-            } else {
-                spectral.frequencies.emplace_back();
-            }
-            spectral.timestamp = sample.timestamp;
-            spectral.sampleRate = sample.sampleRate;
-            spectralSamples.push_back(std::move(spectral));
-        }
+bool buildPlaybackAudio(const WAVEncoder::FrameSource& source,
+                        const uint32_t numChannels,
+                        const AudioMetadata& metadata,
+                        std::vector<float>& playbackAudio,
+                        const ProgressCallback& onProgress,
+                        SynthesisCache* cache) {
+    playbackAudio.clear();
+    if (source.frameCount == 0 || metadata.sampleRate <= 0.0f || metadata.fftSize <= 0 || metadata.hopSize <= 0) {
+        return false;
+    }
+    const std::size_t sourceChannels = source.channelCount;
+
+    std::unique_lock<std::mutex> cacheLock;
+    if (cache != nullptr) {
+        cacheLock = std::unique_lock<std::mutex>(cache->mutex);
+    }
 
-        auto result = WAVEncoder::reconstructFromSpectralData(
-            spectralSamples,
-            metadata.sampleRate,
-            metadata.fftSize,
-            metadata.hopSize);
+    std::size_t channelsDone = 0;
+    std::vector<std::vector<float>> channelAudioData = WAVEncoder::reconstructChannels(
+        source,
+        metadata.sampleRate,
+        metadata.fftSize,
+        metadata.hopSize,
+        [&](std::size_t) {
+            ++channelsDone;
+            if (onProgress) {
+                onProgress(static_cast<float>(channelsDone) / static_cast<float>(numChannels));
+            }
+        },
+        cache != nullptr ? &cache->channels : nullptr);
+    channelAudioData.resize(numChannels);
 
-        if (!result.success || result.audioSamples.empty()) {
+    size_t maxLength = 0;
+    for (uint32_t ch = 0; ch < numChannels; ++ch) {
+        if (channelAudioData[ch].empty() && ch < sourceChannels) {
             playbackAudio.clear();
             return false;
         }
-
-        channelAudioData[ch] = std::move(result.audioSamples);
         maxLength = std::max(maxLength, channelAudioData[ch].size());
-        if (onProgress) {
-            onProgress(static_cast<float>(ch + 1) / static_cast<float>(numChannels));
-        }
     }
 
     playbackAudio.reserve(maxLength * numChannels);
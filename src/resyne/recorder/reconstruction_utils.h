@@ -1,17 +1,37 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
 #include <vector>
 
+#include "resyne/encoding/audio/wav_encoder.h"
 #include "resyne/encoding/formats/exporter.h"
 
 namespace ReSyne::RecorderReconstruction {
 
 using ProgressCallback = std::function<void(float)>;
 
-bool buildPlaybackAudio(const std::vector<AudioColourSample>& samples,
+// The last synthesis of each channel, so rebuilding after an edit only re-synthesises the
+// frames that changed.
+struct SynthesisCache {
+    std::mutex mutex;
+    std::vector<WAVEncoder::ChannelCache> channels;  // Protected by mutex
+};
+
+bool buildPlaybackAudio(const SpectralSequence& samples,
+                        const AudioMetadata& metadata,
+                        std::vector<float>& playbackAudio,
+                        const ProgressCallback& onProgress = nullptr,
+                        SynthesisCache* cache = nullptr,
+                        const Utilities::Threading::CancellationToken& cancellation = {});
+
+// For frames that are not all held in one sequence; numChannels is the playback layout.
+// Fails without audio once source.cancellation is set.
+bool buildPlaybackAudio(const WAVEncoder::FrameSource& source,
+                        uint32_t numChannels,
                         const AudioMetadata& metadata,
                         std::vector<float>& playbackAudio,
-                        const ProgressCallback& onProgress = nullptr);
+                        const ProgressCallback& onProgress = nullptr,
+                        SynthesisCache* cache = nullptr);
 
 }
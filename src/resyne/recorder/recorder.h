@@ -2,6 +2,7 @@
 
 #include <imgui.h>
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -10,10 +11,17 @@
 #include <vector>
 
 #include "audio/output/audio_output.h"
+#include "audio/output/pcm_buffer.h"
 #include "colour/colour_core.h"
 #include "resyne/encoding/formats/exporter.h"
+#include "resyne/recorder/import_queue.h"
+#include "resyne/recorder/reconstruction_utils.h"
+#include "resyne/recorder/recording_capture.h"
+#include "resyne/recorder/rsyn_hydration.h"
+#include "resyne/recorder/streaming_playback.h"
 #include "resyne/ui/timeline/timeline.h"
 #include "resyne/ui/toolbar/tool_state.h"
+#include "utilities/threading/task_scheduler.h"
 
 class FFTProcessor;
 class AudioInput;
@@ -24,11 +32,21 @@ class PresentationResources;
 
 namespace ReSyne {
 
+class ResidentSpectralStore;
+class SpectralJournal;
+
+namespace UI {
+class TimelinePreviewBuilder;
+class TimelinePreviewJob;
+}
+
 struct SampleColourEntry {
 	ImVec4 rgb = ImVec4(0.0f, 0.0f, 0.0f, 1.0f);
 	float labL = 0.0f;
 	float labA = 0.0f;
 	float labB = 0.0f;
+	// Independent of the output colour space, so rgb can be reprojected without reanalysing
+	ColourCore::XYZ xyz{};
 };
 
 enum class RecorderExportFormat {
@@ -46,15 +64,25 @@ struct DetachedVisualisationState {
 
 struct RecorderState {
     ~RecorderState();
-    bool isRecording = false;
+    std::atomic<bool> isRecording{false};
     bool windowOpen = false;
-    std::vector<AudioColourSample> samples;
+    SpectralSequence samples;
     uint64_t firstFrameCounter = 0;
     std::mutex samplesMutex;
+    // While recording, the spectra of all but the newest frames move to the journal; the
+    // first journalledFrames samples keep only their timestamps and loudness.
+    std::shared_ptr<SpectralJournal> spectralJournal;  // Protected by samplesMutex
+    size_t journalledFrames = 0;  // Protected by samplesMutex
+    // A loaded project whose float spectra would exceed residentSpectraThresholdBytes keeps
+    // them compressed here instead, and every sample holds only its timestamp and loudness.
+    // Zero keeps every project's spectra in full.
+    std::shared_ptr<ResidentSpectralStore> residentSpectra;  // Protected by samplesMutex
+    size_t residentSpectraThresholdBytes = size_t{512} << 20;
     bool shouldOpenSaveDialog = false;
     bool shouldOpenLoadDialog = false;
     RecorderExportFormat exportFormat = RecorderExportFormat::WAV;
     AudioMetadata metadata;
+    // Caps imports, and recordings when no journal could be opened.
     static constexpr size_t MAX_RECORDING_SAMPLES = 100000;
     float fallbackSampleRate = 0.0f;
     int fallbackFftSize = 0;
@@ -64,6 +92,8 @@ struct RecorderState {
     float importLowGain = 1.0f;
     float importMidGain = 1.0f;
     float importHighGain = 1.0f;
+    // Decimates audio imported at 88.2 kHz and above before analysing it.
+    bool importDecimateHighRates = false;
     Timeline::TimelineState timeline;
     UI::Utilities::ToolState toolState;
     Timeline::TrackpadGestureInput trackpadInput;
@@ -75,40 +105,48 @@ struct RecorderState {
     std::string loadingFilename;
     float loadingProgress = 0.0f;
     std::string pendingImportPath;
-    int importPhase = 0;  // 0=none, 1=show dialog, 2=start thread, 3+=poll
+    int importPhase = 0;  // 0=none, 1=show dialog, 2=start task, 3+=poll
 
-    std::thread importThread;
-    std::atomic<bool> importRunning{false};
-    std::atomic<bool> importComplete{false};
-    std::atomic<float> loadingProgressAtomic{0.0f};
+    // Both run on the shared scheduler and report their progress through the handle.
+    Utilities::Threading::TaskHandle importTask;
     std::string importErrorMessage;  // Protected by samplesMutex
-    std::vector<AudioColourSample> importedSamples;  // Protected by samplesMutex
+    SpectralSequence importedSamples;  // Protected by samplesMutex
     AudioMetadata importedMetadata;  // Protected by samplesMutex
+    // The rest of a multi-file drop, each saved to .rsyn beside its source in the background.
+    ImportQueue importQueue;
 
-    std::vector<AudioColourSample> previewSamples;  // Protected by samplesMutex
+    SpectralSequence previewSamples;  // Protected by samplesMutex
     std::atomic<bool> previewReady{false};
+    // An .rsyn's embedded preview, drawn while it is opened until previewReady is set or the
+    // import lands.
+    std::shared_ptr<const RSYNPreviewData> storedPreview;  // Protected by samplesMutex
     std::mutex operationStatusMutex;
     std::string loadingOperationStatus;
 
-    std::thread exportThread;
-    std::atomic<bool> exportRunning{false};
-    std::atomic<bool> exportComplete{false};
-    std::atomic<float> exportProgressAtomic{0.0f};
+    Utilities::Threading::TaskHandle exportTask;
     std::string exportErrorMessage;  // Protected by samplesMutex
     bool showExportingDialog = false;
     std::string exportingFilename;
     std::string exportOperationStatus;
     RecorderExportFormat pendingExportFormat = RecorderExportFormat::WAV;
     std::string pendingExportPath;
+    // Ticked in the export dialog, indexed by RecorderExportFormat, and the formats the next
+    // save dialog exports together; empty for a single format.
+    std::array<bool, 4> exportTargetSelected{};
+    std::vector<RecorderExportFormat> pendingExportTargets;
 
     std::unique_ptr<AudioOutput> audioOutput;
-    std::vector<float> playbackAudio;
+    PCMBuffer playbackAudio;
     bool isPlaybackInitialised = false;
+    RecorderReconstruction::SynthesisCache synthesisCache;
 
     bool loopEnabled = true;
+    // Any rate but 1 plays through streamingPlayback, which needs no reconstructed track.
+    float playbackRate = 1.0f;
     bool showExportDialog = false;
     bool focusRequested = false;
     int outputDeviceIndex = -1;
+    AudioStreamSettings outputStreamSettings;
     DetachedVisualisationState detachedVisualisation;
 
     int videoWidth = 1920;
@@ -124,9 +162,16 @@ struct RecorderState {
     float presentationSmoothingAmount = 0.6f;
     Renderer::PresentationResources* presentationResources = nullptr;
 
-    std::vector<Timeline::TimelineSample> timelinePreviewCache;
+    std::shared_ptr<const std::vector<Timeline::TimelineSample>> timelinePreviewCache;
+    // Sampling and smoothing state behind timelinePreviewCache, kept so appended frames can
+    // extend it.
+    std::shared_ptr<UI::TimelinePreviewBuilder> timelinePreviewBuilder;
+    // Rebuild in progress on worker threads; timelinePreviewCache is kept until it lands.
+    std::shared_ptr<UI::TimelinePreviewJob> timelinePreviewJob;
     bool timelinePreviewCacheDirty = true;
     uint64_t timelinePreviewCacheRevision = 0;
+    // Leading samples of timelinePreviewCache carried over unchanged from the revision before.
+    size_t timelinePreviewCacheRetainedCount = 0;
     size_t timelinePreviewCacheMaxSamples = 0;
     size_t timelinePreviewCacheSourceCount = 0;
     bool timelinePreviewCacheUsesPreviewSamples = false;
@@ -138,15 +183,17 @@ struct RecorderState {
     bool timelinePreviewCacheSmoothingEnabled = true;
     bool timelinePreviewCacheManualSmoothing = false;
     float timelinePreviewCacheSmoothingAmount = 0.6f;
+
+    // Last members so they are torn down first while the samples they write still exist.
+    RecordingCapture recordingCapture;
+    RsynHydration rsynHydration;
+    StreamingPlayback streamingPlayback;
 };
 
 class Recorder {
 public:
-    static void updateFromFFTProcessor(RecorderState& state,
-                                       AudioProcessor& audioProcessor,
-                                       float r,
-                                       float g,
-                                       float b);
+    // Appends the frames waiting in the analysis rings. Runs on the capture thread.
+    static void captureBufferedFrames(RecorderState& state, AudioProcessor& audioProcessor);
 
     static void drawBottomPanel(RecorderState& state,
                                 AudioProcessor& audioProcessor,
@@ -192,20 +239,39 @@ public:
                                         std::string filepath,
                                         RecorderExportFormat format);
 
+    // Writes basePath plus each format's extension in one pass: the samples are copied once,
+    // the WAV and the MP4 share one reconstruction of the audio, and the writers run side by
+    // side on the scheduler.
+    static void exportRecordingTargetsThreaded(RecorderState& state,
+                                               std::string basePath,
+                                               std::vector<RecorderExportFormat> formats);
+
     static void startPlayback(RecorderState& state);
     static void pausePlayback(RecorderState& state);
     static void stopPlayback(RecorderState& state);
     static void seekPlayback(RecorderState& state, float normalisedPosition);
+    // Clamped to the streaming range. Leaving rate 1 while the track plays carries on from
+    // the same place through the streaming vocoder.
+    static void setPlaybackRate(RecorderState& state, float rate);
     static void reconstructAudio(RecorderState& state);
     static bool refreshPlaybackOutput(RecorderState& state);
+    // Opens an output for the latency probe's impulses when none is open; loading a track
+    // reopens it at the track's rate.
+    static bool ensureProbeOutput(RecorderState& state);
     static void importFromFileThreaded(RecorderState& state,
+                                       const Utilities::Threading::TaskContext& context,
                                        std::string filepath,
                                        ColourCore::ColourSpace colourSpace,
                                        bool applyGamutMapping);
+    // Starts background hydration of a lazily loaded .rsyn around the scrubber without
+    // waiting for it. True when samples are loaded or on their way.
+    static bool requestRsynHydration(RecorderState& state);
 
 private:
     static bool ensureRsynSamplesLoaded(RecorderState& state);
     static bool ensurePlaybackAudioLoaded(RecorderState& state);
+    static bool startStreamingPlayback(RecorderState& state);
+    static void stopStreamingPlayback(RecorderState& state);
     static void drawExportDialog(RecorderState& state);
     static void drawLoadingDialog(RecorderState& state);
     static void drawExportingDialog(RecorderState& state);
@@ -214,6 +280,9 @@ private:
                                         bool hasPlaybackData);
 };
 
+// The import and presentation settings an .rsyn saved now would carry.
+RSYNExportOptions rsynExportOptions(const RecorderState& state);
+
 void setLoadingOperationStatus(RecorderState& state, std::string status);
 std::string getLoadingOperationStatus(RecorderState& state);
 void setExportOperationStatus(RecorderState& state, std::string status);
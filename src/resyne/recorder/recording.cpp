@@ -1,4 +1,5 @@
 #include "resyne/recorder/recorder.h"
+#include "resyne/recorder/spectral_journal.h"
 
 #include <algorithm>
 
@@ -25,12 +26,13 @@ void resetTimelineState(RecorderState& state) {
 }
 
 RecorderState::~RecorderState() {
-    if (importThread.joinable()) {
-        importThread.join();
-    }
-    if (exportThread.joinable()) {
-        exportThread.join();
-    }
+    streamingPlayback.stop();
+    recordingCapture.stop();
+    rsynHydration.stop();
+    importTask.cancel();
+    importTask.wait();
+    importQueue.cancel();
+    exportTask.wait();
 }
 
 void setLoadingOperationStatus(RecorderState& state, std::string status) {
@@ -64,18 +66,26 @@ bool Recorder::hasLoadedAudio(RecorderState& state) {
 
 void Recorder::clearLoadedAudio(RecorderState& state) {
     state.isRecording = false;
+    state.recordingCapture.stop();
+    state.streamingPlayback.stop();
     if (state.audioOutput) {
+        state.audioOutput->setPlaybackStream(nullptr);
         state.audioOutput->stop();
         state.audioOutput->clearAudioData();
     }
+    state.rsynHydration.stop();
 
     std::lock_guard<std::mutex> lock(state.samplesMutex);
     state.samples.clear();
+    state.spectralJournal.reset();
+    state.journalledFrames = 0;
+    state.residentSpectra.reset();
     state.previewSamples.clear();
+    state.storedPreview.reset();
     state.importedSamples.clear();
     state.importedMetadata = {};
     state.importErrorMessage.clear();
-    state.timelinePreviewCache.clear();
+    state.timelinePreviewCache.reset();
     state.timelinePreviewCacheDirty = true;
     state.playbackAudio.clear();
     state.metadata = {};
@@ -92,23 +102,22 @@ void Recorder::clearLoadedAudio(RecorderState& state) {
     resetTimelineState(state);
 }
 
-void Recorder::updateFromFFTProcessor(RecorderState& state,
-                                                AudioProcessor& audioProcessor,
-                                                float r,
-                                                float g,
-                                                float b) {
+void Recorder::captureBufferedFrames(RecorderState& state, AudioProcessor& audioProcessor) {
     if (!state.isRecording) {
         return;
     }
 
-    (void)r;
-    (void)g;
-    (void)b;
-
-    auto channelFrames = audioProcessor.consumeBufferedFrames();
+    thread_local AudioProcessor::BorrowedFrames channelFrames;
+    audioProcessor.borrowBufferedFrames(channelFrames);
     if (channelFrames.empty() || channelFrames.front().empty()) {
+        audioProcessor.releaseBufferedFrames(channelFrames);
         return;
     }
+    struct ReleaseGuard {
+        AudioProcessor& processor;
+        const AudioProcessor::BorrowedFrames& frames;
+        ~ReleaseGuard() { processor.releaseBufferedFrames(frames); }
+    } releaseGuard{audioProcessor, channelFrames};
 
     const size_t numChannels = channelFrames.size();
     size_t frameCount = channelFrames.front().size();
@@ -124,7 +133,7 @@ void Recorder::updateFromFFTProcessor(RecorderState& state,
 
     for (size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
         const auto& frame = channelFrames[0][frameIndex];
-        if (state.samples.size() >= RecorderState::MAX_RECORDING_SAMPLES) {
+        if (state.spectralJournal == nullptr && state.samples.size() >= RecorderState::MAX_RECORDING_SAMPLES) {
             state.isRecording = false;
             return;
         }
@@ -133,59 +142,77 @@ void Recorder::updateFromFFTProcessor(RecorderState& state,
             state.firstFrameCounter = frame.frameCounter;
             state.metadata.sampleRate = frame.sampleRate;
             state.metadata.channels = static_cast<uint32_t>(numChannels);
+            state.samples.reset(numChannels, frame.magnitudes.size());
         }
 
-	        AudioColourSample sample;
-	        sample.magnitudes.resize(numChannels);
-	        sample.phases.resize(numChannels);
-	        sample.channels = static_cast<uint32_t>(numChannels);
-	        sample.sampleRate = frame.sampleRate;
-        sample.loudnessLUFS = frame.loudnessLUFS;
-        sample.splDb = frame.loudnessLUFS + synesthesia::constants::REFERENCE_SPL_AT_0_LUFS;
-
         bool channelsAligned = true;
+        size_t binCount = 0;
         for (size_t ch = 0; ch < numChannels; ++ch) {
             const auto& channelFrame = channelFrames[ch][frameIndex];
             if (channelFrame.frameCounter != frame.frameCounter) {
                 channelsAligned = false;
                 break;
-	            }
-
-	            sample.magnitudes[ch] = channelFrame.magnitudes;
-	            sample.phases[ch] = channelFrame.phases;
-	        }
+            }
+            binCount = std::max({binCount, channelFrame.magnitudes.size(), channelFrame.phases.size()});
+        }
 
         if (!channelsAligned) {
             continue;
         }
 
+        SpectralFrameInfo info{};
+        info.channels = static_cast<uint32_t>(numChannels);
+        info.sampleRate = frame.sampleRate;
+        info.loudnessLUFS = frame.loudnessLUFS;
+        info.splDb = frame.loudnessLUFS + synesthesia::constants::REFERENCE_SPL_AT_0_LUFS;
         uint64_t relativeFrame = frame.frameCounter - state.firstFrameCounter;
-        sample.timestamp = static_cast<double>(relativeFrame * static_cast<uint64_t>(state.metadata.hopSize)) /
-                           static_cast<double>(state.metadata.sampleRate);
+        info.timestamp = static_cast<double>(relativeFrame * static_cast<uint64_t>(state.metadata.hopSize)) /
+                         static_cast<double>(state.metadata.sampleRate);
 
-        state.samples.push_back(sample);
-        state.timelinePreviewCacheDirty = true;
+        // Each frame is copied straight into the track's slabs.
+        const size_t stored = state.samples.appendFrame(info, numChannels, binCount);
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            const auto& channelFrame = channelFrames[ch][frameIndex];
+            std::copy(channelFrame.magnitudes.begin(), channelFrame.magnitudes.end(),
+                      state.samples.magnitudes(stored, ch).begin());
+            std::copy(channelFrame.phases.begin(), channelFrame.phases.end(),
+                      state.samples.phases(stored, ch).begin());
+        }
     }
+    RecorderJournal::spillRecordedFrames(state);
 }
 
 void Recorder::startRecording(RecorderState& state,
                                          AudioProcessor& audioProcessor,
                                          int fftSize,
                                          int hopSize) {
-    audioProcessor.discardBufferedFrames();
     clearLoadedAudio(state);
+    audioProcessor.discardBufferedFrames();
 
-    std::lock_guard<std::mutex> lock(state.samplesMutex);
-    state.isRecording = true;
-    state.metadata.version = "3.0.0";
-    state.metadata.sampleRate = 0.0f;
-    state.metadata.fftSize = fftSize;
-    state.metadata.hopSize = hopSize;
-    state.metadata.windowType = "hann";
-    state.metadata.numBins = static_cast<size_t>(fftSize / 2 + 1);
+    // Without a journal the recording is held in memory and capped as before.
+    auto journal = std::make_shared<SpectralJournal>();
+    std::string journalError;
+    if (!journal->open(journalError)) {
+        journal.reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state.samplesMutex);
+        state.spectralJournal = std::move(journal);
+        state.isRecording = true;
+        state.metadata.version = "3.0.0";
+        state.metadata.sampleRate = 0.0f;
+        state.metadata.fftSize = fftSize;
+        state.metadata.hopSize = hopSize;
+        state.metadata.windowType = "hann";
+        state.metadata.numBins = static_cast<size_t>(fftSize / 2 + 1);
+    }
+    state.recordingCapture.start(state, audioProcessor);
 }
 
 void Recorder::stopRecording(RecorderState& state) {
+    // The capture collects what analysis has already produced before recording ends.
+    state.recordingCapture.stop();
     state.isRecording = false;
     {
         std::lock_guard<std::mutex> lock(state.samplesMutex);
@@ -0,0 +1,45 @@
+#include "resyne/recorder/recording_capture.h"
+#include "resyne/recorder/recorder.h"
+
+#include <cstdint>
+#include <functional>
+
+#include "audio/processing/audio_processor.h"
+
+namespace ReSyne {
+
+RecordingCapture::~RecordingCapture() {
+    stop();
+}
+
+void RecordingCapture::start(RecorderState& state, AudioProcessor& audioProcessor) {
+    stop();
+    processor = &audioProcessor;
+    stopRequested.store(false, std::memory_order_release);
+    worker = std::thread(&RecordingCapture::run, this, std::ref(state));
+}
+
+void RecordingCapture::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    stopRequested.store(true, std::memory_order_release);
+    processor->wakeFrameWaiters();
+    worker.join();
+    processor = nullptr;
+}
+
+void RecordingCapture::run(RecorderState& state) {
+    for (;;) {
+        // Read before draining, so a buffer pushed mid-drain still wakes the wait below.
+        const uint64_t seenGeneration = processor->bufferedFrameGeneration();
+        Recorder::captureBufferedFrames(state, *processor);
+        if (stopRequested.load(std::memory_order_acquire) ||
+            !state.isRecording.load(std::memory_order_acquire)) {
+            return;
+        }
+        processor->waitForBufferedFrames(seenGeneration);
+    }
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+class AudioProcessor;
+
+namespace ReSyne {
+
+struct RecorderState;
+
+// Drains the analysis thread's frame rings into RecorderState::samples on its own thread
+// while recording, so capture keeps pace with analysis rather than with the UI. The worker
+// sleeps on AudioProcessor's frame generation and never takes a lock the analysis thread
+// holds; only the recorder's own samplesMutex is taken to append.
+class RecordingCapture {
+public:
+    RecordingCapture() = default;
+    ~RecordingCapture();
+
+    RecordingCapture(const RecordingCapture&) = delete;
+    RecordingCapture& operator=(const RecordingCapture&) = delete;
+
+    // audioProcessor must outlive the capture. The worker exits by itself once
+    // state.isRecording clears.
+    void start(RecorderState& state, AudioProcessor& audioProcessor);
+    // Collects frames analysed so far before returning. Must not be called with
+    // samplesMutex held.
+    void stop();
+
+private:
+    void run(RecorderState& state);
+
+    std::thread worker;
+    AudioProcessor* processor = nullptr;
+    std::atomic<bool> stopRequested{false};
+};
+
+}
@@ -0,0 +1,138 @@
+#include "resyne/recorder/resident_spectral_store.h"
+
+#include <algorithm>
+
+#include "resyne/encoding/formats/rsyn_serialisation.h"
+#include "resyne/encoding/formats/spectral_sequence.h"
+
+namespace ReSyne {
+
+ResidentSpectralStore::ResidentSpectralStore(const std::size_t frameCount, const double phaseAdvancePerBin)
+    : totalFrames(frameCount),
+      phaseAdvance(phaseAdvancePerBin),
+      blocks((frameCount + kBlockFrames - 1) / kBlockFrames) {}
+
+bool ResidentSpectralStore::store(const std::size_t firstFrame, const SpectralSequenceView frames) {
+    const std::size_t endFrame = firstFrame + frames.size();
+    if (frames.empty() || firstFrame % kBlockFrames != 0 || endFrame > totalFrames ||
+        (endFrame % kBlockFrames != 0 && endFrame != totalFrames)) {
+        return false;
+    }
+
+    auto axis = std::make_shared<const std::vector<float>>(SpectralSequence::detectSharedFrequencies(frames));
+    std::vector<std::vector<std::uint8_t>> encoded;
+    if (!RSYNSerialisation::encodeSampleBlocks(frames, *axis, kBlockFrames, RSYNSpectralEncoding::Quantised16,
+                                               phaseAdvance, encoded)) {
+        return false;
+    }
+
+    std::vector<StoredBlock> packed(encoded.size());
+    for (std::size_t index = 0; index < encoded.size(); ++index) {
+        if (!RSYNContainer::packBlock(encoded[index], RSYNContainer::Compression::ShuffledDeflate,
+                                      packed[index].bytes, packed[index].locator)) {
+            return false;
+        }
+        std::vector<std::uint8_t>().swap(encoded[index]);
+
+        const std::size_t blockStart = index * kBlockFrames;
+        const std::size_t blockEnd = std::min(blockStart + kBlockFrames, frames.size());
+        const bool uniform = std::all_of(frames.begin() + static_cast<std::ptrdiff_t>(blockStart),
+                                         frames.begin() + static_cast<std::ptrdiff_t>(blockEnd),
+                                         [&](const SpectralFrame& sample) {
+                                             return SpectralSequence::matchesFrequencies(sample.frequencies, *axis);
+                                         });
+        packed[index].frequencies = axis;
+        packed[index].uniformFrequencies = uniform;
+        packed[index].stored = true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::size_t firstBlock = firstFrame / kBlockFrames;
+    for (std::size_t index = 0; index < packed.size(); ++index) {
+        StoredBlock& block = blocks[firstBlock + index];
+        if (!block.stored) {
+            bytesStored += packed[index].bytes.size() + (index == 0 ? axis->size() * sizeof(float) : 0);
+            block = std::move(packed[index]);
+        }
+    }
+    return true;
+}
+
+bool ResidentSpectralStore::readFrames(const std::size_t firstFrame,
+                                       const std::size_t count,
+                                       SpectralSequence& frames) const {
+    frames.clear();
+    if (firstFrame + count > totalFrames) {
+        return false;
+    }
+    frames.reserve(count);
+    for (std::size_t frame = firstFrame; frame < firstFrame + count;) {
+        const std::size_t block = frame / kBlockFrames;
+        const Block frameBlock = loadBlock(block);
+        if (frameBlock == nullptr) {
+            frames.clear();
+            return false;
+        }
+        const std::size_t blockStart = block * kBlockFrames;
+        const std::size_t end = std::min(firstFrame + count, blockStart + frameBlock->size());
+        if (frames.empty()) {
+            frames.setSharedFrequencies(frameBlock->sharedFrequencies());
+        }
+        frames.append(SpectralSequenceView(*frameBlock, frame - blockStart, end - frame));
+        frame = end;
+    }
+    return true;
+}
+
+std::span<const float> ResidentSpectralStore::frequencyAxis(const std::size_t frame) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::size_t block = frame / kBlockFrames;
+    if (block >= blocks.size() || !blocks[block].stored || !blocks[block].uniformFrequencies) {
+        return {};
+    }
+    return *blocks[block].frequencies;
+}
+
+std::size_t ResidentSpectralStore::storedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytesStored;
+}
+
+ResidentSpectralStore::Block ResidentSpectralStore::loadBlock(const std::size_t block) const {
+    const StoredBlock* source = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto hit = std::find_if(cached.begin(), cached.end(), [&](const auto& entry) { return entry.first == block; });
+        if (hit != cached.end()) {
+            cached.splice(cached.begin(), cached, hit);
+            return cached.front().second;
+        }
+        if (block >= blocks.size() || !blocks[block].stored) {
+            return nullptr;
+        }
+        source = &blocks[block];
+    }
+
+    // A stored block never changes, so it is inflated without the lock.
+    std::vector<std::uint8_t> payload;
+    if (!RSYNContainer::unpackBlock(source->bytes, source->locator, payload)) {
+        return nullptr;
+    }
+    auto frames = std::make_shared<SpectralSequence>();
+    std::size_t decodedFrames = 0;
+    const std::size_t expectedFrames = std::min(kBlockFrames, totalFrames - block * kBlockFrames);
+    if (!RSYNSerialisation::decodeSampleBlock(payload, *frames, 0, *source->frequencies,
+                                              RSYNSpectralEncoding::Quantised16, decodedFrames) ||
+        decodedFrames != expectedFrames) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    cached.emplace_front(block, std::move(frames));
+    if (cached.size() > kCachedBlocks) {
+        cached.pop_back();
+    }
+    return cached.front().second;
+}
+
+}
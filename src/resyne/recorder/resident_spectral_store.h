@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "resyne/encoding/formats/exporter.h"
+#include "resyne/encoding/formats/rsyn_container.h"
+#include "resyne/recorder/spectral_journal.h"
+
+namespace ReSyne {
+
+// Spectra of a loaded project held compressed in memory, so a long track costs a fraction
+// of its float frames. Each block is encoded as a Quantised16 SPEC block, log-magnitudes and
+// phase deltas against the expected advance as 16-bit codes, and then deflated. Reads
+// inflate whole blocks into a small LRU shared by every reader, which keeps the blocks
+// around the playhead and the visible timeline warm.
+class ResidentSpectralStore final : public SpilledSpectra {
+public:
+    static constexpr std::size_t kBlockFrames = 256;
+    static constexpr std::size_t kCachedBlocks = 12;
+
+    // phaseAdvancePerBin is 2*pi*hop/fftSize, the advance the phase codes are taken against.
+    ResidentSpectralStore(std::size_t frameCount, double phaseAdvancePerBin);
+
+    ResidentSpectralStore(const ResidentSpectralStore&) = delete;
+    ResidentSpectralStore& operator=(const ResidentSpectralStore&) = delete;
+
+    // Takes frames from firstFrame, a multiple of kBlockFrames, up to a block boundary or
+    // the end of the track. Blocks may arrive in any order; each is stored once.
+    bool store(std::size_t firstFrame, SpectralSequenceView frames);
+
+    // Fails for frames whose block has not been stored yet.
+    bool readFrames(std::size_t firstFrame, std::size_t count, SpectralSequence& frames) const override;
+    std::size_t blockFrames() const override { return kBlockFrames; }
+    std::span<const float> frequencyAxis(std::size_t frame) const override;
+
+    std::size_t storedBytes() const;
+
+private:
+    using Block = std::shared_ptr<const SpectralSequence>;
+
+    struct StoredBlock {
+        std::vector<std::uint8_t> bytes;
+        RSYNContainer::BlockLocator locator{};
+        // The axis the block was encoded against, shared with the blocks stored beside it.
+        // uniformFrequencies is set when every frame in the block uses it.
+        std::shared_ptr<const std::vector<float>> frequencies;
+        bool uniformFrequencies = false;
+        bool stored = false;
+    };
+
+    Block loadBlock(std::size_t block) const;
+
+    std::size_t totalFrames = 0;
+    double phaseAdvance = 0.0;
+    mutable std::mutex mutex;
+    std::vector<StoredBlock> blocks;  // Protected by mutex; a stored block never changes
+    std::size_t bytesStored = 0;  // Protected by mutex
+    // Most recently read first.
+    mutable std::list<std::pair<std::size_t, Block>> cached;  // Protected by mutex
+};
+
+}
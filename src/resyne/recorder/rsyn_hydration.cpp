@@ -0,0 +1,240 @@
+#include "resyne/recorder/rsyn_hydration.h"
+#include "resyne/recorder/recorder.h"
+#include "resyne/recorder/resident_spectral_store.h"
+
+#include <algorithm>
+#include <limits>
+#include <numbers>
+#include <utility>
+
+namespace ReSyne {
+
+namespace {
+
+// A range is inflated and published as one unit: big enough that the per-call file
+// mapping is noise, small enough that the block under the playhead lands within a frame.
+constexpr std::size_t kBlocksPerRange = 4;
+
+// Hydrated frames carry magnitudes, phases and a copy of the frequency axis per channel.
+std::size_t hydratedSpectraBytes(const AudioMetadata& metadata) {
+    const std::size_t bins = metadata.numBins > 0
+        ? metadata.numBins
+        : static_cast<std::size_t>(std::max(metadata.fftSize, 0) / 2 + 1);
+    return metadata.numFrames * std::max<std::size_t>(metadata.channels, 1) * bins * 3 * sizeof(float);
+}
+
+// Playback runs forward, so ranges ahead of the focus are taken before ones equally far
+// behind it.
+std::size_t nextRange(const std::vector<bool>& decoded, const std::size_t focusRange) {
+    std::size_t best = decoded.size();
+    std::size_t bestCost = std::numeric_limits<std::size_t>::max();
+    for (std::size_t range = 0; range < decoded.size(); ++range) {
+        if (decoded[range]) {
+            continue;
+        }
+        const std::size_t cost = range >= focusRange ? range - focusRange : (focusRange - range) * 2;
+        if (cost < bestCost) {
+            best = range;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+}
+
+RsynHydration::~RsynHydration() {
+    task.cancel();
+    task.wait();
+}
+
+bool RsynHydration::start(RecorderState& state, const AudioMetadata& metadata, const std::size_t focusFrame) {
+    if (metadata.lazyAsset == nullptr || metadata.numFrames == 0) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        if (asset == metadata.lazyAsset && status != Status::Idle) {
+            return status != Status::Failed;
+        }
+    }
+
+    stop();
+
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (asset == metadata.lazyAsset && status != Status::Idle) {
+        return status != Status::Failed;
+    }
+
+    // Files written before SPEC was blocked can only be inflated whole, so they hydrate as
+    // a single range.
+    const std::size_t frameCount = metadata.numFrames;
+    const std::size_t blockFrames = metadata.lazyAsset->spectralBlockFrames;
+    const std::size_t rangeSize = blockFrames > 0 ? blockFrames * kBlocksPerRange : frameCount;
+    // Ranges must hold whole store blocks, so only blocked files of the usual block size are
+    // held compressed.
+    std::shared_ptr<ResidentSpectralStore> store;
+    {
+        std::lock_guard<std::mutex> samplesLock(state.samplesMutex);
+        if (state.residentSpectraThresholdBytes > 0 && blockFrames > 0 &&
+            rangeSize % ResidentSpectralStore::kBlockFrames == 0 &&
+            hydratedSpectraBytes(metadata) > state.residentSpectraThresholdBytes) {
+            const double phaseAdvancePerBin = metadata.fftSize > 0
+                ? 2.0 * std::numbers::pi * static_cast<double>(metadata.hopSize) / static_cast<double>(metadata.fftSize)
+                : 0.0;
+            store = std::make_shared<ResidentSpectralStore>(frameCount, phaseAdvancePerBin);
+        }
+        // Without a store the track is laid out at its final shape up front, so each range
+        // is written into its own slot; with one, only timestamps and loudness stay resident.
+        if (store != nullptr) {
+            state.samples.reset(0, 0);
+        } else {
+            state.samples.reset(std::max<std::size_t>(metadata.channels, 1),
+                                metadata.numBins > 0 ? metadata.numBins
+                                                     : static_cast<std::size_t>(std::max(metadata.fftSize, 0) / 2 + 1));
+        }
+        state.samples.reserve(frameCount);
+        for (std::size_t frame = 0; frame < frameCount; ++frame) {
+            state.samples.appendFrame(SpectralFrameInfo{}, 0, 0);
+        }
+        state.residentSpectra = store;
+        rangeFrames = rangeSize;
+        readyRanges.assign((frameCount + rangeSize - 1) / rangeSize, 0);
+    }
+
+    asset = metadata.lazyAsset;
+    owner = &state;
+    status = Status::Running;
+    focus.store(std::min(focusFrame, frameCount - 1), std::memory_order_relaxed);
+    RecorderState* target = &state;
+    task = Utilities::Threading::TaskScheduler::shared().submit(
+        Utilities::Threading::TaskPriority::Interactive,
+        [this, target, metadata, frameCount, rangeSize, store](const Utilities::Threading::TaskContext& context) {
+            run(*target, context, metadata, frameCount, rangeSize, store.get());
+        });
+    return true;
+}
+
+void RsynHydration::stop() {
+    Utilities::Threading::TaskHandle finished;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        finished = std::exchange(task, {});
+    }
+    finished.cancel();
+    finished.wait();
+
+    RecorderState* state = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        state = std::exchange(owner, nullptr);
+        asset.reset();
+        status = Status::Idle;
+    }
+    statusChanged.notify_all();
+
+    if (state != nullptr) {
+        std::lock_guard<std::mutex> samplesLock(state->samplesMutex);
+        rangeFrames = 0;
+        readyRanges.clear();
+    }
+}
+
+bool RsynHydration::isRunning() {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    return status == Status::Running;
+}
+
+bool RsynHydration::waitUntilComplete() {
+    Utilities::Threading::TaskHandle running;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        running = task;
+    }
+    // From a scheduler worker this runs the hydration itself if no other worker has taken it.
+    running.wait();
+
+    std::unique_lock<std::mutex> lock(controlMutex);
+    statusChanged.wait(lock, [this] { return status != Status::Running; });
+    return status == Status::Complete;
+}
+
+bool RsynHydration::isFrameReady(const std::size_t frame) const {
+    if (readyRanges.empty() || rangeFrames == 0) {
+        return true;
+    }
+    const std::size_t range = frame / rangeFrames;
+    return range < readyRanges.size() && readyRanges[range] != 0;
+}
+
+void RsynHydration::run(RecorderState& state,
+                        const Utilities::Threading::TaskContext& context,
+                        const AudioMetadata& metadata,
+                        const std::size_t frameCount,
+                        const std::size_t rangeSize,
+                        ResidentSpectralStore* store) {
+    std::vector<bool> decoded((frameCount + rangeSize - 1) / rangeSize, false);
+    SpectralSequence frames;
+    std::size_t binCount = 0;
+    for (std::size_t remaining = decoded.size(); remaining > 0; --remaining) {
+        if (context.isCancelled()) {
+            return;
+        }
+
+        const std::size_t range = nextRange(decoded, focus.load(std::memory_order_relaxed) / rangeSize);
+        const std::size_t firstFrame = range * rangeSize;
+        const std::size_t count = std::min(rangeSize, frameCount - firstFrame);
+        if (!SequenceExporter::hydrateRsynFrames(metadata, firstFrame, count, frames) || frames.size() != count) {
+            // Ranges that did land stay usable; the rest keep reporting not ready.
+            finish(Status::Failed);
+            return;
+        }
+        if (binCount == 0) {
+            binCount = frames.frameInfo(0).binCount;
+        }
+        // A range the store could not take keeps its spectra, which readers fall back to.
+        if (store != nullptr && store->store(firstFrame, frames)) {
+            frames.releaseSpectra(frames.size());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.samplesMutex);
+            if (state.samples.size() != frameCount) {
+                return;
+            }
+            state.samples.replaceFrames(firstFrame, frames);
+            readyRanges[range] = 1;
+            if (state.metadata.presentationData == nullptr) {
+                state.timelinePreviewCacheDirty = true;
+            }
+        }
+        decoded[range] = true;
+        context.reportProgress(static_cast<float>(decoded.size() - remaining + 1) / static_cast<float>(decoded.size()));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state.samplesMutex);
+        readyRanges.clear();
+        if (!state.samples.empty()) {
+            if (state.metadata.numBins == 0 && binCount > 0) {
+                state.metadata.numBins = binCount;
+            }
+            if (state.metadata.channels == 0) {
+                state.metadata.channels = state.samples.frameInfo(0).channels;
+            }
+        }
+        state.timelinePreviewCacheDirty = true;
+    }
+    finish(Status::Complete);
+}
+
+void RsynHydration::finish(const Status result) {
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        status = result;
+    }
+    statusChanged.notify_all();
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "resyne/encoding/formats/exporter.h"
+#include "utilities/threading/task_scheduler.h"
+
+namespace ReSyne {
+
+class ResidentSpectralStore;
+struct RecorderState;
+
+// Decodes a lazily loaded .rsyn into RecorderState::samples as a task on the shared scheduler.
+// The samples are sized to the whole track up front and filled one range of SPEC blocks
+// at a time, nearest the focus frame first and then outward, so playback and scrubbing
+// can begin before the decode has finished. A project too large to hold in full has each
+// range's spectra moved into RecorderState::residentSpectra as it lands.
+class RsynHydration {
+public:
+    RsynHydration() = default;
+    ~RsynHydration();
+
+    RsynHydration(const RsynHydration&) = delete;
+    RsynHydration& operator=(const RsynHydration&) = delete;
+
+    // Does nothing while a hydration of the same asset is running or has finished, and
+    // does not retry one that failed. Returns false if there is nothing to hydrate.
+    bool start(RecorderState& state, const AudioMetadata& metadata, std::size_t focusFrame);
+    // Must not be called with samplesMutex held; the worker needs it to finish publishing.
+    void stop();
+    void setFocus(std::size_t frame) { focus.store(frame, std::memory_order_relaxed); }
+
+    bool isRunning();
+    // False once hydration has failed or been stopped, or if it never started.
+    bool waitUntilComplete();
+
+    // Caller must hold samplesMutex. Always true when no hydration is in progress.
+    bool isFrameReady(std::size_t frame) const;
+
+private:
+    enum class Status {
+        Idle,
+        Running,
+        Complete,
+        Failed
+    };
+
+    void run(RecorderState& state, const Utilities::Threading::TaskContext& context,
+             const AudioMetadata& metadata, std::size_t frameCount, std::size_t rangeSize,
+             ResidentSpectralStore* store);
+    void finish(Status result);
+
+    std::mutex controlMutex;
+    std::condition_variable statusChanged;
+    Utilities::Threading::TaskHandle task;  // Protected by controlMutex
+    Status status = Status::Idle;  // Protected by controlMutex
+    std::shared_ptr<const RSYNLazyAsset> asset;  // Protected by controlMutex
+    RecorderState* owner = nullptr;  // Protected by controlMutex
+    std::atomic<std::size_t> focus{0};
+
+    std::size_t rangeFrames = 0;  // Protected by samplesMutex
+    std::vector<std::uint8_t> readyRanges;  // Protected by samplesMutex
+};
+
+}
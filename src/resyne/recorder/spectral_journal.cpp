@@ -0,0 +1,340 @@
+#include "resyne/recorder/spectral_journal.h"
+#include "resyne/recorder/recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <system_error>
+#include <utility>
+
+#include "resyne/encoding/formats/rsyn_serialisation.h"
+#include "resyne/recorder/resident_spectral_store.h"
+
+namespace ReSyne {
+
+namespace {
+
+// About 45 seconds at the default hop; the timeline and playback stay in memory for that
+// long behind the newest frame.
+constexpr std::size_t kResidentFrames = 4096;
+
+// Appends frames [first, end) of block, which starts at frame blockStart, to frames.
+void appendBlockFrames(const SpectralSequence& block,
+                       const std::size_t blockStart,
+                       const std::size_t first,
+                       const std::size_t end,
+                       SpectralSequence& frames) {
+    if (frames.empty()) {
+        frames.setSharedFrequencies(block.sharedFrequencies());
+    }
+    frames.append(SpectralSequenceView(block, first - blockStart, end - first));
+}
+
+}
+
+SpectralJournal::~SpectralJournal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    pendingChanged.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (file.is_open()) {
+        file.close();
+    }
+    if (!filepath.empty()) {
+        std::error_code error;
+        std::filesystem::remove(filepath, error);
+    }
+}
+
+bool SpectralJournal::open(std::string& errorMessage) {
+    std::error_code error;
+    const auto directory = std::filesystem::temp_directory_path(error);
+    if (error) {
+        errorMessage = "No temporary directory for the recording journal";
+        return false;
+    }
+
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    filepath = (directory / ("resyne_recording_" + std::to_string(stamp) + ".spec")).string();
+    file.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        errorMessage = "Could not create the recording journal";
+        filepath.clear();
+        return false;
+    }
+
+    writer = std::thread(&SpectralJournal::run, this);
+    return true;
+}
+
+void SpectralJournal::append(SpectralSequence frames) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::make_shared<const SpectralSequence>(std::move(frames)));
+    }
+    pendingChanged.notify_one();
+}
+
+std::size_t SpectralJournal::frameCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (locators.size() + pending.size()) * kBlockFrames;
+}
+
+bool SpectralJournal::readFrames(const std::size_t firstFrame,
+                                 const std::size_t count,
+                                 SpectralSequence& frames) const {
+    frames.clear();
+    frames.reserve(count);
+    for (std::size_t frame = firstFrame; frame < firstFrame + count;) {
+        const std::size_t block = frame / kBlockFrames;
+        const Block frameBlock = loadBlock(block);
+        if (frameBlock == nullptr) {
+            frames.clear();
+            return false;
+        }
+        const std::size_t blockStart = block * kBlockFrames;
+        const std::size_t end = std::min(firstFrame + count, blockStart + frameBlock->size());
+        appendBlockFrames(*frameBlock, blockStart, frame, end, frames);
+        frame = end;
+    }
+    return true;
+}
+
+SpectralJournal::Block SpectralJournal::loadBlock(const std::size_t block) const {
+    RSYNContainer::BlockLocator locator{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cached != nullptr && cachedBlock == block) {
+            return cached;
+        }
+        if (block >= locators.size()) {
+            const std::size_t pendingIndex = block - locators.size();
+            return pendingIndex < pending.size() ? pending[pendingIndex] : nullptr;
+        }
+        locator = locators[block];
+    }
+
+    // Blocks on disk are immutable, so they are read and inflated without the lock.
+    std::vector<std::uint8_t> payload;
+    if (!RSYNContainer::readBlock(filepath, locator, payload)) {
+        return nullptr;
+    }
+    auto frames = std::make_shared<SpectralSequence>();
+    std::size_t decodedFrames = 0;
+    if (!RSYNSerialisation::decodeSampleBlock(payload, *frames, 0, {}, RSYNSpectralEncoding::Float32, decodedFrames) ||
+        decodedFrames != kBlockFrames) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    cachedBlock = block;
+    cached = std::move(frames);
+    return cached;
+}
+
+void SpectralJournal::run() {
+    for (;;) {
+        Block next;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            pendingChanged.wait(lock, [this] { return stopRequested || !pending.empty(); });
+            if (stopRequested) {
+                return;
+            }
+            next = pending.front();
+        }
+
+        if (!writeBlock(*next)) {
+            failed.store(true, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+bool SpectralJournal::writeBlock(const SpectralSequence& frames) {
+    std::vector<std::vector<std::uint8_t>> encoded;
+    if (!RSYNSerialisation::encodeSampleBlocks(frames, {}, kBlockFrames, RSYNSpectralEncoding::Float32, 0.0, encoded) ||
+        encoded.size() != 1) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> stored;
+    RSYNContainer::BlockLocator locator{};
+    if (!RSYNContainer::packBlock(encoded.front(), RSYNContainer::Compression::ShuffledDeflate, stored, locator)) {
+        return false;
+    }
+    locator.offset = static_cast<std::uint64_t>(file.tellp());
+    file.write(reinterpret_cast<const char*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+    file.flush();
+    if (!file.good()) {
+        return false;
+    }
+
+    // The block moves from pending to disk in one step, so readers always find it.
+    std::lock_guard<std::mutex> lock(mutex);
+    locators.push_back(locator);
+    pending.pop_front();
+    return true;
+}
+
+namespace RecorderJournal {
+
+SpilledFrames spilledFrames(const RecorderState& state) {
+    if (state.residentSpectra != nullptr) {
+        return {state.residentSpectra, state.samples.size()};
+    }
+    if (state.spectralJournal != nullptr && state.journalledFrames > 0) {
+        return {state.spectralJournal, state.journalledFrames};
+    }
+    return {};
+}
+
+void spillRecordedFrames(RecorderState& state) {
+    if (state.spectralJournal == nullptr) {
+        return;
+    }
+
+    constexpr std::size_t blockFrames = SpectralJournal::kBlockFrames;
+    while (state.samples.size() - state.journalledFrames >= kResidentFrames + blockFrames) {
+        if (state.spectralJournal->hasFailed()) {
+            // Frames that cannot be journalled simply stay resident.
+            return;
+        }
+        SpectralSequence frames;
+        frames.append(SpectralSequenceView(state.samples, state.journalledFrames, blockFrames));
+        state.spectralJournal->append(std::move(frames));
+        state.journalledFrames += blockFrames;
+        state.samples.releaseSpectra(state.journalledFrames);
+    }
+}
+
+SpectralSequenceView recordedFrames(const RecorderState& state,
+                                    const std::size_t firstFrame,
+                                    const std::size_t count,
+                                    SpectralSequence& scratch) {
+    const std::size_t end = std::min(firstFrame + count, state.samples.size());
+    if (firstFrame >= end) {
+        return {};
+    }
+    const SpilledFrames spilled = spilledFrames(state);
+    if (spilled.store == nullptr || firstFrame >= spilled.frameCount) {
+        return SpectralSequenceView(state.samples, firstFrame, end - firstFrame);
+    }
+
+    const std::size_t spilledEnd = std::min(end, spilled.frameCount);
+    if (!spilled.store->readFrames(firstFrame, spilledEnd - firstFrame, scratch)) {
+        // An unreadable block falls back to the spectrum-less frames left in place.
+        scratch.clear();
+        scratch.append(SpectralSequenceView(state.samples, firstFrame, spilledEnd - firstFrame));
+    }
+    scratch.append(SpectralSequenceView(state.samples, spilledEnd, end - spilledEnd));
+    return scratch;
+}
+
+bool restoreSpilledFrames(const SpilledFrames& spilled, SpectralSequence& samples) {
+    if (spilled.store == nullptr) {
+        return true;
+    }
+    const std::size_t blockFrames = spilled.store->blockFrames();
+    const std::size_t count = std::min(spilled.frameCount, samples.size());
+    SpectralSequence restoredTrack;
+    restoredTrack.reserve(samples.size());
+    SpectralSequence frames;
+    bool restored = true;
+    for (std::size_t first = 0; first < count; first += blockFrames) {
+        const std::size_t blockCount = std::min(blockFrames, count - first);
+        // A block that cannot be read keeps the copy already in samples.
+        const bool read = spilled.store->readFrames(first, blockCount, frames);
+        restored = restored && read;
+        if (restoredTrack.empty() && read) {
+            restoredTrack.setSharedFrequencies(frames.sharedFrequencies());
+        }
+        restoredTrack.append(read ? SpectralSequenceView(frames) : SpectralSequenceView(samples, first, blockCount));
+    }
+    restoredTrack.append(SpectralSequenceView(samples, count, samples.size() - count));
+    samples = std::move(restoredTrack);
+    return restored;
+}
+
+const SpectralSequence& restoredSamples(const RecorderState& state, SpectralSequence& scratch) {
+    const SpilledFrames spilled = spilledFrames(state);
+    if (spilled.store == nullptr) {
+        return state.samples;
+    }
+    scratch = state.samples;
+    restoreSpilledFrames(spilled, scratch);
+    return scratch;
+}
+
+WAVEncoder::FrameSource frameSource(SpilledFrames spilled, const SpectralSequence& samples) {
+    const std::size_t spilledCount = spilled.store != nullptr ? std::min(spilled.frameCount, samples.size()) : 0;
+    std::size_t channelCount = samples.channelCount();
+    if (spilledCount > 0) {
+        channelCount = std::max<std::size_t>(channelCount, samples.frameInfo(0).channels);
+    }
+
+    WAVEncoder::FrameSource source;
+    source.channelCount = channelCount;
+    source.frameCount = samples.size();
+    // Each synthesis thread walks its frames in order, so it keeps the block it is in, and
+    // a view's spans stay valid until that thread moves to another block. The encoder holds
+    // on to frequency spans, so those come from the store's own axes, never from a block.
+    struct ThreadBlock {
+        std::size_t block = 0;
+        SpectralSequence frames;
+    };
+    struct ThreadBlocks {
+        std::mutex mutex;
+        std::map<std::thread::id, ThreadBlock> blocks;  // Protected by mutex
+    };
+    auto threadBlocks = std::make_shared<ThreadBlocks>();
+
+    source.frameAt = [store = std::move(spilled.store), spilledCount, &samples, threadBlocks](
+                         const std::size_t channel, const std::size_t frame) {
+        SpectralFrame sample = samples[frame];
+        const bool isSpilled = frame < spilledCount;
+        if (isSpilled) {
+            ThreadBlock* current = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(threadBlocks->mutex);
+                current = &threadBlocks->blocks[std::this_thread::get_id()];
+            }
+            const std::size_t blockFrames = store->blockFrames();
+            const std::size_t block = frame / blockFrames;
+            const std::size_t blockStart = block * blockFrames;
+            if (current->block != block || current->frames.empty()) {
+                current->block = block;
+                if (!store->readFrames(blockStart, std::min(blockFrames, spilledCount - blockStart), current->frames)) {
+                    current->frames.clear();
+                }
+            }
+            if (!current->frames.empty()) {
+                sample = current->frames[frame - blockStart];
+            }
+        }
+
+        WAVEncoder::ChannelFrame view;
+        if (channel >= sample.magnitudes.size() || channel >= sample.phases.size()) {
+            return view;
+        }
+        view.magnitudes = sample.magnitudes[channel];
+        view.phases = sample.phases[channel];
+        if (isSpilled) {
+            view.frequencies = store->frequencyAxis(frame);
+        } else if (channel < sample.frequencies.size()) {
+            view.frequencies = sample.frequencies[channel];
+        }
+        view.present = true;
+        return view;
+    };
+    return source;
+}
+
+}
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "resyne/encoding/audio/wav_encoder.h"
+#include "resyne/encoding/formats/exporter.h"
+#include "resyne/encoding/formats/rsyn_container.h"
+
+namespace ReSyne {
+
+struct RecorderState;
+
+// Holds the spectra of samples that keep only their timestamps and loudness in memory.
+class SpilledSpectra {
+public:
+    virtual ~SpilledSpectra() = default;
+
+    // Safe to call from any thread.
+    virtual bool readFrames(std::size_t firstFrame, std::size_t count, SpectralSequence& frames) const = 0;
+    // Frames stored together; reading any one of them inflates the rest.
+    virtual std::size_t blockFrames() const = 0;
+    // Frequency axis of a stored frame that carries one, valid as long as the store. Frames
+    // read back hold their own copy, which only lives as long as that read.
+    virtual std::span<const float> frequencyAxis(std::size_t frame) const {
+        (void)frame;
+        return {};
+    }
+};
+
+// Append-only scratch file of recorded spectra, so a live recording keeps only a bounded
+// window of frames in memory. Frames arrive a block at a time, are encoded as RSYN SPEC
+// blocks and compressed on a writer thread, and stay readable from memory until they land.
+// The file is deleted when the journal is destroyed.
+class SpectralJournal final : public SpilledSpectra {
+public:
+    // Small enough that reading back one frame inflates little more than that frame.
+    static constexpr std::size_t kBlockFrames = 16;
+
+    SpectralJournal() = default;
+    ~SpectralJournal() override;
+
+    SpectralJournal(const SpectralJournal&) = delete;
+    SpectralJournal& operator=(const SpectralJournal&) = delete;
+
+    bool open(std::string& errorMessage);
+
+    // Takes kBlockFrames frames that follow the ones already appended and returns at once.
+    // They stay readable from memory even if writing them fails.
+    void append(SpectralSequence frames);
+
+    std::size_t frameCount() const;
+    bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+
+    // Safe to call from any thread, including while frames are being appended.
+    bool readFrames(std::size_t firstFrame, std::size_t count, SpectralSequence& frames) const override;
+    std::size_t blockFrames() const override { return kBlockFrames; }
+
+private:
+    using Block = std::shared_ptr<const SpectralSequence>;
+
+    void run();
+    bool writeBlock(const SpectralSequence& frames);
+    Block loadBlock(std::size_t block) const;
+
+    std::string filepath;
+    std::ofstream file;  // Writer thread only once open() returns
+    std::thread writer;
+    mutable std::mutex mutex;
+    std::condition_variable pendingChanged;
+    std::vector<RSYNContainer::BlockLocator> locators;  // Protected by mutex
+    std::deque<Block> pending;  // Protected by mutex; follows locators
+    bool stopRequested = false;  // Protected by mutex
+    std::atomic<bool> failed{false};
+
+    mutable std::size_t cachedBlock = 0;  // Protected by mutex
+    mutable Block cached;  // Protected by mutex
+};
+
+namespace RecorderJournal {
+
+// The first frameCount samples of a track whose spectra live in store: a recording's
+// journalled frames, or every frame of a project loaded with its spectra held compressed.
+struct SpilledFrames {
+    std::shared_ptr<const SpilledSpectra> store;
+    std::size_t frameCount = 0;
+};
+
+// Empty when every sample of the track holds its own spectra. Caller must hold samplesMutex.
+SpilledFrames spilledFrames(const RecorderState& state);
+
+// Moves the spectra of all but the most recent resident frames of a recording into its
+// journal, leaving each sample's timestamp and loudness in place and freeing every chunk of
+// the track they filled. Caller must hold samplesMutex.
+void spillRecordedFrames(RecorderState& state);
+
+// Frames [firstFrame, firstFrame + count) with their spectra. Points into state.samples
+// when they are resident and into scratch, read back from where they were spilled, when
+// they are not. Caller must hold samplesMutex.
+SpectralSequenceView recordedFrames(const RecorderState& state,
+                                    std::size_t firstFrame,
+                                    std::size_t count,
+                                    SpectralSequence& scratch);
+
+// Reads the spectra of the first spilled.frameCount samples of a copied track back in,
+// for exporters that need the full sequence.
+bool restoreSpilledFrames(const SpilledFrames& spilled, SpectralSequence& samples);
+
+// As restoreSpilledFrames, but returns state.samples itself when nothing has been spilled.
+// Caller must hold samplesMutex.
+const SpectralSequence& restoredSamples(const RecorderState& state, SpectralSequence& scratch);
+
+// Reads spilled frames straight from their store. samples must outlive the source; it only
+// needs the spectra of frames from spilled.frameCount on.
+WAVEncoder::FrameSource frameSource(SpilledFrames spilled, const SpectralSequence& samples);
+
+}
+
+}
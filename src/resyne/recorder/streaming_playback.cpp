@@ -0,0 +1,251 @@
+#include "resyne/recorder/streaming_playback.h"
+#include "resyne/recorder/recorder.h"
+#include "resyne/recorder/spectral_journal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+namespace ReSyne {
+
+namespace {
+
+constexpr std::uint64_t kSeekPending = std::uint64_t{1} << 63;
+constexpr std::uint64_t kSeekFrameMask = kSeekPending - 1;
+// Enough queued to ride out a slow hop or a held samplesMutex without underrunning, short
+// enough that a rate change follows the control closely.
+constexpr std::size_t kQueuedFrames = 8192;
+constexpr std::size_t kMinQueuedBlocks = 3;
+constexpr auto kPollInterval = std::chrono::milliseconds(2);
+
+float clampedRate(const float rate) {
+    return std::isfinite(rate) ? std::clamp(rate, StreamingPlayback::kMinRate, StreamingPlayback::kMaxRate) : 1.0f;
+}
+
+}
+
+std::size_t StreamingPlayback::trackLength(const std::size_t frameCount, const int fftSize, const int hopSize) {
+    return frameCount > 0 && fftSize > 0 && hopSize > 0
+        ? (frameCount - 1) * static_cast<std::size_t>(hopSize) + static_cast<std::size_t>(fftSize)
+        : 0;
+}
+
+void StreamingPlayback::FrameCopy::assign(const SpectralFrame& sample, const std::size_t channelCount) {
+    magnitudes.resize(channelCount);
+    phases.resize(channelCount);
+    present.assign(channelCount, 0);
+    for (std::size_t channel = 0; channel < channelCount; ++channel) {
+        // Frames a hydration has not reached yet have no spectra and play as silence.
+        if (channel >= sample.magnitudes.size() || channel >= sample.phases.size() ||
+            sample.magnitudes[channel].empty()) {
+            continue;
+        }
+        magnitudes[channel].assign(sample.magnitudes[channel].begin(), sample.magnitudes[channel].end());
+        phases[channel].assign(sample.phases[channel].begin(), sample.phases[channel].end());
+        present[channel] = 1;
+    }
+}
+
+WAVEncoder::ChannelFrame StreamingPlayback::FrameCopy::view(const std::size_t channel) const {
+    WAVEncoder::ChannelFrame frame;
+    if (channel < present.size() && present[channel] != 0) {
+        frame.magnitudes = magnitudes[channel];
+        frame.phases = phases[channel];
+        frame.present = true;
+    }
+    return frame;
+}
+
+StreamingPlayback::~StreamingPlayback() {
+    stop();
+}
+
+std::shared_ptr<PlaybackStream> StreamingPlayback::start(RecorderState& state,
+                                                         const std::size_t trackFrame,
+                                                         const float playbackRate,
+                                                         const bool loopEnabled) {
+    stop();
+
+    std::size_t channelCount = 0;
+    std::size_t frameCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(state.samplesMutex);
+        if (state.samples.empty()) {
+            return nullptr;
+        }
+        fftSize = state.metadata.fftSize;
+        hopSize = state.metadata.hopSize;
+        channelCount = state.samples.front().channels > 0 ? state.samples.front().channels
+                                                          : std::max<std::uint32_t>(1, state.metadata.channels);
+        frameCount = state.samples.size();
+    }
+    if (fftSize <= 0 || hopSize <= 0 || hopSize > fftSize) {
+        return nullptr;
+    }
+
+    vocoders.clear();
+    try {
+        for (std::size_t channel = 0; channel < channelCount; ++channel) {
+            vocoders.push_back(std::make_unique<StreamingVocoder>(fftSize, hopSize));
+        }
+    } catch (const std::runtime_error&) {
+        vocoders.clear();
+        return nullptr;
+    }
+
+    const std::size_t hop = static_cast<std::size_t>(hopSize);
+    channelHop.assign(hop, 0.0f);
+    stream = std::make_shared<PlaybackStream>(channelCount, hop,
+                                              std::max(kMinQueuedBlocks, (kQueuedFrames + hop - 1) / hop));
+    stream->setTrackFrames(trackLength(frameCount, fftSize, hopSize));
+    stream->beginGeneration(static_cast<double>(trackFrame));
+    rate.store(clampedRate(playbackRate), std::memory_order_relaxed);
+    loop.store(loopEnabled, std::memory_order_relaxed);
+    pendingSeek.store(0, std::memory_order_relaxed);
+    stopRequested.store(false, std::memory_order_relaxed);
+    worker = std::thread(&StreamingPlayback::run, this, std::ref(state),
+                         static_cast<double>(trackFrame) / static_cast<double>(hop));
+    return stream;
+}
+
+void StreamingPlayback::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    stopRequested.store(true, std::memory_order_release);
+    worker.join();
+    stream.reset();
+    vocoders.clear();
+}
+
+void StreamingPlayback::setRate(const float playbackRate) {
+    rate.store(clampedRate(playbackRate), std::memory_order_relaxed);
+}
+
+void StreamingPlayback::seek(const std::size_t trackFrame) {
+    pendingSeek.store(kSeekPending | std::min<std::uint64_t>(trackFrame, kSeekFrameMask), std::memory_order_release);
+}
+
+void StreamingPlayback::run(RecorderState& state, double position) {
+    const double hop = static_cast<double>(hopSize);
+    // The hop the vocoders have rendered but not yet let out, and the rate it was rendered at.
+    double queuedPosition = position;
+    double queuedRate = 1.0;
+    bool needsRestart = true;
+    bool ended = false;
+
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        const std::uint64_t command = pendingSeek.exchange(0, std::memory_order_acquire);
+        if ((command & kSeekPending) != 0) {
+            const double trackFrame = static_cast<double>(command & kSeekFrameMask);
+            stream->beginGeneration(trackFrame);
+            position = trackFrame / hop;
+            needsRestart = true;
+            ended = false;
+        }
+
+        float* block = ended ? nullptr : stream->beginBlock();
+        if (block == nullptr) {
+            std::this_thread::sleep_for(kPollInterval);
+            continue;
+        }
+
+        const double hopRate = static_cast<double>(rate.load(std::memory_order_relaxed));
+        const std::size_t frameCount = copyFrames(state, static_cast<std::size_t>(position));
+        if (frameCount == 0) {
+            std::this_thread::sleep_for(kPollInterval);
+            continue;
+        }
+        const double lastFrame = static_cast<double>(frameCount - 1);
+
+        if (needsRestart) {
+            needsRestart = false;
+            position = std::min(position, lastFrame);
+            restart(state, position);
+            queuedPosition = position;
+            queuedRate = hopRate;
+            position += hopRate;
+            continue;
+        }
+
+        if (position > lastFrame) {
+            const bool looping = loop.load(std::memory_order_relaxed);
+            stream->commitBlock(finishHop(block), queuedPosition * hop, queuedRate, !looping);
+            if (looping) {
+                position = 0.0;
+                needsRestart = true;
+            } else {
+                ended = true;
+            }
+            continue;
+        }
+
+        const std::size_t frames = renderHop(position, block);
+        if (frames > 0) {
+            stream->commitBlock(frames, queuedPosition * hop, queuedRate, false);
+        }
+        queuedPosition = position;
+        queuedRate = hopRate;
+        position += hopRate;
+    }
+}
+
+std::size_t StreamingPlayback::copyFrames(RecorderState& state, const std::size_t first) {
+    std::lock_guard<std::mutex> lock(state.samplesMutex);
+    const std::size_t frameCount = state.samples.size();
+    stream->setTrackFrames(trackLength(frameCount, fftSize, hopSize));
+    if (first >= frameCount) {
+        return frameCount;
+    }
+    const SpectralSequenceView frames = RecorderJournal::recordedFrames(state, first, 2, scratch);
+    if (frames.empty()) {
+        return frameCount;
+    }
+    before.assign(frames.front(), vocoders.size());
+    after.assign(frames.back(), vocoders.size());
+    return frameCount;
+}
+
+void StreamingPlayback::restart(RecorderState& state, const double position) {
+    for (const auto& vocoder : vocoders) {
+        vocoder->reset();
+    }
+    const std::size_t frame = static_cast<std::size_t>(position);
+    const std::size_t reach = static_cast<std::size_t>(fftSize - 1) / static_cast<std::size_t>(hopSize);
+    for (std::size_t replayed = frame - std::min(frame, reach); replayed < frame; ++replayed) {
+        copyFrames(state, replayed);
+        renderHop(static_cast<double>(replayed), nullptr);
+    }
+    copyFrames(state, frame);
+    renderHop(position, nullptr);
+}
+
+std::size_t StreamingPlayback::renderHop(const double position, float* block) {
+    const float fraction = static_cast<float>(position - std::floor(position));
+    const std::size_t channelCount = vocoders.size();
+    std::size_t frames = 0;
+    for (std::size_t channel = 0; channel < channelCount; ++channel) {
+        const std::span<float> output = block != nullptr ? std::span<float>(channelHop) : std::span<float>();
+        frames = vocoders[channel]->renderHop(before.view(channel), after.view(channel), fraction, output);
+        for (std::size_t i = 0; block != nullptr && i < frames; ++i) {
+            block[i * channelCount + channel] = channelHop[i];
+        }
+    }
+    return frames;
+}
+
+std::size_t StreamingPlayback::finishHop(float* block) {
+    const std::size_t channelCount = vocoders.size();
+    std::size_t frames = 0;
+    for (std::size_t channel = 0; channel < channelCount; ++channel) {
+        frames = vocoders[channel]->finish(channelHop);
+        for (std::size_t i = 0; i < frames; ++i) {
+            block[i * channelCount + channel] = channelHop[i];
+        }
+    }
+    return frames;
+}
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audio/output/playback_stream.h"
+#include "resyne/encoding/audio/streaming_vocoder.h"
+#include "resyne/encoding/formats/exporter.h"
+
+namespace ReSyne {
+
+struct RecorderState;
+
+// Plays RecorderState::samples straight from their spectra at any rate, without
+// reconstructing the track first. A render thread runs one StreamingVocoder per channel a
+// hop at a time into a PlaybackStream for AudioOutput, copying the two frames each hop
+// falls between under samplesMutex, so an edit to the frames is heard as soon as the
+// queued hops ahead of it have played. Pitch stays put whatever the rate. A seek drops the
+// queued hops and is heard about a hop later; a rate change is heard once the queue, a
+// little under 200 ms at 48 kHz, has played out.
+class StreamingPlayback {
+public:
+    static constexpr float kMinRate = 0.25f;
+    static constexpr float kMaxRate = 4.0f;
+
+    StreamingPlayback() = default;
+    ~StreamingPlayback();
+
+    StreamingPlayback(const StreamingPlayback&) = delete;
+    StreamingPlayback& operator=(const StreamingPlayback&) = delete;
+
+    // Starts rendering from trackFrame, in samples, replacing any playback already running.
+    // The stream is for AudioOutput::setPlaybackStream; null when the track has no frames
+    // or no usable analysis settings.
+    std::shared_ptr<PlaybackStream> start(RecorderState& state, std::size_t trackFrame, float rate, bool loop);
+    // Must not be called with samplesMutex held; the render thread needs it to finish a hop.
+    void stop();
+    bool isRunning() const { return worker.joinable(); }
+    // True once a track that does not loop has played to its end.
+    bool hasEnded() const { return stream && stream->hasEnded(); }
+
+    void setRate(float rate);
+    void setLoopEnabled(bool enabled) { loop.store(enabled, std::memory_order_relaxed); }
+    void seek(std::size_t trackFrame);
+
+    std::uint64_t getUnderruns() const { return stream ? stream->getUnderruns() : 0; }
+
+    // Samples a track of frameCount frames synthesises to.
+    static std::size_t trackLength(std::size_t frameCount, int fftSize, int hopSize);
+
+private:
+    // One frame's spectra per channel, copied out so synthesis runs without samplesMutex.
+    struct FrameCopy {
+        std::vector<std::vector<float>> magnitudes;
+        std::vector<std::vector<float>> phases;
+        std::vector<std::uint8_t> present;
+
+        void assign(const SpectralFrame& sample, std::size_t channelCount);
+        WAVEncoder::ChannelFrame view(std::size_t channel) const;
+    };
+
+    void run(RecorderState& state, double position);
+    // Copies the frame at first and the one after it, or first again at the end of the
+    // track, and returns how many frames the track has.
+    std::size_t copyFrames(RecorderState& state, std::size_t first);
+    // Starts the vocoders again at position, first replaying the frames whose windows reach
+    // it so the hop there comes out whole.
+    void restart(RecorderState& state, double position);
+    // Null discards the hop that comes out.
+    std::size_t renderHop(double position, float* block);
+    std::size_t finishHop(float* block);
+
+    std::shared_ptr<PlaybackStream> stream;
+    std::thread worker;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<float> rate{1.0f};
+    std::atomic<bool> loop{true};
+    std::atomic<std::uint64_t> pendingSeek{0};
+
+    // Owned by the render thread once start() has started it.
+    int fftSize = 0;
+    int hopSize = 0;
+    std::vector<std::unique_ptr<StreamingVocoder>> vocoders;
+    FrameCopy before;
+    FrameCopy after;
+    SpectralSequence scratch;
+    std::vector<float> channelHop;
+};
+
+}
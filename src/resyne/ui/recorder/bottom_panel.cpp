@@ -50,21 +50,26 @@ void Recorder::drawBottomPanel(RecorderState& state,
     size_t sampleCount = 0;
     double duration = 0.0;
     bool hasData = false;
-    std::vector<ReSyne::Timeline::TimelineSample> previewData;
+    ReSyne::UI::TimelinePreview previewData;
 
     {
         std::lock_guard<std::mutex> lock(state.samplesMutex);
 
         const bool usePreview = state.importPhase == 3 && state.previewReady.load(std::memory_order_acquire);
         const auto& sourceSamples = usePreview ? state.previewSamples : state.samples;
+        // An .rsyn being opened draws its embedded preview in place of the current track.
+        const bool useStoredPreview = state.importPhase == 3 && !usePreview && state.storedPreview != nullptr;
 
-        sampleCount = sourceSamples.size();
-        if (sampleCount == 0 && !usePreview && state.metadata.presentationData != nullptr) {
+        sampleCount = useStoredPreview ? 0 : sourceSamples.size();
+        if (sampleCount == 0 && !usePreview && !useStoredPreview && state.metadata.presentationData != nullptr) {
             sampleCount = state.metadata.presentationData->frames.size();
         }
-        hasData = sampleCount > 0;
+        hasData = sampleCount > 0 || useStoredPreview;
 
-        if (hasData) {
+        if (useStoredPreview) {
+            duration = state.storedPreview->lastTimestamp;
+            previewData = ReSyne::UI::samplePreviewData(state, ReSyne::UI::MAX_PREVIEW_SAMPLES_BOTTOM_PANEL, lock);
+        } else if (hasData) {
             if (!state.playbackAudio.empty() && state.metadata.sampleRate > 0.0f) {
                 const uint32_t numChannels = state.metadata.channels > 0 ? state.metadata.channels : 1;
                 const size_t totalFrames = state.playbackAudio.size() / numChannels;
@@ -82,7 +87,7 @@ void Recorder::drawBottomPanel(RecorderState& state,
 
     if (hasData) {
         ReSyne::Timeline::RenderContext timelineContext{
-            previewData,
+            *previewData,
             state.timelinePreviewCacheRevision,
             duration,
             gradientSize,
@@ -98,7 +103,8 @@ void Recorder::drawBottomPanel(RecorderState& state,
             !state.timeline.trackScrubber,
             &state.toolState,
             &state.trackpadInput,
-            state.presentationResources
+            state.presentationResources,
+            state.timelinePreviewCacheRetainedCount
         };
 
         if (!state.timeline.isScrubberDragging && timelineContext.playbackNormalisedPosition.has_value()) {
@@ -146,8 +152,10 @@ void Recorder::drawBottomPanel(RecorderState& state,
     const float transportButtonSize = buttonHeight;
     const int toolbarButtonCount = 3;
     const int transportButtonCount = 3;
+    const float rateFieldWidth = 64.0f;
     const float playbackWidth = transportButtonCount * transportButtonSize +
-                                std::max(0, transportButtonCount - 1) * transportSpacing;
+                                std::max(0, transportButtonCount - 1) * transportSpacing +
+                                transportSpacing + rateFieldWidth;
     const float toolbarWidth = toolbarButtonCount * transportButtonSize +
                                std::max(0, toolbarButtonCount - 1) * toolbarButtonSpacing;
     const float controlsSpacing = transportSpacing * 1.5f;
@@ -220,6 +228,7 @@ void Recorder::drawBottomPanel(RecorderState& state,
             if (state.audioOutput) {
                 state.audioOutput->setLoopEnabled(state.loopEnabled);
             }
+            state.streamingPlayback.setLoopEnabled(state.loopEnabled);
         }
         ImGui::PopStyleColor();
         if (ImGui::IsItemHovered()) {
@@ -247,6 +256,9 @@ void Recorder::drawBottomPanel(RecorderState& state,
         if (ImGui::IsItemHovered()) {
             ImGui::SetTooltip(isPlaying ? "Pause" : "Play");
         }
+
+        ImGui::SameLine(0.0f, transportSpacing);
+        UI::renderPlaybackRateControl(state, rateFieldWidth, transportButtonSize);
         ImGui::EndDisabled();
 
         ImGui::TableSetColumnIndex(2);
@@ -1,6 +1,7 @@
 #include "resyne/recorder/recorder.h"
 
 #include "imgui.h"
+#include "resyne/encoding/formats/mp4_libav_writer.h"
 #include "utilities/video/ffmpeg_locator.h"
 
 namespace ReSyne {
@@ -59,7 +60,8 @@ void Recorder::drawExportDialog(RecorderState& state) {
         }
 
         auto& ffmpegLocator = Utilities::Video::FFmpegLocator::instance();
-        const bool ffmpegAvailable = ffmpegLocator.isAvailable();
+        const bool ffmpegAvailable = ffmpegLocator.isAvailable() ||
+                                     ReSyne::Encoding::Video::LibavMP4Writer::isAvailable();
 
         if (ffmpegAvailable) {
             ImGui::Spacing();
@@ -86,6 +88,44 @@ void Recorder::drawExportDialog(RecorderState& state) {
             }
         }
 
+        ImGui::Spacing();
+        ImGui::Separator();
+        ImGui::Spacing();
+        ImGui::Text("Several at once:");
+        ImGui::Spacing();
+
+        const auto targetCheckbox = [&state](const char* label, const RecorderExportFormat format) {
+            ImGui::Checkbox(label, &state.exportTargetSelected[static_cast<size_t>(format)]);
+            ImGui::SameLine();
+        };
+        targetCheckbox("WAV##target", RecorderExportFormat::WAV);
+        targetCheckbox("TIFF##target", RecorderExportFormat::TIFF);
+        targetCheckbox(".rsyn##target", RecorderExportFormat::RSYN);
+        if (ffmpegAvailable) {
+            targetCheckbox("MP4##target", RecorderExportFormat::MP4);
+        } else {
+            state.exportTargetSelected[static_cast<size_t>(RecorderExportFormat::MP4)] = false;
+        }
+
+        std::vector<RecorderExportFormat> targets;
+        for (const auto format : {RecorderExportFormat::WAV, RecorderExportFormat::TIFF,
+                                  RecorderExportFormat::RSYN, RecorderExportFormat::MP4}) {
+            if (state.exportTargetSelected[static_cast<size_t>(format)]) {
+                targets.push_back(format);
+            }
+        }
+        ImGui::BeginDisabled(targets.size() < 2);
+        if (ImGui::Button("Export selected", ImVec2(BUTTON_WIDTH, 0.0f))) {
+            state.pendingExportTargets = std::move(targets);
+            state.shouldOpenSaveDialog = true;
+            state.showExportDialog = false;
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+            ImGui::SetTooltip("Export the ticked formats in one pass,\nsharing the reconstructed audio");
+        }
+
         ImGui::EndPopup();
     }
 
@@ -32,7 +32,7 @@ void Recorder::drawExportingDialog(RecorderState& state) {
         ImGui::Separator();
         ImGui::Spacing();
 
-        const float currentProgress = state.exportProgressAtomic.load(std::memory_order_acquire);
+        const float currentProgress = state.exportTask.progress();
 
         constexpr float PROGRESS_BAR_WIDTH = 400.0f;
         ImGui::ProgressBar(currentProgress, ImVec2(PROGRESS_BAR_WIDTH, 0.0f));
@@ -46,7 +46,21 @@ void Recorder::drawExportingDialog(RecorderState& state) {
             ImGui::PopStyleColor();
         }
 
-        if (state.exportComplete.load(std::memory_order_acquire)) {
+        if (!state.exportTask.isFinished()) {
+            ImGui::Spacing();
+            const bool cancelling = state.exportTask.isCancelled();
+            ImGui::BeginDisabled(cancelling);
+            if (ImGui::Button(cancelling ? "Cancelling..." : "Cancel", ImVec2(120, 0))) {
+                state.exportTask.cancel();
+            }
+            ImGui::EndDisabled();
+        } else if (state.exportTask.isCancelled()) {
+            state.showExportingDialog = false;
+            setExportOperationStatus(state, {});
+            state.statusMessage = "Export cancelled";
+            state.statusMessageTimer = 4.0f;
+            ImGui::CloseCurrentPopup();
+        } else {
             std::string errorMsg;
             {
                 std::lock_guard<std::mutex> lock(state.samplesMutex);
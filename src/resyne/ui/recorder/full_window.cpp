@@ -58,13 +58,17 @@ void Recorder::drawFullWindow(RecorderState& state,
 
         const bool hasPreview = state.importPhase == 3 && !state.previewSamples.empty();
         const auto& sourceSamples = hasPreview ? state.previewSamples : state.samples;
+        // An .rsyn being opened draws its embedded preview in place of the current track.
+        const bool useStoredPreview = state.importPhase == 3 && !hasPreview && state.storedPreview != nullptr;
 
-        sampleCount = sourceSamples.size();
-        if (sampleCount == 0 && !hasPreview && state.metadata.presentationData != nullptr) {
+        sampleCount = useStoredPreview ? 0 : sourceSamples.size();
+        if (sampleCount == 0 && !hasPreview && !useStoredPreview && state.metadata.presentationData != nullptr) {
             sampleCount = state.metadata.presentationData->frames.size();
         }
-        hasData = sampleCount > 0;
-        if (hasData) {
+        hasData = sampleCount > 0 || useStoredPreview;
+        if (useStoredPreview) {
+            duration = state.storedPreview->lastTimestamp;
+        } else if (hasData) {
             if (!state.playbackAudio.empty() && sampleRate > 0.0f) {
                 const uint32_t numChannels = state.metadata.channels > 0 ? state.metadata.channels : 1;
                 const size_t totalFrames = state.playbackAudio.size() / numChannels;
@@ -121,7 +125,7 @@ void Recorder::drawFullWindow(RecorderState& state,
     const float availableHeight = ImGui::GetContentRegionAvail().y - CONTROL_HEIGHT;
     const ImVec2 gradientSize(ImGui::GetContentRegionAvail().x, availableHeight);
 
-    std::vector<ReSyne::Timeline::TimelineSample> previewData;
+    ReSyne::UI::TimelinePreview previewData;
     if (hasData) {
         std::lock_guard<std::mutex> lock(state.samplesMutex);
         previewData = ReSyne::UI::samplePreviewData(state, ReSyne::UI::MAX_PREVIEW_SAMPLES_FULL_WINDOW, lock);
@@ -129,7 +133,7 @@ void Recorder::drawFullWindow(RecorderState& state,
 
     if (hasData) {
         ReSyne::Timeline::RenderContext timelineContext{
-            previewData,
+            *previewData,
             state.timelinePreviewCacheRevision,
             duration,
             gradientSize,
@@ -145,7 +149,8 @@ void Recorder::drawFullWindow(RecorderState& state,
             !state.timeline.trackScrubber,
             &state.toolState,
             &state.trackpadInput,
-            state.presentationResources
+            state.presentationResources,
+            state.timelinePreviewCacheRetainedCount
         };
 
         if (!state.timeline.isScrubberDragging && timelineContext.playbackNormalisedPosition.has_value()) {
@@ -232,10 +237,12 @@ void Recorder::drawFullWindow(RecorderState& state,
 
     const int toolbarButtonCount = 3;
     const int transportButtonCount = 3;
+    const float rateFieldWidth = 64.0f;
     const float toolbarButtonSpacing = 4.0f;
     const float transportSpacing = BUTTON_SPACING;
     const float playbackWidth = transportButtonCount * BUTTON_HEIGHT +
-                                std::max(0, transportButtonCount - 1) * transportSpacing;
+                                std::max(0, transportButtonCount - 1) * transportSpacing +
+                                transportSpacing + rateFieldWidth;
     const float toolbarWidth = toolbarButtonCount * BUTTON_HEIGHT +
                                std::max(0, toolbarButtonCount - 1) * toolbarButtonSpacing;
     const float controlsSpacing = transportSpacing * 1.5f;
@@ -300,6 +307,7 @@ void Recorder::drawFullWindow(RecorderState& state,
             if (state.audioOutput) {
                 state.audioOutput->setLoopEnabled(state.loopEnabled);
             }
+            state.streamingPlayback.setLoopEnabled(state.loopEnabled);
         }
 
         ImGui::SameLine(0.0f, transportSpacing);
@@ -317,6 +325,9 @@ void Recorder::drawFullWindow(RecorderState& state,
                 startPlayback(state);
             }
         }
+
+        ImGui::SameLine(0.0f, transportSpacing);
+        UI::renderPlaybackRateControl(state, rateFieldWidth, BUTTON_HEIGHT);
         ImGui::EndDisabled();
 
         ImGui::TableSetColumnIndex(2);
@@ -44,6 +44,17 @@ void Recorder::drawLoadingDialog(RecorderState& state) {
             ImGui::PopStyleColor();
         }
 
+        // The import handler closes the dialog once the task has wound down.
+        if (state.importTask.valid() && !state.importTask.isFinished()) {
+            ImGui::Spacing();
+            const bool cancelling = state.importTask.isCancelled();
+            ImGui::BeginDisabled(cancelling);
+            if (ImGui::Button(cancelling ? "Cancelling..." : "Cancel", ImVec2(120, 0))) {
+                state.importTask.cancel();
+            }
+            ImGui::EndDisabled();
+        }
+
         ImGui::EndPopup();
     }
 }
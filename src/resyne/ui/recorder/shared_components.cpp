@@ -2,7 +2,12 @@
 
 #include <array>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
 
 #include "imgui.h"
 
@@ -10,8 +15,10 @@
 #include "audio/analysis/presentation/spectral_presentation.h"
 #include "colour/colour_core.h"
 #include "resyne/recorder/colour_cache_utils.h"
+#include "resyne/recorder/spectral_journal.h"
 #include "ui/smoothing/smoothing.h"
 #include "ui/smoothing/smoothing_features.h"
+#include "utilities/threading/task_scheduler.h"
 
 namespace ReSyne::UI {
 
@@ -70,10 +77,39 @@ SpectralPresentation::Settings buildPresentationSettings(const RecorderColourCac
     return presentation;
 }
 
-Timeline::TimelineSample buildTimelineSample(const AudioColourSample& sample,
-                                             const AudioColourSample* previousSample,
-                                             const RecorderColourCache::CacheSettings& settings) {
+ColourCore::OutputSettings buildOutputSettings(const RecorderColourCache::CacheSettings& settings) {
+    return ColourCore::OutputSettings{
+        .colourSpace = settings.colourSpace,
+        .applyGamutMapping = settings.gamutMapping
+    };
+}
+
+bool sameOutputSettings(const RecorderColourCache::CacheSettings& a, const RecorderColourCache::CacheSettings& b) {
+    return a.colourSpace == b.colourSpace && a.gamutMapping == b.gamutMapping;
+}
+
+// Projects each sample's XYZ into the output colour space, keeping its Lab, which does not
+// depend on it.
+void reprojectColours(std::span<Timeline::TimelineSample> samples,
+                      std::span<const ColourCore::XYZ> xyz,
+                      const RecorderColourCache::CacheSettings& settings) {
+    std::vector<ColourCore::RGB> rgb(std::min(samples.size(), xyz.size()));
+    ColourCore::projectToRGB(xyz.first(rgb.size()), rgb, buildOutputSettings(settings));
+    for (size_t i = 0; i < rgb.size(); ++i) {
+        samples[i].colour = ImVec4(
+            std::clamp(rgb[i].r, 0.0f, 1.0f),
+            std::clamp(rgb[i].g, 0.0f, 1.0f),
+            std::clamp(rgb[i].b, 0.0f, 1.0f),
+            1.0f);
+    }
+}
+
+Timeline::TimelineSample buildTimelineSample(const SpectralFrame& sample,
+                                             const SpectralFrame* previousSample,
+                                             const RecorderColourCache::CacheSettings& settings,
+                                             ColourCore::XYZ& xyz) {
     const auto entry = RecorderColourCache::computeSampleColour(sample, settings, previousSample);
+    xyz = entry.xyz;
     Timeline::TimelineSample output{};
     output.timestamp = sample.timestamp;
     output.colour = entry.rgb;
@@ -110,11 +146,25 @@ Timeline::TimelineSample buildTimelineSampleFromStoredFrame(
     return output;
 }
 
+ColourCore::XYZ storedFrameXYZ(const RSYNPresentationFrame& frame, const bool useSmoothedTrack) {
+    if (!useSmoothedTrack) {
+        return ColourCore::XYZ{frame.analysis.X, frame.analysis.Y, frame.analysis.Z};
+    }
+    ColourCore::XYZ xyz{};
+    ColourCore::OklabtoXYZ(frame.smoothedOklab[0], frame.smoothedOklab[1], frame.smoothedOklab[2],
+                           xyz.X, xyz.Y, xyz.Z);
+    return xyz;
+}
+
+// A stored track made for another output colour space or gamut mapping is still usable;
+// reproject is set when its colours need projecting again from its XYZ.
 bool canUseStoredPresentation(const RecorderState& state,
                               const RecorderColourCache::CacheSettings& settings,
                               const bool usePreview,
-                              bool& useSmoothedTrack) {
+                              bool& useSmoothedTrack,
+                              bool& reproject) {
     useSmoothedTrack = false;
+    reproject = false;
 
     if (usePreview || state.metadata.presentationData == nullptr) {
         return false;
@@ -131,14 +181,14 @@ bool canUseStoredPresentation(const RecorderState& state,
 
     const auto& storedSettings = presentation.settings;
     const bool baseSettingsMatch =
-        storedSettings.colourSpace == settings.colourSpace &&
-        storedSettings.applyGamutMapping == settings.gamutMapping &&
         nearlyEqual(storedSettings.lowGain, settings.lowGain) &&
         nearlyEqual(storedSettings.midGain, settings.midGain) &&
         nearlyEqual(storedSettings.highGain, settings.highGain);
     if (!baseSettingsMatch) {
         return false;
     }
+    reproject = storedSettings.colourSpace != settings.colourSpace ||
+        storedSettings.applyGamutMapping != settings.gamutMapping;
 
     if (!settings.smoothingEnabled) {
         useSmoothedTrack = false;
@@ -189,158 +239,118 @@ void timelineSampleToOklab(const Timeline::TimelineSample& sample,
     ColourCore::XYZtoOklab(X, Y, Z, outL, outA, outB);
 }
 
-void applyPreviewSmoothing(std::vector<Timeline::TimelineSample>& previewData,
-                           const std::vector<AudioColourSample>& sourceSamples,
-                           const std::vector<size_t>& sampledIndices,
-                           const RecorderColourCache::CacheSettings& settings) {
-    if (!settings.smoothingEnabled || previewData.size() < 2) {
-        return;
-    }
-
-    SpringSmoother smoother(8.0f, 1.0f, 0.3f);
-    smoother.setSmoothingAmount(settings.smoothingAmount);
-    const auto presentationSettings = buildPresentationSettings(settings);
-    if (settings.manualSmoothing) {
-        if (!sampledIndices.empty() && sampledIndices.front() < sourceSamples.size()) {
-            const size_t initialIndex = sampledIndices.front();
-            const auto& initialSample = sourceSamples[initialIndex];
-            const AudioColourSample* initialPreviousSample =
-                initialIndex > 0 ? &sourceSamples[initialIndex - 1] : nullptr;
-            const auto initialPreparedFrame = SpectralPresentation::SampleSequence::prepareSampleFrame(
-                initialSample,
-                presentationSettings,
-                initialPreviousSample);
-            float initialL = 0.0f;
-            float initialA = 0.0f;
-            float initialB = 0.0f;
-            ColourCore::XYZtoOklab(
-                initialPreparedFrame.colourResult.X,
-                initialPreparedFrame.colourResult.Y,
-                initialPreparedFrame.colourResult.Z,
-                initialL,
-                initialA,
-                initialB);
-            smoother.resetOklab(initialL, initialA, initialB);
-        } else {
-            float initialL = 0.0f;
-            float initialA = 0.0f;
-            float initialB = 0.0f;
-            timelineSampleToOklab(previewData.front(), initialL, initialA, initialB);
-            smoother.resetOklab(initialL, initialA, initialB);
-        }
+void preparedOklab(const SpectralPresentation::PreparedFrame& frame, float& outL, float& outA, float& outB) {
+    ColourCore::XYZtoOklab(frame.colourResult.X, frame.colourResult.Y, frame.colourResult.Z, outL, outA, outB);
+}
+
+// Everything but the output colour space and gamut mapping, which only reproject.
+bool sameAnalysisSettings(const RecorderColourCache::CacheSettings& a, const RecorderColourCache::CacheSettings& b) {
+    return a.lowGain == b.lowGain &&
+        a.midGain == b.midGain &&
+        a.highGain == b.highGain &&
+        a.smoothingEnabled == b.smoothingEnabled &&
+        a.manualSmoothing == b.manualSmoothing &&
+        a.smoothingAmount == b.smoothingAmount;
+}
+
+// Colour for one sampled source frame. It depends only on that frame and the one before
+// it, so frames can be prepared on any thread and pushed through the smoother afterwards.
+struct PreparedPreviewFrame {
+    Timeline::TimelineSample unsmoothed{};
+    ColourCore::XYZ unsmoothedXYZ{};
+    SpectralPresentation::PreparedFrame prepared;
+};
 
-        for (size_t index = 1; index < previewData.size(); ++index) {
-            const double deltaSeconds = previewData[index].timestamp - previewData[index - 1].timestamp;
-            const float deltaTime = std::isfinite(deltaSeconds) && deltaSeconds > 0.0
-                ? static_cast<float>(deltaSeconds)
-                : (1.0f / 60.0f);
-
-            if (index < sampledIndices.size() && sampledIndices[index] < sourceSamples.size()) {
-                const size_t sampleIndex = sampledIndices[index];
-                const auto& currentSample = sourceSamples[sampleIndex];
-                const AudioColourSample* previousSample =
-                    sampleIndex > 0 ? &sourceSamples[sampleIndex - 1] : nullptr;
-                const auto preparedFrame = SpectralPresentation::SampleSequence::prepareSampleFrame(
-                    currentSample,
-                    presentationSettings,
-                    previousSample);
-                float targetL = 0.0f;
-                float targetA = 0.0f;
-                float targetB = 0.0f;
-                ColourCore::XYZtoOklab(
-                    preparedFrame.colourResult.X,
-                    preparedFrame.colourResult.Y,
-                    preparedFrame.colourResult.Z,
-                    targetL,
-                    targetA,
-                    targetB);
-                smoother.setTargetOklab(targetL, targetA, targetB);
-            } else {
-                float targetL = 0.0f;
-                float targetA = 0.0f;
-                float targetB = 0.0f;
-                timelineSampleToOklab(previewData[index], targetL, targetA, targetB);
-                smoother.setTargetOklab(targetL, targetA, targetB);
+}
+
+// Builds the preview one sampled source frame at a time. The smoother and flux history
+// carry over between calls, so frames appended to a growing source extend the preview
+// exactly as a rebuild would, without revisiting the frames already sampled.
+class TimelinePreviewBuilder {
+public:
+    // A non-zero stride samples every stride-th frame, which keeps the sampled indices
+    // stable as the source grows; zero means indices are chosen by the caller.
+    TimelinePreviewBuilder(const RecorderColourCache::CacheSettings& settings, const size_t stride)
+        : settings_(settings),
+          unsmoothedSettings_(settings),
+          presentationSettings_(buildPresentationSettings(settings)),
+          stride_(stride) {
+        unsmoothedSettings_.smoothingEnabled = false;
+        unsmoothedSettings_.smoothingAmount = 0.0f;
+        smoother_.setSmoothingAmount(settings.smoothingAmount);
+    }
+
+    [[nodiscard]] const std::vector<Timeline::TimelineSample>& preview() const { return preview_; }
+    [[nodiscard]] const RecorderColourCache::CacheSettings& settings() const { return settings_; }
+    [[nodiscard]] size_t stride() const { return stride_; }
+
+    [[nodiscard]] bool canExtendTo(const size_t sourceCount, const size_t maxSamples) const {
+        return stride_ > 0 && sourceCount >= nextIndex_ && (sourceCount + stride_ - 1) / stride_ <= maxSamples;
+    }
+
+    // Source indices a build over sourceCount frames would sample next, in order.
+    [[nodiscard]] std::vector<size_t> pendingIndices(const size_t sourceCount, const size_t maxSamples) const {
+        std::vector<size_t> indices;
+        if (stride_ > 0) {
+            for (size_t index = nextIndex_; index < sourceCount; index += stride_) {
+                indices.push_back(index);
+            }
+        } else if (preview_.empty()) {
+            indices.reserve(maxSamples);
+            const double step = static_cast<double>(sourceCount) / static_cast<double>(maxSamples);
+            for (size_t i = 0; i < maxSamples; ++i) {
+                indices.push_back(static_cast<size_t>(static_cast<double>(i) * step));
             }
-            smoother.update(deltaTime * 1.2f);
-
-            float smoothedL = 0.0f;
-            float smoothedA = 0.0f;
-            float smoothedB = 0.0f;
-            smoother.getCurrentOklab(smoothedL, smoothedA, smoothedB);
-            float smoothedX = 0.0f;
-            float smoothedY = 0.0f;
-            float smoothedZ = 0.0f;
-            ColourCore::OklabtoXYZ(smoothedL, smoothedA, smoothedB, smoothedX, smoothedY, smoothedZ);
-            previewData[index] = buildTimelineSampleFromXYZ(
-                previewData[index].timestamp,
-                smoothedX,
-                smoothedY,
-                smoothedZ,
-                settings);
         }
+        return indices;
+    }
 
-        return;
+    void extend(const SpectralSequence& sourceSamples, const size_t sourceCount) {
+        for (const size_t index : pendingIndices(sourceCount, 0)) {
+            append(sourceSamples, index);
+        }
     }
 
-    if (!sampledIndices.empty() && sampledIndices.front() < sourceSamples.size()) {
-        const size_t initialIndex = sampledIndices.front();
-        const auto& initialSample = sourceSamples[initialIndex];
-        const AudioColourSample* initialPreviousSample =
-            initialIndex > 0 ? &sourceSamples[initialIndex - 1] : nullptr;
-        const auto initialPreparedFrame = SpectralPresentation::SampleSequence::prepareSampleFrame(
-            initialSample,
-            buildPresentationSettings(settings),
-            initialPreviousSample);
-        float initialL = 0.0f;
-        float initialA = 0.0f;
-        float initialB = 0.0f;
-        ColourCore::XYZtoOklab(
-            initialPreparedFrame.colourResult.X,
-            initialPreparedFrame.colourResult.Y,
-            initialPreparedFrame.colourResult.Z,
-            initialL,
-            initialA,
-            initialB);
-        smoother.resetOklab(initialL, initialA, initialB);
-    } else {
-        smoother.reset(previewData.front().colour.x, previewData.front().colour.y, previewData.front().colour.z);
+    void append(const SpectralSequence& sourceSamples, const size_t index) {
+        const SpectralFrame previousFrame = index > 0 ? sourceSamples[index - 1] : SpectralFrame{};
+        const SpectralFrame* previousSample = index > 0 ? &previousFrame : nullptr;
+        push(index, prepare(sourceSamples[index], previousSample, preview_.empty()));
     }
 
-    ::UI::Smoothing::MagnitudeHistory fluxHistory;
-    if (!sampledIndices.empty() && sampledIndices.front() < sourceSamples.size()) {
-        const size_t initialIndex = sampledIndices.front();
-        const auto& initialSample = sourceSamples[initialIndex];
-        const AudioColourSample* initialPreviousSample =
-            initialIndex > 0 ? &sourceSamples[initialIndex - 1] : nullptr;
-        fluxHistory.previousMagnitudes =
-            SpectralPresentation::SampleSequence::prepareSampleFrame(
-                initialSample,
-                presentationSettings,
-                initialPreviousSample).visualiserMagnitudes;
+    // Safe to call from several threads at once. first must be true only for the frame
+    // that will be pushed into an empty preview.
+    [[nodiscard]] PreparedPreviewFrame prepare(const SpectralFrame& sample,
+                                               const SpectralFrame* previousSample,
+                                               const bool first) const {
+        PreparedPreviewFrame frame;
+        if (!settings_.smoothingEnabled || first) {
+            frame.unsmoothed = buildTimelineSample(sample, previousSample, unsmoothedSettings_, frame.unsmoothedXYZ);
+        }
+        frame.unsmoothed.timestamp = sample.timestamp;
+        if (settings_.smoothingEnabled) {
+            frame.prepared = SpectralPresentation::SampleSequence::prepareSampleFrame(
+                sample,
+                presentationSettings_,
+                previousSample);
+        }
+        return frame;
     }
 
-    for (size_t index = 1; index < previewData.size(); ++index) {
-        if (index >= sampledIndices.size() || sampledIndices[index] >= sourceSamples.size()) {
-            continue;
+    void push(const size_t index, const PreparedPreviewFrame& frame) {
+        nextIndex_ = index + stride_;
+        if (!settings_.smoothingEnabled || preview_.empty()) {
+            preview_.push_back(frame.unsmoothed);
+            previewXYZ_.push_back(frame.unsmoothedXYZ);
+            if (settings_.smoothingEnabled) {
+                start(frame.prepared);
+            }
+            return;
         }
 
-        const size_t sampleIndex = sampledIndices[index];
-        const auto& currentSample = sourceSamples[sampleIndex];
-        const AudioColourSample* previousSample =
-            sampleIndex > 0 ? &sourceSamples[sampleIndex - 1] : nullptr;
-        const auto preparedFrame = SpectralPresentation::SampleSequence::prepareSampleFrame(
-            currentSample,
-            presentationSettings,
-            previousSample);
-
-        auto features = ::UI::Smoothing::buildSignalFeatures(preparedFrame.colourResult);
-        ::UI::Smoothing::updateFluxHistory(
-            preparedFrame.visualiserMagnitudes,
-            fluxHistory,
-            features);
-
-        const double deltaSeconds = previewData[index].timestamp - previewData[index - 1].timestamp;
+        // Smoothed frames only keep the unsmoothed timestamp, so the colour is computed once.
+        const auto& preparedFrame = frame.prepared;
+        const double timestamp = frame.unsmoothed.timestamp;
+        const double deltaSeconds = timestamp - preview_.back().timestamp;
         const float deltaTime = std::isfinite(deltaSeconds) && deltaSeconds > 0.0
             ? static_cast<float>(deltaSeconds)
             : (1.0f / 60.0f);
@@ -348,44 +358,266 @@ void applyPreviewSmoothing(std::vector<Timeline::TimelineSample>& previewData,
         float targetL = 0.0f;
         float targetA = 0.0f;
         float targetB = 0.0f;
-        ColourCore::XYZtoOklab(
-            preparedFrame.colourResult.X,
-            preparedFrame.colourResult.Y,
-            preparedFrame.colourResult.Z,
-            targetL,
-            targetA,
-            targetB);
-        smoother.setTargetOklab(targetL, targetA, targetB);
-        smoother.update(deltaTime * 1.2f, features);
+        preparedOklab(preparedFrame, targetL, targetA, targetB);
+        smoother_.setTargetOklab(targetL, targetA, targetB);
+        if (settings_.manualSmoothing) {
+            smoother_.update(deltaTime * 1.2f);
+        } else {
+            auto features = ::UI::Smoothing::buildSignalFeatures(preparedFrame.colourResult);
+            ::UI::Smoothing::updateFluxHistory(
+                preparedFrame.visualiserMagnitudes,
+                fluxHistory_,
+                features);
+            smoother_.update(deltaTime * 1.2f, features);
+        }
 
         float smoothedL = 0.0f;
         float smoothedA = 0.0f;
         float smoothedB = 0.0f;
-        smoother.getCurrentOklab(smoothedL, smoothedA, smoothedB);
+        smoother_.getCurrentOklab(smoothedL, smoothedA, smoothedB);
         float smoothedX = 0.0f;
         float smoothedY = 0.0f;
         float smoothedZ = 0.0f;
         ColourCore::OklabtoXYZ(smoothedL, smoothedA, smoothedB, smoothedX, smoothedY, smoothedZ);
-        previewData[index] = buildTimelineSampleFromXYZ(
-            previewData[index].timestamp,
-            smoothedX,
-            smoothedY,
-            smoothedZ,
-            settings);
+        preview_.push_back(buildTimelineSampleFromXYZ(timestamp, smoothedX, smoothedY, smoothedZ, settings_));
+        previewXYZ_.push_back(ColourCore::XYZ{smoothedX, smoothedY, smoothedZ});
+    }
+
+    // Nothing before the projection depends on the output settings, so the preview keeps
+    // its analysis and smoothing and only its colours are projected again.
+    void reproject(const RecorderColourCache::CacheSettings& settings) {
+        settings_.colourSpace = settings.colourSpace;
+        settings_.gamutMapping = settings.gamutMapping;
+        unsmoothedSettings_.colourSpace = settings.colourSpace;
+        unsmoothedSettings_.gamutMapping = settings.gamutMapping;
+        presentationSettings_.colourSpace = settings.colourSpace;
+        presentationSettings_.applyGamutMapping = settings.gamutMapping;
+        reprojectColours(preview_, previewXYZ_, settings_);
+    }
+
+private:
+    void start(const SpectralPresentation::PreparedFrame& preparedFrame) {
+        float initialL = 0.0f;
+        float initialA = 0.0f;
+        float initialB = 0.0f;
+        preparedOklab(preparedFrame, initialL, initialA, initialB);
+        smoother_.resetOklab(initialL, initialA, initialB);
+        if (!settings_.manualSmoothing) {
+            fluxHistory_.previousMagnitudes = preparedFrame.visualiserMagnitudes;
+        }
+    }
+
+    RecorderColourCache::CacheSettings settings_;
+    RecorderColourCache::CacheSettings unsmoothedSettings_;
+    SpectralPresentation::Settings presentationSettings_;
+    size_t stride_ = 0;
+    size_t nextIndex_ = 0;
+    SpringSmoother smoother_{8.0f, 1.0f, 0.3f};
+    ::UI::Smoothing::MagnitudeHistory fluxHistory_;
+    std::vector<Timeline::TimelineSample> preview_;
+    std::vector<ColourCore::XYZ> previewXYZ_;  // Parallel to preview_
+};
+
+// Rebuilds a preview off the UI thread. The sampled source frames are copied when the job
+// is created, so the workers never touch RecorderState; their colours are prepared in
+// parallel and then pushed through the builder in order. Spilled frames are copied without
+// their spectra and read back from their store by the workers.
+class TimelinePreviewJob {
+public:
+    // Caller must hold samplesMutex.
+    TimelinePreviewJob(std::shared_ptr<TimelinePreviewBuilder> builder,
+                       const SpectralSequence& sourceSamples,
+                       const size_t sourceCount,
+                       const size_t maxSamples,
+                       const bool usePreview,
+                       RecorderJournal::SpilledFrames spilled)
+        : builder_(std::move(builder)),
+          indices_(builder_->pendingIndices(sourceCount, maxSamples)),
+          sourceCount_(sourceCount),
+          maxSamples_(maxSamples),
+          usePreview_(usePreview),
+          spilled_(std::move(spilled)) {
+        // Only the smoother's phase analysis reads the previous frame. At stride one it is
+        // the previous sampled frame, so it is shared rather than copied twice.
+        const bool needsPrevious = builder_->settings().smoothingEnabled;
+        constexpr size_t kNone = std::numeric_limits<size_t>::max();
+        size_t lastCopied = kNone;
+        const size_t copiedFrames = indices_.size() * (needsPrevious && builder_->stride() != 1 ? 2 : 1);
+        frames_.setSharedFrequencies(sourceSamples.sharedFrequencies());
+        frames_.reserve(copiedFrames);
+        frameIndices_.reserve(copiedFrames);
+        samplePositions_.reserve(indices_.size());
+        previousPositions_.reserve(indices_.size());
+        for (const size_t index : indices_) {
+            size_t previousPosition = kNone;
+            if (needsPrevious && index > 0) {
+                if (lastCopied != index - 1) {
+                    frames_.appendFrame(sourceSamples[index - 1]);
+                    frameIndices_.push_back(index - 1);
+                }
+                previousPosition = frames_.size() - 1;
+            }
+            if (lastCopied != index) {
+                frames_.appendFrame(sourceSamples[index]);
+                frameIndices_.push_back(index);
+                lastCopied = index;
+            }
+            samplePositions_.push_back(frames_.size() - 1);
+            previousPositions_.push_back(previousPosition);
+        }
+        task_ = ::Utilities::Threading::TaskScheduler::shared().submit(
+            ::Utilities::Threading::TaskPriority::Interactive,
+            [this](const ::Utilities::Threading::TaskContext& context) { run(context); });
+    }
+
+    ~TimelinePreviewJob() {
+        task_.cancel();
+        task_.wait();
     }
+
+    TimelinePreviewJob(const TimelinePreviewJob&) = delete;
+    TimelinePreviewJob& operator=(const TimelinePreviewJob&) = delete;
+
+    [[nodiscard]] bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+
+    // Only valid once isFinished() is true.
+    [[nodiscard]] const std::shared_ptr<TimelinePreviewBuilder>& builder() const { return builder_; }
+    [[nodiscard]] size_t sourceCount() const { return sourceCount_; }
+
+    // A strided build stays worth finishing while the source grows past it, since the
+    // frames appended meanwhile can extend its result.
+    [[nodiscard]] bool matches(const RecorderColourCache::CacheSettings& settings,
+                               const size_t maxSamples,
+                               const size_t sourceCount,
+                               const bool usePreview) const {
+        const bool countMatches = builder_->stride() > 0 ? sourceCount >= sourceCount_ : sourceCount == sourceCount_;
+        return countMatches && maxSamples == maxSamples_ && usePreview == usePreview_ &&
+            sameAnalysisSettings(settings, builder_->settings());
+    }
+
+private:
+    void run(const ::Utilities::Threading::TaskContext& context) {
+        constexpr size_t kChunkFrames = 8;
+        constexpr size_t kNone = std::numeric_limits<size_t>::max();
+        const size_t count = indices_.size();
+        std::vector<PreparedPreviewFrame> prepared(count);
+        const bool startsEmpty = builder_->preview().empty();
+        const auto prepareFrames = [&](const size_t first, const size_t end) {
+            SpectralSequence spilled;
+            SpectralSequence spilledPrevious;
+            // A spilled frame that cannot be read back keeps its spectrum-less copy.
+            const auto resolve = [&](const size_t position, SpectralSequence& scratch) {
+                const size_t index = frameIndices_[position];
+                if (index < spilled_.frameCount && spilled_.store->readFrames(index, 1, scratch)) {
+                    return scratch.front();
+                }
+                return frames_[position];
+            };
+            for (size_t i = first; i < end && !context.isCancelled(); ++i) {
+                const size_t previousPosition = previousPositions_[i];
+                const SpectralFrame sample = resolve(samplePositions_[i], spilled);
+                const SpectralFrame previous =
+                    previousPosition != kNone ? resolve(previousPosition, spilledPrevious) : SpectralFrame{};
+                prepared[i] = builder_->prepare(
+                    sample,
+                    previousPosition != kNone ? &previous : nullptr,
+                    startsEmpty && i == 0);
+            }
+        };
+
+        // The ranges queue at this job's priority, so a running export does not hold them up.
+        ::Utilities::Threading::TaskScheduler::shared().parallelFor(count, kChunkFrames, prepareFrames);
+        if (context.isCancelled()) {
+            return;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            builder_->push(indices_[i], prepared[i]);
+        }
+        frames_ = SpectralSequence{};
+        spilled_ = {};
+        finished_.store(true, std::memory_order_release);
+    }
+
+    std::shared_ptr<TimelinePreviewBuilder> builder_;
+    std::vector<size_t> indices_;
+    size_t sourceCount_ = 0;
+    size_t maxSamples_ = 0;
+    bool usePreview_ = false;
+    RecorderJournal::SpilledFrames spilled_;
+    SpectralSequence frames_;
+    std::vector<size_t> frameIndices_;
+    std::vector<size_t> samplePositions_;
+    std::vector<size_t> previousPositions_;
+    ::Utilities::Threading::TaskHandle task_;
+    std::atomic<bool> finished_{false};
+};
+
+namespace {
+
+std::shared_ptr<const std::vector<Timeline::TimelineSample>> publishPreview(
+    RecorderState& state,
+    std::vector<Timeline::TimelineSample> previewData,
+    const RecorderColourCache::CacheSettings& settings,
+    const size_t maxSamples,
+    const size_t sourceCount,
+    const bool usePreview,
+    const size_t retainedCount = 0) {
+    state.timelinePreviewCache = std::make_shared<const std::vector<Timeline::TimelineSample>>(std::move(previewData));
+    state.timelinePreviewCacheRetainedCount = retainedCount;
+    storePreviewSettings(state, settings, maxSamples, sourceCount, usePreview);
+    return state.timelinePreviewCache;
+}
+
+// Columns of the coarsest level that still fills maxSamples, in the stored colours or
+// reprojected from Oklab when the output settings differ.
+TimelinePreview sampleStoredPreview(RecorderState& state,
+                                    const RecorderColourCache::CacheSettings& settings,
+                                    const size_t maxSamples) {
+    const RSYNPreviewData& preview = *state.storedPreview;
+    const auto& columns = preview.levelFor(maxSamples);
+    if (previewSettingsMatch(state, settings, maxSamples, columns.size(), true)) {
+        return state.timelinePreviewCache;
+    }
+
+    state.timelinePreviewJob.reset();
+    state.timelinePreviewBuilder.reset();
+    std::vector<Timeline::TimelineSample> previewData(columns.size());
+    std::vector<ColourCore::XYZ> previewXYZ(columns.size());
+    const double span = preview.lastTimestamp - preview.firstTimestamp;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const RSYNPreviewColumn& column = columns[i];
+        Timeline::TimelineSample& output = previewData[i];
+        output.timestamp = preview.firstTimestamp + span * static_cast<double>(i) / static_cast<double>(columns.size());
+        output.colour = ImVec4(
+            std::clamp(column.displayRgb[0], 0.0f, 1.0f),
+            std::clamp(column.displayRgb[1], 0.0f, 1.0f),
+            std::clamp(column.displayRgb[2], 0.0f, 1.0f),
+            1.0f);
+        ColourCore::XYZ& xyz = previewXYZ[i];
+        ColourCore::OklabtoXYZ(column.oklab[0], column.oklab[1], column.oklab[2], xyz.X, xyz.Y, xyz.Z);
+        ColourCore::XYZtoLab(xyz.X, xyz.Y, xyz.Z, output.labL, output.labA, output.labB);
+    }
+    if (preview.colourSpace != settings.colourSpace || preview.applyGamutMapping != settings.gamutMapping) {
+        reprojectColours(previewData, previewXYZ, settings);
+    }
+    return publishPreview(state, std::move(previewData), settings, maxSamples, columns.size(), true);
 }
 
 }
 
-std::vector<Timeline::TimelineSample> samplePreviewData(
+TimelinePreview samplePreviewData(
     RecorderState& state,
     size_t maxSamples,
     std::lock_guard<std::mutex>& lock
 ) {
     (void)lock;
-    std::vector<Timeline::TimelineSample> previewData;
+    static const TimelinePreview emptyPreview = std::make_shared<const std::vector<Timeline::TimelineSample>>();
 
     const bool usePreview = state.importPhase == 3 && state.previewReady.load(std::memory_order_acquire);
+    if (state.importPhase == 3 && !usePreview && state.storedPreview != nullptr) {
+        return sampleStoredPreview(state, RecorderColourCache::currentSettings(state), maxSamples);
+    }
     const auto& sourceSamples = usePreview ? state.previewSamples : state.samples;
     const size_t samplesSize = sourceSamples.size();
 
@@ -394,7 +626,28 @@ std::vector<Timeline::TimelineSample> samplePreviewData(
         ? samplesSize
         : (usePreview || state.metadata.presentationData == nullptr ? 0 : state.metadata.presentationData->frames.size());
     if (sourceCount == 0) {
-        return previewData;
+        state.timelinePreviewJob.reset();
+        return emptyPreview;
+    }
+
+    // The previous snapshot stays on screen until a rebuild lands. One made stale by a
+    // newer change is dropped and a fresh one started below.
+    if (state.timelinePreviewJob != nullptr) {
+        const auto& job = *state.timelinePreviewJob;
+        if (state.timelinePreviewCacheDirty || !job.matches(settings, maxSamples, sourceCount, usePreview)) {
+            state.timelinePreviewJob.reset();
+            state.timelinePreviewCacheDirty = true;
+        } else if (!job.isFinished()) {
+            return state.timelinePreviewCache != nullptr ? state.timelinePreviewCache : emptyPreview;
+        } else {
+            state.timelinePreviewBuilder = job.builder();
+            const size_t builtCount = job.sourceCount();
+            state.timelinePreviewJob.reset();
+            if (!sameOutputSettings(settings, state.timelinePreviewBuilder->settings())) {
+                state.timelinePreviewBuilder->reproject(settings);
+            }
+            publishPreview(state, state.timelinePreviewBuilder->preview(), settings, maxSamples, builtCount, usePreview);
+        }
     }
 
     if (previewSettingsMatch(state, settings, maxSamples, sourceCount, usePreview)) {
@@ -402,61 +655,88 @@ std::vector<Timeline::TimelineSample> samplePreviewData(
     }
 
     bool useSmoothedStoredTrack = false;
-    if (canUseStoredPresentation(state, settings, usePreview, useSmoothedStoredTrack)) {
+    bool reprojectStoredTrack = false;
+    if (canUseStoredPresentation(state, settings, usePreview, useSmoothedStoredTrack, reprojectStoredTrack)) {
+        state.timelinePreviewBuilder.reset();
+        std::vector<Timeline::TimelineSample> previewData;
+        std::vector<ColourCore::XYZ> previewXYZ;
         const auto& storedFrames = state.metadata.presentationData->frames;
+        const auto addFrame = [&](const RSYNPresentationFrame& frame) {
+            previewData.push_back(buildTimelineSampleFromStoredFrame(frame, useSmoothedStoredTrack));
+            if (reprojectStoredTrack) {
+                previewXYZ.push_back(storedFrameXYZ(frame, useSmoothedStoredTrack));
+            }
+        };
         if (storedFrames.size() <= maxSamples) {
             previewData.reserve(storedFrames.size());
             for (const auto& frame : storedFrames) {
-                previewData.push_back(buildTimelineSampleFromStoredFrame(frame, useSmoothedStoredTrack));
+                addFrame(frame);
             }
         } else {
             previewData.reserve(maxSamples);
             const double step = static_cast<double>(storedFrames.size()) / static_cast<double>(maxSamples);
             for (size_t i = 0; i < maxSamples; ++i) {
                 const size_t frameIndex = static_cast<size_t>(static_cast<double>(i) * step);
-                previewData.push_back(buildTimelineSampleFromStoredFrame(
-                    storedFrames[std::min(frameIndex, storedFrames.size() - 1)],
-                    useSmoothedStoredTrack));
+                addFrame(storedFrames[std::min(frameIndex, storedFrames.size() - 1)]);
             }
         }
+        if (reprojectStoredTrack) {
+            reprojectColours(previewData, previewXYZ, settings);
+        }
 
-        state.timelinePreviewCache = previewData;
-        storePreviewSettings(state, settings, maxSamples, sourceCount, usePreview);
-        return state.timelinePreviewCache;
+        return publishPreview(state, std::move(previewData), settings, maxSamples, sourceCount, usePreview);
     }
 
-    auto unsmoothedSettings = settings;
-    unsmoothedSettings.smoothingEnabled = false;
-    unsmoothedSettings.smoothingAmount = 0.0f;
-    std::vector<size_t> sampledIndices;
+    // A change to the output settings alone reprojects the preview the builder already holds.
+    const auto& builder = state.timelinePreviewBuilder;
+    if (builder != nullptr && state.timelinePreviewCache != nullptr &&
+        !sameOutputSettings(settings, builder->settings()) &&
+        sameAnalysisSettings(settings, builder->settings()) &&
+        previewSettingsMatch(state, builder->settings(), maxSamples, sourceCount, usePreview)) {
+        builder->reproject(settings);
+        return publishPreview(state, builder->preview(), settings, maxSamples, sourceCount, usePreview);
+    }
 
-    const auto convertSample = [&](size_t index) {
-        const AudioColourSample* previousSample = index > 0 ? &sourceSamples[index - 1] : nullptr;
-        return buildTimelineSample(sourceSamples[index], previousSample, unsmoothedSettings);
-    };
+    // Frames appended while recording or importing extend the current preview when nothing
+    // else has changed.
+    if (builder != nullptr && state.timelinePreviewCache != nullptr &&
+        samplesSize > state.timelinePreviewCacheSourceCount &&
+        previewSettingsMatch(state, settings, maxSamples, state.timelinePreviewCacheSourceCount, usePreview) &&
+        builder->canExtendTo(samplesSize, maxSamples)) {
+        const size_t retainedCount = builder->preview().size();
+        builder->extend(sourceSamples, samplesSize);
+        return publishPreview(state, builder->preview(), settings, maxSamples, sourceCount, usePreview, retainedCount);
+    }
+
+    if (samplesSize == 0) {
+        state.timelinePreviewBuilder.reset();
+        return publishPreview(state, {}, settings, maxSamples, sourceCount, usePreview);
+    }
 
+    // A growing source is sampled at a power-of-two stride so later frames can be appended;
+    // the stride only changes, forcing a rebuild, each time the source doubles.
+    size_t stride = 0;
     if (samplesSize <= maxSamples) {
-        previewData.reserve(samplesSize);
-        sampledIndices.reserve(samplesSize);
-        for (size_t i = 0; i < samplesSize; ++i) {
-            sampledIndices.push_back(i);
-            previewData.push_back(convertSample(i));
-        }
-    } else {
-        previewData.reserve(maxSamples);
-        sampledIndices.reserve(maxSamples);
-        const double step = static_cast<double>(samplesSize) / static_cast<double>(maxSamples);
-        for (size_t i = 0; i < maxSamples; ++i) {
-            const size_t index = static_cast<size_t>(static_cast<double>(i) * step);
-            sampledIndices.push_back(index);
-            previewData.push_back(convertSample(index));
+        stride = 1;
+    } else if (state.isRecording || usePreview) {
+        stride = 2;
+        while ((samplesSize + stride - 1) / stride > maxSamples) {
+            stride *= 2;
         }
     }
 
-    applyPreviewSmoothing(previewData, sourceSamples, sampledIndices, settings);
-    state.timelinePreviewCache = previewData;
-    storePreviewSettings(state, settings, maxSamples, sourceCount, usePreview);
-    return state.timelinePreviewCache;
+    // The dirty flag is cleared as the job starts, so a change made while it runs marks
+    // it stale.
+    state.timelinePreviewBuilder.reset();
+    state.timelinePreviewJob = std::make_shared<TimelinePreviewJob>(
+        std::make_shared<TimelinePreviewBuilder>(settings, stride),
+        sourceSamples,
+        samplesSize,
+        maxSamples,
+        usePreview,
+        usePreview ? RecorderJournal::SpilledFrames{} : RecorderJournal::spilledFrames(state));
+    state.timelinePreviewCacheDirty = false;
+    return state.timelinePreviewCache != nullptr ? state.timelinePreviewCache : emptyPreview;
 }
 
 void renderStatusMessage(RecorderState& state) {
@@ -475,4 +755,22 @@ void renderStatusMessage(RecorderState& state) {
     }
 }
 
+void renderPlaybackRateControl(RecorderState& state, const float width, const float height) {
+    const float framePadding = std::max(0.0f, (height - ImGui::GetFontSize()) * 0.5f);
+    ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(ImGui::GetStyle().FramePadding.x, framePadding));
+    ImGui::SetNextItemWidth(width);
+    float rate = state.playbackRate;
+    if (ImGui::DragFloat("##PlaybackRate", &rate, 0.01f, StreamingPlayback::kMinRate, StreamingPlayback::kMaxRate,
+                         "%.2fx", ImGuiSliderFlags_AlwaysClamp)) {
+        Recorder::setPlaybackRate(state, rate);
+    }
+    if (ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
+        Recorder::setPlaybackRate(state, 1.0f);
+    }
+    ImGui::PopStyleVar();
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Playback speed, pitch unchanged. Right-click for 1x");
+    }
+}
+
 }
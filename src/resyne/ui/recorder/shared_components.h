@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <mutex>
 #include "resyne/recorder/recorder.h"
@@ -7,7 +8,11 @@
 
 namespace ReSyne::UI {
 
-std::vector<Timeline::TimelineSample> samplePreviewData(
+// Immutable once published, so the renderer can hold it after samplesMutex is released.
+using TimelinePreview = std::shared_ptr<const std::vector<Timeline::TimelineSample>>;
+
+// Never null. A cache hit hands back the current snapshot without copying it.
+TimelinePreview samplePreviewData(
     RecorderState& state,
     size_t maxSamples,
     std::lock_guard<std::mutex>& lock
@@ -15,4 +20,7 @@ std::vector<Timeline::TimelineSample> samplePreviewData(
 
 void renderStatusMessage(RecorderState& state);
 
+// Playback speed, sized to sit among the transport buttons. Right-click returns it to 1x.
+void renderPlaybackRateControl(RecorderState& state, float width, float height);
+
 }
@@ -5,7 +5,7 @@
 namespace ReSyne::RecorderUI {
 
 std::optional<float> computePlaybackNormalisedPosition(const RecorderState& state) {
-    if (state.audioOutput && !state.playbackAudio.empty()) {
+    if (state.audioOutput && (!state.playbackAudio.empty() || state.streamingPlayback.isRunning())) {
         size_t total = state.audioOutput->getTotalFrames();
         if (total > 0) {
             size_t position = state.audioOutput->getPlaybackPosition();
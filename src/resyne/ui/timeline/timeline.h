@@ -2,6 +2,7 @@
 
 #include <imgui.h>
 
+#include <cstddef>
 #include <optional>
 #include <vector>
 
@@ -28,6 +29,24 @@ struct TimelineSample {
 	float labB = 0.0f;
 };
 
+// The ruler's ticks and labels as last drawn. They are replayed into the draw list while
+// everything they were drawn from holds, so a paused timeline formats no labels.
+struct RulerCache {
+    bool valid = false;
+    ImVec2 topMin = ImVec2(0.0f, 0.0f);
+    ImVec2 topMax = ImVec2(0.0f, 0.0f);
+    float viewStart = 0.0f;
+    float viewEnd = 1.0f;
+    double durationSeconds = 0.0;
+    bool lightMode = false;
+    ImVec4 clipRect = ImVec4(0.0f, 0.0f, 0.0f, 0.0f);
+    const void* fontTexture = nullptr;
+    ImVec2 whitePixelUv = ImVec2(0.0f, 0.0f);
+    float fontSize = 0.0f;
+    std::vector<ImDrawVert> vertices;
+    std::vector<ImDrawIdx> indices;  // Relative to the first vertex
+};
+
 struct TimelineState {
     ImVec2 gradientRegionMin = ImVec2(0.0f, 0.0f);
     ImVec2 gradientRegionMax = ImVec2(0.0f, 0.0f);
@@ -45,6 +64,7 @@ struct TimelineState {
     float viewCentreNormalised = 0.5f;
     float grabStartViewCentre = 0.5f;
     bool trackScrubber = false;
+    RulerCache rulerCache;
 };
 
 struct TrackpadGestureInput {
@@ -75,6 +95,9 @@ struct RenderContext {
     const UI::Utilities::ToolState* toolState = nullptr;
     const TrackpadGestureInput* trackpadInput = nullptr;
     Renderer::PresentationResources* presentationResources = nullptr;
+    // Leading samples unchanged since revision sampleRevision - 1, so a texture built from
+    // that revision only has the rest to upload.
+    size_t retainedSampleCount = 0;
 };
 
 struct RenderResult {
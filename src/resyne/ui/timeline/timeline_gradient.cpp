@@ -8,14 +8,11 @@
 #include <imgui.h>
 
 #include "colour/colour_core.h"
+#include "colour/display_lut.h"
 
 namespace {
 
-struct LabColour {
-	float L;
-	float a;
-	float b;
-};
+using LabColour = ColourCore::Lab;
 
 ImVec4 labToRGB(const LabColour& lab,
 			ColourCore::ColourSpace colourSpace,
@@ -37,45 +34,19 @@ void labSpanToRGB(std::span<const LabColour> labs,
 		return;
 	}
 
-	thread_local std::vector<float> LValues;
-	thread_local std::vector<float> AValues;
-	thread_local std::vector<float> BValues;
-	thread_local std::vector<float> RValues;
-	thread_local std::vector<float> GValues;
-	thread_local std::vector<float> BOutValues;
-
-	if (LValues.size() < size) {
-		LValues.resize(size);
-		AValues.resize(size);
-		BValues.resize(size);
-		RValues.resize(size);
-		GValues.resize(size);
-		BOutValues.resize(size);
+	thread_local std::vector<ColourCore::RGB> rgbValues;
+	if (rgbValues.size() < size) {
+		rgbValues.resize(size);
 	}
 
-	for (size_t i = 0; i < size; ++i) {
-		LValues[i] = labs[i].L;
-		AValues[i] = labs[i].a;
-		BValues[i] = labs[i].b;
-	}
-
-	for (size_t i = 0; i < size; ++i) {
-		ColourCore::LabtoRGB(
-			LValues[i],
-			AValues[i],
-			BValues[i],
-			RValues[i],
-			GValues[i],
-			BOutValues[i],
-			colourSpace,
-			applyGamutMapping);
-	}
+	ColourCore::DisplayLUT::forSettings({colourSpace, applyGamutMapping})
+		.project(labs.first(size), std::span(rgbValues).first(size));
 
 	for (size_t i = 0; i < size; ++i) {
 		colours[i] = ImVec4(
-			std::clamp(RValues[i], 0.0f, 1.0f),
-			std::clamp(GValues[i], 0.0f, 1.0f),
-			std::clamp(BOutValues[i], 0.0f, 1.0f),
+			std::clamp(rgbValues[i].r, 0.0f, 1.0f),
+			std::clamp(rgbValues[i].g, 0.0f, 1.0f),
+			std::clamp(rgbValues[i].b, 0.0f, 1.0f),
 			1.0f);
 	}
 }
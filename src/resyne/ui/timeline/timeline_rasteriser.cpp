@@ -2,8 +2,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <utility>
+#include <vector>
 
 #include "colour/colour_presentation.h"
+#include "colour/display_lut.h"
 
 namespace ReSyne::Timeline {
 
@@ -23,9 +26,122 @@ void writePixel(std::span<float> rgbaPixels,
     rgbaPixels[baseIndex + 3] = 1.0f;
 }
 
+// The strip's colours are collected first so the display table converts them in one batch.
+struct PixelColours {
+    std::vector<ColourCore::Lab> lab;
+    std::vector<ColourCore::RGB> rgb;
+};
+
+PixelColours& pixelColours(const std::size_t width) {
+    thread_local PixelColours colours;
+    if (colours.lab.size() < width) {
+        colours.lab.resize(width);
+        colours.rgb.resize(width);
+    }
+    return colours;
+}
+
+void writePixels(PixelColours& colours,
+                 const std::size_t width,
+                 const ColourCore::ColourSpace colourSpace,
+                 const bool applyGamutMapping,
+                 const std::span<float> rgbaPixels) {
+    const auto& lut = ColourCore::DisplayLUT::forSettings({colourSpace, applyGamutMapping});
+    lut.project(std::span<const ColourCore::Lab>(colours.lab).first(width), std::span(colours.rgb).first(width));
+    for (std::size_t pixelIndex = 0; pixelIndex < width; ++pixelIndex) {
+        const auto& rgb = colours.rgb[pixelIndex];
+        writePixel(rgbaPixels, pixelIndex, rgb.r, rgb.g, rgb.b);
+    }
+}
+
+}
+
+void buildGradientPyramid(const std::span<const TimelineSample> samples, GradientPyramid& pyramid) {
+    pyramid.sampleCount = 0;
+    pyramid.levels.clear();
+    extendGradientPyramid(samples, pyramid);
+}
+
+void extendGradientPyramid(const std::span<const TimelineSample> samples, GradientPyramid& pyramid) {
+    // Fewer samples than were held means they are not an extension; start again.
+    const std::size_t previousCount = pyramid.sampleCount <= samples.size() ? pyramid.sampleCount : 0;
+    pyramid.sampleCount = samples.size();
+    if (previousCount == 0) {
+        pyramid.levels.clear();
+    }
+    if (samples.empty()) {
+        return;
+    }
+
+    if (pyramid.levels.empty()) {
+        pyramid.levels.emplace_back();
+    }
+    auto& base = pyramid.levels.front();
+    base.resize(previousCount);
+    base.reserve(samples.size());
+    for (std::size_t i = previousCount; i < samples.size(); ++i) {
+        const auto& sample = samples[i];
+        base.push_back({sample.labL, sample.labA, sample.labB});
+    }
+
+    // A level's last bucket may cover fewer samples, so pairs are weighted by what they hold.
+    // Buckets before the one holding the last previous sample cover old samples only.
+    std::size_t bucketSize = 1;
+    for (std::size_t levelIndex = 0; pyramid.levels[levelIndex].size() > 1; ++levelIndex) {
+        if (levelIndex + 1 == pyramid.levels.size()) {
+            pyramid.levels.emplace_back();
+        }
+        const auto& below = pyramid.levels[levelIndex];
+        auto& level = pyramid.levels[levelIndex + 1];
+        level.resize((below.size() + 1) / 2);
+        const std::size_t firstChanged = previousCount > 0 ? (previousCount - 1) / (bucketSize * 2) : 0;
+        for (std::size_t i = firstChanged; i < level.size(); ++i) {
+            const auto& first = below[i * 2];
+            if (i * 2 + 1 >= below.size()) {
+                level[i] = first;
+                continue;
+            }
+            const auto& second = below[i * 2 + 1];
+            const std::size_t secondStart = (i * 2 + 1) * bucketSize;
+            const float secondWeight = static_cast<float>(std::min(bucketSize, samples.size() - secondStart)) /
+                static_cast<float>(bucketSize);
+            const float scale = 1.0f / (1.0f + secondWeight);
+            level[i] = {
+                (first.labL + second.labL * secondWeight) * scale,
+                (first.labA + second.labA * secondWeight) * scale,
+                (first.labB + second.labB * secondWeight) * scale
+            };
+        }
+        bucketSize *= 2;
+    }
 }
 
-void rasteriseGradientStrip(const std::span<const TimelineSample> samples,
+void rasteriseGradientBuckets(const GradientPyramid& pyramid,
+                              const std::size_t levelIndex,
+                              const std::size_t firstTexel,
+                              const std::size_t texelCount,
+                              const ColourCore::ColourSpace colourSpace,
+                              const bool applyGamutMapping,
+                              const std::span<float> rgbaPixels) {
+    if (texelCount == 0 || rgbaPixels.size() < texelCount * 4) {
+        return;
+    }
+    if (pyramid.levels.empty()) {
+        std::fill(rgbaPixels.begin(), rgbaPixels.begin() + static_cast<std::ptrdiff_t>(texelCount * 4), 0.0f);
+        return;
+    }
+
+    const auto& level = pyramid.levels[std::min(levelIndex, pyramid.levels.size() - 1)];
+    const std::size_t lastBucket = level.size() - 1;
+    auto& colours = pixelColours(texelCount);
+    for (std::size_t texel = 0; texel < texelCount; ++texel) {
+        const auto& bucket = level[std::min(firstTexel + texel, lastBucket)];
+        colours.lab[texel] = {bucket.labL, bucket.labA, bucket.labB};
+    }
+    writePixels(colours, texelCount, colourSpace, applyGamutMapping, rgbaPixels);
+}
+
+void rasteriseGradientStrip(const GradientPyramid& pyramid,
                             float visibleStart,
                             float visibleEnd,
                             const std::size_t width,
@@ -39,35 +155,47 @@ void rasteriseGradientStrip(const std::span<const TimelineSample> samples,
     visibleStart = std::clamp(visibleStart, 0.0f, 1.0f);
     visibleEnd = std::clamp(visibleEnd, visibleStart, 1.0f);
 
-    if (samples.empty()) {
+    if (pyramid.levels.empty()) {
         std::fill(rgbaPixels.begin(), rgbaPixels.begin() + static_cast<std::ptrdiff_t>(width * 4), 0.0f);
         return;
     }
 
-    const std::size_t lastIndex = samples.size() - 1;
+    // Take the coarsest level whose buckets are no wider than the sample span of one pixel.
+    const float lastSample = static_cast<float>(pyramid.sampleCount - 1);
+    const float samplesPerPixel = (visibleEnd - visibleStart) * lastSample / static_cast<float>(std::max<std::size_t>(width - 1, 1));
+    std::size_t levelIndex = 0;
+    while (levelIndex + 1 < pyramid.levels.size() &&
+           static_cast<float>(std::size_t{1} << (levelIndex + 1)) <= samplesPerPixel) {
+        ++levelIndex;
+    }
+    const auto& level = pyramid.levels[levelIndex];
+    const float bucketSize = static_cast<float>(std::size_t{1} << levelIndex);
+    const float bucketCentre = (bucketSize - 1.0f) * 0.5f;
+    const float lastBucket = static_cast<float>(level.size() - 1);
+    const std::size_t lastIndex = level.size() - 1;
+
+    auto& colours = pixelColours(width);
     for (std::size_t pixelIndex = 0; pixelIndex < width; ++pixelIndex) {
         const float pixelNormalised = width > 1
             ? static_cast<float>(pixelIndex) / static_cast<float>(width - 1)
             : 0.0f;
         const float visiblePosition = std::lerp(visibleStart, visibleEnd, pixelNormalised);
-        const float samplePosition = visiblePosition * static_cast<float>(lastIndex);
-        const std::size_t sampleIndex0 = std::min(static_cast<std::size_t>(samplePosition), lastIndex);
-        const std::size_t sampleIndex1 = std::min(sampleIndex0 + 1, lastIndex);
-        const float fraction = samplePosition - static_cast<float>(sampleIndex0);
-
-        const auto& sample0 = samples[sampleIndex0];
-        const auto& sample1 = samples[sampleIndex1];
-
-        const float L = std::lerp(sample0.labL, sample1.labL, fraction);
-        const float a = std::lerp(sample0.labA, sample1.labA, fraction);
-        const float bComponent = std::lerp(sample0.labB, sample1.labB, fraction);
-
-        float r = 0.0f;
-        float g = 0.0f;
-        float b = 0.0f;
-        ColourCore::LabtoRGB(L, a, bComponent, r, g, b, colourSpace, applyGamutMapping);
-        writePixel(rgbaPixels, pixelIndex, r, g, b);
+        const float samplePosition = visiblePosition * lastSample;
+        const float bucketPosition = std::clamp((samplePosition - bucketCentre) / bucketSize, 0.0f, lastBucket);
+        const std::size_t bucketIndex0 = std::min(static_cast<std::size_t>(bucketPosition), lastIndex);
+        const std::size_t bucketIndex1 = std::min(bucketIndex0 + 1, lastIndex);
+        const float fraction = bucketPosition - static_cast<float>(bucketIndex0);
+
+        const auto& bucket0 = level[bucketIndex0];
+        const auto& bucket1 = level[bucketIndex1];
+
+        colours.lab[pixelIndex] = {
+            std::lerp(bucket0.labL, bucket1.labL, fraction),
+            std::lerp(bucket0.labA, bucket1.labA, fraction),
+            std::lerp(bucket0.labB, bucket1.labB, fraction)
+        };
     }
+    writePixels(colours, width, colourSpace, applyGamutMapping, rgbaPixels);
 }
 
 }
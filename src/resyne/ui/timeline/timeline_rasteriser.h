@@ -2,13 +2,48 @@
 
 #include <cstddef>
 #include <span>
+#include <vector>
 
 #include "colour/colour_core.h"
 #include "resyne/ui/timeline/timeline.h"
 
 namespace ReSyne::Timeline {
 
-void rasteriseGradientStrip(std::span<const TimelineSample> samples,
+// Mean Oklab of the samples at every power-of-two bucket size. Level 0 holds the samples
+// themselves and each level above averages pairs from the one below, so a strip can be
+// drawn from whichever level has about one bucket per pixel.
+struct GradientPyramid {
+    struct Bucket {
+        float labL = 0.0f;
+        float labA = 0.0f;
+        float labB = 0.0f;
+    };
+
+    std::size_t sampleCount = 0;
+    std::vector<std::vector<Bucket>> levels;
+};
+
+void buildGradientPyramid(std::span<const TimelineSample> samples, GradientPyramid& pyramid);
+// samples must begin with the pyramid.sampleCount samples it was built from. Only the
+// buckets holding the appended samples are recomputed, and the result matches a rebuild.
+void extendGradientPyramid(std::span<const TimelineSample> samples, GradientPyramid& pyramid);
+
+// Texels [firstTexel, firstTexel + texelCount) of one level of a texture mip chain laid out on
+// the pyramid: at levelIndex, texel i holds bucket i, so sampling the chain with GPU filtering
+// matches rasteriseGradientStrip. Texels past the last bucket repeat it, and levels above
+// the pyramid's top repeat its single bucket.
+void rasteriseGradientBuckets(const GradientPyramid& pyramid,
+                              std::size_t levelIndex,
+                              std::size_t firstTexel,
+                              std::size_t texelCount,
+                              ColourCore::ColourSpace colourSpace,
+                              bool applyGamutMapping,
+                              std::span<float> rgbaPixels);
+
+// Costs one colour conversion per pixel whatever the sample count, made through the shared
+// ColourCore::DisplayLUT. Zoomed in, pixels interpolate between neighbouring samples; zoomed
+// out, between bucket means, so panning across dense material does not alias.
+void rasteriseGradientStrip(const GradientPyramid& pyramid,
                             float visibleStart,
                             float visibleEnd,
                             std::size_t width,
@@ -34,6 +34,161 @@ ToolType resolveTool(const RenderContext& context,
     return baseTool;
 }
 
+namespace {
+
+bool rulerCacheMatches(const RulerCache& cache,
+                       const ImDrawList* drawList,
+                       const ImVec2 topMin,
+                       const ImVec2 topMax,
+                       const float viewStart,
+                       const float viewEnd,
+                       const double duration,
+                       const bool isLightMode) {
+    const ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    const ImVec4 clipRect = drawList->_CmdHeader.ClipRect;
+    return cache.valid &&
+        cache.topMin.x == topMin.x && cache.topMin.y == topMin.y &&
+        cache.topMax.x == topMax.x && cache.topMax.y == topMax.y &&
+        cache.viewStart == viewStart &&
+        cache.viewEnd == viewEnd &&
+        cache.durationSeconds == duration &&
+        cache.lightMode == isLightMode &&
+        cache.clipRect.x == clipRect.x && cache.clipRect.y == clipRect.y &&
+        cache.clipRect.z == clipRect.z && cache.clipRect.w == clipRect.w &&
+        cache.fontTexture == atlas->TexData &&
+        cache.whitePixelUv.x == atlas->TexUvWhitePixel.x &&
+        cache.whitePixelUv.y == atlas->TexUvWhitePixel.y &&
+        cache.fontSize == ImGui::GetFontSize();
+}
+
+// Copies the cached primitives after whatever the draw list already holds; PrimReserve
+// opens a new command itself if they would overflow 16-bit indices.
+void replayRuler(ImDrawList* drawList, const RulerCache& cache) {
+    const int vertexCount = static_cast<int>(cache.vertices.size());
+    const int indexCount = static_cast<int>(cache.indices.size());
+    if (vertexCount == 0 || indexCount == 0) {
+        return;
+    }
+
+    drawList->PrimReserve(indexCount, vertexCount);
+    std::copy(cache.vertices.begin(), cache.vertices.end(), drawList->_VtxWritePtr);
+    const auto baseIndex = static_cast<ImDrawIdx>(drawList->_VtxCurrentIdx);
+    for (int i = 0; i < indexCount; ++i) {
+        drawList->_IdxWritePtr[i] = static_cast<ImDrawIdx>(baseIndex + cache.indices[static_cast<size_t>(i)]);
+    }
+    drawList->_VtxWritePtr += vertexCount;
+    drawList->_IdxWritePtr += indexCount;
+    drawList->_VtxCurrentIdx += static_cast<unsigned int>(vertexCount);
+}
+
+void drawRuler(ImDrawList* drawList,
+               RulerCache& cache,
+               const ImVec2 topMin,
+               const ImVec2 topMax,
+               const float topBarHeight,
+               const float viewStart,
+               const float viewEnd,
+               const double duration,
+               const bool isLightMode) {
+    if (rulerCacheMatches(cache, drawList, topMin, topMax, viewStart, viewEnd, duration, isLightMode)) {
+        replayRuler(drawList, cache);
+        return;
+    }
+
+    const float width = topMax.x - topMin.x;
+    const int firstCommand = drawList->CmdBuffer.Size;
+    const int firstVertex = drawList->VtxBuffer.Size;
+    const int firstIndex = drawList->IdxBuffer.Size;
+    const unsigned int firstVertexIndex = drawList->_VtxCurrentIdx;
+
+    const double viewSpanNormalised = static_cast<double>(viewEnd - viewStart);
+    const double visibleDuration = std::max(viewSpanNormalised * duration, 1e-6);
+
+    const double majorStep = Labels::chooseMajorTickStep(visibleDuration);
+    const double epsilon = majorStep * 0.05;
+    const int minorDivisions = 4;
+    const double minorStep = minorDivisions > 0 ? majorStep / static_cast<double>(minorDivisions) : majorStep;
+
+    const double visibleStartSeconds = static_cast<double>(viewStart) * duration;
+    const double visibleEndSeconds = static_cast<double>(viewEnd) * duration;
+
+    if (duration > 0.0 && visibleDuration > 0.0) {
+        double firstMajor = std::floor((visibleStartSeconds) / majorStep) * majorStep;
+        if (firstMajor < 0.0) {
+            firstMajor = 0.0;
+        }
+
+        for (double t = firstMajor; t <= visibleEndSeconds + epsilon; t += majorStep) {
+            if (t < visibleStartSeconds - epsilon) {
+                continue;
+            }
+
+            const float local = static_cast<float>((t - visibleStartSeconds) / visibleDuration);
+            const float x = topMin.x + std::clamp(local, 0.0f, 1.0f) * width;
+
+            drawList->AddLine(ImVec2(x, topMin.y + 2.0f),
+                              ImVec2(x, topMax.y),
+                              isLightMode ? IM_COL32(100, 100, 100, 200) : IM_COL32(180, 180, 180, 220),
+                              1.0f);
+
+            if (minorDivisions > 1 && majorStep > 0.0) {
+                const double segmentEnd = t + majorStep;
+                for (int i = 1; i < minorDivisions; ++i) {
+                    const double minorTime = t + i * minorStep;
+                    if (minorTime >= segmentEnd - epsilon || minorTime > visibleEndSeconds + epsilon) {
+                        break;
+                    }
+                    if (minorTime < visibleStartSeconds - epsilon) {
+                        continue;
+                    }
+                    const float minorLocal = static_cast<float>((minorTime - visibleStartSeconds) / visibleDuration);
+                    const float mx = topMin.x + std::clamp(minorLocal, 0.0f, 1.0f) * width;
+                    drawList->AddLine(ImVec2(mx, topMax.y - topBarHeight * 0.45f),
+                                      ImVec2(mx, topMax.y - 2.0f),
+                                      isLightMode ? IM_COL32(140, 140, 140, 160) : IM_COL32(90, 90, 90, 180),
+                                      1.0f);
+                }
+            }
+
+            std::string label = Labels::formatTickLabel(t, majorStep);
+            ImVec2 textSize = ImGui::CalcTextSize(label.c_str());
+            ImVec2 textPos(x - textSize.x * 0.5f, topMin.y + 4.0f);
+            textPos.x = std::clamp(textPos.x, topMin.x + 4.0f, topMax.x - textSize.x - 4.0f);
+            drawList->AddText(textPos, isLightMode ? IM_COL32(60, 60, 60, 255) : IM_COL32(215, 215, 215, 255), label.c_str());
+        }
+    }
+
+    // Only a run that stayed within one draw command can be replayed by copying it.
+    cache.valid = false;
+    cache.vertices.clear();
+    cache.indices.clear();
+    const int vertexCount = drawList->VtxBuffer.Size - firstVertex;
+    if (drawList->CmdBuffer.Size != firstCommand ||
+        drawList->_VtxCurrentIdx - firstVertexIndex != static_cast<unsigned int>(vertexCount)) {
+        return;
+    }
+    cache.vertices.assign(drawList->VtxBuffer.Data + firstVertex, drawList->VtxBuffer.Data + drawList->VtxBuffer.Size);
+    cache.indices.reserve(static_cast<size_t>(drawList->IdxBuffer.Size - firstIndex));
+    for (int i = firstIndex; i < drawList->IdxBuffer.Size; ++i) {
+        cache.indices.push_back(static_cast<ImDrawIdx>(drawList->IdxBuffer.Data[i] - firstVertexIndex));
+    }
+
+    const ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    cache.topMin = topMin;
+    cache.topMax = topMax;
+    cache.viewStart = viewStart;
+    cache.viewEnd = viewEnd;
+    cache.durationSeconds = duration;
+    cache.lightMode = isLightMode;
+    cache.clipRect = drawList->_CmdHeader.ClipRect;
+    cache.fontTexture = atlas->TexData;
+    cache.whitePixelUv = atlas->TexUvWhitePixel;
+    cache.fontSize = ImGui::GetFontSize();
+    cache.valid = true;
+}
+
+}
+
 RenderResult renderTimelineImpl(TimelineState& state, const RenderContext& context) {
     RenderResult result{};
 
@@ -290,16 +445,21 @@ RenderResult renderTimelineImpl(TimelineState& state, const RenderContext& conte
     bool usedHighPrecisionGradient = false;
     if (context.presentationResources != nullptr) {
         const int rasterWidth = std::max(1, static_cast<int>(std::ceil(size.x)));
+        ImVec2 uvMin;
+        ImVec2 uvMax;
         const ImTextureID textureId = context.presentationResources->updateTimelineTexture(
             context.samples,
             context.sampleRevision,
+            context.retainedSampleCount,
             viewStart,
             viewEnd,
             rasterWidth,
             context.colourSpace,
-            context.applyGamutMapping);
+            context.applyGamutMapping,
+            uvMin,
+            uvMax);
         if (textureId != ImTextureID_Invalid) {
-            drawList->AddImage(textureId, gradientMin, gradientMax);
+            drawList->AddImage(textureId, gradientMin, gradientMax, uvMin, uvMax);
             usedHighPrecisionGradient = true;
         }
     }
@@ -321,63 +481,8 @@ RenderResult renderTimelineImpl(TimelineState& state, const RenderContext& conte
                       1.0f);
     drawList->AddRect(gradientMin, gradientMax, isLightMode ? IM_COL32(210, 210, 210, 255) : IM_COL32(38, 38, 38, 255));
 
-    const double duration = std::max(context.durationSeconds, 0.0);
-    const double viewSpanNormalised = static_cast<double>(viewEnd - viewStart);
-    const double visibleDuration = std::max(viewSpanNormalised * duration, 1e-6);
-
-    const double majorStep = Labels::chooseMajorTickStep(visibleDuration);
-    const double epsilon = majorStep * 0.05;
-    const int minorDivisions = 4;
-    const double minorStep = minorDivisions > 0 ? majorStep / static_cast<double>(minorDivisions) : majorStep;
-
-    const double visibleStartSeconds = static_cast<double>(viewStart) * duration;
-    const double visibleEndSeconds = static_cast<double>(viewEnd) * duration;
-
-    if (duration > 0.0 && visibleDuration > 0.0) {
-        double firstMajor = std::floor((visibleStartSeconds) / majorStep) * majorStep;
-        if (firstMajor < 0.0) {
-            firstMajor = 0.0;
-        }
-
-        for (double t = firstMajor; t <= visibleEndSeconds + epsilon; t += majorStep) {
-            if (t < visibleStartSeconds - epsilon) {
-                continue;
-            }
-
-            const float local = static_cast<float>((t - visibleStartSeconds) / visibleDuration);
-            const float x = topMin.x + std::clamp(local, 0.0f, 1.0f) * size.x;
-
-            drawList->AddLine(ImVec2(x, topMin.y + 2.0f),
-                              ImVec2(x, topMax.y),
-                              isLightMode ? IM_COL32(100, 100, 100, 200) : IM_COL32(180, 180, 180, 220),
-                              1.0f);
-
-            if (minorDivisions > 1 && majorStep > 0.0) {
-                const double segmentEnd = t + majorStep;
-                for (int i = 1; i < minorDivisions; ++i) {
-                    const double minorTime = t + i * minorStep;
-                    if (minorTime >= segmentEnd - epsilon || minorTime > visibleEndSeconds + epsilon) {
-                        break;
-                    }
-                    if (minorTime < visibleStartSeconds - epsilon) {
-                        continue;
-                    }
-                    const float minorLocal = static_cast<float>((minorTime - visibleStartSeconds) / visibleDuration);
-                    const float mx = topMin.x + std::clamp(minorLocal, 0.0f, 1.0f) * size.x;
-                    drawList->AddLine(ImVec2(mx, topMax.y - topBarHeight * 0.45f),
-                                      ImVec2(mx, topMax.y - 2.0f),
-                                      isLightMode ? IM_COL32(140, 140, 140, 160) : IM_COL32(90, 90, 90, 180),
-                                      1.0f);
-                }
-            }
-
-            std::string label = Labels::formatTickLabel(t, majorStep);
-            ImVec2 textSize = ImGui::CalcTextSize(label.c_str());
-            ImVec2 textPos(x - textSize.x * 0.5f, topMin.y + 4.0f);
-            textPos.x = std::clamp(textPos.x, topMin.x + 4.0f, topMax.x - textSize.x - 4.0f);
-            drawList->AddText(textPos, isLightMode ? IM_COL32(60, 60, 60, 255) : IM_COL32(215, 215, 215, 255), label.c_str());
-        }
-    }
+    drawRuler(drawList, state.rulerCache, topMin, topMax, topBarHeight, viewStart, viewEnd,
+              std::max(context.durationSeconds, 0.0), isLightMode);
 
     if (ImGui::IsMouseHoveringRect(topMin, topMax, ImGuiHoveredFlags_None) && context.allowScrubbing) {
         drawList->AddRectFilled(topMin, topMax, IM_COL32(255, 255, 255, 18), 4.0f, ImDrawFlags_RoundCornersTop);
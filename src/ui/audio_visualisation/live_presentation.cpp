@@ -0,0 +1,253 @@
+#include "ui/audio_visualisation/live_presentation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "audio/processing/audio_processor.h"
+#include "colour/colour_presentation.h"
+#include "ui/smoothing/smoothing_features.h"
+#include "utilities/profiling/frame_profiler.h"
+#include "utilities/telemetry/latency_probe.h"
+
+#ifdef ENABLE_OSC
+#include "synesthesia_osc_integration.h"
+#endif
+
+namespace UI::AudioVisualisation {
+
+namespace {
+
+// As UIConstants::COLOUR_SMOOTH_UPDATE_FACTOR, which the UI's own spring runs at.
+constexpr float kColourSmoothUpdateFactor = 1.2f;
+
+}
+
+LivePresentation::~LivePresentation() {
+    stop();
+}
+
+void LivePresentation::start(AudioProcessor& audioProcessor) {
+    if (worker.joinable() && processor == &audioProcessor) {
+        return;
+    }
+    stop();
+    processor = &audioProcessor;
+    hasPreviousFrame = false;
+    previousFrameCounter = 0;
+    previousTransientCount = audioProcessor.acquireSpectralData()->transientOnsetCount;
+    transientPending = false;
+#ifdef ENABLE_OSC
+    hasOSCFrame = false;
+#endif
+    stopRequested.store(false, std::memory_order_release);
+    worker = std::thread(&LivePresentation::run, this);
+}
+
+void LivePresentation::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    stopRequested.store(true, std::memory_order_release);
+    processor->wakeFrameWaiters();
+    worker.join();
+    processor = nullptr;
+}
+
+void LivePresentation::updateSettings(const Settings& newSettings) {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    settings = newSettings;
+}
+
+bool LivePresentation::copyLatest(Result& result) const {
+    for (;;) {
+        ResultSlot* const slot = publishedResult.load(std::memory_order_seq_cst);
+        if (slot == nullptr) {
+            return false;
+        }
+        slot->readers.fetch_add(1, std::memory_order_seq_cst);
+        if (publishedResult.load(std::memory_order_seq_cst) == slot) {
+            result = slot->result;
+            slot->readers.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+        slot->readers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void LivePresentation::run() {
+    for (;;) {
+        // Read before presenting, so a buffer analysed meanwhile still wakes the wait below.
+        const uint64_t seenGeneration = processor->bufferedFrameGeneration();
+        presentLatestFrame();
+        if (stopRequested.load(std::memory_order_acquire)) {
+            return;
+        }
+        processor->waitForBufferedFrames(seenGeneration);
+    }
+}
+
+void LivePresentation::presentLatestFrame() {
+    const auto snapshot = processor->acquireSpectralData();
+    const auto& spectralData = *snapshot;
+    // The count only falls when the processor is reset, which is not an onset.
+    const bool transientOnset = spectralData.transientOnsetCount > previousTransientCount;
+    previousTransientCount = spectralData.transientOnsetCount;
+    transientPending = transientPending || transientOnset;
+    if (spectralData.magnitudes.empty() || spectralData.sampleRate <= 0.0f ||
+        (hasPreviousFrame && spectralData.frameCounter == previousFrameCounter)) {
+        if (transientOnset) {
+            sendTransientOnset(spectralData.bufferTimestampMicros);
+        }
+        return;
+    }
+    // Also flagged on this frame, in case the OSC event was coalesced into it.
+    const bool transientSinceFrame = std::exchange(transientPending, false);
+
+    Settings current;
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        current = settings;
+    }
+
+    const float sampleRate = spectralData.sampleRate;
+    // A buffer can carry several hops; only its last frame is published, and it stands for all of them.
+    const uint64_t hops = hasPreviousFrame && spectralData.frameCounter > previousFrameCounter
+        ? spectralData.frameCounter - previousFrameCounter
+        : 1;
+    const float elapsedSeconds = static_cast<float>(spectralData.hopSize) * static_cast<float>(hops) / sampleRate;
+
+    const SpectralPresentation::FrameView frame = SpectralPresentation::mixChannels(
+        frameWorkspace,
+        spectralData.magnitudes,
+        spectralData.phases,
+        {},
+        static_cast<std::uint32_t>(spectralData.magnitudes.size()),
+        sampleRate);
+    const SpectralPresentation::FrameView previousView = previousFrame.view();
+    SpectralPresentation::prepareFrame(
+        frameWorkspace,
+        frame,
+        current.presentation,
+        spectralData.momentaryLoudnessLUFS,
+        hasPreviousFrame ? &previousView : nullptr,
+        elapsedSeconds,
+        preparedFrame);
+    const auto& colourResult = preparedFrame.colourResult;
+    namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+    LatencyProbe::frameReached(LatencyProbe::Stage::Colour, spectralData.captureTimestampMicros);
+
+    staging.colourResult = colourResult;
+    // Swapping hands the published slots' buffers back round, so none is reallocated.
+    std::swap(staging.visualiserMagnitudes, preparedFrame.visualiserMagnitudes);
+    staging.frameCounter = spectralData.frameCounter;
+    staging.captureTimestampMicros = spectralData.captureTimestampMicros;
+    staging.featuresValid = std::isfinite(colourResult.r) &&
+        std::isfinite(colourResult.g) &&
+        std::isfinite(colourResult.b);
+    staging.features = SmoothingSignalFeatures{};
+    if (staging.featuresValid) {
+        staging.features = ::UI::Smoothing::buildSignalFeatures(colourResult);
+        staging.features.onsetDetected = spectralData.onsetDetected || transientSinceFrame;
+        staging.features.spectralFlux = spectralData.spectralFlux;
+    }
+
+    float displayR = std::clamp(colourResult.r, 0.0f, 1.0f);
+    float displayG = std::clamp(colourResult.g, 0.0f, 1.0f);
+    float displayB = std::clamp(colourResult.b, 0.0f, 1.0f);
+    if (current.smoothingEnabled && staging.featuresValid) {
+        SYN_PROFILE_SCOPE(ColourSmoothing);
+        colourSmoother.setSmoothingAmount(current.smoothingAmount);
+        float targetL = 0.0f;
+        float targetA = 0.0f;
+        float targetB = 0.0f;
+        ColourCore::XYZtoOklab(colourResult.X, colourResult.Y, colourResult.Z, targetL, targetA, targetB);
+        colourSmoother.setTargetOklab(targetL, targetA, targetB);
+        const float step = elapsedSeconds * kColourSmoothUpdateFactor;
+        if (!current.manualSmoothing) {
+            colourSmoother.update(step, staging.features);
+        } else {
+            colourSmoother.update(step);
+        }
+
+        float smoothedL = 0.0f;
+        float smoothedA = 0.0f;
+        float smoothedB = 0.0f;
+        colourSmoother.getCurrentOklab(smoothedL, smoothedA, smoothedB);
+        float smoothedX = 0.0f;
+        float smoothedY = 0.0f;
+        float smoothedZ = 0.0f;
+        ColourCore::OklabtoXYZ(smoothedL, smoothedA, smoothedB, smoothedX, smoothedY, smoothedZ);
+        const auto smoothedRGB = SpectralPresentation::displayRGBFromXYZ(
+            smoothedX,
+            smoothedY,
+            smoothedZ,
+            current.presentation);
+        displayR = smoothedRGB[0];
+        displayG = smoothedRGB[1];
+        displayB = smoothedRGB[2];
+    }
+    ColourPresentation::applyOutputPrecision(displayR, displayG, displayB);
+    staging.displayColour = {displayR, displayG, displayB};
+    LatencyProbe::frameReached(LatencyProbe::Stage::Smoothing, spectralData.captureTimestampMicros);
+
+#ifdef ENABLE_OSC
+    Synesthesia::OSC::OSCFrameUpdate update{};
+    update.magnitudes = std::span<const float>(staging.visualiserMagnitudes.data(), staging.visualiserMagnitudes.size());
+    update.phases = std::span<const float>(frame.phases.data(), frame.phases.size());
+    update.sampleRate = frame.sampleRate;
+    update.captureTimestampMicros = spectralData.captureTimestampMicros;
+    update.colourResult = colourResult;
+    update.displayColour = ColourCore::RGB{displayR, displayG, displayB};
+    update.analysisSignals = Synesthesia::OSC::buildAnalysisSignals(spectralData);
+    update.analysisSignals.onsetDetected = update.analysisSignals.onsetDetected || transientSinceFrame;
+    update.smoothingSignals = staging.featuresValid
+        ? Synesthesia::OSC::buildSmoothingSignals(staging.features)
+        : Synesthesia::OSC::OSCSmoothingSignals{};
+    auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
+    if (osc.wantsFrames()) {
+        lastOSCFrame = Synesthesia::OSC::buildFrameData(update);
+        hasOSCFrame = true;
+        osc.updateFrameData(lastOSCFrame, update.magnitudes, update.phases);
+    }
+#endif
+
+    previousFrame.assign(frame);
+    previousFrameCounter = spectralData.frameCounter;
+    hasPreviousFrame = true;
+    publishResult();
+}
+
+// Only the flags and the timestamp change; the colour and the analysis values are still the
+// last frame's, as they would be until the next hop anyway. The timestamp is the capture time
+// of the buffer the onset was found in, so a scheduled receiver presents it in step with frames.
+void LivePresentation::sendTransientOnset([[maybe_unused]] const int64_t onsetTimestampMicros) {
+#ifdef ENABLE_OSC
+    auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
+    if (!hasOSCFrame || !osc.wantsFrames()) {
+        return;
+    }
+    Synesthesia::OSC::OSCFrameData event = lastOSCFrame;
+    event.meta.frameTimestamp = onsetTimestampMicros > 0
+        ? onsetTimestampMicros
+        : Synesthesia::OSC::currentTimestampMicros();
+    event.transient.onsetDetected = true;
+    event.smoothing.onsetDetected = true;
+    osc.updateFrameData(event, {});
+#endif
+}
+
+// Same ordering argument as AudioProcessor::publishSpectralData.
+void LivePresentation::publishResult() {
+    ResultSlot* const published = publishedResult.load(std::memory_order_relaxed);
+    for (ResultSlot& slot : resultSlots) {
+        if (&slot == published || slot.readers.load(std::memory_order_seq_cst) != 0) {
+            continue;
+        }
+        std::swap(slot.result, staging);
+        publishedResult.store(&slot, std::memory_order_seq_cst);
+        return;
+    }
+}
+
+}
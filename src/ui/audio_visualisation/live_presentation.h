@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "audio/analysis/presentation/spectral_presentation.h"
+#include "colour/colour_core.h"
+#include "ui/smoothing/smoothing.h"
+
+#ifdef ENABLE_OSC
+#include "osc_messages.h"
+#endif
+
+class AudioProcessor;
+
+namespace UI::AudioVisualisation {
+
+// Turns every frame the analysis thread publishes into a colour on its own thread, so colour
+// latency and OSC output follow the audio rather than the UI's frame rate. The worker sleeps
+// on AudioProcessor's frame generation and reads its published snapshot, leaving the frame
+// rings to the recorder. The UI hands over its settings and samples the latest result,
+// never waiting on the worker.
+//
+// Onsets from AudioProcessor's time-domain detector are not held for the next frame: a
+// buffer that carries one but completes no hop re-sends the last OSC frame at once with its
+// onset flags set, and the next presented frame feeds the onset to the smoother.
+class LivePresentation {
+public:
+    struct Settings {
+        SpectralPresentation::Settings presentation;
+        bool smoothingEnabled = true;
+        bool manualSmoothing = false;
+        float smoothingAmount = 0.6f;
+    };
+
+    struct Result {
+        ColourCore::FrameResult colourResult;
+        SmoothingSignalFeatures features;
+        bool featuresValid = false;
+        std::vector<float> visualiserMagnitudes;
+        // Smoothed at the analysis hop rate; this is what went out over OSC.
+        std::array<float, 3> displayColour{};
+        uint64_t frameCounter = 0;
+        // SpectralData::captureTimestampMicros of the frame, the time its OSC frame carries.
+        int64_t captureTimestampMicros = 0;
+    };
+
+    LivePresentation() = default;
+    ~LivePresentation();
+
+    LivePresentation(const LivePresentation&) = delete;
+    LivePresentation& operator=(const LivePresentation&) = delete;
+
+    // audioProcessor must outlive the worker. Does nothing if it is already running on it.
+    void start(AudioProcessor& audioProcessor);
+    void stop();
+    bool isRunning() const { return worker.joinable(); }
+
+    void updateSettings(const Settings& newSettings);
+
+    // Copies the newest result into result, reusing its storage. Returns false until the worker
+    // has presented a frame, and never blocks.
+    bool copyLatest(Result& result) const;
+
+private:
+    void run();
+    void presentLatestFrame();
+    void sendTransientOnset(int64_t onsetTimestampMicros);
+    void publishResult();
+
+    std::thread worker;
+    AudioProcessor* processor = nullptr;
+    std::atomic<bool> stopRequested{false};
+
+    mutable std::mutex settingsMutex;
+    Settings settings;  // Protected by settingsMutex
+
+    // Worker only
+    SpectralPresentation::Frame previousFrame;
+    bool hasPreviousFrame = false;
+    SpectralPresentation::FrameWorkspace frameWorkspace;
+    SpectralPresentation::PreparedFrame preparedFrame;
+    uint64_t previousFrameCounter = 0;
+    uint64_t previousTransientCount = 0;
+    bool transientPending = false;  // Seen by the detector, not yet given to the smoother
+    SpringSmoother colourSmoother{8.0f, 1.0f, 0.3f};
+#ifdef ENABLE_OSC
+    Synesthesia::OSC::OSCFrameData lastOSCFrame{};
+    bool hasOSCFrame = false;
+#endif
+    Result staging;
+
+    // Results are published the way AudioProcessor publishes its spectral data: the worker
+    // swaps staging into a slot no reader has pinned, and a reader pins the published slot and
+    // confirms it is still the published one before copying.
+    struct ResultSlot {
+        Result result;
+        std::atomic<uint32_t> readers{0};
+    };
+    static constexpr size_t RESULT_SLOTS = 3;
+    std::array<ResultSlot, RESULT_SLOTS> resultSlots;
+    std::atomic<ResultSlot*> publishedResult{nullptr};
+};
+
+}
@@ -1,7 +1,9 @@
 #include "ui/audio_visualisation/presentation_state.h"
+#include "ui/audio_visualisation/live_presentation.h"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <mutex>
 #include <vector>
@@ -12,8 +14,11 @@
 #include "colour/colour_presentation.h"
 #include "resyne/controller/controller.h"
 #include "resyne/recorder/colour_cache_utils.h"
+#include "resyne/recorder/spectral_journal.h"
 #include "resyne/ui/timeline/timeline_gradient.h"
 #include "ui/smoothing/smoothing_features.h"
+#include "utilities/profiling/frame_profiler.h"
+#include "utilities/telemetry/latency_probe.h"
 
 #ifdef ENABLE_OSC
 #include "synesthesia_osc_integration.h"
@@ -23,15 +28,84 @@ namespace UI::AudioVisualisation {
 
 namespace {
 ::UI::Smoothing::MagnitudeHistory playbackSmoothingState;
-AudioProcessor::SpectralData liveSpectralScratch;
 
-struct LivePhaseState {
-    SpectralPresentation::Frame previousFrame;
-    uint64_t previousFrameCounter = 0;
-    bool hasPreviousFrame = false;
+// Reused across UI frames, so sampling the presentation thread's result rarely allocates.
+LivePresentation::Result liveResult;
+
+// While OSC frames are scheduled, results wait here until the time their frames are tagged
+// with, so the visualisation changes when the receivers do. Slots are swapped in and out
+// rather than copied, and when the queue is full its oldest result is shown early.
+struct DelayedLiveResults {
+    static constexpr size_t kCapacity = 64;
+    std::array<LivePresentation::Result, kCapacity> results;
+    LivePresentation::Result incoming;
+    size_t first = 0;
+    size_t count = 0;
+    uint64_t lastQueuedFrame = 0;
+    bool queuedAny = false;
+    bool presentedAny = false;
 };
 
-LivePhaseState livePhaseState;
+DelayedLiveResults delayedLiveResults;
+
+float livePresentationLatencyMs() {
+#ifdef ENABLE_OSC
+    return Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance().getPresentationLatencyMs();
+#else
+    return 0.0f;
+#endif
+}
+
+bool takeLiveResult(const LivePresentation& presentation, const float latencyMs, LivePresentation::Result& result) {
+    DelayedLiveResults& delayed = delayedLiveResults;
+    if (latencyMs <= 0.0f) {
+        delayed.count = 0;
+        delayed.queuedAny = false;
+        delayed.presentedAny = false;
+        return presentation.copyLatest(result);
+    }
+
+    const auto present = [&delayed, &result] {
+        std::swap(result, delayed.results[delayed.first]);
+        delayed.first = (delayed.first + 1) % DelayedLiveResults::kCapacity;
+        --delayed.count;
+        delayed.presentedAny = true;
+    };
+
+    if (presentation.copyLatest(delayed.incoming) &&
+        (!delayed.queuedAny || delayed.incoming.frameCounter != delayed.lastQueuedFrame)) {
+        if (delayed.count == DelayedLiveResults::kCapacity) {
+            present();
+        }
+        delayed.lastQueuedFrame = delayed.incoming.frameCounter;
+        delayed.queuedAny = true;
+        std::swap(delayed.results[(delayed.first + delayed.count) % DelayedLiveResults::kCapacity], delayed.incoming);
+        ++delayed.count;
+    }
+
+    const int64_t nowMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const int64_t dueBefore = nowMicros - static_cast<int64_t>(std::lround(latencyMs * 1000.0f));
+    while (delayed.count > 0 && delayed.results[delayed.first].captureTimestampMicros <= dueBefore) {
+        present();
+    }
+    return delayed.presentedAny;
+}
+
+// Reused across UI frames in the same way, so presenting a playback frame from samples held
+// in memory allocates nothing once the buffers have grown to the track's frame size.
+struct PlaybackScratch {
+    SpectralSequence spilledFrames;
+    SpectralPresentation::SampleSequence::Workspace workspace;
+    SpectralPresentation::PreparedFrame prepared;
+    SpectralPresentation::FrameWorkspace colourWorkspace;
+    SpectralPresentation::PreparedFrame colourPrepared;
+    // The mixed frame, copied out of the workspace so OSC can send it after the samples
+    // lock is released.
+    SpectralPresentation::Frame frame;
+};
+
+PlaybackScratch playbackScratch;
 
 struct LiveEQState {
     float lowGain = 1.0f;
@@ -132,6 +206,7 @@ void applyColourSmoothing(const ColourCore::FrameResult& targetColour,
                           float& outB,
                           const ColourUpdateContext& ctx,
                           const SmoothingSignalFeatures* signalFeatures) {
+    SYN_PROFILE_SCOPE(ColourSmoothing);
     if (ctx.smoothingEnabled) {
         float targetL = 0.0f;
         float targetA = 0.0f;
@@ -227,6 +302,8 @@ void syncRecorderPresentationSettings(UIState& state) {
 
     recorderState.importColourSpace = state.visualSettings.colourSpace;
     recorderState.importGamutMapping = state.visualSettings.gamutMappingEnabled;
+    // Imported tracks are always analysed flat; the EQ panel only drives the live input, so
+    // there is no import EQ drag for the timeline preview to follow.
     recorderState.importLowGain = kNeutralGain;
     recorderState.importMidGain = kNeutralGain;
     recorderState.importHighGain = kNeutralGain;
@@ -250,6 +327,7 @@ void processPlaybackState(AudioInput& audioInput,
                           float& currentDisplayG,
                           float& currentDisplayB,
                           const ColourUpdateContext& ctx) {
+    SYN_PROFILE_SCOPE(Presentation);
     size_t playbackPosition = recorderState.audioOutput->getPlaybackPosition();
 
     if (!recorderState.samples.empty()) {
@@ -269,10 +347,12 @@ void processPlaybackState(AudioInput& audioInput,
     ImVec4 playbackColour = ImVec4(0.0f, 0.0f, 0.0f, 1.0f);
     SmoothingSignalFeatures playbackSignalFeatures{};
     bool playbackSignalFeaturesValid = false;
-    SpectralPresentation::Frame frame{};
-    std::vector<float> visualiserMagnitudes;
+    const SpectralPresentation::Frame& frame = playbackScratch.frame;
+    std::vector<float>& visualiserMagnitudes = playbackScratch.prepared.visualiserMagnitudes;
+    visualiserMagnitudes.clear();
     ColourCore::FrameResult playbackColourResult{};
     bool hasPlaybackColourResult = false;
+    bool playbackSampleReady = true;
 
     if (!recorderState.samples.empty()) {
         const float scrubberPos = std::clamp(recorderState.timeline.scrubberNormalisedPosition, 0.0f, 1.0f);
@@ -282,20 +362,29 @@ void processPlaybackState(AudioInput& audioInput,
         const float position = scrubberPos * (static_cast<float>(recorderState.samples.size()) - 1.0f);
         const size_t sampleIndex = static_cast<size_t>(position);
         const size_t clampedIndex = std::min(sampleIndex, recorderState.samples.size() - 1);
+        // Frames still being hydrated are empty; hold the last colour until they land.
+        playbackSampleReady = recorderState.rsynHydration.isFrameReady(clampedIndex);
+        // A long recording's older frames live in its journal; only these few are read back.
+        const size_t windowStart = clampedIndex > 0 ? clampedIndex - 1 : 0;
+        const size_t windowEnd = std::min(clampedIndex + 1, recorderState.samples.size() - 1);
+        const auto windowFrames = ReSyne::RecorderJournal::recordedFrames(
+            recorderState, windowStart, windowEnd - windowStart + 1, playbackScratch.spilledFrames);
+        const auto sampleAt = [&](const size_t index) -> SpectralFrame {
+            return windowFrames[index - windowStart];
+        };
         auto colourSettings = ReSyne::RecorderColourCache::currentSettings(recorderState);
         colourSettings.smoothingEnabled = false;
         colourSettings.manualSmoothing = false;
         colourSettings.smoothingAmount = 0.0f;
 
         const auto makeSample = [&](const size_t index) {
-            const AudioColourSample* previousSample =
-                index > 0 ? &recorderState.samples[index - 1] : nullptr;
             const auto entry = ReSyne::RecorderColourCache::computeSampleColour(
-                recorderState.samples[index],
-                colourSettings,
-                previousSample);
+                playbackScratch.colourWorkspace,
+                playbackScratch.colourPrepared,
+                sampleAt(index),
+                colourSettings);
             ReSyne::Timeline::TimelineSample sample{};
-            sample.timestamp = recorderState.samples[index].timestamp;
+            sample.timestamp = sampleAt(index).timestamp;
             sample.colour = entry.rgb;
             sample.labL = entry.labL;
             sample.labA = entry.labA;
@@ -315,19 +404,21 @@ void processPlaybackState(AudioInput& audioInput,
                 recorderState.importGamutMapping);
         }
 
-        const auto& currentSample = recorderState.samples[clampedIndex];
-        const AudioColourSample* previousSample =
-            clampedIndex > 0 ? &recorderState.samples[clampedIndex - 1] : nullptr;
-        frame = SpectralPresentation::SampleSequence::buildFrame(currentSample);
+        const SpectralFrame currentSample = sampleAt(clampedIndex);
+        const SpectralFrame previousFrame = clampedIndex > 0 ? sampleAt(clampedIndex - 1) : SpectralFrame{};
+        const SpectralFrame* previousSample = clampedIndex > 0 ? &previousFrame : nullptr;
+        const SpectralPresentation::FrameView mixed =
+            SpectralPresentation::SampleSequence::buildFrame(playbackScratch.workspace.current, currentSample);
 
-        if (!frame.magnitudes.empty()) {
-            const auto preparedFrame = SpectralPresentation::SampleSequence::prepareSampleFrame(
+        if (!mixed.magnitudes.empty()) {
+            playbackScratch.frame.assign(SpectralPresentation::SampleSequence::prepareSampleFrame(
+                playbackScratch.workspace,
                 currentSample,
                 presentationSettings,
+                playbackScratch.prepared,
                 previousSample,
-                ctx.deltaTime);
-            visualiserMagnitudes = preparedFrame.visualiserMagnitudes;
-            const auto& colourResult = preparedFrame.colourResult;
+                ctx.deltaTime));
+            const auto& colourResult = playbackScratch.prepared.colourResult;
             playbackColourResult = colourResult;
             hasPlaybackColourResult = true;
 
@@ -380,7 +471,7 @@ void processPlaybackState(AudioInput& audioInput,
             currentDisplayB,
             ctx,
             playbackSignalFeaturesValid ? &playbackSignalFeatures : nullptr);
-    } else {
+    } else if (playbackSampleReady) {
         currentDisplayR = playbackColour.x;
         currentDisplayG = playbackColour.y;
         currentDisplayB = playbackColour.z;
@@ -417,7 +508,6 @@ void processPlaybackState(AudioInput& audioInput,
 
     ReSyne::updateFromFFT(
         state.resyneState,
-        audioInput.getAudioProcessor(),
         audioInput.getSampleRate(),
         currentDisplayR,
         currentDisplayG,
@@ -431,45 +521,33 @@ void processLiveAudioState(AudioInput& audioInput,
                            float& currentDisplayG,
                            float& currentDisplayB,
                            const ColourUpdateContext& ctx) {
-    (void)recorderState;
+    SYN_PROFILE_SCOPE(Presentation);
     const auto presentationSettings = buildLivePresentationSettings(state);
-    audioInput.copySpectralData(liveSpectralScratch);
-    const auto& spectralData = liveSpectralScratch;
-    const size_t numChannels = spectralData.magnitudes.size();
 
     applyLiveEQIfNeeded(audioInput, state);
 
-    const SpectralPresentation::Frame frame = SpectralPresentation::mixChannels(
-        spectralData.magnitudes,
-        spectralData.phases,
-        {},
-        static_cast<std::uint32_t>(numChannels),
-        spectralData.sampleRate > 0.0f ? spectralData.sampleRate : audioInput.getSampleRate());
-    const float liveLoudnessDb = spectralData.momentaryLoudnessLUFS;
-    const uint64_t frameCounter = spectralData.frameCounter;
-    const bool hasNewFrame = !livePhaseState.hasPreviousFrame || frameCounter != livePhaseState.previousFrameCounter;
-    const auto preparedFrame = SpectralPresentation::prepareFrame(
-        frame,
-        presentationSettings,
-        liveLoudnessDb,
-        hasNewFrame && livePhaseState.hasPreviousFrame ? &livePhaseState.previousFrame : nullptr,
-        spectralData.sampleRate > 0.0f
-            ? static_cast<float>(spectralData.hopSize) / spectralData.sampleRate
-            : ctx.deltaTime);
-    if (hasNewFrame) {
-        livePhaseState.previousFrame = frame;
-        livePhaseState.previousFrameCounter = frameCounter;
-        livePhaseState.hasPreviousFrame = true;
+    // Frames are analysed into colours, and sent over OSC, on the presentation thread; the
+    // UI only springs towards the newest one at its own frame rate.
+    LivePresentation::Settings liveSettings{};
+    liveSettings.presentation = presentationSettings;
+    liveSettings.smoothingEnabled = ctx.smoothingEnabled;
+    liveSettings.manualSmoothing = ctx.manualSmoothing;
+    liveSettings.smoothingAmount = state.visualSettings.colourSmoothingSpeed;
+    state.livePresentation.updateSettings(liveSettings);
+    state.livePresentation.start(audioInput.getAudioProcessor());
+    const bool hasLiveResult = takeLiveResult(state.livePresentation, livePresentationLatencyMs(), liveResult);
+
+    namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+    if (hasLiveResult) {
+        LatencyProbe::frameReached(LatencyProbe::Stage::Interface, liveResult.captureTimestampMicros);
+    }
+    if (recorderState.audioOutput && LatencyProbe::impulseDue()) {
+        recorderState.audioOutput->queueImpulse();
     }
-    const std::vector<float>& visualiserMagnitudes = preparedFrame.visualiserMagnitudes;
-    const bool silentMagnitudeFrame = spectrumIsSilent(visualiserMagnitudes);
-    const auto& colourResult = preparedFrame.colourResult;
-    SmoothingSignalFeatures liveFeatures{};
-    bool liveFeaturesValid = false;
 
-    const float displayR = std::clamp(colourResult.r, 0.0f, 1.0f);
-    const float displayG = std::clamp(colourResult.g, 0.0f, 1.0f);
-    const float displayB = std::clamp(colourResult.b, 0.0f, 1.0f);
+    const std::vector<float>& visualiserMagnitudes = liveResult.visualiserMagnitudes;
+    const bool silentMagnitudeFrame = !hasLiveResult || spectrumIsSilent(visualiserMagnitudes);
+    const bool liveFeaturesValid = hasLiveResult && liveResult.featuresValid;
 
     if (!std::isfinite(ctx.clearColour[0]) || !std::isfinite(ctx.clearColour[1]) || !std::isfinite(ctx.clearColour[2])) {
         ctx.clearColour[0] = 0.1f;
@@ -477,20 +555,15 @@ void processLiveAudioState(AudioInput& audioInput,
         ctx.clearColour[2] = 0.1f;
     }
 
-    if (std::isfinite(displayR) && std::isfinite(displayG) && std::isfinite(displayB)) {
-        liveFeatures = ::UI::Smoothing::buildSignalFeatures(colourResult);
-        liveFeatures.onsetDetected = spectralData.onsetDetected;
-        liveFeatures.spectralFlux = spectralData.spectralFlux;
-        liveFeaturesValid = true;
-
+    if (liveFeaturesValid) {
         applyColourSmoothing(
-            colourResult,
+            liveResult.colourResult,
             presentationSettings,
             currentDisplayR,
             currentDisplayG,
             currentDisplayB,
             ctx,
-            &liveFeatures);
+            &liveResult.features);
     }
 
     ColourPresentation::applyOutputPrecision(
@@ -501,25 +574,8 @@ void processLiveAudioState(AudioInput& audioInput,
     ctx.clearColour[1] = currentDisplayG;
     ctx.clearColour[2] = currentDisplayB;
 
-#ifdef ENABLE_OSC
-    const auto analysisSignals = Synesthesia::OSC::buildAnalysisSignals(spectralData);
-    const auto smoothingSignals = liveFeaturesValid
-        ? Synesthesia::OSC::buildSmoothingSignals(liveFeatures)
-        : Synesthesia::OSC::OSCSmoothingSignals{};
-    sendOSCFrame(
-        visualiserMagnitudes,
-        frame,
-        colourResult,
-        currentDisplayR,
-        currentDisplayG,
-        currentDisplayB,
-        analysisSignals,
-        smoothingSignals);
-#endif
-
     ReSyne::updateFromFFT(
         state.resyneState,
-        audioInput.getAudioProcessor(),
         audioInput.getSampleRate(),
         currentDisplayR,
         currentDisplayG,
@@ -538,7 +594,7 @@ void processLiveAudioState(AudioInput& audioInput,
 
         const float smoothing = resolveSpectrumHistoryFactor(
             state,
-            liveFeaturesValid ? &liveFeatures : nullptr);
+            liveFeaturesValid ? &liveResult.features : nullptr);
         const float newContribution = 1.0f - smoothing;
         const float historyContribution = smoothing;
 
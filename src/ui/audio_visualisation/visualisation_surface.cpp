@@ -60,7 +60,8 @@ void renderSpectrumOverlay(UIState& state,
         resolveSpectrumSampleRate(state, audioInput, hasPlaybackSession),
         layout.sidebarWidth,
         layout.sidebarOnLeft,
-        layout.bottomPanelHeight
+        layout.bottomPanelHeight,
+        state.presentationResources
     );
 }
 
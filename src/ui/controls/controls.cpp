@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <filesystem>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "audio/analysis/presentation/sample_sequence.h"
@@ -13,6 +15,10 @@
 #include "colour/colour_core.h"
 #include "ui.h"
 #include "resyne/recorder/recorder.h"
+#include "resyne/recorder/spectral_journal.h"
+#include "utilities/telemetry/latency_probe.h"
+#include "utilities/telemetry/telemetry.h"
+#include "utilities/threading/realtime_thread.h"
 #ifdef ENABLE_OSC
 #include "synesthesia_osc_integration.h"
 #endif
@@ -22,7 +28,14 @@
 
 namespace {
 
-AudioProcessor::SpectralData liveSpectralScratch;
+// Reused across UI frames, so the stats panel allocates nothing once the buffers have grown.
+struct FrequencyInfoScratch {
+    SpectralSequence spilledFrames;
+    SpectralPresentation::SampleSequence::Workspace workspace;
+    SpectralPresentation::PreparedFrame prepared;
+};
+
+FrequencyInfoScratch frequencyInfoScratch;
 
 void renderWrappedStatusText(const char* text, const ImVec4* colour = nullptr) {
     ImGui::PushTextWrapPos(ImGui::GetCursorPos().x + ImGui::GetContentRegionAvail().x);
@@ -114,7 +127,6 @@ void renderFrequencyInfoPanel(AudioInput& audioInput, float* clear_colour, const
             ? buildPlaybackPresentationSettings(state, recorderState)
             : buildLivePresentationSettings(state);
 
-        SpectralPresentation::Frame frame{};
 		float loudnessOverride = ColourCore::LOUDNESS_DB_UNSPECIFIED;
         if (hasPlaybackSession) {
             std::lock_guard<std::mutex> lock(recorderState.samplesMutex);
@@ -123,14 +135,19 @@ void renderFrequencyInfoPanel(AudioInput& audioInput, float* clear_colour, const
             const size_t sampleIndex = static_cast<size_t>(position);
             const size_t clampedIndex = std::min(sampleIndex, recorderState.samples.size() - 1);
 
-            const auto& currentSample = recorderState.samples[clampedIndex];
-            frame = SpectralPresentation::SampleSequence::buildFrame(currentSample);
-            const AudioColourSample* previousSample =
-                clampedIndex > 0 ? &recorderState.samples[clampedIndex - 1] : nullptr;
-            const auto currentColourResult = SpectralPresentation::SampleSequence::buildSampleColourResult(
+            const size_t windowStart = clampedIndex > 0 ? clampedIndex - 1 : 0;
+            const auto windowFrames = ReSyne::RecorderJournal::recordedFrames(
+                recorderState, windowStart, clampedIndex - windowStart + 1, frequencyInfoScratch.spilledFrames);
+            const SpectralFrame currentSample = windowFrames.back();
+            const SpectralFrame previousFrame = windowFrames.front();
+            const SpectralFrame* previousSample = clampedIndex > 0 ? &previousFrame : nullptr;
+            SpectralPresentation::SampleSequence::prepareSampleFrame(
+                frequencyInfoScratch.workspace,
                 currentSample,
                 settings,
+                frequencyInfoScratch.prepared,
                 previousSample);
+            const auto& currentColourResult = frequencyInfoScratch.prepared.colourResult;
             const bool hasFiniteLoudness = std::isfinite(currentColourResult.loudnessDb);
             if (currentColourResult.dominantFrequency > 0.0f) {
                 ImGui::Text("Spectral centroid: %.1f Hz", static_cast<double>(currentColourResult.dominantFrequency));
@@ -149,21 +166,27 @@ void renderFrequencyInfoPanel(AudioInput& audioInput, float* clear_colour, const
             ImGui::Spacing();
             return;
         } else {
-            audioInput.copySpectralData(liveSpectralScratch);
-            const auto& spectralData = liveSpectralScratch;
-            frame = SpectralPresentation::mixChannels(
+            const auto liveSnapshot = audioInput.acquireSpectralData();
+            const auto& spectralData = *liveSnapshot;
+            const SpectralPresentation::FrameView frame = SpectralPresentation::mixChannels(
+                frequencyInfoScratch.workspace.current,
                 spectralData.magnitudes,
                 spectralData.phases,
                 {},
                 static_cast<std::uint32_t>(spectralData.magnitudes.size()),
                 spectralData.sampleRate > 0.0f ? spectralData.sampleRate : audioInput.getSampleRate());
 			loudnessOverride = spectralData.momentaryLoudnessLUFS;
+            SpectralPresentation::prepareFrame(
+                frequencyInfoScratch.workspace.current,
+                frame,
+                settings,
+                loudnessOverride,
+                nullptr,
+                0.0f,
+                frequencyInfoScratch.prepared);
         }
 
-		auto currentColourResult = SpectralPresentation::buildColourResult(
-            frame,
-            settings,
-            loudnessOverride);
+		const auto& currentColourResult = frequencyInfoScratch.prepared.colourResult;
 
 		const bool hasFiniteLoudness = std::isfinite(currentColourResult.loudnessDb);
 		if (currentColourResult.dominantFrequency > 0.0f) {
@@ -298,7 +321,8 @@ void renderEQControlsPanel(float& lowGain,
     }
 }
 
-void renderAdvancedSettingsPanel(UIState& state
+void renderAdvancedSettingsPanel(UIState& state,
+                                 ReSyne::RecorderState& recorderState
 #ifdef ENABLE_MIDI
                                   , MIDIInput* midiInput
                                   , const std::vector<MIDIInput::DeviceInfo>* midiDevices
@@ -389,22 +413,178 @@ void renderAdvancedSettingsPanel(UIState& state
                 ImGui::SetTooltip("When enabled, colours are compressed into the display gamut.\nDisable to preserve raw values for wide-gamut workflows.");
             }
 
+            ImGui::Spacing();
+            ImGui::Text("Frame Rate");
+            ImGui::SliderFloat("##MainWindowRateCap", &state.framePacing.mainWindowRateCap, 0.0f, 240.0f,
+                               state.framePacing.mainWindowRateCap > 0.0f ? "Main: %.0f fps" : "Main: Display");
+            ImGui::SliderFloat("##DetachedWindowRateCap", &state.framePacing.detachedWindowRateCap, 0.0f, 240.0f,
+                               state.framePacing.detachedWindowRateCap > 0.0f ? "Detached: %.0f fps" : "Detached: Display");
+            ImGui::Checkbox("Throttle When Idle", &state.framePacing.idleThrottling);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Redraws only a few times a second while no audio is running\nand nothing is being interacted with.");
+            }
+
             ImGui::Spacing();
             ImGui::TextDisabled("Presentation Debug");
             std::array<char, 192> debugText{};
             std::snprintf(
                 debugText.data(),
                 debugText.size(),
-                "Textures: %s\nDisplay: %s\nBackground: %s",
+                "Textures: %s\nDisplay: %s\nBackground: %s\nRendering: %s",
                 texturePrecisionLabel(state.presentationDiagnostics),
                 displaySurfacePrecisionLabel(state.presentationDiagnostics.displaySurfacePrecision),
-                backgroundPresentationLabel(state.presentationDiagnostics));
+                backgroundPresentationLabel(state.presentationDiagnostics),
+                state.presentationDiagnostics.renderThreadActive ? "render thread" : "UI thread");
             ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
             renderWrappedStatusText(debugText.data());
             ImGui::PopStyleColor();
 
+            ImGui::Spacing();
+            ImGui::TextDisabled("Threads");
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Start with --realtime, --rt-priority, --cpu-audio, --cpu-analysis,\n--cpu-osc or --keep-denormals to change these.");
+            }
+            ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+            for (const Utilities::Threading::ThreadRole role : Utilities::Threading::kThreadRoles) {
+                renderWrappedStatusText(Utilities::Threading::describe(role).c_str());
+            }
+            ImGui::PopStyleColor();
+
+#ifdef ENABLE_FRAME_PROFILER
+            ImGui::Checkbox("Frame Profiler", &state.visibility.showFrameProfiler);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Times the analysis, presentation, OSC and render stages\nwhile the profiler window is open.");
+            }
+#endif
+
 			ImGui::Unindent(10);
         }
+
+        if (ImGui::CollapsingHeader("Telemetry")) {
+            ImGui::Indent(10);
+            using Utilities::Telemetry::Counter;
+            using Utilities::Telemetry::Gauge;
+            using Utilities::Telemetry::Stage;
+            const Utilities::Telemetry::Snapshot telemetry = Utilities::Telemetry::snapshot();
+            const ImVec4 warningColour(1.0f, 0.6f, 0.2f, 1.0f);
+            const bool hadXruns = telemetry.xruns() > 0;
+            if (hadXruns) {
+                ImGui::PushStyleColor(ImGuiCol_Text, warningColour);
+            }
+            ImGui::Text("Xruns: %llu", static_cast<unsigned long long>(telemetry.xruns()));
+            if (hadXruns) {
+                ImGui::PopStyleColor();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Input overflows: %llu\nInput underflows: %llu\nOutput underflows: %llu\nOutput overflows: %llu",
+                                  static_cast<unsigned long long>(telemetry.counter(Counter::InputOverflows)),
+                                  static_cast<unsigned long long>(telemetry.counter(Counter::InputUnderflows)),
+                                  static_cast<unsigned long long>(telemetry.counter(Counter::OutputUnderflows)),
+                                  static_cast<unsigned long long>(telemetry.counter(Counter::OutputOverflows)));
+            }
+            ImGui::Text("Dropped: %llu buffers, %llu frames",
+                        static_cast<unsigned long long>(telemetry.counter(Counter::AnalysisBuffersDropped)),
+                        static_cast<unsigned long long>(telemetry.counter(Counter::SpectrumFramesDropped)));
+            ImGui::Text("Analysis queue: %.0f, ring %.1f%%",
+                        telemetry.gauge(Gauge::AnalysisQueueDepth), telemetry.gauge(Gauge::AnalysisRingFill) * 100.0);
+            ImGui::Text("Frame ring: %.1f%%", telemetry.gauge(Gauge::SpectrumRingFill) * 100.0);
+
+            ImGui::Spacing();
+            ImGui::TextDisabled("Stage (last / mean / peak ms)");
+            for (size_t index = 0; index < Utilities::Telemetry::kStageCount; ++index) {
+                const auto stage = static_cast<Stage>(index);
+                const Utilities::Telemetry::StageSample& sample = telemetry.stage(stage);
+                ImGui::Text("%s: %.2f / %.2f / %.2f", Utilities::Telemetry::name(stage),
+                            sample.lastMs(), sample.meanMs(), sample.peakMs());
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%s", Utilities::Telemetry::description(stage));
+                }
+            }
+
+            ImGui::Spacing();
+            ImGui::TextDisabled("Memory (current / peak MB)");
+            ImGui::Text("total: %.1f / %.1f", telemetry.totalMemory.megabytes(), telemetry.totalMemory.peakMegabytes());
+            for (size_t index = 0; index < Utilities::Telemetry::kMemoryCount; ++index) {
+                const auto memory = static_cast<Utilities::Telemetry::Memory>(index);
+                const Utilities::Telemetry::MemorySample& sample = telemetry.memoryUsage(memory);
+                ImGui::Text("%s: %.1f / %.1f", Utilities::Telemetry::name(memory),
+                            sample.megabytes(), sample.peakMegabytes());
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%s", Utilities::Telemetry::description(memory));
+                }
+            }
+            ImGui::Unindent(10);
+        }
+
+        if (ImGui::CollapsingHeader("Latency Probe")) {
+            ImGui::Indent(10);
+            namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+            static int probeSource = 0;
+            static std::string probeStatus;
+            const bool probeRunning = LatencyProbe::isRunning();
+
+            ImGui::BeginDisabled(probeRunning);
+            ImGui::RadioButton("Output impulse", &probeSource, 0);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Plays a click through the output once a second.\nLoop the output back into the input to time it.");
+            }
+            ImGui::RadioButton("External onsets", &probeSource, 1);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Times any sharp onset the input picks up,\nsuch as a click track on another player.");
+            }
+            ImGui::EndDisabled();
+
+            if (!probeRunning) {
+                if (ImGui::Button("Start Probe")) {
+                    const auto source = probeSource == 0 ? LatencyProbe::Source::OutputImpulse
+                                                         : LatencyProbe::Source::ExternalTransient;
+                    if (source == LatencyProbe::Source::OutputImpulse &&
+                        !ReSyne::Recorder::ensureProbeOutput(recorderState)) {
+                        probeStatus = "Unable to open the output device";
+                    } else {
+                        LatencyProbe::start(source);
+                        probeStatus.clear();
+                    }
+                }
+            } else if (ImGui::Button("Stop Probe")) {
+                LatencyProbe::stop();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save Report")) {
+                std::error_code error;
+                const std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+                if (error) {
+                    probeStatus = "Unable to find a temporary directory";
+                } else {
+                    const std::filesystem::path path = directory / "synesthesia-latency.json";
+                    std::string errorMessage;
+                    probeStatus = LatencyProbe::writeJson(LatencyProbe::collect(), path, errorMessage)
+                        ? "Saved " + path.string()
+                        : errorMessage;
+                }
+            }
+
+            const LatencyProbe::Report report = LatencyProbe::collect();
+            ImGui::Text("Trials: %llu, missed %llu",
+                        static_cast<unsigned long long>(report.trials),
+                        static_cast<unsigned long long>(report.missed));
+            ImGui::Spacing();
+            ImGui::TextDisabled("Stage from impulse (p50 / p95 / max ms)");
+            for (size_t index = 0; index < LatencyProbe::kStageCount; ++index) {
+                const LatencyProbe::StageDistribution& stage = report.stages[index];
+                const char* stageName = LatencyProbe::name(static_cast<LatencyProbe::Stage>(index));
+                if (stage.count == 0) {
+                    ImGui::TextDisabled("%s: -", stageName);
+                } else {
+                    ImGui::Text("%s: %.1f / %.1f / %.1f", stageName, stage.p50Ms, stage.p95Ms, stage.maxMs);
+                }
+            }
+            ImGui::Text("total: %.1f / %.1f / %.1f", report.total.p50Ms, report.total.p95Ms, report.total.maxMs);
+            if (!probeStatus.empty()) {
+                renderWrappedStatusText(probeStatus.c_str());
+            }
+            ImGui::Unindent(10);
+        }
         
 #ifdef ENABLE_OSC
         if (ImGui::CollapsingHeader("OSC")) {
@@ -425,7 +605,7 @@ void renderAdvancedSettingsPanel(UIState& state
 	                const ImVec4 errorColour(1.0f, 0.3f, 0.3f, 1.0f);
 	                renderWrappedStatusText(destinationValidation.errorMessage.c_str(), &errorColour);
 	            } else {
-	                renderWrappedStatusText("Loopback or RFC1918 private IPv4 only");
+	                renderWrappedStatusText("Loopback, RFC1918 private or 239.x multicast IPv4 only");
 	            }
 
 	            ImGui::Text("Transmit Port");
@@ -434,6 +614,74 @@ void renderAdvancedSettingsPanel(UIState& state
 	            ImGui::Text("Receive Port");
 	            ImGui::InputInt("##OSCReceivePort", &state.oscSettings.receivePort);
 
+	            ImGui::Checkbox("Packed Frames", &state.oscSettings.packedFrames);
+	            renderWrappedStatusText("One /synesthesia/frame/packed message per frame");
+
+	            ImGui::Text("Additional Destinations");
+	            bool extraDestinationsValid = true;
+	            std::vector<Synesthesia::OSC::OSCDestination> desiredExtraDestinations;
+	            for (size_t i = 0; i < state.oscSettings.extraDestinations.size();) {
+	                auto& extra = state.oscSettings.extraDestinations[i];
+	                ImGui::PushID(static_cast<int>(i));
+	                std::array<char, 16> extraHost{};
+	                std::snprintf(extraHost.data(), extraHost.size(), "%s", extra.host.c_str());
+	                if (ImGui::InputText("##OSCExtraHost", extraHost.data(), extraHost.size())) {
+	                    extra.host = extraHost.data();
+	                }
+	                ImGui::InputInt("##OSCExtraPort", &extra.port);
+	                extra.port = std::clamp(extra.port, 1, 65535);
+	                ImGui::Checkbox("Packed", &extra.packedFrames);
+	                ImGui::SameLine();
+	                ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.6f);
+	                ImGui::SliderFloat("##OSCExtraRate", &extra.maxRateHz, 0.0f, 120.0f,
+	                                   extra.maxRateHz > 0.0f ? "%.0f Hz" : "Every frame");
+	                const auto extraValidation = Synesthesia::OSC::validateOSCDestination(extra.host);
+	                if (!extraValidation.valid) {
+	                    const ImVec4 errorColour(1.0f, 0.3f, 0.3f, 1.0f);
+	                    renderWrappedStatusText(extraValidation.errorMessage.c_str(), &errorColour);
+	                    extraDestinationsValid = false;
+	                }
+	                const bool removed = ImGui::Button("Remove");
+	                ImGui::PopID();
+	                if (removed) {
+	                    state.oscSettings.extraDestinations.erase(state.oscSettings.extraDestinations.begin() +
+	                                                              static_cast<std::ptrdiff_t>(i));
+	                    continue;
+	                }
+
+	                Synesthesia::OSC::OSCDestination destination;
+	                destination.host = extraValidation.valid ? extraValidation.canonicalHost : extra.host;
+	                destination.port = static_cast<uint16_t>(extra.port);
+	                destination.frameFormat = extra.packedFrames
+	                    ? Synesthesia::OSC::OSCFrameFormat::Packed
+	                    : Synesthesia::OSC::OSCFrameFormat::Named;
+	                destination.maxRateHz = extra.maxRateHz;
+	                desiredExtraDestinations.push_back(std::move(destination));
+	                ++i;
+	            }
+	            if (ImGui::Button("Add Destination")) {
+	                state.oscSettings.extraDestinations.emplace_back();
+	            }
+
+	            ImGui::Checkbox("Stream Spectrum", &state.oscSettings.streamSpectrum);
+	            if (state.oscSettings.streamSpectrum) {
+	                ImGui::Checkbox("All Bins", &state.oscSettings.spectrumAllBins);
+	                ImGui::SameLine();
+	                ImGui::Checkbox("16-bit", &state.oscSettings.spectrumWideLevels);
+	                ImGui::SliderFloat("##OSCSpectrumRate", &state.oscSettings.spectrumRateHz, 1.0f, 120.0f, "%.0f Hz");
+	                renderWrappedStatusText(state.oscSettings.spectrumAllBins
+	                    ? "Every FFT bin to /synesthesia/frame/spectrum"
+	                    : "Critical bands to /synesthesia/frame/spectrum");
+	            }
+
+	            ImGui::Text("Presentation Latency");
+	            ImGui::SliderFloat("##OSCPresentationLatency", &state.oscSettings.presentationLatencyMs, 0.0f,
+	                               Synesthesia::OSC::kMaxPresentationLatencyMs,
+	                               state.oscSettings.presentationLatencyMs > 0.0f ? "%.0f ms" : "Immediate");
+	            renderWrappedStatusText(state.oscSettings.presentationLatencyMs > 0.0f
+	                ? "Bundles are time-tagged this long after capture; the visualisation waits as long"
+	                : "Bundles are sent for immediate use");
+
 	            state.oscSettings.transmitPort = std::clamp(state.oscSettings.transmitPort, 1, 65535);
 	            state.oscSettings.receivePort = std::clamp(state.oscSettings.receivePort, 1, 65535);
 
@@ -459,6 +707,18 @@ void renderAdvancedSettingsPanel(UIState& state
                 if (stats.averageSendTimeMs > 0.0f) {
                     ImGui::Text("Average Send Time: %.2fms", static_cast<double>(stats.averageSendTimeMs));
                 }
+                ImGui::Text("Frames Coalesced: %llu", static_cast<unsigned long long>(stats.framesCoalesced));
+                ImGui::Text("Frames Dropped: %llu", static_cast<unsigned long long>(stats.framesDropped));
+                ImGui::Text("Latency p50/p95/p99: %.2f / %.2f / %.2fms",
+                            static_cast<double>(stats.latencyP50Ms),
+                            static_cast<double>(stats.latencyP95Ms),
+                            static_cast<double>(stats.latencyP99Ms));
+                ImGui::Text("Latency Max: %.2fms", static_cast<double>(stats.latencyMaxMs));
+                ImGui::Text("Jitter: %.2fms", static_cast<double>(stats.jitterMs));
+                for (const auto& destination : stats.destinations) {
+                    ImGui::Text("%s:%u  %.1f KB/s", destination.host.c_str(), static_cast<unsigned>(destination.port),
+                                static_cast<double>(destination.bytesPerSecond) / 1024.0);
+                }
                 ImGui::PopTextWrapPos();
                 ImGui::Separator();
             }
@@ -467,18 +727,38 @@ void renderAdvancedSettingsPanel(UIState& state
             const std::string desiredDestination = destinationValidation.valid
                 ? destinationValidation.canonicalHost
                 : state.oscSettings.destinationHost;
+            const auto desiredFrameFormat = state.oscSettings.packedFrames
+                ? Synesthesia::OSC::OSCFrameFormat::Packed
+                : Synesthesia::OSC::OSCFrameFormat::Named;
+            Synesthesia::OSC::OSCSpectrumConfig desiredSpectrum = currentConfig.spectrum;
+            desiredSpectrum.enabled = state.oscSettings.streamSpectrum;
+            desiredSpectrum.layout = state.oscSettings.spectrumAllBins
+                ? Synesthesia::OSC::OSCSpectrumLayout::Bins
+                : Synesthesia::OSC::OSCSpectrumLayout::CriticalBands;
+            desiredSpectrum.precision = state.oscSettings.spectrumWideLevels
+                ? Synesthesia::OSC::OSCSpectrumPrecision::UInt16
+                : Synesthesia::OSC::OSCSpectrumPrecision::UInt8;
+            desiredSpectrum.rateHz = state.oscSettings.spectrumRateHz;
             const bool hasPendingConfigChanges =
                 desiredDestination != currentConfig.destinationHost ||
                 static_cast<uint16_t>(state.oscSettings.transmitPort) != currentConfig.transmitPort ||
-                static_cast<uint16_t>(state.oscSettings.receivePort) != currentConfig.receivePort;
+                static_cast<uint16_t>(state.oscSettings.receivePort) != currentConfig.receivePort ||
+                desiredFrameFormat != currentConfig.frameFormat ||
+                desiredSpectrum != currentConfig.spectrum ||
+                state.oscSettings.presentationLatencyMs != currentConfig.presentationLatencyMs ||
+                desiredExtraDestinations != currentConfig.additionalDestinations;
 
             if (transportRunning && hasPendingConfigChanges) {
-                ImGui::BeginDisabled(!destinationValidation.valid);
+                ImGui::BeginDisabled(!destinationValidation.valid || !extraDestinationsValid);
                 if (ImGui::Button("Apply Settings", ImVec2(ImGui::GetContentRegionAvail().x, 0))) {
                     Synesthesia::OSC::OSCConfig config;
                     config.destinationHost = state.oscSettings.destinationHost;
                     config.transmitPort = static_cast<uint16_t>(state.oscSettings.transmitPort);
                     config.receivePort = static_cast<uint16_t>(state.oscSettings.receivePort);
+                    config.frameFormat = desiredFrameFormat;
+                    config.spectrum = desiredSpectrum;
+                    config.presentationLatencyMs = state.oscSettings.presentationLatencyMs;
+                    config.additionalDestinations = desiredExtraDestinations;
                     osc.updateConfig(config);
                     state.oscEnabled = osc.isRunning();
                     state.oscSettings.destinationHost = osc.getConfig().destinationHost;
@@ -488,7 +768,7 @@ void renderAdvancedSettingsPanel(UIState& state
             }
 
             const float buttonWidth = ImGui::GetContentRegionAvail().x;
-            ImGui::BeginDisabled(!transportRunning && !destinationValidation.valid);
+            ImGui::BeginDisabled(!transportRunning && (!destinationValidation.valid || !extraDestinationsValid));
             if (ImGui::Button(transportRunning ? "Disable" : "Enable", ImVec2(buttonWidth, 0))) {
                 if (transportRunning) {
                     state.oscEnabled = false;
@@ -498,12 +778,43 @@ void renderAdvancedSettingsPanel(UIState& state
                     config.destinationHost = state.oscSettings.destinationHost;
                     config.transmitPort = static_cast<uint16_t>(state.oscSettings.transmitPort);
                     config.receivePort = static_cast<uint16_t>(state.oscSettings.receivePort);
+                    config.frameFormat = desiredFrameFormat;
+                    config.spectrum = desiredSpectrum;
+                    config.presentationLatencyMs = state.oscSettings.presentationLatencyMs;
+                    config.additionalDestinations = desiredExtraDestinations;
                     state.oscEnabled = osc.start(config);
                     state.oscSettings.destinationHost = osc.getConfig().destinationHost;
                 }
             }
             ImGui::EndDisabled();
 
+            ImGui::Spacing();
+            ImGui::Separator();
+            ImGui::Text("Shared Memory Output");
+            const bool sharedMemoryRunning = osc.isSharedMemoryOutputRunning();
+            std::array<char, 64> sharedMemoryName{};
+            std::snprintf(sharedMemoryName.data(), sharedMemoryName.size(), "%s", state.oscSettings.sharedMemoryName.c_str());
+            ImGui::BeginDisabled(sharedMemoryRunning);
+            if (ImGui::InputText("##SharedMemoryName", sharedMemoryName.data(), sharedMemoryName.size())) {
+                state.oscSettings.sharedMemoryName = sharedMemoryName.data();
+            }
+            ImGui::EndDisabled();
+            if (!state.oscSettings.sharedMemoryError.empty()) {
+                const ImVec4 errorColour(1.0f, 0.3f, 0.3f, 1.0f);
+                renderWrappedStatusText(state.oscSettings.sharedMemoryError.c_str(), &errorColour);
+            } else {
+                renderWrappedStatusText("Frames and spectrum for readers on this machine, without the UDP transport");
+            }
+            if (ImGui::Button(sharedMemoryRunning ? "Close Shared Memory" : "Open Shared Memory",
+                              ImVec2(ImGui::GetContentRegionAvail().x, 0))) {
+                state.oscSettings.sharedMemoryError.clear();
+                if (sharedMemoryRunning) {
+                    osc.stopSharedMemoryOutput();
+                } else {
+                    osc.startSharedMemoryOutput(state.oscSettings.sharedMemoryName, state.oscSettings.sharedMemoryError);
+                }
+            }
+
 			ImGui::Unindent(10);
         }
 #endif
@@ -39,7 +39,8 @@ namespace Controls {
                               float buttonHeight,
                               float contentWidth);
 
-    void renderAdvancedSettingsPanel(UIState& state
+    void renderAdvancedSettingsPanel(UIState& state,
+                                     ReSyne::RecorderState& recorderState
 #ifdef ENABLE_MIDI
                                   , MIDIInput* midiInput = nullptr
                                   , const std::vector<MIDIInput::DeviceInfo>* midiDevices = nullptr
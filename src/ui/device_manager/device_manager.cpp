@@ -4,10 +4,37 @@
 #include <portaudio.h>
 #include <algorithm>
 #include <array>
+#include <iterator>
 #include <string>
 
 namespace {
 
+constexpr std::array<int, 8> kBufferSizeChoices{0, 64, 128, 256, 512, 1024, 2048, 4096};
+constexpr std::array<const char*, 8> kBufferSizeLabels{
+    "Default", "64 frames", "128 frames", "256 frames", "512 frames", "1024 frames", "2048 frames", "4096 frames"
+};
+constexpr std::array<double, 7> kLatencyChoices{0.0, 0.002, 0.005, 0.010, 0.020, 0.040, 0.080};
+constexpr std::array<const char*, 7> kLatencyLabels{
+    "Device default", "2 ms", "5 ms", "10 ms", "20 ms", "40 ms", "80 ms"
+};
+
+template <typename T, size_t N>
+int choiceIndex(const std::array<T, N>& choices, const T value) {
+    const auto it = std::find(choices.begin(), choices.end(), value);
+    // A value set from the command line may match none of the choices.
+    return it != choices.end() ? static_cast<int>(std::distance(choices.begin(), it)) : -1;
+}
+
+void renderStreamLatency(const char* label, const AudioStreamLatency& latency) {
+    if (latency.sampleRate <= 0.0) {
+        ImGui::TextDisabled("%s: not open", label);
+        return;
+    }
+    ImGui::Text("%s: %.1f ms", label, latency.latencySeconds * 1000.0);
+    ImGui::SameLine();
+    ImGui::TextDisabled("%lu frames, %s", latency.framesPerBuffer, AudioStreamConfig::hostApiName(latency.hostApi));
+}
+
 std::vector<DeviceSelector::Item> buildSelectorItems(const std::vector<const char*>& names,
                                                      const int selectedIndex,
                                                      const bool selectedActive,
@@ -55,31 +82,40 @@ std::vector<DeviceSelector::Item> buildInputSelectorItems(
 
 void DeviceManager::populateDeviceNames(DeviceState& deviceState,
                                         const std::vector<AudioInput::DeviceInfo>& devices) {
-    if (!deviceState.deviceNamesPopulated && !devices.empty()) {
-        deviceState.deviceNames.reserve(devices.size());
-        for (const auto& dev : devices) {
-            deviceState.deviceNames.push_back(dev.name.c_str());
-        }
-        deviceState.deviceNamesPopulated = true;
+    if (deviceState.deviceNamesPopulated && deviceState.deviceNamesVersion == deviceState.deviceListVersion) {
+        return;
+    }
+
+    deviceState.deviceNames.clear();
+    deviceState.deviceNames.reserve(devices.size());
+    for (const auto& dev : devices) {
+        deviceState.deviceNames.push_back(dev.name.c_str());
     }
+    deviceState.deviceNamesPopulated = true;
+    deviceState.deviceNamesVersion = deviceState.deviceListVersion;
 }
 
 void DeviceManager::populateOutputDeviceNames(DeviceState& deviceState,
                                               const std::vector<AudioOutput::DeviceInfo>& outputDevices) {
-    if (!deviceState.outputDeviceNamesPopulated && !outputDevices.empty()) {
-        deviceState.outputDeviceNames.reserve(outputDevices.size());
-        for (const auto& dev : outputDevices) {
-            deviceState.outputDeviceNames.push_back(dev.name.c_str());
-        }
-        deviceState.outputDeviceNamesPopulated = true;
-        if (deviceState.selectedOutputDeviceIndex < 0) {
-            PaDeviceIndex defaultDevice = Pa_GetDefaultOutputDevice();
-            if (defaultDevice != paNoDevice) {
-                for (size_t i = 0; i < outputDevices.size(); ++i) {
-                    if (outputDevices[i].paIndex == defaultDevice) {
-                        deviceState.selectedOutputDeviceIndex = static_cast<int>(i);
-                        break;
-                    }
+    if (deviceState.outputDeviceNamesPopulated &&
+        deviceState.outputDeviceNamesVersion == deviceState.deviceListVersion) {
+        return;
+    }
+
+    deviceState.outputDeviceNames.clear();
+    deviceState.outputDeviceNames.reserve(outputDevices.size());
+    for (const auto& dev : outputDevices) {
+        deviceState.outputDeviceNames.push_back(dev.name.c_str());
+    }
+    deviceState.outputDeviceNamesPopulated = true;
+    deviceState.outputDeviceNamesVersion = deviceState.deviceListVersion;
+    if (deviceState.selectedOutputDeviceIndex < 0 && !outputDevices.empty()) {
+        PaDeviceIndex defaultDevice = AudioStreamConfig::defaultOutputDevice(deviceState.listedHostApi);
+        if (defaultDevice != paNoDevice) {
+            for (size_t i = 0; i < outputDevices.size(); ++i) {
+                if (outputDevices[i].paIndex == defaultDevice) {
+                    deviceState.selectedOutputDeviceIndex = static_cast<int>(i);
+                    break;
                 }
             }
         }
@@ -144,6 +180,9 @@ void DeviceManager::renderDeviceSelection(DeviceState& deviceState,
     } else {
         ImGui::TextDisabled("No audio input devices found.");
     }
+    if (deviceState.audioHardwareChanged) {
+        ImGui::TextDisabled("Audio devices changed. Restart to use newly connected devices.");
+    }
     ImGui::Spacing();
 }
 
@@ -170,6 +209,83 @@ void DeviceManager::renderOutputDeviceSelection(DeviceState& deviceState,
     ImGui::Spacing();
 }
 
+void DeviceManager::renderStreamSettings(DeviceState& deviceState,
+                                        AudioInput& audioInput,
+                                        const std::vector<AudioInput::DeviceInfo>& devices,
+                                        const AudioOutput* audioOutput) {
+    if (!ImGui::CollapsingHeader("Latency")) {
+        return;
+    }
+    ImGui::Indent(10);
+
+    AudioStreamSettings settings = deviceState.streamSettings;
+    ImGui::Text("Host API");
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    if (ImGui::BeginCombo("##hostapi", AudioStreamConfig::hostApiName(settings.hostApi))) {
+        for (const AudioStreamSettings::HostApi hostApi : AudioStreamConfig::allHostApis()) {
+            if (!AudioStreamConfig::isHostApiAvailable(hostApi)) {
+                continue;
+            }
+            const bool selected = hostApi == settings.hostApi;
+            if (ImGui::Selectable(AudioStreamConfig::hostApiName(hostApi), selected)) {
+                settings.hostApi = hostApi;
+            }
+            if (selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    ImGui::Text("Buffer size");
+    int bufferIndex = choiceIndex(kBufferSizeChoices, settings.framesPerBuffer);
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    if (ImGui::Combo("##buffersize", &bufferIndex, kBufferSizeLabels.data(), static_cast<int>(kBufferSizeLabels.size()))) {
+        settings.framesPerBuffer = kBufferSizeChoices[static_cast<size_t>(bufferIndex)];
+    }
+
+    ImGui::Text("Suggested latency");
+    int latencyIndex = choiceIndex(kLatencyChoices, settings.suggestedLatencySeconds);
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    if (ImGui::Combo("##latency", &latencyIndex, kLatencyLabels.data(), static_cast<int>(kLatencyLabels.size()))) {
+        settings.suggestedLatencySeconds = kLatencyChoices[static_cast<size_t>(latencyIndex)];
+    }
+
+    if (settings != deviceState.streamSettings) {
+        const bool hostApiChanged = settings.hostApi != deviceState.streamSettings.hostApi;
+        deviceState.streamSettings = settings;
+        // A new host API reopens nothing until its devices are listed and one is picked.
+        if (!hostApiChanged && deviceState.selectedDeviceIndex >= 0) {
+            selectDevice(deviceState, audioInput, devices, deviceState.selectedDeviceIndex);
+        }
+    }
+
+    ImGui::Spacing();
+    renderStreamLatency("Input", audioInput.getStreamLatency());
+    renderStreamLatency("Output", audioOutput != nullptr ? audioOutput->getStreamLatency() : AudioStreamLatency{});
+    if (audioInput.isStreamActive()) {
+        ImGui::Text("Audio to colour: %.1f ms", audioInput.estimateAnalysisLatencySeconds() * 1000.0);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Input latency, half the analysis window and the analysis time.\n"
+                              "The colour is shown on the next display frame after this.");
+        }
+    }
+
+    ImGui::Unindent(10);
+    ImGui::Spacing();
+}
+
+void DeviceManager::resetDeviceSelection(DeviceState& deviceState, AudioInput& audioInput) {
+    audioInput.pauseStream();
+    deviceState.selectedDeviceIndex = -1;
+    deviceState.selectedChannelIndex = 0;
+    deviceState.streamError = false;
+    deviceState.streamErrorMessage.clear();
+    deviceState.channelNames.clear();
+    deviceState.channelNameStrings.clear();
+    deviceState.selectedOutputDeviceIndex = -1;
+}
+
 void DeviceManager::renderChannelSelection(DeviceState& deviceState,
                                           AudioInput& audioInput,
                                           const std::vector<AudioInput::DeviceInfo>& devices) {
@@ -225,7 +341,8 @@ DeviceSelectionResult DeviceManager::validateAndSelectDevice(DeviceState& device
     deviceState.selectedChannelIndex = 0;
     int channelsToUse = std::min(maxChannels, 16);
 
-    if (!audioInput.initStream(devices[static_cast<size_t>(newDeviceIndex)].paIndex, channelsToUse)) {
+    if (!audioInput.initStream(devices[static_cast<size_t>(newDeviceIndex)].paIndex, channelsToUse,
+                               deviceState.streamSettings)) {
         return {false, "Error opening device!"};
     }
     
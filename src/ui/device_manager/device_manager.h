@@ -3,6 +3,7 @@
 #include "audio_input.h"
 #include "audio_output.h"
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -20,6 +21,19 @@ struct DeviceState {
     int selectedOutputDeviceIndex = -1;
     std::vector<const char*> outputDeviceNames;
     bool outputDeviceNamesPopulated = false;
+
+    // The AudioDeviceRegistry version the lists passed in come from; the names are rebuilt
+    // when it moves on.
+    uint64_t deviceListVersion = 0;
+    uint64_t deviceNamesVersion = 0;
+    uint64_t outputDeviceNamesVersion = 0;
+    bool audioHardwareChanged = false;
+
+    // Applied to the input stream by renderStreamSettings and to playback by the UI update.
+    // The device registry lists streamSettings.hostApi's devices; listedHostApi is the host
+    // API of the lists currently held.
+    AudioStreamSettings streamSettings;
+    AudioStreamSettings::HostApi listedHostApi = AudioStreamSettings::HostApi::Default;
 };
 
 struct DeviceSelectionResult {
@@ -54,6 +68,15 @@ public:
                                            bool outputDeviceActive,
                                            const std::array<float, 2>& outputLevels);
 
+    // Host API, buffer size and latency, with the latency each stream achieved.
+    static void renderStreamSettings(DeviceState& deviceState,
+                                    AudioInput& audioInput,
+                                    const std::vector<AudioInput::DeviceInfo>& devices,
+                                    const AudioOutput* audioOutput);
+
+    // Called when the device lists change host API, whose indices no longer match.
+    static void resetDeviceSelection(DeviceState& deviceState, AudioInput& audioInput);
+
     static void renderChannelSelection(DeviceState& deviceState,
                                       AudioInput& audioInput,
                                       const std::vector<AudioInput::DeviceInfo>& devices);
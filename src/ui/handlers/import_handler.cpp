@@ -6,12 +6,21 @@
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 
 namespace UIHandlers {
 
 void ImportHandler::processFileImport(UIState& state) {
     auto& recorderState = state.resyneState.recorderState;
+	const bool queueWasActive = recorderState.importQueue.progress().active();
+	const auto& queued = recorderState.importQueue.pump();
+	if (queueWasActive && !queued.active()) {
+		recorderState.statusMessage = "Saved " + std::to_string(queued.saved) + " dropped file(s) as .rsyn";
+		if (queued.failed > 0) {
+			recorderState.statusMessage += ", " + std::to_string(queued.failed) + " failed (" + queued.firstError + ")";
+		}
+		recorderState.statusMessageTimer = 4.0f;
+	}
+
 	if (recorderState.importPhase == 1 && !recorderState.pendingImportPath.empty()) {
 		std::filesystem::path fsPath(recorderState.pendingImportPath);
 		std::string filename = fsPath.filename().string();
@@ -27,43 +36,62 @@ void ImportHandler::processFileImport(UIState& state) {
 	} else if (recorderState.importPhase == 2 && !recorderState.pendingImportPath.empty()) {
 		const std::string pathToImport = recorderState.pendingImportPath;
 
-		if (recorderState.importThread.joinable()) {
-			recorderState.importThread.join();
-		}
+		// A newer import supersedes one still running.
+		recorderState.importTask.cancel();
+		recorderState.importTask.wait();
 
-		recorderState.importThread = std::thread(
-			&ReSyne::Recorder::importFromFileThreaded,
-			std::ref(recorderState),
-			pathToImport,
-			recorderState.importColourSpace,
-			recorderState.importGamutMapping);
+		const auto colourSpace = recorderState.importColourSpace;
+		const bool gamutMapping = recorderState.importGamutMapping;
+		recorderState.importTask = Utilities::Threading::TaskScheduler::shared().submit(
+			Utilities::Threading::TaskPriority::Interactive,
+			[&recorderState, pathToImport, colourSpace, gamutMapping](const Utilities::Threading::TaskContext& context) {
+				ReSyne::Recorder::importFromFileThreaded(recorderState, context, pathToImport, colourSpace, gamutMapping);
+			});
 
 		recorderState.importPhase = 3;
 	} else if (recorderState.importPhase == 3) {
-		recorderState.loadingProgress = recorderState.loadingProgressAtomic.load(std::memory_order_acquire);
+		recorderState.loadingProgress = recorderState.importTask.progress();
 
-		if (recorderState.importComplete.load(std::memory_order_acquire)) {
-			if (recorderState.importThread.joinable()) {
-				recorderState.importThread.join();
+		if (recorderState.importTask.isFinished() && recorderState.importTask.isCancelled()) {
+			{
+				std::lock_guard<std::mutex> lock(recorderState.samplesMutex);
+				recorderState.importedSamples.clear();
+				recorderState.previewSamples.clear();
+				recorderState.previewReady.store(false, std::memory_order_release);
+				recorderState.storedPreview.reset();
+				recorderState.timelinePreviewCacheDirty = true;
 			}
-
+			recorderState.statusMessage = "Import cancelled";
+			recorderState.statusMessageTimer = 4.0f;
+			recorderState.showLoadingDialog = false;
+			ReSyne::setLoadingOperationStatus(recorderState, {});
+			recorderState.pendingImportPath.clear();
+			recorderState.importPhase = 0;
+			ImGui::ClearActiveID();
+			recorderState.focusRequested = true;
+		} else if (recorderState.importTask.isFinished()) {
 			bool success = false;
 			bool hasReconstructedAudio = false;
 			std::string errorMessage;
 			std::string filename;
 
+			recorderState.rsynHydration.stop();
 			{
 				std::lock_guard<std::mutex> lock(recorderState.samplesMutex);
 				success = !recorderState.importedSamples.empty() ||
                     recorderState.importedMetadata.presentationData != nullptr;
 				errorMessage = recorderState.importErrorMessage;
+				recorderState.storedPreview.reset();
 
 				if (success) {
 					recorderState.samples = std::move(recorderState.importedSamples);
+					recorderState.spectralJournal.reset();
+					recorderState.journalledFrames = 0;
+					recorderState.residentSpectra.reset();
 					recorderState.metadata = std::move(recorderState.importedMetadata);
 					recorderState.isRecording = false;
 					recorderState.isPlaybackInitialised = false;
-					recorderState.timelinePreviewCache.clear();
+					recorderState.timelinePreviewCache.reset();
 					recorderState.timelinePreviewCacheDirty = true;
 
 					hasReconstructedAudio = !recorderState.playbackAudio.empty();
@@ -113,6 +141,7 @@ void ImportHandler::processFileImport(UIState& state) {
 				if (hasReconstructedAudio) {
 					ReSyne::Recorder::refreshPlaybackOutput(recorderState);
 				}
+				ReSyne::Recorder::requestRsynHydration(recorderState);
 
 				recorderState.statusMessage.clear();
 				recorderState.statusMessageTimer = 0.0f;
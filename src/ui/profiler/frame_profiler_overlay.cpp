@@ -0,0 +1,131 @@
+#include "ui/profiler/frame_profiler_overlay.h"
+
+#include <imgui.h>
+#include <implot.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+
+using Utilities::Profiling::FrameProfiler;
+using Utilities::Profiling::Stage;
+using Utilities::Profiling::STAGE_COUNT;
+
+constexpr double REFRESH_INTERVAL_SECONDS = 0.25;
+
+}
+
+void FrameProfilerOverlay::draw(bool& open, const double time) {
+    FrameProfiler::instance().setEnabled(open);
+    if (!open) {
+        return;
+    }
+
+    if (!paused_ && (lastRefreshTime_ < 0.0 || time - lastRefreshTime_ >= REFRESH_INTERVAL_SECONDS)) {
+        refresh();
+        lastRefreshTime_ = time;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(560.0f, 440.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Frame Profiler", &open)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Checkbox("Pause", &paused_);
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome Trace")) {
+        exportTrace();
+    }
+    if (!exportStatus_.empty()) {
+        ImGui::TextDisabled("%s", exportStatus_.c_str());
+    }
+
+    constexpr ImGuiTableFlags tableFlags =
+        ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("##ProfilerStages", 7, tableFlags)) {
+        ImGui::TableSetupColumn("Stage", ImGuiTableColumnFlags_WidthStretch, 2.0f);
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Mean");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableHeadersRow();
+
+        for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+            const auto& summary = summaries_[stage];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(Utilities::Profiling::stageName(static_cast<Stage>(stage)));
+            ImGui::TableNextColumn();
+            if (summary.count == 0) {
+                ImGui::TextDisabled("-");
+                continue;
+            }
+            ImGui::Text("%llu", static_cast<unsigned long long>(summary.count));
+            for (const float valueMs : {summary.meanMs, summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs}) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", valueMs);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImPlot::BeginPlot("##ProfilerHistory", ImVec2(-1.0f, -1.0f))) {
+        ImPlot::SetupAxes("Recent samples", "ms", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+            const auto& history = historyMs_[stage];
+            if (!history.empty()) {
+                ImPlot::PlotLine(Utilities::Profiling::stageName(static_cast<Stage>(stage)),
+                                 history.data(), static_cast<int>(history.size()));
+            }
+        }
+        ImPlot::EndPlot();
+    }
+
+    ImGui::End();
+}
+
+void FrameProfilerOverlay::refresh() {
+    FrameProfiler::instance().copyRecent(samples_);
+    summaries_ = Utilities::Profiling::summarise(samples_);
+
+    for (auto& history : historyMs_) {
+        history.clear();
+    }
+    // Walks back from the newest sample, so each stage's plot shows its latest samples.
+    for (auto it = samples_.rbegin(); it != samples_.rend(); ++it) {
+        const auto stage = static_cast<size_t>(it->stage);
+        if (stage < STAGE_COUNT && historyMs_[stage].size() < HISTORY_LENGTH) {
+            historyMs_[stage].push_back(static_cast<float>(it->durationNanos) * 1.0e-6f);
+        }
+    }
+    for (auto& history : historyMs_) {
+        std::ranges::reverse(history);
+    }
+}
+
+void FrameProfilerOverlay::exportTrace() {
+    if (samples_.empty()) {
+        exportStatus_ = "Nothing has been recorded yet";
+        return;
+    }
+
+    std::error_code error;
+    const std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    if (error) {
+        exportStatus_ = "Unable to find a temporary directory";
+        return;
+    }
+
+    const std::filesystem::path path = directory / "synesthesia-trace.json";
+    std::string errorMessage;
+    if (FrameProfiler::writeChromeTrace(samples_, path, errorMessage)) {
+        exportStatus_ = "Saved " + path.string();
+    } else {
+        exportStatus_ = errorMessage;
+    }
+}
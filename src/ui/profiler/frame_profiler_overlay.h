@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "utilities/profiling/frame_profiler.h"
+
+// Shows the frame profiler's per-stage timings as a table of percentiles and a plot of each
+// stage's recent samples, and exports the ring as a Chrome trace. The profiler records only
+// while the overlay is open.
+class FrameProfilerOverlay {
+public:
+    void draw(bool& open, double time);
+
+private:
+    void refresh();
+    void exportTrace();
+
+    static constexpr size_t HISTORY_LENGTH = 240;
+
+    std::vector<Utilities::Profiling::TimingSample> samples_;
+    std::array<Utilities::Profiling::StageSummary, Utilities::Profiling::STAGE_COUNT> summaries_{};
+    std::array<std::vector<float>, Utilities::Profiling::STAGE_COUNT> historyMs_;
+    double lastRefreshTime_ = -1.0;
+    bool paused_ = false;
+    std::string exportStatus_;
+};
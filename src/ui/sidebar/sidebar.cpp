@@ -239,6 +239,11 @@ void render(RenderArgs& args) {
         args.recorderState.audioOutput != nullptr
             ? args.recorderState.audioOutput->getStereoLevels()
             : std::array<float, 2>{0.0f, 0.0f});
+    DeviceManager::renderStreamSettings(
+        args.uiState.deviceState,
+        args.audioInput,
+        args.devices,
+        args.recorderState.audioOutput.get());
 
     bool deviceSelected = args.uiState.deviceState.selectedDeviceIndex >= 0;
     bool streamHealthy = !args.uiState.deviceState.streamError;
@@ -265,7 +270,8 @@ void render(RenderArgs& args) {
         renderVisualisationSections(args, hasLiveInput, showEQControls);
     }
 
-    Controls::renderAdvancedSettingsPanel(args.uiState
+    Controls::renderAdvancedSettingsPanel(args.uiState,
+                                          args.recorderState
 #ifdef ENABLE_MIDI
                                          , args.midiInput
                                          , args.midiDevices
@@ -0,0 +1,157 @@
+#include "ui/smoothing/offline_smoothing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "utilities/threading/task_scheduler.h"
+
+namespace UI::Smoothing {
+
+namespace {
+
+// Shorter sequences, or chunks, gain less from the parallel pass than the warm-up costs.
+constexpr std::size_t kMinChunkFrames = 4096;
+// Several time constants of the slowest adaptive spring at kReferenceMass. Time constants
+// grow with the square root of the mass.
+constexpr float kWarmUpSeconds = 8.0f;
+constexpr float kReferenceMass = 0.3f;
+// Far below one 16-bit output step in every Oklab channel.
+constexpr float kBoundaryTolerance = 1.0e-5f;
+
+struct SpringState {
+    std::array<float, 3> position{};
+    std::array<float, 3> velocity{};
+};
+
+struct Chunk {
+    std::size_t first = 0;
+    std::size_t end = 0;
+    SpringState entry;
+    SpringState exit;
+};
+
+// Each chunk past the first pays for its warm-up, so there is one per worker, up to 8.
+std::size_t smoothingChunkLimit() {
+    return std::clamp<std::size_t>(Utilities::Threading::TaskScheduler::shared().workerCount(), 1, 8);
+}
+
+SpringSmootherBank makeSpring(const OfflineSpringSettings& settings) {
+    SpringSmootherBank spring(1, 8.0f, 1.0f, settings.mass);
+    spring.setSmoothingAmount(settings.smoothingAmount);
+    return spring;
+}
+
+void restAt(SpringSmootherBank& spring, const SpringStep& step) {
+    spring.resetOklab(0, step.targetOklab[0], step.targetOklab[1], step.targetOklab[2]);
+}
+
+// Steps frames [first, end), writing their colours when output is not empty.
+void stepFrames(SpringSmootherBank& spring,
+                std::span<const SpringStep> steps,
+                const std::size_t first,
+                const std::size_t end,
+                const bool adaptive,
+                std::span<std::array<float, 3>> output) {
+    for (std::size_t index = first; index < end; ++index) {
+        const SpringStep& step = steps[index];
+        spring.setTargetOklab(0, step.targetOklab[0], step.targetOklab[1], step.targetOklab[2]);
+        if (adaptive) {
+            spring.setSignalFeatures(0, step.features);
+        }
+        spring.update(step.deltaTime);
+        if (!output.empty()) {
+            std::array<float, 3>& colour = output[index];
+            spring.getCurrentOklab(0, colour[0], colour[1], colour[2]);
+        }
+    }
+}
+
+SpringState stateOf(const SpringSmootherBank& spring) {
+    SpringState state;
+    spring.getState(0, state.position, state.velocity);
+    return state;
+}
+
+bool statesAgree(const SpringState& a, const SpringState& b) {
+    for (std::size_t channel = 0; channel < 3; ++channel) {
+        if (!(std::abs(a.position[channel] - b.position[channel]) <= kBoundaryTolerance) ||
+            !(std::abs(a.velocity[channel] - b.velocity[channel]) <= kBoundaryTolerance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The frame a chunk starting at first rests on so that the warm-up's spring time passes
+// before first.
+std::size_t warmUpStart(std::span<const SpringStep> steps, const std::size_t first, const float mass) {
+    const float warmUpSeconds = kWarmUpSeconds * std::sqrt(std::max(mass / kReferenceMass, 1.0f));
+    std::size_t start = first - 1;
+    float elapsed = 0.0f;
+    while (start > 0 && elapsed < warmUpSeconds) {
+        elapsed += steps[start].deltaTime;
+        --start;
+    }
+    return start;
+}
+
+void runChunk(std::span<const SpringStep> steps,
+              const OfflineSpringSettings& settings,
+              Chunk& chunk,
+              std::span<std::array<float, 3>> smoothedOklab) {
+    SpringSmootherBank spring = makeSpring(settings);
+    std::size_t first = chunk.first;
+    if (first == 0) {
+        restAt(spring, steps[0]);
+        smoothedOklab[0] = steps[0].targetOklab;
+        first = 1;
+    } else {
+        const std::size_t start = warmUpStart(steps, first, settings.mass);
+        restAt(spring, steps[start]);
+        stepFrames(spring, steps, start + 1, first, settings.adaptive, {});
+    }
+    chunk.entry = stateOf(spring);
+    stepFrames(spring, steps, first, chunk.end, settings.adaptive, smoothedOklab);
+    chunk.exit = stateOf(spring);
+}
+
+}
+
+void smoothSequence(std::span<const SpringStep> steps,
+                    const OfflineSpringSettings& settings,
+                    std::span<std::array<float, 3>> smoothedOklab) {
+    const std::size_t frameCount = std::min(steps.size(), smoothedOklab.size());
+    if (frameCount == 0) {
+        return;
+    }
+    steps = steps.first(frameCount);
+
+    const std::size_t chunkCount = std::max<std::size_t>(1, std::min(smoothingChunkLimit(), frameCount / kMinChunkFrames));
+    std::vector<Chunk> chunks(chunkCount);
+    for (std::size_t index = 0; index < chunkCount; ++index) {
+        chunks[index].first = frameCount * index / chunkCount;
+        chunks[index].end = frameCount * (index + 1) / chunkCount;
+    }
+
+    Utilities::Threading::TaskScheduler::shared().parallelFor(chunkCount, 1, [&](const std::size_t first, const std::size_t end) {
+        for (std::size_t index = first; index < end; ++index) {
+            runChunk(steps, settings, chunks[index], smoothedOklab);
+        }
+    });
+
+    for (std::size_t index = 1; index < chunkCount; ++index) {
+        Chunk& chunk = chunks[index];
+        const SpringState& previousExit = chunks[index - 1].exit;
+        if (statesAgree(chunk.entry, previousExit)) {
+            continue;
+        }
+        SpringSmootherBank spring = makeSpring(settings);
+        spring.setState(0, previousExit.position, previousExit.velocity);
+        stepFrames(spring, steps, chunk.first, chunk.end, settings.adaptive, smoothedOklab);
+        chunk.exit = stateOf(spring);
+    }
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <span>
+
+#include "ui/smoothing/smoothing.h"
+
+namespace UI::Smoothing {
+
+// One frame of a sequence smoothed offline. deltaTime is the spring time since the previous
+// frame and is ignored for the first, which starts at rest on its target.
+struct SpringStep {
+    std::array<float, 3> targetOklab{};
+    float deltaTime = 0.0f;
+    SmoothingSignalFeatures features{};
+};
+
+struct OfflineSpringSettings {
+    float smoothingAmount = 0.5f;
+    float mass = 0.3f;
+    // Adapts the spring to each step's features, as SpringSmoother::update with features.
+    bool adaptive = true;
+};
+
+// Runs the same spring as a frame-by-frame SpringSmoother loop, writing one smoothed Oklab
+// colour per step. Long sequences are cut into chunks that run in parallel, each warmed up
+// from rest over the spring time before it. The damped spring forgets where it started, so
+// a warmed-up chunk normally enters in the state the chunk before it left in. A chunk whose
+// entry state deviates from that is replayed from it afterwards, in order, so the result
+// stays within a small tolerance of the sequential one.
+void smoothSequence(std::span<const SpringStep> steps,
+                    const OfflineSpringSettings& settings,
+                    std::span<std::array<float, 3>> smoothedOklab);
+
+}
@@ -62,6 +62,73 @@ float applyAdaptiveStiffness(const float baseStiffness,
     return std::clamp(adaptiveStiffness, kMinStiffness * 0.5f, kMaxStiffness * 2.5f);
 }
 
+float adaptiveDampingRatio(const SmoothingSignalFeatures& features) {
+    const float loudness = std::clamp(features.loudnessNormalised, 0.0f, 1.0f);
+    constexpr float BASE_DAMPING_RATIO = 0.65f;
+    constexpr float DAMPING_RANGE = 0.25f;
+    // Spectral rolloff → damping: bright timbre (high rolloff) = more responsive colour;
+    // warm timbre (low rolloff) = more sluggish, smoother transitions
+    constexpr float ROLLOFF_DAMPING_RANGE = 0.15f;
+    const float rolloffDampingOffset = (0.5f - features.spectralRolloffNorm) * ROLLOFF_DAMPING_RANGE;
+    const float phaseDampingOffset =
+        features.phaseInstabilityNorm * 0.12f -
+        features.phaseCoherenceNorm * 0.05f -
+        features.phaseTransientNorm * 0.04f;
+    return std::clamp(
+        BASE_DAMPING_RATIO + (1.0f - loudness) * DAMPING_RANGE + rolloffDampingOffset + phaseDampingOffset,
+        0.45f, 0.95f);
+}
+
+struct SpringTransition {
+    float positionFromOffset = 0.0f;
+    float positionFromVelocity = 0.0f;
+    float velocityFromOffset = 0.0f;
+    float velocityFromVelocity = 0.0f;
+};
+
+// Exact solution of m x'' + c x' + k x = 0 over dt, as a linear map of the offset from the
+// target and the velocity. Writing the motion as exp(-alpha t) times an oscillating,
+// linear or hyperbolic term covers the under-, critically and over-damped cases.
+SpringTransition springTransition(const float stiffness, const float damping, const float mass,
+                                  const float dt) {
+    if (!(dt > 0.0f)) {
+        return {1.0f, 0.0f, 0.0f, 1.0f};
+    }
+    if (!(stiffness > 0.0f) || !(mass > 0.0f)) {
+        // No usable spring: land on the target.
+        return {};
+    }
+
+    const float omegaSquared = stiffness / mass;
+    const float alpha = std::max(damping, 0.0f) / (2.0f * mass);
+    const float discriminant = omegaSquared - alpha * alpha;
+
+    // "even" is the cos/cosh term and "odd" the sin/sinh term over its frequency, both
+    // already scaled by the decay.
+    float even = 0.0f;
+    float odd = 0.0f;
+    constexpr float CRITICAL_TOLERANCE = 1.0e-6f;
+    if (std::abs(discriminant) * dt * dt < CRITICAL_TOLERANCE) {
+        const float decay = std::exp(-alpha * dt);
+        even = decay;
+        odd = decay * dt;
+    } else if (discriminant > 0.0f) {
+        const float frequency = std::sqrt(discriminant);
+        const float decay = std::exp(-alpha * dt);
+        even = decay * std::cos(frequency * dt);
+        odd = decay * std::sin(frequency * dt) / frequency;
+    } else {
+        // exp(-alpha t) cosh(beta t) as two decaying exponentials, so it cannot overflow.
+        const float beta = std::sqrt(-discriminant);
+        const float slow = std::exp((beta - alpha) * dt);
+        const float fast = std::exp((-beta - alpha) * dt);
+        even = 0.5f * (slow + fast);
+        odd = 0.5f * (slow - fast) / beta;
+    }
+
+    return {even + alpha * odd, odd, -omegaSquared * odd, even - alpha * odd};
+}
+
 }
 
 float resolveAdaptiveSmoothingAmount(const float baseSmoothingAmount,
@@ -71,17 +138,148 @@ float resolveAdaptiveSmoothingAmount(const float baseSmoothingAmount,
     return baseStiffnessToSmoothingAmount(adaptiveStiffness);
 }
 
-SpringSmoother::SpringSmoother(const float stiffness, const float damping, const float mass)
-	: m_stiffness(stiffness), m_baseStiffness(stiffness), m_damping(damping), m_mass(mass), m_rgbCacheDirty(true) {
-    initialiseToDefaults();
+SpringSmootherBank::SpringSmootherBank(const std::size_t count, const float stiffness, const float damping,
+                                       const float mass)
+    : m_baseStiffness(stiffness), m_baseDamping(damping), m_mass(mass) {
+    resize(count);
+}
+
+void SpringSmootherBank::resize(const std::size_t count) {
+    constexpr std::array<float, CHANNELS> defaultOklab{50.0f, 0.0f, 0.0f};
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+        m_position[channel].resize(count, defaultOklab[channel]);
+        m_velocity[channel].resize(count, 0.0f);
+        m_target[channel].resize(count, defaultOklab[channel]);
+    }
+    m_stiffness.resize(count, m_baseStiffness);
+    m_damping.resize(count, m_baseDamping);
+    m_positionFromOffset.resize(count);
+    m_positionFromVelocity.resize(count);
+    m_velocityFromOffset.resize(count);
+    m_velocityFromVelocity.resize(count);
+    m_springChanged.resize(count, 1);
+    m_moved.resize(count, 0);
+}
+
+void SpringSmootherBank::resetOklab(const std::size_t index, const float L, const float a, const float b) {
+    const std::array<float, CHANNELS> values{L, a, b};
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+        m_position[channel][index] = values[channel];
+        m_velocity[channel][index] = 0.0f;
+        m_target[channel][index] = values[channel];
+    }
+}
+
+void SpringSmootherBank::setTargetOklab(const std::size_t index, const float L, const float a, const float b) {
+    m_target[0][index] = L;
+    m_target[1][index] = a;
+    m_target[2][index] = b;
+}
+
+void SpringSmootherBank::getCurrentOklab(const std::size_t index, float& L, float& a, float& b) const {
+    L = m_position[0][index];
+    a = m_position[1][index];
+    b = m_position[2][index];
+}
+
+void SpringSmootherBank::getState(const std::size_t index,
+                                  std::array<float, 3>& position,
+                                  std::array<float, 3>& velocity) const {
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+        position[channel] = m_position[channel][index];
+        velocity[channel] = m_velocity[channel][index];
+    }
+}
+
+void SpringSmootherBank::setState(const std::size_t index,
+                                  const std::array<float, 3>& position,
+                                  const std::array<float, 3>& velocity) {
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+        m_position[channel][index] = position[channel];
+        m_velocity[channel][index] = velocity[channel];
+    }
+}
+
+void SpringSmootherBank::setSmoothingAmount(const float smoothingAmount) {
+    m_baseStiffness = smoothingAmountToBaseStiffness(smoothingAmount);
+    m_baseDamping = 2.0f * std::sqrt(m_baseStiffness * m_mass) * 0.5f;
+    std::fill(m_stiffness.begin(), m_stiffness.end(), m_baseStiffness);
+    std::fill(m_damping.begin(), m_damping.end(), m_baseDamping);
+    std::fill(m_springChanged.begin(), m_springChanged.end(), 1);
+}
+
+float SpringSmootherBank::getSmoothingAmount() const {
+    return baseStiffnessToSmoothingAmount(m_baseStiffness);
+}
+
+// Stowell & Plumbley (2007) - adaptive whitening for improved onset detection
+// Adaptive smoothing with perceptual cues
+void SpringSmootherBank::setSignalFeatures(const std::size_t index, const SmoothingSignalFeatures& features) {
+    const float stiffness = applyAdaptiveStiffness(m_baseStiffness, features);
+    const float damping = 2.0f * std::sqrt(stiffness * m_mass) * adaptiveDampingRatio(features);
+    if (stiffness != m_stiffness[index] || damping != m_damping[index]) {
+        m_stiffness[index] = stiffness;
+        m_damping[index] = damping;
+        m_springChanged[index] = 1;
+    }
+}
+
+void SpringSmootherBank::refreshTransitions(const float deltaTime) {
+    const bool deltaChanged = deltaTime != m_transitionDelta;
+    m_transitionDelta = deltaTime;
+    for (std::size_t i = 0; i < size(); ++i) {
+        if (!deltaChanged && m_springChanged[i] == 0) {
+            continue;
+        }
+        const SpringTransition transition = springTransition(m_stiffness[i], m_damping[i], m_mass, deltaTime);
+        m_positionFromOffset[i] = transition.positionFromOffset;
+        m_positionFromVelocity[i] = transition.positionFromVelocity;
+        m_velocityFromOffset[i] = transition.velocityFromOffset;
+        m_velocityFromVelocity[i] = transition.velocityFromVelocity;
+        m_springChanged[i] = 0;
+    }
 }
 
-void SpringSmoother::initialiseToDefaults() {
-    m_channels[0] = {50.0f, 0.0f, 50.0f};
-    m_channels[1] = {0.0f, 0.0f, 0.0f};
-    m_channels[2] = {0.0f, 0.0f, 0.0f};
+std::size_t SpringSmootherBank::update(const float deltaTime) {
+    constexpr float MIN_DELTA = 0.0001f;
+    constexpr std::array<float, CHANNELS> lowerBound{0.0f, -100.0f, -100.0f};
+    constexpr std::array<float, CHANNELS> upperBound{100.0f, 100.0f, 100.0f};
+
+    refreshTransitions(deltaTime);
+    std::fill(m_moved.begin(), m_moved.end(), 0);
+
+    const std::size_t count = size();
+    const float* positionFromOffset = m_positionFromOffset.data();
+    const float* positionFromVelocity = m_positionFromVelocity.data();
+    const float* velocityFromOffset = m_velocityFromOffset.data();
+    const float* velocityFromVelocity = m_velocityFromVelocity.data();
+    std::uint8_t* moved = m_moved.data();
+
+    // Branch-free over contiguous arrays, so each channel's loop vectorises across streams.
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+        float* position = m_position[channel].data();
+        float* velocity = m_velocity[channel].data();
+        const float* target = m_target[channel].data();
+        const float lower = lowerBound[channel];
+        const float upper = upperBound[channel];
+        for (std::size_t i = 0; i < count; ++i) {
+            const float offset = position[i] - target[i];
+            const float nextPosition = std::clamp(
+                target[i] + positionFromOffset[i] * offset + positionFromVelocity[i] * velocity[i], lower, upper);
+            const float nextVelocity = velocityFromOffset[i] * offset + velocityFromVelocity[i] * velocity[i];
+            const bool significant = std::abs(nextPosition - position[i]) > MIN_DELTA ||
+                                     std::abs(nextVelocity - velocity[i]) > MIN_DELTA;
+            moved[i] |= static_cast<std::uint8_t>(significant);
+            position[i] = nextPosition;
+            velocity[i] = nextVelocity;
+        }
+    }
+
+    return static_cast<std::size_t>(std::count(m_moved.begin(), m_moved.end(), std::uint8_t{1}));
+}
 
-    m_currentRGB[0] = m_currentRGB[1] = m_currentRGB[2] = 0.5f;
+SpringSmoother::SpringSmoother(const float stiffness, const float damping, const float mass)
+    : m_spring(1, stiffness, damping, mass), m_currentRGB{0.5f, 0.5f, 0.5f}, m_rgbCacheDirty(true) {
 }
 
 void SpringSmoother::reset(const float r, const float g, const float b) {
@@ -98,9 +296,7 @@ void SpringSmoother::reset(const float r, const float g, const float b) {
 }
 
 void SpringSmoother::resetOklab(const float L, const float a, const float b_comp) {
-    m_channels[0] = {L, 0.0f, L};
-    m_channels[1] = {a, 0.0f, a};
-    m_channels[2] = {b_comp, 0.0f, b_comp};
+    m_spring.resetOklab(0, L, a, b_comp);
 
     float r = 0.0f;
     float g = 0.0f;
@@ -128,57 +324,26 @@ void SpringSmoother::setTargetColour(const float r, const float g, const float b
 }
 
 void SpringSmoother::setTargetOklab(const float L, const float a, const float b_comp) {
-    m_channels[0].targetPosition = L;
-    m_channels[1].targetPosition = a;
-    m_channels[2].targetPosition = b_comp;
+    m_spring.setTargetOklab(0, L, a, b_comp);
 }
 
-bool SpringSmoother::update(float deltaTime) {
-    deltaTime = std::min(deltaTime, MAX_DELTA_TIME);
-    bool significantMovement = false;
-
-    for (int i = 0; i < 3; ++i) {
-        SpringState& channel = m_channels[i];
-        
-        const float displacement = channel.position - channel.targetPosition;
-        const float springForce = -m_stiffness * displacement;
-        const float dampingForce = -m_damping * channel.velocity;
-        const float acceleration = (springForce + dampingForce) / m_mass;
-
-        const float prevVelocity = channel.velocity;
-        const float prevPosition = channel.position;
-
-        channel.velocity += acceleration * deltaTime;
-        channel.position += channel.velocity * deltaTime;
-
-        if (i == 0) {
-            channel.position = std::clamp(channel.position, LAB_L_MIN, LAB_L_MAX);
-        } else {
-            channel.position = std::clamp(channel.position, LAB_AB_MIN, LAB_AB_MAX);
-        }
-
-        const float positionDelta = std::abs(channel.position - prevPosition);
-        const float velocityDelta = std::abs(channel.velocity - prevVelocity);
-
-        if (positionDelta > MIN_DELTA || velocityDelta > MIN_DELTA) {
-            significantMovement = true;
-        }
-    }
-
+bool SpringSmoother::update(const float deltaTime) {
+    const bool significantMovement = m_spring.update(deltaTime) > 0;
     if (significantMovement) {
         m_rgbCacheDirty = true;
     }
-
     return significantMovement;
 }
 
 void SpringSmoother::updateRGBCache() const {
+    float L, a, b_comp;
+    m_spring.getCurrentOklab(0, L, a, b_comp);
+
     float r, g, b;
     float X = 0.0f;
     float Y = 0.0f;
     float Z = 0.0f;
-    ColourCore::OklabtoXYZ(m_channels[0].position, m_channels[1].position,
-                           m_channels[2].position, X, Y, Z);
+    ColourCore::OklabtoXYZ(L, a, b_comp, X, Y, Z);
     ColourCore::XYZtoRGB(X, Y, Z, r, g, b, ColourCore::ColourSpace::Rec2020, true, true);
 
     m_currentRGB[0] = std::clamp(r, 0.0f, 1.0f);
@@ -198,45 +363,19 @@ void SpringSmoother::getCurrentColour(float& r, float& g, float& b) const {
 }
 
 void SpringSmoother::getCurrentOklab(float& L, float& a, float& b) const {
-    L = m_channels[0].position;
-    a = m_channels[1].position;
-    b = m_channels[2].position;
+    m_spring.getCurrentOklab(0, L, a, b);
 }
 
-void SpringSmoother::setSmoothingAmount(float smoothingAmount) {
-    smoothingAmount = std::clamp(smoothingAmount, 0.0f, 1.0f);
-
-    m_baseStiffness = smoothingAmountToBaseStiffness(smoothingAmount);
-    m_stiffness = m_baseStiffness;
-    m_damping = 2.0f * std::sqrt(m_stiffness * m_mass) * 0.5f;
+void SpringSmoother::setSmoothingAmount(const float smoothingAmount) {
+    m_spring.setSmoothingAmount(smoothingAmount);
 }
 
 float SpringSmoother::getSmoothingAmount() const {
-    return baseStiffnessToSmoothingAmount(m_baseStiffness);
+    return m_spring.getSmoothingAmount();
 }
 
-// Stowell & Plumbley (2007) - adaptive whitening for improved onset detection
-// Adaptive smoothing with perceptual cues
 bool SpringSmoother::update(const float deltaTime, const SmoothingSignalFeatures& features) {
-    const float adaptiveStiffness = applyAdaptiveStiffness(m_baseStiffness, features);
-    const float loudness = std::clamp(features.loudnessNormalised, 0.0f, 1.0f);
-
-    m_stiffness = adaptiveStiffness;
-    constexpr float BASE_DAMPING_RATIO = 0.65f;
-    constexpr float DAMPING_RANGE = 0.25f;
-    // Spectral rolloff → damping: bright timbre (high rolloff) = more responsive colour;
-    // warm timbre (low rolloff) = more sluggish, smoother transitions
-    constexpr float ROLLOFF_DAMPING_RANGE = 0.15f;
-    const float rolloffDampingOffset = (0.5f - features.spectralRolloffNorm) * ROLLOFF_DAMPING_RANGE;
-    const float phaseDampingOffset =
-        features.phaseInstabilityNorm * 0.12f -
-        features.phaseCoherenceNorm * 0.05f -
-        features.phaseTransientNorm * 0.04f;
-    const float dampingRatio = std::clamp(
-        BASE_DAMPING_RATIO + (1.0f - loudness) * DAMPING_RANGE + rolloffDampingOffset + phaseDampingOffset,
-        0.45f, 0.95f);
-    m_damping = 2.0f * std::sqrt(m_stiffness * m_mass) * dampingRatio;
-
+    m_spring.setSignalFeatures(0, features);
     return update(deltaTime);
 }
 
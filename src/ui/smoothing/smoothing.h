@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 struct SmoothingSignalFeatures {
     bool onsetDetected = false;
     float spectralFlux = 0.0f;
@@ -17,6 +22,63 @@ struct SmoothingSignalFeatures {
 float resolveAdaptiveSmoothingAmount(float baseSmoothingAmount,
                                      const SmoothingSignalFeatures& features);
 
+// Any number of independent Oklab springs stepped together, one array per quantity and
+// channel. Each step is the exact solution of the damped spring towards a target held for
+// deltaTime, so long steps neither overshoot nor need substepping; the per-stream decay
+// and oscillation terms are only recomputed when a spring or the step length changes.
+class SpringSmootherBank {
+public:
+    explicit SpringSmootherBank(std::size_t count = 0, float stiffness = 8.0f, float damping = 1.0f,
+                                float mass = 0.3f);
+
+    // New streams start at the default colour with the bank's current spring.
+    void resize(std::size_t count);
+    [[nodiscard]] std::size_t size() const { return m_stiffness.size(); }
+
+    void resetOklab(std::size_t index, float L, float a, float b);
+    void setTargetOklab(std::size_t index, float L, float a, float b);
+    void getCurrentOklab(std::size_t index, float& L, float& a, float& b) const;
+
+    // Applies to every stream, discarding any adaptive spring.
+    void setSmoothingAmount(float smoothingAmount);
+    [[nodiscard]] float getSmoothingAmount() const;
+
+    // Adapts one stream's stiffness and damping to the signal until the next call.
+    void setSignalFeatures(std::size_t index, const SmoothingSignalFeatures& features);
+
+    // Position and velocity of one stream, to continue its motion in another bank.
+    void getState(std::size_t index, std::array<float, 3>& position, std::array<float, 3>& velocity) const;
+    void setState(std::size_t index, const std::array<float, 3>& position, const std::array<float, 3>& velocity);
+
+    // Returns how many streams moved noticeably.
+    std::size_t update(float deltaTime);
+    [[nodiscard]] bool moved(std::size_t index) const { return m_moved[index] != 0; }
+
+private:
+    static constexpr std::size_t CHANNELS = 3;
+
+    void refreshTransitions(float deltaTime);
+
+    std::array<std::vector<float>, CHANNELS> m_position;
+    std::array<std::vector<float>, CHANNELS> m_velocity;
+    std::array<std::vector<float>, CHANNELS> m_target;
+    std::vector<float> m_stiffness;
+    std::vector<float> m_damping;
+
+    // Maps each stream's (offset from target, velocity) over one step of m_transitionDelta.
+    std::vector<float> m_positionFromOffset;
+    std::vector<float> m_positionFromVelocity;
+    std::vector<float> m_velocityFromOffset;
+    std::vector<float> m_velocityFromVelocity;
+    std::vector<std::uint8_t> m_springChanged;
+    std::vector<std::uint8_t> m_moved;
+    float m_transitionDelta = 0.0f;
+
+    float m_baseStiffness;
+    float m_baseDamping;
+    float m_mass;
+};
+
 class SpringSmoother {
 public:
     explicit SpringSmoother(float stiffness = 8.0f, float damping = 1.0f, float mass = 0.3f);
@@ -34,30 +96,10 @@ public:
     [[nodiscard]] float getSmoothingAmount() const;
 
 private:
-    struct SpringState {
-        float position = 0.0f;
-        float velocity = 0.0f; 
-        float targetPosition = 0.0f;
-    };
-
-    static constexpr float MIN_DELTA = 0.0001f;
-    static constexpr float MAX_DELTA_TIME = 0.05f;
-    static constexpr float MIN_STIFFNESS = 8.0f;
-    static constexpr float MAX_STIFFNESS = 120.0f;
-    static constexpr float LAB_L_MIN = 0.0f;
-    static constexpr float LAB_L_MAX = 100.0f;
-    static constexpr float LAB_AB_MIN = -100.0f;
-    static constexpr float LAB_AB_MAX = 100.0f;
-
-    SpringState m_channels[3];
-    float m_stiffness;
-    float m_baseStiffness;
-    float m_damping;
-    float m_mass;
+    SpringSmootherBank m_spring;
 
     mutable float m_currentRGB[3];
     mutable bool m_rgbCacheDirty;
 
     void updateRGBCache() const;
-    void initialiseToDefaults();
 };
@@ -1,5 +1,6 @@
 #include "spectrum_analyser.h"
 #include "fft_processor.h"
+#include "renderer/presentation_resources.h"
 #include <algorithm>
 #include <cmath>
 #include <numeric>
@@ -18,7 +19,8 @@ void SpectrumAnalyser::drawSpectrumWindow(
     float sampleRate,
     float sidebarWidth,
     bool sidebarOnLeft,
-    float bottomPanelHeight
+    float bottomPanelHeight,
+    Renderer::PresentationResources* presentationResources
 ) {
     float spectrumX = sidebarOnLeft ? sidebarWidth : 0.0f;
     auto spectrumPos = ImVec2(spectrumX, displaySize.y - SPECTRUM_HEIGHT - bottomPanelHeight);
@@ -58,6 +60,29 @@ void SpectrumAnalyser::drawSpectrumWindow(
          applyDynamicRangeCompensation(smoothingBuffer2[ch]);
     }
 
+    constexpr float plotYMax = SPECTRUM_INTENSITY_CLAMP + 0.05f;
+    ImVec4 fillColour = SPECTRUM_COLOUR;
+    fillColour.w = 0.1f;
+
+    // The points are log-spaced in frequency, so they sit evenly across the plot and the
+    // bgfx pass can draw them straight into the window without ImPlot's tessellation.
+    if (presentationResources != nullptr && presentationResources->supportsSpectrumPass()) {
+        const ImVec2 plotMin = ImGui::GetWindowPos();
+        const ImVec2 plotMax = ImVec2(plotMin.x + ImGui::GetWindowWidth(), plotMin.y + ImGui::GetWindowHeight());
+        bool queued = numChannels > 0;
+        for (size_t ch = 0; ch < numChannels && queued; ++ch) {
+            queued = presentationResources->queueSpectrum(
+                ImGui::GetWindowDrawList(), plotMin, plotMax, smoothingBuffer2[ch], plotYMax,
+                ImGui::ColorConvertFloat4ToU32(SPECTRUM_COLOUR), ImGui::ColorConvertFloat4ToU32(fillColour), 1.5f);
+        }
+        if (queued) {
+            ImGui::End();
+            ImGui::PopStyleColor();
+            ImGui::PopStyleVar();
+            return;
+        }
+    }
+
     ImPlot::PushStyleVar(ImPlotStyleVar_PlotPadding, ImVec2(0, 0));
     ImPlot::PushStyleVar(ImPlotStyleVar_FitPadding, ImVec2(0, 0));
     ImPlot::PushStyleColor(ImPlotCol_PlotBg, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
@@ -82,13 +107,9 @@ void SpectrumAnalyser::drawSpectrumWindow(
         ImPlot::SetupAxisLimits(ImAxis_X1, static_cast<double>(FFTProcessor::MIN_FREQ), static_cast<double>(FFTProcessor::MAX_FREQ));
         ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
 
-        constexpr float plotYMax = SPECTRUM_INTENSITY_CLAMP + 0.05f;
         ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, static_cast<double>(plotYMax));
         
         for (size_t ch = 0; ch < numChannels; ++ch) {
-            ImVec4 fillColour = SPECTRUM_COLOUR;
-            fillColour.w = 0.1f;
-
             ImPlot::SetNextFillStyle(fillColour);
             ImPlot::PlotShaded(("##Fill" + std::to_string(ch)).c_str(), smoothingBuffer1[ch].data(), smoothingBuffer2[ch].data(), LINE_COUNT, 0.0);
 
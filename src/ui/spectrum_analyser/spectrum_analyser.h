@@ -4,6 +4,10 @@
 #include <implot.h>
 #include <vector>
 
+namespace Renderer {
+class PresentationResources;
+}
+
 class SpectrumAnalyser {
 public:
     SpectrumAnalyser() = default;
@@ -14,7 +18,8 @@ public:
         float sampleRate,
         float sidebarWidth,
         bool sidebarOnLeft = false,
-        float bottomPanelHeight = 0.0f
+        float bottomPanelHeight = 0.0f,
+        Renderer::PresentationResources* presentationResources = nullptr
     );
 
     void resetTemporalBuffers();
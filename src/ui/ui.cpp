@@ -53,6 +53,11 @@ void initialiseApp(UIState& state) {
 
 namespace {
 
+SpringSmoother colourSmoother(8.0f, 1.0f, 0.3f);
+float currentDisplayR = 0.0f;
+float currentDisplayG = 0.0f;
+float currentDisplayB = 0.0f;
+
 bool dropEventsContainSupportedImport(const std::vector<FileDropManager::FileDropEvent>& events) {
 	for (const auto& event : events) {
 		bool anySupported = std::any_of(
@@ -108,15 +113,30 @@ void handleFileDropEvents(const std::vector<FileDropManager::FileDropEvent>& dro
 			              dropY >= recorderState.timeline.gradientRegionMin.y &&
 			              dropY <= recorderState.timeline.gradientRegionMax.y;
 			if (inside) {
+				// The first file opens on the timeline; the audio files after it are saved to
+				// .rsyn in the background rather than replacing it in turn.
+				size_t queued = 0;
 				for (const auto& path : event.paths) {
 					if (!ReSyne::Recorder::isSupportedImportFile(path)) {
 						continue;
 					}
 					attempted = true;
-					recorderState.pendingImportPath = path;
-					recorderState.importPhase = 1;
-					accepted = true;
-					break;
+					if (!accepted) {
+						recorderState.pendingImportPath = path;
+						recorderState.importPhase = 1;
+						accepted = true;
+					} else if (ReSyne::ImportQueue::accepts(path)) {
+						recorderState.importQueue.enqueue(
+							path, {recorderState.importColourSpace, recorderState.importGamutMapping,
+								   ReSyne::rsynExportOptions(recorderState),
+								   recorderState.importDecimateHighRates});
+						++queued;
+					}
+				}
+				if (queued > 0) {
+					recorderState.statusMessage = "Saving " + std::to_string(queued) +
+						" more dropped file(s) to .rsyn in the background";
+					recorderState.statusMessageTimer = 4.0f;
 				}
 			}
 		}
@@ -130,6 +150,71 @@ void handleFileDropEvents(const std::vector<FileDropManager::FileDropEvent>& dro
 
 }
 
+void updatePresentation(AudioInput& audioInput, float* clear_colour, const float deltaTime, UIState& state) {
+	auto& recorderState = state.resyneState.recorderState;
+	colourSmoother.setSmoothingAmount(state.visualSettings.colourSmoothingSpeed);
+	state.audioSettings.spectrumSmoothingFactor = state.visualSettings.colourSmoothingSpeed;
+	UI::AudioVisualisation::syncRecorderPresentationSettings(state);
+
+	const bool hasPlaybackSession = UI::AudioVisualisation::hasPlaybackSession(recorderState);
+
+	UI::AudioVisualisation::ColourUpdateContext colourCtx{
+		deltaTime,
+		state.visualSettings.smoothingEnabled,
+		state.visualSettings.manualSmoothing,
+		colourSmoother,
+		clear_colour,
+		state.visualSettings.activeView
+	};
+
+	if (hasPlaybackSession) {
+		UI::AudioVisualisation::processPlaybackState(
+			audioInput,
+			state,
+			recorderState,
+			currentDisplayR,
+			currentDisplayG,
+			currentDisplayB,
+			colourCtx);
+	}
+
+	const bool hasMicInput = state.deviceState.selectedDeviceIndex >= 0;
+
+	if (!hasPlaybackSession && hasMicInput) {
+		UI::AudioVisualisation::processLiveAudioState(
+			audioInput,
+			state,
+			recorderState,
+			currentDisplayR,
+			currentDisplayG,
+			currentDisplayB,
+			colourCtx);
+	}
+
+	if (hasPlaybackSession || !hasMicInput) {
+		// Playback sends its own OSC frames, and without an input there is nothing to present.
+		state.livePresentation.stop();
+	}
+
+	if (!hasPlaybackSession && !hasMicInput) {
+		processIdleState(clear_colour, deltaTime);
+		currentDisplayR = clear_colour[0];
+		currentDisplayG = clear_colour[1];
+		currentDisplayB = clear_colour[2];
+        ColourPresentation::applyOutputPrecision(
+            currentDisplayR,
+            currentDisplayG,
+            currentDisplayB);
+        clear_colour[0] = currentDisplayR;
+        clear_colour[1] = currentDisplayG;
+        clear_colour[2] = currentDisplayB;
+	}
+
+    state.resyneState.displayColour[0] = currentDisplayR;
+    state.resyneState.displayColour[1] = currentDisplayG;
+    state.resyneState.displayColour[2] = currentDisplayB;
+}
+
 void updateUI(AudioInput& audioInput, const std::vector<AudioInput::DeviceInfo>& devices,
 			  const std::vector<AudioOutput::DeviceInfo>& outputDevices,
 			  float* clear_colour, ImGuiIO& io, UIState& state
@@ -244,7 +329,7 @@ void updateUI(AudioInput& audioInput, const std::vector<AudioInput::DeviceInfo>&
         audioInput.isStreamActive()) {
         activeInputPaIndex = devices[static_cast<size_t>(state.deviceState.selectedDeviceIndex)].paIndex;
     }
-    state.inputLevelMonitor.syncDevices(devices, activeInputPaIndex);
+    state.inputLevelMonitor.syncDevices(devices, state.deviceState.deviceListVersion, activeInputPaIndex);
     DeviceManager::populateOutputDeviceNames(state.deviceState, outputDevices);
 
     const int previousOutputDeviceIndex = recorderState.outputDeviceIndex;
@@ -269,8 +354,11 @@ void updateUI(AudioInput& audioInput, const std::vector<AudioInput::DeviceInfo>&
     }
 
     recorderState.outputDeviceIndex = requestedOutputDeviceIndex;
+    const AudioStreamSettings previousOutputStreamSettings = recorderState.outputStreamSettings;
+    recorderState.outputStreamSettings = state.deviceState.streamSettings;
 
-    const bool outputDeviceChanged = requestedOutputDeviceIndex != previousOutputDeviceIndex;
+    const bool outputDeviceChanged = requestedOutputDeviceIndex != previousOutputDeviceIndex ||
+                                     recorderState.outputStreamSettings != previousOutputStreamSettings;
     if (outputDeviceChanged && recorderState.audioOutput) {
         const bool wasPlaying = recorderState.audioOutput->isPlaying();
         const size_t playbackPosition = recorderState.audioOutput->getPlaybackPosition();
@@ -286,7 +374,8 @@ void updateUI(AudioInput& audioInput, const std::vector<AudioInput::DeviceInfo>&
         }
         const int channelCount = recorderState.metadata.channels > 0 ? static_cast<int>(recorderState.metadata.channels) : 1;
 
-        if (!recorderState.audioOutput->initOutputStream(sampleRate, channelCount, requestedOutputDeviceIndex)) {
+        if (!recorderState.audioOutput->initOutputStream(sampleRate, channelCount, requestedOutputDeviceIndex,
+                                                         recorderState.outputStreamSettings)) {
             recorderState.outputDeviceIndex = previousOutputDeviceIndex;
             state.deviceState.selectedOutputDeviceIndex = fallbackOutputDeviceSelection;
             recorderState.statusMessage = "Unable to switch output device";
@@ -299,11 +388,7 @@ void updateUI(AudioInput& audioInput, const std::vector<AudioInput::DeviceInfo>&
         }
     }
 
-	float deltaTime = io.DeltaTime;
-	static SpringSmoother colourSmoother(8.0f, 1.0f, 0.3f);
-	colourSmoother.setSmoothingAmount(state.visualSettings.colourSmoothingSpeed);
-	state.audioSettings.spectrumSmoothingFactor = state.visualSettings.colourSmoothingSpeed;
-	UI::AudioVisualisation::syncRecorderPresentationSettings(state);
+	const bool hasPlaybackSession = UI::AudioVisualisation::hasPlaybackSession(recorderState);
 
 	constexpr float SIDEBAR_WIDTH = 280.0f;
 	constexpr float SIDEBAR_PADDING = 12.0f;
@@ -312,63 +397,6 @@ void updateUI(AudioInput& audioInput, const std::vector<AudioInput::DeviceInfo>&
 	if (state.visibility.showUI && state.updateChecker.shouldShowUpdateBanner(state.updateState)) {
         state.updateChecker.drawUpdateBanner(state.updateState, io.DisplaySize.x, SIDEBAR_WIDTH);
     }
-    
-	static float currentDisplayR = 0.0f;
-	static float currentDisplayG = 0.0f;
-	static float currentDisplayB = 0.0f;
-
-	bool hasPlaybackSession = UI::AudioVisualisation::hasPlaybackSession(recorderState);
-
-	UI::AudioVisualisation::ColourUpdateContext colourCtx{
-		deltaTime,
-		state.visualSettings.smoothingEnabled,
-		state.visualSettings.manualSmoothing,
-		colourSmoother,
-		clear_colour,
-		state.visualSettings.activeView
-	};
-
-	if (hasPlaybackSession) {
-		UI::AudioVisualisation::processPlaybackState(
-			audioInput,
-			state,
-			recorderState,
-			currentDisplayR,
-			currentDisplayG,
-			currentDisplayB,
-			colourCtx);
-	}
-
-	bool hasMicInput = state.deviceState.selectedDeviceIndex >= 0;
-
-	if (!hasPlaybackSession && hasMicInput) {
-		UI::AudioVisualisation::processLiveAudioState(
-			audioInput,
-			state,
-			recorderState,
-			currentDisplayR,
-			currentDisplayG,
-			currentDisplayB,
-			colourCtx);
-	}
-
-	if (!hasPlaybackSession && !hasMicInput) {
-		processIdleState(clear_colour, deltaTime);
-		currentDisplayR = clear_colour[0];
-		currentDisplayG = clear_colour[1];
-		currentDisplayB = clear_colour[2];
-        ColourPresentation::applyOutputPrecision(
-            currentDisplayR,
-            currentDisplayG,
-            currentDisplayB);
-        clear_colour[0] = currentDisplayR;
-        clear_colour[1] = currentDisplayG;
-        clear_colour[2] = currentDisplayB;
-	}
-
-    state.resyneState.displayColour[0] = currentDisplayR;
-    state.resyneState.displayColour[1] = currentDisplayG;
-    state.resyneState.displayColour[2] = currentDisplayB;
 
 	if (state.visibility.showUI) {
 		ImGuiStyle& style = ImGui::GetStyle();
@@ -460,6 +488,11 @@ void updateUI(AudioInput& audioInput, const std::vector<AudioInput::DeviceInfo>&
 		}
 
 			ReSyne::handleDialogs(state.resyneState);
+			ReSyne::publishMemoryUsage(state.resyneState);
+
+#ifdef ENABLE_FRAME_PROFILER
+		state.frameProfilerOverlay.draw(state.visibility.showFrameProfiler, ImGui::GetTime());
+#endif
 		}
 
 	handleFileDropEvents(dropEvents, recorderState);
@@ -8,6 +8,8 @@
 #include "resyne/controller/state.h"
 #include "colour/colour_core.h"
 #include "spectrum_analyser.h"
+#include "ui/audio_visualisation/live_presentation.h"
+#include "ui/profiler/frame_profiler_overlay.h"
 #include "imgui.h"
 #include <array>
 #include <string>
@@ -57,13 +59,37 @@ struct UIVisibility {
     bool showSpectrumAnalyser = true;
     bool showAdvancedSettings = false;
     bool showOSCSettings = false;
+    bool showFrameProfiler = false;
     bool sidebarOnLeft = true;
 };
 
 struct OSCSettings {
+    struct ExtraDestination {
+        std::string host = "127.0.0.1";
+        int port = 7000;
+        bool packedFrames = false;
+        float maxRateHz = 0.0f;
+    };
+
     std::string destinationHost = "127.0.0.1";
     int transmitPort = 7000;
     int receivePort = 7001;
+    bool packedFrames = false;
+    bool streamSpectrum = false;
+    bool spectrumAllBins = false;
+    bool spectrumWideLevels = false;
+    float spectrumRateHz = 30.0f;
+    float presentationLatencyMs = 0.0f;
+    std::vector<ExtraDestination> extraDestinations;
+    std::string sharedMemoryName = "synesthesia-frames";
+    std::string sharedMemoryError;
+};
+
+struct FramePacingSettings {
+    // Frames per second; zero follows the display's refresh rate.
+    float mainWindowRateCap = 0.0f;
+    float detachedWindowRateCap = 0.0f;
+    bool idleThrottling = true;
 };
 
 struct PresentationDiagnostics {
@@ -76,6 +102,7 @@ struct PresentationDiagnostics {
     bool presentationResourcesAvailable = false;
     bool highPrecisionTexturesAvailable = false;
     bool backgroundPresentationAvailable = false;
+    bool renderThreadActive = false;
     DisplaySurfacePrecision displaySurfacePrecision = DisplaySurfacePrecision::Unknown;
 };
 
@@ -95,21 +122,29 @@ struct UIState {
 #endif
 
     SpectrumAnalyser spectrumAnalyser;
+    FrameProfilerOverlay frameProfilerOverlay;
     StyleState styleState;
     UpdateState updateState;
     UpdateChecker updateChecker;
     OSCSettings oscSettings;
     PresentationDiagnostics presentationDiagnostics;
+    FramePacingSettings framePacing;
 
     bool oscEnabled = false;
     ReSyne::State resyneState;
     Renderer::PresentationResources* presentationResources = nullptr;
+    // Declared after the audio input it reads from is created, so it stops first.
+    UI::AudioVisualisation::LivePresentation livePresentation;
 
     using View = VisualSettings::View;
 };
 
 void initialiseApp(UIState& state);
 
+// Steps the colour and spectrum that every window draws. The main loop runs it once per
+// iteration before updateUI, including iterations that reuse the previous UI pass.
+void updatePresentation(AudioInput& audioInput, float* clear_colour, float deltaTime, UIState& state);
+
 void updateUI(AudioInput &audioInput,
               const std::vector<AudioInput::DeviceInfo>& devices,
               const std::vector<AudioOutput::DeviceInfo>& outputDevices,
@@ -0,0 +1,144 @@
+#include "batch_dataset_writer.h"
+
+#include <array>
+#include <system_error>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+namespace CLI {
+
+namespace {
+
+constexpr const char* kDatasetSchema = "synesthesia_condition_dataset_v1";
+constexpr std::uint64_t kRecordAlignment = 64;
+constexpr std::size_t kStreamBufferSize = std::size_t{4} << 20;
+
+}
+
+BatchDatasetWriter::BatchDatasetWriter(fs::path outputDirectory,
+                                       std::string shardPrefix,
+                                       const std::vector<std::string>& featureNames,
+                                       const std::vector<std::string>& globalFeatureNames)
+    : directory(std::move(outputDirectory)), filePrefix(std::move(shardPrefix)) {
+    nlohmann::json header;
+    header["schema"] = kDatasetSchema;
+    header["dtype"] = "<f4";
+    header["alignment"] = kRecordAlignment;
+    header["feature_names"] = featureNames;
+    header["global_feature_names"] = globalFeatureNames;
+    headerLine = header.dump();
+}
+
+bool BatchDatasetWriter::append(const Record& record, Location& location, std::string& errorMessage) {
+    std::unique_ptr<Shard> shard = acquire(errorMessage);
+    if (shard == nullptr) {
+        return false;
+    }
+
+    const std::uint64_t offset = shard->size;
+    const std::uint64_t byteCount = record.values.size() * sizeof(float);
+    shard->data.write(reinterpret_cast<const char*>(record.values.data()),
+                      static_cast<std::streamsize>(byteCount));
+    const std::uint64_t padding = (kRecordAlignment - byteCount % kRecordAlignment) % kRecordAlignment;
+    static constexpr std::array<char, kRecordAlignment> zeros{};
+    shard->data.write(zeros.data(), static_cast<std::streamsize>(padding));
+    shard->data.flush();
+    if (!shard->data.good()) {
+        errorMessage = "unable to write " + shard->dataName;
+        release(std::move(shard));
+        return false;
+    }
+    shard->size += byteCount + padding;
+
+    nlohmann::json entry;
+    entry["source"] = record.source;
+    entry["offset"] = offset;
+    entry["rows"] = record.rows;
+    entry["cols"] = record.cols;
+    entry["duration_seconds"] = record.durationSeconds;
+    entry["sample_rate"] = record.sampleRate;
+    entry["hop_size"] = record.hopSize;
+    entry["global_feature_values"] = std::vector<float>(record.globalFeatureValues.begin(),
+                                                        record.globalFeatureValues.end());
+    shard->index << entry.dump() << '\n';
+    shard->index.flush();
+    const bool indexed = shard->index.good();
+    if (!indexed) {
+        errorMessage = "unable to write the index for " + shard->dataName;
+    }
+
+    location.file = shard->dataName;
+    location.offset = offset;
+    release(std::move(shard));
+    return indexed;
+}
+
+std::unique_ptr<BatchDatasetWriter::Shard> BatchDatasetWriter::acquire(std::string& errorMessage) {
+    std::size_t shardIndex = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idleShards.empty()) {
+            std::unique_ptr<Shard> shard = std::move(idleShards.back());
+            idleShards.pop_back();
+            return shard;
+        }
+        shardIndex = shardsOpened++;
+    }
+    // Opened outside the lock: another export may be appending to an idle shard meanwhile.
+    return openShard(shardIndex, errorMessage);
+}
+
+void BatchDatasetWriter::release(std::unique_ptr<Shard> shard) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idleShards.push_back(std::move(shard));
+}
+
+std::unique_ptr<BatchDatasetWriter::Shard> BatchDatasetWriter::openShard(const std::size_t shardIndex,
+                                                                        std::string& errorMessage) const {
+    auto shard = std::make_unique<Shard>();
+    const std::string stem = filePrefix + ".w" + std::to_string(shardIndex);
+    shard->dataName = stem + ".f32";
+    const fs::path dataPath = directory / shard->dataName;
+    const fs::path indexPath = directory / (stem + ".index.jsonl");
+
+    std::error_code error;
+    const bool resuming = fs::exists(indexPath, error);
+    if (resuming) {
+        std::ifstream existing(indexPath);
+        std::string existingHeader;
+        if (!std::getline(existing, existingHeader) || existingHeader != headerLine) {
+            errorMessage = indexPath.filename().string() + " was written with different condition features";
+            return nullptr;
+        }
+    }
+
+    // A record cut short by an earlier crash was never indexed. Padding the file back onto
+    // the alignment leaves those bytes unreferenced.
+    const std::uint64_t existingSize = fs::exists(dataPath, error) ? fs::file_size(dataPath, error) : 0;
+    shard->buffer.resize(kStreamBufferSize);
+    shard->data.rdbuf()->pubsetbuf(shard->buffer.data(), static_cast<std::streamsize>(shard->buffer.size()));
+    shard->data.open(dataPath, std::ios::binary | std::ios::app);
+    shard->index.open(indexPath, std::ios::app);
+    if (error || !shard->data.is_open() || !shard->index.is_open()) {
+        errorMessage = "unable to open " + shard->dataName;
+        return nullptr;
+    }
+
+    const std::uint64_t misalignment = existingSize % kRecordAlignment;
+    if (misalignment != 0) {
+        static constexpr std::array<char, kRecordAlignment> zeros{};
+        shard->data.write(zeros.data(), static_cast<std::streamsize>(kRecordAlignment - misalignment));
+    }
+    shard->size = existingSize + (misalignment != 0 ? kRecordAlignment - misalignment : 0);
+
+    if (!resuming) {
+        shard->index << headerLine << '\n';
+        shard->index.flush();
+    }
+    return shard;
+}
+
+}
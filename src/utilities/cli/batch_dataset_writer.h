@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace CLI {
+
+// Packs condition arrays into a few large files instead of one .cond.npy and .cond.json
+// per track, for filesystems that cope badly with millions of small files. Every export
+// running at once appends to a data file of its own, so writers never wait on each other.
+//
+// Each data file (<prefix>.w<k>.f32) is raw little-endian float32 records, each starting
+// on a 64-byte boundary so a reader can np.memmap it at the record's offset. Its index
+// (<prefix>.w<k>.index.jsonl) holds a header line with the feature names, then one line per
+// record written only once the record's data has been flushed. An interrupted run
+// therefore never indexes a partial record. A later run appends to the same files, and
+// when a source appears more than once its last record wins.
+class BatchDatasetWriter {
+public:
+    struct Record {
+        std::string source;
+        std::span<const float> values;
+        std::size_t rows = 0;
+        std::size_t cols = 0;
+        float durationSeconds = 0.0f;
+        float sampleRate = 0.0f;
+        int hopSize = 0;
+        std::span<const float> globalFeatureValues;
+    };
+
+    struct Location {
+        std::string file;
+        std::uint64_t offset = 0;
+    };
+
+    BatchDatasetWriter(std::filesystem::path outputDirectory,
+                       std::string shardPrefix,
+                       const std::vector<std::string>& featureNames,
+                       const std::vector<std::string>& globalFeatureNames);
+
+    bool append(const Record& record, Location& location, std::string& errorMessage);
+
+private:
+    struct Shard {
+        std::string dataName;
+        std::ofstream data;
+        std::ofstream index;
+        std::uint64_t size = 0;
+        std::vector<char> buffer;
+    };
+
+    std::unique_ptr<Shard> acquire(std::string& errorMessage);
+    void release(std::unique_ptr<Shard> shard);
+    std::unique_ptr<Shard> openShard(std::size_t shardIndex, std::string& errorMessage) const;
+
+    std::filesystem::path directory;
+    std::string filePrefix;
+    std::string headerLine;
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Shard>> idleShards;  // Protected by mutex
+    std::size_t shardsOpened = 0;                    // Protected by mutex
+};
+
+}
@@ -0,0 +1,162 @@
+#include "batch_export_cache.h"
+
+#include <array>
+#include <exception>
+#include <fstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "resyne/encoding/formats/crc32.h"
+
+namespace fs = std::filesystem;
+
+namespace CLI {
+
+namespace {
+
+constexpr const char* kManifestHeader = "# synesthesia-batch-export-cache v1";
+constexpr std::size_t kHashChunkSize = std::size_t{1} << 20;
+
+bool hashFile(const fs::path& path, std::uint32_t& crc) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<unsigned char> chunk(kHashChunkSize);
+    std::uint32_t value = 0;
+    while (file) {
+        file.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+        const std::streamsize count = file.gcount();
+        if (count > 0) {
+            value = CRC32::update(value, chunk.data(), static_cast<std::size_t>(count));
+        }
+    }
+    if (file.bad()) {
+        return false;
+    }
+    crc = value;
+    return true;
+}
+
+}
+
+BatchExportCache::BatchExportCache(fs::path manifestFile, std::string exportSettingsKey)
+    : manifestPath(std::move(manifestFile)), settingsKey(std::move(exportSettingsKey)) {}
+
+void BatchExportCache::load() {
+    std::ifstream file(manifestPath);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line) || line != kManifestHeader) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // Each line is size, modification time, CRC-32 and settings, then the source path,
+    // which goes last so it may hold tabs of its own.
+    while (std::getline(file, line)) {
+        std::array<std::string, 4> fields;
+        std::size_t start = 0;
+        bool complete = true;
+        for (std::string& field : fields) {
+            const std::size_t tab = line.find('\t', start);
+            if (tab == std::string::npos) {
+                complete = false;
+                break;
+            }
+            field = line.substr(start, tab - start);
+            start = tab + 1;
+        }
+        if (!complete || start >= line.size()) {
+            continue;
+        }
+
+        Entry entry;
+        try {
+            entry.fingerprint.size = std::stoull(fields[0]);
+            entry.fingerprint.modifiedTicks = std::stoll(fields[1]);
+            entry.fingerprint.crc32 = static_cast<std::uint32_t>(std::stoul(fields[2]));
+        } catch (const std::exception&) {
+            continue;
+        }
+        entry.settingsKey = fields[3];
+        entries[line.substr(start)] = std::move(entry);
+    }
+}
+
+bool BatchExportCache::save() const {
+    fs::path temporaryPath = manifestPath;
+    temporaryPath += ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << kManifestHeader << '\n';
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [source, entry] : entries) {
+            file << entry.fingerprint.size << '\t'
+                 << entry.fingerprint.modifiedTicks << '\t'
+                 << entry.fingerprint.crc32 << '\t'
+                 << entry.settingsKey << '\t'
+                 << source << '\n';
+        }
+        if (!file.good()) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporaryPath, manifestPath, error);
+    if (error) {
+        fs::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool BatchExportCache::fingerprint(const fs::path& source, SourceFingerprint& result) const {
+    std::error_code error;
+    result.size = fs::file_size(source, error);
+    if (error) {
+        return false;
+    }
+    result.modifiedTicks = static_cast<std::int64_t>(fs::last_write_time(source, error).time_since_epoch().count());
+    if (error) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = entries.find(keyFor(source));
+        if (it != entries.end() &&
+            it->second.fingerprint.size == result.size &&
+            it->second.fingerprint.modifiedTicks == result.modifiedTicks) {
+            result.crc32 = it->second.fingerprint.crc32;
+            return true;
+        }
+    }
+    return hashFile(source, result.crc32);
+}
+
+bool BatchExportCache::isUpToDate(const fs::path& source, const SourceFingerprint& fingerprint) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = entries.find(keyFor(source));
+    return it != entries.end() &&
+           it->second.settingsKey == settingsKey &&
+           it->second.fingerprint.size == fingerprint.size &&
+           it->second.fingerprint.crc32 == fingerprint.crc32;
+}
+
+void BatchExportCache::record(const fs::path& source, const SourceFingerprint& fingerprint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[keyFor(source)] = Entry{fingerprint, settingsKey};
+}
+
+std::string BatchExportCache::keyFor(const fs::path& source) {
+    std::error_code error;
+    const fs::path absolute = fs::absolute(source, error);
+    return (error ? source : absolute).lexically_normal().generic_string();
+}
+
+}
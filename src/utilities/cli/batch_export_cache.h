@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace CLI {
+
+// Manifest of the files an earlier batch export has already written, kept beside its
+// outputs. An entry is reused only while the source's size and CRC-32 and the export
+// settings all still match. Sources whose size and modification time are unchanged
+// are not read again to rehash them. Safe to query and update from several threads.
+class BatchExportCache {
+public:
+    struct SourceFingerprint {
+        std::uintmax_t size = 0;
+        std::int64_t modifiedTicks = 0;
+        std::uint32_t crc32 = 0;
+    };
+
+    BatchExportCache(std::filesystem::path manifestFile, std::string exportSettingsKey);
+
+    // A missing or unreadable manifest just starts an empty cache.
+    void load();
+    // Written to a temporary file and renamed over the old manifest.
+    bool save() const;
+
+    bool fingerprint(const std::filesystem::path& source, SourceFingerprint& result) const;
+    bool isUpToDate(const std::filesystem::path& source, const SourceFingerprint& fingerprint) const;
+    void record(const std::filesystem::path& source, const SourceFingerprint& fingerprint);
+
+private:
+    struct Entry {
+        SourceFingerprint fingerprint;
+        std::string settingsKey;
+    };
+
+    static std::string keyFor(const std::filesystem::path& source);
+
+    std::filesystem::path manifestPath;
+    std::string settingsKey;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;  // Protected by mutex
+};
+
+}
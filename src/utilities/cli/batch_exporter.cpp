@@ -10,36 +10,57 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
-#include <lodepng.h>
+#include <nlohmann/json.hpp>
 
+#include "audio/analysis/fft/fft_backend.h"
 #include "audio/analysis/fft/fft_processor.h"
 #include "audio/analysis/presentation/sample_sequence.h"
 #include "audio/analysis/presentation/spectral_presentation.h"
 #include "colour/colour_core.h"
 #include "colour/colour_presentation.h"
+#include "resyne/decoding/audio_decoder.h"
 #include "resyne/encoding/formats/exporter.h"
 #include "resyne/encoding/formats/rsyn_presentation.h"
 #include "resyne/recorder/import_helpers.h"
+#include "utilities/tuning/wisdom.h"
+#include "batch_dataset_writer.h"
+#include "batch_export_cache.h"
+#include "batch_memory_budget.h"
+#include "batch_prefetcher.h"
+#include "gradient_png_writer.h"
+#include "utilities/threading/task_scheduler.h"
 
 namespace fs = std::filesystem;
 
 namespace CLI {
 
+using Utilities::Threading::TaskContext;
+using Utilities::Threading::TaskPriority;
+using Utilities::Threading::TaskScheduler;
+
 namespace {
 
 static constexpr int   kDefaultPixelsPerSecond = 20;
 static constexpr int   kDefaultHeight          = 800;
 static constexpr int   kNumSpectralBands       = 24;
 static constexpr int   kNumChromaBins          = 12;
+static constexpr const char* kShardManifestSchema = "synesthesia_batch_manifest_v1";
+// Read-ahead past the workers is capped at 1 GiB; two readers keep a network mount busy
+// without competing with the workers' own reads.
+static constexpr size_t kPrefetchByteWindow = size_t{1} << 30;
+static constexpr size_t kPrefetchReaders    = 2;
 
 static const std::vector<std::string> kAudioExtensions = {
     ".wav", ".flac", ".mp3", ".mpeg3", ".mpga", ".ogg", ".oga"
@@ -267,150 +288,150 @@ float weightedMean(const std::vector<float>& values, const std::vector<float>& w
     return static_cast<float>(total / totalWeight);
 }
 
-std::vector<float> resolveFrequencies(const SpectralPresentation::Frame& frame,
-                                      const std::vector<float>& sharedMagnitudes) {
-    std::vector<float> frequencies = frame.frequencies;
-    if (frequencies.size() == sharedMagnitudes.size()) {
-        return frequencies;
+void resolveFrequencies(const SpectralPresentation::FrameView& frame,
+                        const size_t binCount,
+                        std::vector<float>& frequencies) {
+    if (frame.frequencies.size() == binCount) {
+        frequencies.assign(frame.frequencies.begin(), frame.frequencies.end());
+        return;
     }
 
-    frequencies.assign(sharedMagnitudes.size(), 0.0f);
-    const float fftSize = sharedMagnitudes.size() > 1
-        ? static_cast<float>((sharedMagnitudes.size() - 1) * 2)
+    frequencies.resize(binCount);
+    const float fftSize = binCount > 1
+        ? static_cast<float>((binCount - 1) * 2)
         : static_cast<float>(FFTProcessor::FFT_SIZE);
     const float binSize = fftSize > 0.0f ? frame.sampleRate / fftSize : 0.0f;
-    for (size_t index = 0; index < frequencies.size(); ++index) {
+    for (size_t index = 0; index < binCount; ++index) {
         frequencies[index] = static_cast<float>(index) * binSize;
     }
-    return frequencies;
 }
 
-StereoFeatureSet computeStereoFeatures(const AudioColourSample& sample,
-                                       const std::vector<float>& frequencies) {
-    StereoFeatureSet result{};
-    if (sample.magnitudes.size() < 2 || sample.magnitudes[0].empty() || sample.magnitudes[1].empty()) {
-        return result;
-    }
+// MIDI notes 0-135 span FFTProcessor's 20 Hz to 20 kHz range.
+static constexpr int   kNumMidiNotes           = 136;
+static constexpr float kPitchReferenceFrequency = 440.0f;
+static constexpr int   kPitchReferenceMidi      = 69;
+static constexpr size_t kNumContrastBands       = 3;
+
+// Which band, note and range each bin of one frequency axis falls in. Every frame of a track
+// shares the axis, so each worker builds this once and the feature sweep looks bins up
+// instead of comparing frequencies and taking a log2 per bin per frame.
+struct FeatureBinMap {
+    std::vector<float> frequencies;
+    float bandMaxFrequency = 0.0f;
+    float stereoMaxFrequency = 0.0f;
+    std::vector<int16_t> notes;          // -1 outside the analysed frequency range
+    std::vector<int8_t> spectralBands;   // -1 outside the band features' range
+    std::vector<uint8_t> energyBands;    // low, mid or high band energy
+    std::vector<uint8_t> contrastBands;  // low, mid or high spectral contrast
+    std::vector<uint8_t> stereoBins;     // 1 inside the stereo features' range
+};
 
-    const size_t binCount = std::min(sample.magnitudes[0].size(), sample.magnitudes[1].size());
-    if (binCount == 0) {
-        return result;
+void buildFeatureBinMap(const std::vector<float>& frequencies,
+                        const float bandMaxFrequency,
+                        const float stereoMaxFrequency,
+                        FeatureBinMap& map) {
+    map.frequencies = frequencies;
+    map.bandMaxFrequency = bandMaxFrequency;
+    map.stereoMaxFrequency = stereoMaxFrequency;
+    map.notes.assign(frequencies.size(), -1);
+    map.spectralBands.assign(frequencies.size(), -1);
+    map.energyBands.assign(frequencies.size(), 0);
+    map.contrastBands.assign(frequencies.size(), 0);
+    map.stereoBins.assign(frequencies.size(), 0);
+
+    const float minErb = FFTProcessor::frequencyToERBScale(FFTProcessor::MIN_FREQ);
+    const float maxErb = FFTProcessor::frequencyToERBScale(std::max(FFTProcessor::MIN_FREQ, bandMaxFrequency));
+    const float erbSpan = std::max(maxErb - minErb, 1e-6f);
+    for (size_t index = 0; index < frequencies.size(); ++index) {
+        const float frequency = frequencies[index];
+        if (!std::isfinite(frequency) || frequency < FFTProcessor::MIN_FREQ) {
+            continue;
+        }
+
+        if (frequency <= bandMaxFrequency) {
+            const float erb = FFTProcessor::frequencyToERBScale(frequency);
+            const int band = static_cast<int>(((erb - minErb) / erbSpan) * static_cast<float>(kNumSpectralBands));
+            map.spectralBands[index] = static_cast<int8_t>(std::clamp(band, 0, kNumSpectralBands - 1));
+            map.energyBands[index] = frequency < 220.0f ? 0 : (frequency < 2200.0f ? 1 : 2);
+        }
+        map.stereoBins[index] = frequency <= stereoMaxFrequency ? 1 : 0;
+        if (frequency <= FFTProcessor::MAX_FREQ) {
+            const double midi = static_cast<double>(kPitchReferenceMidi) +
+                12.0 * std::log2(static_cast<double>(frequency) / static_cast<double>(kPitchReferenceFrequency));
+            map.notes[index] = static_cast<int16_t>(std::clamp(static_cast<int>(std::lround(midi)), 0, kNumMidiNotes - 1));
+            map.contrastBands[index] = frequency < 250.0f ? 0 : (frequency < 4000.0f ? 1 : 2);
+        }
     }
+}
+
+// Per-worker scratch for computeFrameFeatures, sized by the first frame and reused for the
+// rest so the sweep allocates nothing.
+struct FrameFeatureWorkspace {
+    SpectralPresentation::FrameWorkspace frame;
+    FeatureBinMap binMap;
+    std::vector<float> frequencies;
+    std::vector<double> binEnergies;
+    std::array<std::vector<float>, kNumContrastBands> contrastDb;
+    std::array<size_t, kNumContrastBands> contrastCounts{};
+};
 
+struct StereoSums {
     double leftEnergy = 0.0;
     double rightEnergy = 0.0;
     double midEnergy = 0.0;
     double sideEnergy = 0.0;
     double phaseAlignment = 0.0;
     double phaseWeight = 0.0;
+};
 
-    const bool hasPhases = sample.phases.size() >= 2 &&
-        sample.phases[0].size() >= binCount &&
-        sample.phases[1].size() >= binCount;
-
-    for (size_t index = 0; index < binCount; ++index) {
-        const float frequency = index < frequencies.size() ? frequencies[index] : 0.0f;
-        if (!std::isfinite(frequency) ||
-            frequency < FFTProcessor::MIN_FREQ ||
-            frequency > std::min(FFTProcessor::MAX_FREQ, sample.sampleRate * 0.5f)) {
-            continue;
-        }
-
-        const float leftMagnitude = sample.magnitudes[0][index];
-        const float rightMagnitude = sample.magnitudes[1][index];
-        if (!std::isfinite(leftMagnitude) || !std::isfinite(rightMagnitude) ||
-            leftMagnitude <= 0.0f || rightMagnitude <= 0.0f) {
-            continue;
-        }
-
-        const double left = static_cast<double>(leftMagnitude) * static_cast<double>(leftMagnitude);
-        const double right = static_cast<double>(rightMagnitude) * static_cast<double>(rightMagnitude);
-        const double mid = std::pow(0.5 * (static_cast<double>(leftMagnitude) + static_cast<double>(rightMagnitude)), 2.0);
-        const double side = std::pow(0.5 * (static_cast<double>(leftMagnitude) - static_cast<double>(rightMagnitude)), 2.0);
-        leftEnergy += left;
-        rightEnergy += right;
-        midEnergy += mid;
-        sideEnergy += side;
-
-        if (hasPhases) {
-            const float leftPhase = sample.phases[0][index];
-            const float rightPhase = sample.phases[1][index];
-            if (std::isfinite(leftPhase) && std::isfinite(rightPhase)) {
-                const double weight = 0.5 * (left + right);
-                phaseAlignment += std::cos(static_cast<double>(leftPhase) - static_cast<double>(rightPhase)) * weight;
-                phaseWeight += weight;
-            }
-        }
-    }
-
-    const double stereoEnergy = leftEnergy + rightEnergy;
-    const double midSideEnergy = midEnergy + sideEnergy;
+StereoFeatureSet resolveStereoFeatures(const StereoSums& sums) {
+    StereoFeatureSet result{};
+    const double stereoEnergy = sums.leftEnergy + sums.rightEnergy;
+    const double midSideEnergy = sums.midEnergy + sums.sideEnergy;
     if (stereoEnergy > 1e-8) {
-        result.leftEnergy = static_cast<float>(leftEnergy / stereoEnergy);
-        result.rightEnergy = static_cast<float>(rightEnergy / stereoEnergy);
-        result.balance = static_cast<float>((rightEnergy - leftEnergy) / stereoEnergy);
+        result.leftEnergy = static_cast<float>(sums.leftEnergy / stereoEnergy);
+        result.rightEnergy = static_cast<float>(sums.rightEnergy / stereoEnergy);
+        result.balance = static_cast<float>((sums.rightEnergy - sums.leftEnergy) / stereoEnergy);
     }
     if (midSideEnergy > 1e-8) {
-        result.midEnergy = static_cast<float>(midEnergy / midSideEnergy);
-        result.sideEnergy = static_cast<float>(sideEnergy / midSideEnergy);
-        result.width = static_cast<float>(sideEnergy / midSideEnergy);
+        result.midEnergy = static_cast<float>(sums.midEnergy / midSideEnergy);
+        result.sideEnergy = static_cast<float>(sums.sideEnergy / midSideEnergy);
+        result.width = static_cast<float>(sums.sideEnergy / midSideEnergy);
     }
-    if (phaseWeight > 1e-8) {
-        result.phaseAlignment = static_cast<float>((phaseAlignment / phaseWeight + 1.0) * 0.5);
+    if (sums.phaseWeight > 1e-8) {
+        result.phaseAlignment = static_cast<float>((sums.phaseAlignment / sums.phaseWeight + 1.0) * 0.5);
     }
     return result;
 }
 
-PitchFeatureSet computePitchFeatures(const std::vector<float>& sharedMagnitudes,
-                                     const std::vector<float>& frequencies) {
+// The note energies and their total come from the sweep; only the harmonic pass, which needs
+// the winning pitch, goes back over the bins.
+PitchFeatureSet resolvePitchFeatures(const FeatureBinMap& map,
+                                     const std::vector<double>& binEnergies,
+                                     const std::array<double, kNumMidiNotes>& noteEnergy,
+                                     const double totalEnergy) {
     PitchFeatureSet result{};
-    if (sharedMagnitudes.empty() || frequencies.size() != sharedMagnitudes.size()) {
+    if (totalEnergy <= 1e-8) {
         return result;
     }
 
-    constexpr float kReferenceFrequency = 440.0f;
-    constexpr int kReferenceMidi = 69;
     constexpr float kMinPitchHz = 30.0f;
     constexpr float kMaxPitchHz = 5000.0f;
     constexpr float kHarmonicTolerance = 0.03f;
 
-    std::unordered_map<int, double> noteEnergy;
-    double totalEnergy = 0.0;
-
-    for (size_t index = 0; index < sharedMagnitudes.size(); ++index) {
-        const float magnitude = sharedMagnitudes[index];
-        const float frequency = frequencies[index];
-        if (!std::isfinite(magnitude) || !std::isfinite(frequency) ||
-            magnitude <= 0.0f || frequency < FFTProcessor::MIN_FREQ || frequency > FFTProcessor::MAX_FREQ) {
-            continue;
-        }
-
-        const double energy = static_cast<double>(magnitude) * static_cast<double>(magnitude);
-        totalEnergy += energy;
-
-        const double midi = static_cast<double>(kReferenceMidi) +
-            12.0 * std::log2(static_cast<double>(frequency) / static_cast<double>(kReferenceFrequency));
-        const int nearestMidi = static_cast<int>(std::lround(midi));
-        const int chroma = ((nearestMidi % kNumChromaBins) + kNumChromaBins) % kNumChromaBins;
-        noteEnergy[nearestMidi] += energy;
-        result.chroma[static_cast<size_t>(chroma)] += static_cast<float>(energy);
-    }
-
-    if (totalEnergy <= 1e-8 || noteEnergy.empty()) {
-        return result;
-    }
-
     int bestMidi = 0;
     double bestEnergy = -1.0;
-    for (const auto& [midi, energy] : noteEnergy) {
+    for (int midi = 0; midi < kNumMidiNotes; ++midi) {
+        const double energy = noteEnergy[static_cast<size_t>(midi)];
+        result.chroma[static_cast<size_t>(midi % kNumChromaBins)] += static_cast<float>(energy);
         if (energy > bestEnergy) {
             bestEnergy = energy;
             bestMidi = midi;
         }
     }
 
-    result.pitchHz = kReferenceFrequency *
-        std::pow(2.0f, (static_cast<float>(bestMidi) - static_cast<float>(kReferenceMidi)) / 12.0f);
+    result.pitchHz = kPitchReferenceFrequency *
+        std::pow(2.0f, (static_cast<float>(bestMidi) - static_cast<float>(kPitchReferenceMidi)) / 12.0f);
     if (result.pitchHz < kMinPitchHz || result.pitchHz > kMaxPitchHz) {
         result.pitchHz = 0.0f;
         bestEnergy = 0.0;
@@ -420,18 +441,17 @@ PitchFeatureSet computePitchFeatures(const std::vector<float>& sharedMagnitudes,
     double harmonicEnergy = 0.0;
     double inharmonicity = 0.0;
     if (result.pitchHz > 0.0f) {
-        for (size_t index = 0; index < sharedMagnitudes.size(); ++index) {
-            const float magnitude = sharedMagnitudes[index];
-            const float frequency = frequencies[index];
-            if (!std::isfinite(magnitude) || !std::isfinite(frequency) ||
-                magnitude <= 0.0f || frequency < FFTProcessor::MIN_FREQ || frequency > FFTProcessor::MAX_FREQ) {
+        const double pitchHz = static_cast<double>(result.pitchHz);
+        for (size_t index = 0; index < binEnergies.size(); ++index) {
+            const double energy = binEnergies[index];
+            if (energy <= 0.0) {
                 continue;
             }
 
-            const double energy = static_cast<double>(magnitude) * static_cast<double>(magnitude);
-            const double harmonic = std::max(1.0, std::round(static_cast<double>(frequency) / static_cast<double>(result.pitchHz)));
-            const double target = harmonic * static_cast<double>(result.pitchHz);
-            const double deviation = std::abs(static_cast<double>(frequency) - target) / std::max(target, 1.0);
+            const double frequency = static_cast<double>(map.frequencies[index]);
+            const double harmonic = std::max(1.0, std::round(frequency / pitchHz));
+            const double target = harmonic * pitchHz;
+            const double deviation = std::abs(frequency - target) / std::max(target, 1.0);
             if (deviation <= kHarmonicTolerance) {
                 harmonicEnergy += energy * (1.0 - deviation / kHarmonicTolerance);
             }
@@ -447,94 +467,126 @@ PitchFeatureSet computePitchFeatures(const std::vector<float>& sharedMagnitudes,
     return result;
 }
 
-float computeBandContrast(const std::vector<float>& values) {
-    if (values.size() < 4) {
+// The spread between the 10th and 90th percentile of values, selected in place.
+float computeBandContrast(std::vector<float>& values, const size_t count) {
+    if (count < 4) {
         return 0.0f;
     }
-    std::vector<float> sorted = values;
-    std::sort(sorted.begin(), sorted.end());
-    const size_t lowIndex = static_cast<size_t>(std::floor(0.1 * static_cast<double>(sorted.size() - 1)));
-    const size_t highIndex = static_cast<size_t>(std::floor(0.9 * static_cast<double>(sorted.size() - 1)));
-    return sorted[highIndex] - sorted[lowIndex];
-}
-
-SpectralContrastSet computeSpectralContrast(const std::vector<float>& sharedMagnitudes,
-                                            const std::vector<float>& frequencies) {
-    SpectralContrastSet result{};
-    std::vector<float> lowBand;
-    std::vector<float> midBand;
-    std::vector<float> highBand;
-
-    for (size_t index = 0; index < sharedMagnitudes.size() && index < frequencies.size(); ++index) {
-        const float magnitude = sharedMagnitudes[index];
-        const float frequency = frequencies[index];
-        if (!std::isfinite(magnitude) || !std::isfinite(frequency) ||
-            magnitude <= 0.0f || frequency < FFTProcessor::MIN_FREQ || frequency > FFTProcessor::MAX_FREQ) {
-            continue;
-        }
-        const float db = 20.0f * std::log10(std::max(magnitude, 1e-6f));
-        if (frequency < 250.0f) {
-            lowBand.push_back(db);
-        } else if (frequency < 4000.0f) {
-            midBand.push_back(db);
-        } else {
-            highBand.push_back(db);
-        }
-    }
-
-    result.low = computeBandContrast(lowBand);
-    result.mid = computeBandContrast(midBand);
-    result.high = computeBandContrast(highBand);
-    return result;
+    const auto first = values.begin();
+    const size_t lowIndex = static_cast<size_t>(std::floor(0.1 * static_cast<double>(count - 1)));
+    const size_t highIndex = static_cast<size_t>(std::floor(0.9 * static_cast<double>(count - 1)));
+    std::nth_element(first, first + static_cast<std::ptrdiff_t>(highIndex), first + static_cast<std::ptrdiff_t>(count));
+    const float high = values[highIndex];
+    std::nth_element(first, first + static_cast<std::ptrdiff_t>(lowIndex), first + static_cast<std::ptrdiff_t>(highIndex));
+    return high - values[lowIndex];
 }
 
+// Band, stereo, pitch and contrast features in one sweep over the frame's bins.
 FrameFeatureSet computeFrameFeatures(const AudioMetadata& metadata,
-                                     const AudioColourSample& sample) {
+                                     const SpectralFrame& sample) {
     FrameFeatureSet result{};
-    const auto frame = SpectralPresentation::SampleSequence::buildFrame(sample);
-    const auto sharedMagnitudes = SpectralPresentation::buildSharedMagnitudes(
+    thread_local FrameFeatureWorkspace workspace;
+    const auto frame = SpectralPresentation::SampleSequence::buildFrame(workspace.frame, sample);
+    SpectralPresentation::buildSharedMagnitudes(
         frame,
-        buildBatchSpectralSettings(metadata.presentationData->settings));
+        buildBatchSpectralSettings(metadata.presentationData->settings),
+        workspace.frame.sharedMagnitudes);
+    const std::vector<float>& sharedMagnitudes = workspace.frame.sharedMagnitudes;
     if (sharedMagnitudes.empty() || frame.sampleRate <= 0.0f) {
         return result;
     }
 
-    const std::vector<float> frequencies = resolveFrequencies(frame, sharedMagnitudes);
-    const float nyquist = frame.sampleRate * 0.5f;
-    const float maxFrequency = std::min(FFTProcessor::MAX_FREQ, nyquist);
-    const float minErb = FFTProcessor::frequencyToERBScale(FFTProcessor::MIN_FREQ);
-    const float maxErb = FFTProcessor::frequencyToERBScale(std::max(FFTProcessor::MIN_FREQ, maxFrequency));
-    const float erbSpan = std::max(maxErb - minErb, 1e-6f);
+    const size_t binCount = sharedMagnitudes.size();
+    resolveFrequencies(frame, binCount, workspace.frequencies);
+    const float bandMaxFrequency = std::min(FFTProcessor::MAX_FREQ, frame.sampleRate * 0.5f);
+    const float stereoMaxFrequency = std::min(FFTProcessor::MAX_FREQ, sample.sampleRate * 0.5f);
+    FeatureBinMap& map = workspace.binMap;
+    if (map.bandMaxFrequency != bandMaxFrequency || map.stereoMaxFrequency != stereoMaxFrequency ||
+        map.frequencies != workspace.frequencies) {
+        buildFeatureBinMap(workspace.frequencies, bandMaxFrequency, stereoMaxFrequency, map);
+    }
+
+    workspace.binEnergies.resize(binCount);
+    for (size_t band = 0; band < kNumContrastBands; ++band) {
+        workspace.contrastDb[band].resize(binCount);
+        workspace.contrastCounts[band] = 0;
+    }
 
+    const bool hasStereo = sample.magnitudes.size() >= 2;
+    const size_t stereoBins = hasStereo
+        ? std::min({binCount, sample.magnitudes[0].size(), sample.magnitudes[1].size()})
+        : 0;
+    const bool hasStereoPhases = stereoBins > 0 && sample.phases.size() >= 2 &&
+        sample.phases[0].size() >= stereoBins &&
+        sample.phases[1].size() >= stereoBins;
+
+    std::array<float, 3> bandEnergy{};
     float totalEnergy = 0.0f;
-    for (size_t index = 0; index < sharedMagnitudes.size(); ++index) {
+    std::array<double, kNumMidiNotes> noteEnergy{};
+    double pitchEnergy = 0.0;
+    StereoSums stereo{};
+    for (size_t index = 0; index < binCount; ++index) {
         const float magnitude = sharedMagnitudes[index];
-        const float frequency = frequencies[index];
-        if (!std::isfinite(magnitude) || !std::isfinite(frequency) ||
-            magnitude <= 0.0f || frequency < FFTProcessor::MIN_FREQ || frequency > maxFrequency) {
-            continue;
+        // Fails for NaN as well as for silent and infinite bins.
+        const bool usable = magnitude > 0.0f && magnitude < std::numeric_limits<float>::infinity();
+
+        const int8_t spectralBand = map.spectralBands[index];
+        if (usable && spectralBand >= 0) {
+            const float energy = magnitude * magnitude;
+            totalEnergy += energy;
+            bandEnergy[map.energyBands[index]] += energy;
+            result.bandFeatures.bands[static_cast<size_t>(spectralBand)] += energy;
         }
 
-        const float energy = magnitude * magnitude;
-        totalEnergy += energy;
-        if (frequency < 220.0f) {
-            result.bandFeatures.low += energy;
-        } else if (frequency < 2200.0f) {
-            result.bandFeatures.mid += energy;
-        } else {
-            result.bandFeatures.high += energy;
+        const int16_t note = map.notes[index];
+        const double energy = usable && note >= 0
+            ? static_cast<double>(magnitude) * static_cast<double>(magnitude)
+            : 0.0;
+        workspace.binEnergies[index] = energy;
+        if (energy > 0.0) {
+            noteEnergy[static_cast<size_t>(note)] += energy;
+            pitchEnergy += energy;
+            const size_t contrastBand = map.contrastBands[index];
+            workspace.contrastDb[contrastBand][workspace.contrastCounts[contrastBand]++] =
+                20.0f * std::log10(std::max(magnitude, 1e-6f));
+        }
+
+        if (index >= stereoBins || map.stereoBins[index] == 0) {
+            continue;
+        }
+        const float leftMagnitude = sample.magnitudes[0][index];
+        const float rightMagnitude = sample.magnitudes[1][index];
+        if (!std::isfinite(leftMagnitude) || !std::isfinite(rightMagnitude) ||
+            leftMagnitude <= 0.0f || rightMagnitude <= 0.0f) {
+            continue;
         }
 
-        const float erb = FFTProcessor::frequencyToERBScale(frequency);
-        int bandIndex = static_cast<int>(((erb - minErb) / erbSpan) * static_cast<float>(kNumSpectralBands));
-        bandIndex = std::clamp(bandIndex, 0, kNumSpectralBands - 1);
-        result.bandFeatures.bands[static_cast<size_t>(bandIndex)] += energy;
+        const double leftValue = static_cast<double>(leftMagnitude);
+        const double rightValue = static_cast<double>(rightMagnitude);
+        const double left = leftValue * leftValue;
+        const double right = rightValue * rightValue;
+        const double mid = 0.5 * (leftValue + rightValue);
+        const double side = 0.5 * (leftValue - rightValue);
+        stereo.leftEnergy += left;
+        stereo.rightEnergy += right;
+        stereo.midEnergy += mid * mid;
+        stereo.sideEnergy += side * side;
+
+        if (hasStereoPhases) {
+            const float leftPhase = sample.phases[0][index];
+            const float rightPhase = sample.phases[1][index];
+            if (std::isfinite(leftPhase) && std::isfinite(rightPhase)) {
+                const double weight = 0.5 * (left + right);
+                stereo.phaseAlignment += std::cos(static_cast<double>(leftPhase) - static_cast<double>(rightPhase)) * weight;
+                stereo.phaseWeight += weight;
+            }
+        }
     }
 
     if (totalEnergy > 1e-8f) {
-        result.bandFeatures.low /= totalEnergy;
-        result.bandFeatures.mid /= totalEnergy;
-        result.bandFeatures.high /= totalEnergy;
+        result.bandFeatures.low = bandEnergy[0] / totalEnergy;
+        result.bandFeatures.mid = bandEnergy[1] / totalEnergy;
+        result.bandFeatures.high = bandEnergy[2] / totalEnergy;
         const float weightedLow = result.bandFeatures.low + 0.5f * result.bandFeatures.mid;
         const float weightedHigh = result.bandFeatures.high + 0.5f * result.bandFeatures.mid;
         result.bandFeatures.tilt = std::clamp(weightedHigh - weightedLow, -1.0f, 1.0f);
@@ -543,12 +595,42 @@ FrameFeatureSet computeFrameFeatures(const AudioMetadata& metadata,
         }
     }
 
-    result.stereoFeatures = computeStereoFeatures(sample, frequencies);
-    result.pitchFeatures = computePitchFeatures(sharedMagnitudes, frequencies);
-    result.spectralContrast = computeSpectralContrast(sharedMagnitudes, frequencies);
+    result.stereoFeatures = resolveStereoFeatures(stereo);
+    result.pitchFeatures = resolvePitchFeatures(map, workspace.binEnergies, noteEnergy, pitchEnergy);
+    result.spectralContrast.low = computeBandContrast(workspace.contrastDb[0], workspace.contrastCounts[0]);
+    result.spectralContrast.mid = computeBandContrast(workspace.contrastDb[1], workspace.contrastCounts[1]);
+    result.spectralContrast.high = computeBandContrast(workspace.contrastDb[2], workspace.contrastCounts[2]);
     return result;
 }
 
+// Autocorrelation for lags 0 to maxLag as the inverse transform of the power spectrum
+// (Wiener-Khinchin), which is O(n log n) where summing each lag directly is O(n * lags).
+// Zero-padding to twice the length stops the circular correlation wrapping around.
+std::vector<double> autocorrelate(const std::vector<float>& values, const size_t maxLag) {
+    size_t fftSize = 2;
+    while (fftSize < values.size() * 2) {
+        fftSize <<= 1;
+    }
+
+    const auto transform = FFTBackend::create(static_cast<int>(fftSize));
+    std::vector<float> signal(fftSize, 0.0f);
+    std::copy(values.begin(), values.end(), signal.begin());
+    std::vector<kiss_fft_cpx> spectrum(fftSize / 2 + 1);
+    transform->forward(signal, spectrum);
+    for (kiss_fft_cpx& bin : spectrum) {
+        bin.r = bin.r * bin.r + bin.i * bin.i;
+        bin.i = 0.0f;
+    }
+    transform->inverse(spectrum, signal);
+
+    std::vector<double> correlation(std::min(maxLag + 1, values.size()));
+    const double scale = 1.0 / static_cast<double>(fftSize);
+    for (size_t lag = 0; lag < correlation.size(); ++lag) {
+        correlation[lag] = static_cast<double>(signal[lag]) * scale;
+    }
+    return correlation;
+}
+
 std::optional<std::pair<float, float>> estimateTempoFromOnsets(const std::vector<float>& onsetEnvelope,
                                                                const float deltaTimeSeconds) {
     if (onsetEnvelope.size() < 8 || !std::isfinite(deltaTimeSeconds) || deltaTimeSeconds <= 0.0f) {
@@ -567,10 +649,15 @@ std::optional<std::pair<float, float>> estimateTempoFromOnsets(const std::vector
         return std::nullopt;
     }
 
-    double zeroLag = 0.0;
-    for (const float value : centered) {
-        zeroLag += static_cast<double>(value) * static_cast<double>(value);
+    std::vector<double> correlation;
+    try {
+        correlation = autocorrelate(centered, static_cast<size_t>(maxLag));
+    } catch (const std::runtime_error& error) {
+        std::cerr << "Warning: tempo estimation skipped: " << error.what() << "\n";
+        return std::nullopt;
     }
+
+    const double zeroLag = correlation[0];
     if (zeroLag <= 1e-8) {
         return std::nullopt;
     }
@@ -578,13 +665,8 @@ std::optional<std::pair<float, float>> estimateTempoFromOnsets(const std::vector
     double bestCorrelation = -1.0;
     int bestLag = minLag;
     for (int lag = minLag; lag <= maxLag; ++lag) {
-        double correlation = 0.0;
-        for (size_t index = static_cast<size_t>(lag); index < centered.size(); ++index) {
-            correlation += static_cast<double>(centered[index]) *
-                static_cast<double>(centered[index - static_cast<size_t>(lag)]);
-        }
-        if (correlation > bestCorrelation) {
-            bestCorrelation = correlation;
+        if (correlation[static_cast<size_t>(lag)] > bestCorrelation) {
+            bestCorrelation = correlation[static_cast<size_t>(lag)];
             bestLag = lag;
         }
     }
@@ -683,6 +765,23 @@ bool isAudioFile(const fs::path& path) {
     return false;
 }
 
+bool isRsynFile(const fs::path& path) {
+    return toLower(path.extension().string()) == ".rsyn";
+}
+
+// The audio beside an archive under the same stem, which --copy-audio copies in its place.
+fs::path findAudioTwin(const fs::path& rsynPath) {
+    for (const auto& extension : kAudioExtensions) {
+        fs::path candidate = rsynPath;
+        candidate.replace_extension(extension);
+        std::error_code ec;
+        if (fs::is_regular_file(candidate, ec)) {
+            return candidate;
+        }
+    }
+    return {};
+}
+
 RSYNPresentationSettings buildBatchPresentationSettings(const bool disableSmoothing) {
     RSYNPresentationSettings settings{};
     settings.colourSpace = ColourCore::ColourSpace::Rec2020;
@@ -705,7 +804,23 @@ SpectralPresentation::Settings buildBatchSpectralSettings(const RSYNPresentation
     return presentation;
 }
 
-bool buildFrameColours(const std::vector<AudioColourSample>& samples,
+bool collectFrameColours(AudioMetadata& metadata, std::vector<FrameLab>& frameColours) {
+    frameColours.clear();
+    const bool useSmoothedTrack = metadata.presentationData->settings.smoothingEnabled;
+    frameColours.reserve(metadata.presentationData->frames.size());
+    for (const auto& frame : metadata.presentationData->frames) {
+        if (useSmoothedTrack) {
+            frameColours.push_back({frame.smoothedLab[0], frame.smoothedLab[1], frame.smoothedLab[2]});
+        } else {
+            frameColours.push_back({frame.analysis.L, frame.analysis.a, frame.analysis.b_comp});
+        }
+    }
+
+    metadata.numFrames = frameColours.size();
+    return !frameColours.empty();
+}
+
+bool buildFrameColours(const SpectralSequenceView samples,
                        AudioMetadata& metadata,
                        const bool disableSmoothing,
                        std::vector<FrameLab>& frameColours) {
@@ -717,19 +832,55 @@ bool buildFrameColours(const std::vector<AudioColourSample>& samples,
     if (metadata.presentationData == nullptr || metadata.presentationData->frames.empty()) {
         return false;
     }
+    return collectFrameColours(metadata, frameColours);
+}
 
-    const bool useSmoothedTrack = metadata.presentationData->settings.smoothingEnabled;
-    frameColours.reserve(metadata.presentationData->frames.size());
-    for (const auto& frame : metadata.presentationData->frames) {
-        if (useSmoothedTrack) {
-            frameColours.push_back({frame.smoothedLab[0], frame.smoothedLab[1], frame.smoothedLab[2]});
-        } else {
-            frameColours.push_back({frame.analysis.L, frame.analysis.a, frame.analysis.b_comp});
-        }
+// Whether a stored presentation track is the one buildFrameColours would build. Colour space
+// and gamut mapping only change the display RGB, which the batch outputs never read.
+bool presentationMatches(const RSYNPresentationSettings& stored, const RSYNPresentationSettings& wanted) {
+    if (stored.pipelineId != wanted.pipelineId || stored.lowGain != wanted.lowGain ||
+        stored.midGain != wanted.midGain || stored.highGain != wanted.highGain ||
+        stored.smoothingEnabled != wanted.smoothingEnabled) {
+        return false;
     }
+    return !wanted.smoothingEnabled ||
+        (stored.manualSmoothing == wanted.manualSmoothing && stored.smoothingAmount == wanted.smoothingAmount &&
+         stored.smoothingUpdateFactor == wanted.smoothingUpdateFactor && stored.springMass == wanted.springMass);
+}
 
-    metadata.numFrames = frameColours.size();
-    return !frameColours.empty();
+bool hasSpectralBlocks(const AudioMetadata& metadata) {
+    return metadata.lazyAsset != nullptr && metadata.lazyAsset->spectralBlockFrames > 0;
+}
+
+// Takes an archive's stored analysis in place of decoding the audio. A matching PRES track is
+// used as it is and, when the archive has SPEC blocks, samples stays empty for
+// buildConditionSlices to hydrate a block range at a time. Anything else hydrates every frame
+// and rebuilds the presentation from them.
+bool loadRsynInput(const fs::path& rsynPath,
+                   const bool disableSmoothing,
+                   const bool needsSpectra,
+                   SpectralSequence& samples,
+                   AudioMetadata& metadata,
+                   std::vector<FrameLab>& frameColours,
+                   std::string& errorMessage) {
+    if (!SequenceExporter::loadFromRsynShell(rsynPath.string(), metadata)) {
+        errorMessage = "unreadable .rsyn";
+        return false;
+    }
+
+    const bool reusable = metadata.presentationData != nullptr && metadata.numFrames > 0 &&
+        metadata.presentationData->frames.size() == metadata.numFrames &&
+        presentationMatches(metadata.presentationData->settings, buildBatchPresentationSettings(disableSmoothing));
+    if (!reusable || (needsSpectra && !hasSpectralBlocks(metadata))) {
+        if (!SequenceExporter::hydrateRsynSamples(metadata, samples) || samples.empty()) {
+            errorMessage = "no spectral frames in .rsyn";
+            return false;
+        }
+    }
+    if (!reusable) {
+        return buildFrameColours(samples, metadata, disableSmoothing, frameColours);
+    }
+    return collectFrameColours(metadata, frameColours);
 }
 
 enum class GradientOutputMode {
@@ -796,14 +947,33 @@ bool writeFloat32Npy(const fs::path& outputPath,
     return stream.good();
 }
 
-bool exportConditionSlices(const AudioMetadata& metadata,
-                           const std::vector<AudioColourSample>& samples,
-                           const fs::path& outputPath,
-                           std::vector<float>* globalFeatureValues) {
-    if (metadata.presentationData == nullptr || metadata.presentationData->frames.empty() || samples.empty()) {
+// Frames per range when a file's per-frame work is split across the batch pool.
+static constexpr size_t kFramesPerTask = 512;
+static constexpr size_t kColumnsPerTask = 256;
+
+// Runs job(first, end) over [0, count) on the batch pool when there is one, otherwise inline.
+template <typename Job>
+void forEachRange(TaskScheduler* pool, const size_t count, const size_t minRangeSize, const Job& job) {
+    if (pool == nullptr) {
+        job(0, count);
+        return;
+    }
+    pool->parallelFor(count, minRangeSize, job);
+}
+
+// Fills values with one row of kConditionFeatureNames per frame, ready for writeFloat32Npy or
+// a BatchDatasetWriter.
+bool buildConditionSlices(const AudioMetadata& metadata,
+                          const SpectralSequence& samples,
+                          std::vector<float>& values,
+                          std::vector<float>* globalFeatureValues,
+                          TaskScheduler* pool) {
+    if (metadata.presentationData == nullptr || metadata.presentationData->frames.empty()) {
         return false;
     }
-    if (metadata.presentationData->frames.size() != samples.size()) {
+    // Without samples the spectra come from the archive's SPEC blocks as they are needed.
+    const bool hydratesBlocks = samples.empty();
+    if (hydratesBlocks ? !hasSpectralBlocks(metadata) : metadata.presentationData->frames.size() != samples.size()) {
         return false;
     }
 
@@ -822,7 +992,7 @@ bool exportConditionSlices(const AudioMetadata& metadata,
                             + (1.0f - emaAlpha) * frames[i].analysis.frameLoudnessDb;
     }
 
-    std::vector<float> values;
+    values.clear();
     values.reserve(frames.size() * kConditionFeatureNames.size());
     std::vector<float> loudnesses;
     std::vector<float> brightnesses;
@@ -841,9 +1011,43 @@ bool exportConditionSlices(const AudioMetadata& metadata,
     std::vector<float> onsetEnvelope;
     std::array<double, kNumChromaBins> chromaAccum{};
 
+    // Each frame's features depend only on its own sample, so they are computed in ranges
+    // up front and gathered in order below.
+    std::vector<FrameFeatureSet> featureSets(frames.size());
+    if (hydratesBlocks) {
+        // Ranges are whole blocks so each is inflated once, and only one range's spectra are
+        // held per task.
+        const size_t blockFrames = metadata.lazyAsset->spectralBlockFrames;
+        const size_t blockCount = (frames.size() + blockFrames - 1) / blockFrames;
+        std::atomic<bool> hydrated{true};
+        forEachRange(pool, blockCount, std::max<size_t>(1, kFramesPerTask / blockFrames),
+            [&](const size_t firstBlock, const size_t endBlock) {
+                const size_t first = firstBlock * blockFrames;
+                const size_t end = std::min(frames.size(), endBlock * blockFrames);
+                SpectralSequence blockSamples;
+                if (!SequenceExporter::hydrateRsynFrames(metadata, first, end - first, blockSamples) ||
+                    blockSamples.size() != end - first) {
+                    hydrated.store(false, std::memory_order_relaxed);
+                    return;
+                }
+                for (size_t index = first; index < end; ++index) {
+                    featureSets[index] = computeFrameFeatures(metadata, blockSamples[index - first]);
+                }
+            });
+        if (!hydrated.load(std::memory_order_relaxed)) {
+            return false;
+        }
+    } else {
+        forEachRange(pool, frames.size(), kFramesPerTask, [&](const size_t first, const size_t end) {
+            for (size_t index = first; index < end; ++index) {
+                featureSets[index] = computeFrameFeatures(metadata, samples[index]);
+            }
+        });
+    }
+
     for (size_t index = 0; index < frames.size(); ++index) {
         const auto& frame = frames[index];
-        const auto featureSet = computeFrameFeatures(metadata, samples[index]);
+        const auto& featureSet = featureSets[index];
         const auto& bandFeatures = featureSet.bandFeatures;
         const auto& stereoFeatures = featureSet.stereoFeatures;
         const auto& pitchFeatures = featureSet.pitchFeatures;
@@ -960,11 +1164,7 @@ bool exportConditionSlices(const AudioMetadata& metadata,
             chromaAccum).values;
     }
 
-    return writeFloat32Npy(
-        outputPath,
-        values,
-        frames.size(),
-        kConditionFeatureNames.size());
+    return true;
 }
 
 bool writeGradientMetadata(const fs::path& outputPath,
@@ -1008,88 +1208,177 @@ bool renderGradientPNG(const std::vector<FrameLab>& frameColours,
                        const std::string& outputPath,
                        int imageWidth,
                        int imageHeight,
-                       const ColourCore::ColourSpace colourSpace) {
+                       const ColourCore::ColourSpace colourSpace,
+                       const int compressionLevel,
+                       TaskScheduler* pool) {
     if (frameColours.empty()) {
         return false;
     }
 
     const int numFrames = static_cast<int>(frameColours.size());
 
-    std::vector<unsigned char> pixels(static_cast<size_t>(imageWidth * imageHeight * 3 * 2));
-
-    for (int px = 0; px < imageWidth; ++px) {
-        // Map output pixel to fractional frame index
-        const float t = (imageWidth > 1)
-            ? (static_cast<float>(px) / static_cast<float>(imageWidth - 1))
-              * static_cast<float>(numFrames - 1)
-            : 0.0f;
-
-        const auto i0   = static_cast<size_t>(t);
-        const auto i1   = std::min(i0 + 1, static_cast<size_t>(numFrames - 1));
-        const float frac = t - static_cast<float>(i0);
-
-        // Interpolate in Lab space
-        const float L    = std::lerp(frameColours[i0].L, frameColours[i1].L, frac);
-        const float labA = std::lerp(frameColours[i0].a, frameColours[i1].a, frac);
-        const float labB = std::lerp(frameColours[i0].b, frameColours[i1].b, frac);
-
-        // Convert Lab → RGB
-        float r = 0.0f, g = 0.0f, b = 0.0f;
-        ColourCore::LabtoRGB(L, labA, labB, r, g, b, colourSpace, true);
-        ColourPresentation::applyOutputPrecision(r, g, b);
-
-        const auto ru = static_cast<uint16_t>(std::clamp(r, 0.0f, 1.0f) * 65535.0f + 0.5f);
-        const auto gu = static_cast<uint16_t>(std::clamp(g, 0.0f, 1.0f) * 65535.0f + 0.5f);
-        const auto bu = static_cast<uint16_t>(std::clamp(b, 0.0f, 1.0f) * 65535.0f + 0.5f);
-
-        // Fill entire column
-        for (int py = 0; py < imageHeight; ++py) {
-            const size_t idx = static_cast<size_t>((py * imageWidth + px) * 6);
-            pixels[idx + 0] = static_cast<unsigned char>((ru >> 8) & 0xff);
-            pixels[idx + 1] = static_cast<unsigned char>(ru & 0xff);
-            pixels[idx + 2] = static_cast<unsigned char>((gu >> 8) & 0xff);
-            pixels[idx + 3] = static_cast<unsigned char>(gu & 0xff);
-            pixels[idx + 4] = static_cast<unsigned char>((bu >> 8) & 0xff);
-            pixels[idx + 5] = static_cast<unsigned char>(bu & 0xff);
+    // Every row of the preview is the same, so only one is built.
+    std::vector<unsigned char> row(static_cast<size_t>(imageWidth) * 3 * 2);
+
+    forEachRange(pool, static_cast<size_t>(imageWidth), kColumnsPerTask, [&](const size_t first, const size_t end) {
+        for (int px = static_cast<int>(first); px < static_cast<int>(end); ++px) {
+            // Map output pixel to fractional frame index
+            const float t = (imageWidth > 1)
+                ? (static_cast<float>(px) / static_cast<float>(imageWidth - 1))
+                  * static_cast<float>(numFrames - 1)
+                : 0.0f;
+
+            const auto i0   = static_cast<size_t>(t);
+            const auto i1   = std::min(i0 + 1, static_cast<size_t>(numFrames - 1));
+            const float frac = t - static_cast<float>(i0);
+
+            // Interpolate in Lab space
+            const float L    = std::lerp(frameColours[i0].L, frameColours[i1].L, frac);
+            const float labA = std::lerp(frameColours[i0].a, frameColours[i1].a, frac);
+            const float labB = std::lerp(frameColours[i0].b, frameColours[i1].b, frac);
+
+            // Convert Lab → RGB
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+            ColourCore::LabtoRGB(L, labA, labB, r, g, b, colourSpace, true);
+            ColourPresentation::applyOutputPrecision(r, g, b);
+
+            const auto ru = static_cast<uint16_t>(std::clamp(r, 0.0f, 1.0f) * 65535.0f + 0.5f);
+            const auto gu = static_cast<uint16_t>(std::clamp(g, 0.0f, 1.0f) * 65535.0f + 0.5f);
+            const auto bu = static_cast<uint16_t>(std::clamp(b, 0.0f, 1.0f) * 65535.0f + 0.5f);
+
+            const size_t idx = static_cast<size_t>(px) * 6;
+            row[idx + 0] = static_cast<unsigned char>((ru >> 8) & 0xff);
+            row[idx + 1] = static_cast<unsigned char>(ru & 0xff);
+            row[idx + 2] = static_cast<unsigned char>((gu >> 8) & 0xff);
+            row[idx + 3] = static_cast<unsigned char>(gu & 0xff);
+            row[idx + 4] = static_cast<unsigned char>((bu >> 8) & 0xff);
+            row[idx + 5] = static_cast<unsigned char>(bu & 0xff);
         }
-    }
+    });
 
-    lodepng::State state;
-    state.info_raw.colortype = LCT_RGB;
-    state.info_raw.bitdepth = 16;
-    state.info_png.color.colortype = LCT_RGB;
-    state.info_png.color.bitdepth = 16;
-    state.encoder.auto_convert = 0;
     // ReSyne's UI and SVG path present these RGB values directly on the display,
     // so batch PNG previews are tagged as sRGB to match the app's visible output.
-    const auto& pngProfile = ColourCore::pngProfileFor(ColourCore::ColourSpace::SRGB);
-    if (pngProfile.useSrgbChunk) {
-        state.info_png.srgb_defined = 1;
-        state.info_png.srgb_intent = pngProfile.renderingIntent;
-    }
-    if (pngProfile.useCicpChunk) {
-        state.info_png.cicp_defined = 1;
-        state.info_png.cicp_color_primaries = pngProfile.colourPrimaries;
-        state.info_png.cicp_transfer_function = pngProfile.transferCharacteristics;
-        state.info_png.cicp_matrix_coefficients = pngProfile.matrixCoefficients;
-        state.info_png.cicp_video_full_range_flag = pngProfile.fullRangeFlag;
-    }
-
-    std::vector<unsigned char> encoded;
-    const unsigned error = lodepng::encode(encoded, pixels, static_cast<unsigned>(imageWidth), static_cast<unsigned>(imageHeight), state);
-    if (error != 0) {
-        return false;
-    }
-    return lodepng::save_file(encoded, outputPath) == 0;
+    return writeRepeatedRowPNG(outputPath,
+                               row,
+                               imageWidth,
+                               imageHeight,
+                               ColourCore::pngProfileFor(ColourCore::ColourSpace::SRGB),
+                               compressionLevel);
 }
 
 struct ExportResult {
     bool exported = false;
+    bool cached = false;
     std::string filename;
     std::string detail;
+    BatchDatasetWriter::Location datasetLocation;  // Set when the condition slices went to a dataset shard
 };
 
+// Held for the whole export regardless of length: decode blocks, analysis scratch and the
+// output buffers that do not grow with the frame count.
+static constexpr size_t kFileFixedCostBytes = size_t{16} << 20;
+// Presentation and smoothing state kept per analysis frame, beside its spectra.
+static constexpr size_t kPresentationBytesPerFrame = 256;
+// Frames in one analysis pass (a 512-frame segment for each of up to 8 frame workers), whose
+// per-channel slabs are held alongside the growing sample list.
+static constexpr size_t kAnalysisPassFrames = 4096;
+// Assumed when a container records no frame count, as a 128 kbit/s MP3 would be.
+static constexpr double kFallbackBytesPerSecond = 16000.0;
+// Inflated bytes per archive byte when an .rsyn's SPEC has to be hydrated whole: its codecs
+// shrink float spectra by at most about this much.
+static constexpr std::uintmax_t kArchiveExpansion = 4;
+
+// Estimated peak bytes while one file is exported, from its header alone. The spectra every
+// analysis frame keeps until the presentation is built dominate, so this is those plus the
+// per-frame outputs and a fixed allowance.
+size_t estimateExportCost(const fs::path& audioPath, const int analysisHop, const std::uintmax_t fileSize) {
+    if (isRsynFile(audioPath)) {
+        return kFileFixedCostBytes + static_cast<size_t>(fileSize * kArchiveExpansion);
+    }
+
+    std::string errorMessage;
+    const auto decoder = AudioDecoding::openStreamingDecoder(audioPath.string(), errorMessage);
+    if (!decoder || decoder->channels() == 0 || decoder->sampleRate() == 0) {
+        // The export will skip it without analysing anything.
+        return kFileFixedCostBytes;
+    }
+
+    std::uint64_t audioFrames = decoder->totalFrames();
+    if (audioFrames == 0) {
+        audioFrames = static_cast<std::uint64_t>(static_cast<double>(fileSize) / kFallbackBytesPerSecond *
+                                                 static_cast<double>(decoder->sampleRate()));
+    }
+
+    const int fftSize = ReSyne::ImportHelpers::DEFAULT_ANALYSIS_FFT_SIZE;
+    const int hop = std::clamp(analysisHop, 1, fftSize);
+    // Longer files fail the import's frame limit before growing past it.
+    const size_t frames = std::min(FFTProcessor::countSignalFrames(static_cast<size_t>(audioFrames), hop),
+                                   ReSyne::ImportHelpers::DEFAULT_MAX_ANALYSIS_FRAMES);
+    const size_t bins = static_cast<size_t>(fftSize / 2 + 1);
+    const size_t spectraBytesPerFrame = decoder->channels() * 2 * bins * sizeof(float);
+    const size_t bytesPerFrame = sizeof(SpectralFrameInfo) + spectraBytesPerFrame + sizeof(FrameLab) +
+                                 kConditionFeatureNames.size() * sizeof(float) + kPresentationBytesPerFrame;
+    return kFileFixedCostBytes + frames * bytesPerFrame +
+           std::min(frames, kAnalysisPassFrames) * spectraBytesPerFrame;
+}
+
+// Everything exportSingleAudioFile writes for one source, before any audio copy.
+std::vector<fs::path> expectedOutputs(const fs::path& gradientsDir,
+                                      const std::string& stem,
+                                      const GradientOutputMode gradientOutputMode,
+                                      const bool writeConditionSidecar,
+                                      const bool writeDatasetShards) {
+    std::vector<fs::path> outputs;
+    const bool writesCondition = exportsRawSlices(gradientOutputMode) ||
+        (exportsPreviewPNG(gradientOutputMode) && writeConditionSidecar);
+    if (writesCondition && !writeDatasetShards) {
+        outputs.push_back(gradientsDir / (stem + ".cond.npy"));
+        outputs.push_back(gradientsDir / (stem + ".cond.json"));
+    }
+    if (exportsPreviewPNG(gradientOutputMode)) {
+        outputs.push_back(gradientsDir / (stem + ".png"));
+    }
+    return outputs;
+}
+
+// Anything that changes what a file exports to, so a cached entry from other settings is
+// never mistaken for this run's output.
+std::string buildCacheSettingsKey(const GradientOutputMode gradientOutputMode,
+                                  const bool writeConditionSidecar,
+                                  const bool trueSize,
+                                  const int width,
+                                  const int height,
+                                  const int analysisHop,
+                                  const bool disableSmoothing,
+                                  const bool writeDatasetShards,
+                                  const bool decimateHighSampleRates) {
+    std::ostringstream key;
+    key << "mode=" << static_cast<int>(gradientOutputMode)
+        << ";sidecar=" << writeConditionSidecar
+        << ";trueSize=" << trueSize
+        << ";width=" << width
+        << ";height=" << height
+        << ";hop=" << analysisHop
+        << ";smoothing=" << !disableSmoothing
+        << ";dataset=" << writeDatasetShards;
+    // Only when set, so caches written before the option existed stay valid.
+    if (decimateHighSampleRates) {
+        key << ";decimate=1";
+    }
+    return key.str();
+}
+
+void copyAudioFile(const fs::path& audioPath, const fs::path& audioOutDir, ExportResult& result) {
+    std::error_code ec;
+    const fs::path audioDest = audioOutDir / audioPath.filename();
+    fs::copy_file(audioPath, audioDest, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        result.detail = "done (warning: audio copy failed - " + ec.message() + ")";
+    }
+}
+
 ExportResult exportSingleAudioFile(const fs::path& audioPath,
+                                   const fs::path& inputRoot,
                                    const fs::path& gradientsDir,
                                    const fs::path& audioOutDir,
                                    bool copyAudio,
@@ -1099,38 +1388,84 @@ ExportResult exportSingleAudioFile(const fs::path& audioPath,
                                    bool writeConditionSidecar,
                                    bool trueSize,
                                    int analysisHop,
-                                   bool disableSmoothing) {
+                                   bool disableSmoothing,
+                                   bool decimateHighSampleRates,
+                                   int pngCompressionLevel,
+                                   TaskScheduler* pool,
+                                   BatchExportCache* cache,
+                                   BatchDatasetWriter* datasetWriter) {
     ExportResult result;
     result.filename = audioPath.filename().string();
     const std::string stem = audioPath.stem().string();
+    // An archive carries its own analysis, so --hop and --decimate-analysis do not apply and
+    // --copy-audio copies the audio beside it, if any.
+    const bool fromArchive = isRsynFile(audioPath);
+    const fs::path copySource = fromArchive ? findAudioTwin(audioPath) : audioPath;
+
+    BatchExportCache::SourceFingerprint fingerprint{};
+    const bool fingerprinted = cache != nullptr && cache->fingerprint(audioPath, fingerprint);
+    if (fingerprinted && cache->isUpToDate(audioPath, fingerprint)) {
+        const auto outputs = expectedOutputs(gradientsDir, stem, gradientOutputMode, writeConditionSidecar,
+                                             datasetWriter != nullptr);
+        const bool outputsPresent = std::all_of(outputs.begin(), outputs.end(), [](const fs::path& output) {
+            std::error_code ec;
+            return fs::exists(output, ec);
+        });
+        if (outputsPresent) {
+            result.exported = true;
+            result.cached = true;
+            result.detail = "unchanged (cached)";
+            std::error_code ec;
+            if (copyAudio && !copySource.empty() && !fs::exists(audioOutDir / copySource.filename(), ec)) {
+                copyAudioFile(copySource, audioOutDir, result);
+            }
+            return result;
+        }
+    }
 
-    std::vector<AudioColourSample> samples;
+    SpectralSequence samples;
     AudioMetadata metadata{};
     std::string errorMessage;
+    std::vector<FrameLab> frameColours;
+    const bool writesCondition =
+        exportsRawSlices(gradientOutputMode) || (exportsPreviewPNG(gradientOutputMode) && writeConditionSidecar);
 
-    const bool imported = ReSyne::ImportHelpers::importAudioFile(
-        audioPath.string(),
-        ColourCore::ColourSpace::Rec2020,
-        true,
-        analysisHop,
-        1.0f, 1.0f, 1.0f,
-        samples, metadata, errorMessage,
-        nullptr,
-        nullptr
-    );
-
-    if (!imported || samples.empty()) {
-        result.detail = "skipped";
-        if (!errorMessage.empty()) {
-            result.detail += " (" + errorMessage + ")";
+    if (fromArchive) {
+        if (!loadRsynInput(audioPath, disableSmoothing, writesCondition, samples, metadata, frameColours, errorMessage)) {
+            result.detail = "skipped (" + errorMessage + ")";
+            return result;
+        }
+    } else {
+        const bool imported = ReSyne::ImportHelpers::importAudioFile(
+            audioPath.string(),
+            ColourCore::ColourSpace::Rec2020,
+            true,
+            analysisHop,
+            1.0f, 1.0f, 1.0f,
+            samples, metadata, errorMessage,
+            nullptr,
+            nullptr,
+            true,
+            true,
+            nullptr,
+            ReSyne::ImportHelpers::DEFAULT_MAX_ANALYSIS_FRAMES,
+            ReSyne::ImportHelpers::DEFAULT_ANALYSIS_FFT_SIZE,
+            {},
+            decimateHighSampleRates
+        );
+
+        if (!imported || samples.empty()) {
+            result.detail = "skipped";
+            if (!errorMessage.empty()) {
+                result.detail += " (" + errorMessage + ")";
+            }
+            return result;
         }
-        return result;
-    }
 
-    std::vector<FrameLab> frameColours;
-    if (!buildFrameColours(samples, metadata, disableSmoothing, frameColours)) {
-        result.detail = "skipped (presentation build failed)";
-        return result;
+        if (!buildFrameColours(samples, metadata, disableSmoothing, frameColours)) {
+            result.detail = "skipped (presentation build failed)";
+            return result;
+        }
     }
 
     const float duration = (metadata.durationSeconds > 0.0)
@@ -1150,29 +1485,58 @@ ExportResult exportSingleAudioFile(const fs::path& audioPath,
     bool exportedCondition = false;
     std::vector<float> globalFeatureValues;
 
-    const fs::path conditionPath = gradientsDir / (stem + ".cond.npy");
-    if (exportsRawSlices(gradientOutputMode) || (exportsPreviewPNG(gradientOutputMode) && writeConditionSidecar)) {
-        if (!exportConditionSlices(metadata, samples, conditionPath, &globalFeatureValues)) {
+    if (writesCondition) {
+        std::vector<float> conditionValues;
+        if (!buildConditionSlices(metadata, samples, conditionValues, &globalFeatureValues, pool)) {
             result.detail = "failed (condition sidecar export error)";
             return result;
         }
-        fs::path conditionMetadataPath = conditionPath;
-        conditionMetadataPath.replace_extension(".json");
-        if (!writeGradientMetadata(
-                conditionMetadataPath,
-                frameColours.size(),
-                duration,
-                metadata,
-                &kConditionFeatureNames,
-                &kGlobalFeatureNames,
-                &globalFeatureValues)) {
-            result.detail = "failed (condition sidecar metadata error)";
-            return result;
+        const size_t featureCount = kConditionFeatureNames.size();
+        const size_t rowCount = conditionValues.size() / featureCount;
+
+        if (datasetWriter != nullptr) {
+            BatchDatasetWriter::Record record;
+            record.source = audioPath.lexically_relative(inputRoot).generic_string();
+            record.values = conditionValues;
+            record.rows = rowCount;
+            record.cols = featureCount;
+            record.durationSeconds = duration;
+            record.sampleRate = metadata.sampleRate;
+            record.hopSize = metadata.hopSize;
+            record.globalFeatureValues = globalFeatureValues;
+            errorMessage.clear();
+            if (!datasetWriter->append(record, result.datasetLocation, errorMessage)) {
+                result.detail = "failed (dataset shard error: " + errorMessage + ")";
+                return result;
+            }
+        } else {
+            const fs::path conditionPath = gradientsDir / (stem + ".cond.npy");
+            if (!writeFloat32Npy(conditionPath, conditionValues, rowCount, featureCount)) {
+                result.detail = "failed (condition sidecar export error)";
+                return result;
+            }
+            fs::path conditionMetadataPath = conditionPath;
+            conditionMetadataPath.replace_extension(".json");
+            if (!writeGradientMetadata(
+                    conditionMetadataPath,
+                    frameColours.size(),
+                    duration,
+                    metadata,
+                    &kConditionFeatureNames,
+                    &kGlobalFeatureNames,
+                    &globalFeatureValues)) {
+                result.detail = "failed (condition sidecar metadata error)";
+                return result;
+            }
         }
 
         exportedCondition = true;
     }
 
+    // The spectra are the bulk of this file's memory and nothing below reads them, so they
+    // go before the preview is rendered rather than when the export returns.
+    samples = SpectralSequence{};
+
     if (exportsPreviewPNG(gradientOutputMode)) {
         const fs::path pngPath = gradientsDir / (stem + ".png");
         if (!renderGradientPNG(
@@ -1180,7 +1544,9 @@ ExportResult exportSingleAudioFile(const fs::path& audioPath,
                 pngPath.string(),
                 imageWidth,
                 imageHeight,
-                metadata.presentationData->settings.colourSpace)) {
+                buildBatchPresentationSettings(disableSmoothing).colourSpace,
+                pngCompressionLevel,
+                pool)) {
             result.detail = "failed (PNG write error)";
             return result;
         }
@@ -1198,18 +1564,94 @@ ExportResult exportSingleAudioFile(const fs::path& audioPath,
         result.detail = "done (PNG)";
     }
 
-    if (copyAudio) {
-        std::error_code ec;
-        const fs::path audioDest = audioOutDir / audioPath.filename();
-        fs::copy_file(audioPath, audioDest, fs::copy_options::overwrite_existing, ec);
-        if (ec) {
-            result.detail = "done (warning: audio copy failed - " + ec.message() + ")";
-        }
+    if (copyAudio && !copySource.empty()) {
+        copyAudioFile(copySource, audioOutDir, result);
+    }
+    if (fingerprinted) {
+        cache->record(audioPath, fingerprint);
     }
 
     return result;
 }
 
+// FNV-1a over the path's UTF-8 bytes, so every machine assigns a file to the same shard
+// whatever its platform or the order its directory listing came back in.
+std::uint64_t stableShardHash(const fs::path& relativePath) {
+    const std::u8string text = relativePath.generic_u8string();
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char8_t byte : text) {
+        hash ^= static_cast<std::uint64_t>(byte);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string shardManifestName(const int shardIndex, const int shardCount) {
+    return "manifest.shard-" + std::to_string(shardIndex) + "-of-" + std::to_string(shardCount) + ".json";
+}
+
+// One shard's record of what it exported, with each track's condition-sidecar metadata
+// inlined so --merge-manifests never has to read the sidecars themselves.
+bool writeShardManifest(const fs::path& manifestPath,
+                        const fs::path& inputRoot,
+                        const fs::path& gradientsDir,
+                        const std::vector<fs::path>& audioFiles,
+                        const std::vector<ExportResult>& results,
+                        const GradientOutputMode gradientOutputMode,
+                        const bool writeConditionSidecar,
+                        const bool writeDatasetShards,
+                        const std::string& settingsKey,
+                        const int shardIndex,
+                        const int shardCount) {
+    nlohmann::json manifest;
+    manifest["schema"] = kShardManifestSchema;
+    manifest["shard_index"] = shardIndex;
+    manifest["shard_count"] = shardCount;
+    manifest["settings_key"] = settingsKey;
+    manifest["feature_names"] = kConditionFeatureNames;
+    manifest["global_feature_names"] = kGlobalFeatureNames;
+
+    nlohmann::json tracks = nlohmann::json::array();
+    for (size_t index = 0; index < audioFiles.size(); ++index) {
+        const ExportResult& result = results[index];
+        nlohmann::json track;
+        track["source"] = audioFiles[index].lexically_relative(inputRoot).generic_string();
+        track["status"] = result.cached ? "cached" : (result.exported ? "exported" : "skipped");
+        track["detail"] = result.detail;
+
+        if (result.exported) {
+            nlohmann::json outputs = nlohmann::json::array();
+            for (const fs::path& output : expectedOutputs(gradientsDir, audioFiles[index].stem().string(),
+                                                          gradientOutputMode, writeConditionSidecar,
+                                                          writeDatasetShards)) {
+                outputs.push_back(output.filename().generic_string());
+                if (output.extension() == ".json") {
+                    std::ifstream sidecar(output);
+                    nlohmann::json condition = nlohmann::json::parse(sidecar, nullptr, false);
+                    if (condition.is_object()) {
+                        condition.erase("feature_names");
+                        condition.erase("global_feature_names");
+                        track["condition"] = std::move(condition);
+                    }
+                }
+            }
+            track["outputs"] = std::move(outputs);
+        }
+        if (!result.datasetLocation.file.empty()) {
+            track["dataset"] = {{"file", result.datasetLocation.file}, {"offset", result.datasetLocation.offset}};
+        }
+        tracks.push_back(std::move(track));
+    }
+    manifest["tracks"] = std::move(tracks);
+
+    std::ofstream stream(manifestPath, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        return false;
+    }
+    stream << manifest.dump(2) << "\n";
+    return stream.good();
+}
+
 } // namespace
 
 int BatchExporter::run(const std::string& inputDir,
@@ -1222,7 +1664,21 @@ int BatchExporter::run(const std::string& inputDir,
                        bool trueSize,
                        int numWorkers,
                        int analysisHop,
-                       bool disableSmoothing) {
+                       bool disableSmoothing,
+                       bool useExportCache,
+                       int shardIndex,
+                       int shardCount,
+                       bool writeDatasetShards,
+                       int pngCompressionLevel,
+                       int memoryBudgetMiB,
+                       int prefetchFiles,
+                       bool decimateHighSampleRates) {
+    if (shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount) {
+        std::cerr << "Error: --shard-index must be in [0, " << std::max(shardCount, 1) - 1
+                  << "] for --shard-count " << shardCount << "\n";
+        return 1;
+    }
+
     const GradientOutputMode gradientOutputMode = parseGradientOutputMode(gradientFormat);
     const std::string gradientFormatLowered = toLower(gradientFormat);
     if (gradientFormatLowered != "png" &&
@@ -1241,7 +1697,7 @@ int BatchExporter::run(const std::string& inputDir,
         return 1;
     }
 
-    // --- Collect audio files ---
+    // --- Collect audio files and .rsyn archives ---
     std::vector<fs::path> audioFiles;
     for (const auto& entry :
          fs::recursive_directory_iterator(inputDir,
@@ -1252,18 +1708,46 @@ int BatchExporter::run(const std::string& inputDir,
             continue;
         }
         if (!entry.is_regular_file()) continue;
-        if (isAudioFile(entry.path())) {
+        if (isAudioFile(entry.path()) || isRsynFile(entry.path())) {
             audioFiles.push_back(entry.path());
         }
     }
 
     if (audioFiles.empty()) {
-        std::cout << "No audio files found in: " << inputDir << "\n";
+        std::cout << "No audio or .rsyn files found in: " << inputDir << "\n";
         return 0;
     }
 
     std::sort(audioFiles.begin(), audioFiles.end());
 
+    // Audio with an archive beside it exports from the archive, which skips the decode and
+    // analysis and writes the same stem.
+    std::vector<fs::path> archives;
+    std::copy_if(audioFiles.begin(), audioFiles.end(), std::back_inserter(archives), isRsynFile);
+    const size_t archivesUsed = std::erase_if(audioFiles, [&](const fs::path& file) {
+        if (isRsynFile(file)) {
+            return false;
+        }
+        fs::path archive = file;
+        archive.replace_extension(".rsyn");
+        return std::binary_search(archives.begin(), archives.end(), archive);
+    });
+    if (archivesUsed > 0) {
+        std::cout << "Using .rsyn archives in place of " << archivesUsed << " audio file(s).\n";
+    }
+
+    const bool sharded = shardCount > 1;
+    if (sharded) {
+        const size_t found = audioFiles.size();
+        const fs::path shardRoot(inputDir);
+        std::erase_if(audioFiles, [&](const fs::path& file) {
+            return stableShardHash(file.lexically_relative(shardRoot)) % static_cast<std::uint64_t>(shardCount) !=
+                static_cast<std::uint64_t>(shardIndex);
+        });
+        std::cout << "Shard " << shardIndex << " of " << shardCount << ": " << audioFiles.size()
+                  << " of " << found << " audio file(s).\n";
+    }
+
     std::cout << "Found " << audioFiles.size() << " audio file(s).\n\n";
     if (trueSize && width > 0) {
         std::cout << "Info: --true-size is enabled; ignoring --width and using analyser frame count.\n\n";
@@ -1294,15 +1778,68 @@ int BatchExporter::run(const std::string& inputDir,
         }
     }
 
+    const std::string settingsKey = buildCacheSettingsKey(
+        gradientOutputMode, writeConditionSidecar, trueSize, width, height, analysisHop, disableSmoothing,
+        writeDatasetShards, decimateHighSampleRates);
+    BatchExportCache exportCache(gradientsDir / ".synesthesia_export_cache", settingsKey);
+    BatchExportCache* cache = useExportCache ? &exportCache : nullptr;
+    if (cache != nullptr) {
+        cache->load();
+    }
+
+    const fs::path inputRoot(inputDir);
+    std::unique_ptr<BatchDatasetWriter> datasetWriter;
+    if (writeDatasetShards) {
+        const std::string prefix = sharded ? "conditions.s" + std::to_string(shardIndex) : "conditions";
+        datasetWriter = std::make_unique<BatchDatasetWriter>(
+            gradientsDir, prefix, kConditionFeatureNames, kGlobalFeatureNames);
+    }
+
     size_t exported = 0;
     size_t skipped = 0;
+    std::atomic<size_t> cachedCount{0};
     const size_t total = audioFiles.size();
-    const size_t workerCount = std::min<size_t>(static_cast<size_t>(std::max(1, numWorkers)), total);
+    std::vector<ExportResult> results(total);
+    // Not capped at the file count: a single long file still spreads across the pool.
+    const size_t workerCount =
+        static_cast<size_t>(numWorkers > 0 ? numWorkers : Utilities::Tuning::batchWorkerCount());
+
+    std::vector<std::uintmax_t> fileSizes(total);
+    for (size_t i = 0; i < total; ++i) {
+        std::error_code sizeError;
+        const std::uintmax_t size = fs::file_size(audioFiles[i], sizeError);
+        fileSizes[i] = sizeError ? 0 : size;
+    }
+    // Reads the files in the order given into the page cache ahead of the workers.
+    const auto makePrefetcher = [&](const std::vector<size_t>& order) -> std::unique_ptr<BatchPrefetcher> {
+        if (prefetchFiles <= 0 || total < 2) {
+            return nullptr;
+        }
+        std::vector<fs::path> files;
+        std::vector<std::uintmax_t> sizes;
+        files.reserve(total);
+        sizes.reserve(total);
+        for (const size_t idx : order) {
+            files.push_back(audioFiles[idx]);
+            sizes.push_back(fileSizes[idx]);
+        }
+        return std::make_unique<BatchPrefetcher>(std::move(files), std::move(sizes),
+                                                 static_cast<size_t>(prefetchFiles),
+                                                 kPrefetchByteWindow, kPrefetchReaders);
+    };
+    std::uintmax_t prefetchedBytes = 0;
 
     if (workerCount == 1) {
+        std::vector<size_t> order(total);
+        std::iota(order.begin(), order.end(), size_t{0});
+        const std::unique_ptr<BatchPrefetcher> prefetcher = makePrefetcher(order);
         for (size_t i = 0; i < total; ++i) {
+            if (prefetcher) {
+                prefetcher->started(i);
+            }
             ExportResult result = exportSingleAudioFile(
                 audioFiles[i],
+                inputRoot,
                 gradientsDir,
                 audioOutDir,
                 copyAudio,
@@ -1312,74 +1849,149 @@ int BatchExporter::run(const std::string& inputDir,
                 writeConditionSidecar,
                 trueSize,
                 analysisHop,
-                disableSmoothing
+                disableSmoothing,
+                decimateHighSampleRates,
+                pngCompressionLevel,
+                nullptr,
+                cache,
+                datasetWriter.get()
             );
 
             std::cout << "[" << (i + 1) << "/" << total << "] "
                       << result.filename << " ... " << result.detail << "\n";
 
+            if (result.cached) {
+                cachedCount.fetch_add(1, std::memory_order_relaxed);
+            }
             if (result.exported) {
                 ++exported;
             } else {
                 ++skipped;
             }
+            results[i] = std::move(result);
+        }
+        if (prefetcher) {
+            prefetchedBytes = prefetcher->prefetchedBytes();
         }
     } else {
         std::cout << "Using " << workerCount << " worker threads.\n\n";
-        std::atomic<size_t> nextIndex{0};
         std::atomic<size_t> exportedAtomic{0};
         std::atomic<size_t> skippedAtomic{0};
         std::mutex outputMutex;
-        std::vector<std::thread> workers;
-        workers.reserve(workerCount);
-
-        for (size_t w = 0; w < workerCount; ++w) {
-            workers.emplace_back([&]() {
-                while (true) {
-                    const size_t idx = nextIndex.fetch_add(1, std::memory_order_relaxed);
-                    if (idx >= total) {
-                        break;
-                    }
 
-                    ExportResult result = exportSingleAudioFile(
-                        audioFiles[idx],
-                        gradientsDir,
-                        audioOutDir,
-                        copyAudio,
-                        width,
-                        height,
-                        gradientOutputMode,
-                        writeConditionSidecar,
-                        trueSize,
-                        analysisHop,
-                        disableSmoothing
-                    );
-
-                    {
-                        std::lock_guard<std::mutex> lock(outputMutex);
-                        std::cout << "[" << (idx + 1) << "/" << total << "] "
-                                  << result.filename << " ... " << result.detail << "\n";
-                    }
+        // Largest files go first, so the long ones are already split across the pool while
+        // the short ones fill in around them rather than leaving one worker on the tail.
+        // Under a memory budget they are ranked by estimated cost, which also sets how much
+        // of the budget each holds.
+        std::unique_ptr<BatchMemoryBudget> memoryBudget;
+        if (memoryBudgetMiB > 0) {
+            memoryBudget = std::make_unique<BatchMemoryBudget>(static_cast<size_t>(memoryBudgetMiB) << 20);
+            std::cout << "Memory budget: " << memoryBudgetMiB << " MiB\n";
+        }
+        std::vector<size_t> fileCosts(total, 0);
+        if (memoryBudget) {
+            for (size_t i = 0; i < total; ++i) {
+                fileCosts[i] = estimateExportCost(audioFiles[i], analysisHop, fileSizes[i]);
+            }
+        }
+        std::vector<size_t> order(total);
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&](const size_t lhs, const size_t rhs) {
+            return memoryBudget ? fileCosts[lhs] > fileCosts[rhs] : fileSizes[lhs] > fileSizes[rhs];
+        });
 
-                    if (result.exported) {
-                        exportedAtomic.fetch_add(1, std::memory_order_relaxed);
-                    } else {
-                        skippedAtomic.fetch_add(1, std::memory_order_relaxed);
-                    }
+        const std::unique_ptr<BatchPrefetcher> prefetcher = makePrefetcher(order);
+        TaskScheduler pool(workerCount);
+        for (size_t position = 0; position < total; ++position) {
+            const size_t idx = order[position];
+            // Blocks here, outside the pool, so waiting files hold neither a worker nor memory.
+            if (memoryBudget) {
+                if (fileCosts[idx] > memoryBudget->budget()) {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cout << "Note: " << audioFiles[idx].filename().string() << " needs about "
+                              << (fileCosts[idx] >> 20) << " MiB, over the memory budget; it will run alone\n";
+                }
+                memoryBudget->acquire(fileCosts[idx]);
+            }
+            pool.submit(TaskPriority::Background, [&, idx, position](const TaskContext&) {
+                if (prefetcher) {
+                    prefetcher->started(position);
+                }
+                ExportResult result = exportSingleAudioFile(
+                    audioFiles[idx],
+                    inputRoot,
+                    gradientsDir,
+                    audioOutDir,
+                    copyAudio,
+                    width,
+                    height,
+                    gradientOutputMode,
+                    writeConditionSidecar,
+                    trueSize,
+                    analysisHop,
+                    disableSmoothing,
+                    decimateHighSampleRates,
+                    pngCompressionLevel,
+                    &pool,
+                    cache,
+                    datasetWriter.get()
+                );
+
+                {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cout << "[" << (idx + 1) << "/" << total << "] "
+                              << result.filename << " ... " << result.detail << "\n";
+                }
+
+                if (result.cached) {
+                    cachedCount.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (result.exported) {
+                    exportedAtomic.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    skippedAtomic.fetch_add(1, std::memory_order_relaxed);
+                }
+                results[idx] = std::move(result);
+                if (memoryBudget) {
+                    memoryBudget->release(fileCosts[idx]);
                 }
             });
         }
-
-        for (auto& worker : workers) {
-            worker.join();
+        pool.waitForAll();
+        if (memoryBudget) {
+            std::cout << "Peak estimated memory in flight: " << (memoryBudget->peakReserved() >> 20) << " MiB\n";
+        }
+        if (prefetcher) {
+            prefetchedBytes = prefetcher->prefetchedBytes();
         }
 
         exported = exportedAtomic.load(std::memory_order_relaxed);
         skipped = skippedAtomic.load(std::memory_order_relaxed);
     }
 
+    if (cache != nullptr && !cache->save()) {
+        std::cerr << "Warning: Could not write the export cache manifest in " << gradientsDir << "\n";
+    }
+
+    if (sharded) {
+        const fs::path manifestPath = gradientsDir / shardManifestName(shardIndex, shardCount);
+        if (!writeShardManifest(manifestPath, inputRoot, gradientsDir, audioFiles, results,
+                                gradientOutputMode, writeConditionSidecar, writeDatasetShards, settingsKey,
+                                shardIndex, shardCount)) {
+            std::cerr << "Error: Could not write the shard manifest " << manifestPath << "\n";
+            return 1;
+        }
+    }
+
     std::cout << "\n=== Export Complete ===\n";
     std::cout << "Exported: " << exported << " gradient(s)\n";
+    if (prefetchedBytes > 0) {
+        std::cout << "Read ahead: " << (prefetchedBytes >> 20) << " MiB before their worker reached them\n";
+    }
+    if (cachedCount.load(std::memory_order_relaxed) > 0) {
+        std::cout << "Cached:   " << cachedCount.load(std::memory_order_relaxed)
+                  << " of them unchanged since the last export\n";
+    }
     if (skipped > 0) {
         std::cout << "Skipped:  " << skipped << " file(s) could not be parsed\n";
     }
@@ -1388,4 +2000,109 @@ int BatchExporter::run(const std::string& inputDir,
     return 0;
 }
 
+std::size_t BatchExporter::estimateFileCost(const std::string& path, const int analysisHop) {
+    std::error_code ec;
+    const std::uintmax_t fileSize = fs::file_size(path, ec);
+    return estimateExportCost(fs::path(path), analysisHop, ec ? 0 : fileSize);
+}
+
+int BatchExporter::mergeManifests(const std::string& inputDir, const std::string& outputDir) {
+    std::error_code ec;
+    if (!fs::exists(inputDir, ec) || !fs::is_directory(inputDir, ec)) {
+        std::cerr << "Error: Input directory does not exist or is not a directory: "
+                  << inputDir << "\n";
+        return 1;
+    }
+
+    std::vector<fs::path> manifestPaths;
+    for (const auto& entry :
+         fs::recursive_directory_iterator(inputDir,
+                                          fs::directory_options::skip_permission_denied,
+                                          ec)) {
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with("manifest.shard-") && name.ends_with(".json")) {
+            manifestPaths.push_back(entry.path());
+        }
+    }
+    std::sort(manifestPaths.begin(), manifestPaths.end());
+
+    if (manifestPaths.empty()) {
+        std::cerr << "Error: No shard manifests found in: " << inputDir << "\n";
+        return 1;
+    }
+
+    nlohmann::json merged;
+    std::vector<bool> shardSeen;
+    nlohmann::json tracks = nlohmann::json::array();
+    for (const fs::path& manifestPath : manifestPaths) {
+        std::ifstream stream(manifestPath);
+        const nlohmann::json manifest = nlohmann::json::parse(stream, nullptr, false);
+        if (!manifest.is_object() || manifest.value("schema", "") != kShardManifestSchema ||
+            !manifest.contains("tracks") || !manifest["tracks"].is_array()) {
+            std::cerr << "Error: Not a shard manifest: " << manifestPath << "\n";
+            return 1;
+        }
+
+        const int shardIndex = manifest.value("shard_index", -1);
+        const int shardCount = manifest.value("shard_count", 0);
+        if (merged.is_null()) {
+            merged["schema"] = kShardManifestSchema;
+            merged["shard_count"] = shardCount;
+            merged["settings_key"] = manifest.value("settings_key", "");
+            merged["feature_names"] = manifest.value("feature_names", nlohmann::json::array());
+            merged["global_feature_names"] = manifest.value("global_feature_names", nlohmann::json::array());
+            shardSeen.assign(static_cast<size_t>(std::max(shardCount, 0)), false);
+        }
+
+        // Shards from different runs would mix exports made with different settings.
+        if (shardCount != merged["shard_count"].get<int>() ||
+            manifest.value("settings_key", "") != merged["settings_key"].get<std::string>() ||
+            manifest.value("global_feature_names", nlohmann::json::array()) != merged["global_feature_names"]) {
+            std::cerr << "Error: " << manifestPath << " comes from a different export run\n";
+            return 1;
+        }
+        if (shardIndex < 0 || shardIndex >= shardCount || shardSeen[static_cast<size_t>(shardIndex)]) {
+            std::cerr << "Error: " << manifestPath << " repeats or misnumbers shard " << shardIndex << "\n";
+            return 1;
+        }
+        shardSeen[static_cast<size_t>(shardIndex)] = true;
+
+        for (const auto& track : manifest["tracks"]) {
+            tracks.push_back(track);
+        }
+    }
+
+    std::sort(tracks.begin(), tracks.end(), [](const nlohmann::json& lhs, const nlohmann::json& rhs) {
+        return lhs.value("source", "") < rhs.value("source", "");
+    });
+
+    nlohmann::json missing = nlohmann::json::array();
+    for (size_t shard = 0; shard < shardSeen.size(); ++shard) {
+        if (!shardSeen[shard]) {
+            missing.push_back(shard);
+        }
+    }
+    if (!missing.empty()) {
+        std::cerr << "Warning: missing shard(s) " << missing.dump() << "; the merged manifest is incomplete\n";
+    }
+    merged["missing_shards"] = std::move(missing);
+    merged["tracks"] = std::move(tracks);
+
+    fs::create_directories(outputDir, ec);
+    const fs::path mergedPath = fs::path(outputDir) / "manifest.json";
+    std::ofstream stream(mergedPath, std::ios::binary | std::ios::trunc);
+    if (!stream || !(stream << merged.dump(2) << "\n")) {
+        std::cerr << "Error: Could not write " << mergedPath << "\n";
+        return 1;
+    }
+
+    std::cout << "Merged " << manifestPaths.size() << " shard manifest(s), "
+              << merged["tracks"].size() << " track(s), into " << fs::absolute(mergedPath) << "\n";
+    return 0;
+}
+
 } // namespace CLI
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 namespace CLI {
 
+// --shard-index and --shard-count split the input across machines by a stable hash of each
+// file's path relative to inputDir, so nodes agree on the split without talking to each other.
+// A memoryBudgetMiB above zero holds files back until their estimated cost fits beside the
+// ones already exporting; zero lets every worker take a file. prefetchFiles is how many files
+// may be read into the page cache ahead of the workers; zero turns the read-ahead off. A
+// numWorkers of zero uses the count a --tune run measured fastest, or one without one.
 class BatchExporter {
 public:
     static int run(const std::string& inputDir,
@@ -16,7 +23,23 @@ public:
                    bool trueSize = false,
                    int numWorkers = 1,
                    int analysisHop = 1024,
-                   bool disableSmoothing = false);
+                   bool disableSmoothing = false,
+                   bool useExportCache = true,
+                   int shardIndex = 0,
+                   int shardCount = 1,
+                   bool writeDatasetShards = false,
+                   int pngCompressionLevel = 6,
+                   int memoryBudgetMiB = 0,
+                   int prefetchFiles = 4,
+                   bool decimateHighSampleRates = false);
+
+    // Combines the shard manifests a sharded run left anywhere under inputDir into
+    // outputDir/manifest.json.
+    static int mergeManifests(const std::string& inputDir, const std::string& outputDir);
+
+    // Estimated peak bytes while one audio or .rsyn input is analysed and exported, from its
+    // header alone: what --memory-budget reserves for it.
+    static std::size_t estimateFileCost(const std::string& path, int analysisHop);
 };
 
 }
@@ -0,0 +1,32 @@
+#include "batch_memory_budget.h"
+
+#include <algorithm>
+
+namespace CLI {
+
+BatchMemoryBudget::BatchMemoryBudget(const std::size_t limitBytes)
+    : budgetBytes(limitBytes) {}
+
+void BatchMemoryBudget::acquire(const std::size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    released.wait(lock, [&] {
+        return reserved == 0 || reserved + bytes <= budgetBytes;
+    });
+    reserved += bytes;
+    peak = std::max(peak, reserved);
+}
+
+void BatchMemoryBudget::release(const std::size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reserved -= std::min(bytes, reserved);
+    }
+    released.notify_all();
+}
+
+std::size_t BatchMemoryBudget::peakReserved() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peak;
+}
+
+}
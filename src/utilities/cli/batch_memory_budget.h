@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace CLI {
+
+// Caps the estimated memory of the files a batch export has in flight at once. The thread
+// that submits file tasks reserves each file's cost before submitting it and blocks while
+// the budget is spent, so files wait in the input list rather than all decoding at once.
+// A file costing more than the whole budget is admitted once nothing else is in flight,
+// so it runs alone instead of never.
+class BatchMemoryBudget {
+public:
+    explicit BatchMemoryBudget(std::size_t limitBytes);
+
+    BatchMemoryBudget(const BatchMemoryBudget&) = delete;
+    BatchMemoryBudget& operator=(const BatchMemoryBudget&) = delete;
+
+    void acquire(std::size_t bytes);
+    void release(std::size_t bytes);
+
+    std::size_t budget() const { return budgetBytes; }
+    // The most that was reserved at once, for the end-of-run summary.
+    std::size_t peakReserved() const;
+
+private:
+    const std::size_t budgetBytes;
+    mutable std::mutex mutex;
+    std::condition_variable released;
+    std::size_t reserved = 0;  // Protected by mutex
+    std::size_t peak = 0;      // Protected by mutex
+};
+
+}
@@ -0,0 +1,126 @@
+#include "batch_prefetcher.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+namespace CLI {
+
+namespace {
+
+constexpr std::size_t kReadChunkBytes = std::size_t{1} << 20;
+
+}
+
+BatchPrefetcher::BatchPrefetcher(std::vector<std::filesystem::path> inputFiles,
+                                 std::vector<std::uintmax_t> fileSizes,
+                                 const std::size_t maxFilesAhead,
+                                 const std::size_t maxBytesAhead,
+                                 const std::size_t readerCount)
+    : files(std::move(inputFiles)),
+      sizes(std::move(fileSizes)),
+      fileWindow(std::max<std::size_t>(1, maxFilesAhead)),
+      byteWindow(maxBytesAhead),
+      startedFiles(files.size(), false),
+      readFiles(files.size(), false) {
+    for (std::size_t index = 0; index < std::max<std::size_t>(1, readerCount); ++index) {
+        readers.emplace_back(&BatchPrefetcher::run, this);
+    }
+}
+
+BatchPrefetcher::~BatchPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+}
+
+void BatchPrefetcher::started(const std::size_t position) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (position >= files.size() || startedFiles[position]) {
+            return;
+        }
+        startedFiles[position] = true;
+        // A file being read still counts ahead until now, so the window stays honest.
+        if (position < next) {
+            bytesAhead -= std::min(bytesAhead, sizes[position]);
+            if (readFiles[position]) {
+                usefulBytes += sizes[position];
+            }
+        }
+        while (startedPrefix < files.size() && startedFiles[startedPrefix]) {
+            ++startedPrefix;
+        }
+    }
+    changed.notify_all();
+}
+
+std::uintmax_t BatchPrefetcher::prefetchedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usefulBytes;
+}
+
+// A file larger than the whole byte window is read once nothing else is ahead, as the
+// memory budget admits an oversized file, so it still gets a head start.
+bool BatchPrefetcher::admits(const std::size_t position) const {
+    return position < startedPrefix + fileWindow &&
+           (bytesAhead == 0 || bytesAhead + sizes[position] <= byteWindow);
+}
+
+bool BatchPrefetcher::abandoned(const std::size_t position) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stopping || startedFiles[position];
+}
+
+void BatchPrefetcher::run() {
+    std::vector<char> chunk(kReadChunkBytes);
+    for (;;) {
+        std::size_t position = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // Files a worker already has are skipped; it is reading them itself.
+            while (next < files.size() && startedFiles[next]) {
+                ++next;
+            }
+            changed.wait(lock, [&] {
+                return stopping || next >= files.size() || startedFiles[next] || admits(next);
+            });
+            if (stopping || next >= files.size()) {
+                return;
+            }
+            if (startedFiles[next]) {
+                continue;
+            }
+            position = next++;
+            bytesAhead += sizes[position];
+        }
+
+        // Read and thrown away: the decoder opens the file by path, so the page cache is
+        // where the bytes are handed over.
+        std::ifstream stream(files[position], std::ios::binary);
+        bool complete = static_cast<bool>(stream);
+        while (complete && !abandoned(position)) {
+            stream.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            if (stream.gcount() <= 0) {
+                break;
+            }
+            complete = !stream.bad();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            readFiles[position] = complete;
+            if (!complete && !startedFiles[position]) {
+                bytesAhead -= std::min(bytesAhead, sizes[position]);
+            }
+        }
+        changed.notify_all();
+    }
+}
+
+}
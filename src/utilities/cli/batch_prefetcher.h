@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CLI {
+
+// The read stage of a batch export: reads the files the workers will take next, in the order
+// they will take them, so their bytes are already in the page cache when a worker decodes
+// them. On network storage the read of one file then overlaps the analysis of those before
+// it. At most fileWindow files, and no more than byteWindow bytes, are read ahead of the
+// workers, so a long batch never evicts pages it is about to use. A worker that reaches a
+// file before it has been read just reads it itself.
+class BatchPrefetcher {
+public:
+    BatchPrefetcher(std::vector<std::filesystem::path> inputFiles,
+                    std::vector<std::uintmax_t> fileSizes,
+                    std::size_t maxFilesAhead,
+                    std::size_t maxBytesAhead,
+                    std::size_t readerCount);
+    ~BatchPrefetcher();
+
+    BatchPrefetcher(const BatchPrefetcher&) = delete;
+    BatchPrefetcher& operator=(const BatchPrefetcher&) = delete;
+
+    // A worker has picked up files[position], which moves the window past it.
+    void started(std::size_t position);
+
+    // Bytes read ahead in time for their worker, for the end-of-run summary.
+    std::uintmax_t prefetchedBytes() const;
+
+private:
+    void run();
+    // True when files[position] may be read now: inside both windows. Caller holds mutex.
+    bool admits(std::size_t position) const;
+    bool abandoned(std::size_t position) const;
+
+    const std::vector<std::filesystem::path> files;
+    const std::vector<std::uintmax_t> sizes;
+    const std::size_t fileWindow;
+    const std::uintmax_t byteWindow;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t next = 0;  // Protected by mutex; the next file to read
+    // Every file before it has been started.
+    std::size_t startedPrefix = 0;  // Protected by mutex
+    std::vector<bool> startedFiles;  // Protected by mutex
+    std::vector<bool> readFiles;  // Protected by mutex
+    // Bytes read, or being read, for files no worker has started yet.
+    std::uintmax_t bytesAhead = 0;  // Protected by mutex
+    std::uintmax_t usefulBytes = 0;  // Protected by mutex
+    bool stopping = false;  // Protected by mutex
+    std::vector<std::thread> readers;
+};
+
+}
@@ -0,0 +1,8 @@
+#include "cli.h"
+#include "misc/benchmark_suite_command.h"
+
+// Entry point for synesthesia_bench. Accepts the same -o flag as --misc benchmark-suite.
+int main(int argc, char* argv[]) {
+    const CLI::Arguments args = CLI::Arguments::parseCommandLine(argc, argv);
+    return CLI::Misc::runBenchmarkSuiteCommand(args);
+}
@@ -25,11 +25,39 @@ Arguments Arguments::parseCommandLine(int argc, char* argv[]) {
         else if (strcmp(argv[i], "--version") == 0 || strcmp(argv[i], "-v") == 0) {
             args.showVersion = true;
         }
+        else if (strcmp(argv[i], "--profile-startup") == 0) {
+            args.profileStartup = true;
+        }
         else if (strcmp(argv[i], "--device") == 0 || strcmp(argv[i], "-d") == 0) {
             if (i + 1 < argc) {
                 args.audioDevice = argv[++i];
             }
         }
+        else if (strcmp(argv[i], "--host-api") == 0) {
+            if (i + 1 < argc) {
+                if (const auto hostApi = AudioStreamConfig::parseHostApi(argv[++i])) {
+                    args.streamSettings.hostApi = *hostApi;
+                } else {
+                    std::cerr << "Unknown host API: " << argv[i] << std::endl;
+                }
+            }
+        }
+        else if (strcmp(argv[i], "--buffer-frames") == 0) {
+            if (i + 1 < argc) {
+                args.streamSettings.framesPerBuffer = std::clamp(std::atoi(argv[++i]), 0, 8192);
+            }
+        }
+        else if (strcmp(argv[i], "--latency-ms") == 0) {
+            if (i + 1 < argc) {
+                args.streamSettings.suggestedLatencySeconds = std::max(0.0, std::atof(argv[++i])) / 1000.0;
+            }
+        }
+        else if (args.threadConfiguration.parseArgument(i, argc, argv)) {
+        }
+        else if (args.telemetryExport.parseArgument(i, argc, argv)) {
+        }
+        else if (args.latencyProbe.parseArgument(i, argc, argv)) {
+        }
         else if (strcmp(argv[i], "--osc-destination") == 0) {
             if (i + 1 < argc) {
                 args.oscDestination = argv[++i];
@@ -47,6 +75,56 @@ Arguments Arguments::parseCommandLine(int argc, char* argv[]) {
                 args.oscReceivePort = std::clamp(args.oscReceivePort, 1, 65535);
             }
         }
+        else if (strcmp(argv[i], "--osc-extra-destination") == 0) {
+            if (i + 1 < argc) {
+                args.oscExtraDestinations.emplace_back(argv[++i]);
+            }
+        }
+        else if (strcmp(argv[i], "--pipeline") == 0) {
+            if (i + 1 < argc) {
+                args.pipelines.emplace_back(argv[++i]);
+            }
+        }
+        else if (strcmp(argv[i], "--shm-output") == 0) {
+            args.sharedMemoryOutput = true;
+        }
+        else if (strcmp(argv[i], "--shm-name") == 0) {
+            if (i + 1 < argc) {
+                args.sharedMemoryName = argv[++i];
+                args.sharedMemoryOutput = true;
+            }
+        }
+        else if (strcmp(argv[i], "--osc-packed") == 0) {
+            args.oscPackedFrames = true;
+        }
+        else if (strcmp(argv[i], "--osc-peaks") == 0) {
+            if (i + 1 < argc) {
+                args.oscPeakTracks = std::clamp(std::atoi(argv[++i]), 0, 256);
+            }
+        }
+        else if (strcmp(argv[i], "--replay-speed") == 0) {
+            if (i + 1 < argc) {
+                args.replaySpeed = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+            }
+        }
+        else if (strcmp(argv[i], "--refresh-rate") == 0) {
+            if (i + 1 < argc) {
+                args.terminalRefreshHz = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+            }
+        }
+        else if (strcmp(argv[i], "--quiet") == 0) {
+            args.quiet = true;
+        }
+        else if (strcmp(argv[i], "--capture-input") == 0) {
+            if (i + 1 < argc) {
+                args.inputCapturePath = argv[++i];
+            }
+        }
+        else if (strcmp(argv[i], "--replay-input") == 0) {
+            if (i + 1 < argc) {
+                args.inputReplayPath = argv[++i];
+            }
+        }
         else if (strcmp(argv[i], "--export-gradients") == 0) {
             args.exportGradients = true;
         }
@@ -112,9 +190,49 @@ Arguments Arguments::parseCommandLine(int argc, char* argv[]) {
                                });
             }
         }
+        else if (strcmp(argv[i], "--decimate-analysis") == 0) {
+            args.decimateAnalysis = true;
+        }
+        else if (strcmp(argv[i], "--tune") == 0) {
+            args.tune = true;
+        }
         else if (strcmp(argv[i], "--disable-smoothing") == 0) {
             args.disableSmoothing = true;
         }
+        else if (strcmp(argv[i], "--no-export-cache") == 0) {
+            args.useExportCache = false;
+        }
+        else if (strcmp(argv[i], "--shard-index") == 0) {
+            if (i + 1 < argc) {
+                args.shardIndex = std::atoi(argv[++i]);
+            }
+        }
+        else if (strcmp(argv[i], "--shard-count") == 0) {
+            if (i + 1 < argc) {
+                args.shardCount = std::atoi(argv[++i]);
+            }
+        }
+        else if (strcmp(argv[i], "--dataset-shards") == 0) {
+            args.writeDatasetShards = true;
+        }
+        else if (strcmp(argv[i], "--memory-budget") == 0) {
+            if (i + 1 < argc) {
+                args.memoryBudgetMiB = std::max(0, std::atoi(argv[++i]));
+            }
+        }
+        else if (strcmp(argv[i], "--prefetch") == 0) {
+            if (i + 1 < argc) {
+                args.prefetchFiles = std::max(0, std::atoi(argv[++i]));
+            }
+        }
+        else if (strcmp(argv[i], "--png-level") == 0) {
+            if (i + 1 < argc) {
+                args.pngCompressionLevel = std::clamp(std::atoi(argv[++i]), 0, 9);
+            }
+        }
+        else if (strcmp(argv[i], "--merge-manifests") == 0) {
+            args.mergeManifests = true;
+        }
         else if (strcmp(argv[i], "--misc-track") == 0) {
             if (i + 1 < argc) {
                 args.miscTrack = argv[++i];
@@ -126,6 +244,17 @@ Arguments Arguments::parseCommandLine(int argc, char* argv[]) {
                                });
             }
         }
+        else if (strcmp(argv[i], "--misc-format") == 0) {
+            if (i + 1 < argc) {
+                args.miscFormat = argv[++i];
+                std::transform(args.miscFormat.begin(),
+                               args.miscFormat.end(),
+                               args.miscFormat.begin(),
+                               [](unsigned char c) {
+                                   return static_cast<char>(std::tolower(c));
+                               });
+            }
+        }
         else if (strcmp(argv[i], "--normalise") == 0) {
             args.normaliseHeight = true;
             args.normaliseLength = true;
@@ -136,6 +265,22 @@ Arguments Arguments::parseCommandLine(int argc, char* argv[]) {
         else if (strcmp(argv[i], "--normalise-length") == 0) {
             args.normaliseLength = true;
         }
+        else if (strcmp(argv[i], "--lod-levels") == 0) {
+            if (i + 1 < argc) {
+                args.gltfLodLevels = std::atoi(argv[++i]);
+                if (args.gltfLodLevels < 0) {
+                    args.gltfLodLevels = 0;
+                }
+            }
+        }
+        else if (strcmp(argv[i], "--glb-float") == 0) {
+            args.glbFloat = true;
+        }
+        else if (strcmp(argv[i], "--vector-tolerance") == 0) {
+            if (i + 1 < argc) {
+                args.vectorTolerance = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+            }
+        }
         else {
             std::cerr << "Unknown argument: " << argv[i] << std::endl;
             std::cerr << "Use --help for usage information." << std::endl;
@@ -152,45 +297,127 @@ void Arguments::printHelp() {
     std::cout << "  --headless, -h          Run in headless mode (no GUI)\n";
     std::cout << "  --enable-osc            Start OSC transport automatically\n";
     std::cout << "  --device, -d <name>     Use specific audio device\n";
+    std::cout << "  --host-api <name>       Audio host API: coreaudio, wasapi, wasapi-exclusive, asio, jack\n";
+    std::cout << "                          or alsa (default: PortAudio's default)\n";
+    std::cout << "  --buffer-frames <n>     Audio buffer size in frames (default: the stream's own)\n";
+    std::cout << "  --latency-ms <ms>       Suggested audio latency (default: the device's low latency)\n";
+    std::cout << "  --realtime              Real-time scheduling for the audio, analysis and OSC threads\n";
+    std::cout << "  --rt-round-robin        Use SCHED_RR rather than SCHED_FIFO on Linux\n";
+    std::cout << "  --rt-priority <n>       Audio thread priority, 21-99 (default: 80; analysis and OSC\n";
+    std::cout << "                          run 10 and 20 below it)\n";
+    std::cout << "  --cpu-audio <n>         Pin the audio callback thread to CPU n\n";
+    std::cout << "  --cpu-analysis <n>      Pin the analysis thread to CPU n\n";
+    std::cout << "  --cpu-osc <n>           Pin the OSC sender thread to CPU n\n";
+    std::cout << "  --keep-denormals        Leave flush-to-zero off on the DSP threads\n";
+    std::cout << "  --decimate-analysis     Decimate input at 88.2 kHz and above to 44.1 or 48 kHz before\n";
+    std::cout << "                          analysing it, live and in imports and batch export\n";
+    std::cout << "  --metrics-file <path>   Write telemetry in the Prometheus text format every interval\n";
+    std::cout << "  --statsd <host[:port]>  Send telemetry to a statsd server (default port: 8125)\n";
+    std::cout << "  --metrics-interval <s>  Telemetry export interval (default: 10)\n";
+    std::cout << "  --latency-probe [impulse|external]\n";
+    std::cout << "                          Time audio from the converters to colour and OSC output, from\n";
+    std::cout << "                          test impulses on the output looped back in (default) or any onset\n";
+    std::cout << "  --latency-report <path> Write the probe's per-stage latencies as JSON on exit\n";
     std::cout << "  --osc-destination <ip>  OSC loopback/private IPv4 destination (default: 127.0.0.1)\n";
     std::cout << "  --osc-send-port <port>  OSC destination port (default: 7000)\n";
     std::cout << "  --osc-receive-port <p>  OSC receive port (default: 7001)\n";
+    std::cout << "  --osc-packed            Send each frame as one /synesthesia/frame/packed message\n";
+    std::cout << "  --osc-peaks <k>         Also send the k strongest spectral peaks of each frame,\n";
+    std::cout << "                          linked into tracks, on /synesthesia/frame/peaks (default: 0)\n";
+    std::cout << "  --osc-extra-destination <ip[:port]>\n";
+    std::cout << "                          Also send to this private or 239.x multicast address\n";
+    std::cout << "                          (repeatable; port defaults to the send port)\n";
+    std::cout << "  --pipeline <dev[@port]> With --headless, analyse this input in its own pipeline\n";
+    std::cout << "                          (repeatable; each sends OSC to its port, default the send\n";
+    std::cout << "                          port plus its position, and receives on the receive port\n";
+    std::cout << "                          plus its position)\n";
+    std::cout << "  --shm-output            Also publish frames to a shared memory ring for local readers\n";
+    std::cout << "  --shm-name <name>       Shared memory region name (default: synesthesia-frames)\n";
+    std::cout << "  --replay-speed <x>      With --headless -i <file> or --replay-input, replay at x times\n";
+    std::cout << "                          real time (default: 1; 0 sends as fast as possible)\n";
+    std::cout << "  --refresh-rate <hz>     With --headless, redraw the status screen at hz, apart from the\n";
+    std::cout << "                          analysis and OSC rates (default: 10; 0 behaves as --quiet)\n";
+    std::cout << "  --quiet                 With --headless, draw no status screen; without --device the\n";
+    std::cout << "                          first input device is used\n";
+    std::cout << "  --capture-input <path>  With --headless, record the input's callback blocks and timing\n";
+    std::cout << "  --replay-input <path>   With --headless, feed a --capture-input recording through the\n";
+    std::cout << "                          analysis instead of an input device\n";
+    std::cout << "  --profile-startup       Print how long each step of GUI start-up took\n";
+    std::cout << "  --tune                  Time the FFT backends at each analysis size, the SIMD levels at\n";
+    std::cout << "                          --hop, and the analysis and batch thread counts, and save the\n";
+    std::cout << "                          fastest to -o or the default wisdom file loaded at start-up\n";
     std::cout << "  --version, -v           Show version information\n";
     std::cout << "  --help                  Show this help message\n\n";
     std::cout << "Batch export:\n";
     std::cout << "  --export-gradients      Batch export gradient images from audio files\n";
-    std::cout << "  --input, -i <dir>       Input directory to scan for audio files\n";
+    std::cout << "  --input, -i <dir>       Input directory to scan for audio files and .rsyn archives;\n";
+    std::cout << "                          an archive is used as analysed, in place of any audio of\n";
+    std::cout << "                          the same name beside it, and ignores --hop\n";
     std::cout << "  --output, -o <dir>      Output directory for gradient PNG images\n";
     std::cout << "  --copy-audio            Also copy audio files alongside gradients\n";
     std::cout << "                          (creates 'gradients/' and 'audio/' subdirectories)\n";
     std::cout << "  --gradient-format <m>   Export mode: png, slices, or both (default: png)\n";
     std::cout << "  --write-condition-sidecar Also write a .cond.npy sidecar when exporting PNGs\n";
+    std::cout << "  --dataset-shards        Append condition arrays to a few memory-mappable .f32 files\n";
+    std::cout << "                          with .index.jsonl indexes instead of one .cond.npy per file\n";
+    std::cout << "  --png-level <0-9>       Deflate level for PNG previews; lower is faster (default: 6)\n";
     std::cout << "  --true-size             Use exact analyser frame count as image width\n";
     std::cout << "                          (no temporal interpolation in export)\n";
     std::cout << "  --disable-smoothing     Use analysis colours instead of active presentation smoothing\n";
-    std::cout << "  --num-workers <n>       Number of worker threads for batch export (default: 1)\n";
+    std::cout << "  --no-export-cache       Re-export every file, even those unchanged since the last\n";
+    std::cout << "                          export into the same output directory\n";
+    std::cout << "  --num-workers <n>       Number of worker threads for batch export (default: the\n";
+    std::cout << "                          --tune count, else 1)\n";
+    std::cout << "  --memory-budget <MiB>   Start a file only once its estimated memory fits beside the\n";
+    std::cout << "                          files already exporting (default: 0, no limit)\n";
+    std::cout << "  --prefetch <n>          Read up to n files ahead of the workers so their decode finds\n";
+    std::cout << "                          them cached; 0 turns it off (default: 4)\n";
+    std::cout << "  --shard-count <n>       Split the input into n shards by a hash of each file's path\n";
+    std::cout << "  --shard-index <i>       Export only shard i (0 to n-1) and write its shard manifest\n";
+    std::cout << "  --merge-manifests       Combine the shard manifests under -i into <-o>/manifest.json\n";
     std::cout << "  --hop <samples>         Analysis hop size in samples (default: 1024)\n";
     std::cout << "  --width <px>            Force gradient width in pixels\n";
     std::cout << "                          (default: 20px per second of audio)\n";
     std::cout << "  --height <px>           Force gradient height in pixels (default: 800)\n\n";
     std::cout << "Misc:\n";
     std::cout << "  --misc <command>        Run a misc export command\n";
-    std::cout << "  --misc-track <mode>     Presentation track for misc output: auto, smoothed, or analysis\n\n";
+    std::cout << "  --misc-track <mode>     Presentation track for misc output: auto, smoothed, or analysis\n";
+    std::cout << "  --misc-format <ext>     Output format when -i is a directory or glob: glb (default) or\n";
+    std::cout << "                          gltf for gltf-gradient; vector-gradient always writes .svg\n\n";
     std::cout << "  --normalise             Shorthand for --normalise-length and --normalise-height\n";
     std::cout << "  --normalise-length      Compress GLTF length to a relaxed compact range\n";
-    std::cout << "  --normalise-height      Normalise GLTF height to a compact 0..1 range\n\n";
+    std::cout << "  --normalise-height      Normalise GLTF height to a compact 0..1 range\n";
+    std::cout << "  --lod-levels <n>        Add up to 4 decimated MSFT_lod levels to .glb output\n";
+    std::cout << "  --glb-float             Keep float32 positions and colours in .glb output instead of\n";
+    std::cout << "                          KHR_mesh_quantization\n";
+    std::cout << "  --vector-tolerance <e>  Fit vector-gradient to linear gradient stops within e of each\n";
+    std::cout << "                          column in Oklab (0.02 is about one just noticeable step);\n";
+    std::cout << "                          0 keeps one exact band per colour\n\n";
     std::cout << "Slice export writes float32 condition arrays as .cond.npy.\n";
     std::cout << "PNG export writes condition sidecars only when --write-condition-sidecar is set.\n\n";
     std::cout << "Misc commands:\n";
     std::cout << "  vector-gradient         Export a lossless SVG strip from an audio or .rsyn presentation track\n";
-    std::cout << "  gltf-gradient           Export a formatted .gltf solid with loudness-driven height\n\n";
+    std::cout << "  gltf-gradient           Export a .gltf solid with loudness-driven height, or stream a\n";
+    std::cout << "                          quantised .glb\n";
+    std::cout << "  Either takes a directory or quoted glob for -i and then writes one file per input under\n";
+    std::cout << "  the -o directory, exporting them concurrently within --memory-budget\n";
+    std::cout << "  fft-benchmark           Time each compiled-in FFT backend at the supported analysis sizes\n";
+    std::cout << "  benchmark-suite         Time the analysis, codec, reconstruction and export kernels on a\n";
+    std::cout << "                          synthetic signal and write JSON results to -o, or stdout\n\n";
     std::cout << "Supported audio formats: .wav, .flac, .mp3, .ogg\n\n";
     std::cout << "Examples:\n";
     std::cout << "  Synesthesia --export-gradients -i ~/Music -o ~/GradientExport\n";
     std::cout << "  Synesthesia --export-gradients -i ~/Music -o ~/Export --copy-audio\n";
     std::cout << "  Synesthesia --export-gradients -i ~/Music -o ~/Export --disable-smoothing\n";
+    std::cout << "  Synesthesia --export-gradients -i ~/Music -o ~/Export --shard-index 2 --shard-count 8\n";
+    std::cout << "  Synesthesia --merge-manifests -i ~/Export -o ~/Export\n";
+    std::cout << "  Synesthesia --headless -i ~/track.wav --replay-speed 4 --osc-destination 10.0.0.20\n";
+    std::cout << "  Synesthesia --headless --replay-input ~/rig.syncap --replay-speed 0 --enable-osc\n";
     std::cout << "  Synesthesia --misc vector-gradient -i ~/track.rsyn -o ~/track.svg\n";
-    std::cout << "  Synesthesia --misc gltf-gradient -i ~/track.wav -o ~/track.gltf --normalise\n\n";
+    std::cout << "  Synesthesia --misc vector-gradient -i ~/track.rsyn -o ~/track.svg --vector-tolerance 0.01\n";
+    std::cout << "  Synesthesia --misc gltf-gradient -i ~/track.wav -o ~/track.gltf --normalise\n";
+    std::cout << "  Synesthesia --misc gltf-gradient -i ~/track.rsyn -o ~/track.glb --lod-levels 3\n";
+    std::cout << "  Synesthesia --misc gltf-gradient -i \"$HOME/Library/*.rsyn\" -o ~/Meshes --memory-budget 4096\n\n";
 }
 
 void Arguments::printVersion() {
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+#include "audio_stream_settings.h"
+#include "utilities/telemetry/latency_probe.h"
+#include "utilities/telemetry/telemetry_exporter.h"
+#include "utilities/threading/realtime_thread.h"
 
 namespace CLI {
 
@@ -9,10 +15,28 @@ struct Arguments {
     bool enableOSC = false;
     bool showHelp = false;
     bool showVersion = false;
+    bool profileStartup = false;
+    bool decimateAnalysis = false;  // --decimate-analysis, live input and imports alike
+    bool tune = false;  // --tune, writing the wisdom to -o or its default path
     std::string audioDevice;
+    AudioStreamSettings streamSettings;
+    Utilities::Threading::ThreadConfiguration threadConfiguration;
+    Utilities::Telemetry::ExportConfig telemetryExport;
+    Utilities::Telemetry::LatencyProbe::Config latencyProbe;
     std::string oscDestination = "127.0.0.1";
     int oscSendPort = 7000;
     int oscReceivePort = 7001;
+    bool oscPackedFrames = false;
+    std::vector<std::string> oscExtraDestinations;
+    int oscPeakTracks = 0;  // --osc-peaks, 0 sends none
+    std::vector<std::string> pipelines;  // --pipeline <device[@port]>, one per input device
+    float replaySpeed = 1.0f;
+    float terminalRefreshHz = 10.0f;  // --refresh-rate, with --headless
+    bool quiet = false;               // --quiet, with --headless
+    std::string inputCapturePath;  // --capture-input, with --headless
+    std::string inputReplayPath;   // --replay-input, with --headless
+    bool sharedMemoryOutput = false;
+    std::string sharedMemoryName = "synesthesia-frames";
 
     bool exportGradients = false;
     std::string inputDir;
@@ -20,18 +44,30 @@ struct Arguments {
     bool copyAudio = false;
     bool writeConditionSidecar = false;
     bool trueSize = false;
-    int numWorkers = 1;
+    int numWorkers = 0;  // 0 takes the tuned count, else 1
     int gradientWidth  = 0;
     int gradientHeight = 0;
     int analysisHop = 1024;
     std::string gradientFormat = "png";
     bool disableSmoothing = false;
+    bool useExportCache = true;
+    int shardIndex = 0;
+    int shardCount = 1;
+    bool mergeManifests = false;
+    bool writeDatasetShards = false;
+    int pngCompressionLevel = 6;
+    int memoryBudgetMiB = 0;
+    int prefetchFiles = 4;
 
     bool runMisc = false;
     std::string miscCommand;
     std::string miscTrack = "auto";
+    std::string miscFormat;  // Output format for a directory or glob --input
     bool normaliseHeight = false;
     bool normaliseLength = false;
+    int gltfLodLevels = 0;
+    bool glbFloat = false;
+    float vectorTolerance = 0.0f;
 
     static Arguments parseCommandLine(int argc, char* argv[]);
     static void printHelp();
@@ -0,0 +1,165 @@
+#include "gradient_png_writer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "miniz.h"
+#undef crc32
+
+#include "resyne/encoding/formats/crc32.h"
+
+namespace CLI {
+
+namespace {
+
+constexpr std::array<unsigned char, 8> kPNGSignature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+constexpr int kBytesPerPixel = 6;
+constexpr unsigned char kFilterSub = 1;
+constexpr unsigned char kFilterUp = 2;
+// Both the batch of repeated rows fed to deflate and each IDAT chunk stay under this size.
+constexpr std::size_t kStreamBufferSize = std::size_t{256} << 10;
+
+void appendBigEndian32(std::vector<unsigned char>& bytes, const std::uint32_t value) {
+    bytes.push_back(static_cast<unsigned char>(value >> 24));
+    bytes.push_back(static_cast<unsigned char>(value >> 16));
+    bytes.push_back(static_cast<unsigned char>(value >> 8));
+    bytes.push_back(static_cast<unsigned char>(value));
+}
+
+void writeChunk(std::ofstream& file, const char (&type)[5], const unsigned char* data, const std::size_t size) {
+    std::vector<unsigned char> header;
+    header.reserve(8);
+    appendBigEndian32(header, static_cast<std::uint32_t>(size));
+    header.insert(header.end(), type, type + 4);
+
+    std::uint32_t crc = CRC32::update(0, header.data() + 4, 4);
+    if (size > 0) {
+        crc = CRC32::update(crc, data, size);
+    }
+    std::vector<unsigned char> footer;
+    appendBigEndian32(footer, crc);
+
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    if (size > 0) {
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+    file.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+}
+
+void writeChunk(std::ofstream& file, const char (&type)[5], const std::vector<unsigned char>& data) {
+    writeChunk(file, type, data.data(), data.size());
+}
+
+// Runs input through the deflate stream, writing each full output buffer as an IDAT chunk.
+bool deflateInto(std::ofstream& file,
+                 mz_stream& stream,
+                 std::vector<unsigned char>& output,
+                 const unsigned char* input,
+                 const std::size_t size,
+                 const int flush) {
+    stream.next_in = input;
+    stream.avail_in = static_cast<unsigned int>(size);
+    while (true) {
+        const int status = mz_deflate(&stream, flush);
+        if (status != MZ_OK && status != MZ_STREAM_END && status != MZ_BUF_ERROR) {
+            return false;
+        }
+        const std::size_t produced = output.size() - stream.avail_out;
+        const bool finished = status == MZ_STREAM_END;
+        if (stream.avail_out == 0 || (finished && produced > 0)) {
+            writeChunk(file, "IDAT", output.data(), produced);
+            stream.next_out = output.data();
+            stream.avail_out = static_cast<unsigned int>(output.size());
+        }
+        if (finished || (flush != MZ_FINISH && stream.avail_in == 0 && stream.avail_out > 0)) {
+            return true;
+        }
+    }
+}
+
+}
+
+bool writeRepeatedRowPNG(const std::filesystem::path& path,
+                         const std::span<const unsigned char> row,
+                         const int width,
+                         const int height,
+                         const ColourCore::PngProfile& profile,
+                         const int compressionLevel) {
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * kBytesPerPixel;
+    if (width < 1 || height < 1 || row.size() != rowBytes) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(kPNGSignature.data()), kPNGSignature.size());
+
+    std::vector<unsigned char> header;
+    appendBigEndian32(header, static_cast<std::uint32_t>(width));
+    appendBigEndian32(header, static_cast<std::uint32_t>(height));
+    header.push_back(16); // Bit depth
+    header.push_back(2);  // Truecolour
+    header.push_back(0);  // Deflate
+    header.push_back(0);  // Adaptive filtering
+    header.push_back(0);  // No interlace
+    writeChunk(file, "IHDR", header);
+
+    if (profile.useSrgbChunk) {
+        writeChunk(file, "sRGB", {static_cast<unsigned char>(profile.renderingIntent)});
+    }
+    if (profile.useCicpChunk) {
+        writeChunk(file,
+                   "cICP",
+                   {static_cast<unsigned char>(profile.colourPrimaries),
+                    static_cast<unsigned char>(profile.transferCharacteristics),
+                    static_cast<unsigned char>(profile.matrixCoefficients),
+                    static_cast<unsigned char>(profile.fullRangeFlag)});
+    }
+
+    mz_stream stream{};
+    if (mz_deflateInit(&stream, std::clamp(compressionLevel, 0, 9)) != MZ_OK) {
+        return false;
+    }
+    std::vector<unsigned char> output(kStreamBufferSize);
+    stream.next_out = output.data();
+    stream.avail_out = static_cast<unsigned int>(output.size());
+
+    // The first row uses Sub, which turns a smooth gradient into small deltas.
+    std::vector<unsigned char> firstRow(rowBytes + 1);
+    firstRow[0] = kFilterSub;
+    for (std::size_t i = 0; i < rowBytes; ++i) {
+        const unsigned char left = i >= kBytesPerPixel ? row[i - kBytesPerPixel] : 0;
+        firstRow[i + 1] = static_cast<unsigned char>(row[i] - left);
+    }
+    bool ok = deflateInto(file, stream, output, firstRow.data(), firstRow.size(), MZ_NO_FLUSH);
+
+    // Every later row equals the one above it, so under Up it is the filter byte then zeros.
+    const std::size_t rowsPerBatch = std::max<std::size_t>(1, kStreamBufferSize / (rowBytes + 1));
+    std::vector<unsigned char> repeatedRows(std::min(rowsPerBatch, static_cast<std::size_t>(height)) * (rowBytes + 1));
+    for (std::size_t offset = 0; offset < repeatedRows.size(); offset += rowBytes + 1) {
+        repeatedRows[offset] = kFilterUp;
+    }
+    std::size_t remaining = static_cast<std::size_t>(height) - 1;
+    while (ok && remaining > 0) {
+        const std::size_t rows = std::min(remaining, rowsPerBatch);
+        ok = deflateInto(file, stream, output, repeatedRows.data(), rows * (rowBytes + 1), MZ_NO_FLUSH);
+        remaining -= rows;
+    }
+    if (ok) {
+        ok = deflateInto(file, stream, output, nullptr, 0, MZ_FINISH);
+    }
+    mz_deflateEnd(&stream);
+    if (!ok) {
+        return false;
+    }
+
+    writeChunk(file, "IEND", nullptr, 0);
+    return file.good();
+}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "colour/colour_core.h"
+
+namespace CLI {
+
+constexpr int kDefaultPNGCompressionLevel = 6;
+
+// Writes a 16-bit RGB PNG whose height rows all repeat one scanline, as gradient previews do.
+// row is width big-endian RGB16 pixels. Only that row is filtered; every later row is stored
+// with the Up filter as zeros streamed through one deflate pass, so neither the full image nor
+// the full compressed stream is ever held in memory. compressionLevel is 0 to 9, as in zlib.
+bool writeRepeatedRowPNG(const std::filesystem::path& path,
+                         std::span<const unsigned char> row,
+                         int width,
+                         int height,
+                         const ColourCore::PngProfile& profile,
+                         int compressionLevel = kDefaultPNGCompressionLevel);
+
+}
@@ -2,17 +2,28 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <termios.h>
 #include <unistd.h>
 #include <csignal>
+#include <cstdlib>
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <thread>
+#include <utility>
 
+#include "audio/analysis/presentation/sample_sequence.h"
 #include "audio/analysis/presentation/spectral_presentation.h"
 #include "colour/colour_core.h"
 #include "colour/colour_presentation.h"
+#include "resyne/encoding/formats/rsyn_presentation.h"
+#include "resyne/recorder/import_helpers.h"
+#include "resyne/recorder/memory_usage.h"
 #include "ui/smoothing/smoothing_features.h"
+#include "utilities/telemetry/latency_probe.h"
+#include "utilities/telemetry/telemetry.h"
+#include "utilities/threading/realtime_thread.h"
 
 #ifdef ENABLE_OSC
 #include "synesthesia_osc_integration.h"
@@ -20,6 +31,47 @@
 
 namespace CLI {
 
+namespace {
+
+// OSC frames go out from the frame thread as each hop is analysed, whatever the terminal
+// refresh rate or this are set to.
+constexpr auto kKeypressPollInterval = std::chrono::milliseconds(16);
+
+// The total and every subsystem holding anything, current / peak.
+void printMemoryUsage(std::ostream& out, const Utilities::Telemetry::Snapshot& telemetry) {
+    out << std::fixed << std::setprecision(1) << "Memory: " << telemetry.totalMemory.megabytes() << " / "
+        << telemetry.totalMemory.peakMegabytes() << " MB";
+    for (size_t index = 0; index < Utilities::Telemetry::kMemoryCount; ++index) {
+        const auto memory = static_cast<Utilities::Telemetry::Memory>(index);
+        const Utilities::Telemetry::MemorySample& sample = telemetry.memoryUsage(memory);
+        if (sample.peakBytes > 0) {
+            out << " | " << Utilities::Telemetry::name(memory) << " " << sample.megabytes() << " / "
+                << sample.peakMegabytes();
+        }
+    }
+    out << "\n";
+}
+
+#ifdef ENABLE_OSC
+Synesthesia::OSC::OSCSmoothingSignals toOSCSmoothingSignals(const RSYNSmoothingSignals& signals) {
+    Synesthesia::OSC::OSCSmoothingSignals output{};
+    output.onsetDetected = signals.onsetDetected;
+    output.spectralFlux = signals.spectralFlux;
+    output.spectralFlatness = signals.spectralFlatness;
+    output.loudnessNormalised = signals.loudnessNormalised;
+    output.brightnessNormalised = signals.brightnessNormalised;
+    output.spectralSpreadNorm = signals.spectralSpreadNorm;
+    output.spectralRolloffNorm = signals.spectralRolloffNorm;
+    output.spectralCrestNorm = signals.spectralCrestNorm;
+    output.phaseInstabilityNorm = signals.phaseInstabilityNorm;
+    output.phaseCoherenceNorm = signals.phaseCoherenceNorm;
+    output.phaseTransientNorm = signals.phaseTransientNorm;
+    return output;
+}
+#endif
+
+}
+
 HeadlessInterface* HeadlessInterface::instance = nullptr;
 
 HeadlessInterface::HeadlessInterface() 
@@ -33,6 +85,14 @@ HeadlessInterface::~HeadlessInterface() {
     instance = nullptr;
 }
 
+void HeadlessInterface::setTerminalRefresh(const float refreshHz, const bool quiet) {
+    quiet_ = quiet || refreshHz <= 0.0f;
+    if (!quiet_) {
+        renderInterval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / static_cast<double>(refreshHz)));
+    }
+}
+
 void HeadlessInterface::signalHandler(int /* signal */) {
     if (instance) {
         instance->running = false;
@@ -66,23 +126,40 @@ void HeadlessInterface::restoreTerminal() {
 
 void HeadlessInterface::run(bool enableOSC, const std::string& preferredDevice,
                             const std::string& oscDestination,
-                            const uint16_t oscSendPort, const uint16_t oscReceivePort) {
+                            const uint16_t oscSendPort, const uint16_t oscReceivePort,
+                            const bool oscPackedFrames,
+                            const std::vector<std::string>& oscExtraDestinations,
+                            const AudioStreamSettings& streamSettings) {
     running = true;
     oscEnabled = enableOSC;
     oscDestination_ = oscDestination;
     oscSendPort_ = oscSendPort;
     oscReceivePort_ = oscReceivePort;
+    oscPackedFrames_ = oscPackedFrames;
+    oscExtraDestinations_ = oscExtraDestinations;
+    streamSettings_ = streamSettings;
+    if (streamSettings_.hostApi != AudioStreamSettings::HostApi::Default) {
+        devices = AudioInput::getInputDevices(streamSettings_.hostApi);
+    }
+    
+    if (!inputReplayPath_.empty() && !startInputReplay()) {
+        return;
+    }
     
     setupTerminal();
 
-    std::cout << "\033[2J\033[H\033[?25l";
-    if (!preferredDevice.empty()) {
+    if (!quiet_) {
+        std::cout << "\033[?25l";
+    }
+    terminal.invalidate();
+    if (!preferredDevice.empty() && !replaying) {
         for (size_t i = 0; i < devices.size(); ++i) {
             if (devices[i].name.find(preferredDevice) != std::string::npos) {
                 selectedDeviceIndex = static_cast<int>(i);
                 deviceSelected = true;
-                if (audioInput.initStream(devices[i].paIndex)) {
+                if (audioInput.initStream(devices[i].paIndex, 1, streamSettings_)) {
                     std::cout << "Using preferred device: " << devices[i].name << std::endl;
+                    startInputCapture();
                 } else {
                     std::cout << "Failed to initialise preferred device, falling back to selection" << std::endl;
                     deviceSelected = false;
@@ -92,29 +169,63 @@ void HeadlessInterface::run(bool enableOSC, const std::string& preferredDevice,
             }
         }
     }
+    if (quiet_ && !deviceSelected) {
+        if (devices.empty() || !audioInput.initStream(devices.front().paIndex, 1, streamSettings_)) {
+            std::cerr << "No input device could be opened; --quiet needs --device or the first device" << std::endl;
+            restoreTerminal();
+            return;
+        }
+        selectedDeviceIndex = 0;
+        deviceSelected = true;
+        std::cout << "Using device: " << devices.front().name << std::endl;
+        startInputCapture();
+    }
     
 #ifdef ENABLE_OSC
     if (oscEnabled) {
         startOSCTransport();
     }
 #endif
+    startLatencyProbe();
     
     if (!deviceSelected && selectedDeviceIndex == -1) {
         selectedDeviceIndex = 0;
     }
     
+    frameThreadStopping = false;
+    frameThread = std::thread(&HeadlessInterface::runFrameLoop, this);
+    
+    auto nextRender = std::chrono::steady_clock::now();
     while (running) {
-        if (!deviceSelected) {
-            displayDeviceSelection();
-        } else {
-            displayFrequencyInfo();
+        const auto now = std::chrono::steady_clock::now();
+        if (!quiet_ && now >= nextRender) {
+            if (!deviceSelected) {
+                displayDeviceSelection();
+            } else {
+                displayFrequencyInfo();
+            }
+            nextRender = now + renderInterval_;
+        }
+        
+        if (probeOutput && Utilities::Telemetry::LatencyProbe::impulseDue()) {
+            probeOutput->queueImpulse();
         }
         
         handleKeypress();
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        std::this_thread::sleep_for(kKeypressPollInterval);
     }
     
-    std::cout << "\033[?25h\033[2J\033[H";
+    replayStopping = true;
+    if (replayThread.joinable()) {
+        replayThread.join();
+    }
+    frameThreadStopping = true;
+    audioInput.getAudioProcessor().wakeFrameWaiters();
+    frameThread.join();
+    
+    if (!quiet_) {
+        std::cout << "\033[?25h\033[2J\033[H";
+    }
     
 #ifdef ENABLE_OSC
     if (oscEnabled) {
@@ -123,201 +234,413 @@ void HeadlessInterface::run(bool enableOSC, const std::string& preferredDevice,
 #endif
     
     restoreTerminal();
+    finishInputCapture();
+    finishInputReplay();
+    finishLatencyProbe();
+}
+
+int HeadlessInterface::replayFile([[maybe_unused]] const std::string& audioPath,
+                                  [[maybe_unused]] const float replaySpeed,
+                                  [[maybe_unused]] const int analysisHop,
+                                  [[maybe_unused]] const std::string& oscDestination,
+                                  [[maybe_unused]] const uint16_t oscSendPort,
+                                  [[maybe_unused]] const uint16_t oscReceivePort,
+                                  [[maybe_unused]] const bool oscPackedFrames,
+                                  [[maybe_unused]] const std::vector<std::string>& oscExtraDestinations) {
+#ifdef ENABLE_OSC
+    oscDestination_ = oscDestination;
+    oscSendPort_ = oscSendPort;
+    oscReceivePort_ = oscReceivePort;
+    oscPackedFrames_ = oscPackedFrames;
+    oscExtraDestinations_ = oscExtraDestinations;
+
+    std::cout << "Analysing " << audioPath << "..." << std::endl;
+    SpectralSequence samples;
+    AudioMetadata metadata{};
+    std::string errorMessage;
+    if (!ReSyne::ImportHelpers::importAudioFile(audioPath, oscColourSpace, oscGamutMappingEnabled, analysisHop,
+                                                1.0f, 1.0f, 1.0f, samples, metadata, errorMessage, nullptr, nullptr,
+                                                true, true, nullptr,
+                                                ReSyne::ImportHelpers::DEFAULT_MAX_ANALYSIS_FRAMES,
+                                                ReSyne::ImportHelpers::DEFAULT_ANALYSIS_FFT_SIZE, {},
+                                                decimateAnalysis_) ||
+        samples.empty()) {
+        std::cerr << "Failed to analyse " << audioPath
+                  << (errorMessage.empty() ? std::string() : ": " + errorMessage) << std::endl;
+        return 1;
+    }
+
+    RSYNPresentationSettings presentationSettings{};
+    presentationSettings.colourSpace = oscColourSpace;
+    presentationSettings.applyGamutMapping = oscGamutMappingEnabled;
+    presentationSettings.smoothingEnabled = smoothingEnabled;
+    presentationSettings.smoothingAmount = colourSmoothingSpeed;
+    const auto presentation = RSYNPresentation::buildPresentationData(samples, presentationSettings);
+    if (presentation == nullptr || presentation->frames.size() != samples.size()) {
+        std::cerr << "Failed to build the presentation track for " << audioPath << std::endl;
+        return 1;
+    }
+
+    // Every frame is built before the clock starts, so replay only has to keep time.
+    SpectralPresentation::Settings settings{};
+    settings.colourSpace = oscColourSpace;
+    settings.applyGamutMapping = oscGamutMappingEnabled;
+    std::vector<Synesthesia::OSC::OSCFrameData> frames;
+    std::vector<int64_t> frameOffsetsMicros;
+    frames.reserve(samples.size());
+    frameOffsetsMicros.reserve(samples.size());
+    SpectralPresentation::SampleSequence::Workspace workspace;
+    SpectralPresentation::PreparedFrame preparedFrame;
+    for (size_t index = 0; index < samples.size(); ++index) {
+        const SpectralFrame sample = samples[index];
+        const SpectralFrame previousSample = index > 0 ? samples[index - 1] : SpectralFrame{};
+        const RSYNPresentationFrame& presented = presentation->frames[index];
+        const auto mixedFrame = SpectralPresentation::SampleSequence::prepareSampleFrame(
+            workspace, sample, settings, preparedFrame, index > 0 ? &previousSample : nullptr);
+
+        Synesthesia::OSC::OSCFrameUpdate update{};
+        update.magnitudes = std::span<const float>(preparedFrame.visualiserMagnitudes.data(),
+                                                   preparedFrame.visualiserMagnitudes.size());
+        update.phases = std::span<const float>(mixedFrame.phases.data(), mixedFrame.phases.size());
+        update.sampleRate = sample.sampleRate;
+        update.colourResult = preparedFrame.colourResult;
+        update.displayColour = ColourCore::RGB{presented.smoothedDisplayRgb[0],
+                                               presented.smoothedDisplayRgb[1],
+                                               presented.smoothedDisplayRgb[2]};
+        ColourPresentation::applyOutputPrecision(update.displayColour.r, update.displayColour.g,
+                                                 update.displayColour.b);
+        update.analysisSignals = Synesthesia::OSC::buildAnalysisSignals(
+            std::isfinite(sample.loudnessLUFS) ? sample.loudnessLUFS : -200.0f,
+            presented.smoothingSignals.spectralFlux,
+            presented.smoothingSignals.onsetDetected);
+        update.smoothingSignals = toOSCSmoothingSignals(presented.smoothingSignals);
+        frames.push_back(Synesthesia::OSC::buildFrameData(update));
+        frameOffsetsMicros.push_back(static_cast<int64_t>(std::llround(std::max(0.0, sample.timestamp) * 1e6)));
+    }
+
+    Utilities::Telemetry::setBytes(Utilities::Telemetry::Memory::RecorderSamples,
+                                   ReSyne::RecorderMemory::sampleBytes(samples));
+    Utilities::Telemetry::setBytes(Utilities::Telemetry::Memory::PresentationFrames,
+                                   presentation->frames.capacity() * sizeof(RSYNPresentationFrame));
+
+    if (!startOSCTransport()) {
+        return 1;
+    }
+
+    running = true;
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
+    const auto replayStart = std::chrono::steady_clock::now();
+    // The same clock and epoch OSC frames are normally stamped with, so a 1x replay reports
+    // meaningful send latency. Faster replays stamp frames ahead of the wall clock.
+    const int64_t replayStartMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        replayStart.time_since_epoch()).count();
+    auto nextProgress = replayStart;
+    size_t sent = 0;
+    for (; sent < frames.size() && running; ++sent) {
+        if (replaySpeed > 0.0f) {
+            const auto due = replayStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::micro>(static_cast<double>(frameOffsetsMicros[sent]) / replaySpeed));
+            std::this_thread::sleep_until(due);
+        }
+
+        Synesthesia::OSC::OSCFrameData& frame = frames[sent];
+        frame.meta.frameTimestamp = replayStartMicros + frameOffsetsMicros[sent];
+        osc.waitForPendingFrame();
+        osc.sendFrameData(frame);
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= nextProgress) {
+            std::cout << "\rReplayed " << sent + 1 << " / " << frames.size() << " frames" << std::flush;
+            nextProgress = now + std::chrono::milliseconds(500);
+        }
+    }
+    osc.waitForPendingFrame();
+
+    const float wallSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - replayStart).count();
+    const float mediaSeconds = sent > 0 ? static_cast<float>(frameOffsetsMicros[sent - 1]) / 1e6f : 0.0f;
+    const auto stats = osc.getStats();
+    std::cout << "\rReplayed " << sent << " / " << frames.size() << " frames in "
+              << std::fixed << std::setprecision(2) << wallSeconds << " s ("
+              << (wallSeconds > 0.0f ? mediaSeconds / wallSeconds : 0.0f) << "x real time)\n";
+    std::cout << "OSC frames sent: " << stats.framesSent
+              << " | Coalesced: " << stats.framesCoalesced
+              << " | Dropped: " << stats.framesDropped << std::endl;
+    printMemoryUsage(std::cout, Utilities::Telemetry::snapshot());
+
+    stopOSCTransport();
+    return sent == frames.size() ? 0 : 1;
+#else
+    std::cerr << "File replay needs OSC transport, which this build does not include" << std::endl;
+    return 1;
+#endif
 }
 
 void HeadlessInterface::displayDeviceSelection() {
-    std::cout << "\033[2J\033[H";
-    
-    std::cout << "=== SYNESTHESIA ===\n\n";
+    std::ostringstream& out = terminal.beginFrame();
+    out << "=== SYNESTHESIA ===\n\n";
     
     if (devices.empty()) {
-        std::cout << "No audio input devices found.\n";
-        std::cout << "Press 'q' to quit.\n";
-        std::cout.flush();
+        out << "No audio input devices found.\n";
+        out << "Press 'q' to quit.\n";
+        terminal.present();
         return;
     }
     
-    std::cout << "Available audio input devices:\n\n";
+    out << "Available audio input devices:\n\n";
     
     for (size_t i = 0; i < devices.size(); ++i) {
         if (static_cast<int>(i) == selectedDeviceIndex) {
-            std::cout << "  > ";
+            out << "  > ";
         } else {
-            std::cout << "    ";
+            out << "    ";
         }
         
-        std::cout << i + 1 << ". " << devices[i].name;
-        std::cout << " (" << devices[i].maxChannels << " channels)\n";
+        out << i + 1 << ". " << devices[i].name;
+        out << " (" << devices[i].maxChannels << " channels)\n";
     }
     
-    std::cout << "\n";
-    std::cout << "Controls:\n";
-    std::cout << "  ↑/↓ - Navigate devices\n";
-    std::cout << "  Enter - Select device\n";
+    out << "\n";
+    out << "Controls:\n";
+    out << "  ↑/↓ - Navigate devices\n";
+    out << "  Enter - Select device\n";
 #ifdef ENABLE_OSC
-    std::cout << "  'o' - Toggle OSC transport (" << (oscEnabled ? "ON" : "OFF") << ")\n";
+    out << "  'o' - Toggle OSC transport (" << (oscEnabled ? "ON" : "OFF") << ")\n";
 #endif
-    std::cout << "  'q' - Quit\n";
+    out << "  'q' - Quit\n";
     
-    std::cout.flush();
+    terminal.present();
 }
 
-void HeadlessInterface::displayFrequencyInfo() {
-	const auto& magnitudes = audioInput.getFFTProcessor().getMagnitudesBuffer();
-	const auto& phases = audioInput.getFFTProcessor().getPhaseBuffer();
-	const float loudnessDb = audioInput.getFFTProcessor().getMomentaryLoudnessLUFS();
-    std::vector<float> visualiserMagnitudes;
-
-    float currentDominantFreq = 0.0f;
-    float currentR = 0.0f, currentG = 0.0f, currentB = 0.0f;
-
-	float currentLoudnessDb = loudnessDb;
-	if (!magnitudes.empty() && !phases.empty()) {
-        SpectralPresentation::Settings settings{};
-        settings.colourSpace = oscColourSpace;
-        settings.applyGamutMapping = oscGamutMappingEnabled;
-
-        SpectralPresentation::Frame frame{};
-        frame.magnitudes = magnitudes;
-        frame.phases = phases;
-        frame.sampleRate = audioInput.getSampleRate();
-
-        const uint64_t frameCounter = audioInput.getFFTProcessor().getFrameCounter();
-        const bool hasNewFrame = !hasPreviousFrame || frameCounter != previousFrameCounter;
-        const auto preparedFrame = SpectralPresentation::prepareFrame(
-            frame,
-            settings,
-            loudnessDb,
-            hasNewFrame && hasPreviousFrame ? &previousFrame : nullptr,
-            frame.sampleRate > 0.0f
-                ? static_cast<float>(audioInput.getFFTProcessor().getHopSize()) / frame.sampleRate
-                : (1.0f / 60.0f));
-        visualiserMagnitudes = preparedFrame.visualiserMagnitudes;
-        if (hasNewFrame) {
-            previousFrame = frame;
-            previousFrameCounter = frameCounter;
-            hasPreviousFrame = true;
+void HeadlessInterface::runFrameLoop() {
+    AudioProcessor& processor = audioInput.getAudioProcessor();
+    for (;;) {
+        // Read before draining, so a buffer pushed mid-drain still wakes the wait below.
+        const uint64_t seenGeneration = processor.bufferedFrameGeneration();
+        processor.borrowBufferedFrames(borrowedFrames);
+        if (deviceSelected && !borrowedFrames.empty() && !borrowedFrames.front().empty()) {
+            int hopSize = 0;
+            int64_t captureMicros = 0;
+            {
+                const auto spectralData = audioInput.acquireSpectralData();
+                hopSize = spectralData->hopSize;
+                captureMicros = spectralData->captureTimestampMicros;
+            }
+            for (const FFTProcessor::FrameView& view : borrowedFrames.front()) {
+                const float hopSeconds = view.sampleRate > 0.0f
+                    ? static_cast<float>(hopSize) / view.sampleRate
+                    : (1.0f / 60.0f);
+                processAnalysisFrame(view, hopSeconds);
+            }
+            // Colours and smoothing are one step here, and the batch ends no earlier than the
+            // frame published when it was borrowed.
+            namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+            LatencyProbe::frameReached(LatencyProbe::Stage::Colour, captureMicros);
+            LatencyProbe::frameReached(LatencyProbe::Stage::Smoothing, captureMicros);
+        }
+        processor.releaseBufferedFrames(borrowedFrames);
+        if (frameThreadStopping.load(std::memory_order_acquire)) {
+            return;
         }
-		auto colourResult = preparedFrame.colourResult;
+        processor.waitForBufferedFrames(seenGeneration);
+    }
+}
 
-		currentDominantFreq = colourResult.dominantFrequency;
-		currentR = colourResult.r;
-		currentG = colourResult.g;
-        currentB = colourResult.b;
-		currentLoudnessDb = colourResult.loudnessDb;
-        auto features = ::UI::Smoothing::buildSignalFeatures(colourResult);
-        features.onsetDetected = audioInput.getFFTProcessor().getOnsetDetected();
-        features.spectralFlux = audioInput.getFFTProcessor().getSpectralFlux();
+void HeadlessInterface::processAnalysisFrame(const FFTProcessor::FrameView& view, const float hopSeconds) {
+    if (view.magnitudes.empty() || view.phases.empty()) {
+        return;
+    }
+
+    SpectralPresentation::Settings settings{};
+    settings.colourSpace = oscColourSpace;
+    settings.applyGamutMapping = oscGamutMappingEnabled;
+
+    SpectralPresentation::FrameView frame{};
+    frame.magnitudes = view.magnitudes;
+    frame.phases = view.phases;
+    frame.sampleRate = view.sampleRate > 0.0f ? view.sampleRate : audioInput.getSampleRate();
+
+    const SpectralPresentation::FrameView previousView = previousFrame.view();
+    SpectralPresentation::prepareFrame(
+        analysisWorkspace,
+        frame,
+        settings,
+        view.loudnessLUFS,
+        hasPreviousFrame ? &previousView : nullptr,
+        hopSeconds,
+        analysisFrame);
+
+    const auto& colourResult = analysisFrame.colourResult;
+    float currentR = colourResult.r;
+    float currentG = colourResult.g;
+    float currentB = colourResult.b;
 
 #ifdef ENABLE_OSC
-        if (oscEnabled) {
-            auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
-            const auto pendingSettings = osc.consumePendingSettings();
-            if (pendingSettings.colourSpace.has_value()) {
-                oscColourSpace = *pendingSettings.colourSpace;
-            }
-            if (pendingSettings.gamutMappingEnabled.has_value()) {
-                oscGamutMappingEnabled = *pendingSettings.gamutMappingEnabled;
-            }
-            if (pendingSettings.smoothingEnabled.has_value()) {
-                smoothingEnabled = *pendingSettings.smoothingEnabled;
-            }
-            if (pendingSettings.colourSmoothingSpeed.has_value()) {
-                colourSmoothingSpeed = *pendingSettings.colourSmoothingSpeed;
-                colourSmoother.setSmoothingAmount(colourSmoothingSpeed);
-            }
-            if (pendingSettings.spectrumSmoothingAmount.has_value()) {
-                spectrumSmoothingAmount = *pendingSettings.spectrumSmoothingAmount;
-            }
-            
-            static auto lastTime = std::chrono::steady_clock::now();
-            auto currentTime = std::chrono::steady_clock::now();
-            float deltaTime = std::chrono::duration_cast<std::chrono::duration<float>>(currentTime - lastTime).count();
-            lastTime = currentTime;
+    if (oscEnabled || Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance().isSharedMemoryOutputRunning()) {
+        auto features = ::UI::Smoothing::buildSignalFeatures(colourResult);
+        features.onsetDetected = view.onsetDetected;
+        features.spectralFlux = view.spectralFlux;
 
-            if (smoothingEnabled) {
-                colourSmoother.setTargetColour(currentR, currentG, currentB);
+        auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
+        const auto pendingSettings = osc.consumePendingSettings();
+        if (pendingSettings.colourSpace.has_value()) {
+            oscColourSpace = *pendingSettings.colourSpace;
+        }
+        if (pendingSettings.gamutMappingEnabled.has_value()) {
+            oscGamutMappingEnabled = *pendingSettings.gamutMappingEnabled;
+        }
+        if (pendingSettings.smoothingEnabled.has_value()) {
+            smoothingEnabled = *pendingSettings.smoothingEnabled;
+        }
+        if (pendingSettings.colourSmoothingSpeed.has_value()) {
+            colourSmoothingSpeed = *pendingSettings.colourSmoothingSpeed;
+            colourSmoother.setSmoothingAmount(colourSmoothingSpeed);
+        }
+        if (pendingSettings.spectrumSmoothingAmount.has_value()) {
+            spectrumSmoothingAmount = *pendingSettings.spectrumSmoothingAmount;
+        }
 
-                if (!manualSmoothing) {
-                    colourSmoother.update(deltaTime * 1.2f, features);
-                } else {
-                    colourSmoother.update(deltaTime * 1.2f);
-                }
+        // Each frame stands for one hop of audio, so the smoother advances by exactly that.
+        if (smoothingEnabled) {
+            colourSmoother.setTargetColour(currentR, currentG, currentB);
 
-                colourSmoother.getCurrentColour(currentR, currentG, currentB);
+            if (!manualSmoothing) {
+                colourSmoother.update(hopSeconds * 1.2f, features);
+            } else {
+                colourSmoother.update(hopSeconds * 1.2f);
             }
 
-            ColourPresentation::applyOutputPrecision(currentR, currentG, currentB);
-
-            Synesthesia::OSC::OSCFrameUpdate update{};
-            update.magnitudes = std::span<const float>(visualiserMagnitudes.data(), visualiserMagnitudes.size());
-            update.phases = std::span<const float>(frame.phases.data(), frame.phases.size());
-            update.sampleRate = frame.sampleRate;
-            update.colourResult = colourResult;
-            update.displayColour = ColourCore::RGB{currentR, currentG, currentB};
-            update.analysisSignals = Synesthesia::OSC::buildAnalysisSignals(
-                loudnessDb,
-                audioInput.getFFTProcessor().getSpectralFlux(),
-                audioInput.getFFTProcessor().getOnsetDetected());
-            update.smoothingSignals = Synesthesia::OSC::buildSmoothingSignals(features);
-            osc.updateFrameData(update);
+            colourSmoother.getCurrentColour(currentR, currentG, currentB);
         }
+
+        ColourPresentation::applyOutputPrecision(currentR, currentG, currentB);
+
+        Synesthesia::OSC::OSCFrameUpdate update{};
+        update.magnitudes = std::span<const float>(analysisFrame.visualiserMagnitudes.data(),
+                                                   analysisFrame.visualiserMagnitudes.size());
+        update.phases = std::span<const float>(frame.phases.data(), frame.phases.size());
+        update.sampleRate = frame.sampleRate;
+        update.colourResult = colourResult;
+        update.displayColour = ColourCore::RGB{currentR, currentG, currentB};
+        update.analysisSignals = Synesthesia::OSC::buildAnalysisSignals(
+            view.loudnessLUFS,
+            view.spectralFlux,
+            view.onsetDetected);
+        update.smoothingSignals = Synesthesia::OSC::buildSmoothingSignals(features);
+        osc.updateFrameData(update);
+    }
 #endif
-	}
+
+    previousFrame.assign(frame);
+    hasPreviousFrame = true;
+
+    std::lock_guard<std::mutex> lock(displayMutex);
+    displayState.dominantFrequency = colourResult.dominantFrequency;
+    displayState.r = currentR;
+    displayState.g = currentG;
+    displayState.b = currentB;
+    displayState.loudnessDb = colourResult.loudnessDb;
+}
+
+void HeadlessInterface::displayFrequencyInfo() {
+    DisplayState current;
+    {
+        std::lock_guard<std::mutex> lock(displayMutex);
+        current = displayState;
+    }
+    const float currentDominantFreq = current.dominantFrequency;
+    float currentR = current.r;
+    float currentG = current.g;
+    float currentB = current.b;
+    const float currentLoudnessDb = current.loudnessDb;
 
     ColourPresentation::applyOutputPrecision(currentR, currentG, currentB);
 
-	bool needsRedraw = (abs(currentDominantFreq - lastDominantFreq) > 0.1f) ||
-					   (abs(currentR - lastR) > 0.001f) ||
-					   (abs(currentG - lastG) > 0.001f) ||
-					   (abs(currentB - lastB) > 0.001f) ||
-					   (abs(currentLoudnessDb - lastLoudnessDb) > 0.1f);
-    
-    if (needsRedraw) {
-        std::cout << "\033[2J\033[H";
-        
-        std::cout << "=== SYNESTHESIA - FREQUENCY ANALYSIS ===\n\n";
-        std::cout << "Device: " << devices[static_cast<size_t>(selectedDeviceIndex)].name << "\n\n";
-
-		if (currentDominantFreq > 0.0f) {
-			std::cout << std::fixed << std::setprecision(1);
-			std::cout << "Spectral Centroid: " << currentDominantFreq << " Hz\n";
-			std::cout << std::setprecision(3);
-			std::cout << "RGB: (" << currentR << ", " << currentG << ", " << currentB << ")\n";
-			std::cout << std::setprecision(1);
-			std::cout << "Loudness: " << currentLoudnessDb << " LUFS\n";
-		} else {
-            std::cout << "Spectral Centroid: -- Hz\n";
-            std::cout << "RGB: (0.000, 0.000, 0.000)\n";
-            std::cout << "\n(No significant frequencies detected)\n";
-        }
-        
+    std::ostringstream& out = terminal.beginFrame();
+    out << "=== SYNESTHESIA - FREQUENCY ANALYSIS ===\n\n";
+    if (replaying) {
+        out << "Replaying: " << inputReplayPath_ << " (" << inputReplay.getChannelCount() << " channels, "
+            << inputReplay.getSampleRate() << " Hz)\n";
+    } else {
+        out << "Device: " << devices[static_cast<size_t>(selectedDeviceIndex)].name << "\n";
+    }
+    const AudioStreamLatency& latency = audioInput.getStreamLatency();
+    out << std::fixed << std::setprecision(1);
+    out << "Input latency: " << latency.latencySeconds * 1000.0 << " ms ("
+        << latency.framesPerBuffer << " frames, " << AudioStreamConfig::hostApiName(latency.hostApi)
+        << ") | Audio to colour: " << audioInput.estimateAnalysisLatencySeconds() * 1000.0 << " ms\n";
+    for (const Utilities::Threading::ThreadRole role : Utilities::Threading::kThreadRoles) {
+        out << "  " << Utilities::Threading::describe(role) << "\n";
+    }
+    using Utilities::Telemetry::Counter;
+    using Utilities::Telemetry::Gauge;
+    using Utilities::Telemetry::Stage;
+    const Utilities::Telemetry::Snapshot telemetry = Utilities::Telemetry::snapshot();
+    out << "Xruns: " << telemetry.counter(Counter::InputOverflows) << " input overflows, "
+        << telemetry.counter(Counter::OutputUnderflows) << " output underflows | Dropped: "
+        << telemetry.counter(Counter::AnalysisBuffersDropped) << " buffers, "
+        << telemetry.counter(Counter::SpectrumFramesDropped) << " frames\n";
+    out << "Analysis queue: " << telemetry.gauge(Gauge::AnalysisQueueDepth) << " buffers, ring "
+        << telemetry.gauge(Gauge::AnalysisRingFill) * 100.0 << "% | Callback last/peak: " << std::setprecision(2)
+        << telemetry.stage(Stage::InputCallback).lastMs() << " / "
+        << telemetry.stage(Stage::InputCallback).peakMs() << " ms | Queue to analysed: "
+        << telemetry.stage(Stage::AnalysisQueue).meanMs() << " ms\n";
+    printMemoryUsage(out, telemetry);
+    out << "\n";
+
+    if (currentDominantFreq > 0.0f) {
+        out << std::fixed << std::setprecision(1);
+        out << "Spectral Centroid: " << currentDominantFreq << " Hz\n";
+        out << std::setprecision(3);
+        out << "RGB: (" << currentR << ", " << currentG << ", " << currentB << ")\n";
+        out << std::setprecision(1);
+        out << "Loudness: " << currentLoudnessDb << " LUFS\n";
+    } else {
+        out << "Spectral Centroid: -- Hz\n";
+        out << "RGB: (0.000, 0.000, 0.000)\n";
+        out << "\n(No significant frequencies detected)\n";
+    }
+
 #ifdef ENABLE_OSC
-        if (oscEnabled) {
-            auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
-            const auto stats = osc.getStats();
-            const auto config = osc.getConfig();
-            std::cout << "\nOSC: " << (osc.isRunning() ? "Running" : "Stopped");
-            std::cout << " | Dest: " << config.destinationHost << ":" << config.transmitPort;
-            std::cout << " | Received: " << stats.messagesReceived;
-            std::cout << " | FPS: " << stats.currentFps << "\n";
-        }
+    if (oscEnabled) {
+        auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
+        const auto stats = osc.getStats();
+        const auto config = osc.getConfig();
+        out << "\nOSC: " << (osc.isRunning() ? "Running" : "Stopped");
+        out << " | Dest: " << config.destinationHost << ":" << config.transmitPort;
+        out << " | Received: " << stats.messagesReceived;
+        out << " | FPS: " << stats.currentFps;
+        out << " | Coalesced: " << stats.framesCoalesced;
+        out << " | Dropped: " << stats.framesDropped << "\n";
+        out << "OSC Latency p50/p95/p99: " << std::fixed << std::setprecision(2)
+            << stats.latencyP50Ms << " / " << stats.latencyP95Ms << " / " << stats.latencyP99Ms
+            << " ms | Jitter: " << stats.jitterMs << " ms\n";
+    }
+    if (Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance().isSharedMemoryOutputRunning()) {
+        out << "Shared memory: "
+            << Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance().getSharedMemoryOutputName() << "\n";
+    }
 #endif
-        
-        std::cout << "\nControls: 'b' - Back | ";
+    if (Utilities::Telemetry::LatencyProbe::isRunning()) {
+        namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+        const LatencyProbe::Report report = LatencyProbe::collect();
+        out << "Latency probe (" << LatencyProbe::name(report.source) << "): "
+            << report.trials << " trials | Missed: " << report.missed
+            << " | Analysis/OSC p50: " << std::fixed << std::setprecision(1)
+            << report.stages[static_cast<size_t>(LatencyProbe::Stage::Analysis)].p50Ms << " / "
+            << report.stages[static_cast<size_t>(LatencyProbe::Stage::OSCSend)].p50Ms
+            << " ms | Total p50/p95: " << report.total.p50Ms << " / " << report.total.p95Ms << " ms\n";
+    }
+
+    out << "\nControls: 'b' - Back | ";
 #ifdef ENABLE_OSC
-        std::cout << "'o' - Toggle OSC (" << (oscEnabled ? "ON" : "OFF") << ") | ";
+    out << "'o' - Toggle OSC (" << (oscEnabled ? "ON" : "OFF") << ") | ";
 #endif
-        std::cout << "'q' - Quit\n";
-        
-        std::cout.flush();
-        
-		lastDominantFreq = currentDominantFreq;
-		lastR = currentR;
-		lastG = currentG;
-		lastB = currentB;
-		lastLoudnessDb = currentLoudnessDb;
-	}
+    out << "'q' - Quit\n";
+
+    terminal.present();
 }
 
 void HeadlessInterface::handleKeypress() {
@@ -342,8 +665,11 @@ void HeadlessInterface::handleKeypress() {
                 }
             } else if (ch == '\n' || ch == '\r') {
                 if (selectedDeviceIndex >= 0 && selectedDeviceIndex < static_cast<int>(devices.size())) {
-                    if (audioInput.initStream(devices[static_cast<size_t>(selectedDeviceIndex)].paIndex)) {
+                    if (audioInput.initStream(devices[static_cast<size_t>(selectedDeviceIndex)].paIndex, 1,
+                                              streamSettings_)) {
                         deviceSelected = true;
+                        startInputCapture();
+                        terminal.invalidate();
                     }
                 }
             }
@@ -355,10 +681,11 @@ void HeadlessInterface::handleKeypress() {
                 } else {
                     stopOSCTransport();
                 }
+                terminal.invalidate();
             }
 #endif
         } else {
-            if (ch == 'b' || ch == 'B') {
+            if ((ch == 'b' || ch == 'B') && !replaying && !quiet_) {
                 deviceSelected = false;
                 selectedDeviceIndex = 0;
             }
@@ -370,12 +697,101 @@ void HeadlessInterface::handleKeypress() {
                 } else {
                     stopOSCTransport();
                 }
+                terminal.invalidate();
             }
 #endif
         }
     }
 }
 
+void HeadlessInterface::startInputCapture() {
+    if (inputCapturePath_.empty()) {
+        return;
+    }
+    std::string errorMessage;
+    if (audioInput.startCapture(inputCapturePath_, errorMessage)) {
+        std::cout << "Capturing input to " << inputCapturePath_ << std::endl;
+    } else {
+        std::cerr << "Input capture: " << errorMessage << std::endl;
+    }
+}
+
+void HeadlessInterface::finishInputCapture() {
+    if (inputCapturePath_.empty()) {
+        return;
+    }
+    const InputCaptureWriter& capture = audioInput.getCapture();
+    audioInput.stopCapture();
+    std::cout << "Input capture: " << capture.getBlocksWritten() << " blocks written to " << inputCapturePath_;
+    if (capture.getBlocksDropped() > 0) {
+        std::cout << ", " << capture.getBlocksDropped() << " dropped while the disk fell behind";
+    }
+    std::cout << std::endl;
+}
+
+bool HeadlessInterface::startInputReplay() {
+    std::string errorMessage;
+    if (!inputReplay.open(inputReplayPath_, errorMessage)) {
+        std::cerr << "Input replay: " << errorMessage << std::endl;
+        return false;
+    }
+    deviceSelected = true;
+    replaying = true;
+    replayStopping = false;
+    replayThread = std::thread([this]() {
+        replayResult = inputReplay.replay(audioInput.getAudioProcessor(), inputReplaySpeed_, replayStopping);
+        replaying = false;
+        running = false;
+    });
+    return true;
+}
+
+void HeadlessInterface::finishInputReplay() {
+    if (inputReplayPath_.empty()) {
+        return;
+    }
+    const double seconds = std::chrono::duration<double>(replayResult.elapsed).count();
+    std::cout << "Input replay: " << replayResult.blocks << " blocks in " << std::fixed << std::setprecision(2)
+              << seconds << " s from " << inputReplayPath_ << " | Analysis dropped: " << replayResult.processorDropped
+              << " | Lost in capture: " << replayResult.captureDropped << std::endl;
+}
+
+void HeadlessInterface::startLatencyProbe() {
+    namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+    if (!latencyProbe_.enabled) {
+        return;
+    }
+    if (latencyProbe_.source == LatencyProbe::Source::OutputImpulse) {
+        probeOutput = std::make_unique<AudioOutput>();
+        if (!probeOutput->initOutputStream(48000.0f, 2, -1, streamSettings_)) {
+            std::cerr << "Latency probe: unable to open an output for the test impulse" << std::endl;
+            probeOutput.reset();
+            return;
+        }
+    }
+    LatencyProbe::start(latencyProbe_.source);
+}
+
+void HeadlessInterface::finishLatencyProbe() {
+    namespace LatencyProbe = Utilities::Telemetry::LatencyProbe;
+    if (!LatencyProbe::isRunning()) {
+        return;
+    }
+    LatencyProbe::stop();
+    probeOutput.reset();
+    const LatencyProbe::Report report = LatencyProbe::collect();
+    std::cout << "Latency probe: " << report.trials << " trials, " << report.missed << " missed, total p50 "
+              << std::fixed << std::setprecision(1) << report.total.p50Ms << " ms, p95 "
+              << report.total.p95Ms << " ms" << std::endl;
+    if (latencyProbe_.reportFile.empty()) {
+        return;
+    }
+    std::string errorMessage;
+    if (!LatencyProbe::writeJson(report, latencyProbe_.reportFile, errorMessage)) {
+        std::cerr << "Latency probe: " << errorMessage << std::endl;
+    }
+}
+
 bool HeadlessInterface::startOSCTransport() {
 #ifdef ENABLE_OSC
     auto& osc = Synesthesia::OSC::SynesthesiaOSCIntegration::getInstance();
@@ -383,6 +799,23 @@ bool HeadlessInterface::startOSCTransport() {
     config.destinationHost = oscDestination_;
     config.transmitPort = oscSendPort_;
     config.receivePort = oscReceivePort_;
+    config.frameFormat = oscPackedFrames_ ? Synesthesia::OSC::OSCFrameFormat::Packed
+                                          : Synesthesia::OSC::OSCFrameFormat::Named;
+    for (const std::string& extra : oscExtraDestinations_) {
+        Synesthesia::OSC::OSCDestination destination;
+        destination.port = oscSendPort_;
+        destination.frameFormat = config.frameFormat;
+        const size_t colon = extra.rfind(':');
+        destination.host = extra.substr(0, colon);
+        if (colon != std::string::npos) {
+            destination.port = static_cast<uint16_t>(std::clamp(std::atoi(extra.c_str() + colon + 1), 1, 65535));
+        }
+        config.additionalDestinations.push_back(std::move(destination));
+    }
+    config.peaks.enabled = oscPeakTracks_ > 0;
+    if (config.peaks.enabled) {
+        config.peaks.maxPeaks = oscPeakTracks_;
+    }
 
     if (!osc.start(config)) {
         oscEnabled = false;
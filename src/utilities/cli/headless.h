@@ -4,13 +4,19 @@
 #include <string>
 #include <cstdint>
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 #include "audio_input.h"
+#include "audio_output.h"
 #include "audio/analysis/presentation/spectral_presentation.h"
 #include "colour/colour_core.h"
 #include "fft_processor.h"
+#include "terminal_renderer.h"
 #include "ui/smoothing/smoothing.h"
+#include "utilities/telemetry/latency_probe.h"
 
 namespace CLI {
 
@@ -21,7 +27,44 @@ public:
     
     void run(bool enableOSC = false, const std::string& preferredDevice = "",
              const std::string& oscDestination = "127.0.0.1",
-             uint16_t oscSendPort = 7000, uint16_t oscReceivePort = 7001);
+             uint16_t oscSendPort = 7000, uint16_t oscReceivePort = 7001,
+             bool oscPackedFrames = false,
+             const std::vector<std::string>& oscExtraDestinations = {},
+             const AudioStreamSettings& streamSettings = {});
+
+    // Runs the latency probe alongside run(), playing its impulses through the default
+    // output when it has them, and writes its report when run() returns.
+    void setLatencyProbe(const Utilities::Telemetry::LatencyProbe::Config& config) { latencyProbe_ = config; }
+    // Records the input stream's callback blocks to path from whenever run() opens one.
+    void setInputCapture(const std::string& path) { inputCapturePath_ = path; }
+    // run() analyses this capture at speed times real time instead of a device, and returns
+    // once it has been fed through; zero speed replays as fast as the analysis runs.
+    void setInputReplay(const std::string& path, float speed) {
+        inputReplayPath_ = path;
+        inputReplaySpeed_ = speed;
+    }
+    // Decimates high-rate input before analysis, live and in replayFile; see
+    // AudioProcessor::setAnalysisDecimationEnabled.
+    void setAnalysisDecimation(bool enabled) {
+        decimateAnalysis_ = enabled;
+        audioInput.getAudioProcessor().setAnalysisDecimationEnabled(enabled);
+    }
+    // Redraws the status screen refreshHz times a second, apart from the analysis and OSC
+    // rates. Quiet draws nothing at all and takes the first input device when no preferred
+    // one matches, since there is no screen to choose on.
+    void setTerminalRefresh(float refreshHz, bool quiet);
+    // Sends the maxPeaks strongest tracked spectral peaks of each frame alongside it; zero
+    // sends none.
+    void setOSCPeakTracks(size_t maxPeaks) { oscPeakTracks_ = maxPeaks; }
+
+    // Analyses audioPath offline and sends every frame over OSC, stamped with its position in
+    // the file from the moment replay starts. replaySpeed scales real time; zero sends as
+    // fast as the sender takes them. No frame is coalesced or skipped either way.
+    int replayFile(const std::string& audioPath, float replaySpeed, int analysisHop,
+                   const std::string& oscDestination = "127.0.0.1",
+                   uint16_t oscSendPort = 7000, uint16_t oscReceivePort = 7001,
+                   bool oscPackedFrames = false,
+                   const std::vector<std::string>& oscExtraDestinations = {});
     
 private:
     std::atomic<bool> running;
@@ -31,16 +74,31 @@ private:
     
     std::vector<AudioInput::DeviceInfo> devices;
     AudioInput audioInput;
+    AudioStreamSettings streamSettings_;
     ColourCore::ColourSpace oscColourSpace = ColourCore::ColourSpace::Rec2020;
     bool oscGamutMappingEnabled = true;
     std::string oscDestination_ = "127.0.0.1";
     uint16_t oscSendPort_ = 7000;
     uint16_t oscReceivePort_ = 7001;
+    bool oscPackedFrames_ = false;
+    std::vector<std::string> oscExtraDestinations_;
+    size_t oscPeakTracks_ = 0;
+    Utilities::Telemetry::LatencyProbe::Config latencyProbe_;
+    std::string inputCapturePath_;
+    std::string inputReplayPath_;
+    float inputReplaySpeed_ = 1.0f;
+    bool decimateAnalysis_ = false;
+    InputCaptureReplay inputReplay;
+    std::thread replayThread;
+    std::atomic<bool> replaying{false};
+    std::atomic<bool> replayStopping{false};
+    InputCaptureReplay::Result replayResult;  // Written by replayThread until it is joined
+    // Declared after audioInput, so it closes before PortAudio terminates.
+    std::unique_ptr<AudioOutput> probeOutput;
     
-	float lastDominantFreq = -1.0f;
-	size_t lastPeakCount = 0;
-	float lastR = -1.0f, lastG = -1.0f, lastB = -1.0f;
-	float lastLoudnessDb = -200.0f;
+    TerminalRenderer terminal;
+    std::chrono::steady_clock::duration renderInterval_ = std::chrono::milliseconds(100);
+    bool quiet_ = false;
     
     SpringSmoother colourSmoother{8.0f, 1.0f, 0.3f};
     bool smoothingEnabled = true;
@@ -48,17 +106,41 @@ private:
     float colourSmoothingSpeed = 0.6f;
     float spectrumSmoothingAmount = 0.2f;
     SpectralPresentation::Frame previousFrame;
-    uint64_t previousFrameCounter = 0;
     bool hasPreviousFrame = false;
+    SpectralPresentation::FrameWorkspace analysisWorkspace;
+    SpectralPresentation::PreparedFrame analysisFrame;
+
+    // What the terminal shows, written by the frame thread once per analysis hop and read
+    // by the render loop at its own pace.
+    struct DisplayState {
+        float dominantFrequency = 0.0f;
+        float r = 0.0f, g = 0.0f, b = 0.0f;
+        float loudnessDb = -200.0f;
+    };
+    std::mutex displayMutex;
+    DisplayState displayState;  // Protected by displayMutex
+
+    // Wakes on every buffer the analysis thread publishes and handles each hop's frame,
+    // so OSC output follows the FFT hop rather than the terminal refresh.
+    std::thread frameThread;
+    std::atomic<bool> frameThreadStopping{false};
+    AudioProcessor::BorrowedFrames borrowedFrames;  // Frame thread only
     
     void setupTerminal();
     void restoreTerminal();
     void displayDeviceSelection();
     void displayFrequencyInfo();
     void handleKeypress();
-    void processAudioLoop();
+    void runFrameLoop();
+    void processAnalysisFrame(const FFTProcessor::FrameView& view, float hopSeconds);
     bool startOSCTransport();
     void stopOSCTransport();
+    void startLatencyProbe();
+    void finishLatencyProbe();
+    void startInputCapture();
+    void finishInputCapture();
+    bool startInputReplay();
+    void finishInputReplay();
     
     static void signalHandler(int signal);
     static HeadlessInterface* instance;
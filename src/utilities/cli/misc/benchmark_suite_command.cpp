@@ -0,0 +1,622 @@
+#include "misc/benchmark_suite_command.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "audio/analysis/fft/constant_q_processor.h"
+#include "audio/analysis/fft/fft_backend.h"
+#include "audio/analysis/fft/fft_processor.h"
+#include "audio/analysis/fft/stereo_fft_processor.h"
+#include "batch_exporter.h"
+#include "colour/colour_core.h"
+#include "colour/display_lut.h"
+#include "resyne/encoding/audio/wav_encoder.h"
+#include "resyne/encoding/formats/exporter.h"
+#include "resyne/encoding/reconstruction/pghi.h"
+#include "resyne/encoding/spectral/colour_native_codec.h"
+#include "resyne/ui/timeline/timeline_rasteriser.h"
+
+namespace CLI::Misc {
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+// Everything below is fixed, so two runs on the same build and machine time the same work
+// and report the same checksums.
+constexpr float SAMPLE_RATE = 44100.0f;
+constexpr double SIGNAL_SECONDS = 10.0;
+constexpr uint32_t SIGNAL_SEED = 0x5EED;
+constexpr int FFT_SIZE = FFTProcessor::FFT_SIZE;
+constexpr int HOP_SIZE = FFTProcessor::HOP_SIZE;
+constexpr int PROCESS_HOPS[] = {256, 512, 1024};
+// The block size a PortAudio callback typically delivers.
+constexpr size_t CALLBACK_FRAMES = 512;
+constexpr size_t STRIP_WIDTH = 1920;
+constexpr int REPETITIONS = 7;
+// Every OWN_AXIS_INTERVAL-th fixture frame carries its own, stretched frequency axis, as a
+// varispeed edit leaves them, so the RSYN round trip covers both kinds of frame.
+constexpr size_t OWN_AXIS_INTERVAL = 16;
+constexpr float OWN_AXIS_STRETCH = 1.05f;
+// The right channel of the stereo pair is the signal reversed and this much quieter, so
+// leakage from the louder left shows up against it.
+constexpr float STEREO_RIGHT_GAIN = 1e-3f;
+// How far either channel of a stereo pair may stray from its own mono analysis, relative to
+// the frame's loudest bin in either: ten times the leakage StereoFFTProcessor documents.
+constexpr float STEREO_LEAKAGE_BOUND = 1e-6f;
+
+struct BenchmarkResult {
+    std::string name;
+    nlohmann::json parameters = nlohmann::json::object();
+    int repetitions = 0;
+    double medianMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+    double checksum = 0.0;
+};
+
+// Runs operation once to warm caches and allocations, then times repetitions of it. The
+// operation returns a checksum of its output, so its work cannot be optimised away and the
+// report shows whether two builds still compute the same thing.
+template <typename Operation>
+BenchmarkResult measure(std::string name, nlohmann::json parameters, Operation&& operation) {
+    BenchmarkResult result;
+    result.name = std::move(name);
+    result.parameters = std::move(parameters);
+    result.repetitions = REPETITIONS;
+    result.checksum = operation();
+
+    std::vector<double> timesMs;
+    timesMs.reserve(REPETITIONS);
+    for (int repetition = 0; repetition < REPETITIONS; ++repetition) {
+        const auto start = Clock::now();
+        const double checksum = operation();
+        timesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        if (checksum != result.checksum) {
+            result.checksum = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    std::ranges::sort(timesMs);
+    result.medianMs = timesMs[timesMs.size() / 2];
+    result.minMs = timesMs.front();
+    result.maxMs = timesMs.back();
+    return result;
+}
+
+// A swept tone with harmonics, struck notes and a little noise, so the analysis sees moving
+// partials, onsets and a noise floor.
+std::vector<float> synthesiseSignal() {
+    const auto length = static_cast<size_t>(SIGNAL_SECONDS * SAMPLE_RATE);
+    std::vector<float> signal(length);
+    std::mt19937 rng(SIGNAL_SEED);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+    double sweepPhase = 0.0;
+    for (size_t i = 0; i < length; ++i) {
+        const double t = static_cast<double>(i) / SAMPLE_RATE;
+        const double sweepFrequency = 110.0 * std::pow(2.0, 4.0 * t / SIGNAL_SECONDS);
+        sweepPhase += 2.0 * std::numbers::pi * sweepFrequency / SAMPLE_RATE;
+
+        float sample = 0.0f;
+        for (int harmonic = 1; harmonic <= 4; ++harmonic) {
+            sample += 0.3f / static_cast<float>(harmonic) * static_cast<float>(std::sin(sweepPhase * harmonic));
+        }
+        const double noteTime = std::fmod(t, 0.5);
+        sample += 0.4f * static_cast<float>(std::exp(-8.0 * noteTime) * std::sin(2.0 * std::numbers::pi * 880.0 * t));
+        sample += 0.02f * noise(rng);
+        signal[i] = sample;
+    }
+    return signal;
+}
+
+struct Fixture {
+    std::vector<float> signal;
+    FFTProcessor::SignalFrames frames;
+    std::vector<float> binFrequencies;
+    SpectralSequence samples;
+    AudioMetadata metadata;
+};
+
+Fixture buildFixture() {
+    Fixture fixture;
+    fixture.signal = synthesiseSignal();
+
+    const FFTProcessor analyser(FFT_SIZE);
+    fixture.frames = analyser.analyseWholeSignal(fixture.signal, SAMPLE_RATE, HOP_SIZE);
+
+    const size_t binCount = fixture.frames.binCount;
+    fixture.binFrequencies.resize(binCount);
+    for (size_t bin = 0; bin < binCount; ++bin) {
+        fixture.binFrequencies[bin] = static_cast<float>(bin) * SAMPLE_RATE / static_cast<float>(FFT_SIZE);
+    }
+
+    fixture.samples.reset(1, binCount);
+    fixture.samples.setSharedFrequencies(fixture.binFrequencies);
+    fixture.samples.reserve(fixture.frames.frameCount);
+    for (size_t frame = 0; frame < fixture.frames.frameCount; ++frame) {
+        const auto magnitudes = fixture.frames.frameMagnitudes(frame);
+        const auto phases = fixture.frames.framePhases(frame);
+        SpectralFrameInfo info{};
+        info.timestamp = static_cast<double>((frame + 1) * HOP_SIZE) / SAMPLE_RATE;
+        info.sampleRate = SAMPLE_RATE;
+        const size_t stored = fixture.samples.appendFrame(info, 1, binCount);
+        std::copy(magnitudes.begin(), magnitudes.end(), fixture.samples.magnitudes(stored, 0).begin());
+        std::copy(phases.begin(), phases.end(), fixture.samples.phases(stored, 0).begin());
+        fixture.samples.setUsesSharedFrequencies(stored, true);
+        if (frame % OWN_AXIS_INTERVAL == OWN_AXIS_INTERVAL - 1) {
+            for (float& frequency : fixture.samples.frequencies(stored, 0)) {
+                frequency *= OWN_AXIS_STRETCH;
+            }
+        }
+    }
+
+    fixture.metadata.sampleRate = SAMPLE_RATE;
+    fixture.metadata.fftSize = FFT_SIZE;
+    fixture.metadata.hopSize = HOP_SIZE;
+    fixture.metadata.durationSeconds = SIGNAL_SECONDS;
+    fixture.metadata.numFrames = fixture.samples.size();
+    fixture.metadata.numBins = binCount;
+    fixture.metadata.channels = 1;
+    return fixture;
+}
+
+double sum(std::span<const float> values) {
+    double total = 0.0;
+    for (const float value : values) {
+        total += value;
+    }
+    return total;
+}
+
+// Whether every frame read back has the frequencies it was written with, whether it sits
+// on the shared axis or carries its own.
+bool sameFrequencies(const SpectralSequence& written, const SpectralSequence& read) {
+    if (written.size() != read.size()) {
+        return false;
+    }
+    for (size_t frame = 0; frame < written.size(); ++frame) {
+        const SpectralFrame expected = written[frame];
+        const SpectralFrame actual = read[frame];
+        if (expected.frequencies.size() != actual.frequencies.size()) {
+            return false;
+        }
+        for (size_t channel = 0; channel < expected.frequencies.size(); ++channel) {
+            const auto expectedAxis = expected.frequencies[channel];
+            const auto actualAxis = actual.frequencies[channel];
+            if (!std::equal(expectedAxis.begin(), expectedAxis.end(), actualAxis.begin(), actualAxis.end(),
+                            [](const float lhs, const float rhs) {
+                                return std::fabs(lhs - rhs) <= 1e-3f * std::max(1.0f, std::fabs(lhs));
+                            })) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// BatchExporter reports each file on stdout, which would land in the middle of the JSON.
+class SilencedStdout {
+public:
+    SilencedStdout() : previous_(std::cout.rdbuf(sink_.rdbuf())) {}
+    ~SilencedStdout() { std::cout.rdbuf(previous_); }
+
+    SilencedStdout(const SilencedStdout&) = delete;
+    SilencedStdout& operator=(const SilencedStdout&) = delete;
+
+private:
+    std::ostringstream sink_;
+    std::streambuf* previous_;
+};
+
+void runAnalysisBenchmarks(const Fixture& fixture, std::vector<BenchmarkResult>& results) {
+    for (const int hop : PROCESS_HOPS) {
+        FFTProcessor processor(FFT_SIZE);
+        processor.setHopSize(hop);
+        results.push_back(measure("fft.processBuffer", {{"fftSize", FFT_SIZE}, {"hopSize", hop}}, [&] {
+            processor.reset();
+            const std::span<const float> signal(fixture.signal);
+            for (size_t offset = 0; offset < signal.size(); offset += CALLBACK_FRAMES) {
+                processor.processBuffer(signal.subspan(offset, std::min(CALLBACK_FRAMES, signal.size() - offset)),
+                                        SAMPLE_RATE);
+            }
+            return static_cast<double>(processor.getFrameCounter());
+        }));
+    }
+
+    for (const int hop : PROCESS_HOPS) {
+        ConstantQProcessor processor;
+        processor.setHopSize(hop);
+        std::vector<ConstantQProcessor::FrameView> views;
+        results.push_back(measure("cqt.processBuffer",
+                                  {{"binsPerOctave", processor.getBinsPerOctave()}, {"hopSize", hop}}, [&] {
+            processor.reset();
+            const std::span<const float> signal(fixture.signal);
+            for (size_t offset = 0; offset < signal.size(); offset += CALLBACK_FRAMES) {
+                processor.processBuffer(signal.subspan(offset, std::min(CALLBACK_FRAMES, signal.size() - offset)),
+                                        SAMPLE_RATE);
+                processor.releaseBufferedFrames(processor.borrowBufferedFrames(views));
+            }
+            return static_cast<double>(processor.getFrameCounter());
+        }));
+    }
+
+    {
+        const FFTProcessor analyser(FFT_SIZE);
+        const std::vector<float>& left = fixture.signal;
+        std::vector<float> right(left.rbegin(), left.rend());
+        for (float& sample : right) {
+            sample *= STEREO_RIGHT_GAIN;
+        }
+        const size_t frameCount = FFTProcessor::countSignalFrames(left.size(), HOP_SIZE);
+        FFTProcessor::SignalFrames expectedLeft;
+        FFTProcessor::SignalFrames expectedRight;
+        analyser.analyseSignalFrames(left, SAMPLE_RATE, HOP_SIZE, 0, frameCount, expectedLeft);
+        analyser.analyseSignalFrames(right, SAMPLE_RATE, HOP_SIZE, 0, frameCount, expectedRight);
+
+        FFTProcessor::SignalFrames leftFrames;
+        FFTProcessor::SignalFrames rightFrames;
+        results.push_back(measure("fft.stereoSignalFrames", {{"fftSize", FFT_SIZE}, {"frames", frameCount}}, [&] {
+            StereoFFTProcessor::analyseSignalFrames(analyser, left, right, 0, SAMPLE_RATE, HOP_SIZE, 0, frameCount,
+                                                    leftFrames, rightFrames);
+            double checksum = 0.0;
+            for (size_t frame = 0; frame < frameCount; ++frame) {
+                const auto expectedL = expectedLeft.frameMagnitudes(frame);
+                const auto expectedR = expectedRight.frameMagnitudes(frame);
+                const auto actualL = leftFrames.frameMagnitudes(frame);
+                const auto actualR = rightFrames.frameMagnitudes(frame);
+                const float peak = std::max(std::ranges::max(expectedL), std::ranges::max(expectedR));
+                for (size_t bin = 0; bin < expectedL.size(); ++bin) {
+                    if (std::fabs(actualL[bin] - expectedL[bin]) > STEREO_LEAKAGE_BOUND * peak ||
+                        std::fabs(actualR[bin] - expectedR[bin]) > STEREO_LEAKAGE_BOUND * peak) {
+                        return std::numeric_limits<double>::quiet_NaN();
+                    }
+                }
+                checksum += sum(actualL) + sum(actualR);
+            }
+            return checksum;
+        }));
+    }
+
+    ColourCore::AnalysisScratch scratch;
+    results.push_back(measure("colour.analyseSpectrum", {{"frames", fixture.frames.frameCount}}, [&] {
+        double checksum = 0.0;
+        for (size_t frame = 0; frame < fixture.frames.frameCount; ++frame) {
+            const ColourCore::FrameResult colour = ColourCore::analyseSpectrum(
+                scratch,
+                fixture.frames.frameMagnitudes(frame),
+                fixture.frames.framePhases(frame),
+                fixture.binFrequencies,
+                SAMPLE_RATE,
+                ColourCore::OutputSettings{});
+            checksum += colour.r + colour.g + colour.b;
+        }
+        return checksum;
+    }));
+}
+
+void runCodecBenchmarks(const Fixture& fixture, std::vector<BenchmarkResult>& results) {
+    const nlohmann::json frameParameters = {{"frames", fixture.samples.size()}, {"bins", fixture.metadata.numBins}};
+
+    results.push_back(measure("codec.encode", frameParameters, [&] {
+        const ColourNativeImage image = ColourNativeCodec::encode(fixture.samples, fixture.metadata);
+        double checksum = 0.0;
+        for (const RGBAColour& pixel : image.pixels) {
+            checksum += pixel.r + pixel.g + pixel.b + pixel.a;
+        }
+        return checksum;
+    }));
+
+    const ColourNativeImage image = ColourNativeCodec::encode(fixture.samples, fixture.metadata);
+    results.push_back(measure("codec.decode", frameParameters, [&] {
+        float sampleRate = 0.0f;
+        int hopSize = 0;
+        const SpectralSequence decoded = ColourNativeCodec::decode(image, sampleRate, hopSize);
+        double checksum = 0.0;
+        for (const SpectralFrame sample : decoded) {
+            if (!sample.magnitudes.empty()) {
+                checksum += sum(sample.magnitudes.front());
+            }
+        }
+        return checksum;
+    }));
+}
+
+void runReconstructionBenchmarks(const Fixture& fixture, std::vector<BenchmarkResult>& results) {
+    std::vector<std::vector<float>> allMagnitudes;
+    std::vector<std::vector<float>> allFrequencies;
+    std::vector<SpectralSample> spectralSamples;
+    allMagnitudes.reserve(fixture.samples.size());
+    allFrequencies.reserve(fixture.samples.size());
+    spectralSamples.reserve(fixture.samples.size());
+    for (const SpectralFrame frame : fixture.samples) {
+        AudioColourSample sample = frame.toSample();
+        allMagnitudes.push_back(sample.magnitudes.front());
+        allFrequencies.push_back(fixture.binFrequencies);
+        spectralSamples.push_back(SpectralSample{std::move(sample.magnitudes), std::move(sample.phases),
+                                                 std::move(sample.frequencies), sample.timestamp, sample.sampleRate});
+    }
+
+    PhaseReconstruction::PGHIWorkspace workspace;
+    results.push_back(measure("pghi.reconstruct", {{"frames", allMagnitudes.size()}, {"hopSize", HOP_SIZE}}, [&] {
+        std::vector<float> previousPhases;
+        std::vector<float> phases;
+        double checksum = 0.0;
+        for (size_t frame = 0; frame < allMagnitudes.size(); ++frame) {
+            PhaseReconstruction::reconstructPhasePGHI(
+                allMagnitudes, allFrequencies, frame, phases, SAMPLE_RATE, HOP_SIZE,
+                frame > 0 ? &previousPhases : nullptr, workspace);
+            checksum += sum(phases);
+            std::swap(previousPhases, phases);
+        }
+        return checksum;
+    }));
+
+    results.push_back(measure("wav.reconstructFromSpectralData",
+                              {{"frames", spectralSamples.size()}, {"fftSize", FFT_SIZE}, {"hopSize", HOP_SIZE}},
+                              [&] {
+        const WAVEncoder::EncodingResult encoded =
+            WAVEncoder::reconstructFromSpectralData(spectralSamples, SAMPLE_RATE, FFT_SIZE, HOP_SIZE);
+        return encoded.success ? sum(encoded.audioSamples) : std::numeric_limits<double>::quiet_NaN();
+    }));
+}
+
+void runContainerBenchmarks(const Fixture& fixture, const fs::path& workDirectory,
+                            std::vector<BenchmarkResult>& results) {
+    const std::string path = (workDirectory / "bench.rsyn").string();
+    const RSYNExportOptions options{};
+
+    results.push_back(measure("rsyn.write", {{"frames", fixture.samples.size()}, {"codec", "deflate"}}, [&] {
+        if (!SequenceExporter::exportToRsyn(path, fixture.samples, fixture.metadata, options)) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        std::error_code error;
+        return static_cast<double>(fs::file_size(path, error));
+    }));
+
+    results.push_back(measure("rsyn.read", {{"frames", fixture.samples.size()}, {"codec", "deflate"}}, [&] {
+        SpectralSequence loaded;
+        AudioMetadata metadata;
+        // A file that loses an axis on the way back reports no checksum.
+        if (!SequenceExporter::loadFromRsyn(path, loaded, metadata) || !sameFrequencies(fixture.samples, loaded)) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        double checksum = 0.0;
+        for (const SpectralFrame sample : loaded) {
+            if (!sample.magnitudes.empty()) {
+                checksum += sum(sample.magnitudes.front());
+            }
+        }
+        return checksum;
+    }));
+
+    // Saves a project over itself twice, as editing one does: first with half its spectra
+    // changed, which leaves a third of the file superseded, then with all of them, which
+    // passes half and compacts, moving every block. A block read through the asset loaded
+    // before either save must still be the one saved last.
+    const std::string resavePath = (workDirectory / "resave.rsyn").string();
+    const size_t probeFrame = fixture.samples.size() / 2;
+    results.push_back(measure("rsyn.resaveCompact", {{"frames", fixture.samples.size()}, {"saves", 2}}, [&] {
+        constexpr double failed = std::numeric_limits<double>::quiet_NaN();
+        AudioMetadata metadata;
+        if (!SequenceExporter::exportToRsyn(resavePath, fixture.samples, fixture.metadata, options) ||
+            !SequenceExporter::loadFromRsynShell(resavePath, metadata)) {
+            return failed;
+        }
+
+        SpectralSequence edited = fixture.samples;
+        for (const size_t editedFrames : {edited.size() / 2, edited.size()}) {
+            for (size_t frame = 0; frame < editedFrames; ++frame) {
+                for (float& magnitude : edited.magnitudes(frame, 0)) {
+                    magnitude *= 1.5f;
+                }
+            }
+            const bool compacts = editedFrames == edited.size();
+            if (!SequenceExporter::exportToRsyn(resavePath, edited, metadata, options) ||
+                SequenceExporter::compactRsyn(resavePath, metadata) != compacts) {
+                return failed;
+            }
+        }
+
+        SpectralSequence probe;
+        if (!SequenceExporter::hydrateRsynFrames(metadata, probeFrame, 1, probe) || probe.size() != 1) {
+            return failed;
+        }
+        const auto expected = edited.magnitudes(probeFrame, 0);
+        const auto actual = probe.magnitudes(0, 0);
+        if (!std::equal(expected.begin(), expected.end(), actual.begin(), actual.end())) {
+            return failed;
+        }
+        return sum(actual);
+    }));
+}
+
+void runTimelineBenchmarks(const Fixture& fixture, std::vector<BenchmarkResult>& results) {
+    std::vector<ReSyne::Timeline::TimelineSample> timelineSamples(fixture.frames.frameCount);
+    std::vector<ColourCore::Lab> labs(fixture.frames.frameCount);
+    ColourCore::AnalysisScratch scratch;
+    for (size_t frame = 0; frame < fixture.frames.frameCount; ++frame) {
+        const ColourCore::FrameResult colour = ColourCore::analyseSpectrum(
+            scratch,
+            fixture.frames.frameMagnitudes(frame),
+            fixture.frames.framePhases(frame),
+            fixture.binFrequencies,
+            SAMPLE_RATE,
+            ColourCore::OutputSettings{});
+        ReSyne::Timeline::TimelineSample& sample = timelineSamples[frame];
+        sample.timestamp = fixture.samples.frameInfo(frame).timestamp;
+        ColourCore::XYZtoOklab(colour.X, colour.Y, colour.Z, sample.labL, sample.labA, sample.labB);
+        ColourCore::XYZtoLab(colour.X, colour.Y, colour.Z, labs[frame].L, labs[frame].a, labs[frame].b);
+    }
+
+    ReSyne::Timeline::GradientPyramid pyramid;
+    ReSyne::Timeline::buildGradientPyramid(timelineSamples, pyramid);
+    std::vector<float> pixels(STRIP_WIDTH * 4);
+
+    // Zoomed out the strip reads bucket means; zoomed in it interpolates between samples.
+    for (const float visibleFraction : {1.0f, 0.05f}) {
+        results.push_back(measure("timeline.rasteriseGradientStrip",
+                                  {{"samples", timelineSamples.size()}, {"width", STRIP_WIDTH},
+                                   {"visibleFraction", visibleFraction}},
+                                  [&] {
+            double checksum = 0.0;
+            // Pans across the sequence, as scrolling the timeline does.
+            for (int step = 0; step < 32; ++step) {
+                const float start = (1.0f - visibleFraction) * static_cast<float>(step) / 31.0f;
+                ReSyne::Timeline::rasteriseGradientStrip(pyramid, start, start + visibleFraction, STRIP_WIDTH,
+                                                         ColourCore::ColourSpace::Rec2020, true, pixels);
+                checksum += sum(pixels);
+            }
+            return checksum;
+        }));
+    }
+
+    // The strip converts through the display table; its drift from the exact projection is
+    // reported alongside the timings of both.
+    std::vector<ColourCore::RGB> rgb(labs.size());
+    const ColourCore::OutputSettings outputSettings{};
+    const auto sumRGB = [&rgb] {
+        double checksum = 0.0;
+        for (const auto& colour : rgb) {
+            checksum += colour.r + colour.g + colour.b;
+        }
+        return checksum;
+    };
+    results.push_back(measure("colour.labToRGB", {{"colours", labs.size()}, {"path", "exact"}}, [&] {
+        for (size_t i = 0; i < labs.size(); ++i) {
+            ColourCore::LabtoRGB(labs[i].L, labs[i].a, labs[i].b, rgb[i].r, rgb[i].g, rgb[i].b,
+                                 outputSettings.colourSpace, outputSettings.applyGamutMapping);
+        }
+        return sumRGB();
+    }));
+    const auto& lut = ColourCore::DisplayLUT::forSettings(outputSettings);
+    results.push_back(measure("colour.labToRGB",
+                              {{"colours", labs.size()}, {"path", "displayLut"},
+                               {"gridSize", ColourCore::DisplayLUT::GRID_SIZE}, {"maxDeltaE", lut.maxDeltaE()}},
+                              [&] {
+        lut.project(labs, rgb);
+        return sumRGB();
+    }));
+}
+
+void runBatchExportBenchmark(const Fixture& fixture, const fs::path& workDirectory,
+                             std::vector<BenchmarkResult>& results) {
+    const fs::path inputDirectory = workDirectory / "batch-input";
+    const fs::path outputDirectory = workDirectory / "batch-output";
+    std::error_code error;
+    fs::create_directories(inputDirectory, error);
+    if (error || !WAVEncoder::exportToWAV((inputDirectory / "bench.wav").string(), fixture.signal, SAMPLE_RATE, 1)) {
+        std::cerr << "Warning: skipping batch.singleFile, unable to write its input\n";
+        return;
+    }
+
+    results.push_back(measure("batch.singleFile", {{"seconds", SIGNAL_SECONDS}, {"format", "png"}}, [&] {
+        fs::remove_all(outputDirectory, error);
+        int status = 0;
+        {
+            const SilencedStdout silenced;
+            status = BatchExporter::run(inputDirectory.string(), outputDirectory.string(), false,
+                                        0, 0, "png", false, false, 1, HOP_SIZE, false, false);
+        }
+        if (status != 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        double totalBytes = 0.0;
+        for (const auto& entry : fs::recursive_directory_iterator(outputDirectory, error)) {
+            if (entry.is_regular_file(error)) {
+                totalBytes += static_cast<double>(entry.file_size(error));
+            }
+        }
+        return totalBytes;
+    }));
+}
+
+}
+
+int runBenchmarkSuiteCommand(const Arguments& args) {
+    std::error_code error;
+    const fs::path workDirectory = fs::temp_directory_path(error) / "synesthesia-bench";
+    if (error) {
+        std::cerr << "Error: unable to find a temporary directory\n";
+        return 1;
+    }
+    fs::remove_all(workDirectory, error);
+    fs::create_directories(workDirectory, error);
+    if (error) {
+        std::cerr << "Error: unable to create " << workDirectory.string() << "\n";
+        return 1;
+    }
+
+    std::cerr << "Building the synthetic fixture...\n";
+    const Fixture fixture = buildFixture();
+
+    std::vector<BenchmarkResult> results;
+    std::cerr << "Analysis...\n";
+    runAnalysisBenchmarks(fixture, results);
+    std::cerr << "Colour-native codec...\n";
+    runCodecBenchmarks(fixture, results);
+    std::cerr << "Reconstruction...\n";
+    runReconstructionBenchmarks(fixture, results);
+    std::cerr << "RSYN container...\n";
+    runContainerBenchmarks(fixture, workDirectory, results);
+    std::cerr << "Timeline...\n";
+    runTimelineBenchmarks(fixture, results);
+    std::cerr << "Batch export...\n";
+    runBatchExportBenchmark(fixture, workDirectory, results);
+    fs::remove_all(workDirectory, error);
+
+    nlohmann::json report;
+    report["suite"] = "synesthesia-bench";
+    report["version"] = SYNESTHESIA_VERSION_STRING;
+    report["fftBackend"] = FFTBackend::name(FFTBackend::defaultKind());
+    report["hardwareThreads"] = std::thread::hardware_concurrency();
+    report["repetitions"] = REPETITIONS;
+    report["signal"] = {{"sampleRate", SAMPLE_RATE}, {"seconds", SIGNAL_SECONDS}, {"seed", SIGNAL_SEED}};
+    nlohmann::json& entries = report["results"];
+    entries = nlohmann::json::array();
+    for (const BenchmarkResult& result : results) {
+        entries.push_back({
+            {"name", result.name},
+            {"parameters", result.parameters},
+            {"medianMs", result.medianMs},
+            {"minMs", result.minMs},
+            {"maxMs", result.maxMs},
+            // Null when a repetition's output differed from the warm-up's.
+            {"checksum", std::isfinite(result.checksum) ? nlohmann::json(result.checksum) : nlohmann::json()}
+        });
+    }
+
+    const std::string text = report.dump(2);
+    if (args.outputDir.empty()) {
+        std::cout << text << "\n";
+        return 0;
+    }
+
+    std::ofstream file(args.outputDir, std::ios::trunc);
+    file << text << "\n";
+    if (!file) {
+        std::cerr << "Error: unable to write " << args.outputDir << "\n";
+        return 1;
+    }
+    std::cerr << "Wrote " << args.outputDir << "\n";
+    return 0;
+}
+
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "cli.h"
+
+namespace CLI::Misc {
+
+int runBenchmarkSuiteCommand(const Arguments& args);
+
+}
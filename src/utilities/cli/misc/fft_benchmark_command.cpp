@@ -0,0 +1,120 @@
+#include "misc/fft_benchmark_command.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "audio/analysis/fft/fft_backend.h"
+
+namespace CLI::Misc {
+
+namespace {
+
+constexpr int SIZES[] = {512, 1024, 2048, 4096, 8192};
+constexpr double TARGET_SECONDS = 0.25;
+
+struct Timing {
+    double forwardMicros = 0.0;
+    double inverseMicros = 0.0;
+    float roundTripError = 0.0f;
+};
+
+template <typename Operation>
+double microsPerCall(Operation&& operation) {
+    using Clock = std::chrono::steady_clock;
+
+    for (int i = 0; i < 16; ++i) {
+        operation();
+    }
+
+    size_t iterations = 0;
+    const auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        for (int i = 0; i < 64; ++i) {
+            operation();
+        }
+        iterations += 64;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < TARGET_SECONDS);
+
+    return elapsed * 1e6 / static_cast<double>(iterations);
+}
+
+Timing measure(FFTBackend::RealTransform& transform, const std::vector<float>& signal) {
+    const size_t size = signal.size();
+    std::vector<kiss_fft_cpx> spectrum(size / 2 + 1);
+    std::vector<float> restored(size);
+
+    Timing timing;
+    timing.forwardMicros = microsPerCall([&] { transform.forward(signal, spectrum); });
+
+    transform.forward(signal, spectrum);
+    const std::vector<kiss_fft_cpx> reference = spectrum;
+    timing.inverseMicros = microsPerCall([&] {
+        std::copy(reference.begin(), reference.end(), spectrum.begin());
+        transform.inverse(spectrum, restored);
+    });
+
+    std::copy(reference.begin(), reference.end(), spectrum.begin());
+    transform.inverse(spectrum, restored);
+    const float scale = 1.0f / static_cast<float>(size);
+    for (size_t i = 0; i < size; ++i) {
+        timing.roundTripError = std::max(timing.roundTripError, std::abs(restored[i] * scale - signal[i]));
+    }
+    return timing;
+}
+
+}
+
+int runFFTBenchmarkCommand(const Arguments&) {
+    const std::vector<FFTBackend::Kind> kinds = FFTBackend::availableKinds();
+
+    std::cout << "FFT backends: ";
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        std::cout << (i > 0 ? ", " : "") << FFTBackend::name(kinds[i]);
+    }
+    std::cout << " (default: " << FFTBackend::name(FFTBackend::defaultKind()) << ")\n\n";
+    std::printf("%-12s %6s %14s %14s %12s\n", "backend", "size", "forward (us)", "inverse (us)", "max error");
+
+    std::mt19937 rng(0x5EED);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+    for (const int size : SIZES) {
+        std::vector<float> signal(static_cast<size_t>(size));
+        for (size_t i = 0; i < signal.size(); ++i) {
+            const float t = static_cast<float>(i) / static_cast<float>(size);
+            signal[i] = 0.5f * std::sin(2.0f * std::numbers::pi_v<float> * 37.0f * t) + 0.1f * noise(rng);
+        }
+
+        for (const FFTBackend::Kind kind : kinds) {
+            std::unique_ptr<FFTBackend::RealTransform> transform;
+            try {
+                transform = FFTBackend::create(size, kind);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << FFTBackend::name(kind) << " at " << size << ": " << e.what() << "\n";
+                return 1;
+            }
+            if (transform->kind() != kind) {
+                continue;
+            }
+
+            const Timing timing = measure(*transform, signal);
+            std::printf("%-12s %6d %14.2f %14.2f %12.2e\n",
+                        FFTBackend::name(kind),
+                        size,
+                        timing.forwardMicros,
+                        timing.inverseMicros,
+                        static_cast<double>(timing.roundTripError));
+        }
+    }
+    return 0;
+}
+
+}
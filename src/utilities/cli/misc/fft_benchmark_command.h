@@ -0,0 +1,9 @@
+#pragma once
+
+#include "cli.h"
+
+namespace CLI::Misc {
+
+int runFFTBenchmarkCommand(const Arguments& args);
+
+}
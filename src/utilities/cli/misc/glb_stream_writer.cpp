@@ -0,0 +1,132 @@
+#include "misc/glb_stream_writer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace CLI::Misc {
+
+namespace {
+
+// GLB is little-endian throughout; the header and the buffer are written as they sit in memory.
+static_assert(std::endian::native == std::endian::little);
+
+constexpr std::uint32_t kGlbMagic = 0x46546C67U;
+constexpr std::uint32_t kGlbVersion = 2U;
+constexpr std::uint32_t kJsonChunkType = 0x4E4F534AU;
+constexpr std::uint32_t kBinChunkType = 0x004E4942U;
+constexpr std::size_t kHeaderBytes = 12U;
+constexpr std::size_t kChunkHeaderBytes = 8U;
+constexpr std::size_t kStagingBytes = std::size_t{1} << 20;
+
+std::uint64_t paddedToFour(const std::uint64_t length) {
+    return (length + 3U) & ~std::uint64_t{3};
+}
+
+void writeWords(std::ofstream& file, const std::initializer_list<std::uint32_t> words) {
+    for (const std::uint32_t word : words) {
+        file.write(reinterpret_cast<const char*>(&word), sizeof(word));
+    }
+}
+
+}
+
+bool GlbStreamWriter::open(const std::filesystem::path& path,
+                           const std::string& json,
+                           const std::uint64_t length,
+                           std::string& errorMessage) {
+    const std::uint64_t jsonChunk = paddedToFour(json.size());
+    const std::uint64_t binChunk = paddedToFour(length);
+    const std::uint64_t total = kHeaderBytes + kChunkHeaderBytes + jsonChunk + kChunkHeaderBytes + binChunk;
+    if (total > std::numeric_limits<std::uint32_t>::max()) {
+        errorMessage = "GLB output would exceed the 4 GiB the format can address";
+        return false;
+    }
+
+    if (path.has_parent_path()) {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        errorMessage = "Unable to open " + path.string();
+        return false;
+    }
+
+    writeWords(file, {kGlbMagic, kGlbVersion, static_cast<std::uint32_t>(total)});
+    writeWords(file, {static_cast<std::uint32_t>(jsonChunk), kJsonChunkType});
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    // The JSON chunk pads with spaces so it still parses.
+    const std::array<char, 3> spaces{' ', ' ', ' '};
+    file.write(spaces.data(), static_cast<std::streamsize>(jsonChunk - json.size()));
+    writeWords(file, {static_cast<std::uint32_t>(binChunk), kBinChunkType});
+    if (!file) {
+        errorMessage = "Unable to write " + path.string();
+        return false;
+    }
+
+    outputPath = path;
+    binLength = length;
+    binWritten = 0;
+    staging.clear();
+    staging.reserve(kStagingBytes);
+    return true;
+}
+
+void GlbStreamWriter::write(const void* data, const std::size_t bytes) {
+    const auto* source = static_cast<const std::uint8_t*>(data);
+    std::size_t remaining = bytes;
+    while (remaining > 0U) {
+        const std::size_t count = std::min(remaining, kStagingBytes - staging.size());
+        staging.insert(staging.end(), source, source + count);
+        source += count;
+        remaining -= count;
+        if (staging.size() == kStagingBytes) {
+            flush();
+        }
+    }
+    binWritten += bytes;
+}
+
+void GlbStreamWriter::align(const std::size_t alignment) {
+    const std::uint64_t remainder = binWritten % alignment;
+    if (remainder == 0U) {
+        return;
+    }
+    const std::array<std::uint8_t, 8> zeros{};
+    std::uint64_t padding = alignment - remainder;
+    while (padding > 0U) {
+        const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(padding, zeros.size()));
+        write(zeros.data(), count);
+        padding -= count;
+    }
+}
+
+bool GlbStreamWriter::finish(std::string& errorMessage) {
+    if (binWritten != binLength) {
+        errorMessage = "GLB buffer came to " + std::to_string(binWritten) + " bytes, " +
+                       std::to_string(binLength) + " were laid out";
+        file.close();
+        return false;
+    }
+    align(4U);
+    flush();
+    file.close();
+    if (!file) {
+        errorMessage = "Unable to write " + outputPath.string();
+        return false;
+    }
+    return true;
+}
+
+void GlbStreamWriter::flush() {
+    if (staging.empty()) {
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(staging.data()), static_cast<std::streamsize>(staging.size()));
+    staging.clear();
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace CLI::Misc {
+
+// Writes a binary glTF with its BIN chunk streamed in after the JSON, so a mesh never has to
+// sit whole in memory. The JSON describes the buffer before any of it is written, so the
+// caller lays the buffer out first and tells open() how long it will be.
+class GlbStreamWriter {
+public:
+    bool open(const std::filesystem::path& path,
+              const std::string& json,
+              std::uint64_t binLength,
+              std::string& errorMessage);
+
+    void write(const void* data, std::size_t bytes);
+    // Zero pads the BIN chunk to the next multiple of alignment.
+    void align(std::size_t alignment);
+    std::uint64_t getBinOffset() const { return binWritten; }
+
+    // Fails if fewer or more bytes were written than open() was promised.
+    bool finish(std::string& errorMessage);
+
+private:
+    void flush();
+
+    std::filesystem::path outputPath;
+    std::ofstream file;
+    std::vector<std::uint8_t> staging;
+    std::uint64_t binLength = 0;
+    std::uint64_t binWritten = 0;
+};
+
+}
@@ -12,6 +12,10 @@
 #include <string>
 #include <vector>
 
+#include <nlohmann/json.hpp>
+
+#include "misc/glb_stream_writer.h"
+#include "misc/misc_batch.h"
 #include "misc/presentation_export_utils.h"
 #include "tiny_gltf.h"
 
@@ -24,6 +28,19 @@ namespace {
 constexpr float kMinimumLoudnessDb = -70.0f;
 constexpr float kMaximumLoudnessDb = 0.0f;
 constexpr float kHalfRibbonDepth = 0.5f;
+constexpr int kMaxLodLevels = 4;
+// Level n drops columns within kLodBaseTolerance * 2^(n - 1) of the last one it kept.
+constexpr float kLodBaseTolerance = 0.02f;
+constexpr double kQuantisedPositionMax = 65535.0;
+
+constexpr std::array<std::uint32_t, 24> kSpanIndices{
+    0U, 4U, 5U, 0U, 5U, 1U,
+    2U, 3U, 7U, 2U, 7U, 6U,
+    1U, 5U, 7U, 1U, 7U, 3U,
+    0U, 2U, 6U, 0U, 6U, 4U
+};
+constexpr std::array<std::uint32_t, 6> kStartCapIndices{0U, 1U, 3U, 0U, 3U, 2U};
+constexpr std::array<std::uint32_t, 6> kEndCapIndices{0U, 3U, 1U, 0U, 2U, 3U};
 
 struct HeightProfile {
     bool normaliseHeight = false;
@@ -189,6 +206,53 @@ void appendVertex(MeshPayload& payload,
     payload.maxPosition[2] = std::max(payload.maxPosition[2], static_cast<double>(z));
 }
 
+// Maps presentation samples onto the solid's columns without copying them. The column past
+// the last sample closes the solid at the track's full length.
+struct ColumnMapping {
+    const std::vector<PresentationSample>& samples;
+    HeightProfile profile;
+    double totalLength = 1.0;
+    double lengthExtent = 1.0;
+
+    std::size_t count() const {
+        return samples.size() + 1U;
+    }
+
+    float mapX(const double timestamp) const {
+        if (!profile.normaliseLength) {
+            return static_cast<float>(timestamp);
+        }
+        return static_cast<float>((timestamp / totalLength) * lengthExtent);
+    }
+
+    ColumnSample at(const std::size_t index) const {
+        if (index < samples.size()) {
+            return ColumnSample{
+                .sample = samples[index],
+                .x = mapX(samples[index].timestamp),
+                .height = exportedHeight(samples[index], profile)
+            };
+        }
+        return ColumnSample{
+            .sample = samples.back(),
+            .x = mapX(totalLength),
+            .height = exportedHeight(samples.back(), profile)
+        };
+    }
+};
+
+ColumnMapping makeColumnMapping(const LoadedPresentation& loaded,
+                                const std::vector<PresentationSample>& samples,
+                                const HeightProfile& heightProfile) {
+    const double totalLength = resolvedTrackLengthSeconds(loaded.metadata, samples);
+    return ColumnMapping{
+        .samples = samples,
+        .profile = heightProfile,
+        .totalLength = totalLength,
+        .lengthExtent = exportedLengthExtent(samples, totalLength, heightProfile)
+    };
+}
+
 bool buildColumnSamples(const LoadedPresentation& loaded,
                         const std::vector<PresentationSample>& samples,
                         const HeightProfile& heightProfile,
@@ -198,31 +262,37 @@ bool buildColumnSamples(const LoadedPresentation& loaded,
         return false;
     }
 
-    columns.reserve(samples.size() + 1U);
-    const double totalLength = resolvedTrackLengthSeconds(loaded.metadata, samples);
-    const double lengthExtent = exportedLengthExtent(samples, totalLength, heightProfile);
+    const ColumnMapping mapping = makeColumnMapping(loaded, samples, heightProfile);
+    columns.reserve(mapping.count());
+    for (std::size_t columnIndex = 0; columnIndex < mapping.count(); ++columnIndex) {
+        columns.push_back(mapping.at(columnIndex));
+    }
+    return columns.size() >= 2U;
+}
 
-    const auto mapX = [&heightProfile, totalLength, lengthExtent](const double timestamp) {
-        if (!heightProfile.normaliseLength) {
-            return static_cast<float>(timestamp);
-        }
-        return static_cast<float>((timestamp / totalLength) * lengthExtent);
-    };
+std::size_t solidIndexCount(const std::size_t columnCount) {
+    return (columnCount - 1U) * kSpanIndices.size() + kStartCapIndices.size() + kEndCapIndices.size();
+}
 
-    for (const auto& sample : samples) {
-        columns.push_back(ColumnSample{
-            .sample = sample,
-            .x = mapX(sample.timestamp),
-            .height = exportedHeight(sample, heightProfile)
-        });
+// Calls emit with each index of a solid over columnCount columns of four vertices.
+template <typename Emit>
+void emitSolidIndices(const std::size_t columnCount, Emit&& emit) {
+    for (std::size_t columnIndex = 0; columnIndex + 1U < columnCount; ++columnIndex) {
+        const auto baseIndex = static_cast<std::uint32_t>(columnIndex * 4U);
+        const auto nextIndex = static_cast<std::uint32_t>((columnIndex + 1U) * 4U);
+        for (const std::uint32_t index : kSpanIndices) {
+            emit(index < 4U ? baseIndex + index : nextIndex + (index - 4U));
+        }
     }
 
-    ColumnSample endColumn{};
-    endColumn.sample = samples.back();
-    endColumn.x = mapX(totalLength);
-    endColumn.height = exportedHeight(samples.back(), heightProfile);
-    columns.push_back(std::move(endColumn));
-    return columns.size() >= 2U;
+    const auto startBase = static_cast<std::uint32_t>(0U);
+    const auto endBase = static_cast<std::uint32_t>((columnCount - 1U) * 4U);
+    for (const std::uint32_t index : kStartCapIndices) {
+        emit(startBase + index);
+    }
+    for (const std::uint32_t index : kEndCapIndices) {
+        emit(endBase + index);
+    }
 }
 
 bool buildMeshPayload(const LoadedPresentation& loaded,
@@ -244,7 +314,7 @@ bool buildMeshPayload(const LoadedPresentation& loaded,
     payload.nativeDisplayColours.reserve(columns.size() * 12U);
     payload.labValues.reserve(columns.size() * 12U);
     payload.loudnessValues.reserve(columns.size() * 12U);
-    payload.indices.reserve((columns.size() - 1U) * 24U + 12U);
+    payload.indices.reserve(solidIndexCount(columns.size()));
 
     for (const auto& column : columns) {
         appendVertex(payload, column.sample, column.x, 0.0f, -kHalfRibbonDepth);
@@ -253,31 +323,9 @@ bool buildMeshPayload(const LoadedPresentation& loaded,
         appendVertex(payload, column.sample, column.x, column.height, kHalfRibbonDepth);
     }
 
-    for (std::size_t columnIndex = 0; columnIndex + 1U < columns.size(); ++columnIndex) {
-        const auto baseIndex = static_cast<std::uint32_t>(columnIndex * 4U);
-        const auto nextIndex = static_cast<std::uint32_t>((columnIndex + 1U) * 4U);
-
-        constexpr std::array<std::uint32_t, 24> kSpanIndices{
-            0U, 4U, 5U, 0U, 5U, 1U,
-            2U, 3U, 7U, 2U, 7U, 6U,
-            1U, 5U, 7U, 1U, 7U, 3U,
-            0U, 2U, 6U, 0U, 6U, 4U
-        };
-        for (const std::uint32_t index : kSpanIndices) {
-            payload.indices.push_back(index < 4U ? baseIndex + index : nextIndex + (index - 4U));
-        }
-    }
-
-    constexpr std::array<std::uint32_t, 6> kStartCapIndices{0U, 1U, 3U, 0U, 3U, 2U};
-    constexpr std::array<std::uint32_t, 6> kEndCapIndices{0U, 3U, 1U, 0U, 2U, 3U};
-    const auto startBase = static_cast<std::uint32_t>(0U);
-    const auto endBase = static_cast<std::uint32_t>((columns.size() - 1U) * 4U);
-    for (const std::uint32_t index : kStartCapIndices) {
-        payload.indices.push_back(startBase + index);
-    }
-    for (const std::uint32_t index : kEndCapIndices) {
-        payload.indices.push_back(endBase + index);
-    }
+    emitSolidIndices(columns.size(), [&payload](const std::uint32_t index) {
+        payload.indices.push_back(index);
+    });
 
     return !payload.indices.empty();
 }
@@ -553,39 +601,539 @@ bool writeModel(const fs::path& outputPath,
         false);
 }
 
+struct GlbOptions {
+    bool quantise = true;
+    int lodLevels = 0;
+};
+
+struct LodLevel {
+    // Columns the level keeps, in order. Empty keeps every column.
+    std::vector<std::uint32_t> kept;
+    std::size_t columnCount = 0;
+    float tolerance = 0.0f;
+
+    std::size_t column(const std::size_t index) const {
+        return kept.empty() ? index : kept[index];
+    }
+};
+
+float columnDelta(const ColumnSample& a, const ColumnSample& b, const float heightRange) {
+    const float colourDelta = std::max({
+        std::abs(a.sample.displayR - b.sample.displayR),
+        std::abs(a.sample.displayG - b.sample.displayG),
+        std::abs(a.sample.displayB - b.sample.displayB)
+    });
+    return std::max(colourDelta, std::abs(a.height - b.height) / heightRange);
 }
 
-int runGltfGradientCommand(const Arguments& args) {
-    if (args.inputDir.empty()) {
-        std::cerr << "Error: --misc gltf-gradient requires --input <file>\n";
-        return 1;
+// Drops each column within tolerance of the last one kept, in display colour or in height as
+// a fraction of its range. A column that jumps past tolerance from its neighbour keeps the
+// neighbour too, so a step stays a step rather than ramping across the run dropped before it.
+LodLevel decimateColumns(const ColumnMapping& mapping, const float tolerance) {
+    LodLevel level;
+    level.tolerance = tolerance;
+    const float heightRange = mapping.profile.normaliseHeight ? 1.0f : kMaximumLoudnessDb - kMinimumLoudnessDb;
+    const std::size_t lastColumn = mapping.count() - 1U;
+
+    level.kept.push_back(0U);
+    ColumnSample kept = mapping.at(0U);
+    ColumnSample previous = kept;
+    for (std::size_t columnIndex = 1U; columnIndex <= lastColumn; ++columnIndex) {
+        const ColumnSample current = mapping.at(columnIndex);
+        if (columnIndex == lastColumn || columnDelta(current, kept, heightRange) > tolerance) {
+            if (level.kept.back() != columnIndex - 1U && columnDelta(current, previous, heightRange) > tolerance) {
+                level.kept.push_back(static_cast<std::uint32_t>(columnIndex - 1U));
+            }
+            level.kept.push_back(static_cast<std::uint32_t>(columnIndex));
+            kept = current;
+        }
+        previous = current;
     }
-    if (args.outputDir.empty()) {
-        std::cerr << "Error: --misc gltf-gradient requires --output <file.gltf>\n";
-        return 1;
+    level.columnCount = level.kept.size();
+    return level;
+}
+
+// Quantised positions are uint16 steps from origin; the node's translation and scale take
+// them back to track units, as KHR_mesh_quantization expects.
+struct PositionQuantisation {
+    std::array<double, 3> origin{0.0, 0.0, 0.0};
+    std::array<double, 3> step{1.0, 1.0, 1.0};
+
+    std::uint16_t quantise(const double value, const std::size_t axis) const {
+        const double steps = std::round((value - origin[axis]) / step[axis]);
+        return static_cast<std::uint16_t>(std::clamp(steps, 0.0, kQuantisedPositionMax));
     }
+};
 
-    const fs::path outputPath(args.outputDir);
-    std::string outputExtension = outputPath.extension().string();
-    std::transform(outputExtension.begin(), outputExtension.end(), outputExtension.begin(), [](const unsigned char c) {
-        return static_cast<char>(std::tolower(c));
+struct StreamView {
+    std::uint64_t byteOffset = 0;
+    std::uint64_t byteLength = 0;
+    std::size_t byteStride = 0;
+    int target = 0;
+};
+
+struct LevelLayout {
+    std::size_t vertexCount = 0;
+    std::size_t indexCount = 0;
+    bool wideIndices = true;
+    StreamView indices;
+    StreamView positions;
+    StreamView renderColours;
+    StreamView nativeDisplayColours;
+    StreamView labValues;
+    StreamView loudnessValues;
+};
+
+// Vertex attributes are padded to four bytes per element, which glTF requires of strides.
+LevelLayout layOutLevel(const LodLevel& level, const GlbOptions& options, std::uint64_t& bufferLength) {
+    LevelLayout layout;
+    layout.vertexCount = level.columnCount * 4U;
+    layout.indexCount = solidIndexCount(level.columnCount);
+    layout.wideIndices = layout.vertexCount > std::numeric_limits<std::uint16_t>::max();
+
+    const auto place = [&bufferLength](StreamView& view,
+                                       const std::size_t count,
+                                       const std::size_t elementBytes,
+                                       const std::size_t stride,
+                                       const int target) {
+        bufferLength = (bufferLength + 3U) & ~std::uint64_t{3};
+        view.byteOffset = bufferLength;
+        view.byteLength = static_cast<std::uint64_t>(count) * elementBytes;
+        view.byteStride = stride;
+        view.target = target;
+        bufferLength += view.byteLength;
+    };
+    place(layout.indices, layout.indexCount, layout.wideIndices ? 4U : 2U, 0U, TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER);
+    if (options.quantise) {
+        place(layout.positions, layout.vertexCount, 8U, 8U, TINYGLTF_TARGET_ARRAY_BUFFER);
+        place(layout.renderColours, layout.vertexCount, 8U, 8U, TINYGLTF_TARGET_ARRAY_BUFFER);
+        place(layout.nativeDisplayColours, layout.vertexCount, 4U, 4U, TINYGLTF_TARGET_ARRAY_BUFFER);
+    } else {
+        place(layout.positions, layout.vertexCount, 12U, 0U, TINYGLTF_TARGET_ARRAY_BUFFER);
+        place(layout.renderColours, layout.vertexCount, 12U, 0U, TINYGLTF_TARGET_ARRAY_BUFFER);
+        place(layout.nativeDisplayColours, layout.vertexCount, 12U, 0U, TINYGLTF_TARGET_ARRAY_BUFFER);
+    }
+    place(layout.labValues, layout.vertexCount, 12U, 0U, TINYGLTF_TARGET_ARRAY_BUFFER);
+    place(layout.loudnessValues, layout.vertexCount, 12U, 0U, TINYGLTF_TARGET_ARRAY_BUFFER);
+    return layout;
+}
+
+PositionQuantisation measurePositions(const ColumnMapping& mapping) {
+    double minX = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxHeight = 0.0;
+    for (std::size_t columnIndex = 0; columnIndex < mapping.count(); ++columnIndex) {
+        const ColumnSample column = mapping.at(columnIndex);
+        minX = std::min(minX, static_cast<double>(column.x));
+        maxX = std::max(maxX, static_cast<double>(column.x));
+        maxHeight = std::max(maxHeight, static_cast<double>(column.height));
+    }
+
+    PositionQuantisation quantisation;
+    quantisation.origin = {minX, 0.0, static_cast<double>(-kHalfRibbonDepth)};
+    const std::array<double, 3> extent{maxX - minX, maxHeight, static_cast<double>(kHalfRibbonDepth) * 2.0};
+    for (std::size_t axis = 0; axis < 3U; ++axis) {
+        quantisation.step[axis] = extent[axis] > 0.0 ? extent[axis] / kQuantisedPositionMax : 1.0;
+    }
+    return quantisation;
+}
+
+std::uint16_t unorm16(const float value) {
+    return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+std::uint8_t unorm8(const float value) {
+    return static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+nlohmann::json toJson(const tinygltf::Value& value) {
+    if (value.IsBool()) {
+        return value.Get<bool>();
+    }
+    if (value.IsInt()) {
+        return value.Get<int>();
+    }
+    if (value.IsNumber()) {
+        return value.GetNumberAsDouble();
+    }
+    if (value.IsString()) {
+        return value.Get<std::string>();
+    }
+    if (value.IsArray()) {
+        nlohmann::json array = nlohmann::json::array();
+        for (std::size_t index = 0; index < value.ArrayLen(); ++index) {
+            array.push_back(toJson(value.Get(static_cast<int>(index))));
+        }
+        return array;
+    }
+    if (value.IsObject()) {
+        nlohmann::json object = nlohmann::json::object();
+        for (const auto& key : value.Keys()) {
+            object[key] = toJson(value.Get(key));
+        }
+        return object;
+    }
+    return nullptr;
+}
+
+nlohmann::json bufferViewJson(const StreamView& view) {
+    nlohmann::json json{
+        {"buffer", 0},
+        {"byteOffset", view.byteOffset},
+        {"byteLength", view.byteLength},
+        {"target", view.target}
+    };
+    if (view.byteStride != 0U) {
+        json["byteStride"] = view.byteStride;
+    }
+    return json;
+}
+
+nlohmann::json accessorJson(const std::size_t bufferView,
+                            const int componentType,
+                            const bool normalized,
+                            const char* type,
+                            const std::size_t count) {
+    nlohmann::json json{
+        {"bufferView", bufferView},
+        {"componentType", componentType},
+        {"count", count},
+        {"type", type}
+    };
+    if (normalized) {
+        json["normalized"] = true;
+    }
+    return json;
+}
+
+std::string buildGlbJson(const LoadedPresentation& loaded,
+                         const std::vector<PresentationSample>& samples,
+                         const ColumnMapping& mapping,
+                         const GlbOptions& options,
+                         const std::vector<LodLevel>& levels,
+                         const std::vector<LevelLayout>& layouts,
+                         const PositionQuantisation& quantisation,
+                         const std::uint64_t bufferLength) {
+    nlohmann::json document;
+    document["asset"] = {{"version", "2.0"}, {"generator", "Synesthesia CLI gltf-gradient"}};
+
+    nlohmann::json modelExtras = toJson(buildModelExtras(loaded, samples, mapping.profile));
+    modelExtras["vertex_encoding"] = options.quantise ? "KHR_mesh_quantization" : "float32";
+    modelExtras["lod_levels"] = levels.size() - 1U;
+    document["extras"] = std::move(modelExtras);
+
+    nlohmann::json extensionsUsed = nlohmann::json::array({"KHR_materials_unlit"});
+    if (options.quantise) {
+        extensionsUsed.push_back("KHR_mesh_quantization");
+        document["extensionsRequired"] = nlohmann::json::array({"KHR_mesh_quantization"});
+    }
+    if (levels.size() > 1U) {
+        extensionsUsed.push_back("MSFT_lod");
+    }
+    document["extensionsUsed"] = std::move(extensionsUsed);
+
+    document["buffers"] = nlohmann::json::array({{{"byteLength", bufferLength}}});
+    document["materials"] = nlohmann::json::array({{
+        {"name", "GradientSolid"},
+        {"doubleSided", true},
+        {"pbrMetallicRoughness", {
+            {"baseColorFactor", {1.0, 1.0, 1.0, 1.0}},
+            {"metallicFactor", 0.0},
+            {"roughnessFactor", 1.0}
+        }},
+        {"extensions", {{"KHR_materials_unlit", nlohmann::json::object()}}}
+    }});
+
+    const nlohmann::json primitiveExtras = toJson(buildPrimitiveExtras(loaded, samples, mapping.profile));
+    nlohmann::json& bufferViews = document["bufferViews"];
+    nlohmann::json& accessors = document["accessors"];
+    nlohmann::json& meshes = document["meshes"];
+    nlohmann::json& nodes = document["nodes"];
+    bufferViews = nlohmann::json::array();
+    accessors = nlohmann::json::array();
+    meshes = nlohmann::json::array();
+    nodes = nlohmann::json::array();
+
+    const std::string stem = loaded.inputPath.stem().string();
+    for (std::size_t levelIndex = 0; levelIndex < levels.size(); ++levelIndex) {
+        const LodLevel& level = levels[levelIndex];
+        const LevelLayout& layout = layouts[levelIndex];
+
+        double minX = std::numeric_limits<double>::max();
+        double maxX = std::numeric_limits<double>::lowest();
+        double maxHeight = 0.0;
+        for (std::size_t index = 0; index < level.columnCount; ++index) {
+            const ColumnSample column = mapping.at(level.column(index));
+            minX = std::min(minX, static_cast<double>(column.x));
+            maxX = std::max(maxX, static_cast<double>(column.x));
+            maxHeight = std::max(maxHeight, static_cast<double>(column.height));
+        }
+        std::array<double, 3> minPosition{minX, 0.0, static_cast<double>(-kHalfRibbonDepth)};
+        std::array<double, 3> maxPosition{maxX, maxHeight, static_cast<double>(kHalfRibbonDepth)};
+        if (options.quantise) {
+            for (std::size_t axis = 0; axis < 3U; ++axis) {
+                minPosition[axis] = quantisation.quantise(minPosition[axis], axis);
+                maxPosition[axis] = quantisation.quantise(maxPosition[axis], axis);
+            }
+        }
+
+        const std::size_t firstView = bufferViews.size();
+        for (const StreamView* view : {&layout.indices, &layout.positions, &layout.renderColours,
+                                       &layout.nativeDisplayColours, &layout.labValues, &layout.loudnessValues}) {
+            bufferViews.push_back(bufferViewJson(*view));
+        }
+
+        const std::size_t firstAccessor = accessors.size();
+        accessors.push_back(accessorJson(
+            firstView,
+            layout.wideIndices ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+            false,
+            "SCALAR",
+            layout.indexCount));
+        nlohmann::json positionAccessor = accessorJson(
+            firstView + 1U,
+            options.quantise ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_FLOAT,
+            false,
+            "VEC3",
+            layout.vertexCount);
+        positionAccessor["min"] = minPosition;
+        positionAccessor["max"] = maxPosition;
+        accessors.push_back(std::move(positionAccessor));
+        accessors.push_back(accessorJson(
+            firstView + 2U,
+            options.quantise ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_FLOAT,
+            options.quantise,
+            "VEC3",
+            layout.vertexCount));
+        accessors.push_back(accessorJson(
+            firstView + 3U,
+            options.quantise ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE : TINYGLTF_COMPONENT_TYPE_FLOAT,
+            options.quantise,
+            "VEC3",
+            layout.vertexCount));
+        accessors.push_back(accessorJson(firstView + 4U, TINYGLTF_COMPONENT_TYPE_FLOAT, false, "VEC3", layout.vertexCount));
+        accessors.push_back(accessorJson(firstView + 5U, TINYGLTF_COMPONENT_TYPE_FLOAT, false, "VEC3", layout.vertexCount));
+
+        nlohmann::json extras = primitiveExtras;
+        extras["lod_level"] = levelIndex;
+        extras["column_count"] = level.columnCount;
+        extras["lod_tolerance"] = level.tolerance;
+
+        const std::string suffix = levelIndex == 0U ? "" : "_lod" + std::to_string(levelIndex);
+        meshes.push_back({
+            {"name", stem + "_gradient" + suffix},
+            {"primitives", nlohmann::json::array({{
+                {"indices", firstAccessor},
+                {"material", 0},
+                {"mode", TINYGLTF_MODE_TRIANGLES},
+                {"attributes", {
+                    {"POSITION", firstAccessor + 1U},
+                    {"COLOR_0", firstAccessor + 2U},
+                    {"_SYNESTHESIA_DISPLAY_RGB", firstAccessor + 3U},
+                    {"_SYNESTHESIA_LAB", firstAccessor + 4U},
+                    {"_SYNESTHESIA_LOUDNESS", firstAccessor + 5U}
+                }},
+                {"extras", std::move(extras)}
+            }})}
+        });
+
+        nlohmann::json node{{"name", stem + suffix}, {"mesh", levelIndex}};
+        if (options.quantise) {
+            node["translation"] = quantisation.origin;
+            node["scale"] = quantisation.step;
+        }
+        nodes.push_back(std::move(node));
+    }
+
+    // Only the full detail node is in the scene; MSFT_lod points viewers at the rest, each
+    // taking over at half the screen coverage of the level before.
+    if (levels.size() > 1U) {
+        nlohmann::json ids = nlohmann::json::array();
+        nlohmann::json coverage = nlohmann::json::array();
+        double threshold = 0.5;
+        for (std::size_t levelIndex = 1; levelIndex < levels.size(); ++levelIndex) {
+            ids.push_back(levelIndex);
+            coverage.push_back(threshold);
+            threshold *= 0.5;
+        }
+        coverage.push_back(0.0);
+        nodes[0]["extensions"] = {{"MSFT_lod", {{"ids", std::move(ids)}}}};
+        nodes[0]["extras"] = {{"MSFT_screencoverage", std::move(coverage)}};
+    }
+
+    document["scenes"] = nlohmann::json::array({{{"name", "Scene"}, {"nodes", nlohmann::json::array({0})}}});
+    document["scene"] = 0;
+    return document.dump();
+}
+
+void streamLevel(GlbStreamWriter& writer,
+                 const ColumnMapping& mapping,
+                 const LodLevel& level,
+                 const LevelLayout& layout,
+                 const GlbOptions& options,
+                 const PositionQuantisation& quantisation) {
+    const auto forEachColumn = [&mapping, &level](const auto& emit) {
+        for (std::size_t index = 0; index < level.columnCount; ++index) {
+            emit(mapping.at(level.column(index)));
+        }
+    };
+    const auto writeFloats = [&writer](const float a, const float b, const float c) {
+        const std::array<float, 3> values{a, b, c};
+        writer.write(values.data(), sizeof(values));
+    };
+
+    writer.align(4U);
+    emitSolidIndices(level.columnCount, [&writer, &layout](const std::uint32_t index) {
+        if (layout.wideIndices) {
+            writer.write(&index, sizeof(index));
+        } else {
+            const auto narrow = static_cast<std::uint16_t>(index);
+            writer.write(&narrow, sizeof(narrow));
+        }
     });
-    if (outputExtension != ".gltf") {
-        std::cerr << "Error: gltf-gradient requires an .gltf output path\n";
-        return 1;
+
+    // Vertices go bottom then top at the near edge, then the same at the far edge, as
+    // buildMeshPayload lays them out.
+    writer.align(4U);
+    forEachColumn([&](const ColumnSample& column) {
+        const std::array<std::array<float, 2>, 4> corners{{
+            {0.0f, -kHalfRibbonDepth},
+            {column.height, -kHalfRibbonDepth},
+            {0.0f, kHalfRibbonDepth},
+            {column.height, kHalfRibbonDepth}
+        }};
+        for (const auto& corner : corners) {
+            if (options.quantise) {
+                const std::array<std::uint16_t, 4> position{
+                    quantisation.quantise(column.x, 0U),
+                    quantisation.quantise(corner[0], 1U),
+                    quantisation.quantise(corner[1], 2U),
+                    0U
+                };
+                writer.write(position.data(), sizeof(position));
+            } else {
+                writeFloats(column.x, corner[0], corner[1]);
+            }
+        }
+    });
+
+    writer.align(4U);
+    forEachColumn([&](const ColumnSample& column) {
+        const PresentationSample& sample = column.sample;
+        for (int vertex = 0; vertex < 4; ++vertex) {
+            if (options.quantise) {
+                const std::array<std::uint16_t, 4> colour{
+                    unorm16(sample.linearRenderR),
+                    unorm16(sample.linearRenderG),
+                    unorm16(sample.linearRenderB),
+                    0U
+                };
+                writer.write(colour.data(), sizeof(colour));
+            } else {
+                writeFloats(sample.linearRenderR, sample.linearRenderG, sample.linearRenderB);
+            }
+        }
+    });
+
+    writer.align(4U);
+    forEachColumn([&](const ColumnSample& column) {
+        const PresentationSample& sample = column.sample;
+        for (int vertex = 0; vertex < 4; ++vertex) {
+            if (options.quantise) {
+                const std::array<std::uint8_t, 4> colour{
+                    unorm8(sample.displayR),
+                    unorm8(sample.displayG),
+                    unorm8(sample.displayB),
+                    0U
+                };
+                writer.write(colour.data(), sizeof(colour));
+            } else {
+                writeFloats(sample.displayR, sample.displayG, sample.displayB);
+            }
+        }
+    });
+
+    writer.align(4U);
+    forEachColumn([&](const ColumnSample& column) {
+        for (int vertex = 0; vertex < 4; ++vertex) {
+            writeFloats(column.sample.labL, column.sample.labA, column.sample.labB);
+        }
+    });
+
+    writer.align(4U);
+    forEachColumn([&](const ColumnSample& column) {
+        for (const float y : {0.0f, column.height, 0.0f, column.height}) {
+            writeFloats(column.sample.loudnessDb, column.sample.loudnessNormalised, y);
+        }
+    });
+}
+
+// Lays the buffer out from the column counts alone, writes the JSON that describes it, then
+// streams each level's columns straight into the BIN chunk.
+bool writeStreamedGlb(const fs::path& outputPath,
+                      const LoadedPresentation& loaded,
+                      const std::vector<PresentationSample>& samples,
+                      const HeightProfile& heightProfile,
+                      const GlbOptions& options,
+                      std::vector<std::size_t>& levelColumns,
+                      std::string& errorMessage) {
+    if (samples.empty()) {
+        errorMessage = "no presentation samples to export";
+        return false;
+    }
+
+    const ColumnMapping mapping = makeColumnMapping(loaded, samples, heightProfile);
+    std::vector<LodLevel> levels(1U);
+    levels.front().columnCount = mapping.count();
+    float tolerance = kLodBaseTolerance;
+    for (int lodLevel = 1; lodLevel <= options.lodLevels; ++lodLevel) {
+        levels.push_back(decimateColumns(mapping, tolerance));
+        tolerance *= 2.0f;
+    }
+
+    std::uint64_t bufferLength = 0;
+    std::vector<LevelLayout> layouts;
+    layouts.reserve(levels.size());
+    levelColumns.clear();
+    for (const LodLevel& level : levels) {
+        layouts.push_back(layOutLevel(level, options, bufferLength));
+        levelColumns.push_back(level.columnCount);
     }
 
+    const PositionQuantisation quantisation = measurePositions(mapping);
+    const std::string json = buildGlbJson(
+        loaded, samples, mapping, options, levels, layouts, quantisation, bufferLength);
+
+    GlbStreamWriter writer;
+    if (!writer.open(outputPath, json, bufferLength, errorMessage)) {
+        return false;
+    }
+    for (std::size_t levelIndex = 0; levelIndex < levels.size(); ++levelIndex) {
+        streamLevel(writer, mapping, levels[levelIndex], layouts[levelIndex], options, quantisation);
+    }
+    return writer.finish(errorMessage);
+}
+
+std::string lowerExtension(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return extension;
+}
+
+// outputPath has been checked to end in .gltf or .glb.
+MiscExportResult exportGltfGradient(const Arguments& args, const fs::path& outputPath) {
+    MiscExportResult result;
     LoadedPresentation loaded;
-    std::string errorMessage;
-    if (!loadPresentationForInput(args, loaded, errorMessage)) {
-        std::cerr << "Error: " << errorMessage << '\n';
-        return 1;
+    if (!loadPresentationForInput(args, loaded, result.error)) {
+        return result;
     }
 
     std::vector<PresentationSample> samples;
     if (!collectPresentationSamples(loaded, samples)) {
-        std::cerr << "Error: could not collect presentation samples\n";
-        return 1;
+        result.error = "could not collect presentation samples";
+        return result;
     }
 
     const HeightProfile heightProfile{
@@ -593,19 +1141,74 @@ int runGltfGradientCommand(const Arguments& args) {
         .normaliseLength = args.normaliseLength
     };
 
+    if (lowerExtension(outputPath) == ".glb") {
+        const GlbOptions options{
+            .quantise = !args.glbFloat,
+            .lodLevels = std::clamp(args.gltfLodLevels, 0, kMaxLodLevels)
+        };
+        std::vector<std::size_t> levelColumns;
+        if (!writeStreamedGlb(outputPath, loaded, samples, heightProfile, options, levelColumns, result.error)) {
+            return result;
+        }
+
+        result.exported = true;
+        result.description = "GLB gradient";
+        for (std::size_t level = 1; level < levelColumns.size(); ++level) {
+            result.details.push_back("LOD " + std::to_string(level) + ": " + std::to_string(levelColumns[level]) +
+                                     " of " + std::to_string(levelColumns.front()) + " columns");
+        }
+        return result;
+    }
+
     tinygltf::Model model;
     if (!buildModel(loaded, samples, heightProfile, model)) {
-        std::cerr << "Error: failed to build GLTF model\n";
-        return 1;
+        result.error = "failed to build GLTF model";
+        return result;
     }
 
     if (!writeModel(outputPath, model)) {
-        std::cerr << "Error: failed to write GLTF output\n";
+        result.error = "failed to write GLTF output";
+        return result;
+    }
+
+    result.exported = true;
+    result.description = "GLTF gradient";
+    return result;
+}
+
+}
+
+int runGltfGradientCommand(const Arguments& args) {
+    if (args.inputDir.empty()) {
+        std::cerr << "Error: --misc gltf-gradient requires --input <file|dir|glob>\n";
+        return 1;
+    }
+
+    // A batch's --output is a directory, so its format comes from --misc-format.
+    const bool batch = isBatchInput(args.inputDir);
+    if (!batch && args.outputDir.empty()) {
+        std::cerr << "Error: --misc gltf-gradient requires --output <file.gltf|file.glb>\n";
+        return 1;
+    }
+    const fs::path outputPath(args.outputDir);
+    const std::string outputExtension = batch
+        ? "." + (args.miscFormat.empty() ? std::string("glb") : args.miscFormat)
+        : lowerExtension(outputPath);
+    const bool binaryOutput = outputExtension == ".glb";
+    if (outputExtension != ".gltf" && !binaryOutput) {
+        std::cerr << (batch ? "Error: --misc-format for gltf-gradient must be 'gltf' or 'glb'\n"
+                            : "Error: gltf-gradient requires a .gltf or .glb output path\n");
+        return 1;
+    }
+    if (!binaryOutput && (args.gltfLodLevels > 0 || args.glbFloat)) {
+        std::cerr << "Error: --lod-levels and --glb-float apply to .glb output only\n";
         return 1;
     }
 
-    std::cout << "Exported GLTF gradient: " << outputPath << '\n';
-    return 0;
+    if (batch) {
+        return runMiscBatch(args, "gltf-gradient", outputExtension, exportGltfGradient);
+    }
+    return reportMiscExport(exportGltfGradient(args, outputPath), outputPath);
 }
 
 }
@@ -0,0 +1,261 @@
+#include "misc/misc_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <system_error>
+
+#include "batch_exporter.h"
+#include "batch_memory_budget.h"
+#include "misc/presentation_export_utils.h"
+#include "utilities/threading/task_scheduler.h"
+
+namespace fs = std::filesystem;
+
+namespace CLI::Misc {
+
+namespace {
+
+using Utilities::Threading::TaskContext;
+using Utilities::Threading::TaskHandle;
+using Utilities::Threading::TaskPriority;
+using Utilities::Threading::TaskScheduler;
+
+bool hasWildcard(const std::string& text) {
+    return text.find_first_of("*?") != std::string::npos;
+}
+
+// '*' matches any run of characters and '?' any one, backtracking to the last '*' on a
+// mismatch.
+bool globMatch(const std::string& pattern, const std::string& text) {
+    std::size_t p = 0;
+    std::size_t t = 0;
+    std::size_t starPattern = std::string::npos;
+    std::size_t starText = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starText = t;
+        } else if (starPattern != std::string::npos) {
+            p = starPattern + 1;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool isPresentationInput(const fs::path& path) {
+    return isRsynPath(path) || isAudioPath(path);
+}
+
+// A directory is scanned recursively; a glob matches file names in one directory, so
+// wildcards may only appear in its last component.
+bool collectInputs(const std::string& input,
+                   fs::path& root,
+                   std::vector<fs::path>& inputs,
+                   std::string& errorMessage) {
+    inputs.clear();
+    std::error_code ec;
+    if (fs::is_directory(input, ec)) {
+        root = fs::path(input);
+        for (const auto& entry :
+             fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec)) {
+            if (entry.is_regular_file(ec) && isPresentationInput(entry.path())) {
+                inputs.push_back(entry.path());
+            }
+        }
+    } else {
+        const fs::path pattern(input);
+        root = pattern.has_parent_path() ? pattern.parent_path() : fs::path(".");
+        if (hasWildcard(root.string())) {
+            errorMessage = "wildcards are only supported in the file name of --input";
+            return false;
+        }
+        if (!fs::is_directory(root, ec)) {
+            errorMessage = "input directory does not exist: " + root.string();
+            return false;
+        }
+        const std::string namePattern = pattern.filename().string();
+        for (const auto& entry : fs::directory_iterator(root, fs::directory_options::skip_permission_denied, ec)) {
+            if (entry.is_regular_file(ec) && isPresentationInput(entry.path()) &&
+                globMatch(namePattern, entry.path().filename().string())) {
+                inputs.push_back(entry.path());
+            }
+        }
+    }
+    std::sort(inputs.begin(), inputs.end());
+
+    // As in batch export, audio with an archive beside it is taken from the archive, which
+    // would otherwise write the same output.
+    std::vector<fs::path> archives;
+    std::copy_if(inputs.begin(), inputs.end(), std::back_inserter(archives), isRsynPath);
+    std::erase_if(inputs, [&](const fs::path& file) {
+        if (isRsynPath(file)) {
+            return false;
+        }
+        fs::path archive = file;
+        archive.replace_extension(".rsyn");
+        return std::binary_search(archives.begin(), archives.end(), archive);
+    });
+    return true;
+}
+
+}
+
+int reportMiscExport(const MiscExportResult& result, const fs::path& outputPath) {
+    if (!result.exported) {
+        std::cerr << "Error: " << result.error << '\n';
+        return 1;
+    }
+    std::cout << "Exported " << result.description << ": " << outputPath << '\n';
+    for (const auto& detail : result.details) {
+        std::cout << "  " << detail << '\n';
+    }
+    return 0;
+}
+
+bool isBatchInput(const std::string& input) {
+    std::error_code ec;
+    return fs::is_directory(input, ec) || hasWildcard(fs::path(input).filename().string());
+}
+
+int runMiscBatch(const Arguments& args,
+                 const std::string& commandName,
+                 const std::string& outputExtension,
+                 const MiscFileExport& exportFile) {
+    if (args.outputDir.empty()) {
+        std::cerr << "Error: --misc " << commandName << " with a directory or glob --input requires --output <dir>\n";
+        return 1;
+    }
+
+    fs::path inputRoot;
+    std::vector<fs::path> inputs;
+    std::string errorMessage;
+    if (!collectInputs(args.inputDir, inputRoot, inputs, errorMessage)) {
+        std::cerr << "Error: " << errorMessage << '\n';
+        return 1;
+    }
+    if (inputs.empty()) {
+        std::cout << "No audio or .rsyn files found in: " << args.inputDir << '\n';
+        return 0;
+    }
+
+    const fs::path outputRoot(args.outputDir);
+    std::error_code ec;
+    fs::create_directories(outputRoot, ec);
+    if (ec) {
+        std::cerr << "Error: Could not create output directory: " << outputRoot << " - " << ec.message() << '\n';
+        return 1;
+    }
+
+    TaskScheduler& scheduler = TaskScheduler::shared();
+    const std::size_t total = inputs.size();
+    std::cout << "Found " << total << " input file(s).\n";
+    std::cout << "Using " << scheduler.workerCount() << " worker threads.\n\n";
+
+    // Largest first, as in batch export, so the long files are not left for the tail.
+    std::unique_ptr<BatchMemoryBudget> memoryBudget;
+    if (args.memoryBudgetMiB > 0) {
+        memoryBudget = std::make_unique<BatchMemoryBudget>(static_cast<std::size_t>(args.memoryBudgetMiB) << 20);
+        std::cout << "Memory budget: " << args.memoryBudgetMiB << " MiB\n";
+    }
+    std::vector<std::size_t> fileCosts(total, 0);
+    for (std::size_t i = 0; i < total; ++i) {
+        if (memoryBudget) {
+            fileCosts[i] = BatchExporter::estimateFileCost(inputs[i].string(), args.analysisHop);
+        } else {
+            const std::uintmax_t size = fs::file_size(inputs[i], ec);
+            fileCosts[i] = ec ? 0 : static_cast<std::size_t>(size);
+        }
+    }
+    std::vector<std::size_t> order(total);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](const std::size_t lhs, const std::size_t rhs) {
+        return fileCosts[lhs] > fileCosts[rhs];
+    });
+
+    std::atomic<std::size_t> exported{0};
+    std::atomic<std::size_t> failed{0};
+    std::mutex outputMutex;
+    std::vector<TaskHandle> handles;
+    handles.reserve(total);
+    for (const std::size_t idx : order) {
+        // Blocks here, outside the pool, so a file waiting on the budget holds no worker.
+        if (memoryBudget) {
+            if (fileCosts[idx] > memoryBudget->budget()) {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << "Note: " << inputs[idx].filename().string() << " needs about "
+                          << (fileCosts[idx] >> 20) << " MiB, over the memory budget; it will run alone\n";
+            }
+            memoryBudget->acquire(fileCosts[idx]);
+        }
+        handles.push_back(scheduler.submit(TaskPriority::Background, [&, idx](const TaskContext&) {
+            Arguments fileArgs = args;
+            fileArgs.inputDir = inputs[idx].string();
+            fs::path outputPath = outputRoot / inputs[idx].lexically_relative(inputRoot);
+            outputPath.replace_extension(outputExtension);
+
+            MiscExportResult result;
+            std::error_code directoryError;
+            fs::create_directories(outputPath.parent_path(), directoryError);
+            if (directoryError) {
+                result.error = "could not create " + outputPath.parent_path().string();
+            } else {
+                try {
+                    result = exportFile(fileArgs, outputPath);
+                } catch (const std::exception& exception) {
+                    result = MiscExportResult{};
+                    result.error = exception.what();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << "[" << (idx + 1) << "/" << total << "] " << inputs[idx].filename().string() << " ... ";
+                if (result.exported) {
+                    std::cout << "done (" << result.description << ")\n";
+                    for (const auto& detail : result.details) {
+                        std::cout << "    " << detail << '\n';
+                    }
+                } else {
+                    std::cout << "failed (" << result.error << ")\n";
+                }
+            }
+
+            (result.exported ? exported : failed).fetch_add(1, std::memory_order_relaxed);
+            if (memoryBudget) {
+                memoryBudget->release(fileCosts[idx]);
+            }
+        }));
+    }
+    for (const auto& handle : handles) {
+        handle.wait();
+    }
+
+    std::cout << "\n=== Export Complete ===\n";
+    std::cout << "Exported: " << exported.load(std::memory_order_relaxed) << " file(s)\n";
+    if (memoryBudget) {
+        std::cout << "Peak estimated memory in flight: " << (memoryBudget->peakReserved() >> 20) << " MiB\n";
+    }
+    if (failed.load(std::memory_order_relaxed) > 0) {
+        std::cout << "Failed:   " << failed.load(std::memory_order_relaxed) << " file(s)\n";
+    }
+    std::cout << "Output:   " << fs::absolute(outputRoot) << '\n';
+    return failed.load(std::memory_order_relaxed) > 0 ? 1 : 0;
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "cli.h"
+
+namespace CLI::Misc {
+
+// What exporting one input produced, for the caller to print: the kind of output and any
+// detail lines when it was written, else why not.
+struct MiscExportResult {
+    bool exported = false;
+    std::string description;
+    std::vector<std::string> details;
+    std::string error;
+};
+
+// Exports the single --input of fileArgs to outputPath. Runs concurrently in a batch, so it
+// reports only through its result.
+using MiscFileExport = std::function<MiscExportResult(const Arguments& fileArgs,
+                                                      const std::filesystem::path& outputPath)>;
+
+// Prints a single-file result as "Exported <description>: <path>" and its details, or the
+// error; returns the command's exit code.
+int reportMiscExport(const MiscExportResult& result, const std::filesystem::path& outputPath);
+
+// True when --input names a directory, or a glob such as "library/*.rsyn", rather than a file.
+bool isBatchInput(const std::string& input);
+
+// Runs exportFile for every audio and .rsyn file under a directory --input, or every file a
+// glob --input matches, on the shared scheduler, each written to --output (a directory) at its
+// path relative to the input with outputExtension. A file is only started once a worker takes
+// it, and under --memory-budget once its estimated cost fits beside the files in flight, so
+// memory stays bounded however many files there are. Each file's outcome is printed as it
+// finishes; returns non-zero if any failed.
+int runMiscBatch(const Arguments& args,
+                 const std::string& commandName,
+                 const std::string& outputExtension,
+                 const MiscFileExport& exportFile);
+
+}
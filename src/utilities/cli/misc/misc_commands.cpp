@@ -5,6 +5,8 @@
 #include <iostream>
 #include <string>
 
+#include "misc/benchmark_suite_command.h"
+#include "misc/fft_benchmark_command.h"
 #include "misc/gltf_gradient_command.h"
 #include "misc/vector_gradient_command.h"
 
@@ -29,6 +31,12 @@ int MiscCommands::run(const Arguments& args) {
     if (command == "vector-gradient") {
         return Misc::runVectorGradientCommand(args);
     }
+    if (command == "fft-benchmark") {
+        return Misc::runFFTBenchmarkCommand(args);
+    }
+    if (command == "benchmark-suite") {
+        return Misc::runBenchmarkSuiteCommand(args);
+    }
 
     std::cerr << "Error: unknown misc command '" << args.miscCommand << "'\n";
     return 1;
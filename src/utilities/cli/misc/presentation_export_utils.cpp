@@ -43,7 +43,7 @@ PresentationTrack resolvePresentationTrack(const RSYNPresentationData& presentat
         : PresentationTrack::Analysis;
 }
 
-bool buildPresentationFromSamples(const std::vector<AudioColourSample>& spectralSamples,
+bool buildPresentationFromSamples(const SpectralSequenceView spectralSamples,
                                   AudioMetadata& metadata,
                                   const bool disableSmoothing) {
     RSYNPresentationSettings settings{};
@@ -151,7 +151,7 @@ bool loadPresentationForInput(const Arguments& args,
         }
 
         if (loaded.metadata.presentationData == nullptr || loaded.metadata.presentationData->frames.empty()) {
-            std::vector<AudioColourSample> spectralSamples;
+            SpectralSequence spectralSamples;
             if (!SequenceExporter::hydrateRsynSamples(loaded.metadata, spectralSamples) ||
                 !buildPresentationFromSamples(spectralSamples, loaded.metadata, args.disableSmoothing)) {
                 errorMessage = "failed to build presentation data from RSYN samples";
@@ -159,7 +159,7 @@ bool loadPresentationForInput(const Arguments& args,
             }
         }
     } else if (isAudioPath(loaded.inputPath)) {
-        std::vector<AudioColourSample> spectralSamples;
+        SpectralSequence spectralSamples;
         if (!ReSyne::ImportHelpers::importAudioFile(
                 loaded.inputPath.string(),
                 ColourCore::ColourSpace::Rec2020,
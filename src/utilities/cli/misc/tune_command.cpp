@@ -0,0 +1,343 @@
+#include "misc/tune_command.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "audio/analysis/fft/fft_backend.h"
+#include "audio/analysis/fft/fft_processor.h"
+#include "batch_exporter.h"
+#include "colour/colour_core.h"
+#include "resyne/encoding/audio/wav_encoder.h"
+#include "utilities/cpu/cpu_features.h"
+#include "utilities/tuning/wisdom.h"
+
+namespace CLI::Misc {
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+constexpr float SAMPLE_RATE = 44100.0f;
+// FFTProcessor's supported sizes, any of which an import or the live analysis may be set to.
+constexpr int FFT_SIZES[] = {512, 1024, 2048, 4096, 8192};
+constexpr double KERNEL_SIGNAL_SECONDS = 10.0;
+// Long enough that the frame workers' start-up is amortised as it is over a real import.
+constexpr double ANALYSIS_SIGNAL_SECONDS = 120.0;
+constexpr double BATCH_FILE_SECONDS = 5.0;
+constexpr size_t MAX_BATCH_FILES = 16;
+constexpr double TRANSFORM_SECONDS = 0.1;
+constexpr int REPETITIONS = 5;
+// A later candidate has to be this much faster to displace an earlier one, so timing noise
+// does not trade the default for a nominal gain.
+constexpr double MARGIN = 0.03;
+
+std::vector<float> synthesiseSignal(const double seconds) {
+    const auto length = static_cast<size_t>(seconds * SAMPLE_RATE);
+    std::vector<float> signal(length);
+    std::mt19937 rng(0x5EED);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+    double phase = 0.0;
+    for (size_t i = 0; i < length; ++i) {
+        const double t = static_cast<double>(i) / SAMPLE_RATE;
+        phase += 2.0 * std::numbers::pi * 110.0 * std::pow(2.0, 4.0 * std::fmod(t, 10.0) / 10.0) / SAMPLE_RATE;
+        float sample = 0.0f;
+        for (int harmonic = 1; harmonic <= 4; ++harmonic) {
+            sample += 0.3f / static_cast<float>(harmonic) * static_cast<float>(std::sin(phase * harmonic));
+        }
+        signal[i] = sample + 0.02f * noise(rng);
+    }
+    return signal;
+}
+
+template <typename Operation>
+double microsPerCall(Operation&& operation) {
+    for (int i = 0; i < 16; ++i) {
+        operation();
+    }
+
+    size_t iterations = 0;
+    const auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        for (int i = 0; i < 64; ++i) {
+            operation();
+        }
+        iterations += 64;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < TRANSFORM_SECONDS);
+
+    return elapsed * 1e6 / static_cast<double>(iterations);
+}
+
+// Runs operation once to warm up, then returns the median of repetitions timed runs.
+template <typename Operation>
+double medianMs(const int repetitions, Operation&& operation) {
+    operation();
+    std::vector<double> timesMs;
+    timesMs.reserve(static_cast<size_t>(repetitions));
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+        const auto start = Clock::now();
+        operation();
+        timesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    std::ranges::sort(timesMs);
+    return timesMs[timesMs.size() / 2];
+}
+
+bool beats(const double candidate, const double best) {
+    return candidate < best * (1.0 - MARGIN);
+}
+
+// Powers of two up to the hardware thread count, and the count itself.
+std::vector<int> workerCandidates() {
+    const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> candidates;
+    for (int count = 1; count < hardwareThreads; count *= 2) {
+        candidates.push_back(count);
+    }
+    candidates.push_back(hardwareThreads);
+    return candidates;
+}
+
+// BatchExporter reports each file on stdout, which would bury the tuning table.
+class SilencedStdout {
+public:
+    SilencedStdout() : previous_(std::cout.rdbuf(sink_.rdbuf())) {}
+    ~SilencedStdout() { std::cout.rdbuf(previous_); }
+
+    SilencedStdout(const SilencedStdout&) = delete;
+    SilencedStdout& operator=(const SilencedStdout&) = delete;
+
+private:
+    std::ostringstream sink_;
+    std::streambuf* previous_;
+};
+
+// Scores each backend by a real and a complex forward transform, the two the mono and paired
+// analysis paths run, and keeps the default unless another is clearly faster.
+void tuneFFTBackends(const std::vector<float>& signal, Utilities::Tuning::Wisdom& wisdom) {
+    std::vector<FFTBackend::Kind> kinds = {FFTBackend::defaultKind()};
+    for (const FFTBackend::Kind kind : FFTBackend::availableKinds()) {
+        if (kind != kinds.front()) {
+            kinds.push_back(kind);
+        }
+    }
+
+    std::printf("FFT backends (real + complex forward, us)\n");
+    for (const int size : FFT_SIZES) {
+        const std::span<const float> input(signal.data(), static_cast<size_t>(size));
+        std::vector<kiss_fft_cpx> complexInput(static_cast<size_t>(size));
+        for (size_t i = 0; i < complexInput.size(); ++i) {
+            complexInput[i] = {signal[i], signal[i + static_cast<size_t>(size)]};
+        }
+        std::vector<kiss_fft_cpx> spectrum(static_cast<size_t>(size));
+        const std::span<kiss_fft_cpx> realSpectrum = std::span(spectrum).first(static_cast<size_t>(size / 2 + 1));
+
+        FFTBackend::Kind best = kinds.front();
+        double bestMicros = std::numeric_limits<double>::infinity();
+        std::printf("  %6d", size);
+        for (const FFTBackend::Kind kind : kinds) {
+            const auto real = FFTBackend::create(size, kind);
+            const auto complex = FFTBackend::createComplex(size, kind);
+            // Accelerate falls back to kissfft at sizes its radix-2 path does not cover.
+            if (real->kind() != kind || complex->kind() != kind) {
+                continue;
+            }
+            const double micros =
+                microsPerCall([&] { real->forward(input, realSpectrum); }) +
+                microsPerCall([&] { complex->forward(complexInput, spectrum); });
+            std::printf("  %s %.2f", FFTBackend::name(kind), micros);
+            if (beats(micros, bestMicros)) {
+                best = kind;
+                bestMicros = micros;
+            }
+        }
+        std::printf("  -> %s\n", FFTBackend::name(best));
+        wisdom.fftBackends[size] = best;
+        FFTBackend::setPreferredKind(size, best);
+    }
+}
+
+// Times frame analysis and colour at every size with the dispatched kernels held to each
+// level in turn, widest first since that is what runs untuned. ColourCore's own kernels are
+// chosen at compile time, so its share is the same at every level; it is timed so a level
+// only wins by what it saves on a whole frame.
+void tuneVectorLevel(const std::vector<float>& signal, const int hop, Utilities::Tuning::Wisdom& wisdom) {
+    using Utilities::CPU::VectorLevel;
+    const VectorLevel detected = Utilities::CPU::detectedVectorLevel();
+    if (detected == VectorLevel::Baseline) {
+        std::printf("\nVector level: baseline only\n");
+        wisdom.vectorLevel = VectorLevel::Baseline;
+        return;
+    }
+
+    std::vector<std::unique_ptr<FFTProcessor>> analysers;
+    std::vector<std::vector<float>> binFrequencies;
+    for (const int size : FFT_SIZES) {
+        analysers.push_back(std::make_unique<FFTProcessor>(size));
+        std::vector<float>& frequencies = binFrequencies.emplace_back(static_cast<size_t>(size / 2 + 1));
+        for (size_t bin = 0; bin < frequencies.size(); ++bin) {
+            frequencies[bin] = static_cast<float>(bin) * SAMPLE_RATE / static_cast<float>(size);
+        }
+    }
+    ColourCore::AnalysisScratch scratch;
+    const auto workload = [&] {
+        for (size_t i = 0; i < analysers.size(); ++i) {
+            const FFTProcessor::SignalFrames frames = analysers[i]->analyseWholeSignal(signal, SAMPLE_RATE, hop);
+            for (size_t frame = 0; frame < frames.frameCount; ++frame) {
+                ColourCore::analyseSpectrum(scratch, frames.frameMagnitudes(frame), frames.framePhases(frame),
+                                            binFrequencies[i], SAMPLE_RATE, ColourCore::OutputSettings{});
+            }
+        }
+    };
+
+    std::printf("\nVector level (hop %d, ms)\n ", hop);
+    VectorLevel best = detected;
+    double bestMs = std::numeric_limits<double>::infinity();
+    for (int level = static_cast<int>(detected); level >= static_cast<int>(VectorLevel::Baseline); --level) {
+        const auto candidate = static_cast<VectorLevel>(level);
+        Utilities::CPU::setVectorLevelCap(candidate);
+        const double ms = medianMs(REPETITIONS, workload);
+        std::printf(" %s %.1f", Utilities::CPU::name(candidate), ms);
+        if (beats(ms, bestMs)) {
+            best = candidate;
+            bestMs = ms;
+        }
+    }
+    std::printf("  -> %s\n", Utilities::CPU::name(best));
+    wisdom.vectorLevel = best;
+    Utilities::CPU::setVectorLevelCap(best);
+}
+
+// The frame workers one long import's analysis splits across, fewest first.
+void tuneAnalysisWorkers(const std::vector<float>& signal, const int hop, Utilities::Tuning::Wisdom& wisdom) {
+    const FFTProcessor analyser(FFTProcessor::FFT_SIZE);
+    const size_t frameCount = FFTProcessor::countSignalFrames(signal.size(), hop);
+    FFTProcessor::SignalFrames frames;
+
+    std::printf("\nAnalysis workers (%.0f s at hop %d, ms)\n ", ANALYSIS_SIGNAL_SECONDS, hop);
+    int best = 1;
+    double bestMs = std::numeric_limits<double>::infinity();
+    for (const int workers : workerCandidates()) {
+        const double ms = medianMs(REPETITIONS, [&] {
+            analyser.analyseSignalFrames(signal, SAMPLE_RATE, hop, 0, frameCount, frames, static_cast<size_t>(workers));
+        });
+        std::printf(" %d: %.1f", workers, ms);
+        if (beats(ms, bestMs)) {
+            best = workers;
+            bestMs = ms;
+        }
+    }
+    std::printf("  -> %d\n", best);
+    wisdom.analysisWorkers = best;
+}
+
+// Batch exports a folder of short files at each worker count, the best of two runs each.
+bool tuneBatchWorkers(const std::vector<float>& signal, const int hop, const fs::path& workDirectory,
+                      Utilities::Tuning::Wisdom& wisdom) {
+    const std::vector<int> candidates = workerCandidates();
+    const fs::path inputDirectory = workDirectory / "input";
+    const fs::path outputDirectory = workDirectory / "output";
+    std::error_code error;
+    fs::create_directories(inputDirectory, error);
+    const size_t fileCount = std::clamp<size_t>(static_cast<size_t>(candidates.back()), 4, MAX_BATCH_FILES);
+    for (size_t i = 0; i < fileCount; ++i) {
+        const fs::path file = inputDirectory / ("tune" + std::to_string(i) + ".wav");
+        if (error || !WAVEncoder::exportToWAV(file.string(), signal, SAMPLE_RATE, 1)) {
+            std::cerr << "Error: unable to write the batch input under " << inputDirectory.string() << "\n";
+            return false;
+        }
+    }
+
+    std::printf("\nBatch workers (%zu files of %.0f s, ms)\n ", fileCount, BATCH_FILE_SECONDS);
+    int best = 1;
+    double bestMs = std::numeric_limits<double>::infinity();
+    for (const int workers : candidates) {
+        double ms = std::numeric_limits<double>::infinity();
+        for (int run = 0; run < 2; ++run) {
+            fs::remove_all(outputDirectory, error);
+            const auto start = Clock::now();
+            int status = 0;
+            {
+                const SilencedStdout silenced;
+                status = BatchExporter::run(inputDirectory.string(), outputDirectory.string(), false,
+                                            0, 0, "png", false, false, workers, hop, false, false);
+            }
+            if (status != 0) {
+                std::cerr << "Error: batch export failed with " << workers << " workers\n";
+                return false;
+            }
+            ms = std::min(ms, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        std::printf(" %d: %.0f", workers, ms);
+        if (beats(ms, bestMs)) {
+            best = workers;
+            bestMs = ms;
+        }
+    }
+    std::printf("  -> %d\n", best);
+    wisdom.batchWorkers = best;
+    return true;
+}
+
+}
+
+int runTuneCommand(const Arguments& args) {
+    const fs::path path = args.outputDir.empty() ? Utilities::Tuning::defaultPath() : fs::path(args.outputDir);
+    if (path.empty()) {
+        std::cerr << "Error: no default wisdom path; pass -o <file>\n";
+        return 1;
+    }
+
+    std::error_code error;
+    const fs::path workDirectory = fs::temp_directory_path(error) / "synesthesia-tune";
+    if (error) {
+        std::cerr << "Error: unable to find a temporary directory\n";
+        return 1;
+    }
+    fs::remove_all(workDirectory, error);
+
+    // Measure from the untuned defaults, whatever wisdom start-up loaded.
+    Utilities::Tuning::apply(Utilities::Tuning::Wisdom{});
+    Utilities::Tuning::Wisdom wisdom;
+    wisdom.machine = Utilities::Tuning::machineSignature();
+    wisdom.analysisHop = args.analysisHop;
+    std::printf("Tuning for %s\n\n", wisdom.machine.c_str());
+
+    const std::vector<float> kernelSignal = synthesiseSignal(KERNEL_SIGNAL_SECONDS);
+    tuneFFTBackends(kernelSignal, wisdom);
+    tuneVectorLevel(kernelSignal, args.analysisHop, wisdom);
+    tuneAnalysisWorkers(synthesiseSignal(ANALYSIS_SIGNAL_SECONDS), args.analysisHop, wisdom);
+    const bool batchTuned =
+        tuneBatchWorkers(synthesiseSignal(BATCH_FILE_SECONDS), args.analysisHop, workDirectory, wisdom);
+    fs::remove_all(workDirectory, error);
+    if (!batchTuned) {
+        return 1;
+    }
+
+    std::string saveError;
+    if (!Utilities::Tuning::save(wisdom, path, saveError)) {
+        std::cerr << "Error: " << saveError << "\n";
+        return 1;
+    }
+    std::printf("\nWrote %s\n", path.string().c_str());
+    return 0;
+}
+
+}
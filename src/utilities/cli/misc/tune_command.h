@@ -0,0 +1,11 @@
+#pragma once
+
+#include "cli.h"
+
+namespace CLI::Misc {
+
+// --tune: measures the kernel and thread choices on this machine and writes them as the
+// wisdom Utilities::Tuning loads at start-up.
+int runTuneCommand(const Arguments& args);
+
+}
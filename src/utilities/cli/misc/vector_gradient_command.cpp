@@ -1,17 +1,20 @@
 #include "misc/vector_gradient_command.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "colour/colour_core.h"
 #include "colour/colour_presentation.h"
+#include "misc/misc_batch.h"
 #include "misc/presentation_export_utils.h"
 
 namespace fs = std::filesystem;
@@ -30,6 +33,9 @@ std::string rgbPercentString(const float r, const float g, const float b) {
     return stream.str();
 }
 
+// One code value of 8-bit output, the step the fit probes each channel's Oklab slope with.
+constexpr float kSlopeProbeStep = 1.0f / 255.0f;
+
 struct ExactBand {
     int x = 0;
     int width = 1;
@@ -38,32 +44,14 @@ struct ExactBand {
     float b = 0.0f;
 };
 
-ExactBand convertLabToBand(const int x,
-                           const int width,
-                           const float labL,
-                           const float labA,
-                           const float labB,
-                           const RSYNPresentationSettings& settings) {
-    float r = 0.0f;
-    float g = 0.0f;
-    float b = 0.0f;
-    ColourCore::LabtoRGB(
-        labL,
-        labA,
-        labB,
-        r,
-        g,
-        b,
-        settings.colourSpace,
-        settings.applyGamutMapping);
-    ColourPresentation::applyOutputPrecision(r, g, b);
-
+ExactBand makeBand(const int x, const int width, ColourCore::RGB rgb) {
+    ColourPresentation::applyOutputPrecision(rgb.r, rgb.g, rgb.b);
     return ExactBand{
         .x = x,
         .width = width,
-        .r = r,
-        .g = g,
-        .b = b
+        .r = rgb.r,
+        .g = rgb.g,
+        .b = rgb.b
     };
 }
 
@@ -73,16 +61,22 @@ bool sameBandColour(const ExactBand& left, const ExactBand& right) {
         std::abs(left.b - right.b) <= 1e-7f;
 }
 
-void buildExactBands(const std::vector<PresentationSample>& samples,
-                     const RSYNPresentationSettings& settings,
-                     const int width,
-                     std::vector<ExactBand>& bands) {
-    bands.clear();
+struct GradientStop {
+    float x = 0.0f;
+    std::array<float, 3> rgb{};
+};
+
+void buildPixelColours(const std::vector<PresentationSample>& samples,
+                       const RSYNPresentationSettings& settings,
+                       const int width,
+                       std::vector<ColourCore::RGB>& rgb) {
+    rgb.clear();
     if (samples.empty() || width <= 0) {
         return;
     }
 
     const std::size_t lastIndex = samples.size() - 1;
+    std::vector<ColourCore::Lab> labs(static_cast<std::size_t>(width));
     for (int pixelIndex = 0; pixelIndex < width; ++pixelIndex) {
         const float pixelNormalised = width > 1
             ? static_cast<float>(pixelIndex) / static_cast<float>(width - 1)
@@ -92,11 +86,28 @@ void buildExactBands(const std::vector<PresentationSample>& samples,
         const std::size_t sampleIndex1 = std::min(sampleIndex0 + 1, lastIndex);
         const float fraction = samplePosition - static_cast<float>(sampleIndex0);
 
-        const float labL = std::lerp(samples[sampleIndex0].labL, samples[sampleIndex1].labL, fraction);
-        const float labA = std::lerp(samples[sampleIndex0].labA, samples[sampleIndex1].labA, fraction);
-        const float labB = std::lerp(samples[sampleIndex0].labB, samples[sampleIndex1].labB, fraction);
+        labs[static_cast<std::size_t>(pixelIndex)] = {
+            std::lerp(samples[sampleIndex0].labL, samples[sampleIndex1].labL, fraction),
+            std::lerp(samples[sampleIndex0].labA, samples[sampleIndex1].labA, fraction),
+            std::lerp(samples[sampleIndex0].labB, samples[sampleIndex1].labB, fraction)
+        };
+    }
 
-        const ExactBand nextBand = convertLabToBand(pixelIndex, 1, labL, labA, labB, settings);
+    // The whole width converts in two batches; only band merging or the stop fit walk it per pixel.
+    std::vector<ColourCore::XYZ> xyz(labs.size());
+    rgb.resize(labs.size());
+    ColourCore::LabtoXYZ(labs, xyz);
+    ColourCore::projectToRGB(xyz, rgb, ColourCore::OutputSettings{settings.colourSpace, settings.applyGamutMapping});
+    for (auto& colour : rgb) {
+        ColourPresentation::applyOutputPrecision(colour.r, colour.g, colour.b);
+    }
+}
+
+void buildExactBands(const std::vector<ColourCore::RGB>& rgb,
+                     std::vector<ExactBand>& bands) {
+    bands.clear();
+    for (std::size_t pixelIndex = 0; pixelIndex < rgb.size(); ++pixelIndex) {
+        const ExactBand nextBand = makeBand(static_cast<int>(pixelIndex), 1, rgb[pixelIndex]);
         if (!bands.empty() && sameBandColour(bands.back(), nextBand) &&
             bands.back().x + bands.back().width == nextBand.x) {
             bands.back().width += 1;
@@ -106,6 +117,133 @@ void buildExactBands(const std::vector<PresentationSample>& samples,
     }
 }
 
+std::array<float, 3> toOklab(const std::array<float, 3>& rgb, const ColourCore::ColourSpace colourSpace) {
+    float X = 0.0f;
+    float Y = 0.0f;
+    float Z = 0.0f;
+    ColourCore::RGBtoXYZ(rgb[0], rgb[1], rgb[2], X, Y, Z, colourSpace);
+    std::array<float, 3> oklab{};
+    ColourCore::XYZtoOklab(X, Y, Z, oklab[0], oklab[1], oklab[2]);
+    return oklab;
+}
+
+float oklabDistance(const std::array<float, 3>& left, const std::array<float, 3>& right) {
+    return std::hypot(left[0] - right[0], left[1] - right[1], left[2] - right[2]);
+}
+
+// How far each channel of a pixel may move with its Oklab error staying within tolerance:
+// the tolerance over the sum of the channels' Oklab slopes there, so no combination of
+// channel errors can add up past it, to first order in the slopes.
+float channelAllowance(const std::array<float, 3>& rgb,
+                       const ColourCore::ColourSpace colourSpace,
+                       const float tolerance) {
+    const std::array<float, 3> origin = toOklab(rgb, colourSpace);
+    float slopeSum = 0.0f;
+    for (std::size_t channel = 0; channel < 3U; ++channel) {
+        std::array<float, 3> probe = rgb;
+        probe[channel] += probe[channel] + kSlopeProbeStep <= 1.0f ? kSlopeProbeStep : -kSlopeProbeStep;
+        slopeSum += oklabDistance(toOklab(probe, colourSpace), origin) / kSlopeProbeStep;
+    }
+    return slopeSum > 0.0f ? tolerance / slopeSum : tolerance;
+}
+
+// Fits stops at pixel centres, which SVG joins by interpolating display RGB, in one pass: each
+// segment holds, per channel, the range of slopes from its first stop that keep every pixel
+// so far within that pixel's allowance, and ends at the pixel before the one that empties a
+// range, on the middle of the remaining slopes. Each pixel is then within tolerance of the
+// gradient through the stops, and no segment could have reached further from its start.
+void fitGradientStops(const std::vector<ColourCore::RGB>& rgb,
+                      const ColourCore::ColourSpace colourSpace,
+                      const float tolerance,
+                      std::vector<GradientStop>& stops) {
+    stops.clear();
+    if (rgb.empty()) {
+        return;
+    }
+
+    const auto channels = [](const ColourCore::RGB& colour) {
+        return std::array<float, 3>{colour.r, colour.g, colour.b};
+    };
+    const auto pixelCentre = [](const std::size_t pixelIndex) {
+        return static_cast<float>(pixelIndex) + 0.5f;
+    };
+
+    GradientStop anchor{.x = pixelCentre(0U), .rgb = channels(rgb.front())};
+    stops.push_back(anchor);
+    std::array<float, 3> lowSlope{};
+    std::array<float, 3> highSlope{};
+    lowSlope.fill(std::numeric_limits<float>::lowest());
+    highSlope.fill(std::numeric_limits<float>::max());
+
+    const auto closeSegment = [&](const std::size_t endIndex) {
+        GradientStop end{.x = pixelCentre(endIndex)};
+        for (std::size_t channel = 0; channel < 3U; ++channel) {
+            const float slope = 0.5f * (lowSlope[channel] + highSlope[channel]);
+            end.rgb[channel] = std::clamp(anchor.rgb[channel] + slope * (end.x - anchor.x), 0.0f, 1.0f);
+        }
+        stops.push_back(end);
+        anchor = end;
+    };
+
+    for (std::size_t pixelIndex = 1; pixelIndex < rgb.size(); ++pixelIndex) {
+        const std::array<float, 3> colour = channels(rgb[pixelIndex]);
+        const float allowance = channelAllowance(colour, colourSpace, tolerance);
+
+        std::array<float, 3> low{};
+        std::array<float, 3> high{};
+        bool feasible = true;
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            const float run = pixelCentre(pixelIndex) - anchor.x;
+            feasible = true;
+            for (std::size_t channel = 0; channel < 3U; ++channel) {
+                low[channel] = std::max(lowSlope[channel], (colour[channel] - allowance - anchor.rgb[channel]) / run);
+                high[channel] = std::min(highSlope[channel], (colour[channel] + allowance - anchor.rgb[channel]) / run);
+                feasible = feasible && low[channel] <= high[channel];
+            }
+            if (feasible) {
+                break;
+            }
+            // A segment always takes the pixel after its start, so the retry cannot fail.
+            closeSegment(pixelIndex - 1U);
+            lowSlope.fill(std::numeric_limits<float>::lowest());
+            highSlope.fill(std::numeric_limits<float>::max());
+        }
+        lowSlope = low;
+        highSlope = high;
+    }
+
+    if (rgb.size() > 1U) {
+        closeSegment(rgb.size() - 1U);
+    }
+}
+
+// The largest Oklab distance between a pixel and the gradient through the stops at its centre.
+float measureStopError(const std::vector<ColourCore::RGB>& rgb,
+                       const std::vector<GradientStop>& stops,
+                       const ColourCore::ColourSpace colourSpace) {
+    float maximumError = 0.0f;
+    std::size_t segment = 0;
+    for (std::size_t pixelIndex = 0; pixelIndex < rgb.size(); ++pixelIndex) {
+        const float x = static_cast<float>(pixelIndex) + 0.5f;
+        while (segment + 2U < stops.size() && stops[segment + 1U].x < x) {
+            ++segment;
+        }
+        std::array<float, 3> fitted = stops[segment].rgb;
+        if (segment + 1U < stops.size()) {
+            const GradientStop& left = stops[segment];
+            const GradientStop& right = stops[segment + 1U];
+            const float fraction = std::clamp((x - left.x) / (right.x - left.x), 0.0f, 1.0f);
+            for (std::size_t channel = 0; channel < 3U; ++channel) {
+                fitted[channel] = std::lerp(left.rgb[channel], right.rgb[channel], fraction);
+            }
+        }
+        const std::array<float, 3> pixel{rgb[pixelIndex].r, rgb[pixelIndex].g, rgb[pixelIndex].b};
+        maximumError = std::max(maximumError,
+                                oklabDistance(toOklab(pixel, colourSpace), toOklab(fitted, colourSpace)));
+    }
+    return maximumError;
+}
+
 bool writeSvgGradient(const fs::path& outputPath,
                       const std::vector<ExactBand>& bands,
                       const int width,
@@ -132,53 +270,115 @@ bool writeSvgGradient(const fs::path& outputPath,
     return stream.good();
 }
 
-int defaultLosslessWidth(const std::vector<PresentationSample>& samples) {
-    return std::max(1, static_cast<int>(samples.size()));
-}
+bool writeSvgLinearGradient(const fs::path& outputPath,
+                            const std::vector<GradientStop>& stops,
+                            const int width,
+                            const int height,
+                            const std::string& title) {
+    std::ofstream stream(outputPath, std::ios::binary);
+    if (!stream) {
+        return false;
+    }
 
+    // The fit assumed sRGB interpolation between stops, which is also the SVG default.
+    stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    stream << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width
+           << "\" height=\"" << height
+           << "\" viewBox=\"0 0 " << width << ' ' << height << "\">\n";
+    stream << "  <title>" << title << "</title>\n";
+    stream << "  <defs>\n";
+    stream << "    <linearGradient id=\"fit\" gradientUnits=\"userSpaceOnUse\" x1=\"0\" y1=\"0\" x2=\""
+           << width << "\" y2=\"0\" color-interpolation=\"sRGB\">\n";
+    for (const auto& stop : stops) {
+        stream << "      <stop offset=\"" << std::fixed << std::setprecision(8)
+               << static_cast<double>(stop.x) / static_cast<double>(width)
+               << "\" stop-color=\"" << rgbPercentString(stop.rgb[0], stop.rgb[1], stop.rgb[2])
+               << "\"/>\n";
+    }
+    stream << "    </linearGradient>\n";
+    stream << "  </defs>\n";
+    stream << "  <rect x=\"0\" y=\"0\" width=\"" << width << "\" height=\"" << height
+           << "\" fill=\"url(#fit)\"/>\n";
+    stream << "</svg>\n";
+    return stream.good();
 }
 
-int runVectorGradientCommand(const Arguments& args) {
-    if (args.inputDir.empty()) {
-        std::cerr << "Error: --misc vector-gradient requires --input <file>\n";
-        return 1;
-    }
-    if (args.outputDir.empty()) {
-        std::cerr << "Error: --misc vector-gradient requires --output <file.svg>\n";
-        return 1;
-    }
+int defaultLosslessWidth(const std::vector<PresentationSample>& samples) {
+    return std::max(1, static_cast<int>(samples.size()));
+}
 
+// Either the exact bands or, with a tolerance, the fitted linear gradient.
+MiscExportResult exportVectorGradient(const Arguments& args, const fs::path& outputPath) {
+    MiscExportResult result;
     LoadedPresentation loaded;
-    std::string errorMessage;
-    if (!loadPresentationForInput(args, loaded, errorMessage)) {
-        std::cerr << "Error: " << errorMessage << '\n';
-        return 1;
+    if (!loadPresentationForInput(args, loaded, result.error)) {
+        return result;
     }
 
     std::vector<PresentationSample> samples;
     if (!collectPresentationSamples(loaded, samples)) {
-        std::cerr << "Error: could not collect presentation samples\n";
-        return 1;
+        result.error = "could not collect presentation samples";
+        return result;
     }
 
     const int width = args.gradientWidth > 0 ? args.gradientWidth : defaultLosslessWidth(samples);
     const int height = args.gradientHeight > 0 ? args.gradientHeight : 800;
 
-    std::vector<ExactBand> bands;
-    buildExactBands(samples, loaded.metadata.presentationData->settings, width, bands);
-    if (bands.empty()) {
-        std::cerr << "Error: no exact vector bands generated\n";
-        return 1;
+    const RSYNPresentationSettings& settings = loaded.metadata.presentationData->settings;
+    std::vector<ColourCore::RGB> rgb;
+    buildPixelColours(samples, settings, width, rgb);
+
+    if (args.vectorTolerance > 0.0f) {
+        std::vector<GradientStop> stops;
+        fitGradientStops(rgb, settings.colourSpace, args.vectorTolerance, stops);
+        if (stops.empty()) {
+            result.error = "no vector gradient stops fitted";
+            return result;
+        }
+        if (!writeSvgLinearGradient(outputPath, stops, width, height, loaded.inputPath.stem().string())) {
+            result.error = "failed to write SVG output";
+            return result;
+        }
+
+        std::ostringstream detail;
+        detail << stops.size() << " stops for " << rgb.size() << " columns, max Oklab error "
+               << measureStopError(rgb, stops, settings.colourSpace);
+        result.details.push_back(detail.str());
+    } else {
+        std::vector<ExactBand> bands;
+        buildExactBands(rgb, bands);
+        if (bands.empty()) {
+            result.error = "no exact vector bands generated";
+            return result;
+        }
+        if (!writeSvgGradient(outputPath, bands, width, height, loaded.inputPath.stem().string())) {
+            result.error = "failed to write SVG output";
+            return result;
+        }
     }
 
-    const fs::path outputPath(args.outputDir);
-    if (!writeSvgGradient(outputPath, bands, width, height, loaded.inputPath.stem().string())) {
-        std::cerr << "Error: failed to write SVG output\n";
+    result.exported = true;
+    result.description = "vector gradient";
+    return result;
+}
+
+}
+
+int runVectorGradientCommand(const Arguments& args) {
+    if (args.inputDir.empty()) {
+        std::cerr << "Error: --misc vector-gradient requires --input <file|dir|glob>\n";
+        return 1;
+    }
+    if (isBatchInput(args.inputDir)) {
+        return runMiscBatch(args, "vector-gradient", ".svg", exportVectorGradient);
+    }
+    if (args.outputDir.empty()) {
+        std::cerr << "Error: --misc vector-gradient requires --output <file.svg>\n";
         return 1;
     }
 
-    std::cout << "Exported vector gradient: " << outputPath << '\n';
-    return 0;
+    const fs::path outputPath(args.outputDir);
+    return reportMiscExport(exportVectorGradient(args, outputPath), outputPath);
 }
 
 }
@@ -0,0 +1,346 @@
+#include "multi_input_daemon.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "audio_input.h"
+#include "audio/analysis/presentation/spectral_presentation.h"
+#include "colour/colour_core.h"
+#include "colour/colour_presentation.h"
+#include "fft_processor.h"
+#include "ui/smoothing/smoothing.h"
+#include "ui/smoothing/smoothing_features.h"
+
+#ifdef ENABLE_OSC
+#include "osc_frame_builder.h"
+#include "osc_runtime.h"
+#endif
+
+namespace CLI {
+
+namespace {
+
+constexpr auto kStatusInterval = std::chrono::seconds(1);
+constexpr auto kStopPollInterval = std::chrono::milliseconds(50);
+
+std::optional<size_t> findDevice(const std::vector<AudioInput::DeviceInfo>& devices, const std::string& device) {
+    if (!device.empty() && std::all_of(device.begin(), device.end(), [](const char c) { return c >= '0' && c <= '9'; })) {
+        const size_t index = static_cast<size_t>(std::strtoul(device.c_str(), nullptr, 10));
+        if (index < devices.size()) {
+            return index;
+        }
+    }
+    for (size_t i = 0; i < devices.size(); ++i) {
+        if (devices[i].name.find(device) != std::string::npos) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+}
+
+// One device's stream, analysis and output. The frame thread owns everything below the
+// display state; the status loop only reads what displayMutex guards and the atomic counters.
+struct MultiInputDaemon::Pipeline {
+    std::string deviceName;
+    uint16_t sendPort = 0;
+    AudioInput audioInput;
+
+    std::thread frameThread;
+    std::atomic<bool> frameThreadStopping{false};
+    AudioProcessor::BorrowedFrames borrowedFrames;
+
+    SpringSmoother colourSmoother{8.0f, 1.0f, 0.3f};
+    bool smoothingEnabled = true;
+    float colourSmoothingSpeed = 0.6f;
+    ColourCore::ColourSpace colourSpace = ColourCore::ColourSpace::Rec2020;
+    bool gamutMappingEnabled = true;
+    SpectralPresentation::Frame previousFrame;
+    bool hasPreviousFrame = false;
+    SpectralPresentation::FrameWorkspace analysisWorkspace;
+    SpectralPresentation::PreparedFrame analysisFrame;
+
+#ifdef ENABLE_OSC
+    std::unique_ptr<Synesthesia::OSC::OSCRuntime> osc;
+#endif
+
+    struct DisplayState {
+        float dominantFrequency = 0.0f;
+        float r = 0.0f, g = 0.0f, b = 0.0f;
+        float loudnessDb = -200.0f;
+    };
+    std::mutex displayMutex;
+    DisplayState displayState;  // Protected by displayMutex
+
+    void runFrameLoop();
+    void processAnalysisFrame(const FFTProcessor::FrameView& view, float hopSeconds);
+};
+
+void MultiInputDaemon::Pipeline::runFrameLoop() {
+    AudioProcessor& processor = audioInput.getAudioProcessor();
+    for (;;) {
+        const uint64_t seenGeneration = processor.bufferedFrameGeneration();
+        processor.borrowBufferedFrames(borrowedFrames);
+        if (!borrowedFrames.empty() && !borrowedFrames.front().empty()) {
+            const int hopSize = audioInput.acquireSpectralData()->hopSize;
+            for (const FFTProcessor::FrameView& view : borrowedFrames.front()) {
+                const float hopSeconds = view.sampleRate > 0.0f
+                    ? static_cast<float>(hopSize) / view.sampleRate
+                    : (1.0f / 60.0f);
+                processAnalysisFrame(view, hopSeconds);
+            }
+        }
+        processor.releaseBufferedFrames(borrowedFrames);
+        if (frameThreadStopping.load(std::memory_order_acquire)) {
+            return;
+        }
+        processor.waitForBufferedFrames(seenGeneration);
+    }
+}
+
+void MultiInputDaemon::Pipeline::processAnalysisFrame(const FFTProcessor::FrameView& view, const float hopSeconds) {
+    if (view.magnitudes.empty() || view.phases.empty()) {
+        return;
+    }
+
+#ifdef ENABLE_OSC
+    if (osc) {
+        const Synesthesia::OSC::PendingOSCSettings pendingSettings = osc->consumePendingSettings();
+        if (pendingSettings.colourSpace.has_value()) {
+            colourSpace = *pendingSettings.colourSpace;
+        }
+        if (pendingSettings.gamutMappingEnabled.has_value()) {
+            gamutMappingEnabled = *pendingSettings.gamutMappingEnabled;
+        }
+        if (pendingSettings.smoothingEnabled.has_value()) {
+            smoothingEnabled = *pendingSettings.smoothingEnabled;
+        }
+        if (pendingSettings.colourSmoothingSpeed.has_value()) {
+            colourSmoothingSpeed = *pendingSettings.colourSmoothingSpeed;
+            colourSmoother.setSmoothingAmount(colourSmoothingSpeed);
+        }
+    }
+#endif
+
+    SpectralPresentation::Settings settings{};
+    settings.colourSpace = colourSpace;
+    settings.applyGamutMapping = gamutMappingEnabled;
+
+    SpectralPresentation::FrameView frame{};
+    frame.magnitudes = view.magnitudes;
+    frame.phases = view.phases;
+    frame.sampleRate = view.sampleRate > 0.0f ? view.sampleRate : audioInput.getSampleRate();
+
+    const SpectralPresentation::FrameView previousView = previousFrame.view();
+    SpectralPresentation::prepareFrame(
+        analysisWorkspace,
+        frame,
+        settings,
+        view.loudnessLUFS,
+        hasPreviousFrame ? &previousView : nullptr,
+        hopSeconds,
+        analysisFrame);
+
+    const auto& colourResult = analysisFrame.colourResult;
+    float currentR = colourResult.r;
+    float currentG = colourResult.g;
+    float currentB = colourResult.b;
+
+    auto features = ::UI::Smoothing::buildSignalFeatures(colourResult);
+    features.onsetDetected = view.onsetDetected;
+    features.spectralFlux = view.spectralFlux;
+
+    if (smoothingEnabled) {
+        colourSmoother.setTargetColour(currentR, currentG, currentB);
+        colourSmoother.update(hopSeconds * 1.2f, features);
+        colourSmoother.getCurrentColour(currentR, currentG, currentB);
+    }
+    ColourPresentation::applyOutputPrecision(currentR, currentG, currentB);
+
+#ifdef ENABLE_OSC
+    if (osc && osc->isRunning()) {
+        Synesthesia::OSC::OSCFrameUpdate update{};
+        update.magnitudes = std::span<const float>(analysisFrame.visualiserMagnitudes.data(),
+                                                   analysisFrame.visualiserMagnitudes.size());
+        update.phases = std::span<const float>(frame.phases.data(), frame.phases.size());
+        update.sampleRate = frame.sampleRate;
+        update.colourResult = colourResult;
+        update.displayColour = ColourCore::RGB{currentR, currentG, currentB};
+        update.analysisSignals = Synesthesia::OSC::buildAnalysisSignals(
+            view.loudnessLUFS,
+            view.spectralFlux,
+            view.onsetDetected);
+        update.smoothingSignals = Synesthesia::OSC::buildSmoothingSignals(features);
+        osc->sendFrame(Synesthesia::OSC::buildFrameData(update), update.magnitudes, update.phases);
+    }
+#endif
+
+    previousFrame.assign(frame);
+    hasPreviousFrame = true;
+
+    std::lock_guard<std::mutex> lock(displayMutex);
+    displayState.dominantFrequency = colourResult.dominantFrequency;
+    displayState.r = currentR;
+    displayState.g = currentG;
+    displayState.b = currentB;
+    displayState.loudnessDb = colourResult.loudnessDb;
+}
+
+std::atomic<bool> MultiInputDaemon::stopRequested_{false};
+
+std::optional<MultiInputDaemon::PipelineSpec> MultiInputDaemon::parsePipelineSpec(const std::string& argument) {
+    PipelineSpec spec;
+    const size_t at = argument.rfind('@');
+    spec.device = argument.substr(0, at);
+    if (at != std::string::npos) {
+        const int port = std::atoi(argument.c_str() + at + 1);
+        if (port < 1 || port > 65535) {
+            return std::nullopt;
+        }
+        spec.sendPort = static_cast<uint16_t>(port);
+    }
+    if (spec.device.empty()) {
+        return std::nullopt;
+    }
+    return spec;
+}
+
+MultiInputDaemon::MultiInputDaemon() = default;
+
+MultiInputDaemon::~MultiInputDaemon() {
+    stopAll();
+}
+
+void MultiInputDaemon::signalHandler(int /* signal */) {
+    stopRequested_ = true;
+}
+
+int MultiInputDaemon::run(const std::vector<PipelineSpec>& specs, [[maybe_unused]] const bool enableOSC,
+                          [[maybe_unused]] const std::string& oscDestination,
+                          const uint16_t baseSendPort, [[maybe_unused]] const uint16_t baseReceivePort,
+                          [[maybe_unused]] const bool oscPackedFrames,
+                          const AudioStreamSettings& streamSettings) {
+    const std::vector<AudioInput::DeviceInfo> devices = AudioInput::getInputDevices(streamSettings.hostApi);
+
+    for (size_t i = 0; i < specs.size(); ++i) {
+        const std::optional<size_t> deviceIndex = findDevice(devices, specs[i].device);
+        if (!deviceIndex.has_value()) {
+            std::cerr << "No input device matches \"" << specs[i].device << "\"" << std::endl;
+            stopAll();
+            return 1;
+        }
+
+        auto pipeline = std::make_unique<Pipeline>();
+        pipeline->deviceName = devices[*deviceIndex].name;
+        pipeline->sendPort = specs[i].sendPort != 0
+            ? specs[i].sendPort
+            : static_cast<uint16_t>(std::min<size_t>(baseSendPort + i, 65535));
+        if (!pipeline->audioInput.initStream(devices[*deviceIndex].paIndex, 1, streamSettings)) {
+            std::cerr << "Failed to open " << pipeline->deviceName << std::endl;
+            stopAll();
+            return 1;
+        }
+
+#ifdef ENABLE_OSC
+        if (enableOSC) {
+            Synesthesia::OSC::OSCConfig config;
+            config.destinationHost = oscDestination;
+            config.transmitPort = pipeline->sendPort;
+            config.receivePort = static_cast<uint16_t>(std::min<size_t>(baseReceivePort + i, 65535));
+            config.frameFormat = oscPackedFrames ? Synesthesia::OSC::OSCFrameFormat::Packed
+                                                 : Synesthesia::OSC::OSCFrameFormat::Named;
+            pipeline->osc = std::make_unique<Synesthesia::OSC::OSCRuntime>(config);
+            if (!pipeline->osc->start()) {
+                std::cerr << "Failed to start OSC for " << pipeline->deviceName << ": "
+                          << pipeline->osc->getLastError() << std::endl;
+                stopAll();
+                return 1;
+            }
+        }
+#endif
+
+        std::cout << "Pipeline " << i << ": " << pipeline->deviceName;
+#ifdef ENABLE_OSC
+        if (pipeline->osc) {
+            std::cout << " -> " << oscDestination << ":" << pipeline->sendPort;
+        }
+#endif
+        std::cout << std::endl;
+
+        pipeline->frameThread = std::thread(&Pipeline::runFrameLoop, pipeline.get());
+        pipelines_.push_back(std::move(pipeline));
+    }
+
+    stopRequested_ = false;
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    auto nextStatus = std::chrono::steady_clock::now() + kStatusInterval;
+    while (!stopRequested_) {
+        std::this_thread::sleep_for(kStopPollInterval);
+        if (std::chrono::steady_clock::now() >= nextStatus) {
+            printStatus();
+            nextStatus += kStatusInterval;
+        }
+    }
+
+    stopAll();
+    return 0;
+}
+
+void MultiInputDaemon::printStatus() const {
+    for (size_t i = 0; i < pipelines_.size(); ++i) {
+        Pipeline& pipeline = *pipelines_[i];
+        Pipeline::DisplayState current;
+        {
+            std::lock_guard<std::mutex> lock(pipeline.displayMutex);
+            current = pipeline.displayState;
+        }
+
+        std::cout << "[" << i << "] " << pipeline.deviceName
+                  << std::fixed << std::setprecision(1)
+                  << "  " << current.dominantFrequency << " Hz"
+                  << "  " << current.loudnessDb << " dB"
+                  << std::setprecision(0)
+                  << "  RGB(" << current.r * 255.0f << ", " << current.g * 255.0f << ", " << current.b * 255.0f << ")"
+                  << "  dropped " << pipeline.audioInput.getAudioProcessor().getDroppedBufferCount();
+#ifdef ENABLE_OSC
+        if (pipeline.osc) {
+            const Synesthesia::OSC::OSCStats stats = pipeline.osc->getStats();
+            std::cout << "  osc:" << pipeline.sendPort
+                      << " " << stats.currentFps << " fps"
+                      << " sent " << stats.framesSent
+                      << " coalesced " << stats.framesCoalesced
+                      << " dropped " << stats.framesDropped;
+        }
+#endif
+        std::cout << '\n';
+    }
+    std::cout.flush();
+}
+
+void MultiInputDaemon::stopAll() {
+    for (const auto& pipeline : pipelines_) {
+        pipeline->frameThreadStopping = true;
+        pipeline->audioInput.getAudioProcessor().wakeFrameWaiters();
+        if (pipeline->frameThread.joinable()) {
+            pipeline->frameThread.join();
+        }
+#ifdef ENABLE_OSC
+        if (pipeline->osc) {
+            pipeline->osc->stop();
+        }
+#endif
+    }
+    pipelines_.clear();
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "audio_stream_settings.h"
+
+namespace CLI {
+
+// Runs one analysis pipeline per input device in a single process, each with its own stream,
+// analysis worker, colour smoother and OSC transport, without the interactive terminal.
+// Pipelines share the PortAudio host, the real-time thread configuration and the telemetry
+// registry; each reports its own drops and OSC statistics on the status line.
+class MultiInputDaemon {
+public:
+    // A --pipeline argument: "<device>[@port]". The device is matched as a substring of the
+    // input device names, or taken as a device list index when it is a number. Without a
+    // port the pipeline sends to the base send port plus its index.
+    struct PipelineSpec {
+        std::string device;
+        uint16_t sendPort = 0;
+    };
+
+    static std::optional<PipelineSpec> parsePipelineSpec(const std::string& argument);
+
+    MultiInputDaemon();
+    ~MultiInputDaemon();
+
+    MultiInputDaemon(const MultiInputDaemon&) = delete;
+    MultiInputDaemon& operator=(const MultiInputDaemon&) = delete;
+
+    // Blocks until SIGINT or SIGTERM. Pipelines receive OSC control messages on the base
+    // receive port plus their index.
+    int run(const std::vector<PipelineSpec>& specs, bool enableOSC,
+            const std::string& oscDestination, uint16_t baseSendPort, uint16_t baseReceivePort,
+            bool oscPackedFrames, const AudioStreamSettings& streamSettings);
+
+private:
+    struct Pipeline;
+
+    std::vector<std::unique_ptr<Pipeline>> pipelines_;
+
+    void printStatus() const;
+    void stopAll();
+
+    static void signalHandler(int signal);
+    static std::atomic<bool> stopRequested_;
+};
+
+}
@@ -0,0 +1,131 @@
+#include "terminal_renderer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <unistd.h>
+
+namespace CLI {
+
+namespace {
+
+// Byte offset of every cell in row, then row.size(), so cell i is [cells[i], cells[i + 1]).
+void cellStarts(const std::string& row, std::vector<std::size_t>& cells) {
+    cells.clear();
+    for (std::size_t i = 0; i < row.size(); ++i) {
+        if ((static_cast<unsigned char>(row[i]) & 0xC0) != 0x80) {
+            cells.push_back(i);
+        }
+    }
+    cells.push_back(row.size());
+}
+
+bool sameCell(const std::string& before, const std::vector<std::size_t>& beforeCells, std::size_t beforeIndex,
+              const std::string& after, const std::vector<std::size_t>& afterCells, std::size_t afterIndex) {
+    const std::size_t length = afterCells[afterIndex + 1] - afterCells[afterIndex];
+    return beforeCells[beforeIndex + 1] - beforeCells[beforeIndex] == length &&
+           before.compare(beforeCells[beforeIndex], length, after, afterCells[afterIndex], length) == 0;
+}
+
+void appendCursorMove(std::string& output, std::size_t row, std::size_t column) {
+    output += "\033[";
+    output += std::to_string(row + 1);
+    output += ';';
+    output += std::to_string(column + 1);
+    output += 'H';
+}
+
+}
+
+std::ostringstream& TerminalRenderer::beginFrame() {
+    composed.str(std::string());
+    composed.clear();
+    return composed;
+}
+
+void TerminalRenderer::invalidate() {
+    screenKnown = false;
+}
+
+// Only the span between the first and last changed cells is rewritten. When the row changed
+// length its tail has shifted anyway, so everything from the first change is sent and a
+// shorter row erases what is left of the old one.
+void TerminalRenderer::appendRowChanges(const std::size_t row, const std::string& before, const std::string& after) {
+    cellStarts(before, oldCells);
+    cellStarts(after, newCells);
+    const std::size_t oldCount = oldCells.size() - 1;
+    const std::size_t newCount = newCells.size() - 1;
+
+    std::size_t first = 0;
+    while (first < oldCount && first < newCount && sameCell(before, oldCells, first, after, newCells, first)) {
+        ++first;
+    }
+    if (first == oldCount && first == newCount) {
+        return;
+    }
+    std::size_t last = newCount;
+    if (oldCount == newCount) {
+        while (last > first && sameCell(before, oldCells, last - 1, after, newCells, last - 1)) {
+            --last;
+        }
+    }
+
+    appendCursorMove(output, row, first);
+    output.append(after, newCells[first], newCells[last] - newCells[first]);
+    if (newCount < oldCount) {
+        output += "\033[K";
+    }
+}
+
+bool TerminalRenderer::present() {
+    // Anything still buffered in std::cout belongs before this frame.
+    std::cout.flush();
+
+    std::vector<std::string> rows;
+    const std::string text = composed.str();
+    std::size_t start = 0;
+    while (start < text.size()) {
+        const std::size_t end = std::min(text.find('\n', start), text.size());
+        rows.emplace_back(text, start, end - start);
+        start = end + 1;
+    }
+
+    output.clear();
+    if (!screenKnown) {
+        output += "\033[2J";
+        shown.clear();
+    }
+    static const std::string kEmptyRow;
+    for (std::size_t row = 0; row < std::max(rows.size(), shown.size()); ++row) {
+        const std::string& before = row < shown.size() ? shown[row] : kEmptyRow;
+        const std::string& after = row < rows.size() ? rows[row] : kEmptyRow;
+        if (before != after) {
+            appendRowChanges(row, before, after);
+        }
+    }
+    if (output.empty()) {
+        return true;
+    }
+    // Parks the cursor under the frame, where it is out of the way if the terminal shows it.
+    appendCursorMove(output, rows.size(), 0);
+
+    const char* data = output.data();
+    std::size_t remaining = output.size();
+    while (remaining > 0) {
+        const ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            screenKnown = false;
+            return false;
+        }
+        data += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+    shown = std::move(rows);
+    screenKnown = true;
+    return true;
+}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace CLI {
+
+// Draws a full-screen text status display by difference. Each frame is composed as plain
+// lines into the stream beginFrame() returns; present() compares it with what the terminal
+// already shows and sends only the changed cells of each row, cursor moves included, in one
+// write to stdout. An unchanged frame writes nothing, which keeps a status screen cheap over
+// a slow SSH link. A cell is one UTF-8 code point, taken as one column wide.
+class TerminalRenderer {
+public:
+    // Clears the frame being composed and returns it.
+    std::ostringstream& beginFrame();
+    // Brings the terminal up to the composed frame. Returns false if stdout would not take it,
+    // after which the next present() redraws everything.
+    bool present();
+    // Forgets what is on screen, so the next present() clears it and redraws in full; for
+    // after anything else has written to the terminal.
+    void invalidate();
+
+private:
+    std::ostringstream composed;
+    std::vector<std::string> shown;  // Rows on screen, valid while screenKnown
+    bool screenKnown = false;
+    std::string output;  // Reused escape and text buffer for one present()
+    std::vector<std::size_t> oldCells;
+    std::vector<std::size_t> newCells;
+
+    void appendRowChanges(std::size_t row, const std::string& before, const std::string& after);
+};
+
+}
@@ -0,0 +1,130 @@
+#include "utilities/cpu/cpu_features.h"
+
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+#include <immintrin.h>
+#include <intrin.h>
+#elif defined(_WIN32) && defined(_M_ARM64)
+#include <windows.h>
+#elif defined(__linux__) && defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace Utilities::CPU {
+
+namespace {
+
+struct Features {
+    bool avx2 = false;
+    bool f16c = false;
+    bool avx512 = false;
+    bool pclmul = false;
+    bool armCrc32 = false;
+};
+
+Features detect() {
+    Features features;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+    int registers[4] = {};
+    __cpuid(registers, 0);
+    const int maxLeaf = registers[0];
+
+    __cpuidex(registers, 1, 0);
+    const bool osSavesState = (registers[2] & (1 << 27)) != 0;
+    const bool fma = (registers[2] & (1 << 12)) != 0;
+    const bool f16c = (registers[2] & (1 << 29)) != 0;
+    features.pclmul = (registers[2] & (1 << 1)) != 0;
+    if (!osSavesState || maxLeaf < 7) {
+        return features;
+    }
+
+    // XCR0 must show the OS saving the YMM state, and for AVX-512 the opmask and ZMM state.
+    const unsigned long long xcr0 = _xgetbv(0);
+    const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    const bool zmmEnabled = (xcr0 & 0xe6) == 0xe6;
+
+    __cpuidex(registers, 7, 0);
+    features.avx2 = ymmEnabled && fma && (registers[1] & (1 << 5)) != 0;
+    features.f16c = ymmEnabled && f16c;
+    features.avx512 = features.avx2 && zmmEnabled && (registers[1] & (1 << 16)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    // These also check that the OS has enabled the wider register state.
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    features.f16c = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+    features.avx512 = features.avx2 && __builtin_cpu_supports("avx512f");
+    features.pclmul = __builtin_cpu_supports("pclmul");
+#elif defined(__APPLE__) && defined(__aarch64__)
+    // Every Apple ARM64 core has them.
+    features.armCrc32 = true;
+#elif defined(_WIN32) && defined(_M_ARM64)
+    features.armCrc32 = IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__linux__) && defined(__aarch64__)
+    features.armCrc32 = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#endif
+    return features;
+}
+
+const Features& features() {
+    static const Features detected = detect();
+    return detected;
+}
+
+std::atomic<VectorLevel> levelCap{VectorLevel::AVX512};
+
+bool allowed(const VectorLevel level) {
+    return static_cast<int>(levelCap.load(std::memory_order_relaxed)) >= static_cast<int>(level);
+}
+
+}
+
+bool hasAVX2() {
+    return features().avx2 && allowed(VectorLevel::AVX2);
+}
+
+bool hasF16C() {
+    return features().f16c;
+}
+
+bool hasAVX512() {
+    return features().avx512 && allowed(VectorLevel::AVX512);
+}
+
+bool hasPCLMUL() {
+    return features().pclmul;
+}
+
+bool hasARMCRC32() {
+    return features().armCrc32;
+}
+
+const char* name(const VectorLevel level) {
+    switch (level) {
+        case VectorLevel::Baseline:
+            return "baseline";
+        case VectorLevel::AVX2:
+            return "avx2";
+        case VectorLevel::AVX512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+VectorLevel detectedVectorLevel() {
+    if (features().avx512) {
+        return VectorLevel::AVX512;
+    }
+    return features().avx2 ? VectorLevel::AVX2 : VectorLevel::Baseline;
+}
+
+VectorLevel vectorLevelCap() {
+    return levelCap.load(std::memory_order_relaxed);
+}
+
+void setVectorLevelCap(const VectorLevel cap) {
+    levelCap.store(cap, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace Utilities::CPU {
+
+// Instruction set extensions beyond the SSE4.2 baseline the x86 build assumes, probed once
+// at first use. The SIMD kernels are compiled for each level separately and pick the widest
+// one the running machine and operating system support. Always false off x86.
+[[nodiscard]] bool hasAVX2();
+[[nodiscard]] bool hasF16C();
+[[nodiscard]] bool hasAVX512();
+[[nodiscard]] bool hasPCLMUL();
+
+// The optional ARMv8 CRC32 instructions. Always false off ARM64.
+[[nodiscard]] bool hasARMCRC32();
+
+// The vector widths the runtime-dispatched kernels choose between. AVX2 and AVX-512 are only
+// used up to the cap, so a machine whose wide units downclock can be held to a narrower
+// level that measures faster. hasAVX2() and hasAVX512() honour the cap; detection does not.
+enum class VectorLevel {
+    Baseline,
+    AVX2,
+    AVX512
+};
+
+[[nodiscard]] const char* name(VectorLevel level);
+[[nodiscard]] VectorLevel detectedVectorLevel();
+[[nodiscard]] VectorLevel vectorLevelCap();
+// Defaults to AVX512, leaving detection to decide.
+void setVectorLevelCap(VectorLevel cap);
+
+}
@@ -44,7 +44,7 @@ void MIDIAnalyser::processEvent(const MIDIEvent& event) {
 	logEvent(event);
 }
 
-MIDIState MIDIAnalyser::getCurrentState() const {
+const MIDIState& MIDIAnalyser::getCurrentState() const {
 	return currentState;
 }
 
@@ -53,21 +53,28 @@ void MIDIAnalyser::reset() {
 }
 
 void MIDIAnalyser::handleNoteOn(const MIDIEvent& event) {
-	if (event.data2 > 0) {
-		currentState.activeNotes[event.data1] = event.data2;
-	} else {
-		currentState.activeNotes.erase(event.data1);
+	if (event.data2 == 0) {
+		handleNoteOff(event);
+		return;
+	}
+	if (event.data1 < MIDIState::NOTE_COUNT) {
+		currentState.activeNotes.set(event.data1);
+		currentState.noteVelocities[event.data1] = event.data2;
 	}
-	updateChord();
 }
 
 void MIDIAnalyser::handleNoteOff(const MIDIEvent& event) {
-	currentState.activeNotes.erase(event.data1);
-	updateChord();
+	if (event.data1 < MIDIState::NOTE_COUNT) {
+		currentState.activeNotes.reset(event.data1);
+		currentState.noteVelocities[event.data1] = 0;
+	}
 }
 
 void MIDIAnalyser::handleControlChange(const MIDIEvent& event) {
-	currentState.controlChanges[event.data1] = event.data2;
+	if (event.data1 < MIDIState::CONTROLLER_COUNT) {
+		currentState.receivedControllers.set(event.data1);
+		currentState.controlChanges[event.data1] = event.data2;
+	}
 }
 
 void MIDIAnalyser::handlePitchBend(const MIDIEvent& event) {
@@ -86,13 +93,6 @@ void MIDIAnalyser::handleChannelPressure(const MIDIEvent& event) {
 	(void)event;
 }
 
-void MIDIAnalyser::updateChord() {
-	currentState.currentChord.clear();
-	for (const auto& note : currentState.activeNotes) {
-		currentState.currentChord.push_back(note.first);
-	}
-}
-
 void MIDIAnalyser::logEvent(const MIDIEvent& event) {
 	std::ostringstream oss;
 	oss << "[MIDI] Ch" << std::setw(2) << static_cast<int>(event.channel) << " | ";
@@ -104,13 +104,17 @@ void MIDIAnalyser::logEvent(const MIDIEvent& event) {
 					<< " (" << std::setw(3) << static_cast<int>(event.data1) << ")"
 					<< " velocity " << std::setw(3) << static_cast<int>(event.data2);
 
-				if (currentState.currentChord.size() > 1) {
+				const size_t chordSize = currentState.activeNoteCount();
+				if (chordSize > 1) {
 					oss << " | Chord: [";
-					for (size_t i = 0; i < currentState.currentChord.size(); ++i) {
-						if (i > 0) oss << ", ";
-						oss << getNoteName(currentState.currentChord[i]);
+					bool first = true;
+					for (size_t note = 0; note < MIDIState::NOTE_COUNT; ++note) {
+						if (!currentState.activeNotes.test(note)) continue;
+						if (!first) oss << ", ";
+						oss << getNoteName(static_cast<unsigned char>(note));
+						first = false;
 					}
-					oss << "] (" << currentState.currentChord.size() << " notes)";
+					oss << "] (" << chordSize << " notes)";
 				}
 			} else {
 				oss << "Note OFF: " << getNoteName(event.data1)
@@ -1,9 +1,11 @@
 #pragma once
 
-#include <map>
-#include <string>
-#include <vector>
+#include <array>
+#include <bitset>
 #include <chrono>
+#include <cstddef>
+#include <string>
+#include <type_traits>
 
 enum class MIDIEventType {
 	NoteOn,
@@ -33,25 +35,37 @@ struct MIDIEvent {
 	}
 };
 
+// Fixed size and trivially copyable, so it can be published through a seqlock and read
+// without allocating. The current chord is the set bits of activeNotes, lowest note first.
 struct MIDIState {
-	std::map<unsigned char, unsigned char> activeNotes;
-	std::vector<unsigned char> currentChord;
-	std::map<unsigned char, unsigned char> controlChanges;
+	static constexpr size_t NOTE_COUNT = 128;
+	static constexpr size_t CONTROLLER_COUNT = 128;
+
+	std::bitset<NOTE_COUNT> activeNotes;
+	std::array<unsigned char, NOTE_COUNT> noteVelocities{};
+	// Values are only meaningful for controllers whose bit in receivedControllers is set.
+	std::bitset<CONTROLLER_COUNT> receivedControllers;
+	std::array<unsigned char, CONTROLLER_COUNT> controlChanges{};
 	int pitchBend;
 	unsigned char programNumber;
 	MIDIEvent lastEvent;
 	bool hasNewEvent;
 
 	MIDIState() : pitchBend(0), programNumber(0), hasNewEvent(false) {}
+
+	bool isNoteActive(unsigned char note) const { return note < NOTE_COUNT && activeNotes.test(note); }
+	size_t activeNoteCount() const { return activeNotes.count(); }
 };
 
+static_assert(std::is_trivially_copyable_v<MIDIState>);
+
 class MIDIAnalyser {
 public:
 	MIDIAnalyser();
 	~MIDIAnalyser() = default;
 
 	void processEvent(const MIDIEvent& event);
-	MIDIState getCurrentState() const;
+	const MIDIState& getCurrentState() const;
 	void reset();
 
 private:
@@ -65,7 +79,6 @@ private:
 	void handleAftertouch(const MIDIEvent& event);
 	void handleChannelPressure(const MIDIEvent& event);
 
-	void updateChord();
 	void logEvent(const MIDIEvent& event);
 
 	std::string getNoteName(unsigned char note) const;
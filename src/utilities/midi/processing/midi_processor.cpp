@@ -1,6 +1,6 @@
 #include "midi_processor.h"
 
-MIDIProcessor::MIDIProcessor() : writeIndex(0), readIndex(0), running(false) {
+MIDIProcessor::MIDIProcessor() {
 }
 
 MIDIProcessor::~MIDIProcessor() {
@@ -8,70 +8,111 @@ MIDIProcessor::~MIDIProcessor() {
 }
 
 void MIDIProcessor::queueMIDIEvent(const MIDIEvent& event) {
-	size_t currentWrite = writeIndex.load(std::memory_order_relaxed);
-	size_t nextWrite = (currentWrite + 1) % QUEUE_SIZE;
-
-	if (nextWrite != readIndex.load(std::memory_order_acquire)) {
-		eventQueue[currentWrite] = event;
-		writeIndex.store(nextWrite, std::memory_order_release);
-		dataAvailable.notify_one();
+	const size_t currentWrite = writeIndex.load(std::memory_order_relaxed);
+	if (currentWrite - readIndex.load(std::memory_order_acquire) >= QUEUE_SIZE) {
+		droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+		return;
 	}
+
+	eventQueue[currentWrite & (QUEUE_SIZE - 1)] = event;
+	writeIndex.store(currentWrite + 1, std::memory_order_release);
+	wakeSequence.fetch_add(1, std::memory_order_release);
+	wakeSequence.notify_one();
 }
 
 MIDIState MIDIProcessor::getMIDIState() const {
-	std::lock_guard<std::mutex> lock(stateMutex);
-	return currentState;
+	MIDIState state;
+	while (true) {
+		const PublishedState& published = publishedStates[publishedStateIndex.load(std::memory_order_acquire)];
+		const uint32_t sequence = published.sequence.load(std::memory_order_acquire);
+		if ((sequence & 1U) != 0U) {
+			continue;
+		}
+
+		state = published.state;
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (published.sequence.load(std::memory_order_relaxed) == sequence) {
+			return state;
+		}
+	}
 }
 
+// The worker owns the analyser while it runs, so it applies the reset between batches.
 void MIDIProcessor::reset() {
-	std::lock_guard<std::mutex> lock(stateMutex);
-	analyser.reset();
-	currentState = MIDIState();
+	if (!running.load(std::memory_order_acquire)) {
+		applyReset();
+		return;
+	}
+	resetRequested.store(true, std::memory_order_release);
+	wakeSequence.fetch_add(1, std::memory_order_release);
+	wakeSequence.notify_one();
 }
 
 void MIDIProcessor::start() {
-	if (!running.load()) {
-		running.store(true);
+	if (!running.exchange(true)) {
 		workerThread = std::thread(&MIDIProcessor::processingThreadFunc, this);
 	}
 }
 
 void MIDIProcessor::stop() {
-	if (running.load()) {
-		running.store(false);
-		dataAvailable.notify_all();
+	if (running.exchange(false)) {
+		wakeSequence.fetch_add(1, std::memory_order_release);
+		wakeSequence.notify_one();
 		if (workerThread.joinable()) {
 			workerThread.join();
 		}
 	}
 }
 
+// Everything queued since the last wake is applied before the state is published once, so a
+// dense controller stream costs one publication per batch rather than one per event.
 void MIDIProcessor::processingThreadFunc() {
-	while (running.load()) {
-		std::unique_lock<std::mutex> lock(queueMutex);
-		dataAvailable.wait(lock, [this] {
-			return !running.load() || readIndex.load() != writeIndex.load();
-		});
-
-		if (!running.load()) {
-			break;
+	while (waitForEvent()) {
+		if (resetRequested.exchange(false, std::memory_order_acq_rel)) {
+			applyReset();
 		}
 
-		while (readIndex.load(std::memory_order_acquire) != writeIndex.load(std::memory_order_acquire)) {
-			size_t currentRead = readIndex.load(std::memory_order_relaxed);
-			MIDIEvent event = eventQueue[currentRead];
-			readIndex.store((currentRead + 1) % QUEUE_SIZE, std::memory_order_release);
+		const size_t end = writeIndex.load(std::memory_order_acquire);
+		size_t currentRead = readIndex.load(std::memory_order_relaxed);
+		if (currentRead == end) {
+			continue;
+		}
+		for (; currentRead != end; ++currentRead) {
+			analyser.processEvent(eventQueue[currentRead & (QUEUE_SIZE - 1)]);
+		}
+		readIndex.store(end, std::memory_order_release);
+		publishState(analyser.getCurrentState());
+	}
+}
 
-			lock.unlock();
-			processEvent(event);
-			lock.lock();
+bool MIDIProcessor::waitForEvent() {
+	while (running.load(std::memory_order_acquire)) {
+		// Read before re-checking, so an event queued in between changes it and the wait returns.
+		const uint32_t seen = wakeSequence.load(std::memory_order_acquire);
+		if (readIndex.load(std::memory_order_relaxed) != writeIndex.load(std::memory_order_acquire) ||
+			resetRequested.load(std::memory_order_acquire)) {
+			return true;
 		}
+		wakeSequence.wait(seen, std::memory_order_acquire);
 	}
+	return false;
 }
 
-void MIDIProcessor::processEvent(const MIDIEvent& event) {
-	analyser.processEvent(event);
+void MIDIProcessor::applyReset() {
+	analyser.reset();
+	publishState(analyser.getCurrentState());
+}
+
+void MIDIProcessor::publishState(const MIDIState& state) {
+	PublishedState& published = publishedStates[nextPublishedState];
+	const uint32_t sequence = published.sequence.load(std::memory_order_relaxed);
+	published.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	published.state = state;
 
-	std::lock_guard<std::mutex> lock(stateMutex);
-	currentState = analyser.getCurrentState();
+	published.sequence.store(sequence + 2, std::memory_order_release);
+	publishedStateIndex.store(nextPublishedState, std::memory_order_release);
+	nextPublishedState = (nextPublishedState + 1) % PUBLISHED_STATE_SLOTS;
 }
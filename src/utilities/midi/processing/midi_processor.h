@@ -1,8 +1,9 @@
 #pragma once
 
+#include <array>
 #include <atomic>
-#include <condition_variable>
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
 #include <thread>
 
 #include "midi_analyser.h"
@@ -12,29 +13,50 @@ public:
 	MIDIProcessor();
 	~MIDIProcessor();
 
+	// Called from the RtMidi callback only. Never locks or allocates; an event that finds the
+	// ring full is dropped and counted.
 	void queueMIDIEvent(const MIDIEvent& event);
 	MIDIState getMIDIState() const;
 	void reset();
 	void start();
 	void stop();
 
+	uint64_t getDroppedEventCount() const { return droppedEventCount.load(std::memory_order_relaxed); }
+
 	MIDIAnalyser& getAnalyser() { return analyser; }
 
 private:
-	static constexpr size_t QUEUE_SIZE = 256;
-
-	MIDIEvent eventQueue[QUEUE_SIZE];
-	std::atomic<size_t> writeIndex;
-	std::atomic<size_t> readIndex;
+	static constexpr size_t QUEUE_SIZE = 1024;
+	static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0, "QUEUE_SIZE must be a power of two");
+
+	// Single producer, the RtMidi callback, and single consumer, the worker. The indices run
+	// freely and are masked on access, so a full ring holds QUEUE_SIZE events.
+	std::array<MIDIEvent, QUEUE_SIZE> eventQueue;
+	alignas(64) std::atomic<size_t> writeIndex{0};
+	alignas(64) std::atomic<size_t> readIndex{0};
+	std::atomic<uint64_t> droppedEventCount{0};
 	std::thread workerThread;
-	std::atomic<bool> running;
-	std::condition_variable dataAvailable;
-	std::mutex queueMutex;
-
-	MIDIAnalyser analyser;
-	mutable std::mutex stateMutex;
-	MIDIState currentState;
+	std::atomic<bool> running{false};
+	// Bumped after every queued event and on stop or reset; the worker parks on it with
+	// atomic wait, so the callback only ever notifies.
+	std::atomic<uint32_t> wakeSequence{0};
+	std::atomic<bool> resetRequested{false};
+
+	MIDIAnalyser analyser;  // Worker only while running
+
+	// Seqlock-guarded snapshots: the worker publishes once per drained batch into the next
+	// slot while readers copy the last published one.
+	struct PublishedState {
+		std::atomic<uint32_t> sequence{0};
+		MIDIState state;
+	};
+	static constexpr size_t PUBLISHED_STATE_SLOTS = 3;
+	std::array<PublishedState, PUBLISHED_STATE_SLOTS> publishedStates;
+	std::atomic<size_t> publishedStateIndex{0};
+	size_t nextPublishedState{1};
 
 	void processingThreadFunc();
-	void processEvent(const MIDIEvent& event);
+	bool waitForEvent();
+	void applyReset();
+	void publishState(const MIDIState& state);
 };
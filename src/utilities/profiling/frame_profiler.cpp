@@ -0,0 +1,167 @@
+#include "utilities/profiling/frame_profiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace Utilities::Profiling {
+
+namespace {
+
+constexpr uint32_t STAGE_BITS = 8;
+constexpr uint32_t STAGE_MASK = (1U << STAGE_BITS) - 1U;
+
+std::atomic<uint32_t> nextThreadId{1};
+
+uint32_t currentThreadId() {
+    thread_local const uint32_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    return threadId;
+}
+
+float percentileMs(const std::vector<int64_t>& sortedNanos, const float percentile) {
+    const auto rank = static_cast<size_t>(percentile * static_cast<float>(sortedNanos.size() - 1) + 0.5f);
+    return static_cast<float>(sortedNanos[std::min(rank, sortedNanos.size() - 1)]) * 1.0e-6f;
+}
+
+}
+
+const char* stageName(const Stage stage) {
+    switch (stage) {
+        case Stage::AudioChunk:
+            return "Audio chunk";
+        case Stage::FFTWindow:
+            return "FFT window";
+        case Stage::CriticalBandSmoothing:
+            return "Critical-band smoothing";
+        case Stage::AnalyseSpectrum:
+            return "Analyse spectrum";
+        case Stage::ColourSmoothing:
+            return "Colour smoothing";
+        case Stage::Presentation:
+            return "Presentation";
+        case Stage::OSCSend:
+            return "OSC send";
+        case Stage::UIBuild:
+            return "UI build";
+        case Stage::RenderSubmit:
+            return "Render submit";
+        case Stage::Count:
+            break;
+    }
+    return "Unknown";
+}
+
+FrameProfiler& FrameProfiler::instance() {
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+void FrameProfiler::record(const Stage stage, const Clock::time_point start, const Clock::time_point end) {
+    const uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[index & (RING_CAPACITY - 1)];
+    slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.startNanos.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch_).count(),
+                          std::memory_order_relaxed);
+    slot.durationNanos.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+                             std::memory_order_relaxed);
+    slot.stageAndThread.store(static_cast<uint32_t>(stage) | (currentThreadId() << STAGE_BITS),
+                              std::memory_order_relaxed);
+
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+void FrameProfiler::copyRecent(std::vector<TimingSample>& samples) const {
+    samples.clear();
+    const uint64_t end = head_.load(std::memory_order_acquire);
+    const uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+    samples.reserve(static_cast<size_t>(end - begin));
+
+    for (uint64_t index = begin; index < end; ++index) {
+        const Slot& slot = slots_[index & (RING_CAPACITY - 1)];
+        const uint64_t expected = index * 2 + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            continue;
+        }
+
+        TimingSample sample;
+        sample.startNanos = slot.startNanos.load(std::memory_order_relaxed);
+        sample.durationNanos = slot.durationNanos.load(std::memory_order_relaxed);
+        const uint32_t stageAndThread = slot.stageAndThread.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+            continue;
+        }
+
+        sample.stage = static_cast<Stage>(stageAndThread & STAGE_MASK);
+        sample.threadId = stageAndThread >> STAGE_BITS;
+        samples.push_back(sample);
+    }
+}
+
+bool FrameProfiler::writeChromeTrace(const std::vector<TimingSample>& samples,
+                                     const std::filesystem::path& path,
+                                     std::string& errorMessage) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        errorMessage = "Unable to open " + path.string();
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const TimingSample& sample : samples) {
+        if (!first) {
+            file << ',';
+        }
+        first = false;
+        // Trace timestamps are microseconds.
+        file << "{\"name\":\"" << stageName(sample.stage)
+             << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << sample.threadId
+             << ",\"ts\":" << static_cast<double>(sample.startNanos) * 1.0e-3
+             << ",\"dur\":" << static_cast<double>(sample.durationNanos) * 1.0e-3 << '}';
+    }
+    file << "]}\n";
+
+    if (!file) {
+        errorMessage = "Unable to write " + path.string();
+        return false;
+    }
+    return true;
+}
+
+std::array<StageSummary, STAGE_COUNT> summarise(const std::vector<TimingSample>& samples) {
+    std::array<std::vector<int64_t>, STAGE_COUNT> durations;
+    for (const TimingSample& sample : samples) {
+        const auto stage = static_cast<size_t>(sample.stage);
+        if (stage < STAGE_COUNT) {
+            durations[stage].push_back(sample.durationNanos);
+        }
+    }
+
+    std::array<StageSummary, STAGE_COUNT> summaries{};
+    for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+        std::vector<int64_t>& stageDurations = durations[stage];
+        if (stageDurations.empty()) {
+            continue;
+        }
+        std::ranges::sort(stageDurations);
+
+        int64_t totalNanos = 0;
+        for (const int64_t nanos : stageDurations) {
+            totalNanos += nanos;
+        }
+
+        StageSummary& summary = summaries[stage];
+        summary.count = stageDurations.size();
+        summary.meanMs = static_cast<float>(totalNanos) * 1.0e-6f / static_cast<float>(stageDurations.size());
+        summary.p50Ms = percentileMs(stageDurations, 0.50f);
+        summary.p95Ms = percentileMs(stageDurations, 0.95f);
+        summary.p99Ms = percentileMs(stageDurations, 0.99f);
+        summary.maxMs = static_cast<float>(stageDurations.back()) * 1.0e-6f;
+    }
+    return summaries;
+}
+
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Utilities::Profiling {
+
+// The hot-path stages the scoped timers cover, across the analysis, presentation, OSC and
+// render threads.
+enum class Stage : uint8_t {
+    AudioChunk,
+    FFTWindow,
+    CriticalBandSmoothing,
+    AnalyseSpectrum,
+    ColourSmoothing,
+    Presentation,
+    OSCSend,
+    UIBuild,
+    RenderSubmit,
+    Count
+};
+
+constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+
+[[nodiscard]] const char* stageName(Stage stage);
+
+struct TimingSample {
+    Stage stage = Stage::AudioChunk;
+    uint32_t threadId = 0;
+    int64_t startNanos = 0;  // Since the profiler was created
+    int64_t durationNanos = 0;
+};
+
+struct StageSummary {
+    uint64_t count = 0;
+    float meanMs = 0.0f;
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float maxMs = 0.0f;
+};
+
+// Collects timings from any thread into a fixed ring without locks. Each slot is guarded by a
+// sequence number the way FFTProcessor publishes its frames, so a reader drops a sample that
+// was overwritten while it was being copied rather than waiting on the writer.
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static FrameProfiler& instance();
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // Off, a timer costs one relaxed load and records nothing.
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    [[nodiscard]] bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void record(Stage stage, Clock::time_point start, Clock::time_point end);
+
+    // Copies the samples still in the ring into samples, oldest first, reusing its storage.
+    void copyRecent(std::vector<TimingSample>& samples) const;
+
+    // Writes samples as complete events in the Chrome trace format, which chrome://tracing
+    // and Perfetto open.
+    static bool writeChromeTrace(const std::vector<TimingSample>& samples,
+                                 const std::filesystem::path& path,
+                                 std::string& errorMessage);
+
+private:
+    FrameProfiler() = default;
+
+    static constexpr size_t RING_CAPACITY = 16384;
+    static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0);
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int64_t> startNanos{0};
+        std::atomic<int64_t> durationNanos{0};
+        std::atomic<uint32_t> stageAndThread{0};
+    };
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> head_{0};
+    const Clock::time_point epoch_ = Clock::now();
+    std::array<Slot, RING_CAPACITY> slots_{};
+};
+
+// Percentiles over each stage's samples, indexed by Stage.
+[[nodiscard]] std::array<StageSummary, STAGE_COUNT> summarise(const std::vector<TimingSample>& samples);
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const Stage stage)
+        : stage_(stage),
+          active_(FrameProfiler::instance().isEnabled()) {
+        if (active_) {
+            start_ = FrameProfiler::Clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (active_) {
+            FrameProfiler::instance().record(stage_, start_, FrameProfiler::Clock::now());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Stage stage_;
+    bool active_;
+    FrameProfiler::Clock::time_point start_{};
+};
+
+}
+
+// Times the rest of the enclosing scope. Compiles to nothing unless ENABLE_FRAME_PROFILER is set.
+#ifdef ENABLE_FRAME_PROFILER
+#define SYN_PROFILE_CONCAT_INNER(a, b) a##b
+#define SYN_PROFILE_CONCAT(a, b) SYN_PROFILE_CONCAT_INNER(a, b)
+#define SYN_PROFILE_SCOPE(stage) \
+    const ::Utilities::Profiling::ScopedTimer SYN_PROFILE_CONCAT(synProfileScope, __LINE__)( \
+        ::Utilities::Profiling::Stage::stage)
+#else
+#define SYN_PROFILE_SCOPE(stage) static_cast<void>(0)
+#endif
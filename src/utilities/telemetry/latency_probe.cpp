@@ -0,0 +1,356 @@
+#include "utilities/telemetry/latency_probe.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include <nlohmann/json.hpp>
+
+namespace Utilities::Telemetry::LatencyProbe {
+
+namespace {
+
+// An impulse captured a little before it was emitted is still taken as its own; the two
+// times come from different stream clocks carried onto the steady one.
+constexpr int64_t kEmissionSlackMicros = 5'000;
+
+struct Probe {
+    std::atomic<bool> running{false};
+    std::atomic<Source> source{Source::OutputImpulse};
+    std::atomic<int64_t> lastStartMicros{0};
+
+    // The trial in flight: startMicros is 0 between trials, and originMicros and
+    // captureMicros stay 0 until the impulse has been emitted and picked up again.
+    std::atomic<int64_t> startMicros{0};
+    std::atomic<int64_t> originMicros{0};
+    std::atomic<int64_t> captureMicros{0};
+    std::array<std::atomic<int64_t>, kStageCount> reachedMicros{};
+
+    std::mutex mutex;
+    // Latency of each stage from the trial's origin, -1 where it was not reached.
+    std::vector<std::array<int64_t, kStageCount>> history;  // Protected by mutex
+    size_t historyNext = 0;  // Protected by mutex
+    uint64_t trials = 0;     // Protected by mutex
+    uint64_t missed = 0;     // Protected by mutex
+};
+
+Probe& probe() {
+    static Probe shared;
+    return shared;
+}
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void clearTrial(Probe& state) {
+    for (auto& reached : state.reachedMicros) {
+        reached.store(0, std::memory_order_relaxed);
+    }
+    state.captureMicros.store(0, std::memory_order_relaxed);
+    state.originMicros.store(0, std::memory_order_relaxed);
+}
+
+// Records the trial in flight once it has had kTrialSettleMicros to get through every stage.
+void settle(Probe& state, const int64_t now) {
+    const int64_t start = state.startMicros.load(std::memory_order_acquire);
+    if (start == 0 || now - start < kTrialSettleMicros) {
+        return;
+    }
+
+    const int64_t origin = state.originMicros.load(std::memory_order_acquire);
+    const int64_t capture = state.captureMicros.load(std::memory_order_acquire);
+    std::array<int64_t, kStageCount> latency;
+    latency.fill(-1);
+    if (origin != 0 && capture != 0) {
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            const int64_t reached = state.reachedMicros[stage].load(std::memory_order_acquire);
+            if (reached != 0) {
+                latency[stage] = std::max<int64_t>(reached - origin, 0);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (latency[static_cast<size_t>(Stage::Capture)] < 0) {
+            ++state.missed;
+        } else {
+            ++state.trials;
+            if (state.history.size() < kHistoryLength) {
+                state.history.push_back(latency);
+            } else {
+                state.history[state.historyNext] = latency;
+            }
+            state.historyNext = (state.historyNext + 1) % kHistoryLength;
+        }
+    }
+    clearTrial(state);
+    state.startMicros.store(0, std::memory_order_release);
+}
+
+StageDistribution summarise(std::vector<int64_t>& micros) {
+    StageDistribution distribution;
+    if (micros.empty()) {
+        return distribution;
+    }
+    std::ranges::sort(micros);
+    int64_t total = 0;
+    for (const int64_t value : micros) {
+        total += value;
+    }
+    const auto percentile = [&micros](const float fraction) {
+        const auto index = static_cast<size_t>(fraction * static_cast<float>(micros.size() - 1) + 0.5f);
+        return static_cast<float>(micros[std::min(index, micros.size() - 1)]) * 1.0e-3f;
+    };
+    distribution.count = micros.size();
+    distribution.meanMs = static_cast<float>(total) * 1.0e-3f / static_cast<float>(micros.size());
+    distribution.p50Ms = percentile(0.50f);
+    distribution.p95Ms = percentile(0.95f);
+    distribution.p99Ms = percentile(0.99f);
+    distribution.maxMs = static_cast<float>(micros.back()) * 1.0e-3f;
+    return distribution;
+}
+
+nlohmann::json toJson(const StageDistribution& distribution) {
+    return {
+        {"count", distribution.count},
+        {"mean_ms", distribution.meanMs},
+        {"p50_ms", distribution.p50Ms},
+        {"p95_ms", distribution.p95Ms},
+        {"p99_ms", distribution.p99Ms},
+        {"max_ms", distribution.maxMs}
+    };
+}
+
+}
+
+void start(const Source source) {
+    Probe& state = probe();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.history.clear();
+        state.historyNext = 0;
+        state.trials = 0;
+        state.missed = 0;
+    }
+    clearTrial(state);
+    state.startMicros.store(0, std::memory_order_relaxed);
+    state.lastStartMicros.store(0, std::memory_order_relaxed);
+    state.source.store(source, std::memory_order_relaxed);
+    state.running.store(true, std::memory_order_release);
+}
+
+void stop() {
+    probe().running.store(false, std::memory_order_release);
+}
+
+bool isRunning() {
+    return probe().running.load(std::memory_order_acquire);
+}
+
+bool impulseDue() {
+    Probe& state = probe();
+    if (!state.running.load(std::memory_order_acquire) ||
+        state.source.load(std::memory_order_relaxed) != Source::OutputImpulse) {
+        return false;
+    }
+    const int64_t now = nowMicros();
+    settle(state, now);
+    if (state.startMicros.load(std::memory_order_acquire) != 0 ||
+        now - state.lastStartMicros.load(std::memory_order_relaxed) < kImpulseIntervalMicros) {
+        return false;
+    }
+    clearTrial(state);
+    state.lastStartMicros.store(now, std::memory_order_relaxed);
+    state.startMicros.store(now, std::memory_order_release);
+    return true;
+}
+
+void impulseEmitted(const int64_t dacMicros) {
+    Probe& state = probe();
+    if (!state.running.load(std::memory_order_acquire) || state.startMicros.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    int64_t expected = 0;
+    state.originMicros.compare_exchange_strong(expected, dacMicros, std::memory_order_acq_rel);
+}
+
+void onsetCaptured(const int64_t captureMicros) {
+    Probe& state = probe();
+    if (!state.running.load(std::memory_order_acquire) || captureMicros <= 0) {
+        return;
+    }
+
+    if (state.source.load(std::memory_order_relaxed) == Source::ExternalTransient) {
+        // An onset too soon after the last trial started is most likely that one's tail.
+        const int64_t now = nowMicros();
+        if (now - state.lastStartMicros.load(std::memory_order_relaxed) < kImpulseIntervalMicros) {
+            return;
+        }
+        int64_t idle = 0;
+        if (!state.startMicros.compare_exchange_strong(idle, now, std::memory_order_acq_rel)) {
+            return;
+        }
+        clearTrial(state);
+        state.lastStartMicros.store(now, std::memory_order_relaxed);
+        state.originMicros.store(captureMicros, std::memory_order_release);
+    } else {
+        const int64_t origin = state.originMicros.load(std::memory_order_acquire);
+        if (origin == 0 || captureMicros + kEmissionSlackMicros < origin) {
+            return;
+        }
+    }
+
+    int64_t expected = 0;
+    if (state.captureMicros.compare_exchange_strong(expected, captureMicros, std::memory_order_acq_rel)) {
+        state.reachedMicros[static_cast<size_t>(Stage::Capture)].store(captureMicros, std::memory_order_release);
+    }
+}
+
+void frameReached(const Stage stage, const int64_t frameCaptureMicros) {
+    Probe& state = probe();
+    if (!state.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    const int64_t capture = state.captureMicros.load(std::memory_order_acquire);
+    if (capture == 0 || frameCaptureMicros < capture) {
+        return;
+    }
+    int64_t expected = 0;
+    state.reachedMicros[static_cast<size_t>(stage)].compare_exchange_strong(expected, nowMicros(),
+                                                                            std::memory_order_acq_rel);
+}
+
+void framePresented() {
+    Probe& state = probe();
+    if (!state.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    const int64_t now = nowMicros();
+    if (state.reachedMicros[static_cast<size_t>(Stage::Interface)].load(std::memory_order_acquire) != 0) {
+        int64_t expected = 0;
+        state.reachedMicros[static_cast<size_t>(Stage::Present)].compare_exchange_strong(expected, now,
+                                                                                        std::memory_order_acq_rel);
+    }
+    settle(state, now);
+}
+
+Report collect() {
+    Probe& state = probe();
+    settle(state, nowMicros());
+
+    Report report;
+    report.source = state.source.load(std::memory_order_relaxed);
+    report.running = state.running.load(std::memory_order_acquire);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    report.trials = state.trials;
+    report.missed = state.missed;
+
+    const size_t count = state.history.size();
+    const size_t oldest = count < kHistoryLength ? 0 : state.historyNext;
+    std::array<std::vector<int64_t>, kStageCount> stageMicros;
+    std::vector<int64_t> totalMicros;
+    report.samples.reserve(count);
+    for (size_t index = 0; index < count; ++index) {
+        const auto& latency = state.history[(oldest + index) % count];
+        std::array<float, kStageCount> sample;
+        int64_t last = -1;
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            sample[stage] = latency[stage] < 0 ? -1.0f : static_cast<float>(latency[stage]) * 1.0e-3f;
+            if (latency[stage] >= 0) {
+                stageMicros[stage].push_back(latency[stage]);
+                last = std::max(last, latency[stage]);
+            }
+        }
+        report.samples.push_back(sample);
+        if (last >= 0) {
+            totalMicros.push_back(last);
+        }
+    }
+    for (size_t stage = 0; stage < kStageCount; ++stage) {
+        report.stages[stage] = summarise(stageMicros[stage]);
+    }
+    report.total = summarise(totalMicros);
+    return report;
+}
+
+bool writeJson(const Report& report, const std::filesystem::path& path, std::string& errorMessage) {
+    nlohmann::json document;
+    document["source"] = name(report.source);
+    document["trials"] = report.trials;
+    document["missed"] = report.missed;
+    document["impulse_interval_ms"] = kImpulseIntervalMicros / 1000;
+
+    nlohmann::json& stages = document["stages"];
+    stages = nlohmann::json::object();
+    for (size_t stage = 0; stage < kStageCount; ++stage) {
+        stages[name(static_cast<Stage>(stage))] = toJson(report.stages[stage]);
+    }
+    document["total"] = toJson(report.total);
+
+    nlohmann::json& samples = document["samples_ms"];
+    samples = nlohmann::json::array();
+    for (const auto& sample : report.samples) {
+        nlohmann::json trial = nlohmann::json::object();
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            trial[name(static_cast<Stage>(stage))] = sample[stage] < 0.0f ? nlohmann::json() : nlohmann::json(sample[stage]);
+        }
+        samples.push_back(std::move(trial));
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        errorMessage = "Unable to open " + path.string();
+        return false;
+    }
+    file << document.dump(2) << '\n';
+    if (!file) {
+        errorMessage = "Unable to write " + path.string();
+        return false;
+    }
+    return true;
+}
+
+const char* name(const Stage stage) {
+    switch (stage) {
+        case Stage::Capture: return "capture";
+        case Stage::Analysis: return "analysis";
+        case Stage::Colour: return "colour";
+        case Stage::Smoothing: return "smoothing";
+        case Stage::OSCSend: return "osc_send";
+        case Stage::Interface: return "interface";
+        case Stage::Present: return "present";
+        case Stage::Count: break;
+    }
+    return "unknown";
+}
+
+const char* name(const Source source) {
+    return source == Source::ExternalTransient ? "external" : "impulse";
+}
+
+bool Config::parseArgument(int& index, const int argc, char** argv) {
+    const char* argument = argv[index];
+    if (std::strcmp(argument, "--latency-probe") == 0) {
+        enabled = true;
+        if (index + 1 < argc && argv[index + 1][0] != '-') {
+            source = std::strcmp(argv[++index], "external") == 0 ? Source::ExternalTransient : Source::OutputImpulse;
+        }
+    } else if (std::strcmp(argument, "--latency-report") == 0) {
+        enabled = true;
+        if (index + 1 < argc) {
+            reportFile = argv[++index];
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}
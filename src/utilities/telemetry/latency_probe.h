@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Utilities::Telemetry::LatencyProbe {
+
+// Measures audio-in to colour-out latency one trial at a time. A trial starts from a test
+// impulse leaving the output converter or, with no emitter, from an external transient
+// reaching the input, and each stage records when the first frame holding it got through.
+// Every stage is therefore cumulative from the trial's origin. The hooks live on the audio,
+// analysis, presentation and OSC threads, so they only touch atomics and never wait;
+// trials are settled and summarised by whoever calls collect().
+//
+// Times are steady clock microseconds, the clock SpectralData capture times use.
+
+enum class Source {
+    OutputImpulse,     // The probe asks for impulses, which AudioOutput plays
+    ExternalTransient  // Any onset the input picks up, from a loopback or a click track
+};
+
+enum class Stage : size_t {
+    Capture,    // The impulse's block reached the input converter
+    Analysis,   // AudioProcessor published the first FFT frame whose window holds it
+    Colour,     // That frame was turned into a colour
+    Smoothing,  // ... and smoothed
+    OSCSend,    // A frame carrying it left the OSC sender
+    Interface,  // A UI frame picked up its colour
+    Present,    // That UI frame was submitted to bgfx
+    Count
+};
+
+inline constexpr size_t kStageCount = static_cast<size_t>(Stage::Count);
+
+// One impulse a second; a trial settles this long after it starts, whichever stages it reached.
+inline constexpr int64_t kImpulseIntervalMicros = 1'000'000;
+inline constexpr int64_t kTrialSettleMicros = 750'000;
+// Trials summarised, the most recent ones.
+inline constexpr size_t kHistoryLength = 256;
+
+struct StageDistribution {
+    uint64_t count = 0;
+    float meanMs = 0.0f;
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float maxMs = 0.0f;
+};
+
+struct Report {
+    Source source = Source::OutputImpulse;
+    bool running = false;
+    uint64_t trials = 0;
+    // Impulses the input never picked up within kTrialSettleMicros.
+    uint64_t missed = 0;
+    std::array<StageDistribution, kStageCount> stages{};
+    // Through the last stage each trial reached: Present with the UI, OSCSend headless.
+    StageDistribution total;
+    // Per trial and stage in milliseconds, oldest first; negative where a stage was not reached.
+    std::vector<std::array<float, kStageCount>> samples;
+};
+
+// Starting clears the history of the previous run.
+void start(Source source);
+void stop();
+bool isRunning();
+
+// For OutputImpulse: true once an impulse is due, which the caller then plays through
+// AudioOutput::queueImpulse. The trial starts here and its origin is set by impulseEmitted.
+bool impulseDue();
+
+void impulseEmitted(int64_t dacMicros);
+// A time-domain onset whose block was captured at captureMicros.
+void onsetCaptured(int64_t captureMicros);
+// A frame whose newest sample was captured at frameCaptureMicros got through stage.
+void frameReached(Stage stage, int64_t frameCaptureMicros);
+// A UI frame has been submitted; completes Present for a trial whose Interface stage is done.
+void framePresented();
+
+// Settles finished trials and summarises the history.
+Report collect();
+bool writeJson(const Report& report, const std::filesystem::path& path, std::string& errorMessage);
+
+// snake_case, as the telemetry names are.
+const char* name(Stage stage);
+const char* name(Source source);
+
+// Consumes --latency-probe <impulse|external> or --latency-report <path> at argv[index],
+// advancing index past the value.
+struct Config {
+    bool enabled = false;
+    Source source = Source::OutputImpulse;
+    // Written when the run ends. Empty writes nothing.
+    std::string reportFile;
+
+    bool parseArgument(int& index, int argc, char** argv);
+};
+
+}
@@ -0,0 +1,305 @@
+#include "utilities/telemetry/telemetry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+namespace Utilities::Telemetry {
+
+namespace {
+
+// Each slot on a cache line of its own, since the writers are different threads.
+struct alignas(64) CounterSlot {
+    std::atomic<uint64_t> value{0};
+};
+
+struct alignas(64) GaugeSlot {
+    std::atomic<double> value{0.0};
+};
+
+struct alignas(64) StageSlot {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> totalMicros{0};
+    std::atomic<uint64_t> lastMicros{0};
+    std::atomic<uint64_t> peakMicros{0};
+};
+
+struct alignas(64) MemorySlot {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> peakBytes{0};
+};
+
+struct Registry {
+    std::array<CounterSlot, kCounterCount> counters;
+    std::array<GaugeSlot, kGaugeCount> gauges;
+    std::array<StageSlot, kStageCount> stages;
+    std::array<MemorySlot, kMemoryCount> memory;
+    MemorySlot totalMemory;
+};
+
+Registry& registry() {
+    static Registry shared;
+    return shared;
+}
+
+void raisePeak(std::atomic<uint64_t>& peak, const uint64_t value) {
+    uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+MemorySample load(const MemorySlot& slot) {
+    return MemorySample{slot.bytes.load(std::memory_order_relaxed), slot.peakBytes.load(std::memory_order_relaxed)};
+}
+
+void appendLine(std::string& text, const char* format, const char* metric, const double value) {
+    char line[160];
+    const int length = std::snprintf(line, sizeof(line), format, metric, value);
+    if (length > 0) {
+        text.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+    }
+}
+
+void appendHelp(std::string& text, const char* metric, const char* type, const char* help) {
+    text += "# HELP synesthesia_";
+    text += metric;
+    text += ' ';
+    text += help;
+    text += "\n# TYPE synesthesia_";
+    text += metric;
+    text += ' ';
+    text += type;
+    text += '\n';
+}
+
+}
+
+void increment(const Counter counter, const uint64_t amount) {
+    registry().counters[static_cast<size_t>(counter)].value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+void set(const Gauge gauge, const double value) {
+    registry().gauges[static_cast<size_t>(gauge)].value.store(value, std::memory_order_relaxed);
+}
+
+void record(const Stage stage, const std::chrono::steady_clock::duration elapsed) {
+    const auto micros = static_cast<uint64_t>(std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), 0));
+    StageSlot& slot = registry().stages[static_cast<size_t>(stage)];
+    slot.count.fetch_add(1, std::memory_order_relaxed);
+    slot.totalMicros.fetch_add(micros, std::memory_order_relaxed);
+    slot.lastMicros.store(micros, std::memory_order_relaxed);
+    raisePeak(slot.peakMicros, micros);
+}
+
+// The total moves by the difference from the value replaced, so owners setting different
+// subsystems at once still sum correctly.
+void setBytes(const Memory memory, const uint64_t bytes) {
+    Registry& shared = registry();
+    MemorySlot& slot = shared.memory[static_cast<size_t>(memory)];
+    const uint64_t previous = slot.bytes.exchange(bytes, std::memory_order_relaxed);
+    raisePeak(slot.peakBytes, bytes);
+    const uint64_t total = shared.totalMemory.bytes.fetch_add(bytes - previous, std::memory_order_relaxed) + (bytes - previous);
+    raisePeak(shared.totalMemory.peakBytes, total);
+}
+
+uint64_t Snapshot::xruns() const {
+    return counter(Counter::InputOverflows) + counter(Counter::OutputUnderflows);
+}
+
+// Slots are read one at a time, so a snapshot taken mid-update can mix a stage's count with
+// the previous pass's total; the error is one pass.
+Snapshot snapshot() {
+    const Registry& shared = registry();
+    Snapshot current;
+    for (size_t index = 0; index < kCounterCount; ++index) {
+        current.counters[index] = shared.counters[index].value.load(std::memory_order_relaxed);
+    }
+    for (size_t index = 0; index < kGaugeCount; ++index) {
+        current.gauges[index] = shared.gauges[index].value.load(std::memory_order_relaxed);
+    }
+    for (size_t index = 0; index < kStageCount; ++index) {
+        const StageSlot& slot = shared.stages[index];
+        current.stages[index] = StageSample{
+            slot.count.load(std::memory_order_relaxed),
+            slot.totalMicros.load(std::memory_order_relaxed),
+            slot.lastMicros.load(std::memory_order_relaxed),
+            slot.peakMicros.load(std::memory_order_relaxed)
+        };
+    }
+    for (size_t index = 0; index < kMemoryCount; ++index) {
+        current.memory[index] = load(shared.memory[index]);
+    }
+    current.totalMemory = load(shared.totalMemory);
+    return current;
+}
+
+const char* name(const Counter counter) {
+    switch (counter) {
+        case Counter::InputOverflows: return "input_overflows";
+        case Counter::InputUnderflows: return "input_underflows";
+        case Counter::OutputUnderflows: return "output_underflows";
+        case Counter::OutputOverflows: return "output_overflows";
+        case Counter::AnalysisBuffersDropped: return "analysis_buffers_dropped";
+        case Counter::SpectrumFramesDropped: return "spectrum_frames_dropped";
+        case Counter::OSCFramesDropped: return "osc_frames_dropped";
+        case Counter::OSCFramesCoalesced: return "osc_frames_coalesced";
+        case Counter::Count: break;
+    }
+    return "unknown";
+}
+
+const char* name(const Gauge gauge) {
+    switch (gauge) {
+        case Gauge::AnalysisQueueDepth: return "analysis_queue_depth";
+        case Gauge::AnalysisRingFill: return "analysis_ring_fill_ratio";
+        case Gauge::SpectrumRingFill: return "spectrum_ring_fill_ratio";
+        case Gauge::Count: break;
+    }
+    return "unknown";
+}
+
+const char* name(const Stage stage) {
+    switch (stage) {
+        case Stage::InputCallback: return "input_callback";
+        case Stage::OutputCallback: return "output_callback";
+        case Stage::AnalysisQueue: return "analysis_queue";
+        case Stage::OSCSend: return "osc_send";
+        case Stage::Count: break;
+    }
+    return "unknown";
+}
+
+const char* name(const Memory memory) {
+    switch (memory) {
+        case Memory::RecorderSamples: return "recorder_samples";
+        case Memory::PreviewSamples: return "preview_samples";
+        case Memory::ResidentSpectra: return "resident_spectra";
+        case Memory::PlaybackAudio: return "playback_audio";
+        case Memory::OutputResample: return "output_resample";
+        case Memory::RSYNSource: return "rsyn_source";
+        case Memory::PresentationFrames: return "presentation_frames";
+        case Memory::TimelinePreview: return "timeline_preview";
+        case Memory::Count: break;
+    }
+    return "unknown";
+}
+
+const char* description(const Counter counter) {
+    switch (counter) {
+        case Counter::InputOverflows: return "Input buffers the device overwrote before the callback read them.";
+        case Counter::InputUnderflows: return "Input callbacks given silence because the device had no data.";
+        case Counter::OutputUnderflows: return "Output buffers the device played before the callback filled them.";
+        case Counter::OutputOverflows: return "Output callbacks whose data the device discarded.";
+        case Counter::AnalysisBuffersDropped: return "Input buffers dropped because the analysis worker fell behind.";
+        case Counter::SpectrumFramesDropped: return "Spectral frames dropped because the frame ring was full.";
+        case Counter::OSCFramesDropped: return "OSC frames that failed to send.";
+        case Counter::OSCFramesCoalesced: return "OSC frames replaced by a newer one before they were sent.";
+        case Counter::Count: break;
+    }
+    return "";
+}
+
+const char* description(const Gauge gauge) {
+    switch (gauge) {
+        case Gauge::AnalysisQueueDepth: return "Input buffers waiting for the analysis worker.";
+        case Gauge::AnalysisRingFill: return "Fraction of the analysis sample ring in use.";
+        case Gauge::SpectrumRingFill: return "Fraction of the spectral frame ring waiting for the UI or OSC.";
+        case Gauge::Count: break;
+    }
+    return "";
+}
+
+const char* description(const Stage stage) {
+    switch (stage) {
+        case Stage::InputCallback: return "Time spent in the input callback.";
+        case Stage::OutputCallback: return "Time spent in the output callback.";
+        case Stage::AnalysisQueue: return "Time from an input buffer being queued to its analysis finishing.";
+        case Stage::OSCSend: return "Time spent sending one OSC frame.";
+        case Stage::Count: break;
+    }
+    return "";
+}
+
+const char* description(const Memory memory) {
+    switch (memory) {
+        case Memory::RecorderSamples: return "Recorded or loaded frames and the spectra they hold in full.";
+        case Memory::PreviewSamples: return "Frames of the preview drawn while a file is imported.";
+        case Memory::ResidentSpectra: return "Compressed spectra of a large loaded project.";
+        case Memory::PlaybackAudio: return "The track the recorder plays back, shared with the output stream.";
+        case Memory::OutputResample: return "The output stream's copy of the track resampled to the device rate.";
+        case Memory::RSYNSource: return "Source audio embedded in a loaded .rsyn.";
+        case Memory::PresentationFrames: return "Presentation frames of a loaded or replayed track.";
+        case Memory::TimelinePreview: return "Colour samples behind the drawn timeline.";
+        case Memory::Count: break;
+    }
+    return "";
+}
+
+std::string formatPrometheus(const Snapshot& current) {
+    std::string text;
+    text.reserve(4096);
+    for (size_t index = 0; index < kCounterCount; ++index) {
+        const std::string metric = std::string(name(static_cast<Counter>(index))) + "_total";
+        appendHelp(text, metric.c_str(), "counter", description(static_cast<Counter>(index)));
+        appendLine(text, "synesthesia_%s %.0f\n", metric.c_str(), static_cast<double>(current.counters[index]));
+    }
+    for (size_t index = 0; index < kGaugeCount; ++index) {
+        const char* metric = name(static_cast<Gauge>(index));
+        appendHelp(text, metric, "gauge", description(static_cast<Gauge>(index)));
+        appendLine(text, "synesthesia_%s %g\n", metric, current.gauges[index]);
+    }
+    for (size_t index = 0; index < kStageCount; ++index) {
+        const StageSample& sample = current.stages[index];
+        const std::string metric = std::string(name(static_cast<Stage>(index))) + "_seconds";
+        appendHelp(text, metric.c_str(), "summary", description(static_cast<Stage>(index)));
+        appendLine(text, "synesthesia_%s_sum %.6f\n", metric.c_str(), static_cast<double>(sample.totalMicros) / 1e6);
+        appendLine(text, "synesthesia_%s_count %.0f\n", metric.c_str(), static_cast<double>(sample.count));
+        const std::string peak = std::string(name(static_cast<Stage>(index))) + "_peak_seconds";
+        appendHelp(text, peak.c_str(), "gauge", "Longest pass through the stage since start-up.");
+        appendLine(text, "synesthesia_%s %.6f\n", peak.c_str(), static_cast<double>(sample.peakMicros) / 1e6);
+    }
+    for (size_t index = 0; index <= kMemoryCount; ++index) {
+        const bool total = index == kMemoryCount;
+        const MemorySample& sample = total ? current.totalMemory : current.memory[index];
+        const std::string subsystem = std::string("memory_") + (total ? "total" : name(static_cast<Memory>(index)));
+        const std::string metric = subsystem + "_bytes";
+        appendHelp(text, metric.c_str(), "gauge",
+                   total ? "Bytes held by every tracked subsystem." : description(static_cast<Memory>(index)));
+        appendLine(text, "synesthesia_%s %.0f\n", metric.c_str(), static_cast<double>(sample.bytes));
+        const std::string peak = subsystem + "_peak_bytes";
+        appendHelp(text, peak.c_str(), "gauge", "Most bytes held since start-up.");
+        appendLine(text, "synesthesia_%s %.0f\n", peak.c_str(), static_cast<double>(sample.peakBytes));
+    }
+    return text;
+}
+
+std::string formatStatsd(const Snapshot& current, const Snapshot& previous) {
+    std::string text;
+    text.reserve(1024);
+    for (size_t index = 0; index < kCounterCount; ++index) {
+        const uint64_t delta = current.counters[index] - std::min(previous.counters[index], current.counters[index]);
+        appendLine(text, "synesthesia.%s:%.0f|c\n", name(static_cast<Counter>(index)), static_cast<double>(delta));
+    }
+    for (size_t index = 0; index < kGaugeCount; ++index) {
+        appendLine(text, "synesthesia.%s:%g|g\n", name(static_cast<Gauge>(index)), current.gauges[index]);
+    }
+    for (size_t index = 0; index < kStageCount; ++index) {
+        const StageSample& now = current.stages[index];
+        const StageSample& before = previous.stages[index];
+        if (now.count <= before.count) {
+            continue;
+        }
+        const double meanMs = static_cast<double>(now.totalMicros - before.totalMicros) /
+                              static_cast<double>(now.count - before.count) / 1000.0;
+        appendLine(text, "synesthesia.%s:%.3f|ms\n", name(static_cast<Stage>(index)), meanMs);
+    }
+    for (size_t index = 0; index < kMemoryCount; ++index) {
+        const std::string metric = std::string("memory_") + name(static_cast<Memory>(index)) + "_bytes";
+        appendLine(text, "synesthesia.%s:%.0f|g\n", metric.c_str(), static_cast<double>(current.memory[index].bytes));
+    }
+    appendLine(text, "synesthesia.%s:%.0f|g\n", "memory_total_bytes", static_cast<double>(current.totalMemory.bytes));
+    return text;
+}
+
+}
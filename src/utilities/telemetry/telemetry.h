@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Utilities::Telemetry {
+
+// One registry of counters, gauges and stage timings for the whole process. Writers are the
+// audio callbacks, the analysis worker and the OSC sender, so every update is a relaxed
+// atomic on a slot of its own and never allocates or locks. Readers take a Snapshot.
+
+// Monotonic since start-up, as Prometheus counters are.
+enum class Counter : size_t {
+    InputOverflows,
+    InputUnderflows,
+    OutputUnderflows,
+    OutputOverflows,
+    AnalysisBuffersDropped,
+    SpectrumFramesDropped,
+    OSCFramesDropped,
+    OSCFramesCoalesced,
+    Count
+};
+
+// Last value written.
+enum class Gauge : size_t {
+    AnalysisQueueDepth,
+    AnalysisRingFill,
+    SpectrumRingFill,
+    Count
+};
+
+// How long one pass through a stage took, in microseconds.
+enum class Stage : size_t {
+    InputCallback,
+    OutputCallback,
+    AnalysisQueue,
+    OSCSend,
+    Count
+};
+
+// Bytes held by one subsystem's large buffers, set by their owner whenever they change.
+enum class Memory : size_t {
+    RecorderSamples,
+    PreviewSamples,
+    ResidentSpectra,
+    PlaybackAudio,
+    OutputResample,
+    RSYNSource,
+    PresentationFrames,
+    TimelinePreview,
+    Count
+};
+
+inline constexpr size_t kCounterCount = static_cast<size_t>(Counter::Count);
+inline constexpr size_t kGaugeCount = static_cast<size_t>(Gauge::Count);
+inline constexpr size_t kStageCount = static_cast<size_t>(Stage::Count);
+inline constexpr size_t kMemoryCount = static_cast<size_t>(Memory::Count);
+
+void increment(Counter counter, uint64_t amount = 1);
+void set(Gauge gauge, double value);
+void record(Stage stage, std::chrono::steady_clock::duration elapsed);
+void setBytes(Memory memory, uint64_t bytes);
+
+// Times a stage from construction to destruction.
+class StageTimer {
+public:
+    explicit StageTimer(const Stage stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+    ~StageTimer() { record(stage_, std::chrono::steady_clock::now() - start_); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+struct StageSample {
+    uint64_t count = 0;
+    uint64_t totalMicros = 0;
+    uint64_t lastMicros = 0;
+    uint64_t peakMicros = 0;
+
+    double meanMs() const { return count > 0 ? static_cast<double>(totalMicros) / static_cast<double>(count) / 1000.0 : 0.0; }
+    double lastMs() const { return static_cast<double>(lastMicros) / 1000.0; }
+    double peakMs() const { return static_cast<double>(peakMicros) / 1000.0; }
+};
+
+// peakBytes is the high-water mark since start-up.
+struct MemorySample {
+    uint64_t bytes = 0;
+    uint64_t peakBytes = 0;
+
+    double megabytes() const { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+    double peakMegabytes() const { return static_cast<double>(peakBytes) / (1024.0 * 1024.0); }
+};
+
+struct Snapshot {
+    std::array<uint64_t, kCounterCount> counters{};
+    std::array<double, kGaugeCount> gauges{};
+    std::array<StageSample, kStageCount> stages{};
+    std::array<MemorySample, kMemoryCount> memory{};
+    // All subsystems together. Its peak is the most held at once, not the sum of the peaks.
+    MemorySample totalMemory{};
+
+    uint64_t counter(Counter which) const { return counters[static_cast<size_t>(which)]; }
+    double gauge(Gauge which) const { return gauges[static_cast<size_t>(which)]; }
+    const StageSample& stage(Stage which) const { return stages[static_cast<size_t>(which)]; }
+    const MemorySample& memoryUsage(Memory which) const { return memory[static_cast<size_t>(which)]; }
+    // Input overflows and output underflows, the xruns a listener can hear.
+    uint64_t xruns() const;
+};
+
+Snapshot snapshot();
+
+// snake_case names, shared by the OSC addresses, the Prometheus metrics and statsd keys.
+const char* name(Counter counter);
+const char* name(Gauge gauge);
+const char* name(Stage stage);
+const char* name(Memory memory);
+const char* description(Counter counter);
+const char* description(Gauge gauge);
+const char* description(Stage stage);
+const char* description(Memory memory);
+
+// The Prometheus text exposition format, every metric prefixed synesthesia_. Stages are
+// summaries in seconds with _sum and _count, plus a _peak_seconds gauge. Memory is a
+// memory_<name>_bytes gauge with a memory_<name>_peak_bytes beside it.
+std::string formatPrometheus(const Snapshot& current);
+// statsd lines: counters as |c deltas since previous, gauges and memory as |g, stages as the
+// mean |ms of the passes since previous.
+std::string formatStatsd(const Snapshot& current, const Snapshot& previous);
+
+}
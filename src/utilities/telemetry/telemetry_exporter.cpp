@@ -0,0 +1,124 @@
+#include "utilities/telemetry/telemetry_exporter.h"
+
+#include "utilities/telemetry/telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <system_error>
+
+#ifdef ENABLE_OSC
+#include "ip/UdpSocket.h"
+#endif
+
+namespace Utilities::Telemetry {
+
+bool ExportConfig::parseArgument(int& index, const int argc, char** argv) {
+    const char* argument = argv[index];
+    if (std::strcmp(argument, "--metrics-file") == 0) {
+        if (index + 1 < argc) {
+            prometheusFile = argv[++index];
+        }
+    } else if (std::strcmp(argument, "--statsd") == 0) {
+        if (index + 1 < argc) {
+            const std::string target = argv[++index];
+            const size_t colon = target.rfind(':');
+            statsdHost = target.substr(0, colon);
+            if (colon != std::string::npos) {
+                statsdPort = static_cast<uint16_t>(std::clamp(std::atoi(target.c_str() + colon + 1), 1, 65535));
+            }
+        }
+    } else if (std::strcmp(argument, "--metrics-interval") == 0) {
+        if (index + 1 < argc) {
+            intervalSeconds = std::clamp(std::atof(argv[++index]), 0.1, 3600.0);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+Exporter::Exporter(const ExportConfig& config) : config_(config) {
+    if (config_.enabled()) {
+        thread_ = std::thread(&Exporter::run, this);
+    }
+}
+
+Exporter::~Exporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stopRequested_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Exporter::run() {
+#ifdef ENABLE_OSC
+    std::unique_ptr<UdpTransmitSocket> statsdSocket;
+    if (!config_.statsdHost.empty()) {
+        try {
+            statsdSocket = std::make_unique<UdpTransmitSocket>(
+                IpEndpointName(config_.statsdHost.c_str(), static_cast<int>(config_.statsdPort)));
+        } catch (const std::exception& exception) {
+            std::cerr << "statsd: " << exception.what() << std::endl;
+        }
+    }
+#else
+    if (!config_.statsdHost.empty()) {
+        std::cerr << "statsd export needs a build with ENABLE_OSC" << std::endl;
+    }
+#endif
+
+    const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(config_.intervalSeconds));
+    Snapshot previous = snapshot();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopRequested_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+        const Snapshot current = snapshot();
+        if (!config_.prometheusFile.empty()) {
+            writePrometheusFile(formatPrometheus(current));
+        }
+#ifdef ENABLE_OSC
+        if (statsdSocket) {
+            const std::string lines = formatStatsd(current, previous);
+            try {
+                statsdSocket->Send(lines.data(), lines.size());
+            } catch (...) {
+            }
+        }
+#endif
+        previous = current;
+        lock.lock();
+    }
+}
+
+// Written beside the target and renamed over it, so a scrape never reads half a file.
+void Exporter::writePrometheusFile(const std::string& text) const {
+    const std::filesystem::path target(config_.prometheusFile);
+    std::filesystem::path staging = target;
+    staging += ".tmp";
+    {
+        std::ofstream file(staging, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return;
+        }
+        file << text;
+        if (!file) {
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(staging, target, error);
+}
+
+}
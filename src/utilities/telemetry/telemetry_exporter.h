@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Utilities::Telemetry {
+
+struct ExportConfig {
+    // Rewritten every interval in the Prometheus text format, for node_exporter's textfile
+    // collector. Empty disables it.
+    std::string prometheusFile;
+    // statsd over UDP. Empty disables it; needs an ENABLE_OSC build for the socket.
+    std::string statsdHost;
+    uint16_t statsdPort = 8125;
+    double intervalSeconds = 10.0;
+
+    bool enabled() const { return !prometheusFile.empty() || !statsdHost.empty(); }
+
+    // Consumes --metrics-file <path>, --statsd <host[:port]> or --metrics-interval <seconds>
+    // at argv[index], advancing index past the value.
+    bool parseArgument(int& index, int argc, char** argv);
+};
+
+// Publishes the registry from a thread of its own until destroyed.
+class Exporter {
+public:
+    explicit Exporter(const ExportConfig& config);
+    ~Exporter();
+
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+private:
+    void run();
+    void writePrometheusFile(const std::string& text) const;
+
+    ExportConfig config_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable stopRequested_;
+    bool stopping_ = false;  // Protected by mutex_
+};
+
+}
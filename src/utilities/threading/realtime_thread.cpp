@@ -0,0 +1,305 @@
+#include "utilities/threading/realtime_thread.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <avrt.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <mach/thread_policy.h>
+#include <pthread.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#endif
+
+namespace Utilities::Threading {
+
+namespace {
+
+// Used by the macOS time-constraint policy for threads without a natural period.
+constexpr double kNominalPeriodSeconds = 0.010;
+
+std::mutex& stateMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+ThreadConfiguration& sharedConfiguration() {
+    static ThreadConfiguration shared;
+    return shared;
+}
+
+std::array<ThreadReport, kThreadRoles.size()>& sharedReports() {
+    static std::array<ThreadReport, kThreadRoles.size()> reports;
+    return reports;
+}
+
+void appendDetail(std::string& detail, const std::string& text) {
+    if (!detail.empty()) {
+        detail += ", ";
+    }
+    detail += text;
+}
+
+bool applyRealtime(const ThreadPolicy& policy, const double periodSeconds, std::string& detail) {
+#if defined(_WIN32)
+    (void)periodSeconds;
+    DWORD taskIndex = 0;
+    const HANDLE task = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
+    if (task == nullptr) {
+        appendDetail(detail, "MMCSS refused (" + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+    AVRT_PRIORITY priority = AVRT_PRIORITY_NORMAL;
+    if (policy.priority >= 90) {
+        priority = AVRT_PRIORITY_CRITICAL;
+    } else if (policy.priority >= 60) {
+        priority = AVRT_PRIORITY_HIGH;
+    } else if (policy.priority < 30) {
+        priority = AVRT_PRIORITY_LOW;
+    }
+    AvSetMmThreadPriority(task, priority);
+    appendDetail(detail, "MMCSS Pro Audio");
+    return true;
+#elif defined(__APPLE__)
+    (void)policy;
+    mach_timebase_info_data_t timebase{};
+    mach_timebase_info(&timebase);
+    const double period = periodSeconds > 0.0 ? periodSeconds : kNominalPeriodSeconds;
+    const double ticksPerSecond = 1e9 * static_cast<double>(timebase.denom) / static_cast<double>(timebase.numer);
+
+    thread_time_constraint_policy_data_t constraint{};
+    constraint.period = static_cast<uint32_t>(period * ticksPerSecond);
+    constraint.computation = static_cast<uint32_t>(period * 0.5 * ticksPerSecond);
+    constraint.constraint = static_cast<uint32_t>(period * ticksPerSecond);
+    constraint.preemptible = TRUE;
+    const kern_return_t result = thread_policy_set(pthread_mach_thread_np(pthread_self()),
+                                                   THREAD_TIME_CONSTRAINT_POLICY,
+                                                   reinterpret_cast<thread_policy_t>(&constraint),
+                                                   THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+    if (result != KERN_SUCCESS) {
+        appendDetail(detail, "time constraint refused (" + std::to_string(result) + ")");
+        return false;
+    }
+    appendDetail(detail, "time constraint " + std::to_string(static_cast<int>(period * 1000.0 + 0.5)) + " ms");
+    return true;
+#elif defined(__linux__)
+    (void)periodSeconds;
+    const int schedulingPolicy = policy.roundRobin ? SCHED_RR : SCHED_FIFO;
+    const char* policyName = policy.roundRobin ? "SCHED_RR" : "SCHED_FIFO";
+    int priority = std::clamp(policy.priority,
+                              sched_get_priority_min(schedulingPolicy),
+                              sched_get_priority_max(schedulingPolicy));
+
+    // Unprivileged processes get real-time priorities only up to RLIMIT_RTPRIO, which is zero
+    // unless limits.conf or the audio group raises it.
+    rlimit limit{};
+    if (geteuid() != 0 && getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+        if (limit.rlim_cur == 0) {
+            appendDetail(detail, std::string(policyName) + " not permitted (RLIMIT_RTPRIO is 0)");
+            return false;
+        }
+        priority = std::min(priority, static_cast<int>(limit.rlim_cur));
+    }
+
+    sched_param parameters{};
+    parameters.sched_priority = priority;
+    if (const int error = pthread_setschedparam(pthread_self(), schedulingPolicy, &parameters); error != 0) {
+        appendDetail(detail, std::string(policyName) + " refused (" + std::strerror(error) + ")");
+        return false;
+    }
+    appendDetail(detail, std::string(policyName) + " " + std::to_string(priority));
+    return true;
+#else
+    (void)policy;
+    (void)periodSeconds;
+    appendDetail(detail, "real-time scheduling unsupported");
+    return false;
+#endif
+}
+
+bool applyAffinity(const int cpu, std::string& detail) {
+#if defined(_WIN32)
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8) ||
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) == 0) {
+        appendDetail(detail, "CPU " + std::to_string(cpu) + " refused");
+        return false;
+    }
+#elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE) {
+        appendDetail(detail, "CPU " + std::to_string(cpu) + " out of range");
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus); error != 0) {
+        appendDetail(detail, "CPU " + std::to_string(cpu) + " refused (" + std::strerror(error) + ")");
+        return false;
+    }
+#else
+    appendDetail(detail, "CPU affinity unsupported");
+    return false;
+#endif
+    appendDetail(detail, "CPU " + std::to_string(cpu));
+    return true;
+}
+
+bool suppressDenormals() {
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+    // FTZ (bit 15) and DAZ (bit 6).
+    _mm_setcsr(_mm_getcsr() | 0x8040u);
+    return true;
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    // FPCR.FZ; AArch64 has no separate inputs flag, FZ covers both.
+    uint64_t fpcr = 0;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    fpcr |= static_cast<uint64_t>(1) << 24;
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr));
+    return true;
+#else
+    return false;
+#endif
+}
+
+ThreadReport apply(const ThreadPolicy& policy, const double periodSeconds, const bool pin) {
+    ThreadReport result;
+    result.configured = true;
+    if (policy.realtime) {
+        result.realtime = applyRealtime(policy, periodSeconds, result.detail);
+    }
+    if (pin && policy.cpu >= 0) {
+        result.pinned = applyAffinity(policy.cpu, result.detail);
+    }
+    if (policy.suppressDenormals) {
+        result.denormalsSuppressed = suppressDenormals();
+        appendDetail(result.detail, result.denormalsSuppressed ? "FTZ" : "FTZ unsupported");
+    }
+    if (result.detail.empty()) {
+        result.detail = "default scheduling";
+    }
+    return result;
+}
+
+bool parseInt(int& index, const int argc, char** argv, int& value) {
+    if (index + 1 >= argc) {
+        return false;
+    }
+    value = std::atoi(argv[++index]);
+    return true;
+}
+
+}
+
+ThreadPolicy& ThreadConfiguration::policy(const ThreadRole role) {
+    switch (role) {
+        case ThreadRole::AudioCallback:
+            return audioCallback;
+        case ThreadRole::Analysis:
+            return analysis;
+        case ThreadRole::OSCSender:
+        default:
+            return oscSender;
+    }
+}
+
+const ThreadPolicy& ThreadConfiguration::policy(const ThreadRole role) const {
+    return const_cast<ThreadConfiguration*>(this)->policy(role);
+}
+
+bool ThreadConfiguration::parseArgument(int& index, const int argc, char** argv) {
+    const char* argument = argv[index];
+    int value = 0;
+    if (std::strcmp(argument, "--realtime") == 0) {
+        for (const ThreadRole role : kThreadRoles) {
+            policy(role).realtime = true;
+        }
+    } else if (std::strcmp(argument, "--rt-round-robin") == 0) {
+        for (const ThreadRole role : kThreadRoles) {
+            policy(role).roundRobin = true;
+        }
+    } else if (std::strcmp(argument, "--rt-priority") == 0) {
+        // The base priority goes to the audio callback; analysis and OSC stay below it.
+        if (parseInt(index, argc, argv, value)) {
+            const int base = std::clamp(value, 21, 99);
+            audioCallback.priority = base;
+            analysis.priority = base - 10;
+            oscSender.priority = base - 20;
+        }
+    } else if (std::strcmp(argument, "--cpu-audio") == 0) {
+        if (parseInt(index, argc, argv, value)) {
+            audioCallback.cpu = std::max(value, -1);
+        }
+    } else if (std::strcmp(argument, "--cpu-analysis") == 0) {
+        if (parseInt(index, argc, argv, value)) {
+            analysis.cpu = std::max(value, -1);
+        }
+    } else if (std::strcmp(argument, "--cpu-osc") == 0) {
+        if (parseInt(index, argc, argv, value)) {
+            oscSender.cpu = std::max(value, -1);
+        }
+    } else if (std::strcmp(argument, "--keep-denormals") == 0) {
+        for (const ThreadRole role : kThreadRoles) {
+            policy(role).suppressDenormals = false;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void setConfiguration(const ThreadConfiguration& requested) {
+    std::lock_guard<std::mutex> lock(stateMutex());
+    sharedConfiguration() = requested;
+}
+
+ThreadConfiguration configuration() {
+    std::lock_guard<std::mutex> lock(stateMutex());
+    return sharedConfiguration();
+}
+
+void configureCurrentThread(const ThreadRole role, const double periodSeconds) {
+    const ThreadReport result = apply(configuration().policy(role), periodSeconds, true);
+    std::lock_guard<std::mutex> lock(stateMutex());
+    sharedReports()[static_cast<size_t>(role)] = result;
+}
+
+void configureHelperThread(const ThreadRole role) {
+    apply(configuration().policy(role), 0.0, false);
+}
+
+ThreadReport report(const ThreadRole role) {
+    std::lock_guard<std::mutex> lock(stateMutex());
+    return sharedReports()[static_cast<size_t>(role)];
+}
+
+const char* roleName(const ThreadRole role) {
+    switch (role) {
+        case ThreadRole::AudioCallback:
+            return "Audio callback";
+        case ThreadRole::Analysis:
+            return "Analysis";
+        case ThreadRole::OSCSender:
+        default:
+            return "OSC sender";
+    }
+}
+
+std::string describe(const ThreadRole role) {
+    const ThreadReport current = report(role);
+    return std::string(roleName(role)) + ": " + (current.configured ? current.detail : "not running");
+}
+
+}
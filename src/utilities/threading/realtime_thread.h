@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+namespace Utilities::Threading {
+
+// The threads whose scheduling is configurable. AudioCallback is PortAudio's own thread,
+// configured from inside the first callback it runs; Analysis covers AudioProcessor's worker
+// and its lanes; OSCSender is the OSC runtime's send loop.
+enum class ThreadRole {
+    AudioCallback,
+    Analysis,
+    OSCSender
+};
+
+inline constexpr std::array<ThreadRole, 3> kThreadRoles{
+    ThreadRole::AudioCallback,
+    ThreadRole::Analysis,
+    ThreadRole::OSCSender
+};
+
+struct ThreadPolicy {
+    // Real-time scheduling: SCHED_FIFO (or SCHED_RR) on Linux, the time-constraint policy on
+    // macOS and the "Pro Audio" MMCSS task on Windows.
+    bool realtime = false;
+    bool roundRobin = false;
+    // 1-99 on the Linux scale, clamped to RLIMIT_RTPRIO. Windows maps it onto the four MMCSS
+    // priorities; macOS ignores it.
+    int priority = 0;
+    // Pins the thread to one logical CPU; negative leaves it to the scheduler. Not available on
+    // macOS, where the scheduler has no hard affinity.
+    int cpu = -1;
+    // Flush-to-zero and denormals-are-zero, so decaying filters and window tails do not fall
+    // onto the slow subnormal path.
+    bool suppressDenormals = false;
+};
+
+struct ThreadConfiguration {
+    ThreadPolicy audioCallback{false, false, 80, -1, true};
+    ThreadPolicy analysis{false, false, 70, -1, true};
+    ThreadPolicy oscSender{false, false, 60, -1, false};
+
+    ThreadPolicy& policy(ThreadRole role);
+    const ThreadPolicy& policy(ThreadRole role) const;
+
+    // Consumes the option at argv[index] and its value if it is one of --realtime,
+    // --rt-round-robin, --rt-priority <n>, --cpu-audio <n>, --cpu-analysis <n>, --cpu-osc <n>
+    // or --keep-denormals, advancing index past the value. The GUI and headless modes share it.
+    bool parseArgument(int& index, int argc, char** argv);
+};
+
+// What configuring a role's thread actually achieved, for the stats displays. Requests the
+// platform refused are listed in detail rather than failing the thread.
+struct ThreadReport {
+    bool configured = false;
+    bool realtime = false;
+    bool pinned = false;
+    bool denormalsSuppressed = false;
+    std::string detail;
+};
+
+// Set before the threads start; threads read it once when they configure themselves.
+void setConfiguration(const ThreadConfiguration& requested);
+ThreadConfiguration configuration();
+
+// Applies the role's policy to the calling thread and records the report. periodSeconds is the
+// thread's wake-up interval where it has one (the audio buffer duration), which the macOS
+// time-constraint policy needs; zero falls back to a nominal period.
+void configureCurrentThread(ThreadRole role, double periodSeconds = 0.0);
+// The same scheduling and denormal handling for a thread working alongside the role's main
+// one, without pinning it to the role's CPU or replacing the role's report.
+void configureHelperThread(ThreadRole role);
+
+ThreadReport report(ThreadRole role);
+const char* roleName(ThreadRole role);
+// One line per role, for the headless display.
+std::string describe(ThreadRole role);
+
+}
@@ -0,0 +1,225 @@
+#include "utilities/threading/task_scheduler.h"
+
+#include <exception>
+#include <utility>
+
+namespace Utilities::Threading {
+
+namespace {
+
+// Which scheduler and queue the current thread works for, so tasks submitted from inside a
+// task land on the submitting worker's own deque, and at which priority it is running.
+thread_local const TaskScheduler* currentScheduler = nullptr;
+thread_local std::size_t currentQueue = 0;
+thread_local TaskPriority runningPriority = TaskPriority::Interactive;
+
+void markFinished(Detail::TaskState& state, std::exception_ptr failure) {
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.failure = std::move(failure);
+        state.finished.store(true);
+    }
+    state.finishedChanged.notify_all();
+}
+
+}
+
+void TaskContext::reportProgress(const float fraction) const {
+    if (token_.state) {
+        token_.state->progress.store(std::clamp(fraction, 0.0f, 1.0f), std::memory_order_release);
+    }
+}
+
+void TaskHandle::cancel() {
+    if (state) {
+        state->cancelled.store(true, std::memory_order_release);
+    }
+}
+
+void TaskHandle::wait() const {
+    if (!state) {
+        return;
+    }
+    TaskScheduler* scheduler = state->scheduler;
+    if (scheduler != nullptr && scheduler->isWorkerThread()) {
+        scheduler->helpUntil(scheduler->queueForCaller(), [this] { return state->finished.load(); });
+    }
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finishedChanged.wait(lock, [this] { return state->finished.load(std::memory_order_acquire); });
+    if (state->failure) {
+        std::rethrow_exception(state->failure);
+    }
+}
+
+TaskScheduler::TaskScheduler(const std::size_t workerCount) {
+    const std::size_t count = std::max<std::size_t>(1, workerCount);
+    queues.reserve(count);
+    for (std::size_t index = 0; index < count; ++index) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    workers.reserve(count);
+    for (std::size_t index = 0; index < count; ++index) {
+        workers.emplace_back(&TaskScheduler::runWorker, this, index);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::shared() {
+    static TaskScheduler scheduler(std::max<std::size_t>(1, std::thread::hardware_concurrency()));
+    return scheduler;
+}
+
+TaskHandle TaskScheduler::submit(const TaskPriority priority, Task task) {
+    auto state = std::make_shared<Detail::TaskState>();
+    state->scheduler = this;
+    const std::size_t level = static_cast<std::size_t>(priority);
+    const std::size_t index = queueForCaller();
+    unfinishedTasks.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks[level].push_back(QueuedTask{std::move(task), state});
+    }
+    queuedTasks[level].fetch_add(1, std::memory_order_release);
+    totalQueuedTasks.fetch_add(1, std::memory_order_release);
+    {
+        // Taken so a worker between checking totalQueuedTasks and waiting cannot miss this.
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeWorkers.notify_one();
+    if (waitingHelpers.load() != 0) {
+        wakeWaiters.notify_all();
+    }
+    return TaskHandle(std::move(state));
+}
+
+void TaskScheduler::waitForAll() {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    allFinished.wait(lock, [this] { return unfinishedTasks.load(std::memory_order_acquire) == 0; });
+}
+
+void TaskScheduler::runWorker(const std::size_t index) {
+    currentScheduler = this;
+    currentQueue = index;
+    for (;;) {
+        if (runOneTask(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeWorkers.wait(lock, [this] {
+            return stopping || totalQueuedTasks.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping && totalQueuedTasks.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+bool TaskScheduler::runOneTask(const std::size_t preferredQueue) {
+    QueuedTask task;
+    std::size_t level = 0;
+    if (!takeTask(preferredQueue, task, level)) {
+        return false;
+    }
+
+    // Kept for the handle rather than let out of a worker, which would end the process.
+    std::exception_ptr failure;
+    if (!task.state->cancelled.load(std::memory_order_acquire)) {
+        const TaskPriority outerPriority = std::exchange(runningPriority, static_cast<TaskPriority>(level));
+        try {
+            task.function(TaskContext(task.state));
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        runningPriority = outerPriority;
+    }
+    // Released before the handle sees the task finish, so whatever it captured goes first.
+    task.function = nullptr;
+    markFinished(*task.state, std::move(failure));
+    // Whoever waits on this task, or on the parallelFor it was a range of, may be asleep.
+    wakeHelpers();
+
+    if (unfinishedTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        allFinished.notify_all();
+    }
+    return true;
+}
+
+bool TaskScheduler::takeTask(const std::size_t preferredQueue, QueuedTask& task, std::size_t& priority) {
+    if (totalQueuedTasks.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    for (std::size_t level = 0; level < kTaskPriorityCount; ++level) {
+        if (queuedTasks[level].load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+
+        {
+            Queue& own = *queues[preferredQueue];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks[level].empty()) {
+                task = std::move(own.tasks[level].back());
+                own.tasks[level].pop_back();
+                queuedTasks[level].fetch_sub(1, std::memory_order_relaxed);
+                totalQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+                priority = level;
+                return true;
+            }
+        }
+
+        // Stealing the oldest task takes the largest piece of work another worker has queued.
+        for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+            Queue& victim = *queues[(preferredQueue + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks[level].empty()) {
+                task = std::move(victim.tasks[level].front());
+                victim.tasks[level].pop_front();
+                queuedTasks[level].fetch_sub(1, std::memory_order_relaxed);
+                totalQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+                priority = level;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::size_t TaskScheduler::queueForCaller() {
+    if (currentScheduler == this) {
+        return currentQueue;
+    }
+    return nextExternalQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+}
+
+void TaskScheduler::wakeHelpers() {
+    if (waitingHelpers.load() == 0) {
+        return;
+    }
+    // A helper checks its condition holding wakeMutex, so taking it here means the helper is
+    // either still to check or already waiting.
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeWaiters.notify_all();
+}
+
+bool TaskScheduler::isWorkerThread() const {
+    return currentScheduler == this;
+}
+
+TaskPriority TaskScheduler::currentPriority() {
+    return runningPriority;
+}
+
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utilities::Threading {
+
+// Workers take the highest priority queued anywhere before anything lower, but never preempt
+// a running task, so long Background work should check its token between steps.
+// RealtimeAdjacent is for short work the live path waits on within a frame; Interactive for
+// what a user is watching, such as an import, a preview rebuild or hydration under the
+// playhead; Background for exports and batch work.
+enum class TaskPriority {
+    RealtimeAdjacent,
+    Interactive,
+    Background
+};
+
+inline constexpr std::size_t kTaskPriorityCount = 3;
+
+class TaskScheduler;
+
+namespace Detail {
+
+struct TaskState {
+    TaskScheduler* scheduler = nullptr;
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> finished{false};
+    std::atomic<float> progress{0.0f};
+    std::mutex mutex;
+    std::condition_variable finishedChanged;
+    std::exception_ptr failure;  // Protected by mutex; what the task threw, if anything
+};
+
+// What the ranges of one parallelFor share: the count still running, and the first exception
+// one of them threw, after which the ranges not yet started are skipped.
+struct RangeGroup {
+    explicit RangeGroup(std::size_t count) : remaining(count) {}
+
+    void fail(std::exception_ptr exception) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failure) {
+            failure = std::move(exception);
+        }
+        failed.store(true, std::memory_order_release);
+    }
+
+    std::atomic<std::size_t> remaining;
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    std::exception_ptr failure;  // Protected by mutex
+};
+
+}
+
+// Shared by a task and everyone holding its handle. Cancellation is cooperative: a task that
+// has not started yet is skipped, one that is running sees isCancelled() and returns early.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool isCancelled() const { return state && state->cancelled.load(std::memory_order_acquire); }
+
+private:
+    friend class TaskContext;
+    friend class TaskHandle;
+    explicit CancellationToken(std::shared_ptr<Detail::TaskState> taskState) : state(std::move(taskState)) {}
+
+    std::shared_ptr<Detail::TaskState> state;
+};
+
+// What a running task gets: its token, and somewhere to report progress for its handle.
+class TaskContext {
+public:
+    bool isCancelled() const { return token_.isCancelled(); }
+    const CancellationToken& token() const { return token_; }
+    // Clamped to [0, 1]; read back through TaskHandle::progress().
+    void reportProgress(float fraction) const;
+
+private:
+    friend class TaskScheduler;
+    explicit TaskContext(std::shared_ptr<Detail::TaskState> state) : token_(std::move(state)) {}
+
+    CancellationToken token_;
+};
+
+class TaskHandle {
+public:
+    TaskHandle() = default;
+
+    bool valid() const { return state != nullptr; }
+    void cancel();
+    bool isCancelled() const { return token().isCancelled(); }
+    // Also true for a task that was cancelled before it started and so never ran.
+    bool isFinished() const { return !state || state->finished.load(std::memory_order_acquire); }
+    float progress() const { return state ? state->progress.load(std::memory_order_acquire) : 0.0f; }
+    CancellationToken token() const { return CancellationToken(state); }
+
+    // A worker of the same scheduler runs other queued tasks while it waits, so a task can
+    // wait on work it submitted without tying up its worker. Rethrows whatever the task threw.
+    void wait() const;
+
+private:
+    friend class TaskScheduler;
+    explicit TaskHandle(std::shared_ptr<Detail::TaskState> taskState) : state(std::move(taskState)) {}
+
+    std::shared_ptr<Detail::TaskState> state;
+};
+
+// Work-stealing pool with a deque per priority on each worker. A worker runs the newest task
+// on its own deque first and steals the oldest of another worker's when it runs dry, so the
+// pieces one long job is split into spread across the cores that have finished theirs.
+class TaskScheduler {
+public:
+    using Task = std::function<void(const TaskContext&)>;
+
+    explicit TaskScheduler(std::size_t workerCount);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // The application-wide pool, one worker per core, that the GUI's background work shares.
+    // Created on first use.
+    static TaskScheduler& shared();
+
+    // Queued on the calling worker's deque, or spread across workers from outside the pool.
+    TaskHandle submit(TaskPriority priority, Task task);
+
+    // Calls job(first, end) over contiguous ranges covering [0, count), each at least
+    // minRangeSize long, and returns once every range has run. The caller runs one range and
+    // then helps with whatever is queued. Ranges run at the priority of the calling task. The
+    // first exception a range throws is rethrown here once the others have stopped.
+    template <typename Job>
+    void parallelFor(std::size_t count, std::size_t minRangeSize, const Job& job);
+
+    // Blocks until every submitted task, and everything those submitted, has finished.
+    void waitForAll();
+
+    std::size_t workerCount() const { return workers.size(); }
+
+private:
+    friend class TaskHandle;
+
+    struct QueuedTask {
+        Task function;
+        std::shared_ptr<Detail::TaskState> state;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::array<std::deque<QueuedTask>, kTaskPriorityCount> tasks;  // Protected by mutex
+    };
+
+    void runWorker(std::size_t index);
+    bool runOneTask(std::size_t preferredQueue);
+    bool takeTask(std::size_t preferredQueue, QueuedTask& task, std::size_t& priority);
+    std::size_t queueForCaller();
+    bool isWorkerThread() const;
+    static TaskPriority currentPriority();
+
+    // Runs queued tasks until done() holds, sleeping while there is nothing to take. done()
+    // must become true inside a task, since finishing one is what wakes the sleepers.
+    template <typename Done>
+    void helpUntil(std::size_t ownQueue, const Done& done);
+    void wakeHelpers();
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> nextExternalQueue{0};
+    std::array<std::atomic<std::size_t>, kTaskPriorityCount> queuedTasks{};
+    std::atomic<std::size_t> totalQueuedTasks{0};
+    std::atomic<std::size_t> unfinishedTasks{0};
+
+    // Callers blocked in parallelFor or TaskHandle::wait; read without wakeMutex by wakeHelpers.
+    std::atomic<std::size_t> waitingHelpers{0};
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable wakeWaiters;
+    std::condition_variable allFinished;
+    bool stopping = false;  // Protected by wakeMutex
+};
+
+template <typename Job>
+void TaskScheduler::parallelFor(const std::size_t count, const std::size_t minRangeSize, const Job& job) {
+    // A few ranges per worker leave something to steal when ranges take uneven time.
+    const std::size_t rangeCount = std::max<std::size_t>(
+        1, std::min(count / std::max<std::size_t>(1, minRangeSize), workers.size() * 4));
+    if (rangeCount == 1) {
+        job(0, count);
+        return;
+    }
+
+    const TaskPriority priority = currentPriority();
+    Detail::RangeGroup group(rangeCount - 1);
+    for (std::size_t range = 1; range < rangeCount; ++range) {
+        submit(priority, [&job, &group, count, rangeCount, range](const TaskContext&) {
+            if (!group.failed.load(std::memory_order_acquire)) {
+                try {
+                    job(count * range / rangeCount, count * (range + 1) / rangeCount);
+                } catch (...) {
+                    group.fail(std::current_exception());
+                }
+            }
+            // The caller may return as soon as this reaches zero, so group is not touched after.
+            group.remaining.fetch_sub(1);
+        });
+    }
+    try {
+        job(0, count / rangeCount);
+    } catch (...) {
+        group.fail(std::current_exception());
+    }
+
+    // The queued ranges refer to job and group, so even a failed caller waits for them.
+    helpUntil(queueForCaller(), [&group] { return group.remaining.load() == 0; });
+    if (group.failure) {
+        std::rethrow_exception(group.failure);
+    }
+}
+
+template <typename Done>
+void TaskScheduler::helpUntil(const std::size_t ownQueue, const Done& done) {
+    while (!done()) {
+        if (runOneTask(ownQueue)) {
+            continue;
+        }
+        // waitingHelpers is raised before done() is checked, and whatever satisfies done()
+        // reads it afterwards, so one of the two always sees the other.
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        waitingHelpers.fetch_add(1);
+        wakeWaiters.wait(lock, [this, &done] {
+            return done() || totalQueuedTasks.load(std::memory_order_acquire) > 0;
+        });
+        waitingHelpers.fetch_sub(1);
+    }
+}
+
+}
@@ -0,0 +1,184 @@
+#include "utilities/tuning/wisdom.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+namespace Utilities::Tuning {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::atomic<int> tunedAnalysisWorkers{0};
+std::atomic<int> tunedBatchWorkers{0};
+
+const char* architecture() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+    return "x86_64";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return "arm64";
+#else
+    return "other";
+#endif
+}
+
+std::optional<CPU::VectorLevel> vectorLevelFromName(const std::string& name) {
+    for (const CPU::VectorLevel level : {CPU::VectorLevel::Baseline, CPU::VectorLevel::AVX2, CPU::VectorLevel::AVX512}) {
+        if (name == CPU::name(level)) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+fs::path environmentPath(const char* variable) {
+    const char* value = std::getenv(variable);
+    return value != nullptr && value[0] != '\0' ? fs::path(value) : fs::path();
+}
+
+}
+
+std::string machineSignature() {
+    return std::string(architecture()) + ";threads=" + std::to_string(std::thread::hardware_concurrency()) +
+           ";vector=" + CPU::name(CPU::detectedVectorLevel());
+}
+
+fs::path defaultPath() {
+    if (const fs::path overridePath = environmentPath("SYN_WISDOM"); !overridePath.empty()) {
+        return overridePath;
+    }
+#if defined(_WIN32)
+    const fs::path base = environmentPath("APPDATA");
+    return base.empty() ? fs::path() : base / "Synesthesia" / "wisdom.json";
+#elif defined(__APPLE__)
+    const fs::path home = environmentPath("HOME");
+    return home.empty() ? fs::path() : home / "Library" / "Application Support" / "Synesthesia" / "wisdom.json";
+#else
+    if (const fs::path config = environmentPath("XDG_CONFIG_HOME"); !config.empty()) {
+        return config / "synesthesia" / "wisdom.json";
+    }
+    const fs::path home = environmentPath("HOME");
+    return home.empty() ? fs::path() : home / ".config" / "synesthesia" / "wisdom.json";
+#endif
+}
+
+std::optional<Wisdom> load(const fs::path& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "unable to open " + path.string();
+        return std::nullopt;
+    }
+
+    const nlohmann::json decoded = nlohmann::json::parse(file, nullptr, false);
+    if (decoded.is_discarded() || !decoded.is_object()) {
+        error = path.string() + " is not valid JSON";
+        return std::nullopt;
+    }
+
+    Wisdom wisdom;
+    try {
+        if (decoded.value("version", 0) != Wisdom::VERSION) {
+            error = path.string() + " is from another version; run --tune again";
+            return std::nullopt;
+        }
+
+        wisdom.machine = decoded.value("machine", std::string());
+        if (wisdom.machine != machineSignature()) {
+            error = path.string() + " was tuned on another machine (" + wisdom.machine + "); run --tune again";
+            return std::nullopt;
+        }
+
+        if (const auto fft = decoded.find("fft"); fft != decoded.end() && fft->is_object()) {
+            for (const auto& [size, backend] : fft->items()) {
+                const int fftSize = std::atoi(size.c_str());
+                const auto kind = backend.is_string() ? FFTBackend::kindFromName(backend.get<std::string>()) : std::nullopt;
+                if (fftSize > 0 && kind && FFTBackend::isAvailable(*kind)) {
+                    wisdom.fftBackends[fftSize] = *kind;
+                }
+            }
+        }
+        wisdom.vectorLevel = vectorLevelFromName(decoded.value("vectorLevel", std::string()));
+        wisdom.analysisHop = std::max(0, decoded.value("analysisHop", 0));
+        wisdom.analysisWorkers = std::max(0, decoded.value("analysisWorkers", 0));
+        wisdom.batchWorkers = std::max(0, decoded.value("batchWorkers", 0));
+    } catch (const nlohmann::json::exception&) {
+        error = path.string() + " is not valid wisdom";
+        return std::nullopt;
+    }
+    return wisdom;
+}
+
+bool save(const Wisdom& wisdom, const fs::path& path, std::string& error) {
+    nlohmann::json encoded;
+    encoded["version"] = Wisdom::VERSION;
+    encoded["machine"] = wisdom.machine;
+    nlohmann::json& fft = encoded["fft"];
+    fft = nlohmann::json::object();
+    for (const auto& [size, kind] : wisdom.fftBackends) {
+        fft[std::to_string(size)] = FFTBackend::name(kind);
+    }
+    if (wisdom.vectorLevel) {
+        encoded["vectorLevel"] = CPU::name(*wisdom.vectorLevel);
+    }
+    encoded["analysisHop"] = wisdom.analysisHop;
+    encoded["analysisWorkers"] = wisdom.analysisWorkers;
+    encoded["batchWorkers"] = wisdom.batchWorkers;
+
+    std::error_code directoryError;
+    if (path.has_parent_path()) {
+        fs::create_directories(path.parent_path(), directoryError);
+    }
+    std::ofstream file(path, std::ios::trunc);
+    file << encoded.dump(2) << "\n";
+    if (!file) {
+        error = "unable to write " + path.string();
+        return false;
+    }
+    return true;
+}
+
+void apply(const Wisdom& wisdom) {
+    FFTBackend::clearPreferredKinds();
+    for (const auto& [size, kind] : wisdom.fftBackends) {
+        FFTBackend::setPreferredKind(size, kind);
+    }
+    CPU::setVectorLevelCap(wisdom.vectorLevel.value_or(CPU::VectorLevel::AVX512));
+    tunedAnalysisWorkers.store(wisdom.analysisWorkers, std::memory_order_relaxed);
+    tunedBatchWorkers.store(wisdom.batchWorkers, std::memory_order_relaxed);
+}
+
+void loadDefault() {
+    const fs::path path = defaultPath();
+    std::error_code existsError;
+    if (path.empty() || !fs::exists(path, existsError)) {
+        return;
+    }
+
+    std::string error;
+    if (const std::optional<Wisdom> wisdom = load(path, error)) {
+        apply(*wisdom);
+    } else {
+        std::cerr << "[tuning] Ignoring wisdom: " << error << "\n";
+    }
+}
+
+std::size_t analysisWorkerCount() {
+    const int tuned = tunedAnalysisWorkers.load(std::memory_order_relaxed);
+    if (tuned > 0) {
+        return static_cast<std::size_t>(tuned);
+    }
+    return std::max<std::size_t>(1, std::min<std::size_t>(static_cast<std::size_t>(std::thread::hardware_concurrency()), 8));
+}
+
+int batchWorkerCount() {
+    return std::max(1, tunedBatchWorkers.load(std::memory_order_relaxed));
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "audio/analysis/fft/fft_backend.h"
+#include "utilities/cpu/cpu_features.h"
+
+namespace Utilities::Tuning {
+
+// What a --tune run measured fastest on one machine: the FFT backend for each analysis size,
+// the widest vector level worth dispatching to, and how many threads the import analysis and
+// the batch exporter should use. It only applies on the machine it was measured on.
+struct Wisdom {
+    static constexpr int VERSION = 1;
+
+    std::string machine;
+    std::map<int, FFTBackend::Kind> fftBackends;
+    std::optional<CPU::VectorLevel> vectorLevel;
+    int analysisHop = 0;      // The hop the worker counts were measured at
+    int analysisWorkers = 0;  // 0 when not tuned
+    int batchWorkers = 0;     // 0 when not tuned
+};
+
+// The architecture, hardware thread count and detected vector level; wisdom measured under
+// any other is stale.
+std::string machineSignature();
+// SYN_WISDOM if set, else wisdom.json in the platform's per-user configuration directory.
+std::filesystem::path defaultPath();
+
+// Fails, with error set, when the file is unreadable, from another version or for another
+// machine.
+std::optional<Wisdom> load(const std::filesystem::path& path, std::string& error);
+bool save(const Wisdom& wisdom, const std::filesystem::path& path, std::string& error);
+
+// Hands the selections to FFTBackend and the vector level cap, and keeps the worker counts
+// for the accessors below.
+void apply(const Wisdom& wisdom);
+// Loads and applies defaultPath() if there is a file there. A stale or broken file is
+// reported on stderr and ignored.
+void loadDefault();
+
+// Threads for analysing one imported file: the tuned count, else the hardware threads up to 8.
+std::size_t analysisWorkerCount();
+// Batch export threads when --num-workers is not given: the tuned count, else 1.
+int batchWorkerCount();
+
+}